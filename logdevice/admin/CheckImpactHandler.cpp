@@ -113,7 +113,7 @@ CheckImpactHandler::semifuture_checkImpact(
 
   auto updateable_settings = processor_->updateableServerSettings();
 
-  std::unique_ptr<Request> rq = std::make_unique<CheckImpactRequest>(
+  auto req = std::make_unique<CheckImpactRequest>(
       std::move(status_map),
       std::move(shards),
       target_storage_state,
@@ -125,6 +125,10 @@ CheckImpactHandler::semifuture_checkImpact(
       request->return_sample_size,
       CheckImpactRequest::workerType(processor_),
       std::move(cb));
+  if (updateable_settings->safety_check_cache_storage_sets) {
+    req->useStorageSetImpactCache(storage_set_impact_cache_);
+  }
+  std::unique_ptr<Request> rq = std::move(req);
   int rv = processor_->postRequest(rq);
   if (rv != 0) {
     // We couldn't submit the request to the processor.
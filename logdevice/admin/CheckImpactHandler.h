@@ -11,6 +11,7 @@
 #include <folly/Optional.h>
 
 #include "logdevice/admin/AdminAPIHandlerBase.h"
+#include "logdevice/admin/safety/StorageSetImpactCache.h"
 #include "logdevice/common/NodeID.h"
 #include "logdevice/common/types_internal.h"
 
@@ -21,5 +22,10 @@ class CheckImpactHandler : public virtual AdminAPIHandlerBase {
   virtual folly::SemiFuture<std::unique_ptr<thrift::CheckImpactResponse>>
   semifuture_checkImpact(
       std::unique_ptr<thrift::CheckImpactRequest> request) override;
+
+ private:
+  // Used if safety-check-cache-storage-sets is enabled.
+  std::shared_ptr<StorageSetImpactCache> storage_set_impact_cache_ =
+      std::make_shared<StorageSetImpactCache>();
 };
 }} // namespace facebook::logdevice
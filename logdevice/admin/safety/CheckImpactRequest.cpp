@@ -8,6 +8,7 @@
 #include "logdevice/admin/safety/CheckImpactRequest.h"
 
 #include "logdevice/admin/safety/CheckMetaDataLogRequest.h"
+#include "logdevice/common/ClusterState.h"
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/Timer.h"
 
@@ -77,6 +78,19 @@ Request::Execution CheckImpactRequest::execute() {
 Request::Execution CheckImpactRequest::start() {
   Worker* worker = Worker::onThisThread(true);
   start_time_ = std::chrono::steady_clock::now();
+  std::shared_ptr<Configuration> cfg = worker->getConfiguration();
+  if (storage_set_impact_cache_) {
+    auto* cluster_state = Worker::getClusterState();
+    StorageSetImpactCache::Context context{
+        cfg->serverConfig()->getVersion(),
+        cluster_state ? cluster_state->getSnapshot()->version() : 0,
+        status_map_,
+        shards_,
+        target_storage_state_,
+        safety_margin_};
+    storage_set_impact_results_ =
+        storage_set_impact_cache_->getResults(context);
+  }
   // LOGID_INVALID means that we want to check the metadata logs nodeset.
   if (requestSingleLog(LOGID_INVALID) != 0) {
     ld_warning("Failed to post a CheckMetadataLogRequest to check the metadata"
@@ -85,7 +99,6 @@ Request::Execution CheckImpactRequest::start() {
     complete(err);
     return Request::Execution::COMPLETE;
   }
-  std::shared_ptr<Configuration> cfg = worker->getConfiguration();
   const auto& local_logs_config = cfg->getLocalLogsConfig();
   // User-logs only
   const logsconfig::LogsConfigTree& log_tree =
@@ -142,6 +155,9 @@ int CheckImpactRequest::requestSingleLog(logid_t log_id) {
   if (read_epoch_metadata_from_sequencer_) {
     req->readEpochMetaDataFromSequencer();
   }
+  if (storage_set_impact_results_) {
+    req->useStorageSetImpactResults(storage_set_impact_results_);
+  }
   std::unique_ptr<Request> request = std::move(req);
   int rv = worker->processor_->postRequest(request);
   if (rv == 0) {
@@ -319,6 +335,10 @@ void CheckImpactRequest::complete(Status st) {
           error_name(st),
           total_time,
           logs_done_);
+  if (storage_set_impact_results_) {
+    ld_info("%zu distinct storage sets evaluated",
+            storage_set_impact_results_->size());
+  }
 
   if (st != E::OK) {
     // This is to ensure that we don't return ImpactResult::NONE if the
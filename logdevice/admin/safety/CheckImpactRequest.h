@@ -11,6 +11,7 @@
 #include <folly/Optional.h>
 
 #include "logdevice/admin/safety/SafetyAPI.h"
+#include "logdevice/admin/safety/StorageSetImpactCache.h"
 #include "logdevice/common/Request.h"
 #include "logdevice/common/ShardAuthoritativeStatusMap.h"
 #include "logdevice/common/ShardID.h"
@@ -34,6 +35,10 @@ class InternalLogs;
  *   - This safety checker will first check the metadata nodeset for safety
  *   issues. This will not continue to schedule checks for the logs unless
  *   metadata nodeset will not be affected.
+ *   - With useStorageSetImpactCache(), each distinct (storage set,
+ *   replication) pair is evaluated once for all logs, and the results are
+ *   reused by subsequent checks with the same parameters and config version.
+ *   Historical metadata is still read for every log.
  */
 
 class CheckImpactRequest : public Request {
@@ -61,6 +66,14 @@ class CheckImpactRequest : public Request {
   WorkerType getWorkerTypeAffinity() override;
   ~CheckImpactRequest() override;
 
+  /**
+   * Evaluate each distinct (storage set, replication) pair once, sharing
+   * results through `cache`. Must be called before the request is posted.
+   */
+  void useStorageSetImpactCache(std::shared_ptr<StorageSetImpactCache> cache) {
+    storage_set_impact_cache_ = std::move(cache);
+  }
+
  private:
   /**
    * Kicks off the safety check. This works in the following fashion:
@@ -138,6 +151,10 @@ class CheckImpactRequest : public Request {
   // TODO(T28386689): Set automatically to true once sequencers get the ability
   // to update their in-memory metadata cache after trims.
   bool read_epoch_metadata_from_sequencer_{false};
+  std::shared_ptr<StorageSetImpactCache> storage_set_impact_cache_;
+  // Results for the context of this check, set in start() if
+  // storage_set_impact_cache_ is set.
+  std::shared_ptr<StorageSetImpactCache::Results> storage_set_impact_results_;
   WorkerType worker_type_;
   Callback callback_;
   WorkerCallbackHelper<CheckImpactRequest> metadata_check_callback_helper_;
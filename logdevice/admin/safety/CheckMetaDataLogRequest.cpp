@@ -72,9 +72,18 @@ std::tuple<bool, bool, NodeLocationScope>
 CheckMetaDataLogRequest::checkReadWriteAvailablity(
     const StorageSet& storage_set,
     const ReplicationProperty& replication_property) {
+  if (storage_set_impact_results_) {
+    auto cached =
+        storage_set_impact_results_->get(storage_set, replication_property);
+    if (cached.hasValue()) {
+      return std::make_tuple(
+          cached->safe_reads, cached->safe_writes, cached->fail_scope);
+    }
+  }
+
   bool safe_writes = true;
   bool safe_reads = true;
-  NodeLocationScope fail_scope;
+  NodeLocationScope fail_scope = NodeLocationScope::INVALID;
 
   // We always validate write availability issues, this is because the
   // target_storage_state cannot be READ_WRITE in this class. it will either be
@@ -96,6 +105,12 @@ CheckMetaDataLogRequest::checkReadWriteAvailablity(
       safe_reads = checkReadAvailability(storage_set, replication_prop);
     }
   }
+  if (storage_set_impact_results_) {
+    storage_set_impact_results_->put(
+        storage_set,
+        replication_property,
+        StorageSetImpactCache::Result{safe_reads, safe_writes, fail_scope});
+  }
   return std::make_tuple(safe_reads, safe_writes, fail_scope);
 }
 
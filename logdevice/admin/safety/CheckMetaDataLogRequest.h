@@ -11,6 +11,7 @@
 #include <memory>
 
 #include "SafetyAPI.h"
+#include "logdevice/admin/safety/StorageSetImpactCache.h"
 #include "logdevice/common/EpochMetaData.h"
 #include "logdevice/common/FailureDomainNodeSet.h"
 #include "logdevice/common/NodeSetFinder.h"
@@ -95,6 +96,15 @@ class CheckMetaDataLogRequest : public Request {
     read_epoch_metadata_from_sequencer_ = true;
   }
 
+  /**
+   * Look up the impact on each (storage set, replication) pair in `results`
+   * before evaluating it, and store it there afterwards.
+   */
+  void useStorageSetImpactResults(
+      std::shared_ptr<StorageSetImpactCache::Results> results) {
+    storage_set_impact_results_ = std::move(results);
+  }
+
  private:
   // Use NodeSetFinder to find historical metadata.
   void fetchHistoricalMetadata();
@@ -151,6 +161,8 @@ class CheckMetaDataLogRequest : public Request {
   std::chrono::milliseconds timeout_;
   // TODO(T28386689): remove once all production tiers are on 2.35.
   bool read_epoch_metadata_from_sequencer_ = false;
+  // nullptr unless useStorageSetImpactResults() was called.
+  std::shared_ptr<StorageSetImpactCache::Results> storage_set_impact_results_;
 
   std::unique_ptr<NodeSetFinder> nodeset_finder_;
 
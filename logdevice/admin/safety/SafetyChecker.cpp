@@ -61,18 +61,21 @@ SafetyChecker::checkImpact(const ShardAuthoritativeStatusMap& shard_status,
   };
 
   WorkerType worker_type = CheckImpactRequest::workerType(processor_);
-  std::unique_ptr<Request> request =
-      std::make_unique<CheckImpactRequest>(shard_status,
-                                           shards,
-                                           target_storage_state,
-                                           safety_margin,
-                                           logids_to_check,
-                                           logs_in_flight_,
-                                           abort_on_error_,
-                                           timeout_,
-                                           error_sample_size_,
-                                           worker_type,
-                                           cb);
+  auto req = std::make_unique<CheckImpactRequest>(shard_status,
+                                                  shards,
+                                                  target_storage_state,
+                                                  safety_margin,
+                                                  logids_to_check,
+                                                  logs_in_flight_,
+                                                  abort_on_error_,
+                                                  timeout_,
+                                                  error_sample_size_,
+                                                  worker_type,
+                                                  cb);
+  if (storage_set_impact_cache_) {
+    req->useStorageSetImpactCache(storage_set_impact_cache_);
+  }
+  std::unique_ptr<Request> request = std::move(req);
   int rv = processor_->postRequest(request);
   if (rv != 0) {
     // We couldn't submit the request to the processor.
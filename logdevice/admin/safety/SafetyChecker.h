@@ -8,6 +8,7 @@
 #pragma once
 
 #include "SafetyAPI.h"
+#include "logdevice/admin/safety/StorageSetImpactCache.h"
 #include "logdevice/common/EpochMetaData.h"
 #include "logdevice/common/FailureDomainNodeSet.h"
 #include "logdevice/common/MetaDataLogReader.h"
@@ -62,6 +63,15 @@ class SafetyChecker {
                      SafetyMargin safety_margin = SafetyMargin(),
                      std::vector<logid_t> logids_to_check = {});
 
+  /**
+   * Evaluate each distinct (storage set, replication) pair once per call to
+   * checkImpact(), and reuse the results in subsequent calls with the same
+   * parameters as long as the config and cluster state don't change.
+   */
+  void useStorageSetImpactCache() {
+    storage_set_impact_cache_ = std::make_shared<StorageSetImpactCache>();
+  }
+
   static std::string
   impactToString(const ShardSet& shards,
                  const ShardAuthoritativeStatusMap& shard_status,
@@ -75,6 +85,7 @@ class SafetyChecker {
   size_t error_sample_size_;
   // TODO(T28386689): remove once all production tiers are on 2.35.
   bool read_epoch_metadata_from_sequencer_;
+  std::shared_ptr<StorageSetImpactCache> storage_set_impact_cache_;
 };
 
 }} // namespace facebook::logdevice
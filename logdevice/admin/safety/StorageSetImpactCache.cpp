@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/admin/safety/StorageSetImpactCache.h"
+
+namespace facebook { namespace logdevice {
+
+bool StorageSetImpactCache::Context::operator==(const Context& rhs) const {
+  return config_version == rhs.config_version &&
+      cluster_state_version == rhs.cluster_state_version &&
+      target_storage_state == rhs.target_storage_state &&
+      safety_margin == rhs.safety_margin && op_shards == rhs.op_shards &&
+      status_map == rhs.status_map;
+}
+
+folly::Optional<StorageSetImpactCache::Result>
+StorageSetImpactCache::Results::get(
+    const StorageSet& storage_set,
+    const ReplicationProperty& replication) const {
+  Key key(storage_set, replication.getDistinctReplicationFactors());
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = results_.find(key);
+  if (it == results_.end()) {
+    return folly::none;
+  }
+  return it->second;
+}
+
+void StorageSetImpactCache::Results::put(
+    const StorageSet& storage_set,
+    const ReplicationProperty& replication,
+    Result result) {
+  Key key(storage_set, replication.getDistinctReplicationFactors());
+  std::lock_guard<std::mutex> lock(mutex_);
+  results_[std::move(key)] = result;
+}
+
+size_t StorageSetImpactCache::Results::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return results_.size();
+}
+
+std::shared_ptr<StorageSetImpactCache::Results>
+StorageSetImpactCache::getResults(const Context& context) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!results_ || !context_.hasValue() || !(context_.value() == context)) {
+    context_ = context;
+    results_ = std::make_shared<Results>();
+  }
+  return results_;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <folly/Optional.h>
+
+#include "logdevice/admin/safety/SafetyAPI.h"
+#include "logdevice/common/ShardAuthoritativeStatusMap.h"
+#include "logdevice/common/ShardID.h"
+#include "logdevice/common/configuration/Node.h"
+#include "logdevice/common/configuration/ReplicationProperty.h"
+#include "logdevice/common/types_internal.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Remembers whether read/write availability of a (storage set,
+ * replication) pair survives the operation being checked, so that a safety
+ * check evaluates each distinct pair once instead of once per epoch of every
+ * log. Most logs share their storage set with many others.
+ *
+ * The results depend on the parameters of the check and on the state of the
+ * cluster, all captured by Context. Results are reused across checks as long
+ * as the context stays the same, e.g. when an automated maintenance retries
+ * the same check while the config does not change.
+ */
+
+class StorageSetImpactCache {
+ public:
+  struct Context {
+    config_version_t config_version;
+    // Version of the ClusterState snapshot, the read availability check
+    // takes into account which nodes are alive.
+    uint64_t cluster_state_version;
+    ShardAuthoritativeStatusMap status_map;
+    ShardSet op_shards;
+    configuration::StorageState target_storage_state;
+    SafetyMargin safety_margin;
+
+    bool operator==(const Context& rhs) const;
+  };
+
+  struct Result {
+    bool safe_reads;
+    bool safe_writes;
+    NodeLocationScope fail_scope;
+  };
+
+  /**
+   * Results for a single context. Thread safe, it is shared by the
+   * CheckMetaDataLogRequests of a check, which run on different workers.
+   */
+  class Results {
+   public:
+    folly::Optional<Result> get(const StorageSet& storage_set,
+                                const ReplicationProperty& replication) const;
+    void put(const StorageSet& storage_set,
+             const ReplicationProperty& replication,
+             Result result);
+    // Number of distinct (storage set, replication) pairs evaluated.
+    size_t size() const;
+
+   private:
+    using Key = std::pair<StorageSet,
+                          std::vector<ReplicationProperty::ScopeReplication>>;
+
+    mutable std::mutex mutex_;
+    std::map<Key, Result> results_;
+  };
+
+  /**
+   * @return  the results for `context`. These are the results of the
+   *          previous call if it had the same context, otherwise they start
+   *          empty and replace the previous ones. Checks that are still
+   *          running with the previous results keep them.
+   */
+  std::shared_ptr<Results> getResults(const Context& context);
+
+ private:
+  std::mutex mutex_;
+  folly::Optional<Context> context_;
+  std::shared_ptr<Results> results_;
+};
+
+}} // namespace facebook::logdevice
@@ -6,6 +6,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 #include "logdevice/admin/safety/SafetyChecker.h"
+#include "logdevice/admin/safety/StorageSetImpactCache.h"
 
 #include <gtest/gtest.h>
 
@@ -21,3 +22,40 @@ TEST(SafetyCheckerTest, Parse) {
   ASSERT_EQ(2, safety_margin2[NodeLocationScope::RACK]);
   ASSERT_EQ(5, safety_margin2[NodeLocationScope::NODE]);
 }
+
+TEST(SafetyCheckerTest, StorageSetImpactCache) {
+  StorageSetImpactCache cache;
+  StorageSetImpactCache::Context context{
+      config_version_t(1),
+      1,
+      ShardAuthoritativeStatusMap(),
+      {ShardID(1, 0)},
+      configuration::StorageState::READ_ONLY,
+      SafetyMargin()};
+  StorageSet storage_set{ShardID(1, 0), ShardID(2, 0), ShardID(3, 0)};
+  ReplicationProperty replication({{NodeLocationScope::NODE, 2}});
+
+  auto results = cache.getResults(context);
+  EXPECT_FALSE(results->get(storage_set, replication).hasValue());
+  results->put(storage_set,
+               replication,
+               StorageSetImpactCache::Result{
+                   true, false, NodeLocationScope::NODE});
+  auto result = results->get(storage_set, replication);
+  ASSERT_TRUE(result.hasValue());
+  EXPECT_TRUE(result->safe_reads);
+  EXPECT_FALSE(result->safe_writes);
+  ReplicationProperty other_replication({{NodeLocationScope::NODE, 3}});
+  EXPECT_FALSE(results->get(storage_set, other_replication).hasValue());
+
+  // Same context, results are reused.
+  EXPECT_EQ(results, cache.getResults(context));
+
+  // The config changed, results start over. The ones still in use by a
+  // running check are left alone.
+  context.config_version = config_version_t(2);
+  auto new_results = cache.getResults(context);
+  EXPECT_NE(results, new_results);
+  EXPECT_EQ(0, new_results->size());
+  EXPECT_EQ(1, results->size());
+}
@@ -54,6 +54,11 @@ constexpr auto logs_config_recognized_attributes = {
     SEQUENCER_AFFINITY,
     SHADOW,
     TAIL_OPTIMIZED,
+    HEDGED_COPIES,
+    MAX_APPEND_BYTES_PER_SECOND,
+    STREAMING_INGEST,
+    COMPACT_RECORD_HEADER,
+    EPHEMERAL,
     EXTRAS};
 
 static NodeLocationScope parse_location_scope_or_throw(std::string key) {
@@ -235,6 +240,16 @@ dict LogAttributes_to_dict(const LogAttributes& attrs) {
                               EXTRA_COPIES,
                               output);
 
+  add_log_attribute<int, int>(attrs.hedgedCopies(),
+                              [](auto attr) { return attr.value(); },
+                              HEDGED_COPIES,
+                              output);
+
+  add_log_attribute<int, int>(attrs.maxAppendBytesPerSecond(),
+                              [](auto attr) { return attr.value(); },
+                              MAX_APPEND_BYTES_PER_SECOND,
+                              output);
+
   add_log_attribute<int, int>(attrs.syncedCopies(),
                               [](auto attr) { return attr.value(); },
                               SYNCED_COPIES,
@@ -299,6 +314,21 @@ dict LogAttributes_to_dict(const LogAttributes& attrs) {
       DELIVERY_LATENCY,
       output);
 
+  add_log_attribute<bool, bool>(attrs.streamingIngest(),
+                                [](auto attr) { return attr.value(); },
+                                STREAMING_INGEST,
+                                output);
+
+  add_log_attribute<bool, bool>(attrs.compactRecordHeader(),
+                                [](auto attr) { return attr.value(); },
+                                COMPACT_RECORD_HEADER,
+                                output);
+
+  add_log_attribute<bool, bool>(attrs.ephemeral(),
+                                [](auto attr) { return attr.value(); },
+                                EPHEMERAL,
+                                output);
+
   add_log_attribute<bool, bool>(attrs.scdEnabled(),
                                 [](auto attr) { return attr.value(); },
                                 SCD_ENABLED,
@@ -411,6 +441,12 @@ LogAttributes dict_to_LogAttributes(const dict& attrs) {
     } else if (key_string == EXTRA_COPIES) {
       int v = convert_or_throw<int>(value, EXTRA_COPIES);
       log_attributes = log_attributes.with_extraCopies(v);
+    } else if (key_string == HEDGED_COPIES) {
+      int v = convert_or_throw<int>(value, HEDGED_COPIES);
+      log_attributes = log_attributes.with_hedgedCopies(v);
+    } else if (key_string == MAX_APPEND_BYTES_PER_SECOND) {
+      int v = convert_or_throw<int>(value, MAX_APPEND_BYTES_PER_SECOND);
+      log_attributes = log_attributes.with_maxAppendBytesPerSecond(v);
     } else if (key_string == SYNCED_COPIES) {
       int v = convert_or_throw<int>(value, SYNCED_COPIES);
       log_attributes = log_attributes.with_syncedCopies(v);
@@ -459,6 +495,15 @@ LogAttributes dict_to_LogAttributes(const dict& attrs) {
         log_attributes =
             log_attributes.with_deliveryLatency(std::chrono::milliseconds(v));
       }
+    } else if (key_string == STREAMING_INGEST) {
+      bool v = convert_or_throw<bool>(value, STREAMING_INGEST);
+      log_attributes = log_attributes.with_streamingIngest(v);
+    } else if (key_string == COMPACT_RECORD_HEADER) {
+      bool v = convert_or_throw<bool>(value, COMPACT_RECORD_HEADER);
+      log_attributes = log_attributes.with_compactRecordHeader(v);
+    } else if (key_string == EPHEMERAL) {
+      bool v = convert_or_throw<bool>(value, EPHEMERAL);
+      log_attributes = log_attributes.with_ephemeral(v);
     } else if (key_string == SCD_ENABLED) {
       bool v = convert_or_throw<bool>(value, SCD_ENABLED);
       log_attributes = log_attributes.with_scdEnabled(v);
@@ -124,6 +124,29 @@ class LogDeviceIntegrationTest(TestCase):
                 nread += 1
         self.assertEqual(NWRITES, nread)
 
+    def test_read_batch(self):
+        """read_batch() returns all records, then an empty list at the end."""
+        NWRITES = 100
+        LOGID = 1
+        client = self.client()
+
+        expected = [b"hello%d" % i for i in range(NWRITES)]
+        lsns = [client.append(LOGID, payload) for payload in expected]
+
+        reader = client.create_reader(1)
+        reader.start_reading(LOGID, lsns[0], lsns[-1])
+
+        payloads = []
+        while True:
+            batch = reader.read_batch(16)
+            if not batch:
+                break
+            self.assertLessEqual(len(batch), 16)
+            for data, gap in batch:
+                if data is not None:
+                    payloads.append(data.payload)
+        self.assertEqual(expected, payloads)
+
     def test_is_log_empty(self):
         client = self.client()
         client.append(1, "test")
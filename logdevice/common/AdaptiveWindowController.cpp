@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/AdaptiveWindowController.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "logdevice/common/checks.h"
+
+namespace facebook { namespace logdevice {
+
+constexpr double AdaptiveWindowController::kGain;
+constexpr std::chrono::milliseconds AdaptiveWindowController::kSamplingPeriod;
+constexpr std::chrono::seconds AdaptiveWindowController::kMinLatencyExpiration;
+
+AdaptiveWindowController::AdaptiveWindowController(size_t min_window,
+                                                   size_t max_window)
+    : min_window_(std::min(min_window, max_window)),
+      max_window_(max_window),
+      limit_(max_window),
+      period_min_latency_us_(std::numeric_limits<int64_t>::max()),
+      period_end_(0),
+      min_latency_(std::chrono::microseconds::max()) {
+  ld_check(max_window_ > 0);
+}
+
+void AdaptiveWindowController::onAppendCompleted(
+    std::chrono::microseconds latency) {
+  completed_.fetch_add(1, std::memory_order_relaxed);
+
+  const int64_t latency_us = latency.count();
+  int64_t cur = period_min_latency_us_.load(std::memory_order_relaxed);
+  while (latency_us < cur &&
+         !period_min_latency_us_.compare_exchange_weak(cur, latency_us)) {
+  }
+
+  const TimePoint t = now();
+  if (t.time_since_epoch().count() <
+      period_end_.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    // another thread is already closing this period
+    return;
+  }
+  recompute(t);
+}
+
+void AdaptiveWindowController::recompute(TimePoint t) {
+  if (t.time_since_epoch().count() < period_end_.load()) {
+    // period was closed by another thread while we waited for the mutex
+    return;
+  }
+
+  const uint64_t completed = completed_.exchange(0);
+  const std::chrono::microseconds period_min_latency(
+      period_min_latency_us_.exchange(std::numeric_limits<int64_t>::max()));
+  const TimePoint start = period_start_;
+  period_start_ = t;
+  period_end_.store((t + kSamplingPeriod).time_since_epoch().count());
+
+  if (start == TimePoint() || t <= start || completed == 0) {
+    // first period, nothing to estimate from yet
+    return;
+  }
+
+  if (period_min_latency < min_latency_ ||
+      t - min_latency_time_ > kMinLatencyExpiration) {
+    min_latency_ = period_min_latency;
+    min_latency_time_ = t;
+  }
+
+  // Appends completed per microsecond over the period, times the latency of
+  // an append that didn't queue. A period that started after the log was
+  // idle for a while counts the idle time too, so the window of a log that
+  // only gets occasional appends converges to the minimum.
+  const double elapsed_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(t - start).count();
+  const double bdp = completed / elapsed_us * min_latency_.count();
+  const double target = std::ceil(kGain * bdp);
+
+  limit_.store(target >= max_window_
+                   ? max_window_
+                   : std::max(min_window_, static_cast<size_t>(target)),
+               std::memory_order_relaxed);
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file
+ *
+ * Sizes the effective sliding window of an EpochSequencer, i.e. how many
+ * Appenders may be in flight at once, between a configured minimum and the
+ * log's max-writes-in-flight, from the latencies of completed appends.
+ *
+ * The window is set to a multiple of the bandwidth-delay product of the log:
+ * the rate at which appends complete times the lowest append latency seen
+ * recently, which is the latency of an append that did not queue behind
+ * others. While appends don't queue, latency stays near that minimum and the
+ * estimate, and with it the window, grows by up to kGain every sampling
+ * period. Once the copyset or the storage nodes are saturated, additional
+ * appends only add queueing delay, throughput stops growing and the window
+ * settles near kGain times what the log actually needs. Logs with little
+ * traffic shrink to the minimum.
+ *
+ * The limit is recomputed at most once per sampling period, by whichever
+ * thread completes an append first after the period ends.
+ *
+ * This class is thread-safe.
+ */
+
+class AdaptiveWindowController {
+ public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  // multiple of the bandwidth-delay product to allow in flight
+  static constexpr double kGain = 2.0;
+
+  // how often the limit is recomputed
+  static constexpr std::chrono::milliseconds kSamplingPeriod{100};
+
+  // how long the lowest observed latency is trusted before being replaced
+  // with the lowest latency of the last sampling period, so that the
+  // estimate follows changes in the network or nodeset
+  static constexpr std::chrono::seconds kMinLatencyExpiration{10};
+
+  /**
+   * @param min_window  lowest limit ever returned by getLimit()
+   * @param max_window  highest limit ever returned by getLimit(), the
+   *                    capacity of the sliding window; the initial limit
+   */
+  AdaptiveWindowController(size_t min_window, size_t max_window);
+
+  virtual ~AdaptiveWindowController() {}
+
+  /**
+   * @return  how many Appenders the sequencer should allow in flight
+   */
+  size_t getLimit() const {
+    return limit_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Called when an Appender has fully replicated its record.
+   *
+   * @param latency  time since the Appender was created
+   */
+  void onAppendCompleted(std::chrono::microseconds latency);
+
+ protected:
+  virtual TimePoint now() const {
+    return std::chrono::steady_clock::now();
+  }
+
+ private:
+  const size_t min_window_;
+  const size_t max_window_;
+
+  std::atomic<size_t> limit_;
+
+  // appends completed and lowest latency seen in the current period
+  std::atomic<uint64_t> completed_{0};
+  std::atomic<int64_t> period_min_latency_us_;
+
+  // end of the current sampling period, in steady_clock ticks
+  std::atomic<TimePoint::rep> period_end_;
+
+  // protects the state below, only taken to recompute the limit
+  std::mutex mutex_;
+  TimePoint period_start_;
+  std::chrono::microseconds min_latency_;
+  TimePoint min_latency_time_;
+
+  void recompute(TimePoint now);
+};
+
+}} // namespace facebook::logdevice
@@ -147,7 +147,9 @@ typedef AdminCommandTable<int,                       /* Shard */
                           std::chrono::milliseconds, /* Max Durable Time */
                           std::string,               /* Append Dirtied By */
                           std::string,               /* Rebuild Dirtied By */
-                          uint64_t /* Approx. Obsolete Bytes */
+                          uint64_t, /* Spare Partitions */
+                          bool,     /* Drop Pending */
+                          uint64_t  /* Approx. Obsolete Bytes */
                           >
     InfoPartitionsTable;
 
@@ -284,10 +286,22 @@ typedef AdminCommandTable<std::string, /* Column family */
                           std::string, /* More context on the iterator */
                           admin_command_table::LSN,  /* Last seek LSN */
                           std::chrono::milliseconds, /* Last seek timestamp */
-                          uint64_t /* RocksDB version after last seek */
+                          uint64_t, /* RocksDB version after last seek */
+                          uint64_t, /* Bytes read */
+                          uint64_t, /* Blocks read */
+                          uint64_t  /* Seeks */
                           >
     InfoIteratorsTable;
 
+typedef AdminCommandTable<std::string, /* More context on the iterators */
+                          bool,        /* Created for rebuilding */
+                          uint64_t,    /* Open iterators */
+                          uint64_t,    /* Bytes read */
+                          uint64_t,    /* Blocks read */
+                          uint64_t     /* Seeks */
+                          >
+    InfoIteratorsIOTable;
+
 typedef AdminCommandTable<uint64_t,    /* Shard ID */
                           bool,        /* Failing */
                           Status,      /* Accepting writes */
@@ -312,6 +326,18 @@ typedef AdminCommandTable<logid_t,                  /* Log ID */
                           >
     InfoRecordCacheTable;
 
+typedef AdminCommandTable<uint64_t, /* Shard */
+                          size_t,   /* Budget Bytes */
+                          size_t,   /* Payload Bytes */
+                          uint64_t, /* Digest Hits */
+                          uint64_t, /* Digest Misses */
+                          uint64_t, /* Seal Hits */
+                          uint64_t, /* Seal Misses */
+                          uint64_t, /* Evictions */
+                          uint64_t  /* Bytes Evicted */
+                          >
+    InfoRecordCacheShardsTable;
+
 typedef AdminCommandTable<std::string,  /* Config URI */
                           node_index_t, /* Origin Server of the config */
                           std::string,  /* Config hash */
@@ -340,7 +366,10 @@ typedef AdminCommandTable<logid_t,                  /* Delta log id */
                           size_t, /* Delta log bytes */
                           size_t, /* delta log records */
                           bool,   /* delta log read stream healthy */
-                          admin_command_table::LSN /* Propagated version */
+                          std::chrono::milliseconds, /* Snapshot tail */
+                          std::chrono::milliseconds, /* Snapshot replay */
+                          std::chrono::milliseconds, /* Delta replay */
+                          admin_command_table::LSN   /* Propagated version */
                           >
     InfoReplicatedStateMachineTable;
 
@@ -355,8 +384,10 @@ typedef AdminCommandTable<uint64_t,                  /* Shard ID */
                           logid_t,                   /* Log ID */
                           admin_command_table::LSN,  /* LSN */
                           ClientID,   /* Client that started the task */
-                          Sockaddr,   /* Address of the client */
-                          std::string /* Extra info */
+                          Sockaddr,    /* Address of the client */
+                          std::string, /* Extra info */
+                          bool,        /* Stealable */
+                          uint64_t     /* Tasks stolen from the shard */
                           >
     InfoStorageTasksTable;
 
@@ -382,6 +413,8 @@ struct InfoStorageTasksTableFieldOffsets {
   static constexpr int CLIENT_ID = 10;
   static constexpr int CLIENT_ADDRESS = 11;
   static constexpr int EXTRA_INFO = 12;
+  static constexpr int STEALABLE = 13;
+  static constexpr int SHARD_TASKS_STOLEN = 14;
 };
 
 typedef AdminCommandTable<logid_t,                  /* Log ID */
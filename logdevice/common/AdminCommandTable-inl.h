@@ -20,6 +20,7 @@
 #include <folly/dynamic.h>
 #include <folly/json.h>
 
+#include "logdevice/common/AdminCommandTableBinary.h"
 #include "logdevice/common/Sockaddr.h"
 #include "logdevice/common/libevent/EvbufferTextOutput.h"
 #include "logdevice/common/types_internal.h"
@@ -224,6 +225,48 @@ void AdminCommandTable<Args...>::printJson(EvbufferTextOutput& output,
   output.write("\r\n");
 }
 
+template <typename... Args>
+void AdminCommandTable<Args...>::printBinary(EvbufferTextOutput& output,
+                                             std::size_t max_col_) const {
+  unsigned int max_col = std::min(max_col_, numCols());
+
+  std::string buf;
+  auto append_u32 = [&](uint32_t v) {
+    buf.append(reinterpret_cast<const char*>(&v), sizeof(v));
+  };
+  auto append_str = [&](const std::string& s) {
+    append_u32(s.size());
+    buf.append(s);
+  };
+
+  // Reserve space for the prefix, filled once the size is known.
+  buf.append(admin_command_table::BINARY_PREFIX_SIZE, '\0');
+  append_u32(max_col);
+  append_u32(rows_.size());
+  for (int i = 0; i < max_col; ++i) {
+    append_str(names_[i]);
+  }
+  for (int i = 0; i < max_col; ++i) {
+    for (auto& r : rows_) {
+      if (r[i].hasValue()) {
+        append_str(r[i].value());
+      } else {
+        append_u32(admin_command_table::BINARY_NULL_VALUE);
+      }
+    }
+  }
+
+  const uint64_t size = buf.size() - admin_command_table::BINARY_PREFIX_SIZE;
+  std::memcpy(&buf[0],
+              admin_command_table::BINARY_MAGIC,
+              admin_command_table::BINARY_MAGIC_SIZE);
+  std::memcpy(
+      &buf[admin_command_table::BINARY_MAGIC_SIZE], &size, sizeof(size));
+
+  output.write(buf.data(), buf.size());
+  output.write("\r\n");
+}
+
 template <typename... Args>
 std::string AdminCommandTable<Args...>::toString(bool json,
                                                  size_t max_col_) const {
@@ -45,6 +45,10 @@
  *
  * You can also print the table in json format for easier parsing from scripts:
  * my_table.printJson(evbuffer);
+ *
+ * or in the binary format of AdminCommandTableBinary.h, which is cheaper to
+ * produce and parse for large tables:
+ * my_table.printBinary(evbuffer);
  */
 
 namespace facebook { namespace logdevice {
@@ -158,6 +162,17 @@ class AdminCommandTable {
   void printJson(EvbufferTextOutput& output,
                  std::size_t max_col_ = numCols()) const;
 
+  /**
+   * Print the table to the given evbuffer, in the columnar binary format
+   * described in AdminCommandTableBinary.h.
+   *
+   * @param output Evbuffer to print the table to.
+   * @param max_col_ Only print the first `max_col_` columns. If not provided,
+   *                 print all the columns.
+   */
+  void printBinary(EvbufferTextOutput& output,
+                   std::size_t max_col_ = numCols()) const;
+
   std::string toString(bool json = false, size_t max_col_ = numCols()) const;
 
  private:
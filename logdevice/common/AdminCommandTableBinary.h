@@ -0,0 +1,61 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <folly/Optional.h>
+
+/**
+ * @file Compact columnar binary encoding of an AdminCommandTable, written by
+ *       AdminCommandTable::printBinary() for tools such as ldquery that fetch
+ *       large tables and would otherwise spend most of their time generating
+ *       and parsing json.
+ *
+ *       Layout, integers in host byte order:
+ *
+ *         BINARY_MAGIC
+ *         uint64_t  size of the rest of the encoding, in bytes
+ *         uint32_t  number of columns
+ *         uint32_t  number of rows
+ *         for each column:
+ *           uint32_t  length of the name, followed by the name
+ *         for each column, for each row:
+ *           uint32_t  length of the value, followed by the value, or
+ *                     BINARY_NULL_VALUE if the value is not set
+ *
+ *       Values are not escaped, so readers must use the size in the header
+ *       rather than look for a terminator.
+ */
+
+namespace facebook { namespace logdevice { namespace admin_command_table {
+
+constexpr char BINARY_MAGIC[] = "LDCOLS1\n";
+constexpr size_t BINARY_MAGIC_SIZE = sizeof(BINARY_MAGIC) - 1;
+// Magic and size of the rest of the encoding.
+constexpr size_t BINARY_PREFIX_SIZE = BINARY_MAGIC_SIZE + sizeof(uint64_t);
+constexpr uint32_t BINARY_NULL_VALUE = ~uint32_t(0);
+
+/**
+ * @return  if `data` starts with a binary encoded table, its total size in
+ *          bytes. folly::none if it doesn't, or if `len` is too short to tell.
+ */
+inline folly::Optional<size_t> binaryEncodingSize(const char* data,
+                                                  size_t len) {
+  if (len < BINARY_PREFIX_SIZE ||
+      std::memcmp(data, BINARY_MAGIC, BINARY_MAGIC_SIZE) != 0) {
+    return folly::none;
+  }
+  uint64_t size;
+  std::memcpy(&size, data + BINARY_MAGIC_SIZE, sizeof(size));
+  return BINARY_PREFIX_SIZE + size;
+}
+
+}}} // namespace facebook::logdevice::admin_command_table
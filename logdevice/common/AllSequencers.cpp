@@ -23,6 +23,7 @@
 #include "logdevice/common/RecipientSet.h"
 #include "logdevice/common/SequencerBackgroundActivator.h"
 #include "logdevice/common/SequencerEnqueueReactivationRequest.h"
+#include "logdevice/common/ShardLoadTracker.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/configuration/LocalLogsConfig.h"
 #include "logdevice/common/debug.h"
@@ -69,8 +70,6 @@ AllSequencers::AllSequencers(
       processor_(processor) {
   ld_check(settings_.get());
 
-  map_.set_empty_key(LOGID_INVALID.val());
-  map_.set_deleted_key(LOGID_INVALID2.val());
   if (updateable_config_) { // might not be set if not running sequencers
     config_subscription_ = updateable_config_->subscribeToUpdates(
         std::bind(&AllSequencers::noteConfigurationChanged, this));
@@ -82,10 +81,9 @@ std::shared_ptr<Sequencer> AllSequencers::findSequencer(logid_t logid) {
     return getMetaDataLogSequencer(logid);
   }
 
-  folly::SharedMutex::ReadHolder map_lock(map_mutex_);
   // data log id
   auto it = map_.find(logid.val_);
-  if (it == map_.end()) {
+  if (it == map_.cend()) {
     err = E::NOSEQUENCER;
     return nullptr;
   }
@@ -114,25 +112,25 @@ int AllSequencers::activateSequencer(
     return -1;
   }
 
-  folly::SharedMutex::UpgradeHolder map_lock(map_mutex_);
   auto it = map_.find(logid.val_);
-  if (it != map_.end()) {
+  if (it != map_.cend()) {
     // Already have a Sequencer for this log, check state. In order to
     // avoid shutdown crashes all threads that may run activateSequencer()
     // must stop before this AllSequencers object (a subobject of Processor)
     // is destroyed on shutdown.
     seq = it->second;
-    map_lock.unlock();
   } else {
-    // no Sequencer for logid in the map, create one and insert it in the map.
-    // We shouldn't race with another thread that is also running
-    // activateSequencer() since we there can only be one thread in upgrade mode
-    // of the shared lock
-    seq = createSequencer(logid, settings_);
-    folly::SharedMutex::WriteHolder map_write_lock(std::move(map_lock));
-    auto insertion_result = map_.insert(std::make_pair(logid.val(), seq));
-
-    ld_check(insertion_result.second);
+    // no Sequencer for logid in the map, create one and insert it in the map,
+    // unless another thread running activateSequencer() got there first.
+    std::lock_guard<std::mutex> insert_lock(insert_mutex_);
+    it = map_.find(logid.val_);
+    if (it != map_.cend()) {
+      seq = it->second;
+    } else {
+      seq = createSequencer(logid, settings_);
+      auto insertion_result = map_.insert(logid.val(), seq);
+      ld_check(insertion_result.second);
+    }
   }
 
   ld_check(seq);
@@ -167,13 +165,19 @@ int AllSequencers::getEpochMetaData(
   // check_metadata_log_before_provisioning will only be false if we're
   // activating sequencers on startup, since it's not possible to read the
   // metadata log at that point.
+  NodeSetSelector::Options selector_options;
+  if (settings_->load_aware_nodeset_selection) {
+    selector_options.shard_load = processor_->shardLoadTracker().getLoads(
+        settings_->nodeset_load_report_ttl);
+  }
   int rv = epoch_store_->createOrUpdateMetaData(
       logid,
       std::make_shared<EpochMetaDataUpdateToNextEpoch>(
           cfg,
           acceptable_activation_epoch,
           settings_->epoch_metadata_use_new_storage_set_format,
-          /*provision_if_empty=*/!check_metadata_log_before_provisioning),
+          /*provision_if_empty=*/!check_metadata_log_before_provisioning,
+          std::move(selector_options)),
       nextEpochCF,
       std::move(tracer),
       EpochStore::WriteNodeID::MY);
@@ -908,14 +912,8 @@ void AllSequencers::noteConfigurationChanged() {
   ld_check(node_cfg);
 
   std::vector<logid_t> log_ids;
-  {
-    folly::stop_watch<std::chrono::milliseconds> watch;
-    folly::SharedMutex::ReadHolder map_lock(map_mutex_);
-    uint64_t lock_ms = watch.lap().count();
-    for (auto const& x : map_) {
-      log_ids.push_back(logid_t(x.first));
-    }
-    ld_info("Acquiring lock for sequencer map took %lums", lock_ms);
+  for (auto const& x : map_) {
+    log_ids.push_back(logid_t(x.first));
   }
   if (!log_ids.empty()) {
     std::unique_ptr<Request> rq =
@@ -926,23 +924,21 @@ void AllSequencers::noteConfigurationChanged() {
 }
 
 void AllSequencers::shutdown() {
-  folly::SharedMutex::ReadHolder map_lock(map_mutex_);
   for (auto const& x : map_) {
     x.second->shutdown();
   }
 }
 
-AllSequencers::Accessor::Accessor(AllSequencers* owner)
-    : owner_(owner), map_lock_(owner_->map_mutex_) {}
+AllSequencers::Accessor::Accessor(AllSequencers* owner) : owner_(owner) {}
 
 AllSequencers::Accessor AllSequencers::accessAll() {
   return Accessor(this);
 }
 AllSequencers::Accessor::Iterator AllSequencers::Accessor::begin() {
-  return Iterator(owner_->map_.begin());
+  return Iterator(owner_->map_.cbegin());
 }
 AllSequencers::Accessor::Iterator AllSequencers::Accessor::end() {
-  return Iterator(owner_->map_.end());
+  return Iterator(owner_->map_.cend());
 }
 
 std::shared_ptr<Sequencer>
@@ -974,7 +970,6 @@ AllSequencers::getMetaDataLogSequencer(logid_t datalog_id) {
 }
 
 void AllSequencers::disableAllSequencersDueToIsolation() {
-  folly::SharedMutex::ReadHolder map_lock(map_mutex_);
   for (const auto& x : map_) {
     x.second->onNodeIsolated();
   }
@@ -10,10 +10,10 @@
 #include <chrono>
 #include <functional>
 #include <memory>
+#include <mutex>
 
 #include <boost/iterator/iterator_facade.hpp>
-#include <folly/SharedMutex.h>
-#include <google/dense_hash_map>
+#include <folly/concurrency/ConcurrentHashMap.h>
 
 #include "logdevice/common/EpochStore.h"
 #include "logdevice/common/MetaDataLog.h"
@@ -42,11 +42,16 @@ class Processor;
 
 class AllSequencers {
  public:
-  using SequencerMap = google::dense_hash_map<logid_t::raw_type,
-                                              std::shared_ptr<Sequencer>,
-                                              Hash64<logid_t::raw_type>>;
+  // Lookups take no locks: the map protects its nodes with hazard pointers.
+  // Sequencers are never removed from the map and never replaced, so the
+  // std::shared_ptr in a node can be copied without synchronization.
+  using SequencerMap = folly::ConcurrentHashMap<logid_t::raw_type,
+                                                std::shared_ptr<Sequencer>,
+                                                Hash64<logid_t::raw_type>>;
 
   // An object used to access the contents of the map of sequencers.
+  // Iteration sees the sequencers that exist when it starts and may or may not
+  // see the ones created concurrently.
   class Accessor {
    public:
     // Iterator, along with begin() and end() methods, required to
@@ -56,7 +61,8 @@ class AllSequencers {
                                         Sequencer,
                                         boost::forward_traversal_tag> {
      public:
-      explicit Iterator(SequencerMap::iterator iter) : iter_(iter) {}
+      explicit Iterator(SequencerMap::ConstIterator iter)
+          : iter_(std::move(iter)) {}
       bool equal(const Iterator& rhs) const {
         return iter_ == rhs.iter_;
       }
@@ -68,7 +74,7 @@ class AllSequencers {
       }
 
      private:
-      SequencerMap::iterator iter_;
+      SequencerMap::ConstIterator iter_;
     };
 
     explicit Accessor(AllSequencers* owner);
@@ -78,7 +84,6 @@ class AllSequencers {
 
    private:
     AllSequencers* owner_;
-    folly::SharedMutex::ReadHolder map_lock_;
   };
 
   /**
@@ -367,18 +372,9 @@ class AllSequencers {
   virtual StatsHolder* getStats() const;
 
  private:
-  // Protects map_ and the std::shared_ptr objects within map_.
-  //
-  // A single instance of std::shared_ptr isn't read/write safe
-  // from multiple threads. Since we already use a mutex to serialize
-  // concurrent read/write access to map_, it is natural to just continue
-  // to hold that mutex after lookup while updating, or instantiating a
-  // thread local copy of, the contained std::shared_ptrs.
-  //
-  // NOTE: If we see contention on this mutex, sharding the map should
-  //       be an easy remedy (assuming the contention is not on specific
-  //       logs).
-  folly::SharedMutex map_mutex_;
+  // Serializes insertions into map_, so that only one Sequencer is ever
+  // created for a log. Lookups don't need it.
+  std::mutex insert_mutex_;
   SequencerMap map_;
 
   // cluster config used by the Processor that owns this object
@@ -106,9 +106,12 @@ AppendRequest::AppendRequest(AppendRequest&& other) noexcept
       router_(std::make_unique<SequencerRouter>(record_.logid, this)),
       sequencer_node_(std::move(other.sequencer_node_)),
       sequencer_router_flags_(std::move(other.sequencer_router_flags_)),
+      hashed_worker_(std::move(other.hashed_worker_)),
       append_probe_controller_(std::move(other.append_probe_controller_)),
+      log_worker_migrations_(std::move(other.log_worker_migrations_)),
       tracer_(std::move(other.tracer_)),
       buffered_writer_blob_flag_(std::move(other.buffered_writer_blob_flag_)),
+      batch_with_other_appends_(std::move(other.batch_with_other_appends_)),
       bypass_write_token_check_(std::move(other.bypass_write_token_check_)),
       append_redirected_to_dead_node_(
           std::move(other.append_redirected_to_dead_node_)) {
@@ -138,10 +141,11 @@ AppendRequest::~AppendRequest() {
   Status client_status = translateInternalError(status_);
 
   StatsHolder* stats = w->stats();
-  bumpStatForOutcome(stats, client_status);
-  bumpPerNodeStatForOutcome(stats, client_status);
-
   auto latency_usec = usec_since(creation_time_);
+
+  bumpStatForOutcome(stats, client_status);
+  bumpPerNodeStatForOutcome(
+      stats, client_status, std::chrono::microseconds(latency_usec));
   if (stats) {
     if (client_status == E::OK) {
       CLIENT_HISTOGRAM_ADD(stats, append_latency, latency_usec);
@@ -183,6 +187,33 @@ Request::Execution AppendRequest::execute() {
   // milliseconds pass
   setupTimer();
 
+  if (log_worker_migrations_ && hashed_worker_.val_ >= 0) {
+    auto& appends = Worker::onThisThread()->runningAppends();
+    if (target_worker_ != hashed_worker_) {
+      if (log_worker_migrations_->isHandingOver(
+              record_.logid, hashed_worker_)) {
+        // Requests for the log may still be queued on the Worker it was
+        // migrated from, wait for them to execute first.
+        appends.held_for_handover[record_.logid].push_back(id_);
+        WORKER_STAT_INCR(log_worker_handover_held_appends);
+        return Execution::CONTINUE;
+      }
+    } else if (getSettings().log_worker_migration_load_skew > 0) {
+      ++appends.appends_per_log[record_.logid];
+    }
+  }
+
+  start();
+
+  // ownership was already transferred to runningAppends
+  return Execution::CONTINUE;
+}
+
+void AppendRequest::resumeAfterHandover() {
+  start();
+}
+
+void AppendRequest::start() {
   if (request_span_) {
     // start span for tracing the execution flow of the append
     request_execution_span_ = e2e_tracer_->StartSpan(
@@ -196,9 +227,6 @@ Request::Execution AppendRequest::execute() {
   } else {
     fetchLogConfig();
   }
-
-  // ownership was already transferred to runningAppends
-  return Execution::CONTINUE;
 }
 
 void AppendRequest::setupTimer() {
@@ -253,7 +281,20 @@ void AppendRequest::onLogConfigAvailable(
 }
 
 void AppendRequest::onWriteTokenCheckDone() {
-  router_->start();
+  if (isBackingOff(record_.logid)) {
+    // The sequencer recently rejected an append to this log because the log
+    // is over its rate limit. Don't add to the load until the retry delay it
+    // gave has elapsed.
+    WORKER_STAT_INCR(append_failed_backing_off);
+    destroyWithStatus(E::SEQNOBUFS);
+    return;
+  }
+
+  if (getSettings().use_sequencer_location_cache) {
+    router_->startWithHint(getCachedSequencer(record_.logid));
+  } else {
+    router_->start();
+  }
 }
 
 void AppendRequest::onSequencerKnown(NodeID dest,
@@ -447,6 +488,13 @@ void AppendRequest::sendAppendMessage() {
     append_message_sent_span->Finish();
   };
 
+  if (batch_with_other_appends_ && enqueueAppendForBatch(msg, dest)) {
+    if (append_message_sent_span) {
+      set_status_span_tag("batched");
+    }
+    return;
+  }
+
   int rv = sender_->sendMessage(std::move(msg), dest, &on_socket_close_);
   if (rv != 0) {
     handleMessageSendError(MessageType::APPEND, err, dest);
@@ -577,6 +625,8 @@ void AppendRequest::onReplyReceived(const APPENDED_Header& reply,
         record_.attrs.timestamp = reply.timestamp.toMilliseconds();
       }
       updateSeenEpoch(record_.logid, lsn_to_epoch(reply.lsn));
+      updateCachedSequencer(
+          record_.logid, from.asNodeID(), lsn_to_epoch(reply.lsn));
       FOLLY_FALLTHROUGH;
     case E::BADPAYLOAD:
     case E::NOSPC:
@@ -603,6 +653,7 @@ void AppendRequest::onReplyReceived(const APPENDED_Header& reply,
       // will indeed do), as it indicates that other nodes haven't picked up
       // that this one is not available; however, that should be rare in a
       // healthy cluster.
+      forgetCachedSequencer(record_.logid, from.asNodeID());
       router_->onNodeUnavailable(from.id_.node_, status_);
       return;
     case E::PREEMPTED:
@@ -633,6 +684,7 @@ void AppendRequest::onReplyReceived(const APPENDED_Header& reply,
         // the server cannot handle the situation itself and reactivate the
         // sequencer.
         // we also mark the node as dead in the cluster state.
+        forgetCachedSequencer(record_.logid, reply.redirect);
         router_->onDeadNode(reply.redirect, E::DISABLED);
       } else {
         // Request was redirected to or preempted by a seq running on
@@ -643,6 +695,7 @@ void AppendRequest::onReplyReceived(const APPENDED_Header& reply,
         // the throttle so that we attempt to establish connection.
         resetServerSocketConnectThrottle(reply.redirect);
         redirect = reply.redirect;
+        updateCachedSequencer(record_.logid, redirect, EPOCH_INVALID);
       }
       router_->onRedirected(from.id_.node_, redirect, status_);
       return;
@@ -756,6 +809,7 @@ void AppendRequest::noReply(Status st, const Address& to, bool request_sent) {
   }
 
   // mark the node as dead
+  forgetCachedSequencer(record_.logid, to.asNodeID());
   router_->onDeadNode(to.asNodeID(), status_);
 
   destroy();
@@ -855,6 +909,75 @@ void AppendRequest::updateSeenEpoch(logid_t log_id, epoch_t seen_epoch) {
   }
 }
 
+bool AppendRequest::enqueueAppendForBatch(std::unique_ptr<APPEND_Message>& msg,
+                                          NodeID to) {
+  return Worker::onThisThread()->runningAppends().enqueueAppendForBatch(
+      msg, to, on_socket_close_);
+}
+
+NodeID AppendRequest::getCachedSequencer(logid_t log) const {
+  auto& sequencers = Worker::onThisThread()->appendRequestEpochMap().sequencers;
+
+  auto it = sequencers.find(log);
+  return it != sequencers.end() ? it->second.node : NodeID();
+}
+
+void AppendRequest::updateCachedSequencer(logid_t log,
+                                          NodeID node,
+                                          epoch_t epoch) {
+  ld_check(node.isNodeID());
+  auto& sequencers = Worker::onThisThread()->appendRequestEpochMap().sequencers;
+
+  auto it = sequencers.find(log);
+  if (it == sequencers.end()) {
+    sequencers.insert(std::make_pair(
+        log, AppendRequestEpochMap::CachedSequencer{node, epoch}));
+  } else if (epoch == EPOCH_INVALID) {
+    // Redirects don't carry an epoch, but they always point to a sequencer
+    // that's at least as recent as the one that redirected us.
+    it->second.node = node;
+  } else if (epoch >= it->second.epoch) {
+    it->second = AppendRequestEpochMap::CachedSequencer{node, epoch};
+  }
+}
+
+void AppendRequest::forgetCachedSequencer(logid_t log, NodeID node) {
+  auto& sequencers = Worker::onThisThread()->appendRequestEpochMap().sequencers;
+
+  auto it = sequencers.find(log);
+  if (it != sequencers.end() && it->second.node == node) {
+    sequencers.erase(it);
+  }
+}
+
+bool AppendRequest::isBackingOff(logid_t log) const {
+  auto& backoff_until =
+      Worker::onThisThread()->appendRequestEpochMap().backoff_until;
+
+  auto it = backoff_until.find(log);
+  if (it == backoff_until.end()) {
+    return false;
+  }
+  if (it->second <= std::chrono::steady_clock::now()) {
+    backoff_until.erase(it);
+    return false;
+  }
+  return true;
+}
+
+void AppendRequest::backOff(logid_t log, std::chrono::milliseconds delay) {
+  auto& backoff_until =
+      Worker::onThisThread()->appendRequestEpochMap().backoff_until;
+
+  const auto until = std::chrono::steady_clock::now() + delay;
+  auto& entry = backoff_until[log];
+  entry = std::max(entry, until);
+}
+
+void AppendRequest::onRetryDelayReceived(std::chrono::milliseconds delay) {
+  backOff(record_.logid, delay);
+}
+
 void AppendRequest::SocketClosedCallback::operator()(Status st,
                                                      const Address& name) {
   // notify AppendRequest of failure so that it can quickly unblock the client
@@ -938,13 +1061,18 @@ void AppendRequest::bumpStatForOutcome(StatsHolder* stats, Status status) {
   }
 }
 
-void AppendRequest::bumpPerNodeStatForOutcome(StatsHolder* stats,
-                                              Status status) {
+void AppendRequest::bumpPerNodeStatForOutcome(
+    StatsHolder* stats,
+    Status status,
+    std::chrono::microseconds latency) {
   if (!sequencer_node_.isNodeID()) {
     // no sequencer node to register stats for
     return;
   }
-  if (shouldAddAppendSuccess(status)) {
+  if (isSlowAppend(status, latency)) {
+    PER_NODE_STAT_ADD(stats, sequencer_node_, AppendFail);
+    STAT_INCR(stats, client.append_slow_reported_as_failed);
+  } else if (shouldAddAppendSuccess(status)) {
     PER_NODE_STAT_ADD(stats, sequencer_node_, AppendSuccess);
   } else if (shouldAddAppendFail(status)) {
     PER_NODE_STAT_ADD(stats, sequencer_node_, AppendFail);
@@ -955,6 +1083,14 @@ bool AppendRequest::shouldAddAppendSuccess(Status status) {
   return status == Status::OK;
 }
 
+bool AppendRequest::isSlowAppend(Status status,
+                                 std::chrono::microseconds latency) {
+  auto threshold =
+      getSettings().sequencer_boycotting.node_stats_slow_append_threshold;
+  return shouldAddAppendSuccess(status) &&
+      threshold > std::chrono::milliseconds::zero() && latency > threshold;
+}
+
 bool AppendRequest::shouldAddAppendFail(Status status) {
   switch (status) {
     case Status::TIMEDOUT:
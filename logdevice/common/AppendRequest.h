@@ -25,6 +25,7 @@
 #include "logdevice/common/AppendRequestBase.h"
 #include "logdevice/common/ClientAppendTracer.h"
 #include "logdevice/common/ClientBridge.h"
+#include "logdevice/common/LogWorkerMigrations.h"
 #include "logdevice/common/NodeID.h"
 #include "logdevice/common/Request.h"
 #include "logdevice/common/RequestType.h"
@@ -55,6 +56,24 @@ class StatsHolder;
 // Wrapper instead of typedef to allow forward-declaring in Worker.h
 struct AppendRequestEpochMap {
   std::unordered_map<logid_t, epoch_t, logid_t::Hash> map;
+
+  struct CachedSequencer {
+    NodeID node;
+    // Lower bound on the epoch of the sequencer running on `node'. Replies
+    // about older epochs don't override the entry.
+    epoch_t epoch;
+  };
+  // Node that most recently ran the sequencer for the log, as learned from
+  // APPENDED replies and redirects.
+  std::unordered_map<logid_t, CachedSequencer, logid_t::Hash> sequencers;
+
+  // Time until which appends to the log fail without being sent, because the
+  // sequencer rejected an append over the log's rate limit and asked to back
+  // off.
+  std::unordered_map<logid_t,
+                     std::chrono::steady_clock::time_point,
+                     logid_t::Hash>
+      backoff_until;
 };
 
 /**
@@ -99,14 +118,30 @@ class AppendRequest : public AppendRequestBase,
   // see Request.h
   int getThreadAffinity(int nthreads) override {
     if (target_worker_.val_ < 0) {
-      target_worker_.val_ =
+      hashed_worker_.val_ =
           folly::hash::hash_combine(
               AppendRequest::clientThreadId, record_.logid.val_) %
           nthreads;
+      target_worker_ = log_worker_migrations_
+          ? log_worker_migrations_->route(record_.logid, hashed_worker_)
+          : hashed_worker_;
     }
     return target_worker_.val_;
   }
 
+  /**
+   * Called on the Worker the log of this request was migrated to once the
+   * handover from the Worker the request hashes to is complete, if execute()
+   * held the request until then.
+   */
+  void resumeAfterHandover();
+
+  // Worker that getThreadAffinity() hashed this request to, -1 if the target
+  // Worker was set explicitly.
+  worker_id_t getHashedWorker() const {
+    return hashed_worker_;
+  }
+
   /**
    * Called when Configuration::getLogByIDAsync() returns with the log config.
    */
@@ -117,6 +152,7 @@ class AppendRequest : public AppendRequestBase,
   void onSequencerRoutingFailure(Status status) override;
 
   void onProbeSendError(Status st, NodeID to) override;
+  void onRetryDelayReceived(std::chrono::milliseconds delay) override;
   void onProbeReply(const APPEND_PROBE_REPLY_Header& reply,
                     const Address& from) override;
 
@@ -170,6 +206,13 @@ class AppendRequest : public AppendRequestBase,
     return buffered_writer_blob_flag_;
   }
 
+  // Lets the APPEND go in an APPENDS message together with the APPENDs of
+  // other AppendRequests sent to the same node in the same event loop
+  // iteration. Set by Client::appendMulti().
+  void setBatchWithOtherAppends() {
+    batch_with_other_appends_ = true;
+  }
+
   void setFailedToPost() {
     failed_to_post_ = true;
   }
@@ -196,6 +239,12 @@ class AppendRequest : public AppendRequestBase,
     append_probe_controller_ = ptr;
   }
 
+  // Lets getThreadAffinity() route the request to the Worker its log was
+  // migrated to.
+  void setLogWorkerMigrations(LogWorkerMigrations* ptr) {
+    log_worker_migrations_ = ptr;
+  }
+
   // Two convenience methods to be used with traffic shadowing
   logid_t getRecordLogID() const {
     return record_.logid;
@@ -263,6 +312,9 @@ class AppendRequest : public AppendRequestBase,
   // complete.
   virtual void setupTimer();
 
+  // Kicks off the state machine once the request is registered.
+  void start();
+
   // Request the config for the log being appended to, currently just to check
   // if the write should be allowed
   virtual void fetchLogConfig();
@@ -276,6 +328,30 @@ class AppendRequest : public AppendRequestBase,
   // log.
   virtual void updateSeenEpoch(logid_t log_id, epoch_t seen_epoch);
 
+  // Returns the node that most recently ran the sequencer for the log, as
+  // learned by this Worker, or an invalid NodeID if there is none.
+  virtual NodeID getCachedSequencer(logid_t log) const;
+
+  // Records that `node' runs the sequencer for the log in epoch `epoch' or
+  // higher, unless a higher epoch is already known. EPOCH_INVALID means that
+  // the epoch is unknown (e.g. for redirects), which always replaces the node.
+  virtual void updateCachedSequencer(logid_t log, NodeID node, epoch_t epoch);
+
+  // Forgets the cached sequencer of the log if it is `node', which turned out
+  // to be unable to take appends.
+  virtual void forgetCachedSequencer(logid_t log, NodeID node);
+
+  // Returns true if the sequencer of the log asked this Worker to back off
+  // and the retry delay hasn't elapsed yet.
+  virtual bool isBackingOff(logid_t log) const;
+
+  // Makes appends to the log fail locally for `delay'.
+  virtual void backOff(logid_t log, std::chrono::milliseconds delay);
+
+  // See AppendRequestMap::enqueueAppendForBatch().
+  virtual bool enqueueAppendForBatch(std::unique_ptr<APPEND_Message>& msg,
+                                     NodeID to);
+
   // Proxy for AppendRequestBase::destroy() that, if `status' is anything
   // besides E::UNKNOWN, also sets the status that'll be reported to the user.
   virtual void destroyWithStatus(Status status) {
@@ -324,6 +400,9 @@ class AppendRequest : public AppendRequestBase,
   // called, this is set by getThreadAffinity() the first time it is called.
   worker_id_t target_worker_{-1};
 
+  // See getHashedWorker().
+  worker_id_t hashed_worker_{-1};
+
   // If this is a redirection of an append previously sent to another sequencer,
   // this is the LSN generated there.  Used for removing silent duplicates.
   lsn_t previous_lsn_{LSN_INVALID};
@@ -347,6 +426,8 @@ class AppendRequest : public AppendRequestBase,
 
   AppendProbeController* append_probe_controller_ = nullptr;
 
+  LogWorkerMigrations* log_worker_migrations_ = nullptr;
+
   // Client-side append tracer
   ClientAppendTracer tracer_;
 
@@ -368,6 +449,9 @@ class AppendRequest : public AppendRequestBase,
   // flag set in APPEND_Header.
   bool buffered_writer_blob_flag_ = false;
 
+  // See setBatchWithOtherAppends().
+  bool batch_with_other_appends_ = false;
+
   bool bypass_write_token_check_ = false;
 
   // keeps track of whether the append response had the REDIRECT_NOT_ALIVE flag
@@ -419,7 +503,10 @@ class AppendRequest : public AppendRequestBase,
   Status translateInternalError(Status status);
 
   // used to bump the per-node stats for the sequencer node, given the status
-  void bumpPerNodeStatForOutcome(StatsHolder* holder, Status status);
+  // and latency of the append
+  void bumpPerNodeStatForOutcome(StatsHolder* holder,
+                                 Status status,
+                                 std::chrono::microseconds latency);
 
   /**
    * these functions will return true if the corresponding stat should
@@ -428,6 +515,11 @@ class AppendRequest : public AppendRequestBase,
   bool shouldAddAppendSuccess(Status status);
   bool shouldAddAppendFail(Status status);
 
+  // Returns true if the append succeeded but took longer than
+  // node-stats-slow-append-threshold, in which case it is reported as failed
+  // in the per-node stats.
+  bool isSlowAppend(Status status, std::chrono::microseconds latency);
+
   friend class AppendRequestTest;
 };
 
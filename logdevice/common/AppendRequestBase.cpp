@@ -7,7 +7,13 @@
  */
 #include "AppendRequestBase.h"
 
+#include "logdevice/common/Sender.h"
+#include "logdevice/common/Socket.h"
+#include "logdevice/common/Timer.h"
 #include "logdevice/common/Worker.h"
+#include "logdevice/common/protocol/APPENDS_Message.h"
+#include "logdevice/common/protocol/APPEND_Message.h"
+#include "logdevice/common/settings/Settings.h"
 
 namespace facebook { namespace logdevice {
 
@@ -25,4 +31,82 @@ void AppendRequestBase::destroy() {
   runningAppends.erase(it);
 }
 
+AppendRequestMap::AppendRequestMap() = default;
+
+AppendRequestMap::~AppendRequestMap() = default;
+
+bool AppendRequestMap::enqueueAppendForBatch(
+    std::unique_ptr<APPEND_Message>& msg,
+    NodeID to,
+    SocketCallback& onclose) {
+  Worker* w = Worker::onThisThread();
+  const size_t max_bytes = Worker::settings().max_payload_size;
+  const size_t payload_bytes = msg->getPayloadSize();
+
+  // The protocol of the connection must be known to support APPENDS. APPENDs
+  // sent before the handshake completes go in APPEND messages.
+  Socket* socket = w->sender().findServerSocket(to.index());
+  if (socket == nullptr || !socket->isHandshaken() ||
+      socket->getProto() < Compatibility::APPENDS_MESSAGE_SUPPORT) {
+    return false;
+  }
+  if (w->sender().registerOnSocketClosed(Address(to), onclose) != 0) {
+    return false;
+  }
+
+  auto it = open_append_batches_.find(to.index());
+  if (it != open_append_batches_.end() &&
+      append_batches_[it->second].payload_bytes + payload_bytes > max_bytes) {
+    open_append_batches_.erase(it);
+    it = open_append_batches_.end();
+  }
+  if (it == open_append_batches_.end()) {
+    it = open_append_batches_.emplace(to.index(), append_batches_.size()).first;
+    append_batches_.emplace_back();
+    append_batches_.back().to = to;
+  }
+
+  AppendBatch& batch = append_batches_[it->second];
+  batch.appends.push_back(std::move(msg));
+  batch.payload_bytes += payload_bytes;
+
+  if (!append_flush_timer_) {
+    append_flush_timer_ =
+        std::make_unique<Timer>([this] { flushAppendBatches(); });
+  }
+  if (!append_flush_timer_->isActive()) {
+    append_flush_timer_->activate(std::chrono::microseconds(0));
+  }
+  return true;
+}
+
+void AppendRequestMap::flushAppendBatches() {
+  auto batches = std::move(append_batches_);
+  append_batches_.clear();
+  open_append_batches_.clear();
+  for (auto& batch : batches) {
+    sendAppendBatch(std::move(batch));
+  }
+}
+
+void AppendRequestMap::sendAppendBatch(AppendBatch batch) {
+  ld_check(!batch.appends.empty());
+  Worker* w = Worker::onThisThread();
+  std::unique_ptr<Message> msg;
+  if (batch.appends.size() == 1) {
+    // Nothing to batch the APPEND with, send it as is.
+    msg = std::move(batch.appends.front());
+  } else {
+    msg = std::make_unique<APPENDS_Message>(std::move(batch.appends));
+  }
+  int rv = w->sender().sendMessage(std::move(msg), batch.to);
+  if (rv != 0) {
+    // The message wasn't sent, so the messaging layer won't call onSent().
+    // Report the error to the AppendRequests the same way as if sending had
+    // failed later.
+    w->message_dispatch_->onSent(
+        *msg, err, Address(batch.to), SteadyTimestamp::now());
+  }
+}
+
 }} // namespace facebook::logdevice
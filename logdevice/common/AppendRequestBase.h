@@ -7,10 +7,15 @@
  */
 #pragma once
 
+#include <chrono>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
+#include "logdevice/common/NodeID.h"
 #include "logdevice/common/Request.h"
 #include "logdevice/include/Err.h"
+#include "logdevice/include/types.h"
 
 /**
  * @file Base class for different type of append state machines:
@@ -28,14 +33,70 @@ namespace facebook { namespace logdevice {
 struct Address;
 struct APPENDED_Header;
 struct APPEND_PROBE_REPLY_Header;
+class APPEND_Message;
 class AppendRequestBase;
+class SocketCallback;
+class Timer;
 
 // Wrapper instead of typedef to allow forward-declaring in Worker.h
 struct AppendRequestMap {
+  AppendRequestMap();
+  ~AppendRequestMap();
+
   std::unordered_map<request_id_t,
                      std::unique_ptr<AppendRequestBase>,
                      request_id_t::Hash>
       map;
+
+  // Number of appends executed per log since the Worker last reported its
+  // load, counted while Settings::log_worker_migration_load_skew is set. The
+  // hottest log is the one migrated if the Worker is overloaded.
+  std::unordered_map<logid_t, uint64_t, logid_t::Hash> appends_per_log;
+
+  // Ids of AppendRequests for logs migrated to this Worker that wait for the
+  // handover from the Worker they hash to, see LogWorkerMigrations.
+  std::unordered_map<logid_t, std::vector<request_id_t>, logid_t::Hash>
+      held_for_handover;
+
+  /**
+   * Queues an APPEND that an AppendRequest sends to `to`, to be sent in an
+   * APPENDS message together with the other APPENDs that AppendRequests of
+   * this Worker send to the same node. Batches are sent at the end of the
+   * current event loop iteration. Once a batch holds Settings::max_payload_size
+   * bytes of payload, further APPENDs for the node go in a new batch.
+   *
+   * `onclose` is registered on the socket to `to` right away, as if it had
+   * been passed to Sender::sendMessage().
+   *
+   * @return true if `msg` was queued and moved from. The outcome of sending
+   *         it is reported to the AppendRequest through
+   *         APPEND_Message::onSent(), as usual. false if the connection to
+   *         `to` is not handshaken with a protocol that supports APPENDS
+   *         messages, in which case the caller should send the APPEND_Message
+   *         itself.
+   */
+  bool enqueueAppendForBatch(std::unique_ptr<APPEND_Message>& msg,
+                             NodeID to,
+                             SocketCallback& onclose);
+
+ private:
+  struct AppendBatch {
+    NodeID to;
+    std::vector<std::unique_ptr<APPEND_Message>> appends;
+    size_t payload_bytes{0};
+  };
+
+  // Sends all the batches accumulated in append_batches_.
+  void flushAppendBatches();
+  void sendAppendBatch(AppendBatch batch);
+
+  // Batches in the order of their first APPEND.
+  std::vector<AppendBatch> append_batches_;
+  // Node index -> index in append_batches_ of the batch still taking APPENDs
+  // for that node.
+  std::unordered_map<node_index_t, size_t> open_append_batches_;
+  // Zero-delay timer flushing append_batches_.
+  std::unique_ptr<Timer> append_flush_timer_;
 };
 
 // Used in e2e tracing when we need to know the source of the reply message
@@ -71,6 +132,11 @@ class AppendRequestBase : public Request {
    * APPEND_PROBE::onSent() calls this in case of an error.
    */
   virtual void onProbeSendError(Status st, NodeID to) = 0;
+  /**
+   * Called before onReplyReceived() when the APPENDED message rejecting the
+   * append carries a retry delay (see APPENDED_Header::INCLUDES_RETRY_DELAY).
+   */
+  virtual void onRetryDelayReceived(std::chrono::milliseconds /*delay*/) {}
 
  protected:
   // Inserts this AppendRequest to Worker's runningAppends map, transferring
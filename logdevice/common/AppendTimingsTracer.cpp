@@ -0,0 +1,45 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/AppendTimingsTracer.h"
+
+#include "logdevice/common/TraceLogger.h"
+#include "logdevice/common/TraceSample.h"
+
+namespace facebook { namespace logdevice {
+
+AppendTimingsTracer::AppendTimingsTracer(std::shared_ptr<TraceLogger> logger)
+    : SampledTracer(std::move(logger)) {}
+
+void AppendTimingsTracer::traceAppendTimings(logid_t log_id,
+                                             lsn_t lsn,
+                                             size_t payload_size,
+                                             uint32_t waves,
+                                             int64_t latency_usec,
+                                             const AppendTimings& timings) {
+  auto sample_builder = [&]() -> std::unique_ptr<TraceSample> {
+    auto sample = std::make_unique<TraceSample>();
+    sample->addIntValue("log_id", log_id.val());
+    sample->addIntValue("lsn", lsn);
+    sample->addIntValue("payload_size", payload_size);
+    sample->addIntValue("waves", waves);
+    sample->addIntValue("latency_us", latency_usec);
+    sample->addIntValue("admission_us", timings.admission_usec);
+    sample->addIntValue("retry_us", timings.retry_usec);
+    sample->addIntValue("network_us", timings.network_usec);
+    sample->addNormalValue("storage_shard", timings.storage_shard.toString());
+    sample->addIntValue("storage_worker_us", timings.storage.worker_usec);
+    sample->addIntValue("storage_queue_us", timings.storage.queue_usec);
+    sample->addIntValue("storage_write_us", timings.storage.write_usec);
+    sample->addIntValue("storage_sync_us", timings.storage.sync_usec);
+    sample->addIntValue("storage_reply_us", timings.storage.reply_usec);
+    return sample;
+  };
+  publish(APPEND_TIMINGS_TRACER, sample_builder);
+}
+
+}} // namespace facebook::logdevice
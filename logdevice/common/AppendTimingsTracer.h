@@ -0,0 +1,62 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+
+#include "logdevice/common/SampledTracer.h"
+#include "logdevice/common/ShardID.h"
+#include "logdevice/common/protocol/STORED_Message.h"
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+class TraceLogger;
+
+constexpr auto APPEND_TIMINGS_TRACER = "append_timings";
+
+/**
+ * Where the time of an append went, from the sequencer's point of view. Only
+ * collected for the appends sampled by the append-timings-sample-rate
+ * setting. All durations are in microseconds.
+ */
+struct AppendTimings {
+  // from the Appender being created to it being started, i.e. waiting for
+  // the sequencer to be activated and for room in the sliding window
+  int64_t admission_usec;
+  // from the Appender being started to sending the wave that completed the
+  // append, i.e. the time spent on the waves that timed out or failed
+  int64_t retry_usec;
+  // the part of the round trip of the slowest STORE of the completing wave
+  // that wasn't spent on the storage node: sending the STORE (including
+  // waiting for bandwidth or batching), the network and receiving the STORED
+  int64_t network_usec;
+  // how the slowest storage node of the completing wave spent its time
+  STORED_Timings storage;
+  // shard that sent the last STORED needed to complete the append
+  ShardID storage_shard;
+};
+
+class AppendTimingsTracer : public SampledTracer {
+ public:
+  explicit AppendTimingsTracer(std::shared_ptr<TraceLogger> logger);
+
+  // Appends are already sampled by the append-timings-sample-rate setting.
+  folly::Optional<double> getDefaultSamplePercentage() const override {
+    return 100;
+  }
+
+  void traceAppendTimings(logid_t log_id,
+                          lsn_t lsn,
+                          size_t payload_size,
+                          uint32_t waves,
+                          int64_t latency_usec,
+                          const AppendTimings& timings);
+};
+
+}} // namespace facebook::logdevice
@@ -12,10 +12,12 @@
 #include <alloca.h>
 #include <cstdlib>
 
+#include <folly/Random.h>
 #include <opentracing/tracer.h>
 
 #include "logdevice/common/Address.h"
 #include "logdevice/common/AppendRequest.h"
+#include "logdevice/common/AppendTimingsTracer.h"
 #include "logdevice/common/AppenderTracer.h"
 #include "logdevice/common/Checksum.h"
 #include "logdevice/common/ClusterState.h"
@@ -23,19 +25,24 @@
 #include "logdevice/common/EpochSequencer.h"
 #include "logdevice/common/LocalLogStoreRecordFormat.h"
 #include "logdevice/common/MetaDataLogWriter.h"
+#include "logdevice/common/ObjectPool.h"
 #include "logdevice/common/PayloadHolder.h"
 #include "logdevice/common/PeriodicReleases.h"
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/Sender.h"
 #include "logdevice/common/Sequencer.h"
+#include "logdevice/common/ShardLoadTracker.h"
+#include "logdevice/common/Socket.h"
 #include "logdevice/common/TailRecord.h"
 #include "logdevice/common/TraceLogger.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/protocol/APPENDED_Message.h"
 #include "logdevice/common/protocol/DELETE_Message.h"
+#include "logdevice/common/protocol/RELEASES_Message.h"
 #include "logdevice/common/protocol/RELEASE_Message.h"
 #include "logdevice/common/protocol/STORED_Message.h"
+#include "logdevice/common/protocol/STORES_Message.h"
 #include "logdevice/common/protocol/STORE_Message.h"
 #include "logdevice/common/stats/ServerHistograms.h"
 #include "logdevice/common/types_internal.h"
@@ -125,6 +132,20 @@ Appender::Appender(Worker* worker,
                std::move(e2e_tracer),
                std::move(appender_span)) {}
 
+void* Appender::operator new(size_t size) {
+  bool reused;
+  void* p = ObjectPool<Appender>::allocate(size, &reused);
+  WORKER_STAT_INCR(appenders_allocated);
+  if (reused) {
+    WORKER_STAT_INCR(appenders_allocated_from_pool);
+  }
+  return p;
+}
+
+void Appender::operator delete(void* p, size_t size) {
+  ObjectPool<Appender>::deallocate(p, size);
+}
+
 Appender::~Appender() {
   if (started()) {
     ld_spew(
@@ -224,6 +245,12 @@ int Appender::sendSTORE(const StoreChainLink copyset[],
     }
   };
 
+  if (getSettings().store_batch_max_records > 1 &&
+      enqueueStoreForBatch(store_msg, dest.asNodeID())) {
+    set_status_span_tag(E::OK);
+    return 1;
+  }
+
   int rv = sender_->sendMessage(
       std::move(store_msg), dest.asNodeID(), &r->bwAvailCB());
   if (rv == 0) {
@@ -503,6 +530,9 @@ int Appender::trySendingWavesOfStores(
     if (!attrs_.optional_keys.empty()) {
       store_flags |= STORE_Header::CUSTOM_KEY;
     }
+    if (isStreamingIngest()) {
+      store_flags |= STORE_Header::NO_RECORD_CACHE;
+    }
 
     recipients_.replace(copyset, store_hdr_.copyset_size, this);
 
@@ -591,6 +621,10 @@ int Appender::trySendingWavesOfStores(
 }
 
 int Appender::sendWave() {
+  if (store_hdr_.flags & STORE_Header::TIMINGS) {
+    wave_send_time_ = std::chrono::steady_clock::now();
+  }
+
   if (prev_wave_send_span_) {
     // there has been another wave that was sent before, so this current wave
     // span follows from that one
@@ -625,10 +659,28 @@ int Appender::sendWave() {
 
   // cache these on the stack to have a consistent value throughout this
   // call. These Sequencer attributes can change at any time.
-  const copyset_size_t cfg_extras = getExtras();
+  const copyset_size_t base_extras = getExtras();
   const copyset_size_t cfg_synced =
       std::min(getSynced(), recipients_.getReplication());
 
+  // Hedged stores: if the nodeset has nodes graylisted as slow, there is
+  // likely another straggler that is not graylisted yet. Send the first wave
+  // to a few more nodes so that the append can complete without waiting for
+  // it until the store timeout. Later waves already avoid the nodes that
+  // timed out.
+  copyset_size_t hedged_copies = 0;
+  if (store_hdr_.wave == 0 && getHedgedCopies() > 0) {
+    auto nodeset_state = copyset_manager_->getNodeSetState();
+    if (nodeset_state &&
+        nodeset_state->numNotAvailableShards(
+            NodeSetState::NotAvailableReason::SLOW) > 0) {
+      hedged_copies = getHedgedCopies();
+    }
+  }
+  const copyset_size_t cfg_extras = std::min<int>(
+      base_extras + hedged_copies,
+      COPYSET_SIZE_MAX - recipients_.getReplication());
+
   // add tracing span annotations, only for the first wave, as the information
   // is kept for all waves
   if (wave_send_span_ && !prev_wave_send_span_) {
@@ -651,6 +703,17 @@ int Appender::sendWave() {
 
   int rv = trySendingWavesOfStores(cfg_synced, cfg_extras, append_ctx);
 
+  hedged_copies_sent_ = 0;
+  if (hedged_copies > 0 &&
+      replies_expected_ > recipients_.getReplication() + base_extras) {
+    hedged_copies_sent_ =
+        replies_expected_ - recipients_.getReplication() - base_extras;
+    STAT_INCR(getStats(), appender_hedged_waves);
+    STAT_ADD(getStats(),
+             appender_hedged_store_bytes,
+             hedged_copies_sent_ * payload_->size());
+  }
+
   if (replies_expected_ < recipients_.getReplication()) {
     // We failed to send a complete wave. Up the current wave id so that
     // the Appender ignores replies to any STORE message we did send.
@@ -725,6 +788,12 @@ int Appender::start(std::shared_ptr<EpochSequencer> epoch_sequencer,
   store_hdr_.wave = 0;
   store_hdr_.flags = passthru_flags_;
   store_hdr_.nsync = 0;
+
+  const size_t timings_sample_rate = getSettings().append_timings_sample_rate;
+  if (timings_sample_rate > 0 && folly::Random::oneIn(timings_sample_rate)) {
+    store_hdr_.flags |= STORE_Header::TIMINGS;
+    start_time_ = std::chrono::steady_clock::now();
+  }
   store_hdr_.copyset_size = 0;
 
   deferred_stores_ = 0;
@@ -833,8 +902,10 @@ void Appender::prepareTailRecord(bool include_payload) {
     auto ph_raw = payload_->getPayload();
     // must be on worker thread for handling evbuffer
     auto w = Worker::onThisThread();
-    auto zero_copied_record = ZeroCopiedRecord::create<ZeroCopiedRecord>(
-        ZeroCopiedRecord::Disposer(&w->processor_->zeroCopiedRecordDisposal()),
+    auto& disposal = w->processor_->zeroCopiedRecordDisposal();
+    auto zero_copied_record = ZeroCopiedRecord::createInArena<ZeroCopiedRecord>(
+        disposal.getArena(payload_.get()),
+        ZeroCopiedRecord::Disposer(&disposal),
         lsn_t(store_hdr_.rid.lsn()),
         STORE_flags_t(store_hdr_.flags),
         uint64_t(store_hdr_.timestamp),
@@ -953,6 +1024,10 @@ void Appender::sendReply(lsn_t lsn, Status status, NodeID redirect) {
       RecordTimestamp::from(std::chrono::milliseconds(store_hdr_.timestamp)),
       redirect,
       status};
+  if (retry_delay_.hasValue()) {
+    ld_check(status == E::SEQNOBUFS);
+    replyhdr.flags |= APPENDED_Header::INCLUDES_RETRY_DELAY;
+  }
   if (status == E::PREEMPTED || status == E::REDIRECTED) {
     ld_check(redirect.isNodeID());
     // In the preemption case, if we know for sure that no copy of the record
@@ -1039,6 +1114,9 @@ void Appender::sendReply(lsn_t lsn, Status status, NodeID redirect) {
   }
 
   auto reply = std::make_unique<APPENDED_Message>(replyhdr);
+  if (retry_delay_.hasValue()) {
+    reply->retry_delay_ms = retry_delay_->count();
+  }
   auto set_status_span_tag = [&reply_send_span](E send_err) -> void {
     if (reply_send_span) {
       reply_send_span->SetTag("status", error_name(send_err));
@@ -1063,6 +1141,12 @@ void Appender::sendReply(lsn_t lsn, Status status, NodeID redirect) {
   }
 }
 
+void Appender::sendRateLimited(std::chrono::milliseconds retry_delay) {
+  STAT_ADD(getStats(), append_rejected_rate_limited, append_message_count_);
+  retry_delay_ = retry_delay;
+  sendReply(LSN_INVALID, E::SEQNOBUFS);
+}
+
 void Appender::sendError(Status reason) {
   Status client_code;
 
@@ -1439,7 +1523,8 @@ void Appender::setNotAvailableShard(ShardID shard,
 
 int Appender::onReply(const STORED_Header& header,
                       ShardID from,
-                      ShardID rebuildingRecipient) {
+                      ShardID rebuildingRecipient,
+                      const STORED_Timings* timings) {
   if (appender_span_) {
     // having an appender span means we have e2e tracing enabled
     std::pair<uint32_t, ShardID> current_info(header.wave, from);
@@ -1460,6 +1545,12 @@ int Appender::onReply(const STORED_Header& header,
     }
   }
 
+  if (store_hdr_.flags & STORE_Header::TIMINGS) {
+    // If this reply completes the append, noteAppendTimings() uses it.
+    reply_timings_ = timings ? folly::make_optional(*timings) : folly::none;
+    reply_timings_from_ = from;
+  }
+
   // decrement outstanding responses
   --outstanding_;
   if (header.status == E::OK) {
@@ -1888,10 +1979,20 @@ void Appender::onRecipientSucceeded(Recipient* recipient) {
     wave_send_span_->Finish();
   }
 
+  if (hedged_copies_sent_ > 0 &&
+      recipients_.numOutstanding() > hedged_copies_sent_) {
+    // Whichever recipients the hedged copies were sent to, the wave would
+    // still be waiting for a straggler without them.
+    STAT_INCR(getStats(), appender_hedged_waves_completed_early);
+  }
+
   ld_check(!reply_sent_);
   // record the latency of this append
-  HISTOGRAM_ADD(getStats(), append_latency, usec_since(creation_time_));
   int64_t latency_usec = usec_since(creation_time_);
+  HISTOGRAM_ADD(getStats(), append_latency, latency_usec);
+  HISTOGRAM_ADD(getStats(), append_latency_high_res, latency_usec);
+  noteAppendTimings(latency_usec);
+  noteAppendCompleted(std::chrono::microseconds(latency_usec));
   const Sockaddr& client_sock_addr =
       Sender::sockaddrOrInvalid(Address(reply_to_));
   tracer_.traceAppend(
@@ -1949,6 +2050,49 @@ void Appender::onRecipientSucceeded(Recipient* recipient) {
   onComplete();
 }
 
+void Appender::noteAppendTimings(int64_t latency_usec) {
+  if (!(store_hdr_.flags & STORE_Header::TIMINGS) ||
+      !reply_timings_.hasValue()) {
+    return;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  auto usec = [](std::chrono::steady_clock::duration d) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+  };
+
+  AppendTimings timings;
+  timings.admission_usec = usec(start_time_ - creation_time_);
+  timings.retry_usec = usec(wave_send_time_ - start_time_);
+  timings.storage = reply_timings_.value();
+  timings.storage_shard = reply_timings_from_;
+  // Clocks of different nodes can't be compared, so the network part is
+  // whatever the storage node doesn't account for.
+  timings.network_usec = std::max<int64_t>(
+      0,
+      usec(now - wave_send_time_) -
+          static_cast<int64_t>(timings.storage.totalUsec()));
+
+  StatsHolder* stats = getStats();
+  HISTOGRAM_ADD(stats, append_timings_admission, timings.admission_usec);
+  HISTOGRAM_ADD(stats, append_timings_retry, timings.retry_usec);
+  HISTOGRAM_ADD(stats, append_timings_network, timings.network_usec);
+  const STORED_Timings& storage = timings.storage;
+  HISTOGRAM_ADD(stats, append_timings_storage_worker, storage.worker_usec);
+  HISTOGRAM_ADD(stats, append_timings_storage_queue, storage.queue_usec);
+  HISTOGRAM_ADD(stats, append_timings_storage_write, storage.write_usec);
+  HISTOGRAM_ADD(stats, append_timings_storage_sync, storage.sync_usec);
+  HISTOGRAM_ADD(stats, append_timings_storage_reply, storage.reply_usec);
+
+  AppendTimingsTracer tracer(
+      created_on_ ? created_on_->getTraceLogger() : nullptr);
+  tracer.traceAppendTimings(log_id_,
+                            store_hdr_.rid.lsn(),
+                            payload_->size(),
+                            store_hdr_.wave + 1,
+                            latency_usec,
+                            timings);
+}
+
 bool Appender::onRecipientFailed(Recipient* recipient,
                                  Recipient::State reason) {
   ld_check(!recipient->outcomeKnown());
@@ -2036,11 +2180,15 @@ void Appender::sendReleases(const ShardID* dests,
           store_hdr_.rid.toString().c_str(),
           ndests);
 
+  const bool batch = getSettings().release_batch_interval.count() > 0;
   for (size_t dest_num = 0; dest_num < ndests; ++dest_num) {
     const ShardID& dest = dests[dest_num];
+    const RELEASE_Header header{store_hdr_.rid, release_type, dest.shard()};
+    if (batch && enqueueReleaseForBatch(header, dest.asNodeID())) {
+      continue;
+    }
 
-    auto release_msg = std::make_unique<RELEASE_Message>(
-        RELEASE_Header({store_hdr_.rid, release_type, dest.shard()}));
+    auto release_msg = std::make_unique<RELEASE_Message>(header);
 
     int rv = sender_->sendMessage(std::move(release_msg), dest.asNodeID());
     if (rv != 0) {
@@ -2177,8 +2325,12 @@ void Appender::onReaped() {
 
   if (release_type != ReleaseType::INVALID) {
     // Send a RELEASE message to all recipients that acknowledged their copy.
-    sendReleases(
-        release_.data(), release_.size(), store_hdr_.rid, release_type);
+    // Logs in streaming ingest mode skip this: PeriodicReleases releases
+    // their records in batches, every streaming_ingest_release_interval.
+    if (!isStreamingIngest()) {
+      sendReleases(
+          release_.data(), release_.size(), store_hdr_.rid, release_type);
+    }
     // For gap detection, as well as rebuilding, to work correctly, all nodes
     // eventually need to find out what the last released LSN is. Some nodes
     // (e.g. those with weight=0) don't normally receive records (and
@@ -2262,6 +2414,14 @@ copyset_size_t Appender::getSynced() const {
   return epoch_sequencer_->getSynced();
 }
 
+copyset_size_t Appender::getHedgedCopies() const {
+  return epoch_sequencer_->getHedgedCopies();
+}
+
+bool Appender::isStreamingIngest() const {
+  return epoch_sequencer_->isStreamingIngest();
+}
+
 std::shared_ptr<CopySetManager> Appender::getCopySetManager() const {
   return epoch_sequencer_->getCopySetManager();
 }
@@ -2302,6 +2462,10 @@ void Appender::noteAppenderPreempted(epoch_t epoch, NodeID preempted_by) {
   epoch_sequencer_->noteAppenderPreempted(epoch, preempted_by);
 }
 
+void Appender::noteAppendCompleted(std::chrono::microseconds latency) {
+  epoch_sequencer_->noteAppendCompleted(latency);
+}
+
 bool Appender::checkNodeSet() const {
   return epoch_sequencer_->checkNodeSet();
 }
@@ -2326,8 +2490,12 @@ void Appender::setNotAvailableUntil(
     ShardID shard,
     std::chrono::steady_clock::time_point until_time,
     NodeSetState::NotAvailableReason reason) {
-  copyset_manager_->getNodeSetState()->setNotAvailableUntil(
+  bool changed = copyset_manager_->getNodeSetState()->setNotAvailableUntil(
       shard, until_time, reason);
+  if (changed && Worker::settings().load_aware_nodeset_selection) {
+    Worker::onThisThread()->processor_->shardLoadTracker().update(
+        shard, reason);
+  }
 }
 
 StatsHolder* Appender::getStats() {
@@ -2340,6 +2508,18 @@ int Appender::registerOnSocketClosed(NodeID nid, SocketCallback& cb) {
   return rv;
 }
 
+bool Appender::enqueueStoreForBatch(std::unique_ptr<STORE_Message>& msg,
+                                    NodeID to) {
+  return Worker::onThisThread()->activeAppenders().enqueueStoreForBatch(msg,
+                                                                       to);
+}
+
+bool Appender::enqueueReleaseForBatch(const RELEASE_Header& header,
+                                      NodeID to) {
+  return Worker::onThisThread()->activeAppenders().enqueueReleaseForBatch(
+      header, to);
+}
+
 void Appender::replyToAppendRequest(APPENDED_Header& replyhdr) {
   Worker* w = Worker::onThisThread();
   auto pos = w->runningAppends().map.find(append_request_id_);
@@ -2446,4 +2626,166 @@ bool Appender::isNodeAlive(NodeID node) {
   return (cs == nullptr || cs->isNodeAlive(node.index()));
 }
 
+AppenderMap::AppenderMap(size_t nbuckets) : map(nbuckets) {}
+
+AppenderMap::~AppenderMap() = default;
+
+bool AppenderMap::enqueueStoreForBatch(std::unique_ptr<STORE_Message>& msg,
+                                       NodeID to) {
+  const Settings& settings = Worker::settings();
+  const size_t max_records = settings.store_batch_max_records;
+  const size_t max_bytes = settings.store_batch_max_bytes;
+  const PayloadHolder* payload = msg->getPayloadHolder();
+  const size_t payload_bytes = payload ? payload->size() : 0;
+  if (max_records <= 1 || payload_bytes >= max_bytes) {
+    return false;
+  }
+
+  // The protocol of the connection must be known to support STORES. STOREs
+  // sent before the handshake completes go in STORE messages.
+  Socket* socket =
+      Worker::onThisThread()->sender().findServerSocket(to.index());
+  if (socket == nullptr || !socket->isHandshaken() ||
+      socket->getProto() < Compatibility::STORES_MESSAGE_SUPPORT) {
+    return false;
+  }
+
+  auto it = open_store_batches_.find(to.index());
+  if (it != open_store_batches_.end() &&
+      store_batches_[it->second].payload_bytes + payload_bytes > max_bytes) {
+    open_store_batches_.erase(it);
+    it = open_store_batches_.end();
+  }
+  if (it == open_store_batches_.end()) {
+    it = open_store_batches_.emplace(to.index(), store_batches_.size()).first;
+    store_batches_.emplace_back();
+    store_batches_.back().to = to;
+  }
+
+  StoreBatch& batch = store_batches_[it->second];
+  batch.stores.push_back(std::move(msg));
+  batch.payload_bytes += payload_bytes;
+  if (batch.stores.size() >= max_records) {
+    // Full batches wait for the end of the iteration too. Sending them right
+    // away could report a failure to an Appender that is still in the middle
+    // of sending its wave.
+    open_store_batches_.erase(it);
+  }
+
+  if (!store_flush_timer_) {
+    store_flush_timer_ =
+        std::make_unique<Timer>([this] { flushStoreBatches(); });
+  }
+  if (!store_flush_timer_->isActive()) {
+    store_flush_timer_->activate(std::chrono::microseconds(0));
+  }
+  return true;
+}
+
+void AppenderMap::flushStoreBatches() {
+  auto batches = std::move(store_batches_);
+  store_batches_.clear();
+  open_store_batches_.clear();
+  for (auto& batch : batches) {
+    sendStoreBatch(std::move(batch));
+  }
+}
+
+void AppenderMap::sendStoreBatch(StoreBatch batch) {
+  ld_check(!batch.stores.empty());
+  Worker* w = Worker::onThisThread();
+  std::unique_ptr<Message> msg;
+  if (batch.stores.size() == 1) {
+    // Nothing to batch the STORE with, send it as is.
+    msg = std::move(batch.stores.front());
+  } else {
+    msg = std::make_unique<STORES_Message>(std::move(batch.stores));
+  }
+  int rv = w->sender().sendMessage(std::move(msg), batch.to);
+  if (rv != 0) {
+    // The message wasn't sent, so the messaging layer won't call onSent().
+    // Report the error to the Appenders the same way as if sending had failed
+    // later.
+    w->message_dispatch_->onSent(
+        *msg, err, Address(batch.to), SteadyTimestamp::now());
+  }
+}
+
+bool AppenderMap::enqueueReleaseForBatch(const RELEASE_Header& header,
+                                         NodeID to) {
+  const std::chrono::milliseconds interval =
+      Worker::settings().release_batch_interval;
+  if (interval.count() <= 0) {
+    return false;
+  }
+
+  // The protocol of the connection must be known to support RELEASES.
+  // RELEASEs sent before the handshake completes go in RELEASE messages.
+  Socket* socket =
+      Worker::onThisThread()->sender().findServerSocket(to.index());
+  if (socket == nullptr || !socket->isHandshaken() ||
+      socket->getProto() < Compatibility::RELEASES_MESSAGE_SUPPORT) {
+    return false;
+  }
+
+  // Per-epoch releases of different epochs are independent, e.g. the one for
+  // an epoch that is still draining must not be replaced by one for the next
+  // epoch.
+  const epoch_t epoch = header.release_type == ReleaseType::PER_EPOCH
+      ? header.rid.epoch
+      : EPOCH_INVALID;
+  auto& batch = release_batches_[to.index()];
+  auto insert = batch.emplace(ReleaseKey(header.rid.logid.val_,
+                                         header.shard,
+                                         header.release_type,
+                                         epoch.val_),
+                              header);
+  if (!insert.second &&
+      insert.first->second.rid.lsn() < header.rid.lsn()) {
+    insert.first->second = header;
+  }
+
+  if (!release_flush_timer_) {
+    release_flush_timer_ =
+        std::make_unique<Timer>([this] { flushReleaseBatches(); });
+  }
+  if (!release_flush_timer_->isActive()) {
+    release_flush_timer_->activate(interval);
+  }
+  return true;
+}
+
+void AppenderMap::flushReleaseBatches() {
+  auto batches = std::move(release_batches_);
+  release_batches_.clear();
+  for (auto& kv : batches) {
+    std::vector<RELEASE_Header> releases;
+    releases.reserve(kv.second.size());
+    for (const auto& release : kv.second) {
+      releases.push_back(release.second);
+    }
+    sendReleaseBatch(kv.first, std::move(releases));
+  }
+}
+
+void AppenderMap::sendReleaseBatch(node_index_t node,
+                                   std::vector<RELEASE_Header> releases) {
+  ld_check(!releases.empty());
+  Worker* w = Worker::onThisThread();
+  std::unique_ptr<Message> msg;
+  if (releases.size() == 1) {
+    // Nothing to batch the RELEASE with, send it as is.
+    msg = std::make_unique<RELEASE_Message>(releases.front());
+  } else {
+    msg = std::make_unique<RELEASES_Message>(std::move(releases));
+  }
+  int rv = w->sender().sendMessage(std::move(msg), NodeID(node));
+  if (rv != 0) {
+    // The message wasn't sent, so the messaging layer won't call onSent().
+    // Let the sequencers retry the same way as if sending had failed later.
+    w->message_dispatch_->onSent(
+        *msg, err, Address(NodeID(node)), SteadyTimestamp::now());
+  }
+}
+
 }} // namespace facebook::logdevice
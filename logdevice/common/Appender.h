@@ -9,9 +9,13 @@
 
 #include <bitset>
 #include <chrono>
+#include <map>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 #include <boost/intrusive/unordered_set.hpp>
 #include <folly/Optional.h>
@@ -30,6 +34,7 @@
 #include "logdevice/common/Timer.h"
 #include "logdevice/common/Timestamp.h"
 #include "logdevice/common/WeakRefHolder.h"
+#include "logdevice/common/protocol/RELEASE_Message.h"
 #include "logdevice/common/protocol/STORED_Message.h"
 #include "logdevice/common/stats/Stats.h"
 
@@ -132,6 +137,11 @@ class Appender : public IntrusiveUnorderedMapHook {
 
   virtual ~Appender();
 
+  // Appenders are created and destroyed for every append; their memory is
+  // recycled through a per-thread ObjectPool. See appenders_allocated* stats.
+  static void* operator new(size_t size);
+  static void operator delete(void* p, size_t size);
+
   /**
    * Reason for the retirement of the Appender. Used to determine actions when
    * the appender retires.
@@ -328,6 +338,13 @@ class Appender : public IntrusiveUnorderedMapHook {
    */
   void sendError(Status st);
 
+  /**
+   * Rejects the append because the log is over its maxAppendBytesPerSecond
+   * budget. The client gets E::SEQNOBUFS along with a hint to back off for
+   * @param retry_delay before appending to the log again.
+   */
+  void sendRateLimited(std::chrono::milliseconds retry_delay);
+
   /**
    * Sends a redirect reply to the client.  This is either an explicit redirect
    * (E::REDIRECTED) indicating that another node should take care of the
@@ -389,12 +406,15 @@ class Appender : public IntrusiveUnorderedMapHook {
    * @param from                storage shard that sent the reply
    * @param rebuildingRecipient If header.status == E::REBULDING, recipient in
    *                            the copyset that is rebuilding.
+   * @param timings             If the STORE had STORE_Header::TIMINGS, where
+   *                            the storage node spent its time; may be null.
    *
    * @return 0 on success, -1 if reply is invalid, sets err to E::PROTO.
    */
   int onReply(const STORED_Header& header,
               ShardID from,
-              ShardID rebuildingRecipient = ShardID());
+              ShardID rebuildingRecipient = ShardID(),
+              const STORED_Timings* timings = nullptr);
 
   const PayloadHolder* getPayload() const {
     return payload_.get();
@@ -696,6 +716,9 @@ class Appender : public IntrusiveUnorderedMapHook {
   // Can only be used on metadata logs
   folly::Optional<epoch_t> acceptable_epoch_;
 
+  // Set by sendRateLimited(), included in the APPENDED reply
+  folly::Optional<std::chrono::milliseconds> retry_delay_;
+
   // copyset manager for selecting nodes to store copies of the record
   std::shared_ptr<CopySetManager> copyset_manager_;
 
@@ -711,6 +734,11 @@ class Appender : public IntrusiveUnorderedMapHook {
   // so that we can expect to get replies from them.
   copyset_size_t replies_expected_;
 
+  // the number of recipients added to the latest wave on top of replication
+  // and extras because some nodes of the nodeset were graylisted as slow
+  // (see getHedgedCopies()). 0 if the latest wave was not hedged.
+  copyset_size_t hedged_copies_sent_{0};
+
   // the following members keep track of the status of STOREs accross waves:
   // number of successful STORE messages
   bool stored_{false};
@@ -760,6 +788,15 @@ class Appender : public IntrusiveUnorderedMapHook {
   // time when the appender was created, used to calculate the latency
   std::chrono::steady_clock::time_point creation_time_;
 
+  // For appends sampled for a latency breakdown (store_hdr_.flags has
+  // STORE_Header::TIMINGS): when start() was called, when the latest wave
+  // was sent, and the storage node timings of the latest STORED reply and
+  // the shard that sent it. See AppendTimings.
+  std::chrono::steady_clock::time_point start_time_;
+  std::chrono::steady_clock::time_point wave_send_time_;
+  folly::Optional<STORED_Timings> reply_timings_;
+  ShardID reply_timings_from_;
+
   // deadline after which the client is presumed to have timed out. If the
   // epoch to which this Appender belongs (store_hdr_.epoch) is shut down
   // after this deadline, the appender may abort the request without sending
@@ -825,6 +862,11 @@ class Appender : public IntrusiveUnorderedMapHook {
   static const uint8_t FINISH = 1u << 0u;
   static const uint8_t REAPED = 1u << 1u;
 
+  // If this append was sampled for a latency breakdown and the reply that
+  // completed it had the storage node's timings, updates the
+  // append_timings_* histograms and traces the breakdown.
+  void noteAppendTimings(int64_t latency_usec);
+
   // OpenTracing tracer object used in distributed e2e tracing
   std::shared_ptr<opentracing::Tracer> e2e_tracer_;
   std::shared_ptr<opentracing::Span> appender_span_;
@@ -994,6 +1036,8 @@ class Appender : public IntrusiveUnorderedMapHook {
   virtual lsn_t getLastKnownGood() const;
   virtual copyset_size_t getExtras() const;
   virtual copyset_size_t getSynced() const;
+  virtual copyset_size_t getHedgedCopies() const;
+  virtual bool isStreamingIngest() const;
   virtual std::shared_ptr<CopySetManager> getCopySetManager() const;
   virtual NodeLocationScope getBiggestReplicationScope() const;
   virtual NodeLocationScope getCurrentBiggestReplicationScope() const;
@@ -1007,6 +1051,7 @@ class Appender : public IntrusiveUnorderedMapHook {
   virtual void retireAppender(Status st, lsn_t lsn, Reaper& reaper);
   virtual void noteAppenderPreempted(epoch_t epoch, NodeID preempted_by);
   virtual bool checkNodeSet() const;
+  virtual void noteAppendCompleted(std::chrono::microseconds latency);
   virtual bool noteAppenderReaped(FullyReplicated replicated,
                                   lsn_t reaped_lsn,
                                   std::shared_ptr<TailRecord> tail_record,
@@ -1020,6 +1065,11 @@ class Appender : public IntrusiveUnorderedMapHook {
                        NodeSetState::NotAvailableReason reason);
   virtual StatsHolder* getStats();
   virtual int registerOnSocketClosed(NodeID nid, SocketCallback& cb);
+  // See AppenderMap::enqueueStoreForBatch().
+  virtual bool enqueueStoreForBatch(std::unique_ptr<STORE_Message>& msg,
+                                    NodeID to);
+  // See AppenderMap::enqueueReleaseForBatch().
+  virtual bool enqueueReleaseForBatch(const RELEASE_Header& header, NodeID to);
   virtual void replyToAppendRequest(APPENDED_Header& replyhdr);
   virtual void schedulePeriodicReleases();
 
@@ -1040,7 +1090,9 @@ class Appender : public IntrusiveUnorderedMapHook {
 // Intrusive hash map of appenders.  Wrapper instead of typedef to allow
 // forward-declaring in Worker.h.
 struct AppenderMap {
-  explicit AppenderMap(size_t nbuckets) : map(nbuckets) {}
+  explicit AppenderMap(size_t nbuckets);
+  ~AppenderMap();
+
   IntrusiveUnorderedMap<Appender,
                         RecordID,
                         Appender::KeyExtractor,
@@ -1048,6 +1100,76 @@ struct AppenderMap {
                         std::equal_to<RecordID>,
                         Appender::Disposer>
       map;
+
+  /**
+   * Queues a STORE that an Appender sends to `to`, to be sent in a STORES
+   * message together with the other STOREs that Appenders of this Worker send
+   * to the same node. Batches are sent at the end of the current event loop
+   * iteration. Once a batch holds Settings::store_batch_max_records STOREs or
+   * Settings::store_batch_max_bytes of payload, further STOREs for the node go
+   * in a new batch.
+   *
+   * @return true if `msg` was queued and moved from. The outcome of sending
+   *         it is reported to the Appender through STORE_onSent(), as usual.
+   *         false if batching is disabled, the payload is too large, or the
+   *         connection to `to` is not handshaken with a protocol that
+   *         supports STORES messages, in which case the caller should send
+   *         the STORE_Message itself.
+   */
+  bool enqueueStoreForBatch(std::unique_ptr<STORE_Message>& msg, NodeID to);
+
+  /**
+   * Queues a RELEASE that a sequencer of this Worker sends to `to`, to be
+   * sent in a RELEASES message together with the other RELEASEs that
+   * sequencers of this Worker send to the same node. Queued RELEASEs are sent
+   * Settings::release_batch_interval after the first of them was queued. A
+   * queued global RELEASE for the same log and shard is replaced if the new
+   * one has a higher LSN, as global releases are cumulative. Per-epoch
+   * RELEASEs only cover their own epoch, so they only replace a queued one
+   * for the same epoch.
+   *
+   * @return true if the RELEASE was queued. The outcome of sending it is
+   *         reported to the sequencer through RELEASE_Message::onReleaseSent().
+   *         false if batching is disabled or the connection to `to` is not
+   *         handshaken with a protocol that supports RELEASES messages, in
+   *         which case the caller should send the RELEASE_Message itself.
+   */
+  bool enqueueReleaseForBatch(const RELEASE_Header& header, NodeID to);
+
+ private:
+  struct StoreBatch {
+    NodeID to;
+    std::vector<std::unique_ptr<STORE_Message>> stores;
+    size_t payload_bytes{0};
+  };
+
+  // Sends all the batches accumulated in store_batches_.
+  void flushStoreBatches();
+  void sendStoreBatch(StoreBatch batch);
+
+  // Batches in the order of their first STORE.
+  std::vector<StoreBatch> store_batches_;
+  // Node index -> index in store_batches_ of the batch still taking STOREs
+  // for that node.
+  std::unordered_map<node_index_t, size_t> open_store_batches_;
+  // Zero-delay timer flushing store_batches_.
+  std::unique_ptr<Timer> store_flush_timer_;
+
+  // Sends all the batches accumulated in release_batches_.
+  void flushReleaseBatches();
+  void sendReleaseBatch(node_index_t node,
+                        std::vector<RELEASE_Header> releases);
+
+  // Log, shard, release type and, for per-epoch releases, epoch (otherwise
+  // EPOCH_INVALID).
+  using ReleaseKey = std::
+      tuple<logid_t::raw_type, shard_index_t, ReleaseType, epoch_t::raw_type>;
+  // RELEASEs queued by enqueueReleaseForBatch(), by node, then by ReleaseKey.
+  std::unordered_map<node_index_t, std::map<ReleaseKey, RELEASE_Header>>
+      release_batches_;
+  // Flushes release_batches_ Settings::release_batch_interval after the first
+  // RELEASE was queued.
+  std::unique_ptr<Timer> release_flush_timer_;
 };
 
 }} // namespace facebook::logdevice
@@ -12,6 +12,7 @@
 #include "logdevice/common/Appender.h"
 #include "logdevice/common/AppenderBuffer.h"
 #include "logdevice/common/Checksum.h"
+#include "logdevice/common/JemallocArenas.h"
 #include "logdevice/common/MetaDataLogWriter.h"
 #include "logdevice/common/PermissionChecker.h"
 #include "logdevice/common/Processor.h"
@@ -403,6 +404,15 @@ void AppenderPrep::onSequencerNodeFound(Status st,
       sendError(appender.get(), err);
       return;
     }
+
+    std::chrono::milliseconds retry_delay;
+    const PayloadHolder* payload = appender->getPayload();
+    if (!sequencer->checkAppendRateLimit(payload ? payload->size() : 0,
+                                         &retry_delay)) {
+      // The log is over its max-append-bytes-per-second budget
+      sendRateLimited(appender.get(), retry_delay);
+      return;
+    }
   }
 
   // See if this append should be buffered for batching.  NOTE: Not the same
@@ -458,6 +468,7 @@ std::unique_ptr<Appender> AppenderPrep::constructAppender() {
   // itself.
   size_t full_size = sizeof(Appender) + payload_.size();
 
+  AllocationTagScope tag_scope(AllocationTag::APPENDERS);
   auto appender =
       std::make_unique<Appender>(Worker::onThisThread(),
                                  Worker::onThisThread()->getTraceLogger(),
@@ -790,6 +801,19 @@ RunAppenderStatus AppenderPrep::append(std::shared_ptr<Sequencer>& sequencer,
   auto status = runAppender(*sequencer, *appender);
   if (status != RunAppenderStatus::ERROR_DELETE) {
     // Success!
+    if (!MetaDataLog::isMetaDataLog(header_.logid) &&
+        sequencer->shouldReactivateAhead()) {
+      // The current epoch is about to run out of ESNs. Start activating the
+      // next epoch now, so that appends move over to it without waiting for
+      // the epoch store once the ESN space is exhausted. Meanwhile appends
+      // keep running in the current epoch.
+      auto pred = [](const Sequencer& seq) {
+        return seq.shouldReactivateAhead();
+      };
+      if (activateSequencer(header_.logid, sequencer, pred) == 0) {
+        STAT_INCR(stats(), epoch_pipelining_reactivation);
+      }
+    }
     return status;
   }
 
@@ -988,6 +1012,12 @@ void AppenderPrep::sendError(Appender* appender, Status status) const {
   appender->sendError(status);
 }
 
+void AppenderPrep::sendRateLimited(Appender* appender,
+                                   std::chrono::milliseconds retry_delay) const {
+  ld_check(appender != nullptr);
+  appender->sendRateLimited(retry_delay);
+}
+
 void AppenderPrep::sendRedirect(Appender* appender,
                                 NodeID target,
                                 Status status) const {
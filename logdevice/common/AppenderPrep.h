@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <chrono>
 #include <memory>
 
 #include "logdevice/common/AllSequencers.h"
@@ -149,6 +150,11 @@ class AppenderPrep : public std::enable_shared_from_this<AppenderPrep> {
   // Reply to the client with a given error status.
   virtual void sendError(Appender*, Status) const;
 
+  // Reply to the client with E::SEQNOBUFS and a hint to not send more appends
+  // for the log during `retry_delay'.
+  virtual void sendRateLimited(Appender*,
+                               std::chrono::milliseconds retry_delay) const;
+
   // Reply to the client with a redirect to `target'.
   virtual void sendRedirect(Appender*, NodeID target, Status) const;
 
@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/AsyncTraceLogger.h"
+
+#include <vector>
+
+#include "logdevice/common/ThreadID.h"
+#include "logdevice/common/checks.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+constexpr size_t AsyncTraceLogger::BATCH_SIZE;
+
+AsyncTraceLogger::AsyncTraceLogger(
+    std::shared_ptr<UpdateableConfig> cluster_config,
+    std::shared_ptr<TraceLogger> logger,
+    size_t queue_size,
+    StatsHolder* stats)
+    : TraceLogger(std::move(cluster_config)),
+      logger_(std::move(logger)),
+      stats_(stats),
+      queue_(queue_size) {
+  ld_check(logger_);
+  thread_ = std::thread([this] { threadMain(); });
+}
+
+AsyncTraceLogger::~AsyncTraceLogger() {
+  // Samples written before the stop entry are still published.
+  queue_.blockingWrite(Entry{std::string(), 0, nullptr});
+  thread_.join();
+}
+
+void AsyncTraceLogger::pushSample(const std::string& table,
+                                  int32_t sample_rate,
+                                  std::unique_ptr<TraceSample> sample) {
+  ld_check(sample);
+  if (!queue_.write(Entry{table, sample_rate, std::move(sample)})) {
+    STAT_INCR(stats_, trace_samples_dropped);
+    return;
+  }
+  STAT_INCR(stats_, trace_samples_queued);
+}
+
+void AsyncTraceLogger::threadMain() {
+  ThreadID::set(ThreadID::Type::UTILITY, "ld:trace");
+  std::vector<Entry> batch;
+  batch.reserve(BATCH_SIZE);
+  while (true) {
+    // Wait for a sample, then take whatever else is already there.
+    batch.emplace_back();
+    queue_.blockingRead(batch.back());
+    Entry entry;
+    while (batch.size() < BATCH_SIZE && queue_.read(entry)) {
+      batch.push_back(std::move(entry));
+    }
+
+    bool stop = false;
+    for (Entry& e : batch) {
+      if (!e.sample) {
+        stop = true;
+        continue;
+      }
+      logger_->pushSample(e.table, e.sample_rate, std::move(e.sample));
+    }
+    batch.clear();
+    if (stop) {
+      return;
+    }
+  }
+}
+
+}} // namespace facebook::logdevice
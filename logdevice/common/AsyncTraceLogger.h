@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <folly/MPMCQueue.h>
+
+#include "logdevice/common/TraceLogger.h"
+
+namespace facebook { namespace logdevice {
+
+class StatsHolder;
+
+/**
+ * @file A TraceLogger that hands samples to another TraceLogger on a
+ *       background thread, so that publishing a sample from a worker only
+ *       costs a write to a bounded lock-free queue rather than whatever the
+ *       underlying logger does to serialize and send it. The background
+ *       thread takes samples off the queue in batches.
+ *
+ *       If the queue is full, samples are dropped rather than blocking the
+ *       publisher, and counted in the trace_samples_dropped stat.
+ */
+
+class AsyncTraceLogger : public TraceLogger {
+ public:
+  /**
+   * @param logger      logger to publish the samples to
+   * @param queue_size  maximum number of samples waiting to be published
+   * @param stats       for the trace_samples_* stats, bumped by publishers,
+   *                    may be nullptr
+   */
+  AsyncTraceLogger(std::shared_ptr<UpdateableConfig> cluster_config,
+                   std::shared_ptr<TraceLogger> logger,
+                   size_t queue_size,
+                   StatsHolder* stats);
+
+  // Publishes the samples still in the queue, then stops the thread.
+  ~AsyncTraceLogger() override;
+
+  void pushSample(const std::string& table,
+                  int32_t sample_rate,
+                  std::unique_ptr<TraceSample> sample) override;
+
+  // Samples taken off the queue at a time by the background thread.
+  static constexpr size_t BATCH_SIZE = 128;
+
+ private:
+  struct Entry {
+    std::string table;
+    int32_t sample_rate;
+    // nullptr tells the thread to stop.
+    std::unique_ptr<TraceSample> sample;
+  };
+
+  void threadMain();
+
+  std::shared_ptr<TraceLogger> logger_;
+  StatsHolder* stats_;
+  folly::MPMCQueue<Entry> queue_;
+  std::thread thread_;
+};
+
+}} // namespace facebook::logdevice
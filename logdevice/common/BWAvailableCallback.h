@@ -16,6 +16,7 @@
 
 namespace facebook { namespace logdevice {
 class FlowGroup;
+class Socket;
 
 /**
  * @file BWAvailableCallback is a pure virtual parent of all callback classes
@@ -67,7 +68,9 @@ class BWAvailableCallback {
   void swap(BWAvailableCallback& other) noexcept {
     std::swap(flow_group_, other.flow_group_);
     std::swap(priority_, other.priority_);
+    std::swap(flow_socket_, other.flow_socket_);
     flow_group_links_.swap_nodes(other.flow_group_links_);
+    fair_queue_links_.swap_nodes(other.fair_queue_links_);
     socket_links_.swap_nodes(other.socket_links_);
   }
 
@@ -104,6 +107,11 @@ class BWAvailableCallback {
   FlowGroup* flow_group_ = nullptr;
   folly::IntrusiveListHook flow_group_links_;
 
+  // The Socket the callback waits to send on, and its place in that Socket's
+  // queue for fair queuing within the FlowGroup, see FlowGroup::Flow.
+  Socket* flow_socket_ = nullptr;
+  folly::IntrusiveListHook fair_queue_links_;
+
   // The callback is also tracked by the Socket so that it can be cleaned
   // up when a socket is closed.
   folly::IntrusiveListHook socket_links_;
@@ -7,8 +7,10 @@
  */
 #include "CheckSealRequest.h"
 
+#include "logdevice/common/AllSequencers.h"
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/Sender.h"
+#include "logdevice/common/Sequencer.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/protocol/CHECK_SEAL_Message.h"
 #include "logdevice/common/protocol/GET_SEQ_STATE_REPLY_Message.h"
@@ -33,7 +35,8 @@ CheckSealRequest::CheckSealRequest(
 }
 
 void CheckSealRequest::initTimer() {
-  request_timer_ = std::make_unique<Timer>([this] { this->onTimeout(); });
+  request_timer_ =
+      std::make_unique<Timer>([this] { resumeWith(Event::TIMEOUT); });
 
   std::chrono::milliseconds delay(
       Worker::settings().check_seal_req_min_timeout.count());
@@ -48,15 +51,41 @@ void CheckSealRequest::initTimer() {
 
 Request::Execution CheckSealRequest::execute() {
   Worker* w = Worker::onThisThread();
-  initTimer();
-
   auto& map = w->runningCheckSeals().map;
   map.insert(std::make_pair(id_, std::unique_ptr<CheckSealRequest>(this)));
 
-  sendCheckSeals();
+  resume();
   return Execution::CONTINUE;
 }
 
+void CheckSealRequest::run() {
+  LD_CORO_BEGIN;
+  initTimer();
+  sendCheckSeals();
+
+  while (true) {
+    LD_CORO_YIELD;
+    if (event_ == Event::TIMEOUT) {
+      WORKER_STAT_INCR(check_seal_req_timedout);
+      logTimeout();
+      break;
+    }
+    recvd_from_.push_back(event_from_);
+    // A failed send doesn't end the request: wait for the timeout to send a
+    // retry to the client.
+    if (event_ == Event::REPLY && processReply()) {
+      break;
+    }
+  }
+  LD_CORO_END;
+}
+
+void CheckSealRequest::resumeWith(Event event, ShardID from) {
+  event_ = event;
+  event_from_ = from;
+  resume();
+}
+
 void CheckSealRequest::sendCheckSeals() {
   Worker* w = Worker::onThisThread();
   auto my_nodeid = w->getConfig()->serverConfig()->getMyNodeID();
@@ -116,7 +145,6 @@ void CheckSealRequest::onSent(ShardID shard, Status status) {
     case E::INTERNAL:
     case E::TIMEDOUT:
     case E::SHUTDOWN:
-      recvd_from_.push_back(shard);
       RATELIMIT_INFO(std::chrono::seconds(10),
                      2,
                      "Sending a check-seal message to %s failed with err:%s"
@@ -126,11 +154,9 @@ void CheckSealRequest::onSent(ShardID shard, Status status) {
                      log_id_.val_,
                      id_.val(),
                      gss_message_->request_id_.val());
-      // wait for timeout to send retry to client.
       break;
 
     default:
-      recvd_from_.push_back(shard);
       RATELIMIT_CRITICAL(
           std::chrono::seconds(1),
           5,
@@ -138,27 +164,32 @@ void CheckSealRequest::onSent(ShardID shard, Status status) {
           error_name(status),
           shard.toString().c_str());
       ld_check(false);
-      // wait for timeout to send retry to client.
       break;
   }
+  resumeWith(Event::SEND_FAILED, shard);
 }
 
 void CheckSealRequest::onReply(ShardID from,
                                const CHECK_SEAL_REPLY_Message& msg) {
-  recvd_from_.push_back(from);
+  reply_ = msg.getHeader();
+  resumeWith(Event::REPLY, from);
+}
 
-  Status st = msg.getHeader().status;
+bool CheckSealRequest::processReply() {
+  const ShardID from = event_from_;
+  const CHECK_SEAL_REPLY_Header& hdr = reply_;
+  Status st = hdr.status;
   ld_debug("Received CHECK_SEAL_REPLY for log:%lu from %s, with "
            "rqid:%lu, status (%s), local_epoch_=%u, seal info[epoch=%u, "
            "seal_type=%d, seq_node=%s], replies_got=%zu, expecting=%zu",
-           msg.getHeader().log_id.val_,
+           hdr.log_id.val_,
            from.toString().c_str(),
-           msg.getHeader().rqid.val(),
+           hdr.rqid.val(),
            error_name(st),
            local_epoch_.val_,
-           msg.getHeader().sealed_epoch.val_,
-           (int)msg.getHeader().seal_type,
-           msg.getHeader().sequencer.toString().c_str(),
+           hdr.sealed_epoch.val_,
+           (int)hdr.seal_type,
+           hdr.sequencer.toString().c_str(),
            recvd_from_.size(),
            copyset_.size());
 
@@ -168,7 +199,7 @@ void CheckSealRequest::onReply(ShardID from,
   } else if (st == E::FAILED || st == E::NOTSTORAGE) {
     ld_debug("Blacklisting %s for log:%lu, rqid:%lu, gss-rqid:%lu",
              from.toString().c_str(),
-             msg.getHeader().log_id.val_,
+             hdr.log_id.val_,
              id_.val(),
              gss_message_->request_id_.val());
 
@@ -179,33 +210,37 @@ void CheckSealRequest::onReply(ShardID from,
   }
 
   // If preempted, finish this request immediately.
-  if (st == E::OK && local_epoch_ <= msg.getHeader().sealed_epoch) {
+  if (st == E::OK && local_epoch_ <= hdr.sealed_epoch) {
     ld_debug("Got %u successful replies for log:%lu, rqid:%lu, gss-rqid:%lu",
              replies_successful_,
-             msg.getHeader().log_id.val_,
+             hdr.log_id.val_,
              id_.val(),
              gss_message_->request_id_.val());
-    gss_message_->notePreempted(
-        msg.getHeader().sealed_epoch, msg.getHeader().sequencer);
+    gss_message_->notePreempted(hdr.sealed_epoch, hdr.sequencer);
     gss_message_->continueExecution(from_);
-    finalize();
+    return true;
   } else if (replies_successful_ == copyset_.size()) {
     // If all nodes have replied successfully, finish request.
-    // No retry will be sent to client
+    // No retry will be sent to client. Let tail queries for the next
+    // Settings::tail_query_seal_check_interval skip the check.
+    auto& seqmap = Worker::onThisThread()->processor_->allSequencers();
+    auto seq = seqmap.findSequencer(log_id_);
+    if (seq) {
+      seq->noteSealCheckPassed(local_epoch_);
+    }
     gss_message_->continueExecution(from_);
-    finalize();
+    return true;
   } else if (recvd_from_.size() == copyset_.size()) {
     // If an attempt to connect to all nodes was made
-    // but not all could reply successfully, finalize the
+    // but not all could reply successfully, finish the
     // request, it will internally send a retry to the client
     // in this case
-    finalize();
+    return true;
   }
+  return false;
 }
 
-void CheckSealRequest::onTimeout() {
-  WORKER_STAT_INCR(check_seal_req_timedout);
-
+void CheckSealRequest::logTimeout() {
   std::sort(copyset_.begin(), copyset_.end());
   std::string copyset_str = "[";
   for (auto to : copyset_) {
@@ -244,8 +279,6 @@ void CheckSealRequest::onTimeout() {
         recvd_str.c_str(),
         replies_successful_);
   }
-
-  finalize();
 }
 
 void CheckSealRequest::sendRetryToClient() {
@@ -257,7 +290,7 @@ void CheckSealRequest::sendRetryToClient() {
   gss_message_->sendReply(from_, reply_hdr, E::AGAIN, NodeID());
 }
 
-void CheckSealRequest::finalize() {
+void CheckSealRequest::onFinished() {
   request_timer_->cancel();
 
   if (replies_successful_ < copyset_.size()) {
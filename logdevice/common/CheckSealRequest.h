@@ -10,6 +10,7 @@
 #include <unordered_map>
 
 #include "logdevice/common/Timer.h"
+#include "logdevice/common/WorkerCoroutine.h"
 #include "logdevice/common/protocol/CHECK_SEAL_Message.h"
 #include "logdevice/common/protocol/CHECK_SEAL_REPLY_Message.h"
 #include "logdevice/common/protocol/GET_SEQ_STATE_Message.h"
@@ -29,6 +30,9 @@ namespace facebook { namespace logdevice {
  *
  * If the sequencer's epoch <= storage nodes' seal,
  * Sequencer::notePreempted() is called.
+ *
+ * The flow is a WorkerCoroutine (see run()): onSent(), onReply() and the
+ * timer record the event and resume it.
  */
 class CheckSealRequest;
 
@@ -40,7 +44,7 @@ struct CheckSealRequestMap {
       map;
 };
 
-class CheckSealRequest : public Request {
+class CheckSealRequest : public Request, public WorkerCoroutine {
  public:
   explicit CheckSealRequest(std::unique_ptr<GET_SEQ_STATE_Message> message,
                             Address from,
@@ -74,6 +78,14 @@ class CheckSealRequest : public Request {
   ~CheckSealRequest() override;
 
  private:
+  enum class Event { SEND_FAILED, REPLY, TIMEOUT };
+
+  // The event run() was last resumed for, and the shard it came from
+  Event event_;
+  ShardID event_from_;
+  // For Event::REPLY, the header of the CHECK_SEAL_REPLY
+  CHECK_SEAL_REPLY_Header reply_;
+
   /**
    * CheckSealRequest owns the GET_SEQ_STATE_Message that issued the request
    */
@@ -131,11 +143,32 @@ class CheckSealRequest : public Request {
   // Keeping it to avoid proto change.
   uint32_t wave_{0};
 
+  /**
+   * Sends CHECK_SEAL to the nodes in copyset_, then waits for replies until
+   * the sequencer is known to be preempted or not, or the timer expires.
+   */
+  void run() override;
+
+  /**
+   * Cancels the timer, sends a retry to the client unless all nodes replied
+   * successfully, and destroys the request.
+   */
+  void onFinished() override;
+
   /**
    * Send CHECK_SEAL message to nodes in copyset_
    */
   void sendCheckSeals();
 
+  /**
+   * Processes reply_ from event_from_.
+   *
+   * @return  true if the request is done, false if it waits for more replies
+   */
+  bool processReply();
+
+  void logTimeout();
+
   /**
    * Tells the client of GET_SEQ_STATE to retry by sending E::AGAIN, e.g. when:
    * - Not all storage nodes could reply with a successful CHECK_SEAL_REPLY.
@@ -151,12 +184,11 @@ class CheckSealRequest : public Request {
    */
   virtual void initTimer();
 
-  virtual void onTimeout();
-
   /**
-   * Cancels the timer and destroys the CheckSealRequest
+   * Resumes run() with event `event' from shard `from'.
    */
-  void finalize();
+  void resumeWith(Event event, ShardID from = ShardID());
+
 };
 
 }} // namespace facebook::logdevice
@@ -34,6 +34,12 @@ namespace facebook { namespace logdevice {
  * that failed the checksum, ClientReadStream waits for other storage nodes to
  * send the record.  If all nodes send busted copies of the record, a DATALOSS
  * gap is reported to the application.
+ *
+ * checksum_32bit() is CRC32C. folly picks its implementation at runtime: the
+ * SSE4.2 crc32 instruction when the CPU supports it, a portable table-driven
+ * version otherwise. Both produce the same value, so the choice doesn't affect
+ * the wire or on-disk formats. checksum_64bit() is SpookyHashV2. See
+ * test/benchmarks/ChecksumBenchmark.cpp for how they compare.
  */
 
 uint32_t checksum_32bit(Slice slice);
@@ -97,13 +97,46 @@ void ClusterState::unsubscribeFromUpdates(
 }
 
 bool ClusterState::isNodeBoycotted(node_index_t idx) const {
-  const auto boycotts = boycotted_nodes_.get();
-  return std::find(boycotts->begin(), boycotts->end(), idx) != boycotts->end();
+  return getSnapshot()->isNodeBoycotted(idx);
 }
 
 void ClusterState::setBoycottedNodes(std::vector<node_index_t> boycotts) {
+  folly::SharedMutex::ReadHolder read_lock(mutex_);
   boycotted_nodes_.update(
       std::make_shared<std::vector<node_index_t>>(std::move(boycotts)));
+  publishSnapshot();
+}
+
+size_t ClusterState::Snapshot::numAliveNodes() const {
+  size_t count = 0;
+  for (uint64_t word : alive_) {
+    count += __builtin_popcountll(word);
+  }
+  return count;
+}
+
+void ClusterState::publishSnapshot() {
+  std::lock_guard<std::mutex> lock(snapshot_mutex_);
+  auto snapshot = std::make_shared<Snapshot>();
+  snapshot->version_ = ++snapshot_version_;
+  snapshot->size_ = cluster_size_;
+  snapshot->alive_.assign((cluster_size_ + 63) / 64, 0);
+  for (size_t i = 0; i < cluster_size_; ++i) {
+    if (node_state_list_[i].load() == NodeState::ALIVE) {
+      snapshot->alive_[i / 64] |= 1ull << (i % 64);
+    }
+  }
+  for (node_index_t idx : *boycotted_nodes_.get()) {
+    if (idx < 0) {
+      continue;
+    }
+    size_t word = static_cast<size_t>(idx) / 64;
+    if (word >= snapshot->boycotted_.size()) {
+      snapshot->boycotted_.resize(word + 1, 0);
+    }
+    snapshot->boycotted_[word] |= 1ull << (idx % 64);
+  }
+  snapshot_.update(std::move(snapshot));
 }
 
 node_index_t ClusterState::getFirstNodeAlive() const {
@@ -136,6 +169,9 @@ void ClusterState::setNodeState(node_index_t idx,
   folly::SharedMutex::ReadHolder read_lock(mutex_);
   if (idx < cluster_size_) {
     ClusterState::NodeState prev = node_state_list_[idx].exchange(state);
+    if (prev != state) {
+      publishSnapshot();
+    }
     if ((prev != state) && processor_) {
       if (!processor_->settings()->server) {
         // this is a client stats
@@ -243,6 +279,7 @@ void ClusterState::resizeClusterState(size_t new_size, bool notifySubscribers) {
         "Cluster state size updated from %lu to %lu", cluster_size_, new_size);
     node_state_list_.reset(new_list);
     cluster_size_ = new_size;
+    publishSnapshot();
   }
 }
 
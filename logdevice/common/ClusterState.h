@@ -12,6 +12,7 @@
 #include <condition_variable>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include <folly/SharedMutex.h>
@@ -63,6 +64,55 @@ class ClusterState {
     friend class ClusterState;
   };
 
+  /**
+   * Immutable view of the state of all nodes at some point in time, with a
+   * bit per node index for whether it is alive and whether it is boycotted.
+   * Published by ClusterState each time either changes, so that code
+   * checking many nodes in a row (e.g. locating sequencers) can get one
+   * consistent view without taking a lock per node.
+   */
+  class Snapshot {
+   public:
+    // Increases every time a new snapshot is published.
+    uint64_t version() const {
+      return version_;
+    }
+
+    // Number of node indices covered. Nodes beyond it are dead.
+    size_t size() const {
+      return size_;
+    }
+
+    bool isNodeAlive(node_index_t idx) const {
+      return testBit(alive_, idx);
+    }
+
+    bool isNodeBoycotted(node_index_t idx) const {
+      return testBit(boycotted_, idx);
+    }
+
+    // Alive and not boycotted.
+    bool isNodeAvailable(node_index_t idx) const {
+      return isNodeAlive(idx) && !isNodeBoycotted(idx);
+    }
+
+    size_t numAliveNodes() const;
+
+   private:
+    static bool testBit(const std::vector<uint64_t>& bits, node_index_t idx) {
+      ld_check(idx >= 0);
+      size_t word = static_cast<size_t>(idx) / 64;
+      return word < bits.size() && (bits[word] >> (idx % 64)) & 1;
+    }
+
+    uint64_t version_{0};
+    size_t size_{0};
+    std::vector<uint64_t> alive_;
+    std::vector<uint64_t> boycotted_;
+
+    friend class ClusterState;
+  };
+
   static const char* getNodeStateString(NodeState state) {
     switch (state) {
       case ALIVE:
@@ -142,6 +192,15 @@ class ClusterState {
   bool isNodeBoycotted(node_index_t idx) const;
   void setBoycottedNodes(std::vector<node_index_t> boycotts);
 
+  /**
+   * @return  the latest snapshot of the state of all nodes, never nullptr.
+   *          It doesn't change after being returned, call again for a newer
+   *          one.
+   */
+  std::shared_ptr<const Snapshot> getSnapshot() const {
+    return snapshot_.get();
+  }
+
   void waitForRefresh();
 
  private:
@@ -156,6 +215,10 @@ class ClusterState {
 
   void notifyRefreshComplete();
 
+  // Builds and publishes a new Snapshot from node_state_list_ and
+  // boycotted_nodes_. Must be called with mutex_ held, shared or exclusive.
+  void publishSnapshot();
+
   folly::SharedMutex mutex_;
   std::unique_ptr<std::atomic<NodeState>[]> node_state_list_ { nullptr };
   size_t cluster_size_{0};
@@ -169,5 +232,11 @@ class ClusterState {
   folly::SharedMutex shutdown_mutex_;
   FastUpdateableSharedPtr<std::vector<node_index_t>> boycotted_nodes_{
       std::make_shared<std::vector<node_index_t>>()};
+
+  // Serializes publishSnapshot() calls, which may come from several threads
+  // holding mutex_ in shared mode. Acquired after mutex_.
+  std::mutex snapshot_mutex_;
+  uint64_t snapshot_version_{0};
+  FastUpdateableSharedPtr<Snapshot> snapshot_{std::make_shared<Snapshot>()};
 };
 }} // namespace facebook::logdevice
@@ -26,14 +26,21 @@ int ConfigInit::attach(const std::string& source,
                        UpdateableSettings<Settings> settings,
                        const ConfigParserOptions& options) {
   int rv;
+  std::string server_config_cache_path = settings->server_config_cache_path;
+  std::chrono::seconds server_config_cache_max_age =
+      settings->server_config_cache_max_age;
   auto updater = std::make_shared<TextConfigUpdater>(
       updateable_config, std::move(settings), stats_);
   updater->registerSource(
       std::make_unique<FileConfigSource>(file_polling_interval_));
   updater->registerSource(
       std::make_unique<ZookeeperConfigSource>(zk_polling_interval_));
-  updater->registerSource(std::make_unique<ServerConfigSource>(
-      alternative_logs_config.get(), plugin, plugin_registry));
+  updater->registerSource(
+      std::make_unique<ServerConfigSource>(alternative_logs_config.get(),
+                                           plugin,
+                                           plugin_registry,
+                                           server_config_cache_path,
+                                           server_config_cache_max_age));
 
   // Ask the plugin if it wants to register additional sources
   plugin->registerConfigSources(*updater, zk_polling_interval_);
@@ -93,7 +93,8 @@ std::unique_ptr<CopySetManager> CopySetSelectorFactory::createManager(
     const Settings& settings,
     bool sticky_copysets,
     size_t sticky_copysets_block_size,
-    std::chrono::milliseconds sticky_copysets_block_max_time) {
+    std::chrono::milliseconds sticky_copysets_block_max_time,
+    std::chrono::milliseconds sticky_copysets_block_time_alignment) {
   std::unique_ptr<CopySetSelector> copyset_selector =
       create(logid, epoch_metadata, nodeset_state, config, log_attrs, settings);
   std::unique_ptr<CopySetManager> res;
@@ -102,7 +103,8 @@ std::unique_ptr<CopySetManager> CopySetSelectorFactory::createManager(
         new StickyCopySetManager(std::move(copyset_selector),
                                  nodeset_state,
                                  sticky_copysets_block_size,
-                                 sticky_copysets_block_max_time));
+                                 sticky_copysets_block_max_time,
+                                 sticky_copysets_block_time_alignment));
   } else {
     res = std::unique_ptr<CopySetManager>(new PassThroughCopySetManager(
         std::move(copyset_selector), nodeset_state));
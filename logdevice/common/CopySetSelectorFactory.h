@@ -57,7 +57,8 @@ class CopySetSelectorFactory {
                 const Settings& settings,
                 bool sticky_copysets,
                 size_t sticky_copysets_block_size,
-                std::chrono::milliseconds sticky_copysets_block_max_time);
+                std::chrono::milliseconds sticky_copysets_block_max_time,
+                std::chrono::milliseconds sticky_copysets_block_time_alignment);
 };
 
 }} // namespace facebook::logdevice
@@ -24,7 +24,8 @@ DataRecordOwnsPayload::DataRecordOwnsPayload(
     std::shared_ptr<BufferedWriteDecoder> decoder,
     int batch_offset,
     uint64_t byte_offset,
-    bool invalid_checksum)
+    bool invalid_checksum,
+    std::shared_ptr<const void> payload_owner)
     : DataRecord(log_id,
                  std::move(payload),
                  lsn,
@@ -34,10 +35,11 @@ DataRecordOwnsPayload::DataRecordOwnsPayload(
       flags_(flags),
       invalid_checksum_(invalid_checksum),
       extra_metadata_(std::move(extra_metadata)),
-      decoder_(std::move(decoder)) {}
+      decoder_(std::move(decoder)),
+      payload_owner_(std::move(payload_owner)) {}
 
 DataRecordOwnsPayload::~DataRecordOwnsPayload() {
-  if (!decoder_) {
+  if (!decoder_ && !payload_owner_) {
     if (payload.data()) {
       free(const_cast<void*>(payload.data()));
     } else {
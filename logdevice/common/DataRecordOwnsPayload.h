@@ -18,20 +18,23 @@ class BufferedWriteDecoder;
 struct ExtraMetadata;
 
 /**
- * Simple wrapper around DataRecord that owns the payload in one of two ways:
- * - Unique ownership, when decoder_ is null.  This is the most common;
- *   DataRecordOwnsPayload will free() the payload.
+ * Simple wrapper around DataRecord that owns the payload in one of three ways:
+ * - Unique ownership, when decoder_ and payload_owner_ are null.  This is the
+ *   most common; DataRecordOwnsPayload will free() the payload.
  * - Shared ownership, when decoder_ is non-null.  This record is part of a
  *   group that was decoded together; decoder_ owns the memory for all of
  *   them.
+ * - Ownership through payload_owner_, when it is non-null, e.g. for a
+ *   payload that was zero-copied from the socket into an evbuffer.
  */
 struct DataRecordOwnsPayload : public DataRecord {
   /**
-   * If `decoder' is null, takes ownership of the payload contained in the
-   * record.  The payload must have been allocated with malloc().
+   * If `decoder' and `payload_owner' are null, takes ownership of the payload
+   * contained in the record.  The payload must have been allocated with
+   * malloc().
    *
-   * If `decoder' is non-null, `payload' is expected to be a soft pointer into
-   * memory owned by the decoder.
+   * If `decoder' or `payload_owner' is non-null, `payload' is expected to be
+   * a soft pointer into memory owned by it.
    */
   explicit DataRecordOwnsPayload(logid_t log_id,
                                  Payload&& payload,
@@ -44,7 +47,9 @@ struct DataRecordOwnsPayload : public DataRecord {
                                      std::shared_ptr<BufferedWriteDecoder>(),
                                  int batch_offset = 0,
                                  uint64_t byte_offset = BYTE_OFFSET_INVALID,
-                                 bool invalid_checksum = false);
+                                 bool invalid_checksum = false,
+                                 std::shared_ptr<const void> payload_owner =
+                                     std::shared_ptr<const void>());
 
   ~DataRecordOwnsPayload() override;
 
@@ -60,6 +65,10 @@ struct DataRecordOwnsPayload : public DataRecord {
 
   // Decoder that owns memory if sharing ownership with other instances
   const std::shared_ptr<BufferedWriteDecoder> decoder_;
+
+  // If set, owns the memory of the payload instead of this record, e.g. the
+  // evbuffer that RECORD_Message zero-copied the payload into
+  const std::shared_ptr<const void> payload_owner_;
 };
 
 }} // namespace facebook::logdevice
@@ -7,6 +7,8 @@
  */
 #include "logdevice/common/DataSizeRequest.h"
 
+#include <algorithm>
+
 #include <folly/Memory.h>
 
 #include "logdevice/common/EventLoop.h"
@@ -14,7 +16,10 @@
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/DATA_SIZE_BATCH_Message.h"
 #include "logdevice/common/protocol/DATA_SIZE_Message.h"
+#include "logdevice/common/settings/Settings.h"
+#include "logdevice/common/stats/Stats.h"
 
 namespace facebook { namespace logdevice {
 
@@ -225,6 +230,10 @@ StorageSetAccessor::SendResult DataSizeRequest::sendTo(ShardID shard) {
   NodeID to(shard.node());
   DATA_SIZE_Header header = {
       id_, log_id_, shard.shard(), start_.count(), end_.count()};
+  if (Worker::onThisThread()->runningDataSize().enqueueForBatch(
+          header, shard)) {
+    return StorageSetAccessor::SendResult::SUCCESS;
+  }
   auto msg = std::make_unique<DATA_SIZE_Message>(header);
   if (Worker::onThisThread()->sender().sendMessage(std::move(msg), to) != 0) {
     if (err == E::PROTONOSUPPORT) {
@@ -444,4 +453,41 @@ void DataSizeRequest::deleteThis() {
   map.erase(it); // destroys unique_ptr which owns this
 }
 
+size_t DataSizeRequestMap::getMaxBatchSize() const {
+  return Worker::settings().log_query_batch_size;
+}
+
+uint16_t DataSizeRequestMap::getMinBatchProtocol() const {
+  return Compatibility::LOG_QUERY_BATCH_SUPPORT;
+}
+
+std::unique_ptr<Message>
+DataSizeRequestMap::createBatchMessage(shard_index_t shard,
+                                       std::vector<DATA_SIZE_Header> entries) {
+  return std::make_unique<DATA_SIZE_BATCH_Message>(shard, std::move(entries));
+}
+
+std::unique_ptr<Message>
+DataSizeRequestMap::createMessage(const DATA_SIZE_Header& header) {
+  return std::make_unique<DATA_SIZE_Message>(header);
+}
+
+bool DataSizeRequestMap::isRunning(request_id_t rqid) const {
+  return map.count(rqid);
+}
+
+void DataSizeRequestMap::onMessageSent(request_id_t rqid,
+                                       ShardID to,
+                                       Status st) {
+  auto it = map.find(rqid);
+  if (it != map.end()) {
+    it->second->onMessageSent(to, st);
+  }
+}
+
+void DataSizeRequestMap::onBatchSent(size_t num_entries) {
+  WORKER_STAT_INCR(log_query_batches_sent);
+  WORKER_STAT_ADD(log_query_batched_requests, num_entries);
+}
+
 }} // namespace facebook::logdevice
@@ -7,12 +7,20 @@
  */
 #pragma once
 
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "logdevice/common/NodeSetAccessor.h"
 #include "logdevice/common/NodeSetFinder.h"
 #include "logdevice/common/Request.h"
 #include "logdevice/common/RequestType.h"
 #include "logdevice/common/ShardAuthoritativeStatusMap.h"
+#include "logdevice/common/ShardBatcher.h"
+#include "logdevice/common/Timer.h"
 #include "logdevice/common/configuration/Configuration.h"
+#include "logdevice/common/protocol/DATA_SIZE_Message.h"
 #include "logdevice/include/Client.h"
 
 namespace facebook { namespace logdevice {
@@ -56,11 +64,26 @@ namespace facebook { namespace logdevice {
 class DataSizeRequest;
 
 // Wrapper instead of typedef to allow forward-declaring in Worker.h
-struct DataSizeRequestMap {
+//
+// Also batches the DATA_SIZEs for the same shard into DATA_SIZE_BATCH
+// messages of up to Settings::log_query_batch_size entries, see ShardBatcher.
+struct DataSizeRequestMap : public ShardBatcher<DATA_SIZE_Header> {
   std::unordered_map<request_id_t,
                      std::unique_ptr<DataSizeRequest>,
                      request_id_t::Hash>
       map;
+
+ protected:
+  size_t getMaxBatchSize() const override;
+  uint16_t getMinBatchProtocol() const override;
+  std::unique_ptr<Message>
+  createBatchMessage(shard_index_t shard,
+                     std::vector<DATA_SIZE_Header> entries) override;
+  std::unique_ptr<Message>
+  createMessage(const DATA_SIZE_Header& header) override;
+  bool isRunning(request_id_t rqid) const override;
+  void onMessageSent(request_id_t rqid, ShardID to, Status st) override;
+  void onBatchSent(size_t num_entries) override;
 };
 
 static_assert(static_cast<int>(DataSizeAccuracy::COUNT) == 1,
@@ -17,7 +17,7 @@ void Envelope::operator()(FlowGroup& fg, std::mutex& flow_meters_mutex) {
   if (!fg.drain(*this)) {
     // Should never happen.
     ld_check(false);
-    fg.push(*this, priority());
+    fg.push(*this);
     return;
   }
   socket().releaseMessage(*this);
@@ -38,7 +38,8 @@ EpochMetaData::UpdateResult EpochMetaDataUpdaterBase::generateNewMetaData(
     bool use_storage_set_format,
     bool provision_if_empty,
     bool update_if_exists,
-    bool force_update) {
+    bool force_update,
+    const NodeSetSelector::Options* selector_options) {
   const std::shared_ptr<LogsConfig::LogGroupNode> logcfg =
       config->getLogGroupByIDShared(log_id);
   if (!logcfg) {
@@ -72,10 +73,13 @@ EpochMetaData::UpdateResult EpochMetaDataUpdaterBase::generateNewMetaData(
       metadata_needs_provisioning ? nullptr : &info->shards;
   std::unique_ptr<StorageSet> new_storage_set;
   NodeSetSelector::Decision decision;
-  NodeSetSelector::Options selector_options;
+  NodeSetSelector::Options default_options;
 
   std::tie(decision, new_storage_set) = nodeset_selector->getStorageSet(
-      log_id, config, old_storage_set, &selector_options);
+      log_id,
+      config,
+      old_storage_set,
+      selector_options ? selector_options : &default_options);
 
   switch (decision) {
     case NodeSetSelector::Decision::FAILED:
@@ -307,7 +311,8 @@ operator()(logid_t log_id,
                                 use_storage_set_format_,
                                 provision_if_empty_,
                                 true /* update_if_exists */,
-                                true /* force_udpate */);
+                                true /* force_udpate */,
+                                &selector_options_);
       // If we detected changes are required, they should happen
       ld_check(res != EpochMetaData::UpdateResult::UNCHANGED);
       if (res == EpochMetaData::UpdateResult::FAILED) {
@@ -61,6 +61,8 @@ class EpochMetaDataUpdaterBase : public EpochMetaData::Updater {
    *                               the operation will fail with E::EXISTS
    * @param force_update           update the metadata even if the nodeset
    *                               doesn't change
+   * @param selector_options       options passed to the nodeset selector,
+   *                               can be nullptr
    */
   EpochMetaData::UpdateResult
   generateNewMetaData(logid_t log_id,
@@ -71,7 +73,9 @@ class EpochMetaDataUpdaterBase : public EpochMetaData::Updater {
                       bool use_storage_set_format,
                       bool provision_if_empty = false,
                       bool update_if_exists = true,
-                      bool force_update = false);
+                      bool force_update = false,
+                      const NodeSetSelector::Options* selector_options =
+                          nullptr);
 };
 
 class EpochMetaDataUpdater final : public EpochMetaDataUpdaterBase {
@@ -152,11 +156,13 @@ class EpochMetaDataUpdateToNextEpoch final : public EpochMetaDataUpdaterBase {
       std::shared_ptr<Configuration> config = nullptr,
       folly::Optional<epoch_t> acceptable_activation_epoch = folly::none,
       bool use_storage_set_format = false,
-      bool provision_if_empty = true)
+      bool provision_if_empty = true,
+      NodeSetSelector::Options selector_options = NodeSetSelector::Options())
       : config_(std::move(config)),
         acceptable_activation_epoch_(acceptable_activation_epoch),
         use_storage_set_format_(use_storage_set_format),
-        provision_if_empty_(provision_if_empty) {}
+        provision_if_empty_(provision_if_empty),
+        selector_options_(std::move(selector_options)) {}
 
   EpochMetaData::UpdateResult operator()(logid_t log_id,
                                          std::unique_ptr<EpochMetaData>& info,
@@ -185,6 +191,9 @@ class EpochMetaDataUpdateToNextEpoch final : public EpochMetaDataUpdaterBase {
   folly::Optional<epoch_t> acceptable_activation_epoch_;
   bool use_storage_set_format_;
   bool provision_if_empty_;
+  // Passed to the nodeset selector when provisioning or updating metadata,
+  // e.g. shard loads for load-aware nodeset selection.
+  NodeSetSelector::Options selector_options_;
 };
 
 /**
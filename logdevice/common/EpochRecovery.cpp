@@ -256,6 +256,20 @@ void EpochRecovery::onDigestRecord(
     return;
   }
 
+  // Account for the payloads shipped in digests, and for how much of that is
+  // for records another shard already sent, which a digest made of record
+  // metadata with payloads fetched on demand would save.
+  const size_t payload_size = record->payload.size();
+  STAT_INCR(deps_->getStats(), epoch_recovery_digest_records);
+  STAT_ADD(
+      deps_->getStats(), epoch_recovery_digest_payload_bytes, payload_size);
+  const Digest::Entry* entry = digest_.findEntry(lsn_to_esn(lsn));
+  if (entry != nullptr && entry->record != nullptr) {
+    STAT_ADD(deps_->getStats(),
+             epoch_recovery_digest_duplicate_payload_bytes,
+             payload_size);
+  }
+
   digest_.onRecord(from, std::move(record));
   // ownership of record was transferred to digest_
 
@@ -1097,9 +1111,7 @@ void EpochRecovery::onNodeStateChanged(ShardID shard, RecoveryNode::State to) {
 }
 
 void EpochRecovery::activate(const TailRecord& prev_tail_record) {
-  ld_check(!active_);
-
-  active_ = true;
+  ld_check(!tail_record_before_this_epoch_.isValid());
 
   ld_check(prev_tail_record.isValid());
   ld_check(!prev_tail_record.containOffsetWithinEpoch());
@@ -1108,6 +1120,23 @@ void EpochRecovery::activate(const TailRecord& prev_tail_record) {
   last_timestamp_ =
       std::max(last_timestamp_, prev_tail_record.header.timestamp);
 
+  if (active_) {
+    // The digest was started by activateDigest() and may be waiting for the
+    // tail record to complete.
+    onDigestMayHaveBecomeComplete();
+    return;
+  }
+
+  active_ = true;
+  activation_time_ = std::chrono::steady_clock::now();
+
+  onSealedOrActivated();
+}
+
+void EpochRecovery::activateDigest() {
+  ld_check(!active_);
+
+  active_ = true;
   activation_time_ = std::chrono::steady_clock::now();
 
   onSealedOrActivated();
@@ -1331,6 +1360,12 @@ bool EpochRecovery::onDigestMayHaveBecomeComplete(bool grace_period_expired) {
     return false;
   }
 
+  if (!tail_record_before_this_epoch_.isValid()) {
+    // Only the digest is active, see activateDigest(). Keep building it until
+    // the previous epochs are recovered. activate() calls us again then.
+    return false;
+  }
+
   // note: this function might get called even in SEAL state, e.g., on
   // authoritative status changes
   ld_check(state_ <= State::DIGEST);
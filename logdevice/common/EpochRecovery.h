@@ -439,7 +439,8 @@ class EpochRecovery {
 
   /**
    * Set active_ to true. If enough recovery nodes are in SEALED,
-   * request digest records from them.
+   * request digest records from them. If the digest was started early by
+   * activateDigest(), lets it complete.
    *
    * @param tail_record     Tail record of the previous epoch that
    *                        has been successfully recovered. Contains
@@ -450,6 +451,14 @@ class EpochRecovery {
    */
   void activate(const TailRecord& prev_tail_record);
 
+  /**
+   * Set active_ to true and start building the digest while previous epochs
+   * are still being recovered, see --recovery-max-concurrent-epochs. The
+   * digest is not completed, and mutations don't start, until activate()
+   * provides the tail record of the previous epoch.
+   */
+  void activateDigest();
+
   /**
    * @return true iff this RecoveryEpoch is done building the digest and
    *         is now in the mutation and cleaning phase
@@ -643,7 +652,8 @@ class EpochRecovery {
   TailRecord tail_record_from_sealed_;
 
   // the tail record before the epoch being recovered. set when this state
-  // machine got activated by driver_
+  // machine got activated by driver_. Invalid while only the digest is
+  // active, see activateDigest().
   TailRecord tail_record_before_this_epoch_;
 
   // if valid, this is the tail record of the log until the end of this epoch,
@@ -33,7 +33,8 @@ EpochSequencer::EpochSequencer(logid_t log_id,
                                std::unique_ptr<EpochMetaData> metadata,
                                int window_size,
                                esn_t esn_max,
-                               Sequencer* parent)
+                               Sequencer* parent,
+                               size_t min_window_size)
     : parent_(parent),
       log_id_(log_id),
       epoch_(epoch),
@@ -42,7 +43,12 @@ EpochSequencer::EpochSequencer(logid_t log_id,
       window_(epoch, window_size, esn_max),
       lng_(compose_lsn(epoch, ESN_INVALID)),
       last_reaped_(compose_lsn(epoch, ESN_INVALID)),
-      offset_within_epoch_(0) {}
+      offset_within_epoch_(0) {
+  if (min_window_size > 0 && min_window_size < window_.capacity()) {
+    adaptive_window_ = std::make_unique<AdaptiveWindowController>(
+        min_window_size, window_.capacity());
+  }
+}
 
 RunAppenderStatus EpochSequencer::runAppender(Appender* appender) {
   if (!appender || appender->started()) {
@@ -57,6 +63,14 @@ RunAppenderStatus EpochSequencer::runAppender(Appender* appender) {
     return RunAppenderStatus::ERROR_DELETE;
   }
 
+  if (adaptive_window_ && window_.size() >= adaptive_window_->getLimit()) {
+    // Not atomic with grow(), so the limit may be exceeded by a few Appenders
+    // racing on different Workers, which is fine as capacity is the hard
+    // limit.
+    err = E::NOBUFS;
+    return RunAppenderStatus::ERROR_DELETE;
+  }
+
   lsn_t lsn = window_.grow(appender);
   if (lsn == LSN_INVALID) {
     // 1. window full;
@@ -351,7 +365,8 @@ void EpochSequencer::createOrUpdateCopySetManager(
       settings,
       settings.write_sticky_copysets,
       settings.sticky_copysets_block_size,
-      settings.sticky_copysets_block_max_time));
+      settings.sticky_copysets_block_max_time,
+      settings.sticky_copysets_block_time_alignment));
 }
 
 void EpochSequencer::noteConfigurationChanged(
@@ -513,6 +528,14 @@ copyset_size_t EpochSequencer::getSynced() const {
   return parent_ != nullptr ? parent_->getSynced() : 0;
 }
 
+copyset_size_t EpochSequencer::getHedgedCopies() const {
+  return parent_ != nullptr ? parent_->getHedgedCopies() : 0;
+}
+
+bool EpochSequencer::isStreamingIngest() const {
+  return parent_ != nullptr && parent_->isStreamingIngest();
+}
+
 Processor* EpochSequencer::getProcessor() const {
   return parent_->getProcessor();
 }
@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -14,6 +15,7 @@
 
 #include <folly/concurrency/AtomicSharedPtr.h>
 
+#include "logdevice/common/AdaptiveWindowController.h"
 #include "logdevice/common/Appender.h"
 #include "logdevice/common/SlidingWindowSingleEpoch.h"
 #include "logdevice/common/UpdateableSharedPtr.h"
@@ -104,13 +106,19 @@ class EpochSequencer : public std::enable_shared_from_this<EpochSequencer> {
    *                     to accept new appends (i.e., they fail with E::TOOBIG)
    *
    * @param parent       parent sequencer object managing all epochs of the log
+   *
+   * @param min_window_size  if non-zero, the number of Appenders accepted
+   *                         in flight adapts to the observed append latency
+   *                         and throughput, between min_window_size and
+   *                         window_size (see AdaptiveWindowController)
    */
   EpochSequencer(logid_t log_id,
                  epoch_t epoch,
                  std::unique_ptr<EpochMetaData> metadata,
                  int window_size,
                  esn_t esn_max,
-                 Sequencer* parent);
+                 Sequencer* parent,
+                 size_t min_window_size = 0);
 
   virtual ~EpochSequencer() {}
 
@@ -154,12 +162,24 @@ class EpochSequencer : public std::enable_shared_from_this<EpochSequencer> {
    *    NOSEQUENCER   EpochSequencer is not in ACTIVE state
    *    INVALID_PARAM appender is nullptr or already running
    *                  (debug build asserts)
-   *    NOBUFS        too many append requests are already in flight
+   *    NOBUFS        too many append requests are already in flight, or
+   *                  the adaptive window limit was reached
    *    TOOBIG        ESNs for this epoch have been exhausted
    *    SYSLIMIT      system-wide resource limit has been reached
    */
   virtual RunAppenderStatus runAppender(Appender* appender);
 
+  /**
+   * Called by an Appender of this epoch when its record became fully
+   * replicated, @param latency after the Appender was created. Feeds the
+   * adaptive window, if enabled.
+   */
+  void noteAppendCompleted(std::chrono::microseconds latency) {
+    if (adaptive_window_) {
+      adaptive_window_->onAppendCompleted(latency);
+    }
+  }
+
   /**
    * Tells the EpochSequencer that the Appender whose record was assigned
    * @param lsn has fully stored the record, and the record may
@@ -273,6 +293,13 @@ class EpochSequencer : public std::enable_shared_from_this<EpochSequencer> {
     return window_.can_grow();
   }
 
+  /**
+   * @return  number of LSNs still available to issue in this epoch
+   */
+  uint64_t getNumAvailableLsns() const {
+    return window_.esns_left();
+  }
+
   /**
    * @return current number of appends in flight (current size of window of
    * appenders).
@@ -285,6 +312,15 @@ class EpochSequencer : public std::enable_shared_from_this<EpochSequencer> {
     return window_.capacity();
   }
 
+  /**
+   * @return  number of appends currently allowed in flight; smaller than
+   *          getMaxWindowSize() if the window is adaptive and the log doesn't
+   *          need all of it
+   */
+  size_t getWindowLimit() const {
+    return adaptive_window_ ? adaptive_window_->getLimit() : window_.capacity();
+  }
+
   uint64_t getOffsetWithinEpoch() const {
     return offset_within_epoch_.load();
   }
@@ -360,6 +396,8 @@ class EpochSequencer : public std::enable_shared_from_this<EpochSequencer> {
 
   copyset_size_t getExtras() const;
   copyset_size_t getSynced() const;
+  copyset_size_t getHedgedCopies() const;
+  bool isStreamingIngest() const;
 
   virtual void noteAppenderPreempted(epoch_t epoch, NodeID preempted_by);
 
@@ -416,6 +454,9 @@ class EpochSequencer : public std::enable_shared_from_this<EpochSequencer> {
   // the next sequence number to use.
   SlidingWindowSingleEpoch<Appender, Appender::Reaper> window_;
 
+  // if set, limits the number of Appenders in window_ below its capacity
+  std::unique_ptr<AdaptiveWindowController> adaptive_window_;
+
   // for serializing state changes
   mutable std::mutex state_mutex_;
 
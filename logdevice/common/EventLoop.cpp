@@ -28,9 +28,25 @@ __thread EventLoop* EventLoop::thisThreadLoop;
 
 static const struct timeval tv_zero { 0, 0 };
 
-static struct event_base* createEventBase() {
+static struct event_base* createEventBase(bool epoll_changelist) {
   int rv;
-  struct event_base* base = LD_EV(event_base_new)();
+  struct event_base* base;
+  if (epoll_changelist) {
+    struct event_config* cfg = LD_EV(event_config_new)();
+    if (!cfg) {
+      ld_error("Failed to create an event config for an EventLoop thread");
+      err = E::NOMEM;
+      return nullptr;
+    }
+    // Instead of an epoll_ctl() call for every change to the events a
+    // socket waits for, apply them all at once before the next
+    // epoll_wait(). Changes that cancel each other out cost no syscall.
+    LD_EV(event_config_set_flag)(cfg, EVENT_BASE_FLAG_EPOLL_USE_CHANGELIST);
+    base = LD_EV(event_base_new_with_config)(cfg);
+    LD_EV(event_config_free)(cfg);
+  } else {
+    base = LD_EV(event_base_new)();
+  }
 
   if (!base) {
     ld_error("Failed to create an event base for an EventLoop thread");
@@ -60,8 +76,10 @@ static void deleteEventBase(struct event_base* base) {
   }
 }
 
-EventLoop::EventLoop(std::string thread_name, ThreadID::Type thread_type)
-    : base_(createEventBase(), deleteEventBase),
+EventLoop::EventLoop(std::string thread_name,
+                     ThreadID::Type thread_type,
+                     bool epoll_changelist)
+    : base_(createEventBase(epoll_changelist), deleteEventBase),
       zero_timeout_(
           base_ ? LD_EV(event_base_init_common_timeout)(base_.get(), &tv_zero)
                 : nullptr),
@@ -152,7 +170,11 @@ void EventLoop::run() {
   ld_check(base_);
   // this runs until our EventLoopHandle closes its end of the pipe or there
   // is a fatal error
-  rv = LD_EV(event_base_loop)(base_.get(), 0);
+  if (busy_poll_spin_.count() > 0) {
+    rv = runBusyPoll();
+  } else {
+    rv = LD_EV(event_base_loop)(base_.get(), 0);
+  }
   if (rv != 0) {
     ld_error("event_base_loop() exited abnormally with return value %d.", rv);
   }
@@ -163,4 +185,27 @@ void EventLoop::run() {
   // the thread on which this EventLoop ran terminates here
 }
 
+int EventLoop::runBusyPoll() {
+  using namespace std::chrono;
+  event_base* base = base_.get();
+  size_t handlers_called = event_handlers_called_.load();
+  auto spin_until = steady_clock::now() + busy_poll_spin_;
+
+  while (true) {
+    // Poll without blocking until nothing happened for busy_poll_spin_, then
+    // block until something does.
+    const bool spin = steady_clock::now() < spin_until;
+    int rv = LD_EV(event_base_loop)(
+        base, spin ? EVLOOP_ONCE | EVLOOP_NONBLOCK : EVLOOP_ONCE);
+    if (rv != 0 || LD_EV(event_base_got_break)(base) ||
+        LD_EV(event_base_got_exit)(base)) {
+      return rv;
+    }
+    if (!spin || event_handlers_called_.load() != handlers_called) {
+      handlers_called = event_handlers_called_.load();
+      spin_until = steady_clock::now() + busy_poll_spin_;
+    }
+  }
+}
+
 }} // namespace facebook::logdevice
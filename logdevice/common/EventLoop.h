@@ -8,6 +8,7 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <functional>
 #include <memory>
@@ -39,6 +40,10 @@ class EventLoop {
    * immediately start running the event loop, that only happens after start()
    * is called.
    *
+   * @param epoll_changelist  if true, the event base batches changes to the
+   *                          events it waits for into the next epoll_wait(),
+   *                          see EVENT_BASE_FLAG_EPOLL_USE_CHANGELIST
+   *
    * @throws ConstructorFailed on error, sets err to
    *   NOMEM    if a libevent call failed because malloc() failed
    *   INTERNAL if a libevent call fails unexpectedly
@@ -47,7 +52,8 @@ class EventLoop {
    */
   explicit EventLoop(
       std::string thread_name = "",
-      ThreadID::Type thread_type = ThreadID::Type::UNKNOWN_EVENT_LOOP);
+      ThreadID::Type thread_type = ThreadID::Type::UNKNOWN_EVENT_LOOP,
+      bool epoll_changelist = false);
 
   // destructor has to be virtual because it is invoked by EventLoop::run()
   // as "delete this"
@@ -133,7 +139,17 @@ class EventLoop {
   // called on this EventLoop's thread before starting the event loop
   virtual void onThreadStarted() {}
 
+  // If positive, the loop busy-polls: after handling events, it keeps
+  // polling for more without blocking for this long before it blocks in
+  // epoll_wait() again. This saves the wakeup latency of a blocked thread
+  // when requests are posted or data arrives, at the cost of a CPU spinning
+  // while the loop is idle. May be set by onThreadStarted().
+  std::chrono::microseconds busy_poll_spin_{0};
+
  private:
+  // event_base_loop() for busy_poll_spin_ > 0, see above
+  int runBusyPoll();
+
   ThreadID::Type thread_type_;
   std::string thread_name_;
 
@@ -147,6 +147,18 @@ class EventLoopHandle {
     return request_pump_->forcePost(rq);
   }
 
+  /**
+   * Like postRequest() and forcePostRequest() for several requests at once,
+   * waking up the EventLoop once. See RequestPump::tryPost().
+   */
+  int postRequests(std::vector<std::unique_ptr<Request>>& rqs) {
+    return request_pump_->tryPost(rqs);
+  }
+
+  int forcePostRequests(std::vector<std::unique_ptr<Request>>& rqs) {
+    return request_pump_->forcePost(rqs);
+  }
+
   /**
    * Runs a Request on the EventLoop, waiting for it to finish.
    *
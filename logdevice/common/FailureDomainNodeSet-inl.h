@@ -440,14 +440,24 @@ template <typename AttrType, typename HashFn>
 template <typename AttrPred>
 FmajorityResult
 FailureDomainNodeSet<AttrType, HashFn>::isFmajority(AttrPred pred) const {
+  // A complete domain has at least one shard with the attribute(s). If there
+  // are fewer such shards than the number of complete domains needed for an
+  // f-majority at any scope, and fewer than the fully authoritative shards
+  // needed for a complete set, the answer is NONE without looking at the
+  // domains. This is the common case for ClientReadStream in single copy
+  // delivery mode, where few shards of a possibly large storage set have a
+  // gap state at any time.
+  const size_t n_with_attr = countShards(pred);
+  if (n_with_attr < numFullyAuthoritative() &&
+      !anyScope([&](const ScopeState& scope) {
+        return n_with_attr >= fmajorityAtScope(scope);
+      })) {
+    return FmajorityResult::NONE;
+  }
+
   // We have an f-majority if we have a f-majority for at least one scope.
   const bool f_maj = anyScope([&](const ScopeState& scope) {
-    ld_check(scope.domains.size() >= scope.n_empty);
-    const size_t n_non_empty = scope.domains.size() - scope.n_empty;
-    const size_t f_majority = n_non_empty >= scope.replication - 1
-        ? n_non_empty - scope.replication + 1
-        : 0;
-    return countCompleteDomains(pred, scope) >= f_majority;
+    return countCompleteDomains(pred, scope) >= fmajorityAtScope(scope);
   });
 
   if (f_maj) {
@@ -459,6 +469,16 @@ FailureDomainNodeSet<AttrType, HashFn>::isFmajority(AttrPred pred) const {
   }
 }
 
+template <typename AttrType, typename HashFn>
+size_t FailureDomainNodeSet<AttrType, HashFn>::fmajorityAtScope(
+    const ScopeState& scope) {
+  ld_check(scope.domains.size() >= scope.n_empty);
+  const size_t n_non_empty = scope.domains.size() - scope.n_empty;
+  return n_non_empty >= scope.replication - 1
+      ? n_non_empty - scope.replication + 1
+      : 0;
+}
+
 template <typename AttrType, typename HashFn>
 bool FailureDomainNodeSet<AttrType, HashFn>::canReplicateAtScope(
     attr_pred_t pred,
@@ -506,11 +526,14 @@ template <typename AttrType, typename HashFn>
 template <typename AttrPred>
 bool FailureDomainNodeSet<AttrType, HashFn>::isCompleteSet(
     AttrPred pred) const {
+  const size_t n_fully = numFullyAuthoritative();
+  if (countShards(pred) < n_fully) {
+    // Not enough shards have the attribute(s), whatever their status.
+    return false;
+  }
   // n_shards is the number of fully authoritative shards that have the
   // attribute(s) set.
   const size_t n_shards = countCompleteDomains(pred, shard_scope_);
-  const size_t n_fully = numShards(AuthoritativeStatus::FULLY_AUTHORITATIVE) +
-      numShards(AuthoritativeStatus::UNAVAILABLE);
   ld_check(n_shards <= n_fully);
   return n_shards == n_fully;
 }
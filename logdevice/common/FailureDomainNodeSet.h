@@ -91,7 +91,11 @@ namespace facebook { namespace logdevice {
  * - Changing the authoritative status of a shard consists of a number of
  *   operations equal to the number of replication scopes times the number of
  *   different values for the attribute currently in use;
- * - isFmajority is linear to the number of replication scopes;
+ * - isFmajority is linear to the number of replication scopes when used with
+ *   an attribute value. With an attribute predicate, it is
+ *   O(num attrs * num domains) in the worst case, but only linear to the
+ *   number of replication scopes and attrs when too few shards match the
+ *   predicate for an f-majority, which is checked first;
  * - canReplicate is linear to the number of replication scopes when used with
  *   an attribute value, or O(num attrs * replication * num scopes) in the worst
  *   case if used with an attribute predicate.
@@ -345,6 +349,15 @@ class FailureDomainNodeSet {
   mutable size_t consistency_check_counter_ = 0;
   bool full_consistency_check_{false};
 
+  // Number of shards that are FULLY_AUTHORITATIVE or UNAVAILABLE.
+  size_t numFullyAuthoritative() const {
+    return numShards(AuthoritativeStatus::FULLY_AUTHORITATIVE) +
+        numShards(AuthoritativeStatus::UNAVAILABLE);
+  }
+
+  // Number of complete domains needed for an f-majority at a scope.
+  static size_t fmajorityAtScope(const ScopeState& scope);
+
   static bool isFully(AuthoritativeStatus st) {
     return st == AuthoritativeStatus::FULLY_AUTHORITATIVE ||
         st == AuthoritativeStatus::UNAVAILABLE;
@@ -7,6 +7,8 @@
  */
 #include "FindKeyRequest.h"
 
+#include <algorithm>
+
 #include <folly/Memory.h>
 #include <folly/Random.h>
 
@@ -15,6 +17,7 @@
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/FINDKEY_BATCH_Message.h"
 #include "logdevice/common/protocol/FINDKEY_Message.h"
 #include "logdevice/common/settings/Settings.h"
 #include "logdevice/common/stats/Stats.h"
@@ -139,6 +142,10 @@ StorageSetAccessor::SendResult FindKeyRequest::sendTo(ShardID shard) {
 }
 
 int FindKeyRequest::sendOneMessage(const FINDKEY_Header& header, ShardID to) {
+  if (!key_.hasValue() &&
+      Worker::onThisThread()->runningFindKey().enqueueForBatch(header, to)) {
+    return 0;
+  }
   auto msg = std::make_unique<FINDKEY_Message>(header, key_);
   NodeID node_id(to.node());
   return Worker::onThisThread()->sender().sendMessage(std::move(msg), node_id);
@@ -364,4 +371,42 @@ std::shared_ptr<ServerConfig> FindKeyRequest::getConfig() const {
   return Worker::onThisThread()->getConfig()->serverConfig();
 }
 
+size_t FindKeyRequestMap::getMaxBatchSize() const {
+  return Worker::settings().findtime_batch_size;
+}
+
+uint16_t FindKeyRequestMap::getMinBatchProtocol() const {
+  return Compatibility::FINDKEY_BATCH_SUPPORT;
+}
+
+std::unique_ptr<Message>
+FindKeyRequestMap::createBatchMessage(shard_index_t shard,
+                                      std::vector<FINDKEY_Header> entries) {
+  return std::make_unique<FINDKEY_BATCH_Message>(shard, std::move(entries));
+}
+
+std::unique_ptr<Message>
+FindKeyRequestMap::createMessage(const FINDKEY_Header& header) {
+  // Only findTime() FINDKEYs, which carry no key, are batched.
+  return std::make_unique<FINDKEY_Message>(header, folly::none);
+}
+
+bool FindKeyRequestMap::isRunning(request_id_t rqid) const {
+  return map.count(rqid);
+}
+
+void FindKeyRequestMap::onMessageSent(request_id_t rqid,
+                                      ShardID to,
+                                      Status st) {
+  auto it = map.find(rqid);
+  if (it != map.end()) {
+    it->second->onMessageSent(to, st);
+  }
+}
+
+void FindKeyRequestMap::onBatchSent(size_t num_entries) {
+  WORKER_STAT_INCR(findtime_batches_sent);
+  WORKER_STAT_ADD(findtime_batched_requests, num_entries);
+}
+
 }} // namespace facebook::logdevice
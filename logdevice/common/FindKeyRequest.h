@@ -19,6 +19,7 @@
 #include "logdevice/common/NodeSetFinder.h"
 #include "logdevice/common/Request.h"
 #include "logdevice/common/RequestType.h"
+#include "logdevice/common/ShardBatcher.h"
 #include "logdevice/common/Timer.h"
 #include "logdevice/common/configuration/ServerConfig.h"
 #include "logdevice/common/protocol/FINDKEY_Message.h"
@@ -94,11 +95,26 @@ class FindKeyRequest;
 struct Settings;
 
 // Wrapper instead of typedef to allow forward-declaring in Worker.h
-struct FindKeyRequestMap {
+//
+// Also batches the FINDKEYs of findTime() requests for the same shard into
+// FINDKEY_BATCH messages of up to Settings::findtime_batch_size entries, see
+// ShardBatcher.
+struct FindKeyRequestMap : public ShardBatcher<FINDKEY_Header> {
   std::unordered_map<request_id_t,
                      std::unique_ptr<FindKeyRequest>,
                      request_id_t::Hash>
       map;
+
+ protected:
+  size_t getMaxBatchSize() const override;
+  uint16_t getMinBatchProtocol() const override;
+  std::unique_ptr<Message>
+  createBatchMessage(shard_index_t shard,
+                     std::vector<FINDKEY_Header> entries) override;
+  std::unique_ptr<Message> createMessage(const FINDKEY_Header& header) override;
+  bool isRunning(request_id_t rqid) const override;
+  void onMessageSent(request_id_t rqid, ShardID to, Status st) override;
+  void onBatchSent(size_t num_entries) override;
 };
 
 class FindKeyRequest : public Request,
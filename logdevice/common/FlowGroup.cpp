@@ -13,6 +13,8 @@
 
 namespace facebook { namespace logdevice {
 
+constexpr int64_t FlowGroup::FAIR_QUEUE_QUANTUM;
+
 bool FlowGroup::applyUpdate(FlowGroupsUpdate::GroupEntry& update,
                             StatsHolder* stats) {
   // Skip update work if shaping on this flow group has been and continues
@@ -140,7 +142,7 @@ bool FlowGroup::run(std::mutex& flow_meters_mutex,
     auto& meter_entry = meter_.entries[asInt(p)];
     while (!priorityq_.empty(p) && (!enabled_ || meter_entry.canDrain()) &&
            !run_limits_exceeded()) {
-      issueCallback(priorityq_.front(p), flow_meters_mutex);
+      issueCallback(nextCallback(p), flow_meters_mutex);
     }
 
     // Getting priorityq size is linear time operation instead just depend on
@@ -156,7 +158,7 @@ bool FlowGroup::run(std::mutex& flow_meters_mutex,
   // Consume all remaining priority scheduled bandwidth.
   while (!priorityq_.enabledEmpty() && canRunPriorityQ() &&
          !run_limits_exceeded()) {
-    auto& cb = priorityq_.enabledFront();
+    auto& cb = nextCallback(priorityq_.enabledFront().priority());
     if (debt(cb.priority()) > 0) {
       std::unique_lock<std::mutex> lock(flow_meters_mutex);
       transferCredit(PRIORITYQ_PRIORITY, cb.priority(), debt(cb.priority()));
@@ -205,4 +207,50 @@ bool FlowGroup::run(std::mutex& flow_meters_mutex,
   return !priorityq_.enabledEmpty() && (!enabled_ || canRunPriorityQ());
 }
 
+BWAvailableCallback& FlowGroup::nextCallback(Priority p) {
+  if (!fair_queuing_) {
+    return priorityq_.front(p);
+  }
+
+  auto& rounds = flow_rounds_[asInt(p)];
+  ld_check(!rounds.empty());
+  for (;;) {
+    Flow& flow = rounds.front();
+    if (flow.deficit > 0) {
+      return flow.queue.front();
+    }
+    // Start the Flow's turn. A Flow that overdrew its deficit in earlier
+    // rounds, by sending large messages, waits out more rounds.
+    flow.deficit += FAIR_QUEUE_QUANTUM;
+    if (flow.deficit > 0) {
+      return flow.queue.front();
+    }
+    rounds.erase(rounds.iterator_to(flow));
+    rounds.push_back(flow);
+  }
+}
+
+void FlowGroup::chargeFlow(Flow& flow, Priority p, uint64_t nbytes) {
+  if (flow.queue.empty()) {
+    // The Flow is no longer backlogged and its deficit is forgotten, as
+    // is usual for deficit round robin.
+    flows_[asInt(p)].erase(flow.socket);
+    return;
+  }
+  if (!fair_queuing_) {
+    return;
+  }
+  flow.deficit -= nbytes;
+  if (flow.deficit <= 0) {
+    auto& rounds = flow_rounds_[asInt(p)];
+    rounds.erase(rounds.iterator_to(flow));
+    rounds.push_back(flow);
+  }
+}
+
+void FlowGroup::noteDrained(const Envelope& e) {
+  bytes_drained_ += e.cost();
+  e.socket().noteFlowGroupBytesReleased(e.priority(), e.cost());
+}
+
 }} // namespace facebook::logdevice
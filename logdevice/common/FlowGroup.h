@@ -7,8 +7,11 @@
  */
 #pragma once
 
+#include <array>
 #include <thread>
+#include <unordered_map>
 
+#include <folly/IntrusiveList.h>
 #include <folly/ScopeGuard.h>
 
 #include "logdevice/common/BWAvailableCallback.h"
@@ -50,6 +53,14 @@ namespace facebook { namespace logdevice {
  *        bandwidth release frequency into per-worker and per-quantum
  *        values.
  *
+ *        Within a priority level, callbacks are released in FIFO order by
+ *        default. With --flow-groups-fair-queuing, they are instead
+ *        released by deficit round robin across the Sockets they wait to
+ *        send on, so that one peer with a deep backlog can't hold back
+ *        the messages of all other peers sharing its FlowGroup and
+ *        priority. Bandwidth is still metered by priority; fair queuing
+ *        only decides whose callback runs next.
+ *
  *        Traffic shaping is disabled by default. Like any other
  *        FlowGroupPolicy value, this can be changed dynamically and will
  *        take effect when the next FlowGroupsUpdate is released. See
@@ -141,6 +152,29 @@ class FlowGroup {
     return scope_;
   }
 
+  bool fairQueuing() const {
+    return fair_queuing_;
+  }
+
+  /**
+   * Choose between FIFO and deficit round robin across Sockets for
+   * releasing callbacks within a priority level. Takes effect on the
+   * next run().
+   */
+  void setFairQueuing(bool fair_queuing) {
+    fair_queuing_ = fair_queuing;
+  }
+
+  /**
+   * @return the number of callbacks of the given priority waiting to send
+   *         on the given Socket.
+   */
+  size_t queuedCallbacks(Priority p, const Socket* socket) const {
+    auto& flows = flows_[asInt(p)];
+    auto it = flows.find(const_cast<Socket*>(socket));
+    return it == flows.end() ? 0 : it->second.queue.size();
+  }
+
   /**
    * Return true if sufficient bandwidth exists to transmit at least one
    * message at the given priority level.
@@ -240,13 +274,31 @@ class FlowGroup {
     meter_.entries[asInt(p)].reset(level);
   }
 
-  /** Add a callback to the PriorityQueue for this FlowGroup. */
-  void push(BWAvailableCallback& cb, Priority p) {
+  /**
+   * Add a callback to the PriorityQueue for this FlowGroup.
+   *
+   * @param socket  The Socket the callback waits to send on. Callbacks
+   *                are fair queued per Socket. May be null.
+   */
+  void push(BWAvailableCallback& cb, Priority p, Socket* socket = nullptr) {
     ld_check(onMyWorker());
     ld_check(!cb.active());
     ld_check(p < Priority::NUM_PRIORITIES);
     cb.setAffiliation(this, p);
     priorityq_.push(cb);
+
+    auto& flows = flows_[asInt(p)];
+    auto it = flows.find(socket);
+    if (it == flows.end()) {
+      it = flows
+               .emplace(std::piecewise_construct,
+                        std::forward_as_tuple(socket),
+                        std::forward_as_tuple(socket))
+               .first;
+      flow_rounds_[asInt(p)].push_back(it->second);
+    }
+    cb.flow_socket_ = socket;
+    it->second.queue.push_back(cb);
     // As soon as a callback resorts to deferring a message, revert
     // wouldCutInLine() to its normal mode of operation. We can't
     // allow a future bandwidth delivery by the TrafficShaper to
@@ -258,6 +310,17 @@ class FlowGroup {
   void erase(BWAvailableCallback& cb) {
     ld_check(onMyWorker());
     priorityq_.erase(cb);
+
+    auto& flows = flows_[asInt(cb.priority())];
+    auto it = flows.find(cb.flow_socket_);
+    ld_check(it != flows.end());
+    cb.fair_queue_links_.unlink();
+    // The Flow of the callback being issued is kept so that the callback
+    // can be charged for what it sends, see issueCallback().
+    if (it->second.queue.empty() && &it->second != running_flow_) {
+      flows.erase(it);
+    }
+    cb.flow_socket_ = nullptr;
     // Callbacks are removed from the queue prior to being executed.
     // Some depend on the priority being valid during the callback,
     // so invalidate the FlowGroup affiliation, but not the priority.
@@ -269,7 +332,7 @@ class FlowGroup {
    * this FlowGroup.
    */
   void push(Envelope& e) {
-    push(e, e.priority());
+    push(e, e.priority(), &e.socket());
   }
 
   /**
@@ -293,9 +356,49 @@ class FlowGroup {
   // the FlowMeter::Entry for the priority queue.
   static constexpr Priority PRIORITYQ_PRIORITY = Priority::NUM_PRIORITIES;
 
+  // Bytes a Socket's callbacks may send per round when fair queuing.
+  static constexpr int64_t FAIR_QUEUE_QUANTUM = 16 * 1024;
+
  private:
   friend class RecordRebuildingMockSocket;
 
+  /**
+   * The callbacks of one priority level waiting to send on the same Socket,
+   * in FIFO order, and the Socket's deficit counter for deficit round robin.
+   * A Flow exists while it has callbacks queued, and is then linked into
+   * flow_rounds_.
+   */
+  struct Flow {
+    explicit Flow(Socket* s) : socket(s) {}
+
+    Socket* const socket;
+    folly::IntrusiveList<BWAvailableCallback,
+                         &BWAvailableCallback::fair_queue_links_>
+        queue;
+    // Bytes the Flow may still send in the current round.
+    int64_t deficit = 0;
+    folly::IntrusiveListHook round_links;
+  };
+
+  /**
+   * @return the next callback of the given priority to issue: the oldest
+   *         one if fair queuing is off, otherwise the oldest one of the
+   *         next Flow with a positive deficit.
+   */
+  BWAvailableCallback& nextCallback(Priority p);
+
+  /**
+   * Account for the bytes of a message that passed drain(), both for the
+   * callback being issued and in the Socket's per-priority totals.
+   */
+  void noteDrained(const Envelope& e);
+
+  /**
+   * Account for the bytes sent by the callback just issued from the given
+   * Flow, and move on to the next Flow once this one used up its deficit.
+   */
+  void chargeFlow(Flow& flow, Priority p, uint64_t nbytes);
+
   bool onMyWorker() const {
     // sender_ is null in unit tests.
     return (sender_ == nullptr || &Worker::onThisThread()->sender() == sender_);
@@ -329,8 +432,9 @@ class FlowGroup {
   bool drain(const Envelope& e, Priority p) {
     // assert_can_drain_ is only used when running the backlog.
     ld_check(!assert_can_drain_ || isRunningBacklog());
-    auto drainSuccess = [this]() {
+    auto drainSuccess = [this, &e]() {
       assert_can_drain_ = false;
+      noteDrained(e);
       return true;
     };
 
@@ -429,13 +533,44 @@ class FlowGroup {
     };
     running_ = true;
 
+    const Priority p = cb.priority();
+    auto& flows = flows_[asInt(p)];
+    auto it = flows.find(cb.flow_socket_);
+    ld_check(it != flows.end());
+    Flow& flow = it->second;
+    const uint64_t drained_before = bytes_drained_;
+
+    running_flow_ = &flow;
     cb.deactivate();
     cb(*this, mtx);
+    running_flow_ = nullptr;
+
+    chargeFlow(flow, p, bytes_drained_ - drained_before);
   }
 
   PriorityQueue<BWAvailableCallback, &BWAvailableCallback::flow_group_links_>
       priorityq_;
 
+  // The same callbacks as priorityq_, grouped by priority and Socket.
+  // Maintained even when fair queuing is off so that it can be switched on
+  // at any time.
+  std::array<std::unordered_map<Socket*, Flow>,
+             asInt(Priority::NUM_PRIORITIES)>
+      flows_;
+
+  // Per priority, the Flows in round robin order. The front Flow is served
+  // until its deficit is used up.
+  std::array<folly::IntrusiveList<Flow, &Flow::round_links>,
+             asInt(Priority::NUM_PRIORITIES)>
+      flow_rounds_;
+
+  // The Flow whose callback is being issued, if any.
+  Flow* running_flow_ = nullptr;
+
+  // Total bytes of messages that passed drain(). Used to charge callbacks
+  // for what they send.
+  uint64_t bytes_drained_ = 0;
+
   FlowMeter meter_;
 
   // The Sender that contains this FlowGroup.
@@ -465,6 +600,9 @@ class FlowGroup {
   // delayed.
   bool running_ = false;
 
+  // See setFairQueuing().
+  bool fair_queuing_ = false;
+
   // Used to validate the behavior of bandwidth available callbacks.
   // The first message sent from a bandwidth available callback at or above
   // the priority of the registered callback should always succeed. This
@@ -123,20 +123,28 @@ int HashBasedSequencerLocator::locateSequencer(
   // from the search (e.g. those that were determined to be unavailable) set to
   // zero.
 
+  // Evaluate all candidates against the same view of the cluster state.
+  std::shared_ptr<const ClusterState::Snapshot> snapshot_holder;
+  if (cs) {
+    snapshot_holder = cs->getSnapshot();
+  }
+  const ClusterState::Snapshot* snapshot = snapshot_holder.get();
+
   bool found_in_location = false;
   uint64_t idx;
   if (sequencerAffinity && !sequencerAffinity->isEmpty()) {
     // trying to find sequencer according to location affinity
     auto weight_fn_with_loc = [sequencers,
-                               cs,
+                               snapshot,
                                config,
                                sequencerAffinity,
                                should_consider_boycotts](uint64_t node) {
       double w = sequencers->weights[node];
       if (w > 0.0 &&
-          (!cs ||
-           (cs->isNodeAlive(sequencers->nodes[node].index()) &&
-            (!should_consider_boycotts || !cs->isNodeBoycotted(node))))) {
+          (!snapshot ||
+           (snapshot->isNodeAlive(sequencers->nodes[node].index()) &&
+            (!should_consider_boycotts ||
+             !snapshot->isNodeBoycotted(node))))) {
         auto node_object = config->getNode(node);
         if (node_object) {
           auto location = node_object->location;
@@ -163,12 +171,14 @@ int HashBasedSequencerLocator::locateSequencer(
   }
   if (!found_in_location) {
     // trying to find sequencer regardless of location
-    auto weight_fn = [sequencers, cs, should_consider_boycotts](uint64_t node) {
+    auto weight_fn = [sequencers, snapshot, should_consider_boycotts](
+                         uint64_t node) {
       double w = sequencers->weights[node];
       if (w > 0.0 &&
-          (!cs ||
-           (cs->isNodeAlive(sequencers->nodes[node].index()) &&
-            (!should_consider_boycotts || !cs->isNodeBoycotted(node))))) {
+          (!snapshot ||
+           (snapshot->isNodeAlive(sequencers->nodes[node].index()) &&
+            (!should_consider_boycotts ||
+             !snapshot->isNodeBoycotted(node))))) {
         return w;
       }
       return 0.0;
@@ -7,6 +7,8 @@
  */
 #include "logdevice/common/IsLogEmptyRequest.h"
 
+#include <algorithm>
+
 #include <folly/Memory.h>
 
 #include "logdevice/common/EventLoop.h"
@@ -14,7 +16,10 @@
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/IS_LOG_EMPTY_BATCH_Message.h"
 #include "logdevice/common/protocol/IS_LOG_EMPTY_Message.h"
+#include "logdevice/common/settings/Settings.h"
+#include "logdevice/common/stats/Stats.h"
 
 namespace facebook { namespace logdevice {
 // See header file for explanation
@@ -300,6 +305,10 @@ StorageSetAccessor::SendResult IsLogEmptyRequest::sendTo(ShardID shard) {
 
   NodeID to(shard.node());
   IS_LOG_EMPTY_Header header = {id_, log_id_, shard.shard()};
+  if (Worker::onThisThread()->runningIsLogEmpty().enqueueForBatch(
+          header, shard)) {
+    return StorageSetAccessor::SendResult::SUCCESS;
+  }
   auto msg = std::make_unique<IS_LOG_EMPTY_Message>(header);
   if (Worker::onThisThread()->sender().sendMessage(std::move(msg), to) != 0) {
     if (err == E::PROTONOSUPPORT) {
@@ -525,4 +534,42 @@ void IsLogEmptyRequest::deleteThis() {
   map.erase(it); // destroys unique_ptr which owns this
 }
 
+size_t IsLogEmptyRequestMap::getMaxBatchSize() const {
+  return Worker::settings().log_query_batch_size;
+}
+
+uint16_t IsLogEmptyRequestMap::getMinBatchProtocol() const {
+  return Compatibility::LOG_QUERY_BATCH_SUPPORT;
+}
+
+std::unique_ptr<Message> IsLogEmptyRequestMap::createBatchMessage(
+    shard_index_t shard,
+    std::vector<IS_LOG_EMPTY_Header> entries) {
+  return std::make_unique<IS_LOG_EMPTY_BATCH_Message>(
+      shard, std::move(entries));
+}
+
+std::unique_ptr<Message>
+IsLogEmptyRequestMap::createMessage(const IS_LOG_EMPTY_Header& header) {
+  return std::make_unique<IS_LOG_EMPTY_Message>(header);
+}
+
+bool IsLogEmptyRequestMap::isRunning(request_id_t rqid) const {
+  return map.count(rqid);
+}
+
+void IsLogEmptyRequestMap::onMessageSent(request_id_t rqid,
+                                         ShardID to,
+                                         Status st) {
+  auto it = map.find(rqid);
+  if (it != map.end()) {
+    it->second->onMessageSent(to, st);
+  }
+}
+
+void IsLogEmptyRequestMap::onBatchSent(size_t num_entries) {
+  WORKER_STAT_INCR(log_query_batches_sent);
+  WORKER_STAT_ADD(log_query_batched_requests, num_entries);
+}
+
 }} // namespace facebook::logdevice
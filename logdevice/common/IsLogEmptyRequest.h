@@ -7,11 +7,18 @@
  */
 #pragma once
 
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "logdevice/common/NodeSetAccessor.h"
 #include "logdevice/common/NodeSetFinder.h"
 #include "logdevice/common/Request.h"
 #include "logdevice/common/RequestType.h"
 #include "logdevice/common/ShardAuthoritativeStatusMap.h"
+#include "logdevice/common/ShardBatcher.h"
+#include "logdevice/common/Timer.h"
 #include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/protocol/IS_LOG_EMPTY_Message.h"
 #include "logdevice/common/protocol/IS_LOG_EMPTY_REPLY_Message.h"
@@ -76,11 +83,26 @@ namespace facebook { namespace logdevice {
 class IsLogEmptyRequest;
 
 // Wrapper instead of typedef to allow forward-declaring in Worker.h
-struct IsLogEmptyRequestMap {
+//
+// Also batches the IS_LOG_EMPTYs for the same shard into IS_LOG_EMPTY_BATCH
+// messages of up to Settings::log_query_batch_size entries, see ShardBatcher.
+struct IsLogEmptyRequestMap : public ShardBatcher<IS_LOG_EMPTY_Header> {
   std::unordered_map<request_id_t,
                      std::unique_ptr<IsLogEmptyRequest>,
                      request_id_t::Hash>
       map;
+
+ protected:
+  size_t getMaxBatchSize() const override;
+  uint16_t getMinBatchProtocol() const override;
+  std::unique_ptr<Message>
+  createBatchMessage(shard_index_t shard,
+                     std::vector<IS_LOG_EMPTY_Header> entries) override;
+  std::unique_ptr<Message>
+  createMessage(const IS_LOG_EMPTY_Header& header) override;
+  bool isRunning(request_id_t rqid) const override;
+  void onMessageSent(request_id_t rqid, ShardID to, Status st) override;
+  void onBatchSent(size_t num_entries) override;
 };
 
 class IsLogEmptyRequest : public Request,
@@ -0,0 +1,316 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/JemallocArenas.h"
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+
+#include <folly/Format.h>
+
+#include "logdevice/common/config.h"
+#include "logdevice/common/debug.h"
+
+#ifdef LOGDEVICE_USING_JEMALLOC
+// See StatsJemalloc.h. The binary may not be linked with jemalloc, in which
+// case these are null.
+extern "C" int mallctl(const char*, void*, size_t*, void*, size_t)
+    __attribute__((__weak__));
+extern "C" int mallctlnametomib(const char*, size_t*, size_t*)
+    __attribute__((__weak__));
+extern "C" int
+mallctlbymib(const size_t*, size_t, void*, size_t*, void*, size_t)
+    __attribute__((__weak__));
+extern "C" void* mallocx(size_t, int) __attribute__((__weak__));
+#endif
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+enum class ThreadClass { WORKER = 0, STORAGE, BACKGROUND, COUNT };
+
+const char* threadClassName(ThreadClass c) {
+  switch (c) {
+    case ThreadClass::WORKER:
+      return "worker";
+    case ThreadClass::STORAGE:
+      return "storage";
+    case ThreadClass::BACKGROUND:
+      return "background";
+    case ThreadClass::COUNT:
+      break;
+  }
+  ld_check(false);
+  return "unknown";
+}
+
+ThreadClass threadClass(ThreadID::Type type) {
+  switch (type) {
+    case ThreadID::Type::SERVER_WORKER:
+    case ThreadID::Type::CLIENT_WORKER:
+    case ThreadID::Type::UNKNOWN_WORKER:
+    case ThreadID::Type::UNKNOWN_EVENT_LOOP:
+      return ThreadClass::WORKER;
+    case ThreadID::Type::STORAGE:
+      return ThreadClass::STORAGE;
+    case ThreadID::Type::UNKNOWN:
+    case ThreadID::Type::ROCKSDB:
+    case ThreadID::Type::UTILITY:
+      break;
+  }
+  return ThreadClass::BACKGROUND;
+}
+
+int ctl(const char* name,
+        void* oldp,
+        size_t* oldlenp,
+        void* newp,
+        size_t newlen) {
+#ifdef LOGDEVICE_USING_JEMALLOC
+  if (mallctl != nullptr) {
+    return mallctl(name, oldp, oldlenp, newp, newlen);
+  }
+#endif
+  return ENOENT;
+}
+
+bool createArena(unsigned* out) {
+  size_t len = sizeof(*out);
+  if (ctl("arenas.create", out, &len, nullptr, 0) == 0) {
+    return true;
+  }
+  // Name of the same control before jemalloc 5.
+  len = sizeof(*out);
+  return ctl("arenas.extend", out, &len, nullptr, 0) == 0;
+}
+
+// Flags for mallocx(), as defined in jemalloc.h.
+int mallocxFlags(unsigned arena) {
+  const int arena_flag = static_cast<int>((arena + 1) << 20);
+  const int tcache_none = 1 << 8;
+  return arena_flag | tcache_none;
+}
+
+struct State {
+  std::atomic<bool> thread_arenas{false};
+  std::atomic<bool> allocation_tagging{false};
+
+  // Management information base of "thread.arena", to skip name lookups.
+  std::array<size_t, 2> thread_arena_mib;
+  size_t thread_arena_mib_len = 0;
+
+  std::array<unsigned, static_cast<size_t>(AllocationTag::MAX)> tag_arenas;
+
+  std::mutex mutex;
+  // Arenas created for each class of threads. Protected by mutex.
+  std::array<std::vector<unsigned>, static_cast<size_t>(ThreadClass::COUNT)>
+      class_arenas;
+};
+
+State& state() {
+  static State* s = new State(); // leaked, used by threads until exit
+  return *s;
+}
+
+} // namespace
+
+void JemallocArenas::init(bool thread_arenas, bool allocation_tagging) {
+  State& s = state();
+#ifdef LOGDEVICE_USING_JEMALLOC
+  if (mallctlnametomib == nullptr || mallctlbymib == nullptr ||
+      mallocx == nullptr) {
+    if (thread_arenas || allocation_tagging) {
+      ld_warning("Not linked with jemalloc, ignoring jemalloc arena settings");
+    }
+    return;
+  }
+  s.thread_arena_mib_len = s.thread_arena_mib.size();
+  if (mallctlnametomib("thread.arena",
+                       s.thread_arena_mib.data(),
+                       &s.thread_arena_mib_len) != 0) {
+    ld_error("Failed to look up jemalloc control thread.arena");
+    return;
+  }
+
+  if (allocation_tagging) {
+    for (size_t i = 0; i < s.tag_arenas.size(); ++i) {
+      if (!createArena(&s.tag_arenas[i])) {
+        ld_error("Failed to create jemalloc arena for allocation tag %s",
+                 tagName(static_cast<AllocationTag>(i)));
+        return;
+      }
+    }
+    s.allocation_tagging.store(true);
+  }
+  if (thread_arenas) {
+    s.thread_arenas.store(true);
+  }
+  ld_info("jemalloc thread arenas %s, allocation tagging %s",
+          thread_arenas ? "enabled" : "disabled",
+          s.allocation_tagging.load() ? "enabled" : "disabled");
+#else
+  (void)s;
+  (void)thread_arenas;
+  (void)allocation_tagging;
+#endif
+}
+
+void JemallocArenas::onThreadStart(ThreadID::Type type) {
+  State& s = state();
+  if (!s.thread_arenas.load(std::memory_order_relaxed)) {
+    return;
+  }
+  const ThreadClass c = threadClass(type);
+  std::lock_guard<std::mutex> lock(s.mutex);
+  auto& arenas = s.class_arenas[static_cast<size_t>(c)];
+  unsigned arena;
+  if (c == ThreadClass::BACKGROUND && !arenas.empty()) {
+    // All background threads share an arena.
+    arena = arenas[0];
+  } else {
+    if (!createArena(&arena)) {
+      RATELIMIT_ERROR(std::chrono::seconds(10),
+                      2,
+                      "Failed to create jemalloc arena for %s thread %s",
+                      threadClassName(c),
+                      ThreadID::getName());
+      return;
+    }
+    arenas.push_back(arena);
+  }
+  if (swapThreadArena(arena) < 0) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    2,
+                    "Failed to move thread %s to jemalloc arena %u",
+                    ThreadID::getName(),
+                    arena);
+  }
+}
+
+int JemallocArenas::tagArena(AllocationTag tag) {
+  State& s = state();
+  if (!s.allocation_tagging.load(std::memory_order_relaxed)) {
+    return -1;
+  }
+  ld_check(tag < AllocationTag::MAX);
+  return s.tag_arenas[static_cast<size_t>(tag)];
+}
+
+int JemallocArenas::swapThreadArena(unsigned arena) {
+#ifdef LOGDEVICE_USING_JEMALLOC
+  State& s = state();
+  if (s.thread_arena_mib_len == 0) {
+    return -1;
+  }
+  unsigned prev;
+  size_t len = sizeof(prev);
+  int rv = mallctlbymib(s.thread_arena_mib.data(),
+                        s.thread_arena_mib_len,
+                        &prev,
+                        &len,
+                        &arena,
+                        sizeof(arena));
+  return rv == 0 ? static_cast<int>(prev) : -1;
+#else
+  (void)arena;
+  return -1;
+#endif
+}
+
+void* JemallocArenas::mallocTagged(AllocationTag tag, size_t size) {
+#ifdef LOGDEVICE_USING_JEMALLOC
+  int arena = tagArena(tag);
+  if (arena >= 0 && size > 0) {
+    return mallocx(size, mallocxFlags(arena));
+  }
+#else
+  (void)tag;
+#endif
+  return malloc(size);
+}
+
+std::vector<JemallocArenas::ArenaGroupStats> JemallocArenas::getStats() {
+  State& s = state();
+  std::vector<std::pair<std::string, std::vector<unsigned>>> groups;
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    for (size_t i = 0; i < s.class_arenas.size(); ++i) {
+      if (!s.class_arenas[i].empty()) {
+        groups.emplace_back(threadClassName(static_cast<ThreadClass>(i)),
+                            s.class_arenas[i]);
+      }
+    }
+  }
+  if (s.allocation_tagging.load()) {
+    for (size_t i = 0; i < s.tag_arenas.size(); ++i) {
+      groups.emplace_back(
+          std::string("tag:") + tagName(static_cast<AllocationTag>(i)),
+          std::vector<unsigned>{s.tag_arenas[i]});
+    }
+  }
+  if (groups.empty()) {
+    return {};
+  }
+
+  // Statistics are only refreshed when the epoch is advanced.
+  uint64_t epoch = 1;
+  ctl("epoch", nullptr, nullptr, &epoch, sizeof(epoch));
+
+  std::vector<ArenaGroupStats> res;
+  for (const auto& group : groups) {
+    uint64_t allocated = 0;
+    for (unsigned arena : group.second) {
+      // "huge" only exists before jemalloc 5, it's part of "large" since.
+      for (const char* kind : {"small", "large", "huge"}) {
+        std::string name =
+            folly::sformat("stats.arenas.{}.{}.allocated", arena, kind);
+        size_t val;
+        size_t len = sizeof(val);
+        if (ctl(name.c_str(), &val, &len, nullptr, 0) == 0) {
+          allocated += val;
+        }
+      }
+    }
+    res.push_back(ArenaGroupStats{group.first, group.second.size(), allocated});
+  }
+  return res;
+}
+
+const char* JemallocArenas::tagName(AllocationTag tag) {
+  switch (tag) {
+    case AllocationTag::RECORD_CACHE:
+      return "record_cache";
+    case AllocationTag::READ_BUFFERS:
+      return "read_buffers";
+    case AllocationTag::APPENDERS:
+      return "appenders";
+    case AllocationTag::MAX:
+      break;
+  }
+  ld_check(false);
+  return "unknown";
+}
+
+AllocationTagScope::AllocationTagScope(AllocationTag tag) {
+  int arena = JemallocArenas::tagArena(tag);
+  if (arena >= 0) {
+    prev_arena_ = JemallocArenas::swapThreadArena(arena);
+  }
+}
+
+AllocationTagScope::~AllocationTagScope() {
+  if (prev_arena_ >= 0) {
+    JemallocArenas::swapThreadArena(prev_arena_);
+  }
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "logdevice/common/ThreadID.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Explicit jemalloc arenas for logdeviced threads and subsystems.
+ *
+ *       By default jemalloc assigns threads to arenas round-robin, so workers,
+ *       storage threads and background threads share arenas. Payload buffers
+ *       are often allocated on one kind of thread and freed on another, which
+ *       makes them contend on the arena locks and fragments the arenas.
+ *
+ *       With thread arenas enabled (see ServerSettings::jemalloc_thread_arenas)
+ *       every worker and storage thread gets an arena of its own, and all
+ *       other threads share one background arena. Threads are assigned when
+ *       they call ThreadID::set(). Frees from other threads go through the
+ *       freeing thread's cache, which returns them to the owning arena in
+ *       batches.
+ *
+ *       With allocation tagging enabled (see
+ *       ServerSettings::jemalloc_allocation_tagging) each AllocationTag gets
+ *       an arena too, and the allocations of the tagged subsystems are placed
+ *       in it, so that the bytes allocated by each of them can be read from
+ *       the arena statistics ("stats jemalloc arenas" admin command).
+ *
+ *       Both are no-ops if the binary isn't linked with jemalloc.
+ */
+
+enum class AllocationTag : uint8_t {
+  // Entries of record caches.
+  RECORD_CACHE = 0,
+  // Copies of records read by storage threads for read streams.
+  READ_BUFFERS,
+  // Appenders, with the state they allocate when constructed.
+  APPENDERS,
+  MAX
+};
+
+class JemallocArenas {
+ public:
+  /**
+   * Enables thread arenas and/or allocation tagging. Called once on startup,
+   * before the threads that should be assigned an arena are started.
+   */
+  static void init(bool thread_arenas, bool allocation_tagging);
+
+  /**
+   * Called by ThreadID::set() to move the calling thread to the arena of
+   * its type if thread arenas are enabled.
+   */
+  static void onThreadStart(ThreadID::Type type);
+
+  /**
+   * Allocates `size` bytes in the arena of `tag`, bypassing the thread
+   * cache, so that they are accounted precisely. The memory is freed with
+   * free(). Same as malloc() if allocation tagging is disabled.
+   */
+  static void* mallocTagged(AllocationTag tag, size_t size);
+
+  struct ArenaGroupStats {
+    // "worker", "storage", "background" or the name of a tag.
+    std::string name;
+    size_t num_arenas;
+    // Bytes in active allocations of the arenas of the group.
+    uint64_t allocated_bytes;
+  };
+
+  /**
+   * Refreshes jemalloc statistics and returns the allocated bytes of each
+   * group of arenas created here. Empty if none were created.
+   */
+  static std::vector<ArenaGroupStats> getStats();
+
+  static const char* tagName(AllocationTag tag);
+
+ private:
+  friend class AllocationTagScope;
+
+  // Arena of `tag`, or -1 if allocation tagging is disabled.
+  static int tagArena(AllocationTag tag);
+
+  // Moves the calling thread to `arena`. Returns the previous arena, or -1
+  // on failure.
+  static int swapThreadArena(unsigned arena);
+};
+
+/**
+ * While in scope, allocations made by the current thread go to the arena
+ * of `tag`. Small allocations may still be served from objects cached by
+ * the thread before entering the scope, so the accounting of those is
+ * approximate. Costs two mallctl() calls if allocation tagging is enabled,
+ * nothing otherwise.
+ */
+class AllocationTagScope {
+ public:
+  explicit AllocationTagScope(AllocationTag tag);
+  ~AllocationTagScope();
+
+  AllocationTagScope(const AllocationTagScope&) = delete;
+  AllocationTagScope& operator=(const AllocationTagScope&) = delete;
+
+ private:
+  int prev_arena_ = -1;
+};
+
+}} // namespace facebook::logdevice
@@ -11,6 +11,7 @@
 
 #include "logdevice/common/EventHandler.h"
 #include "logdevice/common/TimeoutMap.h"
+#include "logdevice/common/TimerWheel.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/libevent/compat.h"
@@ -52,6 +53,18 @@ void LibeventTimer::assign(struct event_base* base,
 
 void LibeventTimer::activate(std::chrono::microseconds delay,
                              TimeoutMap* timeout_map) {
+  Worker* w = Worker::onThisThread(false);
+  if (w && delay.count() >= TimerWheel::TICK_USEC &&
+      Worker::settings().worker_timer_wheel && initialized_ &&
+      LD_EV(event_get_base)(&timer_) == w->getEventBase()) {
+    ld_check(callback_);
+    cancel();
+    w->timerWheel().add(this, delay);
+    workerRunState_ = w->currentlyRunning_;
+    active_ = true;
+    return;
+  }
+
   struct timeval tv_buf;
   const struct timeval* tv;
 
@@ -73,6 +86,9 @@ void LibeventTimer::activate(const struct timeval* delay) {
 
   ld_check(initialized_);
   ld_check(callback_);
+  if (wheel_) {
+    wheel_->remove(this);
+  }
   evtimer_add(&timer_, delay);
   ld_assert(evtimer_pending(&timer_, nullptr));
 
@@ -84,8 +100,12 @@ void LibeventTimer::activate(const struct timeval* delay) {
 void LibeventTimer::cancel() {
   if (isActive()) {
     ld_check(initialized_);
-    ld_assert(evtimer_pending(&timer_, nullptr));
-    evtimer_del(&timer_);
+    if (wheel_) {
+      wheel_->remove(this);
+    } else {
+      ld_assert(evtimer_pending(&timer_, nullptr));
+      evtimer_del(&timer_);
+    }
     active_ = false;
   }
 }
@@ -102,9 +122,14 @@ bool LibeventTimer::isAssigned() const {
 void LibeventTimer::libeventCallback(void* instance, short) {
   auto self = reinterpret_cast<LibeventTimer*>(instance);
   ld_assert(!evtimer_pending(&self->timer_, nullptr));
-  self->active_ = false;
+  self->fire();
+}
+
+void LibeventTimer::fire() {
+  ld_check(wheel_ == nullptr);
+  active_ = false;
 
-  RunState run_state = self->workerRunState_;
+  RunState run_state = workerRunState_;
 
   if (!ThreadID::isEventLoop()) {
     RATELIMIT_ERROR(std::chrono::seconds(1),
@@ -117,8 +142,8 @@ void LibeventTimer::libeventCallback(void* instance, short) {
   if (w) {
     Worker::onStartedRunning(run_state);
   }
-  ld_check(self->callback_);
-  self->callback_(); // self could be destroyed after this
+  ld_check(callback_);
+  callback_(); // this could be destroyed after this
   if (w) {
     Worker::onStoppedRunning(run_state);
   }
@@ -28,6 +28,7 @@
 namespace facebook { namespace logdevice {
 
 class TimeoutMap;
+class TimerWheel;
 
 class LibeventTimer : boost::noncopyable {
  public:
@@ -64,6 +65,11 @@ class LibeventTimer : boost::noncopyable {
    * delay to struct timeval (possibly using libevent's common timeout
    * optimization).
    *
+   * On a Worker with the worker-timer-wheel setting on, timers of the
+   * Worker's event base with delays of at least a tick of the wheel go to
+   * Worker::timerWheel() instead of libevent, which makes activating and
+   * cancelling them O(1). They may then fire up to a tick late.
+   *
    * If activate() is called while the timer is already active, it effectively
    * cancels the previous timer.
    */
@@ -108,6 +114,10 @@ class LibeventTimer : boost::noncopyable {
   // callback.
   static void libeventCallback(void* instance, short);
 
+  // Invokes the callback, called when the timer goes off in libevent or in
+  // a TimerWheel.
+  void fire();
+
   bool initialized_{false};
 
   struct event timer_;
@@ -117,6 +127,14 @@ class LibeventTimer : boost::noncopyable {
   // The worker run state that this timer was activated in. Will be propagated
   // with all callbacks.
   RunState workerRunState_;
+
+  // Set while the timer is in a TimerWheel rather than in libevent.
+  TimerWheel* wheel_ = nullptr;
+  folly::IntrusiveListHook wheel_hook_;
+  // Tick of wheel_ at which the timer fires.
+  uint64_t wheel_expiry_ = 0;
+
+  friend class TimerWheel;
 };
 
 }} // namespace facebook::logdevice
@@ -8,6 +8,8 @@
 #define __STDC_FORMAT_MACROS // pull in PRIu64 etc
 #include "LocalLogStoreRecordFormat.h"
 
+#include <limits>
+
 #include <folly/Range.h>
 #include <folly/Varint.h>
 #include <folly/hash/Hash.h>
@@ -39,6 +41,15 @@ uint32_t getRecordWaveOrRecoveryEpoch(const STORE_Header& header,
       : header.wave;
 }
 
+// Varint encoding of a node_index_t or shard_index_t takes at most 3 bytes.
+constexpr size_t kMaxVarintLength16 = 3;
+
+void appendVarint(std::string* buf, uint64_t value) {
+  uint8_t varint_buf[folly::kMaxVarintLength64];
+  size_t n = folly::encodeVarint(value, varint_buf);
+  buf->append((const char*)varint_buf, n);
+}
+
 } // namespace
 
 #define APPEND_TO_STRING(pstr, thing)                                     \
@@ -50,16 +61,22 @@ uint32_t getRecordWaveOrRecoveryEpoch(const STORE_Header& header,
 size_t recordHeaderSizeEstimate(flags_t flags,
                                 copyset_size_t copyset_size,
                                 const Slice& optional_keys) {
+  const bool compact = flags & FLAG_COMPACT_HEADER;
   size_t ret = sizeof(int64_t) + sizeof(esn_t) + folly::kMaxVarintLength32 +
-      sizeof(uint32_t) +
-      ((flags & FLAG_OFFSET_WITHIN_EPOCH) ? sizeof(uint64_t) : 0);
+      (compact ? folly::kMaxVarintLength32 : sizeof(uint32_t));
+  if (flags & FLAG_OFFSET_WITHIN_EPOCH) {
+    ret += compact ? folly::kMaxVarintLength64 : sizeof(uint64_t);
+  }
 
   if ((flags & FLAG_CUSTOM_KEY) || (flags & FLAG_OPTIONAL_KEYS)) {
     ret += sizeof(uint16_t) + optional_keys.size;
   }
 
   ret += sizeof(copyset_size_t);
-  if (flags & FLAG_SHARD_ID) {
+  if (compact) {
+    ret += kMaxVarintLength16 * ((flags & FLAG_SHARD_ID) ? 2 : 1) *
+        copyset_size;
+  } else if (flags & FLAG_SHARD_ID) {
     ret += sizeof(ShardID) * copyset_size;
   } else {
     ret += sizeof(node_index_t) * copyset_size;
@@ -96,10 +113,22 @@ Slice formRecordHeaderBufAppend(int64_t timestamp,
   size_t n = folly::encodeVarint(flags, varint_buf);
   buf->append((const char*)varint_buf, n);
 
-  APPEND_TO_STRING(buf, wave_or_recovery_epoch);
+  const bool compact = flags & FLAG_COMPACT_HEADER;
+  if (compact) {
+    appendVarint(buf, wave_or_recovery_epoch);
+  } else {
+    APPEND_TO_STRING(buf, wave_or_recovery_epoch);
+  }
   copyset_size_t copyset_size = copyset.size();
   APPEND_TO_STRING(buf, copyset_size);
-  if (flags & FLAG_SHARD_ID) {
+  if (compact) {
+    for (ShardID shard : copyset) {
+      appendVarint(buf, static_cast<uint16_t>(shard.node()));
+      if (flags & FLAG_SHARD_ID) {
+        appendVarint(buf, static_cast<uint16_t>(shard.shard()));
+      }
+    }
+  } else if (flags & FLAG_SHARD_ID) {
     for (ShardID shard : copyset) {
       APPEND_TO_STRING(buf, shard);
     }
@@ -114,7 +143,11 @@ Slice formRecordHeaderBufAppend(int64_t timestamp,
   if (flags & FLAG_OFFSET_WITHIN_EPOCH) {
     uint64_t offset_within_epoch =
         offsets_within_epoch.getCounter(CounterType::BYTE_OFFSET);
-    APPEND_TO_STRING(buf, offset_within_epoch);
+    if (compact) {
+      appendVarint(buf, offset_within_epoch);
+    } else {
+      APPEND_TO_STRING(buf, offset_within_epoch);
+    }
   }
 
   if ((flags & FLAG_CUSTOM_KEY) || (flags & FLAG_OPTIONAL_KEYS)) {
@@ -211,7 +244,8 @@ Slice formRecordHeader(const STORE_Header& store_header,
                        std::string* buf,
                        const bool shard_id_in_copyset,
                        const std::map<KeyType, std::string>& optional_keys,
-                       const STORE_Extra& store_extra) {
+                       const STORE_Extra& store_extra,
+                       bool compact_header) {
   flags_t flags = store_header.flags & FLAG_MASK;
   uint32_t wave_or_recovery_epoch_to_store =
       getRecordWaveOrRecoveryEpoch(store_header, store_extra);
@@ -233,6 +267,10 @@ Slice formRecordHeader(const STORE_Header& store_header,
     flags |= FLAG_OFFSET_MAP;
   }
 
+  if (compact_header) {
+    flags |= FLAG_COMPACT_HEADER;
+  }
+
   // TODO 11866467: deprecate STORE_Header::RECOVERY
   if (store_header.flags & STORE_Header::RECOVERY ||
       store_header.flags & STORE_Header::WRITTEN_BY_RECOVERY) {
@@ -402,6 +440,48 @@ int parseOffsetWithinEpochValue(uint64_t* offset_within_epoch_out,
   return 0;
 }
 
+int parseVarintValue(uint64_t& value,
+                     const uint8_t** ptr,
+                     const uint8_t* end,
+                     const char* what) {
+  try {
+    folly::ByteRange range(*ptr, end);
+    value = folly::decodeVarint(range);
+    *ptr = range.begin();
+  } catch (...) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    10,
+                    "Invalid record: failed to decode %s varint",
+                    what);
+    err = E::MALFORMED_RECORD;
+    return -1;
+  }
+  return 0;
+}
+
+// Parses a varint-encoded node_index_t or shard_index_t.
+int parseIndexValue(int16_t& index,
+                    const uint8_t** ptr,
+                    const uint8_t* end,
+                    const char* what) {
+  uint64_t value;
+  int rv = parseVarintValue(value, ptr, end, what);
+  if (rv != 0) {
+    return rv;
+  }
+  if (value > std::numeric_limits<int16_t>::max()) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    10,
+                    "Invalid record: %s %lu out of range",
+                    what,
+                    value);
+    err = E::MALFORMED_RECORD;
+    return -1;
+  }
+  index = static_cast<int16_t>(value);
+  return 0;
+}
+
 int parseFlagsValue(flags_t& flags, const uint8_t** ptr, const uint8_t* end) {
   try {
     folly::ByteRange range(*ptr, end);
@@ -573,22 +653,35 @@ int parse(const Slice& log_store_blob,
     *flags_out = flags;
   }
 
+  const bool compact = flags & FLAG_COMPACT_HEADER;
+
   //
   // Wave number
   //
-  if (ptr + sizeof(*wave_or_recovery_epoch_out) > end) {
-    RATELIMIT_ERROR(std::chrono::seconds(10),
-                    10,
-                    "Invalid record: past end while parsing wave; blob: %s",
-                    hexdump_buf(log_store_blob, 700).c_str());
-    err = E::MALFORMED_RECORD;
-    return -1;
-  }
-  if (wave_or_recovery_epoch_out != nullptr) {
-    memcpy(
-        wave_or_recovery_epoch_out, ptr, sizeof(*wave_or_recovery_epoch_out));
+  if (compact) {
+    uint64_t wave;
+    rv = parseVarintValue(wave, &ptr, end, "wave");
+    if (rv != 0) {
+      return rv;
+    }
+    if (wave_or_recovery_epoch_out != nullptr) {
+      *wave_or_recovery_epoch_out = static_cast<uint32_t>(wave);
+    }
+  } else {
+    if (ptr + sizeof(*wave_or_recovery_epoch_out) > end) {
+      RATELIMIT_ERROR(std::chrono::seconds(10),
+                      10,
+                      "Invalid record: past end while parsing wave; blob: %s",
+                      hexdump_buf(log_store_blob, 700).c_str());
+      err = E::MALFORMED_RECORD;
+      return -1;
+    }
+    if (wave_or_recovery_epoch_out != nullptr) {
+      memcpy(
+          wave_or_recovery_epoch_out, ptr, sizeof(*wave_or_recovery_epoch_out));
+    }
+    ptr += sizeof(*wave_or_recovery_epoch_out);
   }
-  ptr += sizeof(*wave_or_recovery_epoch_out);
 
   //
   // Copyset size
@@ -625,7 +718,31 @@ int parse(const Slice& log_store_blob,
   // Copyset
   //
   Status status = E::OK;
-  if (flags & FLAG_SHARD_ID) {
+  if (compact) {
+    const bool fits = copyset_size <= copyset_arr_out_size;
+    if (copyset_arr_out != nullptr && !fits) {
+      status = E::NOBUFS;
+    }
+    // Always decode the whole copyset to validate it and find its end.
+    for (copyset_size_t i = 0; i < copyset_size; ++i) {
+      node_index_t node;
+      shard_index_t shard = this_shard;
+      rv = parseIndexValue(node, &ptr, end, "copyset node index");
+      if (rv != 0) {
+        return rv;
+      }
+      if (flags & FLAG_SHARD_ID) {
+        rv = parseIndexValue(shard, &ptr, end, "copyset shard index");
+        if (rv != 0) {
+          return rv;
+        }
+      }
+      if (copyset_arr_out != nullptr && fits) {
+        ld_check(shard >= 0);
+        copyset_arr_out[i] = ShardID(node, shard);
+      }
+    }
+  } else if (flags & FLAG_SHARD_ID) {
     if (ptr + copyset_size * sizeof(ShardID) > end) {
       RATELIMIT_ERROR(
           std::chrono::seconds(10),
@@ -676,7 +793,8 @@ int parse(const Slice& log_store_blob,
   //
   if (flags & FLAG_OFFSET_WITHIN_EPOCH) {
     uint64_t out;
-    rv = parseOffsetWithinEpochValue(&out, &ptr, end);
+    rv = compact ? parseVarintValue(out, &ptr, end, "offset within epoch")
+                 : parseOffsetWithinEpochValue(&out, &ptr, end);
     if (rv != 0) {
       return rv;
     }
@@ -1072,6 +1190,7 @@ std::string flagsToString(flags_t flags) {
   FLAG(DRAINED)
   FLAG(SHARD_ID)
   FLAG(OFFSET_MAP)
+  FLAG(COMPACT_HEADER)
 
 #undef FLAG
 
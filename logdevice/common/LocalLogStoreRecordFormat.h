@@ -44,6 +44,17 @@
  *   [0 to  64kb]    user defined key.
  *   [?? bytes]      the rest of the blob is the user-provided data
  *
+ * If FLAG_COMPACT_HEADER is set, the fields between the flags and the user
+ * defined key are varints instead:
+ *   [1-5 bytes]     wave number or seal epoch
+ *   [1 byte]        copyset size N
+ *   [N * 1-6 bytes] for each copyset entry, the node index and, if
+ *                   FLAG_SHARD_ID is set, the shard index
+ *   [0 or 1-10 bytes] offset within epoch if FLAG_OFFSET_WITHIN_EPOCH is set
+ * The timestamp, last_known_good and flags stay where they are in the
+ * default format, so parseTimestamp() and isWrittenByRecovery() work on both.
+ * Each record says which format it uses, so they can be mixed in one store.
+ *
  * The format of single copyset index entries is:
  *   [4 bytes] wave number
  *   [1 byte]  flags. is_hole and written by rebuilding
@@ -117,6 +128,11 @@ const flags_t FLAG_SHARD_ID = 1u << 20; //=1048576
 // Indicates if record contains OffsetMap.
 const flags_t FLAG_OFFSET_MAP = 1u << 21; //=2097152
 
+// The wave, copyset and offset within epoch are varints, see the top of the
+// file. Set for logs with the compact_record_header attribute if
+// --write-compact-record-header is enabled.
+const flags_t FLAG_COMPACT_HEADER = 1u << 22; //=4194304
+
 // Please update flagsToString() when adding new flags.
 
 // Flags that indicate that the record in question is a pseudorecord, and can
@@ -257,13 +273,15 @@ Slice formRecordHeader(int64_t timestamp,
  *                              monotonically increasing order);
  *                              KeyType::FILTERABLE is used by server-side
  *                              filtering.[Experimental feature]
+ * @param compact_header        if true, sets FLAG_COMPACT_HEADER
  */
 Slice formRecordHeader(const STORE_Header& store_header,
                        const StoreChainLink* copyset,
                        std::string* buf,
                        bool shard_id_in_copyset,
                        const std::map<KeyType, std::string>& optional_keys,
-                       const STORE_Extra& store_extra = STORE_Extra());
+                       const STORE_Extra& store_extra = STORE_Extra(),
+                       bool compact_header = false);
 
 /**
  * Form copyset index entry flags from the content of a STORE_Header.
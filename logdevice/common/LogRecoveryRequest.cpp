@@ -907,10 +907,58 @@ void LogRecoveryRequest::sealLog() {
 
   ld_check(epoch_recovery_machines_.size() > 0);
 
+  activateEpochRecoveries();
+}
+
+void LogRecoveryRequest::activateEpochRecoveries() {
+  ld_check(!epoch_recovery_machines_.empty());
   ld_check(tail_record_.hasValue());
+
+  // Digests don't need the tail of the previous epochs, so the digests of
+  // later epochs can be built while earlier epochs are mutated and cleaned.
+  // Digests of later epochs don't complete until their epoch gets to the
+  // front, so mutations, cleaning and LCE updates stay in epoch order.
+  const size_t max_concurrent =
+      std::max<size_t>(Worker::settings().recovery_max_concurrent_epochs, 1);
+  auto it = std::next(epoch_recovery_machines_.begin());
+  for (size_t n = 1;
+       n < max_concurrent && it != epoch_recovery_machines_.end();
+       ++n, ++it) {
+    if (!it->isActive()) {
+      it->activateDigest();
+    }
+  }
+
   epoch_recovery_machines_.begin()->activate(tail_record_.value());
 }
 
+EpochRecovery* LogRecoveryRequest::getActiveEpochRecovery(epoch_t epoch) {
+  for (auto& erm : epoch_recovery_machines_) {
+    if (!erm.isActive()) {
+      // Machines are activated in epoch order.
+      break;
+    }
+    if (erm.epoch_ == epoch) {
+      return &erm;
+    }
+  }
+  return nullptr;
+}
+
+EpochRecovery*
+LogRecoveryRequest::getDigestingEpochRecovery(ShardID shard,
+                                              read_stream_id_t rsid) {
+  for (auto& erm : epoch_recovery_machines_) {
+    if (!erm.isActive()) {
+      break;
+    }
+    if (erm.digestingReadStream(shard, rsid)) {
+      return &erm;
+    }
+  }
+  return nullptr;
+}
+
 void LogRecoveryRequest::checkNodesForSeal() {
   ld_check(seal_header_ != nullptr);
   ld_check(seal_retry_handler_ != nullptr);
@@ -1480,8 +1528,7 @@ void LogRecoveryRequest::onEpochRecovered(epoch_t epoch,
   epoch_recovery_machines_.pop_front();
 
   if (epoch_recovery_machines_.begin() != epoch_recovery_machines_.end()) {
-    ld_check(tail_record_.hasValue());
-    epoch_recovery_machines_.begin()->activate(tail_record_.value());
+    activateEpochRecoveries();
   } else {
     // finished recoverying all epochs in [lce+1, next_epoch-1]
     allEpochsRecovered();
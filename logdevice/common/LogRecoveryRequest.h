@@ -198,6 +198,20 @@ class LogRecoveryRequest : public Request,
     return &*first;
   }
 
+  /**
+   * @return the active EpochRecovery machine for `epoch`, nullptr if there
+   *         is none. Besides the oldest one, machines of later epochs may be
+   *         active building their digest, see --recovery-max-concurrent-epochs.
+   */
+  EpochRecovery* getActiveEpochRecovery(epoch_t epoch);
+
+  /**
+   * @return the active EpochRecovery machine reading a digest from `shard`
+   *         with read stream `rsid`, nullptr if there is none.
+   */
+  EpochRecovery* getDigestingEpochRecovery(ShardID shard,
+                                           read_stream_id_t rsid);
+
   /**
    * Returns the epoch number through which this recovery request will seal the
    * log.
@@ -391,6 +405,11 @@ class LogRecoveryRequest : public Request,
   // keep waiting for the metadata to appear in the metadata log.
   void allEpochsRecovered();
 
+  // Activates the oldest EpochRecovery machine, which is given the tail record
+  // of the epochs recovered so far, and the digests of up to
+  // --recovery-max-concurrent-epochs - 1 machines after it.
+  void activateEpochRecoveries();
+
   // Sends SEAL messages to nodes in the cluster. Once some f-majority responds,
   // baton is handed off to EpochRecovery. A grace period is used to allow
   // additional nodes to also participate in recovery (as long as they reply
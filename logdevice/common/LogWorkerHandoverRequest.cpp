@@ -0,0 +1,61 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/LogWorkerHandoverRequest.h"
+
+#include "logdevice/common/AppendRequest.h"
+#include "logdevice/common/LogWorkerMigrations.h"
+#include "logdevice/common/Processor.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/util.h"
+
+namespace facebook { namespace logdevice {
+
+Request::Execution LogWorkerHandoverRequest::execute() {
+  Worker* w = Worker::onThisThread();
+
+  if (!on_target_) {
+    ld_check(w->idx_ == from_);
+    // Everything posted to this Worker before the migration has executed.
+    auto rq = std::make_unique<LogWorkerHandoverRequest>(log_, from_, to_);
+    rq->on_target_ = true;
+    std::unique_ptr<Request> req(std::move(rq));
+    w->processor_->postImportant(req);
+    return Execution::COMPLETE;
+  }
+
+  ld_check(w->idx_ == to_);
+  w->processor_->logWorkerMigrations().completeHandover(log_, from_);
+
+  auto& appends = w->runningAppends();
+  auto it = appends.held_for_handover.find(log_);
+  if (it == appends.held_for_handover.end()) {
+    return Execution::COMPLETE;
+  }
+  // Appends of the log held for a handover from another Worker stay held.
+  std::vector<request_id_t> held;
+  held.swap(it->second);
+  appends.held_for_handover.erase(it);
+
+  for (request_id_t id : held) {
+    auto rq_it = appends.map.find(id);
+    if (rq_it == appends.map.end()) {
+      // Timed out while held.
+      continue;
+    }
+    auto append = checked_downcast<AppendRequest*>(rq_it->second.get());
+    if (append->getHashedWorker() == from_) {
+      append->resumeAfterHandover();
+    } else {
+      appends.held_for_handover[log_].push_back(id);
+    }
+  }
+  return Execution::COMPLETE;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include "logdevice/common/Request.h"
+#include "logdevice/common/RequestType.h"
+#include "logdevice/common/types_internal.h"
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Hands the requests for a log over from the Worker they hash to,
+ *       `from', to the Worker they were migrated to, `to' (see
+ *       LogWorkerMigrations).
+ *
+ *       The request is first posted to `from' right after the migration
+ *       begins. Requests execute in the order they are posted to a Worker, so
+ *       by the time it runs, all the requests for the log that were posted to
+ *       `from' before the migration have executed. It then goes to `to', which
+ *       completes the handover and starts the appends it held meanwhile, in
+ *       the order they arrived.
+ *
+ *       Appends that `from' already started may still complete after the ones
+ *       `to' starts, as they can when retried on a single Worker.
+ */
+
+class LogWorkerHandoverRequest : public Request {
+ public:
+  LogWorkerHandoverRequest(logid_t log, worker_id_t from, worker_id_t to)
+      : Request(RequestType::LOG_WORKER_HANDOVER),
+        log_(log),
+        from_(from),
+        to_(to) {}
+
+  Execution execute() override;
+
+  int getThreadAffinity(int /*nthreads*/) override {
+    return on_target_ ? to_.val_ : from_.val_;
+  }
+
+ private:
+  const logid_t log_;
+  const worker_id_t from_;
+  const worker_id_t to_;
+  // Whether the request was forwarded to `to'.
+  bool on_target_ = false;
+};
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/LogWorkerMigrations.h"
+
+#include <folly/hash/Hash.h>
+
+#include "logdevice/common/debug.h"
+
+namespace facebook { namespace logdevice {
+
+size_t LogWorkerMigrations::KeyHasher::operator()(const Key& key) const {
+  return folly::hash::hash_combine(key.log.val_, key.from.val_);
+}
+
+worker_id_t LogWorkerMigrations::route(logid_t log, worker_id_t hashed) const {
+  if (size_.load() == 0) {
+    return hashed;
+  }
+  folly::SharedMutex::ReadHolder guard(mutex_);
+  auto it = migrations_.find(Key{log, hashed});
+  return it == migrations_.end() ? hashed : it->second.to;
+}
+
+bool LogWorkerMigrations::isHandingOver(logid_t log, worker_id_t from) const {
+  if (size_.load() == 0) {
+    return false;
+  }
+  folly::SharedMutex::ReadHolder guard(mutex_);
+  auto it = migrations_.find(Key{log, from});
+  return it != migrations_.end() && it->second.handing_over;
+}
+
+bool LogWorkerMigrations::begin(logid_t log,
+                                worker_id_t from,
+                                worker_id_t to) {
+  ld_check(from != to);
+  folly::SharedMutex::WriteHolder guard(mutex_);
+  auto res = migrations_.emplace(Key{log, from}, Migration{to, true});
+  if (!res.second) {
+    return false;
+  }
+  size_.store(migrations_.size());
+  return true;
+}
+
+void LogWorkerMigrations::completeHandover(logid_t log, worker_id_t from) {
+  folly::SharedMutex::WriteHolder guard(mutex_);
+  auto it = migrations_.find(Key{log, from});
+  ld_check(it != migrations_.end());
+  if (it != migrations_.end()) {
+    it->second.handing_over = false;
+  }
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <unordered_map>
+
+#include <folly/SharedMutex.h>
+
+#include "logdevice/common/types_internal.h"
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Table of logs whose log-affine requests were moved off the worker
+ *       their thread affinity hashes them to, because that worker was
+ *       overloaded (see Settings::log_worker_migration_load_skew).
+ *
+ *       An entry is keyed by the log and the worker the requests hash to,
+ *       `from', and says which worker `to' they go to instead. Right after it
+ *       is created, the entry is handing over: requests that were already
+ *       posted to `from' may not have executed yet, so `to' holds the new
+ *       requests for the log until LogWorkerHandoverRequest tells it that
+ *       `from' has caught up. Entries are never removed, a log is migrated at
+ *       most once from each worker.
+ *
+ *       Thread-safe. Lookups of an empty table don't take the lock.
+ */
+
+class LogWorkerMigrations {
+ public:
+  /**
+   * Returns the worker that requests for `log' hashed to worker `hashed'
+   * should be posted to.
+   */
+  worker_id_t route(logid_t log, worker_id_t hashed) const;
+
+  /**
+   * Returns true if requests for `log' hashed to `from' were migrated to
+   * another worker and the handover is still in progress.
+   */
+  bool isHandingOver(logid_t log, worker_id_t from) const;
+
+  /**
+   * Starts migrating the requests for `log' hashed to `from' to worker `to'.
+   *
+   * @return false if they were already migrated.
+   */
+  bool begin(logid_t log, worker_id_t from, worker_id_t to);
+
+  /**
+   * Called on worker `to' once `from' has executed all the requests posted
+   * to it before begin().
+   */
+  void completeHandover(logid_t log, worker_id_t from);
+
+  size_t size() const {
+    return size_.load();
+  }
+
+ private:
+  struct Key {
+    logid_t log;
+    worker_id_t from;
+
+    bool operator==(const Key& other) const {
+      return log == other.log && from == other.from;
+    }
+  };
+
+  struct KeyHasher {
+    size_t operator()(const Key& key) const;
+  };
+
+  struct Migration {
+    worker_id_t to;
+    bool handing_over;
+  };
+
+  mutable folly::SharedMutex mutex_;
+  std::unordered_map<Key, Migration, KeyHasher> migrations_;
+  std::atomic<size_t> size_{0};
+};
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/MessageArena.h"
+
+#include <new>
+
+#include "logdevice/common/checks.h"
+
+namespace facebook { namespace logdevice {
+
+constexpr size_t MessageArena::HEADER_SIZE;
+
+__thread MessageArena* MessageArena::current_;
+
+MessageArena::MessageArena(size_t size)
+    : buf_(new char[size]), size_(size) {}
+
+MessageArena::~MessageArena() {
+  if (live_.load() > 0) {
+    // Messages from the arena outlived the Worker, which can only happen
+    // during shutdown. Leave them the buffer.
+    buf_.release();
+  }
+}
+
+void* MessageArena::allocate(size_t size) {
+  const size_t total = HEADER_SIZE +
+      (size + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE;
+
+  MessageArena* arena = current_;
+  char* p = nullptr;
+  if (arena != nullptr) {
+    if (arena->live_.load(std::memory_order_acquire) == 0) {
+      // Everything allocated so far has been freed.
+      arena->offset_ = 0;
+    }
+    if (arena->offset_ + total <= arena->size_) {
+      p = arena->buf_.get() + arena->offset_;
+      arena->offset_ += total;
+      arena->live_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      arena = nullptr;
+    }
+  }
+  if (p == nullptr) {
+    p = static_cast<char*>(::operator new(total));
+  }
+
+  *reinterpret_cast<MessageArena**>(p) = arena;
+  return p + HEADER_SIZE;
+}
+
+void MessageArena::deallocate(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  char* p = static_cast<char*>(ptr) - HEADER_SIZE;
+  MessageArena* arena = *reinterpret_cast<MessageArena**>(p);
+  if (arena == nullptr) {
+    ::operator delete(p);
+    return;
+  }
+  ld_check(arena->live_.load() > 0);
+  arena->live_.fetch_sub(1, std::memory_order_release);
+}
+
+}} // namespace facebook::logdevice
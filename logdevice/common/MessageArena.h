@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file MessageArena is a bump allocator for received Messages that are
+ *       destroyed as soon as their onReceived() returns, such as STORED,
+ *       WINDOW, RELEASE and GAP. It saves a trip to the general heap for
+ *       every one of these messages on the receive path.
+ *
+ *       Each Worker owns an arena if --message-arena-kb is nonzero.
+ *       Socket::receiveMessage() makes it current with a MessageArena::Scope
+ *       while deserializing a message, and message classes opt in by
+ *       defining their operator new and delete with MESSAGE_ARENA_ALLOCATED.
+ *       Instances of those classes created outside a Scope, or that don't
+ *       fit in the arena, come from the heap as usual.
+ *
+ *       The arena counts its live allocations and rewinds to the start of
+ *       its buffer on the next allocation after they're all freed, which in
+ *       the common case is right after the message's onReceived() returns.
+ *       A message that is kept longer (Disposition::KEEP) just holds the
+ *       arena at its current position until it's freed, from any thread.
+ */
+
+class MessageArena {
+ public:
+  explicit MessageArena(size_t size);
+  ~MessageArena();
+
+  MessageArena(const MessageArena&) = delete;
+  MessageArena& operator=(const MessageArena&) = delete;
+
+  /**
+   * Makes the given arena, which may be null, the one used by allocate() on
+   * this thread for the lifetime of the Scope.
+   */
+  class Scope {
+   public:
+    explicit Scope(MessageArena* arena) : prev_(current_) {
+      current_ = arena;
+    }
+    ~Scope() {
+      current_ = prev_;
+    }
+
+   private:
+    MessageArena* prev_;
+  };
+
+  /**
+   * Allocates size bytes from the current arena if there is one with enough
+   * room left, from the heap otherwise.
+   */
+  static void* allocate(size_t size);
+
+  /**
+   * Frees memory returned by allocate().
+   */
+  static void deallocate(void* ptr);
+
+  /**
+   * Number of allocations from this arena that haven't been freed yet.
+   */
+  size_t liveAllocations() const {
+    return live_.load();
+  }
+
+ private:
+  // Every allocation is preceded by the arena it came from, or nullptr if
+  // it came from the heap.
+  static constexpr size_t HEADER_SIZE = alignof(std::max_align_t);
+
+  static __thread MessageArena* current_;
+
+  std::unique_ptr<char[]> buf_;
+  const size_t size_;
+
+  // Offset of the first free byte of buf_. Only used on the owning thread.
+  size_t offset_ = 0;
+
+  std::atomic<size_t> live_{0};
+};
+
+/**
+ * Allocates instances of the Message class it is used in from the current
+ * MessageArena, see above.
+ */
+#define MESSAGE_ARENA_ALLOCATED                      \
+  static void* operator new(size_t size) {           \
+    return MessageArena::allocate(size);             \
+  }                                                  \
+  static void operator delete(void* ptr) {           \
+    MessageArena::deallocate(ptr);                   \
+  }
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,190 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/NodeSetFinderCoalescer.h"
+
+#include <algorithm>
+
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+NodeSetFinderCoalescer::Handle::~Handle() {
+  NodeSetFinderCoalescer* owner = owner_.get();
+  if (owner) {
+    owner->cancel(id_);
+  }
+}
+
+NodeSetFinderCoalescer::NodeSetFinderCoalescer(
+    UpdateableSettings<Settings> settings)
+    : settings_(std::move(settings)), ref_holder_(this) {}
+
+NodeSetFinderCoalescer::~NodeSetFinderCoalescer() = default;
+
+std::unique_ptr<NodeSetFinderCoalescer::Handle>
+NodeSetFinderCoalescer::find(logid_t log_id,
+                             epoch_t epoch,
+                             NodeSetFinder::Source source,
+                             std::chrono::milliseconds timeout,
+                             Callback cb) {
+  const uint64_t id = next_id_++;
+  waiters_.emplace(id,
+                   Waiter{Key(log_id, source),
+                          epoch,
+                          timeout,
+                          std::move(cb),
+                          /*group_id=*/0,
+                          /*joined_running=*/false});
+  addToGroup(id);
+  return std::make_unique<Handle>(ref_holder_.ref(), id);
+}
+
+/* static */
+bool NodeSetFinderCoalescer::coversEpoch(const EpochMetaDataMap& map,
+                                         epoch_t epoch) {
+  if (epoch > map.getEffectiveUntil()) {
+    return false;
+  }
+  auto it = map.find(epoch);
+  return it != map.end() && ++it != map.end();
+}
+
+void NodeSetFinderCoalescer::addToGroup(uint64_t id) {
+  auto w = waiters_.find(id);
+  ld_check(w != waiters_.end());
+  Waiter& waiter = w->second;
+
+  auto open = open_groups_.find(waiter.key);
+  if (open != open_groups_.end()) {
+    Group& group = *groups_.at(open->second);
+    group.waiters.push_back(id);
+    waiter.group_id = open->second;
+    waiter.joined_running = group.started;
+    WORKER_STAT_INCR(client_read_stream_metadata_reads_coalesced);
+    return;
+  }
+
+  const uint64_t group_id = next_id_++;
+  auto group = std::make_unique<Group>();
+  group->key = waiter.key;
+  group->finder = createNodeSetFinder(
+      waiter.key.first,
+      waiter.timeout,
+      [this, group_id](Status st) { onFinderDone(group_id, st); },
+      waiter.key.second);
+  group->waiters.push_back(id);
+  groups_.emplace(group_id, std::move(group));
+  if (settings_->read_streams_coalesce_metadata_reads) {
+    open_groups_[waiter.key] = group_id;
+  }
+  waiter.group_id = group_id;
+  waiter.joined_running = false;
+
+  pending_start_.push_back(group_id);
+  if (pending_start_.size() == 1) {
+    scheduleStart();
+  }
+}
+
+std::unique_ptr<NodeSetFinderCoalescer::Group>
+NodeSetFinderCoalescer::removeGroup(uint64_t group_id) {
+  auto it = groups_.find(group_id);
+  ld_check(it != groups_.end());
+  std::unique_ptr<Group> group = std::move(it->second);
+  groups_.erase(it);
+  auto open = open_groups_.find(group->key);
+  if (open != open_groups_.end() && open->second == group_id) {
+    open_groups_.erase(open);
+  }
+  return group;
+}
+
+void NodeSetFinderCoalescer::cancel(uint64_t id) {
+  auto w = waiters_.find(id);
+  if (w == waiters_.end()) {
+    // The callback was already called.
+    return;
+  }
+  const uint64_t group_id = w->second.group_id;
+  waiters_.erase(w);
+
+  auto it = groups_.find(group_id);
+  if (it == groups_.end()) {
+    // The group's NodeSetFinder is finishing and calling the callbacks.
+    return;
+  }
+  auto& ids = it->second->waiters;
+  ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+  if (ids.empty()) {
+    // Nobody needs the result anymore.
+    removeGroup(group_id);
+  }
+}
+
+std::unique_ptr<NodeSetFinder> NodeSetFinderCoalescer::createNodeSetFinder(
+    logid_t log_id,
+    std::chrono::milliseconds timeout,
+    std::function<void(Status)> cb,
+    NodeSetFinder::Source source) {
+  return std::make_unique<NodeSetFinder>(
+      log_id, timeout, std::move(cb), source);
+}
+
+void NodeSetFinderCoalescer::scheduleStart() {
+  if (start_timer_ == nullptr) {
+    start_timer_ = std::make_unique<Timer>([this] { startPendingFinders(); });
+  }
+  start_timer_->activate(
+      std::chrono::microseconds(0), &Worker::onThisThread()->commonTimeouts());
+}
+
+void NodeSetFinderCoalescer::startPendingFinders() {
+  std::vector<uint64_t> pending;
+  pending.swap(pending_start_);
+  for (uint64_t group_id : pending) {
+    // Look the group up every time: starting a NodeSetFinder may finish it,
+    // and its callbacks may cancel other groups.
+    auto it = groups_.find(group_id);
+    if (it == groups_.end()) {
+      continue;
+    }
+    it->second->started = true;
+    it->second->finder->start();
+  }
+}
+
+void NodeSetFinderCoalescer::onFinderDone(uint64_t group_id, Status st) {
+  // Keep the group, and its NodeSetFinder that is calling us, alive until
+  // we're done.
+  std::unique_ptr<Group> group = removeGroup(group_id);
+
+  std::shared_ptr<const EpochMetaDataMap> result =
+      st == E::OK ? group->finder->getResult() : nullptr;
+
+  for (uint64_t id : group->waiters) {
+    // Callbacks may cancel the requests after them.
+    auto w = waiters_.find(id);
+    if (w == waiters_.end()) {
+      continue;
+    }
+    if (st == E::OK && w->second.joined_running &&
+        !coversEpoch(*result, w->second.epoch)) {
+      // The NodeSetFinder may have read the metadata before the requested
+      // epoch was released. Try again with a new one.
+      WORKER_STAT_INCR(client_read_stream_metadata_reads_coalesced_retried);
+      addToGroup(id);
+      continue;
+    }
+    Callback cb = std::move(w->second.cb);
+    waiters_.erase(w);
+    cb(st, result);
+  }
+}
+
+}} // namespace facebook::logdevice
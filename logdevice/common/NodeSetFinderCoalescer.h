@@ -0,0 +1,160 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "logdevice/common/EpochMetaDataMap.h"
+#include "logdevice/common/NodeSetFinder.h"
+#include "logdevice/common/Timer.h"
+#include "logdevice/common/WeakRefHolder.h"
+#include "logdevice/common/settings/Settings.h"
+#include "logdevice/common/settings/UpdateableSettings.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file NodeSetFinderCoalescer lets the read streams of a Worker that need the
+ *       historical metadata of the same log at the same time share a single
+ *       NodeSetFinder, instead of each reading the metadata log (or asking
+ *       the sequencer) on its own. This is what happens when many readers of
+ *       a log start together, e.g. after the client restarts, or when they
+ *       all cross into an epoch whose metadata isn't in the
+ *       EpochMetaDataCache.
+ *
+ *       Metadata for an epoch may only be trusted if it was read after the
+ *       epoch was released (see MetaDataLogReader.h), so a request joins a
+ *       NodeSetFinder only if that's guaranteed:
+ *        - NodeSetFinders are started on the event loop iteration after the
+ *          one they were created in, and requests made before then join
+ *          them unconditionally;
+ *        - a request that joins a NodeSetFinder already running is given its
+ *          result only if the result has metadata for a later epoch than the
+ *          requested one, which proves the requested epoch's metadata was
+ *          final. Otherwise the request is retried with a new NodeSetFinder.
+ *
+ *       One instance per Worker, not thread safe.
+ */
+
+class NodeSetFinderCoalescer {
+ public:
+  using Callback =
+      std::function<void(Status, std::shared_ptr<const EpochMetaDataMap>)>;
+
+  /**
+   * Returned by find(). Destroying it cancels the request; its callback is
+   * then not called.
+   */
+  class Handle {
+   public:
+    Handle(WeakRefHolder<NodeSetFinderCoalescer>::Ref owner, uint64_t id)
+        : owner_(std::move(owner)), id_(id) {}
+    ~Handle();
+
+    Handle(const Handle&) = delete;
+    Handle& operator=(const Handle&) = delete;
+
+   private:
+    WeakRefHolder<NodeSetFinderCoalescer>::Ref owner_;
+    const uint64_t id_;
+  };
+
+  explicit NodeSetFinderCoalescer(UpdateableSettings<Settings> settings);
+
+  virtual ~NodeSetFinderCoalescer();
+
+  /**
+   * Finds the historical metadata of `log_id` from `source`, for a read
+   * stream that needs the metadata of `epoch`. Calls `cb` with the status
+   * and result of the NodeSetFinder that got it, see NodeSetFinder. The
+   * callback is never called synchronously.
+   *
+   * @param timeout  timeout of the NodeSetFinder, if one is created for this
+   *                 request
+   */
+  std::unique_ptr<Handle> find(logid_t log_id,
+                               epoch_t epoch,
+                               NodeSetFinder::Source source,
+                               std::chrono::milliseconds timeout,
+                               Callback cb);
+
+  /**
+   * @return  whether the result of a NodeSetFinder that started before
+   *          `epoch` may have been released can be used to read `epoch`,
+   *          i.e. whether `map` has metadata for a later epoch.
+   */
+  static bool coversEpoch(const EpochMetaDataMap& map, epoch_t epoch);
+
+ protected:
+  virtual std::unique_ptr<NodeSetFinder>
+  createNodeSetFinder(logid_t log_id,
+                      std::chrono::milliseconds timeout,
+                      std::function<void(Status)> cb,
+                      NodeSetFinder::Source source);
+
+  // Arranges for startPendingFinders() to be called on the next event loop
+  // iteration.
+  virtual void scheduleStart();
+
+  // Starts the NodeSetFinders created since the last call.
+  void startPendingFinders();
+
+ private:
+  using Key = std::pair<logid_t, NodeSetFinder::Source>;
+
+  // Requests sharing a NodeSetFinder.
+  struct Group {
+    Key key;
+    std::unique_ptr<NodeSetFinder> finder;
+    bool started = false;
+    std::vector<uint64_t> waiters;
+  };
+
+  struct Waiter {
+    Key key;
+    epoch_t epoch;
+    std::chrono::milliseconds timeout;
+    Callback cb;
+    uint64_t group_id;
+    // Joined a NodeSetFinder that had already started, see the file comment.
+    bool joined_running;
+  };
+
+  UpdateableSettings<Settings> settings_;
+
+  uint64_t next_id_ = 1;
+  std::unordered_map<uint64_t, Waiter> waiters_;
+  std::unordered_map<uint64_t, std::unique_ptr<Group>> groups_;
+
+  // The group new requests for a log and source join, if any. Without
+  // read-streams-coalesce-metadata-reads, groups are never open.
+  std::map<Key, uint64_t> open_groups_;
+
+  // Groups created since the last startPendingFinders().
+  std::vector<uint64_t> pending_start_;
+  std::unique_ptr<Timer> start_timer_;
+
+  // Adds waiter `id` to the open group of its key, creating it if needed.
+  void addToGroup(uint64_t id);
+
+  // Removes the group from groups_ and open_groups_, returning it.
+  std::unique_ptr<Group> removeGroup(uint64_t group_id);
+
+  void cancel(uint64_t id);
+
+  void onFinderDone(uint64_t group_id, Status st);
+
+  WeakRefHolder<NodeSetFinderCoalescer> ref_holder_;
+};
+
+}} // namespace facebook::logdevice
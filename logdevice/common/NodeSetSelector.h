@@ -42,6 +42,13 @@ class NodeSetSelector {
     // Nodes that shouldn't be picked into nodeset
     // (as if they weren't in config).
     std::unordered_set<node_index_t> exclude_nodes;
+
+    // Recently observed load of storage shards, from 0 (idle) to 1 (out of
+    // space or saturated), see ShardLoadTracker. Selectors that support it
+    // prefer less loaded shards within each failure domain, without changing
+    // how many shards they take from each domain. Shards missing from the map
+    // are considered idle.
+    std::unordered_map<ShardID, double, ShardID::Hash> shard_load;
   };
 
   /**
@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "logdevice/common/checks.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Bounded per-thread cache of the memory of destroyed objects of type
+ *       T, for classes allocated and destroyed at high rates on Worker
+ *       threads (Appender, STORE_Message). Meant to back class-specific
+ *       operator new/delete:
+ *
+ *         static void* operator new(size_t size) {
+ *           bool reused;
+ *           void* p = ObjectPool<Foo>::allocate(size, &reused);
+ *           ...bump stats...
+ *           return p;
+ *         }
+ *         static void operator delete(void* p, size_t size) {
+ *           ObjectPool<Foo>::deallocate(p, size);
+ *         }
+ *
+ *       Only blocks of exactly sizeof(T) are cached, so subclasses of T (e.g.
+ *       mocks in tests) go straight to the global allocator. Memory freed on
+ *       a thread is only reused by that thread; objects created on one
+ *       thread and destroyed on another are fine, the block just migrates.
+ *       At most Capacity blocks are kept per thread, the rest are freed.
+ */
+template <typename T, size_t Capacity = 1024>
+class ObjectPool {
+ public:
+  /**
+   * @param size    size of the object, as passed to operator new
+   * @param reused  set to true if the memory came from the cache
+   *
+   * @return memory for an object of `size` bytes. Throws std::bad_alloc on
+   *         failure, like operator new.
+   */
+  static void* allocate(size_t size, bool* reused) {
+    ld_check(reused);
+    if (size == sizeof(T)) {
+      auto& blocks = freeList().blocks;
+      if (!blocks.empty()) {
+        void* p = blocks.back();
+        blocks.pop_back();
+        *reused = true;
+        return p;
+      }
+    }
+    *reused = false;
+    return ::operator new(size);
+  }
+
+  static void deallocate(void* p, size_t size) {
+    if (p == nullptr) {
+      return;
+    }
+    if (size == sizeof(T)) {
+      auto& blocks = freeList().blocks;
+      if (blocks.size() < Capacity) {
+        blocks.push_back(p);
+        return;
+      }
+    }
+    ::operator delete(p);
+  }
+
+  // Number of blocks currently cached by the calling thread
+  static size_t cached() {
+    return freeList().blocks.size();
+  }
+
+ private:
+  struct FreeList {
+    FreeList() {
+      blocks.reserve(Capacity);
+    }
+    ~FreeList() {
+      for (void* p : blocks) {
+        ::operator delete(p);
+      }
+    }
+    std::vector<void*> blocks;
+  };
+
+  static FreeList& freeList() {
+    static thread_local FreeList list;
+    return list;
+  }
+};
+
+}} // namespace facebook::logdevice
@@ -14,6 +14,7 @@
 #include "logdevice/common/libevent/compat.h"
 #include "logdevice/common/protocol/ProtocolReader.h"
 #include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/types_internal.h"
 
 namespace facebook { namespace logdevice {
 
@@ -66,10 +67,21 @@ void PayloadHolder::serialize(ProtocolWriter& writer) const {
   } else if (payload_flat_.data()) {
     ld_check(payload_flat_.size() < Message::MAX_LEN); // must have been checked
                                                        // by upper layers
-    writer.write(payload_flat_.data(), payload_flat_.size());
+    if (serializesByReference()) {
+      writer.writeWithoutCopy(payload_flat_.data(), payload_flat_.size());
+    } else {
+      writer.write(payload_flat_.data(), payload_flat_.size());
+    }
   }
 }
 
+bool PayloadHolder::serializesByReference() const {
+  // Unowned payloads may be freed by their owner (e.g. a timed out
+  // AppendRequest) while the message is still queued, so they are copied.
+  return payload_evbuffer_ != nullptr ||
+      (owned_ && payload_flat_.size() > MAX_COPY_TO_EVBUFFER_PAYLOAD_SIZE);
+}
+
 /* static */
 PayloadHolder PayloadHolder::deserialize(ProtocolReader& reader,
                                          size_t payload_size,
@@ -120,7 +120,12 @@ class PayloadHolder {
   size_t size() const;
 
   /**
-   * Serializes the payload into evbuffer.
+   * Serializes the payload into evbuffer. Payloads backed by an evbuffer and
+   * owned flat payloads larger than MAX_COPY_TO_EVBUFFER_PAYLOAD_SIZE are
+   * added by reference rather than copied (see serializesByReference()), so
+   * that the messages for all copyset members share the same buffer. The
+   * caller must keep this PayloadHolder alive until the written bytes are
+   * sent, as Messages owning it do by staying in the Socket's send queue.
    *
    * @param writer     ProtocolWriter that encapsulates the evbuffer to
    *                   write into
@@ -131,6 +136,12 @@ class PayloadHolder {
    */
   void serialize(ProtocolWriter& writer) const;
 
+  /**
+   * @return  true if serialize() adds the payload to the destination evbuffer
+   *          by reference, false if it copies it
+   */
+  bool serializesByReference() const;
+
   /**
    * Deserialze by constructing a PayloadHolder object from evbuffer. Note that
    * evbuffer might get changed after the call.
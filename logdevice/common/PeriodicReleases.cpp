@@ -350,6 +350,10 @@ int PeriodicReleases::sendReleaseToStorageSets(
   return sequencer_->sendReleases(lsn, release_type, pred);
 }
 
+bool PeriodicReleases::isStreamingIngest() const {
+  return sequencer_->isStreamingIngest();
+}
+
 const Settings& PeriodicReleases::getSettings() const {
   return Worker::settings();
 }
@@ -363,7 +367,15 @@ void PeriodicReleases::startPeriodicReleaseTimer(Type type) {
   chrono_expbackoff_t<ExponentialBackoffTimer::Duration> interval;
   switch (type) {
     case PeriodicReleases::Type::RETRY:
-      interval = Worker::settings().release_retry_interval;
+      if (isStreamingIngest()) {
+        // releases of these logs are only sent by this timer
+        const auto streaming_interval =
+            Worker::settings().streaming_ingest_release_interval;
+        interval = chrono_expbackoff_t<ExponentialBackoffTimer::Duration>(
+            streaming_interval, streaming_interval);
+      } else {
+        interval = Worker::settings().release_retry_interval;
+      }
       break;
     case PeriodicReleases::Type::BROADCAST: {
       const bool internal = configuration::InternalLogs::isInternal(getLogID());
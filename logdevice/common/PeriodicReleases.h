@@ -154,6 +154,10 @@ class PeriodicReleases
 
   virtual bool isShuttingDown() const;
 
+  // if true, RELEASEs of the log are only sent by the RETRY timer, which then
+  // fires every streaming_ingest_release_interval
+  virtual bool isStreamingIngest() const;
+
  private:
   // Describes all states PeriodicReleases can be in wrt the timer running
   // ReleaseTimerCallback. Graph of state transitions is a bidirectional chain:
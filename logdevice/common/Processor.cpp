@@ -8,6 +8,8 @@
 #include "Processor.h"
 
 #include <algorithm>
+#include <limits>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <vector>
@@ -25,12 +27,14 @@
 #include "logdevice/common/ClusterState.h"
 #include "logdevice/common/EventLoopHandle.h"
 #include "logdevice/common/LegacyPluginPack.h"
+#include "logdevice/common/LogWorkerMigrations.h"
 #include "logdevice/common/MetaDataLogWriter.h"
 #include "logdevice/common/PermissionChecker.h"
 #include "logdevice/common/Request.h"
 #include "logdevice/common/SecurityInformation.h"
 #include "logdevice/common/SequencerBatching.h"
 #include "logdevice/common/SequencerLocator.h"
+#include "logdevice/common/ShardLoadTracker.h"
 #include "logdevice/common/Thread.h"
 #include "logdevice/common/TraceLogger.h"
 #include "logdevice/common/TrafficShaper.h"
@@ -39,6 +43,7 @@
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/WorkerLoadBalancing.h"
 #include "logdevice/common/ZeroCopiedRecordDisposal.h"
+#include "logdevice/common/client_read_stream/ClientReadStreamReconnectLimiter.h"
 #include "logdevice/common/configuration/UpdateableConfig.h"
 #include "logdevice/common/event_log/EventLogRebuildingSet.h"
 #include "logdevice/common/plugin/CommonBuiltinPlugins.h"
@@ -100,6 +105,9 @@ class ProcessorImpl {
   WorkerLoadBalancing worker_load_balancing_;
   ClientIdxAllocator client_idx_allocator_;
   std::unique_ptr<ZeroCopiedRecordDisposal> record_disposal_;
+  ClientReadStreamReconnectLimiter read_stream_reconnect_limiter_;
+  LogWorkerMigrations log_worker_migrations_;
+  ShardLoadTracker shard_load_tracker_;
 
   // for lazy init of background queue and threads
   folly::once_flag background_init_flag_;
@@ -119,6 +127,12 @@ void settingsUpdated(const UpdateableSettings<Settings>& settings) {
     ld_info("abort-on-failed-catch is %s", ca ? "on" : "off");
   }
 }
+
+uint64_t outbufBudgetLimit(const Settings& settings) {
+  return settings.outbufs_mb_max_total > 0
+      ? settings.outbufs_mb_max_total * 1024 * 1024
+      : std::numeric_limits<uint64_t>::max();
+}
 } // namespace
 
 Processor::Processor(std::shared_ptr<UpdateableConfig> updateable_config,
@@ -143,6 +157,7 @@ Processor::Processor(std::shared_ptr<UpdateableConfig> updateable_config,
       conn_budget_incoming_(settings_->max_incoming_connections),
       conn_budget_backlog_(settings_->connection_backlog),
       conn_budget_external_(settings_->max_external_connections),
+      outbuf_budget_(outbufBudgetLimit(*settings_.get())),
       api_hits_tracer_(std::make_unique<ClientAPIHitsTracer>(trace_logger)),
       HELLOCredentials_(settings_->server ? Principal::CLUSTER_NODE
                                           : std::move(credentials)),
@@ -288,7 +303,8 @@ Processor::Processor(UpdateableSettings<Settings> settings,
       impl_(new ProcessorImpl(this, settings)),
       conn_budget_incoming_(settings_.get()->max_incoming_connections),
       conn_budget_backlog_(settings_.get()->connection_backlog),
-      conn_budget_external_(settings_.get()->max_external_connections) {
+      conn_budget_external_(settings_.get()->max_external_connections),
+      outbuf_budget_(outbufBudgetLimit(*settings_.get())) {
   ld_check(settings.get());
   num_general_workers_ = settings_->num_workers;
   impl_->record_disposal_ = std::make_unique<ZeroCopiedRecordDisposal>(this);
@@ -409,6 +425,78 @@ int Processor::postRequest(std::unique_ptr<Request>& rq) {
       rq, rq->getWorkerTypeAffinity(), getTargetThreadForRequest(rq));
 }
 
+int Processor::postManyImpl(std::vector<std::unique_ptr<Request>>& rqs,
+                            bool force) {
+  struct Batch {
+    WorkerType worker_type;
+    int target_thread;
+    // Indices in rqs of the requests going to the worker.
+    std::vector<size_t> idxs;
+  };
+  std::vector<Batch> batches;
+  std::map<std::pair<WorkerType, int>, size_t> batch_by_worker;
+
+  int rv = 0;
+  for (size_t i = 0; i < rqs.size(); ++i) {
+    if (!rqs[i]) {
+      err = E::INVALID_PARAM;
+      rv = -1;
+      continue;
+    }
+    const WorkerType worker_type = rqs[i]->getWorkerTypeAffinity();
+    const int target_thread = getTargetThreadForRequest(rqs[i]);
+    if (target_thread >= getWorkerCount(worker_type)) {
+      err = E::INVALID_PARAM;
+      rv = -1;
+      continue;
+    }
+    auto res = batch_by_worker.emplace(
+        std::make_pair(worker_type, target_thread), batches.size());
+    if (res.second) {
+      batches.push_back(Batch{worker_type, target_thread, {}});
+    }
+    batches[res.first->second].idxs.push_back(i);
+  }
+
+  std::vector<std::unique_ptr<Request>> batch_rqs;
+  std::vector<RequestType> types;
+  for (const Batch& batch : batches) {
+    batch_rqs.clear();
+    types.clear();
+    for (size_t i : batch.idxs) {
+      types.push_back(rqs[i]->type_);
+      batch_rqs.push_back(std::move(rqs[i]));
+    }
+    auto& wh = findWorker(batch.worker_type, batch.target_thread);
+    const int batch_rv =
+        force ? wh.forcePostRequests(batch_rqs) : wh.postRequests(batch_rqs);
+    for (RequestType type : types) {
+      Request::bumpStatsWhenPosted(stats_,
+                                   type,
+                                   batch.worker_type,
+                                   worker_id_t(batch.target_thread),
+                                   batch_rv == 0);
+    }
+    if (batch_rv != 0) {
+      // Give the requests back to the caller.
+      for (size_t j = 0; j < batch.idxs.size(); ++j) {
+        rqs[batch.idxs[j]] = std::move(batch_rqs[j]);
+      }
+      rv = -1;
+    }
+  }
+  return rv;
+}
+
+int Processor::postRequests(std::vector<std::unique_ptr<Request>>& rqs) {
+  return postManyImpl(rqs, /* force */ false);
+}
+
+int Processor::postImportantRequests(
+    std::vector<std::unique_ptr<Request>>& rqs) {
+  return postManyImpl(rqs, /* force */ true);
+}
+
 int Processor::blockingRequest(std::unique_ptr<Request>& rq) {
   return impl_
       ->workers_[static_cast<uint8_t>(rq->getWorkerTypeAffinity())]
@@ -535,6 +623,14 @@ void Processor::reportLoad(worker_id_t idx,
   impl_->worker_load_balancing_.reportLoad(idx, load);
 }
 
+worker_id_t Processor::selectLeastLoadedWorker() {
+  return impl_->worker_load_balancing_.selectLeastLoadedWorker();
+}
+
+double Processor::getWorkerLoadSkew(worker_id_t idx) {
+  return impl_->worker_load_balancing_.getLoadSkew(idx);
+}
+
 int Processor::postImportant(std::unique_ptr<Request>& rq) {
   return postImpl(rq,
                   rq->getWorkerTypeAffinity(),
@@ -571,6 +667,19 @@ ZeroCopiedRecordDisposal& Processor::zeroCopiedRecordDisposal() const {
   return *impl_->record_disposal_;
 }
 
+ClientReadStreamReconnectLimiter&
+Processor::readStreamReconnectLimiter() const {
+  return impl_->read_stream_reconnect_limiter_;
+}
+
+LogWorkerMigrations& Processor::logWorkerMigrations() const {
+  return impl_->log_worker_migrations_;
+}
+
+ShardLoadTracker& Processor::shardLoadTracker() const {
+  return impl_->shard_load_tracker_;
+}
+
 namespace {
 // Lazily initialize the background queue and background threads.
 void initBackgroundQueueAndThreads(Processor* processor) {
@@ -12,6 +12,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <folly/AtomicBitSet.h>
 #include <folly/Function.h>
@@ -41,9 +42,11 @@ class AllSequencers;
 class AppendProbeController;
 class ClientAPIHitsTracer;
 class ClientIdxAllocator;
+class ClientReadStreamReconnectLimiter;
 class ClusterState;
 class EventLogRebuildingSet;
 class EventLoopHandle;
+class LogWorkerMigrations;
 class LegacyPluginPack;
 class PermissionChecker;
 class PluginRegistry;
@@ -53,6 +56,7 @@ class RebuildingSupervisor;
 class Request;
 class SequencerBatching;
 class SequencerLocator;
+class ShardLoadTracker;
 class StatsHolder;
 class TraceLogger;
 class TrafficShaper;
@@ -147,6 +151,11 @@ class Processor : public folly::enable_shared_from_this<Processor> {
                int target_thread,
                bool force);
 
+  /**
+   * Common implementation of postRequests() and postImportantRequests().
+   */
+  int postManyImpl(std::vector<std::unique_ptr<Request>>& rqs, bool force);
+
   /**
    * Decides which thread to send a request to.
    */
@@ -302,6 +311,26 @@ class Processor : public folly::enable_shared_from_this<Processor> {
     return postImportant(rq);
   }
 
+  /**
+   * Posts many Requests at once, e.g. for bulk operations across thousands
+   * of logs. The requests are grouped by the Worker they go to, and each
+   * Worker is woken up once for its group instead of once per request.
+   * Requests going to the same Worker execute in the order they are in
+   * `rqs'.
+   *
+   * postRequests() behaves like postRequest(), failing with NOBUFS for a
+   * Worker unless its queue has room for its whole group.
+   * postImportantRequests() behaves like postImportant().
+   *
+   * @param rqs  requests to execute. The ones that were posted are moved
+   *             from, the others remain in place.
+   *
+   * @return 0 if all the requests were posted, -1 if some were not. err is
+   *         set as by postRequest() for the last failure.
+   */
+  int postRequests(std::vector<std::unique_ptr<Request>>& rqs);
+  int postImportantRequests(std::vector<std::unique_ptr<Request>>& rqs);
+
   /**
    * Are we a storage node, able to store and deliver records?
    */
@@ -437,6 +466,18 @@ class Processor : public folly::enable_shared_from_this<Processor> {
   // sink for all ZeroCopiedRecord_s
   ZeroCopiedRecordDisposal& zeroCopiedRecordDisposal() const;
 
+  // Paces the reconnects of read streams to storage nodes, see
+  // ClientReadStreamReconnectLimiter.
+  ClientReadStreamReconnectLimiter& readStreamReconnectLimiter() const;
+
+  // Logs whose requests were migrated off the worker they hash to, see
+  // LogWorkerMigrations.
+  LogWorkerMigrations& logWorkerMigrations() const;
+
+  // Load of storage shards reported to this node's Appenders, used for
+  // load-aware nodeset selection, see ShardLoadTracker.
+  ShardLoadTracker& shardLoadTracker() const;
+
   // UpdateableSecurityInfo owned by the processor
   // encapsulates PrincipalParser and PermissionChecker
   std::unique_ptr<UpdateableSecurityInfo> security_info_;
@@ -466,6 +507,11 @@ class Processor : public folly::enable_shared_from_this<Processor> {
   // See Settings::max_external_connections_.
   ResourceBudget conn_budget_external_;
 
+  // Limits bytes pending in output evbuffers of all workers together.
+  // Senders reserve from it in large chunks. Unused unless
+  // Settings::outbufs_mb_max_total is set.
+  ResourceBudget outbuf_budget_;
+
   // Current rebuilding set. Unlike Worker::shard_status_, this is updated
   // immediately after receiving an event log record, without any grace period.
   // nullptr on server means that we haven't yet caught up on the event log.
@@ -536,6 +582,13 @@ class Processor : public folly::enable_shared_from_this<Processor> {
                           int64_t load,
                           WorkerType worker_type);
 
+  /**
+   * Proxies for WorkerLoadBalancing::selectLeastLoadedWorker() and
+   * getLoadSkew(), for the GENERAL worker pool.
+   */
+  worker_id_t selectLeastLoadedWorker();
+  double getWorkerLoadSkew(worker_id_t idx);
+
   SequencerBatching& sequencerBatching();
 
   const std::string& getName() {
@@ -559,6 +612,11 @@ class Processor : public folly::enable_shared_from_this<Processor> {
     return plugin_registry_;
   }
 
+  // nullptr on clients
+  WatchDogThread* getWatchDogThread() const {
+    return watchdog_thread_.get();
+  }
+
   // Run the given function on whichever background thread gets to it first.
   // The three methods of enqueueing are just wrappers on the write*() methods
   // of MPMCQueue.  Briefly, "Blocking()" will block indefinitely until there's
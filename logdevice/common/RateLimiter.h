@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstddef>
@@ -197,6 +198,20 @@ class RateLimiterBase {
     }
   }
 
+  // How long until an operation will be allowed, without reserving anything.
+  // Zero if allowed right now.
+  Duration timeUntilAllowed() const {
+    if (limit_per_second == -1.) {
+      return Duration::zero();
+    }
+    if (limit_per_second == 0.) {
+      return Duration::max();
+    }
+    const Duration res =
+        TimePoint(next_allowed_time.load()) - Deps::currentTime();
+    return std::max(res, Duration::zero());
+  }
+
   bool isUnlimited() const {
     return limit_per_second == -1;
   }
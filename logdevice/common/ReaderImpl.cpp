@@ -10,6 +10,7 @@
 #include <chrono>
 #include <thread>
 
+#include <folly/Hash.h>
 #include <folly/Memory.h>
 #include <sys/time.h>
 
@@ -320,6 +321,9 @@ int ReaderImpl::startReadingImpl(logid_t log_id,
   if (payload_hash_only_) {
     read_stream->addStartFlags(START_Header::PAYLOAD_HASH_ONLY);
   }
+  if (copyset_index_only_) {
+    read_stream->addStartFlags(START_Header::CSI_DATA_ONLY);
+  }
   if (ship_pseudorecords_) {
     read_stream->shipPseudorecords();
   }
@@ -347,14 +351,32 @@ int ReaderImpl::startReadingImpl(logid_t log_id,
   // thread.
   //
   // Use load-aware worker assignment to avoid pathological cases like
-  // #7621815.
-  worker_id_t worker_id = processor_->selectWorkerLoadAware();
+  // #7621815, unless this Reader is confined to some workers.
+  worker_id_t worker_id = workers_.empty()
+      ? processor_->selectWorkerLoadAware()
+      : workers_[folly::hash::twang_mix64(log_id.val_) % workers_.size()];
   *handle_out = ReadingHandle{worker_id, rsid};
   std::unique_ptr<Request> req = std::make_unique<StartReadingRequest>(
       worker_id, log_id, std::move(read_stream));
   return processor_->postRequest(req);
 }
 
+std::vector<worker_id_t> ReaderImpl::workersForConsumer(size_t consumer,
+                                                        size_t nconsumers,
+                                                        size_t nworkers) {
+  ld_check(consumer < nconsumers);
+  ld_check(nworkers > 0);
+  std::vector<worker_id_t> workers;
+  if (nworkers < nconsumers) {
+    workers.emplace_back(consumer % nworkers);
+    return workers;
+  }
+  for (size_t w = consumer; w < nworkers; w += nconsumers) {
+    workers.emplace_back(w);
+  }
+  return workers;
+}
+
 // Production implementation of postStopReadingRequest(): tries to send a
 // StopReadingRequest to the Processor.  Tests are expected to stub out to
 // always succeed and not require an actual Processor to be running.
@@ -385,6 +407,10 @@ void ReaderImpl::payloadHashOnly() {
   payload_hash_only_ = true;
 }
 
+void ReaderImpl::copysetIndexOnly() {
+  copyset_index_only_ = true;
+}
+
 void ReaderImpl::doNotSkipPartiallyTrimmedSections() {
   do_not_skip_partially_trimmed_sections_ = true;
 }
@@ -12,6 +12,7 @@
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/mem_fun.hpp>
@@ -52,6 +53,11 @@ class ReaderImpl : public Reader {
   void waitOnlyWhenNoData() override;
   void withoutPayload() override;
   void payloadHashOnly();
+  // Records will be served from the copyset index of storage nodes, without
+  // reading record values: they'll have no payload and no timestamp. Good for
+  // consumers that only need LSNs and copysets, like replication checkers.
+  // Storage nodes that don't use the copyset index send full records instead.
+  void copysetIndexOnly();
   void includeByteOffset() override;
   void doNotSkipPartiallyTrimmedSections() override;
   int isConnectionHealthy(logid_t) const override;
@@ -104,6 +110,19 @@ class ReaderImpl : public Reader {
     buffer_type_ = buffer_type;
   }
 
+  // Reads logs on the given workers only, each log on one of them picked by
+  // its ID, rather than on the least loaded worker at the time
+  // startReading() is called. See Client::createReaders().
+  void setWorkers(std::vector<worker_id_t> workers) {
+    workers_ = std::move(workers);
+  }
+
+  // Workers for the consumer-th of nconsumers Readers created together out
+  // of nworkers: every nconsumers-th worker, so that no two Readers share a
+  // worker, or a single worker if there are more consumers than workers.
+  static std::vector<worker_id_t>
+  workersForConsumer(size_t consumer, size_t nconsumers, size_t nworkers);
+
  protected: // tests can override
   virtual int startReadingImpl(logid_t log_id,
                                lsn_t from,
@@ -155,6 +174,9 @@ class ReaderImpl : public Reader {
   // Indicates payloadHashOnly() was called
   bool payload_hash_only_ = false;
 
+  // Indicates copysetIndexOnly() was called
+  bool copyset_index_only_ = false;
+
   // Indicates requireFullReadSet() was called
   bool require_full_read_set_ = false;
 
@@ -187,6 +209,9 @@ class ReaderImpl : public Reader {
   // linear buffer
   ClientReadStreamBufferType buffer_type_{ClientReadStreamBufferType::CIRCULAR};
 
+  // From setWorkers(). Empty if logs may be read on any worker.
+  std::vector<worker_id_t> workers_;
+
   /**
    * This gets put on the MPMCQueue when ClientReadStream sends us something.
    * Each entry wraps either a DataRecord or a GapRecord.
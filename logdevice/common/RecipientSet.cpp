@@ -7,6 +7,8 @@
  */
 #include "logdevice/common/RecipientSet.h"
 
+#include <algorithm>
+
 #include "logdevice/common/Appender.h"
 #include "logdevice/common/Sender.h"
 #include "logdevice/common/protocol/STORE_Message.h"
@@ -76,6 +78,13 @@ bool RecipientSet::allRecipientsOutstanding() {
   return true;
 }
 
+copyset_size_t RecipientSet::numOutstanding() const {
+  return std::count_if(
+      recipients_.begin(), recipients_.end(), [](const Recipient& r) {
+        return r.state_ == Recipient::State::OUTSTANDING;
+      });
+}
+
 void RecipientSet::onStored(Recipient* r) {
   ld_check(r);
   ld_check(stored_ < recipients_.size());
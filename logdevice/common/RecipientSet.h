@@ -151,6 +151,9 @@ class RecipientSet {
 
   bool allRecipientsOutstanding();
 
+  // Number of recipients that haven't replied to the STORE message yet.
+  copyset_size_t numOutstanding() const;
+
   folly::fbvector<Recipient>& getRecipients() {
     return recipients_;
   }
@@ -150,6 +150,33 @@ int RequestPump::forcePost(std::unique_ptr<Request>& req) {
   return 0;
 }
 
+int RequestPump::tryPost(std::vector<std::unique_ptr<Request>>& reqs) {
+  if (impl_->sem.valueGuess() + reqs.size() > impl_->capacity) {
+    err = E::NOBUFS;
+    return -1;
+  }
+  return forcePost(reqs);
+}
+
+int RequestPump::forcePost(std::vector<std::unique_ptr<Request>>& reqs) {
+  if (UNLIKELY(impl_->sem.isShutdown())) {
+    err = E::SHUTDOWN;
+    return -1;
+  }
+  if (reqs.empty()) {
+    return 0;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  for (auto& req : reqs) {
+    ld_check(req);
+    req->enqueue_time_ = now;
+    impl_->queue.push(std::move(req));
+  }
+  // A single post() of the total wakes up the consumer once.
+  impl_->sem.post(reqs.size());
+  return 0;
+}
+
 void RequestPump::haveRequestsEventHandler(void* arg, short what) {
   RequestPump* self = static_cast<RequestPump*>(arg);
   if (!(what & EV_READ)) {
@@ -9,6 +9,7 @@
 
 #include <atomic>
 #include <memory>
+#include <vector>
 
 struct event_base;
 
@@ -87,6 +88,18 @@ class RequestPump {
    */
   int forcePost(std::unique_ptr<Request>& req);
 
+  /**
+   * Variants of tryPost() and forcePost() that queue several Requests at
+   * once, in order, waking up the EventLoop once for all of them. The
+   * EventLoop still executes at most requests_per_iteration of them per
+   * iteration.
+   *
+   * tryPost() fails with NOBUFS unless there is room for all of `reqs'.
+   * On success all of `reqs' are moved from; on failure none are.
+   */
+  int tryPost(std::vector<std::unique_ptr<Request>>& reqs);
+  int forcePost(std::vector<std::unique_ptr<Request>>& reqs);
+
   /**
    * Change number of requests to process per event loop iteration.
    * Can be updated on the fly, but only from the thread on which the
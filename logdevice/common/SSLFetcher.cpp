@@ -7,7 +7,11 @@
  */
 #include "logdevice/common/SSLFetcher.h"
 
+#include <cstdlib>
+
+#include <folly/FileUtil.h>
 #include <folly/portability/OpenSSL.h>
+#include <openssl/rand.h>
 
 // Values for supported identity certificate types
 #define HOST_IDENTITY_CERT_TYPE 0
@@ -17,6 +21,10 @@
 // 0x80 is the return value for ASN1_get_object() when any error occurs
 #define OPENSSL_ASN1_GET_OBJECT_ERROR 0x80
 
+// Size of the key set with SSL_CTX_set_tlsext_ticket_keys(): name, HMAC
+// secret and AES key, 16 bytes each
+#define SESSION_TICKET_KEY_SIZE 48
+
 namespace facebook { namespace logdevice {
 
 const char* SSLFetcher::IDENTITY_TYPE_OID = "1.3.6.1.4.1.40981.2.2.5";
@@ -144,4 +152,65 @@ int SSLFetcher::verify_callback(int preverify_ok, X509_STORE_CTX* x509_ctx) {
   return verify_cert;
 }
 
+SSL_SESSION* SSLFetcher::getSession(const std::string& key) const {
+  auto it = sessions_.find(key);
+  return it == sessions_.end() ? nullptr : it->second.get();
+}
+
+void SSLFetcher::saveSession(const std::string& key, SSL* ssl) {
+  folly::ssl::SSLSessionUniquePtr session(SSL_get1_session(ssl));
+  if (!session) {
+    return;
+  }
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+  // With TLS 1.3 the tickets come after the handshake. Until then the
+  // session can't be resumed, and the previous one is better.
+  if (!SSL_SESSION_is_resumable(session.get())) {
+    return;
+  }
+#endif
+  sessions_[key] = std::move(session);
+}
+
+void SSLFetcher::enableSessionTickets(SSL_CTX* ctx) const {
+  // Peer certificates are verified, and OpenSSL refuses to resume sessions
+  // on such contexts unless they have a session id context.
+  static const unsigned char sid_ctx[] = "logdevice";
+  SSL_CTX_set_session_id_context(ctx, sid_ctx, sizeof(sid_ctx) - 1);
+
+  std::string key = getTicketKey();
+  if (SSL_CTX_set_tlsext_ticket_keys(ctx, &key[0], key.size()) != 1) {
+    ld_error("Failed to set the session ticket key");
+  }
+}
+
+std::string SSLFetcher::getTicketKey() const {
+  if (!ticket_key_path_.empty()) {
+    std::string key;
+    if (folly::readFile(
+            ticket_key_path_.c_str(), key, SESSION_TICKET_KEY_SIZE) &&
+        key.size() == SESSION_TICKET_KEY_SIZE) {
+      return key;
+    }
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    1,
+                    "Failed to read a %d-byte session ticket key from %s, "
+                    "using a random key",
+                    SESSION_TICKET_KEY_SIZE,
+                    ticket_key_path_.c_str());
+  }
+  // Same for all workers, so that any of them can resume a session that
+  // another one issued.
+  static const std::string random_key = [] {
+    std::string key(SESSION_TICKET_KEY_SIZE, '\0');
+    if (RAND_bytes(reinterpret_cast<unsigned char*>(&key[0]), key.size()) !=
+        1) {
+      ld_critical("RAND_bytes() failed to generate a session ticket key");
+      std::abort();
+    }
+    return key;
+  }();
+  return random_key;
+}
+
 }} // namespace facebook::logdevice
@@ -9,8 +9,10 @@
 
 #include <chrono>
 #include <string>
+#include <unordered_map>
 
 #include <folly/io/async/SSLContext.h>
+#include <folly/ssl/OpenSSLPtrTypes.h>
 
 #include "logdevice/common/debug.h"
 
@@ -20,6 +22,11 @@ namespace facebook { namespace logdevice {
  * @file Loads the SSL context from the specified files, reloads it if it gets
  *       older than the defined expiration interval, provides a shared_ptr to
  *       folly::SSLContext. Does not implement any thread safety mechanics.
+ *
+ *       With session resumption, accepting contexts issue session tickets
+ *       encrypted with a key that is the same for all SSLFetchers of the
+ *       process, and the SSLFetcher keeps the last session of the connecting
+ *       side with every peer, see getSession() and saveSession().
  */
 
 class SSLFetcher {
@@ -30,11 +37,15 @@ class SSLFetcher {
   SSLFetcher(const std::string& cert_path,
              const std::string& key_path,
              const std::string& ca_path,
-             std::chrono::seconds refresh_interval)
+             std::chrono::seconds refresh_interval,
+             bool session_resumption = false,
+             const std::string& ticket_key_path = "")
       : cert_path_(cert_path),
         key_path_(key_path),
         ca_path_(ca_path),
-        refresh_interval_(refresh_interval) {}
+        refresh_interval_(refresh_interval),
+        session_resumption_(session_resumption),
+        ticket_key_path_(ticket_key_path) {}
 
   /**
    * @param loadCert          Defines whether or not the certificate will be
@@ -98,6 +109,11 @@ class SSLFetcher {
         SSL_CTX_set_session_cache_mode(
             context_->getSSLCtx(), SSL_SESS_CACHE_OFF);
 
+        // Session tickets are stateless: they don't need the cache.
+        if (session_resumption_ && ssl_accepting) {
+          enableSessionTickets(context_->getSSLCtx());
+        }
+
       } catch (const std::exception& ex) {
         ld_error("Failed to load SSL certificate, ex: %s", ex.what());
         context_.reset();
@@ -107,13 +123,29 @@ class SSLFetcher {
     return context_;
   }
 
+  /**
+   * Returns the session last saved with saveSession() under `key`, or
+   * nullptr. The session stays owned by this SSLFetcher; SSL_set_session()
+   * takes a reference of its own.
+   */
+  SSL_SESSION* getSession(const std::string& key) const;
+
+  /**
+   * Keeps the session of the connecting SSL connection `ssl` under `key`,
+   * typically the address of the peer, if it can be resumed.
+   */
+  void saveSession(const std::string& key, SSL* ssl);
+
  private:
   const std::string cert_path_;
   const std::string key_path_;
   const std::string ca_path_;
   const std::chrono::seconds refresh_interval_;
+  const bool session_resumption_;
+  const std::string ticket_key_path_;
 
   std::shared_ptr<folly::SSLContext> context_;
+  std::unordered_map<std::string, folly::ssl::SSLSessionUniquePtr> sessions_;
   std::chrono::time_point<std::chrono::steady_clock> last_loaded_;
   bool last_null_cipher_only_ = false;
   bool last_accepting_state_ = false;
@@ -123,6 +155,14 @@ class SSLFetcher {
   // extensions of a certificate.
   static int verify_callback(int preverify_ok, X509_STORE_CTX* x509_ctx);
 
+  // Sets the session ticket key of an accepting context, see
+  // --ssl-session-ticket-key-path.
+  void enableSessionTickets(SSL_CTX* ctx) const;
+
+  // Reads the ticket key from ticket_key_path_, or returns the random key of
+  // this process.
+  std::string getTicketKey() const;
+
   // a context update is required when refresh_interval_ has passed or when any
   // of the input information is changed
   bool requireContextUpdate(bool loadCert,
@@ -24,6 +24,8 @@
 #include "logdevice/common/EventHandler.h"
 #include "logdevice/common/FlowGroup.h"
 #include "logdevice/common/Processor.h"
+#include "logdevice/common/Request.h"
+#include "logdevice/common/RequestType.h"
 #include "logdevice/common/ResourceBudget.h"
 #include "logdevice/common/Sockaddr.h"
 #include "logdevice/common/Socket.h"
@@ -55,6 +57,32 @@ class DisconnectedClientCallback : public SocketCallback {
   void operator()(Status st, const Address& name) override;
 };
 
+// Posted by Sender::forwardMessage() to the Worker whose mailbox just went
+// from idle to non-empty.
+class DrainSenderMailboxRequest : public Request {
+ public:
+  explicit DrainSenderMailboxRequest(worker_id_t target)
+      : Request(RequestType::DRAIN_SENDER_MAILBOX), target_(target) {}
+
+  int getThreadAffinity(int /*nthreads*/) override {
+    return target_.val_;
+  }
+
+  Execution execute() override {
+    Worker::onThisThread()->sender().drainMailbox();
+    return Execution::COMPLETE;
+  }
+
+ private:
+  worker_id_t target_;
+};
+
+constexpr Sender::ServerConnection kServerConnections[] = {
+    Sender::ServerConnection::MAIN,
+    Sender::ServerConnection::REBUILDING,
+    Sender::ServerConnection::READ,
+};
+
 } // namespace
 
 class SenderImpl {
@@ -64,6 +92,8 @@ class SenderImpl {
              int32_t /*num_workers*/,
              ClientIdxAllocator* client_id_allocator)
       : server_sockets_(max_node_idx + 1),
+        rebuilding_server_sockets_(max_node_idx + 1),
+        read_server_sockets_(max_node_idx + 1),
         client_id_allocator_(client_id_allocator) {}
 
   // a map of all Sockets that have been created on this Worker thread
@@ -80,6 +110,35 @@ class SenderImpl {
   // The rate of reconnection attempts is controlled by a ConnectionThrottle.
   std::vector<std::unique_ptr<Socket>> server_sockets_;
 
+  // Same as server_sockets_, for the separate connections that carry REBUILD
+  // traffic when --separate-rebuilding-connections is set. Kept apart so
+  // that rebuilding STOREs queued behind each other don't delay appends and
+  // control messages to the same node.
+  std::vector<std::unique_ptr<Socket>> rebuilding_server_sockets_;
+
+  // Same as server_sockets_, for the separate connections that carry read
+  // streams when --separate-read-connections is set. Storage nodes serve
+  // them on their read workers.
+  std::vector<std::unique_ptr<Socket>> read_server_sockets_;
+
+  std::vector<std::unique_ptr<Socket>>&
+  serverSockets(Sender::ServerConnection conn) {
+    switch (conn) {
+      case Sender::ServerConnection::REBUILDING:
+        return rebuilding_server_sockets_;
+      case Sender::ServerConnection::READ:
+        return read_server_sockets_;
+      default:
+        ld_check(conn == Sender::ServerConnection::MAIN);
+        return server_sockets_;
+    }
+  }
+
+  std::array<std::vector<std::unique_ptr<Socket>>*, 3> serverSocketTables() {
+    return {{&server_sockets_, &rebuilding_server_sockets_,
+             &read_server_sockets_}};
+  }
+
   // Sockets get moved here from server_sockets_ to be closed. The
   // sockets_to_close_available_ event should be signalled when this vector is
   // not empty.
@@ -135,11 +194,15 @@ void SenderBase::MessageCompletion::send() {
   Worker::unpackRunState(prev_state);
 }
 
+constexpr size_t Sender::OUTBUF_RESERVATION_BYTES;
+constexpr size_t Sender::OUTBUF_STATS_BATCH_BYTES;
+
 Sender::Sender(struct event_base* base,
                const configuration::TrafficShapingConfig& tsc,
                size_t max_node_idx,
                int32_t num_workers,
-               ClientIdxAllocator* client_id_allocator)
+               ClientIdxAllocator* client_id_allocator,
+               ResourceBudget* outbuf_budget)
     : impl_(new SenderImpl(*this,
                            max_node_idx,
                            num_workers,
@@ -167,7 +230,8 @@ Sender::Sender(struct event_base* base,
                            -1,
                            0,
                            EventHandler<Sender::onFlowGroupsRunRequested>,
-                           this)) {
+                           this)),
+      outbuf_budget_(outbuf_budget) {
   auto scope = NodeLocationScope::NODE;
   for (auto& fg : impl_->flow_groups_) {
     fg.setScope(this, scope);
@@ -214,6 +278,9 @@ Sender::~Sender() {
   LD_EV(event_free)(completed_messages_available_);
   LD_EV(event_free)(flow_groups_run_requested_);
   LD_EV(event_free)(flow_groups_run_deadline_exceeded_);
+  if (outbuf_budget_ != nullptr && bytes_reserved_ > 0) {
+    outbuf_budget_->release(bytes_reserved_);
+  }
 }
 
 void Sender::onCompletedMessagesAvailable(void* arg, short) {
@@ -237,6 +304,16 @@ int Sender::addClient(int fd,
                       ResourceBudget::Token conn_token,
                       SocketType type,
                       ConnectionType conntype) {
+  return addClient(
+      fd, client_addr, std::move(conn_token), type, conntype, nullptr);
+}
+
+int Sender::addClient(int fd,
+                      const Sockaddr& client_addr,
+                      ResourceBudget::Token conn_token,
+                      SocketType type,
+                      ConnectionType conntype,
+                      std::unique_ptr<EstablishedSSL> established_ssl) {
   Worker* w = Worker::onThisThread();
   ld_check(&w->sender() == this);
 
@@ -270,7 +347,8 @@ int Sender::addClient(int fd,
                               std::move(conn_token),
                               type,
                               conntype,
-                              flow_group));
+                              flow_group,
+                              std::move(established_ssl)));
     if (!res.second) {
       ld_critical("INTERNAL ERROR: attempt to add client %s (%s) that is "
                   "already in the client map",
@@ -304,15 +382,63 @@ void Sender::noteBytesQueued(size_t nbytes) {
   // nbytes cannot exceed maximum message size
   ld_check(nbytes <= (size_t)Message::MAX_LEN + sizeof(ProtocolHeader));
   bytes_pending_ += nbytes;
-  WORKER_STAT_ADD(evbuffer_total_size, nbytes);
-  WORKER_STAT_ADD(evbuffer_max_size, nbytes);
+  if (outbuf_budget_ != nullptr && bytes_pending_ > bytes_reserved_) {
+    adjustOutbufReservation();
+  }
+  bytes_pending_stats_delta_ += nbytes;
+  if (bytes_pending_stats_delta_ >= int64_t(OUTBUF_STATS_BATCH_BYTES)) {
+    flushBytesPendingStats();
+  }
 }
 
 void Sender::noteBytesDrained(size_t nbytes) {
   ld_check(bytes_pending_ >= nbytes);
   bytes_pending_ -= nbytes;
-  WORKER_STAT_SUB(evbuffer_total_size, nbytes);
-  WORKER_STAT_SUB(evbuffer_max_size, nbytes);
+  if (outbuf_budget_ != nullptr &&
+      (outbuf_budget_exhausted_ ||
+       bytes_reserved_ > bytes_pending_ + 2 * OUTBUF_RESERVATION_BYTES)) {
+    adjustOutbufReservation();
+  }
+  bytes_pending_stats_delta_ -= nbytes;
+  if (bytes_pending_ == 0 ||
+      bytes_pending_stats_delta_ <= -int64_t(OUTBUF_STATS_BATCH_BYTES)) {
+    flushBytesPendingStats();
+  }
+}
+
+void Sender::adjustOutbufReservation() {
+  ld_check(outbuf_budget_ != nullptr);
+  // Aim to hold bytes_pending_ rounded up to a multiple of
+  // OUTBUF_RESERVATION_BYTES, with one more reservation to spare.
+  const size_t chunk = OUTBUF_RESERVATION_BYTES;
+  const size_t target = (bytes_pending_ / chunk + 2) * chunk;
+  if (bytes_reserved_ > target) {
+    outbuf_budget_->release(bytes_reserved_ - target);
+    bytes_reserved_ = target;
+  } else if (bytes_reserved_ < bytes_pending_) {
+    if (outbuf_budget_->acquire(target - bytes_reserved_)) {
+      bytes_reserved_ = target;
+    } else if (outbuf_budget_->acquire(bytes_pending_ - bytes_reserved_)) {
+      // Close to the limit, take only what is needed.
+      bytes_reserved_ = bytes_pending_;
+    }
+  }
+  const bool exhausted = bytes_pending_ > bytes_reserved_;
+  if (exhausted && !outbuf_budget_exhausted_) {
+    WORKER_STAT_INCR(outbuf_budget_exhausted);
+  }
+  outbuf_budget_exhausted_ = exhausted;
+}
+
+void Sender::flushBytesPendingStats() {
+  if (bytes_pending_stats_delta_ > 0) {
+    WORKER_STAT_ADD(evbuffer_total_size, bytes_pending_stats_delta_);
+    WORKER_STAT_ADD(evbuffer_max_size, bytes_pending_stats_delta_);
+  } else if (bytes_pending_stats_delta_ < 0) {
+    WORKER_STAT_SUB(evbuffer_total_size, -bytes_pending_stats_delta_);
+    WORKER_STAT_SUB(evbuffer_max_size, -bytes_pending_stats_delta_);
+  }
+  bytes_pending_stats_delta_ = 0;
 }
 
 ssize_t Sender::getTcpSendBufSizeForClient(ClientID client_id) const {
@@ -326,6 +452,15 @@ ssize_t Sender::getTcpSendBufSizeForClient(ClientID client_id) const {
   return it->second.getTcpSendBufSize();
 }
 
+size_t Sender::getBytesPendingForClient(ClientID client_id) const {
+  auto it = impl_->client_sockets_.find(client_id);
+  if (it == impl_->client_sockets_.end()) {
+    return 0;
+  }
+
+  return it->second.getBytesPending();
+}
+
 void Sender::eraseDisconnectedClients() {
   for (const ClientID& cid : disconnected_clients_) {
     const auto pos = impl_->client_sockets_.find(cid);
@@ -384,8 +519,17 @@ int Sender::notifyPeerConfigUpdated(Socket& sock) {
     // Clients already ignore / don't use the Zookeeper section
     // TODO deprecate in T32793726
     auto zk_config = Worker::onThisThread()->getZookeeperConfig();
-    msg = std::make_unique<CONFIG_CHANGED_Message>(
-        hdr, server_config->toString(nullptr, zk_config.get(), true));
+    std::string zstd_config;
+    if (sock.getProto() >= Compatibility::CONFIG_CHANGED_ZSTD_SUPPORT) {
+      zstd_config = server_config->toZstdCompressedString(zk_config.get());
+    }
+    if (!zstd_config.empty()) {
+      msg = std::make_unique<CONFIG_CHANGED_Message>(
+          hdr, zstd_config, CONFIG_CHANGED_Header::Compression::ZSTD);
+    } else {
+      msg = std::make_unique<CONFIG_CHANGED_Message>(
+          hdr, server_config->toString(nullptr, zk_config.get(), true));
+    }
   } else {
     // The peer is a server. Send a CONFIG_ADVISORY to let it know about our
     // config version. Upon receiving this message, if the server config hasn't
@@ -444,7 +588,7 @@ bool Sender::canSendToImpl(const Address& addr,
   // a bandwidth deposit from the TrafficShaper.
   std::unique_lock<std::mutex> lock(impl_->flow_meters_mutex_);
   if (!sock->flow_group_.canDrain(p)) {
-    sock->flow_group_.push(on_bw_avail, p);
+    sock->flow_group_.push(on_bw_avail, p, sock);
     maybeScheduleRunFlowGroups(sock->flow_group_);
     err = E::CBREGISTERED;
     FLOW_GROUP_STAT_INCR(Worker::stats(), sock->flow_group_, cbregistered);
@@ -575,20 +719,20 @@ int Sender::sendMessageImpl(std::unique_ptr<Message>&& msg,
   FLOW_GROUP_STAT_INCR(Worker::stats(), sock.flow_group_, discarded);
   FLOW_GROUP_MSG_STAT_INCR(Worker::stats(), sock.flow_group_, msg, discarded);
   FLOW_GROUP_STAT_INCR(Worker::stats(), sock.flow_group_, cbregistered);
-  sock.flow_group_.push(*on_bw_avail, msg->priority());
+  sock.flow_group_.push(*on_bw_avail, msg->priority(), &sock);
   sock.pushOnBWAvailableCallback(*on_bw_avail);
   maybeScheduleRunFlowGroups(sock.flow_group_);
   err = E::CBREGISTERED;
   return -1;
 }
 
-Socket* Sender::findServerSocket(node_index_t idx) {
+Socket* Sender::findServerSocket(node_index_t idx, ServerConnection conn) {
   ld_check(idx >= 0);
 
+  auto& table = impl_->serverSockets(conn);
   Socket* s;
 
-  if (idx >= impl_->server_sockets_.size() ||
-      !(s = impl_->server_sockets_[idx].get())) {
+  if (idx >= table.size() || !(s = table[idx].get())) {
     return nullptr;
   }
 
@@ -610,21 +754,77 @@ void Sender::deliverCompletedMessages() {
   }
 }
 
+int Sender::forwardMessage(worker_id_t target,
+                           std::unique_ptr<Message> msg,
+                           ClientID to) {
+  Processor* processor = Worker::onThisThread()->processor_;
+  Sender& sender = processor->getWorker(target, WorkerType::GENERAL).sender();
+
+  sender.mailbox_.push(std::make_unique<MailboxEntry>(std::move(msg), to));
+  WORKER_STAT_INCR(sender_mailbox_posted);
+  WORKER_STAT_INCR(sender_mailbox_depth);
+
+  if (sender.mailbox_drain_scheduled_.exchange(true)) {
+    // a drain is already on its way and will pick this message up
+    return 0;
+  }
+
+  std::unique_ptr<Request> rq =
+      std::make_unique<DrainSenderMailboxRequest>(target);
+  int rv = processor->postImportant(rq);
+  if (rv != 0) {
+    // let the next forwardMessage() try again
+    sender.mailbox_drain_scheduled_.store(false);
+  }
+  return rv;
+}
+
+void Sender::drainMailbox() {
+  ld_check(onMyWorker());
+
+  // Clear the flag before popping: a message pushed after this point either
+  // gets popped below or posts another drain request.
+  mailbox_drain_scheduled_.store(false);
+
+  int64_t drained = 0;
+  while (std::unique_ptr<MailboxEntry> entry = mailbox_.pop()) {
+    ++drained;
+    const MessageType type = entry->msg->type_;
+    int rv = sendMessage(std::move(entry->msg), entry->to);
+    if (rv != 0) {
+      RATELIMIT_INFO(std::chrono::seconds(1),
+                     10,
+                     "Failed to send a forwarded %s message to %s: %s",
+                     messageTypeNames[type].c_str(),
+                     describeConnection(Address(entry->to)).c_str(),
+                     error_description(err));
+    }
+  }
+  mailbox_.compact();
+
+  WORKER_STAT_INCR(sender_mailbox_drains);
+  WORKER_STAT_SUB(sender_mailbox_depth, drained);
+}
+
 void Sender::resetServerSocketConnectThrottle(NodeID node_id) {
   ld_check(node_id.isNodeID());
 
-  auto socket = findServerSocket(node_id.index());
-  if (socket != nullptr) {
-    socket->resetConnectThrottle();
+  for (auto conn : kServerConnections) {
+    auto socket = findServerSocket(node_id.index(), conn);
+    if (socket != nullptr) {
+      socket->resetConnectThrottle();
+    }
   }
 }
 
 void Sender::setPeerShuttingDown(NodeID node_id) {
   ld_check(node_id.isNodeID());
 
-  auto socket = findServerSocket(node_id.index());
-  if (socket != nullptr) {
-    socket->setPeerShuttingDown();
+  for (auto conn : kServerConnections) {
+    auto socket = findServerSocket(node_id.index(), conn);
+    if (socket != nullptr) {
+      socket->setPeerShuttingDown();
+    }
   }
 }
 
@@ -653,8 +853,9 @@ void Sender::runFlowGroups(RunType /*rt*/) {
   std::iota(fg_ids.begin(), fg_ids.end(), 0);
   std::shuffle(fg_ids.begin(), fg_ids.end(), folly::ThreadLocalPRNG());
   for (auto idx : fg_ids) {
-    exceeded_deadline =
-        impl_->flow_groups_[idx].run(impl_->flow_meters_mutex_, run_deadline);
+    auto& fg = impl_->flow_groups_[idx];
+    fg.setFairQueuing(Worker::settings().flow_groups_fair_queuing);
+    exceeded_deadline = fg.run(impl_->flow_meters_mutex_, run_deadline);
     if (exceeded_deadline) {
       // Run again after yielding to the event loop.
       STAT_INCR(Worker::stats(), flow_groups_run_deadline_exceeded);
@@ -684,7 +885,9 @@ bool Sender::applyFlowGroupsUpdate(FlowGroupsUpdate& update,
   return run;
 }
 
-int Sender::registerOnSocketClosed(const Address& addr, SocketCallback& cb) {
+int Sender::registerOnSocketClosed(const Address& addr,
+                                   SocketCallback& cb,
+                                   ServerConnection conn) {
   Socket* sock;
 
   if (addr.isClientAddress()) {
@@ -695,7 +898,7 @@ int Sender::registerOnSocketClosed(const Address& addr, SocketCallback& cb) {
     }
     sock = &pos->second;
   } else { // addr is a server address
-    sock = findServerSocket(addr.id_.node_.index());
+    sock = findServerSocket(addr.id_.node_.index(), conn);
     if (!sock) {
       err = E::NOTFOUND;
       return -1;
@@ -707,10 +910,12 @@ int Sender::registerOnSocketClosed(const Address& addr, SocketCallback& cb) {
 
 void Sender::flushOutputAndClose(Status reason) {
   auto open_socket_count = 0;
-  for (const auto& socket : impl_->server_sockets_) {
-    if (socket && !socket->isClosed()) {
-      socket->flushOutputAndClose(reason);
-      ++open_socket_count;
+  for (auto* table : impl_->serverSocketTables()) {
+    for (const auto& socket : *table) {
+      if (socket && !socket->isClosed()) {
+        socket->flushOutputAndClose(reason);
+        ++open_socket_count;
+      }
     }
   }
 
@@ -747,16 +952,23 @@ int Sender::closeClientSocket(ClientID cid, Status reason) {
 int Sender::closeServerSocket(NodeID peer, Status reason) {
   ld_check(onMyWorker());
 
-  Socket* s = findServerSocket(peer.index());
-  if (!s) {
-    err = E::NOTFOUND;
-    return -1;
+  // A reader may only have a connection for read streams to the node.
+  bool found = false;
+  for (auto conn : kServerConnections) {
+    Socket* s = findServerSocket(peer.index(), conn);
+    if (!s) {
+      continue;
+    }
+    found = true;
+    if (!s->isClosed()) {
+      s->close(reason);
+    }
   }
 
-  if (!s->isClosed()) {
-    s->close(reason);
+  if (!found) {
+    err = E::NOTFOUND;
+    return -1;
   }
-
   return 0;
 }
 
@@ -765,10 +977,12 @@ std::pair<uint32_t, uint32_t> Sender::closeAllSockets() {
 
   std::pair<uint32_t, uint32_t> sockets_closed = {0, 0};
 
-  for (auto& entry : impl_->server_sockets_) {
-    if (entry && !entry->isClosed()) {
-      sockets_closed.first++;
-      entry->close(E::SHUTDOWN);
+  for (auto* table : impl_->serverSocketTables()) {
+    for (auto& entry : *table) {
+      if (entry && !entry->isClosed()) {
+        sockets_closed.first++;
+        entry->close(E::SHUTDOWN);
+      }
     }
   }
 
@@ -790,17 +1004,19 @@ bool Sender::isClosed() {
   auto num_open_server_sockets = 0;
   Socket* max_pending_work_server = nullptr;
   auto server_with_max_pending_bytes = 0;
-  for (const auto& socket : impl_->server_sockets_) {
-    if (socket && !socket->isClosed()) {
-      if (!go_over_all_sockets) {
-        return false;
-      }
+  for (auto* table : impl_->serverSocketTables()) {
+    for (const auto& socket : *table) {
+      if (socket && !socket->isClosed()) {
+        if (!go_over_all_sockets) {
+          return false;
+        }
 
-      ++num_open_server_sockets;
-      auto pending_bytes = socket->getBytesPending();
-      if (server_with_max_pending_bytes < pending_bytes) {
-        max_pending_work_server = socket.get();
-        server_with_max_pending_bytes = pending_bytes;
+        ++num_open_server_sockets;
+        auto pending_bytes = socket->getBytesPending();
+        if (server_with_max_pending_bytes < pending_bytes) {
+          max_pending_work_server = socket.get();
+          server_with_max_pending_bytes = pending_bytes;
+        }
       }
     }
   }
@@ -892,6 +1108,30 @@ int Sender::connect(NodeID nid, bool allow_unencrypted) {
   return s->connect();
 }
 
+Sender::ServerConnection Sender::readStreamsConnection() {
+  return Worker::settings().separate_read_connections ? ServerConnection::READ
+                                                      : ServerConnection::MAIN;
+}
+
+Sender::ServerConnection Sender::connectionFor(const Message& msg) {
+  switch (msg.type_) {
+    case MessageType::STORE:
+    case MessageType::STORES:
+      return msg.tc_ == TrafficClass::REBUILD &&
+              Worker::settings().separate_rebuilding_connections
+          ? ServerConnection::REBUILDING
+          : ServerConnection::MAIN;
+    case MessageType::START:
+    case MessageType::STARTS:
+    case MessageType::STOP:
+    case MessageType::WINDOW:
+    case MessageType::WINDOWS:
+      return readStreamsConnection();
+    default:
+      return ServerConnection::MAIN;
+  }
+}
+
 bool Sender::useSSLWith(NodeID nid,
                         bool* cross_boundary_out,
                         bool* authentication_out) {
@@ -955,10 +1195,12 @@ void Sender::onSocketsToCloseAvailable(void* arg, short) {
 
 Socket* Sender::initServerSocket(NodeID nid,
                                  SocketType sock_type,
-                                 bool allow_unencrypted) {
+                                 bool allow_unencrypted,
+                                 ServerConnection conn) {
   ld_check(!shutting_down_);
+  ld_check(conn == ServerConnection::MAIN || sock_type == SocketType::DATA);
 
-  std::unique_ptr<Socket>* sock_slot = findSocketSlot(nid);
+  std::unique_ptr<Socket>* sock_slot = findSocketSlot(nid, conn);
   if (sock_slot == nullptr) {
     // err set by findSocketSlot().
     return nullptr;
@@ -1035,6 +1277,9 @@ Socket* Sender::initServerSocket(NodeID nid,
         // to eNULL ciphers to reduce overhead.
         s->limitCiphersToENULL();
       }
+      if (conn == ServerConnection::READ) {
+        s->setCarriesReadStreams();
+      }
     } catch (ConstructorFailed&) {
       if (err == E::NOTINCONFIG || err == E::NOSSLCONFIG) {
         return nullptr;
@@ -1122,15 +1367,17 @@ Socket* FOLLY_NULLABLE Sender::getSocket(const NodeID& nid,
   }
 
   SocketType sock_type;
+  ServerConnection conn = ServerConnection::MAIN;
   Worker* w = Worker::onThisThread();
   if (w->worker_type_ == WorkerType::FAILURE_DETECTOR) {
     ld_check(Socket::allowedOnGossipConnection(msg.type_));
     sock_type = SocketType::GOSSIP;
   } else {
     sock_type = SocketType::DATA;
+    conn = connectionFor(msg);
   }
 
-  Socket* sock = initServerSocket(nid, sock_type, msg.allowUnencrypted());
+  Socket* sock = initServerSocket(nid, sock_type, msg.allowUnencrypted(), conn);
   if (!sock) {
     // err set by initServerSocket()
     return nullptr;
@@ -1175,16 +1422,17 @@ Socket* FOLLY_NULLABLE Sender::findSocket(const Address& addr) {
 }
 
 std::unique_ptr<Socket>* FOLLY_NULLABLE
-Sender::findSocketSlot(const NodeID& nid) {
+Sender::findSocketSlot(const NodeID& nid, ServerConnection conn) {
   ld_check(nid.isNodeID());
   node_index_t idx = nid.index();
   ld_check(idx >= 0);
-  if (idx >= impl_->server_sockets_.size()) {
+  auto& table = impl_->serverSockets(conn);
+  if (idx >= table.size()) {
     err = E::NOTINCONFIG;
     return nullptr;
   }
 
-  std::unique_ptr<Socket>& sock = impl_->server_sockets_[nid.index()];
+  std::unique_ptr<Socket>& sock = table[nid.index()];
   if (sock) {
     ld_check(!sock->peer_name_.isClientAddress());
     ld_check(sock->peer_name_.id_.node_.index() == nid.index());
@@ -1335,6 +1583,23 @@ void Sender::setClientLocation(const ClientID& cid,
   sock->peer_location_ = location;
 }
 
+bool Sender::acceptsCompressedRecords(const ClientID& cid) {
+  Socket* sock = getSocket(cid);
+  return sock && sock->peer_accepts_compressed_records_;
+}
+
+void Sender::setAcceptsCompressedRecords(const ClientID& cid) {
+  Socket* sock = getSocket(cid);
+  if (!sock) {
+    RATELIMIT_ERROR(std::chrono::seconds(1),
+                    1,
+                    "Could not find socket for connection: %s",
+                    describeConnection(cid).c_str());
+    return;
+  }
+  sock->peer_accepts_compressed_records_ = true;
+}
+
 void Sender::setPeerConfigVersion(const Address& addr,
                                   const Message& msg,
                                   config_version_t version) {
@@ -1510,49 +1775,54 @@ void Sender::noteConfigurationChanged() {
 
   initMyLocation();
 
-  for (int i = 0; i < impl_->server_sockets_.size(); i++) {
-    std::unique_ptr<Socket>& s = impl_->server_sockets_[i];
+  for (auto* table : impl_->serverSocketTables()) {
+    for (int i = 0; i < table->size(); i++) {
+      std::unique_ptr<Socket>& s = (*table)[i];
 
-    if (!s) {
-      continue;
-    }
+      if (!s) {
+        continue;
+      }
 
-    ld_check(!s->peer_name_.isClientAddress());
-    ld_check(s->peer_name_.id_.node_.index() == i);
+      ld_check(!s->peer_name_.isClientAddress());
+      ld_check(s->peer_name_.id_.node_.index() == i);
+
+      auto it = nodes_cfg.find(i);
+      if (it != nodes_cfg.end()) {
+        const Sockaddr& newaddr =
+            it->second.getSockaddr(s->getSockType(), s->getConnType());
+        if (s->peer_name_.id_.node_.generation() == it->second.generation &&
+            s->peer_sockaddr_ == newaddr) {
+          continue;
+        } else {
+          ld_info("Configuration change detected for node %s. New generation "
+                  "count is %d. New IP address is %s. Destroying old socket.",
+                  Sender::describeConnection(Address(s->peer_name_.id_.node_))
+                      .c_str(),
+                  it->second.generation,
+                  newaddr.toString().c_str());
+        }
 
-    auto it = nodes_cfg.find(i);
-    if (it != nodes_cfg.end()) {
-      const Sockaddr& newaddr =
-          it->second.getSockaddr(s->getSockType(), s->getConnType());
-      if (s->peer_name_.id_.node_.generation() == it->second.generation &&
-          s->peer_sockaddr_ == newaddr) {
-        continue;
       } else {
-        ld_info("Configuration change detected for node %s. New generation "
-                "count is %d. New IP address is %s. Destroying old socket.",
+        ld_info("Node %s is no longer in cluster configuration. New cluster "
+                "size is %zu. Destroying old socket.",
                 Sender::describeConnection(Address(s->peer_name_.id_.node_))
                     .c_str(),
-                it->second.generation,
-                newaddr.toString().c_str());
+                nodes_cfg.size());
       }
 
-    } else {
-      ld_info(
-          "Node %s is no longer in cluster configuration. New cluster "
-          "size is %zu. Destroying old socket.",
-          Sender::describeConnection(Address(s->peer_name_.id_.node_)).c_str(),
-          nodes_cfg.size());
+      s->close(E::NOTINCONFIG);
+      s.reset();
     }
-
-    s->close(E::NOTINCONFIG);
-    s.reset();
   }
 
-  impl_->server_sockets_.resize(cfg->getMaxNodeIdx() + 1);
+  for (auto* table : impl_->serverSocketTables()) {
+    table->resize(cfg->getMaxNodeIdx() + 1);
+  }
 }
 
 bool Sender::bytesPendingLimitReached() {
-  return getBytesPending() >
+  return outbuf_budget_exhausted_ ||
+      getBytesPending() >
       Worker::settings().outbufs_mb_max_per_thread * 1024 * 1024;
 }
 
@@ -1587,9 +1857,11 @@ std::string Sender::dumpQueuedMessages(Address addr) const {
     }
     socket->dumpQueuedMessages(&counts);
   } else {
-    for (const auto& entry : impl_->server_sockets_) {
-      if (entry != nullptr) {
-        entry->dumpQueuedMessages(&counts);
+    for (auto* table : impl_->serverSocketTables()) {
+      for (const auto& entry : *table) {
+        if (entry != nullptr) {
+          entry->dumpQueuedMessages(&counts);
+        }
       }
     }
     for (const auto& entry : impl_->client_sockets_) {
@@ -1604,9 +1876,11 @@ std::string Sender::dumpQueuedMessages(Address addr) const {
 }
 
 void Sender::forEachSocket(std::function<void(const Socket&)> cb) const {
-  for (const auto& entry : impl_->server_sockets_) {
-    if (entry) {
-      cb(*entry);
+  for (auto* table : impl_->serverSocketTables()) {
+    for (const auto& entry : *table) {
+      if (entry) {
+        cb(*entry);
+      }
     }
   }
   for (const auto& entry : impl_->client_sockets_) {
@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <atomic>
 #include <forward_list>
 #include <functional>
 #include <limits>
@@ -22,6 +23,7 @@
 #include <openssl/ossl_typ.h>
 
 #include "logdevice/common/Address.h"
+#include "logdevice/common/MPSCQueue.h"
 #include "logdevice/common/PrincipalIdentity.h"
 #include "logdevice/common/Priority.h"
 #include "logdevice/common/ResourceBudget.h"
@@ -44,6 +46,7 @@ namespace facebook { namespace logdevice {
 
 class BWAvailableCallback;
 class ClientIdxAllocator;
+struct EstablishedSSL;
 class FlowGroup;
 class FlowGroupsUpdate;
 class SenderImpl;
@@ -338,14 +341,27 @@ class Sender : public SenderBase {
   enum class RunType { REPLENISH, EVENTLOOP };
 
   /**
-   * @param node_count   the number of nodes in cluster configuration at the
-   *                     time this Sender was created
+   * The connections a Sender may keep to each node: the main one, which
+   * carries most data traffic, and optional separate ones for rebuilding
+   * STOREs (--separate-rebuilding-connections) and for read streams
+   * (--separate-read-connections). See connectionFor().
+   */
+  enum class ServerConnection : uint8_t { MAIN, REBUILDING, READ, MAX };
+
+  /**
+   * @param node_count    the number of nodes in cluster configuration at the
+   *                      time this Sender was created
+   * @param outbuf_budget process-wide budget of bytes in output evbuffers,
+   *                      shared by the Senders of all workers, see
+   *                      Settings::outbufs_mb_max_total. nullptr if there is
+   *                      no process-wide limit.
    */
   explicit Sender(struct event_base* base,
                   const configuration::TrafficShapingConfig& tsc,
                   size_t max_node_idx,
                   int32_t num_workders,
-                  ClientIdxAllocator* client_id_allocator);
+                  ClientIdxAllocator* client_id_allocator,
+                  ResourceBudget* outbuf_budget = nullptr);
   ~Sender() override;
 
   Sender(const Sender&) = delete;
@@ -390,6 +406,28 @@ class Sender : public SenderBase {
    */
   void deliverCompletedMessages();
 
+  /**
+   * Hands msg over to the GENERAL Worker `target` for delivery to client
+   * `to`, whose connection that Worker owns. Can be called from any Worker
+   * thread. Messages are pushed into the target Sender's lock-free mailbox;
+   * only the push that finds the mailbox idle posts a Request to wake the
+   * target Worker up, which then drains everything queued so far in one go.
+   *
+   * @return 0 on success, -1 if the target Worker could not be woken up
+   *         (err is set by Processor::postImportant()). msg is consumed
+   *         either way: a message left behind in the mailbox is sent by the
+   *         next successful forwardMessage() call.
+   */
+  static int forwardMessage(worker_id_t target,
+                            std::unique_ptr<Message> msg,
+                            ClientID to);
+
+  /**
+   * Sends all messages that other Workers queued in this Sender's mailbox.
+   * Must be called on this Sender's Worker.
+   */
+  void drainMailbox();
+
   /**
    * Dispatch messages from all flow groups until they either are
    * empty or have exhausted their bandwidth credit.
@@ -410,13 +448,18 @@ class Sender : public SenderBase {
    * the Socket is closed. See sendMessage() docblock above for important
    * notes and restrictions.
    *
+   * If addr is a server address, `conn` selects which of the connections
+   * to the node to use, see connectionFor().
+   *
    * @return 0 on success, -1 if callback could not be installed. Sets err
    *         to NOTFOUND if addr does not identify a Socket managed by this
    *                     Sender
    *            INVALID_PARAM  if cb is already on some callback list
    *                           (debug build asserts)
    */
-  int registerOnSocketClosed(const Address& addr, SocketCallback& cb);
+  int registerOnSocketClosed(const Address& addr,
+                             SocketCallback& cb,
+                             ServerConnection conn = ServerConnection::MAIN);
 
   /**
    * Tells all open sockets to flush output and close, asynchronously.
@@ -648,6 +691,8 @@ class Sender : public SenderBase {
    * @param conn_token  an object used for accepted connection accounting
    * @param type        type of socket connection (DATA/GOSSIP)
    * @param conntype    type of connection (PLAIN/SSL)
+   * @param established_ssl  the SSL connection on fd if a listener already
+   *                         did its handshake, see --ssl-handshake-threads
    *
    * @return  0 on success, -1 if we failed to create a Socket, sets err to:
    *     EXISTS          a Socket for this ClientID already exists
@@ -661,6 +706,12 @@ class Sender : public SenderBase {
                 ResourceBudget::Token conn_token,
                 SocketType type,
                 ConnectionType conntype);
+  int addClient(int fd,
+                const Sockaddr& client_addr,
+                ResourceBudget::Token conn_token,
+                SocketType type,
+                ConnectionType conntype,
+                std::unique_ptr<EstablishedSSL> established_ssl);
 
   /**
    * Called by a Socket managed by this Sender when bytes are appended
@@ -690,10 +741,20 @@ class Sender : public SenderBase {
   /**
    * @return true iff the total number of bytes in the output evbuffers of
    *              all Sockets managed by this Sender exceeds the limit set
-   *              in this Processor's configuration
+   *              in this Processor's configuration, or the process-wide
+   *              budget is exhausted
    */
   bool bytesPendingLimitReached();
 
+  // Granularity of reservations from the process-wide outbuf budget. A
+  // Sender holds at most twice this much more than it needs, so that the
+  // shared budget is only touched once per this many bytes sent.
+  static constexpr size_t OUTBUF_RESERVATION_BYTES = 1024 * 1024;
+
+  // The evbuffer stats are brought up to date with bytes_pending_ once they
+  // are off by this much, and whenever all output buffers are drained.
+  static constexpr size_t OUTBUF_STATS_BATCH_BYTES = 64 * 1024;
+
   /**
    * Queue a message for a deferred completion. Used from contexts that
    * must be protected from re-entrance into Sender.
@@ -709,11 +770,44 @@ class Sender : public SenderBase {
    */
   ssize_t getTcpSendBufSizeForClient(ClientID client_id) const;
 
+  /**
+   * Proxy for Socket::getBytesPending() for a client socket.  Returns 0 if
+   * socket not found.
+   */
+  size_t getBytesPendingForClient(ClientID client_id) const;
+
   /**
    * @return if this Sender manages a Socket for the node at configuration
    *         position idx, return that Socket. Otherwise return nullptr.
+   *         `conn` selects which of the connections to the node to look
+   *         for, see connectionFor().
+   */
+  Socket* findServerSocket(node_index_t idx,
+                           ServerConnection conn = ServerConnection::MAIN);
+
+  /**
+   * @return the connection that messages of read streams (START, STOP,
+   *         WINDOW and their batched variants) to storage nodes go over:
+   *         READ if --separate-read-connections is set, MAIN otherwise.
+   *         Read streams use it to find the Socket they talk to a node over.
+   */
+  static ServerConnection readStreamsConnection();
+
+  /**
+   * @return the connection to a node that msg goes over. Messages other
+   *         than the following take the MAIN connection, shared by all
+   *         other data traffic to the node:
+   *         - rebuilding STOREs, and STORES batches of them, take
+   *           REBUILDING if --separate-rebuilding-connections is set. They
+   *           keep their relative order since they all take the same
+   *           connection;
+   *         - messages of read streams take readStreamsConnection(). All
+   *           messages of a stream then reach the same worker on the
+   *           storage node.
+   *         The recipient replies on the connection a message came in on,
+   *         so STORED replies, records and gaps follow.
    */
-  Socket* findServerSocket(node_index_t idx);
+  static ServerConnection connectionFor(const Message& msg);
 
   /**
    * Resets the server socket's connect throttle.
@@ -780,6 +874,14 @@ class Sender : public SenderBase {
 
   void setClientLocation(const ClientID& cid, const std::string& location);
 
+  /**
+   * Whether the client said in HELLO that it accepts RECORD messages with
+   * compressed payloads. See HELLO_Header::ACCEPTS_COMPRESSED_RECORDS.
+   */
+  bool acceptsCompressedRecords(const ClientID& cid);
+
+  void setAcceptsCompressedRecords(const ClientID& cid);
+
   void forAllClientSockets(std::function<void(Socket&)> fn);
 
  private:
@@ -787,6 +889,14 @@ class Sender : public SenderBase {
   friend class SenderImpl;
   std::unique_ptr<SenderImpl> impl_;
 
+  // Reserves or gives back parts of outbuf_budget_ after bytes_pending_
+  // changed, so that bytes_reserved_ covers bytes_pending_ with less than
+  // 2 * OUTBUF_RESERVATION_BYTES to spare.
+  void adjustOutbufReservation();
+
+  // Applies bytes_pending_stats_delta_ to the stats.
+  void flushBytesPendingStats();
+
   struct event* sockets_to_close_available_;
 
   // ids of disconnected sockets to be erased from .client_sockets_
@@ -799,6 +909,22 @@ class Sender : public SenderBase {
   CompletionQueue completed_messages_;
   struct event* completed_messages_available_;
 
+  // Messages handed over by other Workers through forwardMessage(), for
+  // delivery over client connections owned by this Sender.
+  struct MailboxEntry {
+    MailboxEntry(std::unique_ptr<Message> m, ClientID t)
+        : msg(std::move(m)), to(t) {}
+
+    std::unique_ptr<Message> msg;
+    ClientID to;
+    folly::AtomicIntrusiveLinkedListHook<MailboxEntry> hook;
+  };
+  MPSCQueue<MailboxEntry, &MailboxEntry::hook> mailbox_;
+
+  // true while a Request to drain mailbox_ is posted and hasn't started
+  // draining yet. Producers that see it set don't need to post another one.
+  std::atomic<bool> mailbox_drain_scheduled_{false};
+
   // Event signalled when there is demand for priority queue bandwidth.
   // When activated, this low priority event will be serviced once the
   // event loop goes idle for normal priority events. This allows demand
@@ -815,6 +941,15 @@ class Sender : public SenderBase {
   // current number of bytes in all output buffers combined
   size_t bytes_pending_ = 0;
 
+  // Part of the process-wide outbuf budget held by this Sender. Covers
+  // bytes_pending_ unless outbuf_budget_exhausted_.
+  ResourceBudget* const outbuf_budget_;
+  size_t bytes_reserved_ = 0;
+  bool outbuf_budget_exhausted_ = false;
+
+  // Change of bytes_pending_ not yet applied to the evbuffer_* stats.
+  int64_t bytes_pending_stats_delta_ = 0;
+
   // if true, disallow sending messages and initiating connections
   bool shutting_down_ = false;
 
@@ -873,7 +1008,8 @@ class Sender : public SenderBase {
    */
   Socket* initServerSocket(NodeID nid,
                            SocketType sock_type,
-                           bool allow_unencrypted);
+                           bool allow_unencrypted,
+                           ServerConnection conn = ServerConnection::MAIN);
 
   /**
    * This method gets the socket associated with a given ClientID. The
@@ -925,10 +1061,14 @@ class Sender : public SenderBase {
    * connection is already recorded, or a new connection should be placed.
    *
    * @param addr       peer name of the existing or new Socket.
+   * @param conn       which table of connections to look in, see
+   *                   connectionFor()
    * @return a pointer into the server socket table, or nullptr if the
    *         provided NodeID is not in the currnt config.
    */
-  std::unique_ptr<Socket>* FOLLY_NULLABLE findSocketSlot(const NodeID& addr);
+  std::unique_ptr<Socket>* FOLLY_NULLABLE
+  findSocketSlot(const NodeID& addr,
+                 ServerConnection conn = ServerConnection::MAIN);
 
   /**
    * Find the most appropriate FlowGroup for a socket at or above
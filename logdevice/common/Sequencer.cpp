@@ -925,7 +925,9 @@ RunAppenderStatus Sequencer::runAppender(Appender* appender) {
 
   // TEST: simulate bad hardware flipping bits in payload of STORE messages
   // See Settings::test_sequencer_corrupt_stores
-  if (settings_->test_sequencer_corrupt_stores) {
+  const Settings* worker_settings = Worker::settingsIfOnWorker();
+  if (worker_settings ? worker_settings->test_sequencer_corrupt_stores
+                      : settings_->test_sequencer_corrupt_stores) {
     appender->TEST_corruptPayload();
   }
 
@@ -1260,6 +1262,18 @@ bool Sequencer::hasAvailableLsns() const {
   return current != nullptr ? current->hasAvailableLsns() : false;
 }
 
+bool Sequencer::shouldReactivateAhead() const {
+  const Settings* worker_settings = Worker::settingsIfOnWorker();
+  const size_t threshold = worker_settings
+      ? worker_settings->epoch_pipelining_esns
+      : settings_->epoch_pipelining_esns;
+  if (threshold == 0 || getState() != State::ACTIVE) {
+    return false;
+  }
+  auto current = getCurrentEpochSequencer();
+  return current != nullptr && current->getNumAvailableLsns() < threshold;
+}
+
 size_t Sequencer::getLastKnownGood() const {
   auto current = getCurrentEpochSequencer();
   return current != nullptr ? current->getLastKnownGood() : LSN_INVALID;
@@ -1320,9 +1334,13 @@ Sequencer::createEpochSequencer(epoch_t epoch,
     return nullptr;
   }
 
-  // refresh extras_ and synced_
+  // refresh extras_, synced_, hedged_copies_, streaming_ingest_ and the
+  // append rate limit
   extras_.store(logcfg->attrs().extraCopies().value());
   synced_.store(logcfg->attrs().syncedCopies().value());
+  hedged_copies_.store(logcfg->attrs().hedgedCopies().value());
+  streaming_ingest_.store(logcfg->attrs().streamingIngest().value());
+  updateAppendRateLimit(logcfg->attrs().maxAppendBytesPerSecond().value());
 
   // Calculating 2^esn_bits - 1 in a shift-safe manner.  Asserts should be
   // ensured by Settings parser.
@@ -1339,7 +1357,8 @@ Sequencer::createEpochSequencer(epoch_t epoch,
       std::move(metadata),
       logcfg->attrs().maxWritesInFlight().value(),
       esn_max,
-      this);
+      this,
+      local_settings->sequencer_adaptive_window_min);
 
   // initialize copyset manager for the epoch
   epoch_seq->createOrUpdateCopySetManager(cfg, *local_settings);
@@ -1478,6 +1497,7 @@ int Sequencer::sendReleases(lsn_t lsn,
 
   // Header is the same for all messages we send below.
   const RELEASE_Header header{rid, release_type};
+  const bool batch = Worker::settings().release_batch_interval.count() > 0;
 
   int rv = 0;
   for (const auto& shard : *all_shards) {
@@ -1485,6 +1505,10 @@ int Sequencer::sendReleases(lsn_t lsn,
     if (!pred || pred(lsn, release_type, shard)) {
       auto h = header;
       h.shard = shard.shard();
+      if (batch &&
+          w->activeAppenders().enqueueReleaseForBatch(h, shard.asNodeID())) {
+        continue;
+      }
       if (sender.sendMessage(
               std::make_unique<RELEASE_Message>(h), shard.asNodeID()) != 0) {
         RATELIMIT_WARNING(
@@ -1710,6 +1734,33 @@ void Sequencer::processRedirectedRecords() {
   }
 }
 
+bool Sequencer::checkAppendRateLimit(size_t payload_size,
+                                     std::chrono::milliseconds* retry_delay) {
+  ld_check(retry_delay);
+  auto limiter = append_rate_limiter_.get();
+  if (!limiter || limiter->isAllowed(std::max<size_t>(payload_size, 1))) {
+    return true;
+  }
+  // Round up so that clients don't come back before the bucket refills.
+  const auto wait = limiter->timeUntilAllowed();
+  *retry_delay = std::chrono::duration_cast<std::chrono::milliseconds>(wait);
+  if (*retry_delay < wait || retry_delay->count() == 0) {
+    ++*retry_delay;
+  }
+  return false;
+}
+
+void Sequencer::updateAppendRateLimit(int bytes_per_second) {
+  if (append_rate_limit_.exchange(bytes_per_second) == bytes_per_second) {
+    return;
+  }
+  append_rate_limiter_.update(
+      bytes_per_second > 0
+          ? std::make_shared<RateLimiter>(
+                rate_limit_t(bytes_per_second, std::chrono::seconds(1)))
+          : nullptr);
+}
+
 void Sequencer::noteConfigurationChanged(std::shared_ptr<Configuration> cfg,
                                          bool is_sequencer_node) {
   // Note: nodeset and replication factor are updated upon sequencer
@@ -1731,6 +1782,9 @@ void Sequencer::noteConfigurationChanged(std::shared_ptr<Configuration> cfg,
 
   extras_.store(log->attrs().extraCopies().value());
   synced_.store(log->attrs().syncedCopies().value());
+  hedged_copies_.store(log->attrs().hedgedCopies().value());
+  streaming_ingest_.store(log->attrs().streamingIngest().value());
+  updateAppendRateLimit(log->attrs().maxAppendBytesPerSecond().value());
 
   // If nodes were added or removed in config, update nodeset and
   // copyset selector for both current and draining epochs (if any)
@@ -1899,6 +1953,28 @@ std::shared_ptr<const TailRecord> Sequencer::getTailRecord() const {
   return ret_tail;
 }
 
+void Sequencer::noteSealCheckPassed(epoch_t epoch) {
+  if (epoch != getCurrentEpoch()) {
+    return;
+  }
+  // The time is stored first so that a reader that sees the new epoch also
+  // sees a time at least as recent as the check.
+  seal_checked_at_.store(std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()));
+  seal_checked_epoch_.store(epoch.val_);
+}
+
+bool Sequencer::sealCheckedWithin(std::chrono::milliseconds max_age) const {
+  const epoch_t current = getCurrentEpoch();
+  if (current == EPOCH_INVALID || seal_checked_epoch_.load() != current.val_) {
+    return false;
+  }
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()) -
+      seal_checked_at_.load() <=
+      max_age;
+}
+
 uint64_t Sequencer::getEpochOffset() const {
   if (!isRecoveryComplete()) {
     return BYTE_OFFSET_INVALID;
@@ -538,6 +538,15 @@ class Sequencer {
    */
   bool hasAvailableLsns() const;
 
+  /**
+   * @return  true if --epoch-pipelining-esns is set and fewer than that many
+   *          LSNs are left in the current epoch. Appenders can still run in
+   *          the current epoch, but the sequencer should start reactivating
+   *          into the next one so that it is ready once the current epoch
+   *          runs out of ESNs.
+   */
+  bool shouldReactivateAhead() const;
+
   /**
    * @return   number of appends in flight (current size of window of
    *           appenders) in the current epoch. Note that this does not account
@@ -629,6 +638,24 @@ class Sequencer {
   copyset_size_t getSynced() const {
     return synced_.load();
   }
+  copyset_size_t getHedgedCopies() const {
+    return hedged_copies_.load();
+  }
+  bool isStreamingIngest() const {
+    return streaming_ingest_.load();
+  }
+
+  /**
+   * Admission control for appends, see the maxAppendBytesPerSecond log
+   * attribute.
+   *
+   * @return  true if an append with a payload of `payload_size` bytes can
+   *          proceed now, in which case it is charged to the log's budget.
+   *          Otherwise false, and `retry_delay` is set to how long the client
+   *          should back off before appending to the log again.
+   */
+  bool checkAppendRateLimit(size_t payload_size,
+                            std::chrono::milliseconds* retry_delay);
 
   ///////////// Byte offsets and tail attributes ///////////////////
 
@@ -654,6 +681,21 @@ class Sequencer {
    */
   uint64_t getEpochOffset() const;
 
+  /**
+   * Records that the CHECK_SEALs sent on behalf of a GET_SEQ_STATE request
+   * found `epoch` not sealed by a newer sequencer. Ignored unless `epoch` is
+   * the current epoch.
+   */
+  void noteSealCheckPassed(epoch_t epoch);
+
+  /**
+   * @return true if the current epoch passed a seal check (see
+   *         noteSealCheckPassed()) within the last `max_age`. Requests for the
+   *         tail of the log may then be answered from the tail record
+   *         without checking seals again.
+   */
+  bool sealCheckedWithin(std::chrono::milliseconds max_age) const;
+
   ///////////// Log Provision and MetaData Log /////////////////////
 
   virtual MetaDataLogWriter* getMetaDataLogWriter() const;
@@ -752,6 +794,9 @@ class Sequencer {
     std::shared_ptr<EpochSequencer> draining;
   };
 
+  // Applies the maxAppendBytesPerSecond attribute of the log
+  void updateAppendRateLimit(int bytes_per_second);
+
   // id of log managed by this sequencer
   logid_t log_id_;
 
@@ -821,6 +866,13 @@ class Sequencer {
   std::atomic<std::chrono::milliseconds> last_append_{
       std::chrono::milliseconds(0)};
 
+  // Epoch and time of the last seal check this sequencer passed, see
+  // noteSealCheckPassed(). The time is in milliseconds since steady_clock's
+  // epoch, like last_append_.
+  std::atomic<epoch_t::raw_type> seal_checked_epoch_{EPOCH_INVALID.val_};
+  std::atomic<std::chrono::milliseconds> seal_checked_at_{
+      std::chrono::milliseconds(0)};
+
   // tail record of the previous epoch, only populated when log recovery
   // initiated by the current epoch is completed
   UpdateableSharedPtr<const TailRecord> tail_record_previous_epoch_;
@@ -835,6 +887,21 @@ class Sequencer {
   // record is considered fully stored. Capped by replication factor.
   std::atomic<copyset_size_t> synced_{0};
 
+  // Number of recipients added to the first wave of an append while some
+  // nodes of the nodeset are graylisted as slow. See the hedgedCopies log
+  // attribute.
+  std::atomic<copyset_size_t> hedged_copies_{0};
+
+  // If true, records skip the record cache of storage nodes and are released
+  // in batches. See the streamingIngest log attribute.
+  std::atomic<bool> streaming_ingest_{false};
+
+  // Token bucket of the maxAppendBytesPerSecond log attribute, null if there
+  // is no limit. Replaced only when the limit changes, so that config updates
+  // don't refill the bucket.
+  std::atomic<int> append_rate_limit_{0};
+  UpdateableSharedPtr<RateLimiter> append_rate_limiter_;
+
   // Preemption and redirects
 
   // Highest epoch number up to which this sequencer has been preempted. An
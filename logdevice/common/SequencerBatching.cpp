@@ -154,8 +154,8 @@ bool SequencerBatching::buffer(logid_t log_id,
 
   const bool enable_batching = group
       ? group->attrs().sequencerBatching().getValue(
-            processor_->settings()->sequencer_batching)
-      : processor_->settings()->sequencer_batching;
+            Worker::settings().sequencer_batching)
+      : Worker::settings().sequencer_batching;
 
   if (shutting_down_.load() || !enable_batching ||
       MetaDataLog::isMetaDataLog(log_id)) {
@@ -236,8 +236,8 @@ bool SequencerBatching::shouldPassthru(const Appender& appender) const {
 
   const auto passthru_threshold = group
       ? group->attrs().sequencerBatchingPassthruThreshold().getValue(
-            processor_->settings()->sequencer_batching_passthru_threshold)
-      : processor_->settings()->sequencer_batching_passthru_threshold;
+            Worker::settings().sequencer_batching_passthru_threshold)
+      : Worker::settings().sequencer_batching_passthru_threshold;
 
   if (passthru_threshold < 0) {
     return false;
@@ -245,8 +245,8 @@ bool SequencerBatching::shouldPassthru(const Appender& appender) const {
 
   const auto compression = group
       ? group->attrs().sequencerBatchingCompression().getValue(
-            processor_->settings()->sequencer_batching_compression)
-      : processor_->settings()->sequencer_batching_compression;
+            Worker::settings().sequencer_batching_compression)
+      : Worker::settings().sequencer_batching_compression;
 
   bool compressing = compression != Compression::NONE;
 
@@ -461,7 +461,10 @@ void SequencerBatching::sendReply(const AppendMessageState& ams,
 }
 
 Status SequencerBatching::canSendToWorker() {
-  size_t limit = processor_->settings()->max_total_buffered_append_size;
+  const Settings* worker_settings = Worker::settingsIfOnWorker();
+  size_t limit = worker_settings
+      ? worker_settings->max_total_buffered_append_size
+      : processor_->settings()->max_total_buffered_append_size;
   size_t cur_value = totalBufferedAppendSize_.load();
   if (cur_value >= limit) {
     RATELIMIT_WARNING(1s,
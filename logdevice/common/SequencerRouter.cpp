@@ -79,6 +79,37 @@ void SequencerRouter::start() {
   }
 }
 
+void SequencerRouter::startWithHint(NodeID hint) {
+  if (!hint.isNodeID() || getSettings().force_sequencer_choice.isNodeID() ||
+      !getSequencerLocator().isAllowedToCache()) {
+    start();
+    return;
+  }
+
+  auto server_config = getServerConfig();
+  const ServerConfig::SequencersConfig& sequencers =
+      sequencers_.hasValue() ? sequencers_.value()
+                             : server_config->getSequencers();
+  auto it = std::find(sequencers.nodes.begin(), sequencers.nodes.end(), hint);
+  if (it == sequencers.nodes.end() ||
+      sequencers.weights[std::distance(sequencers.nodes.begin(), it)] <= 0) {
+    // Not in the config anymore (or with another generation), or not taking
+    // appends.
+    start();
+    return;
+  }
+  auto cs = getClusterState();
+  if (cs && !cs->isNodeAlive(hint.index())) {
+    start();
+    return;
+  }
+
+  ld_spew("Sending to cached sequencer %s for log:%lu",
+          hint.toString().c_str(),
+          log_id_.val_);
+  sendTo(hint, flags_t(0));
+}
+
 const std::string& SequencerRouter::Handler::getRequestTypeName() {
   switch (this->rqtype_) {
     case Handler::SRRequestType::GET_SEQ_STATE_REQ_TYPE:
@@ -109,6 +109,12 @@ class SequencerRouter {
   // Start the state machine: locate a sequencer and send a message to it.
   void start();
 
+  // Like start(), but sends the message straight to `hint', a node known to
+  // have run the sequencer for the log recently, without consulting the
+  // SequencerLocator. Falls back to start() if `hint' is not an available
+  // sequencer node. If the sequencer has moved, `hint' redirects as usual.
+  void startWithHint(NodeID hint);
+
   // Called when a redirect reply is received from a node.
   void onRedirected(NodeID from, NodeID to, Status status);
 
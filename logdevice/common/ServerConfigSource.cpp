@@ -7,6 +7,9 @@
  */
 #include "ServerConfigSource.h"
 
+#include <folly/FileUtil.h>
+#include <folly/json.h>
+
 #include "logdevice/common/ConfigurationFetchRequest.h"
 #include "logdevice/common/NoopTraceLogger.h"
 #include "logdevice/common/PermissionChecker.h"
@@ -21,8 +24,11 @@
 
 namespace facebook { namespace logdevice {
 
-Status ServerConfigSource::getConfig(const std::string& path,
-                                     Output* /* out */) {
+// Version of the format of the config cache file. Files in other formats
+// are ignored.
+static constexpr int64_t CACHE_FORMAT_VERSION = 1;
+
+Status ServerConfigSource::getConfig(const std::string& path, Output* out) {
   // TODO (#12733971): Add a retry mechanism in case all seed hosts don't
   //                   respond
   std::vector<std::string> hosts;
@@ -38,20 +44,95 @@ Status ServerConfigSource::getConfig(const std::string& path,
     ld_error("ServerConfigSource requires that on-demand-logs-config be set.");
     return E::INVALID_PARAM;
   }
+  bool use_cache = false;
   if (!processor_) {
     ld_info("Initializating processor to fetch config");
     init(path, hosts);
+    use_cache = !cache_path_.empty() && readCache(path, out);
   }
   bool fetch_succeeded = false;
   for (const std::string& host : hosts) {
     fetch_succeeded |= fetch(host);
   }
+  if (use_cache) {
+    // The fetched config, if any, will replace the cached one when it
+    // arrives.
+    return E::OK;
+  }
   if (!fetch_succeeded) {
     return err;
   }
   return E::NOTREADY;
 }
 
+bool ServerConfigSource::readCache(const std::string& path, Output* out) {
+  std::string raw;
+  if (!folly::readFile(cache_path_.c_str(), raw)) {
+    ld_info("No config cached in %s", cache_path_.c_str());
+    return false;
+  }
+  Output cached;
+  try {
+    folly::dynamic cache = folly::parseJson(raw);
+    if (cache["version"].asInt() != CACHE_FORMAT_VERSION) {
+      ld_info("Ignoring config cached in %s: unsupported format version",
+              cache_path_.c_str());
+      return false;
+    }
+    if (cache["path"].asString() != path) {
+      ld_info("Ignoring config cached in %s: it was fetched from %s",
+              cache_path_.c_str(),
+              cache["path"].asString().c_str());
+      return false;
+    }
+    using namespace std::chrono;
+    auto age = duration_cast<seconds>(system_clock::now().time_since_epoch()) -
+        seconds(cache["written_at"].asInt());
+    if (age > cache_max_age_) {
+      ld_info("Ignoring config cached in %s %lds ago",
+              cache_path_.c_str(),
+              age.count());
+      return false;
+    }
+    cached.contents = cache["contents"].asString();
+    cached.hash = cache["hash"].asString();
+    cached.mtime = milliseconds(cache["mtime"].asInt());
+  } catch (const std::exception& e) {
+    ld_warning("Ignoring invalid config cache file %s: %s",
+               cache_path_.c_str(),
+               e.what());
+    return false;
+  }
+  // Don't fail the initial load on a bad cached config.
+  if (!ServerConfig::fromJson(cached.contents)) {
+    ld_warning("Ignoring config cached in %s: failed to parse it",
+               cache_path_.c_str());
+    return false;
+  }
+  ld_info("Starting from config cached in %s, hash = %s",
+          cache_path_.c_str(),
+          cached.hash.c_str());
+  *out = std::move(cached);
+  return true;
+}
+
+void ServerConfigSource::writeCache(const std::string& path,
+                                    const Output& out) {
+  using namespace std::chrono;
+  folly::dynamic cache = folly::dynamic::object(
+      "version", CACHE_FORMAT_VERSION)("path", path)(
+      "written_at",
+      duration_cast<seconds>(system_clock::now().time_since_epoch()).count())(
+      "hash", out.hash)("mtime", out.mtime.count())("contents", out.contents);
+  try {
+    folly::writeFileAtomic(cache_path_, folly::toJson(cache));
+  } catch (const std::exception& e) {
+    ld_warning("Failed to write config cache file %s: %s",
+               cache_path_.c_str(),
+               e.what());
+  }
+}
+
 static std::shared_ptr<ServerConfig>
 constructConfig(const std::vector<std::string>& hosts) {
   folly::dynamic nodes = folly::dynamic::array;
@@ -98,6 +179,9 @@ void ServerConfigSource::init(const std::string& path,
             server_config->getMainConfigMetadata();
         out.mtime = metadata.modified_time;
         out.hash = metadata.hash;
+        if (!cache_path_.empty()) {
+          writeCache(path, out);
+        }
         async_cb_->onAsyncGet(this, path, E::OK, std::move(out));
       });
 
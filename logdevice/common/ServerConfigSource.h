@@ -7,6 +7,9 @@
  */
 #pragma once
 
+#include <chrono>
+#include <string>
+
 #include "logdevice/common/ConfigSource.h"
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/settings/Settings.h"
@@ -23,16 +26,27 @@ class UpdateableConfig;
  * @file Config source that gets configs from LogDevice servers. Can accept
  * multiple seed hosts in the config path. The config path should be of the
  * form "server:<host1>,<host2>,<host3>...".
+ *
+ * If a cache path is given, every fetched config is saved there along with
+ * the config path it was fetched for. The first getConfig() call returns the
+ * saved config if it is for the same path, valid and not older than
+ * `cache_max_age`, and still fetches the current config from the servers;
+ * that one replaces the saved config once it arrives (if it's newer).
  */
 
 class ServerConfigSource : public ConfigSource {
  public:
-  explicit ServerConfigSource(const LogsConfig* alternative_logs_config,
-                              std::shared_ptr<LegacyPluginPack> plugin,
-                              std::shared_ptr<PluginRegistry> plugin_registry)
+  explicit ServerConfigSource(
+      const LogsConfig* alternative_logs_config,
+      std::shared_ptr<LegacyPluginPack> plugin,
+      std::shared_ptr<PluginRegistry> plugin_registry,
+      std::string cache_path = "",
+      std::chrono::seconds cache_max_age = std::chrono::seconds::zero())
       : alternative_logs_config_(alternative_logs_config),
         plugin_(std::move(plugin)),
-        plugin_registry_(std::move(plugin_registry)) {}
+        plugin_registry_(std::move(plugin_registry)),
+        cache_path_(std::move(cache_path)),
+        cache_max_age_(cache_max_age) {}
   ~ServerConfigSource() override {
     // The local processor needs to shutdown its workers first, before anything
     // else gets destroyed
@@ -56,9 +70,16 @@ class ServerConfigSource : public ConfigSource {
   std::shared_ptr<LegacyPluginPack> plugin_;
   std::shared_ptr<PluginRegistry> plugin_registry_;
   ConfigSubscriptionHandle server_config_subscription_;
+  const std::string cache_path_;
+  const std::chrono::seconds cache_max_age_;
 
   void init(const std::string& path, const std::vector<std::string>& hosts);
   bool fetch(const std::string& host);
+
+  // Reads the config saved for `path` from cache_path_. Returns false if
+  // there is none or it can't be used.
+  bool readCache(const std::string& path, Output* out);
+  void writeCache(const std::string& path, const Output& out);
 };
 
 }} // namespace facebook::logdevice
@@ -39,6 +39,17 @@ class ServerRecordFilter {
  public:
   virtual bool operator()(folly::StringPiece key) = 0;
   virtual std::string toString() const = 0;
+
+  /**
+   * @return  false if no key between min_key and max_key (inclusive) can pass
+   *          the filter. Used to skip partitions using the range of their
+   *          filterable keys. The default is conservative.
+   */
+  virtual bool mayMatchRange(folly::StringPiece /* min_key */,
+                             folly::StringPiece /* max_key */) const {
+    return true;
+  }
+
   virtual ~ServerRecordFilter() {}
 };
 }} // namespace facebook::logdevice
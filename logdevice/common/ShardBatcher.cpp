@@ -0,0 +1,34 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/ShardBatcher.h"
+
+#include "logdevice/common/Socket.h"
+#include "logdevice/common/Worker.h"
+
+namespace facebook { namespace logdevice {
+
+ShardBatcherBase::ShardBatcherBase()
+    : sender_(std::make_unique<SenderProxy>()) {}
+
+ShardBatcherBase::~ShardBatcherBase() {}
+
+folly::Optional<uint16_t>
+ShardBatcherBase::getPeerProtocol(node_index_t node) const {
+  Socket* socket = Worker::onThisThread()->sender().findServerSocket(node);
+  if (socket == nullptr || !socket->isHandshaken()) {
+    return folly::none;
+  }
+  return socket->getProto();
+}
+
+std::unique_ptr<Timer>
+ShardBatcherBase::createFlushTimer(std::function<void()> callback) {
+  return std::make_unique<Timer>(std::move(callback));
+}
+
+}} // namespace facebook::logdevice
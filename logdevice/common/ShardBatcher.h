@@ -0,0 +1,221 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <folly/Optional.h>
+
+#include "logdevice/common/NodeID.h"
+#include "logdevice/common/Sender.h"
+#include "logdevice/common/ShardID.h"
+#include "logdevice/common/Timer.h"
+#include "logdevice/common/protocol/Message.h"
+#include "logdevice/include/Err.h"
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Groups the per-shard messages of many client requests (e.g. FINDKEY
+ *       for findTime()) into batch messages (e.g. FINDKEY_BATCH) sent at the
+ *       end of the current event loop iteration.
+ *
+ *       Batching is only used once the connection to the recipient is
+ *       handshaken with a protocol that supports the batch message; headers
+ *       for other recipients are left to the caller to send individually. If
+ *       a batch can still not be sent because the recipient's protocol is too
+ *       old, its entries are resent as individual messages and batching is
+ *       disabled for the node.
+ */
+
+class ShardBatcherBase {
+ public:
+  ShardBatcherBase();
+  virtual ~ShardBatcherBase();
+
+ protected:
+  // Protocol of the handshaken connection to `node`, or folly::none if there
+  // is no such connection yet.
+  virtual folly::Optional<uint16_t> getPeerProtocol(node_index_t node) const;
+
+  virtual std::unique_ptr<Timer>
+  createFlushTimer(std::function<void()> callback);
+
+  std::unique_ptr<SenderBase> sender_;
+};
+
+/**
+ * Header is the header of the individual message and must have a
+ * `client_rqid` member identifying the request it was sent for.
+ */
+template <typename Header>
+class ShardBatcher : public ShardBatcherBase {
+ public:
+  /**
+   * Queues `header` to be sent to `to` in a batch message together with other
+   * headers for the same shard. A batch holds at most getMaxBatchSize()
+   * entries; further headers for the shard go in a new batch. All batches are
+   * sent at the end of the current event loop iteration, never from within
+   * this call, so failures are not reported to a request that is still in
+   * the middle of sending its messages.
+   *
+   * @return true if the header was queued, false if batching is disabled or
+   *         `to` is not known to support the batch message, in which case
+   *         the caller should send the individual message.
+   */
+  bool enqueueForBatch(const Header& header, ShardID to) {
+    const size_t max_batch_size = getMaxBatchSize();
+    if (max_batch_size <= 1 || batch_not_supported_.count(to.node())) {
+      return false;
+    }
+
+    // The protocol of the connection must be known to support the batch
+    // message. Headers sent before the handshake completes go individually.
+    folly::Optional<uint16_t> proto = getPeerProtocol(to.node());
+    if (!proto.hasValue() || proto.value() < getMinBatchProtocol()) {
+      return false;
+    }
+
+    auto it = open_batches_.find(to);
+    if (it == open_batches_.end()) {
+      it = open_batches_.emplace(to, batches_.size()).first;
+      batches_.emplace_back();
+      batches_.back().to = to;
+    }
+
+    Batch& batch = batches_[it->second];
+    batch.entries.push_back(header);
+    if (batch.entries.size() >= max_batch_size) {
+      open_batches_.erase(it);
+    }
+
+    if (!flush_timer_) {
+      flush_timer_ = createFlushTimer([this] { flushBatches(); });
+    }
+    if (!flush_timer_->isActive()) {
+      flush_timer_->activate(std::chrono::microseconds(0));
+    }
+    return true;
+  }
+
+  /**
+   * Called when a batch message couldn't be sent to `node` because its
+   * protocol is too old. Resends the entries that still belong to running
+   * requests as individual messages and disables batching for the node.
+   */
+  void onBatchNotSupported(node_index_t node,
+                           shard_index_t shard,
+                           const std::vector<Header>& entries) {
+    batch_not_supported_.insert(node);
+    ShardID to(node, shard);
+    for (const Header& h : entries) {
+      if (!isRunning(h.client_rqid)) {
+        continue;
+      }
+      int rv = sender_->sendMessage(createMessage(h), NodeID(node));
+      if (rv != 0) {
+        onMessageSent(h.client_rqid, to, err);
+      }
+    }
+  }
+
+ protected:
+  // Largest number of entries in a batch. Batching is disabled if this is
+  // 1 or less.
+  virtual size_t getMaxBatchSize() const = 0;
+
+  // Lowest protocol version that supports the batch message.
+  virtual uint16_t getMinBatchProtocol() const = 0;
+
+  virtual std::unique_ptr<Message>
+  createBatchMessage(shard_index_t shard, std::vector<Header> entries) = 0;
+
+  virtual std::unique_ptr<Message> createMessage(const Header& header) = 0;
+
+  // Returns false if the request `rqid` has completed.
+  virtual bool isRunning(request_id_t rqid) const = 0;
+
+  // Reports that sending the message for `rqid` failed synchronously.
+  virtual void onMessageSent(request_id_t rqid, ShardID to, Status st) = 0;
+
+  // Called for each batch message handed to the messaging layer.
+  virtual void onBatchSent(size_t /* num_entries */) {}
+
+ private:
+  struct Batch {
+    ShardID to;
+    std::vector<Header> entries;
+  };
+
+  // Sends all the batches accumulated in batches_.
+  void flushBatches() {
+    auto batches = std::move(batches_);
+    batches_.clear();
+    open_batches_.clear();
+    for (auto& batch : batches) {
+      sendBatch(std::move(batch));
+    }
+  }
+
+  void sendBatch(Batch batch) {
+    const ShardID to = batch.to;
+    std::vector<Header>& entries = batch.entries;
+    // Skip requests that completed while their entries were waiting.
+    entries.erase(std::remove_if(entries.begin(),
+                                 entries.end(),
+                                 [this](const Header& h) {
+                                   return !isRunning(h.client_rqid);
+                                 }),
+                  entries.end());
+    if (entries.empty()) {
+      return;
+    }
+
+    if (batch_not_supported_.count(to.node())) {
+      // An earlier batch to the node was rejected during this iteration.
+      onBatchNotSupported(to.node(), to.shard(), entries);
+      return;
+    }
+
+    onBatchSent(entries.size());
+    int rv = sender_->sendMessage(
+        createBatchMessage(to.shard(), entries), NodeID(to.node()));
+    if (rv == 0) {
+      return;
+    }
+    if (err == E::PROTONOSUPPORT) {
+      // The connection was renegotiated with an older protocol since the
+      // entries were queued.
+      onBatchNotSupported(to.node(), to.shard(), entries);
+      return;
+    }
+    // The message wasn't sent, so onSent() won't be called. Tell the requests.
+    Status st = err;
+    for (const Header& h : entries) {
+      onMessageSent(h.client_rqid, to, st);
+    }
+  }
+
+  // Batches in the order of their first entry.
+  std::vector<Batch> batches_;
+  // Shard -> index in batches_ of the batch still taking entries for it.
+  std::unordered_map<ShardID, size_t, ShardID::Hash> open_batches_;
+  // Zero-delay timer flushing batches_.
+  std::unique_ptr<Timer> flush_timer_;
+  // Nodes that don't support the batch message.
+  std::unordered_set<node_index_t> batch_not_supported_;
+};
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/ShardLoadTracker.h"
+
+namespace facebook { namespace logdevice {
+
+double
+ShardLoadTracker::reasonToLoad(NodeSetState::NotAvailableReason reason) {
+  switch (reason) {
+    case NodeSetState::NotAvailableReason::NONE:
+      return 0;
+    case NodeSetState::NotAvailableReason::SLOW:
+      return 0.25;
+    case NodeSetState::NotAvailableReason::OVERLOADED:
+      return 0.5;
+    case NodeSetState::NotAvailableReason::LOW_WATERMARK_NOSPC:
+      return 0.75;
+    case NodeSetState::NotAvailableReason::NO_SPC:
+      return 1;
+    case NodeSetState::NotAvailableReason::UNROUTABLE:
+    case NodeSetState::NotAvailableReason::STORE_DISABLED:
+    case NodeSetState::NotAvailableReason::PROBING:
+    case NodeSetState::NotAvailableReason::Count:
+      break;
+  }
+  return -1;
+}
+
+void ShardLoadTracker::update(ShardID shard,
+                              NodeSetState::NotAvailableReason reason) {
+  const double load = reasonToLoad(reason);
+  if (load < 0) {
+    return;
+  }
+  if (load == 0 && size_.load() == 0) {
+    return;
+  }
+  folly::SharedMutex::WriteHolder guard(mutex_);
+  if (load == 0) {
+    loads_.erase(shard);
+  } else {
+    loads_[shard] = Entry{load, std::chrono::steady_clock::now()};
+  }
+  size_.store(loads_.size());
+}
+
+std::unordered_map<ShardID, double, ShardID::Hash>
+ShardLoadTracker::getLoads(std::chrono::milliseconds max_age) const {
+  std::unordered_map<ShardID, double, ShardID::Hash> res;
+  if (size_.load() == 0) {
+    return res;
+  }
+  const auto min_time = std::chrono::steady_clock::now() - max_age;
+  folly::SharedMutex::ReadHolder guard(mutex_);
+  for (const auto& kv : loads_) {
+    if (kv.second.updated_at >= min_time) {
+      res[kv.first] = kv.second.load;
+    }
+  }
+  return res;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,74 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+
+#include <folly/SharedMutex.h>
+
+#include "logdevice/common/NodeSetState.h"
+#include "logdevice/common/ShardID.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Latest load of storage shards as seen by the write path of this node,
+ *       for load-aware nodeset selection (see
+ *       Settings::load_aware_nodeset_selection).
+ *
+ *       Storage nodes report their state in STORED replies and in replies to
+ *       health check probes: LOW_ON_SPC when the free space of the shard is
+ *       below the low watermark of LogStoreMonitor, NOSPC when it is out of
+ *       space, OVERLOADED when its storage threads can't keep up with the
+ *       writes. Sequencers also notice shards that are slow to store. Every
+ *       time an Appender changes the NodeSetState of a shard because of one
+ *       of these, the state is recorded here as a load between 0 and 1. The
+ *       load goes back to 0 when an Appender sees the shard healthy again,
+ *       and readers ignore old reports (see
+ *       Settings::nodeset_load_report_ttl), since most of these states
+ *       simply expire in NodeSetState.
+ *
+ *       Thread-safe. Lookups of an empty table don't take the lock.
+ */
+
+class ShardLoadTracker {
+ public:
+  /**
+   * Records that `shard` was just put in state `reason` in some
+   * NodeSetState. Reasons that say nothing about the load of the shard, e.g.
+   * UNROUTABLE, are ignored.
+   */
+  void update(ShardID shard, NodeSetState::NotAvailableReason reason);
+
+  /**
+   * @return  load of the shards that were reported loaded within the last
+   *          `max_age`, in the format of NodeSetSelector::Options::shard_load
+   */
+  std::unordered_map<ShardID, double, ShardID::Hash>
+  getLoads(std::chrono::milliseconds max_age) const;
+
+  /**
+   * @return  load corresponding to `reason`, or a negative value if the
+   *          reason is not related to load.
+   */
+  static double reasonToLoad(NodeSetState::NotAvailableReason reason);
+
+ private:
+  struct Entry {
+    double load;
+    std::chrono::steady_clock::time_point updated_at;
+  };
+
+  mutable folly::SharedMutex mutex_;
+  std::unordered_map<ShardID, Entry, ShardID::Hash> loads_;
+  std::atomic<size_t> size_{0};
+};
+
+}} // namespace facebook::logdevice
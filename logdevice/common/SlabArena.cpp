@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "SlabArena.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#include "logdevice/common/checks.h"
+
+namespace facebook { namespace logdevice {
+
+namespace {
+// Keeps slots aligned, and large enough to link them in the free list.
+size_t roundUpSlotSize(size_t size) {
+  const size_t align = alignof(std::max_align_t);
+  return (std::max(size, sizeof(void*)) + align - 1) / align * align;
+}
+} // namespace
+
+SlabArena::SlabArena(size_t slot_size, size_t slots_per_slab)
+    : slot_size_(roundUpSlotSize(slot_size)), slots_per_slab_(slots_per_slab) {
+  ld_check(slots_per_slab_ > 0);
+}
+
+SlabArena::~SlabArena() {
+  // Objects in use would point into freed slabs.
+  ld_check(slots_in_use_.load() == 0);
+}
+
+void* SlabArena::allocate() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (free_list_ == nullptr) {
+    // new[] of char is aligned for any fundamental type.
+    const size_t bytes = slot_size_ * slots_per_slab_;
+    slabs_.emplace_back(new char[bytes]);
+    char* slab = slabs_.back().get();
+    for (size_t i = slots_per_slab_; i-- > 0;) {
+      auto slot = reinterpret_cast<FreeSlot*>(slab + i * slot_size_);
+      slot->next = free_list_;
+      free_list_ = slot;
+    }
+    bytes_reserved_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+  FreeSlot* slot = free_list_;
+  free_list_ = slot->next;
+  slots_in_use_.fetch_add(1, std::memory_order_relaxed);
+  return slot;
+}
+
+void SlabArena::deallocate(std::vector<void*>& slots) {
+  if (slots.empty()) {
+    return;
+  }
+  // Link the batch outside of the lock, then splice it in.
+  FreeSlot* head = nullptr;
+  FreeSlot* tail = nullptr;
+  for (void* p : slots) {
+    ld_check(p != nullptr);
+    auto slot = static_cast<FreeSlot*>(p);
+    slot->next = head;
+    head = slot;
+    if (tail == nullptr) {
+      tail = slot;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tail->next = free_list_;
+    free_list_ = head;
+  }
+  ld_check(slots_in_use_.load() >= slots.size());
+  slots_in_use_.fetch_sub(slots.size(), std::memory_order_relaxed);
+  slots.clear();
+}
+
+}} // namespace facebook::logdevice
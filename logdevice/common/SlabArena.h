@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file  SlabArena hands out fixed-size slots carved from large slabs, for
+ *        small objects that are allocated and freed at a high rate on
+ *        different threads (e.g. record cache entries, allocated by storage
+ *        threads and freed by the worker that owns their payload).
+ *
+ *        Freed slots are returned in batches, so that the lock is taken
+ *        once per batch rather than once per object. Slabs are only released
+ *        when the arena is destroyed, which requires all slots to have been
+ *        returned. All methods are thread safe.
+ */
+class SlabArena {
+ public:
+  /**
+   * @param slot_size       size of the objects allocated from this arena
+   * @param slots_per_slab  number of slots allocated at once when the arena
+   *                        runs out of free slots
+   */
+  explicit SlabArena(size_t slot_size, size_t slots_per_slab = 512);
+
+  /**
+   * @return  uninitialized memory for one object of up to slot_size bytes,
+   *          aligned for any fundamental type.
+   */
+  void* allocate();
+
+  /**
+   * Returns the slots in `slots`, which must all have been allocated from
+   * this arena, and clears the vector.
+   */
+  void deallocate(std::vector<void*>& slots);
+
+  size_t slotSize() const {
+    return slot_size_;
+  }
+
+  // Bytes of slabs allocated by this arena, whether their slots are in use
+  // or not.
+  size_t bytesReserved() const {
+    return bytes_reserved_.load(std::memory_order_relaxed);
+  }
+
+  // Number of slots currently handed out.
+  size_t slotsInUse() const {
+    return slots_in_use_.load(std::memory_order_relaxed);
+  }
+
+  ~SlabArena();
+
+ private:
+  struct FreeSlot {
+    FreeSlot* next;
+  };
+
+  const size_t slot_size_;
+  const size_t slots_per_slab_;
+
+  std::mutex mutex_;
+  // Singly linked list of free slots, protected by mutex_.
+  FreeSlot* free_list_{nullptr};
+  std::vector<std::unique_ptr<char[]>> slabs_;
+
+  std::atomic<size_t> bytes_reserved_{0};
+  std::atomic<size_t> slots_in_use_{0};
+};
+
+}} // namespace facebook::logdevice
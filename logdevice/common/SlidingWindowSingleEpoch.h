@@ -424,6 +424,18 @@ class SlidingWindowSingleEpoch {
     return right != LSN_DISABLED && lsn_to_esn(right) <= esn_max_;
   }
 
+  /**
+   * @return  number of ESNs that grow() can still issue in this epoch; 0 if
+   *          the window is disabled
+   */
+  uint64_t esns_left() const {
+    const lsn_t right = right_.load();
+    if (right == LSN_DISABLED || lsn_to_esn(right) > esn_max_) {
+      return 0;
+    }
+    return uint64_t(esn_max_.val_) - lsn_to_esn(right).val_ + 1;
+  }
+
   // smallest allowed value of capacity in constructor
   static const unsigned MIN_CAPACITY = SLIDING_WINDOW_MIN_CAPACITY;
 
@@ -12,11 +12,13 @@
 #include <memory>
 
 #include <folly/Random.h>
+#include <linux/errqueue.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <openssl/err.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include "event2/bufferevent_ssl.h"
 #include "event2/event.h"
@@ -26,6 +28,7 @@
 #include "logdevice/common/EventHandler.h"
 #include "logdevice/common/FlowGroup.h"
 #include "logdevice/common/LegacyPluginPack.h"
+#include "logdevice/common/MessageArena.h"
 #include "logdevice/common/PrincipalParser.h"
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/ResourceBudget.h"
@@ -62,6 +65,8 @@
 namespace facebook { namespace logdevice {
 using folly::SSLContext;
 
+constexpr size_t Socket::CORK_MAX_BYTES;
+
 const char* socketTypeToString(SocketType sock_type) {
   switch (sock_type) {
     case SocketType::DATA:
@@ -221,6 +226,14 @@ Socket::Socket(std::unique_ptr<SocketDependencies>& deps,
     err = E::INTERNAL;
     throw ConstructorFailed();
   }
+
+  rv = deps_->evtimerAssign(&zerocopy_reap_event_,
+                            EventHandler<onZeroCopyReapTimerEvent>,
+                            reinterpret_cast<void*>(this));
+  if (rv != 0) {
+    err = E::INTERNAL;
+    throw ConstructorFailed();
+  }
 }
 
 Socket::Socket(NodeID server_name,
@@ -242,7 +255,8 @@ Socket::Socket(int fd,
                SocketType type,
                ConnectionType conntype,
                FlowGroup& flow_group,
-               std::unique_ptr<SocketDependencies> deps)
+               std::unique_ptr<SocketDependencies> deps,
+               std::unique_ptr<EstablishedSSL> established_ssl)
     : Socket(deps,
              Address(client_name),
              client_addr,
@@ -252,17 +266,21 @@ Socket::Socket(int fd,
   ld_check(fd >= 0);
   ld_check(client_name.valid());
   ld_check(client_addr.valid());
+  ld_check(!established_ssl || isSSL());
 
   // note that caller (Sender.addClient()) does not close(fd) on error.
   // If you add code here that throws ConstructorFailed you must close(fd)!
 
+  const bool handshake_done = established_ssl != nullptr;
+  established_ssl_ = std::move(established_ssl);
   bev_ = newBufferevent(fd,
                         client_addr.family(),
                         &tcp_sndbuf_cache_.size,
                         &tcp_rcvbuf_size_,
                         // This is only used if conntype_ == SSL, tells libevent
                         // we are in a server context
-                        BUFFEREVENT_SSL_ACCEPTING);
+                        handshake_done ? BUFFEREVENT_SSL_OPEN
+                                       : BUFFEREVENT_SSL_ACCEPTING);
   if (!bev_) {
     throw ConstructorFailed(); // err is already set
   }
@@ -272,7 +290,7 @@ Socket::Socket(int fd,
   addHandshakeTimeoutEvent();
   expectProtocolHeader();
 
-  if (isSSL()) {
+  if (isSSL() && !handshake_done) {
     expecting_ssl_handshake_ = true;
   }
   connected_ = true;
@@ -284,6 +302,9 @@ Socket::Socket(int fd,
   if (isSSL()) {
     STAT_INCR(deps_->getStats(), num_ssl_connections);
   }
+  if (handshake_done) {
+    onSSLHandshakeDone();
+  }
 }
 
 void Socket::onBufferedOutputWrite(struct evbuffer* buffer,
@@ -297,14 +318,30 @@ void Socket::onBufferedOutputWrite(struct evbuffer* buffer,
   ld_check(buffer == self->buffered_output_);
 
   if (info->n_added) {
-    self->deps_->evtimerAdd(
-        &self->buffered_output_flush_event_, self->deps_->getZeroTimeout());
+    self->scheduleBufferedOutputFlush();
   }
 }
 
+void Socket::scheduleBufferedOutputFlush() {
+  if (corked_ &&
+      LD_EV(evbuffer_get_length)(buffered_output_) < CORK_MAX_BYTES) {
+    if (!deps_->evtimerPending(&buffered_output_flush_event_)) {
+      deps_->evtimerAdd(
+          &buffered_output_flush_event_,
+          deps_->getCommonTimeout(getSettings().output_cork_delay));
+    }
+    return;
+  }
+  deps_->evtimerAdd(&buffered_output_flush_event_, deps_->getZeroTimeout());
+}
+
 void Socket::flushBufferedOutput() {
   ld_check(buffered_output_);
   ld_check(bev_);
+  if (zerocopy_) {
+    reapZeroCopyCompletions();
+    sendZeroCopy();
+  }
   // Moving buffer chains into bev's output
   int rv = LD_EV(evbuffer_add_buffer)(deps_->getOutput(bev_), buffered_output_);
   if (rv != 0) {
@@ -325,9 +362,121 @@ void Socket::flushBufferedOutput() {
 void Socket::onBufferedOutputTimerEvent(void* instance, short) {
   auto self = reinterpret_cast<Socket*>(instance);
   ld_check(self);
+  if (self->corked_) {
+    STAT_INCR(self->deps_->getStats(), corked_output_flushes);
+    STAT_ADD(self->deps_->getStats(),
+             corked_output_bytes_flushed,
+             LD_EV(evbuffer_get_length)(self->buffered_output_));
+  }
   self->flushBufferedOutput();
 }
 
+void Socket::sendZeroCopy() {
+  ld_check(zerocopy_);
+  ld_check(zerocopy_pending_);
+  const size_t threshold = getSettings().zerocopy_send_threshold;
+  struct evbuffer* outbuf = deps_->getOutput(bev_);
+
+  // Bypass libevent only while nothing is queued in bev's output buffer, so
+  // that bytes reach the socket in order.
+  while (threshold > 0 && LD_EV(evbuffer_get_length)(outbuf) == 0 &&
+         LD_EV(evbuffer_get_length)(buffered_output_) >= threshold) {
+    constexpr int MAX_IOVECS = 64;
+    struct evbuffer_iovec vecs[MAX_IOVECS];
+    const int nvecs = std::min(
+        MAX_IOVECS,
+        LD_EV(evbuffer_peek)(buffered_output_, -1, nullptr, vecs, MAX_IOVECS));
+    struct iovec iov[MAX_IOVECS];
+    for (int i = 0; i < nvecs; ++i) {
+      iov[i].iov_base = vecs[i].iov_base;
+      iov[i].iov_len = vecs[i].iov_len;
+    }
+
+    const ssize_t rv = deps_->sendZeroCopy(fd_, iov, nvecs);
+    if (rv <= 0) {
+      // socket buffer full, out of optmem for pinned pages, or an error that
+      // libevent will run into and report on its next write
+      break;
+    }
+    const size_t sent = rv;
+
+    // Every evbuffer_iovec is one chain. Move all chains the kernel took
+    // bytes from to zerocopy_pending_, so that their memory stays valid
+    // until the send completes. The unsent tail of the last of them, if any,
+    // is copied back to the front of buffered_output_.
+    size_t chains_len = 0;
+    int last = 0;
+    for (; last < nvecs; ++last) {
+      chains_len += vecs[last].iov_len;
+      if (chains_len >= sent) {
+        break;
+      }
+    }
+    ld_check(last < nvecs);
+    const size_t unsent = chains_len - sent;
+    int moved = LD_EV(evbuffer_remove_buffer)(
+        buffered_output_, zerocopy_pending_, chains_len);
+    ld_check(moved == static_cast<int>(chains_len));
+    if (unsent > 0) {
+      const char* tail = static_cast<const char*>(vecs[last].iov_base) +
+          (vecs[last].iov_len - unsent);
+      int prepended = LD_EV(evbuffer_prepend)(buffered_output_, tail, unsent);
+      ld_check(prepended == 0);
+    }
+
+    zerocopy_sends_.emplace_back(chains_len, false);
+    STAT_INCR(deps_->getStats(), zerocopy_sends);
+    STAT_ADD(deps_->getStats(), zerocopy_bytes_sent, sent);
+    onBytesPassedToTCP(sent);
+  }
+
+  if (!zerocopy_sends_.empty() &&
+      !deps_->evtimerPending(&zerocopy_reap_event_)) {
+    deps_->evtimerAdd(&zerocopy_reap_event_,
+                      deps_->getCommonTimeout(std::chrono::milliseconds(1)));
+  }
+}
+
+void Socket::reapZeroCopyCompletions() {
+  ld_check(zerocopy_);
+  uint32_t lo, hi;
+  bool copied;
+  int rv;
+  while ((rv = deps_->readZeroCopyCompletion(fd_, &lo, &hi, &copied)) >= 0) {
+    if (rv == 0) {
+      continue;
+    }
+    for (uint32_t seq = lo; seq - lo <= hi - lo; ++seq) {
+      const uint32_t idx = seq - zerocopy_first_seq_;
+      if (idx < zerocopy_sends_.size()) {
+        zerocopy_sends_[idx].second = true;
+      }
+    }
+    if (copied) {
+      // e.g. the route goes through a device without scatter-gather support
+      STAT_INCR(deps_->getStats(), zerocopy_sends_copied);
+    }
+  }
+
+  while (!zerocopy_sends_.empty() && zerocopy_sends_.front().second) {
+    LD_EV(evbuffer_drain)(zerocopy_pending_, zerocopy_sends_.front().first);
+    zerocopy_sends_.pop_front();
+    ++zerocopy_first_seq_;
+  }
+}
+
+void Socket::onZeroCopyReapTimerEvent(void* instance, short) {
+  auto self = reinterpret_cast<Socket*>(instance);
+  ld_check(self);
+  ld_check(self->zerocopy_);
+  self->reapZeroCopyCompletions();
+  if (!self->zerocopy_sends_.empty()) {
+    self->deps_->evtimerAdd(
+        &self->zerocopy_reap_event_,
+        self->deps_->getCommonTimeout(std::chrono::milliseconds(1)));
+  }
+}
+
 Socket::~Socket() {
   ld_debug(
       "Destroying Socket %s", deps_->describeConnection(peer_name_).c_str());
@@ -380,13 +529,30 @@ struct bufferevent* Socket::newBufferevent(int sfd,
   deps_->configureSocket(
       !peer_sockaddr_.isUnixAddress(), sfd, &tcp_sndbuf_size, &tcp_rcvbuf_size);
 
-  if (isSSL()) {
-    ld_check(!ssl_context_);
-    ssl_context_ = deps_->getSSLContext(ssl_state, null_ciphers_only_);
+  if (!isSSL() && !peer_sockaddr_.isUnixAddress() &&
+      getSettings().zerocopy_send_threshold > 0) {
+    zerocopy_ = deps_->enableZeroCopy(sfd);
   }
 
-  struct bufferevent* bev = deps_->buffereventSocketNew(
-      sfd, BEV_OPT_CLOSE_ON_FREE, isSSL(), ssl_state, ssl_context_.get());
+  corked_ = getSettings().output_cork_delay.count() > 0;
+
+  struct bufferevent* bev;
+  if (established_ssl_) {
+    ld_check(isSSL());
+    ld_check(ssl_state == BUFFEREVENT_SSL_OPEN);
+    ld_check(!ssl_context_);
+    ssl_context_ = std::move(established_ssl_->context);
+    bev = deps_->buffereventSocketNewEstablishedSSL(
+        sfd, BEV_OPT_CLOSE_ON_FREE, established_ssl_->ssl.release());
+    established_ssl_.reset();
+  } else {
+    if (isSSL()) {
+      ld_check(!ssl_context_);
+      ssl_context_ = deps_->getSSLContext(ssl_state, null_ciphers_only_);
+    }
+    bev = deps_->buffereventSocketNew(
+        sfd, BEV_OPT_CLOSE_ON_FREE, isSSL(), ssl_state, ssl_context_.get());
+  }
   if (!bev) { // unlikely
     ld_error("bufferevent_socket_new() failed. errno=%d (%s)",
              errno,
@@ -432,17 +598,21 @@ struct bufferevent* Socket::newBufferevent(int sfd,
                           BufferEventHandler<Socket::eventCallback>,
                           (void*)this);
 
-  if (isSSL()) {
+  if (isSSL() || zerocopy_ || corked_) {
     // The buffer may already exist if we're making another attempt at a
     // connection
     if (!buffered_output_) {
-      // creating an evbuffer that would batch up SSL writes
+      // creating an evbuffer that would batch up SSL or corked writes, or
+      // from which large writes are sent with MSG_ZEROCOPY
       buffered_output_ = LD_EV(evbuffer_new)();
       LD_EV(evbuffer_add_cb)
       (buffered_output_,
        &EvBufferEventHandler<Socket::onBufferedOutputWrite>,
        (void*)this);
     }
+    if (zerocopy_ && !zerocopy_pending_) {
+      zerocopy_pending_ = LD_EV(evbuffer_new)();
+    }
   } else {
     buffered_output_ = nullptr;
   }
@@ -529,6 +699,10 @@ int Socket::doConnectAttempt() {
     return -1; // err is already set
   }
 
+  if (isSSL() && getSettings().ssl_session_resumption) {
+    deps_->buffereventResumeSSLSession(bev_, sslSessionKey());
+  }
+
   expectProtocolHeader();
 
   struct sockaddr_storage ss;
@@ -771,6 +945,38 @@ void Socket::eventCallbackImpl(SocketEvent e) {
   }
 }
 
+void Socket::onSSLHandshakeDone() {
+  ld_check(isSSL());
+  if (getSettings().ssl_session_resumption &&
+      deps_->buffereventSSLSessionReused(bev_)) {
+    STAT_INCR(deps_->getStats(), ssl_sessions_resumed);
+  }
+
+  if (!getSettings().ssl_enable_ktls || null_ciphers_only_) {
+    return;
+  }
+
+  bool send = false;
+  bool recv = false;
+  deps_->buffereventGetKTLS(bev_, &send, &recv);
+  ld_debug("kTLS with %s: send %s, receive %s",
+           deps_->describeConnection(peer_name_).c_str(),
+           send ? "on" : "off",
+           recv ? "on" : "off");
+  if (send) {
+    ktls_send_ = true;
+    STAT_INCR(deps_->getStats(), num_ktls_connections);
+  } else {
+    STAT_INCR(deps_->getStats(), ktls_unavailable);
+  }
+}
+
+std::string Socket::sslSessionKey() const {
+  // Sessions negotiated with eNULL ciphers can't be resumed when they're
+  // excluded, and vice versa.
+  return peer_sockaddr_.toString() + (null_ciphers_only_ ? " eNULL" : "");
+}
+
 void Socket::flushNextInSerializeQueue() {
   ld_check(!serializeq_.empty());
 
@@ -795,6 +1001,7 @@ void Socket::onConnected() {
     ld_debug("SSL handshake with %s completed",
              deps_->describeConnection(peer_name_).c_str());
     expecting_ssl_handshake_ = false;
+    onSSLHandshakeDone();
     expectProtocolHeader();
     return;
   }
@@ -806,6 +1013,12 @@ void Socket::onConnected() {
   connected_ = true;
   peer_shuttingdown_ = false;
 
+  if (isSSL()) {
+    // for outgoing SSL connections, BEV_EVENT_CONNECTED is only reported once
+    // the handshake is done
+    onSSLHandshakeDone();
+  }
+
   ld_debug("Socket(%p) to node %s has connected",
            this,
            deps_->describeConnection(peer_name_).c_str());
@@ -1047,6 +1260,21 @@ void Socket::close(Status reason) {
     buffered_output_ = nullptr;
   }
 
+  if (zerocopy_pending_) {
+    // Pick up whatever completed. Memory of sends still in flight gets
+    // freed below even though the kernel may not have transmitted it yet;
+    // the connection is being torn down, so the peer won't process those
+    // bytes anyway.
+    reapZeroCopyCompletions();
+    deps_->evtimerDel(&zerocopy_reap_event_);
+    LD_EV(evbuffer_free)(zerocopy_pending_);
+    zerocopy_pending_ = nullptr;
+    zerocopy_sends_.clear();
+    zerocopy_first_seq_ = 0;
+  }
+  zerocopy_ = false;
+  corked_ = false;
+
   if (isSSL()) {
     deps_->buffereventShutDownSSL(bev_);
   }
@@ -1071,6 +1299,10 @@ void Socket::close(Status reason) {
   if (isSSL()) {
     STAT_DECR(deps_->getStats(), num_ssl_connections);
   }
+  if (ktls_send_) {
+    STAT_DECR(deps_->getStats(), num_ktls_connections);
+    ktls_send_ = false;
+  }
 
   deps_->evtimerDel(&read_more_);
   deps_->evtimerDel(&connect_timeout_event_);
@@ -1271,7 +1503,8 @@ int Socket::serializeMessage(std::unique_ptr<Envelope>&& envelope,
       buffered_output_ ? buffered_output_ : deps_->getOutput(bev_);
   ld_check(outbuf);
 
-  bool compute_checksum = !buffered_output_ &&
+  // SSL already protects the integrity of the stream
+  bool compute_checksum = !isSSL() &&
       ProtocolHeader::needChecksumInHeader(msg.type_, proto_) &&
       isChecksummingEnabled(msg.type_);
 
@@ -1576,6 +1809,14 @@ void Socket::sendHello() {
     hdr.flags |= HELLO_Header::CLIENT_LOCATION;
   }
 
+  if (getSettings().accept_compressed_records) {
+    hdr.flags |= HELLO_Header::ACCEPTS_COMPRESSED_RECORDS;
+  }
+
+  if (carries_read_streams_) {
+    hdr.flags |= HELLO_Header::READ_STREAMS;
+  }
+
   const std::string& csid = deps_->getCSID();
   ld_check(csid.size() < MAX_CSID_SIZE);
   if (!csid.empty()) {
@@ -1895,8 +2136,11 @@ int Socket::receiveMessage() {
         checksumming_enabled ? "yes" : "no");
 
     // 2. read actual message
-    std::unique_ptr<Message> msg =
-        messageDeserializers[recv_message_ph_.type](reader).msg;
+    std::unique_ptr<Message> msg;
+    {
+      MessageArena::Scope arena_scope(deps_->getMessageArena());
+      msg = messageDeserializers[recv_message_ph_.type](reader).msg;
+    }
 
     ++num_messages_received_;
     num_bytes_received_ += recv_message_ph_.len;
@@ -1994,6 +2238,12 @@ int Socket::receiveMessage() {
       handshaken_ = true;
       first_attempt_ = false;
       deps_->evtimerDel(&handshake_timeout_event_);
+      if (isSSL() && !peer_name_.isClientAddress() &&
+          getSettings().ssl_session_resumption) {
+        // Servers send TLS 1.3 session tickets right after the TLS
+        // handshake, so they have arrived by the time of the ACK.
+        deps_->buffereventSaveSSLSession(bev_, sslSessionKey());
+      }
     }
 
     MESSAGE_TYPE_STAT_INCR(
@@ -2312,6 +2562,10 @@ StatsHolder* SocketDependencies::getStats() {
   return Worker::stats();
 }
 
+MessageArena* SocketDependencies::getMessageArena() {
+  return Worker::onThisThread()->messageArena();
+}
+
 void SocketDependencies::noteBytesQueued(size_t nbytes) {
   Worker::onThisThread()->sender().noteBytesQueued(nbytes);
 }
@@ -2408,7 +2662,7 @@ void SocketDependencies::evtimerDel(struct event* ev) {
 }
 
 const struct timeval*
-SocketDependencies::getCommonTimeout(std::chrono::milliseconds timeout) {
+SocketDependencies::getCommonTimeout(std::chrono::microseconds timeout) {
   return Worker::onThisThread()->getCommonTimeout(timeout);
 }
 
@@ -2442,6 +2696,15 @@ SocketDependencies::buffereventSocketNew(int sfd,
       ld_error("Null SSL* returned, can't create SSL socket");
       return nullptr;
     }
+#ifdef SSL_OP_ENABLE_KTLS
+    if (getSettings().ssl_enable_ktls) {
+      // OpenSSL installs the session keys into the kernel as soon as the
+      // handshake completes, if both the kernel and the negotiated cipher
+      // support it. SSL_write() and SSL_read() then pass plaintext to and
+      // from the socket, which bufferevent_openssl keeps using unchanged.
+      SSL_set_options(ssl, SSL_OP_ENABLE_KTLS);
+    }
+#endif
 
     struct bufferevent* bev = bufferevent_openssl_socket_new(
         Worker::onThisThread()->getEventBase(), sfd, ssl, ssl_state, opts);
@@ -2457,6 +2720,25 @@ SocketDependencies::buffereventSocketNew(int sfd,
   }
 }
 
+struct bufferevent*
+SocketDependencies::buffereventSocketNewEstablishedSSL(int sfd,
+                                                       int opts,
+                                                       SSL* ssl) {
+  ld_check(ssl);
+  struct bufferevent* bev =
+      bufferevent_openssl_socket_new(Worker::onThisThread()->getEventBase(),
+                                     sfd,
+                                     ssl,
+                                     BUFFEREVENT_SSL_OPEN,
+                                     opts);
+#if LIBEVENT_VERSION_NUMBER >= 0x02010100
+  if (bev) {
+    bufferevent_openssl_set_allow_dirty_shutdown(bev, 1);
+  }
+#endif
+  return bev;
+}
+
 struct evbuffer* SocketDependencies::getOutput(struct bufferevent* bev) {
   return LD_EV(bufferevent_get_output)(bev);
 }
@@ -2486,6 +2768,120 @@ void SocketDependencies::buffereventSetCb(struct bufferevent* bev,
   LD_EV(bufferevent_setcb)(bev, readcb, writecb, eventcb, cbarg);
 }
 
+void SocketDependencies::buffereventGetKTLS(struct bufferevent* bev,
+                                            bool* send,
+                                            bool* recv) {
+  ld_check(send);
+  ld_check(recv);
+  *send = false;
+  *recv = false;
+#ifdef SSL_OP_ENABLE_KTLS
+  SSL* ssl = bufferevent_openssl_get_ssl(bev);
+  if (ssl) {
+    *send = BIO_get_ktls_send(SSL_get_wbio(ssl));
+    *recv = BIO_get_ktls_recv(SSL_get_rbio(ssl));
+  }
+#else
+  (void)bev;
+#endif
+}
+
+void SocketDependencies::buffereventResumeSSLSession(struct bufferevent* bev,
+                                                     const std::string& key) {
+  SSL_SESSION* session = Worker::onThisThread()->sslFetcher().getSession(key);
+  SSL* ssl = bufferevent_openssl_get_ssl(bev);
+  if (session && ssl) {
+    // If the server doesn't resume it, the handshake is a full one.
+    SSL_set_session(ssl, session);
+  }
+}
+
+void SocketDependencies::buffereventSaveSSLSession(struct bufferevent* bev,
+                                                   const std::string& key) {
+  SSL* ssl = bufferevent_openssl_get_ssl(bev);
+  if (ssl) {
+    Worker::onThisThread()->sslFetcher().saveSession(key, ssl);
+  }
+}
+
+bool SocketDependencies::buffereventSSLSessionReused(struct bufferevent* bev) {
+  SSL* ssl = bufferevent_openssl_get_ssl(bev);
+  return ssl && SSL_session_reused(ssl);
+}
+
+bool SocketDependencies::enableZeroCopy(int fd) {
+#ifdef SO_ZEROCOPY
+  int one = 1;
+  if (setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0) {
+    return true;
+  }
+  RATELIMIT_INFO(std::chrono::seconds(10),
+                 1,
+                 "Failed to set SO_ZEROCOPY on socket %d: %s",
+                 fd,
+                 strerror(errno));
+#else
+  (void)fd;
+#endif
+  return false;
+}
+
+ssize_t SocketDependencies::sendZeroCopy(int fd,
+                                         const struct iovec* iov,
+                                         int iovcnt) {
+#ifdef MSG_ZEROCOPY
+  struct msghdr msg {};
+  msg.msg_iov = const_cast<struct iovec*>(iov);
+  msg.msg_iovlen = iovcnt;
+  return ::sendmsg(fd, &msg, MSG_ZEROCOPY | MSG_DONTWAIT | MSG_NOSIGNAL);
+#else
+  (void)fd;
+  (void)iov;
+  (void)iovcnt;
+  errno = EOPNOTSUPP;
+  return -1;
+#endif
+}
+
+int SocketDependencies::readZeroCopyCompletion(int fd,
+                                               uint32_t* lo,
+                                               uint32_t* hi,
+                                               bool* copied) {
+#ifdef SO_EE_ORIGIN_ZEROCOPY
+  // room for a sock_extended_err followed by the offender's sockaddr_in6
+  char control[128];
+  struct msghdr msg {};
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  if (::recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+    return -1;
+  }
+  for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != nullptr;
+       cm = CMSG_NXTHDR(&msg, cm)) {
+    if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) &&
+        !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)) {
+      continue;
+    }
+    const auto* serr =
+        reinterpret_cast<const struct sock_extended_err*>(CMSG_DATA(cm));
+    if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+      continue;
+    }
+    *lo = serr->ee_info;
+    *hi = serr->ee_data;
+    *copied = serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED;
+    return 1;
+  }
+  return 0;
+#else
+  (void)fd;
+  (void)lo;
+  (void)hi;
+  (void)copied;
+  return -1;
+#endif
+}
+
 void SocketDependencies::buffereventShutDownSSL(struct bufferevent* bev) {
   SSL* ctx = bufferevent_openssl_get_ssl(bev);
   ld_check(ctx);
@@ -2703,6 +3099,19 @@ void SocketDependencies::configureSocket(bool is_tcp,
   }
 
 #ifdef __linux__
+  Worker* w = Worker::onThisThread(false);
+  int busy_poll_usec = getSettings().socket_busy_poll.count();
+  if (busy_poll_usec > 0 && w && w->busyPolls()) {
+    rv = setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll_usec, sizeof(int));
+    if (rv != 0) {
+      RATELIMIT_ERROR(std::chrono::seconds(10),
+                      1,
+                      "Failed to set SO_BUSY_POLL for socket %d: %s",
+                      fd,
+                      strerror(errno));
+    }
+  }
+
   if (is_tcp) {
     int tcp_user_timeout = getSettings().tcp_user_timeout;
 
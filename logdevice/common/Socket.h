@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <deque>
 #include <memory>
@@ -14,6 +15,7 @@
 #include <folly/Memory.h>
 #include <folly/Optional.h>
 #include <folly/io/async/SSLContext.h>
+#include <folly/ssl/OpenSSLPtrTypes.h>
 
 #include "event2/buffer.h"
 #include "event2/bufferevent.h"
@@ -40,6 +42,7 @@ namespace facebook { namespace logdevice {
 
 class BWAvailableCallback;
 class FlowGroup;
+class MessageArena;
 class ResourceBudget;
 class SocketCallback;
 class SocketImpl;
@@ -78,6 +81,16 @@ class Worker;
 // Defined later in this file.
 class SocketDependencies;
 
+/**
+ * An accepted SSL connection whose handshake a listener thread completed,
+ * see --ssl-handshake-threads.
+ */
+struct EstablishedSSL {
+  // The context `ssl` was created from. Must outlive it.
+  std::shared_ptr<folly::SSLContext> context;
+  folly::ssl::SSLUniquePtr ssl;
+};
+
 class Socket {
  public:
   using PendingQueue = PriorityQueue<Envelope, &Envelope::socket_links_>;
@@ -135,6 +148,8 @@ class Socket {
    * @param type        type of socket
    * @param flow_group  traffic shaping state shared between sockets
    *                    with the same bandwidth constraints.
+   * @param established_ssl  if not null, the SSL connection on fd, whose
+   *                         handshake is already done
    *
    * @return  on success, a new fully constructed Socket is returned. On
    *          failure throws ConstructorFailed and sets err to:
@@ -151,7 +166,8 @@ class Socket {
          ResourceBudget::Token conn_token,
          SocketType type,
          ConnectionType conntype,
-         FlowGroup& flow_group)
+         FlowGroup& flow_group,
+         std::unique_ptr<EstablishedSSL> established_ssl = nullptr)
       : Socket(fd,
                client_name,
                client_addr,
@@ -159,7 +175,8 @@ class Socket {
                type,
                conntype,
                flow_group,
-               std::make_unique<SocketDependencies>()) {}
+               std::make_unique<SocketDependencies>(),
+               std::move(established_ssl)) {}
 
   /**
    * Used for tests.
@@ -171,7 +188,8 @@ class Socket {
          SocketType type,
          ConnectionType conntype,
          FlowGroup& flow_group,
-         std::unique_ptr<SocketDependencies> deps);
+         std::unique_ptr<SocketDependencies> deps,
+         std::unique_ptr<EstablishedSSL> established_ssl = nullptr);
 
   /**
    * Disconnects, deletes the underlying bufferevent, and closes the TCP socket.
@@ -207,6 +225,10 @@ class Socket {
   // for local SCD reading.
   std::string peer_location_;
 
+  // True if the peer said in HELLO it can decompress compressed RECORD
+  // messages. Only set for client (incoming) connections.
+  bool peer_accepts_compressed_records_ = false;
+
   // Used to identify the client for permission checks. Set after successfull
   // authentication
   PrincipalIdentity principal_;
@@ -454,6 +476,15 @@ class Socket {
    */
   void limitCiphersToENULL();
 
+  /**
+   * Marks this connection as only carrying read streams: its HELLO will have
+   * the READ_STREAMS flag. Must be called before connecting.
+   */
+  void setCarriesReadStreams() {
+    ld_check(!connected_);
+    carries_read_streams_ = true;
+  }
+
   void setPeerShuttingDown() {
     peer_shuttingdown_ = true;
   }
@@ -509,6 +540,18 @@ class Socket {
    */
   size_t getBytesPending() const;
 
+  /**
+   * Bytes of messages of the given priority that flow_group_ let through
+   * on this Socket. Reported by the traffic_shaping admin command.
+   */
+  uint64_t getFlowGroupBytesReleased(Priority p) const {
+    return flow_group_bytes_released_[asInt(p)];
+  }
+
+  void noteFlowGroupBytesReleased(Priority p, uint64_t nbytes) {
+    flow_group_bytes_released_[asInt(p)] += nbytes;
+  }
+
  private:
   /**
    * This is strictly a delegating constructor. It sets all members
@@ -665,6 +708,18 @@ class Socket {
    */
   void onConnected();
 
+  /**
+   * Called once the SSL handshake of an SSL socket has completed. Checks
+   * whether the kernel took over encryption, see --ssl-enable-ktls.
+   */
+  void onSSLHandshakeDone();
+
+  /**
+   * Key of the TLS session with the peer of an outgoing SSL connection, see
+   * --ssl-session-resumption.
+   */
+  std::string sslSessionKey() const;
+
   void onSent(std::unique_ptr<Envelope>,
               Status,
               Message::CompletionMethod = Message::CompletionMethod::IMMEDIATE);
@@ -724,7 +779,8 @@ class Socket {
    * @param   rcvbuf_size_out   if non-NULL and TCP receive buffer size for
    *                            sfd was successfully obtained, the size is
    *                            returned through this parameter
-   * @param   ssl_state BUFFEREVENT_SSL_ACCEPTING or BUFFEREVENT_SSL_CONNECTING
+   * @param   ssl_state BUFFEREVENT_SSL_ACCEPTING, BUFFEREVENT_SSL_CONNECTING
+   *                    or, with established_ssl_, BUFFEREVENT_SSL_OPEN.
    *                    Used only if (conntype_ == SSL)
    * @return  a new bufferevent on success, nullptr on failure. err is set to
    *             SYSLIMIT        out of file descriptors
@@ -921,20 +977,35 @@ class Socket {
   // Used for debugging.
   size_t num_bytes_received_;
 
+  // See getFlowGroupBytesReleased().
+  std::array<uint64_t, asInt(Priority::NUM_PRIORITIES)>
+      flow_group_bytes_released_{};
+
   // Indicates whether this is an SSL socket
   ConnectionType conntype_{ConnectionType::PLAIN};
 
   // Defines if the socket will be encrypted. Only used if conntype_ is SSL
   bool null_ciphers_only_ = false;
 
+  // See setCarriesReadStreams().
+  bool carries_read_streams_ = false;
+
   // The SSL context. We have to hold it alive as long as the SSL* object which
   // we submit to bufferevent_openssl_new() is in use
   std::shared_ptr<folly::SSLContext> ssl_context_;
 
+  // The SSL connection handed over with an accepted fd, until
+  // newBufferevent() wraps it in bev_.
+  std::unique_ptr<EstablishedSSL> established_ssl_;
+
   // true if we accepted a TCP connection, but the SSL handshake didn't
   // complete yet
   bool expecting_ssl_handshake_ = false;
 
+  // true if the kernel encrypts what we send on this SSL connection, see
+  // --ssl-enable-ktls
+  bool ktls_send_ = false;
+
   // true if the message error injection code has decided to rewind
   // a message stream. All traffic for this socket will be diverted until
   // the end of the event loop, at which time the messages will be delivered
@@ -972,12 +1043,41 @@ class Socket {
   ResourceBudget::Token conn_external_token_;
 
   // Output buffer in front of bev's output buffer. Used mostly for SSL to
-  // batch up small writes.
+  // batch up small writes, by plain sockets that send with MSG_ZEROCOPY, and
+  // by all sockets when output is corked.
   struct evbuffer* buffered_output_{nullptr};
 
-  // The zero-timeout timer used to flush the output buffer
+  // The timer used to flush the output buffer. Zero timeout, unless output
+  // is corked.
   struct event buffered_output_flush_event_;
 
+  // true if writes are held in buffered_output_ for up to
+  // --output-cork-delay, see scheduleBufferedOutputFlush()
+  bool corked_ = false;
+
+  // Corked output is flushed right away once this many bytes are buffered
+  static constexpr size_t CORK_MAX_BYTES = 64 * 1024;
+
+  // true if SO_ZEROCOPY was enabled on the TCP socket, see
+  // --zerocopy-send-threshold
+  bool zerocopy_ = false;
+
+  // Bytes sent with MSG_ZEROCOPY whose memory the kernel may still be
+  // reading. The evbuffer chains, and through them the payloads they
+  // reference, are kept here until the kernel reports the send complete.
+  struct evbuffer* zerocopy_pending_{nullptr};
+
+  // One entry per sendmsg() call with MSG_ZEROCOPY not yet drained from
+  // zerocopy_pending_, in the order they were made: the number of bytes of
+  // zerocopy_pending_ it holds on to and whether the kernel is done with it.
+  // The kernel numbers these calls consecutively from 0 for every socket;
+  // zerocopy_first_seq_ is the number of the front entry.
+  std::deque<std::pair<size_t, bool>> zerocopy_sends_;
+  uint32_t zerocopy_first_seq_ = 0;
+
+  // Polls for completions of zerocopy sends while some are outstanding
+  struct event zerocopy_reap_event_;
+
  private:
   // called by bev_ when all bytes we have been waiting for arrive
   static void dataReadCallback(struct bufferevent*, void*, short);
@@ -1040,6 +1140,15 @@ class Socket {
   static void onBufferedOutputWrite(struct evbuffer* buffer,
                                     const struct evbuffer_cb_info* info,
                                     void* arg);
+  /**
+   * Arms buffered_output_flush_event_ after bytes were added to
+   * buffered_output_. Corked sockets flush after --output-cork-delay, counted
+   * from the first write since the last flush so that a steady trickle of
+   * messages can't postpone it, or right away once CORK_MAX_BYTES are
+   * buffered. Other sockets flush at the end of the event loop iteration.
+   */
+  void scheduleBufferedOutputFlush();
+
   /**
    * Flushes the local output buffer to bev's output buffer
    */
@@ -1050,6 +1159,26 @@ class Socket {
    */
   static void onBufferedOutputTimerEvent(void* instance, short);
 
+  /**
+   * While bev's output buffer is empty, sends the contents of
+   * buffered_output_ straight to the socket with MSG_ZEROCOPY, as long as at
+   * least --zerocopy-send-threshold bytes are buffered. Stops at the first
+   * send that fails, e.g. because the socket buffer is full, leaving the rest
+   * to libevent.
+   */
+  void sendZeroCopy();
+
+  /**
+   * Reads completion notifications of zerocopy sends from the socket's error
+   * queue and frees the memory of the sends the kernel is done with.
+   */
+  void reapZeroCopyCompletions();
+
+  /**
+   * A callback for zerocopy_reap_event_
+   */
+  static void onZeroCopyReapTimerEvent(void* instance, short);
+
   /**
    * Gets the sum of sizes of output buffers
    */
@@ -1083,6 +1212,7 @@ class SocketDependencies {
  public:
   virtual const Settings& getSettings() const;
   virtual StatsHolder* getStats();
+  virtual MessageArena* getMessageArena();
   virtual void noteBytesQueued(size_t nbytes);
   virtual void noteBytesDrained(size_t nbytes);
   virtual size_t getBytesPending() const;
@@ -1107,7 +1237,7 @@ class SocketDependencies {
                             void* arg);
   virtual void evtimerDel(struct event* ev);
   virtual int evtimerPending(struct event* ev, struct timeval* tv = nullptr);
-  virtual const struct timeval* getCommonTimeout(std::chrono::milliseconds t);
+  virtual const struct timeval* getCommonTimeout(std::chrono::microseconds t);
   virtual const struct timeval* getZeroTimeout();
   virtual int evtimerAdd(struct event* ev, const struct timeval* timeout);
   virtual struct bufferevent* buffereventSocketNew(int sfd,
@@ -1115,6 +1245,10 @@ class SocketDependencies {
                                                    bool secure,
                                                    bufferevent_ssl_state,
                                                    folly::SSLContext*);
+  // Wraps an SSL connection whose handshake is done, taking ownership of
+  // `ssl'.
+  virtual struct bufferevent*
+  buffereventSocketNewEstablishedSSL(int sfd, int opts, SSL* ssl);
 
   virtual struct evbuffer* getOutput(struct bufferevent* bev);
   virtual struct evbuffer* getInput(struct bufferevent* bev);
@@ -1131,8 +1265,36 @@ class SocketDependencies {
                                 bufferevent_event_cb eventcb,
                                 void* cbarg);
   virtual void buffereventShutDownSSL(struct bufferevent* bev);
+  // Reports whether OpenSSL installed the keys of the SSL connection of
+  // `bev' into the kernel for sending and for receiving. Only meaningful
+  // once the handshake has completed.
+  virtual void buffereventGetKTLS(struct bufferevent* bev,
+                                  bool* send,
+                                  bool* recv);
+  // Client side of --ssl-session-resumption: offers the TLS session saved
+  // under `key' in the handshake of `bev', and saves the session of `bev'
+  // under `key'.
+  virtual void buffereventResumeSSLSession(struct bufferevent* bev,
+                                           const std::string& key);
+  virtual void buffereventSaveSSLSession(struct bufferevent* bev,
+                                         const std::string& key);
+  // Whether the handshake of the SSL connection of `bev' resumed a session.
+  virtual bool buffereventSSLSessionReused(struct bufferevent* bev);
   virtual void buffereventFree(struct bufferevent* bev);
   virtual int evUtilMakeSocketNonBlocking(int sfd);
+  // Sets SO_ZEROCOPY on a TCP socket. Returns false if the kernel doesn't
+  // support it.
+  virtual bool enableZeroCopy(int fd);
+  // sendmsg() with MSG_ZEROCOPY, never blocks
+  virtual ssize_t sendZeroCopy(int fd, const struct iovec* iov, int iovcnt);
+  // Dequeues one message from the error queue of the socket. Returns 1 and
+  // sets the range [lo, hi] of completed zerocopy sends if it was a zerocopy
+  // completion (`copied' tells whether the kernel fell back to copying), 0
+  // if it was another message, -1 if the queue is empty.
+  virtual int readZeroCopyCompletion(int fd,
+                                     uint32_t* lo,
+                                     uint32_t* hi,
+                                     bool* copied);
   virtual int buffereventSetMaxSingleWrite(struct bufferevent* bev,
                                            size_t size);
   virtual int buffereventSetMaxSingleRead(struct bufferevent* bev, size_t size);
@@ -199,8 +199,11 @@ bool StickyCopySetManager::startNewBlock(State& csm_state,
                                         // here.
   current_block_starting_lsn_ = max_lsn + 1;
   current_block_bytes_written_ = 0;
-  current_block_expiration_ =
-      std::chrono::steady_clock::now() + block_time_threshold_;
+  current_block_expiration_ = std::chrono::steady_clock::now() +
+      (block_time_alignment_.count() > 0
+           ? timeUntilAligned(
+                 std::chrono::system_clock::now(), block_time_alignment_)
+           : block_time_threshold_);
   current_block_css_result_ = result;
   return true;
 }
@@ -232,10 +235,21 @@ StickyCopySetManager::StickyCopySetManager(
     std::shared_ptr<NodeSetState> nodeset_state,
     size_t sticky_copysets_block_size,
     std::chrono::milliseconds sticky_copysets_block_max_time,
+    std::chrono::milliseconds block_time_alignment,
     const CopySetSelectorDependencies* deps)
     : CopySetManager(std::move(selector), nodeset_state),
       block_size_threshold_(sticky_copysets_block_size),
       block_time_threshold_(sticky_copysets_block_max_time),
+      block_time_alignment_(block_time_alignment),
       deps_(deps) {}
 
+std::chrono::milliseconds StickyCopySetManager::timeUntilAligned(
+    std::chrono::system_clock::time_point now,
+    std::chrono::milliseconds alignment) {
+  ld_check(alignment.count() > 0);
+  auto since_epoch = std::chrono::duration_cast<std::chrono::milliseconds>(
+      now.time_since_epoch());
+  return alignment - since_epoch % alignment;
+}
+
 }} // namespace facebook::logdevice
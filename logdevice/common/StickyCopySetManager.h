@@ -24,6 +24,9 @@ namespace facebook { namespace logdevice {
  * records - a number of records being stored consecutively. It will start a
  * new block by generating a new copyset whenever a threshold for the total
  * size of processed appends is hit, or the block's maximum lifespan expires.
+ * Optionally, blocks instead end at wall clock times that are multiples of a
+ * fixed period, so that blocks of all logs switch copysets together, e.g. on
+ * the boundaries of time-based storage partitions.
  * Currently this is an implementation of a single-copyset selector.  When we
  * implement distributed appenders, we will want to maintain several copysets
  * and assign them based on which location scope the appender is in.
@@ -54,6 +57,7 @@ class StickyCopySetManager : public CopySetManager {
                        std::shared_ptr<NodeSetState> nodeset_state,
                        size_t sticky_copysets_block_size,
                        std::chrono::milliseconds sticky_copysets_block_max_time,
+                       std::chrono::milliseconds block_time_alignment,
                        const CopySetSelectorDependencies* deps =
                            CopySetSelectorDependencies::instance());
 
@@ -85,6 +89,12 @@ class StickyCopySetManager : public CopySetManager {
   // see docblock in CopySetSelector::createState()
   std::unique_ptr<CopySetManager::State> createState() const override;
 
+  // Time from `now` until the next wall clock time that is a multiple of
+  // `alignment`. Always positive.
+  static std::chrono::milliseconds
+  timeUntilAligned(std::chrono::system_clock::time_point now,
+                   std::chrono::milliseconds alignment);
+
  private:
   // returns true if a new block should be started - either because the current
   // copyset was generated with outdated inputs, or because block size
@@ -121,6 +131,10 @@ class StickyCopySetManager : public CopySetManager {
   // When the age of a block exceeds this value, we start a new one.
   const std::chrono::milliseconds block_time_threshold_;
 
+  // If positive, blocks expire at the next wall clock time that is a multiple
+  // of this value instead of after block_time_threshold_.
+  const std::chrono::milliseconds block_time_alignment_;
+
   // Number of extras. Used to start a new block if this changes.
   copyset_size_t extras_{0};
 
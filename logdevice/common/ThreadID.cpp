@@ -7,6 +7,7 @@
  */
 #include "ThreadID.h"
 
+#include "logdevice/common/JemallocArenas.h"
 #include "logdevice/common/debug.h"
 
 namespace facebook { namespace logdevice {
@@ -30,6 +31,8 @@ void ThreadID::set(Type type, folly::StringPiece name) {
     int rv = pthread_setname_np(pthread_self(), name_.data());
     ld_check(rv == 0);
   }
+
+  JemallocArenas::onThreadStart(type);
 }
 
 __thread ThreadID::Type ThreadID::type_ = ThreadID::Type::UNKNOWN;
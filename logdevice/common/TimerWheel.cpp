@@ -0,0 +1,194 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/TimerWheel.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "logdevice/common/EventHandler.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/libevent/compat.h"
+
+namespace facebook { namespace logdevice {
+
+using namespace std::chrono;
+
+constexpr microseconds::rep TimerWheel::TICK_USEC;
+constexpr size_t TimerWheel::SLOT_BITS;
+constexpr size_t TimerWheel::SLOTS;
+constexpr size_t TimerWheel::LEVELS;
+
+TimerWheel::TimerWheel(struct event_base* base)
+    : start_(steady_clock::now()), base_(base) {
+  memset(&tick_event_, 0, sizeof(tick_event_));
+  if (base_ != nullptr) {
+    int rv = evtimer_assign(&tick_event_,
+                            base_,
+                            (EventHandler<TimerWheel::onTick>),
+                            reinterpret_cast<void*>(this));
+    ld_check(rv == 0);
+  }
+}
+
+TimerWheel::~TimerWheel() {
+  if (tick_scheduled_) {
+    evtimer_del(&tick_event_);
+  }
+  // Timers that are still in the wheel can't fire anymore, make them
+  // inactive so that cancelling or destroying them later is a no-op.
+  for (auto& level : slots_) {
+    for (auto& slot : level) {
+      while (!slot.empty()) {
+        LibeventTimer& timer = slot.front();
+        slot.pop_front();
+        timer.wheel_ = nullptr;
+        timer.active_ = false;
+      }
+    }
+  }
+}
+
+uint64_t TimerWheel::toTick(steady_clock::time_point t, bool round_up) const {
+  const microseconds::rep us =
+      std::max(duration_cast<microseconds>(t - start_).count(),
+               microseconds::rep(0));
+  return round_up ? (us + TICK_USEC - 1) / TICK_USEC : us / TICK_USEC;
+}
+
+void TimerWheel::add(LibeventTimer* timer, microseconds delay) {
+  ld_check(timer->wheel_ == nullptr);
+  const auto now = steady_clock::now();
+  if (size_ == 0) {
+    // Nothing can fire or cascade while the wheel is empty, skip the ticks it
+    // has been idle for.
+    current_tick_ = std::max(current_tick_, toTick(now, false));
+  }
+
+  timer->wheel_ = this;
+  timer->wheel_expiry_ = std::max(toTick(now + delay, true), current_tick_ + 1);
+  insert(timer);
+  ++size_;
+
+  // Wake up for this timer if it's in level 0, or for the next cascade
+  // otherwise.
+  const uint64_t next_cascade = (current_tick_ | (SLOTS - 1)) + 1;
+  const uint64_t tick = std::min(timer->wheel_expiry_, next_cascade);
+  if (!tick_scheduled_ || tick < scheduled_tick_) {
+    scheduleTick(tick);
+  }
+}
+
+void TimerWheel::remove(LibeventTimer* timer) {
+  ld_check(timer->wheel_ == this);
+  timer->wheel_hook_.unlink();
+  timer->wheel_ = nullptr;
+  ld_check(size_ > 0);
+  --size_;
+  // tick_event_ stays scheduled, a spurious tick is cheaper than finding the
+  // next non-empty slot on every cancellation.
+}
+
+void TimerWheel::insert(LibeventTimer* timer) {
+  const uint64_t delta = timer->wheel_expiry_ - current_tick_;
+  size_t level = 0;
+  while (level + 1 < LEVELS &&
+         delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+    ++level;
+  }
+  uint64_t slot_tick = timer->wheel_expiry_;
+  if (delta >= (uint64_t(1) << (SLOT_BITS * LEVELS))) {
+    // Out of range. Park the timer in the last slot of the top level, it
+    // will be inserted again when that slot is cascaded.
+    slot_tick = current_tick_ + (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+  }
+  const size_t index = (slot_tick >> (SLOT_BITS * level)) & (SLOTS - 1);
+  slots_[level][index].push_back(*timer);
+}
+
+void TimerWheel::cascade(size_t level) {
+  const size_t index = (current_tick_ >> (SLOT_BITS * level)) & (SLOTS - 1);
+  TimerList timers;
+  timers.swap(slots_[level][index]);
+  while (!timers.empty()) {
+    LibeventTimer& timer = timers.front();
+    timers.pop_front();
+    insert(&timer);
+  }
+}
+
+void TimerWheel::advance(steady_clock::time_point now) {
+  const uint64_t target = toTick(now, false);
+  while (current_tick_ < target) {
+    if (size_ == 0) {
+      current_tick_ = target;
+      break;
+    }
+    ++current_tick_;
+
+    // Level i is cascaded every time the levels below it complete a
+    // revolution.
+    for (size_t level = 1; level < LEVELS; ++level) {
+      if ((current_tick_ >> (SLOT_BITS * (level - 1))) & (SLOTS - 1)) {
+        break;
+      }
+      cascade(level);
+    }
+
+    // Callbacks may add and remove timers, including ones in this slot, so
+    // take them out one at a time. Timers they add always go to other slots.
+    auto& slot = slots_[0][current_tick_ & (SLOTS - 1)];
+    while (!slot.empty()) {
+      LibeventTimer& timer = slot.front();
+      slot.pop_front();
+      timer.wheel_ = nullptr;
+      --size_;
+      timer.fire(); // timer could be destroyed after this
+    }
+  }
+  scheduleNextTick();
+}
+
+void TimerWheel::scheduleTick(uint64_t tick) {
+  if (base_ == nullptr) {
+    return;
+  }
+  const auto deadline = start_ + microseconds(tick * TICK_USEC);
+  const microseconds::rep us = std::max(
+      duration_cast<microseconds>(deadline - steady_clock::now()).count(),
+      microseconds::rep(0));
+  struct timeval tv;
+  tv.tv_sec = us / 1000000;
+  tv.tv_usec = us % 1000000;
+  evtimer_add(&tick_event_, &tv);
+  tick_scheduled_ = true;
+  scheduled_tick_ = tick;
+}
+
+void TimerWheel::scheduleNextTick() {
+  if (size_ == 0) {
+    if (tick_scheduled_) {
+      evtimer_del(&tick_event_);
+      tick_scheduled_ = false;
+    }
+    return;
+  }
+  const uint64_t next_cascade = (current_tick_ | (SLOTS - 1)) + 1;
+  uint64_t tick = current_tick_ + 1;
+  while (tick < next_cascade && slots_[0][tick & (SLOTS - 1)].empty()) {
+    ++tick;
+  }
+  scheduleTick(tick);
+}
+
+void TimerWheel::onTick(void* instance, short) {
+  auto self = reinterpret_cast<TimerWheel*>(instance);
+  self->tick_scheduled_ = false;
+  self->advance(steady_clock::now());
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <array>
+#include <chrono>
+
+#include <boost/noncopyable.hpp>
+#include <folly/IntrusiveList.h>
+
+#include "event2/event_struct.h"
+#include "logdevice/common/LibeventTimer.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file A hierarchical timing wheel for the LibeventTimers of a Worker.
+ *
+ *       libevent keeps its timers in a min-heap, so adding or cancelling one
+ *       costs O(log n), and with hundreds of thousands of Appenders, read
+ *       streams and retry timers on a worker that shows up in profiles. The
+ *       wheel instead hashes a timer into one of SLOTS lists of the level
+ *       whose range covers its delay, making insertion and cancellation O(1).
+ *       Level 0 has a slot per TICK; each slot of level i covers a whole
+ *       revolution of level i - 1. When level i - 1 completes a revolution,
+ *       the next slot of level i is cascaded down.
+ *
+ *       A single libevent timer drives the wheel. It is scheduled for the
+ *       next non-empty slot of level 0 or the next cascade, whichever comes
+ *       first, so an idle wheel doesn't wake the event loop.
+ *
+ *       Timers fire on the first tick at or after their deadline, i.e. up to
+ *       TICK late, never early. Not thread-safe, the wheel and its timers
+ *       belong to a single event loop.
+ */
+
+class TimerWheel : boost::noncopyable {
+ public:
+  // Resolution of the wheel.
+  static constexpr std::chrono::microseconds::rep TICK_USEC = 1000;
+  static constexpr size_t SLOT_BITS = 8;
+  static constexpr size_t SLOTS = 1 << SLOT_BITS;
+  // 4 levels of 256 slots of 1ms cover delays of up to ~49 days. Longer ones
+  // go around the last level until they are in range.
+  static constexpr size_t LEVELS = 4;
+
+  /**
+   * @param base  event base of the timer that drives the wheel. If nullptr,
+   *              the wheel is only advanced by calls to advance(), in tests.
+   */
+  explicit TimerWheel(struct event_base* base);
+
+  ~TimerWheel();
+
+  /**
+   * Schedules timer, which must not already be in the wheel, to fire after
+   * delay. LibeventTimer::activate() calls this.
+   */
+  void add(LibeventTimer* timer, std::chrono::microseconds delay);
+
+  /**
+   * Takes timer out of the wheel without firing it.
+   */
+  void remove(LibeventTimer* timer);
+
+  /**
+   * Fires all the timers whose deadline is at or before `now'.
+   */
+  void advance(std::chrono::steady_clock::time_point now);
+
+  // Number of timers in the wheel.
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  using TimerList =
+      folly::IntrusiveList<LibeventTimer, &LibeventTimer::wheel_hook_>;
+
+  // Returns the tick of `t', rounded up if round_up is true.
+  uint64_t toTick(std::chrono::steady_clock::time_point t, bool round_up) const;
+
+  // Links timer into the slot for its deadline relative to current_tick_.
+  void insert(LibeventTimer* timer);
+
+  // Moves the timers of the current slot of `level' to lower levels.
+  void cascade(size_t level);
+
+  // (Re)schedules tick_event_ to go off at `tick'.
+  void scheduleTick(uint64_t tick);
+
+  // Schedules tick_event_ for the next non-empty slot of level 0 or the next
+  // cascade.
+  void scheduleNextTick();
+
+  static void onTick(void* instance, short);
+
+  const std::chrono::steady_clock::time_point start_;
+  // All timers with deadlines up to and including this tick have fired.
+  uint64_t current_tick_ = 0;
+  std::array<std::array<TimerList, SLOTS>, LEVELS> slots_;
+  size_t size_ = 0;
+
+  struct event_base* base_;
+  struct event tick_event_;
+  bool tick_scheduled_ = false;
+  uint64_t scheduled_tick_ = 0;
+};
+
+}} // namespace facebook::logdevice
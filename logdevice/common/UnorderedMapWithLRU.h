@@ -145,6 +145,14 @@ class UnorderedMapWithLRU {
     return sentinel_.prev;
   }
 
+  // Returns the key used right after `key`, i.e. the next one to be evicted
+  // after it, or the empty key if `key` is the most recently used one.
+  Key getNextLRU(const Key& key) const {
+    auto iter = index_.find(key);
+    ld_check(iter != index_.end());
+    return iter->second.node_.prev;
+  }
+
   Key removeLRU() {
     verifyIntegrity(-1);
 
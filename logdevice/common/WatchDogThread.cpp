@@ -7,7 +7,16 @@
  */
 #include "WatchDogThread.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
 #include <signal.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <folly/experimental/symbolizer/StackTrace.h>
+#include <folly/experimental/symbolizer/Symbolizer.h>
 
 #include "logdevice/common/LegacyPluginPack.h"
 #include "logdevice/common/Processor.h"
@@ -18,6 +27,113 @@
 
 namespace facebook { namespace logdevice {
 
+constexpr size_t WatchDogThread::STALL_SAMPLES_CAPACITY;
+
+namespace {
+
+constexpr size_t MAX_STALL_FRAMES = 64;
+// Frames of onStackSampleSignal() and of the signal trampoline, at the top of
+// sampled stacks
+constexpr size_t SIGNAL_FRAMES = 2;
+// How long to wait for the sampled thread to run the signal handler
+constexpr std::chrono::milliseconds STACK_SAMPLE_TIMEOUT(20);
+
+// Filled by onStackSampleSignal() on the sampled thread. Stacks are sampled
+// one at a time, under stack_sample_mutex.
+struct StackSample {
+  // Id of the thread to sample. Set to -1 by the signal handler when it
+  // starts filling the sample, or by the sampler when it gives up waiting.
+  std::atomic<int> tid{-1};
+  // Number of frames, -1 until the signal handler is done
+  std::atomic<ssize_t> nframes{-1};
+  uintptr_t frames[MAX_STALL_FRAMES];
+};
+
+StackSample stack_sample;
+// Shared by the WatchDogThreads of all Processors in the process
+std::mutex stack_sample_mutex;
+
+int stackSampleSignal() {
+  // Not SIGPROF, which is used by CPU profilers.
+  return SIGRTMIN + 3;
+}
+
+void onStackSampleSignal(int /*sig*/) {
+  const int saved_errno = errno;
+  int tid = syscall(__NR_gettid);
+  // A signal delivered after the sampler gave up finds another tid or -1
+  // and leaves the sample alone.
+  if (stack_sample.tid.compare_exchange_strong(tid, -1)) {
+    ssize_t n = folly::symbolizer::getStackTraceSafe(
+        stack_sample.frames, MAX_STALL_FRAMES);
+    stack_sample.nframes.store(n, std::memory_order_release);
+  }
+  errno = saved_errno;
+}
+
+// Samples the stack of the worker thread and returns it in folded format,
+// or an empty string if that failed.
+std::string sampleStack(Worker& w) {
+  static std::once_flag handler_installed;
+  std::call_once(handler_installed, [] {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onStackSampleSignal;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    int rv = sigaction(stackSampleSignal(), &sa, nullptr);
+    if (rv != 0) {
+      ld_error("Failed to install the stack sampling signal handler: %s",
+               strerror(errno));
+    }
+  });
+
+  std::lock_guard<std::mutex> lock(stack_sample_mutex);
+  stack_sample.nframes.store(-1);
+  stack_sample.tid.store(w.getThreadId());
+  if (pthread_kill(w.getThread(), stackSampleSignal()) != 0) {
+    stack_sample.tid.store(-1);
+    return "";
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + STACK_SAMPLE_TIMEOUT;
+  ssize_t n;
+  while ((n = stack_sample.nframes.load(std::memory_order_acquire)) < 0) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      int tid = w.getThreadId();
+      if (stack_sample.tid.compare_exchange_strong(tid, -1)) {
+        // The handler hasn't started and won't touch the sample anymore.
+        return "";
+      }
+      // Otherwise the handler is filling the sample, wait for it.
+    }
+    std::this_thread::yield();
+  }
+  if (n <= static_cast<ssize_t>(SIGNAL_FRAMES)) {
+    return "";
+  }
+
+  folly::symbolizer::FrameArray<MAX_STALL_FRAMES> fa;
+  fa.frameCount = n - SIGNAL_FRAMES;
+  std::copy(stack_sample.frames + SIGNAL_FRAMES,
+            stack_sample.frames + n,
+            fa.addresses);
+  folly::symbolizer::Symbolizer symbolizer;
+  symbolizer.symbolize(fa);
+
+  std::string res;
+  for (size_t i = fa.frameCount; i-- > 0;) {
+    if (!res.empty()) {
+      res += ';';
+    }
+    const auto& frame = fa.frames[i];
+    res += frame.found ? frame.demangledName().toStdString() : "??";
+  }
+  return res;
+}
+
+} // namespace
+
 WatchDogThread::WatchDogThread(Processor* p,
                                std::chrono::milliseconds poll_interval,
                                rate_limit_t bt_ratelimit)
@@ -105,25 +221,89 @@ void WatchDogThread::detectStalls() {
   }
 }
 
+void WatchDogThread::profileStalls(std::chrono::milliseconds threshold) {
+  for (int i = 0; i < numOfWorkerTypes(); i++) {
+    processor_->applyToWorkerPool(
+        [&](Worker& w) {
+          const uint64_t slot =
+              w.currentlyRunningSlot_.load(std::memory_order_relaxed);
+          RunState state;
+          auto duration = Worker::unpackRunningSlot(slot, &state);
+          // Idle workers are NONE.
+          if (state.type_ == RunState::NONE || duration < threshold) {
+            return;
+          }
+          auto it = sampled_runs_.find(w.getThreadId());
+          if (it != sampled_runs_.end() && it->second == slot) {
+            return;
+          }
+          sampled_runs_[w.getThreadId()] = slot;
+
+          StallSample sample;
+          sample.time = std::chrono::system_clock::now();
+          sample.worker = w.getName();
+          sample.run_state = state.describe();
+          sample.duration = duration;
+          sample.stack = sampleStack(w);
+          // The run may have ended while the stack was sampled.
+          if (w.currentlyRunningSlot_.load(std::memory_order_relaxed) !=
+              slot) {
+            sample.stack.clear();
+          }
+          STAT_INCR(processor_->stats_, watchdog_stall_samples);
+
+          std::lock_guard<std::mutex> lock(stall_samples_mutex_);
+          if (stall_samples_.size() >= STALL_SAMPLES_CAPACITY) {
+            stall_samples_.pop_front();
+          }
+          stall_samples_.push_back(std::move(sample));
+        },
+        Processor::Order::FORWARD,
+        workerTypeByIndex(i));
+  }
+}
+
+std::vector<WatchDogThread::StallSample>
+WatchDogThread::getStallSamples() const {
+  std::lock_guard<std::mutex> lock(stall_samples_mutex_);
+  return std::vector<StallSample>(stall_samples_.begin(), stall_samples_.end());
+}
+
 void WatchDogThread::run() {
   ThreadID::set(ThreadID::Type::UTILITY, "ld:watchdog");
 
   std::unique_lock<std::mutex> cv_lock(mutex_);
   std::chrono::steady_clock::time_point last_entry_time =
       std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point next_poll_time = last_entry_time;
   while (!shutdown_) {
-    int64_t loop_entry_delay = msec_since(last_entry_time);
-    if (loop_entry_delay - poll_interval_ms_.count() > 100) {
-      STAT_INCR(processor_->stats_, watchdog_num_delays);
-      RATELIMIT_INFO(std::chrono::minutes(1),
-                     1,
-                     "Entry into watchdog loop took %lums",
-                     loop_entry_delay);
+    if (std::chrono::steady_clock::now() >= next_poll_time) {
+      int64_t loop_entry_delay = msec_since(last_entry_time);
+      if (loop_entry_delay - poll_interval_ms_.count() > 100) {
+        STAT_INCR(processor_->stats_, watchdog_num_delays);
+        RATELIMIT_INFO(std::chrono::minutes(1),
+                       1,
+                       "Entry into watchdog loop took %lums",
+                       loop_entry_delay);
+      }
+      detectStalls();
+      last_entry_time = std::chrono::steady_clock::now();
+      next_poll_time = last_entry_time + poll_interval_ms_;
+    }
+
+    // The stall profiler checks on workers every half threshold, so that
+    // runs are sampled before they have taken 1.5 times the threshold.
+    std::chrono::steady_clock::duration wait =
+        next_poll_time - std::chrono::steady_clock::now();
+    const std::chrono::milliseconds threshold =
+        processor_->settings()->watchdog_stall_profiler_threshold;
+    if (threshold.count() > 0) {
+      profileStalls(threshold);
+      wait = std::min<std::chrono::steady_clock::duration>(
+          wait, std::max(threshold / 2, std::chrono::milliseconds(1)));
     }
-    detectStalls();
-    last_entry_time = std::chrono::steady_clock::now();
 
-    cv_.wait_for(cv_lock, poll_interval_ms_);
+    cv_.wait_for(cv_lock, wait);
   }
   ld_info("Exiting the watchdog thread");
 }
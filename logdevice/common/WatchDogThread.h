@@ -9,8 +9,11 @@
 
 #include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
+#include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "logdevice/common/RateLimiter.h"
@@ -19,14 +22,42 @@ namespace facebook { namespace logdevice {
 
 class Processor;
 
+/**
+ * Besides looking for workers that stopped making progress every
+ * watchdog-poll-interval, WatchDogThread runs a stall profiler if
+ * watchdog-stall-profiler-threshold is set. It checks what each worker is
+ * running, as published by the worker in Worker::currentlyRunningSlot_,
+ * every half threshold. When a request or message callback has been running
+ * for longer than the threshold, it samples the stack of the worker with a
+ * signal and records it, along with the RunState, in a ring buffer that
+ * `info stalls' dumps. Each run is sampled at most once.
+ */
 class WatchDogThread {
  public:
+  struct StallSample {
+    std::chrono::system_clock::time_point time;
+    std::string worker;
+    // RunState::describe() of the run that stalled
+    std::string run_state;
+    // How long the run had been going on for when it was sampled
+    std::chrono::milliseconds duration;
+    // Frames of the stack, outermost first, separated with ';' as in the
+    // folded format of flame graphs. Empty if the stack couldn't be sampled.
+    std::string stack;
+  };
+
+  // Number of samples kept
+  static constexpr size_t STALL_SAMPLES_CAPACITY = 1024;
+
   explicit WatchDogThread(Processor* p,
                           std::chrono::milliseconds poll_interval,
                           rate_limit_t bt_ratelimit);
 
   void shutdown();
 
+  // Returns the samples recorded by the stall profiler, oldest first.
+  std::vector<StallSample> getStallSamples() const;
+
  private:
   std::thread thread_;
 
@@ -47,10 +78,22 @@ class WatchDogThread {
   std::mutex mutex_;
 
   std::vector<std::chrono::milliseconds> total_stalled_time_ms_;
+
+  // Last sampled run of each worker, keyed by thread id, as a value of
+  // Worker::currentlyRunningSlot_. Used to sample each run once.
+  std::unordered_map<int, uint64_t> sampled_runs_;
+
+  // Ring buffer of the stall profiler
+  std::deque<StallSample> stall_samples_;
+  mutable std::mutex stall_samples_mutex_;
+
   // Main thread loop.
   void run();
 
   void detectStalls();
+
+  // Samples the workers whose current run has taken more than threshold.
+  void profileStalls(std::chrono::milliseconds threshold);
 };
 
 }} // namespace facebook::logdevice
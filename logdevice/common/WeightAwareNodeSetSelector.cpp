@@ -7,6 +7,8 @@
  */
 #include "logdevice/common/WeightAwareNodeSetSelector.h"
 
+#include <algorithm>
+#include <cmath>
 #include <map>
 #include <queue>
 #include <utility>
@@ -15,6 +17,19 @@
 
 namespace facebook { namespace logdevice {
 
+constexpr double WeightAwareNodeSetSelector::MAX_LOAD;
+
+double WeightAwareNodeSetSelector::loadAwareRank(uint64_t hash, double load) {
+  // Weighted rendezvous hashing: with u uniform in [0, 1) and weight w, the
+  // shard with the smallest -ln(1 - u) / w is picked with probability
+  // proportional to w. The rank grows with the hash, so if all shards are
+  // equally loaded the order is the same as without loads and nodesets only
+  // change where loads differ.
+  const double weight = 1 - std::min(std::max(load, 0.0), MAX_LOAD);
+  const double u = std::ldexp(static_cast<double>(hash), -64);
+  return -std::log1p(-std::min(u, 1 - 1e-16)) / weight;
+}
+
 std::tuple<NodeSetSelector::Decision, std::unique_ptr<StorageSet>>
 WeightAwareNodeSetSelector::getStorageSet(
     logid_t log_id,
@@ -55,8 +70,9 @@ WeightAwareNodeSetSelector::getStorageSet(
     int num_picked = 0;
     uint64_t priority;
 
-    // A sorted vector of hashes of nodes.
-    std::vector<std::pair<uint64_t, ShardID>> node_hashes;
+    // Shards sorted by rank, then by hash. The rank is 0 unless shard loads
+    // are given in `options`.
+    std::vector<std::tuple<double, uint64_t, ShardID>> node_hashes;
   };
   std::map<std::string, Domain> domains;
 
@@ -116,8 +132,14 @@ WeightAwareNodeSetSelector::getStorageSet(
     } else {
       curr_hash = folly::Random::rand64();
     }
+    double rank = 0;
+    if (options != nullptr && !options->shard_load.empty()) {
+      auto load_it = options->shard_load.find(current_shard_id);
+      double load = load_it == options->shard_load.end() ? 0 : load_it->second;
+      rank = loadAwareRank(curr_hash, load);
+    }
     domains[location_str].node_hashes.push_back(
-        std::make_pair(curr_hash, current_shard_id));
+        std::make_tuple(rank, curr_hash, current_shard_id));
   }
 
   // Form the nodeset by repeatedly taking a random unpicked node from the
@@ -148,7 +170,7 @@ WeightAwareNodeSetSelector::getStorageSet(
       // The nodeset is big enough and has enough nodes from each domain.
       break;
     }
-    result->push_back(d->node_hashes[d->num_picked++].second);
+    result->push_back(std::get<2>(d->node_hashes[d->num_picked++]));
     if (d->num_picked != d->node_hashes.size()) {
       queue.push(d);
     }
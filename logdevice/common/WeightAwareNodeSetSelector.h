@@ -31,6 +31,16 @@ class WeightAwareNodeSetSelector : public NodeSetSelector {
                 const StorageSet* prev,
                 const Options* options = nullptr) override;
 
+  // Loads are capped at this value, so that even a full shard can still be
+  // picked when its domain has nothing better.
+  static constexpr double MAX_LOAD = 0.99;
+
+  /**
+   * Rank of a shard with the given hash and Options::shard_load. Shards with
+   * lower rank are picked first within a domain.
+   */
+  static double loadAwareRank(uint64_t hash, double load);
+
  private:
   MapLogToShardFn mapLogToShard_;
   bool consistentHashing_;
@@ -564,7 +564,7 @@ WeightedCopySetSelector::prepareCachedNodeAvailability() const {
         nodeset_state_.get(), shard, &unused);
     if (node_status != NodeStatus::NOT_AVAILABLE) {
       cache.unavailable_nodes.erase(cache.unavailable_nodes.begin() + i);
-      bool was_disabled = cache.adjusted_hierarchy->attachNode(shard);
+      bool was_disabled = cache.attachNode(shard);
       ld_check(was_disabled);
       cache.avoid_detaching_my_domain = false;
     }
@@ -576,7 +576,7 @@ WeightedCopySetSelector::prepareCachedNodeAvailability() const {
 bool WeightedCopySetSelector::checkAvailabilityAndBlacklist(
     const StoreChainLink copyset_chain[],
     size_t copyset_size,
-    AdjustedHierarchy& hierarchy,
+    AdjustedHierarchy* hierarchy,
     NodeAvailabilityCache& cache,
     bool* out_biased,
     StoreChainLink* out_chain_links,
@@ -597,9 +597,11 @@ bool WeightedCopySetSelector::checkAvailabilityAndBlacklist(
                             node));
       // Node is unavailable. Disable it both in cache and in the local
       // AdjustedHierarchy.
-      bool was_enabled_local = hierarchy.detachNode(node);
-      bool was_enabled_cache = cache.adjusted_hierarchy->detachNode(node);
-      ld_check(was_enabled_local);
+      if (hierarchy) {
+        bool was_enabled_local = hierarchy->detachNode(node);
+        ld_check(was_enabled_local);
+      }
+      bool was_enabled_cache = cache.detachNode(node);
       if (was_enabled_cache) {
         cache.unavailable_nodes.push_back(node);
         cache.avoid_detaching_my_domain = false;
@@ -645,9 +647,6 @@ WeightedCopySetSelector::select(copyset_size_t extras,
                                 RNG& rng,
                                 bool retry) const {
   NodeAvailabilityCache& cache = prepareCachedNodeAvailability();
-  // Need to make a copy in case we'll detach local domain - don't want to
-  // cache that.
-  AdjustedHierarchy hierarchy = cache.adjusted_hierarchy.value();
 
   bool biased = false;
   copyset_chain_t copyset_chain(replication_);
@@ -706,9 +705,10 @@ WeightedCopySetSelector::select(copyset_size_t extras,
     return Result::FAILED;
   };
 
-  bool pick_local_separately = false;
-  if (locality_enabled_ && my_domain_idx_.hasValue() &&
-      !cache.avoid_detaching_my_domain) {
+  const bool pick_local_separately = locality_enabled_ &&
+      my_domain_idx_.hasValue() && !cache.avoid_detaching_my_domain;
+  if (pick_local_separately &&
+      !cache.adjusted_hierarchy_without_my_domain.hasValue()) {
     // If locality is enabled, we should maximize the probability that copyset
     // will have at least one copy from local domain, but we should still
     // strictly adhere to weights. Let's detach local domain and process it
@@ -722,10 +722,17 @@ WeightedCopySetSelector::select(copyset_size_t extras,
     // between the two approaches is that the first one sometimes picks 2 copies
     // in rack A, which forces it to sometimes pick 0 copies in rack A (so that
     // it's 1 on average, as required by weights).
-    bool wasnt_detached = hierarchy.detachDomain({my_domain_idx_.value()});
+    cache.adjusted_hierarchy_without_my_domain = cache.adjusted_hierarchy;
+    bool wasnt_detached =
+        cache.adjusted_hierarchy_without_my_domain->detachDomain(
+            {my_domain_idx_.value()});
     ld_check(wasnt_detached);
-    pick_local_separately = true;
   }
+  // The hierarchy is used in place: the only changes made to it below are
+  // blacklisting unavailable nodes, which is cached anyway.
+  AdjustedHierarchy& hierarchy = pick_local_separately
+      ? cache.adjusted_hierarchy_without_my_domain.value()
+      : cache.adjusted_hierarchy.value();
 
   while (true) {
     if (attempts >= MAX_BLACKLISTING_ITERATIONS) {
@@ -867,7 +874,7 @@ WeightedCopySetSelector::select(copyset_size_t extras,
     // Check if all selected nodes are available. If not, blacklist and retry.
     if (checkAvailabilityAndBlacklist(copyset_chain.data(),
                                       replication_,
-                                      hierarchy,
+                                      /* hierarchy */ nullptr,
                                       cache,
                                       &biased,
                                       copyset_out,
@@ -1221,7 +1228,7 @@ WeightedCopySetSelector::augment(StoreChainLink inout_copyset[],
     // Check if all selected nodes are available. If not, blacklist and retry.
     if (checkAvailabilityAndBlacklist(inout_copyset + useful_existing_copies,
                                       replication_ - useful_existing_copies,
-                                      hierarchy,
+                                      &hierarchy,
                                       cache,
                                       &biased)) {
       // Leave the existing copies at the beginning of the copyset.
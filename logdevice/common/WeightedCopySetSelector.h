@@ -224,6 +224,27 @@ class WeightedCopySetSelector : public CopySetSelector {
     std::vector<ShardID> unavailable_nodes;
     // folly::Optional is used for deferred initialization.
     folly::Optional<AdjustedHierarchy> adjusted_hierarchy;
+    // Same as adjusted_hierarchy, but with the local domain (my_domain_idx_)
+    // detached as well, for select() to pick the local copies separately.
+    // Built on first use and kept in sync with unavailable_nodes, so that
+    // select() doesn't need to copy and adjust the hierarchy for every
+    // copyset.
+    folly::Optional<AdjustedHierarchy> adjusted_hierarchy_without_my_domain;
+
+    // Detach/attach the node in both adjusted hierarchies.
+    // @return  the result of doing it in adjusted_hierarchy.
+    bool detachNode(ShardID node) {
+      if (adjusted_hierarchy_without_my_domain.hasValue()) {
+        adjusted_hierarchy_without_my_domain->detachNode(node);
+      }
+      return adjusted_hierarchy->detachNode(node);
+    }
+    bool attachNode(ShardID node) {
+      if (adjusted_hierarchy_without_my_domain.hasValue()) {
+        adjusted_hierarchy_without_my_domain->attachNode(node);
+      }
+      return adjusted_hierarchy->attachNode(node);
+    }
 
     // When locality is enabled, select() will usually detach the local domain
     // from the hierarchy and process it separately. But sometimes this leads
@@ -312,9 +333,12 @@ class WeightedCopySetSelector : public CopySetSelector {
   // initializing it if needed and re-checking the cached blacklist of nodes.
   NodeAvailabilityCache& prepareCachedNodeAvailability() const;
 
+  // Detaches the unavailable nodes of the copyset in `cache`, and in
+  // `hierarchy` if it's not null (a copy of the cached hierarchy with some
+  // adjustments of its own).
   bool checkAvailabilityAndBlacklist(const StoreChainLink copyset[],
                                      size_t copyset_size,
-                                     AdjustedHierarchy& hierarchy,
+                                     AdjustedHierarchy* hierarchy,
                                      NodeAvailabilityCache& cache,
                                      bool* out_biased,
                                      StoreChainLink* out_chain_links = nullptr,
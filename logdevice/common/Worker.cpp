@@ -13,9 +13,12 @@
 #include <unistd.h>
 
 #include <folly/Memory.h>
+#include <folly/Random.h>
+#include <folly/String.h>
 #include <folly/stats/BucketedTimeSeries.h>
 #include <sys/resource.h>
 #include <sys/time.h>
+#include <time.h>
 
 #include "logdevice/common/AbortAppendersEpochRequest.h"
 #include "logdevice/common/AllSequencers.h"
@@ -41,9 +44,13 @@
 #include "logdevice/common/IsLogEmptyRequest.h"
 #include "logdevice/common/LogIDUniqueQueue.h"
 #include "logdevice/common/LogRecoveryRequest.h"
+#include "logdevice/common/LogWorkerHandoverRequest.h"
+#include "logdevice/common/LogWorkerMigrations.h"
 #include "logdevice/common/LogsConfigApiRequest.h"
 #include "logdevice/common/LogsConfigUpdatedRequest.h"
+#include "logdevice/common/MessageArena.h"
 #include "logdevice/common/MetaDataLogWriter.h"
+#include "logdevice/common/NodeSetFinderCoalescer.h"
 #include "logdevice/common/PermissionChecker.h"
 #include "logdevice/common/PrincipalParser.h"
 #include "logdevice/common/Processor.h"
@@ -52,6 +59,7 @@
 #include "logdevice/common/ServerConfigUpdatedRequest.h"
 #include "logdevice/common/SyncSequencerRequest.h"
 #include "logdevice/common/TimeoutMap.h"
+#include "logdevice/common/TimerWheel.h"
 #include "logdevice/common/TraceLogger.h"
 #include "logdevice/common/TrimRequest.h"
 #include "logdevice/common/WriteMetaDataRecord.h"
@@ -76,11 +84,20 @@ static constexpr size_t N_APPENDER_MAP_BUCKETS = 128 * 1024;
 class WorkerImpl {
  public:
   WorkerImpl(Worker* w, const std::shared_ptr<UpdateableConfig>& config)
-      : sender_(w->getEventBase(),
+      : message_arena_(w->immutable_settings_->message_arena_kb > 0
+                           ? std::make_unique<MessageArena>(
+                                 w->immutable_settings_->message_arena_kb *
+                                 1024)
+                           : nullptr),
+        timer_wheel_(w->getEventBase()),
+        sender_(w->getEventBase(),
                 config->get()->serverConfig()->getTrafficShapingConfig(),
                 config->get()->serverConfig()->getMaxNodeIdx(),
                 w->processor_->getWorkerCount(w->worker_type_),
-                &w->processor_->clientIdxAllocator()),
+                &w->processor_->clientIdxAllocator(),
+                w->immutable_settings_->outbufs_mb_max_total > 0
+                    ? &w->processor_->outbuf_budget_
+                    : nullptr),
         commonTimeouts_(w->getEventBase(), Worker::MAX_FAST_TIMEOUTS),
         activeAppenders_(w->immutable_settings_->server ? N_APPENDER_MAP_BUCKETS
                                                         : 1),
@@ -99,10 +116,14 @@ class WorkerImpl {
             1,
             0),
 
+        nodeSetFinderCoalescer_(w->updateable_settings_),
+
         sslFetcher_(w->immutable_settings_->ssl_cert_path,
                     w->immutable_settings_->ssl_key_path,
                     w->immutable_settings_->ssl_ca_path,
-                    w->immutable_settings_->ssl_cert_refresh_interval)
+                    w->immutable_settings_->ssl_cert_refresh_interval,
+                    w->immutable_settings_->ssl_session_resumption,
+                    w->immutable_settings_->ssl_session_ticket_key_path)
 
   {
     const bool rv =
@@ -110,6 +131,11 @@ class WorkerImpl {
     ld_check(rv);
   }
 
+  // Declared first so that it outlives all messages the other members hold.
+  std::unique_ptr<MessageArena> message_arena_;
+  // Outlives the timers of the other members, so that they can be cancelled
+  // when they are destroyed.
+  TimerWheel timer_wheel_;
   ShardAuthoritativeStatusManager shardStatusManager_;
   Sender sender_;
   LogRebuildingMap runningLogRebuildings_;
@@ -141,6 +167,8 @@ class WorkerImpl {
       adaptive_store_delay_;
   LogIDUniqueQueue recoveryQueueDataLog_;
   LogIDUniqueQueue recoveryQueueMetaDataLog_;
+  // Declared before clientReadStreams_ so that it outlives the read streams.
+  NodeSetFinderCoalescer nodeSetFinderCoalescer_;
   AllClientReadStreams clientReadStreams_;
   WriteMetaDataRecordMap runningWriteMetaDataRecords_;
   AppendRequestEpochMap appendRequestEpochMap_;
@@ -168,7 +196,9 @@ Worker::Worker(Processor* processor,
                StatsHolder* stats,
                WorkerType worker_type,
                ThreadID::Type thread_type)
-    : EventLoop(makeThreadName(processor, worker_type, idx), thread_type),
+    : EventLoop(makeThreadName(processor, worker_type, idx),
+                thread_type,
+                processor->settings()->event_loop_epoll_changelist),
       processor_(processor),
       updateable_settings_(processor->updateableSettings()),
       immutable_settings_(processor->updateableSettings().get()),
@@ -321,6 +351,11 @@ const Settings& Worker::settings() {
   return *w->immutable_settings_;
 }
 
+const Settings* Worker::settingsIfOnWorker() {
+  Worker* w = onThisThread(false);
+  return w ? w->immutable_settings_.get() : nullptr;
+}
+
 void Worker::onSettingsUpdated() {
   // If SettingsUpdatedRequest are posted faster than they're processed,
   // each request will pick up multiple settings updates. This would mean
@@ -426,6 +461,18 @@ void Worker::onThreadStarted() {
     stats_->get().worker_id = idx_;
   }
 
+  if (worker_type_ == WorkerType::GENERAL &&
+      idx_.val_ < immutable_settings_->busy_poll_workers) {
+    busy_poll_spin_ = immutable_settings_->busy_poll_spin;
+  }
+
+  std::vector<int> cpus = getCpus(*immutable_settings_, worker_type_, idx_);
+  if (!cpus.empty() && bind_this_thread_to_cpus(cpus) != 0) {
+    ld_error("Failed to pin %s to CPUs %s",
+             getName().c_str(),
+             folly::join(",", cpus).c_str());
+  }
+
   // Subscribe to config updates and setting updates
   initializeSubscriptions();
 
@@ -638,6 +685,43 @@ EpochRecovery* Worker::findActiveEpochRecovery(logid_t logid) const {
   return erm;
 }
 
+EpochRecovery* Worker::findActiveEpochRecovery(logid_t logid,
+                                               epoch_t epoch) const {
+  ld_check(logid != LOGID_INVALID);
+
+  auto it = runningLogRecoveries().map.find(logid);
+  if (it == runningLogRecoveries().map.end()) {
+    err = E::NOTFOUND;
+    return nullptr;
+  }
+
+  ld_check(it->second);
+  EpochRecovery* erm = it->second->getActiveEpochRecovery(epoch);
+  if (!erm) {
+    err = E::NOTFOUND;
+  }
+  return erm;
+}
+
+EpochRecovery* Worker::findDigestingEpochRecovery(logid_t logid,
+                                                  ShardID shard,
+                                                  read_stream_id_t rsid) const {
+  ld_check(logid != LOGID_INVALID);
+
+  auto it = runningLogRecoveries().map.find(logid);
+  if (it == runningLogRecoveries().map.end()) {
+    err = E::NOTFOUND;
+    return nullptr;
+  }
+
+  ld_check(it->second);
+  EpochRecovery* erm = it->second->getDigestingEpochRecovery(shard, rsid);
+  if (!erm) {
+    err = E::NOTFOUND;
+  }
+  return erm;
+}
+
 bool Worker::requestsPending() const {
   std::vector<std::string> counts;
 #define PROCESS(x, name)                                     \
@@ -778,6 +862,7 @@ void Worker::reportLoad() {
 
     ld_spew("%s reporting load %ld", getName().c_str(), load_delta);
     processor_->reportLoad(idx_, load_delta, worker_type_);
+    maybeMigrateHotLog();
   }
 
   last_load_ = now_load;
@@ -785,6 +870,43 @@ void Worker::reportLoad() {
   load_timer_->activate(seconds(10));
 }
 
+void Worker::maybeMigrateHotLog() {
+  const double skew = processor_->getWorkerLoadSkew(idx_);
+  WORKER_STAT_SET(worker_load_skew_percent, int64_t(skew * 100));
+
+  // Counts start over for the next report.
+  decltype(AppendRequestMap::appends_per_log) appends_per_log;
+  appends_per_log.swap(runningAppends().appends_per_log);
+  const double max_skew = settings().log_worker_migration_load_skew;
+  if (max_skew <= 0 || skew <= max_skew || appends_per_log.empty()) {
+    return;
+  }
+
+  auto hottest = std::max_element(
+      appends_per_log.begin(),
+      appends_per_log.end(),
+      [](const auto& a, const auto& b) { return a.second < b.second; });
+  const logid_t log = hottest->first;
+  const worker_id_t to = processor_->selectLeastLoadedWorker();
+  if (to == idx_ ||
+      !processor_->logWorkerMigrations().begin(log, idx_, to)) {
+    return;
+  }
+
+  ld_info("%s is at %.0f%% of the mean worker load, migrating log %lu "
+          "(%lu appends since the last report) to W%d",
+          getName().c_str(),
+          skew * 100,
+          log.val_,
+          hottest->second,
+          to.val_);
+  WORKER_STAT_INCR(log_worker_migrations);
+
+  std::unique_ptr<Request> rq =
+      std::make_unique<LogWorkerHandoverRequest>(log, idx_, to);
+  processor_->postImportant(rq);
+}
+
 EventLogStateMachine* Worker::getEventLogStateMachine() {
   return event_log_.get();
 }
@@ -814,12 +936,53 @@ ClusterState* Worker::getClusterState() {
   return Worker::onThisThread()->processor_->cluster_state_.get();
 }
 
+std::vector<int> Worker::getCpus(const Settings& settings,
+                                 WorkerType type,
+                                 worker_id_t idx) {
+  const auto& cpus = settings.worker_cpus;
+  if (cpus.empty() || type != WorkerType::GENERAL) {
+    return cpus;
+  }
+  return {cpus[idx.val_ % cpus.size()]};
+}
+
+worker_id_t Worker::getGeneralWorkerForCpu(const Settings& settings,
+                                           int cpu,
+                                           int nworkers) {
+  const auto& cpus = settings.worker_cpus;
+  auto it = std::find(cpus.begin(), cpus.end(), cpu);
+  if (it == cpus.end() || it - cpus.begin() >= nworkers) {
+    return worker_id_t(-1);
+  }
+  // Workers pos, pos + n, pos + 2n, ... are pinned to cpu.
+  const int pos = it - cpus.begin();
+  const int n = cpus.size();
+  const int count = (nworkers - pos + n - 1) / n;
+  return worker_id_t(pos + n * folly::Random::rand32(count));
+}
+
+static int64_t threadCpuTimeNs() {
+  struct timespec ts;
+  int rv = clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  ld_check(rv == 0);
+  return ts.tv_sec * 1000000000l + ts.tv_nsec;
+}
+
 void Worker::onStoppedRunning(RunState prev_state) {
   Worker* w = Worker::onThisThread();
   ld_check(w);
   std::chrono::steady_clock::time_point start_time;
   start_time = w->currentlyRunningStart_;
 
+  // Extrapolate the CPU time of the runs that weren't sampled from the ones
+  // that were.
+  int64_t cpu_usec = -1;
+  if (w->currentlyRunningCpuStart_ >= 0) {
+    cpu_usec = (threadCpuTimeNs() - w->currentlyRunningCpuStart_) / 1000 *
+        static_cast<int64_t>(settings().worker_cpu_time_sample_rate);
+    w->currentlyRunningCpuStart_ = -1;
+  }
+
   setCurrentlyRunningState(RunState(), prev_state);
 
   auto end_time = w->currentlyRunningStart_;
@@ -843,6 +1006,10 @@ void Worker::onStoppedRunning(RunState prev_state) {
       ld_check(msg_type < static_cast<int>(MessageType::MAX));
       MESSAGE_TYPE_STAT_ADD(
           Worker::stats(), msg_type, message_worker_usec, usec);
+      if (cpu_usec >= 0) {
+        MESSAGE_TYPE_STAT_ADD(
+            Worker::stats(), msg_type, message_worker_cpu_usec, cpu_usec);
+      }
       HISTOGRAM_ADD(Worker::stats(), message_callback_duration[msg_type], usec);
       break;
     }
@@ -850,12 +1017,22 @@ void Worker::onStoppedRunning(RunState prev_state) {
       auto rqtype = static_cast<int>(prev_state.subtype_.request);
       ld_check(rqtype < static_cast<int>(RequestType::MAX));
       REQUEST_TYPE_STAT_ADD(Worker::stats(), rqtype, request_worker_usec, usec);
+      if (cpu_usec >= 0) {
+        REQUEST_TYPE_STAT_ADD(
+            Worker::stats(), rqtype, request_worker_cpu_usec, cpu_usec);
+      }
       HISTOGRAM_ADD(Worker::stats(), request_execution_duration[rqtype], usec);
       break;
     }
     case RunState::NONE: {
       REQUEST_TYPE_STAT_ADD(
           Worker::stats(), RequestType::INVALID, request_worker_usec, usec);
+      if (cpu_usec >= 0) {
+        REQUEST_TYPE_STAT_ADD(Worker::stats(),
+                              RequestType::INVALID,
+                              request_worker_cpu_usec,
+                              cpu_usec);
+      }
       HISTOGRAM_ADD(
           Worker::stats(),
           request_execution_duration[static_cast<int>(RequestType::INVALID)],
@@ -867,6 +1044,20 @@ void Worker::onStoppedRunning(RunState prev_state) {
 
 void Worker::onStartedRunning(RunState new_state) {
   setCurrentlyRunningState(new_state, RunState());
+
+  // Reading the thread CPU time is a system call, so only do it for one in
+  // worker_cpu_time_sample_rate runs.
+  const size_t sample_rate = settings().worker_cpu_time_sample_rate;
+  Worker* w = Worker::onThisThread(false);
+  if (w && sample_rate > 0) {
+    if (w->cpu_time_sample_countdown_ == 0 ||
+        w->cpu_time_sample_countdown_ > sample_rate) {
+      w->cpu_time_sample_countdown_ = sample_rate;
+    }
+    if (--w->cpu_time_sample_countdown_ == 0) {
+      w->currentlyRunningCpuStart_ = threadCpuTimeNs();
+    }
+  }
 }
 
 void Worker::activateIsolationTimer() {
@@ -910,6 +1101,52 @@ void Worker::setCurrentlyRunningState(RunState new_state, RunState prev_state) {
   ld_check(w->currentlyRunning_ == prev_state);
   w->currentlyRunning_ = new_state;
   w->currentlyRunningStart_ = std::chrono::steady_clock::now();
+  w->publishRunningSlot();
+}
+
+static uint32_t truncatedSteadyMs(std::chrono::steady_clock::time_point t) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             t.time_since_epoch())
+      .count();
+}
+
+void Worker::publishRunningSlot() {
+  uint64_t state = 0;
+  switch (currentlyRunning_.type_) {
+    case RunState::NONE:
+      break;
+    case RunState::REQUEST:
+      state = uint64_t(RunState::REQUEST) << 8 |
+          static_cast<uint8_t>(currentlyRunning_.subtype_.request);
+      break;
+    case RunState::MESSAGE:
+      state = uint64_t(RunState::MESSAGE) << 8 |
+          static_cast<uint8_t>(currentlyRunning_.subtype_.message);
+      break;
+  }
+  currentlyRunningSlot_.store(
+      uint64_t(truncatedSteadyMs(currentlyRunningStart_)) << 32 | state,
+      std::memory_order_relaxed);
+}
+
+std::chrono::milliseconds Worker::unpackRunningSlot(uint64_t slot,
+                                                    RunState* state_out) {
+  const uint8_t subtype = slot & 0xff;
+  switch ((slot >> 8) & 0xff) {
+    case RunState::REQUEST:
+      *state_out = RunState(static_cast<RequestType>(subtype));
+      break;
+    case RunState::MESSAGE:
+      *state_out = RunState(static_cast<MessageType>(subtype));
+      break;
+    default:
+      *state_out = RunState();
+      break;
+  }
+  // Unsigned arithmetic takes care of the wraparound of the truncated times.
+  const uint32_t start_ms = slot >> 32;
+  return std::chrono::milliseconds(
+      uint32_t(truncatedSteadyMs(std::chrono::steady_clock::now()) - start_ms));
 }
 
 std::unique_ptr<MessageDispatch> Worker::createMessageDispatch() {
@@ -947,6 +1184,10 @@ Worker::packRunState() {
       std::chrono::steady_clock::now() - w->currentlyRunningStart_);
   w->currentlyRunning_ = RunState();
   w->currentlyRunningStart_ = std::chrono::steady_clock::now();
+  w->publishRunningSlot();
+  // The CPU time of the nested runs would be counted towards the packed one,
+  // drop its sample.
+  w->currentlyRunningCpuStart_ = -1;
   return res;
 }
 
@@ -975,6 +1216,7 @@ void Worker::unpackRunState(
   ld_check(w->currentlyRunning_.type_ == RunState::Type::NONE);
   w->currentlyRunning_ = std::get<0>(s);
   w->currentlyRunningStart_ = std::chrono::steady_clock::now() - std::get<1>(s);
+  w->publishRunningSlot();
 }
 
 //
@@ -1041,6 +1283,10 @@ TimeoutMap& Worker::commonTimeouts() const {
   return impl_->commonTimeouts_;
 }
 
+TimerWheel& Worker::timerWheel() const {
+  return impl_->timer_wheel_;
+}
+
 AppenderMap& Worker::activeAppenders() const {
   return impl_->activeAppenders_;
 }
@@ -1102,6 +1348,10 @@ AllClientReadStreams& Worker::clientReadStreams() const {
   return impl_->clientReadStreams_;
 }
 
+NodeSetFinderCoalescer& Worker::nodeSetFinderCoalescer() const {
+  return impl_->nodeSetFinderCoalescer_;
+}
+
 WriteMetaDataRecordMap& Worker::runningWriteMetaDataRecords() const {
   return impl_->runningWriteMetaDataRecords_;
 }
@@ -1123,6 +1373,10 @@ SSLFetcher& Worker::sslFetcher() const {
   return impl_->sslFetcher_;
 }
 
+MessageArena* Worker::messageArena() const {
+  return impl_->message_arena_.get();
+}
+
 std::unique_ptr<SequencerBackgroundActivator>&
 Worker::sequencerBackgroundActivator() const {
   return impl_->sequencerBackgroundActivator_;
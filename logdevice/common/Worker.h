@@ -59,15 +59,16 @@ struct SocketConnectRequest;
 // Otherwise, the versions prefixed with "WORKER_LOG_STAT_" are more convenient.
 // This is a no-op if per-log configuration is not available locally which may
 // be the case in clients.
-#define LOG_STAT_ADD(stats, cluster_config, log_id, name, val)       \
-  do {                                                               \
-    const auto config_ = cluster_config;                             \
-    if (config_ && config_->logsConfig()->isLocal()) {               \
-      const auto log_path_opt_ = config_->getLogGroupPath(log_id);   \
-      if (log_path_opt_) {                                           \
-        LOG_GROUP_STAT_ADD(stats, log_path_opt_.value(), name, val); \
-      }                                                              \
-    }                                                                \
+#define LOG_STAT_ADD(stats, cluster_config, log_id, name, val)            \
+  do {                                                                    \
+    const auto stats_ = (stats);                                          \
+    if (stats_) {                                                         \
+      PerLogStats* log_stats_ =                                           \
+          stats_->get().getPerLogStats((cluster_config).get(), (log_id)); \
+      if (log_stats_) {                                                   \
+        log_stats_->name += (val);                                        \
+      }                                                                   \
+    }                                                                     \
   } while (0)
 
 #define LOG_STAT_SUB(stats, cluster_config, log_id, name, val) \
@@ -117,9 +118,11 @@ class LogRebuildingInterface;
 class LogStorageState;
 class LogsConfig;
 class LogsConfigManager;
+class MessageArena;
 class MessageDispatch;
 class MetaDataLogReader;
 class Mutator;
+class NodeSetFinderCoalescer;
 class Processor;
 class RebuildingCoordinatorInterface;
 class Request;
@@ -131,6 +134,7 @@ class ShardAuthoritativeStatusManager;
 class SocketCallback;
 class StatsHolder;
 class SyncSequencerRequestList;
+class TimerWheel;
 class TraceLogger;
 class UpdateableConfig;
 class WorkerImpl;
@@ -292,6 +296,31 @@ class Worker : public EventLoop {
 
   static ClusterState* getClusterState();
 
+  /**
+   * @return  whether this worker's event loop busy-polls (see
+   *          busy-poll-workers setting)
+   */
+  bool busyPolls() const {
+    return busy_poll_spin_.count() > 0;
+  }
+
+  /**
+   * @return  the CPUs that worker `idx` of type `type` is pinned to according
+   *          to the worker-cpus setting, empty if it isn't pinned
+   */
+  static std::vector<int> getCpus(const Settings& settings,
+                                  WorkerType type,
+                                  worker_id_t idx);
+
+  /**
+   * @return  a general worker pinned to `cpu` by the worker-cpus setting, out
+   *          of the first `nworkers` ones, picked at random if there are
+   *          several, or worker_id_t(-1) if there is none
+   */
+  static worker_id_t getGeneralWorkerForCpu(const Settings& settings,
+                                            int cpu,
+                                            int nworkers);
+
   /**
    * This is a convenience function that objects running on a Worker can
    * use to get the cluster config without getting their Worker object first.
@@ -411,6 +440,10 @@ class Worker : public EventLoop {
   // ids for this thread's event_base.
   TimeoutMap& commonTimeouts() const;
 
+  // Timing wheel that LibeventTimers of this Worker go to instead of libevent
+  // when the worker-timer-wheel setting is on. See LibeventTimer::activate().
+  TimerWheel& timerWheel() const;
+
   // Convenience function so callers of commonTimeouts().get() don't need
   // to declare a local timeval. Must only be used from the Worker's thread.
   template <typename Duration>
@@ -515,6 +548,10 @@ class Worker : public EventLoop {
 
   AllClientReadStreams& clientReadStreams() const;
 
+  // Lets the read streams of this Worker that need the historical metadata
+  // of the same log share a NodeSetFinder.
+  NodeSetFinderCoalescer& nodeSetFinderCoalescer() const;
+
   // a map of running WriteMetaDataRecord state machines, noted that we store
   // raw pointers in the map. The state machine is owned by their parent driver,
   // MetaDataLogWriter, which guarantees that it can outlive Workers and its
@@ -523,7 +560,9 @@ class Worker : public EventLoop {
 
   // For each log, contains the largest epoch number of a record that was
   // successfully appended by this Worker thread to that log. Included in
-  // subsequent append requests to prevent out-of-order LSN assignment.
+  // subsequent append requests to prevent out-of-order LSN assignment. Also
+  // caches the node running the sequencer for each log, so that appends skip
+  // the redirect hop after sequencers move.
   AppendRequestEpochMap& appendRequestEpochMap() const;
 
   // Outstanding health check requests
@@ -532,6 +571,10 @@ class Worker : public EventLoop {
   // SSL context fetcher, used to refresh certificate data
   SSLFetcher& sslFetcher() const;
 
+  // Arena for received messages, see MessageArena. nullptr if disabled by
+  // --message-arena-kb.
+  MessageArena* messageArena() const;
+
   // Sequencer background activator, only runs on one worker
   std::unique_ptr<SequencerBackgroundActivator>&
   sequencerBackgroundActivator() const;
@@ -607,6 +650,22 @@ class Worker : public EventLoop {
    */
   EpochRecovery* findActiveEpochRecovery(logid_t logid) const;
 
+  /**
+   * Like findActiveEpochRecovery(), but returns the active EpochRecovery
+   * machine for @param epoch, which may be building its digest while older
+   * epochs are recovered. Used to route digest messages.
+   */
+  EpochRecovery* findActiveEpochRecovery(logid_t logid, epoch_t epoch) const;
+
+  /**
+   * @return the active EpochRecovery machine of @param logid reading a digest
+   *         from @param shard with read stream @param rsid, nullptr if there
+   *         is none.
+   */
+  EpochRecovery* findDigestingEpochRecovery(logid_t logid,
+                                            ShardID shard,
+                                            read_stream_id_t rsid) const;
+
   /**
    * A utility method to register a new ExponentialBackoffTimer with this
    * Worker. The newly created timer is owned by this Worker and is destroyed
@@ -663,6 +722,25 @@ class Worker : public EventLoop {
   // Time when currentlyRunning_ was set
   std::chrono::steady_clock::time_point currentlyRunningStart_;
 
+  // Thread CPU time, in nanoseconds, when currentlyRunning_ was set if its
+  // CPU time is sampled (see worker_cpu_time_sample_rate setting), -1
+  // otherwise
+  int64_t currentlyRunningCpuStart_ = -1;
+
+  // Number of runs left until the next one whose CPU time is sampled
+  size_t cpu_time_sample_countdown_ = 0;
+
+  // currentlyRunning_ and currentlyRunningStart_ packed in a word that other
+  // threads can read: the RunState in the low 16 bits, the start time in
+  // milliseconds of steady_clock, truncated to 32 bits, in the high ones.
+  // WatchDogThread reads it to find runs that take too long.
+  std::atomic<uint64_t> currentlyRunningSlot_{0};
+
+  // Unpacks a value of currentlyRunningSlot_ into *state_out. Returns how
+  // long the run has been going on for.
+  static std::chrono::milliseconds unpackRunningSlot(uint64_t slot,
+                                                     RunState* state_out);
+
   // This should be called whenever the ServerConfig  has been updated.
   // Has to be called from the worker thread
   virtual void onServerConfigUpdated();
@@ -698,6 +776,15 @@ class Worker : public EventLoop {
    */
   static const Settings& settings();
 
+  /**
+   * @return the Settings of the Worker running on this thread, like
+   *         settings(), or nullptr if this isn't a Worker thread. For hot
+   *         paths that may also run elsewhere (e.g. in tests) and would
+   *         otherwise read an UpdateableSettings or Processor::settings(),
+   *         which copy a shared_ptr on every access.
+   */
+  static const Settings* settingsIfOnWorker();
+
   // This overrides EventLoop::onSettingsUpdated() but calls it first thing
   virtual void onSettingsUpdated();
 
@@ -715,6 +802,11 @@ class Worker : public EventLoop {
   // assignment
   void reportLoad();
 
+  // Called after reportLoad(). If this Worker's load is skewed by more than
+  // Settings::log_worker_migration_load_skew, migrates the log it executed the
+  // most appends for to the least loaded Worker, see LogWorkerMigrations.
+  void maybeMigrateHotLog();
+
   void disableSequencersDueIsolationTimeout();
 
   // Initializes subscriptions to config and setting updates
@@ -723,6 +815,10 @@ class Worker : public EventLoop {
   // Helper used by onStartedRunning() and onStoppedRunning()
   static void setCurrentlyRunningState(RunState new_state, RunState prev_state);
 
+  // Stores currentlyRunning_ and currentlyRunningStart_ into
+  // currentlyRunningSlot_
+  void publishRunningSlot();
+
   // Subclasses can override to create a MessageDispatch subclass during
   // initialisation
   virtual std::unique_ptr<MessageDispatch> createMessageDispatch();
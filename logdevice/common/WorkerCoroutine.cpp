@@ -0,0 +1,34 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/WorkerCoroutine.h"
+
+#include "logdevice/common/Worker.h"
+
+namespace facebook { namespace logdevice {
+
+constexpr int WorkerCoroutine::FINISHED;
+
+void WorkerCoroutine::resume() {
+  ld_check(!finished());
+  ld_check(!running_);
+  Worker* w = Worker::onThisThread(false);
+  if (coro_state_ == 0) {
+    worker_ = w;
+  }
+  // Coroutines don't migrate between workers.
+  ld_check(w == worker_);
+
+  running_ = true;
+  run();
+  running_ = false;
+  if (finished()) {
+    onFinished();
+  }
+}
+
+}} // namespace facebook::logdevice
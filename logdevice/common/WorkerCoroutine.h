@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include "logdevice/common/debug.h"
+
+namespace facebook { namespace logdevice {
+
+class Worker;
+
+/**
+ * @file WorkerCoroutine is the base of state machines that run on a Worker
+ *       and are written as one function that suspends while waiting for
+ *       events (message replies, storage task completions, timers), instead
+ *       of a callback per event that works out where the flow is from a
+ *       handful of flags.
+ *
+ *       This is a stackless coroutine in the style of Duff's device: run()
+ *       is wrapped in LD_CORO_BEGIN and LD_CORO_END, and LD_CORO_YIELD
+ *       returns from it, recording where to continue the next time resume()
+ *       is called. Resuming is a switch on an int: it needs no allocation and
+ *       never leaves the worker thread. Callbacks for the events the
+ *       coroutine waits for store what happened in members and call
+ *       resume().
+ *
+ *       Since run() returns at each suspension point, its local variables
+ *       don't survive LD_CORO_YIELD; keep all state in members. Also,
+ *       LD_CORO_YIELD must not appear inside a nested switch statement.
+ *
+ *       Example:
+ *
+ *         void run() override {
+ *           LD_CORO_BEGIN;
+ *           sendRequests();
+ *           while (replies_ < expected_) {
+ *             LD_CORO_YIELD; // onReply() bumps replies_ and resumes
+ *           }
+ *           LD_CORO_END;
+ *         }
+ */
+
+class WorkerCoroutine {
+ public:
+  virtual ~WorkerCoroutine() = default;
+
+  /**
+   * @return  whether run() reached LD_CORO_END
+   */
+  bool finished() const {
+    return coro_state_ == FINISHED;
+  }
+
+ protected:
+  /**
+   * Runs the coroutine from where it was suspended, or from the beginning
+   * the first time, until it suspends again or finishes. In the latter case,
+   * calls onFinished(), which may destroy this object. Must be called on the
+   * same Worker every time.
+   */
+  void resume();
+
+  /**
+   * The body of the coroutine. See the file comment.
+   */
+  virtual void run() = 0;
+
+  /**
+   * Called by resume() once run() has finished. The coroutine is not used
+   * after this returns, so it may destroy it.
+   */
+  virtual void onFinished() {}
+
+  static constexpr int FINISHED = -1;
+
+  // Where run() continues from: 0 before it first runs, the line number of
+  // the LD_CORO_YIELD it suspended at after that, FINISHED at the end.
+  int coro_state_ = 0;
+
+ private:
+  // Worker the coroutine runs on, set by the first resume(). nullptr if it
+  // doesn't run on a Worker, e.g. in tests.
+  Worker* worker_ = nullptr;
+
+  // True while run() executes, to catch events that resume the coroutine
+  // from inside it.
+  bool running_ = false;
+};
+
+#define LD_CORO_BEGIN    \
+  switch (coro_state_) { \
+    case 0:              \
+      do {               \
+      } while (0)
+
+#define LD_CORO_YIELD       \
+  do {                      \
+    coro_state_ = __LINE__; \
+    return;                 \
+    case __LINE__:;         \
+  } while (0)
+
+#define LD_CORO_END \
+  }                 \
+  coro_state_ = FINISHED
+
+}} // namespace facebook::logdevice
@@ -72,4 +72,30 @@ worker_id_t WorkerLoadBalancing::selectWorker() {
   return worker_id_t(coinflip < prob ? index2 : index1);
 }
 
+worker_id_t WorkerLoadBalancing::selectLeastLoadedWorker() const {
+  size_t best = 0;
+  int64_t best_load = loads_[0].val.load();
+  for (size_t i = 1; i < loads_.size(); ++i) {
+    const int64_t load = loads_[i].val.load();
+    if (load < best_load) {
+      best = i;
+      best_load = load;
+    }
+  }
+  return worker_id_t(best);
+}
+
+double WorkerLoadBalancing::getLoadSkew(worker_id_t idx) const {
+  ld_check(idx.val_ >= 0);
+  ld_check(idx.val_ < loads_.size());
+  int64_t total = 0;
+  for (const auto& load : loads_) {
+    total += load.val.load();
+  }
+  if (total <= 0) {
+    return 1;
+  }
+  return double(loads_[idx.val_].val.load()) * loads_.size() / total;
+}
+
 }} // namespace facebook::logdevice
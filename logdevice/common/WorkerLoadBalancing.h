@@ -54,6 +54,21 @@ class WorkerLoadBalancing {
    */
   worker_id_t selectWorker();
 
+  /**
+   * Returns the worker with the smallest reported load.
+   *
+   * Thread-safe.
+   */
+  worker_id_t selectLeastLoadedWorker() const;
+
+  /**
+   * Returns the load of worker idx relative to the mean load of all workers,
+   * e.g. 1.5 if it is 50% above the mean. 1 if no load was reported yet.
+   *
+   * Thread-safe.
+   */
+  double getLoadSkew(worker_id_t idx) const;
+
  private:
   struct PaddedLoad {
     std::atomic<int64_t> val{0};
@@ -14,7 +14,9 @@
 #include <folly/AtomicIntrusiveLinkedList.h>
 
 #include "logdevice/common/CopySet.h"
+#include "logdevice/common/SlabArena.h"
 #include "logdevice/common/WorkerType.h"
+#include "logdevice/common/checks.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/include/Record.h"
 
@@ -102,6 +104,12 @@ class ZeroCopiedRecord {
 
   WorkerType getDisposalWorkerType() const;
 
+  // arena that the record was placed in by createInArena(), nullptr if it was
+  // allocated on the heap
+  SlabArena* getArena() const {
+    return arena_;
+  }
+
   ZeroCopiedRecord(const ZeroCopiedRecord&) = delete;
   ZeroCopiedRecord& operator=(const ZeroCopiedRecord&) = delete;
 
@@ -119,6 +127,27 @@ class ZeroCopiedRecord {
         new Derived(std::forward<Args>(args)...), std::move(disposer));
   }
 
+  /**
+   * Like create(), but places the object in a slot of `arena` rather than on
+   * the heap, unless `arena` is nullptr. The slot is given back to the arena
+   * by ZeroCopiedRecordDisposal.
+   */
+  template <typename Derived, typename Disposer, typename... Args>
+  static std::shared_ptr<Derived>
+  createInArena(SlabArena* arena, Disposer disposer, Args&&... args) {
+    if (arena == nullptr) {
+      return create<Derived>(std::move(disposer), std::forward<Args>(args)...);
+    }
+    ld_check(sizeof(Derived) <= arena->slotSize());
+    Derived* record =
+        new (arena->allocate()) Derived(std::forward<Args>(args)...);
+    ZeroCopiedRecord* base = record;
+    // The slot is given back from a ZeroCopiedRecord pointer.
+    ld_check(static_cast<void*>(base) == static_cast<void*>(record));
+    base->arena_ = arena;
+    return std::shared_ptr<Derived>(record, std::move(disposer));
+  }
+
  protected:
   ZeroCopiedRecord();
 
@@ -142,6 +171,9 @@ class ZeroCopiedRecord {
   // references of payload are all owned by the same worker, the payload
   // should be ultimatedly freed on the same worker thread.
   std::shared_ptr<PayloadHolder> payload_holder_;
+
+ private:
+  SlabArena* arena_{nullptr};
 };
 
 class ZeroCopiedRecord::Disposer {
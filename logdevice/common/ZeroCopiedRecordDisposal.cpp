@@ -7,6 +7,12 @@
  */
 #include "ZeroCopiedRecordDisposal.h"
 
+#include <algorithm>
+#include <utility>
+
+#include <folly/small_vector.h>
+
+#include "logdevice/common/PayloadHolder.h"
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/stats/Stats.h"
@@ -14,14 +20,37 @@
 namespace facebook { namespace logdevice {
 
 ZeroCopiedRecordDisposal::ZeroCopiedRecordDisposal(Processor* processor)
-    : processor_(processor) {
+    : processor_(processor), any_worker_arena_(sizeof(ZeroCopiedRecord)) {
   ld_check(processor_ != nullptr);
   for (int i = 0; i < numOfWorkerTypes(); i++) {
-    worker_lists_[i] = std::vector<DisposalList>(
-        processor_->getWorkerCount(workerTypeByIndex(i)));
+    const int num_workers = processor_->getWorkerCount(workerTypeByIndex(i));
+    worker_lists_[i] = std::vector<DisposalList>(num_workers);
+    for (int j = 0; j < num_workers; j++) {
+      worker_arenas_[i].push_back(
+          std::make_unique<SlabArena>(sizeof(ZeroCopiedRecord)));
+    }
   }
 }
 
+SlabArena* ZeroCopiedRecordDisposal::getArena(const PayloadHolder* payload) {
+  const Settings* worker_settings = Worker::settingsIfOnWorker();
+  const bool use_arenas = worker_settings
+      ? worker_settings->zero_copied_record_slab_arenas
+      : processor_->settings()->zero_copied_record_slab_arenas;
+  if (!use_arenas) {
+    return nullptr;
+  }
+  const worker_id_t worker_id =
+      payload == nullptr ? worker_id_t(-1) : payload->getThreadAffinity();
+  if (worker_id == worker_id_t(-1)) {
+    return &any_worker_arena_;
+  }
+  const auto& arenas =
+      worker_arenas_[workerIndexByType(payload->getWorkerTypeAffinity())];
+  ld_check(worker_id.val_ >= 0 && worker_id.val_ < arenas.size());
+  return arenas[worker_id.val_].get();
+}
+
 ZeroCopiedRecordDisposal::~ZeroCopiedRecordDisposal() {
   for (int i = 0; i < numOfWorkerTypes(); i++) {
     for (auto& list : worker_lists_[i]) {
@@ -59,7 +88,9 @@ void ZeroCopiedRecordDisposal::disposeOfRecord(
 size_t ZeroCopiedRecordDisposal::drainListRecords(DisposalList* list) {
   ld_check(list != nullptr);
   size_t num_drained = 0;
-  list->sweep([&num_drained](ZeroCopiedRecord* record) {
+  // slots of records placed in arenas, given back once the list is drained
+  folly::small_vector<std::pair<SlabArena*, std::vector<void*>>, 2> freed;
+  list->sweep([&](ZeroCopiedRecord* record) {
     // record must be unlinked already
     ld_check(!record->isLinked());
 
@@ -68,8 +99,24 @@ size_t ZeroCopiedRecordDisposal::drainListRecords(DisposalList* list) {
 
     // this decreases the ref count of payload_holder_ and is likely
     // to free the payload
-    delete record;
+    SlabArena* arena = record->getArena();
+    if (arena == nullptr) {
+      delete record;
+      return;
+    }
+    record->~ZeroCopiedRecord();
+    auto it = std::find_if(freed.begin(), freed.end(), [&](const auto& kv) {
+      return kv.first == arena;
+    });
+    if (it == freed.end()) {
+      freed.emplace_back(arena, std::vector<void*>());
+      it = freed.end() - 1;
+    }
+    it->second.push_back(record);
   });
+  for (auto& kv : freed) {
+    kv.first->deallocate(kv.second);
+  }
 
   WORKER_STAT_ADD(zero_copied_records_drained, num_drained);
   return num_drained;
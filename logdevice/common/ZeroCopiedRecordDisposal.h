@@ -14,6 +14,7 @@
 
 #include <folly/AtomicIntrusiveLinkedList.h>
 
+#include "logdevice/common/SlabArena.h"
 #include "logdevice/common/ZeroCopiedRecord.h"
 #include "logdevice/common/types_internal.h"
 
@@ -27,6 +28,10 @@ namespace facebook { namespace logdevice {
  *
  *       ZeroCopiedRecordDisposal is owned by Processor shared among all
  *       workers.
+ *
+ *       It also owns a SlabArena per worker, which records whose payload is
+ *       freed by that worker can be placed in (see getArena()). Their slots
+ *       are given back in a batch each time the worker drains its records.
  */
 
 class Processor;
@@ -45,6 +50,13 @@ class ZeroCopiedRecordDisposal {
    */
   size_t drainRecords(WorkerType type, worker_id_t worker_id);
 
+  /**
+   * @return  the arena to place a record holding `payload` in, using
+   *          ZeroCopiedRecord::createInArena(); nullptr if
+   *          --zero-copied-record-slab-arenas is disabled
+   */
+  SlabArena* getArena(const PayloadHolder* payload);
+
   virtual ~ZeroCopiedRecordDisposal();
 
  private:
@@ -61,6 +73,13 @@ class ZeroCopiedRecordDisposal {
   // particular worker to destroy, we use the general worker pool only for this.
   std::atomic<size_t> next_worker_id_{0};
 
+  // per-worker arenas for records, and one for records whose payload can be
+  // freed on any worker
+  std::array<std::vector<std::unique_ptr<SlabArena>>,
+             static_cast<size_t>(WorkerType::MAX)>
+      worker_arenas_;
+  SlabArena any_worker_arena_;
+
   size_t drainListRecords(DisposalList* list);
 
   worker_id_t getCurrentWorkerId() const;
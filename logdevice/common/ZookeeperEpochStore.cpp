@@ -11,6 +11,7 @@
 
 #include <boost/filesystem.hpp>
 #include <folly/Memory.h>
+#include <folly/ScopeGuard.h>
 #include <folly/small_vector.h>
 
 #include "logdevice/common/ConstructorFailed.h"
@@ -31,6 +32,9 @@ namespace facebook { namespace logdevice {
 
 using MultiOpState = ZookeeperEpochStore::MultiOpState;
 using CreateRootsState = ZookeeperEpochStore::CreateRootsState;
+using WriteBatchState = ZookeeperEpochStore::WriteBatchState;
+
+constexpr std::chrono::milliseconds ZookeeperEpochStore::MAX_WRITE_BATCH_DELAY;
 
 ZookeeperEpochStore::ZookeeperEpochStore(
     std::string cluster_name,
@@ -371,6 +375,52 @@ class ZookeeperEpochStore::CreateRootsState {
   std::unique_ptr<MultiOpState> current_op_;
 };
 
+// State for a batch of version-conditional znode writes, typically for
+// different logs, sent as a single multi-op. See queueWrite().
+class ZookeeperEpochStore::WriteBatchState {
+ public:
+  struct Write {
+    std::unique_ptr<ZookeeperEpochStoreRequest> zrq;
+    std::string path;
+    std::string value;
+    int version;
+  };
+
+  std::vector<Write> writes;
+
+  // Runs the multi-op. If this returns 0, this instance should not be
+  // destroyed until the completion function is called.
+  int runMultiOp(ZookeeperClientBase& zkclient,
+                 void_completion_t cf,
+                 const void* data) {
+    ld_check(writes.size() > 1);
+    // `writes' must not change from here on, operations_ point into it
+    operations_.resize(writes.size());
+    stats_.resize(writes.size());
+    op_results_.clear();
+    op_results_.resize(writes.size());
+    for (size_t i = 0; i < writes.size(); ++i) {
+      zoo_set_op_init(&operations_[i],
+                      writes[i].path.c_str(),
+                      writes[i].value.data(),
+                      writes[i].value.size(),
+                      writes[i].version,
+                      &stats_[i]);
+    }
+    return zkclient.multiOp(
+        operations_.size(), operations_.data(), op_results_.data(), cf, data);
+  }
+
+  const std::vector<zoo_op_result_t>& getResults() const {
+    return op_results_;
+  }
+
+ private:
+  std::vector<zoo_op_t> operations_;
+  std::vector<struct ::Stat> stats_;
+  std::vector<zoo_op_result_t> op_results_;
+};
+
 Status ZookeeperEpochStore::provisionLogZnodes(
     std::unique_ptr<ZookeeperEpochStoreRequest>& zrq,
     const char* sequencer_znode_value,
@@ -421,14 +471,38 @@ void ZookeeperEpochStore::zkGetCF(int rc,
                                   int value_len_from_zk,
                                   const struct ::Stat* stat,
                                   const void* data) {
+  std::unique_ptr<ZookeeperEpochStoreRequest> zrq{
+      reinterpret_cast<ZookeeperEpochStoreRequest*>(const_cast<void*>(data))};
+  ld_check(zrq);
+
+  ZookeeperEpochStore* store = zrq->store_;
+  ld_check(store->reads_in_flight_.load() > 0);
+  store->reads_in_flight_--;
+  // whatever happens to these requests, writes queued by others may be
+  // waiting for this read to complete
+  SCOPE_EXIT {
+    store->maybeFlushWriteBatch();
+  };
+
+  auto waiters = store->takeReadWaiters(zrq.get(), zrq->getZnodePath());
+  onZnodeRead(std::move(zrq), rc, value_from_zk, value_len_from_zk, stat);
+  for (auto& waiter : waiters) {
+    onZnodeRead(std::move(waiter), rc, value_from_zk, value_len_from_zk, stat);
+  }
+}
+
+void ZookeeperEpochStore::onZnodeRead(
+    std::unique_ptr<ZookeeperEpochStoreRequest> zrq,
+    int rc,
+    const char* value_from_zk,
+    int value_len_from_zk,
+    const struct ::Stat* stat) {
   int rv;
   ZookeeperEpochStoreRequest::NextStep next_step;
   bool do_provision = false;
-  std::unique_ptr<ZookeeperEpochStoreRequest> zrq{
-      reinterpret_cast<ZookeeperEpochStoreRequest*>(const_cast<void*>(data))};
   ld_check(zrq);
 
-  StatsHolder* stats_holder = zrq->store_->processor_->stats_;
+  StatsHolder* stats_holder = store->processor_->stats_;
 
   const char* value_for_zrq = value_from_zk;
 
@@ -496,6 +570,8 @@ void ZookeeperEpochStore::zkGetCF(int rc,
 
     st = E::INTERNAL;
     ZookeeperEpochStore* self = const_cast<ZookeeperEpochStore*>(zrq->store_);
+    // requests from now on must see the result of this write
+    self->closeReads(zrq->getZnodePath());
     if (do_provision) {
       st = self->provisionLogZnodes(zrq, znode_value, znode_value_size);
       if (st == E::OK) {
@@ -511,6 +587,14 @@ void ZookeeperEpochStore::zkGetCF(int rc,
       // number of znode on every write to that znode. If the versions do not
       // match zkSetCf() will be called with status ZBADVERSION. This ensures
       // that if our read-modify-write of znode_path succeeds, it was atomic.
+      if (self->settings_->zk_max_batched_writes > 1) {
+        self->queueWrite(std::move(zrq),
+                         std::move(znode_path),
+                         znode_value,
+                         znode_value_size,
+                         stat->version);
+        return;
+      }
       std::shared_ptr<ZookeeperClientBase> zkclient = self->zkclient_.get();
       logid_t log_id = zrq->logid_;
       rv = zkclient->setData(znode_path.c_str(),
@@ -552,6 +636,28 @@ done:
   }
 }
 
+std::vector<std::unique_ptr<ZookeeperEpochStoreRequest>>
+ZookeeperEpochStore::takeReadWaiters(const ZookeeperEpochStoreRequest* zrq,
+                                     const std::string& path) {
+  std::vector<std::unique_ptr<ZookeeperEpochStoreRequest>> waiters;
+  std::lock_guard<std::mutex> lock(reads_mutex_);
+  auto open_it = open_reads_.find(path);
+  if (open_it != open_reads_.end() && open_it->second == zrq) {
+    open_reads_.erase(open_it);
+  }
+  auto it = read_waiters_.find(zrq);
+  if (it != read_waiters_.end()) {
+    waiters = std::move(it->second);
+    read_waiters_.erase(it);
+  }
+  return waiters;
+}
+
+void ZookeeperEpochStore::closeReads(const std::string& path) {
+  std::lock_guard<std::mutex> lock(reads_mutex_);
+  open_reads_.erase(path);
+}
+
 void ZookeeperEpochStore::zkSetCF(int rc,
                                   const struct ::Stat* /*stat*/,
                                   const void* data) {
@@ -571,6 +677,132 @@ void ZookeeperEpochStore::zkSetCF(int rc,
   }
 }
 
+void ZookeeperEpochStore::queueWrite(
+    std::unique_ptr<ZookeeperEpochStoreRequest> zrq,
+    std::string path,
+    const char* value,
+    int value_len,
+    int version) {
+  ld_check(zrq);
+  std::lock_guard<std::mutex> lock(write_batch_mutex_);
+  if (!write_batch_) {
+    write_batch_ = std::make_unique<WriteBatchState>();
+    write_batch_start_ = std::chrono::steady_clock::now();
+  }
+  write_batch_->writes.push_back(WriteBatchState::Write{
+      std::move(zrq), std::move(path), std::string(value, value_len), version});
+  // sent by maybeFlushWriteBatch() when zkGetCF() returns
+}
+
+void ZookeeperEpochStore::maybeFlushWriteBatch() {
+  std::unique_ptr<WriteBatchState> batch;
+  {
+    std::lock_guard<std::mutex> lock(write_batch_mutex_);
+    if (!write_batch_) {
+      return;
+    }
+    if (reads_in_flight_.load() > 0 &&
+        write_batch_->writes.size() < settings_->zk_max_batched_writes &&
+        std::chrono::steady_clock::now() - write_batch_start_ <
+            MAX_WRITE_BATCH_DELAY) {
+      // more writes may join the batch soon
+      return;
+    }
+    batch = std::move(write_batch_);
+  }
+  runWriteBatch(std::move(batch));
+}
+
+void ZookeeperEpochStore::runWriteBatch(
+    std::unique_ptr<WriteBatchState> batch) {
+  ld_check(batch);
+  ld_check(!batch->writes.empty());
+  std::shared_ptr<ZookeeperClientBase> zkclient = zkclient_.get();
+
+  auto fail = [&](std::unique_ptr<ZookeeperEpochStoreRequest> zrq, int rv) {
+    Status st = zkOpStatus(rv, zrq->logid_, "zoo_aset");
+    ld_check(st != E::OK);
+    if (st == E::NOTCONN || st == E::SYSLIMIT) {
+      st = E::CONNFAILED;
+    }
+    if (st != E::SHUTDOWN || !zrq->epoch_store_shutting_down_->load()) {
+      zrq->postCompletion(st);
+    }
+  };
+
+  if (batch->writes.size() == 1) {
+    auto& write = batch->writes[0];
+    int rv = zkclient->setData(write.path.c_str(),
+                               write.value.data(),
+                               write.value.size(),
+                               write.version,
+                               zkSetCF,
+                               write.zrq.get());
+    if (rv == ZOK) {
+      write.zrq.release();
+    } else {
+      fail(std::move(write.zrq), rv);
+    }
+    return;
+  }
+
+  STAT_INCR(processor_->stats_, zookeeper_epoch_store_write_batches);
+  STAT_ADD(processor_->stats_,
+           zookeeper_epoch_store_batched_writes,
+           batch->writes.size());
+  int rv = batch->runMultiOp(*zkclient, zkWriteBatchCF, batch.get());
+  if (rv == ZOK) {
+    // zkWriteBatchCF() owns the batch now
+    batch.release();
+    return;
+  }
+  for (auto& write : batch->writes) {
+    fail(std::move(write.zrq), rv);
+  }
+}
+
+void ZookeeperEpochStore::zkWriteBatchCF(int rc, const void* data) {
+  std::unique_ptr<WriteBatchState> batch{
+      reinterpret_cast<WriteBatchState*>(const_cast<void*>(data))};
+  ld_check(batch);
+  ld_check(batch->writes.size() == batch->getResults().size());
+
+  if (rc != ZOK && rc != ZBADVERSION && rc != ZNONODE) {
+    // the multi-op as a whole failed, e.g. the connection was lost
+    for (auto& write : batch->writes) {
+      zkSetCF(rc, nullptr, write.zrq.release());
+    }
+    return;
+  }
+
+  // writes that were rolled back because another write of the batch failed
+  std::unique_ptr<WriteBatchState> retry;
+  for (size_t i = 0; i < batch->writes.size(); ++i) {
+    auto& write = batch->writes[i];
+    const int op_rc = batch->getResults()[i].err;
+    if (rc != ZOK && (op_rc == ZOK || op_rc == ZRUNTIMEINCONSISTENCY)) {
+      if (!retry) {
+        retry = std::make_unique<WriteBatchState>();
+      }
+      retry->writes.push_back(std::move(write));
+      continue;
+    }
+    zkSetCF(rc == ZOK ? ZOK : op_rc, nullptr, write.zrq.release());
+  }
+
+  if (retry) {
+    ZookeeperEpochStore* store = retry->writes[0].zrq->store_;
+    STAT_ADD(store->processor_->stats_,
+             zookeeper_epoch_store_batched_writes_retried,
+             retry->writes.size());
+    for (auto& write : retry->writes) {
+      auto single = std::make_unique<WriteBatchState>();
+      single->writes.push_back(std::move(write));
+      store->runWriteBatch(std::move(single));
+    }
+  }
+}
+
 void ZookeeperEpochStore::zkLogMultiCreateCF(int rc, const void* data) {
   std::unique_ptr<MultiOpState> state{
       reinterpret_cast<MultiOpState*>(const_cast<void*>(data))};
@@ -683,7 +915,23 @@ int ZookeeperEpochStore::runRequest(
   std::string znode_path = zrq->getZnodePath();
   const logid_t logid = zrq->logid_;
 
+  const bool coalesce = settings_->zk_coalesce_reads;
+  if (coalesce) {
+    std::lock_guard<std::mutex> lock(reads_mutex_);
+    auto it = open_reads_.find(znode_path);
+    if (it != open_reads_.end()) {
+      // zkGetCF() of that read will take care of zrq
+      read_waiters_[it->second].push_back(std::move(zrq));
+      STAT_INCR(processor_->stats_, zookeeper_epoch_store_coalesced_reads);
+      return 0;
+    }
+    // Registered before issuing the read, whose completion may run on the
+    // Zookeeper client thread before getData() returns.
+    open_reads_[znode_path] = zrq.get();
+  }
+
   std::shared_ptr<ZookeeperClientBase> zkclient = zkclient_.get();
+  reads_in_flight_++;
   int rv = zkclient->getData(
       znode_path.c_str(), &ZookeeperEpochStore::zkGetCF, zrq.get());
 
@@ -692,6 +940,17 @@ int ZookeeperEpochStore::runRequest(
     zrq.release(); // now owned by Zookeeper client library
     return 0;
   }
+  reads_in_flight_--;
+  if (coalesce) {
+    // Requests that joined this read in the meantime were told it was
+    // submitted; they fail through their completion instead.
+    for (auto& waiter : takeReadWaiters(zrq.get(), znode_path)) {
+      waiter->postCompletion(
+          st == E::NOTCONN || st == E::SYSLIMIT ? E::CONNFAILED : st);
+    }
+  }
+  // this read won't complete, writes queued behind it may be due
+  maybeFlushWriteBatch();
   err = st;
   return -1;
 }
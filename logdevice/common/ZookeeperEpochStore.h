@@ -7,9 +7,13 @@
  */
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <boost/noncopyable.hpp>
 #include <folly/Optional.h>
@@ -41,6 +45,7 @@ class ZookeeperEpochStore : public EpochStore, boost::noncopyable {
  public:
   class MultiOpState;
   class CreateRootsState;
+  class WriteBatchState;
 
   /**
    * @param   cluster_name  name of LD cluster this epoch store services
@@ -128,6 +133,11 @@ class ZookeeperEpochStore : public EpochStore, boost::noncopyable {
   static void createRootZnodesCF(std::unique_ptr<CreateRootsState> state,
                                  int rc);
 
+  // a write of the current batch is flushed at the latest this long after it
+  // was queued, even if reads whose writes could join the batch are still
+  // outstanding
+  static constexpr std::chrono::milliseconds MAX_WRITE_BATCH_DELAY{2};
+
   Status zkOpStatus(int rc, logid_t logid, const char* op) const;
 
  private:
@@ -161,10 +171,37 @@ class ZookeeperEpochStore : public EpochStore, boost::noncopyable {
   // ZookeeperClientFactory to create ZookeeperClient
   ZKFactory zkFactory_;
 
+  // Number of zoo_aget() calls issued by runRequest() whose completion
+  // function hasn't run yet
+  std::atomic<size_t> reads_in_flight_{0};
+
+  // Writes of read-modify-write requests waiting to be sent together in a
+  // single multi-op, see queueWrite(). nullptr if there are none.
+  std::unique_ptr<WriteBatchState> write_batch_;
+  std::chrono::steady_clock::time_point write_batch_start_;
+  std::mutex write_batch_mutex_;
+
+  // Reads of a znode requested while a read of the same znode is in flight
+  // are coalesced with it, see runRequest(). For each znode path, the
+  // request whose read later requests can still join.
+  std::unordered_map<std::string, const ZookeeperEpochStoreRequest*>
+      open_reads_;
+  // For each request whose read is in flight, the requests that joined it.
+  std::unordered_map<const ZookeeperEpochStoreRequest*,
+                     std::vector<std::unique_ptr<ZookeeperEpochStoreRequest>>>
+      read_waiters_;
+  std::mutex reads_mutex_;
+
   /**
    * Run a zoo_aget() on a znode, optionally followed by a modify and a
    * version-conditional zoo_aset() of a new value into the same znode.
    *
+   * If zk-coalesce-reads is set and a read of the same znode is in flight,
+   * no zoo_aget() is issued: zrq is handed the result of that read when it
+   * completes. Since writes are conditional on the version read, this is
+   * safe for read-modify-writes as well. Once a write of a znode is about to
+   * be sent, later requests no longer join a read of it issued before.
+   *
    * @param  zrq   controls the path to znode, znode value (de)serialization,
    *               and whether a new value must be written back.
    *
@@ -186,6 +223,42 @@ class ZookeeperEpochStore : public EpochStore, boost::noncopyable {
    */
   static void zkSetCF(int rc, const struct ::Stat* stat, const void* data);
 
+  /**
+   * When many logs are activated at once, e.g. after a sequencer node
+   * failed, every activation reads the epoch metadata znode of its log and
+   * then writes it back with the next epoch. Reads are served by the
+   * Zookeeper server we are connected to, but every write goes through the
+   * leader and a quorum commit, which makes writes the bottleneck.
+   *
+   * Rather than calling zoo_aset() right away, zkGetCF() queues the write
+   * here. The writes queued while reads of other requests are outstanding
+   * are sent in a single zoo_amulti() of version-conditional set operations,
+   * of up to zk-max-batched-writes writes. A batch is sent once it is full,
+   * once no reads are outstanding anymore, or after MAX_WRITE_BATCH_DELAY,
+   * so an isolated activation is not delayed.
+   *
+   * @param  value  znode value to write, copied
+   */
+  void queueWrite(std::unique_ptr<ZookeeperEpochStoreRequest> zrq,
+                  std::string path,
+                  const char* value,
+                  int value_len,
+                  int version);
+
+  // Sends the current write batch if it is due, see queueWrite()
+  void maybeFlushWriteBatch();
+
+  // Sends all writes of @param batch, as a multi-op if there is more than one
+  void runWriteBatch(std::unique_ptr<WriteBatchState> batch);
+
+  /**
+   * The Zookeeper completion function for the zoo_amulti() call of a write
+   * batch. A multi-op is atomic: if one of the writes fails, e.g. because
+   * another node has just written that log's znode, none of them are
+   * applied. Those that didn't fail themselves are then retried one by one.
+   */
+  static void zkWriteBatchCF(int rc, const void* data);
+
   /**
    * The Zookeeper completion function for the zoo_amulti() call that is called
    * to create multiple znodes for a particular log. ZK client will call it on
@@ -204,6 +277,24 @@ class ZookeeperEpochStore : public EpochStore, boost::noncopyable {
                       const struct ::Stat* stat,
                       const void* data);
 
+  // Processes the result of a read for zrq: the zkGetCF() logic for one
+  // request, whether it issued the read or joined it
+  static void onZnodeRead(std::unique_ptr<ZookeeperEpochStoreRequest> zrq,
+                          int rc,
+                          const char* value,
+                          int value_len,
+                          const struct ::Stat* stat);
+
+  // Removes the requests that joined the read of @param zrq, and stops
+  // others from joining it
+  std::vector<std::unique_ptr<ZookeeperEpochStoreRequest>>
+  takeReadWaiters(const ZookeeperEpochStoreRequest* zrq,
+                  const std::string& path);
+
+  // Stops requests from joining reads of @param path that are in flight,
+  // called before writing to it
+  void closeReads(const std::string& path);
+
   /**
    * Provisions znodes for a log that a particular zrq runs on. Calls
    * zoo_amulti() which will call back into zkMultiCF() on completion.
@@ -7,13 +7,19 @@
  */
 #include "BufferedWriteDecoderImpl.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 #include <lz4.h>
 #include <zstd.h>
 
+#include <folly/Likely.h>
+#include <folly/Synchronized.h>
 #include <folly/Varint.h>
 
 #include "logdevice/common/DataRecordOwnsPayload.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/include/Err.h"
 
 namespace facebook { namespace logdevice {
 
@@ -79,8 +85,82 @@ int decodeHeader(Slice& blob,
   }
   return 0;
 }
+
+// Reads a varint from [ptr, end) and advances `ptr' past it.  The lengths of
+// individual payloads in a batch usually fit in a single byte, which is
+// handled without calling into folly::decodeVarint() and its exceptions.
+inline int decodeLength(const uint8_t*& ptr,
+                        const uint8_t* end,
+                        uint64_t* len_out) {
+  if (LIKELY(ptr < end && *ptr < 0x80)) {
+    *len_out = *ptr++;
+    return 0;
+  }
+  try {
+    folly::ByteRange range(ptr, end);
+    *len_out = folly::decodeVarint(range);
+    ptr = range.begin();
+  } catch (...) {
+    RATELIMIT_ERROR(std::chrono::seconds(1), 1, "Failed to decode varint");
+    return -1;
+  }
+  return 0;
+}
+
+// Reads the uncompressed size that compressed blobs start with.  Updates the
+// slice to point to the compressed data directly following it.
+int decodeUncompressedSize(Slice& blob, uint64_t* size_out) {
+  const uint8_t *ptr = (const uint8_t*)blob.data, *end = ptr + blob.size;
+  uint64_t uncompressed_size;
+  if (decodeLength(ptr, end, &uncompressed_size) != 0) {
+    return -1;
+  }
+
+  ld_spew("uncompressed length in header is %lu", uncompressed_size);
+  if (uncompressed_size > MAX_PAYLOAD_SIZE_INTERNAL) {
+    RATELIMIT_ERROR(std::chrono::seconds(1),
+                    1,
+                    "Compressed buffered write header says uncompressed length "
+                    "is %lu, should be at most MAX_PAYLOAD_SIZE_INTERNAL (%zu)",
+                    uncompressed_size,
+                    MAX_PAYLOAD_SIZE_INTERNAL);
+    return -1;
+  }
+
+  blob = Slice(ptr, end - ptr);
+  *size_out = uncompressed_size;
+  return 0;
+}
+
+// ZSTD dictionaries registered with registerZstdDictionary(), by ID.
+using ZstdDictionaryMap =
+    std::unordered_map<unsigned, std::shared_ptr<const ZSTD_DDict>>;
+folly::Synchronized<ZstdDictionaryMap>& zstdDictionaries() {
+  // Leaked so that decoders can still be used during static destruction.
+  static auto* dictionaries = new folly::Synchronized<ZstdDictionaryMap>();
+  return *dictionaries;
+}
 } // namespace
 
+int BufferedWriteDecoderImpl::registerZstdDictionary(
+    const std::string& dictionary) {
+  const unsigned dict_id =
+      ZSTD_getDictID_fromDict(dictionary.data(), dictionary.size());
+  if (dict_id == 0) {
+    err = E::INVALID_PARAM;
+    return -1;
+  }
+  ZSTD_DDict* ddict = ZSTD_createDDict(dictionary.data(), dictionary.size());
+  if (ddict == nullptr) {
+    err = E::INVALID_PARAM;
+    return -1;
+  }
+  std::shared_ptr<const ZSTD_DDict> ptr(
+      ddict, [](ZSTD_DDict* d) { ZSTD_freeDDict(d); });
+  (*zstdDictionaries().wlock())[dict_id] = std::move(ptr);
+  return 0;
+}
+
 int BufferedWriteDecoderImpl::decode(
     std::vector<std::unique_ptr<DataRecord>>&& records,
     std::vector<Payload>& payloads_out) {
@@ -100,6 +180,113 @@ int BufferedWriteDecoderImpl::decode(
   return rv;
 }
 
+int BufferedWriteDecoderImpl::decodeBatch(
+    std::vector<std::unique_ptr<DataRecord>>&& records,
+    std::vector<RecordView>& records_out) {
+  // First pass: parse the headers to size the decompression buffer and the
+  // output vector.  `blob' is left empty for records that failed to decode.
+  struct Batch {
+    Slice blob;
+    Compression compression;
+    uint64_t uncompressed_size;
+    size_t buf_offset;
+  };
+  std::vector<Batch> batches(records.size());
+  size_t total_uncompressed = 0;
+  size_t total_records = 0;
+  for (size_t i = 0; i < records.size(); ++i) {
+    // For the memory ownership transfer to work as intended, the records
+    // need to be DataRecordOwnsPayload under the hood.
+    ld_assert(dynamic_cast<DataRecordOwnsPayload*>(records[i].get()) !=
+              nullptr);
+    Batch& batch = batches[i];
+    Slice blob(records[i]->payload);
+    flags_t flags;
+    size_t batch_size;
+    if (decodeHeader(blob, &flags, &batch_size) != 0) {
+      continue;
+    }
+    batch.compression = (Compression)(flags & Flags::COMPRESSION_MASK);
+    switch (batch.compression) {
+      case Compression::NONE:
+        batch.uncompressed_size = blob.size;
+        break;
+      case Compression::ZSTD:
+      case Compression::LZ4:
+      case Compression::LZ4_HC:
+        if (decodeUncompressedSize(blob, &batch.uncompressed_size) != 0) {
+          continue;
+        }
+        batch.buf_offset = total_uncompressed;
+        total_uncompressed += batch.uncompressed_size;
+        break;
+      default:
+        RATELIMIT_ERROR(std::chrono::seconds(1),
+                        1,
+                        "Invalid compression flag value 0x%02x",
+                        (uint8_t)batch.compression);
+        continue;
+    }
+    batch.blob = blob;
+    // Every record takes at least one byte, don't trust the header beyond
+    // that.
+    total_records += std::min(batch_size, batch.uncompressed_size);
+  }
+
+  std::unique_ptr<uint8_t[]> buf(new uint8_t[total_uncompressed]);
+  records_out.reserve(records_out.size() + total_records);
+
+  // Second pass: decompress and split the batches.
+  std::vector<Payload> payloads;
+  int rv = 0;
+  for (size_t i = 0; i < records.size(); ++i) {
+    const Batch& batch = batches[i];
+    if (batch.blob.data == nullptr) {
+      rv = -1;
+      continue;
+    }
+    Slice data = batch.blob;
+    if (batch.compression != Compression::NONE) {
+      uint8_t* dst = buf.get() + batch.buf_offset;
+      if (decompress(
+              batch.blob, batch.compression, dst, batch.uncompressed_size) !=
+          0) {
+        rv = -1;
+        continue;
+      }
+      data = Slice(dst, batch.uncompressed_size);
+    }
+    payloads.clear();
+    if (decodeUnowned(data, payloads) != 0) {
+      rv = -1;
+      continue;
+    }
+
+    const DataRecord& record = *records[i];
+    int batch_offset = 0;
+    for (const Payload& payload : payloads) {
+      records_out.push_back(
+          RecordView{record.logid,
+                     DataRecordAttributes(record.attrs.lsn,
+                                          record.attrs.timestamp,
+                                          batch_offset++,
+                                          record.attrs.byte_offset),
+                     payload});
+    }
+    if (batch.compression == Compression::NONE) {
+      // Views point into the record's own payload.
+      pinned_data_records_.push_back(std::move(records[i]));
+    } else {
+      records[i].reset();
+    }
+  }
+
+  if (total_uncompressed > 0) {
+    pinned_buffers_.push_back(std::move(buf));
+  }
+  return rv;
+}
+
 int BufferedWriteDecoderImpl::decodeOne(std::unique_ptr<DataRecord>&& record,
                                         std::vector<Payload>& payloads_out) {
   Slice slice(record->payload);
@@ -199,15 +386,10 @@ int BufferedWriteDecoderImpl::decodeUnowned(
   const uint8_t *ptr = (const uint8_t*)slice.data, *end = ptr + slice.size;
   for (; ptr < end;) {
     uint64_t len;
-    try {
-      folly::ByteRange range(ptr, end);
-      len = folly::decodeVarint(range);
-      ptr = range.begin();
-    } catch (...) {
-      RATELIMIT_ERROR(std::chrono::seconds(1), 1, "Failed to decode varint");
+    if (decodeLength(ptr, end, &len) != 0) {
       return -1;
     }
-    if (ptr + len > end) {
+    if (len > static_cast<uint64_t>(end - ptr)) {
       RATELIMIT_ERROR(std::chrono::seconds(1),
                       1,
                       "Expected %lu more bytes based on length varint but "
@@ -227,37 +409,64 @@ int BufferedWriteDecoderImpl::decodeCompressed(
     const Slice& slice,
     const Compression compression,
     std::vector<Payload>& payloads_out) {
-  const uint8_t *ptr = (const uint8_t*)slice.data, *end = ptr + slice.size;
-
-  // Blob should start with a varint containing the uncompressed size
+  Slice blob = slice;
   uint64_t uncompressed_size;
-  try {
-    folly::ByteRange range(ptr, end);
-    uncompressed_size = folly::decodeVarint(range);
-    ptr = range.begin();
-  } catch (...) {
-    RATELIMIT_ERROR(std::chrono::seconds(1), 1, "Failed to decode varint");
+  if (decodeUncompressedSize(blob, &uncompressed_size) != 0) {
     return -1;
   }
 
-  ld_spew("uncompressed length in header is %lu", uncompressed_size);
-  if (uncompressed_size > MAX_PAYLOAD_SIZE_INTERNAL) {
-    RATELIMIT_ERROR(std::chrono::seconds(1),
-                    1,
-                    "Compressed buffered write header says uncompressed length "
-                    "is %lu, should be at most MAX_PAYLOAD_SIZE_INTERNAL (%zu)",
-                    uncompressed_size,
-                    MAX_PAYLOAD_SIZE_INTERNAL);
+  std::unique_ptr<uint8_t[]> buf(new uint8_t[uncompressed_size]);
+  if (decompress(blob, compression, buf.get(), uncompressed_size) != 0 ||
+      decodeUnowned(Slice(buf.get(), uncompressed_size), payloads_out) != 0) {
     return -1;
   }
 
+  // Decoding succeeded.  Pin the decompressed buffer.
+  pinned_buffers_.push_back(std::move(buf));
+  return 0;
+}
+
+int BufferedWriteDecoderImpl::decompress(const Slice& slice,
+                                         const Compression compression,
+                                         uint8_t* buf,
+                                         const uint64_t uncompressed_size) {
+  const uint8_t *ptr = (const uint8_t*)slice.data, *end = ptr + slice.size;
   ld_spew("decompressing blob of size %ld", end - ptr);
-  std::unique_ptr<uint8_t[]> buf(new uint8_t[uncompressed_size]);
   if (compression == Compression::ZSTD) {
-    size_t rv = ZSTD_decompress(buf.get(),         // dst
-                                uncompressed_size, // dstCapacity
-                                ptr,               // src
-                                end - ptr);        // compressedSize
+    // Batches compressed with a dictionary have its ID in the frame header.
+    const unsigned dict_id = ZSTD_getDictID_fromFrame(ptr, end - ptr);
+    size_t rv;
+    if (dict_id != 0) {
+      std::shared_ptr<const ZSTD_DDict> ddict;
+      {
+        auto dictionaries = zstdDictionaries().rlock();
+        auto it = dictionaries->find(dict_id);
+        if (it != dictionaries->end()) {
+          ddict = it->second;
+        }
+      }
+      if (!ddict) {
+        RATELIMIT_ERROR(std::chrono::seconds(1),
+                        1,
+                        "Batch is compressed with ZSTD dictionary %u, which "
+                        "is not registered",
+                        dict_id);
+        return -1;
+      }
+      static thread_local std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)>
+          dctx(ZSTD_createDCtx(), ZSTD_freeDCtx);
+      rv = ZSTD_decompress_usingDDict(dctx.get(),        // dctx
+                                      buf,               // dst
+                                      uncompressed_size, // dstCapacity
+                                      ptr,               // src
+                                      end - ptr,         // compressedSize
+                                      ddict.get());      // ddict
+    } else {
+      rv = ZSTD_decompress(buf,               // dst
+                           uncompressed_size, // dstCapacity
+                           ptr,               // src
+                           end - ptr);        // compressedSize
+    }
     if (ZSTD_isError(rv)) {
       RATELIMIT_ERROR(std::chrono::seconds(1),
                       1,
@@ -277,7 +486,7 @@ int BufferedWriteDecoderImpl::decodeCompressed(
   }
   if (compression == Compression::LZ4 || compression == Compression::LZ4_HC) {
     int rv = LZ4_decompress_safe(
-        (char*)ptr, (char*)buf.get(), end - ptr, uncompressed_size);
+        (char*)ptr, (char*)buf, end - ptr, uncompressed_size);
 
     if (rv < 0) {
       RATELIMIT_ERROR(std::chrono::seconds(1),
@@ -297,12 +506,6 @@ int BufferedWriteDecoderImpl::decodeCompressed(
     }
   }
 
-  if (decodeUnowned(Slice(buf.get(), uncompressed_size), payloads_out) != 0) {
-    return -1;
-  }
-
-  // Decoding succeeded.  Pin the decompressed buffer.
-  pinned_buffers_.push_back(std::move(buf));
   return 0;
 }
 }} // namespace facebook::logdevice
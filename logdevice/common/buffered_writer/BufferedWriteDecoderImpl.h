@@ -34,6 +34,10 @@ class BufferedWriteDecoderImpl : public BufferedWriteDecoder {
 
   int decode(std::vector<std::unique_ptr<DataRecord>>&& records,
              std::vector<Payload>& payloads_out);
+  // See BufferedWriteDecoder::decodeBatch().  Compressed batches are
+  // decompressed into a single buffer sized from their headers up front.
+  int decodeBatch(std::vector<std::unique_ptr<DataRecord>>&& records,
+                  std::vector<RecordView>& records_out);
   // Decodes a single DataRecord.  Claims ownership of the DataRecord if
   // successful.  Allowed to partially fill `payloads_out' in case of failed
   // decoding.  If necessary, caller will ensure atomicity in appending to the
@@ -59,6 +63,9 @@ class BufferedWriteDecoderImpl : public BufferedWriteDecoder {
   static int getCompression(const DataRecord& record,
                             Compression* compression_out);
 
+  // See BufferedWriteDecoder::registerZstdDictionary().
+  static int registerZstdDictionary(const std::string& dictionary);
+
  private:
   // Decodes an uncompressed blob without claiming ownership of the memory.
   int decodeUnowned(const Slice& slice, std::vector<Payload>& payloads_out);
@@ -68,6 +75,12 @@ class BufferedWriteDecoderImpl : public BufferedWriteDecoder {
   int decodeCompressed(const Slice& slice,
                        BufferedWriter::Options::Compression compression,
                        std::vector<Payload>& payloads_out);
+  // Decompresses a compressed blob (following the uncompressed size) into
+  // `buf', which must have room for exactly `uncompressed_size' bytes.
+  static int decompress(const Slice& slice,
+                        BufferedWriter::Options::Compression compression,
+                        uint8_t* buf,
+                        uint64_t uncompressed_size);
 
   // DataRecord instances we decoded and assumed ownership of from the client
   std::deque<std::unique_ptr<DataRecord>> pinned_data_records_;
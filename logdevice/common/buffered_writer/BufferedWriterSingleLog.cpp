@@ -29,6 +29,7 @@
 #include "logdevice/common/buffered_writer/BufferedWriterShard.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/stats/Stats.h"
+#include "logdevice/common/util.h"
 
 namespace facebook { namespace logdevice {
 
@@ -51,6 +52,10 @@ using batch_flags_t = BufferedWriteDecoderImpl::flags_t;
 using Compression = BufferedWriter::Options::Compression;
 using Flags = BufferedWriteDecoderImpl::Flags;
 
+// How long batches that found the queue of background threads full wait
+// before trying again.
+static constexpr std::chrono::milliseconds BG_QUEUE_RETRY_DELAY{1};
+
 BufferedWriterSingleLog::BufferedWriterSingleLog(BufferedWriterShard* parent,
                                                  logid_t log_id,
                                                  GetLogOptionsFunc get_options)
@@ -59,6 +64,10 @@ BufferedWriterSingleLog::BufferedWriterSingleLog(BufferedWriterShard* parent,
       get_log_options_(std::move(get_options)) {}
 
 BufferedWriterSingleLog::~BufferedWriterSingleLog() {
+  STAT_SUB(parent_->parent_->processor()->stats_,
+           buffered_writer_bg_queue_depth,
+           waiting_for_bg_queue_.size());
+
   for (std::unique_ptr<Batch>& batch : *batches_) {
     if (batch->state != Batch::State::FINISHED) {
       invokeCallbacks(*batch, E::SHUTDOWN, DataRecord(), NodeID());
@@ -286,7 +295,12 @@ void BufferedWriterSingleLog::sendBatch(Batch& batch) {
         (batch_flags_t(options.compression) & Flags::COMPRESSION_MASK);
 
     setBatchState(batch, Batch::State::CONSTRUCTING_BLOB);
-    construct_blob(batch, flags, checksumBits(), options.destroy_payloads);
+    construct_blob(batch,
+                   flags,
+                   checksumBits(),
+                   options.destroy_payloads,
+                   getZstdCDict(options,
+                                Worker::settings().buffered_writer_zstd_level));
   } else {
     // This is a retry, so we must have already sent it, so we can skip the
     // purgatory of READY_TO_SEND.
@@ -304,6 +318,11 @@ void BufferedWriterSingleLog::readyToSend(Batch& batch) {
   // idea of the compression ratio
   STAT_ADD(stats, buffered_writer_bytes_in, batch.payload_bytes_total);
   STAT_ADD(stats, buffered_writer_bytes_batched, batch.blob.size);
+  if (batch.uncompressed_blob_size > 0 && batch.blob.size > 0) {
+    HISTOGRAM_ADD(stats,
+                  buffered_writer_compression_ratio,
+                  batch.uncompressed_blob_size * 100 / batch.blob.size);
+  }
 
   setBatchState(batch, Batch::State::READY_TO_SEND);
 
@@ -405,6 +424,9 @@ void BufferedWriterSingleLog::quiesce() {
   if (time_trigger_timer_) {
     time_trigger_timer_->cancel();
   }
+  if (bg_queue_retry_timer_) {
+    bg_queue_retry_timer_->cancel();
+  }
 
   for (std::unique_ptr<Batch>& batch : *batches_) {
     if (batch->retry_timer) {
@@ -574,6 +596,44 @@ void BufferedWriterSingleLog::setBatchState(Batch& batch, Batch::State state) {
   parent_->setFlushable(*this, isFlushable());
 }
 
+std::shared_ptr<const ZSTD_CDict_s>
+BufferedWriterSingleLog::getZstdCDict(const BufferedWriter::LogOptions& options,
+                                      int zstd_level) {
+  if (options.compression != Compression::ZSTD || !options.zstd_dictionary) {
+    return nullptr;
+  }
+  if (options.zstd_dictionary == zstd_dictionary_ &&
+      zstd_level == zstd_cdict_level_) {
+    return zstd_cdict_;
+  }
+
+  zstd_dictionary_ = options.zstd_dictionary;
+  zstd_cdict_level_ = zstd_level;
+  zstd_cdict_.reset();
+  const std::string& dictionary = *zstd_dictionary_;
+  if (ZSTD_getDictID_fromDict(dictionary.data(), dictionary.size()) == 0) {
+    // Readers wouldn't be able to tell which dictionary to decompress with.
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    1,
+                    "ZSTD dictionary for log %lu has no dictionary ID. "
+                    "Compressing without it.",
+                    log_id_.val_);
+    return nullptr;
+  }
+  ZSTD_CDict* cdict =
+      ZSTD_createCDict(dictionary.data(), dictionary.size(), zstd_level);
+  if (cdict == nullptr) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    1,
+                    "ZSTD_createCDict() failed for log %lu. Compressing "
+                    "without a dictionary.",
+                    log_id_.val_);
+    return nullptr;
+  }
+  zstd_cdict_.reset(cdict, [](ZSTD_CDict* d) { ZSTD_freeCDict(d); });
+  return zstd_cdict_;
+}
+
 int BufferedWriterSingleLog::checksumBits() const {
   return parent_->parent_->shouldPrependChecksum()
       ? Worker::settings().checksum_bits
@@ -652,11 +712,13 @@ void BufferedWriterSingleLog::Impl::maybe_compress_blob(
     BufferedWriterSingleLog::Batch& batch,
     Compression compression,
     int checksum_bits,
-    const int zstd_level) {
+    const int zstd_level,
+    const ZSTD_CDict_s* zstd_cdict) {
   if (compression == Compression::NONE) {
     // Nothing to do.
     return;
   }
+  batch.uncompressed_blob_size = batch.blob.size;
   ld_check(compression == Compression::ZSTD ||
            compression == Compression::LZ4 ||
            compression == Compression::LZ4_HC);
@@ -689,7 +751,24 @@ void BufferedWriterSingleLog::Impl::maybe_compress_blob(
   out += folly::encodeVarint(to_compress.size, out);
 
   size_t compressed_size;
-  if (compression == Compression::ZSTD) {
+  if (compression == Compression::ZSTD && zstd_cdict != nullptr) {
+    // The dictionary ID goes into the frame header, for the decoder to find
+    // the dictionary.
+    static thread_local std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx*)>
+        cctx(ZSTD_createCCtx(), ZSTD_freeCCtx);
+    compressed_size = ZSTD_compress_usingCDict(cctx.get(),       // cctx
+                                               out,              // dst
+                                               end - out,        // dstCapacity
+                                               to_compress.data, // src
+                                               to_compress.size, // srcSize
+                                               zstd_cdict);      // cdict
+    if (ZSTD_isError(compressed_size)) {
+      ld_error("ZSTD_compress_usingCDict() failed: %s",
+               ZSTD_getErrorName(compressed_size));
+      ld_check(false);
+      return;
+    }
+  } else if (compression == Compression::ZSTD) {
     compressed_size = ZSTD_compress(out,              // dst
                                     end - out,        // dstCapacity
                                     to_compress.data, // src
@@ -733,14 +812,16 @@ void BufferedWriterSingleLog::Impl::construct_blob_long_running(
     batch_flags_t flags,
     int checksum_bits,
     bool destroy_payloads,
-    const int zstd_level) {
+    const int zstd_level,
+    const ZSTD_CDict_s* zstd_cdict) {
   ld_check(batch.state == Batch::State::CONSTRUCTING_BLOB);
 
   construct_uncompressed_blob(batch, flags, checksum_bits, destroy_payloads);
   maybe_compress_blob(batch,
                       (Compression)(flags & Flags::COMPRESSION_MASK),
                       checksum_bits,
-                      zstd_level);
+                      zstd_level,
+                      zstd_cdict);
 
   if (checksum_bits > 0) {
     // construct_uncompressed_blob() left this many bytes at the front to put
@@ -757,7 +838,8 @@ void BufferedWriterSingleLog::construct_blob(
     BufferedWriterSingleLog::Batch& batch,
     batch_flags_t flags,
     int checksum_bits,
-    bool destroy_payloads) {
+    bool destroy_payloads,
+    std::shared_ptr<const ZSTD_CDict_s> zstd_cdict) {
   ld_check(batch.state == Batch::State::CONSTRUCTING_BLOB);
 
   if (parent_->parent_->isShuttingDown()) {
@@ -774,46 +856,112 @@ void BufferedWriterSingleLog::construct_blob(
 
   if (batch.blob_bytes_total <
       Worker::settings().buffered_writer_bg_thread_bytes_threshold) {
-    Impl::construct_blob_long_running(
-        batch, flags, checksum_bits, destroy_payloads, zstd_level);
+    const auto start_time = std::chrono::steady_clock::now();
+    Impl::construct_blob_long_running(batch,
+                                      flags,
+                                      checksum_bits,
+                                      destroy_payloads,
+                                      zstd_level,
+                                      zstd_cdict.get());
+    HISTOGRAM_ADD(parent_->parent_->processor()->stats_,
+                  buffered_writer_construct_blob_latency,
+                  usec_since(start_time));
     readyToSend(batch);
-  } else {
-    ProcessorProxy* processor_proxy = parent_->parent_->processorProxy();
-    ld_spew("Enqueueing batch %lu for log %s to background thread.  Batches "
-            "outstanding for this log: %lu Background tasks: %lu",
-            batch.num,
-            toString(log_id_).c_str(),
-            batches_->size(),
-            parent_->parent_->recentNumBackground());
-
-    processor_proxy->processor()->enqueueToBackgroundBlocking(
-        [&batch,
-         flags,
-         checksum_bits,
-         destroy_payloads,
-         processor_proxy,
-         trigger = parent_->parent_->getBackgroundTaskCountHolder(),
-         thread_affinity = Worker::onThisThread()->idx_.val(),
-         zstd_level,
-         this]() mutable {
-          BufferedWriterSingleLog::Impl::construct_blob_long_running(
-              batch, flags, checksum_bits, destroy_payloads, zstd_level);
-          std::unique_ptr<Request> request =
-              std::make_unique<ContinueBlobSendRequest>(
-                  this, batch, thread_affinity);
-          // Since this runs on the background thread, be careful not to access
-          // non-constant fields of "this", unless you know what you're doing.
-          ld_spew("Done constructing batch %lu for log %s, posting back to "
-                  "worker.  Background tasks: %lu",
-                  batch.num,
-                  toString(log_id_).c_str(),
-                  parent_->parent_->recentNumBackground());
-
-          int rc = processor_proxy->postWithRetrying(request);
-          if (rc != 0) {
-            ld_error("Processor::postWithRetrying() failed: %d", rc);
-          }
-        });
+    return;
+  }
+
+  ld_spew("Enqueueing batch %lu for log %s to background thread.  Batches "
+          "outstanding for this log: %lu Background tasks: %lu",
+          batch.num,
+          toString(log_id_).c_str(),
+          batches_->size(),
+          parent_->parent_->recentNumBackground());
+
+  BackgroundBlob blob{&batch,
+                      flags,
+                      checksum_bits,
+                      destroy_payloads,
+                      zstd_level,
+                      std::move(zstd_cdict)};
+  STAT_INCR(parent_->parent_->processor()->stats_,
+            buffered_writer_bg_queue_depth);
+  // Batches that wait for room in the queue go out in order.
+  if (!waiting_for_bg_queue_.empty() || !enqueueToBackground(blob)) {
+    STAT_INCR(parent_->parent_->processor()->stats_,
+              buffered_writer_bg_queue_full);
+    waiting_for_bg_queue_.push_back(std::move(blob));
+    if (!bg_queue_retry_timer_) {
+      bg_queue_retry_timer_ =
+          std::make_unique<Timer>([this] { retryEnqueueToBackground(); });
+    }
+    if (!bg_queue_retry_timer_->isActive()) {
+      bg_queue_retry_timer_->activate(BG_QUEUE_RETRY_DELAY);
+    }
+  }
+}
+
+bool BufferedWriterSingleLog::enqueueToBackground(const BackgroundBlob& blob) {
+  ProcessorProxy* processor_proxy = parent_->parent_->processorProxy();
+  return processor_proxy->processor()->enqueueToBackground(
+      [batch = blob.batch,
+       flags = blob.flags,
+       checksum_bits = blob.checksum_bits,
+       destroy_payloads = blob.destroy_payloads,
+       processor_proxy,
+       trigger = parent_->parent_->getBackgroundTaskCountHolder(),
+       thread_affinity = Worker::onThisThread()->idx_.val(),
+       zstd_level = blob.zstd_level,
+       zstd_cdict = blob.zstd_cdict,
+       enqueue_time = std::chrono::steady_clock::now(),
+       this]() mutable {
+        StatsHolder* stats = processor_proxy->processor()->stats_;
+        STAT_DECR(stats, buffered_writer_bg_queue_depth);
+        HISTOGRAM_ADD(
+            stats, buffered_writer_bg_queue_latency, usec_since(enqueue_time));
+        const auto start_time = std::chrono::steady_clock::now();
+        BufferedWriterSingleLog::Impl::construct_blob_long_running(
+            *batch,
+            flags,
+            checksum_bits,
+            destroy_payloads,
+            zstd_level,
+            zstd_cdict.get());
+        HISTOGRAM_ADD(stats,
+                      buffered_writer_construct_blob_latency,
+                      usec_since(start_time));
+        std::unique_ptr<Request> request =
+            std::make_unique<ContinueBlobSendRequest>(
+                this, *batch, thread_affinity);
+        // Since this runs on the background thread, be careful not to access
+        // non-constant fields of "this", unless you know what you're doing.
+        ld_spew("Done constructing batch %lu for log %s, posting back to "
+                "worker.  Background tasks: %lu",
+                batch->num,
+                toString(log_id_).c_str(),
+                parent_->parent_->recentNumBackground());
+
+        int rc = processor_proxy->postWithRetrying(request);
+        if (rc != 0) {
+          ld_error("Processor::postWithRetrying() failed: %d", rc);
+        }
+      });
+}
+
+void BufferedWriterSingleLog::retryEnqueueToBackground() {
+  StatsHolder* stats = parent_->parent_->processor()->stats_;
+  while (!waiting_for_bg_queue_.empty()) {
+    if (parent_->parent_->isShuttingDown()) {
+      // Our destructor will call callbacks with E::SHUTDOWN.
+      STAT_SUB(
+          stats, buffered_writer_bg_queue_depth, waiting_for_bg_queue_.size());
+      waiting_for_bg_queue_.clear();
+      return;
+    }
+    if (!enqueueToBackground(waiting_for_bg_queue_.front())) {
+      bg_queue_retry_timer_->activate(BG_QUEUE_RETRY_DELAY);
+      return;
+    }
+    waiting_for_bg_queue_.pop_front();
   }
 }
 
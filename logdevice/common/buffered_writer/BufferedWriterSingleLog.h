@@ -26,6 +26,7 @@
 #include "logdevice/include/BufferedWriter.h"
 
 class ProcessorTestProxy;
+struct ZSTD_CDict_s;
 
 namespace facebook { namespace logdevice {
 
@@ -115,6 +116,9 @@ class BufferedWriterSingleLog {
     Slice blob;
     std::unique_ptr<uint8_t[]> blob_buf;
     size_t blob_header_size = 0;
+    // Size of the blob before compression, if maybe_compress_blob() tried to
+    // compress it; 0 otherwise.
+    size_t uncompressed_blob_size = 0;
 
     // How many times we've retried sending this batch
     int retry_count = 0;
@@ -161,15 +165,18 @@ class BufferedWriterSingleLog {
                                 BufferedWriteDecoderImpl::flags_t flags,
                                 int checksum_bits,
                                 bool destroy_payloads,
-                                int zstd_level);
+                                int zstd_level,
+                                const ZSTD_CDict_s* zstd_cdict = nullptr);
 
     // Possibly long running.  Checks conditions for compression, and if
-    // satisfied, compresses.
+    // satisfied, compresses.  If `zstd_cdict' is not null, ZSTD compression
+    // uses that dictionary (and the level it was created with).
     static void
     maybe_compress_blob(Batch& batch,
                         BufferedWriter::Options::Compression compression,
                         int checksum_bits,
-                        int zstd_level);
+                        int zstd_level,
+                        const ZSTD_CDict_s* zstd_cdict = nullptr);
     // Constructs a blob from a batch.  Copies the data, so is therefore
     // potentially long running.
     static void
@@ -268,7 +275,33 @@ class BufferedWriterSingleLog {
   void construct_blob(Batch& batch,
                       BufferedWriteDecoderImpl::flags_t flags,
                       int checksum_bits,
-                      bool destroy_payloads);
+                      bool destroy_payloads,
+                      std::shared_ptr<const ZSTD_CDict_s> zstd_cdict);
+
+  // A batch whose blob is to be constructed on a background thread, with the
+  // arguments to construct it with.
+  struct BackgroundBlob {
+    Batch* batch;
+    BufferedWriteDecoderImpl::flags_t flags;
+    int checksum_bits;
+    bool destroy_payloads;
+    int zstd_level;
+    std::shared_ptr<const ZSTD_CDict_s> zstd_cdict;
+  };
+
+  // Tries to hand `blob' to the Processor's background threads.  Returns
+  // false if their queue is full.
+  bool enqueueToBackground(const BackgroundBlob& blob);
+
+  // Called by bg_queue_retry_timer_.  Hands the batches in
+  // waiting_for_bg_queue_ to the background threads, as long as there is room
+  // in their queue.
+  void retryEnqueueToBackground();
+
+  // Returns the ZSTD dictionary of `options', loaded for compression at
+  // `zstd_level', or nullptr if batches are not compressed with a dictionary.
+  std::shared_ptr<const ZSTD_CDict_s>
+  getZstdCDict(const BufferedWriter::LogOptions& options, int zstd_level);
 
   // Used only in constructor.
   std::vector<Batch*> getVectorWithCapacity(size_t capacity);
@@ -279,6 +312,21 @@ class BufferedWriterSingleLog {
   CompactableContainer<std::deque<std::unique_ptr<Batch>>> batches_;
   std::unique_ptr<Timer> time_trigger_timer_;
 
+  // Batches to be sent to the background threads that found their queue
+  // full, in order.  They wait here rather than being constructed on the
+  // worker, which would stall all other logs of the worker under load.  They
+  // keep counting against the memory limit, so writers get E::NOBUFS once
+  // too many have piled up.
+  std::deque<BackgroundBlob> waiting_for_bg_queue_;
+  std::unique_ptr<Timer> bg_queue_retry_timer_;
+
+  // Cache for getZstdCDict(): the dictionary and level zstd_cdict_ was
+  // created from.  Loading a dictionary is costly, so it is only done when
+  // they change.
+  std::shared_ptr<const std::string> zstd_dictionary_;
+  int zstd_cdict_level_ = 0;
+  std::shared_ptr<const ZSTD_CDict_s> zstd_cdict_;
+
   // In the ONE_AT_A_TIME mode, this is a buffer for appends that came in
   // while a batch was already inflight.  When that batch finishes, we can
   // create a batch for them.
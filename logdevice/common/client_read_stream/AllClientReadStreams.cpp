@@ -12,13 +12,23 @@
 #include "logdevice/common/AdminCommandTable.h"
 #include "logdevice/common/DataRecordOwnsPayload.h"
 #include "logdevice/common/Sender.h"
+#include "logdevice/common/Socket.h"
+#include "logdevice/common/Timer.h"
 #include "logdevice/common/Worker.h"
+#include "logdevice/common/protocol/STARTS_Message.h"
+#include "logdevice/common/protocol/START_Message.h"
 #include "logdevice/common/protocol/STOP_Message.h"
+#include "logdevice/common/protocol/WINDOWS_Message.h"
 #include "logdevice/common/request_util.h"
+#include "logdevice/common/stats/Stats.h"
 #include "logdevice/include/Err.h"
 
 namespace facebook { namespace logdevice {
 
+AllClientReadStreams::AllClientReadStreams() = default;
+
+AllClientReadStreams::~AllClientReadStreams() = default;
+
 void AllClientReadStreams::insertAndStart(
     std::unique_ptr<ClientReadStream>&& stream) {
   read_stream_id_t id = stream->getID();
@@ -199,4 +209,191 @@ AllClientReadStreams::getAllReadStreamsDebugInfo(bool pretty,
   return table.toString(json);
 }
 
+bool AllClientReadStreams::canBatch(NodeID to, uint16_t min_proto) {
+  // The protocol of the connection must be known to support the batch
+  // message. Messages sent before the handshake completes aren't batched.
+  Socket* socket = Worker::onThisThread()->sender().findServerSocket(
+      to.index(), Sender::readStreamsConnection());
+  return socket != nullptr && socket->isHandshaken() &&
+      socket->getProto() >= min_proto;
+}
+
+bool AllClientReadStreams::enqueueStartForBatch(
+    std::unique_ptr<START_Message>& msg,
+    NodeID to,
+    SocketCallback* onclose) {
+  Worker* w = Worker::onThisThread();
+  const size_t max_batch_size = Worker::settings().start_batch_size;
+  if (max_batch_size <= 1 ||
+      !canBatch(to, Compatibility::STARTS_MESSAGE_SUPPORT)) {
+    return false;
+  }
+  if (onclose &&
+      w->sender().registerOnSocketClosed(
+          Address(to), *onclose, Sender::readStreamsConnection()) != 0) {
+    return false;
+  }
+
+  auto& batch = start_batches_[to.index()];
+  batch.push_back(std::move(msg));
+  if (batch.size() >= max_batch_size) {
+    flushStartBatch(to.index());
+    return true;
+  }
+
+  if (!start_flush_timer_) {
+    start_flush_timer_ =
+        std::make_unique<Timer>([this] { flushStartBatches(); });
+  }
+  if (!start_flush_timer_->isActive()) {
+    start_flush_timer_->activate(std::chrono::microseconds(0));
+  }
+  return true;
+}
+
+void AllClientReadStreams::flushStartBatch(node_index_t node) {
+  auto it = start_batches_.find(node);
+  if (it == start_batches_.end()) {
+    return;
+  }
+  auto starts = std::move(it->second);
+  start_batches_.erase(it);
+  sendStartBatch(node, std::move(starts));
+}
+
+void AllClientReadStreams::flushStartBatches() {
+  auto batches = std::move(start_batches_);
+  start_batches_.clear();
+  for (auto& kv : batches) {
+    sendStartBatch(kv.first, std::move(kv.second));
+  }
+}
+
+void AllClientReadStreams::sendStartBatch(
+    node_index_t node,
+    std::vector<std::unique_ptr<START_Message>> starts) {
+  ld_check(!starts.empty());
+  Worker* w = Worker::onThisThread();
+  std::unique_ptr<Message> msg;
+  if (starts.size() == 1) {
+    // Nothing to batch the START with, send it as is.
+    msg = std::move(starts.front());
+  } else {
+    msg = std::make_unique<STARTS_Message>(std::move(starts));
+  }
+  int rv = w->sender().sendMessage(std::move(msg), NodeID(node));
+  if (rv != 0) {
+    // The message wasn't sent, so the messaging layer won't call onSent().
+    // Report the error to the read streams the same way as if sending had
+    // failed later.
+    w->message_dispatch_->onSent(
+        *msg, err, Address(NodeID(node)), SteadyTimestamp::now());
+  }
+}
+
+bool AllClientReadStreams::enqueueWindowForBatch(
+    const WINDOW_Header& header,
+    NodeID to,
+    std::chrono::microseconds max_delay) {
+  if (!canBatch(to, Compatibility::WINDOWS_MESSAGE_SUPPORT)) {
+    return false;
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  const auto deadline = now + max_delay;
+  auto insert = window_batches_.emplace(to.index(), WindowBatch());
+  WindowBatch& batch = insert.first->second;
+  if (insert.second || deadline < batch.deadline) {
+    batch.deadline = deadline;
+  }
+  batch.windows[std::make_pair(header.read_stream_id.val_, header.shard)] =
+      header;
+
+  if (!window_flush_timer_) {
+    window_flush_timer_ =
+        std::make_unique<Timer>([this] { flushDueWindowBatches(); });
+  }
+  if (!window_flush_timer_->isActive() || deadline < window_flush_time_) {
+    window_flush_time_ = deadline;
+    window_flush_timer_->activate(
+        std::chrono::duration_cast<std::chrono::microseconds>(deadline - now));
+  }
+  return true;
+}
+
+void AllClientReadStreams::flushWindowBatch(node_index_t node) {
+  auto it = window_batches_.find(node);
+  if (it == window_batches_.end()) {
+    return;
+  }
+  WindowBatch batch = std::move(it->second);
+  window_batches_.erase(it);
+  sendWindowBatch(node, std::move(batch));
+}
+
+void AllClientReadStreams::flushDueWindowBatches() {
+  const auto now = std::chrono::steady_clock::now();
+  std::vector<node_index_t> due;
+  auto next_deadline = std::chrono::steady_clock::time_point::max();
+  for (const auto& kv : window_batches_) {
+    if (kv.second.deadline <= now) {
+      due.push_back(kv.first);
+    } else {
+      next_deadline = std::min(next_deadline, kv.second.deadline);
+    }
+  }
+  for (node_index_t node : due) {
+    flushWindowBatch(node);
+  }
+  if (!window_batches_.empty() && !window_flush_timer_->isActive()) {
+    window_flush_time_ = next_deadline;
+    window_flush_timer_->activate(
+        std::chrono::duration_cast<std::chrono::microseconds>(next_deadline -
+                                                              now));
+  }
+}
+
+void AllClientReadStreams::sendWindowBatch(node_index_t node,
+                                           WindowBatch batch) {
+  ld_check(!batch.windows.empty());
+  // The STARTs of these read streams must reach the node first.
+  flushStartBatch(node);
+
+  Worker* w = Worker::onThisThread();
+  std::unique_ptr<Message> msg;
+  if (batch.windows.size() == 1) {
+    // Nothing to batch the update with, send it as is.
+    msg = std::make_unique<WINDOW_Message>(batch.windows.begin()->second);
+  } else {
+    std::vector<WINDOW_Header> windows;
+    windows.reserve(batch.windows.size());
+    for (const auto& kv : batch.windows) {
+      windows.push_back(kv.second);
+    }
+    msg = std::make_unique<WINDOWS_Message>(std::move(windows));
+  }
+  int rv = w->sender().sendMessage(std::move(msg), NodeID(node));
+  if (rv != 0) {
+    for (const auto& kv : batch.windows) {
+      onWindowSendFailed(
+          kv.second.read_stream_id, ShardID(node, kv.second.shard));
+    }
+    return;
+  }
+  WORKER_STAT_INCR(client.window_messages_sent);
+}
+
+void AllClientReadStreams::onWindowSendFailed(read_stream_id_t id,
+                                              ShardID shard) {
+  auto ptr = getStream(id);
+  if (ptr) {
+    ptr->onWindowSendFailed(shard);
+  }
+}
+
+void AllClientReadStreams::flushBatches(node_index_t node) {
+  flushStartBatch(node);
+  flushWindowBatch(node);
+}
+
 }} // namespace facebook::logdevice
@@ -7,14 +7,20 @@
  */
 #pragma once
 
+#include <chrono>
+#include <map>
 #include <memory>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "logdevice/common/AdminCommandTable-fwd.h"
 #include "logdevice/common/ShardAuthoritativeStatusMap.h"
+#include "logdevice/common/checks.h"
 #include "logdevice/common/client_read_stream/ClientReadStream.h"
 #include "logdevice/common/protocol/GAP_Message.h"
 #include "logdevice/common/protocol/STARTED_Message.h"
+#include "logdevice/common/protocol/WINDOW_Message.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/include/types.h"
 
@@ -30,9 +36,15 @@ namespace facebook { namespace logdevice {
 
 struct DataRecordOwnsPayload;
 class Processor;
+class SocketCallback;
+class START_Message;
+class Timer;
 
 class AllClientReadStreams : public ShardAuthoritativeStatusSubscriber {
  public:
+  AllClientReadStreams();
+  ~AllClientReadStreams() override;
+
   /**
    * Claims ownership of the ClientReadStream, and kicks off reading by
    * calling start() on it.
@@ -123,7 +135,113 @@ class AllClientReadStreams : public ShardAuthoritativeStatusSubscriber {
    */
   void forEachStream(std::function<void(ClientReadStream& read_stream)> cb);
 
+  /**
+   * Called by read streams when the payload bytes held in their buffers
+   * change.
+   */
+  void onBufferedBytesChanged(int64_t delta) {
+    ld_check(delta >= 0 || buffered_bytes_ >= static_cast<size_t>(-delta));
+    buffered_bytes_ += delta;
+  }
+
+  /**
+   * @return Total payload size of the records buffered by all read streams on
+   *         this worker.
+   */
+  size_t getBufferedBytes() const {
+    return buffered_bytes_;
+  }
+
+  /**
+   * Queues a START that a read stream sends to `to`, to be sent in a STARTS
+   * message together with the other STARTs that read streams of this worker
+   * send to the same node. Batches are sent at the end of the current event
+   * loop iteration, or once they hold Settings::start_batch_size STARTs.
+   *
+   * `onclose`, if not null, is registered on the socket to `to` right away, as
+   * if it had been passed to Sender::sendMessage().
+   *
+   * @return true if `msg` was queued and moved from. The outcome of sending
+   *         it is reported through START_Message::onSent(), as usual. false if
+   *         batching is disabled or the connection to `to` is not handshaken
+   *         with a protocol that supports STARTS messages, in which case the
+   *         caller should send the START_Message itself.
+   */
+  bool enqueueStartForBatch(std::unique_ptr<START_Message>& msg,
+                            NodeID to,
+                            SocketCallback* onclose);
+
+  /**
+   * Queues a WINDOW update that a read stream sends to `to`, to be sent in a
+   * WINDOWS message together with the other WINDOW updates that read streams
+   * of this worker send to the same node. A newer update of the same read
+   * stream replaces a queued one. The batch of a node is sent once the
+   * smallest `max_delay` of its updates has passed, after the node's queued
+   * STARTs.
+   *
+   * @return true if the update was queued. If sending it fails, the read
+   *         stream is told through ClientReadStream::onWindowSendFailed().
+   *         false if the connection to `to` is not handshaken with a protocol
+   *         that supports WINDOWS messages, in which case the caller should
+   *         send a WINDOW_Message itself.
+   */
+  bool enqueueWindowForBatch(const WINDOW_Header& header,
+                             NodeID to,
+                             std::chrono::microseconds max_delay);
+
+  /**
+   * Called when a WINDOWS message could not be sent.
+   */
+  void onWindowSendFailed(read_stream_id_t id, ShardID shard);
+
+  /**
+   * Sends the STARTs and WINDOW updates queued for `node` right away. Called
+   * before sending other messages for read streams to the node, so that they
+   * don't overtake the queued ones.
+   */
+  void flushBatches(node_index_t node);
+
  private:
+  struct WindowBatch {
+    // Keyed by read stream and shard, so that a newer update of a read
+    // stream replaces the queued one.
+    std::map<std::pair<uint64_t, shard_index_t>, WINDOW_Header> windows;
+    std::chrono::steady_clock::time_point deadline;
+  };
+
+  // @return true if messages to `to` can be batched in messages that need
+  //         protocol `min_proto`.
+  bool canBatch(NodeID to, uint16_t min_proto);
+
+  void flushStartBatch(node_index_t node);
+  // Sends all the batches accumulated in start_batches_.
+  void flushStartBatches();
+  void sendStartBatch(node_index_t node,
+                      std::vector<std::unique_ptr<START_Message>> starts);
+
+  void flushWindowBatch(node_index_t node);
+  // Sends the batches of window_batches_ whose deadline has passed, and
+  // schedules window_flush_timer_ for the next one.
+  void flushDueWindowBatches();
+  void sendWindowBatch(node_index_t node, WindowBatch batch);
+
+  // STARTs queued by enqueueStartForBatch(), by node. Declared before
+  // streams_ because read streams flush them when they're destroyed.
+  std::unordered_map<node_index_t, std::vector<std::unique_ptr<START_Message>>>
+      start_batches_;
+  // Zero-delay timer flushing start_batches_.
+  std::unique_ptr<Timer> start_flush_timer_;
+
+  // WINDOW updates queued by enqueueWindowForBatch(), by node.
+  std::unordered_map<node_index_t, WindowBatch> window_batches_;
+  // Fires at the earliest deadline of window_batches_.
+  std::unique_ptr<Timer> window_flush_timer_;
+  std::chrono::steady_clock::time_point window_flush_time_;
+
+  // @see getBufferedBytes(). Declared before streams_ because read streams
+  // update it when they're destroyed.
+  size_t buffered_bytes_ = 0;
+
   // Actual container
   std::unordered_map<read_stream_id_t,
                      std::unique_ptr<ClientReadStream>,
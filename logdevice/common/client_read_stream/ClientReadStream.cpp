@@ -16,6 +16,7 @@
 
 #include <folly/CppAttributes.h>
 #include <folly/Memory.h>
+#include <folly/Random.h>
 #include <folly/String.h>
 
 #include "logdevice/common/AdminCommandTable.h"
@@ -39,6 +40,7 @@
 #include "logdevice/common/client_read_stream/ClientReadStreamBuffer.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamBufferFactory.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamConnectionHealth.h"
+#include "logdevice/common/client_read_stream/ClientReadStreamReconnectLimiter.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamScd.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamTracer.h"
 #include "logdevice/common/configuration/Configuration.h"
@@ -481,7 +483,9 @@ void ClientReadStream::ensureSkipEpoch0(
   disposeIfDone();
 }
 
-void ClientReadStream::sendStart(ShardID shard_id, SenderState& state) {
+void ClientReadStream::sendStart(ShardID shard_id,
+                                 SenderState& state,
+                                 lsn_t start_lsn) {
   ld_check(!done());
   ld_check(last_epoch_with_metadata_ != EPOCH_INVALID);
 
@@ -491,7 +495,9 @@ void ClientReadStream::sendStart(ShardID shard_id, SenderState& state) {
   resetGapParametersForSender(state);
 
   START_Header header;
-  header.start_lsn = next_lsn_to_deliver_;
+  header.start_lsn = std::max(
+      next_lsn_to_deliver_,
+      std::min(start_lsn, std::min(server_window_.high, until_lsn_)));
   header.until_lsn = until_lsn_;
   header.window_high = server_window_.high;
   header.flags = additional_start_flags_;
@@ -1007,6 +1013,7 @@ void ClientReadStream::onDataRecord(
                                       readSetSize());
 
     if (!rstate->record) {
+      onBufferedBytesChanged(record->payload.size());
       rstate->record = std::move(record);
       // Updating info reg. buffer usage.
       bytes_buffered_ += rstate->record->payload.size();
@@ -1307,6 +1314,15 @@ void ClientReadStream::updateGapState(lsn_t next_lsn,
  */
 void ClientReadStream::findGapsAndRecords(bool grace_period_expired,
                                           bool redelivery_in_progress) {
+  if (!record_batch_.empty()) {
+    // The application left part of the last batch for redelivery. Nothing
+    // else can be delivered before it is consumed.
+    if ((redelivery_timer_ != nullptr && redelivery_timer_->isActive()) ||
+        flushRecordBatch() != 0) {
+      return;
+    }
+  }
+
   if (done()) {
     // The stream may be in an inconsistent state so better to return early.
     return;
@@ -1427,6 +1443,12 @@ void ClientReadStream::findGapsAndRecords(bool grace_period_expired,
     }
   }
 
+  // Hand over what was batched so far rather than wait for more records,
+  // unless a failed delivery is waiting on the redelivery timer.
+  if (redelivery_timer_ == nullptr || !redelivery_timer_->isActive()) {
+    flushRecordBatch();
+  }
+
   if (scd_->isActive()) {
     scd_->checkNeedsFailoverToAllSendAll();
   }
@@ -1827,11 +1849,12 @@ void ClientReadStream::onReaderProgress() {
     return;
   }
 
+  const auto window_delay = windowUpdateDelay();
   updateServerWindow();
   scd_->onWindowSlid(server_window_.high, filter_version_);
 
   for (auto& it : storage_set_states_) {
-    sendWindowMessage(it.second);
+    sendWindowMessage(it.second, window_delay);
   }
 
   window_update_pending_ = false;
@@ -1950,7 +1973,7 @@ void ClientReadStream::onSettingsUpdated() {
   if (current_metadata_) {
     findGapsAndRecords();
     if (done()) {
-      deps_->dispose();
+      disposeIfDone();
       return;
     }
   }
@@ -2950,6 +2973,7 @@ int ClientReadStream::handleRecord(RecordState* rstate,
     }
   } else if (!bridge ||
              ship_pseudorecords_) { // don't deliver bridges by default
+    const size_t payload_size = rstate->record->payload.size();
     rv = deliverRecord(rstate->record);
     if (rv != 0) {
       // The record could not be delivered at this time.  Assert that we still
@@ -2957,6 +2981,10 @@ int ClientReadStream::handleRecord(RecordState* rstate,
       ld_check(rstate->record || rstate->filtered_out);
       return rv;
     }
+    if (!rstate->record) {
+      // The record was moved out of the buffer.
+      onBufferedBytesChanged(-static_cast<int64_t>(payload_size));
+    }
   }
 
   if (bridge) {
@@ -2966,7 +2994,7 @@ int ClientReadStream::handleRecord(RecordState* rstate,
 
   // Free the record and advance to next LSN.
   ++next_lsn_to_deliver_;
-  rstate->reset();
+  resetRecordState(*rstate);
   buffer_->popFront();
   buffer_->advanceBufferHead();
   ld_check(next_lsn_to_deliver_ == buffer_->getBufferHead());
@@ -3114,6 +3142,28 @@ int ClientReadStream::deliverRecord(
   }
 
   bool bridge_record = (record->flags_ & RECORD_Header::BRIDGE);
+  if (!reader_ && !bridge_record && deps_->getMaxRecordBatchSize() > 0) {
+    // The record is taken off the buffer now and passed to the application
+    // with the rest of its batch by flushRecordBatch(). Until the
+    // application consumes the batch, nothing else gets delivered.
+    last_delivered_lsn_ = lsn;
+    if (current_offset != BYTE_OFFSET_INVALID) {
+      accumulated_byte_offset_ = current_offset;
+    }
+    record_batch_.push_back(std::unique_ptr<DataRecord>(std::move(record)));
+    record_batch_payload_sizes_.push_back(payload_size);
+    if (record_batch_.size() >= deps_->getMaxRecordBatchSize() ||
+        lsn >= until_lsn_) {
+      flushRecordBatch();
+    }
+    return 0;
+  }
+
+  // Records batched before this one must be delivered first.
+  if (flushRecordBatch() != 0) {
+    return -1;
+  }
+
   bool success;
   if (reader_) {
     bool notify =
@@ -3169,30 +3219,7 @@ int ClientReadStream::deliverRecord(
       // lsn appropriately in that case.
       last_delivered_lsn_ = lsn;
     }
-    if (MetaDataLog::isMetaDataLog(log_id_)) {
-      if (wait_for_all_copies_) {
-        WORKER_STAT_INCR(client.metadata_log_records_delivered_wait_for_all);
-      } else {
-        WORKER_STAT_INCR(client.metadata_log_records_delivered);
-      }
-      WORKER_STAT_ADD(client.metadata_log_bytes_delivered, payload_size);
-    } else {
-      if (wait_for_all_copies_) {
-        WORKER_STAT_INCR(client.records_delivered_wait_for_all);
-      } else {
-        WORKER_STAT_INCR(client.records_delivered);
-        if (scd_ && scd_->isActive()) {
-          WORKER_STAT_INCR(client.records_delivered_scd);
-        } else {
-          WORKER_STAT_INCR(client.records_delivered_noscd);
-        }
-      }
-      WORKER_STAT_ADD(client.bytes_delivered, payload_size);
-    }
-    num_records_delivered_++;
-    num_bytes_delivered_ += payload_size;
-    // Updating info reg. buffer usage.
-    bytes_buffered_ -= payload_size;
+    onRecordDelivered(payload_size);
     if (current_offset != BYTE_OFFSET_INVALID) {
       accumulated_byte_offset_ = current_offset;
     }
@@ -3205,10 +3232,90 @@ int ClientReadStream::deliverRecord(
   return success ? 0 : -1;
 }
 
+int ClientReadStream::flushRecordBatch() {
+  if (record_batch_.empty()) {
+    return 0;
+  }
+  ld_check(record_batch_.size() == record_batch_payload_sizes_.size());
+  const lsn_t last_lsn = record_batch_.back()->attrs.lsn;
+
+  inside_callback_ = true;
+  size_t consumed = deps_->batchRecordCallback(record_batch_);
+  inside_callback_ = false;
+
+  if (consumed > record_batch_.size()) {
+    RATELIMIT_CRITICAL(std::chrono::seconds(5),
+                       2,
+                       "Batch record callback for log %lu claims to have "
+                       "consumed %lu records out of %lu",
+                       log_id_.val_,
+                       consumed,
+                       record_batch_.size());
+    ld_check(false);
+    consumed = record_batch_.size();
+  }
+  for (size_t i = 0; i < consumed; ++i) {
+    onRecordDelivered(record_batch_payload_sizes_[i]);
+  }
+  record_batch_.erase(record_batch_.begin(), record_batch_.begin() + consumed);
+  record_batch_payload_sizes_.erase(record_batch_payload_sizes_.begin(),
+                                    record_batch_payload_sizes_.begin() +
+                                        consumed);
+
+  const bool success = record_batch_.empty();
+  if (success) {
+    if (last_lsn >= until_lsn_) {
+      inside_callback_ = true;
+      deps_->doneCallback(log_id_);
+      inside_callback_ = false;
+    }
+  } else {
+    // Application must not drain the records it didn't consume
+    ld_check(record_batch_.front() != nullptr);
+    if (!MetaDataLog::isMetaDataLog(log_id_)) {
+      WORKER_STAT_INCR(client.records_redelivery_attempted);
+    }
+  }
+  adjustRedeliveryTimer(success);
+  return success ? 0 : -1;
+}
+
+void ClientReadStream::onRecordDelivered(size_t payload_size) {
+  if (MetaDataLog::isMetaDataLog(log_id_)) {
+    if (wait_for_all_copies_) {
+      WORKER_STAT_INCR(client.metadata_log_records_delivered_wait_for_all);
+    } else {
+      WORKER_STAT_INCR(client.metadata_log_records_delivered);
+    }
+    WORKER_STAT_ADD(client.metadata_log_bytes_delivered, payload_size);
+  } else {
+    if (wait_for_all_copies_) {
+      WORKER_STAT_INCR(client.records_delivered_wait_for_all);
+    } else {
+      WORKER_STAT_INCR(client.records_delivered);
+      if (scd_ && scd_->isActive()) {
+        WORKER_STAT_INCR(client.records_delivered_scd);
+      } else {
+        WORKER_STAT_INCR(client.records_delivered_noscd);
+      }
+    }
+    WORKER_STAT_ADD(client.bytes_delivered, payload_size);
+  }
+  num_records_delivered_++;
+  num_bytes_delivered_ += payload_size;
+  // Updating info reg. buffer usage.
+  bytes_buffered_ -= payload_size;
+}
+
 int ClientReadStream::deliverGap(GapType type, lsn_t lo, lsn_t hi) {
   ld_check(hi <= until_lsn_);
   ld_check(lo <= hi);
 
+  // Records batched before the gap must be delivered first.
+  if (flushRecordBatch() != 0) {
+    return -1;
+  }
+
   if (type == GapType::DATALOSS) {
     RATELIMIT_WARNING(std::chrono::seconds(10),
                       2,
@@ -3462,6 +3569,30 @@ void ClientReadStream::calcWindowHigh() {
       : until_lsn_;
 }
 
+std::chrono::microseconds ClientReadStream::windowUpdateDelay() {
+  const auto now = std::chrono::steady_clock::now();
+  const auto elapsed = now - last_window_slide_time_;
+  const lsn_t prev_slide_lsn = last_window_slide_lsn_;
+  last_window_slide_time_ = now;
+  last_window_slide_lsn_ = next_lsn_to_deliver_;
+
+  const std::chrono::microseconds max_delay =
+      deps_->getSettings().client_window_update_max_delay;
+  if (max_delay.count() <= 0 || prev_slide_lsn == LSN_INVALID ||
+      next_lsn_to_deliver_ <= prev_slide_lsn ||
+      server_window_.high < next_lsn_to_deliver_) {
+    return std::chrono::microseconds(0);
+  }
+
+  const double consumed = next_lsn_to_deliver_ - prev_slide_lsn;
+  const double headroom = server_window_.high - next_lsn_to_deliver_ + 1;
+  const double until_exhausted_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() *
+      headroom / consumed;
+  return std::min(
+      max_delay, std::chrono::microseconds(int64_t(until_exhausted_us / 2)));
+}
+
 bool ClientReadStream::canAcceptRecord(lsn_t lsn) const {
   return lsn <= window_high_;
 }
@@ -3528,6 +3659,7 @@ bool ClientReadStream::slideSenderWindows() {
   calcWindowHigh();
   calcNextLSNToSlideWindow();
 
+  std::chrono::microseconds window_delay(0);
   if (reader_) {
     // Let onReaderProgress() know that it needs to send WINDOW messages
     window_update_pending_ = true;
@@ -3535,6 +3667,7 @@ bool ClientReadStream::slideSenderWindows() {
       readers_flow_tracer_->onWindowUpdatePending();
     }
   } else {
+    window_delay = windowUpdateDelay();
     updateServerWindow();
     scd_->onWindowSlid(server_window_.high, filter_version_);
   }
@@ -3554,7 +3687,7 @@ bool ClientReadStream::slideSenderWindows() {
   for (auto& it : storage_set_states_) {
     SenderState& state = it.second;
     if (!reader_) {
-      sendWindowMessage(state);
+      sendWindowMessage(state, window_delay);
     }
 
     bool under_replicated = state.getGapState() == GapState::UNDER_REPLICATED;
@@ -3568,7 +3701,8 @@ bool ClientReadStream::slideSenderWindows() {
   return true;
 }
 
-void ClientReadStream::sendWindowMessage(SenderState& state) {
+void ClientReadStream::sendWindowMessage(SenderState& state,
+                                         std::chrono::microseconds max_delay) {
   // If we are in the READING state, send out the WINDOW message now.
   //
   // If we are in an error state (RECONNECT_PENDING or PERSISTENT_ERROR),
@@ -3602,8 +3736,10 @@ void ClientReadStream::sendWindowMessage(SenderState& state) {
 
     ld_check(server_window_.high >= state.getWindowHigh());
 
-    int rv = deps_->sendWindowMessage(
-        state.getShardID(), server_window_.low, server_window_.high);
+    int rv = deps_->sendWindowMessage(state.getShardID(),
+                                      server_window_.low,
+                                      server_window_.high,
+                                      max_delay);
     if (rv == 0) {
       state.resetRetryWindowTimer();
       state.setWindowHigh(server_window_.high);
@@ -3613,6 +3749,22 @@ void ClientReadStream::sendWindowMessage(SenderState& state) {
   }
 }
 
+void ClientReadStream::onWindowSendFailed(ShardID shard) {
+  auto it = storage_set_states_.find(shard);
+  if (it == storage_set_states_.end()) {
+    return;
+  }
+  SenderState& state = it->second;
+  if (state.getConnectionState() != ConnectionState::READING) {
+    // A new START will carry the window.
+    return;
+  }
+  // sendWindowMessage() assumed the update went through. Forget about it so
+  // that the retry sends it again.
+  state.setWindowHigh(LSN_INVALID);
+  state.activateRetryWindowTimer();
+}
+
 bool ClientReadStream::canSkipPartiallyTrimmedSection() const {
   return !do_not_skip_partially_trimmed_sections_ &&
       trim_point_ != LSN_INVALID && trim_point_ >= next_lsn_to_deliver_;
@@ -3677,6 +3829,25 @@ ClientReadStream::~ClientReadStream() {
     }
   }
   storage_set_states_.clear();
+
+  onBufferedBytesChanged(-static_cast<int64_t>(buffered_bytes_));
+}
+
+void ClientReadStream::onBufferedBytesChanged(int64_t delta) {
+  ld_check(delta >= 0 || buffered_bytes_ >= static_cast<size_t>(-delta));
+  if (delta == 0) {
+    return;
+  }
+  buffered_bytes_ += delta;
+  deps_->onBufferedBytesChanged(delta);
+}
+
+void ClientReadStream::resetRecordState(RecordState& rstate) {
+  if (rstate.record) {
+    const size_t payload_size = rstate.record->payload.size();
+    onBufferedBytesChanged(-static_cast<int64_t>(payload_size));
+  }
+  rstate.reset();
 }
 
 // Used in tests only.
@@ -3865,6 +4036,12 @@ void ClientReadStream::rewind(const std::string& reason) {
                              readSetSize());
   ld_debug("Rewinding stream for log %lu: %s", log_id_.val(), reason.c_str());
 
+  // Must be computed before the senders' gap parameters are reset.
+  std::unordered_map<ShardID, lsn_t, ShardID::Hash> partial_start_lsns;
+  if (deps_->getSettings().reader_slow_shards_partial_failover) {
+    partial_start_lsns = getPartialFailoverStartLsns();
+  }
+
   for (auto it = storage_set_states_.begin(); it != storage_set_states_.end();
        ++it) {
     resetGapParametersForSender(it->second);
@@ -3874,8 +4051,19 @@ void ClientReadStream::rewind(const std::string& reason) {
   ld_assert(numShardsInState(GapState::UNDER_REPLICATED) == 0);
   ld_check(scd_->getGapShardsFilteredOut() == 0);
 
-  // clear the entire read stream buffer
-  buffer_->clear();
+  if (partial_start_lsns.empty()) {
+    WORKER_STAT_ADD(client.read_streams_rewind_discarded_bytes,
+                    buffered_bytes_);
+
+    // clear the entire read stream buffer
+    buffer_->clear();
+    onBufferedBytesChanged(-static_cast<int64_t>(buffered_bytes_));
+  } else {
+    // Keep the buffered records so that they can be delivered without waiting
+    // for them to be shipped again. Gap accounting starts over since senders'
+    // gap parameters were reset.
+    WORKER_STAT_INCR(client.read_streams_rewinds_partial);
+  }
 
   gap_end_outside_window_ = LSN_INVALID;
 
@@ -3896,6 +4084,7 @@ void ClientReadStream::rewind(const std::string& reason) {
   immediate_rewind_timer_->cancel();
 
   if (scd_ && scd_->isActive()) {
+    WORKER_STAT_INCR(client.read_streams_rewinds_scd);
     RATELIMIT_INFO(std::chrono::seconds(1),
                    10,
                    "Rewinding read stream for log %lu in SCD mode with version "
@@ -3904,6 +4093,7 @@ void ClientReadStream::rewind(const std::string& reason) {
                    filter_version_.val_,
                    reason.c_str());
   } else {
+    WORKER_STAT_INCR(client.read_streams_rewinds_all_send_all);
     RATELIMIT_INFO(std::chrono::seconds(1),
                    10,
                    "Rewinding read stream for log %lu in ALL_SEND_ALL mode "
@@ -3943,11 +4133,52 @@ void ClientReadStream::rewind(const std::string& reason) {
   // sendStart() calls ClientReadStream::checkConsistency() so let's call it
   // after we set ClientReadStreamSenderState::known_down for all nodes.
   for (auto& it : storage_set_states_) {
-    sendStart(it.second.getShardID(), it.second);
+    auto start_it = partial_start_lsns.find(it.first);
+    sendStart(it.second.getShardID(),
+              it.second,
+              start_it != partial_start_lsns.end() ? start_it->second
+                                                   : LSN_INVALID);
   }
   scd_->onWindowSlid(server_window_.high, filter_version_);
 }
 
+std::unordered_map<ShardID, lsn_t, ShardID::Hash>
+ClientReadStream::getPartialFailoverStartLsns() const {
+  std::unordered_map<ShardID, lsn_t, ShardID::Hash> start_lsns;
+  if (!scd_) {
+    return start_lsns;
+  }
+  const small_shardset_t slow = scd_->getScheduledShardsSlowAdded();
+  if (slow.empty()) {
+    return start_lsns;
+  }
+
+  // First LSN that one of the new slow shards may not have shipped yet.
+  lsn_t resume_lsn = LSN_MAX;
+  for (ShardID shard : slow) {
+    auto it = storage_set_states_.find(shard);
+    if (it == storage_set_states_.end() ||
+        it->second.getConnectionState() != ConnectionState::READING) {
+      return start_lsns;
+    }
+    resume_lsn = std::min(resume_lsn, it->second.getNextLsn());
+  }
+
+  // Usually a slow shard is what holds next_lsn_to_deliver_ back, in which
+  // case every sender restarts from next_lsn_to_deliver_ and the records we
+  // keep buffered are shipped again and dropped as duplicates.
+  for (const auto& it : storage_set_states_) {
+    const SenderState& state = it.second;
+    lsn_t start_lsn = next_lsn_to_deliver_;
+    if (state.getConnectionState() == ConnectionState::READING) {
+      // The sender shipped everything it had to below its next lsn.
+      start_lsn = std::max(start_lsn, std::min(state.getNextLsn(), resume_lsn));
+    }
+    start_lsns[it.first] = start_lsn;
+  }
+  return start_lsns;
+}
+
 int ClientReadStream::setGapStateFilteredOut(lsn_t start_lsn,
                                              lsn_t end_lsn,
                                              SenderState& state) {
@@ -4010,8 +4241,37 @@ ClientReadStreamDependencies::ClientReadStreamDependencies() = default;
 ClientReadStreamDependencies::~ClientReadStreamDependencies() {}
 
 bool ClientReadStreamDependencies::hasMemoryPressure() const {
-  // TODO(T6159466): implement memory limits/accounting
-  return false;
+  const size_t budget = getSettings().client_read_buffer_memory_budget;
+  Worker* w = Worker::onThisThread(false);
+  if (budget == 0 || w == nullptr) {
+    return false;
+  }
+  // Read streams are pinned to workers, each worker gets an equal share.
+  const size_t nworkers = std::max(1, getSettings().num_workers);
+  return w->clientReadStreams().getBufferedBytes() > budget / nworkers;
+}
+
+void ClientReadStreamDependencies::onBufferedBytesChanged(int64_t delta) {
+  Worker* w = Worker::onThisThread(false);
+  if (w) {
+    w->clientReadStreams().onBufferedBytesChanged(delta);
+  }
+}
+
+std::chrono::milliseconds
+ClientReadStreamDependencies::reserveReconnect(ShardID shard) {
+  Worker* w = Worker::onThisThread();
+  const Settings& settings = getSettings();
+  auto delay = w->processor_->readStreamReconnectLimiter().reserve(
+      shard.node(), settings.reader_reconnect_rate_limit);
+  if (delay.count() > 0) {
+    WORKER_STAT_INCR(client.read_stream_reconnects_throttled);
+  }
+  if (settings.reader_reconnect_jitter.count() > 0) {
+    delay += std::chrono::milliseconds(folly::Random::rand64(
+        settings.reader_reconnect_jitter.count() + 1));
+  }
+  return delay;
 }
 
 void ClientReadStreamDependencies::getMetaDataForEpoch(
@@ -4136,10 +4396,11 @@ void ClientReadStreamDependencies::getMetaDataForEpoch(
 
   // a callback object which essentially wraps the ClientReadStream callback
   // passed in.
-  auto cb_wrapper = [this, epoch, cb](Status st) {
+  auto cb_wrapper = [this, epoch, cb](
+                        Status st,
+                        std::shared_ptr<const EpochMetaDataMap> map) {
     MetaDataLogReader::Result result;
     if (st == E::OK) {
-      auto map = nodeset_finder_->getResult();
       epoch_t until;
       std::unique_ptr<EpochMetaData> metadata;
       epoch_t effective_until = map->getEffectiveUntil();
@@ -4206,22 +4467,21 @@ void ClientReadStreamDependencies::getMetaDataForEpoch(
                 nullptr};
     }
 
-    // Clear the nodeset_finder_ while keeping the object alive to avoid
-    // ASAN failures. It will be destroyed after the callback returned.
-    std::unique_ptr<NodeSetFinder> nf;
-    nodeset_finder_.swap(nf);
+    // The request is done, the handle no longer cancels anything.
+    nodeset_finder_.reset();
     cb(st, std::move(result));
   };
 
-  nodeset_finder_ = std::make_unique<NodeSetFinder>(
+  // Read streams of this worker that need the metadata of the log at the
+  // same time share a NodeSetFinder.
+  nodeset_finder_ = w->nodeSetFinderCoalescer().find(
       log_id_,
-      MAX_RETRY_READ_METADATA_DELAY,
-      std::move(cb_wrapper),
+      epoch,
       getSettings().read_streams_use_metadata_log_only
           ? NodeSetFinder::Source::METADATA_LOG
-          : NodeSetFinder::Source::BOTH);
-
-  nodeset_finder_->start();
+          : NodeSetFinder::Source::BOTH,
+      MAX_RETRY_READ_METADATA_DELAY,
+      std::move(cb_wrapper));
   return;
 }
 
@@ -4252,6 +4512,10 @@ int ClientReadStreamDependencies::sendStartMessage(
 
   auto msg = std::make_unique<START_Message>(
       header, filtered_out, attrs, client_session_id_);
+  if (w->clientReadStreams().enqueueStartForBatch(
+          msg, shard.asNodeID(), onclose)) {
+    return 0;
+  }
   return w->sender().sendMessage(std::move(msg), shard.asNodeID(), onclose);
 }
 
@@ -4265,12 +4529,16 @@ int ClientReadStreamDependencies::sendStopMessage(ShardID shard) {
   header.shard = shard.shard();
 
   auto msg = std::make_unique<STOP_Message>(header);
+  // Messages queued for batching must reach the node first.
+  w->clientReadStreams().flushBatches(shard.node());
   return w->sender().sendMessage(std::move(msg), shard.asNodeID());
 }
 
-int ClientReadStreamDependencies::sendWindowMessage(ShardID shard,
-                                                    lsn_t window_low,
-                                                    lsn_t window_high) {
+int ClientReadStreamDependencies::sendWindowMessage(
+    ShardID shard,
+    lsn_t window_low,
+    lsn_t window_high,
+    std::chrono::microseconds max_delay) {
   auto w = Worker::onThisThread();
   ld_check(w);
 
@@ -4283,8 +4551,19 @@ int ClientReadStreamDependencies::sendWindowMessage(ShardID shard,
 
   ld_check(window_low <= window_high);
 
+  WORKER_STAT_INCR(client.read_stream_window_updates);
+  if (w->clientReadStreams().enqueueWindowForBatch(
+          header, shard.asNodeID(), max_delay)) {
+    return 0;
+  }
+
   auto msg = std::make_unique<WINDOW_Message>(header);
-  return w->sender().sendMessage(std::move(msg), shard.asNodeID());
+  w->clientReadStreams().flushBatches(shard.node());
+  int rv = w->sender().sendMessage(std::move(msg), shard.asNodeID());
+  if (rv == 0) {
+    WORKER_STAT_INCR(client.window_messages_sent);
+  }
+  return rv;
 }
 
 void ClientReadStreamDependencies::dispose() {
@@ -4385,7 +4664,8 @@ void ClientReadStreamDependencies::refreshClusterState() {
 
 folly::Optional<uint16_t>
 ClientReadStreamDependencies::getSocketProtocolVersion(node_index_t nid) const {
-  Socket* socket = Worker::onThisThread()->sender().findServerSocket(nid);
+  Socket* socket = Worker::onThisThread()->sender().findServerSocket(
+      nid, Sender::readStreamsConnection());
   return socket != nullptr && socket->isHandshaken()
       ? socket->getProto()
       : folly::Optional<uint16_t>();
@@ -4394,7 +4674,9 @@ ClientReadStreamDependencies::getSocketProtocolVersion(node_index_t nid) const {
 ClientID
 ClientReadStreamDependencies::getOurNameAtPeer(node_index_t node_index) const {
   Worker* w = Worker::onThisThread(false);
-  Socket* socket = w ? w->sender().findServerSocket(node_index) : nullptr;
+  Socket* socket = w ? w->sender().findServerSocket(
+                           node_index, Sender::readStreamsConnection())
+                     : nullptr;
   return socket != nullptr ? socket->getOurNameAtPeer() : ClientID::INVALID;
 }
 
@@ -11,6 +11,7 @@
 #include <memory>
 #include <queue>
 #include <set>
+#include <vector>
 
 #include <boost/noncopyable.hpp>
 #include <folly/Optional.h>
@@ -21,6 +22,7 @@
 #include "logdevice/common/MetaDataLogReader.h"
 #include "logdevice/common/NodeID.h"
 #include "logdevice/common/NodeSetFinder.h"
+#include "logdevice/common/NodeSetFinderCoalescer.h"
 #include "logdevice/common/ReadStreamAttributes.h"
 #include "logdevice/common/ShardID.h"
 #include "logdevice/common/Timer.h"
@@ -92,6 +94,8 @@ class ClientReadStreamDependencies {
   ClientReadStreamDependencies();
 
   using record_cb_t = std::function<bool(std::unique_ptr<DataRecord>&)>;
+  using batch_record_cb_t =
+      std::function<size_t(std::vector<std::unique_ptr<DataRecord>>&)>;
   using gap_cb_t = std::function<bool(const GapRecord&)>;
   using done_cb_t = std::function<void(logid_t)>;
   using record_copy_cb_t =
@@ -191,10 +195,13 @@ class ClientReadStreamDependencies {
    * @param shard       target Shard ID.
    * @param window_low  the smallest LSN in current sliding window.
    * @param window_high the largest LSN in current sliding window.
+   * @param max_delay   how long the update may wait to be batched with
+   *                    updates of other read streams for the same node.
    */
   virtual int sendWindowMessage(ShardID shard,
                                 lsn_t window_low,
-                                lsn_t window_high);
+                                lsn_t window_high,
+                                std::chrono::microseconds max_delay);
 
   /**
    * Call the application-supplied callback to deliver a record.
@@ -203,6 +210,35 @@ class ClientReadStreamDependencies {
     return record_callback_ ? record_callback_(record) : true;
   }
 
+  /**
+   * Makes ClientReadStream deliver records in batches of up to
+   * max_batch_size through batchRecordCallback() instead of one at a time
+   * through recordCallback(). See AsyncReader::setBatchRecordCallback().
+   */
+  void setBatchRecordCallback(batch_record_cb_t cb, size_t max_batch_size) {
+    batch_record_callback_ = std::move(cb);
+    max_record_batch_size_ = batch_record_callback_ ? max_batch_size : 0;
+  }
+
+  /**
+   * Maximum number of records to pass to batchRecordCallback() at once, or 0
+   * if records are delivered one at a time.
+   */
+  virtual size_t getMaxRecordBatchSize() const {
+    return max_record_batch_size_;
+  }
+
+  /**
+   * Call the application-supplied callback to deliver a batch of records.
+   *
+   * @return the number of records from the front of the batch that were
+   *         consumed; the others must be left intact.
+   */
+  virtual size_t
+  batchRecordCallback(std::vector<std::unique_ptr<DataRecord>>& records) {
+    return batch_record_callback_(records);
+  }
+
   /**
    * Call the application-supplied callback to report a gap.
    */
@@ -314,8 +350,27 @@ class ClientReadStreamDependencies {
 
   virtual ~ClientReadStreamDependencies();
 
+  /**
+   * @return true if the read streams of this worker buffer more than their
+   *         share of --client-read-buffer-memory-budget. ClientReadStream then
+   *         halves its window each time it slides it, instead of growing it.
+   */
   virtual bool hasMemoryPressure() const;
 
+  /**
+   * Called when the payload bytes held in the read stream's buffer change by
+   * `delta`. Accounts for them in AllClientReadStreams.
+   */
+  virtual void onBufferedBytesChanged(int64_t delta);
+
+  /**
+   * Called before sending a START to reconnect to a storage node. Reserves a
+   * reconnect in the budget of the node (see ClientReadStreamReconnectLimiter)
+   * and returns how long to wait before sending the START, including some
+   * random jitter.
+   */
+  virtual std::chrono::milliseconds reserveReconnect(ShardID shard);
+
   virtual TimeoutMap* getCommonTimeouts();
 
  private:
@@ -323,6 +378,8 @@ class ClientReadStreamDependencies {
   logid_t log_id_;
   std::string client_session_id_;
   record_cb_t record_callback_;
+  batch_record_cb_t batch_record_callback_;
+  size_t max_record_batch_size_{0};
   gap_cb_t gap_callback_;
   done_cb_t done_callback_;
   // If our owner requested health updates, this is the callback.
@@ -343,8 +400,9 @@ class ClientReadStreamDependencies {
   // the timer.
   std::unique_ptr<Timer> delivery_timer_;
 
-  // currently running NodeSetFinder
-  std::unique_ptr<NodeSetFinder> nodeset_finder_;
+  // currently running request for historical metadata, see
+  // NodeSetFinderCoalescer
+  std::unique_ptr<NodeSetFinderCoalescer::Handle> nodeset_finder_;
 };
 
 /**
@@ -433,8 +491,14 @@ class ClientReadStream : boost::noncopyable {
 
   /**
    * Sends START message to one sender, updating the state as necessary.
+   *
+   * @param start_lsn  LSN the sender should start reading from, if it is
+   *                   greater than next_lsn_to_deliver_. Used by partial
+   *                   failover, see getPartialFailoverStartLsns().
    */
-  void sendStart(ShardID shard, SenderState& state);
+  void sendStart(ShardID shard,
+                 SenderState& state,
+                 lsn_t start_lsn = LSN_INVALID);
 
   /**
    * Called when the outcome of sending a START message is known.  If the
@@ -465,8 +529,18 @@ class ClientReadStream : boost::noncopyable {
    * Helper method, sends a WINDOW message to a single storage shard.  This is
    * called as part of a window update (when the update is broadcast to all
    * shards) and when retrying a previously failed send.
+   *
+   * @param max_delay  see ClientReadStreamDependencies::sendWindowMessage()
+   */
+  void sendWindowMessage(
+      SenderState&,
+      std::chrono::microseconds max_delay = std::chrono::microseconds(0));
+
+  /**
+   * Called when a WINDOW update that was queued for batching could not be
+   * sent to a shard. Retries it like a WINDOW message that failed to send.
    */
-  void sendWindowMessage(SenderState&);
+  void onWindowSendFailed(ShardID shard);
 
   /**
    * Add these flags to START messages sent out. See code below for possible
@@ -820,6 +894,19 @@ class ClientReadStream : boost::noncopyable {
    */
   int deliverRecord(std::unique_ptr<DataRecordOwnsPayload>& record);
 
+  /**
+   * If the application reads through a batch record callback, passes the
+   * records in record_batch_ to it.
+   *
+   * @return 0 if the batch was consumed entirely (or was empty), -1 if the
+   *         application left some of it for redelivery
+   */
+  int flushRecordBatch();
+
+  // Updates stats and counters for a record of the given size accepted by
+  // the application.
+  void onRecordDelivered(size_t payload_size);
+
   /**
    * Attempts to delivers parameter gap record.
    *
@@ -892,6 +979,16 @@ class ClientReadStream : boost::noncopyable {
    */
   void updateServerWindow();
 
+  /**
+   * Called when the senders' window slides, before server_window_ is updated.
+   * Estimates how long the application will take to consume the rest of the
+   * current server window, at the rate it consumed records since the
+   * previous slide. WINDOW updates may wait for half of that, up to
+   * --client-window-update-max-delay, to be batched with the updates of other
+   * read streams.
+   */
+  std::chrono::microseconds windowUpdateDelay();
+
   /**
    * Evaluates current conditions and update the size of the next window if
    * needed. This does not change the current window.
@@ -1026,9 +1123,19 @@ class ClientReadStream : boost::noncopyable {
    */
   void clearRecordState(lsn_t lsn, RecordState& rstate) {
     unlinkRecordState(lsn, rstate);
-    rstate.reset();
+    resetRecordState(rstate);
   }
 
+  /**
+   * Frees the record held by rstate, if any, and resets it.
+   */
+  void resetRecordState(RecordState& rstate);
+
+  /**
+   * Updates buffered_bytes_ and lets deps_ know.
+   */
+  void onBufferedBytesChanged(int64_t delta);
+
   /**
    * @return   number of storage shards in the storage set whose GapState is
    *           st regardless of their authoritative status.
@@ -1115,7 +1222,7 @@ class ClientReadStream : boost::noncopyable {
   // potential to advance next_lsn_to_deliver_ beyond until_lsn_.  If we are
   // done(), we should never yield to the event loop and stay alive.
   void disposeIfDone() {
-    if (done()) {
+    if (done() && record_batch_.empty()) {
       deps_->dispose();
     }
   }
@@ -1182,9 +1289,27 @@ class ClientReadStream : boost::noncopyable {
   /**
    * Clear buffer_ and ask storage nodes to rewind to next_lsn_to_deliver_
    * by sending them a new START message.
+   *
+   * If --reader-slow-shards-partial-failover is set and the rewind only adds
+   * slow shards to the filtered out list, buffer_ is kept and storage nodes
+   * are asked to rewind to the LSNs returned by getPartialFailoverStartLsns()
+   * instead.
    */
   void rewind(const std::string& reason);
 
+  /**
+   * When the only change the scheduled rewind makes is adding shards to the
+   * SCD shards slow list, the records already buffered stay valid, and the
+   * other shards don't have to ship again what they already shipped below the
+   * first LSN the slow shards may not have shipped yet: the slow shards
+   * shipped their part of that range already.
+   *
+   * @return The LSN each sender should restart from, or an empty map if the
+   *         rewind can't be partial.
+   */
+  std::unordered_map<ShardID, lsn_t, ShardID::Hash>
+  getPartialFailoverStartLsns() const;
+
   /**
    * Called to set gap state to be FILTERED_OUT from start_lsn to end_lsn.
    * This method first verifies start_lsn, end_lsn, state. If we should
@@ -1329,6 +1454,11 @@ class ClientReadStream : boost::noncopyable {
    */
   size_t window_size_;
 
+  /**
+   * Total payload size of the records in buffer_.
+   */
+  size_t buffered_bytes_{0};
+
   /**
    * The largest LSN in sender's sliding window. This member variable
    * is employed to avoid doing the math every time we call
@@ -1453,6 +1583,12 @@ class ClientReadStream : boost::noncopyable {
   // is not null.
   bool window_update_pending_;
 
+  // When the senders' window was last slid, and next_lsn_to_deliver_ at that
+  // time. Used to estimate how fast the application consumes records, see
+  // windowUpdateDelay().
+  std::chrono::steady_clock::time_point last_window_slide_time_;
+  lsn_t last_window_slide_lsn_{LSN_INVALID};
+
   // a Throttled tracelogger to report gaps
   std::unique_ptr<ClientGapTracer> gap_tracer_;
   // a Sampled tracelogger for tracing reads
@@ -1533,6 +1669,15 @@ class ClientReadStream : boost::noncopyable {
   // Counter of the size (in bytes) of the current ReadStream.
   size_t bytes_buffered_{0};
 
+  // With a batch record callback, records taken off the front of buffer_ by
+  // deliverRecord() but not yet consumed by the application, in LSN order,
+  // and their payload sizes. Passed to the application by
+  // flushRecordBatch() once full and whenever we're about to stop delivering
+  // or deliver a gap. Records the application doesn't consume stay here for
+  // redelivery, and nothing else is delivered until they are.
+  std::vector<std::unique_ptr<DataRecord>> record_batch_;
+  std::vector<size_t> record_batch_payload_sizes_;
+
   /**
    * When we are in all send all mode but SCD is in use on the log, there is a
    * race condition that can cause erroneous data loss reporting. We fix this by
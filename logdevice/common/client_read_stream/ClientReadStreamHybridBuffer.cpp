@@ -0,0 +1,301 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "ClientReadStreamHybridBuffer.h"
+
+#include <folly/lang/Bits.h>
+
+#include "logdevice/common/DataRecordOwnsPayload.h"
+#include "logdevice/common/Timer.h"
+#include "logdevice/common/client_read_stream/ClientReadStream.h"
+#include "logdevice/common/debug.h"
+
+namespace facebook { namespace logdevice {
+
+using RecordState = ClientReadStreamRecordState;
+
+constexpr size_t ClientReadStreamHybridBuffer::CHUNK_SIZE;
+constexpr size_t ClientReadStreamHybridBuffer::SPARSE_SLOTS;
+
+struct ClientReadStreamHybridBuffer::Chunk {
+  explicit Chunk(lsn_t base) : base(base) {}
+
+  // First LSN of the chunk, a multiple of CHUNK_SIZE.
+  const lsn_t base;
+  // Bit i is set if LSN base + i has a descriptor.
+  uint64_t present = 0;
+  // Bit i is set if sparse[i] is in use, in which case it is the descriptor of
+  // LSN base + sparse_offsets[i].
+  uint8_t sparse_used = 0;
+  uint8_t sparse_offsets[SPARSE_SLOTS];
+  RecordState sparse[SPARSE_SLOTS];
+  // Allocated when the chunk is promoted to dense, one slot per LSN of the
+  // chunk. Descriptors that were created before that stay in sparse.
+  std::unique_ptr<RecordState[]> dense;
+
+  static uint64_t bit(size_t offset) {
+    return uint64_t(1) << offset;
+  }
+
+  // Returns the index in sparse of the descriptor at offset, or -1 if it's
+  // not there.
+  int sparseIndex(size_t offset) const {
+    for (size_t i = 0; i < SPARSE_SLOTS; ++i) {
+      if ((sparse_used & (1u << i)) && sparse_offsets[i] == offset) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  RecordState* get(size_t offset) {
+    if (!(present & bit(offset))) {
+      return nullptr;
+    }
+    int i = sparseIndex(offset);
+    if (i >= 0) {
+      return &sparse[i];
+    }
+    ld_check(dense);
+    return &dense[offset];
+  }
+};
+
+ClientReadStreamHybridBuffer::ClientReadStreamHybridBuffer(size_t capacity,
+                                                           lsn_t buffer_head)
+    : capacity_(capacity),
+      buffer_head_(buffer_head),
+      chunks_(capacity / CHUNK_SIZE + 2) {}
+
+ClientReadStreamHybridBuffer::~ClientReadStreamHybridBuffer() = default;
+
+ClientReadStreamHybridBuffer::Chunk*
+ClientReadStreamHybridBuffer::getChunk(lsn_t lsn) const {
+  Chunk* chunk = chunks_[lsn / CHUNK_SIZE % chunks_.size()].get();
+  if (chunk == nullptr || chunk->base != lsn - lsn % CHUNK_SIZE) {
+    return nullptr;
+  }
+  return chunk;
+}
+
+RecordState* ClientReadStreamHybridBuffer::get(lsn_t lsn) const {
+  Chunk* chunk = getChunk(lsn);
+  return chunk ? chunk->get(lsn % CHUNK_SIZE) : nullptr;
+}
+
+RecordState* ClientReadStreamHybridBuffer::createOrGet(lsn_t lsn) {
+  // lsn must be with in the range of
+  // [buffer_head, buffer_head + capacity() - 1]
+  if (!LSNInBuffer(lsn)) {
+    return nullptr;
+  }
+
+  auto& slot = chunks_[lsn / CHUNK_SIZE % chunks_.size()];
+  const lsn_t base = lsn - lsn % CHUNK_SIZE;
+  if (!slot) {
+    slot = std::make_unique<Chunk>(base);
+  }
+  Chunk& chunk = *slot;
+  // Chunks in the range of the buffer don't collide, and chunks are freed
+  // when the buffer head moves past them.
+  ld_check(chunk.base == base);
+
+  const size_t offset = lsn - base;
+  RecordState* rstate = chunk.get(offset);
+  if (rstate) {
+    return rstate;
+  }
+
+  chunk.present |= Chunk::bit(offset);
+  if (!chunk.dense) {
+    for (size_t i = 0; i < SPARSE_SLOTS; ++i) {
+      if (!(chunk.sparse_used & (1u << i))) {
+        chunk.sparse_used |= 1u << i;
+        chunk.sparse_offsets[i] = offset;
+        return &chunk.sparse[i];
+      }
+    }
+    // The chunk is full, promote it.
+    chunk.dense.reset(new RecordState[CHUNK_SIZE]);
+  }
+  return &chunk.dense[offset];
+}
+
+RecordState* ClientReadStreamHybridBuffer::find(lsn_t lsn) {
+  if (!LSNInBuffer(lsn)) {
+    return nullptr;
+  }
+  return get(lsn);
+}
+
+void ClientReadStreamHybridBuffer::erase(lsn_t lsn) {
+  auto& slot = chunks_[lsn / CHUNK_SIZE % chunks_.size()];
+  ld_check(slot && slot->base == lsn - lsn % CHUNK_SIZE);
+  Chunk& chunk = *slot;
+
+  const size_t offset = lsn % CHUNK_SIZE;
+  ld_check(chunk.present & Chunk::bit(offset));
+  // Descriptors are reused, leave them in the default state.
+  int i = chunk.sparseIndex(offset);
+  if (i >= 0) {
+    chunk.sparse[i].reset();
+    chunk.sparse_used &= ~(1u << i);
+  } else {
+    chunk.dense[offset].reset();
+  }
+  chunk.present &= ~Chunk::bit(offset);
+
+  if (chunk.present == 0) {
+    slot.reset();
+  }
+}
+
+bool ClientReadStreamHybridBuffer::next(lsn_t from,
+                                        lsn_t to,
+                                        bool reverse,
+                                        lsn_t* out) const {
+  const lsn_t lo = std::max(reverse ? to : from, buffer_head_);
+  const lsn_t hi = std::min(reverse ? from : to, maxLSNToAccept());
+  if (lo > hi) {
+    return false;
+  }
+
+  // Walk the chunks from the one that holds `from'. Within a chunk, mask out
+  // the bits of the LSNs outside of [lo, hi].
+  lsn_t base = reverse ? hi - hi % CHUNK_SIZE : lo - lo % CHUNK_SIZE;
+  while (true) {
+    const Chunk* chunk = getChunk(base);
+    if (chunk) {
+      uint64_t mask = chunk->present;
+      if (lo > base) {
+        mask &= ~uint64_t(0) << (lo - base);
+      }
+      if (hi - base < CHUNK_SIZE - 1) {
+        mask &= ~uint64_t(0) >> (CHUNK_SIZE - 1 - (hi - base));
+      }
+      if (mask != 0) {
+        *out = base +
+            (reverse ? folly::findLastSet(mask) : folly::findFirstSet(mask)) -
+            1;
+        return true;
+      }
+    }
+    if (reverse) {
+      if (lo >= base) {
+        return false;
+      }
+      base -= CHUNK_SIZE;
+    } else {
+      if (hi - base < CHUNK_SIZE) {
+        return false;
+      }
+      base += CHUNK_SIZE;
+    }
+  }
+}
+
+std::pair<ClientReadStreamRecordState*, lsn_t>
+ClientReadStreamHybridBuffer::findFirstMarker() {
+  lsn_t lsn;
+  if (!next(buffer_head_, maxLSNToAccept(), false, &lsn)) {
+    return std::make_pair(nullptr, LSN_INVALID);
+  }
+  return std::make_pair(get(lsn), lsn);
+}
+
+ClientReadStreamRecordState* ClientReadStreamHybridBuffer::front() {
+  return get(buffer_head_);
+}
+
+void ClientReadStreamHybridBuffer::popFront() {
+  // record and list, if exist, must be already consumed
+  RecordState* rstate = get(buffer_head_);
+  if (rstate == nullptr) {
+    return;
+  }
+  ld_check(!rstate->record && !rstate->filtered_out);
+  ld_check(rstate->list.empty());
+  erase(buffer_head_);
+}
+
+void ClientReadStreamHybridBuffer::advanceBufferHead(size_t offset) {
+  // caller needs to ensure that there must not be any marker
+  // in the buffer slots that get advanced. assert this below.
+  if (offset == 0) {
+    return;
+  }
+#ifndef NDEBUG
+  const lsn_t max_lsn = maxLSNToAccept();
+  const lsn_t last =
+      offset - 1 > max_lsn - buffer_head_ ? max_lsn : buffer_head_ + offset - 1;
+  lsn_t lsn;
+  ld_check(!next(buffer_head_, last, false, &lsn));
+#endif
+  buffer_head_ += offset;
+}
+
+void ClientReadStreamHybridBuffer::clear() {
+  for (auto& chunk : chunks_) {
+    chunk.reset();
+  }
+}
+
+void ClientReadStreamHybridBuffer::forEach(
+    lsn_t from,
+    lsn_t to,
+    std::function<bool(lsn_t, ClientReadStreamRecordState& record)> cb) {
+  const bool reverse = from > to;
+  lsn_t lsn;
+  while (next(from, to, reverse, &lsn)) {
+    const bool done = !cb(lsn, *get(lsn));
+
+    // The callback may have created or removed other descriptors, so look
+    // this one up again.
+    RecordState* rstate = get(lsn);
+    if (rstate && !rstate->record && !rstate->gap && !rstate->filtered_out) {
+      ld_check(rstate->list.empty());
+      erase(lsn);
+    }
+
+    if (done || lsn == to) {
+      break;
+    }
+    from = reverse ? lsn - 1 : lsn + 1;
+  }
+}
+
+void ClientReadStreamHybridBuffer::forEachUpto(
+    lsn_t to,
+    std::function<void(lsn_t, RecordState& record)> callback) {
+  if (to < buffer_head_) {
+    return;
+  }
+  forEach(buffer_head_,
+          to,
+          [cb = std::move(callback)](lsn_t lsn, RecordState& rstate) {
+            cb(lsn, rstate);
+            return true;
+          });
+}
+
+size_t ClientReadStreamHybridBuffer::numChunks() const {
+  size_t n = 0;
+  for (const auto& chunk : chunks_) {
+    n += chunk != nullptr;
+  }
+  return n;
+}
+
+size_t ClientReadStreamHybridBuffer::numDenseChunks() const {
+  size_t n = 0;
+  for (const auto& chunk : chunks_) {
+    n += chunk && chunk->dense;
+  }
+  return n;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "logdevice/common/client_read_stream/ClientReadStreamBuffer.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file ClientReadStreamHybridBuffer is an implementation of
+ *       ClientReadStreamBuffer for logs whose density of records varies, in
+ *       between ClientReadStreamCircularBuffer and
+ *       ClientReadStreamOrderedMapBuffer.
+ *
+ *       The LSN range of the buffer is divided into chunks of CHUNK_SIZE
+ *       LSNs, which are only allocated while they hold RecordState
+ *       descriptors. A chunk starts sparse, with room for SPARSE_SLOTS
+ *       descriptors stored inline. A chunk that needs more is promoted to
+ *       dense: it allocates a slot for each of its LSNs, which new
+ *       descriptors go to. Descriptors never move, so pointers to them stay
+ *       valid until they are removed, as with the other implementations.
+ *
+ *       A bitmap of the LSNs of a chunk that have a descriptor makes finding
+ *       the next descriptor a few bit operations per chunk.
+ *
+ *       Like ClientReadStreamOrderedMapBuffer, descriptors exist from the time
+ *       createOrGet() creates them until popFront() removes them or forEach()
+ *       finds them empty.
+ *
+ *       The table of chunks takes a pointer per CHUNK_SIZE LSNs of capacity,
+ *       so ClientReadStreamOrderedMapBuffer remains the better fit for huge
+ *       capacities such as the ones metadata log readers use.
+ */
+
+class ClientReadStreamHybridBuffer : public ClientReadStreamBuffer {
+ public:
+  // Number of LSNs in a chunk, one per bit of Chunk::present.
+  static constexpr size_t CHUNK_SIZE = 64;
+  // Number of descriptors a chunk stores before it is promoted to dense.
+  static constexpr size_t SPARSE_SLOTS = 4;
+
+  ClientReadStreamHybridBuffer(size_t capacity, lsn_t buffer_head);
+  ~ClientReadStreamHybridBuffer() override;
+
+  // see ClientReadStreamBuffer::createOrGet()
+  // complexity O(1)
+  ClientReadStreamRecordState* createOrGet(lsn_t lsn) override;
+
+  // see ClientReadStreamBuffer::find()
+  // complexity O(1)
+  ClientReadStreamRecordState* find(lsn_t lsn) override;
+
+  // see ClientReadStreamBuffer::findFirstMarker()
+  // complexity O(n / CHUNK_SIZE) in which n is the capacity of the buffer
+  std::pair<ClientReadStreamRecordState*, lsn_t> findFirstMarker() override;
+
+  // see ClientReadStreamBuffer::front()
+  // complexity O(1)
+  ClientReadStreamRecordState* front() override;
+
+  // see ClientReadStreamBuffer::popFront()
+  // complexity O(1)
+  void popFront() override;
+
+  // see ClientReadStreamBuffer::advanceBufferHead()
+  // complexity O(1)
+  void advanceBufferHead(size_t offset = 1) override;
+
+  // see ClientReadStreamBuffer::capacity()
+  size_t capacity() const override {
+    return capacity_;
+  }
+
+  // see ClientReadStreamBuffer::clear()
+  // complexity O(n / CHUNK_SIZE)
+  void clear() override;
+
+  // see ClientReadStreamBuffer::forEachUpto()
+  // complexity O(k + (to - buffer_head_) / CHUNK_SIZE) in which k is the
+  // number of descriptors visited
+  void forEachUpto(
+      lsn_t to,
+      std::function<void(lsn_t, ClientReadStreamRecordState& record)> cb)
+      override;
+
+  // see ClientReadStreamBuffer::forEach()
+  // complexity O(k + abs(to - from) / CHUNK_SIZE)
+  void forEach(lsn_t from,
+               lsn_t to,
+               std::function<bool(lsn_t, ClientReadStreamRecordState& record)>
+                   cb) override;
+
+  // see ClientReadStreamBuffer::getBufferHead()
+  lsn_t getBufferHead() const override {
+    return buffer_head_;
+  }
+
+  // Number of chunks currently allocated, and how many of them are dense.
+  // Used in tests.
+  size_t numChunks() const;
+  size_t numDenseChunks() const;
+
+ private:
+  struct Chunk;
+
+  // Returns the chunk that holds lsn, or nullptr if it isn't allocated.
+  Chunk* getChunk(lsn_t lsn) const;
+
+  // Returns the descriptor of lsn if it exists.
+  ClientReadStreamRecordState* get(lsn_t lsn) const;
+
+  // Resets and removes the descriptor of lsn, which must exist and hold no
+  // record. Frees its chunk if it was the last one.
+  void erase(lsn_t lsn);
+
+  // Finds the first LSN that has a descriptor, going from `from' to `to',
+  // which is smaller than `from' if reverse is true. Returns false if there is
+  // none.
+  bool next(lsn_t from, lsn_t to, bool reverse, lsn_t* out) const;
+
+  // determines the maximum LSN to accept in the buffer
+  size_t capacity_;
+  // tracks the buffer head
+  lsn_t buffer_head_;
+  // Chunk for LSN lsn is chunks_[lsn / CHUNK_SIZE % chunks_.size()]. There are
+  // enough of them for chunks in the range of the buffer to not collide.
+  std::vector<std::unique_ptr<Chunk>> chunks_;
+};
+
+}} // namespace facebook::logdevice
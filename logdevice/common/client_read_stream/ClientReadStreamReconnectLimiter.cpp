@@ -0,0 +1,42 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "ClientReadStreamReconnectLimiter.h"
+
+namespace facebook { namespace logdevice {
+
+std::chrono::milliseconds
+ClientReadStreamReconnectLimiter::reserve(node_index_t node,
+                                          rate_limit_t limit) {
+  if (limit == RATE_UNLIMITED) {
+    return std::chrono::milliseconds(0);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = limiters_.find(node);
+  if (it == limiters_.end()) {
+    it = limiters_.emplace(node, NodeLimiter(limit)).first;
+  } else if (it->second.limit != limit) {
+    // The setting changed, start over with the new budget.
+    it->second = NodeLimiter(limit);
+  }
+
+  RateLimiter::Duration wait;
+  if (!it->second.limiter.isAllowed(1, &wait)) {
+    // A budget of zero. The setting doesn't allow it, but don't block
+    // reconnects forever.
+    return std::chrono::milliseconds(0);
+  }
+  // Round up so that the caller never wakes up before its slot.
+  auto wait_ms = std::chrono::duration_cast<std::chrono::milliseconds>(wait);
+  if (wait_ms < wait) {
+    ++wait_ms;
+  }
+  return wait_ms;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+
+#include "logdevice/common/RateLimiter.h"
+#include "logdevice/common/types_internal.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file When a storage node restarts, all the read streams of a client that
+ *       were reading from it reconnect at about the same time, and the node
+ *       gets a START for each of them at once. Each START makes the node seek
+ *       in its local log store, so a client with many readers can overwhelm a
+ *       node that just came up.
+ *
+ *       ClientReadStreamReconnectLimiter paces the reconnects of all read
+ *       streams of a Processor to each storage node, with a budget of STARTs
+ *       per unit of time (--reader-reconnect-rate-limit). Read streams reserve
+ *       a slot before sending a START after a reconnect, and wait for it.
+ *
+ *       This class is thread-safe.
+ */
+
+class ClientReadStreamReconnectLimiter {
+ public:
+  /**
+   * Reserves a reconnect to `node` with the given budget, and returns how long
+   * the caller must wait before sending its START. Does not wait itself.
+   */
+  std::chrono::milliseconds reserve(node_index_t node, rate_limit_t limit);
+
+ private:
+  struct NodeLimiter {
+    explicit NodeLimiter(rate_limit_t limit) : limit(limit), limiter(limit) {}
+
+    rate_limit_t limit;
+    RateLimiter limiter;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<node_index_t, NodeLimiter> limiters_;
+};
+
+}} // namespace facebook::logdevice
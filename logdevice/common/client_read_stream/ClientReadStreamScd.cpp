@@ -7,6 +7,8 @@
  */
 #include "logdevice/common/client_read_stream/ClientReadStreamScd.h"
 
+#include <algorithm>
+
 #include "folly/container/Array.h"
 #include "logdevice/common/DataRecordOwnsPayload.h"
 #include "logdevice/common/Timer.h"
@@ -276,6 +278,25 @@ bool ClientReadStreamScd::FilteredOut::applyDeferredChanges() {
   return true;
 }
 
+small_shardset_t
+ClientReadStreamScd::FilteredOut::getDeferredShardsSlowAdded() const {
+  if (new_shards_down_ != ShardSet(shards_down_.begin(), shards_down_.end())) {
+    return {};
+  }
+  small_shardset_t added;
+  for (const auto& shard : new_shards_slow_) {
+    if (std::find(shards_slow_.begin(), shards_slow_.end(), shard) ==
+        shards_slow_.end()) {
+      added.push_back(shard);
+    }
+  }
+  if (new_shards_slow_.size() != shards_slow_.size() + added.size()) {
+    // Some shards are also removed from the shards slow list.
+    return {};
+  }
+  return added;
+}
+
 bool ClientReadStreamScd::FilteredOut::deferredAddShardDown(ShardID shard) {
   if (!new_shards_down_.insert(shard).second) {
     return false;
@@ -365,6 +386,13 @@ void ClientReadStreamScd::applyScheduledChanges() {
   scheduled_mode_transition_.clear();
 }
 
+small_shardset_t ClientReadStreamScd::getScheduledShardsSlowAdded() const {
+  if (!isActive() || scheduled_mode_transition_.hasValue()) {
+    return {};
+  }
+  return filtered_out_.getDeferredShardsSlowAdded();
+}
+
 void ClientReadStreamScd::scheduleRewindToMode(Mode mode, std::string reason) {
   ld_check(!owner_->done());
 
@@ -513,6 +541,37 @@ void ClientReadStreamScd::onOutliersChanged(ShardSet outliers,
   rewindWithOutliers(std::move(outliers), std::move(reason));
 }
 
+size_t ClientReadStreamScd::capLocalOutliers(ShardSet& outliers) {
+  const auto& settings = owner_->deps_->getSettings();
+  const int max_local = settings.reader_slow_shards_max_local_outliers;
+  if (mode_ != Mode::LOCAL_SCD || max_local < 0 ||
+      !settings.client_location.hasValue()) {
+    return 0;
+  }
+  auto config = owner_->getConfig()->getServerConfig();
+  // Storage shards only send records of another region if all shards of the
+  // client's region in the copyset are filtered out, so these are the ones
+  // whose failover may cost cross-region bandwidth.
+  std::vector<ShardID> local;
+  for (const ShardID& shard : outliers) {
+    const auto* node = config->getNode(shard.node());
+    if (node && node->location.hasValue() &&
+        settings.client_location->sharesScopeWith(
+            node->location.value(), NodeLocationScope::REGION)) {
+      local.push_back(shard);
+    }
+  }
+  if (local.size() <= size_t(max_local)) {
+    return 0;
+  }
+  // Keep the same ones on every call so that the list doesn't ping-pong.
+  std::sort(local.begin(), local.end());
+  for (size_t i = max_local; i < local.size(); ++i) {
+    outliers.erase(local[i]);
+  }
+  return local.size() - max_local;
+}
+
 void ClientReadStreamScd::rewindWithOutliers(ShardSet outliers,
                                              std::string reason) {
   if (mode_ == Mode::ALL_SEND_ALL) {
@@ -528,6 +587,19 @@ void ClientReadStreamScd::rewindWithOutliers(ShardSet outliers,
   }
   ld_check(isActive());
 
+  if (size_t removed = capLocalOutliers(outliers)) {
+    RATELIMIT_INFO(std::chrono::seconds(10),
+                   1,
+                   "Outlier Detector for log %lu is marking %lu more shards in "
+                   "the client's region as outliers (reason: %s) than "
+                   "--reader-slow-shards-max-local-outliers allows. Keeping "
+                   "%s.",
+                   owner_->log_id_.val_,
+                   removed,
+                   reason.c_str(),
+                   toString(outliers).c_str());
+  }
+
   if (filtered_out_.deferredChangeShardsSlow(outliers)) {
     owner_->scheduleRewind(
         folly::format("Changing the outliers list from {} to {}: {}",
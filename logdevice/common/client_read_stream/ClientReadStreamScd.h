@@ -80,6 +80,9 @@ class Timer;
  *      5. Optional primary failover due to a slow shard. If a shard (or set of
  *         shards) is slower at completing windows that all the other shards,
  *          we will add it to the shards slow list and rewind the stream.
+ *          With --reader-slow-shards-partial-failover, that rewind keeps the
+ *          records already buffered, @see
+ *          ClientReadStream::getPartialFailoverStartLsns().
  *          @see ClientReadStreamFailureDetector.
  *
  *      6. Failover to ALL_SEND_ALL because we are stuck:
@@ -211,6 +214,13 @@ class ClientReadStreamScd : public boost::noncopyable {
     return filtered_out_.getShardsSlow();
   }
 
+  /**
+   * @return Shards that the next rewind will add to the shards slow list, if
+   * that is the only change it will make to the filtered out list and no mode
+   * transition is scheduled. Empty otherwise.
+   */
+  small_shardset_t getScheduledShardsSlowAdded() const;
+
   /**
    * Update the storage shard set that the filtered out list is based on.
    *
@@ -399,6 +409,10 @@ class ClientReadStreamScd : public boost::noncopyable {
     // @returns whether the shard was removed
     bool deferredRemoveShardDown(ShardID shard);
 
+    // Returns the shards that applyDeferredChanges() will add to the shards
+    // slow list if it won't make any other change, an empty list otherwise.
+    small_shardset_t getDeferredShardsSlowAdded() const;
+
     // Applies all deferred changes to the shard down/slow list.
     // @returns whether there were any changes at all to be applied
     bool applyDeferredChanges();
@@ -438,6 +452,11 @@ class ClientReadStreamScd : public boost::noncopyable {
   // stream is in ALL_SEND_ALL mode.
   void rewindWithOutliers(ShardSet outliers, std::string reason);
 
+  // In LOCAL_SCD mode, keeps at most --reader-slow-shards-max-local-outliers
+  // of the outliers that are in the client's region. Returns the number of
+  // outliers removed.
+  size_t capLocalOutliers(ShardSet& outliers);
+
   // Utility method to get from client settings whether the detection of slow
   // shards is enabled.
   bool isSlowShardsDetectionEnabled();
@@ -57,6 +57,8 @@ ClientReadStreamSenderState::ClientReadStreamSenderState(
 
 void ClientReadStreamSenderState::activateReconnectTimer() {
   setConnectionState(ConnectionState::RECONNECT_PENDING);
+  // The reconnect timer will reserve a new turn.
+  cancelReconnectPacingTimer();
   reconnect_timer_->activate();
 }
 
@@ -103,6 +105,24 @@ void ClientReadStreamSenderState::reconnectTimerCallback() {
     return;
   }
 
+  // Don't send the START right away if many other read streams are
+  // reconnecting to the same node, e.g. because it restarted.
+  const std::chrono::milliseconds delay =
+      client_read_stream_->deps_->reserveReconnect(shard_id_);
+  if (delay.count() > 0) {
+    setConnectionState(ConnectionState::RECONNECT_PENDING);
+    if (!reconnect_pacing_timer_) {
+      reconnect_pacing_timer_ = client_read_stream_->deps_->createTimer(
+          [this]() { sendReconnectStart(); });
+    }
+    reconnect_pacing_timer_->activate(delay);
+    return;
+  }
+
+  sendReconnectStart();
+}
+
+void ClientReadStreamSenderState::sendReconnectStart() {
   client_read_stream_->sendStart(shard_id_, *this);
   client_read_stream_->applyShardStatus("reconnectTimerCallback", this);
 }
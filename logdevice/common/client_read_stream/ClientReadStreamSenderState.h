@@ -20,6 +20,7 @@
 #include "logdevice/common/NodeID.h"
 #include "logdevice/common/ShardID.h"
 #include "logdevice/common/SocketCallback.h"
+#include "logdevice/common/Timer.h"
 #include "logdevice/include/types.h"
 
 namespace facebook { namespace logdevice {
@@ -176,7 +177,8 @@ class ClientReadStreamSenderState : boost::noncopyable {
     READING = 3,
 
     // Socket was closed or the server reported a transient error.  The
-    // reconnect timer is active.
+    // reconnect timer is active, or the reconnect is waiting for its turn in
+    // the budget of the node (see ClientReadStreamReconnectLimiter).
     RECONNECT_PENDING = 4,
 
     // The server reported a persistent error.  We should not retry until the
@@ -227,14 +229,17 @@ class ClientReadStreamSenderState : boost::noncopyable {
 
   void cancelReconnectTimer() {
     reconnect_timer_->cancel();
+    cancelReconnectPacingTimer();
   }
 
   void resetReconnectTimer() {
     reconnect_timer_->reset();
+    cancelReconnectPacingTimer();
   }
 
   bool reconnectTimerIsActive() const {
-    return reconnect_timer_->isActive();
+    return reconnect_timer_->isActive() ||
+        (reconnect_pacing_timer_ && reconnect_pacing_timer_->isActive());
   }
 
   void activateStartedTimer();
@@ -286,6 +291,15 @@ class ClientReadStreamSenderState : boost::noncopyable {
   void startedTimerCallback();
 
  private:
+  // Sends the START of a reconnect once it's its turn.
+  void sendReconnectStart();
+
+  void cancelReconnectPacingTimer() {
+    if (reconnect_pacing_timer_) {
+      reconnect_pacing_timer_->cancel();
+    }
+  }
+
   /**
    * Upper end of the window that this storage node knows about.  We keep
    * track of this to avoid sending duplicate WINDOW messages.
@@ -341,6 +355,9 @@ class ClientReadStreamSenderState : boost::noncopyable {
   std::unique_ptr<BackoffTimer> reconnect_timer_;
   std::unique_ptr<BackoffTimer> started_timer_;
   std::unique_ptr<BackoffTimer> retry_window_timer_;
+  // Delays a reconnect by what reserveReconnect() returned. Created the first
+  // time a reconnect is delayed.
+  std::unique_ptr<Timer> reconnect_pacing_timer_;
   friend class ClientReadStreamTest;
   friend class MockClientReadStreamDependencies;
 };
@@ -54,6 +54,11 @@ bool Log::operator==(const Log& other) const {
                     l.sequencerBatchingCompression,
                     l.sequencerBatchingPassthruThreshold,
                     l.tailOptimized,
+                    l.hedgedCopies,
+                    l.maxAppendBytesPerSecond,
+                    l.streamingIngest,
+                    l.compactRecordHeader,
+                    l.ephemeral,
                     l.customFields);
   };
   return as_tuple(*this) == as_tuple(other);
@@ -100,6 +105,11 @@ std::unique_ptr<Log> Log::fromLogAttributes(const std::string& rangeName,
   COPY_ATTR(sequencerBatchingCompression);
   COPY_ATTR(sequencerBatchingPassthruThreshold);
   COPY_ATTR(tailOptimized);
+  COPY_ATTR(hedgedCopies);
+  COPY_ATTR(maxAppendBytesPerSecond);
+  COPY_ATTR(streamingIngest);
+  COPY_ATTR(compactRecordHeader);
+  COPY_ATTR(ephemeral);
 #undef COPY_ATTR
   folly::dynamic customFields = folly::dynamic::object;
   if (attrs.extras().hasValue()) {
@@ -146,6 +156,11 @@ void Log::toLogAttributes(LogAttributes* out) const {
                        sequencerBatchingPassthruThreshold,
                        Attribute<LogAttributes::Shadow>(),
                        tailOptimized,
+                       hedgedCopies,
+                       maxAppendBytesPerSecond,
+                       streamingIngest,
+                       compactRecordHeader,
+                       ephemeral,
                        extras_map);
 }
 }}} // namespace facebook::logdevice::configuration
@@ -200,6 +200,35 @@ struct Log {
    */
   bool tailOptimized = false;
 
+  /**
+   * Number of copies added to the first wave of STOREs while some nodes of
+   * the nodeset are graylisted as slow.
+   */
+  int hedgedCopies = 0;
+
+  /**
+   * Maximum rate, in payload bytes per second, at which the sequencer accepts
+   * appends for the log. 0 means no limit.
+   */
+  int maxAppendBytesPerSecond = 0;
+
+  /**
+   * Skip the record cache on storage nodes and release records in batches,
+   * see LogAttributes::streamingIngest.
+   */
+  bool streamingIngest = false;
+
+  /**
+   * Write records with FLAG_COMPACT_HEADER, see
+   * LogAttributes::compactRecordHeader.
+   */
+  bool compactRecordHeader = false;
+
+  /**
+   * Store appends in memory only, see LogAttributes::ephemeral.
+   */
+  bool ephemeral = false;
+
   /**
    * Arbitrary fields that logdevice does not recognize
    */
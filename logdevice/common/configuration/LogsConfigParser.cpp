@@ -125,7 +125,12 @@ static const std::set<std::string> logs_config_recognized_keys = {
     SEQUENCER_BATCHING_COMPRESSION,
     SEQUENCER_BATCHING_PASSTHRU_THRESHOLD,
     SHADOW,
-    TAIL_OPTIMIZED};
+    TAIL_OPTIMIZED,
+    HEDGED_COPIES,
+    MAX_APPEND_BYTES_PER_SECOND,
+    STREAMING_INGEST,
+    COMPACT_RECORD_HEADER,
+    EPHEMERAL};
 
 static const std::set<std::string> logs_config_non_defaultable_keys = {
     "id",
@@ -776,12 +781,24 @@ parseAttributes(const folly::dynamic& attrs,
         Attribute<ssize_t>(),     /* sequencerBatchingPassthruThreshold */
         Attribute<LogAttributes::Shadow>(),     /* shadow */
         false,                                  /* tail optimized */
+        0,                                      /* hedged copies */
+        0,                                      /* max append bytes/s */
+        false,                                  /* streaming ingest */
+        false,                                  /* compact record header */
+        false,                                  /* ephemeral */
         Attribute<LogAttributes::ExtrasMap>()); /* extras */
   }
 
   Attribute<int> extraCopies;
   getIntAttributeFromMap<int>(attrs, EXTRA_COPIES, extraCopies, nullptr);
 
+  Attribute<int> hedgedCopies;
+  getIntAttributeFromMap<int>(attrs, HEDGED_COPIES, hedgedCopies, nullptr);
+
+  Attribute<int> maxAppendBytesPerSecond;
+  getIntAttributeFromMap<int>(
+      attrs, MAX_APPEND_BYTES_PER_SECOND, maxAppendBytesPerSecond, nullptr);
+
   Attribute<int> maxWritesInFlight;
   getIntAttributeFromMap<int>(
       attrs, MAX_WRITES_IN_FLIGHT, maxWritesInFlight, nullptr);
@@ -1094,6 +1111,53 @@ parseAttributes(const folly::dynamic& attrs,
     return nullptr;
   }
 
+  // Optional, defaults to false in logs/DefaultLogAttributes.h.
+  Attribute<bool> streamingIngest;
+  bool streamingIngest_bool = false;
+  success =
+      getBoolFromMap(attrs, STREAMING_INGEST, streamingIngest_bool, nullptr);
+  if (success) {
+    streamingIngest = streamingIngest_bool;
+  } else if (!success && err != E::NOTFOUND) {
+    ld_error("Invalid value for \"%s\" attribute of log range '%s'. Expected "
+             "a bool.",
+             STREAMING_INGEST,
+             interval_string.c_str());
+    err = E::INVALID_CONFIG;
+    return nullptr;
+  }
+
+  // Optional, defaults to false in logs/DefaultLogAttributes.h.
+  Attribute<bool> compactRecordHeader;
+  bool compactRecordHeader_bool = false;
+  success = getBoolFromMap(
+      attrs, COMPACT_RECORD_HEADER, compactRecordHeader_bool, nullptr);
+  if (success) {
+    compactRecordHeader = compactRecordHeader_bool;
+  } else if (!success && err != E::NOTFOUND) {
+    ld_error("Invalid value for \"%s\" attribute of log range '%s'. Expected "
+             "a bool.",
+             COMPACT_RECORD_HEADER,
+             interval_string.c_str());
+    err = E::INVALID_CONFIG;
+    return nullptr;
+  }
+
+  // Optional, defaults to false in logs/DefaultLogAttributes.h.
+  Attribute<bool> ephemeral;
+  bool ephemeral_bool = false;
+  success = getBoolFromMap(attrs, EPHEMERAL, ephemeral_bool, nullptr);
+  if (success) {
+    ephemeral = ephemeral_bool;
+  } else if (!success && err != E::NOTFOUND) {
+    ld_error("Invalid value for \"%s\" attribute of log range '%s'. Expected "
+             "a bool.",
+             EPHEMERAL,
+             interval_string.c_str());
+    err = E::INVALID_CONFIG;
+    return nullptr;
+  }
+
   // Adding fields that logdevice doesn't recognize
   Attribute<LogAttributes::ExtrasMap> extras;
   LogAttributes::ExtrasMap extras_map;
@@ -1143,6 +1207,11 @@ parseAttributes(const folly::dynamic& attrs,
                        sequencerBatchingPassthruThreshold,
                        shadow,
                        tailOptimized,
+                       hedgedCopies,
+                       maxAppendBytesPerSecond,
+                       streamingIngest,
+                       compactRecordHeader,
+                       ephemeral,
                        extras};
   return folly::Optional<LogAttributes>(std::move(output));
 }
@@ -139,6 +139,15 @@ int ReplicationProperty::validateLogAttributes(
     ERR("extraCopies is negative (" +
         std::to_string(log.extraCopies().value()) + ").");
   }
+  if (log.hedgedCopies().hasValue() && log.hedgedCopies().value() < 0) {
+    ERR("hedgedCopies is negative (" +
+        std::to_string(log.hedgedCopies().value()) + ").");
+  }
+  if (log.maxAppendBytesPerSecond().hasValue() &&
+      log.maxAppendBytesPerSecond().value() < 0) {
+    ERR("maxAppendBytesPerSecond is negative (" +
+        std::to_string(log.maxAppendBytesPerSecond().value()) + ").");
+  }
   if (log.syncedCopies().hasValue() && log.syncedCopies().value() < 0) {
     ERR("syncedCopies is negative (" +
         std::to_string(log.syncedCopies().value()) + ").");
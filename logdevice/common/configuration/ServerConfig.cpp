@@ -557,6 +557,35 @@ const std::string ServerConfig::toString(const LogsConfig* with_logs,
   return compressed_config_str;
 }
 
+const std::string
+ServerConfig::toZstdCompressedString(const ZookeeperConfig* with_zk) const {
+  std::lock_guard<std::mutex> guard(to_string_cache_mutex_);
+  if (!zstd_main_to_string_cache_.empty()) {
+    return zstd_main_to_string_cache_;
+  }
+  if (main_to_string_cache_.empty()) {
+    main_to_string_cache_ = toStringImpl(nullptr, with_zk);
+  }
+
+  if (!folly::io::hasCodec(folly::io::CodecType::ZSTD)) {
+    return std::string();
+  }
+
+  using folly::IOBuf;
+  std::unique_ptr<IOBuf> input = IOBuf::wrapBuffer(
+      main_to_string_cache_.data(), main_to_string_cache_.size());
+  auto codec = folly::io::getCodec(folly::io::CodecType::ZSTD);
+  std::unique_ptr<IOBuf> compressed;
+  try {
+    compressed = codec->compress(input.get());
+  } catch (const std::invalid_argument& ex) {
+    ld_error("zstd compression of config failed");
+    return std::string();
+  }
+  zstd_main_to_string_cache_ = compressed->moveToFbString().toStdString();
+  return zstd_main_to_string_cache_;
+}
+
 std::string ServerConfig::toStringImpl(const LogsConfig* with_logs,
                                        const ZookeeperConfig* with_zk) const {
   auto json = toJson(with_logs, with_zk);
@@ -534,6 +534,16 @@ class ServerConfig {
   const std::string toString(const LogsConfig* with_logs = nullptr,
                              const ZookeeperConfig* with_zk = nullptr,
                              bool compress = false) const;
+
+  /**
+   * Like toString(nullptr, with_zk, true), but compressed with zstd rather
+   * than gzip, which makes it smaller and faster to decompress. Cached like
+   * toString(). Returns an empty string if zstd is not available or
+   * compression failed.
+   */
+  const std::string
+  toZstdCompressedString(const ZookeeperConfig* with_zk = nullptr) const;
+
   folly::dynamic toJson(const LogsConfig* with_logs = nullptr,
                         const ZookeeperConfig* with_zk = nullptr) const;
 
@@ -618,6 +628,7 @@ class ServerConfig {
   mutable std::string compressed_all_to_string_cache_;
   mutable std::string main_to_string_cache_; // excludes the logs config
   mutable std::string compressed_main_to_string_cache_;
+  mutable std::string zstd_main_to_string_cache_;
   // The LogsConfig version at the last time toString() was called
   mutable uint64_t last_to_string_logs_config_version_{0};
 
@@ -74,6 +74,16 @@ class DefaultLogAttributes : public LogAttributes {
             Attribute<Shadow>(),
             /* tailOptimized */
             false,
+            /* hedgedCopies */
+            0,
+            /* maxAppendBytesPerSecond */
+            0,
+            /* streamingIngest */
+            false,
+            /* compactRecordHeader */
+            false,
+            /* ephemeral */
+            false,
             /* extras */
             Attribute<ExtrasMap>()) {}
 };
@@ -251,6 +251,12 @@ FBuffersLogsConfigCodec::fbuffers_deserialize<logsconfig::LogAttributes,
                    SEQUENCER_BATCHING_PASSTHRU_THRESHOLD,
                    ssize_t);
   DESERIALIZE_ATTR(tailOptimized, TAIL_OPTIMIZED, bool);
+  DESERIALIZE_ATTR(hedgedCopies, HEDGED_COPIES, int32_t);
+  DESERIALIZE_ATTR(
+      maxAppendBytesPerSecond, MAX_APPEND_BYTES_PER_SECOND, int32_t);
+  DESERIALIZE_ATTR(streamingIngest, STREAMING_INGEST, bool);
+  DESERIALIZE_ATTR(compactRecordHeader, COMPACT_RECORD_HEADER, bool);
+  DESERIALIZE_ATTR(ephemeral, EPHEMERAL, bool);
 
 #undef DESERIALIZE_ATTR_OPT
 #undef DESERIALIZE_ATTR
@@ -401,6 +407,11 @@ FBuffersLogsConfigCodec::fbuffers_deserialize<logsconfig::LogAttributes,
                        std::move(sequencerBatchingPassthruThreshold),
                        std::move(shadow),
                        std::move(tailOptimized),
+                       std::move(hedgedCopies),
+                       std::move(maxAppendBytesPerSecond),
+                       std::move(streamingIngest),
+                       std::move(compactRecordHeader),
+                       std::move(ephemeral),
                        std::move(extras)};
 }
 
@@ -159,6 +159,13 @@ FBuffersLogsConfigCodec::fbuffers_serialize(
                       Long,
                       attributes.sequencerBatchingPassthruThreshold);
   SERIALIZE_ATTRIBUTE(TAIL_OPTIMIZED, Bool, attributes.tailOptimized);
+  SERIALIZE_ATTRIBUTE(HEDGED_COPIES, Int, attributes.hedgedCopies);
+  SERIALIZE_ATTRIBUTE(
+      MAX_APPEND_BYTES_PER_SECOND, Int, attributes.maxAppendBytesPerSecond);
+  SERIALIZE_ATTRIBUTE(STREAMING_INGEST, Bool, attributes.streamingIngest);
+  SERIALIZE_ATTRIBUTE(
+      COMPACT_RECORD_HEADER, Bool, attributes.compactRecordHeader);
+  SERIALIZE_ATTRIBUTE(EPHEMERAL, Bool, attributes.ephemeral);
 
   // permissions
   std::vector<flatbuffers::Offset<fbuffers::Permission>> perms;
@@ -7,6 +7,7 @@
  */
 #include "logdevice/common/configuration/logs/LogsConfigTree.h"
 
+#include <algorithm>
 #include <deque>
 #include <iostream>
 
@@ -197,6 +198,29 @@ folly::dynamic LogGroupInDirectory::toFollyDynamic(bool metadata_logs) const {
 
   json_log[TAIL_OPTIMIZED] = attrs.tailOptimized().value();
 
+  if (attrs.hedgedCopies().hasValue() && attrs.hedgedCopies().value() > 0) {
+    json_log[HEDGED_COPIES] = attrs.hedgedCopies().value();
+  }
+
+  if (attrs.maxAppendBytesPerSecond().hasValue() &&
+      attrs.maxAppendBytesPerSecond().value() > 0) {
+    json_log[MAX_APPEND_BYTES_PER_SECOND] =
+        attrs.maxAppendBytesPerSecond().value();
+  }
+
+  if (attrs.streamingIngest().hasValue() && attrs.streamingIngest().value()) {
+    json_log[STREAMING_INGEST] = true;
+  }
+
+  if (attrs.compactRecordHeader().hasValue() &&
+      attrs.compactRecordHeader().value()) {
+    json_log[COMPACT_RECORD_HEADER] = true;
+  }
+
+  if (attrs.ephemeral().hasValue() && attrs.ephemeral().value()) {
+    json_log[EPHEMERAL] = true;
+  }
+
   if (attrs.shadow().hasValue() &&
       !attrs.shadow().value().destination().empty()) {
     json_log[SHADOW] = folly::dynamic::object();
@@ -1249,6 +1273,7 @@ void LogsConfigTree::updateLookupIndex(
   logs_index_.insert(
       logs_index_.end(),
       std::make_pair(interval, LogGroupInDirectory{log_group, parent}));
+  invalidateFlatIndex();
 }
 
 bool LogsConfigTree::deleteLogGroupFromLookupIndex(const logid_range_t& range) {
@@ -1266,6 +1291,7 @@ bool LogsConfigTree::deleteLogGroupFromLookupIndex(const logid_range_t& range) {
   }
   // clears that interval from the index
   logs_index_.erase(iter->first);
+  invalidateFlatIndex();
   return true;
 }
 
@@ -1293,9 +1319,80 @@ void LogsConfigTree::rebuildIndexForDir(const DirectoryNode* dir,
 
 void LogsConfigTree::rebuildIndex() {
   logs_index_.clear();
+  invalidateFlatIndex();
   rebuildIndexForDir(root_.get(), false);
 }
 
+namespace {
+
+// Maps each directory under `from` to its copy under `to`
+void mapDirectories(
+    const DirectoryNode* from,
+    const DirectoryNode* to,
+    std::unordered_map<const DirectoryNode*, const DirectoryNode*>& out) {
+  out[from] = to;
+  for (const auto& it : from->children()) {
+    auto copied = to->children().find(it.first);
+    if (copied != to->children().end()) {
+      mapDirectories(it.second.get(), copied->second.get(), out);
+    }
+  }
+}
+
+} // namespace
+
+void LogsConfigTree::copyIndex(const LogsConfigTree& other) {
+  std::unordered_map<const DirectoryNode*, const DirectoryNode*> dirs;
+  mapDirectories(other.root_.get(), root_.get(), dirs);
+
+  logs_index_ = other.logs_index_;
+  invalidateFlatIndex();
+  max_backlog_duration_ = std::chrono::seconds{0};
+  for (auto& it : logs_index_) {
+    auto dir = dirs.find(it.second.parent);
+    if (dir == dirs.end() || it.second.log_group == nullptr) {
+      ld_check(false);
+      rebuildIndex();
+      return;
+    }
+    it.second.parent = dir->second;
+    auto backlog = it.second.log_group->attrs().backlogDuration();
+    if (backlog.hasValue() && backlog.value().hasValue()) {
+      max_backlog_duration_ =
+          std::max(max_backlog_duration_, backlog.value().value());
+    }
+  }
+}
+
+const LogGroupInDirectory*
+LogsConfigTree::findInFlatIndex(logid_t::raw_type logid) const {
+  if (!flat_index_valid_.load()) {
+    std::lock_guard<std::mutex> lock(flat_index_mutex_);
+    if (!flat_index_valid_.load()) {
+      flat_index_.clear();
+      flat_index_.reserve(boost::icl::interval_count(logs_index_));
+      for (const auto& it : logs_index_) {
+        flat_index_.push_back(
+            FlatIndexEntry{it.first.upper(), it.first.lower(), &it.second});
+      }
+      flat_index_valid_.store(true);
+    }
+  }
+
+  // first range that ends after logid
+  auto it = std::upper_bound(
+      flat_index_.begin(),
+      flat_index_.end(),
+      logid,
+      [](logid_t::raw_type id, const FlatIndexEntry& e) {
+        return id < e.upper;
+      });
+  if (it == flat_index_.end() || it->lower > logid) {
+    return nullptr;
+  }
+  return it->log_group;
+}
+
 ReplicationProperty LogsConfigTree::getNarrowestReplication() const {
   return root_->getNarrowestReplication();
 }
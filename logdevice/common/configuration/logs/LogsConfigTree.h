@@ -7,11 +7,14 @@
  */
 #pragma once
 
+#include <atomic>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <boost/icl/interval_map.hpp>
 #include <boost/icl/map.hpp>
@@ -607,12 +610,11 @@ class LogsConfigTree {
   // this returns nullptr if the logid was not found.
   //
   const LogGroupInDirectory* getLogGroupByID(const logid_t& logid) const {
-    auto iter = logs_index_.find(logid.val());
-    if (iter == logs_index_.end()) {
+    const LogGroupInDirectory* res = findInFlatIndex(logid.val());
+    if (res == nullptr) {
       err = E::NOTFOUND;
-      return nullptr;
     }
-    return &iter->second;
+    return res;
   }
 
   std::pair<DirectoryNode*, std::shared_ptr<LogGroupNode>>
@@ -620,8 +622,7 @@ class LogsConfigTree {
 
   // returns true if the logid exists in the tree
   bool logExists(logid_t logid) const {
-    auto iter = logs_index_.find(logid.val());
-    if (iter == logs_index_.end()) {
+    if (findInFlatIndex(logid.val()) == nullptr) {
       err = E::NOTFOUND;
       return false;
     }
@@ -710,9 +711,7 @@ class LogsConfigTree {
     delimiter_ = other.delimiter_;
     root_ = std::make_unique<DirectoryNode>(*other.root_);
     version_ = other.version_;
-    // We cannot copy the index because the Parent pointer in
-    // LogGroupInDirectory will be pointing to the old tree.
-    rebuildIndex();
+    copyIndex(other);
     return *this;
   }
 
@@ -745,6 +744,22 @@ class LogsConfigTree {
   // same as rebuildIndexForDir except that this rebuilds the whole tree
   void rebuildIndex();
 
+  // Sets the lookup index to the one of `other`, of which root_ was just
+  // copied, pointing its entries to the directories of this tree. Copying the
+  // index takes linear time while rebuilding it takes O(n log n) inserts into
+  // the interval map, for every copy LogsConfigManager makes of the tree on
+  // each delta. Falls back to rebuildIndex() if a directory can't be mapped.
+  void copyIndex(const LogsConfigTree& other);
+
+  // Looks up the log group of a log id in flat_index_, building it first if
+  // logs_index_ changed since it was last built. nullptr if not found.
+  const LogGroupInDirectory* findInFlatIndex(logid_t::raw_type logid) const;
+
+  // Must be called whenever logs_index_ changes.
+  void invalidateFlatIndex() {
+    flat_index_valid_.store(false);
+  }
+
   std::string normalize_path(const std::string& path) const;
   /*
    * Used by print() to print a specific directory level
@@ -781,6 +796,22 @@ class LogsConfigTree {
   // maximum finite backlog duration of a log
   std::chrono::seconds max_backlog_duration_{0};
   LogMap logs_index_;
+
+  struct FlatIndexEntry {
+    // [lower, upper) is the range of the log group
+    logid_t::raw_type upper;
+    logid_t::raw_type lower;
+    // points into logs_index_
+    const LogGroupInDirectory* log_group;
+  };
+  // A copy of logs_index_ as an array sorted by range, built on the first
+  // lookup after logs_index_ changes. Lookups by log id are on the hot path of
+  // appends and reads and a binary search over this array is cheaper than
+  // walking the tree of the interval map. Trees are shared between threads
+  // once built, hence the mutex for building the index lazily.
+  mutable std::vector<FlatIndexEntry> flat_index_;
+  mutable std::atomic<bool> flat_index_valid_{false};
+  mutable std::mutex flat_index_mutex_;
   // Max version seen, this is meant to be used if this tree is not backed by
   // LogsConfigManager.
   static std::atomic<uint64_t> max_version;
@@ -148,15 +148,31 @@ int EventLogStateMachine::serializeDelta(const EventLogRecord& delta,
 int EventLogStateMachine::serializeState(const EventLogRebuildingSet& state,
                                          void* buf,
                                          size_t buf_size) {
-  flatbuffers::FlatBufferBuilder builder;
-  auto set = EventLogRebuildingSetCodec::serialize(builder, state);
-  builder.Finish(set);
-  Payload payload(builder.GetBufferPointer(), builder.GetSize());
+  // ReplicatedStateMachine calls this twice per snapshot: first without a
+  // buffer to get the size, then to serialize the same state. Reuse the
+  // flatbuffer built by the first call.
+  std::unique_ptr<flatbuffers::FlatBufferBuilder> builder;
+  if (serialized_state_ && serialized_state_src_ == &state &&
+      serialized_state_version_ == state.getLastSeenLSN()) {
+    builder = std::move(serialized_state_);
+  } else {
+    builder = std::make_unique<flatbuffers::FlatBufferBuilder>();
+    auto set = EventLogRebuildingSetCodec::serialize(*builder, state);
+    builder->Finish(set);
+  }
+  serialized_state_.reset();
+  serialized_state_src_ = nullptr;
+
+  const int size = builder->GetSize();
   if (buf) {
-    ld_check(buf_size >= builder.GetSize());
-    memcpy(buf, builder.GetBufferPointer(), builder.GetSize());
+    ld_check(buf_size >= size);
+    memcpy(buf, builder->GetBufferPointer(), size);
+  } else {
+    serialized_state_ = std::move(builder);
+    serialized_state_src_ = &state;
+    serialized_state_version_ = state.getLastSeenLSN();
   }
-  return builder.GetSize();
+  return size;
 }
 
 void EventLogStateMachine::writeDelta(
@@ -224,6 +224,14 @@ class EventLogStateMachine
 
   // worker running this state machine
   worker_id_t worker_{-1};
+
+  // Flatbuffer built by serializeState() when it was asked for the size of a
+  // state, kept for the call that serializes the same state onto a buffer
+  // right after, so that a snapshot encodes the rebuilding set only once.
+  std::unique_ptr<flatbuffers::FlatBufferBuilder> serialized_state_;
+  // State and version serialized_state_ was built from
+  const EventLogRebuildingSet* serialized_state_src_{nullptr};
+  lsn_t serialized_state_version_{LSN_INVALID};
 };
 
 /**
@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <string>
+
+#include "logdevice/common/plugin/Plugin.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Object storage outside of the storage node, e.g. a blob store.
+ * PartitionedRocksDBStore uploads old partitions to it and deletes their
+ * local copy if --rocksdb-partition-offload-age is set, and downloads them
+ * back when they are read or written.
+ *
+ * Objects are whole files identified by a key. All methods are called from
+ * storage and background threads, may block, and must be thread safe.
+ */
+
+class RemoteStorage : public Plugin {
+ public:
+  PluginType type() const override {
+    return PluginType::REMOTE_STORAGE;
+  }
+
+  /**
+   * Uploads the local file at `path` as object `key`, replacing the object
+   * if it exists.
+   *
+   * @return 0 on success, -1 on failure.
+   */
+  virtual int upload(const std::string& key, const std::string& path) = 0;
+
+  /**
+   * Writes the contents of object `key` to the local file at `path`.
+   *
+   * @return 0 on success, -1 on failure, including if the object doesn't
+   *         exist.
+   */
+  virtual int download(const std::string& key, const std::string& path) = 0;
+
+  /**
+   * Deletes object `key`. Deleting an object that doesn't exist succeeds.
+   *
+   * @return 0 on success, -1 on failure.
+   */
+  virtual int remove(const std::string& key) = 0;
+};
+
+}} // namespace facebook::logdevice
@@ -57,12 +57,20 @@ operator=(const APPENDED_Header& hdr) {
 }
 
 void APPENDED_Message::serialize(ProtocolWriter& writer) const {
+  ld_check((header_.flags & APPENDED_Header::INCLUDES_RETRY_DELAY) ==
+           retry_delay_ms.hasValue());
+  APPENDED_Header header = header_;
+  if (writer.proto() < Compatibility::APPENDED_RETRY_DELAY_SUPPORT) {
+    // Older clients still see E::SEQNOBUFS, just without the hint.
+    header.flags &= ~APPENDED_Header::INCLUDES_RETRY_DELAY;
+  }
+
   if (writer.proto() >=
       Compatibility::ProtocolVersion::RECORD_TIMESTAMP_IN_APPENDED_MSG) {
-    writer.write(header_);
+    writer.write(header);
   } else {
     Legacy_APPENDED_Header legacy;
-    legacy = header_;
+    legacy = header;
     writer.write(legacy);
   }
 
@@ -72,6 +80,10 @@ void APPENDED_Message::serialize(ProtocolWriter& writer) const {
     uint32_t offset = seq_batching_offset.value();
     writer.write(offset);
   }
+  if (header.flags & APPENDED_Header::INCLUDES_RETRY_DELAY) {
+    uint32_t delay = retry_delay_ms.value();
+    writer.write(delay);
+  }
 }
 
 MessageReadResult APPENDED_Message::deserialize(ProtocolReader& reader) {
@@ -93,6 +105,11 @@ MessageReadResult APPENDED_Message::deserialize(ProtocolReader& reader) {
     reader.read(&offset);
     m->seq_batching_offset = offset;
   }
+  if (hdr.flags & APPENDED_Header::INCLUDES_RETRY_DELAY) {
+    uint32_t delay;
+    reader.read(&delay);
+    m->retry_delay_ms = delay;
+  }
   return reader.resultMsg(std::move(m));
 }
 
@@ -147,6 +164,10 @@ Message::Disposition APPENDED_Message::onReceived(const Address& from) {
   auto pos = w->runningAppends().map.find(header_.rqid);
   if (pos != w->runningAppends().map.end()) {
     ld_check(pos->second);
+    if (retry_delay_ms.hasValue()) {
+      pos->second->onRetryDelayReceived(
+          std::chrono::milliseconds(retry_delay_ms.value()));
+    }
     pos->second->onReplyReceived(header_, from, ReplySource::APPEND);
   } else {
     ld_debug("Request id %" PRIu64 " not found in the map of running Append "
@@ -170,6 +191,7 @@ APPENDED_Message::getDebugInfo() const {
     FLAG(INCLUDES_SEQ_BATCHING_OFFSET)
     FLAG(NOT_REPLICATED)
     FLAG(REDIRECT_NOT_ALIVE)
+    FLAG(INCLUDES_RETRY_DELAY)
 #undef FLAG
     return folly::join('|', strings);
   };
@@ -188,6 +210,9 @@ APPENDED_Message::getDebugInfo() const {
   if (seq_batching_offset.hasValue()) {
     add("seq_batching_offset", seq_batching_offset.value());
   }
+  if (retry_delay_ms.hasValue()) {
+    add("retry_delay_ms", retry_delay_ms.value());
+  }
 
   return res;
 }
@@ -80,6 +80,12 @@ struct APPENDED_Header {
   // preemptor doesn't seem to be alive. In that case clients need to retry the
   // append rather than follow the redirect.
   static const APPENDED_flags_t REDIRECT_NOT_ALIVE = 4;
+  // If set, the append was rejected with E::SEQNOBUFS because the log is over
+  // its append rate limit, and the header is followed by uint32_t
+  // `retry_delay_ms', how long the client should wait before appending to the
+  // log again. Only sent with protocol >=
+  // Compatibility::APPENDED_RETRY_DELAY_SUPPORT.
+  static const APPENDED_flags_t INCLUDES_RETRY_DELAY = 8;
 
   const APPENDED_Header& operator=(const Legacy_APPENDED_Header&);
 };
@@ -127,6 +133,8 @@ class APPENDED_Message : public Message {
   // avoid bloating the append API with the offset, we just stash it into a
   // thread-local that can be read by the Contest-supporting part of loadtest.
   static __thread uint32_t last_seq_batching_offset;
+  // See APPENDED_Header::INCLUDES_RETRY_DELAY
+  folly::Optional<uint32_t> retry_delay_ms;
 };
 
 }} // namespace facebook::logdevice
@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "APPENDS_Message.h"
+
+#include <algorithm>
+
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+APPENDS_Message::APPENDS_Message(
+    std::vector<std::unique_ptr<APPEND_Message>> appends)
+    : Message(MessageType::APPENDS, TrafficClass::APPEND),
+      appends_(std::move(appends)) {}
+
+bool APPENDS_Message::cancelled() const {
+  // APPENDs whose AppendRequest is gone are still sent along with the others,
+  // the APPENDED replies are ignored.
+  return std::all_of(appends_.begin(), appends_.end(), [](const auto& append) {
+    return append->cancelled();
+  });
+}
+
+void APPENDS_Message::serialize(ProtocolWriter& writer) const {
+  APPENDS_Header header = {uint32_t(appends_.size())};
+  writer.write(header);
+  for (const auto& append : appends_) {
+    append->serializeInBatch(writer);
+  }
+}
+
+MessageReadResult APPENDS_Message::deserialize(ProtocolReader& reader) {
+  return deserialize(reader, Worker::settings().max_payload_inline);
+}
+
+MessageReadResult APPENDS_Message::deserialize(ProtocolReader& reader,
+                                               size_t max_payload_inline) {
+  APPENDS_Header header;
+  reader.read(&header);
+
+  // Every APPEND takes at least an APPEND_Header, don't let a corrupted count
+  // make us allocate a huge vector.
+  if (reader.ok() &&
+      uint64_t(header.num_appends) * sizeof(APPEND_Header) >
+          reader.bytesRemaining()) {
+    reader.setError(E::BADMSG);
+  }
+
+  std::vector<std::unique_ptr<APPEND_Message>> appends;
+  if (reader.ok()) {
+    appends.reserve(header.num_appends);
+  }
+  for (uint32_t i = 0; reader.ok() && i < header.num_appends; ++i) {
+    auto append =
+        APPEND_Message::deserializeInBatch(reader, max_payload_inline);
+    if (!append) {
+      break;
+    }
+    appends.push_back(std::move(append));
+  }
+
+  return reader.result(
+      [&] { return new APPENDS_Message(std::move(appends)); });
+}
+
+uint16_t APPENDS_Message::getMinProtocolVersion() const {
+  return Compatibility::APPENDS_MESSAGE_SUPPORT;
+}
+
+void APPENDS_Message::onSent(Status st, const Address& to) const {
+  if (st == E::OK) {
+    WORKER_STAT_INCR(appends_batch_messages_sent);
+    WORKER_STAT_ADD(appends_batched, appends_.size());
+  }
+  // Complete every APPEND as if it had been sent in its own message, so that
+  // AppendRequests see the same outcome either way.
+  for (const auto& append : appends_) {
+    append->onSent(st, to);
+  }
+}
+
+Message::Disposition APPENDS_Message::onReceived(const Address& from) {
+  WORKER_STAT_INCR(appends_batch_messages_received);
+  for (auto& append : appends_) {
+    Message::Disposition disp = append->onReceived(from);
+    if (disp == Message::Disposition::ERROR) {
+      return disp;
+    }
+  }
+  return Disposition::NORMAL;
+}
+
+std::string APPENDS_Message::identify() const {
+  std::string res = "appends=" + std::to_string(appends_.size());
+  if (!appends_.empty()) {
+    res += ",first_log=" + toString(appends_.front()->header_.logid);
+  }
+  return res;
+}
+
+}} // namespace facebook::logdevice
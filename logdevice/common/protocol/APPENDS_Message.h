@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "logdevice/common/protocol/APPEND_Message.h"
+#include "logdevice/common/protocol/Message.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Message sent by a client to deliver the APPENDs of several records to
+ * the same sequencer node at once, typically records for different logs
+ * passed to Client::appendMulti(). Equivalent to sending one APPEND_Message
+ * per record: the node runs a separate Appender for every APPEND and answers
+ * each with its own APPENDED, but the APPENDs go through the messaging layer
+ * as a single message. Clients only send it to nodes whose protocol is at
+ * least Compatibility::APPENDS_MESSAGE_SUPPORT (see
+ * AppendRequestMap::enqueueAppendForBatch()).
+ */
+
+struct APPENDS_Header {
+  uint32_t num_appends; // number of APPENDs following the header
+} __attribute__((__packed__));
+
+class APPENDS_Message : public Message {
+ public:
+  explicit APPENDS_Message(
+      std::vector<std::unique_ptr<APPEND_Message>> appends);
+
+  // see Message.h
+  bool cancelled() const override;
+  void serialize(ProtocolWriter&) const override;
+  static Message::deserializer_t deserialize;
+  // Overload of deserialize that does not need to run in an EventLoop
+  // context
+  static MessageReadResult deserialize(ProtocolReader&,
+                                       size_t max_payload_inline);
+  uint16_t getMinProtocolVersion() const override;
+  void onSent(Status st, const Address& to) const override;
+  Disposition onReceived(const Address& from) override;
+
+  std::string identify() const;
+
+  std::vector<std::unique_ptr<APPEND_Message>> appends_;
+};
+
+}} // namespace facebook::logdevice
@@ -33,6 +33,15 @@
 namespace facebook { namespace logdevice {
 
 void APPEND_Message::serialize(ProtocolWriter& writer) const {
+  serializeImpl(writer, /*in_batch=*/false);
+}
+
+void APPEND_Message::serializeInBatch(ProtocolWriter& writer) const {
+  serializeImpl(writer, /*in_batch=*/true);
+}
+
+void APPEND_Message::serializeImpl(ProtocolWriter& writer,
+                                   bool in_batch) const {
   ld_check(payload_.valid());
 
   const auto proto = writer.proto();
@@ -79,11 +88,17 @@ void APPEND_Message::serialize(ProtocolWriter& writer) const {
     }
   }
 
+  const int checksum_bits = !(header_.flags & APPEND_Header::CHECKSUM)
+      ? 0
+      : (header_.flags & APPEND_Header::CHECKSUM_64BIT) ? 64 : 32;
+  if (in_batch) {
+    // The receiver sees the checksum as part of the payload.
+    writer.write(static_cast<uint32_t>(checksum_bits / 8 + payload_.size()));
+  }
+
   // If we are supposed to checksum the payload, calculate it now and inject the
   // checksum at the front of the payload.
   if (header_.flags & APPEND_Header::CHECKSUM) {
-    int checksum_bits =
-        (header_.flags & APPEND_Header::CHECKSUM_64BIT) ? 64 : 32;
     if (writer.isBlackHole()) {
       // no need to checksum anything, just add the appropriate number of bytes
       writer.write(nullptr, checksum_bits / 8);
@@ -136,6 +151,20 @@ MessageReadResult APPEND_Message::deserialize(ProtocolReader& reader) {
 
 MessageReadResult APPEND_Message::deserialize(ProtocolReader& reader,
                                               size_t max_payload_inline) {
+  auto m = deserializeImpl(reader, max_payload_inline, /*in_batch=*/false);
+  return reader.result([&] { return std::move(m); });
+}
+
+std::unique_ptr<APPEND_Message>
+APPEND_Message::deserializeInBatch(ProtocolReader& reader,
+                                   size_t max_payload_inline) {
+  return deserializeImpl(reader, max_payload_inline, /*in_batch=*/true);
+}
+
+std::unique_ptr<APPEND_Message>
+APPEND_Message::deserializeImpl(ProtocolReader& reader,
+                                size_t max_payload_inline,
+                                bool in_batch) {
   APPEND_Header header;
   header.flags = 0;
   reader.read(&header);
@@ -186,20 +215,31 @@ MessageReadResult APPEND_Message::deserialize(ProtocolReader& reader,
     reader.readLengthPrefixedVector(&tracing_info);
   }
 
+  // Inside an APPENDS message, the payload is followed by other APPENDs and
+  // its size precedes it.
   size_t payload_size = reader.bytesRemaining();
+  if (in_batch) {
+    uint32_t size = 0;
+    reader.read(&size);
+    payload_size = size;
+    if (reader.ok() && payload_size > reader.bytesRemaining()) {
+      reader.setError(E::BADMSG);
+    }
+  }
   ld_check(payload_size < Message::MAX_LEN);
   PayloadHolder ph = PayloadHolder::deserialize(
       reader,
       payload_size,
       /*zero_copy*/ payload_size > max_payload_inline);
 
-  return reader.result([&] {
-    return new APPEND_Message(header,
-                              lsn_before_redirect,
-                              std::move(attrs),
-                              std::move(ph),
-                              std::move(tracing_info));
-  });
+  if (!reader.ok()) {
+    return nullptr;
+  }
+  return std::make_unique<APPEND_Message>(header,
+                                          lsn_before_redirect,
+                                          std::move(attrs),
+                                          std::move(ph),
+                                          std::move(tracing_info));
 }
 
 Message::Disposition APPEND_Message::onReceived(const Address& from) {
@@ -221,6 +261,7 @@ Message::Disposition APPEND_Message::onReceived(const Address& from) {
     }
   }
   WORKER_LOG_STAT_ADD(header_.logid, append_payload_bytes, payload_size);
+  LOG_HEAVY_HITTER_ADD(stats, APPENDED_BYTES, header_.logid, payload_size);
 
   std::shared_ptr<opentracing::Tracer> e2e_tracer =
       Worker::onThisThread()->processor_->getPlugin()->createOTTracer();
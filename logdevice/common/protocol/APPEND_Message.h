@@ -110,8 +110,26 @@ class APPEND_Message : public Message {
   static MessageReadResult deserialize(ProtocolReader&,
                                        size_t max_payload_inline);
 
+  /**
+   * Serializes the message as part of an APPENDS message: the same as
+   * serialize(), except that the payload (including its checksum, if any) is
+   * prefixed with its size, so that other APPENDs can follow it.
+   */
+  void serializeInBatch(ProtocolWriter& writer) const;
+
+  /**
+   * @return  the APPEND written by serializeInBatch(), or nullptr if the
+   *          reader is in an error state afterwards
+   */
+  static std::unique_ptr<APPEND_Message>
+  deserializeInBatch(ProtocolReader& reader, size_t max_payload_inline);
+
   const APPEND_Header header_;
 
+  size_t getPayloadSize() const {
+    return payload_.size();
+  }
+
   virtual std::vector<std::pair<std::string, folly::dynamic>>
   getDebugInfo() const override;
 
@@ -132,6 +150,12 @@ class APPEND_Message : public Message {
   // Need a serialization of the tracing information gathered so far
   std::string e2e_tracing_context_;
 
+  void serializeImpl(ProtocolWriter& writer, bool in_batch) const;
+  static std::unique_ptr<APPEND_Message>
+  deserializeImpl(ProtocolReader& reader,
+                  size_t max_payload_inline,
+                  bool in_batch);
+
   friend class ChecksumTest;
   friend class MessageSerializationTest;
   friend class E2ETracingSerializationTest;
@@ -32,6 +32,12 @@ void CONFIG_CHANGED_Message::serialize(ProtocolWriter& writer) const {
     config_str_size_t size = config_str_.size();
     writer.write(size);
     writer.writeVector(config_str_);
+    if (writer.proto() >= Compatibility::CONFIG_CHANGED_ZSTD_SUPPORT) {
+      writer.write(compression_);
+    } else {
+      // the sender is expected to only use zstd with peers that support it
+      ld_check(compression_ == CONFIG_CHANGED_Header::Compression::GZIP);
+    }
   }
 }
 
@@ -39,14 +45,18 @@ MessageReadResult CONFIG_CHANGED_Message::deserialize(ProtocolReader& reader) {
   CONFIG_CHANGED_Header hdr;
   reader.read(&hdr);
   std::string config_str;
+  auto compression = CONFIG_CHANGED_Header::Compression::GZIP;
   if (hdr.action == CONFIG_CHANGED_Header::Action::UPDATE) {
     config_str_size_t size = 0;
     reader.read(&size);
     config_str.resize(size);
     reader.read(const_cast<char*>(config_str.data()), config_str.size());
+    reader.protoGate(Compatibility::CONFIG_CHANGED_ZSTD_SUPPORT);
+    reader.read(&compression);
   }
-  return reader.result(
-      [&] { return new CONFIG_CHANGED_Message(hdr, config_str); });
+  return reader.result([&] {
+    return new CONFIG_CHANGED_Message(hdr, config_str, compression);
+  });
 }
 
 Message::Disposition CONFIG_CHANGED_Message::onReceived(const Address& from) {
@@ -141,12 +151,26 @@ Message::Disposition CONFIG_CHANGED_Message::onReceived(const Address& from) {
   using folly::IOBuf;
   std::unique_ptr<IOBuf> input =
       IOBuf::wrapBuffer(config_str_.data(), config_str_.size());
-  auto codec = folly::io::getCodec(folly::io::CodecType::GZIP);
+  folly::io::CodecType codec_type;
+  switch (compression_) {
+    case CONFIG_CHANGED_Header::Compression::GZIP:
+      codec_type = folly::io::CodecType::GZIP;
+      break;
+    case CONFIG_CHANGED_Header::Compression::ZSTD:
+      codec_type = folly::io::CodecType::ZSTD;
+      break;
+    default:
+      ld_error("Unknown compression %u of CONFIG_CHANGED_Message body",
+               static_cast<unsigned>(compression_));
+      err = E::BADMSG;
+      return Disposition::ERROR;
+  }
+  auto codec = folly::io::getCodec(codec_type);
   std::unique_ptr<IOBuf> uncompressed;
   try {
     uncompressed = codec->uncompress(input.get());
   } catch (const std::runtime_error& ex) {
-    ld_error("gzip decompression of CONFIG_CHANGED_Message body failed");
+    ld_error("Decompression of CONFIG_CHANGED_Message body failed");
     err = E::BADMSG;
     return Disposition::ERROR;
   }
@@ -27,6 +27,10 @@ struct CONFIG_CHANGED_Header {
     // Used by config synchronization to provide the new config
     UPDATE = 1
   };
+  // How the config in an UPDATE is compressed. Not part of the header: sent
+  // after the config, only to peers that support
+  // Compatibility::CONFIG_CHANGED_ZSTD_SUPPORT, otherwise it is GZIP.
+  enum class Compression : uint8_t { GZIP = 0, ZSTD = 1 };
   uint64_t modified_time;
   config_version_t version;
   // Used to determine whether the config in the message body can be trusted.
@@ -50,11 +54,15 @@ class CONFIG_CHANGED_Message : public Message {
         Message(MessageType::CONFIG_CHANGED, TrafficClass::RECOVERY),
         header_(header) {}
 
-  explicit CONFIG_CHANGED_Message(const CONFIG_CHANGED_Header& header,
-                                  const std::string& config_str)
+  explicit CONFIG_CHANGED_Message(
+      const CONFIG_CHANGED_Header& header,
+      const std::string& config_str,
+      CONFIG_CHANGED_Header::Compression compression =
+          CONFIG_CHANGED_Header::Compression::GZIP)
       : Message(MessageType::CONFIG_CHANGED, TrafficClass::RECOVERY),
         header_(header),
-        config_str_(config_str) {}
+        config_str_(config_str),
+        compression_(compression) {}
 
   void serialize(ProtocolWriter&) const override;
   static Message::deserializer_t deserialize;
@@ -62,8 +70,11 @@ class CONFIG_CHANGED_Message : public Message {
   Disposition onReceived(const Address& from) override;
 
  private:
+  friend class MessageSerializationTest;
+
   CONFIG_CHANGED_Header header_;
   std::string config_str_;
+  CONFIG_CHANGED_Header::Compression compression_;
 };
 
 }} // namespace facebook::logdevice
@@ -67,6 +67,54 @@ enum ProtocolVersion : uint16_t {
 
   OFFSET_MAP_SUPPORT_IN_SEALED_MSG, // = 85
 
+  // Clients can send FINDKEY_BATCH to resolve findTime() for many logs in one
+  // message
+  FINDKEY_BATCH_SUPPORT, // = 86
+
+  // Storage nodes can deliver several records of a read stream in one RECORDS
+  // message
+  RECORDS_MESSAGE_SUPPORT, // = 87
+
+  // Sequencers can send the STOREs of several records to a storage node in one
+  // STORES message
+  STORES_MESSAGE_SUPPORT, // = 88
+
+  // Clients can send the APPENDs of several records to a sequencer node in one
+  // APPENDS message
+  APPENDS_MESSAGE_SUPPORT, // = 89
+
+  // APPENDED messages rejecting an append with E::SEQNOBUFS because of the
+  // log's append rate limit may include a retry delay
+  APPENDED_RETRY_DELAY_SUPPORT, // = 90
+
+  // Readers can send the STARTs of several read streams to a storage node in
+  // one STARTS message
+  STARTS_MESSAGE_SUPPORT, // = 91
+
+  // Readers can send the WINDOW updates of several read streams to a storage
+  // node in one WINDOWS message
+  WINDOWS_MESSAGE_SUPPORT, // = 92
+
+  // The config in CONFIG_CHANGED messages may be compressed with zstd, as
+  // indicated by a byte after it
+  CONFIG_CHANGED_ZSTD_SUPPORT, // = 93
+
+  // GOSSIP messages write the gossip list with the narrowest integer type
+  // that fits its entries and the gossip timestamps as 32-bit offsets
+  GOSSIP_COMPACT_LISTS_SUPPORT, // = 94
+
+  // STORED messages may carry a breakdown of where the STORE spent its time
+  // on the storage node (STORED_Header::TIMINGS)
+  STORED_TIMINGS_SUPPORT, // = 95
+
+  // Clients can send IS_LOG_EMPTY_BATCH and DATA_SIZE_BATCH to query many
+  // logs in one message
+  LOG_QUERY_BATCH_SUPPORT, // = 96
+
+  // Sequencers can send the RELEASEs of several logs to a storage node in one
+  // RELEASES message
+  RELEASES_MESSAGE_SUPPORT, // = 97
+
   // NOTE: insert new protocol versions here
 
   // Maximum version number of the protocol this version of LogDevice
@@ -97,6 +145,18 @@ static_assert(TAIL_RECORD_IN_GSS_REPLY == 82, "");
 static_assert(STORE_E2E_TRACING_SUPPORT == 83, "");
 static_assert(OFFSET_MAP_SUPPORT == 84, "");
 static_assert(OFFSET_MAP_SUPPORT_IN_SEALED_MSG == 85, "");
+static_assert(FINDKEY_BATCH_SUPPORT == 86, "");
+static_assert(RECORDS_MESSAGE_SUPPORT == 87, "");
+static_assert(STORES_MESSAGE_SUPPORT == 88, "");
+static_assert(APPENDS_MESSAGE_SUPPORT == 89, "");
+static_assert(APPENDED_RETRY_DELAY_SUPPORT == 90, "");
+static_assert(STARTS_MESSAGE_SUPPORT == 91, "");
+static_assert(WINDOWS_MESSAGE_SUPPORT == 92, "");
+static_assert(CONFIG_CHANGED_ZSTD_SUPPORT == 93, "");
+static_assert(GOSSIP_COMPACT_LISTS_SUPPORT == 94, "");
+static_assert(STORED_TIMINGS_SUPPORT == 95, "");
+static_assert(LOG_QUERY_BATCH_SUPPORT == 96, "");
+static_assert(RELEASES_MESSAGE_SUPPORT == 97, "");
 
 constexpr uint16_t MIN_PROTOCOL_SUPPORTED = PROTOCOL_VERSION_LOWER_BOUND + 1;
 constexpr uint16_t MAX_PROTOCOL_SUPPORTED = PROTOCOL_VERSION_UPPER_BOUND - 1;
@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "FINDKEY_BATCH_Message.h"
+
+#include "logdevice/common/FindKeyRequest.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+
+namespace facebook { namespace logdevice {
+
+void FINDKEY_BATCH_Message::serialize(ProtocolWriter& writer) const {
+  FINDKEY_BATCH_Header header = {uint32_t(entries_.size()), shard_};
+  writer.write(header);
+  writer.writeVector(entries_);
+}
+
+MessageReadResult FINDKEY_BATCH_Message::deserialize(ProtocolReader& reader) {
+  FINDKEY_BATCH_Header header;
+  reader.read(&header);
+  std::vector<FINDKEY_Header> entries;
+  reader.readVector(&entries, header.count);
+  return reader.result([&] {
+    return new FINDKEY_BATCH_Message(header.shard, std::move(entries));
+  });
+}
+
+void FINDKEY_BATCH_Message::onSent(Status status, const Address& to) const {
+  Message::onSent(status, to);
+
+  auto& rqmap = Worker::onThisThread()->runningFindKey();
+  if (status == E::PROTONOSUPPORT) {
+    // The server is too old to understand batches. Fall back to sending
+    // an individual FINDKEY for each entry.
+    rqmap.onBatchNotSupported(to.id_.node_.index(), shard_, entries_);
+    return;
+  }
+
+  // Inform the FindKeyRequests of the outcome of sending the message
+  for (const FINDKEY_Header& entry : entries_) {
+    auto it = rqmap.map.find(entry.client_rqid);
+    if (it != rqmap.map.end()) {
+      it->second->onMessageSent(ShardID(to.id_.node_.index(), shard_), status);
+    }
+  }
+}
+
+uint16_t FINDKEY_BATCH_Message::getMinProtocolVersion() const {
+  return Compatibility::FINDKEY_BATCH_SUPPORT;
+}
+
+}} // namespace facebook::logdevice
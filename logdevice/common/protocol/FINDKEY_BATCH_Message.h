@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <vector>
+
+#include "logdevice/common/protocol/FINDKEY_Message.h"
+#include "logdevice/common/protocol/Message.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Message sent by the client library to a storage node to resolve
+ * findTime() for many logs at once. Equivalent to sending one FINDKEY_Message
+ * per entry, but lets the storage node process all of them in a single
+ * storage task. Storage nodes reply with one FINDKEY_REPLY_Message per entry.
+ *
+ * Only used for findTime(); findKey() requests are always sent as individual
+ * FINDKEY_Messages.
+ */
+
+struct FINDKEY_BATCH_Header {
+  uint32_t count;      // number of entries following the header
+  shard_index_t shard; // shard on which to look for all the logs
+} __attribute__((__packed__));
+
+class FINDKEY_BATCH_Message : public Message {
+ public:
+  FINDKEY_BATCH_Message(shard_index_t shard,
+                        std::vector<FINDKEY_Header> entries)
+      : Message(MessageType::FINDKEY_BATCH, TrafficClass::READ_BACKLOG),
+        shard_(shard),
+        entries_(std::move(entries)) {}
+
+  void serialize(ProtocolWriter&) const override;
+  static Message::deserializer_t deserialize;
+
+  Disposition onReceived(const Address&) override {
+    // Receipt handler lives in server/FINDKEY_onReceived.cpp; this should
+    // never get called.
+    std::abort();
+  }
+  void onSent(Status st, const Address& to) const override;
+  uint16_t getMinProtocolVersion() const override;
+
+  const shard_index_t shard_;
+
+  // Each entry has the same meaning as the header of a FINDKEY_Message
+  // without the USER_KEY flag. Entries' `shard` is equal to shard_.
+  std::vector<FINDKEY_Header> entries_;
+};
+
+}} // namespace facebook::logdevice
@@ -9,6 +9,7 @@
 
 #include <string>
 
+#include "logdevice/common/MessageArena.h"
 #include "logdevice/common/protocol/FixedSizeMessage.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/include/EnumMap.h"
@@ -76,6 +77,9 @@ struct GAP_Header {
 
 class GAP_Message : public Message {
  public:
+  // Received instances are short-lived, see MessageArena.
+  MESSAGE_ARENA_ALLOCATED
+
   // identifies the origin of the gap
   enum class Source { LOCAL_LOG_STORE, CACHED_DIGEST };
 
@@ -18,6 +18,7 @@
 #include "logdevice/common/protocol/GET_SEQ_STATE_REPLY_Message.h"
 #include "logdevice/common/protocol/ProtocolReader.h"
 #include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/stats/Stats.h"
 
 namespace facebook { namespace logdevice {
 
@@ -185,6 +186,20 @@ GET_SEQ_STATE_Message::checkSeals(Address src, std::shared_ptr<Sequencer> seq) {
   return Disposition::KEEP;
 }
 
+bool GET_SEQ_STATE_Message::canSkipCheckSeals(const Sequencer& seq) const {
+  const auto interval = Worker::settings().tail_query_seal_check_interval;
+  if (interval.count() <= 0) {
+    return false;
+  }
+  // Only getTailAttributes() and getTailRecord() may get a result that is up
+  // to `interval` stale. Other callers rely on check seals to find out
+  // about preemption.
+  const bool tail_query =
+      calling_ctx_ == GetSeqStateRequest::Context::GET_TAIL_ATTRIBUTES ||
+      calling_ctx_ == GetSeqStateRequest::Context::GET_TAIL_RECORD;
+  return tail_query && seq.sealCheckedWithin(interval);
+}
+
 Status
 GET_SEQ_STATE_Message::getSequencer(logid_t datalog_id,
                                     std::shared_ptr<Sequencer>& sequencer_out,
@@ -454,6 +469,11 @@ void GET_SEQ_STATE_Message::onSequencerNodeFound(Status status,
           // redirects
           /* BOOST_FALLTHROUGH */
         case Sequencer::State::ACTIVE:
+          if (state == Sequencer::State::ACTIVE &&
+              canSkipCheckSeals(*sequencer)) {
+            WORKER_STAT_INCR(get_seq_state_check_seals_skipped);
+            break;
+          }
           if (checkSeals(from, sequencer) == Disposition::KEEP) {
             // ownership is transfered to CheckSealsRequest
             msg.release();
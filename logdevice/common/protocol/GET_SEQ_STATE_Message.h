@@ -250,6 +250,15 @@ class GET_SEQ_STATE_Message : public Message {
    */
   Message::Disposition checkSeals(Address from, std::shared_ptr<Sequencer> seq);
 
+  /**
+   * @return true if this message comes from getTailAttributes() or
+   *         getTailRecord() and `seq` passed a seal check within
+   *         Settings::tail_query_seal_check_interval. Such requests are
+   *         answered from the sequencer's tail record without sending
+   *         CHECK_SEALs, so that polling tails doesn't load storage nodes.
+   */
+  bool canSkipCheckSeals(const Sequencer& seq) const;
+
   void
   sendReply(Address const& dest,
             GET_SEQ_STATE_REPLY_Header const& header,
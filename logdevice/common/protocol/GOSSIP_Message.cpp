@@ -7,7 +7,10 @@
  */
 #include "GOSSIP_Message.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
+#include <vector>
 
 #include <folly/small_vector.h>
 
@@ -65,10 +68,10 @@ void GOSSIP_Message::serialize(ProtocolWriter& writer) const {
   writer.write(num_nodes_);
   writer.write(gossip_node_);
   writer.write(flags_);
-  writer.writeVector(gossip_list_);
+  writeGossipList(writer);
   writer.write(instance_id_);
   writer.write(sent_time_);
-  writer.writeVector(gossip_ts_);
+  writeGossipTs(writer);
 
   if (flags_ & HAS_FAILOVER_LIST_FLAG) {
     ld_check(failover_list_.size() == num_nodes_);
@@ -85,10 +88,10 @@ MessageReadResult GOSSIP_Message::deserialize(ProtocolReader& reader) {
   reader.read(&msg->num_nodes_);
   reader.read(&msg->gossip_node_);
   reader.read(&msg->flags_);
-  reader.readVector(&msg->gossip_list_, msg->num_nodes_);
+  msg->readGossipList(reader);
   reader.read(&msg->instance_id_);
   reader.read(&msg->sent_time_);
-  reader.readVector(&msg->gossip_ts_, msg->num_nodes_);
+  msg->readGossipTs(reader);
 
   if (reader.ok() && (msg->flags_ & HAS_FAILOVER_LIST_FLAG)) {
     reader.readVector(&msg->failover_list_, msg->num_nodes_);
@@ -103,6 +106,149 @@ MessageReadResult GOSSIP_Message::deserialize(ProtocolReader& reader) {
   return reader.resultMsg(std::move(msg));
 }
 
+namespace {
+
+template <typename T>
+void writeNarrowed(ProtocolWriter& writer,
+                   const GOSSIP_Message::gossip_list_t& list) {
+  std::vector<T> narrow(list.begin(), list.end());
+  writer.writeVector(narrow);
+}
+
+template <typename T>
+void readNarrowed(ProtocolReader& reader,
+                  size_t n,
+                  GOSSIP_Message::gossip_list_t* out) {
+  std::vector<T> narrow;
+  reader.readVector(&narrow, n);
+  if (reader.ok()) {
+    out->assign(narrow.begin(), narrow.end());
+  }
+}
+
+} // namespace
+
+void GOSSIP_Message::writeGossipList(ProtocolWriter& writer) const {
+  if (writer.proto() < Compatibility::GOSSIP_COMPACT_LISTS_SUPPORT) {
+    writer.writeVector(gossip_list_);
+    return;
+  }
+
+  uint32_t max = 0;
+  for (uint32_t v : gossip_list_) {
+    max = std::max(max, v);
+  }
+  uint8_t width = max <= std::numeric_limits<uint8_t>::max()
+      ? 1
+      : (max <= std::numeric_limits<uint16_t>::max() ? 2 : 4);
+  writer.write(width);
+  switch (width) {
+    case 1:
+      writeNarrowed<uint8_t>(writer, gossip_list_);
+      break;
+    case 2:
+      writeNarrowed<uint16_t>(writer, gossip_list_);
+      break;
+    default:
+      writer.writeVector(gossip_list_);
+      break;
+  }
+}
+
+void GOSSIP_Message::readGossipList(ProtocolReader& reader) {
+  if (reader.proto() < Compatibility::GOSSIP_COMPACT_LISTS_SUPPORT) {
+    reader.readVector(&gossip_list_, num_nodes_);
+    return;
+  }
+
+  uint8_t width = 0;
+  reader.read(&width);
+  if (!reader.ok()) {
+    return;
+  }
+  switch (width) {
+    case 1:
+      readNarrowed<uint8_t>(reader, num_nodes_, &gossip_list_);
+      break;
+    case 2:
+      readNarrowed<uint16_t>(reader, num_nodes_, &gossip_list_);
+      break;
+    case 4:
+      reader.readVector(&gossip_list_, num_nodes_);
+      break;
+    default:
+      ld_error("Bad GOSSIP message: invalid gossip list width %u", width);
+      reader.setError(E::BADMSG);
+      break;
+  }
+}
+
+void GOSSIP_Message::writeGossipTs(ProtocolWriter& writer) const {
+  if (writer.proto() < Compatibility::GOSSIP_COMPACT_LISTS_SUPPORT) {
+    writer.writeVector(gossip_ts_);
+    return;
+  }
+
+  using rep_t = std::chrono::milliseconds::rep;
+  rep_t min = std::numeric_limits<rep_t>::max();
+  rep_t max = std::numeric_limits<rep_t>::min();
+  for (auto ts : gossip_ts_) {
+    if (ts.count() != 0) {
+      min = std::min(min, ts.count());
+      max = std::max(max, ts.count());
+    }
+  }
+  // Offsets are shifted by one so that 0 can stand for 0.
+  uint8_t compact = min > max ||
+      (min >= 0 && max - min < std::numeric_limits<uint32_t>::max());
+  writer.write(compact);
+  if (!compact) {
+    writer.writeVector(gossip_ts_);
+    return;
+  }
+
+  std::chrono::milliseconds base(min > max ? 0 : min);
+  std::vector<uint32_t> offsets(gossip_ts_.size());
+  for (size_t i = 0; i < gossip_ts_.size(); ++i) {
+    if (gossip_ts_[i].count() != 0) {
+      offsets[i] = static_cast<uint32_t>((gossip_ts_[i] - base).count() + 1);
+    }
+  }
+  writer.write(base);
+  writer.writeVector(offsets);
+}
+
+void GOSSIP_Message::readGossipTs(ProtocolReader& reader) {
+  if (reader.proto() < Compatibility::GOSSIP_COMPACT_LISTS_SUPPORT) {
+    reader.readVector(&gossip_ts_, num_nodes_);
+    return;
+  }
+
+  uint8_t compact = 0;
+  reader.read(&compact);
+  if (!reader.ok()) {
+    return;
+  }
+  if (!compact) {
+    reader.readVector(&gossip_ts_, num_nodes_);
+    return;
+  }
+
+  std::chrono::milliseconds base;
+  std::vector<uint32_t> offsets;
+  reader.read(&base);
+  reader.readVector(&offsets, num_nodes_);
+  if (!reader.ok()) {
+    return;
+  }
+  gossip_ts_.assign(num_nodes_, std::chrono::milliseconds::zero());
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    if (offsets[i] != 0) {
+      gossip_ts_[i] = base + std::chrono::milliseconds(offsets[i] - 1);
+    }
+  }
+}
+
 void GOSSIP_Message::writeSuspectMatrix(ProtocolWriter& writer) const {
   if (!suspect_matrix_.size()) {
     return;
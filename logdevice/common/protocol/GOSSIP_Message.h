@@ -86,6 +86,20 @@ class GOSSIP_Message : public Message {
   static const GOSSIP_flags_t SUSPECT_STATE_FINISHED = 1 << 2;
 
  private:
+  // Starting with GOSSIP_COMPACT_LISTS_SUPPORT, the gossip list is written as
+  // a byte with the width of its entries (1, 2 or 4) followed by the entries.
+  // Entries count gossip intervals since a node was last heard from, so they
+  // are small for all nodes but the dead ones.
+  void writeGossipList(ProtocolWriter& writer) const;
+  void readGossipList(ProtocolReader& reader);
+
+  // Starting with GOSSIP_COMPACT_LISTS_SUPPORT, gossip timestamps, which are
+  // start times of nodes and close to each other, are written as 32-bit
+  // offsets from the smallest nonzero one when they fit, with 0 standing for
+  // 0. A leading byte says whether this encoding is used.
+  void writeGossipTs(ProtocolWriter& writer) const;
+  void readGossipTs(ProtocolReader& reader);
+
   // helper method that writes the compact representation of the suspect matrix
   // to the given evbuffer
   void writeSuspectMatrix(ProtocolWriter& writer) const;
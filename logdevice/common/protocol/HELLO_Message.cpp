@@ -417,6 +417,11 @@ Message::Disposition HELLO_Message::onReceived(const Address& from) {
         from.id_.client_, client_location_);
   }
 
+  if (header_.flags & HELLO_Header::ACCEPTS_COMPRESSED_RECORDS) {
+    Worker::onThisThread()->sender().setAcceptsCompressedRecords(
+        from.id_.client_);
+  }
+
   // Parse extra build information if provided
   folly::Optional<folly::dynamic> build_info;
   if (!(header_.flags & HELLO_Header::SOURCE_NODE) &&
@@ -66,6 +66,16 @@ struct HELLO_Header {
 
   // If set, HELLO message will include the client location
   static constexpr HELLO_flags_t CLIENT_LOCATION = 1ul << 5;
+
+  // If set, the peer can decompress RECORD messages with the COMPRESSED flag,
+  // and storage nodes may send those (see setting record-compression).
+  static constexpr HELLO_flags_t ACCEPTS_COMPRESSED_RECORDS = 1ul << 6;
+
+  // If set, the connection only carries read streams (see
+  // --separate-read-connections). Storage nodes with read workers hand it to
+  // one of those. Carries no extra data, so that a listener can tell from the
+  // fixed-size header alone.
+  static constexpr HELLO_flags_t READ_STREAMS = 1ul << 7;
 } __attribute__((__packed__));
 
 /**
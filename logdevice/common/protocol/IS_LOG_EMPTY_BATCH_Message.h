@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <vector>
+
+#include "logdevice/common/protocol/IS_LOG_EMPTY_Message.h"
+#include "logdevice/common/protocol/Message.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Message sent by the client library to a storage node to check whether
+ * many logs are empty at once. Equivalent to sending one IS_LOG_EMPTY_Message
+ * per entry. Storage nodes reply with one IS_LOG_EMPTY_REPLY_Message per
+ * entry.
+ */
+
+struct IS_LOG_EMPTY_BATCH_Header {
+  uint32_t count;      // number of entries following the header
+  shard_index_t shard; // shard on which to look for all the logs
+} __attribute__((__packed__));
+
+class IS_LOG_EMPTY_BATCH_Message : public Message {
+ public:
+  IS_LOG_EMPTY_BATCH_Message(shard_index_t shard,
+                             std::vector<IS_LOG_EMPTY_Header> entries)
+      : Message(MessageType::IS_LOG_EMPTY_BATCH, TrafficClass::READ_BACKLOG),
+        shard_(shard),
+        entries_(std::move(entries)) {}
+
+  void serialize(ProtocolWriter&) const override;
+  static Message::deserializer_t deserialize;
+
+  Disposition onReceived(const Address&) override {
+    // Receipt handler lives in server/IS_LOG_EMPTY_onReceived.cpp; this should
+    // never get called.
+    std::abort();
+  }
+  void onSent(Status st, const Address& to) const override;
+  uint16_t getMinProtocolVersion() const override;
+
+  const shard_index_t shard_;
+
+  // Each entry has the same meaning as the header of an IS_LOG_EMPTY_Message.
+  // Entries' `shard` is equal to shard_.
+  std::vector<IS_LOG_EMPTY_Header> entries_;
+};
+
+}} // namespace facebook::logdevice
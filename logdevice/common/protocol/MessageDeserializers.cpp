@@ -9,6 +9,7 @@
 
 #include "ACK_Message.h"
 #include "APPENDED_Message.h"
+#include "APPENDS_Message.h"
 #include "APPEND_Message.h"
 #include "APPEND_PROBE_Message.h"
 #include "APPEND_PROBE_REPLY_Message.h"
@@ -21,11 +22,13 @@
 #include "CONFIG_ADVISORY_Message.h"
 #include "CONFIG_CHANGED_Message.h"
 #include "CONFIG_FETCH_Message.h"
+#include "DATA_SIZE_BATCH_Message.h"
 #include "DATA_SIZE_Message.h"
 #include "DATA_SIZE_REPLY_Message.h"
 #include "DELETE_LOG_METADATA_Message.h"
 #include "DELETE_LOG_METADATA_REPLY_Message.h"
 #include "DELETE_Message.h"
+#include "FINDKEY_BATCH_Message.h"
 #include "FINDKEY_Message.h"
 #include "FINDKEY_REPLY_Message.h"
 #include "GAP_Message.h"
@@ -43,6 +46,7 @@
 #include "GET_TRIM_POINT_REPLY_Message.h"
 #include "GOSSIP_Message.h"
 #include "HELLO_Message.h"
+#include "IS_LOG_EMPTY_BATCH_Message.h"
 #include "IS_LOG_EMPTY_Message.h"
 #include "IS_LOG_EMPTY_REPLY_Message.h"
 #include "LOGS_CONFIG_API_Message.h"
@@ -53,20 +57,25 @@
 #include "NODE_STATS_AGGREGATE_REPLY_Message.h"
 #include "NODE_STATS_Message.h"
 #include "NODE_STATS_REPLY_Message.h"
+#include "RECORDS_Message.h"
 #include "RECORD_Message.h"
+#include "RELEASES_Message.h"
 #include "RELEASE_Message.h"
 #include "SEALED_Message.h"
 #include "SEAL_Message.h"
 #include "SHARD_STATUS_UPDATE_Message.h"
 #include "SHUTDOWN_Message.h"
 #include "STARTED_Message.h"
+#include "STARTS_Message.h"
 #include "START_Message.h"
 #include "STOP_Message.h"
 #include "STORED_Message.h"
+#include "STORES_Message.h"
 #include "STORE_Message.h"
 #include "TEST_Message.h"
 #include "TRIMMED_Message.h"
 #include "TRIM_Message.h"
+#include "WINDOWS_Message.h"
 #include "WINDOW_Message.h"
 
 namespace facebook { namespace logdevice {
@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "RECORDS_Message.h"
+
+#include "logdevice/common/Sender.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+
+namespace facebook { namespace logdevice {
+
+RECORDS_Message::RECORDS_Message(
+    logid_t log_id,
+    read_stream_id_t read_stream_id,
+    shard_index_t shard,
+    TrafficClass tc,
+    std::vector<std::unique_ptr<RECORD_Message>> records,
+    std::unique_ptr<GAP_Message> gap)
+    : Message(MessageType::RECORDS, tc),
+      log_id_(log_id),
+      read_stream_id_(read_stream_id),
+      shard_(shard),
+      records_(std::move(records)),
+      gap_(std::move(gap)) {}
+
+void RECORDS_Message::serialize(ProtocolWriter& writer) const {
+  RECORDS_Header header = {log_id_,
+                           read_stream_id_,
+                           shard_,
+                           uint32_t(records_.size()),
+                           gap_ ? RECORDS_Header::INCLUDES_GAP : 0};
+  writer.write(header);
+  for (const auto& record : records_) {
+    ld_check(record->header_.log_id == log_id_);
+    ld_check(record->header_.read_stream_id == read_stream_id_);
+    record->serializeInBatch(writer);
+  }
+  if (gap_) {
+    ld_check(gap_->header_.log_id == log_id_);
+    ld_check(gap_->header_.read_stream_id == read_stream_id_);
+    writer.write(gap_->header_);
+  }
+}
+
+MessageReadResult RECORDS_Message::deserialize(ProtocolReader& reader) {
+  RECORDS_Header header;
+  reader.read(&header);
+
+  // Every record takes at least a RECORD_Header, don't let a corrupted count
+  // make us allocate a huge vector.
+  if (reader.ok() &&
+      uint64_t(header.num_records) * sizeof(RECORD_Header) >
+          reader.bytesRemaining()) {
+    reader.setError(E::BADMSG);
+  }
+
+  std::vector<std::unique_ptr<RECORD_Message>> records;
+  if (reader.ok()) {
+    records.reserve(header.num_records);
+  }
+  const size_t zero_copy_min_size = RECORD_Message::zeroCopyMinSize();
+  for (uint32_t i = 0; reader.ok() && i < header.num_records; ++i) {
+    auto record =
+        RECORD_Message::deserializeInBatch(reader, zero_copy_min_size);
+    if (!record) {
+      break;
+    }
+    if (record->header_.log_id != header.log_id ||
+        record->header_.read_stream_id != header.read_stream_id ||
+        record->header_.shard != header.shard) {
+      reader.setError(E::BADMSG);
+      break;
+    }
+    records.push_back(std::move(record));
+  }
+
+  std::unique_ptr<GAP_Message> gap;
+  if (header.flags & RECORDS_Header::INCLUDES_GAP) {
+    GAP_Header gap_header;
+    reader.read(&gap_header);
+    if (reader.ok() &&
+        (gap_header.log_id != header.log_id ||
+         gap_header.read_stream_id != header.read_stream_id ||
+         gap_header.shard != header.shard)) {
+      reader.setError(E::BADMSG);
+    }
+    gap = std::make_unique<GAP_Message>(gap_header);
+  }
+
+  return reader.result([&] {
+    TrafficClass tc =
+        records.empty() ? TrafficClass::READ_BACKLOG : records.front()->tc_;
+    return new RECORDS_Message(header.log_id,
+                               header.read_stream_id,
+                               header.shard,
+                               tc,
+                               std::move(records),
+                               std::move(gap));
+  });
+}
+
+Message::Disposition RECORDS_Message::onReceived(const Address& from) {
+  // Deliver the records and the gap one by one, exactly as if they had come
+  // in separate messages.
+  for (auto& record : records_) {
+    if (record->onReceived(from) == Disposition::ERROR) {
+      return Disposition::ERROR;
+    }
+  }
+  if (gap_ && gap_->onReceived(from) == Disposition::ERROR) {
+    return Disposition::ERROR;
+  }
+  return Disposition::NORMAL;
+}
+
+uint16_t RECORDS_Message::getMinProtocolVersion() const {
+  return Compatibility::RECORDS_MESSAGE_SUPPORT;
+}
+
+std::string RECORDS_Message::identify() const {
+  std::string res = "Log=" + std::to_string(log_id_.val_) + ",records=" +
+      std::to_string(records_.size());
+  if (!records_.empty()) {
+    res += ",[" + lsn_to_string(records_.front()->header_.lsn) + "," +
+        lsn_to_string(records_.back()->header_.lsn) + "]";
+  }
+  if (gap_) {
+    res += ",gap=" + gap_->identify();
+  }
+  return res;
+}
+
+}} // namespace facebook::logdevice
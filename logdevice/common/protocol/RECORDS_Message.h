@@ -0,0 +1,74 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "logdevice/common/protocol/GAP_Message.h"
+#include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/RECORD_Message.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Message sent by a storage node to deliver several consecutive records
+ * of a read stream at once, optionally followed by a gap. Equivalent to
+ * sending one RECORD_Message per record and then the GAP_Message, but goes
+ * through the messaging layer, and completes on the storage node, as a single
+ * message. Storage nodes only send it to readers whose protocol is at least
+ * Compatibility::RECORDS_MESSAGE_SUPPORT, when
+ * --record-batch-max-records is greater than 1.
+ */
+
+typedef uint8_t RECORDS_flags_t;
+
+struct RECORDS_Header {
+  logid_t log_id;
+  read_stream_id_t read_stream_id;
+  shard_index_t shard;
+  uint32_t num_records; // number of records following the header
+  RECORDS_flags_t flags;
+
+  // If set in .flags, the records are followed by a GAP_Header of the same
+  // read stream.
+  static const RECORDS_flags_t INCLUDES_GAP = 1u << 0; //=1
+} __attribute__((__packed__));
+
+class RECORDS_Message : public Message {
+ public:
+  /**
+   * @param records  records of the read stream identified by the header
+   *                 fields, in the order of their LSNs
+   * @param gap      if not null, gap of the same read stream delivered right
+   *                 after the records
+   */
+  RECORDS_Message(logid_t log_id,
+                  read_stream_id_t read_stream_id,
+                  shard_index_t shard,
+                  TrafficClass tc,
+                  std::vector<std::unique_ptr<RECORD_Message>> records,
+                  std::unique_ptr<GAP_Message> gap = nullptr);
+
+  // see Message.h
+  void serialize(ProtocolWriter&) const override;
+  Disposition onReceived(const Address& from) override;
+  static Message::deserializer_t deserialize;
+  uint16_t getMinProtocolVersion() const override;
+
+  std::string identify() const;
+
+  const logid_t log_id_;
+  const read_stream_id_t read_stream_id_;
+  const shard_index_t shard_;
+
+  std::vector<std::unique_ptr<RECORD_Message>> records_;
+  std::unique_ptr<GAP_Message> gap_;
+};
+
+}} // namespace facebook::logdevice
@@ -8,8 +8,14 @@
 #include "RECORD_Message.h"
 
 #include <cstdlib>
+#include <limits>
 
 #include <folly/Memory.h>
+#include <lz4.h>
+#include <lz4hc.h>
+#include <zstd.h>
+
+#include "event2/buffer.h"
 
 #include "logdevice/common/Checksum.h"
 #include "logdevice/common/EpochRecovery.h"
@@ -17,11 +23,13 @@
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/client_read_stream/AllClientReadStreams.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/common/libevent/compat.h"
 #include "logdevice/common/protocol/GAP_Message.h"
 #include "logdevice/common/protocol/MessageType.h"
 #include "logdevice/common/protocol/ProtocolReader.h"
 #include "logdevice/common/protocol/ProtocolWriter.h"
 #include "logdevice/common/settings/Settings.h"
+#include "logdevice/common/stats/Stats.h"
 
 namespace facebook { namespace logdevice {
 
@@ -51,10 +59,25 @@ RECORD_Message::RECORD_Message(const RECORD_Header& header,
       log_group_path_(std::move(log_group_path)) {}
 
 RECORD_Message::~RECORD_Message() {
-  free(const_cast<void*>(payload_.data()));
+  if (payload_owner_) {
+    // payload_ is released along with the last reference to its owner
+  } else if (payload_buffer_) {
+    free(payload_buffer_);
+  } else {
+    free(const_cast<void*>(payload_.data()));
+  }
 }
 
 void RECORD_Message::serialize(ProtocolWriter& writer) const {
+  serializeImpl(writer, /*in_batch=*/false);
+}
+
+void RECORD_Message::serializeInBatch(ProtocolWriter& writer) const {
+  serializeImpl(writer, /*in_batch=*/true);
+}
+
+void RECORD_Message::serializeImpl(ProtocolWriter& writer,
+                                   bool in_batch) const {
   writer.write(header_);
 
   // Note: this method needs to be kept at least approximately in sync with
@@ -78,6 +101,9 @@ void RECORD_Message::serialize(ProtocolWriter& writer) const {
 
   ld_check(payload_.size() < Message::MAX_LEN); // must have been checked
                                                 // by upper layers
+  if (in_batch) {
+    writer.write(static_cast<uint32_t>(payload_.size()));
+  }
   if (payload_.size() <= MAX_COPY_TO_EVBUFFER_PAYLOAD_SIZE) {
     writer.write(payload_.data(), payload_.size());
   } else {
@@ -86,6 +112,66 @@ void RECORD_Message::serialize(ProtocolWriter& writer) const {
 }
 
 MessageReadResult RECORD_Message::deserialize(ProtocolReader& reader) {
+  return deserialize(reader, zeroCopyMinSize());
+}
+
+MessageReadResult RECORD_Message::deserialize(ProtocolReader& reader,
+                                              size_t zero_copy_min_size) {
+  return reader.resultMsg(
+      deserializeImpl(reader, zero_copy_min_size, /*in_batch=*/false));
+}
+
+std::unique_ptr<RECORD_Message>
+RECORD_Message::deserializeInBatch(ProtocolReader& reader,
+                                   size_t zero_copy_min_size) {
+  return deserializeImpl(reader, zero_copy_min_size, /*in_batch=*/true);
+}
+
+size_t RECORD_Message::zeroCopyMinSize() {
+  return Worker::onThisThread(false)
+      ? Worker::settings().client_record_payload_zero_copy_min_size
+      : 0;
+}
+
+/**
+ * Moves `size' bytes of payload out of the reader's evbuffer into a new
+ * evbuffer. Chains of the socket's input evbuffer that hold only payload
+ * bytes change hands without being copied. Sets *payload to the payload,
+ * which is only copied if it spans several chains and has to be made
+ * contiguous.
+ *
+ * @return  the new evbuffer, which *payload points into and which is freed
+ *          with the last reference
+ */
+static std::shared_ptr<const void>
+read_payload_zero_copy(ProtocolReader& reader, size_t size, void** payload) {
+  struct evbuffer* evbuf = LD_EV(evbuffer_new)();
+  if (!evbuf) { // unlikely
+    throw std::bad_alloc();
+  }
+  // The evbuffer isn't shared with anything else, so it can be freed on any
+  // thread, e.g. by the application thread that got the record.
+  std::shared_ptr<const void> owner(
+      evbuf, [](struct evbuffer* buf) { LD_EV(evbuffer_free)(buf); });
+
+  reader.readEvbuffer(evbuf, size);
+  if (!reader.ok()) {
+    return owner;
+  }
+  if (LD_EV(evbuffer_get_contiguous_space)(evbuf) == size) {
+    WORKER_STAT_INCR(client.record_payloads_zero_copied);
+  }
+  *payload = LD_EV(evbuffer_pullup)(evbuf, size);
+  if (!*payload) { // unlikely
+    throw std::bad_alloc();
+  }
+  return owner;
+}
+
+std::unique_ptr<RECORD_Message>
+RECORD_Message::deserializeImpl(ProtocolReader& reader,
+                                size_t zero_copy_min_size,
+                                bool in_batch) {
   TrafficClass tc = TrafficClass::READ_TAIL;
   RECORD_Header header;
   reader.read(&header);
@@ -107,6 +193,21 @@ MessageReadResult RECORD_Message::deserialize(ProtocolReader& reader) {
     tc = TrafficClass::REBUILD;
   }
 
+  // Inside a RECORDS message, the payload is followed by other records and the
+  // size of the payload including the checksum precedes it.
+  size_t bytes_left = 0;
+  if (in_batch) {
+    uint32_t size = 0;
+    reader.read(&size);
+    bytes_left = size;
+    if (reader.ok() && bytes_left > reader.bytesRemaining()) {
+      reader.setError(E::BADMSG);
+    }
+  }
+  auto bytes_remaining = [&] {
+    return in_batch ? bytes_left : reader.bytesRemaining();
+  };
+
   // If flags indicate that the payload includes a checksum, strip it now.
   // The payload size reported to the client will be just the actual client
   // payload.
@@ -126,14 +227,14 @@ MessageReadResult RECORD_Message::deserialize(ProtocolReader& reader) {
       checksum_size = sizeof u.c32;
     }
 
-    if (reader.bytesRemaining() < checksum_size) {
+    if (bytes_remaining() < checksum_size) {
       RATELIMIT_ERROR(
           std::chrono::seconds(10),
           10,
           "Malformed RECORD message: ran out of bytes while reading "
           "checksum (expected %zu, got %zu); log: %lu lsn: %s rsid: %lu",
           checksum_size,
-          reader.bytesRemaining(),
+          bytes_remaining(),
           header.log_id.val_,
           lsn_to_string(header.lsn).c_str(),
           header.read_stream_id.val_);
@@ -143,16 +244,21 @@ MessageReadResult RECORD_Message::deserialize(ProtocolReader& reader) {
       expected_checksum = 0x5000b4df00f00f00ul;
     } else {
       reader.read(ptr, checksum_size);
+      bytes_left -= in_batch ? checksum_size : 0;
       expected_checksum =
           (header.flags & RECORD_Header::CHECKSUM_64BIT) ? u.c64 : u.c32;
     }
   }
 
-  size_t payload_size = reader.ok() ? reader.bytesRemaining() : 0;
+  size_t payload_size = reader.ok() ? bytes_remaining() : 0;
   ld_check(payload_size < Message::MAX_LEN);
 
   void* payload = nullptr;
-  if (payload_size > 0) {
+  std::shared_ptr<const void> payload_owner;
+  if (payload_size > 0 && zero_copy_min_size > 0 &&
+      payload_size >= zero_copy_min_size) {
+    payload_owner = read_payload_zero_copy(reader, payload_size, &payload);
+  } else if (payload_size > 0) {
     payload = malloc(payload_size);
     if (!payload) { // unlikely
       throw std::bad_alloc();
@@ -160,13 +266,18 @@ MessageReadResult RECORD_Message::deserialize(ProtocolReader& reader) {
     reader.read(payload, payload_size);
   }
 
-  return reader.result([&] {
-    auto m = std::make_unique<RECORD_Message>(
-        header, tc, Payload(payload, payload_size), std::move(extra_metadata));
-    m->expected_checksum_ = expected_checksum;
-    m->byte_offset_ = byte_offset;
-    return m;
-  });
+  if (!reader.ok()) {
+    if (!payload_owner) {
+      free(payload);
+    }
+    return nullptr;
+  }
+  auto m = std::make_unique<RECORD_Message>(
+      header, tc, Payload(payload, payload_size), std::move(extra_metadata));
+  m->payload_owner_ = std::move(payload_owner);
+  m->expected_checksum_ = expected_checksum;
+  m->byte_offset_ = byte_offset;
+  return m;
 }
 
 std::string RECORD_Message::identify() const {
@@ -203,7 +314,8 @@ Message::Disposition RECORD_Message::onReceived(const Address& from) {
 
   if (header_.flags & RECORD_Header::DIGEST) {
     // this is a digest record, route to an EpochRecovery object
-    recovery = w->findActiveEpochRecovery(header_.log_id);
+    recovery =
+        w->findActiveEpochRecovery(header_.log_id, lsn_to_epoch(header_.lsn));
     if (!recovery) {
       RATELIMIT_INFO(std::chrono::seconds(1),
                      10,
@@ -231,7 +343,9 @@ Message::Disposition RECORD_Message::onReceived(const Address& from) {
     }
   }
 
-  bool invalid_checksum = (verifyChecksum() != 0);
+  // A payload that fails to decompress is treated like one with a bad
+  // checksum: the client reads the record from another copy.
+  bool invalid_checksum = decompressPayload() != 0 || verifyChecksum() != 0;
 
   std::unique_ptr<DataRecordOwnsPayload> record(
       new DataRecordOwnsPayload(header_.log_id,
@@ -243,7 +357,8 @@ Message::Disposition RECORD_Message::onReceived(const Address& from) {
                                 std::shared_ptr<BufferedWriteDecoder>(),
                                 0, // batch_offset
                                 byte_offset_,
-                                invalid_checksum));
+                                invalid_checksum,
+                                std::move(payload_owner_)));
   // We have transferred ownership of the payload.
   ld_check(!payload_.data());
 
@@ -258,6 +373,135 @@ Message::Disposition RECORD_Message::onReceived(const Address& from) {
   return Disposition::NORMAL;
 }
 
+Payload RECORD_Message::compressPayload(const Payload& payload,
+                                        size_t prefix_size,
+                                        Compression compression) {
+  ld_check(compression != Compression::NONE);
+  ld_check(prefix_size <= payload.size());
+  const char* src = (const char*)payload.data() + prefix_size;
+  const size_t src_size = payload.size() - prefix_size;
+  if (src_size > std::numeric_limits<int>::max()) {
+    return Payload();
+  }
+
+  const size_t bound = compression == Compression::ZSTD
+      ? ZSTD_compressBound(src_size)
+      : LZ4_compressBound(src_size);
+  const size_t header_size = prefix_size + sizeof(RECORD_CompressionHeader);
+  char* buf = (char*)malloc(header_size + bound);
+  if (!buf) { // unlikely
+    throw std::bad_alloc();
+  }
+  char* out = buf + header_size;
+
+  size_t compressed_size;
+  if (compression == Compression::ZSTD) {
+    compressed_size = ZSTD_compress(out, bound, src, src_size, /*level=*/1);
+    if (ZSTD_isError(compressed_size)) {
+      ld_error(
+          "ZSTD_compress() failed: %s", ZSTD_getErrorName(compressed_size));
+      ld_check(false);
+      free(buf);
+      return Payload();
+    }
+  } else {
+    int rv = compression == Compression::LZ4
+        ? LZ4_compress_default(src, out, src_size, bound)
+        : LZ4_compress_HC(src, out, src_size, bound, 0);
+    ld_check(rv > 0);
+    compressed_size = std::max(rv, 0);
+  }
+
+  if (compressed_size == 0 || header_size + compressed_size >= payload.size()) {
+    // Compression wasn't a win.
+    free(buf);
+    return Payload();
+  }
+
+  memcpy(buf, payload.data(), prefix_size);
+  RECORD_CompressionHeader h{
+      static_cast<uint8_t>(compression), static_cast<uint32_t>(src_size)};
+  memcpy(buf + prefix_size, &h, sizeof(h));
+  return Payload(buf, header_size + compressed_size);
+}
+
+int RECORD_Message::decompressPayload() {
+  if (!(header_.flags & RECORD_Header::COMPRESSED)) {
+    return 0;
+  }
+
+  RECORD_CompressionHeader h;
+  if (payload_.size() < sizeof(h)) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    10,
+                    "Malformed compressed RECORD %s: payload of %zu bytes is "
+                    "too short",
+                    identify().c_str(),
+                    payload_.size());
+    return -1;
+  }
+  memcpy(&h, payload_.data(), sizeof(h));
+  const uint32_t uncompressed_size = h.uncompressed_size;
+  const char* src = (const char*)payload_.data() + sizeof(h);
+  const size_t src_size = payload_.size() - sizeof(h);
+
+  if (uncompressed_size >= Message::MAX_LEN) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    10,
+                    "Malformed compressed RECORD %s: uncompressed size %u is "
+                    "too big",
+                    identify().c_str(),
+                    uncompressed_size);
+    return -1;
+  }
+  // Allocate at least one byte so that an empty payload still has an owner.
+  char* buf = (char*)malloc(std::max(uncompressed_size, uint32_t(1)));
+  if (!buf) { // unlikely
+    throw std::bad_alloc();
+  }
+
+  bool ok;
+  switch (static_cast<Compression>(h.compression)) {
+    case Compression::ZSTD: {
+      size_t rv = ZSTD_decompress(buf, uncompressed_size, src, src_size);
+      ok = !ZSTD_isError(rv) && rv == uncompressed_size;
+      break;
+    }
+    case Compression::LZ4:
+    case Compression::LZ4_HC: {
+      int rv = LZ4_decompress_safe(src, buf, src_size, uncompressed_size);
+      ok = rv >= 0 && size_t(rv) == uncompressed_size;
+      break;
+    }
+    default:
+      ok = false;
+  }
+
+  if (!ok) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    10,
+                    "Failed to decompress RECORD %s: compression %u, %zu "
+                    "compressed bytes, %u uncompressed bytes expected",
+                    identify().c_str(),
+                    h.compression,
+                    src_size,
+                    uncompressed_size);
+    free(buf);
+    return -1;
+  }
+
+  // deserialize() malloc-d or zero-copied the payload.
+  ld_check(!payload_buffer_);
+  if (payload_owner_) {
+    payload_owner_.reset();
+  } else {
+    free(const_cast<void*>(payload_.data()));
+  }
+  payload_ = Payload(buf, uncompressed_size);
+  header_.flags &= ~RECORD_Header::COMPRESSED;
+  return 0;
+}
+
 size_t RECORD_Message::expectedSize(size_t payload_size) {
   // TODO: Also account for extra metadata and byte offset.
   return ProtocolHeader::bytesNeeded(
@@ -344,6 +588,7 @@ std::string RECORD_Message::flagsToString(RECORD_flags_t flags) {
   }
 
   FLAG(INCLUDES_EXTRA_METADATA)
+  FLAG(COMPRESSED)
   FLAG(CHECKSUM)
   FLAG(CHECKSUM_64BIT)
   FLAG(CHECKSUM_PARITY)
@@ -38,7 +38,11 @@ struct RECORD_Header {
 
   static const RECORD_flags_t INCLUDES_EXTRA_METADATA = 1u << 0; //=1
 
-  // Value 2 (bit 1) is available for use
+  // If set in .flags, the payload (after the checksum, if there is one) is
+  // compressed: it consists of a RECORD_CompressionHeader followed by the
+  // compressed bytes. Storage nodes only set it for peers that asked for it in
+  // HELLO (see HELLO_Header::ACCEPTS_COMPRESSED_RECORDS).
+  static const RECORD_flags_t COMPRESSED = 1u << 1; //=2
 
   // If set in .flags, the payload is prefixed with a checksum.  The length of
   // the checksum depends on the CHECKSUM_64BIT flag; if it is set, the
@@ -97,6 +101,15 @@ struct RECORD_Header {
 
 } __attribute__((__packed__));
 
+/**
+ * Prefix of the compressed part of the payload of RECORD messages with the
+ * COMPRESSED flag.
+ */
+struct RECORD_CompressionHeader {
+  uint8_t compression; // a Compression value other than NONE
+  uint32_t uncompressed_size;
+} __attribute__((__packed__));
+
 /**
  * Additional metadata that can be sent alongside RECORD messages.
  * This is used by state machines such as:
@@ -157,10 +170,54 @@ class RECORD_Message : public Message, boost::noncopyable {
    */
   static size_t expectedSize(size_t payload_size);
 
+  /**
+   * Compresses `payload`, except its first `prefix_size` bytes (the checksum,
+   * if any), into the payload of a RECORD message with the COMPRESSED flag.
+   *
+   * @return  a malloc-d copy of the payload in that format, or a null Payload
+   *          if compression wouldn't make the payload smaller
+   */
+  static Payload compressPayload(const Payload& payload,
+                                 size_t prefix_size,
+                                 Compression compression);
+
+  /**
+   * If the COMPRESSED flag is set, replaces payload_ with its decompressed
+   * version and clears the flag. Called by onReceived().
+   *
+   * @return  0 on success, -1 if the payload is malformed
+   */
+  int decompressPayload();
+
   // see Message.h
   void serialize(ProtocolWriter&) const override;
   Disposition onReceived(const Address& from) override;
   static Message::deserializer_t deserialize;
+  // Payloads of at least zero_copy_min_size bytes are moved out of the
+  // socket's input evbuffer instead of being copied, see
+  // Settings::client_record_payload_zero_copy_min_size. 0 always copies.
+  static MessageReadResult deserialize(ProtocolReader& reader,
+                                       size_t zero_copy_min_size);
+
+  /**
+   * Serialization of a record inside a RECORDS message: same as serialize(),
+   * except that the payload (including the checksum) is prefixed with its
+   * size, since it doesn't extend to the end of the message.
+   */
+  void serializeInBatch(ProtocolWriter&) const;
+
+  /**
+   * @return  the record written by serializeInBatch(), or nullptr if the
+   *          reader hit an error
+   */
+  static std::unique_ptr<RECORD_Message>
+  deserializeInBatch(ProtocolReader& reader, size_t zero_copy_min_size);
+
+  /**
+   * @return  the zero_copy_min_size to pass to deserialize() according to
+   *          the settings of the worker, 0 if not on a worker thread
+   */
+  static size_t zeroCopyMinSize();
   // onSent() handler lives in server/RECORD_onSent.cpp
 
   /**
@@ -186,11 +243,25 @@ class RECORD_Message : public Message, boost::noncopyable {
   //   than MAX_COPY_TO_EVBUFFER_PAYLOAD_SIZE, the payload memory is added to
   //   the evbuffer by reference. The payload is freed, along with the message,
   //   once transfer into the socket is acknowledged.
-  // - On the read path, the payload gets malloc-d in deserialize().
-  //   onReceived() then passes its ownership to the client library where the
-  //   memory will get freed later when it is no longer needed.
+  // - On the read path, the payload gets malloc-d in deserialize(), or
+  //   points into an evbuffer owned by payload_owner_ for payloads that were
+  //   zero-copied. onReceived() then passes its ownership to the client
+  //   library where the memory will get freed later when it is no longer
+  //   needed.
   Payload payload_;
 
+  // If not nullptr, payload_ points into this malloc-d buffer, which is freed
+  // instead of payload_.data(). Lets the send path hand over a buffer holding
+  // the whole local log store record without copying the payload out of it.
+  void* payload_buffer_{nullptr};
+
+  // If set, payload_ points into memory kept alive by this reference rather
+  // than owned by the message, and nothing is freed on destruction. Lets the
+  // RECORD messages of all read streams tailing a log share a single copy of
+  // each real-time record's payload, and received RECORD messages keep their
+  // payload in the evbuffer it was zero-copied into.
+  std::shared_ptr<const void> payload_owner_;
+
   // If non-null:
   // - On the send path, the structure will be embedded in the RECORD
   //   message
@@ -214,6 +285,13 @@ class RECORD_Message : public Message, boost::noncopyable {
   getDebugInfo() const override;
 
  private:
+  void serializeImpl(ProtocolWriter&, bool in_batch) const;
+
+  static std::unique_ptr<RECORD_Message>
+  deserializeImpl(ProtocolReader& reader,
+                  size_t zero_copy_min_size,
+                  bool in_batch);
+
   // Verifies the integrity of checksum flags and the checksum if the message
   // came with one
   int verifyChecksum() const;
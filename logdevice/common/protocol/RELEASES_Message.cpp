@@ -0,0 +1,52 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "RELEASES_Message.h"
+
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+
+namespace facebook { namespace logdevice {
+
+RELEASES_Message::RELEASES_Message(std::vector<RELEASE_Header> releases)
+    : Message(MessageType::RELEASES, TrafficClass::READ_TAIL),
+      releases_(std::move(releases)) {}
+
+void RELEASES_Message::serialize(ProtocolWriter& writer) const {
+  RELEASES_Header header = {uint32_t(releases_.size())};
+  writer.write(header);
+  writer.writeVector(releases_);
+}
+
+MessageReadResult RELEASES_Message::deserialize(ProtocolReader& reader) {
+  RELEASES_Header header;
+  reader.read(&header);
+  // Don't let a corrupted count make us allocate a huge vector.
+  if (reader.ok() &&
+      uint64_t(header.count) * sizeof(RELEASE_Header) !=
+          reader.bytesRemaining()) {
+    reader.setError(E::BADMSG);
+  }
+  std::vector<RELEASE_Header> releases;
+  if (reader.ok()) {
+    reader.readVector(&releases, header.count);
+  }
+  return reader.result(
+      [&] { return new RELEASES_Message(std::move(releases)); });
+}
+
+uint16_t RELEASES_Message::getMinProtocolVersion() const {
+  return Compatibility::RELEASES_MESSAGE_SUPPORT;
+}
+
+void RELEASES_Message::onSent(Status st, const Address& to) const {
+  for (const RELEASE_Header& header : releases_) {
+    RELEASE_Message::onReleaseSent(header, st, to);
+  }
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,52 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <vector>
+
+#include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/RELEASE_Message.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Message sent by a sequencer node to release records of several logs
+ * on the same storage node at once. Equivalent to sending one RELEASE_Message
+ * per entry. Sequencers only send it to nodes whose protocol is at least
+ * Compatibility::RELEASES_MESSAGE_SUPPORT (see
+ * AppenderMap::enqueueReleaseForBatch()).
+ */
+
+struct RELEASES_Header {
+  uint32_t count; // number of RELEASE_Headers following the header
+} __attribute__((__packed__));
+
+class RELEASES_Message : public Message {
+ public:
+  explicit RELEASES_Message(std::vector<RELEASE_Header> releases);
+
+  // see Message.h
+  void serialize(ProtocolWriter&) const override;
+  static Message::deserializer_t deserialize;
+  uint16_t getMinProtocolVersion() const override;
+  void onSent(Status st, const Address& to) const override;
+  Disposition onReceived(const Address&) override {
+    // Receipt handler lives in PurgeCoordinator::onReceived(); this should
+    // never get called.
+    std::abort();
+  }
+  bool warnAboutOldProtocol() const override {
+    // Only sent on connections known to support it.
+    return false;
+  }
+
+  // Each entry has the same meaning as the header of a RELEASE_Message.
+  std::vector<RELEASE_Header> releases_;
+};
+
+}} // namespace facebook::logdevice
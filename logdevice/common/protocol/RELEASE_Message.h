@@ -10,6 +10,7 @@
 #include <cstdint>
 #include <string>
 
+#include "logdevice/common/MessageArena.h"
 #include "logdevice/common/RecordID.h"
 #include "logdevice/common/configuration/TrafficClass.h"
 #include "logdevice/common/protocol/FixedSizeMessage.h"
@@ -43,6 +44,9 @@ struct RELEASE_Header {
 
 class RELEASE_Message : public Message {
  public:
+  // Received instances are short-lived, see MessageArena.
+  MESSAGE_ARENA_ALLOCATED
+
   explicit RELEASE_Message(const RELEASE_Header& header);
 
   RELEASE_Message(const RELEASE_Message&) noexcept = delete;
@@ -60,6 +64,14 @@ class RELEASE_Message : public Message {
   void onSent(Status st, const Address& to) const override;
   static Message::deserializer_t deserialize;
 
+  /**
+   * Tells the sequencer of the log the outcome of sending the release in
+   * `header` to `to`, whether it was sent in a RELEASE or a RELEASES message.
+   */
+  static void onReleaseSent(const RELEASE_Header& header,
+                            Status st,
+                            const Address& to);
+
   bool warnAboutOldProtocol() const override;
 
   const RELEASE_Header& getHeader() const {
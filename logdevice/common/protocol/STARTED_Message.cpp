@@ -85,11 +85,10 @@ Message::Disposition STARTED_Message::onReceived(const Address& from) {
   ShardID shard_id(from.id_.node_.index(), shard);
 
   Worker* worker = Worker::onThisThread();
-  EpochRecovery* recovery =
-      Worker::onThisThread()->findActiveEpochRecovery(header_.log_id);
+  EpochRecovery* recovery = worker->findDigestingEpochRecovery(
+      header_.log_id, shard_id, header_.read_stream_id);
 
-  if (recovery &&
-      recovery->digestingReadStream(shard_id, header_.read_stream_id)) {
+  if (recovery) {
     recovery->onDigestStreamStarted(shard_id,
                                     header_.read_stream_id,
                                     // if not LSN_INVALID, this is the lng of
@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "STARTS_Message.h"
+
+#include <algorithm>
+
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+STARTS_Message::STARTS_Message(
+    std::vector<std::unique_ptr<START_Message>> starts)
+    : Message(MessageType::STARTS, TrafficClass::HANDSHAKE),
+      starts_(std::move(starts)) {}
+
+void STARTS_Message::serialize(ProtocolWriter& writer) const {
+  STARTS_Header header = {uint32_t(starts_.size())};
+  writer.write(header);
+  for (const auto& start : starts_) {
+    start->serialize(writer);
+  }
+}
+
+MessageReadResult STARTS_Message::deserialize(ProtocolReader& reader) {
+  STARTS_Header header;
+  reader.read(&header);
+
+  // Every START takes at least a START_Header, don't let a corrupted count
+  // make us allocate a huge vector.
+  if (reader.ok() &&
+      uint64_t(header.num_starts) * sizeof(START_Header) >
+          reader.bytesRemaining()) {
+    reader.setError(E::BADMSG);
+  }
+
+  std::vector<std::unique_ptr<START_Message>> starts;
+  if (reader.ok()) {
+    starts.reserve(header.num_starts);
+  }
+  for (uint32_t i = 0; reader.ok() && i < header.num_starts; ++i) {
+    auto start = START_Message::deserializeInBatch(reader);
+    if (!start) {
+      break;
+    }
+    starts.push_back(std::move(start));
+  }
+
+  return reader.result([&] { return new STARTS_Message(std::move(starts)); });
+}
+
+bool STARTS_Message::allowUnencrypted() const {
+  return std::all_of(starts_.begin(), starts_.end(), [](const auto& start) {
+    return start->allowUnencrypted();
+  });
+}
+
+uint16_t STARTS_Message::getMinProtocolVersion() const {
+  return Compatibility::STARTS_MESSAGE_SUPPORT;
+}
+
+void STARTS_Message::onSent(Status st, const Address& to) const {
+  if (st == E::OK) {
+    WORKER_STAT_INCR(starts_batch_messages_sent);
+    WORKER_STAT_ADD(starts_batched, starts_.size());
+  }
+  // Complete every START as if it had been sent in its own message, so that
+  // read streams see the same outcome either way.
+  for (const auto& start : starts_) {
+    start->onSent(st, to);
+  }
+}
+
+std::string STARTS_Message::identify() const {
+  std::string res = "starts=" + std::to_string(starts_.size());
+  if (!starts_.empty()) {
+    res += ",first_log=" + toString(starts_.front()->header_.log_id);
+  }
+  return res;
+}
+
+}} // namespace facebook::logdevice
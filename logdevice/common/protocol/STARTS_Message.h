@@ -0,0 +1,59 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/START_Message.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Message sent by a reader to deliver the STARTs of several read
+ * streams, typically for different logs, to the same storage node at once.
+ * Equivalent to sending one START_Message per read stream: the storage node
+ * creates a separate ServerReadStream for every START and answers each with
+ * its own STARTED, but the STARTs go through the messaging layer as a single
+ * message. Readers only send it to nodes whose protocol is at least
+ * Compatibility::STARTS_MESSAGE_SUPPORT (see
+ * AllClientReadStreams::enqueueStartForBatch()).
+ */
+
+struct STARTS_Header {
+  uint32_t num_starts; // number of STARTs following the header
+} __attribute__((__packed__));
+
+class STARTS_Message : public Message {
+ public:
+  explicit STARTS_Message(std::vector<std::unique_ptr<START_Message>> starts);
+
+  // see Message.h
+  void serialize(ProtocolWriter&) const override;
+  static Message::deserializer_t deserialize;
+  uint16_t getMinProtocolVersion() const override;
+  void onSent(Status st, const Address& to) const override;
+  Disposition onReceived(const Address&) override {
+    // Receipt handler lives in server/START_onReceived.cpp; this should never
+    // get called.
+    std::abort();
+  }
+  bool warnAboutOldProtocol() const override {
+    // Only sent on connections known to support it.
+    return false;
+  }
+  // Only if every START allows it.
+  bool allowUnencrypted() const override;
+
+  std::string identify() const;
+
+  std::vector<std::unique_ptr<START_Message>> starts_;
+};
+
+}} // namespace facebook::logdevice
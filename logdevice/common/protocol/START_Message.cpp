@@ -37,7 +37,8 @@ void START_Message::onSent(Status st, const Address& to) const {
     // EpochRecovery machine and on to the RecoveryNode that sent the message,
     // if they are still around.
     const epoch_t recovering_epoch = lsn_to_epoch(header_.start_lsn);
-    EpochRecovery* active_recovery = w->findActiveEpochRecovery(header_.log_id);
+    EpochRecovery* active_recovery =
+        w->findActiveEpochRecovery(header_.log_id, recovering_epoch);
 
     if (!active_recovery || active_recovery->epoch_ != recovering_epoch) {
       RATELIMIT_WARNING(std::chrono::seconds(1),
@@ -135,6 +136,12 @@ void START_Message::readFilteredOut(ProtocolReader& reader, START_Message& m) {
 }
 
 MessageReadResult START_Message::deserialize(ProtocolReader& reader) {
+  auto m = deserializeInBatch(reader);
+  return reader.result([&] { return std::move(m); });
+}
+
+std::unique_ptr<START_Message>
+START_Message::deserializeInBatch(ProtocolReader& reader) {
   const auto proto = reader.proto();
 
   START_Header hdr;
@@ -160,7 +167,8 @@ MessageReadResult START_Message::deserialize(ProtocolReader& reader) {
         m->attrs_.filter_type != ServerRecordFilterType::NOFILTER) {
       ld_error("Bad START message, unknown ServerRecordFilterType: %d",
                static_cast<int>(m->attrs_.filter_type));
-      return reader.errorResult(E::BADMSG);
+      reader.setError(E::BADMSG);
+      return nullptr;
     }
     reader.readLengthPrefixedVector(&m->attrs_.filter_key1);
     reader.readLengthPrefixedVector(&m->attrs_.filter_key2);
@@ -174,7 +182,10 @@ MessageReadResult START_Message::deserialize(ProtocolReader& reader) {
     }
   }
 
-  return reader.resultMsg(std::move(m));
+  if (!reader.ok()) {
+    return nullptr;
+  }
+  return m;
 }
 
 bool START_Message::allowUnencrypted() const {
@@ -152,6 +152,16 @@ class START_Message : public Message {
   static void readFilteredOut(ProtocolReader& reader, START_Message& m);
   static Message::deserializer_t deserialize;
 
+  /**
+   * START messages are self-delimiting, so serialize() is also used to write
+   * the STARTs of a STARTS_Message.
+   *
+   * @return  the START written by serialize() in a STARTS_Message, or nullptr
+   *          if the reader is in an error state afterwards
+   */
+  static std::unique_ptr<START_Message>
+  deserializeInBatch(ProtocolReader& reader);
+
   // `proto_' only populated when receiving
   uint16_t proto_;
   START_Header header_;
@@ -13,8 +13,6 @@
 #include "logdevice/common/ClientIdxAllocator.h"
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/RebuildingTypes.h"
-#include "logdevice/common/Request.h"
-#include "logdevice/common/RequestType.h"
 #include "logdevice/common/Sender.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/debug.h"
@@ -30,7 +28,8 @@ STORED_Message::STORED_Message(const STORED_Header& header,
                                log_rebuilding_id_t rebuilding_id,
                                FlushToken flushToken,
                                ServerInstanceId serverInstanceId,
-                               ShardID rebuildingRecipient)
+                               ShardID rebuildingRecipient,
+                               folly::Optional<STORED_Timings> timings)
     : Message(MessageType::STORED, calcTrafficClass(header)),
       header_(header),
       rebuilding_version_(rebuilding_version),
@@ -38,7 +37,14 @@ STORED_Message::STORED_Message(const STORED_Header& header,
       rebuilding_id_(rebuilding_id),
       flushToken_(flushToken),
       serverInstanceId_(serverInstanceId),
-      rebuildingRecipient_(rebuildingRecipient) {}
+      rebuildingRecipient_(rebuildingRecipient),
+      timings_(timings) {
+  if (timings_.hasValue()) {
+    header_.flags |= STORED_Header::TIMINGS;
+  } else {
+    header_.flags &= ~STORED_Header::TIMINGS;
+  }
+}
 
 MessageReadResult STORED_Message::deserialize(ProtocolReader& reader) {
   STORED_Header hdr;
@@ -73,6 +79,12 @@ MessageReadResult STORED_Message::deserialize(ProtocolReader& reader) {
     }
   }
 
+  folly::Optional<STORED_Timings> timings;
+  if (hdr.flags & STORED_Header::TIMINGS) {
+    timings.emplace();
+    reader.read(timings.get_pointer());
+  }
+
   return reader.result([&] {
     return new STORED_Message(hdr,
                               rebuilding_version,
@@ -80,12 +92,19 @@ MessageReadResult STORED_Message::deserialize(ProtocolReader& reader) {
                               rebuilding_id,
                               flushToken,
                               serverInstanceId,
-                              rebuildingRecipient);
+                              rebuildingRecipient,
+                              timings);
   });
 }
 
 void STORED_Message::serialize(ProtocolWriter& writer) const {
-  writer.write(&header_, STORED_Header::headerSize(writer.proto()));
+  const bool write_timings = timings_.hasValue() &&
+      writer.proto() >= Compatibility::STORED_TIMINGS_SUPPORT;
+  STORED_Header header = header_;
+  if (!write_timings) {
+    header.flags &= ~STORED_Header::TIMINGS;
+  }
+  writer.write(&header, STORED_Header::headerSize(writer.proto()));
   if (header_.flags & STORED_Header::REBUILDING) {
     writer.write(rebuilding_version_);
     writer.write(rebuilding_wave_);
@@ -96,12 +115,16 @@ void STORED_Message::serialize(ProtocolWriter& writer) const {
   if (header_.status == E::REBUILDING) {
     writer.write(rebuildingRecipient_);
   }
+  if (write_timings) {
+    writer.write(timings_.value());
+  }
 }
 
 Message::Disposition
 STORED_Message::handleOneMessage(const STORED_Header& header,
                                  ShardID from,
-                                 ShardID rebuildingRecipient) {
+                                 ShardID rebuildingRecipient,
+                                 const STORED_Timings* timings) {
   Appender* appender{
       // Appender that sent the corresponding STORE
       Worker::onThisThread()->activeAppenders().map.find(header.rid)};
@@ -115,7 +138,7 @@ STORED_Message::handleOneMessage(const STORED_Header& header,
 
   ld_assert(header.rid == Appender::KeyExtractor()(*appender));
 
-  return appender->onReply(header, from, rebuildingRecipient)
+  return appender->onReply(header, from, rebuildingRecipient, timings)
       ? Disposition::ERROR
       : Disposition::NORMAL;
 }
@@ -174,91 +197,18 @@ Message::Disposition STORED_Message::onReceivedCommon(const Address& from) {
     }
   }
 
-  return handleOneMessage(header_, shard, rebuildingRecipient_);
+  return handleOneMessage(
+      header_, shard, rebuildingRecipient_, timings_.get_pointer());
 }
 
-/**
- * Objects of class SendSTOREDRequest are Requests that Workers use to
- * arrange for the delivery of a reply to a chained STORE
- * request. Such replies are commonly sent through direct client
- * connections to the originator of the chain (a sequencer node). If
- * the client (incoming) connection from the sequencer was assigned to
- * a Worker other than the one that is handling the STORE, the Worker
- * handling the STORE posts a SendSTOREDRequest that the Processor
- * delivers to the Worker that the connection was assigned to.
- */
-class SendSTOREDRequest : public Request {
- public:
-  SendSTOREDRequest(const STORED_Header& header,
-                    lsn_t rebuilding_version,
-                    uint32_t rebuilding_wave,
-                    log_rebuilding_id_t rebuilding_id,
-                    FlushToken flushToken,
-                    ShardID rebuildingRecipient,
-                    ClientID to,
-                    worker_id_t target_worker)
-      : Request(RequestType::SEND_STORED),
-        header_(header),
-        rebuilding_version_(rebuilding_version),
-        rebuilding_wave_(rebuilding_wave),
-        rebuilding_id_(rebuilding_id),
-        flushToken_(flushToken),
-        rebuildingRecipient_(rebuildingRecipient),
-        to_(to),
-        target_worker_(target_worker) {}
-
-  int getThreadAffinity(int /*nthreads*/) override {
-    // route the request to the Worker that the incoming ("client")
-    // connection was assigned to
-    return target_worker_.val_;
-  }
-
-  Request::Execution execute() override {
-    auto serverInstanceId =
-        Worker::onThisThread()->processor_->getServerInstanceId();
-    auto msg = std::make_unique<STORED_Message>(header_,
-                                                rebuilding_version_,
-                                                rebuilding_wave_,
-                                                rebuilding_id_,
-                                                flushToken_,
-                                                serverInstanceId,
-                                                rebuildingRecipient_);
-
-    ld_check(to_.valid());
-
-    int rv = Worker::onThisThread()->sender().sendMessage(std::move(msg), to_);
-
-    if (rv != 0) {
-      RATELIMIT_INFO(std::chrono::seconds(1),
-                     10,
-                     "Failed to send a STORED message for %s to %s: %s",
-                     header_.rid.toString().c_str(),
-                     Sender::describeConnection(Address(to_)).c_str(),
-                     error_description(err));
-    }
-
-    return Execution::COMPLETE;
-  }
-
- private:
-  const STORED_Header header_; // header of request to send
-  lsn_t rebuilding_version_;
-  uint32_t rebuilding_wave_;
-  log_rebuilding_id_t rebuilding_id_;
-  FlushToken flushToken_;
-  ShardID rebuildingRecipient_;
-  const ClientID to_; // id of incoming ("client") connection
-                      // to send the request to
-  worker_id_t target_worker_;
-};
-
 void STORED_Message::createAndSend(const STORED_Header& header,
                                    ClientID send_to,
                                    lsn_t rebuilding_version,
                                    uint32_t rebuilding_wave,
                                    log_rebuilding_id_t rebuilding_id,
                                    FlushToken flushToken,
-                                   ShardID rebuildingRecipient) {
+                                   ShardID rebuildingRecipient,
+                                   folly::Optional<STORED_Timings> timings) {
   ld_check(send_to.valid()); // must have been set by onReceived()
   Worker* worker = Worker::onThisThread();
 
@@ -345,7 +295,8 @@ void STORED_Message::createAndSend(const STORED_Header& header,
                                                 rebuilding_id,
                                                 flushToken,
                                                 serverInstanceId,
-                                                rebuildingRecipient);
+                                                rebuildingRecipient,
+                                                timings);
     int rv = worker->sender().sendMessage(std::move(msg), send_to);
     if (rv != 0) {
       RATELIMIT_INFO(std::chrono::seconds(1),
@@ -358,29 +309,28 @@ void STORED_Message::createAndSend(const STORED_Header& header,
     }
   } else {
     // the connection to origin is handled by another Worker
-    // thread. Have that Worker send the reply. Hopefully we will be
-    // able to skip this step by having the storage task reply
-    // directly to the correct thread.
+    // thread. Hand the reply over to that Worker's Sender.
     ld_debug("%s is passing a STORED for %s to %s for delivery to %s",
              worker->getName().c_str(),
              header.rid.toString().c_str(),
              Worker::getName(target_worker.first, target_worker.second).c_str(),
              Sender::describeConnection(Address(send_to)).c_str());
 
-    std::unique_ptr<Request> send_stored =
-        std::make_unique<SendSTOREDRequest>(header,
-                                            rebuilding_version,
-                                            rebuilding_wave,
-                                            rebuilding_id,
-                                            flushToken,
-                                            rebuildingRecipient,
-                                            send_to,
-                                            target_worker.second);
-    int rv = worker->processor_->postRequest(send_stored);
+    auto msg = std::make_unique<STORED_Message>(
+        header,
+        rebuilding_version,
+        rebuilding_wave,
+        rebuilding_id,
+        flushToken,
+        worker->processor_->getServerInstanceId(),
+        rebuildingRecipient,
+        timings);
+    int rv =
+        Sender::forwardMessage(target_worker.second, std::move(msg), send_to);
     if (rv != 0) {
       RATELIMIT_INFO(std::chrono::seconds(1),
                      10,
-                     "Failed to post a SendSTOREDRequest for %s (wave %u) "
+                     "Failed to forward a STORED for %s (wave %u) "
                      "for final delivery to %s: %s",
                      header.rid.toString().c_str(),
                      header.wave,
@@ -406,6 +356,7 @@ STORED_Message::getDebugInfo() const {
     FLAG(REBUILDING)
     FLAG(PREMPTED_BY_SOFT_SEAL_ONLY)
     FLAG(LOW_WATERMARK_NOSPC)
+    FLAG(TIMINGS)
 #undef FLAG
     return folly::join('|', strings);
   };
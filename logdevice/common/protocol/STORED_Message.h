@@ -9,7 +9,10 @@
 
 #include <cstdint>
 
+#include <folly/Optional.h>
+
 #include "logdevice/common/ClientID.h"
+#include "logdevice/common/MessageArena.h"
 #include "logdevice/common/NodeID.h"
 #include "logdevice/common/RecordID.h"
 #include "logdevice/common/ShardID.h"
@@ -97,10 +100,41 @@ struct STORED_Header {
   static const STORED_flags_t PREMPTED_BY_SOFT_SEAL_ONLY = 1ul << 4; //=16
   // the local log store's partition crossed low-watermark
   static const STORED_flags_t LOW_WATERMARK_NOSPC = 1ul << 5; //=32
+  // the header is followed by STORED_Timings. Only set if the STORE had
+  // STORE_Header::TIMINGS and the protocol is at least
+  // Compatibility::STORED_TIMINGS_SUPPORT.
+  static const STORED_flags_t TIMINGS = 1ul << 6; //=64
+} __attribute__((__packed__));
+
+/**
+ * Where a STORE spent its time on the storage node, for the latency
+ * breakdown of sampled appends. All durations are in microseconds, capped at
+ * UINT32_MAX.
+ */
+struct STORED_Timings {
+  // from receiving the STORE to handing the write to the storage threads,
+  // including waiting for the log's seals to be read
+  uint32_t worker_usec;
+  // waiting in the storage thread queue
+  uint32_t queue_usec;
+  // writing the batch that included the record to the local log store
+  uint32_t write_usec;
+  // waiting for the WAL sync, 0 if the write wasn't synced
+  uint32_t sync_usec;
+  // from the write (or sync) completing to sending the STORED
+  uint32_t reply_usec;
+
+  uint64_t totalUsec() const {
+    return uint64_t(worker_usec) + queue_usec + write_usec + sync_usec +
+        reply_usec;
+  }
 } __attribute__((__packed__));
 
 class STORED_Message : public Message {
  public:
+  // Received instances are short-lived, see MessageArena.
+  MESSAGE_ARENA_ALLOCATED
+
   static TrafficClass calcTrafficClass(const STORED_Header& header) {
     return (header.flags & STORED_Header::REBUILDING) ? TrafficClass::REBUILD
                                                       : TrafficClass::APPEND;
@@ -112,7 +146,9 @@ class STORED_Message : public Message {
                           log_rebuilding_id_t rebuilding_id,
                           FlushToken flushToken,
                           ServerInstanceId serverInstanceId,
-                          ShardID rebuildingRecipient = ShardID());
+                          ShardID rebuildingRecipient = ShardID(),
+                          folly::Optional<STORED_Timings> timings =
+                              folly::none);
 
   void serialize(ProtocolWriter&) const override;
 
@@ -145,7 +181,9 @@ class STORED_Message : public Message {
                             uint32_t rebuilding_wave,
                             log_rebuilding_id_t rebuilding_id,
                             FlushToken flushToken = FlushToken_INVALID,
-                            ShardID rebuildingRecipient = ShardID());
+                            ShardID rebuildingRecipient = ShardID(),
+                            folly::Optional<STORED_Timings> timings =
+                                folly::none);
 
   STORED_Header header_;
 
@@ -171,6 +209,9 @@ class STORED_Message : public Message {
   // recipient in the copyset that is in the rebuilding set.
   ShardID rebuildingRecipient_;
 
+  // Set iff header_.flags has TIMINGS.
+  folly::Optional<STORED_Timings> timings_;
+
   virtual std::vector<std::pair<std::string, folly::dynamic>>
   getDebugInfo() const override;
 
@@ -178,9 +219,11 @@ class STORED_Message : public Message {
   /**
    * Calls Appender::onReply() once (at most).  Helper function.
    */
-  static Message::Disposition handleOneMessage(const STORED_Header& header,
-                                               ShardID from,
-                                               ShardID rebuildingRecipient);
+  static Message::Disposition
+  handleOneMessage(const STORED_Header& header,
+                   ShardID from,
+                   ShardID rebuildingRecipient,
+                   const STORED_Timings* timings = nullptr);
 
   friend Disposition STORED_onReceived(STORED_Message* msg,
                                        const Address& from);
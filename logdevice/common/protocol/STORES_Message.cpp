@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "STORES_Message.h"
+
+#include <algorithm>
+
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+
+namespace facebook { namespace logdevice {
+
+STORES_Message::STORES_Message(
+    std::vector<std::unique_ptr<STORE_Message>> stores)
+    : Message(MessageType::STORES,
+              stores.empty() ? TrafficClass::APPEND : stores.front()->tc_),
+      stores_(std::move(stores)) {}
+
+bool STORES_Message::cancelled() const {
+  // STOREs whose Appender is gone are still sent along with the others. The
+  // storage node stores them and the STORED replies are ignored, as for any
+  // STORE that was sent just before its Appender retired.
+  return std::all_of(stores_.begin(), stores_.end(), [](const auto& store) {
+    return store->cancelled();
+  });
+}
+
+void STORES_Message::serialize(ProtocolWriter& writer) const {
+  STORES_Header header = {uint32_t(stores_.size())};
+  writer.write(header);
+  for (const auto& store : stores_) {
+    store->serializeInBatch(writer);
+  }
+}
+
+MessageReadResult STORES_Message::deserialize(ProtocolReader& reader) {
+  return deserialize(reader, Worker::settings().max_payload_inline);
+}
+
+MessageReadResult STORES_Message::deserialize(ProtocolReader& reader,
+                                              size_t max_payload_inline) {
+  STORES_Header header;
+  reader.read(&header);
+
+  // Every STORE takes at least a STORE_Header, don't let a corrupted count
+  // make us allocate a huge vector.
+  if (reader.ok() &&
+      uint64_t(header.num_stores) * sizeof(STORE_Header) >
+          reader.bytesRemaining()) {
+    reader.setError(E::BADMSG);
+  }
+
+  std::vector<std::unique_ptr<STORE_Message>> stores;
+  if (reader.ok()) {
+    stores.reserve(header.num_stores);
+  }
+  for (uint32_t i = 0; reader.ok() && i < header.num_stores; ++i) {
+    auto store = STORE_Message::deserializeInBatch(reader, max_payload_inline);
+    if (!store) {
+      break;
+    }
+    stores.push_back(std::move(store));
+  }
+
+  return reader.result([&] { return new STORES_Message(std::move(stores)); });
+}
+
+uint16_t STORES_Message::getMinProtocolVersion() const {
+  return Compatibility::STORES_MESSAGE_SUPPORT;
+}
+
+std::string STORES_Message::identify() const {
+  std::string res = "stores=" + std::to_string(stores_.size());
+  if (!stores_.empty()) {
+    res += ",[" + stores_.front()->getHeader().rid.toString() + ".." +
+        stores_.back()->getHeader().rid.toString() + "]";
+  }
+  return res;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,62 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/STORE_Message.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Message sent by a sequencer to deliver the STOREs of several records
+ * to the same storage node at once. Equivalent to sending one STORE_Message
+ * per record, and each STORE is still answered with its own STORED, but the
+ * STOREs go through the messaging layer as a single message. Sequencers only
+ * send it to storage nodes whose protocol is at least
+ * Compatibility::STORES_MESSAGE_SUPPORT, when --store-batch-max-records is
+ * greater than 1 (see StoreBatcher).
+ */
+
+struct STORES_Header {
+  uint32_t num_stores; // number of STOREs following the header
+} __attribute__((__packed__));
+
+class STORES_Message : public Message {
+ public:
+  explicit STORES_Message(std::vector<std::unique_ptr<STORE_Message>> stores);
+
+  // see Message.h
+  bool cancelled() const override;
+  void serialize(ProtocolWriter&) const override;
+  static Message::deserializer_t deserialize;
+  // Overload of deserialize that does not need to run in an EventLoop
+  // context
+  static MessageReadResult deserialize(ProtocolReader&,
+                                       size_t max_payload_inline);
+  uint16_t getMinProtocolVersion() const override;
+
+  void onSent(Status, const Address& /* to */) const override {
+    // Handler lives either in STORES_onSent() (server) or
+    // ClientMessageDispatch (client). This should never get called.
+    std::abort();
+  }
+  Disposition onReceived(const Address&) override {
+    // Receipt handler lives in StoreStateMachine::onReceived(); this should
+    // never get called.
+    std::abort();
+  }
+
+  std::string identify() const;
+
+  std::vector<std::unique_ptr<STORE_Message>> stores_;
+};
+
+}} // namespace facebook::logdevice
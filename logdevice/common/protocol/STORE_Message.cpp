@@ -18,6 +18,7 @@
 
 #include "logdevice/common/Appender.h"
 #include "logdevice/common/EpochRecovery.h"
+#include "logdevice/common/ObjectPool.h"
 #include "logdevice/common/RebuildingTypes.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/debug.h"
@@ -97,6 +98,20 @@ STORE_Message::STORE_Message(const STORE_Header& header,
   ld_check(payload_);
 }
 
+void* STORE_Message::operator new(size_t size) {
+  bool reused;
+  void* p = ObjectPool<STORE_Message>::allocate(size, &reused);
+  WORKER_STAT_INCR(store_messages_allocated);
+  if (reused) {
+    WORKER_STAT_INCR(store_messages_allocated_from_pool);
+  }
+  return p;
+}
+
+void STORE_Message::operator delete(void* p, size_t size) {
+  ObjectPool<STORE_Message>::deallocate(p, size);
+}
+
 bool STORE_Message::cancelled() const {
   if (appender_context_) {
     // TODO: Is this check worth it?  This is likely executing very quickly
@@ -113,6 +128,15 @@ bool STORE_Message::cancelled() const {
 }
 
 void STORE_Message::serialize(ProtocolWriter& writer) const {
+  serializeImpl(writer, /*in_batch=*/false);
+}
+
+void STORE_Message::serializeInBatch(ProtocolWriter& writer) const {
+  serializeImpl(writer, /*in_batch=*/true);
+}
+
+void STORE_Message::serializeImpl(ProtocolWriter& writer,
+                                  bool in_batch) const {
   // Assert that the expectation documented in the header file about
   // `first_amendable_offset' is satisfied.  This is not in the constructor
   // because the forwarding codepath on storage nodes modifies and sends an
@@ -185,8 +209,21 @@ void STORE_Message::serialize(ProtocolWriter& writer) const {
     }
   }
 
-  if (payload_ && !(header_.flags & STORE_Header::AMEND)) {
+  const bool include_payload =
+      payload_ && !(header_.flags & STORE_Header::AMEND);
+  if (in_batch) {
+    writer.write(static_cast<uint32_t>(include_payload ? payload_->size() : 0));
+  }
+  if (include_payload) {
     payload_->serialize(writer);
+    if (!writer.isBlackHole()) {
+      if (payload_->serializesByReference()) {
+        WORKER_STAT_INCR(store_payload_references);
+      } else {
+        WORKER_STAT_INCR(store_payload_copies);
+        WORKER_STAT_ADD(store_payload_bytes_copied, payload_->size());
+      }
+    }
   }
 }
 
@@ -196,6 +233,20 @@ MessageReadResult STORE_Message::deserialize(ProtocolReader& reader) {
 
 MessageReadResult STORE_Message::deserialize(ProtocolReader& reader,
                                              size_t max_payload_inline) {
+  auto m = deserializeImpl(reader, max_payload_inline, /*in_batch=*/false);
+  return reader.result([&] { return std::move(m); });
+}
+
+std::unique_ptr<STORE_Message>
+STORE_Message::deserializeInBatch(ProtocolReader& reader,
+                                  size_t max_payload_inline) {
+  return deserializeImpl(reader, max_payload_inline, /*in_batch=*/true);
+}
+
+std::unique_ptr<STORE_Message>
+STORE_Message::deserializeImpl(ProtocolReader& reader,
+                               size_t max_payload_inline,
+                               bool in_batch) {
   const auto proto = reader.proto();
   STORE_Header hdr;
   STORE_Extra extra;
@@ -234,7 +285,8 @@ MessageReadResult STORE_Message::deserialize(ProtocolReader& reader,
              "range [1..%zu]",
              hdr.copyset_size,
              COPYSET_SIZE_MAX);
-    return reader.errorResult(E::BADMSG);
+    reader.setError(E::BADMSG);
+    return nullptr;
   }
 
   folly::small_vector<StoreChainLink, 6> copyset;
@@ -274,23 +326,34 @@ MessageReadResult STORE_Message::deserialize(ProtocolReader& reader,
     reader.readLengthPrefixedVector(&tracing_context);
   }
 
-  const size_t payload_size = reader.bytesRemaining();
+  // Inside a STORES message, the payload is followed by other STOREs and its
+  // size precedes it.
+  size_t payload_size = reader.bytesRemaining();
+  if (in_batch) {
+    uint32_t size = 0;
+    reader.read(&size);
+    payload_size = size;
+    if (reader.ok() && payload_size > reader.bytesRemaining()) {
+      reader.setError(E::BADMSG);
+    }
+  }
   auto payload_holder =
       std::make_shared<PayloadHolder>(PayloadHolder::deserialize(
           reader,
           payload_size,
           /*zero_copy*/ payload_size > max_payload_inline));
 
-  return reader.result([&] {
-    std::unique_ptr<STORE_Message> m(
-        new STORE_Message(hdr, std::move(payload_holder)));
-    m->copyset_ = std::move(copyset);
-    m->block_starting_lsn_ = std::move(block_starting_lsn);
-    m->extra_ = std::move(extra);
-    m->optional_keys_ = std::move(optional_keys);
-    m->e2e_tracing_context_ = std::move(tracing_context);
-    return m;
-  });
+  if (!reader.ok()) {
+    return nullptr;
+  }
+  std::unique_ptr<STORE_Message> m(
+      new STORE_Message(hdr, std::move(payload_holder)));
+  m->copyset_ = std::move(copyset);
+  m->block_starting_lsn_ = std::move(block_starting_lsn);
+  m->extra_ = std::move(extra);
+  m->optional_keys_ = std::move(optional_keys);
+  m->e2e_tracing_context_ = std::move(tracing_context);
+  return m;
 }
 
 void STORE_Message::onSentCommon(Status st, const Address& to) const {
@@ -505,6 +568,8 @@ std::string STORE_Message::flagsToString(STORE_flags_t flags) {
   FLAG(BRIDGE)
   FLAG(EPOCH_BEGIN)
   FLAG(DRAINED)
+  FLAG(NO_RECORD_CACHE)
+  FLAG(TIMINGS)
 
 #undef FLAG
 
@@ -170,6 +170,16 @@ struct STORE_Header {
   //       be set on a STORE. Used for asserts.
   static const STORE_flags_t DRAINED = 1u << 19; //=524288
 
+  // The record belongs to a log in streaming ingest mode: the storage node
+  // should not put it in its record cache. Not persisted. Storage nodes that
+  // don't know the flag ignore it and cache the record as usual.
+  static const STORE_flags_t NO_RECORD_CACHE = 1u << 20; //=1048576
+
+  // The append was sampled for a latency breakdown: the storage node should
+  // reply with STORED_Timings (see STORED_Header::TIMINGS). Not persisted.
+  // Storage nodes that don't know the flag ignore it.
+  static const STORE_flags_t TIMINGS = 1u << 21; //=2097152
+
   // Please update STORE_Message::flagsToString() when adding flags.
 } __attribute__((__packed__));
 
@@ -267,6 +277,11 @@ class STORE_Message : public Message {
   STORE_Message(const STORE_Message&) = delete;
   STORE_Message& operator=(const STORE_Message&) = delete;
 
+  // A wave of STOREs is allocated for every append; their memory is recycled
+  // through a per-thread ObjectPool. See store_messages_allocated* stats.
+  static void* operator new(size_t size);
+  static void operator delete(void* p, size_t size);
+
   static TrafficClass calcTrafficClass(const STORE_Header& header) {
     TrafficClass tc;
 
@@ -307,6 +322,20 @@ class STORE_Message : public Message {
   static MessageReadResult deserialize(ProtocolReader&,
                                        size_t max_payload_inline);
 
+  /**
+   * Serializes the message as part of a STORES message: the same as
+   * serialize(), except that the payload is prefixed with its size, so that
+   * other STOREs can follow it.
+   */
+  void serializeInBatch(ProtocolWriter& writer) const;
+
+  /**
+   * @return  the STORE written by serializeInBatch(), or nullptr if the
+   *          reader is in an error state afterwards
+   */
+  static std::unique_ptr<STORE_Message>
+  deserializeInBatch(ProtocolReader& reader, size_t max_payload_inline);
+
   /**
    * @return a human-readable representation of copyset_
    */
@@ -393,6 +422,12 @@ class STORE_Message : public Message {
   STORE_Message(const STORE_Header& header,
                 std::shared_ptr<PayloadHolder>&& payload);
 
+  void serializeImpl(ProtocolWriter& writer, bool in_batch) const;
+  static std::unique_ptr<STORE_Message>
+  deserializeImpl(ProtocolReader& reader,
+                  size_t max_payload_inline,
+                  bool in_batch);
+
   // Convenience wrapper for STORED_Message::createAndSend
   void sendReply(Status status,
                  Seal seal = Seal(),
@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "WINDOWS_Message.h"
+
+#include <algorithm>
+
+#include "logdevice/common/MetaDataLog.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/client_read_stream/AllClientReadStreams.h"
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+WINDOWS_Message::WINDOWS_Message(std::vector<WINDOW_Header> windows)
+    : Message(MessageType::WINDOWS, TrafficClass::HANDSHAKE),
+      windows_(std::move(windows)) {}
+
+void WINDOWS_Message::serialize(ProtocolWriter& writer) const {
+  WINDOWS_Header header = {uint32_t(windows_.size())};
+  writer.write(header);
+  writer.writeVector(windows_);
+}
+
+MessageReadResult WINDOWS_Message::deserialize(ProtocolReader& reader) {
+  WINDOWS_Header header;
+  reader.read(&header);
+  // Don't let a corrupted count make us allocate a huge vector.
+  if (reader.ok() &&
+      uint64_t(header.count) * sizeof(WINDOW_Header) !=
+          reader.bytesRemaining()) {
+    reader.setError(E::BADMSG);
+  }
+  std::vector<WINDOW_Header> windows;
+  if (reader.ok()) {
+    reader.readVector(&windows, header.count);
+  }
+  return reader.result(
+      [&] { return new WINDOWS_Message(std::move(windows)); });
+}
+
+uint16_t WINDOWS_Message::getMinProtocolVersion() const {
+  return Compatibility::WINDOWS_MESSAGE_SUPPORT;
+}
+
+void WINDOWS_Message::onSent(Status st, const Address& to) const {
+  Message::onSent(st, to);
+  if (st == E::OK) {
+    return;
+  }
+  // Let the read streams retry, as they do when sending a WINDOW_Message
+  // fails right away.
+  auto& streams = Worker::onThisThread()->clientReadStreams();
+  for (const WINDOW_Header& window : windows_) {
+    streams.onWindowSendFailed(window.read_stream_id,
+                               ShardID(to.id_.node_.index(), window.shard));
+  }
+}
+
+bool WINDOWS_Message::allowUnencrypted() const {
+  return Worker::settings().read_streams_use_metadata_log_only &&
+      std::all_of(windows_.begin(), windows_.end(), [](const auto& window) {
+           return MetaDataLog::isMetaDataLog(window.log_id);
+         });
+}
+
+}} // namespace facebook::logdevice
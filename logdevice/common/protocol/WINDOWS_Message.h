@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <vector>
+
+#include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/WINDOW_Message.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Message sent by a reader to update the sliding windows of several
+ * read streams on the same storage node at once. Equivalent to sending one
+ * WINDOW_Message per entry. Readers only send it to nodes whose protocol is
+ * at least Compatibility::WINDOWS_MESSAGE_SUPPORT (see
+ * AllClientReadStreams::enqueueWindowForBatch()).
+ */
+
+struct WINDOWS_Header {
+  uint32_t count; // number of WINDOW_Headers following the header
+} __attribute__((__packed__));
+
+class WINDOWS_Message : public Message {
+ public:
+  explicit WINDOWS_Message(std::vector<WINDOW_Header> windows);
+
+  // see Message.h
+  void serialize(ProtocolWriter&) const override;
+  static Message::deserializer_t deserialize;
+  uint16_t getMinProtocolVersion() const override;
+  void onSent(Status st, const Address& to) const override;
+  Disposition onReceived(const Address&) override {
+    // Receipt handler is AllServerReadStreams::onWindowsMessage(); this should
+    // never get called.
+    std::abort();
+  }
+  bool warnAboutOldProtocol() const override {
+    // Only sent on connections known to support it.
+    return false;
+  }
+  // Only if every WINDOW allows it.
+  bool allowUnencrypted() const override;
+
+  // Each entry has the same meaning as the header of a WINDOW_Message.
+  std::vector<WINDOW_Header> windows_;
+};
+
+}} // namespace facebook::logdevice
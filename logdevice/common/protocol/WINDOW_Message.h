@@ -8,6 +8,7 @@
 #pragma once
 
 #include "Message.h"
+#include "logdevice/common/MessageArena.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/include/types.h"
 
@@ -35,6 +36,9 @@ struct WINDOW_Header {
 
 class WINDOW_Message : public Message {
  public:
+  // Received instances are short-lived, see MessageArena.
+  MESSAGE_ARENA_ALLOCATED
+
   /**
    * Construct a WINDOW message.
    */
@@ -29,10 +29,15 @@ void ReplicatedStateMachine<T, D>::start() {
   // Initialize `data_` with a default value that we'll use if the snapshot
   // log is empty.
   data_ = makeDefaultState(version_);
+  start_time_ = std::chrono::steady_clock::now();
 
   if (snapshot_log_id_ == LOGID_INVALID) {
     onBaseSnapshotRetrieved();
   } else {
+    // Find the tail of the delta log while we read the snapshot log, rather
+    // than after, so that reading deltas can start as soon as we have the
+    // base snapshot.
+    getDeltaLogTailLSN();
     getSnapshotLogTailLSN();
   }
   stopped_ = false;
@@ -158,6 +163,7 @@ void ReplicatedStateMachine<T, D>::onGotSnapshotLogTailLSN(Status st,
 
   ld_check(lsn != LSN_INVALID);
   snapshot_sync_ = lsn;
+  snapshot_tail_latency_ = timeSinceStart();
 
   // If stop_at_tail_ is used, we don't care about reading past the tail of the
   // snapshot log.
@@ -403,15 +409,20 @@ void ReplicatedStateMachine<T, D>::onBaseSnapshotRetrieved() {
   rsm_info(rsm_type_,
            "Base snapshot has version %s",
            lsn_to_string(version_).c_str());
+  snapshot_replay_latency_ = timeSinceStart();
   gotInitialState(*data_);
   sync_state_ = SyncState::SYNC_DELTAS;
-  getDeltaLogTailLSN();
+  if (prefetched_delta_sync_ != LSN_INVALID) {
+    const lsn_t lsn = prefetched_delta_sync_;
+    prefetched_delta_sync_ = LSN_INVALID;
+    onGotDeltaLogTailLSN(E::OK, lsn);
+  } else {
+    getDeltaLogTailLSN();
+  }
 }
 
 template <typename T, typename D>
 void ReplicatedStateMachine<T, D>::getDeltaLogTailLSN() {
-  ld_check(version_ != LSN_INVALID);
-  ld_check(data_);
 
   rsm_info(rsm_type_, "Retrieving tail lsn of delta log...");
 
@@ -444,6 +455,15 @@ void ReplicatedStateMachine<T, D>::onGotDeltaLogTailLSN(Status st, lsn_t lsn) {
   rsm_info(
       rsm_type_, "Tail lsn of delta log is %s", lsn_to_string(lsn).c_str());
 
+  if (sync_state_ == SyncState::SYNC_SNAPSHOT) {
+    // Requested by start(). Deltas can only be read once we know the version
+    // of the base snapshot, onBaseSnapshotRetrieved() takes it from here.
+    prefetched_delta_sync_ = lsn;
+    return;
+  }
+  ld_check(version_ != LSN_INVALID);
+  ld_check(data_);
+
   // We will notifier subscribers of the initial state machine's state only
   // after we sync up to that lsn.
   ld_check(lsn != LSN_INVALID);
@@ -738,6 +758,9 @@ bool ReplicatedStateMachine<T, D>::onDeltaGap(const GapRecord& gap) {
 template <typename T, typename D>
 void ReplicatedStateMachine<T, D>::onReachedDeltaLogTailLSN() {
   sync_state_ = SyncState::TAILING;
+  if (!delta_replay_latency_.hasValue()) {
+    delta_replay_latency_ = timeSinceStart();
+  }
 
   rsm_info(rsm_type_, "Reached tail of delta log");
 
@@ -1243,6 +1266,15 @@ void ReplicatedStateMachine<T, D>::getDebugInfo(
   table.set<11>(numBytesSinceLastSnapshot());
   table.set<12>(numDeltaRecordsSinceLastSnapshot());
   table.set<13>(delta_read_stream_is_healthy_);
+  if (snapshot_tail_latency_.hasValue()) {
+    table.set<14>(snapshot_tail_latency_.value());
+  }
+  if (snapshot_replay_latency_.hasValue()) {
+    table.set<15>(snapshot_replay_latency_.value());
+  }
+  if (delta_replay_latency_.hasValue()) {
+    table.set<16>(delta_replay_latency_.value());
+  }
 }
 
 }} // namespace facebook::logdevice
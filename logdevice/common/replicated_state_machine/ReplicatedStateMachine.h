@@ -627,7 +627,8 @@ class ReplicatedStateMachine {
   // the tail lsn `snapshot_sync_` of the snapshot log. When this
   // function is called, we have the base snapshot to apply deltas onto, so it's
   // time to read the delta log.
-  // Calls getDeltaLogTailLSN().
+  // Calls getDeltaLogTailLSN() unless start() already got the tail of the
+  // delta log.
   void onBaseSnapshotRetrieved();
 
   // When we are tailing, we may receive a new snapshot record. Applying that
@@ -700,6 +701,23 @@ class ReplicatedStateMachine {
   // version of the last record from the snapshot log.
   lsn_t last_snapshot_version_{LSN_INVALID};
 
+  // Tail of the delta log retrieved while we were still reading the snapshot
+  // log, see start(). LSN_INVALID if we don't have it.
+  lsn_t prefetched_delta_sync_{LSN_INVALID};
+
+  // Time start() was called, and how long it then took to find the tail of the
+  // snapshot log, to retrieve the base snapshot and to reach the tail of the
+  // delta log. Reported by getDebugInfo().
+  std::chrono::steady_clock::time_point start_time_;
+  folly::Optional<std::chrono::milliseconds> snapshot_tail_latency_;
+  folly::Optional<std::chrono::milliseconds> snapshot_replay_latency_;
+  folly::Optional<std::chrono::milliseconds> delta_replay_latency_;
+
+  std::chrono::milliseconds timeSinceStart() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time_);
+  }
+
   // Current state of the process of syncing our local version to the last
   // version prior to this state machine starting.
   // SYNC_SNAPSHOT: we are issuing a SyncSequencerRequest to find the tail LSN
@@ -10,9 +10,13 @@
 #include <iostream>
 
 #include "logdevice/common/commandline_util_chrono.h"
+#include "logdevice/common/settings/Validators.h"
 
 namespace facebook { namespace logdevice {
 
+// Defined in Settings.cpp.
+std::istream& operator>>(std::istream& in, NodeLocationScope& val);
+
 std::istream& operator>>(std::istream& in, GossipSettings::SelectionMode& val) {
   std::string token;
   in >> token;
@@ -20,6 +24,8 @@ std::istream& operator>>(std::istream& in, GossipSettings::SelectionMode& val) {
     val = GossipSettings::SelectionMode::RANDOM;
   } else if (token == "round-robin") {
     val = GossipSettings::SelectionMode::ROUND_ROBIN;
+  } else if (token == "locality") {
+    val = GossipSettings::SelectionMode::LOCALITY;
   } else {
     in.setstate(std::ios::failbit);
   }
@@ -122,7 +128,30 @@ void GossipSettings::defineSettings(SettingEasyInit& init) {
        "How to select a node to send a "
        "gossip message to. One of: "
        "'round-robin', "
-       "'random' (default)",
+       "'random' (default), "
+       "'locality' (see gossip-locality-scope)",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::FailureDetector);
+  init("gossip-locality-scope",
+       &locality_scope,
+       "rack",
+       nullptr, // no validation
+       "With gossip-mode 'locality', nodes send gossip messages to random "
+       "nodes in the same location scope as them, e.g. the same rack, "
+       "except for one in gossip-cross-scope-interval messages, which goes to "
+       "a random node outside of it. This keeps heartbeats flowing mostly "
+       "over short distances in large clusters, while every message still "
+       "carries the state of the whole cluster.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::FailureDetector);
+  init("gossip-cross-scope-interval",
+       &cross_scope_gossip_interval,
+       "4",
+       validate_positive<ssize_t>(),
+       "With gossip-mode 'locality', one in this many gossip messages goes to "
+       "a node outside of gossip-locality-scope. Higher values reduce "
+       "cross-scope traffic, but increase the time it takes to detect "
+       "failures in other scopes.",
        SERVER | REQUIRES_RESTART,
        SettingsCategory::FailureDetector);
   init("ignore-isolation",
@@ -10,6 +10,7 @@
 #include <chrono>
 
 #include "logdevice/common/settings/UpdateableSettings.h"
+#include "logdevice/include/NodeLocationScope.h"
 
 /**
  * @file  Settings specific to the gossip-based failure detector.
@@ -21,6 +22,9 @@ struct GossipSettings : public SettingsBundle {
   enum class SelectionMode {
     RANDOM,
     ROUND_ROBIN,
+    // Mostly gossip to random nodes sharing locality_scope with this node,
+    // see gossip-locality-scope.
+    LOCALITY,
   };
 
   // See .cpp for docs and defaults
@@ -34,6 +38,8 @@ struct GossipSettings : public SettingsBundle {
   std::chrono::milliseconds suspect_duration;
   std::chrono::seconds gossip_msg_dump_duration;
   SelectionMode mode;
+  NodeLocationScope locality_scope;
+  int cross_scope_gossip_interval;
   // Determines whether to ignore isolation detection
   // This settings is used to bypass the minority partition check in the
   // failure detector, which is by default enabled. The failure detector
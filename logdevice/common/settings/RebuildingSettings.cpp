@@ -195,6 +195,56 @@ void RebuildingSettings::defineSettings(SettingEasyInit& init) {
        "time.",
        SERVER,
        SettingsCategory::Rebuilding);
+  init("rebuilding-batch-chunk-stores",
+       &batch_chunk_stores,
+       "false",
+       nullptr,
+       "Send the STOREs of all records of a rebuilding chunk (consecutive "
+       "records of a log with the same copyset) to each recipient in one "
+       "STORES message rather than one message per record. Only used with "
+       "recipients that support STORES messages. Each record is still "
+       "acknowledged with its own STORED.",
+       SERVER,
+       SettingsCategory::Rebuilding);
+  init("rebuilding-donor-store-latency-target",
+       &donor_store_latency_target,
+       "0ms",
+       [](std::chrono::milliseconds val) {
+         if (val.count() < 0) {
+           throw boost::program_options::error(
+               "rebuilding-donor-store-latency-target must be non-negative");
+         }
+       },
+       "If positive, a donor halves the number of logs it rebuilds at the same "
+       "time whenever the p99 latency of stores of appends on the shard over "
+       "the last --rebuilding-donor-throttle-interval exceeds this, and adds "
+       "one back, up to --rebuilding-max-logs-in-flight, whenever it doesn't. "
+       "0 disables this limit.",
+       SERVER,
+       SettingsCategory::Rebuilding);
+  init("rebuilding-donor-socket-backlog-target",
+       &donor_socket_backlog_target,
+       "0",
+       nullptr,
+       "Same as --rebuilding-donor-store-latency-target, but for the number "
+       "of bytes waiting to be written to sockets across all workers. 0 "
+       "disables this limit.",
+       SERVER,
+       SettingsCategory::Rebuilding);
+  init("rebuilding-donor-throttle-interval",
+       &donor_throttle_interval,
+       "1s",
+       [](std::chrono::milliseconds val) {
+         if (val.count() <= 0) {
+           throw boost::program_options::error(
+               "rebuilding-donor-throttle-interval must be positive");
+         }
+       },
+       "How often a donor checks --rebuilding-donor-store-latency-target and "
+       "--rebuilding-donor-socket-backlog-target to adjust the number of logs "
+       "it rebuilds at the same time.",
+       SERVER,
+       SettingsCategory::Rebuilding);
   init("rebuilding-use-rocksdb-cache",
        &use_rocksdb_cache,
        "true",
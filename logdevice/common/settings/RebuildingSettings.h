@@ -45,6 +45,10 @@ struct RebuildingSettings : public SettingsBundle {
   size_t max_records_in_flight;
   size_t max_amends_in_flight;
   size_t max_logs_in_flight;
+  bool batch_chunk_stores;
+  std::chrono::milliseconds donor_store_latency_target;
+  size_t donor_socket_backlog_target;
+  std::chrono::milliseconds donor_throttle_interval;
   bool use_rocksdb_cache;
   RebuildingReadOnlyOption read_only;
   size_t checkpoint_interval_mb;
@@ -33,6 +33,17 @@ void SequencerBoycottingSettings::defineSettings(SettingEasyInit& init) {
        CLIENT | REQUIRES_RESTART /* Used when initializing NodeStatsHandler */
            | EXPERIMENTAL,       /* (during worker thread start) */
        SettingsCategory::SequencerBoycotting);
+  init("node-stats-slow-append-threshold",
+       &node_stats_slow_append_threshold,
+       "0ms",
+       validate_nonnegative<ssize_t>(),
+       "Successful appends that took longer than this are reported to the "
+       "cluster as failed appends to their sequencer node in the per-node "
+       "stats. This makes sequencers that are much slower than the rest of "
+       "the cluster, but don't fail appends, outliers for sequencer "
+       "boycotting. 0 disables.",
+       CLIENT | EXPERIMENTAL,
+       SettingsCategory::SequencerBoycotting);
   init("node-stats-timeout-delay",
        &node_stats_timeout_delay,
        "2s",
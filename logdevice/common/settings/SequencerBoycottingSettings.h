@@ -32,6 +32,11 @@ struct SequencerBoycottingSettings {
   // Defines the delay before trying to resend a NODE_STATS_Message
   chrono_expbackoff_t<std::chrono::milliseconds> node_stats_send_retry_delay;
 
+  // Client only setting:
+  // Successful appends slower than this are reported as failed in the node
+  // stats, so that slow sequencers can be boycotted. 0 disables.
+  std::chrono::milliseconds node_stats_slow_append_threshold;
+
   // Client only setting:
   // Defines the accepted delay between successfully sending a
   // NODE_STATS_Message and then receiving a NODE_STATS_REPLY_Message
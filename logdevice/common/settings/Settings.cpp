@@ -25,6 +25,7 @@
 #include "logdevice/common/protocol/Compatibility.h"
 #include "logdevice/common/protocol/MessageTypeNames.h"
 #include "logdevice/common/settings/Validators.h"
+#include "logdevice/common/util.h"
 
 using namespace facebook::logdevice::setting_validators;
 
@@ -108,6 +109,38 @@ parse_recipients_list(const std::string& value) {
   return recipients;
 }
 
+static std::vector<int> parse_cpus(const std::string& value) {
+  std::vector<int> cpus;
+  if (parse_cpu_list(value, &cpus) != 0) {
+    throw boost::program_options::error(
+        std::string("Invalid CPU list in --worker-cpus. Expected a list like "
+                    "\"0-7,16-23\"."));
+  }
+  return cpus;
+}
+
+static std::vector<int> parse_numa_nodes(const std::string& value) {
+  std::vector<std::string> nodes_tmp;
+  std::vector<int> nodes;
+  folly::split(",", value, nodes_tmp, true);
+  try {
+    for (const auto& node : nodes_tmp) {
+      nodes.push_back(std::stoi(node, nullptr, 10));
+    }
+  } catch (const std::logic_error& ex) {
+    throw boost::program_options::error(
+        std::string("Invalid NUMA node in --storage-thread-numa-nodes."));
+  }
+  for (int node : nodes) {
+    if (node < 0) {
+      throw boost::program_options::error(
+          std::string("NUMA nodes in --storage-thread-numa-nodes must be "
+                      "nonnegative."));
+    }
+  }
+  return nodes;
+}
+
 static std::unordered_set<logid_t> parse_log_set(const std::string& value) {
   std::unordered_set<logid_t> res;
 
@@ -360,6 +393,31 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "per CPU core",
        SERVER | CLIENT | REQUIRES_RESTART /* used in Processor ctor */,
        SettingsCategory::Execution);
+  init("worker-cpus",
+       &worker_cpus,
+       "",
+       parse_cpus,
+       "CPUs to pin worker threads to, as a list like \"0-7,16-23\". General "
+       "worker i runs on CPU number i modulo the length of the list, other "
+       "workers (failure detector, background) on all of them. On servers, "
+       "incoming connections are handed to a worker pinned to the CPU that "
+       "received their packets (SO_INCOMING_CPU), so with the NIC's RSS "
+       "queues steered to these CPUs a connection is served by the core that "
+       "handles its interrupts. Empty to not pin workers.",
+       SERVER | CLIENT | REQUIRES_RESTART /* used when workers start */,
+       SettingsCategory::Execution);
+  init("shared-transport",
+       &shared_transport,
+       "false",
+       nullptr, // no validation
+       "If true, Clients created in the same process for the same cluster "
+       "and credentials share one set of workers and connections to the "
+       "cluster, created by the first of them with its settings. Each Client "
+       "keeps its own settings and stats for what it does itself, such as "
+       "timeouts of its API calls. The workers are shut down when the last "
+       "of these Clients is destroyed.",
+       CLIENT | REQUIRES_RESTART /* used in ClientImpl ctor */,
+       SettingsCategory::Execution);
   init("trace-db-shard",
        &trace_db_shard,
        "-1",
@@ -398,6 +456,16 @@ void Settings::defineSettings(SettingEasyInit& init) {
        " otherwise FBTraceLogger is used",
        SERVER | CLIENT | REQUIRES_RESTART /* init'ed at startup */,
        SettingsCategory::Monitoring);
+  init("trace-logger-queue-size",
+       &trace_logger_queue_size,
+       "10000",
+       parse_nonnegative<ssize_t>(),
+       "Trace samples are published by a background thread, so that tracing "
+       "doesn't add latency to workers. This is how many samples may wait for "
+       "it; more are dropped, see the trace_samples_dropped stat. 0 to "
+       "publish samples on the thread that traces them.",
+       SERVER | CLIENT | REQUIRES_RESTART,
+       SettingsCategory::Monitoring);
   init("outbytes-mb",
        &outbufs_mb_max_per_thread,
        "512",
@@ -405,6 +473,16 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "per-thread limit on bytes pending in output evbuffers (in MB)",
        SERVER | CLIENT,
        SettingsCategory::Network);
+  init("outbytes-mb-total",
+       &outbufs_mb_max_total,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "limit on bytes pending in output evbuffers of all workers together "
+       "(in MB). Workers reserve bytes from it 1MB at a time, so each of them "
+       "may hold up to 2MB more than it has pending. 0 means no limit other "
+       "than outbytes-mb.",
+       SERVER | CLIENT | REQUIRES_RESTART,
+       SettingsCategory::Network);
   init("sendbuf-kb",
        &tcp_sendbuf_kb,
        "-1",
@@ -414,6 +492,67 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "apply it to existing sockets, only to newly created ones",
        SERVER | CLIENT,
        SettingsCategory::Network);
+  init("zerocopy-send-threshold",
+       &zerocopy_send_threshold,
+       "0",
+       nullptr, // no validation
+       "If positive, non-SSL TCP sockets are opened with SO_ZEROCOPY, and "
+       "whenever at least this many bytes are waiting to be sent and the "
+       "socket isn't backed up, they are sent with MSG_ZEROCOPY: the kernel "
+       "transmits payloads straight from our memory instead of copying them "
+       "into the socket buffer, and the memory is released once the kernel "
+       "reports the transmission complete. Worth it for large records, e.g. "
+       "1MB; for small messages the page pinning and completion handling "
+       "cost more than the copy. Only applies to new connections. 0 "
+       "disables zerocopy sends.",
+       SERVER | CLIENT,
+       SettingsCategory::Network);
+  init("output-cork-delay",
+       &output_cork_delay,
+       "0ms",
+       validate_nonnegative<ssize_t>(),
+       "If nonzero, messages written to a socket are collected for up to this "
+       "long, or until 64KB have accumulated, and then handed to the kernel "
+       "together, in as few writev() calls as possible. Trades a little "
+       "latency for fewer syscalls on sockets carrying many small messages "
+       "(STORE, RELEASE, WINDOW, GAP). Only applies to new connections. 0 "
+       "hands messages written during an event loop iteration to the kernel "
+       "at the end of that iteration.",
+       SERVER | CLIENT,
+       SettingsCategory::Network);
+  init("socket-busy-poll",
+       &socket_busy_poll,
+       "0us",
+       validate_nonnegative<ssize_t>(),
+       "If nonzero, set SO_BUSY_POLL to this value on the sockets of workers "
+       "that busy-poll (see busy-poll-workers), so that the kernel polls the "
+       "NIC queue of a socket for this long when it has no data instead of "
+       "waiting for an interrupt. Raising it above the net.core.busy_read "
+       "sysctl requires CAP_NET_ADMIN. Only applies to new connections.",
+       SERVER | CLIENT,
+       SettingsCategory::Network);
+  init("separate-rebuilding-connections",
+       &separate_rebuilding_connections,
+       "false",
+       nullptr, // no validation
+       "Open a second connection from each worker to each node, used only by "
+       "rebuilding STOREs and their STORED replies. Large rebuilding records "
+       "then don't queue ahead of appends and control messages to the same "
+       "node in socket buffers. Traffic shaping still applies to REBUILD "
+       "traffic as configured.",
+       SERVER,
+       SettingsCategory::Network);
+  init("separate-read-connections",
+       &separate_read_connections,
+       "false",
+       nullptr, // no validation
+       "Open a second connection from each worker to each storage node, used "
+       "only by read streams. Its HELLO says so, and storage nodes that have "
+       "--num-read-workers serve it on their read workers, apart from "
+       "appends. Requires plaintext connections to storage nodes to have an "
+       "effect; SSL connections are served by the general workers.",
+       SERVER | CLIENT | REQUIRES_RESTART,
+       SettingsCategory::Network);
   init(
       "rcvbuf-kb",
       &tcp_rcvbuf_kb,
@@ -474,6 +613,123 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "amount of RECORD data to read from local log store at once",
        SERVER,
        SettingsCategory::ReadPath);
+  init("zero-copy-record-payloads",
+       &zero_copy_record_payloads,
+       "false",
+       nullptr,
+       "When shipping records read on storage threads, attach the payload to "
+       "the RECORD message in place, inside the buffer the storage thread "
+       "copied the record into, instead of copying it into a new buffer. The "
+       "whole record buffer is then kept in memory until the message is "
+       "sent. Records read on worker threads are still copied.",
+       SERVER,
+       SettingsCategory::ReadPath);
+  init("share-real-time-record-payloads",
+       &share_real_time_record_payloads,
+       "false",
+       nullptr,
+       "When shipping records from the real-time buffer to tailing readers, "
+       "attach the buffer's copy of the payload to the RECORD messages by "
+       "reference instead of copying it for every read stream. Readers at the "
+       "same position then share one copy of each record. Records stay in "
+       "memory until all RECORD messages referencing them are sent, even if "
+       "evicted from the buffer.",
+       SERVER,
+       SettingsCategory::ReadPath);
+  init("share-read-iterators",
+       &share_read_iterators,
+       "false",
+       nullptr,
+       "Let the read streams that read the same log from the same shard on a "
+       "worker share a pool of local log store iterators, instead of each "
+       "caching its own. A stream only holds an iterator while reading a "
+       "batch, and reuses the most recently returned one. This reduces the "
+       "number of iterators, and of memtables and files they pin, for logs "
+       "with many readers. Applies to read streams created after the change.",
+       SERVER,
+       SettingsCategory::ReadPath);
+  init("prefetch-backlog-reads",
+       &prefetch_backlog_reads,
+       "false",
+       nullptr,
+       "While a batch of records of a backlog (READ_BACKLOG traffic class) "
+       "read stream is being sent to the client, read the next batch on a "
+       "storage thread, instead of waiting for the batch to be sent before "
+       "reading more. At most one batch per stream is read ahead. Its memory "
+       "is taken from the budget of read storage tasks "
+       "(read-storage-tasks-max-mem-bytes), and no batch is read ahead if "
+       "that budget is exhausted.",
+       SERVER,
+       SettingsCategory::ReadPath);
+  init("adaptive-read-batch-size",
+       &adaptive_read_batch_size,
+       "false",
+       nullptr,
+       "Adapt the amount of record bytes a read stream reads per batch, "
+       "which is otherwise always output-max-records-kb (or the TCP send "
+       "buffer size). The batch is halved while the client's socket already "
+       "buffers that much data, i.e. while the client doesn't keep up, and "
+       "doubled otherwise. It is never made smaller than what the client "
+       "consumes, at its observed rate, during the round trip of a read "
+       "storage task, so that deep storage task queues don't starve fast "
+       "readers.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
+  init("adaptive-read-batch-min-kb",
+       &adaptive_read_batch_min_kb,
+       "16",
+       parse_positive<ssize_t>(),
+       "smallest read batch, in KB, chosen by adaptive-read-batch-size",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
+  init("accept-compressed-records",
+       &accept_compressed_records,
+       "false",
+       nullptr,
+       "Tell storage nodes, when connecting to them, that they may send "
+       "record payloads compressed (see record-compression). Trades CPU time "
+       "of readers and storage nodes for read bandwidth. Only affects "
+       "connections opened after the change.",
+       CLIENT | SERVER | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
+  init("record-compression",
+       &record_compression,
+       "none",
+       parse_compression,
+       "Compression of record payloads sent to readers that accept it "
+       "(accept-compressed-records): 'none', 'zstd', 'lz4' or 'lz4_hc'. "
+       "Each payload is compressed separately, and sent uncompressed if that "
+       "doesn't make it smaller. Payloads written by BufferedWriter are "
+       "never compressed again.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
+  init("record-compression-min-bytes",
+       &record_compression_min_bytes,
+       "512",
+       parse_nonnegative<ssize_t>(),
+       "record-compression only compresses payloads of at least this many "
+       "bytes",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
+  init("record-batch-max-records",
+       &record_batch_max_records,
+       "1",
+       parse_positive<ssize_t>(),
+       "Maximum number of consecutive records of a read stream that storage "
+       "nodes put in one RECORDS message, along with the gap that follows "
+       "them, if any. Readers that don't support RECORDS messages always get "
+       "one RECORD message per record. 1 disables batching.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
+  init("record-batch-max-bytes",
+       &record_batch_max_bytes,
+       "65536",
+       parse_positive<ssize_t>(),
+       "Maximum total size of the records in one RECORDS message (see "
+       "record-batch-max-records). Larger records are sent in their own "
+       "RECORD message.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
   init("max-record-read-execution-time",
        &max_record_read_execution_time,
        "max", // likely fixed by D6679900, need to be tested more (t24433367).
@@ -511,6 +767,28 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "and 'worker_slow_requests' stat is bumped",
        SERVER | CLIENT,
        SettingsCategory::Monitoring);
+  init("worker-cpu-time-sample-rate",
+       &worker_cpu_time_sample_rate,
+       "64",
+       parse_nonnegative<ssize_t>(),
+       "Workers measure the thread CPU time of one in this many requests and "
+       "message callbacks, and add it, multiplied by this number, to the "
+       "'request_worker_cpu_usec' and 'message_worker_cpu_usec' stats of its "
+       "type. 0 disables the sampling.",
+       SERVER | CLIENT,
+       SettingsCategory::Monitoring);
+  init("append-timings-sample-rate",
+       &append_timings_sample_rate,
+       "1000",
+       parse_nonnegative<ssize_t>(),
+       "Sequencers collect a breakdown of the latency of one in this many "
+       "appends: waiting for admission, earlier waves, the network, and the "
+       "storage node's worker, storage thread queue, write, sync and reply. "
+       "Storage nodes report their part in the STORED reply. The breakdown "
+       "goes to the 'append_timings_*' histograms and to the append_timings "
+       "tracer. 0 disables the sampling.",
+       SERVER,
+       SettingsCategory::Monitoring);
   init("slow-background-task-threshold",
        &slow_background_task_threshold,
        "100ms",
@@ -527,6 +805,16 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "event loop.",
        SERVER | CLIENT,
        SettingsCategory::ResourceManagement);
+  init("flow-groups-fair-queuing",
+       &flow_groups_fair_queuing,
+       "false",
+       nullptr, // no validation
+       "Within each priority level of a traffic shaping FlowGroup, release "
+       "messages waiting for bandwidth by deficit round robin across "
+       "connections instead of in FIFO order, so that a peer with a large "
+       "backlog cannot delay the messages of other peers.",
+       SERVER | CLIENT,
+       SettingsCategory::ResourceManagement);
   init("flow-groups-run-deadline",
        &flow_groups_run_deadline,
        "5ms",
@@ -565,6 +853,18 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "messages per each storage shard for each worker",
        SERVER | REQUIRES_RESTART /* used in PurgeScheduler ctor */,
        SettingsCategory::Recovery);
+  init("purging-batch-deletes",
+       &purging_batch_deletes,
+       "true",
+       nullptr, // no validation
+       "When purging deletes the records of an unclean epoch key by key, "
+       "which it does if the range to delete has at most 4096 ESNs, send the "
+       "deletes to the write queue of the shard. There, the deletes of all "
+       "logs being purged at the same time are written in a single batch, "
+       "instead of a separate storage task and write batch per epoch of each "
+       "log.",
+       SERVER,
+       SettingsCategory::Recovery);
   init("enable-record-cache",
        &enable_record_cache,
        "true",
@@ -597,6 +897,27 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "size of the record cache.",
        SERVER,
        SettingsCategory::Recovery);
+  init("record-cache-budget-hit-weight",
+       &record_cache_budget_hit_weight,
+       "0.5",
+       validate_range<double>(0, 1),
+       "When the record cache exceeds --record-cache-max-size, only shards "
+       "whose caches exceed their budget are evicted from. This is the "
+       "fraction of --record-cache-max-size given out to shards in proportion "
+       "to how many epoch recovery digests and seals were recently served "
+       "from their record caches; the rest is shared equally between shards.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::Recovery);
+  init("zero-copied-record-slab-arenas",
+       &zero_copied_record_slab_arenas,
+       "false",
+       nullptr, // no validation
+       "Place record cache entries and the records of tail optimized logs in "
+       "slab arenas owned by the worker that frees their payload, instead of "
+       "allocating each of them on the heap. Freed entries are given back to "
+       "the arena in batches when the worker drains its disposal list.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::Recovery);
 
   init("abort-on-failed-check",
        &abort_on_failed_check,
@@ -635,6 +956,16 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "Should we print backtrace of stalled workers.",
        SERVER | CLIENT,
        SettingsCategory::Monitoring);
+  init("watchdog-stall-profiler-threshold",
+       &watchdog_stall_profiler_threshold,
+       "0ms",
+       validate_nonnegative<ssize_t>(),
+       "If positive, the watchdog checks on workers every half this time, "
+       "and samples the stack of those whose current request or message "
+       "callback has been running for longer than this. Samples are kept in "
+       "a ring buffer that 'info stalls' dumps. 0 disables the profiler.",
+       SERVER,
+       SettingsCategory::Monitoring);
   init("watchdog-bt-ratelimit",
        &watchdog_bt_ratelimit,
        "10/120s",
@@ -706,6 +1037,26 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "client request timeout.",
        SERVER,
        SettingsCategory::WritePath);
+  init("store-batch-max-records",
+       &store_batch_max_records,
+       "1",
+       parse_positive<ssize_t>(),
+       "Maximum number of STOREs that a sequencer puts in one STORES message "
+       "to a storage node. STOREs that Appenders of a worker send to the same "
+       "node within one event loop iteration are batched. Storage nodes that "
+       "don't support STORES messages always get one STORE message per record. "
+       "1 disables batching.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::WritePath);
+  init("store-batch-max-bytes",
+       &store_batch_max_bytes,
+       "262144",
+       parse_positive<ssize_t>(),
+       "Maximum total size of the payloads in one STORES message (see "
+       "store-batch-max-records). Larger payloads are sent in their own STORE "
+       "message.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::WritePath);
   init("connect-throttle",
        &connect_throttle,
        "1ms..10s",
@@ -800,6 +1151,27 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "the states of nodes in the nodeset in use",
        SERVER,
        SettingsCategory::WritePath);
+  init("load-aware-nodeset-selection",
+       &load_aware_nodeset_selection,
+       "false",
+       nullptr,
+       "If true, when a sequencer provisions or updates the nodeset of a log, "
+       "it prefers storage shards that didn't recently report being low on "
+       "space, out of space, overloaded or slow to its appenders. Only the "
+       "choice of shards within each failure domain changes, the number of "
+       "shards picked from each domain stays the same. Only used by the "
+       "weight-aware nodeset selectors, and only if sequencers are allowed "
+       "to provision epoch metadata.",
+       SERVER,
+       SettingsCategory::WritePath);
+  init("nodeset-load-report-ttl",
+       &nodeset_load_report_ttl,
+       "5min",
+       validate_positive<ssize_t>(),
+       "Load-aware nodeset selection (see --load-aware-nodeset-selection) "
+       "ignores reports of storage shard load older than this",
+       SERVER,
+       SettingsCategory::WritePath);
   init("connect-timeout",
        &connect_timeout,
        "100ms",
@@ -866,6 +1238,27 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "unless write-batch-size is reached first",
        SERVER,
        SettingsCategory::Storage);
+  init("sync-group-commit-target-latency",
+       &sync_group_commit_target_latency,
+       "0ms",
+       validate_nonnegative<ssize_t>(),
+       "If nonzero, the syncing storage thread of a shard may wait for more "
+       "writes that need a WAL sync before issuing the sync, as long as the "
+       "oldest write is expected to be synced within this time. The expected "
+       "sync time is estimated from recent sync durations, and the thread "
+       "only waits if more writes are likely to arrive in time, so quiet "
+       "shards still sync immediately. 0 syncs as soon as possible.",
+       SERVER,
+       SettingsCategory::Storage);
+  init("sync-group-commit-max-batch",
+       &sync_group_commit_max_batch,
+       "1024",
+       parse_nonnegative<ssize_t>(),
+       "Stop waiting for more writes to sync together (see "
+       "--sync-group-commit-target-latency) once this many are waiting. "
+       "0 means no limit.",
+       SERVER,
+       SettingsCategory::Storage);
   init("max-server-read-streams",
        &max_server_read_streams,
        "150000",
@@ -914,6 +1307,18 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "batch size for processing per-log queue of pending writes",
        SERVER,
        SettingsCategory::WritePath);
+  init("sequencer-adaptive-window-min",
+       &sequencer_adaptive_window_min,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "If non-zero, the sequencer of every log limits the number of appends "
+       "in flight to an estimate of what the log needs given its append "
+       "throughput and latency, between this value and the log's "
+       "max-writes-in-flight, instead of always allowing "
+       "max-writes-in-flight. Saves memory on logs with little traffic. "
+       "Applies to epochs started after the change.",
+       SERVER,
+       SettingsCategory::WritePath);
 
   init("test-appender-skip-stores",
        &test_appender_skip_stores,
@@ -946,6 +1351,17 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "apply to new reader instances",
        SERVER | CLIENT,
        SettingsCategory::ReadPath);
+  init("client-read-buffer-memory-budget",
+       &client_read_buffer_memory_budget,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "approximate limit on the total payload size of the records buffered "
+       "by all the read streams of the client, split evenly across workers. "
+       "When the read streams of a worker buffer more than its share, they "
+       "halve their windows each time they slide them instead of growing "
+       "them. 0 means no limit.",
+       CLIENT,
+       SettingsCategory::ReadPath);
   init("client-read-flow-control-threshold",
        &client_read_flow_control_threshold,
        "0.7",
@@ -954,6 +1370,43 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "window update messages (less means more often)",
        CLIENT | SERVER /* for event log reads */,
        SettingsCategory::ReadPath);
+  init("client-window-update-max-delay",
+       &client_window_update_max_delay,
+       "10ms",
+       validate_nonnegative<ssize_t>(),
+       "Maximum time a read stream delays a WINDOW update to a storage node "
+       "so that it can be sent in one WINDOWS message along with the updates "
+       "of other read streams reading from that node. The delay is shorter "
+       "the closer the stream is to exhausting its window, so that it never "
+       "waits for the update. Only used with storage nodes that support "
+       "WINDOWS messages. 0 disables coalescing.",
+       CLIENT,
+       SettingsCategory::ReadPath);
+  init("client-record-payload-zero-copy-min-size",
+       &client_record_payload_zero_copy_min_size,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "Payloads of records received from storage nodes that are at least "
+       "this big are handed to the application in the buffers they were "
+       "read from the socket into, instead of being copied. Only payloads "
+       "that arrived in a single read are fully zero-copy; others are made "
+       "contiguous, which is one copy as before. The record then keeps the "
+       "socket buffers it was read into in memory, which may be somewhat "
+       "larger than the payload. 0 disables zero-copy.",
+       CLIENT,
+       SettingsCategory::ReadPath);
+  init("start-batch-size",
+       &start_batch_size,
+       "64",
+       parse_positive<ssize_t>(),
+       "Maximum number of STARTs for the same storage node that the read "
+       "streams of a worker coalesce into a single STARTS message. STARTs sent "
+       "during the same event loop iteration of a worker are batched, which "
+       "cuts the number of messages when a reader starts reading many logs at "
+       "once. Only used with storage nodes that support STARTS messages. 1 "
+       "disables batching.",
+       CLIENT,
+       SettingsCategory::ReadPath);
   init("client-epoch-metadata-cache-size",
        &client_epoch_metadata_cache_size,
        "50000",
@@ -1022,6 +1475,28 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "RELEASE message retry period",
        SERVER,
        SettingsCategory::WritePath);
+  init("streaming-ingest-release-interval",
+       &streaming_ingest_release_interval,
+       "100ms",
+       validate_positive<ssize_t>(),
+       "How often the sequencer of a log with the streaming_ingest attribute "
+       "sends RELEASE messages to storage nodes. Records of such logs are not "
+       "released to the storage nodes of their copysets as they are appended, "
+       "but in batches, at most this long after they are fully replicated.",
+       SERVER,
+       SettingsCategory::WritePath);
+  init("release-batch-interval",
+       &release_batch_interval,
+       "0ms",
+       validate_nonnegative<ssize_t>(),
+       "If positive, RELEASE messages that the sequencers of a worker send to "
+       "the same storage node within this interval are sent together in one "
+       "RELEASES message, with only the highest LSN released for each log. "
+       "Delays the delivery of records to tailing readers by up to this long. "
+       "Storage nodes that don't support RELEASES messages always get one "
+       "RELEASE message per log. 0 disables batching.",
+       SERVER,
+       SettingsCategory::WritePath);
   init("release-broadcast-interval",
        &release_broadcast_interval,
        "300s",
@@ -1052,6 +1527,17 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "an authoritative complete digest. Millisecond granularity. Can be 0. ",
        SERVER,
        SettingsCategory::Recovery);
+  init("recovery-max-concurrent-epochs",
+       &recovery_max_concurrent_epochs,
+       "1",
+       validate_positive<ssize_t>(),
+       "Maximum number of epochs of a log for which log recovery builds "
+       "digests at the same time. Digests of later epochs are built while "
+       "earlier epochs are mutated and cleaned, which speeds up recovery of "
+       "logs with several unclean epochs. Mutations, cleaning and last clean "
+       "epoch updates still happen one epoch at a time, in epoch order.",
+       SERVER,
+       SettingsCategory::Recovery);
   init("event-log-grace-period",
        &event_log_grace_period,
        "10s",
@@ -1130,6 +1616,17 @@ void Settings::defineSettings(SettingEasyInit& init) {
       "log's sequencer over the network.",
       SERVER | REQUIRES_RESTART /* init'ed with this in Procesor's ctor */,
       SettingsCategory::ReadPath);
+  init("warm-up-log-storage-state",
+       &warm_up_log_storage_state,
+       "false",
+       nullptr, // no validation
+       "On startup, populate the in-memory state of all logs (trim point, "
+       "last released LSN, last clean epoch and seals) with one sequential "
+       "scan of the log metadata per shard, instead of reading it log by log "
+       "when each log is first accessed. Shortens the time it takes a storage "
+       "node with many logs to serve reads after a restart.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::ReadPath);
   init("seq-state-reply-timeout",
        &get_seq_state_reply_timeout,
        "2s",
@@ -1147,6 +1644,16 @@ void Settings::defineSettings(SettingEasyInit& init) {
       "a timeout.",
       SERVER | CLIENT,
       SettingsCategory::Sequencer);
+  init("use-sequencer-location-cache",
+       &use_sequencer_location_cache,
+       "true",
+       nullptr, // no validation
+       "Send appends straight to the node that most recently ran the "
+       "sequencer for the log, as learned from successful appends and "
+       "redirects, instead of picking a node with the sequencer locator. "
+       "Saves a redirect hop after sequencers move.",
+       CLIENT,
+       SettingsCategory::Sequencer);
   init("check-seal-req-min-timeout",
        &check_seal_req_min_timeout,
        "500ms",
@@ -1245,6 +1752,19 @@ void Settings::defineSettings(SettingEasyInit& init) {
       "will consider it expired and start a new one.",
       SERVER | REQUIRES_RESTART /* Used in CopySetManager ctor */,
       SettingsCategory::WritePath);
+  init("sticky-copysets-block-time-alignment",
+       &sticky_copysets_block_time_alignment,
+       "0ms",
+       validate_nonnegative<ssize_t>(),
+       "If positive, sticky copyset blocks end at wall clock times that are "
+       "multiples of this duration, instead of after "
+       "--sticky-copysets-block-max-time. Blocks of all logs then switch "
+       "copysets at the same times. Setting it to --rocksdb-partition-duration "
+       "makes each block of a log span at most two partitions on a storage "
+       "node, giving longer contiguous runs per copyset for reading and "
+       "rebuilding. --sticky-copysets-block-size still applies.",
+       SERVER | REQUIRES_RESTART /* Used in CopySetManager ctor */,
+       SettingsCategory::WritePath);
   init("iterator-cache-ttl",
        &iterator_cache_ttl,
        "20s",
@@ -1326,6 +1846,16 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "while reactivating to serve a higher epoch.",
        SERVER,
        SettingsCategory::Sequencer);
+  init("epoch-pipelining-esns",
+       &epoch_pipelining_esns,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "When fewer than this many ESNs are left in the current epoch of a "
+       "sequencer, start reactivating it into the next epoch while appends "
+       "keep being admitted into the current one, instead of waiting for "
+       "the ESN space to run out. Releases stay gated per epoch. 0 disables.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::Sequencer);
   init("read-historical-metadata-timeout",
        &read_historical_metadata_timeout,
        "10s",
@@ -1390,6 +1920,35 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "be.",
        CLIENT | REQUIRES_RESTART /* used in ClientImpl::create() */,
        SettingsCategory::Configuration);
+  init("remote-logs-config-negative-cache-ttl",
+       &remote_logs_config_negative_cache_ttl,
+       "5s",
+       validate_nonnegative<ssize_t>(),
+       "How long the remote logs config remembers that a log ID doesn't exist "
+       "on the server, answering lookups of it with NOTFOUND without asking "
+       "again. Logs created in the meantime aren't seen until it expires. 0 "
+       "disables the negative cache.",
+       CLIENT | REQUIRES_RESTART /* used in ClientImpl::create() */,
+       SettingsCategory::Configuration);
+  init("server-config-cache-path",
+       &server_config_cache_path,
+       "",
+       nullptr, // no validation
+       "If not empty and the config is fetched from the servers (a \"server:\" "
+       "config path), the client saves every config it fetches to this file. "
+       "A client created later with the same config path starts from the "
+       "saved config instead of waiting for a server, and replaces it with the "
+       "fetched one when it arrives.",
+       CLIENT | REQUIRES_RESTART /* used in ClientImpl::create() */,
+       SettingsCategory::Configuration);
+  init("server-config-cache-max-age",
+       &server_config_cache_max_age,
+       "1h",
+       validate_nonnegative<ssize_t>(),
+       "Configs saved to --server-config-cache-path longer ago than this are "
+       "not used.",
+       CLIENT | REQUIRES_RESTART /* used in ClientImpl::create() */,
+       SettingsCategory::Configuration);
   init("alternative-layout-property",
        &alternative_layout_property,
        "",
@@ -1410,6 +1969,98 @@ void Settings::defineSettings(SettingEasyInit& init) {
       "FindKey requests small and predictable, at the expense of accuracy",
       SERVER,
       SettingsCategory::Performance);
+  init("findtime-batch-size",
+       &findtime_batch_size,
+       "64",
+       parse_positive<ssize_t>(),
+       "Maximum number of concurrent findTime() requests for the same storage "
+       "shard that the client coalesces into a single FINDKEY_BATCH message. "
+       "Requests issued during the same event loop iteration of a worker are "
+       "batched. Storage nodes process each batch in a single storage task. "
+       "1 disables batching.",
+       CLIENT,
+       SettingsCategory::Performance);
+  init("log-query-batch-size",
+       &log_query_batch_size,
+       "256",
+       parse_positive<ssize_t>(),
+       "Maximum number of concurrent isLogEmpty() or dataSize() requests for "
+       "the same storage shard that the client coalesces into a single "
+       "IS_LOG_EMPTY_BATCH or DATA_SIZE_BATCH message. Requests issued during "
+       "the same event loop iteration of a worker are batched. 1 disables "
+       "batching.",
+       CLIENT,
+       SettingsCategory::Performance);
+  init("message-arena-kb",
+       &message_arena_kb,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "Size in KB of a per-worker arena that short-lived received messages "
+       "(STORED, WINDOW, RELEASE, GAP) are deserialized into instead of the "
+       "heap. The arena is reused once the messages in it are processed. "
+       "0 disables the arenas.",
+       SERVER | CLIENT | REQUIRES_RESTART /* used in Worker ctor */,
+       SettingsCategory::Performance);
+  init("worker-timer-wheel",
+       &worker_timer_wheel,
+       "false",
+       nullptr, // no validation
+       "If true, timers of workers with delays of 1ms or more (store "
+       "timeouts, retry backoffs, read stream timers, etc.) are kept in a "
+       "per-worker hierarchical timing wheel driven by a single libevent "
+       "timer, instead of libevent's heap. Activating and cancelling them "
+       "becomes O(1), which matters with hundreds of thousands of active "
+       "appenders per worker, but they may fire up to 1ms late.",
+       SERVER | CLIENT,
+       SettingsCategory::Performance);
+  init("busy-poll-workers",
+       &busy_poll_workers,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "Number of general workers, starting from worker 0, whose event loops "
+       "busy-poll: after handling events they keep polling for requests and "
+       "socket events without blocking for busy-poll-spin before blocking in "
+       "epoll_wait() again. Saves the latency of waking up a blocked thread "
+       "on each request hop at the cost of spinning CPUs. Meant for workers "
+       "of latency-critical tiers pinned to dedicated cores (see "
+       "worker-cpus).",
+       SERVER | CLIENT | REQUIRES_RESTART /* used when workers start */,
+       SettingsCategory::Performance);
+  init("busy-poll-spin",
+       &busy_poll_spin,
+       "50us",
+       validate_positive<ssize_t>(),
+       "How long the event loops of busy-polling workers (see "
+       "busy-poll-workers) keep polling without blocking after the last "
+       "event they handled.",
+       SERVER | CLIENT | REQUIRES_RESTART /* used when workers start */,
+       SettingsCategory::Performance);
+  init("event-loop-epoll-changelist",
+       &event_loop_epoll_changelist,
+       "false",
+       nullptr, // no validation
+       "If true, the event loops of workers batch the changes to the socket "
+       "events they wait for and apply them all with the next epoll_wait(), "
+       "instead of making an epoll_ctl() syscall for each change as it "
+       "happens. Changes that cancel out, e.g. a socket that stops and "
+       "resumes waiting for writability within one loop iteration, cost no "
+       "syscall at all. This saves syscalls on workers with many busy "
+       "connections.",
+       SERVER | CLIENT | REQUIRES_RESTART /* used in Worker ctor */,
+       SettingsCategory::Performance);
+  init("log-worker-migration-load-skew",
+       &log_worker_migration_load_skew,
+       "0",
+       validate_nonnegative<double>(),
+       "If positive, every time workers report their load (every 10s), a "
+       "worker whose load is more than this many times the mean load of all "
+       "workers migrates the log it executed the most appends for to the least "
+       "loaded worker. Appends are otherwise pinned to a worker by hashing "
+       "their log id and thread, so a few hot logs can saturate a worker while "
+       "the others idle. Migrated logs stay on their new worker. 0 disables "
+       "migrations.",
+       CLIENT,
+       SettingsCategory::Performance);
   init("read-storage-tasks-max-mem-bytes",
        &read_storage_tasks_max_mem_bytes,
        "16106127360", // 15GB
@@ -1417,6 +2068,27 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "Maximum amount of memory that can be allocated by read storage tasks.",
        SERVER,
        SettingsCategory::ResourceManagement);
+  init("read-storage-tasks-mem-rebalance-interval",
+       &read_storage_tasks_mem_rebalance_interval,
+       "0s",
+       validate_nonnegative<ssize_t>(),
+       "If nonzero, --read-storage-tasks-max-mem-bytes is redivided between "
+       "workers this often: every worker keeps "
+       "--read-storage-tasks-mem-min-share of its even share, and the rest "
+       "goes to workers in proportion to how many read storage tasks they had "
+       "to delay for lack of memory since the last time. If zero, the memory "
+       "is divided evenly between workers.",
+       SERVER | REQUIRES_RESTART /* used in ServerWorker::onThreadStarted() */,
+       SettingsCategory::ResourceManagement);
+  init("read-storage-tasks-mem-min-share",
+       &read_storage_tasks_mem_min_share,
+       "0.5",
+       validate_range<double>(0, 1),
+       "Fraction of its even share of --read-storage-tasks-max-mem-bytes that "
+       "a worker is guaranteed when the memory is redivided according to "
+       "--read-storage-tasks-mem-rebalance-interval.",
+       SERVER,
+       SettingsCategory::ResourceManagement);
   init("initial-config-load-timeout",
        &initial_config_load_timeout,
        "15s",
@@ -1454,6 +2126,26 @@ void Settings::defineSettings(SettingEasyInit& init) {
       "externally before logdevice can do any ZooKeeper epoch store operations",
       SERVER | EXPERIMENTAL,
       SettingsCategory::Core);
+  init("zk-max-batched-writes",
+       &zk_max_batched_writes,
+       "64",
+       parse_positive<ssize_t>(),
+       "Maximum number of writes to the epoch store znodes of different logs, "
+       "e.g. by sequencer activations after a node failure, that are sent to "
+       "Zookeeper together in a single multi-op. 1 disables batching.",
+       SERVER,
+       SettingsCategory::Core);
+  init("zk-coalesce-reads",
+       &zk_coalesce_reads,
+       "true",
+       nullptr, // no validation
+       "If true, a read of the epoch store znode of a log, e.g. to activate a "
+       "sequencer or start recovery, that is requested while a read of the "
+       "same znode is already in flight waits for the result of that read "
+       "instead of sending its own. Read-modify-writes remain conditional on "
+       "the version that was read.",
+       SERVER,
+       SettingsCategory::Core);
   init("ssl-load-client-cert",
        &ssl_load_client_cert,
        "false",
@@ -1461,6 +2153,17 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "Set to include client certificate for mutual ssl authenticaiton",
        CLIENT | SERVER,
        SettingsCategory::Security);
+  init("ssl-enable-ktls",
+       &ssl_enable_ktls,
+       "false",
+       nullptr, // no validation
+       "Once the handshake of an SSL connection completes, install its keys "
+       "into the kernel (kTLS), so that records are encrypted and decrypted "
+       "by the kernel instead of by the worker thread. Connections for which "
+       "the kernel or OpenSSL don't support kTLS, or the negotiated cipher, "
+       "keep encrypting in userspace. Only affects new connections.",
+       CLIENT | SERVER,
+       SettingsCategory::Security);
   init("ssl-cert-path",
        &ssl_cert_path,
        "",
@@ -1489,6 +2192,40 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "TTL for an SSL certificate that we have loaded from disk.",
        SERVER | CLIENT | REQUIRES_RESTART /* used in Worker ctor */,
        SettingsCategory::Security);
+  init("ssl-session-resumption",
+       &ssl_session_resumption,
+       "false",
+       nullptr, // no validation
+       "Resume the TLS sessions of SSL connections instead of doing a full "
+       "handshake every time. Servers issue session tickets encrypted with a "
+       "key shared by all their workers (see --ssl-session-ticket-key-path), "
+       "and every worker remembers its last session with each node it "
+       "connects to and offers it when reconnecting.",
+       SERVER | CLIENT | REQUIRES_RESTART /* used in Worker ctor */,
+       SettingsCategory::Security);
+  init("ssl-session-ticket-key-path",
+       &ssl_session_ticket_key_path,
+       "",
+       nullptr, // no validation
+       "With --ssl-session-resumption, path to a file whose first 48 bytes "
+       "are the key that encrypts session tickets, e.g. made with "
+       "'head -c 48 /dev/urandom'. It's reread every "
+       "--ssl-cert-refresh-interval. Share the file across restarts, and "
+       "across nodes, for tickets to stay valid after a restart. If empty, a "
+       "random key is generated on startup.",
+       SERVER | REQUIRES_RESTART /* used in Worker ctor */,
+       SettingsCategory::Security);
+  init("ssl-handshake-threads",
+       &ssl_handshake_threads,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "If positive, the SSL port is served by this many listener threads, "
+       "bound with SO_REUSEPORT, which complete the TLS handshake of the "
+       "connections they accept before handing them to workers, so that "
+       "handshakes don't take CPU time from the workers' traffic. If 0, one "
+       "listener accepts SSL connections and the workers do the handshakes.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::Security);
   init("ssl-boundary",
        &ssl_boundary,
        "none",
@@ -1546,6 +2283,58 @@ void Settings::defineSettings(SettingEasyInit& init) {
        SERVER | REQUIRES_RESTART /* used once when ExecStorageThread starts */,
        SettingsCategory::ResourceManagement);
 
+  init("storage-thread-numa-nodes",
+       &storage_thread_numa_nodes,
+       "",
+       parse_numa_nodes,
+       "Comma-separated list of NUMA nodes; storage threads of shard i run on "
+       "the CPUs of node number i modulo the length of the list and prefer "
+       "allocating memory from it. Since memtable memory is allocated by the "
+       "threads writing to the shard, this keeps each shard's memtables local "
+       "to its storage threads. Empty to not bind storage threads.",
+       SERVER | REQUIRES_RESTART /* used once when ExecStorageThread starts */,
+       SettingsCategory::ResourceManagement);
+  init("storage-task-stealing-interval",
+       &storage_task_stealing_interval,
+       "0ms",
+       validate_nonnegative<ssize_t>(),
+       "If nonzero, storage threads that have nothing to do take CPU-bound "
+       "tasks, such as tailing reads, from the queues of other shards' "
+       "storage threads, so that one busy shard can use the threads of idle "
+       "ones. Idle threads look for such tasks with this period. I/O-bound "
+       "tasks always run on the threads of their own shard. 0 disables work "
+       "stealing.",
+       SERVER | REQUIRES_RESTART /* queues are sized on startup */,
+       SettingsCategory::ResourceManagement);
+
+  init("storage-thread-read-batch-size",
+       &storage_thread_read_batch_size,
+       "1",
+       parse_positive<ssize_t>(),
+       "When a storage thread picks up a read task, it also takes up to this "
+       "many minus one other read tasks of the same priority waiting in the "
+       "queue and executes them all sorted by log ID and LSN, so that "
+       "consecutive reads touch adjacent keys and share cached blocks. "
+       "1 disables read batching.",
+       SERVER | REQUIRES_RESTART /* queues are sized on startup */,
+       SettingsCategory::ResourceManagement);
+  init("storage-thread-read-scheduler-window",
+       &storage_thread_read_scheduler_window,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "If nonzero, read tasks that storage threads take from the queue of "
+       "a shard, which gathers the reads of all workers, aren't executed in "
+       "the order they were posted. Up to this many are held back, and "
+       "threads execute them giving each client a turn in round-robin "
+       "order; along with each task they execute the other held tasks "
+       "reading the same log, sorted by LSN, which count as turns of their "
+       "clients. Works best with storage-thread-read-batch-size greater "
+       "than 1, so that threads take several queued reads at a time. "
+       "0 disables the read scheduler.",
+       SERVER | REQUIRES_RESTART /* queues are created on startup */ |
+           EXPERIMENTAL,
+       SettingsCategory::ResourceManagement);
+
   init("checksumming-enabled",
        &checksumming_enabled,
        "false",
@@ -1848,6 +2637,18 @@ void Settings::defineSettings(SettingEasyInit& init) {
       "use in production emergencies only.",
       SERVER,
       SettingsCategory::Performance);
+  init("tail-query-seal-check-interval",
+       &tail_query_seal_check_interval,
+       "10s",
+       validate_nonnegative<ssize_t>(),
+       "'get sequencer state' requests that only ask for the tail of a log "
+       "(getTailAttributes(), getTailRecord()) are answered from the tail "
+       "record the sequencer keeps in memory, without sending 'check seal' "
+       "requests to storage nodes, if the sequencer passed a seal check within "
+       "this interval. The tail may then be this stale if the sequencer was "
+       "preempted in the meantime. 0 checks seals for every request.",
+       SERVER,
+       SettingsCategory::Performance);
   init("recovery-seq-metadata-timeout",
        &recovery_seq_metadata_timeout,
        "2s..60s",
@@ -2255,6 +3056,18 @@ void Settings::defineSettings(SettingEasyInit& init) {
        CLIENT,
        SettingsCategory::Monitoring);
 
+  init("shadow-max-bytes-in-flight",
+       &shadow_max_bytes_in_flight,
+       "67108864", // 64MB
+       parse_positive<ssize_t>(),
+       "Maximum total size of payloads of shadow appends to one shadow "
+       "cluster that may be in flight at a time. Appends that would exceed it "
+       "are not shadowed, so that a slow shadow cluster doesn't make the "
+       "client buffer an unbounded amount of copied payloads. See "
+       "traffic-shadow-enabled.",
+       CLIENT,
+       SettingsCategory::Monitoring);
+
   init("shadow-client",
        &shadow_client,
        "false",
@@ -2305,6 +3118,17 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "and will be removed at some point.",
        CLIENT | SERVER | DEPRECATED);
 
+  init("read-streams-coalesce-metadata-reads",
+       &read_streams_coalesce_metadata_reads,
+       "true",
+       nullptr, // no validation
+       "If true, read streams on the same worker that need the historical "
+       "metadata of the same log at the same time share the reads of the "
+       "metadata log (or the request to the sequencer) instead of each "
+       "making its own.",
+       CLIENT | SERVER,
+       SettingsCategory::ReadPath);
+
   init("max-sequencer-background-activations-in-flight",
        &max_sequencer_background_activations_in_flight,
        "20",
@@ -2350,6 +3174,17 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "When the real time buffer reaches this size, we evict entries.",
        SERVER | REQUIRES_RESTART | EXPERIMENTAL,
        SettingsCategory::ReadPath);
+  init("real-time-eviction-candidate-logs",
+       &real_time_eviction_candidate_logs,
+       "64",
+       nullptr, // no validation
+       "When evicting from the real time buffer, first look at this many of "
+       "the least recently used logs and evict the records that none of their "
+       "read streams is positioned to read, before evicting whole logs in LRU "
+       "order.  This keeps the records of logs with tailing readers in memory. "
+       "0 means plain LRU eviction.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
 
   init("test-timestamp-linear-transform",
        &test_timestamp_linear_transform,
@@ -2371,6 +3206,36 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "which it tries reconnecting.",
        CLIENT,
        SettingsCategory::ReadPath);
+  init("reader-reconnect-jitter",
+       &reader_reconnect_jitter,
+       "20ms",
+       validate_nonnegative<ssize_t>(),
+       "Maximum random delay added to --reader-reconnect-delay before a reader "
+       "sends a START to reconnect to a storage node. Spreads the STARTs of "
+       "readers that lost their connections at the same time, e.g. because "
+       "the storage node restarted.",
+       CLIENT,
+       SettingsCategory::ReadPath);
+  init("reader-reconnect-rate-limit",
+       &reader_reconnect_rate_limit,
+       "1000/1s",
+       [](const std::string& val) -> rate_limit_t {
+         rate_limit_t res;
+         if (parse_rate_limit(val.c_str(), &res) != 0 ||
+             (res != RATE_UNLIMITED && res.first == 0)) {
+           throw boost::program_options::error(
+               "Invalid value for --reader-reconnect-rate-limit. Expected "
+               "format is <count>/<duration><unit> with a positive count, "
+               "e.g. 1000/1s, or 'unlimited'");
+         }
+         return res;
+       },
+       "Maximum rate at which the readers of a client process send STARTs to "
+       "reconnect to the same storage node. Readers over the budget wait for "
+       "their turn, so that a storage node that restarts doesn't get a START "
+       "from all of them at once.",
+       CLIENT,
+       SettingsCategory::ReadPath);
   init("reader-started-timeout",
        &reader_started_timeout,
        "30s..5min",
@@ -2419,6 +3284,18 @@ void Settings::defineSettings(SettingEasyInit& init) {
        SERVER | EXPERIMENTAL,
        SettingsCategory::WritePath);
 
+  init("write-compact-record-header",
+       &write_compact_record_header,
+       "false",
+       nullptr,
+       "Allow writing records of logs with the compact_record_header log "
+       "attribute in the compact record header format. Storage nodes that "
+       "don't support that format can't read such records, so only enable "
+       "this once all storage nodes are upgraded. If not set, the attribute "
+       "is ignored and records are written in the regular format.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::WritePath);
+
   init("epoch-metadata-use-new-storage-set-format",
        &epoch_metadata_use_new_storage_set_format,
        "false",
@@ -2553,6 +3430,30 @@ void Settings::defineSettings(SettingEasyInit& init) {
        CLIENT,
        SettingsCategory::ReaderFailover);
 
+  init("reader-slow-shards-partial-failover",
+       &reader_slow_shards_partial_failover,
+       "false",
+       nullptr, // no validation
+       "When slow shards detection adds shards to the filtered out list of "
+       "a read stream in SCD mode, keep the records already buffered instead "
+       "of discarding them, and restart each storage shard no earlier than "
+       "the first LSN the slow shards may not have shipped yet.",
+       CLIENT,
+       SettingsCategory::ReaderFailover);
+
+  init("reader-slow-shards-max-local-outliers",
+       &reader_slow_shards_max_local_outliers,
+       "-1",
+       parse_validate_lower_bound<ssize_t>(-1),
+       "For logs with local SCD, the maximum number of shards in the client's "
+       "region that slow shards detection may filter out at a time. Records "
+       "are only sent from another region when all shards of the client's "
+       "region in their copyset are filtered out, so this bounds the "
+       "cross-region read traffic that slow shards detection causes. -1 for "
+       "no limit.",
+       CLIENT,
+       SettingsCategory::ReaderFailover);
+
   init("eventlog-snapshotting-period",
        &eventlog_snapshotting_period,
        "1h",
@@ -65,6 +65,15 @@ struct Settings : public SettingsBundle {
   // number of worker threads to run
   int num_workers;
 
+  // CPUs to pin workers to. General worker i runs on worker_cpus[i modulo the
+  // number of CPUs], other workers on all of them. Empty means no pinning.
+  std::vector<int> worker_cpus;
+
+  // (client-only setting) Share workers and connections with the other
+  // Clients of the process that are created with this setting for the same
+  // cluster and credentials.
+  bool shared_transport;
+
   // Time interval after which watchdog wakes up and detects stalls
   std::chrono::milliseconds watchdog_poll_interval_ms;
 
@@ -81,6 +90,11 @@ struct Settings : public SettingsBundle {
   // If true, turn off TraceLogger by using NoopTraceLogger implementation
   bool trace_logger_disabled;
 
+  // Samples waiting to be published by the trace logger's background thread.
+  // Samples are dropped when the queue is full. 0 to publish on the calling
+  // thread.
+  size_t trace_logger_queue_size;
+
   // If false: no checksumming is done at the Protocol Layer
   // If true: 'checksumming_blacklisted_messages' is consulted
   bool checksumming_enabled;
@@ -96,6 +110,12 @@ struct Settings : public SettingsBundle {
   // is this times the number of threads the Processor runs.
   size_t outbufs_mb_max_per_thread;
 
+  // Limit on bytes pending in output evbuffers of all workers of the
+  // Processor together, in megabytes. 0 means no limit other than
+  // outbufs_mb_max_per_thread. Workers reserve bytes from this limit in
+  // large chunks, see Sender::OUTBUF_RESERVATION_BYTES.
+  size_t outbufs_mb_max_total;
+
   // Set SO_SNDBUF of all new TCP sockets to this number of KILOBYTES.  Note
   // that this makes Linux bypass its autotuning logic for the buffer size.
   // Importantly, it will never increase the buffer size for high-throughput
@@ -104,6 +124,28 @@ struct Settings : public SettingsBundle {
   // If -1, system default will be used instead (setsockopt not called).
   int tcp_sendbuf_kb;
 
+  // Plain TCP sockets send with MSG_ZEROCOPY whenever at least this many
+  // bytes are waiting to be written. 0 disables zerocopy sends.
+  size_t zerocopy_send_threshold;
+
+  // If nonzero, small messages written to a socket are held for up to this
+  // long so that they go out together in one write. Zero writes them out at
+  // the end of the current event loop iteration, as before.
+  std::chrono::microseconds output_cork_delay;
+
+  // If nonzero, value of SO_BUSY_POLL for the sockets of workers that
+  // busy-poll (see busy_poll_workers).
+  std::chrono::microseconds socket_busy_poll;
+
+  // If true, rebuilding STOREs to other nodes go over a connection of their
+  // own, so that they don't hold up appends and control messages.
+  bool separate_rebuilding_connections;
+
+  // If true, messages of read streams (START, STOP, WINDOW) to storage nodes
+  // go over a connection of their own, which storage nodes with read workers
+  // serve on those. See WorkerType::READ.
+  bool separate_read_connections;
+
   // Set SO_RCVBUF of all new TCP sockets to this number of KILOBYTES.  Note
   // that this makes Linux bypass its autotuning logic for the buffer size.
   // Importantly, it will never increase the buffer size for high-throughput
@@ -130,6 +172,50 @@ struct Settings : public SettingsBundle {
   // Similar to output_max_records_kb but is applied *before* filtering records.
   int64_t max_record_bytes_read_at_once;
 
+  // If true, RECORD messages for records read by ReadStorageTask take
+  // ownership of the task's copy of the record instead of copying the payload.
+  bool zero_copy_record_payloads;
+
+  // If true, RECORD messages for records delivered from the real-time buffer
+  // reference the buffer's copy of the payload instead of copying it, so that
+  // all streams tailing a log share one copy.
+  bool share_real_time_record_payloads;
+
+  // If true, read streams reading the same log from the same shard on a
+  // worker share a pool of iterators instead of each caching its own.
+  bool share_read_iterators;
+
+  // If true, while a batch of a backlog read stream is being sent, a storage
+  // task already reads the next batch.
+  bool prefetch_backlog_reads;
+
+  // If true, CatchupOneStream sizes each read batch of a stream from how fast
+  // the client drains it, how long its storage tasks take and how much data
+  // is already buffered in the client's socket, within
+  // [adaptive_read_batch_min_kb, output_max_records_kb].
+  bool adaptive_read_batch_size;
+
+  // Smallest read batch adaptive_read_batch_size can choose, in KB.
+  size_t adaptive_read_batch_min_kb;
+
+  // If true, HELLO asks storage nodes to compress RECORD payloads (see
+  // record_compression).
+  bool accept_compressed_records;
+
+  // Compression of payloads of RECORD messages sent to readers that accept
+  // it, NONE to never compress.
+  Compression record_compression;
+
+  // Only payloads of at least this many bytes are compressed.
+  size_t record_compression_min_bytes;
+
+  // Maximum number of consecutive records of a read stream delivered in one
+  // RECORDS message. 1 means every record is sent in a RECORD message.
+  size_t record_batch_max_records;
+
+  // Maximum total size of the records in one RECORDS message.
+  size_t record_batch_max_bytes;
+
   // Maximum execution time for reading records
   std::chrono::milliseconds max_record_read_execution_time;
 
@@ -154,6 +240,15 @@ struct Settings : public SettingsBundle {
   // and Worker stats 'worker_slow_requests' is bumped
   std::chrono::milliseconds request_execution_delay_threshold;
 
+  // Workers measure the thread CPU time of one in this many requests and
+  // message callbacks, and attribute it, scaled up, to the request or message
+  // type. 0 disables the sampling.
+  size_t worker_cpu_time_sample_rate;
+
+  // Sequencers collect a latency breakdown, with the help of storage nodes,
+  // for one in this many appends. 0 disables the sampling.
+  size_t append_timings_sample_rate;
+
   // Background task execution time (in milli-seconds) after which it is
   // considered slow and we log it
   std::chrono::milliseconds slow_background_task_threshold;
@@ -208,6 +303,14 @@ struct Settings : public SettingsBundle {
   // size of the record cache
   std::chrono::seconds record_cache_monitor_interval;
 
+  // fraction of the record cache budget that is given to shards in proportion
+  // to their recent record cache hits, the rest is shared equally
+  double record_cache_budget_hit_weight;
+
+  // place record cache entries and other ZeroCopiedRecords in per-worker slab
+  // arenas rather than allocating each of them on the heap
+  bool zero_copied_record_slab_arenas;
+
   // When an ld_check() fails, call abort().  If not, just continue
   // executing.  We'll log either way.
   bool abort_on_failed_check;
@@ -224,6 +327,11 @@ struct Settings : public SettingsBundle {
   // stalled thread(s) will be logged into the log file.
   bool watchdog_print_bt_on_stall;
 
+  // If positive, the watchdog samples the stack of workers whose request or
+  // message callback has been running for longer than this, see
+  // WatchDogThread
+  std::chrono::milliseconds watchdog_stall_profiler_threshold;
+
   // If true, the NodeSetFinder within PurgeUncleanEpochs will use
   // only the metadata log as source for fetching historical metadata.
   // TODO: T28014582
@@ -233,6 +341,10 @@ struct Settings : public SettingsBundle {
   // per storage shard for each worker
   size_t max_concurrent_purging_for_release_per_shard;
 
+  // delete the records of small ESN ranges being purged through the write
+  // queue of the shard, where deletes of many logs are batched together
+  bool purging_batch_deletes;
+
   // An option to control if a gossip message should be sent to the
   // destination's gossip port or data port.
   // This is set to false by default for upgrades(from release where nodes
@@ -264,6 +376,13 @@ struct Settings : public SettingsBundle {
   // rather than timeouts when initiating STORE retries.
   chrono_expbackoff_t<std::chrono::milliseconds> store_timeout;
 
+  // Maximum number of STOREs sent to a storage node in one STORES message.
+  // 1 means every STORE is sent in its own message.
+  size_t store_batch_max_records;
+
+  // Maximum total size of the payloads in one STORES message.
+  size_t store_batch_max_bytes;
+
   // Timeout after it which two nodes retry to connect when they loose a
   // a connection. Backoff for throttling socket re-connection attempts.
   chrono_expbackoff_t<std::chrono::milliseconds> connect_throttle;
@@ -312,6 +431,15 @@ struct Settings : public SettingsBundle {
   // Minimum time interval between two consecutive refreshes of a NodeSetState
   std::chrono::milliseconds nodeset_state_refresh_interval;
 
+  // If true, sequencers record the load of storage shards reported to their
+  // Appenders (see ShardLoadTracker) and steer nodesets they provision or
+  // update away from loaded shards.
+  bool load_aware_nodeset_selection;
+
+  // Reports of shard load older than this are ignored by load-aware nodeset
+  // selection.
+  std::chrono::milliseconds nodeset_load_report_ttl;
+
   // Time to wait for the TCP connection to be established.
   // If set to 0, timeout is defined by OS configuration.
   std::chrono::milliseconds connect_timeout;
@@ -338,6 +466,15 @@ struct Settings : public SettingsBundle {
   //   unless write_batch_size is reached first.
   size_t write_batch_bytes;
 
+  // If nonzero, the syncing storage thread may delay a WAL sync to add more
+  // tasks to it, as long as the first task of the batch is expected to be
+  // synced within this time. Zero means syncing as soon as possible.
+  std::chrono::microseconds sync_group_commit_target_latency;
+
+  // Maximum number of tasks to confirm with one WAL sync when delaying syncs
+  // for group commit. Zero means no limit.
+  size_t sync_group_commit_max_batch;
+
   // Maximum number of read streams clients can establish to the server, per
   // worker
   size_t max_server_read_streams;
@@ -361,6 +498,15 @@ struct Settings : public SettingsBundle {
   // How long to wait before retrying to send RELEASE messages to storage nodes.
   chrono_expbackoff_t<std::chrono::milliseconds> release_retry_interval;
 
+  // How often the sequencer of a log in streaming ingest mode sends RELEASE
+  // messages. Such logs don't send a RELEASE for every append.
+  std::chrono::milliseconds streaming_ingest_release_interval;
+
+  // How long RELEASEs that the sequencers of a worker send to the same
+  // storage node are held back to be sent together in a RELEASES message.
+  // 0 sends every RELEASE right away in its own message.
+  std::chrono::milliseconds release_batch_interval;
+
   // How long to wait before broadcasting RELEASE messages to all storage nodes
   // for logs other than internal logs
   chrono_expbackoff_t<std::chrono::milliseconds> release_broadcast_interval;
@@ -390,6 +536,10 @@ struct Settings : public SettingsBundle {
   // participate in epoch recovery
   std::chrono::milliseconds recovery_grace_period;
 
+  // number of epochs of a log whose recovery digests are built at the same
+  // time. Mutations and cleaning still run one epoch at a time, in order.
+  size_t recovery_max_concurrent_epochs;
+
   // Amount of time we wait before we report a read stream that is
   // considered stuck.
   std::chrono::milliseconds reader_stuck_threshold;
@@ -426,6 +576,11 @@ struct Settings : public SettingsBundle {
   // processed before returning to the libevent loop
   size_t appender_buffer_process_batch;
 
+  // If non-zero, sequencers size the window of appends in flight of every
+  // log between this value and the log's max-writes-in-flight, based on
+  // observed append latency and throughput.
+  size_t sequencer_adaptive_window_min;
+
   // Skip sending data to storage node from appender . So that it remains
   // in worker map to test abort or recreate appender leak scenario etc.
   bool test_appender_skip_stores;
@@ -459,12 +614,21 @@ struct Settings : public SettingsBundle {
   // log store and the sequencer
   std::chrono::microseconds log_state_recovery_interval;
 
+  // if true, storage nodes populate LogStorageStateMap on startup by scanning
+  // the trim points, last released LSNs, last clean epochs and seals of all
+  // logs in bulk, instead of recovering them lazily one log at a time
+  bool warm_up_log_storage_state;
+
   // how long to wait for a single node to respond to the GET_SEQ_STATE message
   std::chrono::milliseconds get_seq_state_reply_timeout;
 
   // Exponential Backoff Timer for GET_SEQ_STATE request.
   chrono_expbackoff_t<std::chrono::milliseconds> seq_state_backoff_time;
 
+  // (client-only setting) If true, AppendRequests first try the node that
+  // most recently ran the sequencer for the log, as learned by this Worker.
+  bool use_sequencer_location_cache;
+
   // Minium timeout for a CheckSealRequest
   std::chrono::milliseconds check_seal_req_min_timeout;
 
@@ -499,12 +663,33 @@ struct Settings : public SettingsBundle {
   // Client::createReader()
   size_t client_read_buffer_size;
 
+  // (client-only setting) Approximate limit on the total payload size of the
+  // records buffered by all the read streams of a client, split evenly across
+  // workers. Read streams of a worker above its share shrink their windows.
+  // 0 means no limit.
+  size_t client_read_buffer_memory_budget;
+
   // (client-only setting) Threshold (relative to buffer size) at which
   // ClientReadStream broadcasts WINDOW messages to storage nodes.  Smaller
   // values mean more frequent broadcasting, possibly increasing throughput
   // but also wire chatter.
   double client_read_flow_control_threshold;
 
+  // (client-only setting) Maximum time a read stream holds back a WINDOW
+  // update so that it can be coalesced with the updates of other read streams
+  // reading from the same storage node. The actual delay adapts to how fast
+  // the stream consumes its window. 0 sends updates right away.
+  std::chrono::milliseconds client_window_update_max_delay;
+
+  // Maximum number of STARTs for the same storage node that read streams of a
+  // worker send in one STARTS message. 1 disables batching.
+  size_t start_batch_size;
+
+  // (client-only setting) Payloads of received records of at least this many
+  // bytes are moved out of the socket's input buffer instead of being copied,
+  // and the record keeps that buffer alive. 0 disables.
+  size_t client_record_payload_zero_copy_min_size;
+
   // (client-only setting) maximum number of epoch metadata entries cached in
   // the client. Set it to 0 to disable epoch metadata caching
   size_t client_epoch_metadata_cache_size;
@@ -558,6 +743,10 @@ struct Settings : public SettingsBundle {
   // CopySetSelector manager - sticky copyset block max time
   std::chrono::milliseconds sticky_copysets_block_max_time;
 
+  // If positive, sticky copyset blocks end at wall clock multiples of this
+  // instead of after sticky_copysets_block_max_time
+  std::chrono::milliseconds sticky_copysets_block_time_alignment;
+
   // Specifies how long to keep unused cached iterators around before
   // invalidating them.
   std::chrono::milliseconds iterator_cache_ttl;
@@ -596,6 +785,11 @@ struct Settings : public SettingsBundle {
   // epoch
   std::chrono::milliseconds epoch_draining_timeout;
 
+  // (sequencer-only setting) when fewer than this many ESNs are left in the
+  // current epoch, reactivate into the next epoch ahead of ESN exhaustion,
+  // while appends keep running in the current epoch. 0 disables.
+  size_t epoch_pipelining_esns;
+
   // (sequencer-only setting) maximum time interval for a sequencer to get
   // historical epoch metadata through reading the metadata log before retrying
   std::chrono::milliseconds read_historical_metadata_timeout;
@@ -646,10 +840,52 @@ struct Settings : public SettingsBundle {
   // the client will be.
   std::chrono::seconds remote_logs_config_cache_ttl;
 
+  // (client-only setting) How long the remote logs config remembers that a
+  // log ID doesn't exist on the server. 0 disables negative caching.
+  std::chrono::milliseconds remote_logs_config_negative_cache_ttl;
+
+  // (client-only setting) If not empty, a client with a "server:" config
+  // keeps the last config it fetched in this file and starts from it.
+  std::string server_config_cache_path;
+
+  // (client-only setting) Cached configs older than this are not used.
+  std::chrono::seconds server_config_cache_max_age;
+
   // (server-only setting) Override the client FindKeyAccuracy setting with
   // FindKeyAccuracy::APPROXIMATE.
   bool findtime_force_approximate;
 
+  // (client-only setting) Maximum number of findTime() FINDKEYs for the same
+  // shard to coalesce into one FINDKEY_BATCH message. 1 disables batching.
+  size_t findtime_batch_size;
+
+  // (client-only setting) Maximum number of isLogEmpty() IS_LOG_EMPTYs or
+  // dataSize() DATA_SIZEs for the same shard to coalesce into one
+  // IS_LOG_EMPTY_BATCH or DATA_SIZE_BATCH message. 1 disables batching.
+  size_t log_query_batch_size;
+
+  // Size of each Worker's MessageArena for received messages that don't
+  // outlive their onReceived(). 0 disables the arenas.
+  size_t message_arena_kb;
+
+  // If true, worker timers go to a per-worker timing wheel with O(1)
+  // activation and cancellation instead of libevent's heap.
+  bool worker_timer_wheel;
+
+  // Number of general workers, starting from worker 0, whose event loops
+  // busy-poll for busy_poll_spin after handling events instead of blocking
+  // right away.
+  int busy_poll_workers;
+  std::chrono::microseconds busy_poll_spin;
+
+  // Create worker event bases with EVENT_BASE_FLAG_EPOLL_USE_CHANGELIST
+  bool event_loop_epoll_changelist;
+
+  // If positive, a worker whose load is more than this many times the mean
+  // load of all workers migrates the log it executes the most appends for to
+  // the least loaded worker.
+  double log_worker_migration_load_skew;
+
   std::chrono::seconds initial_config_load_timeout;
 
   // How often to poll for config changes when the config is stored in a local
@@ -665,9 +901,26 @@ struct Settings : public SettingsBundle {
   // the root znodes should be created by external tooling.
   bool zk_create_root_znodes;
 
+  // Maximum number of epoch store znode writes of different logs sent
+  // together in one Zookeeper multi-op. 1 disables batching.
+  size_t zk_max_batched_writes;
+
+  // If true, a read of an epoch store znode that is issued while a read of
+  // the same znode is in flight uses the result of that read.
+  bool zk_coalesce_reads;
+
   // Maximum amount of memory that can be allocated by read storage tasks.
   size_t read_storage_tasks_max_mem_bytes;
 
+  // If nonzero, how often read_storage_tasks_max_mem_bytes is redivided
+  // between workers according to how often they ran out of it. Otherwise
+  // it's divided evenly.
+  std::chrono::milliseconds read_storage_tasks_mem_rebalance_interval;
+
+  // Fraction of its even share of read_storage_tasks_max_mem_bytes that a
+  // worker keeps when the memory is redivided.
+  double read_storage_tasks_mem_min_share;
+
   // Path to LD SSL-certificate
   std::string ssl_cert_path;
 
@@ -679,9 +932,28 @@ struct Settings : public SettingsBundle {
 
   bool ssl_load_client_cert;
 
+  // Ask OpenSSL to hand encryption of SSL connections over to the kernel
+  // (kTLS) once the handshake is done
+  bool ssl_enable_ktls;
+
   // TTL for the cert loaded from file
   std::chrono::seconds ssl_cert_refresh_interval;
 
+  // Resume TLS sessions of SSL connections instead of doing full handshakes:
+  // servers issue session tickets encrypted with a key shared by all their
+  // workers, and workers keep the last session with every node they connect
+  // to
+  bool ssl_session_resumption;
+
+  // {server-only} File with the 48-byte key used to encrypt session tickets.
+  // If empty, a random key is generated on startup.
+  std::string ssl_session_ticket_key_path;
+
+  // {server-only} If positive, this many listener threads accept connections
+  // on the SSL port and do their TLS handshakes before handing them to
+  // workers
+  int ssl_handshake_threads;
+
   // Sets the boundary which triggers enabling SSL. Communication that crosses
   // this boundary will be encrypted; communication that doesn't will not.
   // For instance, if set to NodeLocationScope::RACK, all cross-rack traffic
@@ -700,6 +972,24 @@ struct Settings : public SettingsBundle {
   // See man ioprio_set for possible values.
   folly::Optional<std::pair<int, int>> slow_ioprio;
 
+  // NUMA nodes to bind storage threads of each shard to, round-robin.
+  // Empty means no binding.
+  std::vector<int> storage_thread_numa_nodes;
+
+  // If nonzero, idle storage threads take stealable tasks (see
+  // StorageTask::isStealable()) from the queues of other shards, and wake up
+  // with this period to look for them. Zero disables work stealing.
+  std::chrono::milliseconds storage_task_stealing_interval;
+
+  // Storage threads execute up to this many queued ReadStorageTasks of the
+  // same priority back to back, sorted by log and LSN. 1 disables batching.
+  size_t storage_thread_read_batch_size;
+
+  // If nonzero, storage threads hold back up to this many read tasks per
+  // shard and thread type, and execute them taking turns between clients and
+  // grouping tasks reading the same log. See ReadScheduler.
+  size_t storage_thread_read_scheduler_window;
+
   // (client-only setting) Timeout after which ClientReadStream considers a
   // storage node down if it does not send any data for some time but the socket
   // to it remains open. This can happen if:
@@ -834,6 +1124,10 @@ struct Settings : public SettingsBundle {
   // This option prevents GET_SEQ_STATE from sending CHECK_SEAL messages.
   bool disable_check_seals;
 
+  // GET_SEQ_STATE requests for the tail of a log don't send check-seal
+  // requests if the sequencer passed one within this interval. 0 disables.
+  std::chrono::milliseconds tail_query_seal_check_interval;
+
   // GetClusterStateRequest will use these value to setup wave timer and
   // overall request timer.
   // TODO (t13314297): these settings are not modified anywhere
@@ -844,6 +1138,10 @@ struct Settings : public SettingsBundle {
   // event loop.
   std::chrono::microseconds flow_groups_run_yield_interval;
 
+  // Release the callbacks waiting for bandwidth in a FlowGroup by deficit
+  // round robin across Sockets within each priority level, instead of FIFO.
+  bool flow_groups_fair_queuing;
+
   // Maximum delay (plus one cycle of the event loop) between
   // a request to run FlowGroups and Sender::runFlowGroups() executing.
   std::chrono::microseconds flow_groups_run_deadline;
@@ -1029,6 +1327,9 @@ struct Settings : public SettingsBundle {
   // See .cpp
   std::chrono::milliseconds shadow_client_timeout;
 
+  // See .cpp
+  size_t shadow_max_bytes_in_flight;
+
   // Defaults to false, should only be set by traffic shadowing framework
   bool shadow_client;
 
@@ -1048,6 +1349,11 @@ struct Settings : public SettingsBundle {
   Status dont_serve_stores_status;
 
   chrono_expbackoff_t<std::chrono::milliseconds> reader_reconnect_delay;
+  // Random delay of up to this much added to each reconnect of a read stream,
+  // and the budget of reconnects to each storage node across all read streams
+  // of the process. See ClientReadStreamReconnectLimiter.
+  std::chrono::milliseconds reader_reconnect_jitter;
+  rate_limit_t reader_reconnect_rate_limit;
   chrono_expbackoff_t<std::chrono::milliseconds> reader_started_timeout;
   chrono_expbackoff_t<std::chrono::milliseconds> reader_retry_window_delay;
 
@@ -1063,6 +1369,11 @@ struct Settings : public SettingsBundle {
   // entries.
   size_t real_time_eviction_threshold_bytes;
 
+  // (server-only setting) How many of the least recently used logs to look at
+  // when evicting from the real time buffer, for records that no read stream
+  // is tailing.  Those get evicted before whole logs are evicted in LRU order.
+  size_t real_time_eviction_candidate_logs;
+
   // Test Options:
 
   // This option should only be used in tests. This is used to linerarly
@@ -1075,6 +1386,9 @@ struct Settings : public SettingsBundle {
 
   // When set, serialize ShardIDs instead of node_index_t on disk.
   bool write_shard_id_in_copyset;
+  // When set, records of logs with the compact_record_header attribute are
+  // written with LocalLogStoreRecordFormat::FLAG_COMPACT_HEADER.
+  bool write_compact_record_header;
   // When set, new EpochMetaData is serialized using the new copyset
   // serialization format for Flexible Log Sharding.
   // TODO(T15517759): once all clusters are configured to use this option,
@@ -1117,6 +1431,17 @@ struct Settings : public SettingsBundle {
   ClientReadStreamFailureDetector::Settings
       reader_slow_shards_detection_settings;
 
+  // When slow shards are added to the SCD filtered out list, keep the records
+  // already buffered instead of discarding them, and restart each storage
+  // shard no earlier than the first LSN the slow shards may still have to
+  // ship.
+  bool reader_slow_shards_partial_failover;
+
+  // For logs with local SCD, the maximum number of shards in the client's
+  // region that slow shards detection may filter out at a time. -1 for no
+  // limit.
+  int reader_slow_shards_max_local_outliers;
+
   SequencerBoycottingSettings sequencer_boycotting;
 
   // Use metadata logs in NodeSetFinder if true, otherwise use sequencers
@@ -1125,6 +1450,10 @@ struct Settings : public SettingsBundle {
   // everywhere.
   bool read_streams_use_metadata_log_only;
 
+  // Let read streams of a worker that need the historical metadata of the
+  // same log at the same time share a NodeSetFinder.
+  bool read_streams_coalesce_metadata_reads;
+
  private:
   // Only UpdateableSettings can create this bundle to ensure defaults are
   // populated.
@@ -31,6 +31,9 @@ namespace facebook { namespace logdevice {
 
 // ~30 years
 const int64_t LatencyHistogram::USEC_MAX = 1000l * 1000 * 1000 * 1000 * 1000;
+const int64_t HighResLatencyHistogram::USEC_MAX = 1000l * 1000 * 1000;
+constexpr size_t HighResLatencyHistogram::DEFAULT_PRECISION_BITS;
+constexpr size_t HighResLatencyHistogram::MAX_PRECISION_BITS;
 // 1 PiB
 const int64_t SizeHistogram::BYTES_MAX = 1l << 50;
 // ~30 years
@@ -80,6 +83,53 @@ const std::vector<MultiScaleHistogram::Scale>* LatencyHistogram::getScales() {
   return &SCALE;
 };
 
+HighResLatencyHistogram::HighResLatencyHistogram(int64_t usec_max,
+                                                 size_t precision_bits)
+    : MultiScaleHistogram(createHistograms(usec_max, precision_bits),
+                          getScales()) {}
+
+HighResLatencyHistogram::HighResLatencyHistogram(
+    const std::map<std::string, std::string>& map,
+    const std::string& prefix,
+    int64_t usec_max,
+    size_t precision_bits)
+    : MultiScaleHistogram(createHistograms(usec_max, precision_bits),
+                          getScales(),
+                          map,
+                          prefix) {}
+
+std::vector<MultiScaleHistogram::LinearHistogram>
+HighResLatencyHistogram::createHistograms(int64_t usec_max,
+                                          size_t precision_bits) {
+  if (UNLIKELY(usec_max > USEC_MAX)) {
+    throw std::invalid_argument("usec_max is too large");
+  }
+  if (UNLIKELY(precision_bits == 0 || precision_bits > MAX_PRECISION_BITS)) {
+    throw std::invalid_argument("precision_bits is out of range");
+  }
+
+  const int64_t buckets_per_level = 1l << precision_bits;
+  std::vector<LinearHistogram> histograms;
+  // Values that are small enough to count exactly.
+  histograms.emplace_back(1, 0, buckets_per_level);
+  // Then one level for each power of two, with buckets twice as wide as the
+  // level below.
+  for (int64_t width = 1; buckets_per_level * width < usec_max; width <<= 1) {
+    histograms.emplace_back(
+        width, buckets_per_level * width, 2 * buckets_per_level * width);
+  }
+
+  return histograms;
+}
+
+const std::vector<MultiScaleHistogram::Scale>*
+HighResLatencyHistogram::getScales() {
+  // Bucket boundaries are rarely round numbers of ms or s, and labels must be
+  // distinct for toMap() to be reversible. Stick to usec.
+  static const std::vector<MultiScaleHistogram::Scale> SCALE({{1, "usec"}});
+  return &SCALE;
+};
+
 SizeHistogram::SizeHistogram(int64_t bytes_max)
     : MultiScaleHistogram(createHistograms(bytes_max), getScales()) {}
 
@@ -386,9 +436,17 @@ void MultiScaleHistogram::merge(const MultiScaleHistogram& other) {
     throw std::invalid_argument("Cannot merge: different number of levels");
   }
 
+  const_cast<MultiScaleHistogram&>(other).mergeStagedValues();
+  if (other.count_ == 0) {
+    // Nothing to merge. This is the common case when aggregating the
+    // histograms of all threads: most threads never add values to most
+    // histograms, e.g. to the per-shard histograms of shards they don't
+    // work on. Don't go through all the buckets.
+    return;
+  }
+
   // Merge all staged values.
   mergeStagedValues();
-  const_cast<MultiScaleHistogram&>(other).mergeStagedValues();
 
   // Merge corresponding LinearHistograms.
   for (int i = 0; i < histograms_.size(); i++) {
@@ -510,9 +568,14 @@ void MultiScaleHistogram::subtract(const MultiScaleHistogram& other) {
     throw std::invalid_argument("Cannot subtract: different number of levels");
   }
 
+  const_cast<MultiScaleHistogram&>(other).mergeStagedValues();
+  if (other.count_ == 0) {
+    // Nothing to subtract, see merge().
+    return;
+  }
+
   // Merge all staged values.
   mergeStagedValues();
-  const_cast<MultiScaleHistogram&>(other).mergeStagedValues();
 
   // Subtract corresponding LinearHistograms from one another.
   for (size_t hist_idx = 0; hist_idx < histograms_.size(); ++hist_idx) {
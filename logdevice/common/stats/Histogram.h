@@ -286,6 +286,37 @@ class LatencyHistogram final : public MultiScaleHistogram {
   static const std::vector<Scale>* getScales();
 };
 
+// Log-linear histogram for tracking latencies with a bounded relative error,
+// in the style of HdrHistogram. Values below 2^precision_bits usec are counted
+// exactly. Above that, each power of two is split into 2^precision_bits
+// buckets, so that the width of the bucket a value falls into is at most
+// 2^-precision_bits of the value: about 3% with the default of 5 bits. Use it
+// where LatencyHistogram's power-of-ten buckets are too coarse to tell high
+// percentiles apart. It has more buckets, which costs memory and aggregation
+// time; precision_bits trades those for precision.
+class HighResLatencyHistogram final : public MultiScaleHistogram {
+ public:
+  // maximum value in microseconds that histogram can track (1000s)
+  static const int64_t USEC_MAX;
+  static constexpr size_t DEFAULT_PRECISION_BITS = 5;
+  static constexpr size_t MAX_PRECISION_BITS = 10;
+
+  explicit HighResLatencyHistogram(
+      int64_t usec_max = USEC_MAX,
+      size_t precision_bits = DEFAULT_PRECISION_BITS);
+
+  HighResLatencyHistogram(const std::map<std::string, std::string>& map,
+                          const std::string& prefix,
+                          int64_t usec_max = USEC_MAX,
+                          size_t precision_bits = DEFAULT_PRECISION_BITS);
+
+ private:
+  static std::vector<LinearHistogram> createHistograms(int64_t usec_max,
+                                                       size_t precision_bits);
+
+  static const std::vector<Scale>* getScales();
+};
+
 // Histogram for tracking sizes. Bucket sizes are
 // 1B, 10B, 100B, 1KiB, 10KiB, 100KiB, 1MiB, 10MiB, 100MiB, 1GiB, 10GiB, 100GiB.
 // Note that for linear histograms like 100B..1KiB the last bucket is 24% bigger
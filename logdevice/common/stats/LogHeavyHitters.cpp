@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/stats/LogHeavyHitters.h"
+
+#include <algorithm>
+
+#include "logdevice/common/checks.h"
+
+namespace facebook { namespace logdevice {
+
+void SpaceSavingSummary::add(logid_t log_id, uint64_t weight, uint64_t error) {
+  auto it = entries_.find(log_id);
+  if (it != entries_.end()) {
+    Entry& entry = it->second;
+    by_weight_.erase(std::make_pair(entry.weight, log_id));
+    entry.weight += weight;
+    entry.error += error;
+    by_weight_.emplace(entry.weight, log_id);
+    return;
+  }
+
+  if (capacity_ == 0) {
+    return;
+  }
+  if (entries_.size() >= capacity_) {
+    // Replace the log with the smallest weight. Its weight is an upper bound
+    // of how much was added for the new log before.
+    auto min = by_weight_.begin();
+    weight += min->first;
+    error += min->first;
+    entries_.erase(min->second);
+    by_weight_.erase(min);
+  }
+  entries_.emplace(log_id, Entry{log_id, weight, error});
+  by_weight_.emplace(weight, log_id);
+}
+
+void SpaceSavingSummary::merge(const SpaceSavingSummary& other) {
+  for (const auto& kv : other.entries_) {
+    add(kv.first, kv.second.weight, kv.second.error);
+  }
+}
+
+std::vector<SpaceSavingSummary::Entry>
+SpaceSavingSummary::top(size_t n) const {
+  std::vector<Entry> res;
+  for (auto it = by_weight_.rbegin(); it != by_weight_.rend() && res.size() < n;
+       ++it) {
+    res.push_back(entries_.at(it->second));
+  }
+  return res;
+}
+
+void SpaceSavingSummary::clear() {
+  entries_.clear();
+  by_weight_.clear();
+}
+
+constexpr size_t LogHeavyHitters::CAPACITY;
+
+const char* LogHeavyHitters::metricName(Metric metric) {
+  switch (metric) {
+    case Metric::APPENDED_BYTES:
+      return "appended_bytes";
+    case Metric::READ_BYTES:
+      return "read_bytes";
+    case Metric::STORAGE_TASK_USEC:
+      return "storage_task_usec";
+    case Metric::MAX:
+      break;
+  }
+  ld_check(false);
+  return "unknown";
+}
+
+LogHeavyHitters::LogHeavyHitters()
+    : current_window_(currentWindow()),
+      current_(static_cast<size_t>(Metric::MAX), SpaceSavingSummary(CAPACITY)),
+      previous_(current_) {}
+
+LogHeavyHitters::Window LogHeavyHitters::currentWindow() {
+  return std::chrono::duration_cast<Window>(
+      std::chrono::system_clock::now().time_since_epoch());
+}
+
+void LogHeavyHitters::add(Metric metric, logid_t log_id, uint64_t weight) {
+  ld_check(metric < Metric::MAX);
+  const Window window = currentWindow();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (window != current_window_) {
+    std::swap(previous_, current_);
+    if (window != current_window_ + Window(1)) {
+      // Nothing was added during the window before this one.
+      for (auto& s : previous_) {
+        s.clear();
+      }
+    }
+    for (auto& s : current_) {
+      s.clear();
+    }
+    current_window_ = window;
+  }
+  current_[static_cast<size_t>(metric)].add(log_id, weight);
+}
+
+void LogHeavyHitters::mergeInto(Metric metric,
+                                Window window,
+                                SpaceSavingSummary& out) const {
+  ld_check(metric < Metric::MAX);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (window == current_window_) {
+    out.merge(current_[static_cast<size_t>(metric)]);
+  } else if (window == current_window_ - Window(1)) {
+    out.merge(previous_[static_cast<size_t>(metric)]);
+  }
+}
+
+void LogHeavyHitters::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& s : current_) {
+    s.clear();
+  }
+  for (auto& s : previous_) {
+    s.clear();
+  }
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,129 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <folly/Optional.h>
+
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Bounded-memory tracking of the logs responsible for most of a node's
+ *       appended bytes, read bytes and storage thread time, for logs that
+ *       don't have per-log time series enabled.
+ */
+
+/**
+ * Space-Saving summary (Metwally, Agrawal, El Abbadi, "Efficient computation
+ * of frequent and top-k elements in data streams") of the weights added for
+ * log IDs. Keeps at most `capacity` logs. When a new log is added to a full
+ * summary, it replaces the log with the smallest weight and inherits that
+ * weight as its error, so that weights are overestimated by at most `error`
+ * and any log with more than 1/capacity of the total weight is kept.
+ *
+ * Not thread safe.
+ */
+class SpaceSavingSummary {
+ public:
+  struct Entry {
+    logid_t log_id;
+    // Upper bound of the total weight added for the log.
+    uint64_t weight;
+    // How much `weight` may be overestimated by.
+    uint64_t error;
+  };
+
+  explicit SpaceSavingSummary(size_t capacity) : capacity_(capacity) {}
+
+  void add(logid_t log_id, uint64_t weight) {
+    add(log_id, weight, 0);
+  }
+
+  // Adds all entries of `other`. Errors add up.
+  void merge(const SpaceSavingSummary& other);
+
+  // @return  the `n` entries with the highest weight, highest first.
+  std::vector<Entry> top(size_t n) const;
+
+  size_t size() const {
+    return entries_.size();
+  }
+
+  void clear();
+
+ private:
+  void add(logid_t log_id, uint64_t weight, uint64_t error);
+
+  size_t capacity_;
+  std::unordered_map<logid_t, Entry, logid_t::Hash> entries_;
+  // (weight, log ID) of all entries, to find the one to replace.
+  std::set<std::pair<uint64_t, logid_t>> by_weight_;
+};
+
+/**
+ * SpaceSavingSummary of each metric, over 5 minute windows aligned on the
+ * system clock so that the windows of different threads and different nodes
+ * line up and can be summed. Only the current and previous windows are
+ * kept.
+ *
+ * Each thread has one in its Stats object. Thread safe; the mutex is almost
+ * only locked by the owning thread.
+ */
+class LogHeavyHitters {
+ public:
+  enum class Metric {
+    // Payload bytes of appends received by sequencers.
+    APPENDED_BYTES = 0,
+    // Record and CSI bytes read from the local log store by read streams.
+    READ_BYTES,
+    // Storage thread time spent executing tasks that read the log.
+    STORAGE_TASK_USEC,
+    MAX
+  };
+
+  static const char* metricName(Metric metric);
+
+  // Logs kept per metric and window in each thread.
+  static constexpr size_t CAPACITY = 256;
+
+  // Windows since the epoch of the system clock.
+  using Window = std::chrono::duration<int64_t, std::ratio<300>>;
+
+  LogHeavyHitters();
+
+  void add(Metric metric, logid_t log_id, uint64_t weight);
+
+  // Merges this thread's summary of `metric` for `window` into `out`, if
+  // this thread still has it.
+  void mergeInto(Metric metric, Window window, SpaceSavingSummary& out) const;
+
+  void clear();
+
+  // Window containing the current time.
+  static Window currentWindow();
+
+ private:
+  // Indexed by Metric.
+  using Summaries = std::vector<SpaceSavingSummary>;
+
+  mutable std::mutex mutex_;
+  Window current_window_;
+  Summaries current_;
+  Summaries previous_;
+};
+
+}} // namespace facebook::logdevice
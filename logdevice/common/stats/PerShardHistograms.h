@@ -43,6 +43,8 @@ struct PerShardHistograms : public PerShardHistogramBundle {
         {"flushed_log_run_length", &flushed_log_run_length},
         {"compacted_log_run_length", &compacted_log_run_length},
         {"trimmed_record_age", &trimmed_record_age},
+        {"sync_batch_size", &sync_batch_size},
+        {"sync_wait_time", &sync_wait_time},
 
         // Rebuilding related histograms
         {"record_rebuilding", &record_rebuilding},
@@ -70,13 +72,22 @@ struct PerShardHistograms : public PerShardHistogramBundle {
          &storage_threads_queue_time[static_cast<int>(
              StorageTaskThreadType::METADATA)]},
 
-    // Execution and queueing latencies for storage tasks.
+    // Execution, queueing and response latencies for storage tasks.
     // See Stats::enumerate() to see how these are published
-#define STORAGE_TASK_TYPE(name, class_name, _)                           \
-  {class_name, &storage_tasks[static_cast<int>(StorageTaskType::name)]}, \
-      {"queue_time." class_name,                                         \
-       &storage_task_queue_time[static_cast<int>(StorageTaskType::name)]},
+#define STORAGE_TASK_TYPE(name, class_name, _)                              \
+  {class_name, &storage_tasks[static_cast<int>(StorageTaskType::name)]},    \
+      {"queue_time." class_name,                                            \
+       &storage_task_queue_time[static_cast<int>(StorageTaskType::name)]},  \
+      {"response_time." class_name,                                         \
+       &storage_task_response_time[static_cast<int>(StorageTaskType::name)]},
 #include "logdevice/common/storage_task_types.inc"
+
+    // Queueing latencies for storage tasks by priority.
+#define STORAGE_TASK_PRIORITY(name, str_name)           \
+  {"queue_time.priority." str_name,                     \
+   &storage_task_priority_queue_time[static_cast<int>( \
+       StorageTaskPriority::name)]},
+#include "logdevice/common/storage_task_priorities.inc"
     };
   }
 
@@ -118,6 +129,11 @@ struct PerShardHistograms : public PerShardHistogramBundle {
   // The Histogram of trimmed records age, in seconds
   record_age_histogram_t trimmed_record_age;
 
+  // Number of tasks confirmed by each WAL sync of SyncingStorageThread.
+  no_unit_histogram_t sync_batch_size;
+  // Time tasks spent in SyncingStorageThread waiting for their WAL sync.
+  latency_histogram_t sync_wait_time;
+
   // Latency of RecordRebuilding state machine.
   latency_histogram_t record_rebuilding;
   // Latency of Reading a batch in LogRebuilding.
@@ -138,6 +154,13 @@ struct PerShardHistograms : public PerShardHistogramBundle {
   // Queueing latencies for storage tasks (by storage task type)
   latency_histogram_t
       storage_task_queue_time[static_cast<size_t>(StorageTaskType::MAX)];
+  // Time from a storage task completing on a storage thread to the worker
+  // processing its StorageTaskResponse (by storage task type)
+  latency_histogram_t
+      storage_task_response_time[static_cast<size_t>(StorageTaskType::MAX)];
+  // Queueing latencies for storage tasks (by storage task priority)
+  latency_histogram_t storage_task_priority_queue_time[static_cast<size_t>(
+      StorageTaskPriority::NUM_PRIORITIES)];
   // Queueing latencies for storage threads (by storage thread type)
   latency_histogram_t storage_threads_queue_time[static_cast<size_t>(
       StorageTaskThreadType::MAX)];
@@ -23,6 +23,15 @@ struct ServerHistograms : public HistogramBundle {
   HistogramBundle::MapType getMap() override {
     return {
         {"append_latency", &append_latency},
+        {"append_latency_high_res", &append_latency_high_res},
+        {"append_timings_admission", &append_timings_admission},
+        {"append_timings_retry", &append_timings_retry},
+        {"append_timings_network", &append_timings_network},
+        {"append_timings_storage_worker", &append_timings_storage_worker},
+        {"append_timings_storage_queue", &append_timings_storage_queue},
+        {"append_timings_storage_write", &append_timings_storage_write},
+        {"append_timings_storage_sync", &append_timings_storage_sync},
+        {"append_timings_storage_reply", &append_timings_storage_reply},
         {"write_to_read_latency", &write_to_read_latency},
         {"requests_queue_latency", &requests_queue_latency},
         {"gossip_queue_latency", &gossip_queue_latency},
@@ -41,6 +50,12 @@ struct ServerHistograms : public HistogramBundle {
         {"logsconfig_manager_delta_apply_latency",
          &logsconfig_manager_delta_apply_latency},
         {"background_thread_duration", &background_thread_duration},
+        {"buffered_writer_bg_queue_latency", &buffered_writer_bg_queue_latency},
+        {"buffered_writer_compression_ratio",
+         &buffered_writer_compression_ratio},
+        {"buffered_writer_construct_blob_latency",
+         &buffered_writer_construct_blob_latency},
+        {"read_batch_size", &read_batch_size},
 #define REQUEST_TYPE(name)              \
   {"request_execution_duration." #name, \
    &request_execution_duration[int(RequestType::name)]},
@@ -56,6 +71,21 @@ struct ServerHistograms : public HistogramBundle {
   // Latency of appends as seen by the sequencer
   LatencyHistogram append_latency;
 
+  // Same with buckets fine enough to track high percentiles, see
+  // HighResLatencyHistogram
+  HighResLatencyHistogram append_latency_high_res;
+
+  // Latency breakdown of the appends sampled by append-timings-sample-rate,
+  // see AppendTimings
+  LatencyHistogram append_timings_admission;
+  LatencyHistogram append_timings_retry;
+  LatencyHistogram append_timings_network;
+  LatencyHistogram append_timings_storage_worker;
+  LatencyHistogram append_timings_storage_queue;
+  LatencyHistogram append_timings_storage_write;
+  LatencyHistogram append_timings_storage_sync;
+  LatencyHistogram append_timings_storage_reply;
+
   // Write-to-read latency
   LatencyHistogram write_to_read_latency;
 
@@ -108,6 +138,22 @@ struct ServerHistograms : public HistogramBundle {
 
   LatencyHistogram background_thread_duration;
 
+  // Time BufferedWriter batches (e.g. of SequencerBatching) wait in the queue
+  // of background threads before their blob is constructed and compressed
+  LatencyHistogram buffered_writer_bg_queue_latency;
+
+  // Size of BufferedWriter batch blobs before compression relative to after,
+  // in percent (e.g. 300 for 3:1), for batches that compression was tried on
+  NoUnitHistogram buffered_writer_compression_ratio;
+
+  // Time it takes to construct and compress BufferedWriter batch blobs, on
+  // workers or background threads
+  LatencyHistogram buffered_writer_construct_blob_latency;
+
+  // Limit on record bytes chosen for read batches by CatchupOneStream when
+  // adaptive-read-batch-size is enabled
+  SizeHistogram read_batch_size;
+
   std::array<LatencyHistogram, static_cast<int>(RequestType::MAX)>
       request_execution_duration;
   std::array<LatencyHistogram, static_cast<int>(MessageType::MAX)>
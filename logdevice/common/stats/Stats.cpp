@@ -18,6 +18,7 @@
 #include <folly/stats/MultiLevelTimeSeries-defs.h>
 #include <folly/stats/MultiLevelTimeSeries.h>
 
+#include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/stats/ClientHistograms.h"
 #include "logdevice/common/stats/Histogram.h"
 #include "logdevice/common/stats/PerShardHistograms.h"
@@ -242,12 +243,15 @@ void PerStorageTaskTypeStats::reset() {
 #include "logdevice/common/stats/per_storage_task_type_stats.inc" // nolint
 }
 
+constexpr size_t PerLogStatsCache::MAX_ENTRIES;
+
 Stats::Stats(const FastUpdateableSharedPtr<StatsParams>* params)
     : params(params), worker_id(-1) {
   if (params->get()->is_server) {
     server_histograms = std::make_unique<ServerHistograms>();
     per_shard_histograms = std::make_unique<PerShardHistograms>();
     per_shard_stats = std::make_unique<ShardedStats>();
+    log_heavy_hitters = std::make_unique<LogHeavyHitters>();
   }
 }
 
@@ -267,6 +271,46 @@ Stats::Stats(Stats&& other) noexcept(true) = default;
 
 Stats& Stats::operator=(Stats&& other) noexcept(false) = default;
 
+PerLogStats* Stats::getPerLogStats(const Configuration* config,
+                                   logid_t log_id) {
+  if (config == nullptr || !config->logsConfig()->isLocal()) {
+    return nullptr;
+  }
+
+  PerLogStatsCache& cache = per_log_stats_cache;
+  const auto& logs_config = config->logsConfig();
+  const uint64_t generation = cache.generation.load();
+  if (cache.entries_generation != generation ||
+      cache.logs_config.owner_before(logs_config) ||
+      logs_config.owner_before(cache.logs_config) ||
+      cache.entries.size() >= PerLogStatsCache::MAX_ENTRIES) {
+    // per_log_stats was reset, or log groups may have been renamed.
+    cache.entries.clear();
+    cache.entries_generation = generation;
+    cache.logs_config = logs_config;
+  }
+
+  auto it = cache.entries.find(log_id);
+  if (it != cache.entries.end()) {
+    return it->second.get();
+  }
+
+  std::shared_ptr<PerLogStats> stats;
+  const auto log_path = config->getLogGroupPath(log_id);
+  if (log_path.hasValue()) {
+    auto ulock = per_log_stats.ulock();
+    auto stats_it = ulock->find(log_path.value());
+    if (stats_it != ulock->end()) {
+      stats = stats_it->second;
+    } else {
+      // No risk of deadlock because we are the only writer thread.
+      stats = std::make_shared<PerLogStats>();
+      ulock.moveFromUpgradeToWrite()->emplace(log_path.value(), stats);
+    }
+  }
+  return cache.entries.emplace(log_id, std::move(stats)).first->second.get();
+}
+
 void Stats::aggregate(Stats const& other, StatsAggOptional agg_override) {
 #define STAT_DEFINE(name, agg) \
   aggregateStat(StatsAgg::agg, agg_override, name, other.name);
@@ -409,6 +453,7 @@ void Stats::reset() {
   per_worker_stats.wlock()->clear();
 
   per_log_stats.wlock()->clear();
+  per_log_stats_cache.invalidate();
 
   if (server_histograms) {
     server_histograms->clear();
@@ -419,6 +464,9 @@ void Stats::reset() {
   if (per_shard_stats) {
     per_shard_stats->reset();
   }
+  if (log_heavy_hitters) {
+    log_heavy_hitters->clear();
+  }
 
   client.histograms->clear();
 }
@@ -588,6 +636,9 @@ void Stats::enumerate(EnumerationCallbacks* cb, bool list_all) const {
   cb->stat(
       "request_worker_usec.INVALID",
       per_request_type_stats[int(RequestType::INVALID)].request_worker_usec);
+  cb->stat("request_worker_cpu_usec.INVALID",
+           per_request_type_stats[int(RequestType::INVALID)]
+               .request_worker_cpu_usec);
 
   // Per storage task type
   std::array<bool, static_cast<int>(StorageTaskType::MAX)>
@@ -600,6 +651,7 @@ void Stats::enumerate(EnumerationCallbacks* cb, bool list_all) const {
     publish_stats_by_index[int(StorageTaskType::type)] = publish;         \
     publish_stats_by_name[str_name] = publish;                            \
     publish_stats_by_name["queue_time." str_name] = publish;              \
+    publish_stats_by_name["response_time." str_name] = publish;           \
   }
 #include "logdevice/common/storage_task_types.inc"
 
@@ -660,6 +712,7 @@ void Stats::enumerate(EnumerationCallbacks* cb, bool list_all) const {
     // Server per shard histograms.
     PerShardHistograms::latency_histogram_t unknown_histogram;
     PerShardHistograms::latency_histogram_t unknown_queue_histogram;
+    PerShardHistograms::latency_histogram_t unknown_response_histogram;
     ld_check(per_shard_histograms);
     for (auto& hist : per_shard_histograms->map()) {
       auto it = publish_stats_by_name.find(hist.first);
@@ -668,6 +721,8 @@ void Stats::enumerate(EnumerationCallbacks* cb, bool list_all) const {
             hist.second));
         if (boost::starts_with(hist.first, "queue_time.")) {
           unknown_queue_histogram.merge(*hist.second);
+        } else if (boost::starts_with(hist.first, "response_time.")) {
+          unknown_response_histogram.merge(*hist.second);
         } else {
           unknown_histogram.merge(*hist.second);
         }
@@ -677,6 +732,7 @@ void Stats::enumerate(EnumerationCallbacks* cb, bool list_all) const {
     }
     publishHist("OtherStorageTask", unknown_histogram);
     publishHist("queue_time.OtherStorageTask", unknown_queue_histogram);
+    publishHist("response_time.OtherStorageTask", unknown_response_histogram);
 
     // Aggregated across all shards. Ignoring the publish_stats bit.
 
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <map>
@@ -29,6 +30,7 @@
 #include "logdevice/common/configuration/NodeLocation.h"
 #include "logdevice/common/configuration/TrafficClass.h"
 #include "logdevice/common/protocol/MessageType.h"
+#include "logdevice/common/stats/LogHeavyHitters.h"
 #include "logdevice/common/stats/StatsCounter.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/common/util.h"
@@ -53,6 +55,7 @@ namespace facebook { namespace logdevice {
  *        stats counters for LogDevice.
  */
 
+class Configuration;
 class LatencyHistogram;
 class MultiScaleHistogram;
 struct ClientHistograms;
@@ -149,6 +152,44 @@ struct PerLogStats {
   std::mutex mutex;
 };
 
+/**
+ * The PerLogStats of log IDs, cached by the thread owning a Stats object so
+ * that bumping a per-log stat (LOG_STAT_ADD) doesn't build the log group path
+ * of the log, hash it and lock per_log_stats every time. See
+ * Stats::getPerLogStats(). Copies are empty.
+ */
+struct PerLogStatsCache {
+  PerLogStatsCache() = default;
+  PerLogStatsCache(const PerLogStatsCache&) noexcept {}
+  PerLogStatsCache& operator=(const PerLogStatsCache&) {
+    invalidate();
+    return *this;
+  }
+
+  /**
+   * Makes the owner drop the cached entries the next time it uses them.
+   * Thread-safe.
+   */
+  void invalidate() {
+    generation.fetch_add(1);
+  }
+
+  // Entries are dropped once there are this many, so that threads touching
+  // many logs don't keep an entry for each of them.
+  static constexpr size_t MAX_ENTRIES = 1 << 16;
+
+  std::atomic<uint64_t> generation{0};
+
+  // The rest is only used by the owner.
+
+  // Values of generation and of the logs config the entries are valid for.
+  uint64_t entries_generation = 0;
+  std::weak_ptr<void> logs_config;
+  // nullptr for logs that aren't in a log group.
+  std::unordered_map<logid_t, std::shared_ptr<PerLogStats>, logid_t::Hash>
+      entries;
+};
+
 struct PerTrafficClassStats {
   PerTrafficClassStats() {}
 
@@ -598,6 +639,16 @@ struct Stats final {
    */
   void reset();
 
+  /**
+   * @return  the entry of per_log_stats for the log group that `log_id`
+   *          belongs to in `config`, created if needed. nullptr if `config`
+   *          is nullptr, if the logs config is not local, or if the log is
+   *          not in a log group.
+   *
+   * Must be called by the thread owning this Stats object.
+   */
+  PerLogStats* getPerLogStats(const Configuration* config, logid_t log_id);
+
   /**
    * Aggregates PerTrafficClassStats across all traffic classes.
    */
@@ -678,6 +729,7 @@ struct Stats final {
   folly::Synchronized<
       std::unordered_map<std::string, std::shared_ptr<PerLogStats>>>
       per_log_stats;
+  PerLogStatsCache per_log_stats_cache;
 
   // Server histograms. Initialized only on servers.
   std::unique_ptr<ServerHistograms> server_histograms;
@@ -688,6 +740,11 @@ struct Stats final {
   // Stats that we keep track of per shard. Initialized only on servers.
   std::unique_ptr<ShardedStats> per_shard_stats;
 
+  // Logs with the most appends, reads and storage thread time. Initialized
+  // only on servers. Not aggregated across threads: the "info
+  // log_heavy_hitters" admin command merges them on demand.
+  std::unique_ptr<LogHeavyHitters> log_heavy_hitters;
+
   // Per-worker stats kept over a specific time span.
   // Only for workers of type GENERAL.
   folly::Synchronized<
@@ -939,6 +996,14 @@ class PerShardStatToken {
     }                                      \
   } while (0)
 
+#define LOG_HEAVY_HITTER_ADD(stats_struct, metric, log_id, val)          \
+  do {                                                                   \
+    if (stats_struct && (stats_struct)->get().log_heavy_hitters) {       \
+      (stats_struct)->get().log_heavy_hitters->add(                      \
+          LogHeavyHitters::Metric::metric, (log_id), (val));             \
+    }                                                                    \
+  } while (0)
+
 #define STAT_SET(stats_struct, name, val) \
   do {                                    \
     if (stats_struct) {                   \
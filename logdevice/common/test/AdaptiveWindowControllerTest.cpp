@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/AdaptiveWindowController.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+using namespace std::chrono_literals;
+
+namespace {
+
+class MockAdaptiveWindowController : public AdaptiveWindowController {
+ public:
+  using AdaptiveWindowController::AdaptiveWindowController;
+
+  TimePoint now() const override {
+    return now_;
+  }
+
+  // Completes `n' appends with the given latency spread over the next
+  // sampling period, then one more to close the period.
+  void runPeriod(int n, std::chrono::microseconds latency) {
+    for (int i = 0; i < n; ++i) {
+      onAppendCompleted(latency);
+    }
+    now_ += kSamplingPeriod;
+    onAppendCompleted(latency);
+  }
+
+  TimePoint now_{std::chrono::hours(1)};
+};
+
+TEST(AdaptiveWindowControllerTest, StartsAtMax) {
+  MockAdaptiveWindowController c(16, 1000);
+  EXPECT_EQ(1000, c.getLimit());
+  // the first completion only starts the first sampling period
+  c.onAppendCompleted(10ms);
+  EXPECT_EQ(1000, c.getLimit());
+}
+
+// 100 appends per 100ms with a latency of 10ms keep 10 appends in flight
+TEST(AdaptiveWindowControllerTest, BandwidthDelayProduct) {
+  MockAdaptiveWindowController c(4, 1000);
+  c.onAppendCompleted(10ms);
+  c.runPeriod(99, 10ms);
+  EXPECT_EQ(20, c.getLimit());
+}
+
+TEST(AdaptiveWindowControllerTest, Bounds) {
+  MockAdaptiveWindowController c(16, 1000);
+  c.onAppendCompleted(10ms);
+
+  // a log with almost no appends shrinks to the minimum
+  c.runPeriod(0, 10ms);
+  EXPECT_EQ(16, c.getLimit());
+
+  // 100k appends/s at 10ms need more than max-writes-in-flight
+  c.runPeriod(9999, 10ms);
+  EXPECT_EQ(1000, c.getLimit());
+}
+
+// Queueing delay does not inflate the estimate: it is based on the lowest
+// latency seen recently
+TEST(AdaptiveWindowControllerTest, Queueing) {
+  MockAdaptiveWindowController c(4, 1000);
+  c.onAppendCompleted(10ms);
+  c.runPeriod(99, 10ms);
+  EXPECT_EQ(20, c.getLimit());
+
+  // same throughput, but appends wait behind each other
+  c.runPeriod(99, 50ms);
+  EXPECT_EQ(20, c.getLimit());
+
+  // once the low latency hasn't been seen for a while, the estimate follows
+  // the new latency, e.g. after the nodeset moved to another region
+  for (int i = 0; i < 100; ++i) {
+    c.runPeriod(99, 50ms);
+  }
+  EXPECT_EQ(100, c.getLimit());
+}
+
+} // namespace
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/AdminCommandTable.h"
+
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+#include "event2/buffer.h"
+#include "logdevice/common/AdminCommandTableBinary.h"
+#include "logdevice/common/libevent/compat.h"
+
+using namespace facebook::logdevice;
+using namespace facebook::logdevice::admin_command_table;
+
+namespace {
+
+std::string printBinary(const AdminCommandTable<logid_t, std::string>& table) {
+  struct evbuffer* evbuf = LD_EV(evbuffer_new)();
+  EvbufferTextOutput output(evbuf);
+  table.printBinary(output);
+  const size_t len = LD_EV(evbuffer_get_length)(evbuf);
+  std::string data(len, '\0');
+  LD_EV(evbuffer_copyout)(evbuf, &data[0], len);
+  LD_EV(evbuffer_free)(evbuf);
+  return data;
+}
+
+TEST(AdminCommandTableTest, PrintBinary) {
+  AdminCommandTable<logid_t, std::string> table(false, "Log ID", "Value");
+  table.next().set<0>(logid_t(1)).set<1>(std::string("END\r\n"));
+  table.next().set<0>(logid_t(2));
+
+  std::string data = printBinary(table);
+  auto size = binaryEncodingSize(data.data(), data.size());
+  ASSERT_TRUE(size.hasValue());
+  // The encoding is followed by a line break.
+  ASSERT_EQ(data.size(), size.value() + 2);
+
+  const char* p = data.data() + BINARY_PREFIX_SIZE;
+  auto read_u32 = [&] {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    p += sizeof(v);
+    return v;
+  };
+  auto read_str = [&] {
+    uint32_t len = read_u32();
+    std::string s(p, len);
+    p += len;
+    return s;
+  };
+
+  EXPECT_EQ(2, read_u32());
+  EXPECT_EQ(2, read_u32());
+  EXPECT_EQ("Log ID", read_str());
+  EXPECT_EQ("Value", read_str());
+  EXPECT_EQ("1", read_str());
+  EXPECT_EQ("2", read_str());
+  EXPECT_EQ("END\r\n", read_str());
+  EXPECT_EQ(BINARY_NULL_VALUE, read_u32());
+  EXPECT_EQ(data.data() + size.value(), p);
+}
+
+TEST(AdminCommandTableTest, BinaryEncodingSize) {
+  EXPECT_FALSE(binaryEncodingSize("{\"headers\": []}", 15).hasValue());
+  EXPECT_FALSE(binaryEncodingSize(BINARY_MAGIC, BINARY_MAGIC_SIZE).hasValue());
+}
+
+} // namespace
@@ -65,6 +65,25 @@ class MockAppendRequest : public AppendRequest {
     return epoch_t(0);
   }
   void updateSeenEpoch(logid_t /*log_id*/, epoch_t /*seen_epoch*/) override {}
+  NodeID getCachedSequencer(logid_t /*log*/) const override {
+    return cached_sequencer_;
+  }
+  void updateCachedSequencer(logid_t /*log*/,
+                             NodeID node,
+                             epoch_t /*epoch*/) override {
+    cached_sequencer_ = node;
+  }
+  void forgetCachedSequencer(logid_t /*log*/, NodeID node) override {
+    if (cached_sequencer_ == node) {
+      cached_sequencer_ = NodeID();
+    }
+  }
+  bool isBackingOff(logid_t /*log*/) const override {
+    return backing_off_;
+  }
+  void backOff(logid_t /*log*/, std::chrono::milliseconds /*delay*/) override {
+    backing_off_ = true;
+  }
 
   bool canSendToImpl(const Address&, TrafficClass, BWAvailableCallback&) {
     return true;
@@ -90,6 +109,8 @@ class MockAppendRequest : public AppendRequest {
   }
 
   NodeID dest_;
+  NodeID cached_sequencer_;
+  bool backing_off_ = false;
   Settings settings_;
 };
 
@@ -150,6 +171,12 @@ class AppendRequestTest : public ::testing::Test {
     return req->shouldAddAppendFail(status);
   }
 
+  bool isSlowAppend(AppendRequest* req,
+                    Status status,
+                    std::chrono::microseconds latency) {
+    return req->isSlowAppend(status, latency);
+  }
+
   void sendProbe(AppendRequest* req) {
     req->sendProbe();
   }
@@ -327,6 +354,76 @@ TEST_F(AppendRequestTest, SequencerAffinityTest) {
   EXPECT_NE(N1, rq->dest_);
 }
 
+// Verifies that AppendRequest sends straight to the cached sequencer node
+// instead of asking the SequencerLocator, and forgets the node once it turns
+// out to be unreachable.
+TEST_F(AppendRequestTest, CachedSequencer) {
+  int num_nodes = 4;
+  init(num_nodes, 1);
+
+  auto rq = create(logid_t(1));
+  ASSERT_EQ(Request::Execution::CONTINUE, rq->execute());
+  const NodeID located = rq->dest_;
+  ASSERT_NE(NodeID(), located);
+
+  const NodeID cached((located.index() + 1) % num_nodes, 1);
+  rq = create(logid_t(1));
+  rq->cached_sequencer_ = cached;
+  ASSERT_EQ(Request::Execution::CONTINUE, rq->execute());
+  ASSERT_EQ(cached, rq->dest_);
+
+  rq->noReply(E::CONNFAILED, Address(cached), false);
+  ASSERT_EQ(E::UNKNOWN, rq->getStatus());
+  ASSERT_NE(cached, rq->dest_);
+  ASSERT_EQ(NodeID(), rq->cached_sequencer_);
+
+  // A redirect updates the cache.
+  const NodeID redirect((rq->dest_.index() + 1) % num_nodes, 1);
+  APPENDED_Header hdr{rq->id_,
+                      LSN_INVALID,
+                      RecordTimestamp::zero(),
+                      redirect,
+                      E::REDIRECTED,
+                      0};
+  rq->onReplyReceived(hdr, Address(rq->dest_));
+  ASSERT_EQ(redirect, rq->cached_sequencer_);
+
+  // The setting turns the cache off.
+  rq = create(logid_t(1));
+  rq->settings_.use_sequencer_location_cache = false;
+  rq->cached_sequencer_ = cached;
+  ASSERT_EQ(Request::Execution::CONTINUE, rq->execute());
+  ASSERT_EQ(located, rq->dest_);
+}
+
+// Verifies that a retry delay from the sequencer makes appends to the log fail
+// with E::SEQNOBUFS without being sent.
+TEST_F(AppendRequestTest, BackOff) {
+  init(4, 1);
+
+  auto rq = create(logid_t(1));
+  ASSERT_EQ(Request::Execution::CONTINUE, rq->execute());
+  const NodeID dest = rq->dest_;
+  ASSERT_NE(NodeID(), dest);
+
+  rq->onRetryDelayReceived(std::chrono::milliseconds(100));
+  APPENDED_Header hdr{rq->id_,
+                      LSN_INVALID,
+                      RecordTimestamp::zero(),
+                      NodeID(),
+                      E::SEQNOBUFS,
+                      APPENDED_Header::INCLUDES_RETRY_DELAY};
+  rq->onReplyReceived(hdr, Address(dest));
+  ASSERT_EQ(E::SEQNOBUFS, rq->getStatus());
+  ASSERT_TRUE(rq->backing_off_);
+
+  rq = create(logid_t(1));
+  rq->backing_off_ = true;
+  rq->execute();
+  ASSERT_EQ(E::SEQNOBUFS, rq->getStatus());
+  ASSERT_EQ(NodeID(), rq->dest_);
+}
+
 TEST_F(AppendRequestTest, ShouldAddStatAppendSuccess) {
   init(1, 1);
   auto request = create(logid_t(1));
@@ -368,6 +465,22 @@ TEST_F(AppendRequestTest, ShouldAddStatAppendFail) {
   }
 }
 
+TEST_F(AppendRequestTest, SlowAppendReportedAsFailed) {
+  using namespace std::chrono_literals;
+  init(1, 1);
+  auto request = create(logid_t(1));
+
+  // disabled by default
+  EXPECT_FALSE(isSlowAppend(request.get(), Status::OK, 1h));
+
+  request->settings_.sequencer_boycotting.node_stats_slow_append_threshold =
+      100ms;
+  EXPECT_FALSE(isSlowAppend(request.get(), Status::OK, 100ms));
+  EXPECT_TRUE(isSlowAppend(request.get(), Status::OK, 101ms));
+  // failed appends are reported as failed anyway
+  EXPECT_FALSE(isSlowAppend(request.get(), Status::TIMEDOUT, 1s));
+}
+
 TEST_F(AppendRequestTest, E2ETracing) {
   init(1, 1);
 
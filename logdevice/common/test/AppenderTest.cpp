@@ -112,6 +112,11 @@ class AppenderTest : public ::testing::Test {
   copyset_size_t replication_{3};
   copyset_size_t extras_{2};
   copyset_size_t synced_{0};
+  copyset_size_t hedged_copies_{0};
+  bool streaming_ingest_{false};
+
+  // set when the Appender asks for PeriodicReleases to be scheduled
+  bool periodic_releases_scheduled_{false};
 
   // Used by tests to determine what the next calls to
   // bytesPendingLimitReached() should return.
@@ -502,6 +507,13 @@ class AppenderTest::MockAppender : public Appender {
   copyset_size_t getSynced() const override {
     return test_->synced_;
   }
+  copyset_size_t getHedgedCopies() const override {
+    return test_->hedged_copies_;
+  }
+  bool isStreamingIngest() const override {
+    return test_->streaming_ingest_;
+  }
+  void noteAppendCompleted(std::chrono::microseconds /*latency*/) override {}
   int link() override {
     return test_->activeAppenders_.map.insert(*this);
   }
@@ -655,7 +667,9 @@ class AppenderTest::MockAppender : public Appender {
     test_->reply_ = replyhdr;
   }
 
-  void schedulePeriodicReleases() override {}
+  void schedulePeriodicReleases() override {
+    test_->periodic_releases_scheduled_ = true;
+  }
 
   bool epochMetaDataAvailable(epoch_t /*epoch*/) const override {
     return true;
@@ -1387,6 +1401,68 @@ TEST_F(AppenderTest, NotEnoughExtras) {
   CHECK_RELEASE_MSG(N1S0, N2S0, N7S0);
 }
 
+// While a node of the nodeset is graylisted, the first wave goes to
+// hedged_copies_ additional nodes.
+TEST_F(AppenderTest, HedgedStores) {
+  extras_ = 0;
+  hedged_copies_ = 2;
+  updateConfig();
+  first_candidate_idx_ = 0;
+  SET_NOT_AVAILABLE(SLOW, N8S0);
+  start();
+
+  CHECK_STORE_MSG_AND_TRIGGER_ON_SENT(E::OK, 1, N0S0, N1S0, N2S0, N3S0, N4S0);
+  CHECK_NO_STORE_MSG();
+  ON_STORED_SENT(E::OK, 1, N0S0, N1S0, N3S0);
+  CHECK_APPENDED(E::OK);
+  CHECK_DELETE_MSG(N2S0, N4S0);
+  ASSERT_TRUE(retired_);
+  Appender::Reaper()(appender_);
+  CHECK_RELEASE_MSG(N0S0, N1S0, N3S0);
+}
+
+// Without graylisted nodes, hedged copies are not sent.
+TEST_F(AppenderTest, HedgedStoresNoStragglers) {
+  extras_ = 0;
+  hedged_copies_ = 2;
+  updateConfig();
+  first_candidate_idx_ = 0;
+  start();
+
+  CHECK_STORE_MSG_AND_TRIGGER_ON_SENT(E::OK, 1, N0S0, N1S0, N2S0);
+  CHECK_NO_STORE_MSG();
+  ON_STORED_SENT(E::OK, 1, N0S0, N1S0, N2S0);
+  CHECK_APPENDED(E::OK);
+  CHECK_NO_DELETE_MSG();
+  ASSERT_TRUE(retired_);
+  Appender::Reaper()(appender_);
+  CHECK_RELEASE_MSG(N0S0, N1S0, N2S0);
+}
+
+// In streaming ingest mode, STOREs tell storage nodes not to cache the record
+// and the record is released by PeriodicReleases rather than by the Appender.
+TEST_F(AppenderTest, StreamingIngest) {
+  streaming_ingest_ = true;
+  updateConfig();
+  first_candidate_idx_ = 0;
+  start();
+
+  for (const auto& kv : store_msgs_) {
+    EXPECT_TRUE(getHeader(kv.second.get()).flags &
+                STORE_Header::NO_RECORD_CACHE);
+  }
+  CHECK_STORE_MSG(1, N4S0);
+  CHECK_STORE_MSG_AND_TRIGGER_ON_SENT(E::OK, 1, N0S0, N1S0, N2S0, N3S0);
+  CHECK_NO_STORE_MSG();
+  ON_STORED_SENT(E::OK, 1, N0S0, N1S0, N3S0);
+  CHECK_APPENDED(E::OK);
+  ASSERT_TRUE(retired_);
+  CHECK_DELETE_MSG(N2S0, N4S0);
+  Appender::Reaper()(appender_);
+  CHECK_NO_RELEASE_MSG();
+  EXPECT_TRUE(periodic_releases_scheduled_);
+}
+
 // Check that Appender will try again after the store timeout if it fails to
 // send a complete wave because not enough destinations are available.
 TEST_F(AppenderTest, NotEnoughDestinationsRetry) {
@@ -9,8 +9,12 @@
 
 #include <random>
 
+#include <folly/Format.h>
 #include <folly/Memory.h>
+#include <folly/Varint.h>
 #include <gtest/gtest.h>
+#include <zdict.h>
+#include <zstd.h>
 
 #include "logdevice/common/DataRecordOwnsPayload.h"
 #include "logdevice/common/Processor.h"
@@ -23,6 +27,7 @@
 #include "logdevice/common/settings/Settings.h"
 #include "logdevice/common/settings/util.h"
 #include "logdevice/common/test/TestUtil.h"
+#include "logdevice/include/BufferedWriteDecoder.h"
 
 /**
  * @file Unit tests for BufferedWriter.  Outgoing (batched) appends are
@@ -154,20 +159,8 @@ class TestAppendSink : public BufferedWriterAppendSink {
 
   // Passes the result of getFlushedBlobs() through BufferedWriteDecoder
   std::vector<std::string> getFlushedOriginalPayloads(logid_t log) {
-    // BufferedWriterDecoder needs DataRecordOwnsPayload instances like those
-    // that would arrive in RECORD messages
-    std::vector<std::unique_ptr<DataRecord>> blob_payloads;
-    lsn_t lsn = 1;
-    for (const std::string& blob : getFlushedBlobs(log)) {
-      void* buf = malloc(blob.size());
-      memcpy(buf, blob.data(), blob.size());
-      blob_payloads.push_back(std::make_unique<DataRecordOwnsPayload>(
-          log,
-          Payload(buf, blob.size()),
-          lsn++,
-          std::chrono::milliseconds(0),
-          RECORD_flags_t(RECORD_Header::BUFFERED_WRITER_BLOB)));
-    }
+    std::vector<std::unique_ptr<DataRecord>> blob_payloads =
+        getFlushedRecords(log);
     const size_t nread = blob_payloads.size();
 
     BufferedWriteDecoderImpl decoder;
@@ -186,9 +179,44 @@ class TestAppendSink : public BufferedWriterAppendSink {
     for (Payload p : payloads) {
       rv.emplace_back(p.toString());
     }
+
+    // The bulk API must produce the same records.
+    BufferedWriteDecoderImpl batch_decoder;
+    std::vector<BufferedWriteDecoder::RecordView> views;
+    blob_payloads = getFlushedRecords(log);
+    EXPECT_EQ(0, batch_decoder.decodeBatch(std::move(blob_payloads), views));
+    EXPECT_EQ(std::vector<std::unique_ptr<DataRecord>>(nread), blob_payloads);
+    EXPECT_EQ(rv.size(), views.size());
+    for (size_t i = 0; i < std::min(rv.size(), views.size()); ++i) {
+      EXPECT_EQ(rv[i], views[i].payload.toString());
+      if (i > 0 && views[i].attrs.lsn == views[i - 1].attrs.lsn) {
+        EXPECT_EQ(views[i - 1].attrs.batch_offset + 1,
+                  views[i].attrs.batch_offset);
+      } else {
+        EXPECT_EQ(0, views[i].attrs.batch_offset);
+      }
+    }
     return rv;
   }
 
+  // Wraps the result of getFlushedBlobs() into DataRecordOwnsPayload
+  // instances like those that would arrive in RECORD messages
+  std::vector<std::unique_ptr<DataRecord>> getFlushedRecords(logid_t log) {
+    std::vector<std::unique_ptr<DataRecord>> records;
+    lsn_t lsn = 1;
+    for (const std::string& blob : getFlushedBlobs(log)) {
+      void* buf = malloc(blob.size());
+      memcpy(buf, blob.data(), blob.size());
+      records.push_back(std::make_unique<DataRecordOwnsPayload>(
+          log,
+          Payload(buf, blob.size()),
+          lsn++,
+          std::chrono::milliseconds(0),
+          RECORD_flags_t(RECORD_Header::BUFFERED_WRITER_BLOB)));
+    }
+    return records;
+  }
+
   // Return true if append should succeed
   std::function<bool()> pre_append_callback_;
 
@@ -384,6 +412,18 @@ TEST_F(BufferedWriterTest, ExplicitFlushIndependentUseBackgroundThread) {
   this->explicitFlushTest(BufferedWriter::Options::Mode::INDEPENDENT, 1000);
 }
 
+// Batches that find the queue of background threads full wait for room and
+// still go out in order.
+TEST_F(BufferedWriterTest, ExplicitFlushBackgroundQueueFull) {
+  Settings settings = create_default_settings<Settings>();
+  settings.buffered_writer_bg_thread_bytes_threshold = 1;
+  settings.num_processor_background_threads = 1;
+  settings.background_queue_size = 1;
+  initProcessor(settings);
+
+  this->explicitFlushTest(BufferedWriter::Options::Mode::INDEPENDENT, 1000);
+}
+
 TEST_F(BufferedWriterTest, ExplicitFlushOneAtATimeUseBackgroundThread) {
   Settings settings = create_default_settings<Settings>();
   settings.buffered_writer_bg_thread_bytes_threshold = 1;
@@ -490,6 +530,73 @@ TEST_F(BufferedWriterTest, RoundTripLZ4NotCompressible) {
   this->roundTripTest(Compression::LZ4, false);
 }
 
+// Batches compressed with a ZSTD dictionary decode once the dictionary is
+// registered.
+TEST_F(BufferedWriterTest, RoundTripZstdDictionary) {
+  auto gen_payload = [](int i) {
+    return folly::sformat(
+        "{{\"user_id\": {}, \"event\": \"{}\", \"ts\": {}}}",
+        i * 7919 % 100000,
+        i % 3 == 0 ? "click" : "view",
+        1500000000 + i);
+  };
+
+  std::string samples;
+  std::vector<size_t> sample_sizes;
+  for (int i = 0; i < 5000; ++i) {
+    std::string sample = gen_payload(1000000 + i);
+    samples += sample;
+    sample_sizes.push_back(sample.size());
+  }
+  std::string dictionary(4096, '\0');
+  size_t dict_size = ZDICT_trainFromBuffer(&dictionary[0],
+                                           dictionary.size(),
+                                           samples.data(),
+                                           sample_sizes.data(),
+                                           sample_sizes.size());
+  ASSERT_FALSE(ZDICT_isError(dict_size)) << ZDICT_getErrorName(dict_size);
+  dictionary.resize(dict_size);
+
+  ASSERT_EQ(-1, BufferedWriteDecoder::registerZstdDictionary("not a dict"));
+  ASSERT_EQ(E::INVALID_PARAM, err);
+  ASSERT_EQ(0, BufferedWriteDecoder::registerZstdDictionary(dictionary));
+
+  TestCallback cb;
+  BufferedWriter::Options opts;
+  opts.compression = Compression::ZSTD;
+  opts.zstd_dictionary = std::make_shared<const std::string>(dictionary);
+  auto writer = this->createWriter(&cb, opts);
+  const logid_t LOG_ID(1);
+
+  std::vector<std::string> orig_payloads;
+  for (int nbatch = 0; nbatch < 10; ++nbatch) {
+    for (int i = 0; i < 30; ++i) {
+      std::string str = gen_payload(nbatch * 30 + i);
+      orig_payloads.push_back(str);
+      ASSERT_EQ(0, writer->append(LOG_ID, std::move(str), NULL_CONTEXT));
+    }
+    writer->flushAll();
+  }
+
+  std::vector<std::string> read_payloads;
+  wait_until("BufferedWriter has flushed everything", [&]() {
+    read_payloads = sink_->getFlushedOriginalPayloads(LOG_ID);
+    return read_payloads.size() == orig_payloads.size() &&
+        orig_payloads.size() == cb.getNumSucceeded();
+  });
+  ASSERT_EQ(orig_payloads, read_payloads);
+
+  for (const std::string& blob : sink_->getFlushedBlobs(LOG_ID)) {
+    // Skip the marker and flags bytes and the batch size and uncompressed size
+    // varints.
+    folly::ByteRange range((const uint8_t*)blob.data() + 2, blob.size() - 2);
+    folly::decodeVarint(range);
+    folly::decodeVarint(range);
+    EXPECT_EQ(ZSTD_getDictID_fromDict(dictionary.data(), dictionary.size()),
+              ZSTD_getDictID_fromFrame(range.data(), range.size()));
+  }
+}
+
 // Test Options::size_trigger.
 TEST_F(BufferedWriterTest, SizeTrigger) {
   TestCallback cb;
@@ -15,6 +15,7 @@
 #include "logdevice/common/client_read_stream/ClientReadStream.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamBufferFactory.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamCircularBuffer.h"
+#include "logdevice/common/client_read_stream/ClientReadStreamHybridBuffer.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamOrderedMapBuffer.h"
 #include "logdevice/include/types.h"
 
@@ -39,11 +40,7 @@ class ClientReadStreamBufferTest
     : public ::testing::TestWithParam<ClientReadStreamBufferType> {
  public:
   virtual void SetUp() {
-    if (GetParam() == ClientReadStreamBufferType::CIRCULAR) {
-      buf = std::make_unique<ClientReadStreamCircularBuffer>(10, 100);
-    } else {
-      buf = std::make_unique<ClientReadStreamOrderedMapBuffer>(10, 100);
-    }
+    buf = ClientReadStreamBufferFactory::create(GetParam(), 10, 100);
   }
   std::unique_ptr<ClientReadStreamBuffer> buf;
 };
@@ -59,8 +56,8 @@ TEST_P(ClientReadStreamBufferTest, ForEachForward) {
 }
 
 TEST_P(ClientReadStreamBufferTest, ForEachWithHoles) {
-  // holes are only supported in ordered map
-  if (GetParam() != ClientReadStreamBufferType::ORDERED_MAP) {
+  // holes are only supported in ordered map and hybrid
+  if (GetParam() == ClientReadStreamBufferType::CIRCULAR) {
     return;
   }
   auto reset_buffer = [&]() {
@@ -122,8 +119,8 @@ TEST_P(ClientReadStreamBufferTest, ForEachBackward2) {
 TEST_P(ClientReadStreamBufferTest, ForEachForwardEmpty) {
   Collector collector;
   buf->forEach(100, 102, std::ref(collector));
-  if (GetParam() == ClientReadStreamBufferType::ORDERED_MAP) {
-    // Ordered map only returns actual entries
+  if (GetParam() != ClientReadStreamBufferType::CIRCULAR) {
+    // Ordered map and hybrid only return actual entries
     // but since the map is empty, it should not return anything
     ASSERT_COLLECTED(collector);
   } else {
@@ -135,8 +132,8 @@ TEST_P(ClientReadStreamBufferTest, ForEachForwardEmpty) {
 TEST_P(ClientReadStreamBufferTest, ForEachBackwardEmpty) {
   Collector collector;
   buf->forEach(102, 100, std::ref(collector));
-  if (GetParam() == ClientReadStreamBufferType::ORDERED_MAP) {
-    // Ordered map only returns actual entries
+  if (GetParam() != ClientReadStreamBufferType::CIRCULAR) {
+    // Ordered map and hybrid only return actual entries
     // but since the map is empty, it should not return anything
     ASSERT_COLLECTED(collector);
   } else {
@@ -145,10 +142,73 @@ TEST_P(ClientReadStreamBufferTest, ForEachBackwardEmpty) {
   ASSERT_TRUE(true);
 }
 
+// A chunk of the hybrid buffer is promoted to dense once it holds more than
+// SPARSE_SLOTS descriptors, and freed once they are all removed. Descriptors
+// don't move in the process.
+TEST(ClientReadStreamHybridBufferTest, Promotion) {
+  using Buffer = ClientReadStreamHybridBuffer;
+  const size_t chunk = Buffer::CHUNK_SIZE;
+  const lsn_t head = 5 * chunk;
+  Buffer buf(4 * chunk, head);
+  ASSERT_EQ(0, buf.numChunks());
+
+  // One descriptor in each of the first 3 chunks.
+  buf.createOrGet(head + 3);
+  buf.createOrGet(head + chunk + 1);
+  buf.createOrGet(head + 2 * chunk);
+  ASSERT_EQ(3, buf.numChunks());
+  ASSERT_EQ(0, buf.numDenseChunks());
+  // Outside of the buffer.
+  ASSERT_EQ(nullptr, buf.createOrGet(head + 4 * chunk));
+  ASSERT_EQ(nullptr, buf.createOrGet(head - 1));
+
+  std::vector<ClientReadStreamRecordState*> rstates;
+  for (size_t i = 0; i < Buffer::SPARSE_SLOTS + 2; ++i) {
+    rstates.push_back(buf.createOrGet(head + chunk + 2 + i));
+    rstates.back()->gap = true;
+  }
+  ASSERT_EQ(1, buf.numDenseChunks());
+  for (size_t i = 0; i < rstates.size(); ++i) {
+    ASSERT_EQ(rstates[i], buf.find(head + chunk + 2 + i));
+  }
+
+  Collector collector;
+  buf.forEach(head + 2 * chunk, head, std::ref(collector));
+  ASSERT_COLLECTED(collector,
+                   head + 2 * chunk,
+                   head + chunk + 7,
+                   head + chunk + 6,
+                   head + chunk + 5,
+                   head + chunk + 4,
+                   head + chunk + 3,
+                   head + chunk + 2,
+                   head + chunk + 1,
+                   head + 3);
+
+  // forEach() removed the empty descriptors, only the gap markers are left.
+  ASSERT_EQ(1, buf.numChunks());
+  ASSERT_EQ(std::make_pair(rstates[0], head + chunk + 2),
+            buf.findFirstMarker());
+  for (auto rstate : rstates) {
+    rstate->gap = false;
+  }
+  buf.forEachUpto(head + 2 * chunk, std::ref(collector));
+  ASSERT_EQ(0, buf.numChunks());
+
+  // The buffer head can move past chunks that were freed.
+  buf.advanceBufferHead(3 * chunk);
+  ASSERT_EQ(nullptr, buf.front());
+  buf.createOrGet(head + 3 * chunk)->gap = true;
+  ASSERT_NE(nullptr, buf.front());
+  buf.popFront();
+  ASSERT_EQ(0, buf.numChunks());
+}
+
 INSTANTIATE_TEST_CASE_P(
     ClientReadStreamBufferTest,
     ClientReadStreamBufferTest,
     ::testing::Values(ClientReadStreamBufferType::CIRCULAR,
-                      ClientReadStreamBufferType::ORDERED_MAP));
+                      ClientReadStreamBufferType::ORDERED_MAP,
+                      ClientReadStreamBufferType::HYBRID));
 
 }} // namespace facebook::logdevice
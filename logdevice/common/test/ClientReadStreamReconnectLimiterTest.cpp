@@ -0,0 +1,47 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/client_read_stream/ClientReadStreamReconnectLimiter.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+using std::chrono::milliseconds;
+
+namespace {
+
+TEST(ClientReadStreamReconnectLimiterTest, Unlimited) {
+  ClientReadStreamReconnectLimiter limiter;
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(milliseconds(0), limiter.reserve(1, RATE_UNLIMITED));
+  }
+}
+
+TEST(ClientReadStreamReconnectLimiterTest, PacesEachNode) {
+  ClientReadStreamReconnectLimiter limiter;
+  const rate_limit_t limit(10, std::chrono::seconds(100));
+
+  // A burst of reconnects up to the budget goes through right away. The
+  // budget may go negative, so that's 11 of them.
+  for (int i = 0; i < 11; ++i) {
+    EXPECT_EQ(milliseconds(0), limiter.reserve(1, limit));
+  }
+  // The next ones wait for their turn, 10s apart.
+  milliseconds first = limiter.reserve(1, limit);
+  milliseconds second = limiter.reserve(1, limit);
+  EXPECT_GT(first, milliseconds(0));
+  EXPECT_LE(first, milliseconds(10000));
+  EXPECT_GE(second - first, milliseconds(9000));
+
+  // Other nodes have their own budget.
+  EXPECT_EQ(milliseconds(0), limiter.reserve(2, limit));
+
+  // A new budget takes effect right away.
+  EXPECT_EQ(milliseconds(0), limiter.reserve(1, rate_limit_t(5, limit.second)));
+}
+
+} // namespace
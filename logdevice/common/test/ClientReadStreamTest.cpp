@@ -8,6 +8,7 @@
 #include "logdevice/common/client_read_stream/ClientReadStream.h"
 
 #include <functional>
+#include <limits>
 #include <map>
 #include <memory>
 #include <unordered_map>
@@ -176,6 +177,13 @@ struct TestState {
   bool callbacks_accepting = true;
   bool disposed = false;
 
+  // If nonzero, records are delivered in batches of up to this many, and
+  // the sizes of the batches go into `batches`. Batch callbacks consume at
+  // most `batch_records_accepting` records.
+  size_t record_batch_size = 0;
+  size_t batch_records_accepting = std::numeric_limits<size_t>::max();
+  std::vector<size_t> batches;
+
   // default metadata to be delivered when epoch metadata is requested
   EpochMetaData default_metadata;
   // If set, deps_->getMetaDataForEpoch() will be a no-op and tests are
@@ -199,6 +207,9 @@ struct TestState {
   // Protocol version overrides for sockets to servers
   std::unordered_map<node_index_t, uint16_t> protos;
 
+  // Returned by deps_->reserveReconnect().
+  std::chrono::milliseconds reconnect_delay{0};
+
   EventLogRebuildingSet rebuilding_set;
 
   bool nodes_may_send_shard_status_update_message = true;
@@ -211,6 +222,8 @@ struct TestState {
   std::vector<CacheEntry> cache_entries_;
 
   bool has_memory_pressure = false;
+  // Sum of the deltas passed to onBufferedBytesChanged().
+  int64_t buffered_bytes = 0;
   std::unordered_map<ShardID, ClientReadStreamSenderState, ShardID::Hash>*
       storage_set_states;
 };
@@ -295,7 +308,8 @@ class MockClientReadStreamDependencies : public ClientReadStreamDependencies {
 
   int sendWindowMessage(ShardID shard,
                         lsn_t window_low,
-                        lsn_t window_high) override {
+                        lsn_t window_high,
+                        std::chrono::microseconds /*max_delay*/) override {
     EXPECT_LE(window_low, window_high);
     state_.window.push_back(WindowMessage{shard, window_low, window_high});
     return 0;
@@ -306,6 +320,21 @@ class MockClientReadStreamDependencies : public ClientReadStreamDependencies {
     return state_.callbacks_accepting;
   }
 
+  size_t getMaxRecordBatchSize() const override {
+    return state_.record_batch_size;
+  }
+
+  size_t batchRecordCallback(
+      std::vector<std::unique_ptr<DataRecord>>& records) override {
+    state_.batches.push_back(records.size());
+    for (const auto& record : records) {
+      state_.recv.push_back(record->attrs.lsn);
+    }
+    return state_.callbacks_accepting
+        ? std::min(records.size(), state_.batch_records_accepting)
+        : 0;
+  }
+
   bool gapCallback(const GapRecord& gap) override {
     state_.gap.push_back(GapMessage{gap.type, gap.lo, gap.hi});
     return state_.callbacks_accepting;
@@ -333,8 +362,12 @@ class MockClientReadStreamDependencies : public ClientReadStreamDependencies {
   }
 
   std::unique_ptr<Timer>
-  createTimer(std::function<void()> /*cb*/ = nullptr) override {
-    return std::make_unique<MockTimer>();
+  createTimer(std::function<void()> cb = nullptr) override {
+    return std::make_unique<MockTimer>(std::move(cb));
+  }
+
+  std::chrono::milliseconds reserveReconnect(ShardID /*shard*/) override {
+    return state_.reconnect_delay;
   }
 
   TimeoutMap* getCommonTimeouts() override {
@@ -373,6 +406,10 @@ class MockClientReadStreamDependencies : public ClientReadStreamDependencies {
     return state_.has_memory_pressure;
   }
 
+  void onBufferedBytesChanged(int64_t delta) override {
+    state_.buffered_bytes += delta;
+  }
+
  private:
   ClientReadStream* client_read_stream_ = nullptr;
   TestState& state_;
@@ -506,6 +543,12 @@ class ClientReadStreamTest
     return read_stream_->reconnectTimerIsActive(shard);
   }
 
+  void triggerReconnectPacingTimer(ShardID shard) {
+    auto& state = read_stream_->storage_set_states_.at(shard);
+    ASSERT_NE(nullptr, state.reconnect_pacing_timer_);
+    static_cast<MockTimer&>(*state.reconnect_pacing_timer_).trigger();
+  }
+
   void fireReadMetadataRetryTimer() {
     ASSERT_NE(nullptr, read_stream_->retry_read_metadata_);
     ASSERT_TRUE(read_stream_->retry_read_metadata_->isActive());
@@ -595,6 +638,11 @@ class ClientReadStreamTest
     read_stream_->scd_->all_send_all_failover_timer_.callback();
   }
 
+  void scdRewindWithOutliers(ShardSet outliers) {
+    ld_check(read_stream_->scd_);
+    read_stream_->scd_->rewindWithOutliers(std::move(outliers), "test");
+  }
+
   void assertNoRewindScheduled() {
     ASSERT_FALSE(read_stream_->rewindScheduled());
   }
@@ -869,7 +917,8 @@ INSTANTIATE_TEST_CASE_P(
     ClientReadStreamTest,
     ClientReadStreamTest,
     ::testing::Values(ClientReadStreamBufferType::CIRCULAR,
-                      ClientReadStreamBufferType::ORDERED_MAP));
+                      ClientReadStreamBufferType::ORDERED_MAP,
+                      ClientReadStreamBufferType::HYBRID));
 
 /**
  * Simple test where records come in order from different nodes.
@@ -1219,6 +1268,31 @@ TEST_P(ClientReadStreamTest, DynamicWindowScaling) {
   ASSERT_NO_WINDOW_MESSAGES();
 }
 
+/**
+ * The payload bytes held in the buffer are reported to the dependencies, which
+ * account for them against --client-read-buffer-memory-budget.
+ */
+TEST_P(ClientReadStreamTest, BufferedBytes) {
+  buffer_size_ = 10;
+  start();
+
+  onDataRecord(N0, mockRecord(lsn(1, 2)));
+  onDataRecord(N0, mockRecord(lsn(1, 3)));
+  // Copies of a record already buffered are dropped.
+  onDataRecord(N1, mockRecord(lsn(1, 3)));
+  ASSERT_RECV();
+  ASSERT_EQ(8, state_.buffered_bytes);
+
+  onDataRecord(N1, mockRecord(lsn(1, 1)));
+  ASSERT_RECV(lsn(1, 1), lsn(1, 2), lsn(1, 3));
+  ASSERT_EQ(0, state_.buffered_bytes);
+
+  onDataRecord(N0, mockRecord(lsn(1, 5)));
+  ASSERT_EQ(4, state_.buffered_bytes);
+  read_stream_.reset();
+  ASSERT_EQ(0, state_.buffered_bytes);
+}
+
 /**
  * Receiving the same LSN from the same node more than once should not be an
  * issue.  This can happen when:
@@ -3030,6 +3104,28 @@ TEST_P(ClientReadStreamTest, ScdOnCloseCallback) {
   ASSERT_GAP_MESSAGES();
 }
 
+// A reconnect that is over the budget of the storage node waits for its turn
+// before sending START.
+TEST_P(ClientReadStreamTest, ReconnectWaitsForItsTurn) {
+  state_.shards.resize(2);
+  start();
+  state_.start.clear();
+
+  onDataRecord(N0, mockRecord(lsn(1, 1)));
+  ASSERT_RECV(lsn(1, 1));
+
+  state_.reconnect_delay = std::chrono::milliseconds(100);
+  (*state_.on_close[N1])(E::PEER_CLOSED, Address(NodeID(N1.node())));
+  reconnectTimerCallback(N1);
+  ASSERT_NO_START_MESSAGES();
+  ASSERT_TRUE(reconnectTimerIsActive(N1));
+
+  triggerReconnectPacingTimer(N1);
+  ASSERT_EQ(1, state_.start.size());
+  EXPECT_EQ(N1, state_.start[0].dest);
+  EXPECT_EQ(lsn(1, 2), state_.start[0].start_lsn);
+}
+
 // Check that if the socket for a node closes while all the other nodes are in
 // the known down list, we failover to all send all mode.
 TEST_P(ClientReadStreamTest, ScdOnCloseCallbackFailoverToAllSendAll) {
@@ -3650,6 +3746,97 @@ TEST_P(ClientReadStreamTest, ScdFailoverToAllSendAllWhenRebuildingNodes) {
 // In this test, we exercise the failover mechanism that happens where a call to
 // sendStartMessage() fails synchronously instead of being an asynchronous error
 // reported by onStartSent().
+// With --reader-slow-shards-partial-failover, adding a slow shard to the
+// filtered out list keeps the buffered records, and senders are not asked to
+// ship again what was shipped below the first LSN the slow shards may not have
+// shipped yet.
+TEST_P(ClientReadStreamTest, ScdSlowShardPartialFailover) {
+  state_.shards.resize(4);
+  buffer_size_ = 30;
+  replication_factor_ = 2;
+  scd_enabled_ = true;
+  state_.settings.reader_slow_shards_partial_failover = true;
+  start();
+
+  lsn_t buffer_max = calc_buffer_max(start_lsn_, buffer_size_);
+  ASSERT_START_MESSAGES(lsn_t(start_lsn_),
+                        LSN_MAX,
+                        buffer_max,
+                        filter_version_t{1},
+                        true,
+                        small_shardset_t{},
+                        N0,
+                        N1,
+                        N2,
+                        N3);
+  ON_STARTED(filter_version_t{1}, N0, N1, N2, N3);
+
+  onDataRecord(N0, mockRecord(lsn(1, 1)));
+  onDataRecord(N1, mockRecord(lsn(1, 2)));
+  onDataRecord(N2, mockRecord(lsn(1, 3)));
+  onDataRecord(N0, mockRecord(lsn(1, 4)));
+  onDataRecord(N2, mockRecord(lsn(1, 6)));
+  onDataRecord(N2, mockRecord(lsn(1, 7)));
+  onDataRecord(N3, mockRecord(lsn(1, 8)));
+  ASSERT_RECV(lsn(1, 1), lsn(1, 2), lsn(1, 3), lsn(1, 4));
+
+  // N1 is slow and holds record 5 back. It is what holds the stream back, so
+  // all shards restart from record 5.
+  scdRewindWithOutliers({N1});
+  triggerScheduledRewind();
+  ASSERT_START_MESSAGES(lsn(1, 5),
+                        LSN_MAX,
+                        buffer_max,
+                        filter_version_t{2},
+                        true,
+                        small_shardset_t{N1},
+                        N0,
+                        N1,
+                        N2,
+                        N3);
+  ON_STARTED(filter_version_t{2}, N0, N1, N2, N3);
+
+  // Records 6-8 were kept, they are delivered as soon as N3 ships record 5 in
+  // place of N1. Copies shipped again are discarded.
+  onDataRecord(N3, mockRecord(lsn(1, 5)));
+  ASSERT_RECV(lsn(1, 5), lsn(1, 6), lsn(1, 7), lsn(1, 8));
+  onDataRecord(N2, mockRecord(lsn(1, 6)));
+  onDataRecord(N2, mockRecord(lsn(1, 7)));
+  onDataRecord(N3, mockRecord(lsn(1, 8)));
+  ASSERT_RECV();
+
+  onDataRecord(N2, mockRecord(lsn(1, 10)));
+  onDataRecord(N3, mockRecord(lsn(1, 12)));
+  ASSERT_RECV();
+
+  // N3 is slow as well but shipped everything it had to up to record 12.
+  // Shards that are ahead of that restart from record 13, N2 only has to ship
+  // again from where it was.
+  state_.start.clear();
+  scdRewindWithOutliers({N1, N3});
+  triggerScheduledRewind();
+  std::map<ShardID, lsn_t> start_lsns;
+  for (const auto& msg : state_.start) {
+    start_lsns[msg.dest] = msg.start_lsn;
+    ASSERT_EQ(filter_version_t{3}, msg.filter_version);
+    auto filtered_out = msg.filtered_out;
+    std::sort(filtered_out.begin(), filtered_out.end());
+    ASSERT_EQ(small_shardset_t({N1, N3}), filtered_out);
+  }
+  ASSERT_EQ((std::map<ShardID, lsn_t>{{N0, lsn(1, 9)},
+                                      {N1, lsn(1, 9)},
+                                      {N2, lsn(1, 11)},
+                                      {N3, lsn(1, 13)}}),
+            start_lsns);
+  state_.start.clear();
+  ON_STARTED(filter_version_t{3}, N0, N1, N2, N3);
+
+  // Record 10 was kept.
+  onDataRecord(N0, mockRecord(lsn(1, 9)));
+  onDataRecord(N0, mockRecord(lsn(1, 11)));
+  ASSERT_RECV(lsn(1, 9), lsn(1, 10), lsn(1, 11), lsn(1, 12));
+}
+
 TEST_P(ClientReadStreamTest, ScdFailoverWhenSendStartFails) {
   state_.shards.resize(4);
   buffer_size_ = 10;
@@ -4932,6 +5119,51 @@ TEST_P(ClientReadStreamTest, Redelivery) {
   ASSERT_WINDOW_MESSAGES(lsn(1, 5), lsn(1, 6), N0);
 }
 
+// With a batch record callback, records available at once are delivered
+// together, and the part of a batch the callback doesn't consume is
+// redelivered before anything else.
+TEST_P(ClientReadStreamTest, BatchRecordCallback) {
+  state_.shards.resize(1);
+  buffer_size_ = 10;
+  state_.record_batch_size = 3;
+  start();
+
+  onDataRecord(N0, mockRecord(lsn(1, 1)));
+  ASSERT_RECV(lsn(1, 1));
+  ASSERT_EQ(std::vector<size_t>({1}), state_.batches);
+  state_.batches.clear();
+
+  onDataRecord(N0, mockRecord(lsn(1, 3)));
+  onDataRecord(N0, mockRecord(lsn(1, 4)));
+  onDataRecord(N0, mockRecord(lsn(1, 5)));
+  onDataRecord(N0, mockRecord(lsn(1, 6)));
+  ASSERT_RECV();
+  onDataRecord(N0, mockRecord(lsn(1, 2)));
+  ASSERT_RECV(lsn(1, 2), lsn(1, 3), lsn(1, 4), lsn(1, 5), lsn(1, 6));
+  ASSERT_EQ(std::vector<size_t>({3, 2}), state_.batches);
+  state_.batches.clear();
+
+  // The callback only consumes the first record of the next batch.
+  state_.batch_records_accepting = 1;
+  onDataRecord(N0, mockRecord(lsn(1, 8)));
+  onDataRecord(N0, mockRecord(lsn(1, 9)));
+  onDataRecord(N0, mockRecord(lsn(1, 7)));
+  ASSERT_RECV(lsn(1, 7), lsn(1, 8), lsn(1, 9));
+  ASSERT_TRUE(getRedeliveryTimer()->isActive());
+
+  // Nothing is delivered past the rest of the batch until it's consumed.
+  onGap(N0, mockGap(N0, lsn(1, 10), lsn(1, 10), GapReason::TRIM));
+  ASSERT_RECV();
+  ASSERT_GAP_MESSAGES();
+
+  state_.batch_records_accepting = std::numeric_limits<size_t>::max();
+  dynamic_cast<MockBackoffTimer*>(getRedeliveryTimer())->trigger();
+  ASSERT_RECV(lsn(1, 8), lsn(1, 9));
+  ASSERT_GAP_MESSAGES(GapMessage{GapType::TRIM, lsn(1, 10), lsn(1, 10)});
+  ASSERT_FALSE(getRedeliveryTimer()->isActive());
+  ASSERT_EQ(std::vector<size_t>({3, 2}), state_.batches);
+}
+
 // If callbacks reject data, but client receives a TRIM gap in the meantime,
 // it should still redeliver the record.
 TEST_P(ClientReadStreamTest, NoFastForwardWhileRedelivering) {
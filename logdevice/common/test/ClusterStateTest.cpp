@@ -0,0 +1,52 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/ClusterState.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+
+TEST(ClusterStateTest, Snapshot) {
+  // Without a failure detector, nodes start alive.
+  ClusterState cs(100, nullptr);
+  auto initial = cs.getSnapshot();
+  ASSERT_NE(nullptr, initial);
+  EXPECT_EQ(100, initial->size());
+  EXPECT_EQ(100, initial->numAliveNodes());
+  EXPECT_TRUE(initial->isNodeAvailable(99));
+  EXPECT_FALSE(initial->isNodeAlive(100));
+
+  cs.setNodeState(3, ClusterState::NodeState::DEAD);
+  cs.setNodeState(70, ClusterState::NodeState::FAILING_OVER);
+  auto snapshot = cs.getSnapshot();
+  EXPECT_GT(snapshot->version(), initial->version());
+  EXPECT_EQ(98, snapshot->numAliveNodes());
+  EXPECT_FALSE(snapshot->isNodeAlive(3));
+  EXPECT_FALSE(snapshot->isNodeAlive(70));
+  EXPECT_TRUE(snapshot->isNodeAlive(4));
+  // Snapshots don't change once published.
+  EXPECT_TRUE(initial->isNodeAlive(3));
+
+  // Setting the same state again doesn't publish a new snapshot.
+  cs.setNodeState(3, ClusterState::NodeState::DEAD);
+  EXPECT_EQ(snapshot->version(), cs.getSnapshot()->version());
+
+  cs.setBoycottedNodes({4, 65});
+  snapshot = cs.getSnapshot();
+  EXPECT_TRUE(snapshot->isNodeBoycotted(4));
+  EXPECT_TRUE(snapshot->isNodeBoycotted(65));
+  EXPECT_FALSE(snapshot->isNodeBoycotted(5));
+  EXPECT_TRUE(snapshot->isNodeAlive(4));
+  EXPECT_FALSE(snapshot->isNodeAvailable(4));
+  EXPECT_TRUE(cs.isNodeBoycotted(65));
+  EXPECT_FALSE(cs.isNodeBoycotted(66));
+
+  cs.setBoycottedNodes({});
+  EXPECT_FALSE(cs.getSnapshot()->isNodeBoycotted(4));
+  EXPECT_FALSE(cs.getSnapshot()->isNodeAlive(3));
+}
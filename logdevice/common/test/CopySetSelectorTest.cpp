@@ -262,6 +262,7 @@ class MockStickyCopySetManager : public StickyCopySetManager {
                              test->nodeset_state_,
                              test->sticky_copysets_block_size_,
                              test->sticky_copysets_block_max_time_,
+                             std::chrono::milliseconds::zero(),
                              &test->deps_) {}
 
  private:
@@ -1249,3 +1250,17 @@ TEST_F(CopySetSelectorTest, RandomLinearIteratorBase) {
     ASSERT_GE(sum, num_entries);
   }
 }
+
+TEST(StickyCopySetManagerTest, TimeUntilAligned) {
+  using namespace std::chrono;
+  const auto alignment = minutes(15);
+  system_clock::time_point boundary(hours(24 * 365 * 48));
+  EXPECT_EQ(milliseconds(alignment),
+            StickyCopySetManager::timeUntilAligned(boundary, alignment));
+  EXPECT_EQ(milliseconds(minutes(5)),
+            StickyCopySetManager::timeUntilAligned(
+                boundary + minutes(10), alignment));
+  EXPECT_EQ(milliseconds(1),
+            StickyCopySetManager::timeUntilAligned(
+                boundary + alignment - milliseconds(1), alignment));
+}
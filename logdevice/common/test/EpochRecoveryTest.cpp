@@ -544,6 +544,47 @@ TEST_F(EpochRecoveryTest, Basic) {
   ASSERT_TRUE(lce_tail_.sameContent(result_.tail));
 }
 
+// the digest of an epoch can be built before the previous epochs are
+// recovered, but it does not complete until the tail record of the previous
+// epoch is known
+TEST_F(EpochRecoveryTest, DigestBeforeActivation) {
+  setUp();
+
+  erm_->activateDigest();
+  ASSERT_TRUE(erm_->isActive());
+  erm_->onSealed(N1, esn_t(1), esn_t(1), 19, folly::none);
+  erm_->onSealed(N2, esn_t(1), esn_t(1), 19, folly::none);
+  checkRecoveryState(ERMState::DIGEST);
+  ASSERT_NODE_STATE(NState::DIGESTING, N1, N2);
+
+  erm_->onMessageSent(N1, MessageType::START, E::OK, read_stream_id_t(1));
+  erm_->onMessageSent(N2, MessageType::START, E::OK, read_stream_id_t(2));
+  erm_->onDigestStreamStarted(N1, read_stream_id_t(1), lsn(epoch_, 1), E::OK);
+  erm_->onDigestStreamStarted(N2, read_stream_id_t(2), lsn(epoch_, 1), E::OK);
+  erm_->onDigestRecord(N1, read_stream_id_t(1), mockRecord(lsn(epoch_, 1), 9));
+  erm_->onDigestRecord(N2, read_stream_id_t(2), mockRecord(lsn(epoch_, 1), 9));
+  erm_->onDigestGap(
+      N1,
+      mockGap(N1, lsn(epoch_, 2), lsn(epoch_, ESN_MAX), read_stream_id_t(1)));
+  erm_->onDigestGap(
+      N2,
+      mockGap(N2, lsn(epoch_, 2), lsn(epoch_, ESN_MAX), read_stream_id_t(2)));
+
+  // the digest has an f-majority, but the previous epoch is not recovered
+  // yet: no grace period, no mutations
+  ASSERT_NODE_STATE(NState::MUTATABLE, N1, N2);
+  ASSERT_FALSE(erm_->getGracePeriodTimer()->isActive());
+  checkRecoveryState(ERMState::DIGEST);
+
+  // previous epoch recovered
+  erm_->activate(prev_tail_);
+  ASSERT_TRUE(erm_->getGracePeriodTimer()->isActive());
+  static_cast<MockTimer*>(erm_->getGracePeriodTimer())->trigger();
+  checkRecoveryState(ERMState::MUTATION);
+  ASSERT_EQ(2, erm_->mutationSetSize());
+  ASSERT_EQ(1, erm_->getMutators().size());
+}
+
 // similar to the basic test, but node changes authoritative status
 // causing state machine to be restarted
 TEST_F(EpochRecoveryTest, RestartWhenAuthoritativeStatusChanges) {
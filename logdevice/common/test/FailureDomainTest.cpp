@@ -359,6 +359,29 @@ TEST_F(FailureDomainTest, FmajorityBasicTest2) {
   }
 }
 
+// isFmajority() with a predicate returns early when too few shards match it,
+// and must not when authoritative empty shards lower the bar.
+TEST_F(FailureDomainTest, FmajorityFewShardsMatchingPredicate) {
+  replication_ = 3;
+  setUp();
+  auto pred = [](TestAttr attr) {
+    return attr == TestAttr::B || attr == TestAttr::C;
+  };
+
+  setShardsAttr(TestAttr::B, {N0});
+  setShardsAttr(TestAttr::C, {N1});
+  ASSERT_EQ(F::NONE, failure_set_->isFmajority(pred));
+
+  setShardsAttr(TestAttr::B, {N2, N3, N4, N5, N6, N7, N8, N9});
+  ASSERT_EQ(F::AUTHORITATIVE_COMPLETE, failure_set_->isFmajority(pred));
+
+  setShardsAttr(TestAttr::A, {N2, N3, N4, N5, N6, N7, N8, N9});
+  ASSERT_EQ(F::NONE, failure_set_->isFmajority(pred));
+  setShardAuthoritativeStatus(AuthoritativeStatus::AUTHORITATIVE_EMPTY,
+                              {N3, N4, N5, N6, N7, N8, N9});
+  ASSERT_EQ(F::AUTHORITATIVE_INCOMPLETE, failure_set_->isFmajority(pred));
+}
+
 TEST_F(FailureDomainTest, CanReplicationTest) {
   replication_ = 3;
   setUp();
@@ -13,6 +13,7 @@
 #include <gtest/gtest.h>
 
 #include "logdevice/common/configuration/LocalLogsConfig.h"
+#include "logdevice/common/protocol/FINDKEY_BATCH_Message.h"
 #include "logdevice/common/protocol/FINDKEY_Message.h"
 #include "logdevice/common/settings/Settings.h"
 #include "logdevice/common/test/MockBackoffTimer.h"
@@ -770,3 +771,181 @@ TEST(FindKeyRequestTest, KeyStatusFailedClientTimeout) {
   FindKeyResult result = {E::FAILED, LSN_INVALID, LSN_INVALID};
   cb.assertCalled(result);
 }
+
+namespace {
+
+// Exercises the batching of findTime() FINDKEYs into FINDKEY_BATCH messages
+// without a Worker: the connection protocol, the flush timer, the sender and
+// the set of running requests are all mocked.
+class MockFindKeyRequestMap : public FindKeyRequestMap {
+ public:
+  using MockSender = SenderTestProxy<MockFindKeyRequestMap>;
+
+  MockFindKeyRequestMap() {
+    sender_ = std::make_unique<MockSender>(this);
+  }
+
+  bool canSendToImpl(const Address&, TrafficClass, BWAvailableCallback&) {
+    return true;
+  }
+
+  int sendMessageImpl(std::unique_ptr<Message>&& msg,
+                      const Address& addr,
+                      BWAvailableCallback*,
+                      SocketCallback*) {
+    if (msg->type_ == MessageType::FINDKEY_BATCH &&
+        batch_send_error_ != E::OK) {
+      err = batch_send_error_;
+      return -1;
+    }
+    sent_.emplace_back(addr.id_.node_.index(), std::move(msg));
+    return 0;
+  }
+
+  FINDKEY_Header header(request_id_t::raw_type rqid) {
+    FINDKEY_Header h{};
+    h.client_rqid = request_id_t(rqid);
+    h.log_id = logid_t(rqid);
+    h.shard = 1;
+    running_.insert(h.client_rqid);
+    return h;
+  }
+
+  void flush() {
+    ASSERT_NE(nullptr, timer_);
+    timer_->trigger();
+  }
+
+  size_t max_batch_size_ = 2;
+  // Protocol of the connection to every node, folly::none if not handshaken.
+  folly::Optional<uint16_t> proto_ = Compatibility::MAX_PROTOCOL_SUPPORTED;
+  // Error with which sending FINDKEY_BATCH messages fails.
+  Status batch_send_error_ = E::OK;
+
+  std::unordered_set<request_id_t, request_id_t::Hash> running_;
+  std::vector<std::pair<node_index_t, std::unique_ptr<Message>>> sent_;
+  std::vector<std::pair<request_id_t, Status>> send_errors_;
+  MockTimer* timer_ = nullptr;
+
+ protected:
+  size_t getMaxBatchSize() const override {
+    return max_batch_size_;
+  }
+
+  folly::Optional<uint16_t> getPeerProtocol(node_index_t) const override {
+    return proto_;
+  }
+
+  std::unique_ptr<Timer>
+  createFlushTimer(std::function<void()> callback) override {
+    auto timer = std::make_unique<MockTimer>(std::move(callback));
+    timer_ = timer.get();
+    return timer;
+  }
+
+  bool isRunning(request_id_t rqid) const override {
+    return running_.count(rqid);
+  }
+
+  void onMessageSent(request_id_t rqid, ShardID, Status st) override {
+    send_errors_.emplace_back(rqid, st);
+  }
+
+  void onBatchSent(size_t) override {}
+};
+
+std::vector<request_id_t> batchRqids(const Message& msg) {
+  EXPECT_EQ(MessageType::FINDKEY_BATCH, msg.type_);
+  std::vector<request_id_t> rqids;
+  for (const FINDKEY_Header& h :
+       static_cast<const FINDKEY_BATCH_Message&>(msg).entries_) {
+    rqids.push_back(h.client_rqid);
+  }
+  return rqids;
+}
+
+} // namespace
+
+TEST(FindKeyRequestTest, Batching) {
+  MockFindKeyRequestMap rqmap;
+  ASSERT_TRUE(rqmap.enqueueForBatch(rqmap.header(1), N1));
+  ASSERT_TRUE(rqmap.enqueueForBatch(rqmap.header(2), N1));
+  ASSERT_TRUE(rqmap.enqueueForBatch(rqmap.header(3), N1));
+  ASSERT_TRUE(rqmap.enqueueForBatch(rqmap.header(4), N2));
+
+  // Nothing is sent before the end of the iteration, not even the full batch.
+  ASSERT_TRUE(rqmap.sent_.empty());
+
+  // Request 3 completes before its batch is sent.
+  rqmap.running_.erase(request_id_t(3));
+  rqmap.flush();
+
+  ASSERT_EQ(2, rqmap.sent_.size());
+  EXPECT_EQ(1, rqmap.sent_[0].first);
+  EXPECT_EQ(std::vector<request_id_t>({request_id_t(1), request_id_t(2)}),
+            batchRqids(*rqmap.sent_[0].second));
+  EXPECT_EQ(2, rqmap.sent_[1].first);
+  EXPECT_EQ(std::vector<request_id_t>({request_id_t(4)}),
+            batchRqids(*rqmap.sent_[1].second));
+}
+
+TEST(FindKeyRequestTest, BatchingNeedsHandshakenProtocol) {
+  MockFindKeyRequestMap rqmap;
+  rqmap.proto_ = folly::none;
+  ASSERT_FALSE(rqmap.enqueueForBatch(rqmap.header(1), N1));
+  rqmap.proto_ = Compatibility::FINDKEY_BATCH_SUPPORT - 1;
+  ASSERT_FALSE(rqmap.enqueueForBatch(rqmap.header(2), N1));
+  rqmap.max_batch_size_ = 1;
+  rqmap.proto_ = Compatibility::FINDKEY_BATCH_SUPPORT;
+  ASSERT_FALSE(rqmap.enqueueForBatch(rqmap.header(3), N1));
+}
+
+TEST(FindKeyRequestTest, BatchFallbackToFindKey) {
+  MockFindKeyRequestMap rqmap;
+  ASSERT_TRUE(rqmap.enqueueForBatch(rqmap.header(1), N1));
+  ASSERT_TRUE(rqmap.enqueueForBatch(rqmap.header(2), N1));
+
+  // The connection was renegotiated with a server too old for FINDKEY_BATCH.
+  rqmap.batch_send_error_ = E::PROTONOSUPPORT;
+  rqmap.flush();
+
+  ASSERT_TRUE(rqmap.send_errors_.empty());
+  ASSERT_EQ(2, rqmap.sent_.size());
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(1, rqmap.sent_[i].first);
+    ASSERT_EQ(MessageType::FINDKEY, rqmap.sent_[i].second->type_);
+    auto& msg = static_cast<const FINDKEY_Message&>(*rqmap.sent_[i].second);
+    request_id_t rqid = msg.header_.client_rqid;
+    EXPECT_EQ(request_id_t(i + 1), rqid);
+  }
+
+  // Batching stays disabled for the node.
+  ASSERT_FALSE(rqmap.enqueueForBatch(rqmap.header(3), N1));
+  ASSERT_TRUE(rqmap.enqueueForBatch(rqmap.header(4), N2));
+}
+
+TEST(FindKeyRequestTest, BatchNotSupportedAfterSend) {
+  // FINDKEY_BATCH_Message::onSent() reports E::PROTONOSUPPORT this way.
+  MockFindKeyRequestMap rqmap;
+  std::vector<FINDKEY_Header> entries = {rqmap.header(1), rqmap.header(2)};
+  rqmap.running_.erase(request_id_t(2));
+  rqmap.onBatchNotSupported(1, 1, entries);
+
+  ASSERT_EQ(1, rqmap.sent_.size());
+  ASSERT_EQ(MessageType::FINDKEY, rqmap.sent_[0].second->type_);
+  ASSERT_FALSE(rqmap.enqueueForBatch(rqmap.header(3), N1));
+}
+
+TEST(FindKeyRequestTest, BatchSendFailure) {
+  MockFindKeyRequestMap rqmap;
+  ASSERT_TRUE(rqmap.enqueueForBatch(rqmap.header(1), N1));
+  ASSERT_TRUE(rqmap.enqueueForBatch(rqmap.header(2), N1));
+  rqmap.batch_send_error_ = E::UNROUTABLE;
+  rqmap.flush();
+
+  ASSERT_TRUE(rqmap.sent_.empty());
+  using Error = std::pair<request_id_t, Status>;
+  EXPECT_EQ(std::vector<Error>({Error(request_id_t(1), E::UNROUTABLE),
+                                Error(request_id_t(2), E::UNROUTABLE)}),
+            rqmap.send_errors_);
+}
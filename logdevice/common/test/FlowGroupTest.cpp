@@ -166,6 +166,63 @@ TEST_F(FlowGroupTest, FlowGroupRunLimits) {
   EXPECT_FALSE(callback2.active());
 }
 
+TEST_F(FlowGroupTest, FairQueuing) {
+  // Records the order in which callbacks run, and pretends to send
+  // nbytes from each.
+  class SendingCallback : public BWAvailableCallback {
+   public:
+    SendingCallback(int id, size_t nbytes, std::function<void(int, size_t)> cb)
+        : id_(id), nbytes_(nbytes), cb_(std::move(cb)) {}
+
+    void operator()(FlowGroup&, std::mutex&) override {
+      cb_(id_, nbytes_);
+    }
+
+   private:
+    int id_;
+    size_t nbytes_;
+    std::function<void(int, size_t)> cb_;
+  };
+
+  update.policy.setEnabled(false);
+  flow_group.applyUpdate(update);
+
+  std::vector<int> order;
+  auto send = [&](int id, size_t nbytes) {
+    order.push_back(id);
+    noteSent(nbytes);
+  };
+
+  // The Sockets are only used to tell flows apart.
+  char sockets[3];
+  auto socket = [&](int id) { return reinterpret_cast<Socket*>(&sockets[id]); };
+
+  auto run_callbacks = [&](bool fair_queuing) {
+    flow_group.setFairQueuing(fair_queuing);
+    std::vector<std::unique_ptr<SendingCallback>> callbacks;
+    // A peer with a backlog of large messages is queued ahead of two peers
+    // with one small message each.
+    for (int i = 0; i < 4; ++i) {
+      callbacks.push_back(std::make_unique<SendingCallback>(
+          0, 2 * FlowGroup::FAIR_QUEUE_QUANTUM, send));
+      flow_group.push(*callbacks.back(), Priority::CLIENT_NORMAL, socket(0));
+    }
+    for (int id = 1; id <= 2; ++id) {
+      callbacks.push_back(std::make_unique<SendingCallback>(id, 100, send));
+      flow_group.push(*callbacks.back(), Priority::CLIENT_NORMAL, socket(id));
+    }
+    order.clear();
+    run();
+    EXPECT_TRUE(flow_group.empty());
+    return order;
+  };
+
+  EXPECT_EQ(std::vector<int>({0, 0, 0, 0, 1, 2}), run_callbacks(false));
+  // The small messages go out after the first large one, and the backlog
+  // is drained once they're gone.
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 0, 0, 0}), run_callbacks(true));
+}
+
 TEST_F(FlowGroupTest, FlowGroupBandwidthCaps) {
   auto send_msg = [this](size_t msg_size, bool expect_success) {
     // Pretend to send a message of msg_size.
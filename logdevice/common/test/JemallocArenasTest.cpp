@@ -0,0 +1,50 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/JemallocArenas.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+namespace facebook { namespace logdevice {
+
+static uint64_t tagBytes(AllocationTag tag) {
+  std::string name = std::string("tag:") + JemallocArenas::tagName(tag);
+  for (const auto& group : JemallocArenas::getStats()) {
+    if (group.name == name) {
+      return group.allocated_bytes;
+    }
+  }
+  return 0;
+}
+
+TEST(JemallocArenasTest, AllocationTagging) {
+  JemallocArenas::init(/*thread_arenas=*/false, /*allocation_tagging=*/true);
+
+  const size_t size = 4 << 20;
+  const uint64_t before = tagBytes(AllocationTag::READ_BUFFERS);
+  void* buf = JemallocArenas::mallocTagged(AllocationTag::READ_BUFFERS, size);
+  ASSERT_NE(nullptr, buf);
+  memset(buf, 'x', size);
+  if (!JemallocArenas::getStats().empty()) {
+    // Linked with jemalloc.
+    EXPECT_GE(tagBytes(AllocationTag::READ_BUFFERS), before + size);
+  }
+  free(buf);
+  EXPECT_LE(tagBytes(AllocationTag::READ_BUFFERS), before);
+
+  {
+    AllocationTagScope scope(AllocationTag::APPENDERS);
+    std::unique_ptr<char[]> p(new char[size]);
+    p[0] = 'x';
+  }
+}
+
+}} // namespace facebook::logdevice
@@ -17,7 +17,7 @@ using namespace facebook::logdevice;
 
 class LocalLogStoreRecordFormatTest
     : public ::testing::TestWithParam<
-          std::tuple<bool, bool, bool, bool, bool, bool>> {
+          std::tuple<bool, bool, bool, bool, bool, bool, bool>> {
  public:
   LocalLogStoreRecordFormatTest() {
     dbg::assertOnData = true;
@@ -37,6 +37,7 @@ TEST_P(LocalLogStoreRecordFormatTest, RoundTrip) {
   const bool written_by_rebuilding = std::get<3>(GetParam());
   const bool shard_id_in_copyset = std::get<4>(GetParam());
   bool enable_offset_map = std::get<5>(GetParam());
+  const bool compact_header = std::get<6>(GetParam());
 
   STORE_Header header;
   header.rid = rid;
@@ -87,8 +88,14 @@ TEST_P(LocalLogStoreRecordFormatTest, RoundTrip) {
   optional_keys.insert(
       std::make_pair(KeyType::FILTERABLE, std::string("abcd")));
   std::string buf;
-  Slice header_blob = LocalLogStoreRecordFormat::formRecordHeader(
-      header, copyset, &buf, shard_id_in_copyset, optional_keys, extra);
+  Slice header_blob =
+      LocalLogStoreRecordFormat::formRecordHeader(header,
+                                                  copyset,
+                                                  &buf,
+                                                  shard_id_in_copyset,
+                                                  optional_keys,
+                                                  extra,
+                                                  compact_header);
 
   size_t blob_size = 8 + 4 + 1 +
       4
@@ -108,6 +115,18 @@ TEST_P(LocalLogStoreRecordFormatTest, RoundTrip) {
       // FLAG_OFFSET_MAP causes the `flag` varint to use one more byte
       + (enable_offset_map ? 1 : 0);
 
+  if (compact_header) {
+    // FLAG_COMPACT_HEADER needs a 4-byte `flag` varint too
+    blob_size += enable_offset_map ? 0 : 1;
+    // 2-byte varint wave instead of 4 bytes
+    blob_size -= 2;
+    // 1-byte varints for node and shard indexes
+    blob_size -= 2 *
+        (shard_id_in_copyset ? sizeof(ShardID) - 2 : sizeof(node_index_t) - 1);
+    // 1-byte varint offset within epoch instead of 8 bytes
+    blob_size -= enable_offset ? 7 : 0;
+  }
+
   ASSERT_EQ(blob_size, header_blob.size);
 
   //
@@ -159,7 +178,8 @@ TEST_P(LocalLogStoreRecordFormatTest, RoundTrip) {
            : 0) |
       LocalLogStoreRecordFormat::FLAG_CUSTOM_KEY |
       LocalLogStoreRecordFormat::FLAG_OPTIONAL_KEYS |
-      (enable_offset_map ? LocalLogStoreRecordFormat::FLAG_OFFSET_MAP : 0);
+      (enable_offset_map ? LocalLogStoreRecordFormat::FLAG_OFFSET_MAP : 0) |
+      (compact_header ? LocalLogStoreRecordFormat::FLAG_COMPACT_HEADER : 0);
   ASSERT_EQ(expected_flags, flags);
   ASSERT_EQ(2, copyset_size_read);
   ASSERT_EQ("data", payload_read.toString());
@@ -280,4 +300,5 @@ INSTANTIATE_TEST_CASE_P(LocalLogStoreRecordFormatTest,
                                            ::testing::Bool(),
                                            ::testing::Bool(),
                                            ::testing::Bool(),
+                                           ::testing::Bool(),
                                            ::testing::Bool()));
@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/stats/LogHeavyHitters.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+
+namespace {
+
+TEST(SpaceSavingSummaryTest, Exact) {
+  SpaceSavingSummary s(3);
+  s.add(logid_t(1), 10);
+  s.add(logid_t(2), 30);
+  s.add(logid_t(1), 5);
+  auto top = s.top(10);
+  ASSERT_EQ(2, top.size());
+  EXPECT_EQ(logid_t(2), top[0].log_id);
+  EXPECT_EQ(30, top[0].weight);
+  EXPECT_EQ(logid_t(1), top[1].log_id);
+  EXPECT_EQ(15, top[1].weight);
+  EXPECT_EQ(0, top[1].error);
+}
+
+TEST(SpaceSavingSummaryTest, Replace) {
+  SpaceSavingSummary s(2);
+  s.add(logid_t(1), 100);
+  s.add(logid_t(2), 5);
+  // Replaces log 2, the one with the smallest weight.
+  s.add(logid_t(3), 1);
+  ASSERT_EQ(2, s.size());
+  auto top = s.top(2);
+  EXPECT_EQ(logid_t(1), top[0].log_id);
+  EXPECT_EQ(logid_t(3), top[1].log_id);
+  EXPECT_EQ(6, top[1].weight);
+  EXPECT_EQ(5, top[1].error);
+
+  // Heavy hitters stay in the summary however many small logs come by.
+  for (int i = 10; i < 1000; ++i) {
+    s.add(logid_t(i), 1);
+  }
+  top = s.top(1);
+  EXPECT_EQ(logid_t(1), top[0].log_id);
+  EXPECT_EQ(100, top[0].weight);
+}
+
+TEST(SpaceSavingSummaryTest, Merge) {
+  SpaceSavingSummary a(4);
+  SpaceSavingSummary b(4);
+  a.add(logid_t(1), 10);
+  a.add(logid_t(2), 1);
+  b.add(logid_t(1), 7);
+  b.add(logid_t(3), 20);
+  a.merge(b);
+  auto top = a.top(3);
+  ASSERT_EQ(3, top.size());
+  EXPECT_EQ(logid_t(3), top[0].log_id);
+  EXPECT_EQ(20, top[0].weight);
+  EXPECT_EQ(logid_t(1), top[1].log_id);
+  EXPECT_EQ(17, top[1].weight);
+}
+
+TEST(LogHeavyHittersTest, CurrentWindow) {
+  LogHeavyHitters h;
+  LogHeavyHitters::Window window = LogHeavyHitters::currentWindow();
+  h.add(LogHeavyHitters::Metric::READ_BYTES, logid_t(1), 42);
+  SpaceSavingSummary out(LogHeavyHitters::CAPACITY);
+  h.mergeInto(LogHeavyHitters::Metric::READ_BYTES, window, out);
+  h.mergeInto(LogHeavyHitters::Metric::APPENDED_BYTES, window, out);
+  // The window may have just changed.
+  if (LogHeavyHitters::currentWindow() == window) {
+    auto top = out.top(10);
+    ASSERT_EQ(1, top.size());
+    EXPECT_EQ(42, top[0].weight);
+  }
+}
+
+} // namespace
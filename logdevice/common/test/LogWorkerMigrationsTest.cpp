@@ -0,0 +1,44 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/LogWorkerMigrations.h"
+
+#include <gtest/gtest.h>
+
+namespace facebook { namespace logdevice {
+
+static const worker_id_t W0(0), W1(1), W2(2);
+
+TEST(LogWorkerMigrationsTest, Basic) {
+  LogWorkerMigrations migrations;
+  const logid_t LOG(1), OTHER_LOG(2);
+  EXPECT_EQ(W0, migrations.route(LOG, W0));
+  EXPECT_FALSE(migrations.isHandingOver(LOG, W0));
+
+  ASSERT_TRUE(migrations.begin(LOG, W0, W1));
+  EXPECT_EQ(1, migrations.size());
+  // Only the requests for the log that hash to W0 move.
+  EXPECT_EQ(W1, migrations.route(LOG, W0));
+  EXPECT_EQ(W2, migrations.route(LOG, W2));
+  EXPECT_EQ(W0, migrations.route(OTHER_LOG, W0));
+  EXPECT_TRUE(migrations.isHandingOver(LOG, W0));
+  EXPECT_FALSE(migrations.isHandingOver(LOG, W2));
+
+  // A log is migrated at most once from each worker.
+  EXPECT_FALSE(migrations.begin(LOG, W0, W2));
+  EXPECT_EQ(W1, migrations.route(LOG, W0));
+
+  migrations.completeHandover(LOG, W0);
+  EXPECT_FALSE(migrations.isHandingOver(LOG, W0));
+  EXPECT_EQ(W1, migrations.route(LOG, W0));
+
+  ASSERT_TRUE(migrations.begin(LOG, W2, W0));
+  EXPECT_EQ(W0, migrations.route(LOG, W2));
+  EXPECT_EQ(2, migrations.size());
+}
+
+}} // namespace facebook::logdevice
@@ -172,6 +172,36 @@ TEST(LogsConfigTreeTest, ImmutabilityTest) {
   ASSERT_TRUE(snapshot1->findDirectory("/normal_logs"));
 }
 
+TEST(LogsConfigTreeTest, CopyIndex) {
+  std::unique_ptr<LogsConfigTree> tree = LogsConfigTree::create();
+  auto dir1 = tree->addDirectory(
+      tree->root(), "dir1", LogAttributes().with_replicationFactor(2));
+  auto dir2 = tree->addDirectory(dir1, "dir2", LogAttributes());
+  auto lg1 = tree->addLogGroup(
+      dir1, "log_group1", logid_range_t{logid_t(1), logid_t(10)});
+  auto lg2 = tree->addLogGroup(
+      dir2, "log_group2", logid_range_t{logid_t(20), logid_t(30)});
+  ASSERT_TRUE(lg1);
+  ASSERT_TRUE(lg2);
+
+  std::unique_ptr<LogsConfigTree> copy = tree->copy();
+  const LogGroupInDirectory* res = copy->getLogGroupByID(logid_t(5));
+  ASSERT_NE(nullptr, res);
+  ASSERT_EQ(lg1, res->log_group);
+  // the index points to the directories of the copy
+  ASSERT_EQ(copy->findDirectory("/dir1"), res->parent);
+  res = copy->getLogGroupByID(logid_t(25));
+  ASSERT_NE(nullptr, res);
+  ASSERT_EQ(copy->findDirectory("/dir1/dir2"), res->parent);
+  ASSERT_EQ("/dir1/dir2/log_group2", res->getFullyQualifiedName());
+
+  // the copy is still usable after the original is gone
+  tree.reset();
+  ASSERT_EQ("/dir1/log_group1",
+            copy->getLogGroupByID(logid_t(1))->getFullyQualifiedName());
+  ASSERT_EQ(nullptr, copy->getLogGroupByID(logid_t(15)));
+}
+
 TEST(LogsConfigTreeTest, TestSnapshottingPerformance) {
   auto defaults = DefaultLogAttributes();
   std::unique_ptr<LogsConfigTree> tree = LogsConfigTree::create();
@@ -251,6 +281,20 @@ TEST(LogsConfigTreeTest, TestFindLogByID) {
   ASSERT_EQ(*lg2, *tree->getLogGroupByID(logid_t(24))->log_group);
   auto not_found = tree->getLogGroupByID(logid_t(201));
   ASSERT_FALSE(not_found);
+
+  // range boundaries and the hole between the two ranges
+  ASSERT_EQ(lg1, tree->getLogGroupByID(logid_t(1))->log_group);
+  ASSERT_EQ(lg1, tree->getLogGroupByID(logid_t(10))->log_group);
+  ASSERT_EQ(nullptr, tree->getLogGroupByID(logid_t(11)));
+  ASSERT_EQ(nullptr, tree->getLogGroupByID(logid_t(19)));
+  ASSERT_EQ(lg2, tree->getLogGroupByID(logid_t(100))->log_group);
+
+  // log groups added after a lookup can be found
+  auto lg3 = tree->addLogGroup(
+      dir2, "log_group3", logid_range_t{logid_t(11), logid_t(19)});
+  ASSERT_TRUE(lg3);
+  ASSERT_EQ(lg3, tree->getLogGroupByID(logid_t(15))->log_group);
+  ASSERT_EQ(lg1, tree->getLogGroupByID(logid_t(10))->log_group);
 }
 
 TEST(LogsConfigTreeTest, TestMetadataLogAddFail) {
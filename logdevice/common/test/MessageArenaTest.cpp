@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/MessageArena.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+
+namespace {
+
+struct TestMessage {
+  MESSAGE_ARENA_ALLOCATED
+
+  char data[100];
+};
+
+TEST(MessageArenaTest, Basic) {
+  MessageArena arena(1024);
+
+  // Outside of a Scope, allocations come from the heap.
+  auto heap_msg = std::make_unique<TestMessage>();
+  EXPECT_EQ(0, arena.liveAllocations());
+
+  void* first;
+  {
+    MessageArena::Scope scope(&arena);
+    auto m1 = std::make_unique<TestMessage>();
+    auto m2 = std::make_unique<TestMessage>();
+    EXPECT_EQ(2, arena.liveAllocations());
+    EXPECT_NE(m1.get(), m2.get());
+    first = m1.get();
+  }
+  EXPECT_EQ(0, arena.liveAllocations());
+
+  // Once everything was freed, the arena starts over.
+  {
+    MessageArena::Scope scope(&arena);
+    auto m = std::make_unique<TestMessage>();
+    EXPECT_EQ(first, m.get());
+  }
+}
+
+TEST(MessageArenaTest, Full) {
+  MessageArena arena(1024);
+  MessageArena::Scope scope(&arena);
+
+  // A message that is kept keeps the arena from starting over, and once the
+  // arena is full allocations fall back to the heap.
+  std::vector<std::unique_ptr<TestMessage>> msgs;
+  for (int i = 0; i < 20; ++i) {
+    msgs.push_back(std::make_unique<TestMessage>());
+  }
+  EXPECT_GT(arena.liveAllocations(), 0);
+  EXPECT_LT(arena.liveAllocations(), msgs.size());
+
+  msgs.clear();
+  EXPECT_EQ(0, arena.liveAllocations());
+}
+
+} // namespace
@@ -14,16 +14,22 @@
 
 #include "event2/buffer.h"
 #include "logdevice/common/Metadata.h"
+#include "logdevice/common/PayloadHolder.h"
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/libevent/compat.h"
 #include "logdevice/common/protocol/APPEND_Message.h"
+#include "logdevice/common/protocol/APPENDS_Message.h"
 #include "logdevice/common/protocol/CLEAN_Message.h"
+#include "logdevice/common/protocol/CONFIG_CHANGED_Message.h"
 #include "logdevice/common/protocol/DELETE_Message.h"
+#include "logdevice/common/protocol/DATA_SIZE_BATCH_Message.h"
+#include "logdevice/common/protocol/FINDKEY_BATCH_Message.h"
 #include "logdevice/common/protocol/GET_EPOCH_RECOVERY_METADATA_Message.h"
 #include "logdevice/common/protocol/GET_EPOCH_RECOVERY_METADATA_REPLY_Message.h"
 #include "logdevice/common/protocol/HELLO_Message.h"
+#include "logdevice/common/protocol/IS_LOG_EMPTY_BATCH_Message.h"
 #include "logdevice/common/protocol/MessageDeserializers.h"
 #include "logdevice/common/protocol/MessageTypeNames.h"
 #include "logdevice/common/protocol/ProtocolReader.h"
@@ -32,9 +38,14 @@
 #include "logdevice/common/protocol/SEALED_Message.h"
 #include "logdevice/common/protocol/SHUTDOWN_Message.h"
 #include "logdevice/common/protocol/STARTED_Message.h"
+#include "logdevice/common/protocol/STARTS_Message.h"
 #include "logdevice/common/protocol/START_Message.h"
 #include "logdevice/common/protocol/STOP_Message.h"
+#include "logdevice/common/protocol/STORED_Message.h"
+#include "logdevice/common/protocol/RELEASES_Message.h"
+#include "logdevice/common/protocol/STORES_Message.h"
 #include "logdevice/common/protocol/STORE_Message.h"
+#include "logdevice/common/protocol/WINDOWS_Message.h"
 #include "logdevice/common/request_util.h"
 #include "logdevice/common/test/TestUtil.h"
 #include "logdevice/common/util.h"
@@ -118,6 +129,18 @@ class MessageSerializationTest : public ::testing::Test {
   MessageSerializationTest() {
     dbg::assertOnData = true;
   }
+  void checkCONFIG_CHANGED(const CONFIG_CHANGED_Message& sent,
+                           const CONFIG_CHANGED_Message& recv,
+                           uint16_t proto) {
+    ASSERT_EQ(sent.header_.version, recv.header_.version);
+    ASSERT_EQ(sent.header_.action, recv.header_.action);
+    ASSERT_EQ(sent.config_str_, recv.config_str_);
+    if (proto >= Compatibility::CONFIG_CHANGED_ZSTD_SUPPORT) {
+      ASSERT_EQ(sent.compression_, recv.compression_);
+    } else {
+      ASSERT_EQ(CONFIG_CHANGED_Header::Compression::GZIP, recv.compression_);
+    }
+  }
   void checkSTORE(const STORE_Message& sent,
                   const STORE_Message& recv,
                   uint16_t proto) {
@@ -503,6 +526,46 @@ TEST_F(MessageSerializationTest, STORE_WithKey) {
           [](ProtocolReader& r) { return STORE_Message::deserialize(r, 128); });
 }
 
+// Each STORE of a STORES message keeps its own serialization, with the payload
+// prefixed by its size.
+TEST_F(MessageSerializationTest, STORES) {
+  TestStoreMessageFactory plain;
+  TestStoreMessageFactory with_key;
+  std::map<KeyType, std::string> optional_keys;
+  optional_keys.insert(
+      std::make_pair(KeyType::FINDKEY, std::string("abcdefgh")));
+  with_key.setFlags(STORE_Header::CUSTOM_KEY);
+  with_key.setKey(optional_keys, "08006162636465666768");
+
+  std::vector<std::unique_ptr<STORE_Message>> stores;
+  stores.push_back(std::make_unique<STORE_Message>(plain.message()));
+  stores.push_back(std::make_unique<STORE_Message>(with_key.message()));
+  STORES_Message m(std::move(stores));
+
+  auto check = [&](const STORES_Message& m2, uint16_t proto) {
+    ASSERT_EQ(2, m2.stores_.size());
+    for (size_t i = 0; i < m2.stores_.size(); ++i) {
+      checkSTORE(*m.stores_[i], *m2.stores_[i], proto);
+    }
+  };
+  auto expected = [&](uint16_t proto) {
+    // Move the payload ("hi") of each STORE after its size.
+    auto in_batch = [&](const TestStoreMessageFactory& factory) {
+      std::string s = factory.serialized(proto);
+      return s.substr(0, s.size() - 4) + "02000000" + "6869";
+    };
+    return "02000000" + in_batch(plain) + in_batch(with_key);
+  };
+  DO_TEST(m,
+          check,
+          Compatibility::STORES_MESSAGE_SUPPORT,
+          Compatibility::MAX_PROTOCOL_SUPPORTED,
+          expected,
+          [](ProtocolReader& r) {
+            return STORES_Message::deserialize(r, 128);
+          });
+}
+
 TEST_F(MessageSerializationTest, STORE_WithFilterableKey) {
   TestStoreMessageFactory factory;
   std::map<KeyType, std::string> optional_keys;
@@ -938,6 +1001,47 @@ TEST_F(MessageSerializationTest, APPEND) {
   }
 }
 
+// Each APPEND of an APPENDS message keeps its own serialization, with the
+// payload prefixed by its size.
+TEST_F(MessageSerializationTest, APPENDS) {
+  APPEND_Header h = {request_id_t(0xb64a0f255e281e45),
+                     logid_t(0x3c3b4fa7a1299851),
+                     epoch_t(0xee396b50),
+                     0xed5b3efc,
+                     APPEND_Header::CHECKSUM_64BIT};
+  AppendAttributes attrs;
+  std::vector<std::unique_ptr<APPEND_Message>> appends;
+  appends.push_back(std::make_unique<APPEND_Message>(
+      h, LSN_INVALID, attrs, PayloadHolder(strdup("hello"), 5)));
+
+  h.rqid = request_id_t(0xb64a0f255e281e46);
+  h.logid = logid_t(0x3c3b4fa7a1299852);
+  h.flags |= APPEND_Header::CUSTOM_KEY | APPEND_Header::E2E_TRACING_ON;
+  attrs.optional_keys[KeyType::FINDKEY] = "abcdefgh";
+  appends.push_back(
+      std::make_unique<APPEND_Message>(h,
+                                       LSN_INVALID,
+                                       attrs,
+                                       PayloadHolder(strdup("world!"), 6),
+                                       "TRACING_INFORMATION"));
+  APPENDS_Message m(std::move(appends));
+
+  auto check = [&](const APPENDS_Message& m2, uint16_t proto) {
+    ASSERT_EQ(2, m2.appends_.size());
+    for (size_t i = 0; i < m2.appends_.size(); ++i) {
+      checkAPPEND(*m.appends_[i], *m2.appends_[i], proto);
+    }
+  };
+  DO_TEST(m,
+          check,
+          Compatibility::APPENDS_MESSAGE_SUPPORT,
+          Compatibility::MAX_PROTOCOL_SUPPORTED,
+          [](uint16_t) { return std::string(); },
+          [](ProtocolReader& r) {
+            return APPENDS_Message::deserialize(r, 128);
+          });
+}
+
 TEST_F(MessageSerializationTest, RECORD) {
   RECORD_Header h = {
       logid_t(0xb1ae6d3809c1cdad),
@@ -1369,6 +1473,272 @@ TEST_F(MessageSerializationTest, START_num_filtered_out) {
   }
 }
 
+// Each START of a STARTS message keeps its own serialization, including the
+// variable-length parts that follow its header.
+TEST_F(MessageSerializationTest, STARTS) {
+  START_Header h = {logid_t(0xDCC49E8FF44783D3),
+                    read_stream_id_t(0x8B49478D2C473B3A),
+                    lsn_t(5),
+                    lsn_t(13),
+                    lsn_t(8),
+                    0,
+                    0,
+                    filter_version_t(1),
+                    0,
+                    3,
+                    SCDCopysetReordering::NONE,
+                    shard_index_t{2}};
+  std::vector<std::unique_ptr<START_Message>> starts;
+  starts.push_back(std::make_unique<START_Message>(h));
+
+  h.log_id = logid_t(0xDCC49E8FF44783D4);
+  h.read_stream_id = read_stream_id_t(0x8B49478D2C473B3B);
+  h.flags = START_Header::SINGLE_COPY_DELIVERY;
+  h.scd_copyset_reordering = SCDCopysetReordering::HASH_SHUFFLE_CLIENT_SEED;
+  ReadStreamAttributes attrs;
+  attrs.filter_type = ServerRecordFilterType::RANGE;
+  attrs.filter_key1 = "a";
+  attrs.filter_key2 = "m";
+  starts.push_back(std::make_unique<START_Message>(
+      h, small_shardset_t{ShardID(1, 2), ShardID(3, 2)}, &attrs, "csid"));
+  STARTS_Message m(std::move(starts));
+
+  auto check = [&](const STARTS_Message& m2, uint16_t /*proto*/) {
+    ASSERT_EQ(2, m2.starts_.size());
+    for (size_t i = 0; i < m2.starts_.size(); ++i) {
+      const START_Message& s = *m.starts_[i];
+      const START_Message& s2 = *m2.starts_[i];
+      EXPECT_EQ(s.header_.log_id, s2.header_.log_id);
+      EXPECT_EQ(s.header_.read_stream_id, s2.header_.read_stream_id);
+      EXPECT_EQ(s.header_.start_lsn, s2.header_.start_lsn);
+      EXPECT_EQ(s.header_.flags, s2.header_.flags);
+      EXPECT_EQ(s.header_.shard, s2.header_.shard);
+      EXPECT_EQ(s.filtered_out_, s2.filtered_out_);
+      EXPECT_EQ(s.attrs_.filter_type, s2.attrs_.filter_type);
+      EXPECT_EQ(s.attrs_.filter_key1, s2.attrs_.filter_key1);
+      EXPECT_EQ(s.attrs_.filter_key2, s2.attrs_.filter_key2);
+    }
+    EXPECT_NE(0, m2.starts_[1]->csid_hash_pt1);
+  };
+  DO_TEST(m,
+          check,
+          Compatibility::STARTS_MESSAGE_SUPPORT,
+          Compatibility::MAX_PROTOCOL_SUPPORTED,
+          [](uint16_t) { return std::string(); },
+          nullptr);
+}
+
+TEST_F(MessageSerializationTest, WINDOWS) {
+  std::vector<WINDOW_Header> windows;
+  for (int i = 1; i <= 3; ++i) {
+    windows.push_back(WINDOW_Header{logid_t(i),
+                                    read_stream_id_t(100 + i),
+                                    {lsn_t(10 * i), lsn_t(10 * i + 5)},
+                                    shard_index_t(i)});
+  }
+  WINDOWS_Message m(windows);
+
+  auto check = [&](const WINDOWS_Message& m2, uint16_t /*proto*/) {
+    ASSERT_EQ(windows.size(), m2.windows_.size());
+    for (size_t i = 0; i < windows.size(); ++i) {
+      EXPECT_EQ(windows[i].log_id, m2.windows_[i].log_id);
+      EXPECT_EQ(windows[i].read_stream_id, m2.windows_[i].read_stream_id);
+      EXPECT_EQ(windows[i].sliding_window.low,
+                m2.windows_[i].sliding_window.low);
+      EXPECT_EQ(windows[i].sliding_window.high,
+                m2.windows_[i].sliding_window.high);
+      EXPECT_EQ(windows[i].shard, m2.windows_[i].shard);
+    }
+  };
+  DO_TEST(m,
+          check,
+          Compatibility::WINDOWS_MESSAGE_SUPPORT,
+          Compatibility::MAX_PROTOCOL_SUPPORTED,
+          [](uint16_t) { return std::string(); },
+          nullptr);
+}
+
+TEST_F(MessageSerializationTest, RELEASES) {
+  std::vector<RELEASE_Header> releases;
+  for (int i = 1; i <= 3; ++i) {
+    releases.push_back(
+        RELEASE_Header{RecordID(esn_t(10 * i), epoch_t(i), logid_t(i)),
+                       i % 2 ? ReleaseType::GLOBAL : ReleaseType::PER_EPOCH,
+                       shard_index_t(i)});
+  }
+  RELEASES_Message m(releases);
+
+  auto check = [&](const RELEASES_Message& m2, uint16_t /*proto*/) {
+    ASSERT_EQ(releases.size(), m2.releases_.size());
+    for (size_t i = 0; i < releases.size(); ++i) {
+      EXPECT_EQ(releases[i].rid, m2.releases_[i].rid);
+      EXPECT_EQ(releases[i].release_type, m2.releases_[i].release_type);
+      EXPECT_EQ(releases[i].shard, m2.releases_[i].shard);
+    }
+  };
+  DO_TEST(m,
+          check,
+          Compatibility::RELEASES_MESSAGE_SUPPORT,
+          Compatibility::MAX_PROTOCOL_SUPPORTED,
+          [](uint16_t) { return std::string(); },
+          nullptr);
+}
+
+TEST_F(MessageSerializationTest, STORED_WithTimings) {
+  STORED_Header hdr{RecordID(esn_t(3), epoch_t(2), logid_t(1)),
+                    4,
+                    E::OK,
+                    NodeID(),
+                    STORED_Header::SYNCED,
+                    shard_index_t(5)};
+  STORED_Timings timings{10, 20, 30, 40, 50};
+  STORED_Message m(hdr,
+                   LSN_INVALID,
+                   0,
+                   LOG_REBUILDING_ID_INVALID,
+                   FlushToken_INVALID,
+                   ServerInstanceId_INVALID,
+                   ShardID(),
+                   timings);
+  EXPECT_TRUE(m.header_.flags & STORED_Header::TIMINGS);
+
+  auto check = [&](const STORED_Message& m2, uint16_t proto) {
+    EXPECT_EQ(hdr.rid, m2.header_.rid);
+    EXPECT_EQ(hdr.wave, m2.header_.wave);
+    EXPECT_EQ(hdr.shard, m2.header_.shard);
+    EXPECT_TRUE(m2.header_.flags & STORED_Header::SYNCED);
+    if (proto < Compatibility::STORED_TIMINGS_SUPPORT) {
+      // Older nodes don't get the timings.
+      EXPECT_FALSE(m2.header_.flags & STORED_Header::TIMINGS);
+      EXPECT_FALSE(m2.timings_.hasValue());
+    } else {
+      EXPECT_TRUE(m2.header_.flags & STORED_Header::TIMINGS);
+      ASSERT_TRUE(m2.timings_.hasValue());
+      const STORED_Timings timings2 = m2.timings_.value();
+      EXPECT_EQ(20, uint32_t(timings2.queue_usec));
+      EXPECT_EQ(50, uint32_t(timings2.reply_usec));
+      EXPECT_EQ(150, timings2.totalUsec());
+    }
+  };
+  DO_TEST(m,
+          check,
+          Compatibility::STORED_TIMINGS_SUPPORT - 1,
+          Compatibility::MAX_PROTOCOL_SUPPORTED,
+          [](uint16_t) { return std::string(); },
+          nullptr);
+}
+
+TEST_F(MessageSerializationTest, CONFIG_CHANGED) {
+  CONFIG_CHANGED_Header hdr = {42,
+                               config_version_t(7),
+                               NodeID(1, 2),
+                               CONFIG_CHANGED_Header::ConfigType::MAIN_CONFIG,
+                               CONFIG_CHANGED_Header::Action::UPDATE};
+  CONFIG_CHANGED_Message gzip(hdr, "gzip config");
+  DO_TEST(gzip,
+          [&](const CONFIG_CHANGED_Message& recv, uint16_t proto) {
+            checkCONFIG_CHANGED(gzip, recv, proto);
+          },
+          Compatibility::MIN_PROTOCOL_SUPPORTED,
+          Compatibility::MAX_PROTOCOL_SUPPORTED,
+          [](uint16_t) { return std::string(); },
+          nullptr);
+
+  CONFIG_CHANGED_Message zstd(
+      hdr, "zstd config", CONFIG_CHANGED_Header::Compression::ZSTD);
+  DO_TEST(zstd,
+          [&](const CONFIG_CHANGED_Message& recv, uint16_t proto) {
+            checkCONFIG_CHANGED(zstd, recv, proto);
+          },
+          Compatibility::CONFIG_CHANGED_ZSTD_SUPPORT,
+          Compatibility::MAX_PROTOCOL_SUPPORTED,
+          [](uint16_t) { return std::string(); },
+          nullptr);
+}
+
+TEST_F(MessageSerializationTest, FINDKEY_BATCH) {
+  std::vector<FINDKEY_Header> entries;
+  for (int i = 1; i <= 3; ++i) {
+    entries.push_back(FINDKEY_Header{request_id_t(10 + i),
+                                     logid_t(i),
+                                     1000 + i,
+                                     FINDKEY_Header::APPROXIMATE,
+                                     lsn_t(i),
+                                     LSN_MAX,
+                                     500,
+                                     shard_index_t(2)});
+  }
+  FINDKEY_BATCH_Message m(shard_index_t(2), entries);
+  auto check = [&](const FINDKEY_BATCH_Message& m2, uint16_t /*proto*/) {
+    ASSERT_EQ(m.shard_, m2.shard_);
+    ASSERT_EQ(m.entries_.size(), m2.entries_.size());
+    for (size_t i = 0; i < m.entries_.size(); ++i) {
+      EXPECT_EQ(0,
+                memcmp(&m.entries_[i],
+                       &m2.entries_[i],
+                       sizeof(FINDKEY_Header)));
+    }
+  };
+  DO_TEST(m,
+          check,
+          Compatibility::FINDKEY_BATCH_SUPPORT,
+          Compatibility::MAX_PROTOCOL_SUPPORTED,
+          [](uint16_t /*proto*/) { return ""; },
+          nullptr);
+}
+
+TEST_F(MessageSerializationTest, IS_LOG_EMPTY_BATCH) {
+  std::vector<IS_LOG_EMPTY_Header> entries;
+  for (int i = 1; i <= 3; ++i) {
+    entries.push_back(IS_LOG_EMPTY_Header{
+        request_id_t(10 + i), logid_t(i), shard_index_t(2)});
+  }
+  IS_LOG_EMPTY_BATCH_Message m(shard_index_t(2), entries);
+  auto check = [&](const IS_LOG_EMPTY_BATCH_Message& m2, uint16_t /*proto*/) {
+    ASSERT_EQ(m.shard_, m2.shard_);
+    ASSERT_EQ(m.entries_.size(), m2.entries_.size());
+    for (size_t i = 0; i < m.entries_.size(); ++i) {
+      EXPECT_EQ(0,
+                memcmp(&m.entries_[i],
+                       &m2.entries_[i],
+                       sizeof(IS_LOG_EMPTY_Header)));
+    }
+  };
+  DO_TEST(m,
+          check,
+          Compatibility::LOG_QUERY_BATCH_SUPPORT,
+          Compatibility::MAX_PROTOCOL_SUPPORTED,
+          [](uint16_t /*proto*/) { return ""; },
+          nullptr);
+}
+
+TEST_F(MessageSerializationTest, DATA_SIZE_BATCH) {
+  std::vector<DATA_SIZE_Header> entries;
+  for (int i = 1; i <= 3; ++i) {
+    entries.push_back(DATA_SIZE_Header{request_id_t(10 + i),
+                                       logid_t(i),
+                                       shard_index_t(2),
+                                       1000 * i,
+                                       2000 * i});
+  }
+  DATA_SIZE_BATCH_Message m(shard_index_t(2), entries);
+  auto check = [&](const DATA_SIZE_BATCH_Message& m2, uint16_t /*proto*/) {
+    ASSERT_EQ(m.shard_, m2.shard_);
+    ASSERT_EQ(m.entries_.size(), m2.entries_.size());
+    for (size_t i = 0; i < m.entries_.size(); ++i) {
+      EXPECT_EQ(
+          0,
+          memcmp(&m.entries_[i], &m2.entries_[i], sizeof(DATA_SIZE_Header)));
+    }
+  };
+  DO_TEST(m,
+          check,
+          Compatibility::LOG_QUERY_BATCH_SUPPORT,
+          Compatibility::MAX_PROTOCOL_SUPPORTED,
+          [](uint16_t /*proto*/) { return ""; },
+          nullptr);
+}
+
 TEST_F(MessageSerializationTest, CLEAN) {
   CLEAN_Header h = {
       logid_t(0xBBC18E8AA44783D3),
@@ -1469,4 +1839,35 @@ TEST_F(MessageSerializationTest, DrainExtraBytes) {
                    sizeof(delete_msg.getHeader())));
 }
 
+// Large owned payloads are added to outgoing evbuffers by reference, so that
+// the STOREs of all copyset members share one buffer. Unowned and small
+// payloads are copied.
+TEST_F(MessageSerializationTest, PayloadSerializedByReference) {
+  const size_t size = MAX_COPY_TO_EVBUFFER_PAYLOAD_SIZE * 4;
+  void* buf = malloc(size);
+  ASSERT_NE(nullptr, buf);
+  memset(buf, 'x', size);
+  PayloadHolder owned(buf, size);
+  EXPECT_TRUE(owned.serializesByReference());
+  EXPECT_FALSE(PayloadHolder(Payload(buf, size), PayloadHolder::UNOWNED)
+                   .serializesByReference());
+  EXPECT_FALSE(PayloadHolder(Payload(buf, MAX_COPY_TO_EVBUFFER_PAYLOAD_SIZE),
+                             PayloadHolder::UNOWNED)
+                   .serializesByReference());
+
+  for (int i = 0; i < 3; ++i) {
+    struct evbuffer* evbuf = LD_EV(evbuffer_new)();
+    SCOPE_EXIT {
+      LD_EV(evbuffer_free)(evbuf);
+    };
+    ProtocolWriter writer(
+        MessageType::STORE, evbuf, Compatibility::MAX_PROTOCOL_SUPPORTED);
+    owned.serialize(writer);
+    ASSERT_EQ(ssize_t(size), writer.result());
+    std::string data(size, '\0');
+    ASSERT_EQ(ssize_t(size), LD_EV(evbuffer_copyout)(evbuf, &data[0], size));
+    EXPECT_EQ(std::string(size, 'x'), data);
+  }
+}
+
 }} // namespace facebook::logdevice
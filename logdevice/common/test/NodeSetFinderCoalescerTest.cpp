@@ -0,0 +1,189 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/NodeSetFinderCoalescer.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logdevice/common/settings/Settings.h"
+#include "logdevice/common/settings/SettingsUpdater.h"
+#include "logdevice/include/types.h"
+
+using namespace facebook::logdevice;
+
+namespace {
+
+const logid_t LOG(1);
+const auto SOURCE = NodeSetFinder::Source::METADATA_LOG;
+const std::chrono::milliseconds TIMEOUT(1000);
+
+// NodeSetFinder that finishes when the test tells it to.
+class FakeNodeSetFinder : public NodeSetFinder {
+ public:
+  FakeNodeSetFinder(logid_t log_id, std::function<void(Status)> cb)
+      : NodeSetFinder(log_id, TIMEOUT, std::move(cb)) {}
+
+  void start() override {
+    started = true;
+  }
+
+  void finish(Status st, std::shared_ptr<const EpochMetaDataMap> result) {
+    setResultAndFinalize(st, std::move(result));
+  }
+
+  bool started = false;
+
+ protected:
+  void stopReadingMetaDataLog() override {}
+};
+
+class TestCoalescer : public NodeSetFinderCoalescer {
+ public:
+  explicit TestCoalescer(UpdateableSettings<Settings> settings)
+      : NodeSetFinderCoalescer(std::move(settings)) {}
+
+  using NodeSetFinderCoalescer::startPendingFinders;
+
+  std::vector<FakeNodeSetFinder*> finders;
+
+ protected:
+  std::unique_ptr<NodeSetFinder>
+  createNodeSetFinder(logid_t log_id,
+                      std::chrono::milliseconds /* timeout */,
+                      std::function<void(Status)> cb,
+                      NodeSetFinder::Source /* source */) override {
+    auto finder = std::make_unique<FakeNodeSetFinder>(log_id, std::move(cb));
+    finders.push_back(finder.get());
+    return std::move(finder);
+  }
+
+  void scheduleStart() override {}
+};
+
+// Metadata effective since epochs 1 and 5, until `effective_until`.
+std::shared_ptr<const EpochMetaDataMap> makeMap(epoch_t effective_until) {
+  EpochMetaDataMap::Map map;
+  map[EPOCH_MIN] =
+      EpochMetaData(StorageSet{ShardID(0, 0), ShardID(1, 0)},
+                    ReplicationProperty({{NodeLocationScope::NODE, 2}}));
+  map[epoch_t(5)] =
+      EpochMetaData(StorageSet{ShardID(1, 0), ShardID(2, 0)},
+                    ReplicationProperty({{NodeLocationScope::NODE, 2}}),
+                    epoch_t(5),
+                    epoch_t(5));
+  return EpochMetaDataMap::create(
+      std::make_shared<const EpochMetaDataMap::Map>(std::move(map)),
+      effective_until);
+}
+
+class NodeSetFinderCoalescerTest : public ::testing::Test {
+ public:
+  NodeSetFinderCoalescerTest() : coalescer_(settings_) {}
+
+  std::unique_ptr<NodeSetFinderCoalescer::Handle> find(epoch_t epoch) {
+    return coalescer_.find(
+        LOG, epoch, SOURCE, TIMEOUT, [this](Status st, auto result) {
+          statuses_.push_back(st);
+          results_.push_back(std::move(result));
+        });
+  }
+
+  UpdateableSettings<Settings> settings_;
+  TestCoalescer coalescer_;
+  std::vector<Status> statuses_;
+  std::vector<std::shared_ptr<const EpochMetaDataMap>> results_;
+};
+
+TEST_F(NodeSetFinderCoalescerTest, CoversEpoch) {
+  auto map = makeMap(epoch_t(10));
+  EXPECT_TRUE(NodeSetFinderCoalescer::coversEpoch(*map, epoch_t(1)));
+  EXPECT_TRUE(NodeSetFinderCoalescer::coversEpoch(*map, epoch_t(4)));
+  // The last metadata could still change after the NodeSetFinder read it.
+  EXPECT_FALSE(NodeSetFinderCoalescer::coversEpoch(*map, epoch_t(5)));
+  EXPECT_FALSE(NodeSetFinderCoalescer::coversEpoch(*map, epoch_t(10)));
+  EXPECT_FALSE(NodeSetFinderCoalescer::coversEpoch(*map, epoch_t(11)));
+}
+
+// Requests made before the NodeSetFinder starts share it.
+TEST_F(NodeSetFinderCoalescerTest, SharedBeforeStart) {
+  auto h1 = find(epoch_t(7));
+  auto h2 = find(epoch_t(3));
+  ASSERT_EQ(1, coalescer_.finders.size());
+  ASSERT_FALSE(coalescer_.finders[0]->started);
+
+  coalescer_.startPendingFinders();
+  ASSERT_TRUE(coalescer_.finders[0]->started);
+  EXPECT_TRUE(statuses_.empty());
+
+  auto map = makeMap(epoch_t(7));
+  coalescer_.finders[0]->finish(E::OK, map);
+  ASSERT_EQ(std::vector<Status>({E::OK, E::OK}), statuses_);
+  EXPECT_EQ(map, results_[0]);
+  EXPECT_EQ(map, results_[1]);
+}
+
+// A request that joins a running NodeSetFinder gets its result only if it
+// has metadata for a later epoch.
+TEST_F(NodeSetFinderCoalescerTest, JoinRunning) {
+  auto h1 = find(epoch_t(7));
+  coalescer_.startPendingFinders();
+  auto h2 = find(epoch_t(3));
+  auto h3 = find(epoch_t(6));
+  ASSERT_EQ(1, coalescer_.finders.size());
+
+  auto map = makeMap(epoch_t(7));
+  coalescer_.finders[0]->finish(E::OK, map);
+  // h1 created the NodeSetFinder and h2's epoch is covered. h3 is retried.
+  ASSERT_EQ(std::vector<Status>({E::OK, E::OK}), statuses_);
+  ASSERT_EQ(2, coalescer_.finders.size());
+  ASSERT_FALSE(coalescer_.finders[1]->started);
+
+  coalescer_.startPendingFinders();
+  coalescer_.finders[1]->finish(E::OK, map);
+  ASSERT_EQ(3, statuses_.size());
+}
+
+TEST_F(NodeSetFinderCoalescerTest, Failure) {
+  auto h1 = find(epoch_t(7));
+  coalescer_.startPendingFinders();
+  auto h2 = find(epoch_t(6));
+  coalescer_.finders[0]->finish(E::TIMEDOUT, nullptr);
+  // Errors are not retried.
+  ASSERT_EQ(std::vector<Status>({E::TIMEDOUT, E::TIMEDOUT}), statuses_);
+  EXPECT_FALSE(results_[0]);
+  EXPECT_EQ(1, coalescer_.finders.size());
+}
+
+TEST_F(NodeSetFinderCoalescerTest, Cancel) {
+  auto h1 = find(epoch_t(7));
+  auto h2 = find(epoch_t(7));
+  h1.reset();
+  coalescer_.startPendingFinders();
+  coalescer_.finders[0]->finish(E::OK, makeMap(epoch_t(7)));
+  ASSERT_EQ(1, statuses_.size());
+
+  // Cancelling all requests destroys the NodeSetFinder. A new request gets
+  // a new one.
+  auto h3 = find(epoch_t(7));
+  ASSERT_EQ(2, coalescer_.finders.size());
+  h3.reset();
+  auto h4 = find(epoch_t(7));
+  ASSERT_EQ(3, coalescer_.finders.size());
+}
+
+TEST_F(NodeSetFinderCoalescerTest, Disabled) {
+  SettingsUpdater updater;
+  updater.registerSettings(settings_);
+  updater.setFromCLI({{"read-streams-coalesce-metadata-reads", "false"}});
+  auto h1 = find(epoch_t(7));
+  auto h2 = find(epoch_t(7));
+  ASSERT_EQ(2, coalescer_.finders.size());
+}
+
+} // namespace
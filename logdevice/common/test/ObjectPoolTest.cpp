@@ -0,0 +1,79 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/ObjectPool.h"
+
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+
+namespace {
+
+struct Object {
+  char data[64];
+};
+
+using Pool = ObjectPool<Object, /*Capacity=*/2>;
+
+TEST(ObjectPoolTest, ReusesFreedBlocks) {
+  bool reused;
+  void* a = Pool::allocate(sizeof(Object), &reused);
+  EXPECT_FALSE(reused);
+  void* b = Pool::allocate(sizeof(Object), &reused);
+  EXPECT_FALSE(reused);
+
+  Pool::deallocate(a, sizeof(Object));
+  EXPECT_EQ(1, Pool::cached());
+  void* c = Pool::allocate(sizeof(Object), &reused);
+  EXPECT_TRUE(reused);
+  EXPECT_EQ(a, c);
+  EXPECT_EQ(0, Pool::cached());
+
+  Pool::deallocate(b, sizeof(Object));
+  Pool::deallocate(c, sizeof(Object));
+}
+
+TEST(ObjectPoolTest, Capacity) {
+  bool reused;
+  std::vector<void*> blocks;
+  for (int i = 0; i < 3; ++i) {
+    blocks.push_back(Pool::allocate(sizeof(Object), &reused));
+  }
+  for (void* p : blocks) {
+    Pool::deallocate(p, sizeof(Object));
+  }
+  // The third block went back to the global allocator
+  EXPECT_EQ(2, Pool::cached());
+}
+
+// Subclasses, whose size differs, are not cached
+TEST(ObjectPoolTest, OtherSizes) {
+  bool reused;
+  const size_t cached = Pool::cached();
+  void* p = Pool::allocate(sizeof(Object) + 8, &reused);
+  EXPECT_FALSE(reused);
+  Pool::deallocate(p, sizeof(Object) + 8);
+  EXPECT_EQ(cached, Pool::cached());
+}
+
+// Every thread has its own cache
+TEST(ObjectPoolTest, PerThread) {
+  bool reused;
+  void* p = Pool::allocate(sizeof(Object), &reused);
+  const size_t cached = Pool::cached();
+  std::thread([&] {
+    EXPECT_EQ(0, Pool::cached());
+    Pool::deallocate(p, sizeof(Object));
+    EXPECT_EQ(1, Pool::cached());
+  }).join();
+  EXPECT_EQ(cached, Pool::cached());
+}
+
+} // namespace
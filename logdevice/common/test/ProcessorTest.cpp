@@ -113,6 +113,55 @@ TEST_F(ProcessorTest, ThreadTargetingTest) {
   EXPECT_EQ(expected, counts);
 }
 
+// Records the order in which requests execute on each worker.
+static std::map<int, std::vector<int>> sequence_per_worker;
+static std::mutex sequence_per_worker_lock;
+
+struct SequenceRequest : public Request {
+  SequenceRequest(int worker, int seq)
+      : Request(RequestType::TEST_PROCESSOR_SEQUENCE_REQUEST),
+        worker_(worker),
+        seq_(seq) {}
+  int getThreadAffinity(int /*nthreads*/) override {
+    return worker_;
+  }
+  Request::Execution execute() override {
+    std::lock_guard<std::mutex> guard(sequence_per_worker_lock);
+    sequence_per_worker[Worker::onThisThread()->idx_.val_].push_back(seq_);
+    return Execution::COMPLETE;
+  }
+  int worker_;
+  int seq_;
+};
+
+// postRequests() delivers the requests to their workers, in order.
+TEST_F(ProcessorTest, PostRequests) {
+  Settings settings = create_default_settings<Settings>();
+  settings.num_workers = 3;
+  auto processor = make_test_processor(settings);
+
+  std::vector<std::unique_ptr<Request>> rqs;
+  std::map<int, std::vector<int>> expected;
+  for (int i = 0; i < 300; ++i) {
+    const int worker = i % 7 % 3;
+    rqs.push_back(std::make_unique<SequenceRequest>(worker, i));
+    expected[worker].push_back(i);
+  }
+  // Out of range, stays with the caller.
+  rqs.push_back(std::make_unique<SequenceRequest>(3, -1));
+
+  ASSERT_EQ(-1, processor->postRequests(rqs));
+  EXPECT_EQ(E::INVALID_PARAM, err);
+  for (size_t i = 0; i < 300; ++i) {
+    EXPECT_EQ(nullptr, rqs[i]);
+  }
+  EXPECT_NE(nullptr, rqs.back());
+
+  // Wait for the work to finish
+  processor.reset();
+  EXPECT_EQ(expected, sequence_per_worker);
+}
+
 struct TargetedNoopRequest : public Request {
   explicit TargetedNoopRequest(worker_id_t target)
       : Request(RequestType::TEST_PROCESSOR_TARGETED_NOOP_REQUEST),
@@ -16,6 +16,7 @@
 #include "event2/buffer.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/libevent/compat.h"
+#include "logdevice/common/protocol/RECORDS_Message.h"
 #include "logdevice/common/protocol/ProtocolReader.h"
 #include "logdevice/common/protocol/ProtocolWriter.h"
 #include "logdevice/common/util.h"
@@ -55,6 +56,52 @@ class RECORD_MessageTest : public ::testing::Test {
   ExtraMetadata* getExtraMetadata(const RECORD_Message& msg) {
     return msg.extra_metadata_.get();
   }
+
+  uint64_t getExpectedChecksum(const RECORD_Message& msg) {
+    return msg.expected_checksum_;
+  }
+
+  const std::shared_ptr<const void>&
+  getPayloadOwner(const RECORD_Message& msg) {
+    return msg.payload_owner_;
+  }
+
+  // Serializes `msg` and deserializes it back.
+  std::unique_ptr<RECORD_Message>
+  serializeAndBack(const RECORD_Message& msg, size_t zero_copy_min_size = 0) {
+    struct evbuffer* evbuf = LD_EV(evbuffer_new)();
+    SCOPE_EXIT {
+      LD_EV(evbuffer_free)(evbuf);
+    };
+    ProtocolWriter writer(
+        msg.type_, evbuf, Compatibility::MAX_PROTOCOL_SUPPORTED);
+    msg.serialize(writer);
+    EXPECT_GT(writer.result(), 0);
+    ProtocolReader reader(MessageType::RECORD,
+                          evbuf,
+                          LD_EV(evbuffer_get_length)(evbuf),
+                          Compatibility::MAX_PROTOCOL_SUPPORTED);
+    return checked_downcast<std::unique_ptr<RECORD_Message>>(
+        RECORD_Message::deserialize(reader, zero_copy_min_size).msg);
+  }
+
+  std::unique_ptr<RECORDS_Message>
+  serializeAndBack(const RECORDS_Message& msg) {
+    struct evbuffer* evbuf = LD_EV(evbuffer_new)();
+    SCOPE_EXIT {
+      LD_EV(evbuffer_free)(evbuf);
+    };
+    ProtocolWriter writer(
+        msg.type_, evbuf, Compatibility::MAX_PROTOCOL_SUPPORTED);
+    msg.serialize(writer);
+    EXPECT_GT(writer.result(), 0);
+    ProtocolReader reader(MessageType::RECORDS,
+                          evbuf,
+                          LD_EV(evbuffer_get_length)(evbuf),
+                          Compatibility::MAX_PROTOCOL_SUPPORTED);
+    return checked_downcast<std::unique_ptr<RECORDS_Message>>(
+        RECORDS_Message::deserialize(reader).msg);
+  }
 };
 
 TEST_F(RECORD_MessageTest, SerializationNoExtraMetadata) {
@@ -135,4 +182,134 @@ TEST_F(RECORD_MessageTest, SerializationWithExtraMetadata) {
   ASSERT_EQ(meta_copyset, read_copyset);
 }
 
+TEST_F(RECORD_MessageTest, CompressedPayload) {
+  const uint32_t checksum = 0x12345678;
+  std::string data;
+  for (int i = 0; i < 100; ++i) {
+    data += "{\"key\": \"value\", \"i\": " + std::to_string(i % 3) + "}";
+  }
+  std::string raw((const char*)&checksum, sizeof(checksum));
+  raw += data;
+
+  for (Compression c :
+       {Compression::ZSTD, Compression::LZ4, Compression::LZ4_HC}) {
+    Payload compressed = RECORD_Message::compressPayload(
+        Payload(raw.data(), raw.size()), sizeof(checksum), c);
+    ASSERT_NE(nullptr, compressed.data());
+    EXPECT_LT(compressed.size(), raw.size());
+    // The checksum is left in front.
+    EXPECT_EQ(0, memcmp(compressed.data(), &checksum, sizeof(checksum)));
+
+    RECORD_Header header = create_test_header();
+    header.flags |= RECORD_Header::COMPRESSED | RECORD_Header::CHECKSUM;
+    RECORD_Message orig(
+        header, TrafficClass::READ_TAIL, std::move(compressed), nullptr);
+    auto read = serializeAndBack(orig);
+    ASSERT_NE(nullptr, read);
+    EXPECT_EQ(checksum, getExpectedChecksum(*read));
+    EXPECT_TRUE(getHeader(*read).flags & RECORD_Header::COMPRESSED);
+
+    ASSERT_EQ(0, read->decompressPayload());
+    EXPECT_FALSE(getHeader(*read).flags & RECORD_Header::COMPRESSED);
+    EXPECT_EQ(data, read->payload_.toString());
+  }
+}
+
+// Payloads of at least zero_copy_min_size bytes are left in an evbuffer that
+// the message keeps alive, smaller ones are copied.
+TEST_F(RECORD_MessageTest, ZeroCopyPayload) {
+  const uint32_t checksum = 0x12345678;
+  std::string data(100000, 'x');
+  for (size_t i = 0; i < data.size(); i += 7) {
+    data[i] = 'a' + i % 26;
+  }
+  std::string raw((const char*)&checksum, sizeof(checksum));
+  raw += data;
+
+  RECORD_Header header = create_test_header();
+  header.flags |= RECORD_Header::CHECKSUM;
+  RECORD_Message orig(header,
+                      TrafficClass::READ_TAIL,
+                      Payload(raw.data(), raw.size()).dup(),
+                      nullptr);
+
+  auto read = serializeAndBack(orig, data.size());
+  ASSERT_NE(nullptr, read);
+  EXPECT_NE(nullptr, getPayloadOwner(*read));
+  EXPECT_EQ(checksum, getExpectedChecksum(*read));
+  EXPECT_EQ(data, read->payload_.toString());
+
+  read = serializeAndBack(orig, data.size() + 1);
+  ASSERT_NE(nullptr, read);
+  EXPECT_EQ(nullptr, getPayloadOwner(*read));
+  EXPECT_EQ(data, read->payload_.toString());
+}
+
+TEST_F(RECORD_MessageTest, IncompressiblePayload) {
+  std::string data = "abcdefgh";
+  EXPECT_EQ(nullptr,
+            RECORD_Message::compressPayload(
+                Payload(data.data(), data.size()), 0, Compression::LZ4)
+                .data());
+}
+
+TEST_F(RECORD_MessageTest, MalformedCompressedPayload) {
+  RECORD_Header header = create_test_header();
+  header.flags |= RECORD_Header::COMPRESSED;
+  std::string garbage(100, 'x');
+  RECORD_Message orig(header,
+                      TrafficClass::READ_TAIL,
+                      Payload(garbage.data(), garbage.size()).dup(),
+                      nullptr);
+  auto read = serializeAndBack(orig);
+  ASSERT_NE(nullptr, read);
+  EXPECT_EQ(-1, read->decompressPayload());
+}
+
+// Records in a RECORDS message keep their checksums and payloads, which don't
+// extend to the end of the message.
+TEST_F(RECORD_MessageTest, RecordsMessage) {
+  const uint32_t checksums[] = {0x12345678, 0x9abcdef0};
+  const std::string payloads[] = {"abc", "defgh"};
+  std::vector<std::unique_ptr<RECORD_Message>> records;
+  for (int i = 0; i < 2; ++i) {
+    RECORD_Header header = create_test_header();
+    header.lsn += i;
+    header.flags |= RECORD_Header::CHECKSUM;
+    std::string raw((const char*)&checksums[i], sizeof(checksums[i]));
+    raw += payloads[i];
+    records.push_back(std::make_unique<RECORD_Message>(
+        header,
+        TrafficClass::READ_BACKLOG,
+        Payload(raw.data(), raw.size()).dup(),
+        nullptr));
+  }
+  GAP_Header gap_header = {logid_t(333),
+                           read_stream_id_t(444),
+                           lsn_t(557),
+                           lsn_t(600),
+                           GapReason::NO_RECORDS,
+                           0,
+                           0};
+  RECORDS_Message orig(logid_t(333),
+                       read_stream_id_t(444),
+                       0,
+                       TrafficClass::READ_BACKLOG,
+                       std::move(records),
+                       std::make_unique<GAP_Message>(gap_header));
+
+  auto read = serializeAndBack(orig);
+  ASSERT_NE(nullptr, read);
+  ASSERT_EQ(2, read->records_.size());
+  for (int i = 0; i < 2; ++i) {
+    const RECORD_Message& record = *read->records_[i];
+    EXPECT_EQ(lsn_t(555 + i), getHeader(record).lsn);
+    EXPECT_EQ(checksums[i], getExpectedChecksum(record));
+    EXPECT_EQ(payloads[i], record.payload_.toString());
+  }
+  ASSERT_NE(nullptr, read->gap_);
+  EXPECT_EQ(lsn_t(557), read->gap_->getHeader().start_lsn);
+  EXPECT_EQ(lsn_t(600), read->gap_->getHeader().end_lsn);
+}
+
 }} // namespace facebook::logdevice
@@ -5,6 +5,7 @@
  * This source code is licensed under the BSD-style license found in the
  * LICENSE file in the root directory of this source tree.
  */
+#include <algorithm>
 #include <functional>
 #include <numeric>
 #include <utility>
@@ -744,3 +745,66 @@ TEST(ConsistentHashingWeightAwareNodeSetSelectorTest, AddNode) {
   EXPECT_EQ(new_totalremoved, new_totaladded);
   EXPECT_LE(new_totalremoved, 5000);
 }
+
+TEST(ConsistentHashingWeightAwareNodeSetSelectorTest, ShardLoad) {
+  // 10-node cluster with nodes in 2 different racks
+  Nodes nodes;
+  addNodes(&nodes, 5, 1, "region0.datacenter1.01.a.a");
+  addNodes(&nodes, 5, 1, "region0.datacenter1.01.a.b");
+  Configuration::NodesConfig nodes_config(std::move(nodes));
+
+  auto logs_config = std::make_shared<LocalLogsConfig>();
+  const int numlogs = 1000;
+  for (int i = 1; i <= numlogs; i++) {
+    addLog(logs_config.get(),
+           logid_t(i),
+           ReplicationProperty(
+               {{NodeLocationScope::RACK, 2}, {NodeLocationScope::NODE, 3}}),
+           0,
+           4 /* nodeset_size */);
+  }
+
+  auto config = std::make_shared<Configuration>(
+      ServerConfig::fromDataTest(
+          "nodeset_selector_test", std::move(nodes_config)),
+      std::move(logs_config));
+
+  auto selector = NodeSetSelectorFactory::create(
+      NodeSetSelectorType::CONSISTENT_HASHING_V2);
+
+  // Equal loads don't change the nodesets.
+  NodeSetSelector::Options equal_load;
+  for (node_index_t i = 0; i < 10; ++i) {
+    equal_load.shard_load[ShardID(i, 0)] = 0.5;
+  }
+  // Three of the five nodes of the first rack are full.
+  NodeSetSelector::Options full;
+  for (node_index_t i : {0, 1, 2}) {
+    full.shard_load[ShardID(i, 0)] = 1;
+  }
+
+  size_t num_full_picked = 0;
+  for (int i = 1; i <= numlogs; i++) {
+    auto res = selector->getStorageSet(logid_t(i), config, nullptr);
+    ASSERT_EQ(Decision::NEEDS_CHANGE, std::get<0>(res));
+    auto res_equal =
+        selector->getStorageSet(logid_t(i), config, nullptr, &equal_load);
+    ASSERT_EQ(Decision::NEEDS_CHANGE, std::get<0>(res_equal));
+    EXPECT_EQ(*std::get<1>(res), *std::get<1>(res_equal));
+
+    auto res_full = selector->getStorageSet(logid_t(i), config, nullptr, &full);
+    ASSERT_EQ(Decision::NEEDS_CHANGE, std::get<0>(res_full));
+    const StorageSet& ss = *std::get<1>(res_full);
+    ASSERT_EQ(4, ss.size());
+    // Still two nodes from each rack.
+    EXPECT_EQ(2, std::count_if(ss.begin(), ss.end(), [](ShardID s) {
+                return s.node() < 5;
+              }));
+    num_full_picked += std::count_if(
+        ss.begin(), ss.end(), [](ShardID s) { return s.node() < 3; });
+  }
+  // Without loads, 40% of nodesets would contain each of the full nodes.
+  // With them, the two other nodes of the rack are almost always picked
+  // instead.
+  EXPECT_LT(num_full_picked, numlogs / 10);
+}
@@ -349,6 +349,28 @@ TEST(ReaderTest, StopReadingTimeout) {
   ASSERT_EQ(0, nread);
 }
 
+/**
+ * Readers created together by Client::createReaders() split the workers
+ * between them.
+ */
+TEST(ReaderTest, WorkersForConsumer) {
+  auto workers = [](size_t consumer, size_t nconsumers, size_t nworkers) {
+    std::vector<int> out;
+    for (worker_id_t w :
+         ReaderImpl::workersForConsumer(consumer, nconsumers, nworkers)) {
+      out.push_back(w.val_);
+    }
+    return out;
+  };
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3}), workers(0, 1, 4));
+  EXPECT_EQ(std::vector<int>({0, 3, 6}), workers(0, 3, 8));
+  EXPECT_EQ(std::vector<int>({1, 4, 7}), workers(1, 3, 8));
+  EXPECT_EQ(std::vector<int>({2, 5}), workers(2, 3, 8));
+  // More consumers than workers: each consumer gets a single worker.
+  EXPECT_EQ(std::vector<int>({1}), workers(1, 4, 3));
+  EXPECT_EQ(std::vector<int>({0}), workers(3, 4, 3));
+}
+
 /**
  * If a client restarts reading a log (at a different LSN, say), any buffered
  * records should be discarded
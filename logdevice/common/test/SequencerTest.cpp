@@ -785,6 +785,29 @@ TEST_F(SequencerTest, PreemptionSimple) {
   ASSERT_FALSE(sequencer_->isPreempted());
 }
 
+TEST_F(SequencerTest, SealCheckPassed) {
+  settings_.reactivation_limit = RATE_UNLIMITED;
+  setUp();
+  ASSERT_FALSE(sequencer_->sealCheckedWithin(std::chrono::hours(1)));
+  sequencer_->startActivation([this](logid_t) { return getMetaData(); });
+  completeActivation(3);
+  ASSERT_FALSE(sequencer_->sealCheckedWithin(std::chrono::hours(1)));
+
+  // a check of an older epoch doesn't count
+  sequencer_->noteSealCheckPassed(epoch_t(2));
+  ASSERT_FALSE(sequencer_->sealCheckedWithin(std::chrono::hours(1)));
+
+  sequencer_->noteSealCheckPassed(epoch_t(3));
+  ASSERT_TRUE(sequencer_->sealCheckedWithin(std::chrono::hours(1)));
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  ASSERT_FALSE(sequencer_->sealCheckedWithin(std::chrono::milliseconds(1)));
+
+  // reactivation into a new epoch requires a new check
+  sequencer_->startActivation([this](logid_t) { return getMetaData(); });
+  completeActivation(4);
+  ASSERT_FALSE(sequencer_->sealCheckedWithin(std::chrono::hours(1)));
+}
+
 TEST_F(SequencerTest, LastReleased) {
   settings_.reactivation_limit = RATE_UNLIMITED;
   setUp();
@@ -0,0 +1,45 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/ShardLoadTracker.h"
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace facebook { namespace logdevice {
+
+using Reason = NodeSetState::NotAvailableReason;
+
+TEST(ShardLoadTrackerTest, Basic) {
+  ShardLoadTracker tracker;
+  const std::chrono::milliseconds TTL(std::chrono::minutes(5));
+  EXPECT_TRUE(tracker.getLoads(TTL).empty());
+
+  tracker.update(ShardID(1, 0), Reason::LOW_WATERMARK_NOSPC);
+  tracker.update(ShardID(2, 0), Reason::OVERLOADED);
+  // Not related to load.
+  tracker.update(ShardID(3, 0), Reason::UNROUTABLE);
+  auto loads = tracker.getLoads(TTL);
+  ASSERT_EQ(2, loads.size());
+  EXPECT_EQ(0.75, loads.at(ShardID(1, 0)));
+  EXPECT_EQ(0.5, loads.at(ShardID(2, 0)));
+
+  // The latest report wins.
+  tracker.update(ShardID(1, 0), Reason::NO_SPC);
+  tracker.update(ShardID(2, 0), Reason::NONE);
+  loads = tracker.getLoads(TTL);
+  ASSERT_EQ(1, loads.size());
+  EXPECT_EQ(1, loads.at(ShardID(1, 0)));
+
+  // Old reports are ignored.
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_TRUE(tracker.getLoads(std::chrono::milliseconds(10)).empty());
+  EXPECT_EQ(1, tracker.getLoads(TTL).size());
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,50 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/SlabArena.h"
+
+#include <cstdint>
+#include <set>
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+
+TEST(SlabArenaTest, SlotsAreReused) {
+  SlabArena arena(24, 4);
+  EXPECT_EQ(0, arena.slotSize() % alignof(std::max_align_t));
+  EXPECT_GE(arena.slotSize(), 24);
+
+  std::vector<void*> slots;
+  std::set<void*> distinct;
+  for (int i = 0; i < 6; ++i) {
+    slots.push_back(arena.allocate());
+    distinct.insert(slots.back());
+    EXPECT_EQ(0,
+              reinterpret_cast<uintptr_t>(slots.back()) %
+                  alignof(std::max_align_t));
+  }
+  EXPECT_EQ(6, distinct.size());
+  EXPECT_EQ(6, arena.slotsInUse());
+  // Two slabs of 4 slots.
+  EXPECT_EQ(2 * 4 * arena.slotSize(), arena.bytesReserved());
+
+  arena.deallocate(slots);
+  EXPECT_TRUE(slots.empty());
+  EXPECT_EQ(0, arena.slotsInUse());
+
+  // Freed slots are handed out again before new slabs are allocated.
+  for (int i = 0; i < 8; ++i) {
+    void* p = arena.allocate();
+    slots.push_back(p);
+    if (i < 6) {
+      EXPECT_EQ(1, distinct.count(p));
+    }
+  }
+  EXPECT_EQ(2 * 4 * arena.slotSize(), arena.bytesReserved());
+  arena.deallocate(slots);
+}
@@ -388,6 +388,32 @@ TEST(SlidingWindowTest, EsnExhaustion) {
             << lsn_to_esn(totals.right_edge_max).val_ << std::endl;
 }
 
+// esns_left() counts down to 0 as the ESN space of the epoch is used up
+TEST(SlidingWindowTest, EsnsLeft) {
+  Stats stats;
+  SlidingWindowSingleEpoch<Item, Item::Deleter> window(
+      EPOCH_MIN, 16, esn_t(3));
+  Item::Deleter::initLastReaped(compose_lsn(EPOCH_MIN, ESN_MIN));
+  EXPECT_EQ(3, window.esns_left());
+
+  std::vector<lsn_t> lsns;
+  for (int i = 0; i < 3; ++i) {
+    Item* it = new Item(0);
+    lsn_t lsn = window.grow(it);
+    ASSERT_NE(LSN_INVALID, lsn);
+    it->id_ = lsn;
+    lsns.push_back(lsn);
+    EXPECT_EQ(uint64_t(2 - i), window.esns_left());
+  }
+  EXPECT_FALSE(window.can_grow());
+
+  Item::Deleter deleter(&stats);
+  for (lsn_t lsn : lsns) {
+    window.retire(lsn, deleter);
+  }
+  EXPECT_EQ(0, window.esns_left());
+}
+
 TEST(SlidingWindowTest, ConditionalInsert) {
   Stats stats;
   SlidingWindowSingleEpoch<Item, Item::Deleter> window(EPOCH_MIN, 1024);
@@ -18,6 +18,10 @@ StatsHolder* TestSocketDependencies::getStats() {
   return nullptr;
 }
 
+MessageArena* TestSocketDependencies::getMessageArena() {
+  return nullptr;
+}
+
 void TestSocketDependencies::noteBytesQueued(size_t nbytes) {
   owner_->bytes_pending_ += nbytes;
 }
@@ -99,7 +103,7 @@ int TestSocketDependencies::evtimerPending(struct event*, struct timeval*) {
 }
 
 const struct timeval*
-TestSocketDependencies::getCommonTimeout(std::chrono::milliseconds /*t*/) {
+TestSocketDependencies::getCommonTimeout(std::chrono::microseconds /*t*/) {
   // This is passed to evtimerAdd and ignored.
   return nullptr;
 }
@@ -42,6 +42,7 @@ class TestSocketDependencies : public SocketDependencies {
   explicit TestSocketDependencies(SocketTest* owner) : owner_(owner) {}
   virtual const Settings& getSettings() const override;
   virtual StatsHolder* getStats() override;
+  virtual MessageArena* getMessageArena() override;
   virtual void noteBytesQueued(size_t nbytes) override;
   virtual void noteBytesDrained(size_t nbytes) override;
   virtual size_t getBytesPending() const override;
@@ -66,7 +67,7 @@ class TestSocketDependencies : public SocketDependencies {
   virtual void evtimerDel(struct event* ev) override;
   virtual int evtimerPending(struct event* ev, struct timeval* tv) override;
   virtual const struct timeval*
-  getCommonTimeout(std::chrono::milliseconds t) override;
+  getCommonTimeout(std::chrono::microseconds t) override;
   virtual const struct timeval* getZeroTimeout() override;
   virtual int evtimerAdd(struct event* ev,
                          const struct timeval* timeout) override;
@@ -405,6 +406,11 @@ class FlowGroupTest : public ClientSocketTest {
     }
   }
 
+  // Account for bytes sent by a callback as if its messages passed drain().
+  void noteSent(size_t nbytes) {
+    flow_group.bytes_drained_ += nbytes;
+  }
+
   std::mutex flow_meter_mutex;
   FlowGroup flow_group;
   FlowGroupsUpdate::GroupEntry update;
@@ -25,6 +25,7 @@
 
 #include "logdevice/common/ClientID.h"
 #include "logdevice/common/Semaphore.h"
+#include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/stats/ClientHistograms.h"
 #include "logdevice/common/stats/Histogram.h"
 #include "logdevice/common/test/TestUtil.h"
@@ -172,6 +173,40 @@ TEST(StatsTest, LatencyPercentileTest) {
   EXPECT_EQ(samples[8], (int64_t)2e14);
 }
 
+TEST(StatsTest, HighResLatencyPercentileTest) {
+  HighResLatencyHistogram h;
+
+  // Small values are exact.
+  h.add(7);
+  EXPECT_GE(h.estimatePercentile(.5), 7);
+  EXPECT_LE(h.estimatePercentile(.5), 8);
+  h.clear();
+
+  // p99 of 1ms appends with 1% of 1.3ms ones: LatencyHistogram would only
+  // tell it's within 1ms..10ms.
+  for (int i = 0; i < 990; ++i) {
+    h.add(1000);
+  }
+  for (int i = 0; i < 10; ++i) {
+    h.add(1300);
+  }
+  int64_t p = h.estimatePercentile(.995);
+  EXPECT_GE(p, 1300 - 1300 / 32);
+  EXPECT_LE(p, 1300 + 1300 / 32);
+  p = h.estimatePercentile(.5);
+  EXPECT_GE(p, 1000 - 1000 / 32);
+  EXPECT_LE(p, 1000 + 1000 / 32);
+
+  // Survives conversion to and from a map.
+  HighResLatencyHistogram copy(h.toMap("x."), "x.");
+  EXPECT_EQ(1000, copy.getCountAndSum().first);
+  EXPECT_GE(copy.estimatePercentile(.5), 1000 - 1000 / 32);
+  EXPECT_LE(copy.estimatePercentile(.5), 1000 + 1000 / 32);
+
+  EXPECT_THROW(HighResLatencyHistogram(HighResLatencyHistogram::USEC_MAX, 0),
+               std::invalid_argument);
+}
+
 TEST(StatsTest, HistogramConcurrencyTest) {
   static constexpr size_t NUM_THREADS = 16;
   static constexpr size_t ADDS_PER_THREAD = 10'000'000;
@@ -422,6 +457,35 @@ TEST(StatsTest, PerNodeTimeSeriesSumOld) {
       stats.sumAppendSuccess(now - retention_time, now + retention_time * 2));
 }
 
+TEST(StatsTest, PerLogStatsCache) {
+  FastUpdateableSharedPtr<StatsParams> params(std::make_shared<StatsParams>());
+  Stats s(&params);
+  auto config = createSimpleConfig(1, 10);
+  auto path = config->getLogGroupPath(logid_t(1));
+  ASSERT_TRUE(path.hasValue());
+
+  PerLogStats* log_stats = s.getPerLogStats(config.get(), logid_t(1));
+  ASSERT_NE(nullptr, log_stats);
+  ++log_stats->append_success;
+  EXPECT_EQ(1, s.per_log_stats.rlock()->at(path.value())->append_success);
+  // Logs of the same log group share the stats.
+  EXPECT_EQ(log_stats, s.getPerLogStats(config.get(), logid_t(2)));
+  EXPECT_EQ(nullptr, s.getPerLogStats(config.get(), logid_t(100)));
+  EXPECT_EQ(nullptr, s.getPerLogStats(nullptr, logid_t(1)));
+
+  // Bumps after a reset aren't lost in the stats the cache had.
+  s.reset();
+  log_stats = s.getPerLogStats(config.get(), logid_t(1));
+  ++log_stats->append_success;
+  EXPECT_EQ(1, s.per_log_stats.rlock()->at(path.value())->append_success);
+
+  // A new logs config drops the cached entries, but the log group keeps its
+  // stats.
+  auto new_config = createSimpleConfig(1, 10);
+  EXPECT_EQ(log_stats, s.getPerLogStats(new_config.get(), logid_t(1)));
+  EXPECT_EQ(1, s.per_log_stats.rlock()->size());
+}
+
 TEST(StatsTest, StatsParamsBuilder) {
   auto is_server = true;
   auto node_stats_retention_time_on_clients = std::chrono::seconds(42);
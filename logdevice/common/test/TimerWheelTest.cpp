@@ -0,0 +1,100 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/TimerWheel.h"
+
+#include <chrono>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+using namespace std::chrono;
+
+namespace {
+
+// Timers are declared before the wheel so that the wheel is destroyed first
+// and unlinks the ones that didn't fire.
+struct TimerWheelTest : public ::testing::Test {
+  void SetUp() override {
+    for (int i = 0; i < 8; ++i) {
+      timers[i].setCallback([this, i] { fired.push_back(i); });
+    }
+  }
+
+  void add(int i, microseconds delay) {
+    wheel.add(&timers[i], delay);
+  }
+
+  LibeventTimer timers[8];
+  std::vector<int> fired;
+  // Not driven by libevent, advance() is called directly.
+  TimerWheel wheel{nullptr};
+};
+
+} // namespace
+
+TEST_F(TimerWheelTest, FiresInOrderAcrossLevels) {
+  add(0, seconds(70)); // level 2
+  add(1, milliseconds(300)); // level 1
+  add(2, milliseconds(5)); // level 0
+  add(3, milliseconds(1));
+  add(4, milliseconds(300));
+  const auto t0 = steady_clock::now();
+  EXPECT_EQ(5, wheel.size());
+
+  wheel.advance(t0);
+  EXPECT_TRUE(fired.empty());
+
+  wheel.advance(t0 + milliseconds(3));
+  EXPECT_EQ(std::vector<int>({3}), fired);
+
+  wheel.advance(t0 + milliseconds(290));
+  EXPECT_EQ(std::vector<int>({3, 2}), fired);
+
+  wheel.advance(t0 + milliseconds(302));
+  EXPECT_EQ(std::vector<int>({3, 2, 1, 4}), fired);
+
+  wheel.advance(t0 + seconds(69));
+  EXPECT_EQ(4, fired.size());
+  wheel.advance(t0 + milliseconds(70002));
+  EXPECT_EQ(std::vector<int>({3, 2, 1, 4, 0}), fired);
+  EXPECT_EQ(0, wheel.size());
+}
+
+TEST_F(TimerWheelTest, Remove) {
+  add(0, milliseconds(10));
+  add(1, milliseconds(10));
+  add(2, seconds(1));
+  const auto t0 = steady_clock::now();
+  wheel.remove(&timers[0]);
+  wheel.remove(&timers[2]);
+  EXPECT_EQ(1, wheel.size());
+
+  wheel.advance(t0 + seconds(2));
+  EXPECT_EQ(std::vector<int>({1}), fired);
+  EXPECT_EQ(0, wheel.size());
+}
+
+// Callbacks can remove timers of the slot being fired and add new ones.
+TEST_F(TimerWheelTest, ModifiedFromCallback) {
+  timers[0].setCallback([this] {
+    fired.push_back(0);
+    wheel.remove(&timers[1]);
+    add(2, milliseconds(1));
+  });
+  add(0, milliseconds(5));
+  add(1, milliseconds(5));
+  const auto t0 = steady_clock::now();
+
+  wheel.advance(t0 + milliseconds(7));
+  EXPECT_EQ(std::vector<int>({0}), fired);
+  EXPECT_EQ(1, wheel.size());
+
+  wheel.advance(t0 + milliseconds(20));
+  EXPECT_EQ(std::vector<int>({0, 2}), fired);
+}
@@ -85,3 +85,16 @@ TEST(UtilTest, SetIfNotNull) {
     EXPECT_EQ(456, **p_ptr);
   }
 }
+
+TEST(UtilTest, ParseCpuList) {
+  std::vector<int> cpus;
+  ASSERT_EQ(0, parse_cpu_list("0-3,8,10-11\n", &cpus));
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 8, 10, 11}), cpus);
+  ASSERT_EQ(0, parse_cpu_list("", &cpus));
+  EXPECT_TRUE(cpus.empty());
+
+  EXPECT_EQ(-1, parse_cpu_list("3-1", &cpus));
+  EXPECT_EQ(-1, parse_cpu_list("1,x", &cpus));
+  EXPECT_EQ(-1, parse_cpu_list("-1", &cpus));
+  EXPECT_EQ(-1, parse_cpu_list("0-1000000", &cpus));
+}
@@ -7,6 +7,8 @@
  */
 #include <logdevice/common/WeightedCopySetSelector.h>
 
+#include <algorithm>
+
 #include <gtest/gtest.h>
 #include <logdevice/common/FailureDomainNodeSet.h>
 #include <logdevice/common/HashBasedSequencerLocator.h>
@@ -813,6 +815,35 @@ TEST_F(WeightedCopySetSelectorTest, Unblacklisting) {
   EXPECT_EQ(std::vector<ShardID>({N2, N0}), cs);
 }
 
+// With locality, the local rack is detached in a cached hierarchy that must
+// follow blacklisting and unblacklisting of nodes.
+TEST_F(WeightedCopySetSelectorTest, UnblacklistingWithLocality) {
+  addNodes("rg.dc.cl.ro.rk0", {1, 1});
+  addNodes("rg.dc.cl.ro.rk1", {1, 1});
+  addNodes("rg.dc.cl.ro.rk2", {1, 1});
+  replication_ = ReplicationProperty({{S::RACK, 2}, {S::NODE, 2}});
+
+  auto& selector = getSelector(
+      LOG_ID, /* sequencer_node */ -1, /* my_node */ 0, /* locality */ true);
+  auto count_picked = [&](ShardID shard) {
+    int picked = 0;
+    std::vector<ShardID> cs;
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_EQ(CopySetSelector::Result::SUCCESS, select(cs, selector));
+      picked += std::count(cs.begin(), cs.end(), shard);
+    }
+    return picked;
+  };
+
+  deps_.setNotAvailableNodes({N1});
+  EXPECT_EQ(0, count_picked(N1));
+  deps_.setNotAvailableNodes({N0, N1});
+  EXPECT_EQ(0, count_picked(N0));
+  EXPECT_EQ(0, count_picked(N1));
+  deps_.setNotAvailableNodes({});
+  EXPECT_GT(count_picked(N1), 0);
+}
+
 TEST_F(WeightedCopySetSelectorTest, Augment) {
   addNodes("rg.dc.cl.ro.rk0", {1, 1, 1, 1});
   addNodes("rg.dc.cl.ro.rk1", {1, 1, 1});
@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/WorkerCoroutine.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+
+namespace {
+
+// Waits for `expected' replies, then for a final acknowledgement.
+class TestCoroutine : public WorkerCoroutine {
+ public:
+  explicit TestCoroutine(int expected) : expected_(expected) {}
+
+  void start() {
+    resume();
+  }
+
+  void onReply(int value) {
+    last_ = value;
+    resume();
+  }
+
+  std::vector<std::string> steps;
+  bool finished_called = false;
+
+ protected:
+  void run() override {
+    LD_CORO_BEGIN;
+    steps.push_back("sent");
+    for (i_ = 0; i_ < expected_; ++i_) {
+      LD_CORO_YIELD;
+      steps.push_back("reply " + std::to_string(last_));
+    }
+    steps.push_back("ack");
+    LD_CORO_YIELD;
+    steps.push_back("done " + std::to_string(last_));
+    LD_CORO_END;
+  }
+
+  void onFinished() override {
+    finished_called = true;
+  }
+
+ private:
+  const int expected_;
+  int i_;
+  int last_ = -1;
+};
+
+} // namespace
+
+TEST(WorkerCoroutineTest, Basic) {
+  TestCoroutine c(2);
+  c.start();
+  EXPECT_EQ(std::vector<std::string>({"sent"}), c.steps);
+  EXPECT_FALSE(c.finished());
+
+  c.onReply(10);
+  c.onReply(11);
+  EXPECT_EQ(std::vector<std::string>({"sent", "reply 10", "reply 11", "ack"}),
+            c.steps);
+  EXPECT_FALSE(c.finished());
+  EXPECT_FALSE(c.finished_called);
+
+  c.onReply(12);
+  EXPECT_EQ("done 12", c.steps.back());
+  EXPECT_TRUE(c.finished());
+  EXPECT_TRUE(c.finished_called);
+}
+
+TEST(WorkerCoroutineTest, NoSuspension) {
+  TestCoroutine c(0);
+  c.start();
+  EXPECT_EQ(std::vector<std::string>({"sent", "ack"}), c.steps);
+  c.onReply(1);
+  EXPECT_TRUE(c.finished_called);
+}
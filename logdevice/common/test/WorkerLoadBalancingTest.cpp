@@ -82,4 +82,16 @@ TEST(WorkerLoadBalancingTest, NewWorkRebalances) {
   ASSERT_LT(after_ratio, 2.2);
 }
 
+TEST(WorkerLoadBalancingTest, LeastLoadedAndSkew) {
+  WorkerLoadBalancing balancer(4);
+  EXPECT_EQ(1, balancer.getLoadSkew(W1));
+  balancer.reportLoad(worker_id_t(0), 300);
+  balancer.reportLoad(worker_id_t(1), 50);
+  balancer.reportLoad(worker_id_t(2), 100);
+  balancer.reportLoad(worker_id_t(3), 150);
+  EXPECT_EQ(W1, balancer.selectLeastLoadedWorker());
+  EXPECT_DOUBLE_EQ(2, balancer.getLoadSkew(W0));
+  EXPECT_DOUBLE_EQ(1. / 3, balancer.getLoadSkew(W1));
+}
+
 }} // namespace facebook::logdevice
@@ -168,11 +168,41 @@ int ZookeeperClientInMemory::multiOp(int count,
     // operation within the same batch succeeds or not
     state_map_t new_map = map_;
 
+    // Like Zookeeper, reports the error of the failed set operation, ZOK for
+    // the ones before it and ZRUNTIMEINCONSISTENCY for the ones after it
+    auto fail_set = [&](int failed, int rv) {
+      for (int i = 0; i < count; ++i) {
+        results[i].err =
+            i < failed ? ZOK : i == failed ? rv : ZRUNTIMEINCONSISTENCY;
+        results[i].value = nullptr;
+        results[i].valuelen = 0;
+        results[i].stat = nullptr;
+      }
+      return rv;
+    };
+
     // Checking the input and verifying that none of the nodes exist
     for (int i = 0; i < count; ++i) {
+      if (ops[i].type == ZOO_SETDATA_OP) {
+        const auto& op = ops[i].set_op;
+        auto it = new_map.find(op.path);
+        if (it == new_map.end()) {
+          return fail_set(i, ZNONODE);
+        }
+        auto old_version = it->second.second.version_;
+        if (old_version != op.version && op.version != -1) {
+          return fail_set(i, ZBADVERSION);
+        }
+        it->second.first = std::string(op.data, op.datalen);
+        it->second.second = zk::Stat{.version_ = old_version + 1};
+        if (op.stat) {
+          op.stat->version = old_version + 1;
+        }
+        continue;
+      }
       if (ops[i].type != ZOO_CREATE_OP) {
         // no other ops supported currently
-        ld_critical("Only create operations supported in multi-ops");
+        ld_critical("Only create and set operations supported in multi-ops");
         ld_check(false);
         return -1;
       }
@@ -0,0 +1,390 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Format.h>
+#include <folly/Singleton.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/Appender.h"
+#include "logdevice/common/EpochSequencer.h"
+#include "logdevice/common/PassThroughCopySetManager.h"
+#include "logdevice/common/Processor.h"
+#include "logdevice/common/Sender.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/configuration/UpdateableConfig.h"
+#include "logdevice/common/protocol/STORED_Message.h"
+#include "logdevice/common/protocol/STORE_Message.h"
+#include "logdevice/common/request_util.h"
+#include "logdevice/common/settings/Settings.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/common/test/TestUtil.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file: benchmark of the sequencer append path, from EpochSequencer::
+ *        runAppender() to the Appender retiring on a STORED reply. Storage
+ *        nodes are mocked out: the Appender's Sender consumes the STORE and
+ *        the benchmark replies STORED with E::OK as soon as the wave was
+ *        sent, so the benchmark measures only the CPU cost of the sequencer
+ *        side of an append: sliding window insertion, copyset selection,
+ *        building the STORE, retiring and reaping.
+ *
+ *        The same EpochSequencer is shared by 1 to 16 workers appending
+ *        concurrently, which shows the contention on its SlidingWindow.
+ *        Divide the iteration count by the time per iteration and the number
+ *        of workers to get appends per second per worker.
+ *
+ *        When built standalone, the benchmark also reports the number of
+ *        heap allocations per append done on a single worker.
+ *
+ *        Run with --bm_min_usec=1000000.
+ */
+
+namespace {
+
+const logid_t LOG_ID(1);
+const epoch_t EPOCH(1);
+const size_t PAYLOAD_SIZE = 200;
+const int WINDOW_SIZE = 256;
+
+#ifndef BENCHMARK_BUNDLE
+// Heap allocations made by all threads, counted by the operator new below.
+std::atomic<size_t> allocations{0};
+#endif
+
+struct BenchmarkState {
+  StatsHolder stats{StatsParams().setIsServer(true)};
+  std::shared_ptr<CopySetManager> copyset_manager;
+  std::shared_ptr<Processor> processor;
+  std::shared_ptr<EpochSequencer> epoch_sequencer;
+
+  std::atomic<size_t> appenders_created{0};
+  std::atomic<size_t> appenders_destroyed{0};
+  // Appenders rejected with E::NOBUFS because the window was full.
+  std::atomic<size_t> appenders_nobufs{0};
+
+  explicit BenchmarkState(int num_workers);
+  ~BenchmarkState();
+};
+
+class BenchmarkEpochSequencer : public EpochSequencer {
+ public:
+  explicit BenchmarkEpochSequencer(BenchmarkState* state)
+      : EpochSequencer(LOG_ID,
+                       EPOCH,
+                       std::make_unique<EpochMetaData>(),
+                       WINDOW_SIZE,
+                       ESN_MAX,
+                       /*parent=*/nullptr),
+        state_(state) {}
+
+  void noteDrainingCompleted(Status /*status*/) override {}
+
+  bool updateLastReleased(lsn_t /*reaped_lsn*/,
+                          epoch_t* /*last_released_epoch_out*/) override {
+    return true;
+  }
+
+  Processor* getProcessor() const override {
+    return state_->processor.get();
+  }
+
+ private:
+  BenchmarkState* const state_;
+};
+
+class BenchmarkAppender : public Appender {
+ public:
+  using MockSender = SenderTestProxy<BenchmarkAppender>;
+
+  explicit BenchmarkAppender(BenchmarkState* state)
+      : Appender(Worker::onThisThread(),
+                 Worker::onThisThread()->getTraceLogger(),
+                 std::chrono::seconds(10),
+                 /* append_request_id= */ request_id_t(0),
+                 STORE_flags_t(0),
+                 LOG_ID,
+                 genPayload(),
+                 epoch_t(0),
+                 /*size=*/PAYLOAD_SIZE),
+        state_(state) {
+    sender_ = std::make_unique<MockSender>(this);
+    ++state_->appenders_created;
+  }
+
+  ~BenchmarkAppender() override {
+    epoch_sequencer_.reset();
+    ++state_->appenders_destroyed;
+  }
+
+  static PayloadHolder genPayload() {
+    void* payload = malloc(PAYLOAD_SIZE);
+    memset(payload, 'c', PAYLOAD_SIZE);
+    return PayloadHolder(payload, PAYLOAD_SIZE);
+  }
+
+  int sendMessageImpl(std::unique_ptr<Message>&& msg,
+                      const Address& /*addr*/,
+                      BWAvailableCallback*,
+                      SocketCallback*) {
+    if (msg->type_ == MessageType::STORE) {
+      auto store_msg = static_cast<STORE_Message*>(msg.get());
+      store_header_ = store_msg->getHeader();
+      shard_ = store_msg->getCopyset()[store_header_.copyset_offset]
+                   .destination;
+    }
+    return 0;
+  }
+
+  bool canSendToImpl(const Address&, TrafficClass, BWAvailableCallback&) {
+    return true;
+  }
+
+  // Simulates the socket sending the STORE and the storage node replying
+  // STORED. The Appender retires and may be deleted by this call.
+  void reply() {
+    onCopySent(E::OK, shard_, store_header_);
+    STORED_Header hdr;
+    hdr.rid = store_header_.rid;
+    hdr.wave = store_header_.wave;
+    hdr.status = E::OK;
+    hdr.redirect = NodeID();
+    hdr.flags = 0;
+    hdr.shard = shard_.shard();
+    onReply(hdr, shard_);
+  }
+
+  NodeID checkIfPreempted(epoch_t /*epoch*/) override {
+    return NodeID();
+  }
+
+  std::shared_ptr<CopySetManager> getCopySetManager() const override {
+    return state_->copyset_manager;
+  }
+
+  bool epochMetaDataAvailable(epoch_t /*epoch*/) const override {
+    return true;
+  }
+
+  void schedulePeriodicReleases() override {}
+
+  bool isDraining() const override {
+    return false;
+  }
+
+  int registerOnSocketClosed(NodeID /*nid*/, SocketCallback& /*cb*/) override {
+    return 0;
+  }
+
+  NodeLocationScope getCurrentBiggestReplicationScope() const override {
+    return NodeLocationScope::NODE;
+  }
+
+  copyset_size_t getExtras() const override {
+    return 0;
+  }
+
+  copyset_size_t getSynced() const override {
+    return 0;
+  }
+
+  bool checkNodeSet() const override {
+    return true;
+  }
+
+ private:
+  BenchmarkState* const state_;
+  STORE_Header store_header_;
+  ShardID shard_;
+};
+
+// Always selects N1 as the single copy, as in EpochSequencerTest.
+class BenchmarkCopySetSelector : public CopySetSelector {
+ public:
+  CopySetSelector::Result select(copyset_size_t /*extras*/,
+                                 StoreChainLink copyset_out[],
+                                 copyset_size_t* copyset_size_out,
+                                 bool* /*chain_out*/,
+                                 State* /*selector_state*/,
+                                 RNG&,
+                                 bool /*retry*/) const override {
+    copyset_out[0] = StoreChainLink{ShardID(1, 1), ClientID()};
+    *copyset_size_out = 1;
+    return CopySetSelector::Result::SUCCESS;
+  }
+
+  CopySetSelector::Result augment(ShardID[] /*inout_copyset*/,
+                                  copyset_size_t /*existing_copyset_size*/,
+                                  copyset_size_t* /*out_full_size*/,
+                                  RNG&,
+                                  bool /*retry*/) const override {
+    ld_check(false);
+    return CopySetSelector::Result::FAILED;
+  }
+
+  CopySetSelector::Result augment(StoreChainLink[],
+                                  copyset_size_t,
+                                  copyset_size_t*,
+                                  bool,
+                                  bool*,
+                                  RNG&,
+                                  bool) const override {
+    throw std::runtime_error("unimplemented");
+  }
+
+  copyset_size_t getReplicationFactor() const override {
+    return 1;
+  }
+};
+
+BenchmarkState::BenchmarkState(int num_workers) {
+  auto updateable_config = std::make_shared<UpdateableConfig>(
+      Configuration::fromJsonFile(TEST_CONFIG_FILE("sequencer_test.conf")));
+
+  StorageSet shards{ShardID(0, 1), ShardID(1, 1)};
+  auto nodeset_state = std::make_shared<NodeSetState>(
+      shards, LOG_ID, NodeSetState::HealthCheck::DISABLED);
+  copyset_manager.reset(new PassThroughCopySetManager(
+      std::make_unique<BenchmarkCopySetSelector>(), nodeset_state));
+  copyset_manager->disableCopySetShuffling();
+
+  Settings settings = create_default_settings<Settings>();
+  settings.num_workers = num_workers;
+  processor = make_test_processor(settings, updateable_config, &stats);
+  processor->config_->get()->serverConfig()->setMyNodeID(NodeID(1, 1));
+
+  epoch_sequencer = std::make_shared<BenchmarkEpochSequencer>(this);
+}
+
+BenchmarkState::~BenchmarkState() {
+  epoch_sequencer.reset();
+  processor.reset();
+}
+
+// Runs `n` appends on the current worker, retrying the ones rejected
+// because the window was full.
+void appendOnWorker(BenchmarkState& state, size_t n) {
+  for (size_t i = 0; i < n;) {
+    auto appender = new BenchmarkAppender(&state);
+    auto status = state.epoch_sequencer->runAppender(appender);
+    if (status == RunAppenderStatus::ERROR_DELETE) {
+      ld_check(err == E::NOBUFS);
+      delete appender;
+      ++state.appenders_nobufs;
+      continue;
+    }
+    appender->reply();
+    ++i;
+  }
+}
+
+void waitForAppenders(BenchmarkState& state) {
+  while (state.appenders_destroyed.load() < state.appenders_created.load()) {
+    std::this_thread::yield();
+  }
+}
+
+void appends(size_t iters, int num_workers) {
+  std::unique_ptr<BenchmarkState> state;
+  BENCHMARK_SUSPEND {
+    state = std::make_unique<BenchmarkState>(num_workers);
+  }
+
+  std::vector<std::thread> threads;
+  for (int w = 0; w < num_workers; ++w) {
+    const size_t n =
+        iters / num_workers + (size_t(w) < iters % num_workers ? 1 : 0);
+    threads.emplace_back([&state, w, n] {
+      run_on_worker(
+          state->processor.get(), w, [&] { appendOnWorker(*state, n); });
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // Appenders reaped by another worker may be deleted after the loops end.
+  waitForAppenders(*state);
+
+  BENCHMARK_SUSPEND {
+    if (state->appenders_nobufs.load() > 0) {
+      ld_info("%d workers: %lu appends rejected because the window was full",
+              num_workers,
+              state->appenders_nobufs.load());
+    }
+    recordBenchmarkStats(
+        folly::sformat("appends_{}_workers", num_workers), state->stats);
+    state.reset();
+  }
+}
+
+BENCHMARK_NAMED_PARAM(appends, 1_worker, 1)
+BENCHMARK_RELATIVE_NAMED_PARAM(appends, 2_workers, 2)
+BENCHMARK_RELATIVE_NAMED_PARAM(appends, 4_workers, 4)
+BENCHMARK_RELATIVE_NAMED_PARAM(appends, 8_workers, 8)
+BENCHMARK_RELATIVE_NAMED_PARAM(appends, 16_workers, 16)
+
+} // namespace
+
+#ifndef BENCHMARK_BUNDLE
+
+void* operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  void* p = malloc(size);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+void operator delete(void* p, size_t /*size*/) noexcept {
+  free(p);
+}
+
+// Heap allocations per append on a single worker. Includes the few
+// allocations of idle background threads during the run.
+void reportAllocationsPerAppend() {
+  const size_t n = 100000;
+  BenchmarkState state(1);
+  run_on_worker(state.processor.get(), 0, [&] {
+    // Warm up thread-local caches and the copyset manager state.
+    appendOnWorker(state, 1000);
+  });
+  waitForAppenders(state);
+  const size_t before = allocations.load();
+  run_on_worker(
+      state.processor.get(), 0, [&] { appendOnWorker(state, n); });
+  waitForAppenders(state);
+  const size_t after = allocations.load();
+  ld_info("%.2f heap allocations per append", double(after - before) / n);
+}
+
+int main(int argc, char** argv) {
+  folly::SingletonVault::singleton()->registrationComplete();
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  reportAllocationsPerAppend();
+  setBenchmarkParam("payload_size", PAYLOAD_SIZE);
+  setBenchmarkParam("window_size", WINDOW_SIZE);
+  runBenchmarksWithReport();
+  return 0;
+}
+
+#endif
@@ -2,10 +2,12 @@
 #include <folly/Singleton.h>
 #include <gflags/gflags.h>
 
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
+
 int main(int argc, char** argv) {
   folly::SingletonVault::singleton()->registrationComplete();
   gflags::ParseCommandLineFlags(&argc, &argv, true);
-  folly::runBenchmarks();
+  facebook::logdevice::runBenchmarksWithReport();
 
   return 0;
 }
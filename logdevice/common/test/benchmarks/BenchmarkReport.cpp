@@ -0,0 +1,233 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include <folly/Benchmark.h>
+#include <folly/FileUtil.h>
+#include <folly/String.h>
+#include <folly/json.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/BuildInfo.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/plugin/CommonBuiltinPlugins.h"
+#include "logdevice/common/plugin/PluginRegistry.h"
+#include "logdevice/common/protocol/MessageTypeNames.h"
+#include "logdevice/common/stats/Stats.h"
+
+DEFINE_string(benchmark_report,
+              "",
+              "If set, write the results of the benchmarks, their parameters, "
+              "build, host and stats to this file as JSON.");
+
+// Defined by folly. Benchmark results are written to this file in the
+// verbose JSON format, which the report is built from.
+DECLARE_string(bm_json_verbose);
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+struct ReportState {
+  std::mutex mutex;
+  folly::dynamic params = folly::dynamic::object;
+  folly::dynamic stats = folly::dynamic::object;
+};
+
+ReportState& reportState() {
+  static ReportState state;
+  return state;
+}
+
+// Simple stats and per-message-type stats; the other per-something stats
+// are totals of the simple ones or too fine-grained for a report.
+class StatsToDynamic : public Stats::EnumerationCallbacks {
+ public:
+  explicit StatsToDynamic(folly::dynamic& out) : out_(out) {}
+
+  void stat(const std::string& name, int64_t val) override {
+    out_[name] = val;
+  }
+  void stat(const std::string& name, MessageType msg, int64_t val) override {
+    out_[name + "." + messageTypeNames[msg]] = val;
+  }
+  void stat(const std::string&, shard_index_t, int64_t) override {}
+  void stat(const std::string&, TrafficClass, int64_t) override {}
+  void stat(const std::string&, NodeLocationScope, int64_t) override {}
+  void stat(const std::string&,
+            NodeLocationScope,
+            Priority,
+            int64_t) override {}
+  void stat(const std::string&, Priority, int64_t) override {}
+  void stat(const std::string&, RequestType, int64_t) override {}
+  void stat(const std::string&, StorageTaskType, int64_t) override {}
+  void stat(const std::string&, worker_id_t, uint64_t) override {}
+  void stat(const char*, const std::string&, int64_t) override {}
+  void histogram(const std::string&, const MultiScaleHistogram&) override {}
+  void histogram(const std::string&,
+                 shard_index_t,
+                 const MultiScaleHistogram&) override {}
+
+ private:
+  folly::dynamic& out_;
+};
+
+folly::dynamic commandLineParams() {
+  folly::dynamic res = folly::dynamic::object;
+  std::vector<gflags::CommandLineFlagInfo> flags;
+  gflags::GetAllFlags(&flags);
+  for (const auto& flag : flags) {
+    if (!flag.is_default && flag.name != "benchmark_report" &&
+        flag.name != "bm_json_verbose") {
+      res[flag.name] = flag.current_value;
+    }
+  }
+  return res;
+}
+
+folly::dynamic buildInfo() {
+  folly::dynamic res = folly::dynamic::object;
+  auto registry = std::make_shared<PluginRegistry>(
+      createAugmentedCommonBuiltinPluginVector<>());
+  auto build_info =
+      registry->getSinglePlugin<BuildInfo>(PluginType::BUILD_INFO);
+  if (build_info) {
+    res = folly::parseJson(build_info->getBuildInfoJson());
+    res["version"] = build_info->version();
+  }
+  return res;
+}
+
+folly::dynamic hostInfo() {
+  folly::dynamic res = folly::dynamic::object;
+  char hostname[256];
+  if (gethostname(hostname, sizeof(hostname)) == 0) {
+    hostname[sizeof(hostname) - 1] = '\0';
+    res["hostname"] = hostname;
+  }
+  struct utsname uts;
+  if (uname(&uts) == 0) {
+    res["kernel"] = folly::sformat("{} {}", uts.sysname, uts.release);
+    res["arch"] = uts.machine;
+  }
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    if (line.compare(0, 10, "model name") == 0) {
+      auto colon = line.find(':');
+      if (colon != std::string::npos) {
+        res["cpu_model"] =
+            folly::trimWhitespace(folly::StringPiece(line).subpiece(colon + 1))
+                .str();
+      }
+      break;
+    }
+  }
+  res["cpus"] = std::thread::hardware_concurrency();
+  const long pages = sysconf(_SC_PHYS_PAGES);
+  const long page_size = sysconf(_SC_PAGESIZE);
+  if (pages > 0 && page_size > 0) {
+    res["memory_bytes"] = int64_t(pages) * page_size;
+  }
+  return res;
+}
+
+// Converts folly's verbose JSON, [[file, name, ns_per_iter], ...].
+folly::dynamic benchmarkResults(const std::string& path) {
+  folly::dynamic res = folly::dynamic::array;
+  std::string contents;
+  if (!folly::readFile(path.c_str(), contents)) {
+    ld_error("Failed to read benchmark results from %s", path.c_str());
+    return res;
+  }
+  for (const auto& result : folly::parseJson(contents)) {
+    res.push_back(folly::dynamic::object("file", result[0])(
+        "name", result[1])("ns_per_iter", result[2]));
+  }
+  return res;
+}
+
+} // namespace
+
+void runBenchmarksWithReport() {
+  if (FLAGS_benchmark_report.empty()) {
+    folly::runBenchmarks();
+    return;
+  }
+
+  const bool keep_verbose_json = !FLAGS_bm_json_verbose.empty();
+  if (!keep_verbose_json) {
+    FLAGS_bm_json_verbose = FLAGS_benchmark_report + ".folly";
+  }
+  const auto start = std::chrono::system_clock::now();
+  folly::runBenchmarks();
+
+  char exe[4096];
+  ssize_t len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+  std::string benchmark = len > 0 ? std::string(exe, len) : "";
+  benchmark = benchmark.substr(benchmark.rfind('/') + 1);
+
+  folly::dynamic report = folly::dynamic::object;
+  report["benchmark"] = benchmark;
+  report["start_time"] =
+      std::chrono::duration_cast<std::chrono::seconds>(start.time_since_epoch())
+          .count();
+  report["build"] = buildInfo();
+  report["host"] = hostInfo();
+  report["results"] = benchmarkResults(FLAGS_bm_json_verbose);
+  {
+    ReportState& state = reportState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    folly::dynamic params = commandLineParams();
+    params.update(state.params);
+    report["params"] = std::move(params);
+    report["stats"] = state.stats;
+  }
+
+  if (!keep_verbose_json) {
+    unlink(FLAGS_bm_json_verbose.c_str());
+  }
+  if (!folly::writeFile(folly::toPrettyJson(report) + "\n",
+                        FLAGS_benchmark_report.c_str())) {
+    ld_error("Failed to write benchmark report to %s: %s",
+             FLAGS_benchmark_report.c_str(),
+             strerror(errno));
+  }
+}
+
+void setBenchmarkParam(const std::string& name, folly::dynamic value) {
+  ReportState& state = reportState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.params[name] = std::move(value);
+}
+
+void recordBenchmarkStats(const std::string& label, const StatsHolder& stats) {
+  if (FLAGS_benchmark_report.empty()) {
+    return;
+  }
+  folly::dynamic snapshot = folly::dynamic::object;
+  StatsToDynamic cb(snapshot);
+  stats.aggregate().enumerate(&cb, /* list_all */ false);
+
+  ReportState& state = reportState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.stats[label] = std::move(snapshot);
+}
+
+}} // namespace facebook::logdevice
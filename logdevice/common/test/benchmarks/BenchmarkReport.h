@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <string>
+
+#include <folly/dynamic.h>
+
+namespace facebook { namespace logdevice {
+
+class StatsHolder;
+
+/**
+ * @file Machine-readable output of the LogDevice benchmarks, for tracking
+ *       their results across commits. With --benchmark_report=<path>,
+ *       runBenchmarksWithReport() writes to <path> a JSON object with:
+ *
+ *       - "benchmark": the name of the binary;
+ *       - "params": the command line flags that were set and the parameters
+ *         registered with setBenchmarkParam();
+ *       - "build": the version and fields of the BuildInfo plugin;
+ *       - "host": hostname, kernel, CPU model, number of CPUs and memory;
+ *       - "results": [{"file", "name", "ns_per_iter"}] for every benchmark
+ *         folly ran;
+ *       - "stats": the snapshots taken with recordBenchmarkStats().
+ *
+ *       Without the flag, it's the same as folly::runBenchmarks().
+ */
+
+/**
+ * Runs all registered folly benchmarks, prints their results as usual and
+ * writes the report if --benchmark_report is set. Benchmark mains call this
+ * instead of folly::runBenchmarks().
+ */
+void runBenchmarksWithReport();
+
+/**
+ * Records a parameter of the workload that isn't a command line flag.
+ */
+void setBenchmarkParam(const std::string& name, folly::dynamic value);
+
+/**
+ * Records the simple and per-message-type stats aggregated from `stats`
+ * under `label`. A later snapshot with the same label replaces it, so a
+ * benchmark function that folly runs several times reports its last run.
+ */
+void recordBenchmarkStats(const std::string& label, const StatsHolder& stats);
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,192 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Varint.h>
+#include <gflags/gflags.h>
+#include <zstd.h>
+
+#include "logdevice/common/DataRecordOwnsPayload.h"
+#include "logdevice/common/buffered_writer/BufferedWriteDecoderImpl.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/RECORD_Message.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file: decoding of BufferedWriter batches as done by readers: the existing
+ *        per-batch decode path, including the DataRecord that readers create
+ *        for every record in a batch, compared to decodeBatch().
+ */
+
+DEFINE_int32(batches, 64, "number of batches decoded at once");
+DEFINE_int32(records_per_batch, 256, "number of records in every batch");
+DEFINE_int32(payload_size, 32, "size of the records in the batches");
+
+namespace {
+
+using Flags = BufferedWriteDecoderImpl::Flags;
+
+void appendVarint(std::string& out, uint64_t value) {
+  uint8_t buf[folly::kMaxVarintLength64];
+  size_t len = folly::encodeVarint(value, buf);
+  out.append(reinterpret_cast<const char*>(buf), len);
+}
+
+// Builds a batch in the format written by BufferedWriter.
+std::string makeBlob(Compression compression) {
+  std::string payloads;
+  for (int i = 0; i < FLAGS_records_per_batch; ++i) {
+    appendVarint(payloads, FLAGS_payload_size);
+    payloads.append(FLAGS_payload_size, 'a' + i % 26);
+  }
+
+  std::string blob;
+  blob.push_back(static_cast<char>(0xb1));
+  blob.push_back(
+      static_cast<char>(Flags::SIZE_INCLUDED | static_cast<int>(compression)));
+  appendVarint(blob, FLAGS_records_per_batch);
+  if (compression == Compression::NONE) {
+    return blob + payloads;
+  }
+  ld_check(compression == Compression::ZSTD);
+  appendVarint(blob, payloads.size());
+  std::string compressed(ZSTD_compressBound(payloads.size()), '\0');
+  size_t size = ZSTD_compress(&compressed[0],
+                              compressed.size(),
+                              payloads.data(),
+                              payloads.size(),
+                              /* compressionLevel */ 5);
+  ld_check(!ZSTD_isError(size));
+  return blob + compressed.substr(0, size);
+}
+
+std::vector<std::unique_ptr<DataRecord>> makeRecords(const std::string& blob) {
+  std::vector<std::unique_ptr<DataRecord>> records;
+  for (int i = 0; i < FLAGS_batches; ++i) {
+    void* buf = malloc(blob.size());
+    memcpy(buf, blob.data(), blob.size());
+    records.push_back(std::make_unique<DataRecordOwnsPayload>(
+        logid_t(1),
+        Payload(buf, blob.size()),
+        lsn_t(i + 1),
+        std::chrono::milliseconds(0),
+        RECORD_flags_t(RECORD_Header::BUFFERED_WRITER_BLOB)));
+  }
+  return records;
+}
+
+// What readers do today: decodeOne() every batch, then wrap every record
+// into its own DataRecord sharing ownership of the decoder.
+void decodeOneToDataRecords(int n, Compression compression) {
+  std::string blob;
+  BENCHMARK_SUSPEND {
+    blob = makeBlob(compression);
+  }
+  for (int iter = 0; iter < n; ++iter) {
+    std::vector<std::unique_ptr<DataRecord>> records;
+    BENCHMARK_SUSPEND {
+      records = makeRecords(blob);
+    }
+    std::vector<std::unique_ptr<DataRecord>> out;
+    for (auto& record : records) {
+      const lsn_t lsn = record->attrs.lsn;
+      auto decoder = std::make_shared<BufferedWriteDecoderImpl>();
+      std::vector<Payload> payloads;
+      decoder->decodeOne(std::move(record), payloads);
+      int batch_offset = 0;
+      for (Payload& payload : payloads) {
+        out.push_back(std::make_unique<DataRecordOwnsPayload>(
+            logid_t(1),
+            std::move(payload),
+            lsn,
+            std::chrono::milliseconds(0),
+            RECORD_flags_t(0),
+            nullptr,
+            decoder,
+            batch_offset++));
+      }
+    }
+    folly::doNotOptimizeAway(out);
+  }
+}
+
+void decode(int n, Compression compression) {
+  std::string blob;
+  BENCHMARK_SUSPEND {
+    blob = makeBlob(compression);
+  }
+  for (int iter = 0; iter < n; ++iter) {
+    std::vector<std::unique_ptr<DataRecord>> records;
+    BENCHMARK_SUSPEND {
+      records = makeRecords(blob);
+    }
+    BufferedWriteDecoderImpl decoder;
+    std::vector<Payload> payloads;
+    decoder.decode(std::move(records), payloads);
+    folly::doNotOptimizeAway(payloads);
+  }
+}
+
+void decodeBatch(int n, Compression compression) {
+  std::string blob;
+  BENCHMARK_SUSPEND {
+    blob = makeBlob(compression);
+  }
+  for (int iter = 0; iter < n; ++iter) {
+    std::vector<std::unique_ptr<DataRecord>> records;
+    BENCHMARK_SUSPEND {
+      records = makeRecords(blob);
+    }
+    BufferedWriteDecoderImpl decoder;
+    std::vector<BufferedWriteDecoder::RecordView> views;
+    decoder.decodeBatch(std::move(records), views);
+    folly::doNotOptimizeAway(views);
+  }
+}
+
+} // namespace
+
+BENCHMARK(DecodeOneToDataRecordsNone, n) {
+  decodeOneToDataRecords(n, Compression::NONE);
+}
+
+BENCHMARK_RELATIVE(DecodeNone, n) {
+  decode(n, Compression::NONE);
+}
+
+BENCHMARK_RELATIVE(DecodeBatchNone, n) {
+  decodeBatch(n, Compression::NONE);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(DecodeOneToDataRecordsZstd, n) {
+  decodeOneToDataRecords(n, Compression::ZSTD);
+}
+
+BENCHMARK_RELATIVE(DecodeZstd, n) {
+  decode(n, Compression::ZSTD);
+}
+
+BENCHMARK_RELATIVE(DecodeBatchZstd, n) {
+  decodeBatch(n, Compression::ZSTD);
+}
+
+#ifndef BENCHMARK_BUNDLE
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  runBenchmarksWithReport();
+  return 0;
+}
+#endif
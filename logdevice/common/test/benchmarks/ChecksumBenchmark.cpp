@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <iostream>
+#include <string>
+
+#include <folly/Benchmark.h>
+#include <folly/hash/Checksum.h>
+#include <folly/hash/detail/ChecksumDetail.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/Checksum.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file Benchmark of the payload and protocol checksums: checksum_32bit()
+ *       (CRC32C, which folly computes with the SSE4.2 instruction when the
+ *       CPU has it), the portable CRC32C that folly falls back to otherwise,
+ *       and checksum_64bit() (SpookyHashV2), for typical payload sizes.
+ *
+ *       Run with --bm_min_usec=1000000.
+ */
+
+namespace {
+
+// 1MB of pseudo-random bytes, enough for the largest size benchmarked
+const char* payload() {
+  static std::string buf = [] {
+    std::string s(1 << 20, '\0');
+    for (size_t i = 0; i < s.size(); ++i) {
+      s[i] = static_cast<char>(i * 2654435761u >> 24);
+    }
+    return s;
+  }();
+  return buf.data();
+}
+
+void crc32c(size_t iters, size_t size) {
+  const char* data = payload();
+  uint32_t res = 0;
+  for (size_t i = 0; i < iters; ++i) {
+    res ^= checksum_32bit(Slice(data, size));
+  }
+  folly::doNotOptimizeAway(res);
+}
+
+void crc32c_sw(size_t iters, size_t size) {
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(payload());
+  uint32_t res = 0;
+  for (size_t i = 0; i < iters; ++i) {
+    res ^= folly::detail::crc32c_sw(data, size);
+  }
+  folly::doNotOptimizeAway(res);
+}
+
+void spooky64(size_t iters, size_t size) {
+  const char* data = payload();
+  uint64_t res = 0;
+  for (size_t i = 0; i < iters; ++i) {
+    res ^= checksum_64bit(Slice(data, size));
+  }
+  folly::doNotOptimizeAway(res);
+}
+
+#define BENCH(size)                                             \
+  BENCHMARK_NAMED_PARAM(crc32c, size##_bytes, size)             \
+  BENCHMARK_RELATIVE_NAMED_PARAM(crc32c_sw, size##_bytes, size) \
+  BENCHMARK_RELATIVE_NAMED_PARAM(spooky64, size##_bytes, size)  \
+  BENCHMARK_DRAW_LINE();
+
+BENCH(64)
+BENCH(512)
+BENCH(4096)
+BENCH(32768)
+BENCH(1048576)
+
+} // namespace
+
+#ifndef BENCHMARK_BUNDLE
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::cout << "CRC32C hardware support: "
+            << (folly::detail::crc32c_hw_supported() ? "yes" : "no")
+            << std::endl;
+  runBenchmarksWithReport();
+
+  return 0;
+}
+
+#endif
@@ -0,0 +1,412 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include <folly/Benchmark.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/DataRecordOwnsPayload.h"
+#include "logdevice/common/ShardAuthoritativeStatusMap.h"
+#include "logdevice/common/client_read_stream/ClientReadStream.h"
+#include "logdevice/common/configuration/LocalLogsConfig.h"
+#include "logdevice/common/configuration/UpdateableConfig.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/GAP_Message.h"
+#include "logdevice/common/protocol/STARTED_Message.h"
+#include "logdevice/common/settings/Settings.h"
+#include "logdevice/common/test/MockBackoffTimer.h"
+#include "logdevice/common/test/MockTimer.h"
+#include "logdevice/common/test/TestUtil.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file Benchmark of the client CPU cost of a ClientReadStream reading from
+ *       large nodesets. Records and gaps from N simulated storage shards are
+ *       fed to the read stream directly, with dependencies that, like
+ *       MockClientReadStreamDependencies in ClientReadStreamTest, capture
+ *       outgoing messages and never touch a Worker.
+ *
+ *       - records_all_send_all: every record arrives from the 3 shards of its
+ *         copyset, and ClientReadStream deduplicates them;
+ *       - records_scd: every record arrives once, from its primary copy;
+ *       - gap_detection: half of the LSNs are missing, and each shard sends a
+ *         gap past its single record of a round of 2 * N LSNs, so that the
+ *         read stream has to find f-majorities of shards without the missing
+ *         records before reporting them;
+ *       - scd_failover: one shard is added to the known down list, the
+ *         stream is rewound, and all N shards reply to the new START.
+ *
+ *       The first three report the time per LSN, the last one per failover.
+ *       Buffer operations are part of all of them; the buffer
+ *       implementations alone are compared by ClientReadStreamBufferBenchmark.
+ */
+
+namespace {
+
+const logid_t LOG_ID(1);
+const size_t REPLICATION = 3;
+const size_t BUFFER_SIZE = 4096;
+
+lsn_t lsn(esn_t::raw_type esn) {
+  return compose_lsn(EPOCH_MIN, esn_t(esn));
+}
+
+// Outgoing messages are only counted, the read stream's callbacks accept
+// everything, and timers never fire on their own.
+class BenchmarkDeps : public ClientReadStreamDependencies {
+ public:
+  explicit BenchmarkDeps(EpochMetaData metadata)
+      : metadata_(std::move(metadata)),
+        settings_(create_default_settings<Settings>()) {}
+
+  void getMetaDataForEpoch(read_stream_id_t /*rsid*/,
+                           epoch_t epoch,
+                           MetaDataLogReader::Callback cb,
+                           bool /*allow_from_cache*/,
+                           bool /*require_consistent_from_cache*/) override {
+    cb(E::OK,
+       MetaDataLogReader::Result{LOG_ID,
+                                 epoch,
+                                 lsn_to_epoch(LSN_MAX),
+                                 MetaDataLogReader::RecordSource::LAST,
+                                 compose_lsn(epoch, esn_t(1)),
+                                 std::chrono::milliseconds(0),
+                                 std::make_unique<EpochMetaData>(metadata_)});
+  }
+
+  void updateEpochMetaDataCache(epoch_t,
+                                epoch_t,
+                                const EpochMetaData&,
+                                MetaDataLogReader::RecordSource) override {}
+
+  int sendStartMessage(ShardID /*shard*/,
+                       SocketCallback* /*onclose*/,
+                       START_Header header,
+                       const small_shardset_t& /*filtered_out*/,
+                       const ReadStreamAttributes* /*attrs*/) override {
+    filter_version = header.filter_version;
+    ++starts;
+    return 0;
+  }
+
+  int sendStopMessage(ShardID /*shard*/) override {
+    return 0;
+  }
+
+  int sendWindowMessage(ShardID /*shard*/,
+                        lsn_t /*window_low*/,
+                        lsn_t /*window_high*/,
+                        std::chrono::microseconds /*max_delay*/) override {
+    ++windows;
+    return 0;
+  }
+
+  bool recordCallback(std::unique_ptr<DataRecord>& /*record*/) override {
+    ++records;
+    return true;
+  }
+
+  size_t getMaxRecordBatchSize() const override {
+    return 0;
+  }
+
+  bool gapCallback(const GapRecord& /*gap*/) override {
+    ++gaps;
+    return true;
+  }
+
+  void dispose() override {}
+
+  std::unique_ptr<BackoffTimer>
+  createBackoffTimer(std::chrono::milliseconds,
+                     std::chrono::milliseconds) override {
+    return std::make_unique<MockBackoffTimer>();
+  }
+
+  std::unique_ptr<BackoffTimer> createBackoffTimer(
+      const chrono_expbackoff_t<std::chrono::milliseconds>&) override {
+    return std::make_unique<MockBackoffTimer>();
+  }
+
+  std::unique_ptr<Timer>
+  createTimer(std::function<void()> cb = nullptr) override {
+    auto timer = std::make_unique<MockTimer>(std::move(cb));
+    // ClientReadStream::start() creates the immediate rewind timer first.
+    if (rewind_timer == nullptr) {
+      rewind_timer = timer.get();
+    }
+    return std::move(timer);
+  }
+
+  std::chrono::milliseconds reserveReconnect(ShardID /*shard*/) override {
+    return std::chrono::milliseconds(0);
+  }
+
+  TimeoutMap* getCommonTimeouts() override {
+    return nullptr;
+  }
+
+  std::function<ClientReadStream*(read_stream_id_t)>
+  getStreamByIDCallback() override {
+    return [this](read_stream_id_t) { return stream; };
+  }
+
+  const Settings& getSettings() const override {
+    return settings_;
+  }
+
+  ShardAuthoritativeStatusMap getShardStatus() const override {
+    return ShardAuthoritativeStatusMap();
+  }
+
+  void refreshClusterState() override {}
+
+  folly::Optional<uint16_t>
+  getSocketProtocolVersion(node_index_t /*nid*/) const override {
+    return Compatibility::MAX_PROTOCOL_SUPPORTED;
+  }
+
+  bool hasMemoryPressure() const override {
+    return false;
+  }
+
+  void onBufferedBytesChanged(int64_t /*delta*/) override {}
+
+  ClientReadStream* stream = nullptr;
+  MockTimer* rewind_timer = nullptr;
+  filter_version_t filter_version{0};
+  size_t starts = 0;
+  size_t windows = 0;
+  size_t records = 0;
+  size_t gaps = 0;
+
+ private:
+  EpochMetaData metadata_;
+  Settings settings_;
+};
+
+// A ClientReadStream of LOG_ID reading from a nodeset of `nodeset_size`
+// single-shard nodes, all of which replied STARTED.
+class Reader {
+ public:
+  Reader(size_t nodeset_size, bool scd)
+      : config_(std::make_shared<UpdateableConfig>()) {
+    configuration::Nodes nodes;
+    for (size_t i = 0; i < nodeset_size; ++i) {
+      Configuration::Node& node = nodes[i];
+      node.address = Sockaddr("::1", folly::to<std::string>(4440 + i));
+      node.generation = 1;
+      node.addSequencerRole();
+      node.addStorageRole();
+      shards_.push_back(ShardID(node_index_t(i), 0));
+    }
+    Configuration::Log log{};
+    log.rangeName = "log";
+    log.replicationFactor = REPLICATION;
+    log.scdEnabled = scd;
+    Configuration::NodesConfig nodes_config(std::move(nodes));
+    auto logs_config = std::make_shared<configuration::LocalLogsConfig>();
+    logs_config->insert(boost::icl::right_open_interval<logid_t::raw_type>(
+                            LOG_ID.val_, LOG_ID.val_ + 1),
+                        log);
+    auto meta_config = createMetaDataLogsConfig(nodes_config, 5, REPLICATION);
+    config_->updateableServerConfig()->update(
+        ServerConfig::fromDataTest(__FILE__, nodes_config, meta_config));
+    config_->updateableLogsConfig()->update(std::move(logs_config));
+
+    EpochMetaData metadata(shards_,
+                           ReplicationProperty(REPLICATION,
+                                               NodeLocationScope::NODE),
+                           EPOCH_MIN,
+                           EPOCH_MIN);
+    auto deps = std::make_unique<BenchmarkDeps>(std::move(metadata));
+    deps_ = deps.get();
+    stream_ = std::make_unique<ClientReadStream>(
+        read_stream_id_t(1),
+        LOG_ID,
+        lsn(1),
+        LSN_MAX,
+        0.5,
+        ClientReadStreamBufferType::CIRCULAR,
+        BUFFER_SIZE,
+        std::move(deps),
+        config_);
+    deps_->stream = stream_.get();
+    stream_->start();
+    onStartSentAndStarted();
+  }
+
+  // Replies to the START messages the read stream sent to all shards.
+  void onStartSentAndStarted() {
+    STARTED_Header header{LOG_ID,
+                          read_stream_id_t(1),
+                          E::OK,
+                          deps_->filter_version,
+                          LSN_INVALID,
+                          /*shard_idx*/ 0};
+    for (ShardID shard : shards_) {
+      stream_->onStartSent(shard, E::OK);
+      stream_->onStarted(shard, STARTED_Message(header));
+    }
+  }
+
+  void record(ShardID from, lsn_t lsn, RECORD_flags_t flags = 0) {
+    static const char data[] = "benchmark record payload";
+    void* payload = malloc(sizeof(data));
+    memcpy(payload, data, sizeof(data));
+    stream_->onDataRecord(
+        from,
+        std::make_unique<DataRecordOwnsPayload>(
+            LOG_ID,
+            Payload(payload, sizeof(data)),
+            lsn,
+            std::chrono::milliseconds(0),
+            flags));
+  }
+
+  void gap(ShardID from, lsn_t lo, lsn_t hi) {
+    GAP_Header header{LOG_ID,
+                      read_stream_id_t(1),
+                      lo,
+                      hi,
+                      GapReason::NO_RECORDS,
+                      GAP_flags_t{0},
+                      /*shard*/ 0};
+    stream_->onGap(from, GAP_Message(header));
+  }
+
+  // Fires the rewind scheduled by the read stream, if any.
+  void rewind() {
+    if (deps_->rewind_timer->isActive()) {
+      deps_->rewind_timer->trigger();
+    }
+  }
+
+  ShardID shard(size_t i) const {
+    return shards_[i % shards_.size()];
+  }
+
+  size_t nodesetSize() const {
+    return shards_.size();
+  }
+
+  BenchmarkDeps& deps() {
+    return *deps_;
+  }
+
+ private:
+  std::shared_ptr<UpdateableConfig> config_;
+  StorageSet shards_;
+  BenchmarkDeps* deps_;
+  std::unique_ptr<ClientReadStream> stream_;
+};
+
+void records_all_send_all(size_t iters, size_t nodeset_size) {
+  std::unique_ptr<Reader> reader;
+  BENCHMARK_SUSPEND {
+    dbg::currentLevel = dbg::Level::ERROR;
+    reader = std::make_unique<Reader>(nodeset_size, false);
+  }
+  for (size_t i = 1; i <= iters; ++i) {
+    for (size_t r = 0; r < REPLICATION; ++r) {
+      reader->record(reader->shard(i + r), lsn(i));
+    }
+  }
+  BENCHMARK_SUSPEND {
+    ld_check(reader->deps().records == iters);
+    reader.reset();
+  }
+}
+
+void records_scd(size_t iters, size_t nodeset_size) {
+  std::unique_ptr<Reader> reader;
+  BENCHMARK_SUSPEND {
+    dbg::currentLevel = dbg::Level::ERROR;
+    reader = std::make_unique<Reader>(nodeset_size, true);
+  }
+  for (size_t i = 1; i <= iters; ++i) {
+    reader->record(reader->shard(i), lsn(i));
+  }
+  BENCHMARK_SUSPEND {
+    ld_check(reader->deps().records == iters);
+    reader.reset();
+  }
+}
+
+void gap_detection(size_t iters, size_t nodeset_size) {
+  std::unique_ptr<Reader> reader;
+  BENCHMARK_SUSPEND {
+    dbg::currentLevel = dbg::Level::ERROR;
+    reader = std::make_unique<Reader>(nodeset_size, false);
+  }
+  // In each round of 2 * N LSNs, shard s has the record at offset 2 * s, and
+  // nothing else. The LSN after each record was lost.
+  const size_t round = 2 * nodeset_size;
+  for (size_t lo = 1; lo < iters + 1; lo += round) {
+    const lsn_t hi = lsn(lo + round - 1);
+    for (size_t s = 0; s < nodeset_size; ++s) {
+      const lsn_t record = lsn(lo + 2 * s);
+      reader->record(reader->shard(s), record);
+      reader->gap(reader->shard(s), record + 1, hi);
+    }
+  }
+  BENCHMARK_SUSPEND {
+    reader.reset();
+  }
+}
+
+void scd_failover(size_t iters, size_t nodeset_size) {
+  std::unique_ptr<Reader> reader;
+  for (size_t i = 0; i < iters; ++i) {
+    BENCHMARK_SUSPEND {
+      dbg::currentLevel = dbg::Level::ERROR;
+      reader = std::make_unique<Reader>(nodeset_size, true);
+      // Some records delivered, so that the rewind starts past the start.
+      for (size_t j = 1; j <= 100; ++j) {
+        reader->record(reader->shard(j), lsn(j));
+      }
+    }
+    // A record in an under-replicated region makes the read stream add the
+    // shard to the known down list and rewind the stream.
+    reader->record(
+        reader->shard(0), lsn(101), RECORD_Header::UNDER_REPLICATED_REGION);
+    reader->rewind();
+    reader->onStartSentAndStarted();
+    BENCHMARK_SUSPEND {
+      reader.reset();
+    }
+  }
+}
+
+#define BENCH(n)                                                 \
+  BENCHMARK_NAMED_PARAM(records_all_send_all, nodeset_##n, n)    \
+  BENCHMARK_RELATIVE_NAMED_PARAM(records_scd, nodeset_##n, n)    \
+  BENCHMARK_RELATIVE_NAMED_PARAM(gap_detection, nodeset_##n, n)  \
+  BENCHMARK_NAMED_PARAM(scd_failover, nodeset_##n, n)            \
+  BENCHMARK_DRAW_LINE();
+
+BENCH(6)
+BENCH(50)
+BENCH(100)
+BENCH(200)
+
+} // namespace
+
+#ifndef BENCHMARK_BUNDLE
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  runBenchmarksWithReport();
+  return 0;
+}
+
+#endif
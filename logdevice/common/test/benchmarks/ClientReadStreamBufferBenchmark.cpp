@@ -0,0 +1,95 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <folly/Benchmark.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/DataRecordOwnsPayload.h"
+#include "logdevice/common/client_read_stream/ClientReadStream.h"
+#include "logdevice/common/client_read_stream/ClientReadStreamBufferFactory.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file Benchmark of the ClientReadStreamBuffer implementations: circular,
+ *       ordered map and hybrid. Each iteration fills the window of a buffer
+ *       with markers, every `stride' LSNs, in reverse order as records that
+ *       arrive out of order would, then drains it the way ClientReadStream
+ *       does, finding the first marker and advancing the buffer head to it.
+ *
+ *       Run with --bm_min_usec=1000000.
+ */
+
+namespace {
+
+constexpr size_t CAPACITY = 4096;
+
+void fillAndDrain(size_t iters,
+                  ClientReadStreamBufferType type,
+                  size_t stride) {
+  std::unique_ptr<ClientReadStreamBuffer> buf;
+  BENCHMARK_SUSPEND {
+    buf = ClientReadStreamBufferFactory::create(type, CAPACITY, lsn_t(1));
+  }
+  for (size_t it = 0; it < iters; ++it) {
+    const lsn_t head = buf->getBufferHead();
+    for (size_t i = CAPACITY; i >= stride; i -= stride) {
+      buf->createOrGet(head + i - 1)->gap = true;
+    }
+    while (true) {
+      auto marker = buf->findFirstMarker();
+      if (marker.first == nullptr) {
+        break;
+      }
+      buf->advanceBufferHead(marker.second - buf->getBufferHead());
+      marker.first->gap = false;
+      buf->popFront();
+      buf->advanceBufferHead();
+    }
+    buf->advanceBufferHead(head + CAPACITY - buf->getBufferHead());
+  }
+}
+
+void circular(size_t iters, size_t stride) {
+  fillAndDrain(iters, ClientReadStreamBufferType::CIRCULAR, stride);
+}
+
+void ordered_map(size_t iters, size_t stride) {
+  fillAndDrain(iters, ClientReadStreamBufferType::ORDERED_MAP, stride);
+}
+
+void hybrid(size_t iters, size_t stride) {
+  fillAndDrain(iters, ClientReadStreamBufferType::HYBRID, stride);
+}
+
+#define BENCH(stride)                                                  \
+  BENCHMARK_NAMED_PARAM(circular, stride_##stride, stride)             \
+  BENCHMARK_RELATIVE_NAMED_PARAM(ordered_map, stride_##stride, stride) \
+  BENCHMARK_RELATIVE_NAMED_PARAM(hybrid, stride_##stride, stride)      \
+  BENCHMARK_DRAW_LINE();
+
+// Every LSN is a record.
+BENCH(1)
+// A record every few LSNs, in dense chunks of the hybrid buffer.
+BENCH(8)
+// Records sparse enough for the hybrid buffer's chunks to stay sparse.
+BENCH(64)
+// Mostly gaps.
+BENCH(1024)
+
+} // namespace
+
+#ifndef BENCHMARK_BUNDLE
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  runBenchmarksWithReport();
+  return 0;
+}
+
+#endif
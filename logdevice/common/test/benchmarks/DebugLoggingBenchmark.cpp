@@ -13,6 +13,7 @@
 #include <gflags/gflags.h>
 
 #include "logdevice/common/debug.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
 
 using namespace facebook::logdevice;
 
@@ -67,7 +68,7 @@ BENCHMARK(LoggingOverridesMulti, n) {
 int main(int argc, char** argv) {
   folly::SingletonVault::singleton()->registrationComplete();
   gflags::ParseCommandLineFlags(&argc, &argv, true);
-  folly::runBenchmarks();
+  runBenchmarksWithReport();
 
   return 0;
 }
@@ -0,0 +1,95 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <folly/Benchmark.h>
+#include <gflags/gflags.h>
+
+#include "event2/buffer.h"
+#include "logdevice/common/libevent/compat.h"
+#include "logdevice/common/protocol/GOSSIP_Message.h"
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file Benchmark of writing and reading GOSSIP messages of large clusters,
+ *       with and without the compact gossip lists of
+ *       GOSSIP_COMPACT_LISTS_SUPPORT.
+ *
+ *       Run with --bm_min_usec=1000000.
+ */
+
+namespace {
+
+std::unique_ptr<GOSSIP_Message> makeMessage(size_t num_nodes) {
+  GOSSIP_Message::gossip_list_t gossip_list(num_nodes);
+  GOSSIP_Message::gossip_ts_t gossip_ts(num_nodes);
+  for (size_t i = 0; i < num_nodes; ++i) {
+    // Mostly live nodes, heard from a few gossip intervals ago, that started
+    // within a few days of each other.
+    gossip_list[i] = i % 7;
+    gossip_ts[i] = std::chrono::milliseconds(1500000000000 + i * 100000);
+  }
+  return std::make_unique<GOSSIP_Message>(NodeID(0, 1),
+                                          std::move(gossip_list),
+                                          std::chrono::milliseconds(1),
+                                          std::chrono::milliseconds(1),
+                                          std::move(gossip_ts),
+                                          GOSSIP_Message::failover_list_t(),
+                                          GOSSIP_Message::suspect_matrix_t(),
+                                          GOSSIP_Message::boycott_list_t());
+}
+
+void roundTrip(size_t iters, size_t num_nodes, uint16_t proto) {
+  std::unique_ptr<GOSSIP_Message> msg;
+  struct evbuffer* evbuf;
+  BENCHMARK_SUSPEND {
+    msg = makeMessage(num_nodes);
+    evbuf = LD_EV(evbuffer_new)();
+  }
+  for (size_t it = 0; it < iters; ++it) {
+    ProtocolWriter writer(msg->type_, evbuf, proto);
+    msg->serialize(writer);
+    ProtocolReader reader(msg->type_, evbuf, writer.result(), proto);
+    auto res = GOSSIP_Message::deserialize(reader);
+    folly::doNotOptimizeAway(res.msg);
+  }
+  BENCHMARK_SUSPEND {
+    LD_EV(evbuffer_free)(evbuf);
+  }
+}
+
+void full(size_t iters, size_t num_nodes) {
+  roundTrip(iters, num_nodes, Compatibility::GOSSIP_COMPACT_LISTS_SUPPORT - 1);
+}
+
+void compact(size_t iters, size_t num_nodes) {
+  roundTrip(iters, num_nodes, Compatibility::GOSSIP_COMPACT_LISTS_SUPPORT);
+}
+
+#define BENCH(num_nodes)                                                \
+  BENCHMARK_NAMED_PARAM(full, nodes_##num_nodes, num_nodes)             \
+  BENCHMARK_RELATIVE_NAMED_PARAM(compact, nodes_##num_nodes, num_nodes) \
+  BENCHMARK_DRAW_LINE();
+
+BENCH(100)
+BENCH(1000)
+BENCH(5000)
+
+} // namespace
+
+#ifndef BENCHMARK_BUNDLE
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  runBenchmarksWithReport();
+  return 0;
+}
+
+#endif
@@ -23,6 +23,7 @@
 #include "event2/bufferevent.h"
 #include "event2/event.h"
 #include "logdevice/common/libevent/compat.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
 
 namespace {
 
@@ -135,7 +136,7 @@ BENCH(131072);
 
 int main(int argc, char** argv) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
-  folly::runBenchmarks();
+  facebook::logdevice::runBenchmarksWithReport();
 
   return 0;
 }
@@ -0,0 +1,276 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <folly/Benchmark.h>
+#include <gflags/gflags.h>
+
+#include "event2/buffer.h"
+#include "logdevice/common/PayloadHolder.h"
+#include "logdevice/common/libevent/compat.h"
+#include "logdevice/common/protocol/APPENDED_Message.h"
+#include "logdevice/common/protocol/APPEND_Message.h"
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/GAP_Message.h"
+#include "logdevice/common/protocol/MessageDeserializers.h"
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/protocol/RECORD_Message.h"
+#include "logdevice/common/protocol/STORED_Message.h"
+#include "logdevice/common/protocol/STORE_Message.h"
+#include "logdevice/common/settings/Settings.h"
+#include "logdevice/common/settings/util.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file: benchmark of the serialization and deserialization of the messages
+ *        of the append and read paths (STORE, STORED, APPEND, APPENDED,
+ *        RECORD and GAP), for different payload sizes, with and without
+ *        protocol checksums. For each message:
+ *         - serialize: ProtocolWriter serialization into an evbuffer, as
+ *           Socket::serializeMessage() does, plus the checksum of the
+ *           serialized message if enabled;
+ *         - roundTrip: the same, followed by the checksum of the received
+ *           bytes if enabled and the deserialization with ProtocolReader,
+ *           as Socket does when receiving a message. The deserialization
+ *           cost is the difference between the two.
+ *
+ *        MessageSerializationTest checks that the messages round trip
+ *        correctly; this benchmark does not.
+ *
+ *        Run with --bm_min_usec=1000000.
+ */
+
+namespace {
+
+const uint16_t PROTO = Compatibility::MAX_PROTOCOL_SUPPORTED;
+
+const Settings& settings() {
+  static const Settings settings = create_default_settings<Settings>();
+  return settings;
+}
+
+PayloadHolder copyPayload(const std::string& payload) {
+  void* data = malloc(payload.size());
+  memcpy(data, payload.data(), payload.size());
+  return PayloadHolder(data, payload.size());
+}
+
+// Creates a message of the given type. Messages with a payload get
+// `payload`, which must outlive the message.
+std::unique_ptr<Message> makeMessage(MessageType type,
+                                     const std::string& payload) {
+  const RecordID rid(esn_t(42), epoch_t(7), logid_t(1));
+  switch (type) {
+    case MessageType::STORE: {
+      STORE_Header header{rid,
+                          1500000000000,
+                          esn_t(41),
+                          1, // wave
+                          STORE_Header::CHECKSUM_PARITY,
+                          0, // nsync
+                          0, // copyset offset
+                          3, // copyset size
+                          10000,
+                          NodeID(1, 1)};
+      StoreChainLink copyset[] = {{ShardID(1, 0), ClientID(4)},
+                                  {ShardID(2, 0), ClientID(5)},
+                                  {ShardID(3, 0), ClientID(6)}};
+      return std::make_unique<STORE_Message>(
+          header,
+          copyset,
+          0,
+          0,
+          STORE_Extra(),
+          std::map<KeyType, std::string>(),
+          std::make_shared<PayloadHolder>(
+              Payload(payload.data(), payload.size()),
+              PayloadHolder::UNOWNED));
+    }
+    case MessageType::STORED: {
+      STORED_Header header{
+          rid, 1, E::OK, NodeID(), STORED_Header::SYNCED, shard_index_t(0)};
+      return std::make_unique<STORED_Message>(header,
+                                              LSN_INVALID,
+                                              0,
+                                              LOG_REBUILDING_ID_INVALID,
+                                              FlushToken_INVALID,
+                                              ServerInstanceId_INVALID,
+                                              ShardID());
+    }
+    case MessageType::APPEND: {
+      APPEND_Header header{request_id_t(1),
+                           logid_t(1),
+                           epoch_t(7),
+                           10000,
+                           APPEND_Header::CHECKSUM_64BIT};
+      return std::make_unique<APPEND_Message>(
+          header, LSN_INVALID, AppendAttributes(), copyPayload(payload));
+    }
+    case MessageType::APPENDED: {
+      APPENDED_Header header{request_id_t(1),
+                             rid.lsn(),
+                             RecordTimestamp(std::chrono::milliseconds(1)),
+                             NodeID(),
+                             E::OK,
+                             APPENDED_flags_t(0)};
+      return std::make_unique<APPENDED_Message>(header);
+    }
+    case MessageType::RECORD: {
+      RECORD_Header header{logid_t(1),
+                           read_stream_id_t(1),
+                           rid.lsn(),
+                           1500000000000,
+                           RECORD_Header::CHECKSUM_PARITY,
+                           shard_index_t(0)};
+      return std::make_unique<RECORD_Message>(
+          header,
+          TrafficClass::READ_TAIL,
+          Payload(payload.data(), payload.size()).dup(),
+          nullptr);
+    }
+    case MessageType::GAP: {
+      GAP_Header header{logid_t(1),
+                        read_stream_id_t(1),
+                        rid.lsn(),
+                        rid.lsn() + 1000,
+                        GapReason::NO_RECORDS,
+                        GAP_flags_t(0),
+                        shard_index_t(0)};
+      return std::make_unique<GAP_Message>(header);
+    }
+    default:
+      ld_check(false);
+      return nullptr;
+  }
+}
+
+// Deserializes as Socket would on a worker with default settings. Some
+// deserializers read the settings from the Worker, which this benchmark
+// does not run on.
+std::unique_ptr<Message> deserialize(MessageType type, ProtocolReader& reader) {
+  switch (type) {
+    case MessageType::STORE:
+      return STORE_Message::deserialize(reader,
+                                        settings().max_payload_inline)
+          .msg;
+    case MessageType::APPEND:
+      return APPEND_Message::deserialize(reader,
+                                         settings().max_payload_inline)
+          .msg;
+    case MessageType::RECORD:
+      return RECORD_Message::deserialize(
+                 reader, settings().client_record_payload_zero_copy_min_size)
+          .msg;
+    default:
+      return messageDeserializers[type](reader).msg;
+  }
+}
+
+void run(size_t iters,
+         MessageType type,
+         size_t payload_size,
+         bool checksum,
+         bool deserialize_message) {
+  std::string payload;
+  std::unique_ptr<Message> msg;
+  struct evbuffer* evbuf;
+  BENCHMARK_SUSPEND {
+    payload.assign(payload_size, 'x');
+    msg = makeMessage(type, payload);
+    evbuf = LD_EV(evbuffer_new)();
+  }
+
+  for (size_t i = 0; i < iters; ++i) {
+    ProtocolWriter writer(type, evbuf, PROTO);
+    msg->serialize(writer);
+    const ssize_t len = writer.result();
+    ld_check(len > 0);
+    if (checksum) {
+      folly::doNotOptimizeAway(writer.computeChecksum());
+    }
+    if (!deserialize_message) {
+      LD_EV(evbuffer_drain)(evbuf, len);
+      continue;
+    }
+    ProtocolReader reader(type, evbuf, len, PROTO);
+    if (checksum) {
+      folly::doNotOptimizeAway(reader.computeChecksum(len));
+    }
+    auto received = deserialize(type, reader);
+    ld_check(received);
+    folly::doNotOptimizeAway(received);
+  }
+
+  BENCHMARK_SUSPEND {
+    msg.reset();
+    LD_EV(evbuffer_free)(evbuf);
+  }
+}
+
+void serialize(size_t iters, MessageType type, size_t payload_size) {
+  run(iters, type, payload_size, false, false);
+}
+void serializeChecksum(size_t iters, MessageType type, size_t payload_size) {
+  run(iters, type, payload_size, true, false);
+}
+void roundTrip(size_t iters, MessageType type, size_t payload_size) {
+  run(iters, type, payload_size, false, true);
+}
+void roundTripChecksum(size_t iters, MessageType type, size_t payload_size) {
+  run(iters, type, payload_size, true, true);
+}
+
+#define BENCH(type, payload_size)                                  \
+  BENCHMARK_NAMED_PARAM(serialize,                                 \
+                        type##_##payload_size,                     \
+                        MessageType::type,                         \
+                        payload_size)                              \
+  BENCHMARK_RELATIVE_NAMED_PARAM(serializeChecksum,                \
+                                 type##_##payload_size,            \
+                                 MessageType::type,                \
+                                 payload_size)                     \
+  BENCHMARK_NAMED_PARAM(roundTrip,                                 \
+                        type##_##payload_size,                     \
+                        MessageType::type,                         \
+                        payload_size)                              \
+  BENCHMARK_RELATIVE_NAMED_PARAM(roundTripChecksum,                \
+                                 type##_##payload_size,            \
+                                 MessageType::type,                \
+                                 payload_size)                     \
+  BENCHMARK_DRAW_LINE();
+
+BENCH(STORE, 100)
+BENCH(STORE, 1000)
+BENCH(STORE, 16000)
+BENCH(STORED, 0)
+BENCH(APPEND, 100)
+BENCH(APPEND, 1000)
+BENCH(APPEND, 16000)
+BENCH(APPENDED, 0)
+BENCH(RECORD, 100)
+BENCH(RECORD, 1000)
+BENCH(RECORD, 16000)
+BENCH(GAP, 0)
+
+} // namespace
+
+#ifndef BENCHMARK_BUNDLE
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  runBenchmarksWithReport();
+  return 0;
+}
+
+#endif
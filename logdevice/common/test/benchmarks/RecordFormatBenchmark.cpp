@@ -0,0 +1,122 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <iostream>
+#include <string>
+
+#include <folly/Benchmark.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/LocalLogStoreRecordFormat.h"
+#include "logdevice/common/protocol/STORE_Message.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file Benchmark of parsing record headers in the local log store format,
+ *       the default one and the one with FLAG_COMPACT_HEADER, for a typical
+ *       small record: 3 copies, offset within epoch, a find key and a 16 byte
+ *       payload.
+ *
+ *       Run with --bm_min_usec=1000000.
+ */
+
+namespace {
+
+std::string makeRecord(bool compact) {
+  STORE_Header header;
+  header.rid = {esn_t(111), epoch_t(222), logid_t(333)};
+  header.timestamp = 1500000000000;
+  header.last_known_good = esn_t(110);
+  header.wave = 1;
+  header.flags = STORE_Header::CHECKSUM | STORE_Header::OFFSET_WITHIN_EPOCH;
+  header.copyset_size = 3;
+  STORE_Extra extra;
+  extra.offset_within_epoch = 123456789;
+  const StoreChainLink copyset[] = {{ShardID(12, 3), ClientID()},
+                                    {ShardID(47, 3), ClientID()},
+                                    {ShardID(105, 3), ClientID()}};
+  std::map<KeyType, std::string> optional_keys{
+      {KeyType::FINDKEY, std::string("0000000012345678")}};
+
+  std::string buf;
+  Slice header_blob = LocalLogStoreRecordFormat::formRecordHeader(
+      header, copyset, &buf, true, optional_keys, extra, compact);
+  return std::string(reinterpret_cast<const char*>(header_blob.data),
+                     header_blob.size) +
+      std::string(16, 'x');
+}
+
+void parseRecord(size_t iters, bool compact) {
+  std::string record;
+  BENCHMARK_SUSPEND {
+    record = makeRecord(compact);
+    setBenchmarkParam(compact ? "compact_record_size" : "record_size",
+                      static_cast<int64_t>(record.size()));
+  }
+  const Slice blob(record.data(), record.size());
+  std::chrono::milliseconds timestamp;
+  LocalLogStoreRecordFormat::flags_t flags;
+  uint32_t wave;
+  copyset_size_t copyset_size;
+  ShardID copyset[COPYSET_SIZE_MAX];
+  uint64_t offset_within_epoch;
+  Payload payload;
+  for (size_t i = 0; i < iters; ++i) {
+    int rv = LocalLogStoreRecordFormat::parse(blob,
+                                              &timestamp,
+                                              nullptr,
+                                              &flags,
+                                              &wave,
+                                              &copyset_size,
+                                              copyset,
+                                              COPYSET_SIZE_MAX,
+                                              &offset_within_epoch,
+                                              nullptr,
+                                              &payload,
+                                              -1 /* unused */);
+    folly::doNotOptimizeAway(rv);
+    folly::doNotOptimizeAway(copyset[0]);
+    folly::doNotOptimizeAway(payload.size());
+  }
+}
+
+void getCopysetHash(size_t iters, bool compact) {
+  std::string record;
+  BENCHMARK_SUSPEND {
+    record = makeRecord(compact);
+  }
+  const Slice blob(record.data(), record.size());
+  size_t hash = 0;
+  for (size_t i = 0; i < iters; ++i) {
+    LocalLogStoreRecordFormat::getCopysetHash(blob, &hash);
+    folly::doNotOptimizeAway(hash);
+  }
+}
+
+BENCHMARK_NAMED_PARAM(parseRecord, default, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(parseRecord, compact, true)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_NAMED_PARAM(getCopysetHash, default, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(getCopysetHash, compact, true)
+
+} // namespace
+
+#ifndef BENCHMARK_BUNDLE
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  std::cout << "Record size: " << makeRecord(false).size()
+            << " bytes, compact: " << makeRecord(true).size() << " bytes"
+            << std::endl;
+  runBenchmarksWithReport();
+
+  return 0;
+}
+
+#endif
@@ -16,10 +16,12 @@
 #include <folly/Memory.h>
 #include <folly/SharedMutex.h>
 #include <folly/ThreadLocal.h>
+#include <folly/concurrency/ConcurrentHashMap.h>
 #include <gflags/gflags.h>
 #include <google/dense_hash_map>
 
 #include "logdevice/common/UpdateableSharedPtr.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/include/Err.h"
 
@@ -29,8 +31,11 @@ namespace {
 
 /**
  * @file Benchmark comparing access and update performance of folly's
- *       AtomicHashMap, and a std::unorderd_map protected by folly's
- *       SharedMutex.
+ *       AtomicHashMap and ConcurrentHashMap, and a std::unorderd_map protected
+ *       by folly's SharedMutex. The ReadsInThreads benchmarks compare the map
+ *       AllSequencers used to have (dense_hash_map behind a SharedMutex) with
+ *       the one it uses now (ConcurrentHashMap) for different numbers of
+ *       workers doing lookups.
  *
  *       Run with --bm_min_usec=1000000.
  */
@@ -352,6 +357,39 @@ logid_t* Map::find(const logid_t& k) {
 }
 } // namespace dense_map_of_shared_ptrs
 
+namespace concurrent_map_of_shared_ptrs {
+class Map {
+  using MapType = folly::ConcurrentHashMap<logid_t::raw_type,
+                                           std::shared_ptr<logid_t>,
+                                           Hash64<logid_t::raw_type>>;
+
+ public:
+  int insert(const logid_t& k);
+  int erase(const logid_t& k);
+  logid_t* find(const logid_t& k);
+
+ private:
+  MapType map_;
+};
+
+int Map::insert(const logid_t& k) {
+  auto insertion_result = map_.insert(k.val(), std::make_shared<logid_t>(k));
+  return insertion_result.second ? 0 : 1;
+}
+
+int Map::erase(const logid_t& k) {
+  return map_.erase(k.val_);
+}
+
+logid_t* Map::find(const logid_t& k) {
+  auto it = map_.find(k.val_);
+  if (it == map_.cend()) {
+    return nullptr;
+  }
+  return it->second.get();
+}
+} // namespace concurrent_map_of_shared_ptrs
+
 template <typename Map>
 void benchInit(Map& m) {
   BENCHMARK_SUSPEND {
@@ -463,10 +501,9 @@ void benchWritesWhenReading(int n) {
 }
 
 template <class MapType>
-void benchReadsIn10Threads(int n) {
+void benchReadsInThreads(int n, int nthreads) {
   MapType map;
-  std::atomic<bool> shutdown{false};
-  std::vector<std::thread> threads(10);
+  std::vector<std::thread> threads(nthreads);
   int threadNumber{1};
 
   benchInit(map);
@@ -486,6 +523,19 @@ void benchReadsIn10Threads(int n) {
   }
 }
 
+template <class MapType>
+void benchReadsIn10Threads(int n) {
+  benchReadsInThreads<MapType>(n, 10);
+}
+
+void readsInThreads_DenseMapOfSharedPtrs(int n, int nthreads) {
+  benchReadsInThreads<dense_map_of_shared_ptrs::Map>(n, nthreads);
+}
+
+void readsInThreads_ConcurrentMapOfSharedPtrs(int n, int nthreads) {
+  benchReadsInThreads<concurrent_map_of_shared_ptrs::Map>(n, nthreads);
+}
+
 #define BENCH(name)                                               \
   BENCHMARK(name##_AtomicMapOfPtrs, n) {                          \
     bench##name<atomic_map_of_ptrs::Map>(n);                      \
@@ -505,6 +555,14 @@ void benchReadsIn10Threads(int n) {
   BENCHMARK_RELATIVE(name##_DenseMapOfSharedPtrs, n) {            \
     bench##name<dense_map_of_shared_ptrs::Map>(n);                \
   }                                                               \
+  BENCHMARK_RELATIVE(name##_ConcurrentMapOfSharedPtrs, n) {       \
+    bench##name<concurrent_map_of_shared_ptrs::Map>(n);           \
+  }                                                               \
+  BENCHMARK_DRAW_LINE();
+
+#define BENCH_READS_IN_THREADS(nthreads)                                      \
+  BENCHMARK_PARAM(readsInThreads_DenseMapOfSharedPtrs, nthreads)              \
+  BENCHMARK_RELATIVE_PARAM(readsInThreads_ConcurrentMapOfSharedPtrs, nthreads) \
   BENCHMARK_DRAW_LINE();
 
 BENCH(Reads);
@@ -513,13 +571,20 @@ BENCH(ReadsWhenWriting);
 BENCH(WritesWhenReading);
 BENCH(ReadsIn10Threads);
 
+BENCH_READS_IN_THREADS(1)
+BENCH_READS_IN_THREADS(2)
+BENCH_READS_IN_THREADS(4)
+BENCH_READS_IN_THREADS(8)
+BENCH_READS_IN_THREADS(16)
+BENCH_READS_IN_THREADS(32)
+
 } // namespace
 
 #ifndef BENCHMARK_BUNDLE
 
 int main(int argc, char** argv) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
-  folly::runBenchmarks();
+  runBenchmarksWithReport();
 
   return 0;
 }
@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <thread>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/Semaphore.h"
+#include "logdevice/common/stats/Histogram.h"
+#include "logdevice/common/stats/ServerHistograms.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file Benchmark of StatsHolder::aggregate(), what StatsCollectionThread
+ *       does on each collection cycle, with the server stats of many threads.
+ *       Like on a real server, only a few of the histograms of each thread
+ *       have values.
+ *
+ *       Run with --bm_min_usec=1000000.
+ */
+
+namespace {
+
+void aggregate(size_t iters, size_t nthreads) {
+  std::unique_ptr<StatsHolder> holder;
+  std::vector<std::thread> threads;
+  Semaphore ready;
+  Semaphore done;
+  BENCHMARK_SUSPEND {
+    holder = std::make_unique<StatsHolder>(StatsParams().setIsServer(true));
+    for (size_t i = 0; i < nthreads; ++i) {
+      threads.emplace_back([&, i] {
+        Stats& stats = holder->get();
+        ++stats.num_connections;
+        for (int64_t v = 0; v < 1000; ++v) {
+          stats.server_histograms->append_latency.add(v * (i + 1));
+        }
+        ready.post();
+        // Keep the thread-local stats alive until the benchmark is done.
+        done.wait();
+      });
+    }
+    for (size_t i = 0; i < nthreads; ++i) {
+      ready.wait();
+    }
+  }
+  for (size_t it = 0; it < iters; ++it) {
+    Stats stats = holder->aggregate();
+    folly::doNotOptimizeAway(stats.num_connections);
+  }
+  BENCHMARK_SUSPEND {
+    for (size_t i = 0; i < nthreads; ++i) {
+      done.post();
+    }
+    for (std::thread& t : threads) {
+      t.join();
+    }
+    holder.reset();
+  }
+}
+
+BENCHMARK_PARAM(aggregate, 1)
+BENCHMARK_PARAM(aggregate, 16)
+BENCHMARK_PARAM(aggregate, 64)
+
+} // namespace
+
+#ifndef BENCHMARK_BUNDLE
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  runBenchmarksWithReport();
+  return 0;
+}
+
+#endif
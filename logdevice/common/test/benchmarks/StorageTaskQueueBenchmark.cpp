@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
+#include "logdevice/server/storage_tasks/PrioritizedQueue.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file Benchmark of the enqueue/dequeue throughput of PrioritizedQueue, the
+ *       queue between worker threads and storage threads, with many producers
+ *       (workers) and a few consumers (storage threads) contending on it.
+ *
+ *       Run with --bm_min_usec=1000000.
+ */
+
+namespace {
+
+constexpr size_t kNumPriorities = 3;
+
+struct Item {
+  size_t getPriority() const {
+    return priority;
+  }
+  size_t priority;
+};
+
+using Queue = PrioritizedQueue<Item*, kNumPriorities>;
+
+// Each of `nproducers` threads enqueues about n / nproducers items with
+// rotating priorities, `nconsumers` threads dequeue all of them.
+void benchContended(int n, int nproducers, int nconsumers) {
+  std::unique_ptr<Queue> queue;
+  std::vector<Item> items;
+  BENCHMARK_SUSPEND {
+    queue = std::make_unique<Queue>(1024, nullptr);
+    for (size_t i = 0; i < kNumPriorities; ++i) {
+      items.push_back(Item{i});
+    }
+  }
+
+  const int per_producer = std::max(1, n / nproducers);
+  const int total = per_producer * nproducers;
+  std::atomic<int> consumed{0};
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < nproducers; ++p) {
+    threads.emplace_back([&, p] {
+      for (int i = 0; i < per_producer; ++i) {
+        queue->blockingWrite(&items[(i + p) % kNumPriorities]);
+      }
+    });
+  }
+  for (int c = 0; c < nconsumers; ++c) {
+    threads.emplace_back([&] {
+      Item* item;
+      // Claim an item before reading so that consumers stop exactly after
+      // `total` reads in total.
+      while (consumed.fetch_add(1) < total) {
+        queue->blockingRead(item);
+        folly::doNotOptimizeAway(item);
+      }
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+}
+
+void benchUncontended(int n) {
+  Queue queue(1024, nullptr);
+  Item item{1};
+  Item* out;
+  for (int i = 0; i < n; ++i) {
+    queue.writeIfNotFull(&item);
+    queue.read(out);
+    folly::doNotOptimizeAway(out);
+  }
+}
+
+} // namespace
+
+BENCHMARK(Uncontended, n) {
+  benchUncontended(n);
+}
+
+BENCHMARK_DRAW_LINE();
+
+#define BENCH_CONTENDED(producers, consumers)                 \
+  BENCHMARK(Producers##producers##_Consumers##consumers, n) { \
+    benchContended(n, producers, consumers);                  \
+  }
+
+BENCH_CONTENDED(1, 1)
+BENCH_CONTENDED(8, 2)
+BENCH_CONTENDED(16, 4)
+BENCH_CONTENDED(48, 2)
+BENCH_CONTENDED(48, 8)
+
+#ifndef BENCHMARK_BUNDLE
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  runBenchmarksWithReport();
+
+  return 0;
+}
+#endif
@@ -12,6 +12,7 @@
 #include <gflags/gflags.h>
 
 #include "logdevice/common/UpdateableSharedPtr.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
 
 using namespace facebook::logdevice;
 
@@ -186,7 +187,7 @@ BENCH(ReadsIn10Threads)
 
 int main(int argc, char** argv) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
-  folly::runBenchmarks();
+  runBenchmarksWithReport();
 
   return 0;
 }
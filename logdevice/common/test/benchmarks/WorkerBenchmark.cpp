@@ -13,6 +13,7 @@
 #include "logdevice/common/Semaphore.h"
 #include "logdevice/common/Timestamp.h"
 #include "logdevice/common/test/TestUtil.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
 #include "logdevice/common/types_internal.h"
 
 namespace facebook { namespace logdevice {
@@ -95,7 +96,7 @@ BENCHMARK(WorkerBenchmark, n) {
 int main(int argc, char** argv) {
   folly::SingletonVault::singleton()->registrationComplete();
   gflags::ParseCommandLineFlags(&argc, &argv, true);
-  folly::runBenchmarks();
+  facebook::logdevice::runBenchmarksWithReport();
   return 0;
 }
 #endif
@@ -329,6 +329,10 @@ constexpr int FIND_TIME_KEY_SIZE = 8;
 // Used for requesting the findKey indexes to be written in RocksDB.
 constexpr char FIND_KEY_INDEX = 'k';
 
+// Used for the per-partition ranges of filterable keys in RocksDB. Unlike the
+// above, it's only written to the partition's metadata, never as IndexKeys.
+constexpr char FILTERABLE_KEY_INDEX = 'F';
+
 /**
  * Config version used to detect stale configs.
  */
@@ -12,12 +12,16 @@
 #include <cstdlib>
 #include <cstring>
 #include <errno.h>
+#include <fstream>
 #include <limits.h>
+#include <pthread.h>
 #include <pwd.h>
+#include <sched.h>
 #include <signal.h>
 
 #include <folly/Format.h>
 #include <folly/Singleton.h>
+#include <folly/String.h>
 #include <sys/prctl.h>
 #include <sys/syscall.h>
 
@@ -491,6 +495,91 @@ int get_io_priority_of_this_thread(std::pair<int, int>* out_prio) {
   return 0;
 }
 
+int parse_cpu_list(const std::string& list, std::vector<int>* out) {
+  ld_check(out);
+  out->clear();
+  std::vector<std::string> ranges;
+  folly::split(",", folly::trimWhitespace(list), ranges, true);
+  for (const std::string& range : ranges) {
+    int first, last;
+    folly::StringPiece first_str, last_str;
+    if (!folly::split('-', range, first_str, last_str)) {
+      first_str = last_str = range;
+    }
+    auto first_res = folly::tryTo<int>(first_str);
+    auto last_res = folly::tryTo<int>(last_str);
+    if (!first_res.hasValue() || !last_res.hasValue()) {
+      return -1;
+    }
+    first = first_res.value();
+    last = last_res.value();
+    if (first < 0 || last < first || last >= CPU_SETSIZE) {
+      return -1;
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      out->push_back(cpu);
+    }
+  }
+  return 0;
+}
+
+int bind_this_thread_to_cpus(const std::vector<int>& cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+      ld_error("Invalid CPU %d", cpu);
+      return -1;
+    }
+    CPU_SET(cpu, &set);
+  }
+  int rv = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if (rv != 0) {
+    ld_error("pthread_setaffinity_np() failed: %s", strerror(rv));
+    return -1;
+  }
+  return 0;
+}
+
+int bind_this_thread_to_numa_node(int node) {
+  // Not using libnuma to avoid the dependency; the kernel exposes everything
+  // we need.
+  const std::string path =
+      folly::sformat("/sys/devices/system/node/node{}/cpulist", node);
+  std::ifstream file(path);
+  std::string cpulist;
+  if (!file || !std::getline(file, cpulist)) {
+    ld_error("Failed to read %s. Does NUMA node %d exist?", path.c_str(), node);
+    return -1;
+  }
+
+  std::vector<int> cpus;
+  if (parse_cpu_list(cpulist, &cpus) != 0) {
+    ld_error("Unexpected contents of %s: %s", path.c_str(), cpulist.c_str());
+    return -1;
+  }
+  int rv = bind_this_thread_to_cpus(cpus);
+  if (rv != 0) {
+    return -1;
+  }
+
+  constexpr int MPOL_PREFERRED = 1; // from linux/mempolicy.h
+  constexpr size_t kMaxNodes = 1024;
+  constexpr size_t kBitsPerWord = 8 * sizeof(unsigned long);
+  if (node < 0 || static_cast<size_t>(node) >= kMaxNodes) {
+    ld_error("Invalid NUMA node %d", node);
+    return -1;
+  }
+  unsigned long nodemask[kMaxNodes / kBitsPerWord] = {};
+  nodemask[node / kBitsPerWord] |= 1ul << (node % kBitsPerWord);
+  rv = syscall(SYS_set_mempolicy, MPOL_PREFERRED, nodemask, kMaxNodes);
+  if (rv != 0) {
+    ld_error("set_mempolicy() failed: %s", strerror(errno));
+    return -1;
+  }
+  return 0;
+}
+
 std::string lowerCase(std::string s) {
   std::transform(s.begin(), s.end(), s.begin(), ::tolower);
   return s;
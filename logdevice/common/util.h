@@ -482,6 +482,26 @@ void set_if_not_null(std::add_pointer_t<folly::remove_cvref_t<T>> output,
 int set_io_priority_of_this_thread(std::pair<int, int> prio);
 int get_io_priority_of_this_thread(std::pair<int, int>* out_prio);
 
+/**
+ * Parses a CPU list in the format of /sys/devices/system/node/node0/cpulist
+ * and the cpuset(7) "List format", e.g. "0-7,16-23", into `out`.
+ * @return 0 on success, -1 if the list is malformed
+ */
+int parse_cpu_list(const std::string& list, std::vector<int>* out);
+
+/**
+ * Restricts the calling thread to the given CPUs.
+ * @return 0 on success, -1 on error
+ */
+int bind_this_thread_to_cpus(const std::vector<int>& cpus);
+
+/**
+ * Restricts the calling thread to the CPUs of NUMA node `node` and makes it
+ * prefer allocating memory from that node (set_mempolicy(MPOL_PREFERRED)).
+ * @return 0 on success, -1 on error
+ */
+int bind_this_thread_to_numa_node(int node);
+
 /* Template to remove duplicates from vector of objects */
 template <typename T>
 void removeDuplicates(std::vector<T>* out_objects) {
@@ -9,6 +9,7 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "logdevice/include/Record.h"
 #include "logdevice/include/types.h"
@@ -57,6 +58,30 @@ class AsyncReader {
   virtual void
   setRecordCallback(std::function<bool(std::unique_ptr<DataRecord>&)>) = 0;
 
+  /**
+   * Sets a callback that the LogDevice client library will call with
+   * batches of consecutive records of a log, instead of calling the record
+   * callback once per record. This saves the per-record overhead of
+   * delivery for applications that read at high rates.
+   *
+   * A batch holds up to max_batch_size records, in LSN order. Records are
+   * batched as they become available: a batch is delivered once full, when
+   * a gap needs to be delivered after it, or when no more records are
+   * available for now, so batches may be smaller.
+   *
+   * The callback should return the number of records from the front of the
+   * batch that it consumed; it may move these out of the vector. The rest of
+   * the records must be left intact: they are redelivered, at the front of
+   * a later batch, after some time or a resumeReading() call, and nothing
+   * else is delivered for the log until they are consumed.
+   *
+   * If both are set, this callback is used instead of the record callback.
+   * Like setRecordCallback(), only affects subsequent startReading() calls.
+   */
+  virtual void setBatchRecordCallback(
+      std::function<size_t(std::vector<std::unique_ptr<DataRecord>>&)>,
+      size_t max_batch_size = 1024) = 0;
+
   /**
    * Sets a callback that the LogDevice client library will call when a gap
    * record is delivered for this log. A gap record informs the reader about
@@ -136,8 +161,8 @@ class AsyncReader {
    *          delivery. On failure -1 is returned and logdevice::err is set to
    *             NOBUFS        if request could not be enqueued because a buffer
    *                           space limit was reached
-   *             INVALID_PARAM if from > until or the record callback was not
-   *                           specified.
+   *             INVALID_PARAM if from > until or neither the record nor the
+   *                           batch record callback was specified.
    *             SHUTDOWN      the logdevice::Client instance was destroyed.
    *             INTERNAL      An internal error has been detected, check logs.
    *
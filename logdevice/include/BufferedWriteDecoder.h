@@ -8,6 +8,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "logdevice/include/Record.h"
@@ -39,6 +40,20 @@ class BufferedWriteDecoder {
    */
   static int getBatchSize(const DataRecord& record, size_t* size_out);
 
+  /**
+   * Makes a ZSTD dictionary available to all decoders in this process,
+   * including the ones readers use internally.  Batches written with a
+   * dictionary (see BufferedWriter::LogOptions::zstd_dictionary) carry its
+   * ID and only decode once a dictionary with that ID is registered.
+   * Registering a dictionary with the ID of an already registered one
+   * replaces it.
+   *
+   * @returns On success, returns 0.  If `dictionary' is not a zstd
+   *          dictionary with a nonzero ID, returns -1 and sets err to
+   *          E::INVALID_PARAM.
+   */
+  static int registerZstdDictionary(const std::string& dictionary);
+
   /**
    * This method is meant to be used with data records returned by the Reader
    * API.
@@ -70,6 +85,31 @@ class BufferedWriteDecoder {
   int decodeOne(std::unique_ptr<DataRecord>&& record,
                 std::vector<Payload>& payloads_out);
 
+  /**
+   * A record decoded by decodeBatch().  Unlike DataRecord, it owns no memory:
+   * `payload' points into memory owned by the decoder that produced it.
+   */
+  struct RecordView {
+    logid_t logid;
+    // Attributes of the batch the record came from, with batch_offset set to
+    // the record's index within the batch.
+    DataRecordAttributes attrs;
+    Payload payload;
+  };
+
+  /**
+   * Bulk variant of decode() for readers that consume many batches at once.
+   * The batches are decompressed into a single buffer, and a RecordView is
+   * appended to `records_out' for each original record instead of a
+   * Payload, so no allocation is made per record.  Like with decode(), the
+   * returned views are only valid as long as this decoder exists.
+   *
+   * @returns On success, returns 0.  If some DataRecord's failed to decode,
+   *          return -1, leaving malformed records in `records'.
+   */
+  int decodeBatch(std::vector<std::unique_ptr<DataRecord>>&& records,
+                  std::vector<RecordView>& records_out);
+
   virtual ~BufferedWriteDecoder() {}
 
  private:
@@ -175,6 +175,15 @@ class BufferedWriter {
     // Compression codec.
     Compression compression = Compression::LZ4;
 
+    // If set and compression is ZSTD, batches are compressed with this ZSTD
+    // dictionary, which improves the compression ratio of batches of small
+    // similar records a lot.  It must be in the zstd dictionary format, with
+    // a nonzero dictionary ID, e.g. trained with `zstd --train` or
+    // ZDICT_trainFromBuffer() on sample payloads of the log.  The ID is
+    // written into every batch, and readers need the dictionary registered
+    // with BufferedWriteDecoder::registerZstdDictionary() to decode them.
+    std::shared_ptr<const std::string> zstd_dictionary;
+
     // If set to true, will destroy individual payloads immediately after they
     // are batched together. onSuccess(), onFailure() and onRetry() callbacks
     // will not contain payloads.
@@ -13,6 +13,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "logdevice/include/AsyncReader.h"
 #include "logdevice/include/ClientSettings.h"
@@ -419,6 +420,38 @@ class Client {
                      append_callback_t cb,
                      AppendAttributes attrs = AppendAttributes()) noexcept = 0;
 
+  /**
+   * Appends a set of records, possibly to different logs, without blocking.
+   * The records are handed to the same LogDevice client thread at once, so
+   * that the appends whose sequencers run on the same node are sent to it
+   * in a single message. This saves per-append network and CPU overhead for
+   * writers that append to many logs at the same time.
+   *
+   * NOTE: this is NOT an atomic multi-log write. Every record is appended
+   *       individually and cb is called once per record with its own
+   *       status; some records of a call may be appended while others fail.
+   *       Records appended to the same log by appendMulti() calls on the
+   *       same thread receive sequence numbers in the order of the calls
+   *       and of the records within a call.
+   *
+   * @param records   pairs of log id and payload to append
+   *
+   * @param cb        the callback to call for each record
+   *
+   * @param attrs     additional append attributes, used for all records.
+   *                  See AppendAttributes
+   *
+   * @return  0 is returned if all records were successfully enqueued for
+   *          delivery. On failure -1 is returned, none of the records is
+   *          appended, cb is not called, and logdevice::err is set as for
+   *          append(logid_t, std::string, ...) for the first invalid record,
+   *          or to INVALID_PARAM if records is empty.
+   */
+  virtual int
+  appendMulti(std::vector<std::pair<logid_t, std::string>> records,
+              append_callback_t cb,
+              AppendAttributes attrs = AppendAttributes()) noexcept = 0;
+
   /**
    * Creates a Reader object that can be used to read from one or more logs.
    *
@@ -447,6 +480,28 @@ class Client {
   virtual std::unique_ptr<Reader>
   createReader(size_t max_logs, ssize_t buffer_size = -1) noexcept = 0;
 
+  /**
+   * Creates nconsumers Readers for an application that reads many logs from
+   * as many threads, each thread with its own Reader and reading its own
+   * subset of the logs. Each Reader reads its logs on its own subset of the
+   * Client's worker threads, each log pinned to one of them, so that records
+   * for one consumer don't share a handoff queue or a worker with those of
+   * other consumers. With at least as many workers (see num-workers) as
+   * consumers, no two of the Readers share a worker.
+   *
+   * Compared to one Reader reading all logs, this takes the single queue
+   * through which all workers hand records to read() off the path; compared
+   * to nconsumers Readers from createReader(), it keeps the consumers from
+   * competing for the same workers.
+   *
+   * @param nconsumers number of Readers to create
+   * @param max_logs, buffer_size  for each Reader, see createReader()
+   */
+  virtual std::vector<std::unique_ptr<Reader>>
+  createReaders(size_t nconsumers,
+                size_t max_logs,
+                ssize_t buffer_size = -1) noexcept = 0;
+
   /**
    * Creates an AsyncReader object that can be used to read from one or more
    * logs via callbacks.
@@ -58,6 +58,12 @@ constexpr char const* SHADOW = "shadow";
 constexpr char const* SHADOW_DEST = "destination";
 constexpr char const* SHADOW_RATIO = "ratio";
 constexpr char const* TAIL_OPTIMIZED = "tail_optimized";
+constexpr char const* HEDGED_COPIES = "hedged_copies";
+constexpr char const* MAX_APPEND_BYTES_PER_SECOND =
+    "max_append_bytes_per_second";
+constexpr char const* STREAMING_INGEST = "streaming_ingest";
+constexpr char const* COMPACT_RECORD_HEADER = "compact_record_header";
+constexpr char const* EPHEMERAL = "ephemeral";
 
 constexpr char const* EXTRAS = "extra_attributes";
 
@@ -334,6 +340,11 @@ class LogAttributes {
     MERGE_WITH_PARENT(attrs, sequencerBatchingPassthruThreshold)
     MERGE_WITH_PARENT(attrs, shadow)
     MERGE_WITH_PARENT(attrs, tailOptimized)
+    MERGE_WITH_PARENT(attrs, hedgedCopies)
+    MERGE_WITH_PARENT(attrs, maxAppendBytesPerSecond)
+    MERGE_WITH_PARENT(attrs, streamingIngest)
+    MERGE_WITH_PARENT(attrs, compactRecordHeader)
+    MERGE_WITH_PARENT(attrs, ephemeral)
 
     MERGE_WITH_PARENT(attrs, extras)
 #undef MERGE_WITH_PARENT
@@ -493,6 +504,51 @@ class LogAttributes {
    */
   Attribute<bool> tailOptimized_;
 
+  /**
+   * Number of copies the sequencer sends out in the first wave of STOREs of a
+   * record, in addition to replicationFactor and extraCopies, while some
+   * storage nodes of the nodeset are graylisted as slow. This way a straggler
+   * that is not graylisted yet is less likely to hold up the append until the
+   * store timeout, at the cost of extra store traffic. 0 disables hedging.
+   */
+  Attribute<int> hedgedCopies_;
+
+  /**
+   * Admission control for appends: maximum average rate, in payload bytes per
+   * second, at which the sequencer of each log of the group accepts appends,
+   * with bursts of up to one second worth of bytes. Appends over the limit
+   * fail with E::SEQNOBUFS and tell the client how long to back off, so that
+   * one producer can't fill the sliding window and appender buffers of the
+   * sequencer node at the expense of other logs. 0 means no limit.
+   */
+  Attribute<int> maxAppendBytesPerSecond_;
+
+  /**
+   * For write-heavy logs whose readers don't need to see records right after
+   * they are appended. Storage nodes don't put records of these logs in the
+   * record cache, and the sequencer doesn't send a RELEASE for every append
+   * but releases them in batches, every streaming-ingest-release-interval.
+   * Records are replicated and acknowledged exactly as for other logs.
+   */
+  Attribute<bool> streamingIngest_;
+
+  /**
+   * Storage nodes write the records of these logs with a smaller header, in
+   * which the wave, copyset and offset within epoch are varints. Saves disk,
+   * block cache and memory for logs with small records. Records already
+   * written keep their format, so this can be changed at any time.
+   */
+  Attribute<bool> compactRecordHeader_;
+
+  /**
+   * For short-lived data that can tolerate the loss of unflushed copies.
+   * Storage nodes store appends of these logs in the RocksDB memtable only,
+   * without writing them to the WAL, unless the append asks for a sync.
+   * Copies lost in a crash are restored by rebuilding of the dirty time
+   * ranges, as for --append-store-durability=memory.
+   */
+  Attribute<bool> ephemeral_;
+
   /**
    * Arbitrary fields that logdevice does not recognize
    */
@@ -528,6 +584,11 @@ class LogAttributes {
       const Attribute<ssize_t>& sequencerBatchingPassthruThreshold,
       const Attribute<Shadow>& shadow,
       const Attribute<bool>& tailOptimized,
+      const Attribute<int>& hedgedCopies,
+      const Attribute<int>& maxAppendBytesPerSecond,
+      const Attribute<bool>& streamingIngest,
+      const Attribute<bool>& compactRecordHeader,
+      const Attribute<bool>& ephemeral,
       const Attribute<ExtrasMap>& extras)
       : replicationFactor_(replicationFactor),
         extraCopies_(extraCopies),
@@ -555,6 +616,11 @@ class LogAttributes {
         sequencerBatchingPassthruThreshold_(sequencerBatchingPassthruThreshold),
         shadow_(shadow),
         tailOptimized_(tailOptimized),
+        hedgedCopies_(hedgedCopies),
+        maxAppendBytesPerSecond_(maxAppendBytesPerSecond),
+        streamingIngest_(streamingIngest),
+        compactRecordHeader_(compactRecordHeader),
+        ephemeral_(ephemeral),
         extras_(extras) {}
 
   /**
@@ -595,6 +661,11 @@ class LogAttributes {
   ACCESSOR(sequencerBatchingPassthruThreshold)
   ACCESSOR(shadow)
   ACCESSOR(tailOptimized)
+  ACCESSOR(hedgedCopies)
+  ACCESSOR(maxAppendBytesPerSecond)
+  ACCESSOR(streamingIngest)
+  ACCESSOR(compactRecordHeader)
+  ACCESSOR(ephemeral)
 
   ACCESSOR(extras)
 
@@ -626,6 +697,11 @@ class LogAttributes {
                       l.sequencerBatchingPassthruThreshold_,
                       l.shadow_,
                       l.tailOptimized_,
+                      l.hedgedCopies_,
+                      l.maxAppendBytesPerSecond_,
+                      l.streamingIngest_,
+                      l.compactRecordHeader_,
+                      l.ephemeral_,
                       l.extras_);
     };
     return as_tuple(*this) == as_tuple(other);
@@ -7,6 +7,7 @@
  */
 #include "AsyncReaderImpl.h"
 
+#include <algorithm>
 #include <thread>
 
 #include <folly/Memory.h>
@@ -93,6 +94,13 @@ void AsyncReaderImpl::setRecordCallback(
   record_callback_ = std::move(cb);
 }
 
+void AsyncReaderImpl::setBatchRecordCallback(
+    std::function<size_t(std::vector<std::unique_ptr<DataRecord>>&)> cb,
+    size_t max_batch_size) {
+  batch_record_callback_ = std::move(cb);
+  max_record_batch_size_ = std::max(max_batch_size, size_t(1));
+}
+
 void AsyncReaderImpl::setGapCallback(std::function<bool(const GapRecord&)> cb) {
   gap_callback_ = std::move(cb);
 }
@@ -114,6 +122,10 @@ void AsyncReaderImpl::forceNoSingleCopyDelivery() {
   force_no_scd_ = true;
 }
 
+void AsyncReaderImpl::copysetIndexOnly() {
+  copyset_index_only_ = true;
+}
+
 void AsyncReaderImpl::doNotDecodeBufferedWrites() {
   decode_buffered_writes_ = false;
 }
@@ -188,7 +200,7 @@ bool AsyncReaderImpl::recordCallbackWrapper(
   // must be a DataRecordOwnsPayload. Downcast so we can access the metadata.
   ld_assert(dynamic_cast<DataRecordOwnsPayload*>(record.get()) != nullptr);
 
-  if (!record_callback_) {
+  if (!record_callback_ && !batch_record_callback_) {
     return true;
   }
 
@@ -215,7 +227,7 @@ bool AsyncReaderImpl::recordCallbackWrapper(
       decode_buffered_writes_ && !without_payload_) {
     return handleBufferedWrite(record);
   } else {
-    bool rv = record_callback_(record);
+    bool rv = deliverToApplication(record);
     if (!rv) {
       RATELIMIT_DEBUG(std::chrono::seconds(10),
                       10,
@@ -227,6 +239,57 @@ bool AsyncReaderImpl::recordCallbackWrapper(
   }
 }
 
+size_t AsyncReaderImpl::batchRecordCallbackWrapper(
+    std::vector<std::unique_ptr<DataRecord>>& records) {
+  bool per_record = buffered_delivery_failed_.load();
+  if (decode_buffered_writes_ && !without_payload_) {
+    for (const auto& record : records) {
+      ld_assert(dynamic_cast<DataRecordOwnsPayload*>(record.get()) != nullptr);
+      if (static_cast<DataRecordOwnsPayload*>(record.get())->flags_ &
+          RECORD_Header::BUFFERED_WRITER_BLOB) {
+        per_record = true;
+        break;
+      }
+    }
+  }
+
+  if (!per_record) {
+    size_t consumed = batch_record_callback_(records);
+    if (consumed < records.size()) {
+      RATELIMIT_DEBUG(std::chrono::seconds(10),
+                      10,
+                      "Batch record callback consumed %lu of %lu records "
+                      "starting at %lu%s",
+                      consumed,
+                      records.size(),
+                      records.front()->logid.val(),
+                      lsn_to_string(records.front()->attrs.lsn).c_str());
+    }
+    return consumed;
+  }
+
+  size_t consumed = 0;
+  while (consumed < records.size() &&
+         recordCallbackWrapper(records[consumed])) {
+    ++consumed;
+  }
+  return consumed;
+}
+
+bool AsyncReaderImpl::deliverToApplication(
+    std::unique_ptr<DataRecord>& record) {
+  if (record_callback_) {
+    return record_callback_(record);
+  }
+  std::vector<std::unique_ptr<DataRecord>> records;
+  records.push_back(std::move(record));
+  if (batch_record_callback_(records) > 0) {
+    return true;
+  }
+  record = std::move(records.front());
+  return false;
+}
+
 int AsyncReaderImpl::startReading(logid_t log_id,
                                   lsn_t from,
                                   lsn_t until,
@@ -247,7 +310,7 @@ int AsyncReaderImpl::startReading(logid_t log_id,
     return -1;
   }
 
-  if (!record_callback_) {
+  if (!record_callback_ && !batch_record_callback_) {
     ld_error("called without specifying record callback for log_id %lu",
              log_id.val_);
     err = E::INVALID_PARAM;
@@ -311,6 +374,12 @@ int AsyncReaderImpl::startReading(logid_t log_id,
                                           : HealthChangeType::LOG_UNHEALTHY);
         }
       });
+  if (batch_record_callback_) {
+    deps->setBatchRecordCallback(
+        // Safe to bind to `this' for the same reason as above
+        std::bind(&AsyncReaderImpl::batchRecordCallbackWrapper, this, arg::_1),
+        max_record_batch_size_);
+  }
   auto read_stream = std::make_unique<ClientReadStream>(
       rsid,
       log_id,
@@ -332,6 +401,10 @@ int AsyncReaderImpl::startReading(logid_t log_id,
     read_stream->forceNoSingleCopyDelivery();
   }
 
+  if (copyset_index_only_) {
+    read_stream->addStartFlags(START_Header::CSI_DATA_ONLY);
+  }
+
   if (do_not_skip_partially_trimmed_sections_) {
     read_stream->doNotSkipPartiallyTrimmedSections();
   }
@@ -494,7 +567,7 @@ bool AsyncReaderImpl::handleBufferedWrite(std::unique_ptr<DataRecord>& record) {
       log_state->pre_queue.push_back(std::move(sub_record));
       continue;
     }
-    if (!record_callback_(sub_record)) {
+    if (!deliverToApplication(sub_record)) {
       RATELIMIT_DEBUG(std::chrono::seconds(10),
                       10,
                       "Record callback rejected sub-record of record %lu%s",
@@ -564,7 +637,7 @@ int AsyncReaderImpl::drainBufferedRecords(logid_t log_id,
       record_mismatch = true;
     }
 
-    if (!record_callback_(record)) {
+    if (!deliverToApplication(record)) {
       RATELIMIT_DEBUG(std::chrono::seconds(10),
                       10,
                       "Record callback rejected record %lu%s",
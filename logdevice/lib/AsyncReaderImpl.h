@@ -30,6 +30,9 @@ class AsyncReaderImpl : public AsyncReader {
   // see AsyncReader.h for all of these functions:
   void
   setRecordCallback(std::function<bool(std::unique_ptr<DataRecord>&)>) override;
+  void setBatchRecordCallback(
+      std::function<size_t(std::vector<std::unique_ptr<DataRecord>>&)>,
+      size_t max_batch_size) override;
   void setGapCallback(std::function<bool(const GapRecord&)>) override;
   void setDoneCallback(std::function<void(logid_t)>) override;
   void setHealthChangeCallback(
@@ -47,6 +50,8 @@ class AsyncReaderImpl : public AsyncReader {
   void includeByteOffset() override;
   void doNotSkipPartiallyTrimmedSections() override;
   void getBytesBuffered(std::function<void(size_t)> callback) override;
+  // See ReaderImpl::copysetIndexOnly().
+  void copysetIndexOnly();
 
   // specify the buffer type for reading the log
   void setBufferType(ClientReadStreamBufferType buffer_type) {
@@ -67,6 +72,16 @@ class AsyncReaderImpl : public AsyncReader {
   // automatic decoding of buffered writes
   bool recordCallbackWrapper(std::unique_ptr<DataRecord>& record);
 
+  // Same for the application-provided batch record callback. Batches that
+  // contain buffered writes to decode are delivered one record at a time
+  // through recordCallbackWrapper().
+  size_t
+  batchRecordCallbackWrapper(std::vector<std::unique_ptr<DataRecord>>& records);
+
+  // Passes a single record to the application's record callback, or to its
+  // batch record callback if that's what it set.
+  bool deliverToApplication(std::unique_ptr<DataRecord>& record);
+
   // Handles a record that is a buffered write and needs automatic decoding
   bool handleBufferedWrite(std::unique_ptr<DataRecord>& record);
 
@@ -86,6 +101,9 @@ class AsyncReaderImpl : public AsyncReader {
   Processor* processor_;
 
   std::function<bool(std::unique_ptr<DataRecord>&)> record_callback_;
+  std::function<size_t(std::vector<std::unique_ptr<DataRecord>>&)>
+      batch_record_callback_;
+  size_t max_record_batch_size_ = 0;
   std::function<bool(const GapRecord&)> gap_callback_;
   std::function<void(logid_t)> done_callback_;
   std::function<void(logid_t, HealthChangeType)> health_change_callback_;
@@ -96,6 +114,9 @@ class AsyncReaderImpl : public AsyncReader {
   // Indicates forceNoSingleCopyDelivery() was called
   bool force_no_scd_ = false;
 
+  // Indicates copysetIndexOnly() was called
+  bool copyset_index_only_ = false;
+
   // Indicates whether records that come with the BUFFERED_WRITER_BLOB flag set
   // should be transparently decoded
   bool decode_buffered_writes_ = true;
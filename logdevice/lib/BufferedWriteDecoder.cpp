@@ -22,6 +22,11 @@ int BufferedWriteDecoder::getBatchSize(const DataRecord& record,
   return BufferedWriteDecoderImpl::getBatchSize(record, size_out);
 }
 
+int BufferedWriteDecoder::registerZstdDictionary(
+    const std::string& dictionary) {
+  return BufferedWriteDecoderImpl::registerZstdDictionary(dictionary);
+}
+
 int BufferedWriteDecoder::decode(
     std::vector<std::unique_ptr<DataRecord>>&& records,
     std::vector<Payload>& payloads_out) {
@@ -33,6 +38,12 @@ int BufferedWriteDecoder::decodeOne(std::unique_ptr<DataRecord>&& record,
   return impl()->decodeOne(std::move(record), payloads_out);
 }
 
+int BufferedWriteDecoder::decodeBatch(
+    std::vector<std::unique_ptr<DataRecord>>&& records,
+    std::vector<RecordView>& records_out) {
+  return impl()->decodeBatch(std::move(records), records_out);
+}
+
 BufferedWriteDecoderImpl* BufferedWriteDecoder::impl() {
   return static_cast<BufferedWriteDecoderImpl*>(this);
 }
@@ -8,6 +8,7 @@
 #include "logdevice/lib/ClientImpl.h"
 
 #include <chrono>
+#include <mutex>
 #include <unordered_map>
 
 #include <boost/algorithm/string.hpp>
@@ -15,6 +16,7 @@
 #include <folly/Random.h>
 
 #include "logdevice/common/AppendRequest.h"
+#include "logdevice/common/AsyncTraceLogger.h"
 #include "logdevice/common/ClientAPIHitsTracer.h"
 #include "logdevice/common/ClientBridge.h"
 #include "logdevice/common/ClientEventTracer.h"
@@ -102,6 +104,22 @@ class ClientBridgeImpl : public ClientBridge {
 };
 
 namespace {
+
+// Workers and connections shared by all Clients of the process that are
+// created with --shared-transport for the same cluster and credentials.
+struct SharedTransport {
+  // Stats of the shared workers. Each Client still has its own StatsHolder
+  // for stats it updates itself.
+  std::unique_ptr<StatsHolder> stats;
+  std::unique_ptr<StatsCollectionThread> stats_thread;
+  // Declared last so that it's destroyed, and shut down, first.
+  std::shared_ptr<ClientProcessor> processor;
+};
+
+std::mutex shared_transports_mutex;
+std::unordered_map<std::string, std::weak_ptr<SharedTransport>>
+    shared_transports;
+
 bool validateSSLSettings(std::shared_ptr<ServerConfig> config,
                          std::shared_ptr<const Settings> settings) {
   size_t ssl_nodes = 0;
@@ -119,6 +137,48 @@ bool validateSSLSettings(std::shared_ptr<ServerConfig> config,
   bool ca_only = !settings->ssl_load_client_cert;
   return validateSSLCertificatesExist(settings, ca_only);
 }
+
+/**
+ * Starts the AppendRequests of a Client::appendMulti() call back to back on
+ * the same Worker, so that the APPENDs of those whose sequencers run on the
+ * same node are sent in a single APPENDS message.
+ */
+class AppendMultiRequest : public Request {
+ public:
+  AppendMultiRequest(std::vector<std::unique_ptr<AppendRequest>> appends,
+                     worker_id_t target_worker)
+      : Request(RequestType::APPEND_MULTI),
+        appends_(std::move(appends)),
+        target_worker_(target_worker) {}
+
+  ~AppendMultiRequest() override {
+    // Never executed, e.g. the Worker was shutting down or postRequest()
+    // failed. Instruct ~AppendRequest not to invoke the callbacks, as we may
+    // not be on a Worker thread.
+    for (auto& append : appends_) {
+      append->setFailedToPost();
+    }
+  }
+
+  int getThreadAffinity(int /*nthreads*/) override {
+    return target_worker_.val_;
+  }
+
+  Execution execute() override {
+    for (auto& append : appends_) {
+      Execution rv = append->execute();
+      // AppendRequest is now owned by Worker::runningAppends()
+      ld_check(rv == Execution::CONTINUE);
+      append.release();
+    }
+    appends_.clear();
+    return Execution::COMPLETE;
+  }
+
+ private:
+  std::vector<std::unique_ptr<AppendRequest>> appends_;
+  worker_id_t target_worker_;
+};
 } // namespace
 
 // Implementing the member function of Client inside ClientImpl.cpp sounds
@@ -189,7 +249,10 @@ std::shared_ptr<Client> Client::create(std::string cluster_name,
     // on_demand_logs_config enabled
     ld_info("Remote (on-demand) LogsConfig is ENABLED");
     auto cache_ttl = impl_settings->getSettings()->remote_logs_config_cache_ttl;
-    RemoteLogsConfig* raw_logs_cfg = new RemoteLogsConfig(timeout, cache_ttl);
+    auto negative_cache_ttl =
+        impl_settings->getSettings()->remote_logs_config_negative_cache_ttl;
+    RemoteLogsConfig* raw_logs_cfg =
+        new RemoteLogsConfig(timeout, cache_ttl, negative_cache_ttl);
     logs_cfg_processor_ptr_ptr = raw_logs_cfg->getProcessorPtrPtr();
     logs_cfg.reset(raw_logs_cfg);
   }
@@ -352,14 +415,16 @@ ClientImpl::ClientImpl(std::string cluster_name,
         std::make_unique<EpochMetaDataCache>(metadata_cache_size);
   }
 
+  auto make_stats_holder = [&] {
+    return std::make_unique<StatsHolder>(
+        StatsParams().setIsServer(false).setNodeStatsRetentionTimeOnClients(
+            settings->sequencer_boycotting.node_stats_send_period));
+  };
   if (settings->stats_collection_interval.count() > 0 ||
       settings->client_test_force_stats) {
-    auto params =
-        StatsParams().setIsServer(false).setNodeStatsRetentionTimeOnClients(
-            settings->sequencer_boycotting.node_stats_send_period);
     // Only create StatsHolder when we're going to collect stats, primarily to
     // avoid instantianting thread-local Stats unnecessarily
-    stats_ = std::make_unique<StatsHolder>(std::move(params));
+    stats_ = make_stats_holder();
   }
 
   std::shared_ptr<ServerConfig> server_cfg = config_->get()->serverConfig();
@@ -371,6 +436,13 @@ ClientImpl::ClientImpl(std::string cluster_name,
     trace_logger_ = std::make_shared<NoopTraceLogger>(config_);
   } else {
     trace_logger_ = (*trace_logger_factory)(config_);
+    if (settings->trace_logger_queue_size > 0) {
+      trace_logger_ = std::make_shared<AsyncTraceLogger>(
+          config_,
+          std::move(trace_logger_),
+          settings->trace_logger_queue_size,
+          stats_.get());
+    }
   }
 
   event_tracer_ =
@@ -381,22 +453,61 @@ ClientImpl::ClientImpl(std::string cluster_name,
           PluginType::LEGACY_CLIENT_PLUGIN);
   ld_check(plugin);
 
-  processor_ = ClientProcessor::create(config_,
-                                       trace_logger_,
-                                       settings,
-                                       stats_.get(),
-                                       std::move(sequencer_locator),
-                                       plugin,
-                                       plugin_registry_,
-                                       credentials_,
-                                       csid_);
+  auto create_processor = [&](StatsHolder* stats) {
+    auto processor = ClientProcessor::create(config_,
+                                             trace_logger_,
+                                             settings,
+                                             stats,
+                                             std::move(sequencer_locator),
+                                             plugin,
+                                             plugin_registry_,
+                                             credentials_,
+                                             csid_);
+
+    if (!LogsConfigManager::createAndAttach(
+            *processor, false /* is_writable */)) {
+      err = E::INVALID_CONFIG;
+      ld_critical("Internal LogsConfig Manager could not be started in "
+                  "Client. LogsConfig will not be available!");
+      throw ConstructorFailed();
+    }
+    return processor;
+  };
 
-  if (!LogsConfigManager::createAndAttach(
-          *processor_, false /* is_writable */)) {
-    err = E::INVALID_CONFIG;
-    ld_critical("Internal LogsConfig Manager could not be started in Client. "
-                "LogsConfig will not be available!");
-    throw ConstructorFailed();
+  shared_transport_ = settings->shared_transport;
+  if (shared_transport_) {
+    const std::string key = cluster_name_ + '\0' + credentials_;
+    std::lock_guard<std::mutex> guard(shared_transports_mutex);
+    auto transport = shared_transports[key].lock();
+    if (!transport) {
+      transport = std::make_shared<SharedTransport>();
+      if (stats_) {
+        transport->stats = make_stats_holder();
+        transport->stats_thread =
+            StatsCollectionThread::maybeCreate(settings,
+                                               server_cfg,
+                                               plugin_registry_,
+                                               StatsPublisherScope::CLIENT,
+                                               /* num_shards */ 0,
+                                               transport->stats.get());
+      }
+      transport->processor = create_processor(transport->stats.get());
+
+      for (auto it = shared_transports.begin();
+           it != shared_transports.end();) {
+        it = it->second.expired() ? shared_transports.erase(it) : ++it;
+      }
+      shared_transports[key] = transport;
+      ld_info("Created shared transport for cluster %s", cluster_name_.c_str());
+    } else {
+      ld_info("Using existing shared transport for cluster %s",
+              cluster_name_.c_str());
+    }
+    // Keeps the whole SharedTransport alive for as long as the processor is.
+    processor_ = std::shared_ptr<ClientProcessor>(
+        transport, transport->processor.get());
+  } else {
+    processor_ = create_processor(stats_.get());
   }
 
   stats_thread_ =
@@ -464,7 +575,11 @@ ClientImpl::~ClientImpl() {
   ld_info("Destroying Client. Cluster name: %s", cluster_name_.c_str());
 
   server_config_hook_handles_.clear();
-  processor_->shutdown();
+  if (!shared_transport_) {
+    processor_->shutdown();
+  }
+  // Otherwise the processor is shut down when the last Client using it
+  // goes away.
 
   auto end_time = std::chrono::steady_clock::now();
   ld_info("Destroyed Client in %.3f seconds. Cluster name: %s",
@@ -555,6 +670,7 @@ int ClientImpl::postAppend(std::unique_ptr<AppendRequest> req_append) {
   ld_check(req_append != nullptr);
 
   req_append->setAppendProbeController(&processor_->appendProbeController());
+  req_append->setLogWorkerMigrations(&processor_->logWorkerMigrations());
 
   // First perform shadowing. since postRequest can invalidate pointer
   if (shadow_ != nullptr) { // Is only null for shadow clients
@@ -679,6 +795,64 @@ int ClientImpl::append(logid_t logid,
                 nullptr);
 }
 
+int ClientImpl::appendMulti(
+    std::vector<std::pair<logid_t, std::string>> records,
+    append_callback_t cb,
+    AppendAttributes attrs) noexcept {
+  if (records.empty()) {
+    err = E::INVALID_PARAM;
+    return -1;
+  }
+
+  std::vector<std::unique_ptr<AppendRequest>> appends;
+  appends.reserve(records.size());
+  for (auto& record : records) {
+    if (!checkAppend(record.first, record.second.size())) {
+      // err was set by checkAppend()
+      for (auto& append : appends) {
+        append->setFailedToPost();
+      }
+      return -1;
+    }
+    auto req = prepareRequest(
+        record.first, Payload(), cb, attrs, worker_id_t{-1}, nullptr);
+    ld_check(req);
+    req->setStringPayload(std::move(record.second));
+    appends.push_back(std::move(req));
+  }
+
+  // All records of the call go to the same Worker, picked by the calling
+  // thread only, so that successive calls on a thread stay ordered per log.
+  // The AppendRequest constructor assigned AppendRequest::clientThreadId.
+  const worker_id_t target_worker(
+      AppendRequest::clientThreadId %
+      processor_->getWorkerCount(WorkerType::GENERAL));
+  for (auto& req : appends) {
+    if (append_error_injector_) {
+      req = append_error_injector_->maybeReplaceRequest(std::move(req));
+    }
+    req->setTargetWorker(target_worker);
+    req->setAppendProbeController(&processor_->appendProbeController());
+    req->setBatchWithOtherAppends();
+    if (shadow_ != nullptr) {
+      shadow_->appendShadow(*req);
+    }
+  }
+
+  const size_t count = appends.size();
+  std::unique_ptr<Request> req =
+      std::make_unique<AppendMultiRequest>(std::move(appends), target_worker);
+  int rv = processor_->postRequest(req);
+  if (rv != 0) {
+    // ~AppendMultiRequest instructs the AppendRequests not to invoke the
+    // callbacks
+    for (size_t i = 0; i < count; ++i) {
+      AppendRequest::bumpStatForOutcome(stats_.get(), err);
+    }
+  }
+  return rv;
+}
+
 lsn_t ClientImpl::appendSync(logid_t logid,
                              const Payload& payload,
                              AppendAttributes attrs,
@@ -703,6 +877,24 @@ std::unique_ptr<Reader> ClientImpl::createReader(size_t max_logs,
                                       shared_from_this());
 }
 
+std::vector<std::unique_ptr<Reader>>
+ClientImpl::createReaders(size_t nconsumers,
+                          size_t max_logs,
+                          ssize_t buffer_size) noexcept {
+  const size_t nworkers = processor_->getWorkerCount(WorkerType::GENERAL);
+  std::vector<std::unique_ptr<Reader>> readers;
+  for (size_t i = 0; i < nconsumers; ++i) {
+    auto reader = std::make_unique<ReaderImpl>(max_logs,
+                                               buffer_size,
+                                               processor_.get(),
+                                               getEpochMetaDataCache(),
+                                               shared_from_this());
+    reader->setWorkers(ReaderImpl::workersForConsumer(i, nconsumers, nworkers));
+    readers.push_back(std::move(reader));
+  }
+  return readers;
+}
+
 std::unique_ptr<AsyncReader>
 ClientImpl::createAsyncReader(ssize_t buffer_size) noexcept {
   return std::make_unique<AsyncReaderImpl>(shared_from_this(), buffer_size);
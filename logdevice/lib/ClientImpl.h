@@ -112,6 +112,10 @@ class ClientImpl : public Client,
              append_callback_t cb,
              AppendAttributes attrs = AppendAttributes()) noexcept override;
 
+  int appendMulti(std::vector<std::pair<logid_t, std::string>> records,
+                  append_callback_t cb,
+                  AppendAttributes attrs = AppendAttributes()) noexcept override;
+
   int append(logid_t logid,
              std::string payload,
              append_callback_t cb,
@@ -142,6 +146,11 @@ class ClientImpl : public Client,
   std::unique_ptr<Reader> createReader(size_t max_logs,
                                        ssize_t buffer_size) noexcept override;
 
+  std::vector<std::unique_ptr<Reader>>
+  createReaders(size_t nconsumers,
+                size_t max_logs,
+                ssize_t buffer_size) noexcept override;
+
   std::unique_ptr<AsyncReader>
   createAsyncReader(ssize_t buffer_size) noexcept override;
 
@@ -496,6 +505,10 @@ class ClientImpl : public Client,
   // Should be deleted before config and settings
   std::unique_ptr<Shadow> shadow_;
 
+  // True if processor_ is shared with other Clients, see
+  // Settings::shared_transport.
+  bool shared_transport_{false};
+
   // see allowWriteMetaDataLog() above
   bool allow_write_metadata_log_{false};
 
@@ -10,6 +10,7 @@
 #include "logdevice/common/debug.h"
 #include "logdevice/common/protocol/MessageTypeNames.h"
 #include "logdevice/common/protocol/STORED_Message.h"
+#include "logdevice/common/protocol/STORES_Message.h"
 #include "logdevice/common/protocol/STORE_Message.h"
 #include "logdevice/common/util.h"
 #include "logdevice/lib/NODE_STATS_REPLY_onReceived.h"
@@ -28,8 +29,10 @@ ClientMessageDispatch::onReceivedImpl(Message* msg, const Address& from) {
     case MessageType::CHECK_NODE_HEALTH:
     case MessageType::CHECK_SEAL:
     case MessageType::CLEAN:
+    case MessageType::DATA_SIZE_BATCH:
     case MessageType::DELETE:
     case MessageType::FINDKEY:
+    case MessageType::FINDKEY_BATCH:
     case MessageType::GET_EPOCH_RECOVERY_METADATA:
     case MessageType::GET_EPOCH_RECOVERY_METADATA_REPLY:
     case MessageType::GET_HEAD_ATTRIBUTES:
@@ -37,13 +40,18 @@ ClientMessageDispatch::onReceivedImpl(Message* msg, const Address& from) {
     case MessageType::NODE_STATS_AGGREGATE:
     case MessageType::NODE_STATS_AGGREGATE_REPLY:
     case MessageType::IS_LOG_EMPTY:
+    case MessageType::IS_LOG_EMPTY_BATCH:
     case MessageType::RELEASE:
+    case MessageType::RELEASES:
     case MessageType::SEAL:
     case MessageType::START:
+    case MessageType::STARTS:
     case MessageType::STOP:
     case MessageType::STORE:
+    case MessageType::STORES:
     case MessageType::TRIM:
     case MessageType::WINDOW:
+    case MessageType::WINDOWS:
       RATELIMIT_ERROR(
           std::chrono::seconds(60),
           1,
@@ -74,11 +82,19 @@ void ClientMessageDispatch::onSentImpl(const Message& msg,
       checked_downcast<const STORE_Message&>(msg).onSentCommon(st, to);
       return;
 
+    case MessageType::STORES:
+      for (const auto& store :
+           checked_downcast<const STORES_Message&>(msg).stores_) {
+        store->onSentCommon(st, to);
+      }
+      return;
+
     case MessageType::GET_EPOCH_RECOVERY_METADATA:
     case MessageType::NODE_STATS_AGGREGATE:
     case MessageType::NODE_STATS_AGGREGATE_REPLY:
     case MessageType::NODE_STATS_REPLY:
     case MessageType::RECORD:
+    case MessageType::RECORDS:
     case MessageType::SHARD_STATUS_UPDATE:
       RATELIMIT_ERROR(std::chrono::seconds(60),
                       1,
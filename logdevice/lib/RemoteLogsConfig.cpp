@@ -83,12 +83,23 @@ int RemoteLogsConfig::postRequest(LOGS_CONFIG_API_Header::Type request_type,
   return rv;
 }
 
+constexpr size_t RemoteLogsConfig::MAX_NOT_FOUND_IDS;
+
 void RemoteLogsConfig::getLogGroupByIDAsync(
     logid_t id,
     std::function<void(std::shared_ptr<LogGroupNode>)> cb) const {
   {
     // Attempting to fetch result from cache
     shared_lock<RWSpinLock> lock(id_cache_mutex);
+    auto not_found_it = not_found_ids_.find(id.val_);
+    if (not_found_it != not_found_ids_.end() &&
+        steady_clock::now() - not_found_it->second <= max_not_found_age_) {
+      // The server recently told us there is no such log.
+      lock.unlock();
+      err = E::NOTFOUND;
+      cb(nullptr);
+      return;
+    }
     auto it = id_result_cache.find(id.val_);
     if (it != id_result_cache.end()) {
       // potential cache hit - check timestamp
@@ -103,17 +114,50 @@ void RemoteLogsConfig::getLogGroupByIDAsync(
     }
   }
 
+  // If there already is a request for this log whose callbacks run on this
+  // thread's worker, wait for it instead of sending another one.
+  auto w = Worker::onThisThread(false);
+  const auto key = std::make_pair(id.val_, w ? w->idx_.val_ : -1);
+  {
+    std::lock_guard<std::mutex> lock(pending_id_lookups_->mutex);
+    auto& callbacks = pending_id_lookups_->callbacks[key];
+    callbacks.push_back(std::move(cb));
+    if (callbacks.size() > 1) {
+      return;
+    }
+  }
+
+  // Calls all callbacks waiting for the request.
+  auto done = [pending = pending_id_lookups_, key](
+                  Status st, std::shared_ptr<LogGroupNode> log) {
+    std::vector<id_lookup_callback_t> callbacks;
+    {
+      std::lock_guard<std::mutex> lock(pending->mutex);
+      auto it = pending->callbacks.find(key);
+      ld_check(it != pending->callbacks.end());
+      callbacks = std::move(it->second);
+      pending->callbacks.erase(it);
+    }
+    for (auto& callback : callbacks) {
+      err = st;
+      callback(log);
+    }
+  };
+
   std::string delimiter = getNamespaceDelimiter();
   // No suitable results in cache - proceed to get them from remote hosts.
-  auto request_callback = [cb, delimiter](Status st, std::string payload) {
+  auto request_callback = [id, done, delimiter](Status st,
+                                                std::string payload) {
     auto config = Worker::onThisThread()->getConfig();
     RemoteLogsConfig* rlc = checked_downcast<RemoteLogsConfig*>(
         const_cast<LogsConfig*>(config->logsConfig().get()));
     if (!rlc || st != E::OK) {
       // failing if the status is not okay or the LogsConfig is not an instance
       // of RemoteLogsConfig anymore
-      err = !rlc ? E::FAILED : st;
-      cb(nullptr);
+      if (rlc && st == E::NOTFOUND) {
+        rlc->insertIntoNotFoundCache(id);
+      }
+      done(!rlc ? E::FAILED : st, nullptr);
       return;
     }
 
@@ -126,7 +170,7 @@ void RemoteLogsConfig::getLogGroupByIDAsync(
     ld_check(lid != nullptr);
     if (lid == nullptr) {
       ld_error("Failed to deserialize LogGroupWithParentPath result");
-      cb(nullptr);
+      done(E::FAILED, nullptr);
       return;
     }
 
@@ -136,7 +180,7 @@ void RemoteLogsConfig::getLogGroupByIDAsync(
     rlc->insertIntoIdCache(log_shared);
 
     // Returning to client
-    cb(std::move(log_shared));
+    done(E::OK, std::move(log_shared));
   };
   this->postRequest(LOGS_CONFIG_API_Header::Type::GET_LOG_GROUP_BY_ID,
                     std::to_string(id.val()),
@@ -152,6 +196,25 @@ void RemoteLogsConfig::insertIntoIdCache(
   std::unique_lock<RWSpinLock> lock(id_cache_mutex);
   id_result_cache.erase(interval);
   id_result_cache.insert(std::make_pair(interval, entry));
+  // The log group may have been created since we were told it didn't exist.
+  for (auto it = not_found_ids_.begin(); it != not_found_ids_.end();) {
+    if (it->first >= range.first.val_ && it->first <= range.second.val_) {
+      it = not_found_ids_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void RemoteLogsConfig::insertIntoNotFoundCache(logid_t id) const {
+  if (max_not_found_age_.count() == 0) {
+    return;
+  }
+  std::unique_lock<RWSpinLock> lock(id_cache_mutex);
+  if (not_found_ids_.size() >= MAX_NOT_FOUND_IDS) {
+    not_found_ids_.clear();
+  }
+  not_found_ids_[id.val_] = steady_clock::now();
 }
 
 bool RemoteLogsConfig::logExists(logid_t id) const {
@@ -411,7 +474,9 @@ RemoteLogsConfig::RemoteLogsConfig(const RemoteLogsConfig& src)
   // not copying the cache
   timeout_ = src.timeout_;
   max_data_age_ = src.max_data_age_;
+  max_not_found_age_ = src.max_not_found_age_;
   processor_ = src.processor_;
+  pending_id_lookups_ = std::make_shared<PendingIDLookups>();
   target_node_info_ = src.target_node_info_;
 
   // Enabling sending LOGS_CONFIG_API messages if it's disabled
@@ -8,6 +8,10 @@
 #pragma once
 
 #include <chrono>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include <folly/synchronization/RWSpinLock.h>
 
@@ -24,11 +28,19 @@ namespace facebook { namespace logdevice {
  */
 class RemoteLogsConfig : public LogsConfig {
  public:
+  /**
+   * @param cache_ttl           how long results are cached for
+   * @param negative_cache_ttl  how long log IDs the server didn't find are
+   *                            remembered as missing
+   */
   RemoteLogsConfig(std::chrono::milliseconds timeout,
-                   std::chrono::milliseconds cache_ttl)
+                   std::chrono::milliseconds cache_ttl,
+                   std::chrono::milliseconds negative_cache_ttl)
       : timeout_(timeout),
         max_data_age_(cache_ttl),
+        max_not_found_age_(negative_cache_ttl),
         processor_(new std::weak_ptr<Processor>()),
+        pending_id_lookups_(std::make_shared<PendingIDLookups>()),
         target_node_info_(std::make_shared<GetLogInfoRequestSharedState>()) {}
 
   bool isLocal() const override {
@@ -76,9 +88,15 @@ class RemoteLogsConfig : public LogsConfig {
  private:
   using RangeLookupMap = LogsConfig::NamespaceRangeLookupMap;
 
+  using id_lookup_callback_t =
+      std::function<void(std::shared_ptr<LogGroupNode>)>;
+
   // Inserts entries into logid->log struct cache
   void insertIntoIdCache(const std::shared_ptr<LogGroupNode>& log) const;
 
+  // Remembers that the server has no log with this ID
+  void insertIntoNotFoundCache(logid_t id) const;
+
   // attempts to fetch results from cache into res. Returns true on success,
   // false on failure.
   bool getLogRangesByNamespaceCached(const std::string& ns,
@@ -102,6 +120,8 @@ class RemoteLogsConfig : public LogsConfig {
 
   // TTL for the result cache
   std::chrono::milliseconds max_data_age_ = std::chrono::milliseconds(60000);
+  // TTL for the cache of log IDs that don't exist
+  std::chrono::milliseconds max_not_found_age_ = std::chrono::milliseconds(0);
   // This is a pointer to the client's processor. It is shared for easier
   // substitution across all RemoteLogsConfig instances
   std::shared_ptr<std::weak_ptr<Processor>> processor_;
@@ -126,6 +146,25 @@ class RemoteLogsConfig : public LogsConfig {
       IDMap;
   mutable IDMap id_result_cache;
 
+  // Log IDs the server didn't find -> when that was. Also protected by
+  // id_cache_mutex. Cleared when it grows past MAX_NOT_FOUND_IDS.
+  static constexpr size_t MAX_NOT_FOUND_IDS = 100000;
+  mutable std::unordered_map<logid_t::raw_type,
+                             std::chrono::steady_clock::time_point>
+      not_found_ids_;
+
+  // GET_LOG_GROUP_BY_ID requests in flight and the callbacks waiting for
+  // them, by log ID and the worker to call them on (-1 if not called from a
+  // worker). Concurrent lookups of a log share a request. Shared with the
+  // request callbacks, which may outlive this object.
+  struct PendingIDLookups {
+    std::mutex mutex;
+    std::map<std::pair<logid_t::raw_type, int>,
+             std::vector<id_lookup_callback_t>>
+        callbacks;
+  };
+  std::shared_ptr<PendingIDLookups> pending_id_lookups_;
+
   // Name -> log id range entry cache
   struct NameMapEntry {
     std::pair<logid_t, logid_t> range;
@@ -22,10 +22,15 @@ void IsLogEmptyBatchRunner::complete(logid_t logid, Status status, bool empty) {
 }
 
 void IsLogEmptyBatchRunner::scheduleMore() {
+  std::vector<std::unique_ptr<Request>> requests;
   while (!logs_.empty() && in_flight_ < max_in_flight_) {
     const logid_t log = logs_.front();
     logs_.pop_front();
-    scheduleForLog(log);
+    requests.push_back(scheduleForLog(log));
+  }
+  if (!requests.empty()) {
+    ClientImpl* client = static_cast<ClientImpl*>(client_.get());
+    client->getProcessor().postImportantRequests(requests);
   }
 
   if (logs_.empty() && in_flight_ == 0) {
@@ -34,7 +39,7 @@ void IsLogEmptyBatchRunner::scheduleMore() {
   }
 }
 
-void IsLogEmptyBatchRunner::scheduleForLog(logid_t logid) {
+std::unique_ptr<Request> IsLogEmptyBatchRunner::scheduleForLog(logid_t logid) {
   ++in_flight_;
 
   RATELIMIT_INFO(
@@ -46,9 +51,7 @@ void IsLogEmptyBatchRunner::scheduleForLog(logid_t logid) {
   std::unique_ptr<IsLogEmptyRequest> is_log_empty_req(
       new IsLogEmptyRequest(logid, std::chrono::seconds{10}, cb));
   is_log_empty_req->setWorkerThread(Worker::onThisThread()->idx_);
-  std::unique_ptr<Request> request = std::move(is_log_empty_req);
-  ClientImpl* client = static_cast<ClientImpl*>(client_.get());
-  client->getProcessor().postImportant(request);
+  return std::move(is_log_empty_req);
 }
 
 IsLogEmptyBatchRunner::IsLogEmptyBatchRunner(std::shared_ptr<Client> client,
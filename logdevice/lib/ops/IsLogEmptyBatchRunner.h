@@ -70,7 +70,8 @@ class IsLogEmptyBatchRunner {
 
   void complete(logid_t logid, Status status, bool empty);
   void scheduleMore();
-  void scheduleForLog(logid_t logid);
+  // Returns the request to post for logid.
+  std::unique_ptr<Request> scheduleForLog(logid_t logid);
 
   friend class StartIsLogEmptyBatchRunnerRequest;
 };
@@ -76,9 +76,12 @@ int Shadow::appendShadow(const AppendRequest& req) {
   AppendAttributes req_attrs;
   std::tie(payload, req_attrs) = req.getShadowData();
 
-  int rv = shadow_client->append(
-      logid, payload, req_attrs, req.getBufferedWriterBlobFlag());
-  if (rv == -1) {
+  int rv = shadow_client->append(logid,
+                                 payload,
+                                 req_attrs,
+                                 req.getBufferedWriterBlobFlag(),
+                                 client_settings_->shadow_max_bytes_in_flight);
+  if (rv == -1 && err != E::SHADOW_BUSY) {
     // TODO detailed scuba stats T20416930 including error code
     STAT_INCR(stats_, client.shadow_append_failed);
   }
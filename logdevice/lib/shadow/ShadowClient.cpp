@@ -152,9 +152,28 @@ ShadowClient::~ShadowClient() {}
 int ShadowClient::append(logid_t logid,
                          const Payload& payload,
                          AppendAttributes attrs,
-                         bool buffered_writer_blob) noexcept {
+                         bool buffered_writer_blob,
+                         size_t max_bytes_in_flight) noexcept {
   auto callback = [&](auto a, const auto& b) { this->appendCallback(a, b); };
 
+  // Reserve the payload's size before copying it. Appends to a slow shadow
+  // cluster pile up on its workers; past the limit, drop them rather than
+  // buffer more copies of production payloads.
+  const size_t size = payload.size();
+  if (bytes_in_flight_.fetch_add(size) + size > max_bytes_in_flight) {
+    bytes_in_flight_.fetch_sub(size);
+    STAT_INCR(stats_, client.shadow_append_dropped);
+    RATELIMIT_WARNING(1s,
+                      1,
+                      LD_SHADOW_PREFIX
+                      "Dropping shadow appends to '%s': more than %zu bytes "
+                      "in flight",
+                      shadow_attrs_->destination().c_str(),
+                      max_bytes_in_flight);
+    err = E::SHADOW_BUSY;
+    return -1;
+  }
+
   // Need to copy payload, since it is technically owned by the client
   // This will likely be a performance impact, so care should be taken
   // to keep the ratio low and only enable shadowing on clients that
@@ -167,6 +186,7 @@ int ShadowClient::append(logid_t logid,
     STAT_INCR(stats_, client.shadow_payload_alloc_failed);
     ld_warning(LD_SHADOW_PREFIX
                "Failed to allocate memory for duplicating shadow payload");
+    bytes_in_flight_.fetch_sub(size);
     err = E::NOMEM;
     return -1;
   }
@@ -191,6 +211,7 @@ int ShadowClient::append(logid_t logid,
   }
 
   if (rv == -1) {
+    bytes_in_flight_.fetch_sub(size);
     // Payload was created via Payload.dup() which uses malloc()
     free(const_cast<void*>(payload_copy.data()));
     RATELIMIT_WARNING(1s,
@@ -218,6 +239,7 @@ void ShadowClient::appendCallback(Status status, const DataRecord& record) {
                       error_description(status));
   }
 
+  bytes_in_flight_.fetch_sub(record.payload.size());
   // Payload was created via Payload.dup() which uses malloc()
   free(const_cast<void*>(record.payload.data()));
 }
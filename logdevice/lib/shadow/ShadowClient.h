@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <memory>
@@ -106,10 +107,22 @@ class ShadowClient {
 
   ~ShadowClient();
 
+  /**
+   * Copies the payload and appends it to the shadow cluster. Doesn't wait
+   * for the append to complete.
+   *
+   * @param max_bytes_in_flight  if the payloads of appends still in flight
+   *                             plus this one would exceed it, the append is
+   *                             dropped
+   * @return 0 if the append was posted, -1 otherwise with err set to
+   *         E::SHADOW_BUSY if it was dropped, E::NOMEM if the payload
+   *         couldn't be copied, or an error of ClientImpl::postAppend()
+   */
   int append(logid_t logid,
              const Payload& payload,
              AppendAttributes attrs,
-             bool buffered_writer_blob) noexcept;
+             bool buffered_writer_blob,
+             size_t max_bytes_in_flight) noexcept;
 
  private:
   ShadowClient(std::shared_ptr<Client> client,
@@ -122,6 +135,9 @@ class ShadowClient {
   Shadow::Attrs shadow_attrs_;
   StatsHolder* stats_;
   std::chrono::milliseconds client_timeout_{0};
+
+  // Total size of payloads of appends posted but not completed yet.
+  std::atomic<size_t> bytes_in_flight_{0};
 };
 
 }} // namespace facebook::logdevice
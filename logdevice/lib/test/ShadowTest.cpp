@@ -288,8 +288,24 @@ TEST(ShadowClientTest, ShadowClientInitAppend) {
 
   std::string payload_str = "test";
   Payload payload{payload_str.data(), payload_str.size()};
-  int rv = shadow_client->append(logid_t{1}, payload, {}, false);
+  int rv = shadow_client->append(logid_t{1}, payload, {}, false, 1024);
   ASSERT_EQ(rv, 0);
 }
 
+// Appends that would exceed the limit on bytes in flight are dropped
+TEST(ShadowClientTest, ShadowClientDropsOverLimit) {
+  LogAttributes::Shadow shadowAttr{
+      std::string("file:") + TEST_CONFIG_FILE("sample_no_ssl.conf"), 0.1};
+  std::shared_ptr<ShadowClient> shadow_client = ShadowClient::create(
+      "test", shadowAttr, std::chrono::seconds(10), nullptr);
+  ASSERT_NE(shadow_client, nullptr);
+
+  std::string payload_str = "test";
+  Payload payload{payload_str.data(), payload_str.size()};
+  int rv = shadow_client->append(
+      logid_t{1}, payload, {}, false, payload_str.size() - 1);
+  ASSERT_EQ(rv, -1);
+  ASSERT_EQ(err, E::SHADOW_BUSY);
+}
+
 }} // namespace facebook::logdevice
@@ -7,7 +7,9 @@
  */
 #include "AdminCommandClient.h"
 
+#include <algorithm>
 #include <deque>
+#include <limits>
 
 #include <folly/Memory.h>
 #include <folly/io/async/AsyncSSLSocket.h>
@@ -16,6 +18,7 @@
 #include <folly/io/async/AsyncTransport.h>
 #include <folly/io/async/EventBase.h>
 
+#include "logdevice/common/AdminCommandTableBinary.h"
 #include "logdevice/common/debug.h"
 
 using folly::AsyncSocket;
@@ -97,6 +100,8 @@ class AdminClientConnection
   void readDataAvailable(size_t length) noexcept override {
     ld_check(length > 0);
     result_.back().resize(length);
+    received_ += length;
+    checkBinaryResponse();
 
     if (result_.size() >= 8) {
       // fold all buffers together to reclaim some memory
@@ -114,7 +119,12 @@ class AdminClientConnection
       result_.resize(result_.size() - 1);
     }
 
-    // Checking if we're done here
+    // Checking if we're done here. Binary responses are not escaped and may
+    // contain the end marker, so wait for all of the encoding first.
+    if (binary_size_.hasValue() &&
+        received_ < binary_size_.value() + eof.size()) {
+      return;
+    }
     if (result_.back().size() >= eof.size()) {
       if (result_.back().compare(
               result_.back().size() - eof.size(), eof.size(), eof) == 0) {
@@ -195,6 +205,26 @@ class AdminClientConnection
     result_.clear();
   }
 
+  // Once we have received enough of the response, checks whether it is a
+  // table in the binary format of AdminCommandTableBinary.h and if so sets
+  // binary_size_.
+  void checkBinaryResponse() {
+    if (binary_checked_ ||
+        received_ < admin_command_table::BINARY_PREFIX_SIZE) {
+      return;
+    }
+    binary_checked_ = true;
+    std::string prefix;
+    for (const auto& s : result_) {
+      if (prefix.size() >= admin_command_table::BINARY_PREFIX_SIZE) {
+        break;
+      }
+      prefix += s;
+    }
+    binary_size_ =
+        admin_command_table::binaryEncodingSize(prefix.data(), prefix.size());
+  }
+
   ~AdminClientConnection() override {
     // Deregister socket callback to avoid readEOF to be invoked
     // when we close the socket.
@@ -208,6 +238,9 @@ class AdminClientConnection
   std::vector<std::string> result_;
   bool success_{false};
   bool done_{false};
+  size_t received_{0};
+  bool binary_checked_{false};
+  folly::Optional<size_t> binary_size_;
   std::function<void()> done_callback_;
   std::chrono::milliseconds timeout_;
   std::chrono::steady_clock::time_point tstart_;
@@ -217,7 +250,8 @@ std::vector<folly::SemiFuture<AdminCommandClient::RequestResponse*>>
 AdminCommandClient::semifuture_send(
     std::vector<AdminCommandClient::RequestResponse>& rr,
     std::chrono::milliseconds command_timeout,
-    std::chrono::milliseconds connect_timeout) {
+    std::chrono::milliseconds connect_timeout,
+    ResponseCallback on_response) {
   std::shared_ptr<
       std::vector<folly::Promise<AdminCommandClient::RequestResponse*>>>
       proms = std::make_shared<
@@ -236,6 +270,12 @@ AdminCommandClient::semifuture_send(
     actual_num_threads = rr.size();
     num_requests_per_thread = 1;
   }
+  // Split the limit on outstanding commands between the threads.
+  const size_t max_in_flight_per_thread = max_in_flight_ == 0
+      ? std::numeric_limits<size_t>::max()
+      : std::max(size_t(1),
+                 (max_in_flight_ + actual_num_threads - 1) /
+                     actual_num_threads);
   executor_ =
       std::make_unique<folly::CPUThreadPoolExecutor>(actual_num_threads);
   for (int k = 0; k < actual_num_threads; k++) {
@@ -248,10 +288,14 @@ AdminCommandClient::semifuture_send(
                     connect_timeout,
                     start,
                     num_requests_per_thread,
+                    max_in_flight_per_thread,
+                    on_response,
                     &rr]() mutable {
       bool timed_out = false;
       size_t connections_done = 0;
-      size_t connections_size;
+      const size_t end =
+          std::min(rr.size(), size_t(start + num_requests_per_thread));
+      const size_t connections_size = end - start;
       auto& promises = *proms;
       {
         // Scope event_base and connections objects
@@ -263,24 +307,36 @@ AdminCommandClient::semifuture_send(
         timeout->scheduleTimeout(command_timeout);
         auto context = std::make_shared<folly::SSLContext>();
 
-        for (size_t i = start;
-             i < rr.size() && i - start < num_requests_per_thread;
-             ++i) {
-          auto connection = std::make_unique<AdminClientConnection>(
-              &event_base,
-              rr[i],
-              [i, &connections_done, &promises, &rr]() {
-                ++connections_done;
-                promises[i].setValue(&rr[i]);
-              },
-              connect_timeout,
-              context);
-          connection->connect();
-          connections.push_back(std::move(connection));
-        }
-        connections_size = connections.size();
+        size_t next = start;
+        // Opens connections until there are max_in_flight_per_thread of them
+        // outstanding. Called again each time some complete.
+        auto connect_more = [&]() {
+          while (next < end &&
+                 next - start - connections_done < max_in_flight_per_thread) {
+            const size_t i = next++;
+            auto connection = std::make_unique<AdminClientConnection>(
+                &event_base,
+                rr[i],
+                [i, &connections_done, &promises, &rr, &on_response]() {
+                  ++connections_done;
+                  if (on_response) {
+                    on_response(rr[i]);
+                  }
+                  promises[i].setValue(&rr[i]);
+                },
+                connect_timeout,
+                context);
+            connection->connect();
+            connections.push_back(std::move(connection));
+          }
+        };
+
+        connect_more();
         do {
           event_base.loopOnce();
+          if (!timed_out) {
+            connect_more();
+          }
         } while (connections_done < connections_size && !timed_out);
       }
 
@@ -288,13 +344,14 @@ AdminCommandClient::semifuture_send(
         ld_error("Timed out after %lums reading from %lu nodes",
                  command_timeout.count(),
                  connections_size - connections_done);
-        for (size_t i = start;
-             i < rr.size() && i - start < num_requests_per_thread;
-             ++i) {
+        for (size_t i = start; i < end; ++i) {
           if (!rr[i].success && rr[i].failure_reason.empty()) {
             rr[i].failure_reason = "TIMEOUT";
             if (!promises[i].isFulfilled()) {
               ++connections_done;
+              if (on_response) {
+                on_response(rr[i]);
+              }
               promises[i].setValue(&rr[i]);
               if (connections_done == connections_size) {
                 break;
@@ -312,8 +369,10 @@ AdminCommandClient::semifuture_send(
 void AdminCommandClient::send(
     std::vector<AdminCommandClient::RequestResponse>& rr,
     std::chrono::milliseconds command_timeout,
-    std::chrono::milliseconds connect_timeout) {
-  collectAllSemiFuture(semifuture_send(rr, command_timeout, connect_timeout))
+    std::chrono::milliseconds connect_timeout,
+    ResponseCallback on_response) {
+  collectAllSemiFuture(semifuture_send(
+                           rr, command_timeout, connect_timeout, on_response))
       .wait();
   terminate();
 }
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
 #include <map>
 #include <vector>
 
@@ -18,6 +19,12 @@
 /**
  * @file AdminCommandClient sends an admin command in parallel to several
  * logdeviced instances and waits for all response with a timeout.
+ *
+ * At most `max_in_flight` commands are outstanding at any time (0 means no
+ * limit), so that querying a large cluster doesn't open thousands of
+ * connections at once. An optional callback is called as soon as each
+ * response is in, so that callers can process responses while others are
+ * still being fetched.
  */
 
 namespace facebook { namespace logdevice {
@@ -26,8 +33,8 @@ class AdminCommandClient {
  public:
   enum class ConnectionType { UNKNOWN, PLAIN, ENCRYPTED };
 
-  AdminCommandClient(size_t num_threads = 4)
-      : executor_(), num_threads_(num_threads) {}
+  AdminCommandClient(size_t num_threads = 4, size_t max_in_flight = 0)
+      : executor_(), num_threads_(num_threads), max_in_flight_(max_in_flight) {}
 
   class RequestResponse {
    public:
@@ -46,16 +53,22 @@ class AdminCommandClient {
 
   typedef std::vector<AdminCommandClient::RequestResponse> RequestResponses;
 
+  // Called on one of the client's threads with each RequestResponse once it
+  // is complete, successful or not. Must be thread safe.
+  typedef std::function<void(RequestResponse&)> ResponseCallback;
+
   void send(RequestResponses& rr,
             std::chrono::milliseconds command_timeout,
             std::chrono::milliseconds connect_timeout =
-                std::chrono::milliseconds(5000));
+                std::chrono::milliseconds(5000),
+            ResponseCallback on_response = nullptr);
 
   std::vector<folly::SemiFuture<RequestResponse*>>
   semifuture_send(std::vector<RequestResponse>& rr,
                   std::chrono::milliseconds command_timeout,
                   std::chrono::milliseconds connect_timeout =
-                      std::chrono::milliseconds(5000));
+                      std::chrono::milliseconds(5000),
+                  ResponseCallback on_response = nullptr);
 
   void terminate() {
     executor_.reset();
@@ -64,6 +77,7 @@ class AdminCommandClient {
  private:
   std::unique_ptr<folly::CPUThreadPoolExecutor> executor_;
   size_t num_threads_{4};
+  size_t max_in_flight_{0};
 };
 
 }} // namespace facebook::logdevice
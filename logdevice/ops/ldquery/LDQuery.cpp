@@ -27,8 +27,10 @@
 #include "tables/Info.h"
 #include "tables/InfoConfig.h"
 #include "tables/IsLogEmpty.h"
+#include "tables/IteratorIO.h"
 #include "tables/Iterators.h"
 #include "tables/LogGroups.h"
+#include "tables/LogHeavyHitters.h"
 #include "tables/LogRebuildings.h"
 #include "tables/LogStorageState.h"
 #include "tables/LogsConfigRsm.h"
@@ -49,6 +51,7 @@
 #include "tables/Sockets.h"
 #include "tables/Stats.h"
 #include "tables/StatsRocksdb.h"
+#include "tables/StorageTaskLatencies.h"
 #include "tables/StorageTasks.h"
 #include "tables/StoredLogs.h"
 #include "tables/SyncSequencerRequests.h"
@@ -155,8 +158,10 @@ LDQuery::LDQuery(std::string config_path,
   table_registry_.registerTable<tables::Info>(ctx_);
   table_registry_.registerTable<tables::InfoConfig>(ctx_);
   table_registry_.registerTable<tables::IsLogEmpty>(ctx_);
+  table_registry_.registerTable<tables::IteratorIO>(ctx_);
   table_registry_.registerTable<tables::Iterators>(ctx_);
   table_registry_.registerTable<tables::LogGroups>(ctx_);
+  table_registry_.registerTable<tables::LogHeavyHitters>(ctx_);
   table_registry_.registerTable<tables::LogRebuildings>(ctx_);
   table_registry_.registerTable<tables::LogStorageState>(ctx_);
   table_registry_.registerTable<tables::LogsConfigRsm>(ctx_);
@@ -176,6 +181,7 @@ LDQuery::LDQuery(std::string config_path,
   table_registry_.registerTable<tables::Sockets>(ctx_);
   table_registry_.registerTable<tables::Stats>(ctx_);
   table_registry_.registerTable<tables::StatsRocksdb>(ctx_);
+  table_registry_.registerTable<tables::StorageTaskLatencies>(ctx_);
   table_registry_.registerTable<tables::StorageTasks>(ctx_);
   table_registry_.registerTable<tables::StoredLogs>(ctx_);
   table_registry_.registerTable<tables::SyncSequencerRequests>(ctx_);
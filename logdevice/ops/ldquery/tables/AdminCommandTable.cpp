@@ -7,13 +7,14 @@
  */
 #include "AdminCommandTable.h"
 
-#include <thread>
+#include <cstring>
 
 #include <folly/Memory.h>
 #include <folly/String.h>
 #include <folly/json.h>
 
 #include "external/gason/gason.h"
+#include "logdevice/common/AdminCommandTableBinary.h"
 #include "logdevice/common/configuration/UpdateableConfig.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/lib/ClientImpl.h"
@@ -277,7 +278,10 @@ void AdminCommandTable::refillCache(QueryContext& ctx) {
     }
   }
 
-  AdminCommandClient ld_admin_client;
+  // Responses are parsed on the client's threads as they arrive, hence the
+  // large number of threads.
+  AdminCommandClient ld_admin_client(
+      /*num_threads=*/32, /*max_in_flight=*/MAX_NODES_IN_FLIGHT);
 
   std::unordered_map<folly::SocketAddress, node_index_t> addr_to_node_id;
   AdminCommandClient::RequestResponses request_response;
@@ -297,8 +301,15 @@ void AdminCommandTable::refillCache(QueryContext& ctx) {
           folly::rtrimWhitespace(cmd.c_str()).str().c_str(),
           request_response.size());
 
+  std::vector<TableData> results(request_response.size());
   steady_clock::time_point tstart = steady_clock::now();
-  ld_admin_client.send(request_response, command_timeout_);
+  ld_admin_client.send(
+      request_response,
+      command_timeout_,
+      std::chrono::milliseconds(5000),
+      [&](AdminCommandClient::RequestResponse& r) {
+        transformResponse(r, results[&r - request_response.data()]);
+      });
   steady_clock::time_point tend = steady_clock::now();
   double duration =
       std::chrono::duration_cast<std::chrono::duration<double>>(tend - tstart)
@@ -307,15 +318,12 @@ void AdminCommandTable::refillCache(QueryContext& ctx) {
   for (const auto& r : request_response) {
     replies += r.success;
   }
-  ld_info("Receiving data took %.1fs, %lu/%lu nodes replied",
+  ld_info("Receiving and parsing data took %.1fs, %lu/%lu nodes replied",
           duration,
           replies,
           request_response.size());
   tstart = tend;
 
-  ld_info("Parsing json data...");
-  std::vector<TableData> results = transformDataParallel(request_response);
-  ld_check(results.size() == request_response.size());
   for (int i = 0; i < results.size(); ++i) {
     if (!results[i].cols.empty()) {
       size_t rows = results[i].cols.begin()->second.size();
@@ -337,13 +345,6 @@ void AdminCommandTable::refillCache(QueryContext& ctx) {
     }
   }
 
-  tend = steady_clock::now();
-  duration =
-      std::chrono::duration_cast<std::chrono::duration<double>>(tend - tstart)
-          .count();
-  ld_info("Json parsing took %.1fs", duration);
-
-  tstart = tend;
   Data data;
   ld_info("Aggregating data from %lu nodes...", request_response.size());
   data.data = std::make_shared<TableData>(aggregate(std::move(results)));
@@ -645,6 +646,84 @@ PartialTableData AdminCommandTable::jsonToTableData(std::string json) const {
   return PartialTableData{std::move(results), true, ""};
 }
 
+PartialTableData
+AdminCommandTable::binaryToTableData(std::string data) const {
+  using namespace admin_command_table;
+  const PartialTableData malformed{folly::none, false, "MALFORMED_RESPONSE"};
+
+  auto size = binaryEncodingSize(data.data(), data.size());
+  if (!size.hasValue() || size.value() > data.size()) {
+    ld_error("Truncated binary table");
+    return malformed;
+  }
+  const char* p = data.data() + BINARY_PREFIX_SIZE;
+  const char* const end = data.data() + size.value();
+
+  auto read_u32 = [&](uint32_t& v) {
+    if (size_t(end - p) < sizeof(v)) {
+      return false;
+    }
+    std::memcpy(&v, p, sizeof(v));
+    p += sizeof(v);
+    return true;
+  };
+
+  uint32_t num_cols;
+  uint32_t num_rows;
+  if (!read_u32(num_cols) || !read_u32(num_rows)) {
+    ld_error("Truncated binary table header");
+    return malformed;
+  }
+
+  TableData results;
+  // If `data` is nullptr, the column is not present in getFetchableColumns(),
+  // so we should ignore it.
+  std::vector<ColumnAndDataType> columns(num_cols);
+  for (auto& column_info : columns) {
+    uint32_t len;
+    if (!read_u32(len) || size_t(end - p) < len) {
+      ld_error("Truncated binary table header");
+      return malformed;
+    }
+    std::string name(p, len);
+    p += len;
+    NameNormalizer::normalize(name);
+    auto it = nameToPosMap_.find(name);
+    if (it != nameToPosMap_.end()) {
+      column_info.type = getFetchableColumns()[it->second].type;
+      column_info.data = &results.cols[name];
+      column_info.data->reserve(num_rows);
+    }
+  }
+
+  for (auto& column_info : columns) {
+    for (uint32_t row = 0; row < num_rows; ++row) {
+      uint32_t len;
+      if (!read_u32(len)) {
+        ld_error("Truncated binary table");
+        return malformed;
+      }
+      if (len == BINARY_NULL_VALUE) {
+        if (column_info.data) {
+          column_info.data->push_back(folly::none);
+        }
+        continue;
+      }
+      if (size_t(end - p) < len) {
+        ld_error("Truncated binary table");
+        return malformed;
+      }
+      if (column_info.data) {
+        column_info.data->emplace_back(std::string(p, len));
+        preprocessColumn(column_info.type, &column_info.data->back());
+      }
+      p += len;
+    }
+  }
+
+  return PartialTableData{std::move(results), true, ""};
+}
+
 PartialTableData
 AdminCommandTable::statToTableData(std::string stat_output) const {
   TableData result;
@@ -702,6 +781,10 @@ PartialTableData
 AdminCommandTable::transformData(std::string response_from_node) const {
   switch (type_) {
     case Type::JSON_TABLE:
+      if (admin_command_table::binaryEncodingSize(
+              response_from_node.data(), response_from_node.size())) {
+        return binaryToTableData(std::move(response_from_node));
+      }
       return jsonToTableData(std::move(response_from_node));
     case Type::STAT:
       return statToTableData(std::move(response_from_node));
@@ -712,41 +795,21 @@ AdminCommandTable::transformData(std::string response_from_node) const {
   return PartialTableData{folly::none, false, "UNEXPECTED"};
 }
 
-std::vector<TableData> AdminCommandTable::transformDataParallel(
-    AdminCommandClient::RequestResponses& responses) {
-  std::vector<TableData> outputs(responses.size());
-
-  auto thread_func = [&](size_t from, size_t to) {
-    for (size_t i = from; i < std::min(to, responses.size()); ++i) {
-      if (responses[i].success) {
-        PartialTableData partial_data =
-            transformData(std::move(responses[i].response));
-        if (partial_data.success) {
-          outputs[i] = std::move(*(partial_data.data));
-        } else {
-          responses[i].success = false;
-          responses[i].failure_reason = partial_data.failure_reason;
-        }
-      }
-    }
-  };
-
-  const size_t num_threads = 32;
-  const size_t num_per_thread = responses.size() / num_threads + 1;
-
-  std::vector<std::thread> threads;
-  for (int i = 0; i < num_threads && i * num_per_thread < responses.size();
-       i++) {
-    const size_t from = i * num_per_thread;
-    const size_t to = from + num_per_thread;
-    threads.push_back(std::thread(thread_func, from, to));
-  }
-
-  for (int i = 0; i < threads.size(); ++i) {
-    threads[i].join();
+void AdminCommandTable::transformResponse(
+    AdminCommandClient::RequestResponse& response,
+    TableData& out) const {
+  if (!response.success) {
+    return;
+  }
+  PartialTableData partial_data = transformData(std::move(response.response));
+  // Don't keep the raw response around while other nodes are still replying.
+  std::string().swap(response.response);
+  if (partial_data.success) {
+    out = std::move(*(partial_data.data));
+  } else {
+    response.success = false;
+    response.failure_reason = partial_data.failure_reason;
   }
-
-  return outputs;
 }
 
 }}} // namespace facebook::logdevice::ldquery
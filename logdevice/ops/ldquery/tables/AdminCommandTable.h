@@ -36,6 +36,11 @@ class AdminCommandTable : public Table {
   // @see num_fetches_.
   static constexpr int MAX_FETCHES = 5;
 
+  // Maximum number of nodes we wait for a reply from at the same time. Bounds
+  // the number of connections and of replies buffered in memory when querying
+  // large clusters.
+  static constexpr size_t MAX_NODES_IN_FLIGHT = 256;
+
   enum class Type { JSON_TABLE, STAT };
 
   explicit AdminCommandTable(std::shared_ptr<Context> ctx,
@@ -58,6 +63,10 @@ class AdminCommandTable : public Table {
   // converts json to a column representation
   PartialTableData jsonToTableData(std::string json) const;
 
+  // converts a table in the binary format of AdminCommandTableBinary.h, which
+  // admin commands print with --binary, to a column representation
+  PartialTableData binaryToTableData(std::string data) const;
+
   // converts stat output to a column representation
   PartialTableData statToTableData(std::string stat_output) const;
 
@@ -120,8 +129,11 @@ class AdminCommandTable : public Table {
   // getFetchableColumns().
   std::unordered_map<ColumnName, int> nameToPosMap_;
 
-  std::vector<TableData>
-  transformDataParallel(AdminCommandClient::RequestResponses& responses);
+  // Converts the response of a node into `out` and frees the response.
+  // Called as soon as the response arrives, on one of AdminCommandClient's
+  // threads.
+  void transformResponse(AdminCommandClient::RequestResponse& response,
+                         TableData& out) const;
 
   std::chrono::milliseconds command_timeout_;
   Type type_;
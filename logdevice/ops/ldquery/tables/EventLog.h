@@ -85,6 +85,19 @@ class EventLog : public AdminCommandTable {
          "log reports itself as healthy, ie it has enough healthy connections "
          "to the storage nodes in the delta log's storage set such that it "
          "should be able to not miss any delta."},
+        {"snapshot_tail_ms",
+         DataType::BIGINT,
+         "On startup, how long it took the state machine to find the tail of "
+         "the snapshot log, in milliseconds."},
+        {"snapshot_replay_ms",
+         DataType::BIGINT,
+         "On startup, how long it took the state machine to read the snapshot "
+         "log up to its tail, in milliseconds."},
+        {"delta_replay_ms",
+         DataType::BIGINT,
+         "On startup, how long it took the state machine to read the delta "
+         "log up to its tail and deliver the initial state to subscribers, in "
+         "milliseconds."},
         {"propagated_version",
          DataType::LSN,
          "Version of the last state that was fully propagated to all state "
@@ -75,7 +75,16 @@ class Info : public AdminCommandTable {
          "while the permissions and users are stored in an external store).  "
          "See \"PermissionCheckerType\" in "
          "\"logdevice/common/SecurityInformation.h\" for more information."},
-        {"rocksdb_version", DataType::TEXT, "Version of RocksDB."}};
+        {"rocksdb_version", DataType::TEXT, "Version of RocksDB."},
+        {"worker_cpus",
+         DataType::TEXT,
+         "CPUs each worker thread is pinned to, e.g. \"WG0:2 WG1:3 WF0:2-3\", "
+         "or \"none\".  See the \"worker-cpus\" setting."},
+        {"storage_thread_numa_nodes",
+         DataType::TEXT,
+         "NUMA node the storage threads of each shard are bound to, e.g. "
+         "\"S0:0 S1:1\", or \"none\".  See the \"storage-thread-numa-nodes\" "
+         "setting."}};
   }
   std::string getCommandToSend(QueryContext& /*ctx*/) const override {
     return std::string("info --json\n");
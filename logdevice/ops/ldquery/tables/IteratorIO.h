@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "../Context.h"
+#include "AdminCommandTable.h"
+
+namespace facebook {
+  namespace logdevice {
+    namespace ldquery {
+      namespace tables {
+
+class IteratorIO : public AdminCommandTable {
+ public:
+  explicit IteratorIO(std::shared_ptr<Context> ctx) : AdminCommandTable(ctx) {}
+  static std::string getName() {
+    return "iterator_io";
+  }
+  std::string getDescription() override {
+    return "Disk IO done by RocksDB iterators on all storage nodes since the "
+           "nodes started, aggregated by the context the iterators were "
+           "created in. Unlike the \"iterators\" table, this includes "
+           "iterators that were already destroyed. Useful to find out which "
+           "readers are responsible for a node's disk reads.";
+  }
+  TableColumns getFetchableColumns() const override {
+    return {
+        {"more_context",
+         DataType::TEXT,
+         "Where the iterators were created, e.g. read streams or rebuilding."},
+        {"rebuilding",
+         DataType::BIGINT,
+         "1 if the iterators are used for rebuilding, 0 otherwise."},
+        {"open_iterators",
+         DataType::BIGINT,
+         "Number of iterators in this context that currently exist."},
+        {"bytes_read",
+         DataType::BIGINT,
+         "Bytes read from disk (or OS page cache, but not RocksDB block "
+         "cache) by the iterators."},
+        {"blocks_read",
+         DataType::BIGINT,
+         "Number of blocks read from disk by the iterators."},
+        {"seeks",
+         DataType::BIGINT,
+         "Number of seeks done on the iterators, including lower-level "
+         "iterators."},
+    };
+  }
+  std::string getCommandToSend(QueryContext& /*ctx*/) const override {
+    return std::string("info iterators --io-summary --json\n");
+  }
+};
+
+}}}} // namespace facebook::logdevice::ldquery::tables
@@ -69,10 +69,22 @@ class Iterators : public AdminCommandTable {
         {"version",
          DataType::BIGINT,
          "RocksDB superversion that this iterator points to."},
+        {"bytes_read",
+         DataType::BIGINT,
+         "Bytes read from disk (or OS page cache, but not RocksDB block "
+         "cache) by operations on this iterator. IO done by lower-level "
+         "iterators is counted in the high-level iterator only."},
+        {"blocks_read",
+         DataType::BIGINT,
+         "Number of blocks read from disk by operations on this iterator. "
+         "Same caveats as \"bytes_read\"."},
+        {"seeks",
+         DataType::BIGINT,
+         "Number of times this iterator was seeked."},
     };
   }
   std::string getCommandToSend(QueryContext& /*ctx*/) const override {
-    return std::string("info iterators --json\n");
+    return std::string("info iterators --binary\n");
   }
 };
 
@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "../Context.h"
+#include "AdminCommandTable.h"
+
+namespace facebook {
+  namespace logdevice {
+    namespace ldquery {
+      namespace tables {
+
+class LogHeavyHitters : public AdminCommandTable {
+ public:
+  using AdminCommandTable::AdminCommandTable;
+  static std::string getName() {
+    return "log_heavy_hitters";
+  }
+  std::string getDescription() override {
+    return "Logs responsible for the most appended bytes, read bytes and "
+           "storage thread time on each node, over the last complete 5 minute "
+           "window. Tracked for all logs with bounded memory, so values are "
+           "upper bounds and only logs with a significant share of a node's "
+           "load are guaranteed to be listed. Windows are aligned on the "
+           "system clock, so rows of different nodes can be summed, e.g. "
+           "\"SELECT log_id, SUM(value) FROM log_heavy_hitters WHERE metric = "
+           "'appended_bytes' GROUP BY log_id ORDER BY 2 DESC\".";
+  }
+  TableColumns getFetchableColumns() const override {
+    return {
+        {"metric",
+         DataType::TEXT,
+         "\"appended_bytes\": payload bytes of appends received by the "
+         "sequencer. \"read_bytes\": bytes read from the local log store by "
+         "read streams. \"storage_task_usec\": storage thread time spent "
+         "executing tasks that read the log."},
+        {"log_id", DataType::LOGID, "Log ID."},
+        {"value",
+         DataType::BIGINT,
+         "Upper bound of the value of the metric for the log in the window."},
+        {"max_error",
+         DataType::BIGINT,
+         "How much \"value\" may be overestimated by."},
+        {"window_start", DataType::TIME, "Start of the window."},
+        {"window_sec", DataType::BIGINT, "Length of the window, in seconds."}};
+  }
+  std::string getCommandToSend(QueryContext& ctx) const override {
+    std::string expr;
+    if (columnHasEqualityConstraint(1, ctx, expr)) {
+      return std::string("info log_heavy_hitters --metric ") + expr.c_str() +
+          " --json\n";
+    } else {
+      return std::string("info log_heavy_hitters --json\n");
+    }
+  }
+};
+
+}}}} // namespace facebook::logdevice::ldquery::tables
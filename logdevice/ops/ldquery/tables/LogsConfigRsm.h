@@ -77,6 +77,19 @@ class LogsConfigRsm : public AdminCommandTable {
         {"delta_log_records",
          DataType::BIGINT,
          "Number of delta records that are past the last snapshot."},
+        {"snapshot_tail_ms",
+         DataType::BIGINT,
+         "On startup, how long it took the state machine to find the tail of "
+         "the snapshot log, in milliseconds."},
+        {"snapshot_replay_ms",
+         DataType::BIGINT,
+         "On startup, how long it took the state machine to read the snapshot "
+         "log up to its tail, in milliseconds."},
+        {"delta_replay_ms",
+         DataType::BIGINT,
+         "On startup, how long it took the state machine to read the delta "
+         "log up to its tail and deliver the initial state to subscribers, in "
+         "milliseconds."},
     };
   }
   std::string getCommandToSend(QueryContext& /*ctx*/) const override {
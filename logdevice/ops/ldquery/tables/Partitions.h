@@ -112,7 +112,16 @@ class Partitions : public AdminCommandTable {
          "Nodes that have uncommitted append data in this partition."},
         {"rebuild_dirtied_by",
          DataType::TEXT,
-         "Nodes that have uncommitted rebuild data in this partition."}};
+         "Nodes that have uncommitted rebuild data in this partition."},
+        {"spare_partitions",
+         DataType::BIGINT,
+         "Number of empty partitions pre-created in this shard ahead of the "
+         "latest partition (see --rocksdb-partition-precreate-count). Same "
+         "for all partitions of the shard."},
+        {"drop_pending",
+         DataType::BOOL,
+         "True if this partition is being dropped by a partition drop that's "
+         "currently in progress."}};
   }
   std::string getCommandToSend(QueryContext& ctx) const override {
     std::string expr;
@@ -57,8 +57,14 @@ class Purges : public AdminCommandTable {
          "\"logdevice/server/storage/PurgeSingleEpoch.h\""},
     };
   }
-  std::string getCommandToSend(QueryContext& /*ctx*/) const override {
-    return std::string("info purges --json\n");
+  std::string getCommandToSend(QueryContext& ctx) const override {
+    logid_t logid;
+    if (columnHasEqualityConstraintOnLogid(1, ctx, logid)) {
+      return std::string("info purges ") + std::to_string(logid.val_) +
+          " --json\n";
+    } else {
+      return std::string("info purges --json\n");
+    }
   }
 };
 
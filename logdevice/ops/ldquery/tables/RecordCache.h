@@ -80,7 +80,7 @@ class RecordCache : public AdminCommandTable {
       shard_constraint = std::string(" --shard=") + shard_expr.c_str();
     }
 
-    return std::string("info record_cache --json") + log_constraint +
+    return std::string("info record_cache --binary") + log_constraint +
         shard_constraint + "\n";
   }
 };
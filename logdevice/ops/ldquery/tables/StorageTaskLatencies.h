@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "../Context.h"
+#include "AdminCommandTable.h"
+
+namespace facebook {
+  namespace logdevice {
+    namespace ldquery {
+      namespace tables {
+
+class StorageTaskLatencies : public AdminCommandTable {
+ public:
+  using AdminCommandTable::AdminCommandTable;
+  static std::string getName() {
+    return "storage_task_latencies";
+  }
+  virtual std::string getDescription() override {
+    return "Latency percentiles of the storage tasks of each shard since the "
+           "server started, by stage of their lifecycle. Use it with "
+           "\"storage_tasks\" to find where storage tasks spend their time on "
+           "a slow node.";
+  }
+  virtual TableColumns getFetchableColumns() const override {
+    return {
+        {"shard", DataType::BIGINT, "Index of the local log store shard."},
+        {"group",
+         DataType::TEXT,
+         "What the row is broken down by: \"type\" for the type of the "
+         "storage task, \"priority\" for its priority."},
+        {"name", DataType::TEXT, "Storage task type or priority."},
+        {"stage",
+         DataType::TEXT,
+         "\"queue\": time spent in the storage thread queue. \"execution\": "
+         "time spent executing on a storage thread. \"response\": time from "
+         "the task completing to the worker processing its response. Only "
+         "\"queue\" is broken down by priority."},
+        {"count", DataType::BIGINT, "Number of tasks measured."},
+        {"p50_usec", DataType::REAL, "Median latency, in microseconds."},
+        {"p99_usec",
+         DataType::REAL,
+         "99th percentile of the latency, in microseconds."},
+        {"max_usec", DataType::REAL, "Maximum latency, in microseconds."}};
+  }
+  virtual std::string getCommandToSend(QueryContext& ctx) const override {
+    std::string expr;
+    if (columnHasEqualityConstraint(1, ctx, expr)) {
+      return std::string("info storage_tasks ") + expr.c_str() +
+          " --latencies --json\n";
+    } else {
+      return std::string("info storage_tasks --latencies --json\n");
+    }
+  }
+};
+
+}}}} // namespace facebook::logdevice::ldquery::tables
@@ -76,7 +76,15 @@ class StorageTasks : public AdminCommandTable {
          "Address of the client that initiated the storage task."},
         {"extra_info",
          DataType::TEXT,
-         "Other information specific to particular task type."}};
+         "Other information specific to particular task type."},
+        {"stealable",
+         DataType::BOOL,
+         "True if an idle storage thread of another shard may execute this "
+         "task (see --storage-task-stealing-interval)."},
+        {"shard_tasks_stolen",
+         DataType::BIGINT,
+         "Number of tasks of this shard that were executed by storage threads "
+         "of other shards since the server started."}};
   }
   virtual std::string getCommandToSend(QueryContext& ctx) const override {
     std::string expr;
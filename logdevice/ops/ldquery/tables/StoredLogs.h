@@ -51,8 +51,21 @@ class StoredLogs : public AdminCommandTable {
          "non-decreasing with LSN in this log.  Can be overestimated by up to "
          "\"rocksdb-partition-duration\" setting."}};
   }
-  std::string getCommandToSend(QueryContext& /*ctx*/) const override {
-    return std::string("info stored_logs --extended --json\n");
+  std::string getCommandToSend(QueryContext& ctx) const override {
+    std::string log_constraint;
+    logid_t logid;
+    if (columnHasEqualityConstraintOnLogid(1, ctx, logid)) {
+      log_constraint = std::string(" ") + std::to_string(logid.val_);
+    }
+
+    std::string shard_constraint;
+    std::string shard_expr;
+    if (columnHasEqualityConstraint(2, ctx, shard_expr)) {
+      shard_constraint = std::string(" --shard=") + shard_expr.c_str();
+    }
+
+    return std::string("info stored_logs --extended --binary") +
+        log_constraint + shard_constraint + "\n";
   }
 };
 
@@ -179,6 +179,35 @@ void ReplicationCheckerSettings::defineSettings(SettingEasyInit& init) {
        nullptr,
        "Logdevice client timeout",
        CLIENT);
+  init("num-checkers",
+       &num_checkers,
+       "1",
+       [](size_t val) {
+         if (val == 0) {
+           throw boost::program_options::error(
+               "--num-checkers must be positive");
+         }
+       },
+       "Number of checker processes the logs of the cluster are split "
+       "between. Each process checks the logs whose ID modulo --num-checkers "
+       "is its --checker-index; metadata logs go with their data logs.",
+       CLIENT);
+  init("checker-index",
+       &checker_index,
+       "0",
+       nullptr,
+       "Which part of the logs this process checks when they are split "
+       "between --num-checkers processes; in [0, --num-checkers).",
+       CLIENT);
+  init("checkpoint-file",
+       &checkpoint_file,
+       "",
+       nullptr,
+       "If set, the IDs of logs checked without errors are appended to this "
+       "file as they finish, and logs already listed in it are skipped. Use "
+       "it to resume an interrupted run; the stats then cover only the logs "
+       "checked since. Use a separate file for each --checker-index.",
+       CLIENT);
 }
 
 }} // namespace facebook::logdevice
@@ -46,6 +46,9 @@ class ReplicationCheckerSettings : public SettingsBundle {
   std::chrono::seconds read_starting_point;
   std::chrono::microseconds max_execution_time;
   std::chrono::seconds client_timeout;
+  size_t num_checkers;
+  size_t checker_index;
+  std::string checkpoint_file;
 
   bool dont_count_bridge_records;
   bool enable_noisy_errors;
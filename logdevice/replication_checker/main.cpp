@@ -6,12 +6,14 @@
  * LICENSE file in the root directory of this source tree.
  */
 #include <signal.h>
+#include <fstream>
 #include <unordered_map>
 #include <unordered_set>
 
 #include <boost/program_options.hpp>
 #include <boost/tokenizer.hpp>
 #include <folly/Bits.h>
+#include <folly/Conv.h>
 #include <folly/Random.h>
 #include <folly/Range.h>
 #include <folly/Singleton.h>
@@ -98,6 +100,8 @@ std::vector<LogCheckRequest> logs_to_check;
 
 std::chrono::steady_clock::time_point start_time;
 size_t logs_to_check_initial_count;
+// Appended to by onLogDone() if --checkpoint-file is set. Guarded by `mutex`.
+std::ofstream checkpoint_out;
 
 class PerWorkerCoordinatorRequest;
 std::vector<std::unique_ptr<PerWorkerCoordinatorRequest>> worker_coordinators;
@@ -1493,6 +1497,9 @@ class PerWorkerCoordinatorRequest : public Request {
              "error: log %lu failed: %s",
              rq.log_id.val_,
              c->getError().c_str());
+    } else if (checkpoint_out.is_open()) {
+      std::lock_guard<std::mutex> lock(mutex);
+      checkpoint_out << rq.log_id.val_ << std::endl;
     }
     auto st = c->getStats();
     folly::dynamic d = folly::dynamic::object();
@@ -1881,6 +1888,11 @@ int main(int argc, const char** argv) {
     std::cerr << "--num-logs-to-check and --logs are incompatible" << std::endl;
     exit(2);
   }
+  if (checker_settings->checker_index >= checker_settings->num_checkers) {
+    std::cerr << "--checker-index must be less than --num-checkers"
+              << std::endl;
+    exit(2);
+  }
   errors_to_ignore = checker_settings->dont_fail_on_errors;
   if (!checker_settings->enable_noisy_errors) {
     const RecordLevelError noisy_errors =
@@ -1908,11 +1920,40 @@ int main(int argc, const char** argv) {
   auto logs_config = cfg->localLogsConfig();
   std::set<logid_t> logids_to_check_set(
       logids_to_check.begin(), logids_to_check.end());
+  std::set<logid_t> logids_already_checked;
+  if (!checker_settings->checkpoint_file.empty()) {
+    std::ifstream checkpoint_in(checker_settings->checkpoint_file);
+    std::string line;
+    while (std::getline(checkpoint_in, line)) {
+      auto log_id = folly::tryTo<logid_t::raw_type>(line);
+      if (log_id.hasValue()) {
+        logids_already_checked.insert(logid_t(log_id.value()));
+      }
+    }
+    checkpoint_out.open(checker_settings->checkpoint_file, std::ios::app);
+    if (!checkpoint_out.is_open()) {
+      ld_error("Could not open checkpoint file %s: %s",
+               checker_settings->checkpoint_file.c_str(),
+               strerror(errno));
+      return 1;
+    }
+    ld_info("%lu logs were already checked according to %s",
+            logids_already_checked.size(),
+            checker_settings->checkpoint_file.c_str());
+  }
   for (auto it = logs_config->logsBegin(); it != logs_config->logsEnd(); ++it) {
+    if (it->first % checker_settings->num_checkers !=
+        checker_settings->checker_index) {
+      // Checked by another process.
+      continue;
+    }
     auto add_log = [&](logid_t log_id, size_t replication_factor) {
       if (!logids_to_check_set.empty() && !logids_to_check_set.count(log_id)) {
         return;
       }
+      if (logids_already_checked.count(log_id)) {
+        return;
+      }
       logs_to_check.push_back({
           log_id,
           replication_factor,
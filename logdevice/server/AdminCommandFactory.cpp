@@ -31,8 +31,10 @@
 #include "logdevice/server/admincommands/InfoEventLog.h"
 #include "logdevice/server/admincommands/InfoGossip.h"
 #include "logdevice/server/admincommands/InfoIterators.h"
+#include "logdevice/server/admincommands/InfoLogHeavyHitters.h"
 #include "logdevice/server/admincommands/InfoLogsConfigRsm.h"
 #include "logdevice/server/admincommands/InfoLogsDBMetadata.h"
+#include "logdevice/server/admincommands/InfoMemory.h"
 #include "logdevice/server/admincommands/InfoPartitions.h"
 #include "logdevice/server/admincommands/InfoPurges.h"
 #include "logdevice/server/admincommands/InfoReaders.h"
@@ -46,6 +48,7 @@
 #include "logdevice/server/admincommands/InfoSettings.h"
 #include "logdevice/server/admincommands/InfoShards.h"
 #include "logdevice/server/admincommands/InfoSockets.h"
+#include "logdevice/server/admincommands/InfoStalls.h"
 #include "logdevice/server/admincommands/InfoStorageTasks.h"
 #include "logdevice/server/admincommands/InfoStoredLogs.h"
 #include "logdevice/server/admincommands/InfoSyncSequencerRequests.h"
@@ -90,6 +93,7 @@ AdminCommandFactory::AdminCommandFactory() {
   selector_.add<commands::InfoGossip>("info gossip");
   selector_.add<commands::InfoSST>("info sst");
   selector_.add<commands::InfoSockets>("info sockets");
+  selector_.add<commands::InfoStalls>("info stalls");
   selector_.add<commands::InfoConfig>("info config");
   selector_.add<commands::InfoSequencers>("info sequencers");
   selector_.add<commands::InfoReaders>("info readers");
@@ -107,12 +111,14 @@ AdminCommandFactory::AdminCommandFactory() {
   selector_.add<commands::ListOrEraseMetadata>("delete metadata",
                                                /* erase */ true);
   selector_.add<commands::InfoIterators>("info iterators");
+  selector_.add<commands::InfoMemory>("info memory");
   selector_.add<commands::InfoShards>("info shards");
   selector_.add<commands::InfoSettings>("info settings");
   selector_.add<commands::InfoRecordCache>("info record_cache");
   selector_.add<commands::InfoStorageTasks>("info storage_tasks");
   selector_.add<commands::InfoStoredLogs>("info stored_logs");
   selector_.add<commands::InfoReplication>("info replication");
+  selector_.add<commands::InfoLogHeavyHitters>("info log_heavy_hitters");
 
   // Admin command for querying the state of rebuilding.
   selector_.add<commands::InfoRebuildings>("info rebuildings");
@@ -147,6 +153,7 @@ AdminCommandFactory::AdminCommandFactory() {
 #ifdef LOGDEVICE_USING_JEMALLOC
   selector_.add<commands::StatsJemalloc>("stats jemalloc");
   selector_.add<commands::StatsJemallocFull>("stats jemalloc full");
+  selector_.add<commands::StatsJemallocArenas>("stats jemalloc arenas");
   selector_.add<commands::StatsJemallocProfActive>(
       "stats jemalloc prof.active");
   selector_.add<commands::StatsJemallocProfDump>("stats jemalloc prof.dump");
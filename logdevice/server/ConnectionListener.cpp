@@ -7,20 +7,32 @@
  */
 #include "ConnectionListener.h"
 
+#include <cstddef>
+#include <cstring>
 #include <memory>
 #include <netdb.h>
 #include <pthread.h>
 #include <string>
 
+#include <openssl/err.h>
+#include <openssl/ssl.h>
 #include <sys/socket.h>
 
+#ifndef SO_INCOMING_CPU
+#define SO_INCOMING_CPU 49 // from asm-generic/socket.h, Linux 3.19+
+#endif
+
 #include "event2/listener.h"
 #include "event2/util.h"
 #include "logdevice/common/ClientID.h"
 #include "logdevice/common/Request.h"
 #include "logdevice/common/Sockaddr.h"
+#include "logdevice/common/Worker.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/libevent/compat.h"
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/HELLO_Message.h"
+#include "logdevice/common/protocol/ProtocolHeader.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/include/Err.h"
 #include "logdevice/server/FailureDetector.h"
@@ -32,11 +44,30 @@ namespace facebook { namespace logdevice {
 ConnectionListener::ConnectionListener(
     Listener::InterfaceDef iface,
     std::shared_ptr<SharedState> shared_state,
-    ListenerType listener_type)
-    : Listener(std::move(iface), listenerTypeNames()[listener_type]),
+    ListenerType listener_type,
+    int group,
+    int num_groups)
+    : Listener(std::move(iface),
+               listenerTypeNames()[listener_type],
+               /* reuse_port */ num_groups > 1),
       shared_state_(shared_state),
-      listener_type_(listener_type) {
+      listener_type_(listener_type),
+      group_(group),
+      num_groups_(num_groups) {
   ld_check(shared_state);
+  ld_check(group >= 0 && group < num_groups);
+}
+
+ConnectionListener::~ConnectionListener() {
+  for (auto& it : pending_hello_) {
+    LD_EV(event_free)(it.second->ev);
+    LD_EV(evutil_closesocket)(it.first);
+  }
+  for (auto& it : pending_ssl_handshake_) {
+    LD_EV(event_free)(it.second->ev);
+    it.second->ssl.reset();
+    LD_EV(evutil_closesocket)(it.first);
+  }
 }
 
 const SimpleEnumMap<ConnectionListener::ListenerType, std::string>&
@@ -57,10 +88,11 @@ void ConnectionListener::acceptCallback(evutil_socket_t sock,
   ld_check(processor_ != nullptr);
   ServerProcessor* processor = checked_downcast<ServerProcessor*>(processor_);
   Sockaddr sockaddr(addr, len);
+  STAT_INCR(processor->stats_, connections_accepted);
 
-  // Check if accepting this connection pushed us over the limit.  Since there's
-  // only one ConnectionListener thread, and this is called soon after accept(),
-  // we're able to react promptly in case there's a burst of new connections.
+  // Check if accepting this connection pushed us over the limit. This is
+  // called soon after accept() on each listener thread, so we're able to
+  // react promptly in case there's a burst of new connections.
   auto token = processor->conn_budget_incoming_.acquireToken();
   if (!token) {
     STAT_INCR(processor->stats_, dropped_connection_limit);
@@ -95,22 +127,78 @@ void ConnectionListener::acceptCallback(evutil_socket_t sock,
     target_worker_type = WorkerType::FAILURE_DETECTOR;
   } else {
     sock_type = SocketType::DATA;
+    auto settings = processor->settings();
+    if (!settings->worker_cpus.empty()) {
+      // Hand the connection to a worker pinned to the CPU that processed its
+      // packets, so that it's served where the NIC delivers its interrupts.
+      int cpu;
+      socklen_t optlen = sizeof(cpu);
+      if (getsockopt(sock, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &optlen) == 0) {
+        wid = Worker::getGeneralWorkerForCpu(
+            *settings,
+            cpu,
+            processor->getWorkerCount(WorkerType::GENERAL));
+      }
+    }
+    if (wid == worker_id_t(-1)) {
+      wid = pickGroupWorker();
+    }
+    if (isSSL() && settings->ssl_handshake_threads > 0) {
+      startSSLHandshake(std::unique_ptr<PendingConnection>(
+          new PendingConnection{sock,
+                                wid,
+                                sockaddr,
+                                std::move(token),
+                                std::move(conn_backlog_token),
+                                nullptr}));
+      return;
+    }
+    if (!isSSL() && processor->getWorkerCount(WorkerType::READ) > 0) {
+      // The HELLO tells whether the connection carries read streams.
+      waitForHello(std::unique_ptr<PendingConnection>(
+          new PendingConnection{sock,
+                                wid,
+                                sockaddr,
+                                std::move(token),
+                                std::move(conn_backlog_token),
+                                nullptr}));
+      return;
+    }
   }
 
+  handOff(sock,
+          wid,
+          sockaddr,
+          std::move(token),
+          std::move(conn_backlog_token),
+          sock_type,
+          target_worker_type);
+}
+
+void ConnectionListener::handOff(evutil_socket_t sock,
+                                 worker_id_t wid,
+                                 const Sockaddr& sockaddr,
+                                 ResourceBudget::Token token,
+                                 ResourceBudget::Token backlog_token,
+                                 SocketType sock_type,
+                                 WorkerType worker_type,
+                                 std::unique_ptr<EstablishedSSL> ssl) {
+  ServerProcessor* processor = checked_downcast<ServerProcessor*>(processor_);
   std::unique_ptr<Request> request = std::make_unique<NewConnectionRequest>(
       sock,
       wid,
       sockaddr,
       std::move(token),
-      std::move(conn_backlog_token),
+      std::move(backlog_token),
       sock_type,
       isSSL() ? ConnectionType::SSL : ConnectionType::PLAIN,
-      target_worker_type);
+      worker_type,
+      std::move(ssl));
 
   int rv;
   STAT_INCR(processor->stats_, num_backlog_connections);
-  // The processor will route gossip request because WorkerType is
-  // WorkerType::FAILURE_DETECTOR in that case
+  // The processor will route the request to a worker of worker_type, e.g.
+  // WorkerType::FAILURE_DETECTOR for gossip connections
   rv = processor->postRequest(request);
 
   if (rv != 0) {
@@ -121,8 +209,224 @@ void ConnectionListener::acceptCallback(evutil_socket_t sock,
              error_description(err));
     LD_EV(evutil_closesocket)(sock);
     // ~NewConnectionRequest() will also destroy the token, thus releasing the
-    // fd from conn_budget_incoming_.
+    // fd from conn_budget_incoming_, and free the SSL connection if any.
+  }
+}
+
+void ConnectionListener::waitForHello(
+    std::unique_ptr<PendingConnection> conn) {
+  PendingConnection* pc = conn.get();
+  const int64_t timeout_ms = processor_->settings()->handshake_timeout.count();
+  struct timeval tv;
+  tv.tv_sec = timeout_ms / 1000;
+  tv.tv_usec = timeout_ms % 1000 * 1000;
+  pc->ev =
+      LD_EV(event_new)(getEventBase(), pc->fd, EV_READ, onHelloReadable, this);
+  if (!pc->ev || LD_EV(event_add)(pc->ev, &tv) != 0) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    1,
+                    "Failed to wait for the HELLO of a connection from %s, "
+                    "handing it to a general worker",
+                    pc->addr.toString().c_str());
+    if (pc->ev) {
+      LD_EV(event_free)(pc->ev);
+    }
+    handOff(pc->fd,
+            pc->wid,
+            pc->addr,
+            std::move(pc->token),
+            std::move(pc->backlog_token),
+            SocketType::DATA,
+            WorkerType::GENERAL);
+    return;
+  }
+  pending_hello_[pc->fd] = std::move(conn);
+  ServerProcessor* processor = checked_downcast<ServerProcessor*>(processor_);
+  STAT_INCR(processor->stats_, num_connections_awaiting_hello);
+}
+
+void ConnectionListener::onHelloReadable(evutil_socket_t fd,
+                                         short what,
+                                         void* arg) {
+  auto self = reinterpret_cast<ConnectionListener*>(arg);
+  auto it = self->pending_hello_.find(fd);
+  ld_check(it != self->pending_hello_.end());
+  std::unique_ptr<PendingConnection> pc = std::move(it->second);
+  self->pending_hello_.erase(it);
+  LD_EV(event_free)(pc->ev);
+  ServerProcessor* processor =
+      checked_downcast<ServerProcessor*>(self->processor_);
+  STAT_DECR(processor->stats_, num_connections_awaiting_hello);
+
+  // The header of a HELLO has no checksum, and the flags are among the first
+  // bytes of HELLO_Header. Peek at them, leaving the HELLO to the worker. If
+  // they aren't all there yet, or this isn't a HELLO, a general worker deals
+  // with the connection: it completes or rejects the handshake.
+  const size_t hdr_size = ProtocolHeader::bytesNeeded(
+      MessageType::HELLO, Compatibility::MIN_PROTOCOL_SUPPORTED);
+  const size_t flags_pos = hdr_size + offsetof(HELLO_Header, flags);
+  char buf[sizeof(ProtocolHeader) + sizeof(HELLO_Header)];
+  WorkerType worker_type = WorkerType::GENERAL;
+  if (what & EV_READ) {
+    const size_t want = flags_pos + sizeof(HELLO_flags_t);
+    ssize_t nread = recv(fd, buf, want, MSG_PEEK | MSG_DONTWAIT);
+    const char type = buf[offsetof(ProtocolHeader, type)];
+    if (nread == static_cast<ssize_t>(want) &&
+        type == static_cast<char>(MessageType::HELLO)) {
+      HELLO_flags_t flags;
+      std::memcpy(&flags, buf + flags_pos, sizeof(flags));
+      if (flags & HELLO_Header::READ_STREAMS) {
+        worker_type = WorkerType::READ;
+      }
+    }
+  }
+
+  worker_id_t wid = pc->wid;
+  if (worker_type == WorkerType::READ) {
+    // wid was picked among general workers.
+    wid = worker_id_t(-1);
+    STAT_INCR(processor->stats_, read_stream_connections_accepted);
+  }
+  self->handOff(fd,
+                wid,
+                pc->addr,
+                std::move(pc->token),
+                std::move(pc->backlog_token),
+                SocketType::DATA,
+                worker_type);
+}
+
+void ConnectionListener::startSSLHandshake(
+    std::unique_ptr<PendingConnection> conn) {
+  auto settings = processor_->settings();
+  if (!ssl_fetcher_) {
+    ssl_fetcher_ =
+        std::make_unique<SSLFetcher>(settings->ssl_cert_path,
+                                     settings->ssl_key_path,
+                                     settings->ssl_ca_path,
+                                     settings->ssl_cert_refresh_interval,
+                                     settings->ssl_session_resumption,
+                                     settings->ssl_session_ticket_key_path);
+  }
+  // Same context as the workers would use, see
+  // SocketDependencies::getSSLContext().
+  std::shared_ptr<folly::SSLContext> context =
+      ssl_fetcher_->getSSLContext(/* loadCert */ true,
+                                  /* ssl_accepting */ true,
+                                  /* null_ciphers_only */ false);
+  SSL* ssl = context ? context->createSSL() : nullptr;
+  if (!ssl) {
+    failSSLHandshake(std::move(conn), "couldn't create an SSL object");
+    return;
+  }
+  // The socket BIO doesn't close the fd when freed.
+  SSL_set_fd(ssl, conn->fd);
+  SSL_set_accept_state(ssl);
+#ifdef SSL_OP_ENABLE_KTLS
+  if (settings->ssl_enable_ktls) {
+    SSL_set_options(ssl, SSL_OP_ENABLE_KTLS);
+  }
+#endif
+  conn->ssl.reset(
+      new EstablishedSSL{std::move(context), folly::ssl::SSLUniquePtr(ssl)});
+  conn->deadline =
+      std::chrono::steady_clock::now() + settings->handshake_timeout;
+  continueSSLHandshake(std::move(conn));
+}
+
+void ConnectionListener::continueSSLHandshake(
+    std::unique_ptr<PendingConnection> conn) {
+  PendingConnection* pc = conn.get();
+  SSL* ssl = pc->ssl->ssl.get();
+  ERR_clear_error();
+  const int rv = SSL_do_handshake(ssl);
+  if (rv == 1) {
+    ServerProcessor* processor = checked_downcast<ServerProcessor*>(processor_);
+    STAT_INCR(processor->stats_, ssl_listener_handshakes);
+    handOff(pc->fd,
+            pc->wid,
+            pc->addr,
+            std::move(pc->token),
+            std::move(pc->backlog_token),
+            SocketType::DATA,
+            WorkerType::GENERAL,
+            std::move(pc->ssl));
+    return;
+  }
+
+  short what;
+  switch (SSL_get_error(ssl, rv)) {
+    case SSL_ERROR_WANT_READ:
+      what = EV_READ;
+      break;
+    case SSL_ERROR_WANT_WRITE:
+      what = EV_WRITE;
+      break;
+    default:
+      failSSLHandshake(std::move(conn), "failed");
+      return;
+  }
+  const auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(
+      pc->deadline - std::chrono::steady_clock::now());
+  if (remaining.count() <= 0) {
+    failSSLHandshake(std::move(conn), "timed out");
+    return;
+  }
+  struct timeval tv;
+  tv.tv_sec = remaining.count() / 1000000;
+  tv.tv_usec = remaining.count() % 1000000;
+  pc->ev = LD_EV(event_new)(
+      getEventBase(), pc->fd, what, onSSLHandshakeEvent, this);
+  if (!pc->ev || LD_EV(event_add)(pc->ev, &tv) != 0) {
+    if (pc->ev) {
+      LD_EV(event_free)(pc->ev);
+    }
+    failSSLHandshake(std::move(conn), "couldn't wait for the socket");
+    return;
+  }
+  pending_ssl_handshake_[pc->fd] = std::move(conn);
+}
+
+void ConnectionListener::failSSLHandshake(
+    std::unique_ptr<PendingConnection> conn,
+    const char* reason) {
+  ServerProcessor* processor = checked_downcast<ServerProcessor*>(processor_);
+  STAT_INCR(processor->stats_, ssl_listener_handshake_failures);
+  RATELIMIT_INFO(std::chrono::seconds(10),
+                 1,
+                 "SSL handshake with %s %s, closing the connection",
+                 conn->addr.toString().c_str(),
+                 reason);
+  conn->ssl.reset();
+  LD_EV(evutil_closesocket)(conn->fd);
+}
+
+void ConnectionListener::onSSLHandshakeEvent(evutil_socket_t fd,
+                                             short /*what*/,
+                                             void* arg) {
+  auto self = reinterpret_cast<ConnectionListener*>(arg);
+  auto it = self->pending_ssl_handshake_.find(fd);
+  ld_check(it != self->pending_ssl_handshake_.end());
+  std::unique_ptr<PendingConnection> pc = std::move(it->second);
+  self->pending_ssl_handshake_.erase(it);
+  LD_EV(event_free)(pc->ev);
+  pc->ev = nullptr;
+  // After a timeout the handshake can't progress and the deadline has
+  // passed, so this closes the connection.
+  self->continueSSLHandshake(std::move(pc));
+}
+
+worker_id_t ConnectionListener::pickGroupWorker() {
+  if (num_groups_ <= 1) {
+    return worker_id_t(-1);
+  }
+  const int nworkers = processor_->getWorkerCount(WorkerType::GENERAL);
+  const int group_size = (nworkers - group_ + num_groups_ - 1) / num_groups_;
+  if (group_size <= 0) {
+    return worker_id_t(-1);
   }
+  return worker_id_t(group_ +
+                     num_groups_ * int(next_group_worker_++ % group_size));
 }
 
 }} // namespace facebook::logdevice
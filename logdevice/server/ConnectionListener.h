@@ -7,13 +7,21 @@
  */
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <vector>
 
 #include "event2/event.h"
 #include "event2/listener.h"
+#include <memory>
+#include <unordered_map>
+
 #include "logdevice/common/Processor.h"
+#include "logdevice/common/ResourceBudget.h"
+#include "logdevice/common/SSLFetcher.h"
 #include "logdevice/common/SimpleEnumMap.h"
+#include "logdevice/common/Sockaddr.h"
+#include "logdevice/common/Socket.h"
 #include "logdevice/common/WorkerType.h"
 #include "logdevice/server/Listener.h"
 
@@ -42,9 +50,20 @@ class ConnectionListener : public Listener {
 
   static const SimpleEnumMap<ListenerType, std::string>& listenerTypeNames();
 
+  /**
+   * With --num-connection-listeners > 1, the DATA port is served by that
+   * many ConnectionListeners bound with SO_REUSEPORT. Listener `group` of
+   * `num_groups` then hands its connections to the general workers whose
+   * index is `group` modulo `num_groups`, unless --worker-cpus picks the
+   * worker.
+   */
   explicit ConnectionListener(Listener::InterfaceDef iface,
                               std::shared_ptr<SharedState> shared_state,
-                              ListenerType listener_type);
+                              ListenerType listener_type,
+                              int group = 0,
+                              int num_groups = 1);
+
+  ~ConnectionListener() override;
 
   void setProcessor(Processor* processor) {
     processor_ = processor;
@@ -60,10 +79,90 @@ class ConnectionListener : public Listener {
                       int len) override;
 
  private:
+  // An accepted connection waiting for its HELLO, see waitForHello(), or
+  // for its SSL handshake, see startSSLHandshake().
+  struct PendingConnection {
+    evutil_socket_t fd;
+    worker_id_t wid;
+    Sockaddr addr;
+    ResourceBudget::Token token;
+    ResourceBudget::Token backlog_token;
+    struct event* ev;
+    // Only for SSL handshakes.
+    std::unique_ptr<EstablishedSSL> ssl;
+    std::chrono::steady_clock::time_point deadline;
+  };
+
+  /**
+   * Posts a NewConnectionRequest handing the connection off to a worker of
+   * the given type, or closes the connection if that fails.
+   */
+  void handOff(evutil_socket_t sock,
+               worker_id_t wid,
+               const Sockaddr& sockaddr,
+               ResourceBudget::Token token,
+               ResourceBudget::Token backlog_token,
+               SocketType sock_type,
+               WorkerType worker_type,
+               std::unique_ptr<EstablishedSSL> established_ssl = nullptr);
+
+  /**
+   * When the node has READ workers, plaintext DATA connections are only
+   * handed off once their HELLO arrives, or after --handshake-timeout. The
+   * listener peeks at the fixed-size part of the HELLO without consuming it;
+   * connections with the READ_STREAMS flag go to a READ worker, all others
+   * to a GENERAL one.
+   */
+  void waitForHello(std::unique_ptr<PendingConnection> conn);
+
+  // Called by libevent when a pending connection is readable or timed out.
+  static void onHelloReadable(evutil_socket_t fd, short what, void* arg);
+
+  /**
+   * With --ssl-handshake-threads, SSL connections are handed off once this
+   * listener has completed their handshake, so that workers don't spend
+   * CPU time on full handshakes during mass reconnects. Connections whose
+   * handshake fails or takes longer than --handshake-timeout are closed.
+   */
+  void startSSLHandshake(std::unique_ptr<PendingConnection> conn);
+
+  // Makes progress on the handshake, and either hands the connection off,
+  // closes it, or waits for the socket to be ready again.
+  void continueSSLHandshake(std::unique_ptr<PendingConnection> conn);
+
+  void failSSLHandshake(std::unique_ptr<PendingConnection> conn,
+                        const char* reason);
+
+  // Called by libevent when a connection in the middle of its SSL handshake
+  // is ready or timed out.
+  static void onSSLHandshakeEvent(evutil_socket_t fd, short what, void* arg);
+
+  // Round-robins over the general workers of this listener's group. Returns
+  // -1, which lets the Processor pick, if there is a single group or the
+  // group has no workers.
+  worker_id_t pickGroupWorker();
+
   // Pointer to Processor to hand connections off to. Unowned.
   Processor* processor_ = nullptr;
   std::shared_ptr<SharedState> shared_state_;
   ListenerType listener_type_;
+
+  // See the constructor.
+  const int group_;
+  const int num_groups_;
+  // Used by pickGroupWorker(). Only accessed on this listener's thread.
+  uint64_t next_group_worker_{0};
+
+  // Connections waiting for their HELLO, by fd.
+  std::unordered_map<evutil_socket_t, std::unique_ptr<PendingConnection>>
+      pending_hello_;
+
+  // Connections in the middle of their SSL handshake, by fd.
+  std::unordered_map<evutil_socket_t, std::unique_ptr<PendingConnection>>
+      pending_ssl_handshake_;
+
+  // Created on the first SSL handshake this listener does.
+  std::unique_ptr<SSLFetcher> ssl_fetcher_;
 };
 
 }} // namespace facebook::logdevice
@@ -40,21 +40,26 @@ static void send_reply(const Address& to,
   Worker::onThisThread()->sender().sendMessage(std::move(msg), to);
 }
 
-Message::Disposition DATA_SIZE_onReceived(DATA_SIZE_Message* msg,
-                                          const Address& from) {
-  const DATA_SIZE_Header& header = msg->getHeader();
-
+/**
+ * Validates a DATA_SIZE request and either replies to it right away or returns
+ * the store to compute the data size from.
+ *
+ * @return the store of header.shard, or nullptr if the request was already
+ *         handled.
+ */
+static PartitionedRocksDBStore* prepareDataSize(const DATA_SIZE_Header& header,
+                                                const Address& from) {
   if (header.log_id == LOGID_INVALID) {
     ld_error("got DATA_SIZE message from %s with invalid log ID, ignoring",
              Sender::describeConnection(from).c_str());
-    return Message::Disposition::NORMAL;
+    return nullptr;
   }
 
   ServerWorker* worker = ServerWorker::onThisThread();
   if (!worker->isAcceptingWork()) {
     ld_debug("Ignoring DATA_SIZE message: not accepting more work");
     send_reply(from, header, E::SHUTDOWN, 0);
-    return Message::Disposition::NORMAL;
+    return nullptr;
   }
 
   WORKER_LOG_STAT_INCR(header.log_id, data_size_received);
@@ -62,7 +67,7 @@ Message::Disposition DATA_SIZE_onReceived(DATA_SIZE_Message* msg,
   ServerProcessor* processor = worker->processor_;
   if (!processor->runningOnStorageNode()) {
     send_reply(from, header, E::NOTSTORAGE, 0);
-    return Message::Disposition::NORMAL;
+    return nullptr;
   }
 
   auto scfg = worker->getServerConfig();
@@ -76,19 +81,19 @@ Message::Disposition DATA_SIZE_onReceived(DATA_SIZE_Message* msg,
                     Sender::describeConnection(from).c_str(),
                     shard_idx,
                     n_shards);
-    return Message::Disposition::NORMAL;
+    return nullptr;
   }
 
   if (processor->isDataMissingFromShard(shard_idx)) {
     send_reply(from, header, E::REBUILDING, 0);
-    return Message::Disposition::NORMAL;
+    return nullptr;
   }
 
   LogStorageStateMap& map = processor->getLogStorageStateMap();
   LogStorageState* log_state = map.insertOrGet(header.log_id, shard_idx);
   if (log_state == nullptr || log_state->hasPermanentError()) {
     send_reply(from, header, E::FAILED, 0);
-    return Message::Disposition::NORMAL;
+    return nullptr;
   }
 
   ShardedStorageThreadPool* sstp = processor->sharded_storage_thread_pool_;
@@ -98,6 +103,7 @@ Message::Disposition DATA_SIZE_onReceived(DATA_SIZE_Message* msg,
   if (!partitioned_store) {
     // Only supported on partitioned, rocksdb-based stores
     send_reply(from, header, E::NOTSUPPORTED, 0);
+    return nullptr;
   }
 
   ld_debug("DATA_SIZE: log %lu in range [%lu,%lu]",
@@ -112,17 +118,77 @@ Message::Disposition DATA_SIZE_onReceived(DATA_SIZE_Message* msg,
                     "reporting transient rebuilding state",
                     header.log_id.val_);
     send_reply(from, header, E::REBUILDING, 0);
+    return nullptr;
+  }
+
+  return partitioned_store;
+}
+
+Message::Disposition DATA_SIZE_onReceived(DATA_SIZE_Message* msg,
+                                          const Address& from) {
+  const DATA_SIZE_Header& header = msg->getHeader();
+  PartitionedRocksDBStore* store = prepareDataSize(header, from);
+  if (store == nullptr) {
     return Message::Disposition::NORMAL;
   }
 
   size_t size = 0;
-  int rv = partitioned_store->dataSize(
-      header.log_id,
-      std::chrono::milliseconds(header.lo_timestamp_ms),
-      std::chrono::milliseconds(header.hi_timestamp_ms),
-      &size);
+  int rv = store->dataSize(header.log_id,
+                           std::chrono::milliseconds(header.lo_timestamp_ms),
+                           std::chrono::milliseconds(header.hi_timestamp_ms),
+                           &size);
   send_reply(from, header, rv == 0 ? E::OK : E::FAILED, size);
   return Message::Disposition::NORMAL;
 }
 
+Message::Disposition DATA_SIZE_BATCH_onReceived(DATA_SIZE_BATCH_Message* msg,
+                                                const Address& from) {
+  for (const DATA_SIZE_Header& entry : msg->entries_) {
+    if (entry.shard != msg->shard_) {
+      RATELIMIT_ERROR(std::chrono::seconds(10),
+                      10,
+                      "Got malformed DATA_SIZE_BATCH message from %s: entry "
+                      "for log %lu has shard %u, batch shard is %u",
+                      Sender::describeConnection(from).c_str(),
+                      entry.log_id.val_,
+                      entry.shard,
+                      msg->shard_);
+      err = E::BADMSG;
+      return Message::Disposition::ERROR;
+    }
+  }
+
+  WORKER_STAT_INCR(log_query_batches_received);
+
+  // Entries that pass validation are answered from a single snapshot of the
+  // shard's partition list.
+  PartitionedRocksDBStore* store = nullptr;
+  std::vector<const DATA_SIZE_Header*> entries;
+  std::vector<PartitionedRocksDBStore::DataSizeRange> ranges;
+  for (const DATA_SIZE_Header& entry : msg->entries_) {
+    PartitionedRocksDBStore* entry_store = prepareDataSize(entry, from);
+    if (entry_store == nullptr) {
+      continue;
+    }
+    ld_check(store == nullptr || store == entry_store);
+    store = entry_store;
+    entries.push_back(&entry);
+    ranges.push_back(
+        {entry.log_id,
+         RecordTimestamp(std::chrono::milliseconds(entry.lo_timestamp_ms)),
+         RecordTimestamp(std::chrono::milliseconds(entry.hi_timestamp_ms))});
+  }
+  if (entries.empty()) {
+    return Message::Disposition::NORMAL;
+  }
+
+  std::vector<size_t> sizes;
+  store->dataSize(ranges, &sizes);
+  ld_check(sizes.size() == entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    send_reply(from, *entries[i], E::OK, sizes[i]);
+  }
+  return Message::Disposition::NORMAL;
+}
+
 }} // namespace facebook::logdevice
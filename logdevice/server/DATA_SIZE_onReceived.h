@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include "logdevice/common/protocol/DATA_SIZE_BATCH_Message.h"
 #include "logdevice/common/protocol/DATA_SIZE_Message.h"
 #include "logdevice/common/protocol/Message.h"
 
@@ -16,4 +17,7 @@ struct Address;
 
 Message::Disposition DATA_SIZE_onReceived(DATA_SIZE_Message* msg,
                                           const Address& from);
+
+Message::Disposition DATA_SIZE_BATCH_onReceived(DATA_SIZE_BATCH_Message* msg,
+                                                const Address& from);
 }} // namespace facebook::logdevice
@@ -15,6 +15,7 @@
 
 #include "logdevice/common/AdminCommandTable.h"
 #include "logdevice/common/Digest.h"
+#include "logdevice/common/JemallocArenas.h"
 #include "logdevice/common/LocalLogStoreRecordFormat.h"
 #include "logdevice/common/RecordID.h"
 #include "logdevice/common/debug.h"
@@ -269,7 +270,9 @@ int EpochRecordCache::putRecord(
 
   // it is likely that the record will be stored in cache, pre-allocate
   // its entry
-  auto entry = EpochRecordCacheEntry::create<EpochRecordCacheEntry>(
+  AllocationTagScope tag_scope(AllocationTag::RECORD_CACHE);
+  auto entry = EpochRecordCacheEntry::createInArena<EpochRecordCacheEntry>(
+      deps_->getCacheEntryArena(payload_holder.get()),
       EpochRecordCacheEntry::Disposer(deps_),
       rid.lsn(),
       flags,
@@ -630,11 +633,14 @@ EpochRecordCache::createSnapshotImpl(Snapshot::SnapshotType type,
     }
     const size_t start_idx = std::max(head, esn_start.val_) - head;
     const size_t until_idx = std::min(max_seen, esn_end.val_) - head;
+    snapshot->entry_map_.reserve(
+        std::min(buffer_entries_.load(), until_idx - start_idx + 1));
+    // entries are added in order of esn, keeping entry_map_ sorted
     for (size_t i = start_idx; i <= until_idx; ++i) {
       auto& e = buffer_[i];
       if (e != nullptr) {
         ld_check(!e->isLinked());
-        snapshot->entry_map_[esn_t(head + i)] = e;
+        snapshot->entry_map_.emplace_back(esn_t(head + i), e);
       }
     }
   }
@@ -759,7 +765,8 @@ EpochRecordCache::Snapshot::createFromLinearBuffer(
     ld_check(entry_size > 0);
 
     cumulative_size += entry_size;
-    snapshot->entry_map_[esn_t(esn_raw)] = std::move(entry);
+    // esns were checked to be increasing, entry_map_ stays sorted
+    snapshot->entry_map_.emplace_back(esn_t(esn_raw), std::move(entry));
   }
   if (result_size != nullptr) {
     *result_size = cumulative_size;
@@ -951,8 +958,12 @@ ssize_t EpochRecordCache::Snapshot::toLinearBuffer(char* buffer,
 
 std::pair<bool, EpochRecordCache::Snapshot::Record>
 EpochRecordCache::Snapshot::getRecord(esn_t esn) const {
-  auto it = entry_map_.find(esn);
-  if (it == entry_map_.end()) {
+  auto it = std::lower_bound(
+      entry_map_.begin(),
+      entry_map_.end(),
+      esn,
+      [](const InternalMap::value_type& kv, esn_t e) { return kv.first < e; });
+  if (it == entry_map_.end() || it->first != esn) {
     return std::make_pair(false, Record());
   }
 
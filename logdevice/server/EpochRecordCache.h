@@ -13,6 +13,7 @@
 #include <map>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include <folly/SharedMutex.h>
 
@@ -228,6 +229,10 @@ class EpochRecordCache {
    */
   void disableCache();
 
+  bool isDisabled() const {
+    return disabled_.load();
+  }
+
   //// functions for reading the cache
 
   /**
@@ -321,7 +326,11 @@ class EpochRecordCache {
     explicit Snapshot(const EpochRecordCacheSerializer::CacheHeader& header,
                       const TailRecord& TailRecord);
 
-    using InternalMap = std::map<esn_t, std::shared_ptr<EpochRecordCacheEntry>>;
+    // Entries sorted by esn. A flat vector rather than a map, so that
+    // creating a snapshot takes one allocation and reading it sequentially
+    // goes through contiguous memory.
+    using InternalMap =
+        std::vector<std::pair<esn_t, std::shared_ptr<EpochRecordCacheEntry>>>;
 
     const esn_t start_;
     const esn_t until_;
@@ -22,6 +22,11 @@ namespace facebook { namespace logdevice {
 
 using namespace EpochRecordCacheSerializer;
 
+// Entries are placed in the arenas of ZeroCopiedRecordDisposal, whose slots
+// fit a ZeroCopiedRecord.
+static_assert(sizeof(EpochRecordCacheEntry) <= sizeof(ZeroCopiedRecord),
+              "EpochRecordCacheEntry must not add members");
+
 EpochRecordCacheEntry::EpochRecordCacheEntry() : ZeroCopiedRecord() {}
 
 EpochRecordCacheEntry::EpochRecordCacheEntry(
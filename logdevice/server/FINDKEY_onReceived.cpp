@@ -10,6 +10,7 @@
 #include "logdevice/common/FindKeyTracer.h"
 #include "logdevice/common/Sender.h"
 #include "logdevice/common/configuration/Configuration.h"
+#include "logdevice/common/protocol/FINDKEY_BATCH_Message.h"
 #include "logdevice/common/protocol/FINDKEY_REPLY_Message.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/server/FindKeyStorageTask.h"
@@ -49,79 +50,81 @@ static void send_error(const Address& to,
  * PartitionedRocksDBStore local storage.
  * @return        true if non blocking operation succeed and false otherwise
  */
-static bool runNonBlockingFindKey(const FINDKEY_Message& msg,
+static bool runNonBlockingFindKey(const FINDKEY_Header& header,
+                                  const folly::Optional<std::string>& key,
                                   lsn_t trim_point,
                                   lsn_t last_per_epoch_released_lsn,
                                   const Address& from,
                                   shard_index_t shard_idx,
                                   FindKeyTracer tracer);
 
-Message::Disposition FINDKEY_onReceived(FINDKEY_Message* msg,
-                                        const Address& from) {
+/**
+ * Validates a FINDKEY request and either replies to it right away or returns
+ * the storage task that needs to run to answer it.
+ *
+ * @return the task to put on the storage task queue of header.shard, or
+ *         nullptr if the request was already handled.
+ */
+static std::unique_ptr<FindKeyStorageTask>
+prepareFindKey(const FINDKEY_Header& header,
+               folly::Optional<std::string> key,
+               const Address& from) {
   ServerWorker* worker = ServerWorker::onThisThread();
   FindKeyTracer tracer(
-      worker->getTraceLogger(), Sender::sockaddrOrInvalid(from), msg->header_);
+      worker->getTraceLogger(), Sender::sockaddrOrInvalid(from), header);
 
   std::chrono::milliseconds timestamp;
-  timestamp = std::chrono::milliseconds(msg->header_.timestamp);
+  timestamp = std::chrono::milliseconds(header.timestamp);
   tracer.setTimestamp(timestamp);
-  tracer.setKey(msg->key_.value_or(""));
-
-  if (!from.isClientAddress()) {
-    ld_error("got FINDKEY message from non-client %s",
-             Sender::describeConnection(from).c_str());
-    tracer.trace(E::PROTO, LSN_INVALID, LSN_INVALID);
-    err = E::PROTO;
-    return Message::Disposition::ERROR;
-  }
+  tracer.setKey(key.value_or(""));
 
-  if (msg->header_.log_id == LOGID_INVALID) {
+  if (header.log_id == LOGID_INVALID) {
     ld_error("got FINDKEY message from %s with invalid log ID, "
              "ignoring",
              Sender::describeConnection(from).c_str());
     tracer.trace(E::INVALID_PARAM, LSN_INVALID, LSN_INVALID);
-    return Message::Disposition::NORMAL;
+    return nullptr;
   }
 
   if (!worker->isAcceptingWork()) {
     ld_debug("Ignoring FINDKEY message: not accepting more work");
     send_error(from,
-               msg->header_.client_rqid,
+               header.client_rqid,
                E::SHUTDOWN,
-               msg->header_.shard,
+               header.shard,
                tracer);
-    return Message::Disposition::NORMAL;
+    return nullptr;
   }
 
-  WORKER_LOG_STAT_INCR(msg->header_.log_id, findkey_received);
+  WORKER_LOG_STAT_INCR(header.log_id, findkey_received);
 
   ServerProcessor* processor = worker->processor_;
 
   if (!processor->runningOnStorageNode()) {
     send_error(from,
-               msg->header_.client_rqid,
+               header.client_rqid,
                E::NOTSTORAGE,
-               msg->header_.shard,
+               header.shard,
                tracer);
-    return Message::Disposition::NORMAL;
+    return nullptr;
   }
 
   const auto& log_map = Worker::settings().dont_serve_findtimes_logs;
-  if (log_map.find(msg->header_.log_id) != log_map.end()) {
+  if (log_map.find(header.log_id) != log_map.end()) {
     Status status = Worker::settings().dont_serve_findtimes_status;
     RATELIMIT_INFO(
         std::chrono::seconds(10),
         1,
         "Denying findtimes for log %lu based on settings with status %s",
-        msg->header_.log_id.val(),
+        header.log_id.val(),
         error_description(status));
     send_error(
-        from, msg->header_.client_rqid, status, msg->header_.shard, tracer);
-    return Message::Disposition::NORMAL;
+        from, header.client_rqid, status, header.shard, tracer);
+    return nullptr;
   }
 
   auto scfg = worker->getServerConfig();
-  shard_index_t shard_idx = msg->header_.shard;
+  shard_index_t shard_idx = header.shard;
   const shard_size_t n_shards = scfg->getNumShards();
   if (shard_idx >= n_shards) {
     RATELIMIT_ERROR(std::chrono::seconds(10),
@@ -131,22 +134,22 @@ Message::Disposition FINDKEY_onReceived(FINDKEY_Message* msg,
                     Sender::describeConnection(from).c_str(),
                     shard_idx,
                     n_shards);
-    return Message::Disposition::NORMAL;
+    return nullptr;
   }
 
   if (processor->isDataMissingFromShard(shard_idx)) {
     send_error(
-        from, msg->header_.client_rqid, E::REBUILDING, shard_idx, tracer);
-    return Message::Disposition::NORMAL;
+        from, header.client_rqid, E::REBUILDING, shard_idx, tracer);
+    return nullptr;
   }
 
-  auto flags = msg->header_.flags;
+  auto flags = header.flags;
   lsn_t last_per_epoch_released_lsn = LSN_INVALID;
   folly::Optional<lsn_t> trim_point;
 
   if (!(flags & FINDKEY_Header::USER_KEY)) {
     LogStorageState* log_state = processor->getLogStorageStateMap().insertOrGet(
-        msg->header_.log_id, shard_idx);
+        header.log_id, shard_idx);
     if (log_state == nullptr ||        // LogStorageStateMap is at capacity
         log_state->hasPermanentError() // LogStorageState may be stale.
     ) {
@@ -158,8 +161,8 @@ Message::Disposition FINDKEY_onReceived(FINDKEY_Message* msg,
                       Sender::describeConnection(from).c_str(),
                       log_state == nullptr,
                       log_state->hasPermanentError());
-      send_error(from, msg->header_.client_rqid, E::FAILED, shard_idx, tracer);
-      return Message::Disposition::NORMAL;
+      send_error(from, header.client_rqid, E::FAILED, shard_idx, tracer);
+      return nullptr;
     }
 
     // Get last per-epoch released LSN. It may be ahead of the last released
@@ -170,13 +173,13 @@ Message::Disposition FINDKEY_onReceived(FINDKEY_Message* msg,
       // Last per-epoch released LSN or trim point are unknown.  Try to find
       // them...
       processor->getLogStorageStateMap().recoverLogState(
-          msg->header_.log_id,
+          header.log_id,
           shard_idx,
           LogStorageState::RecoverContext::FINDKEY_MESSAGE);
 
       // And in the meantime tell the client to try again in a bit
-      send_error(from, msg->header_.client_rqid, E::AGAIN, shard_idx, tracer);
-      return Message::Disposition::NORMAL;
+      send_error(from, header.client_rqid, E::AGAIN, shard_idx, tracer);
+      return nullptr;
     }
 
     if (timestamp == std::chrono::milliseconds::max()) {
@@ -184,13 +187,13 @@ Message::Disposition FINDKEY_onReceived(FINDKEY_Message* msg,
       // of the last log record; we can avoid binary search here and just return
       // last_per_epoch_released_lsn
       send_reply(from,
-                 msg->header_.client_rqid,
+                 header.client_rqid,
                  E::OK,
                  std::max(last_per_epoch_released_lsn, trim_point.value()),
                  LSN_MAX,
                  shard_idx,
                  tracer);
-      return Message::Disposition::NORMAL;
+      return nullptr;
     }
 
     if (Worker::settings().findtime_force_approximate) {
@@ -204,37 +207,101 @@ Message::Disposition FINDKEY_onReceived(FINDKEY_Message* msg,
   // for findKey().
   lsn_t trim_point_value = trim_point.value_or(LSN_INVALID);
 
-  if (runNonBlockingFindKey(*msg,
+  if (runNonBlockingFindKey(header,
+                            key,
                             trim_point_value,
                             last_per_epoch_released_lsn,
                             from,
                             shard_idx,
                             std::move(tracer))) {
-    return Message::Disposition::NORMAL;
+    return nullptr;
   }
 
-  auto task_deadline = msg->header_.timeout_ms > 0
+  auto task_deadline = header.timeout_ms > 0
       ? std::chrono::steady_clock::now() +
-          std::chrono::milliseconds(msg->header_.timeout_ms)
+          std::chrono::milliseconds(header.timeout_ms)
       : std::chrono::steady_clock::time_point::max();
 
-  worker->getStorageTaskQueueForShard(shard_idx)->putTask(
-      std::make_unique<FindKeyStorageTask>(
-          from.id_.client_,
-          msg->header_.client_rqid,
-          msg->header_.log_id,
-          timestamp,
-          std::move(msg->key_),
-          std::min(last_per_epoch_released_lsn, msg->header_.hint_hi),
-          std::max(trim_point_value, msg->header_.hint_lo),
-          flags,
-          task_deadline,
-          std::move(tracer),
-          Worker::onThisThread()->sender().getSockaddr(from)));
+  return std::make_unique<FindKeyStorageTask>(
+      from.id_.client_,
+      header.client_rqid,
+      header.log_id,
+      timestamp,
+      std::move(key),
+      std::min(last_per_epoch_released_lsn, header.hint_hi),
+      std::max(trim_point_value, header.hint_lo),
+      flags,
+      task_deadline,
+      std::move(tracer),
+      Worker::onThisThread()->sender().getSockaddr(from));
+}
+
+Message::Disposition FINDKEY_onReceived(FINDKEY_Message* msg,
+                                        const Address& from) {
+  if (!from.isClientAddress()) {
+    ld_error("got FINDKEY message from non-client %s",
+             Sender::describeConnection(from).c_str());
+    err = E::PROTO;
+    return Message::Disposition::ERROR;
+  }
+
+  auto task = prepareFindKey(msg->header_, std::move(msg->key_), from);
+  if (task) {
+    ServerWorker::onThisThread()
+        ->getStorageTaskQueueForShard(msg->header_.shard)
+        ->putTask(std::move(task));
+  }
+  return Message::Disposition::NORMAL;
+}
+
+Message::Disposition FINDKEY_BATCH_onReceived(FINDKEY_BATCH_Message* msg,
+                                              const Address& from) {
+  if (!from.isClientAddress()) {
+    ld_error("got FINDKEY_BATCH message from non-client %s",
+             Sender::describeConnection(from).c_str());
+    err = E::PROTO;
+    return Message::Disposition::ERROR;
+  }
+
+  for (const FINDKEY_Header& entry : msg->entries_) {
+    if ((entry.flags & FINDKEY_Header::USER_KEY) ||
+        entry.shard != msg->shard_) {
+      RATELIMIT_ERROR(std::chrono::seconds(10),
+                      10,
+                      "Got malformed FINDKEY_BATCH message from client %s: "
+                      "entry for log %lu has flags %u and shard %u, batch "
+                      "shard is %u",
+                      Sender::describeConnection(from).c_str(),
+                      entry.log_id.val_,
+                      entry.flags,
+                      entry.shard,
+                      msg->shard_);
+      err = E::BADMSG;
+      return Message::Disposition::ERROR;
+    }
+  }
+
+  WORKER_STAT_INCR(findkey_batches_received);
+
+  // Entries that can't be answered right away are executed in a single
+  // storage task instead of one task each.
+  std::vector<std::unique_ptr<FindKeyStorageTask>> tasks;
+  for (const FINDKEY_Header& entry : msg->entries_) {
+    auto task = prepareFindKey(entry, folly::none, from);
+    if (task) {
+      tasks.push_back(std::move(task));
+    }
+  }
+  if (!tasks.empty()) {
+    ServerWorker::onThisThread()
+        ->getStorageTaskQueueForShard(msg->shard_)
+        ->putTask(std::make_unique<FindKeyBatchStorageTask>(std::move(tasks)));
+  }
   return Message::Disposition::NORMAL;
 }
 
-bool runNonBlockingFindKey(const FINDKEY_Message& msg,
+bool runNonBlockingFindKey(const FINDKEY_Header& header,
+                           const folly::Optional<std::string>& key,
                            lsn_t trim_point,
                            lsn_t last_per_epoch_released_lsn,
                            const Address& from,
@@ -247,11 +314,11 @@ bool runNonBlockingFindKey(const FINDKEY_Message& msg,
   LocalLogStore* store = &pool.getLocalLogStore();
   ld_check(store);
 
-  bool approximate = msg.header_.flags & FINDKEY_Header::APPROXIMATE;
+  bool approximate = header.flags & FINDKEY_Header::APPROXIMATE;
 
   if (!Worker::settings().allow_reads_on_workers ||
-      (!msg.key_.hasValue() && !store->supportsNonBlockingFindTime()) ||
-      (msg.key_.hasValue() && !store->supportsNonBlockingFindKey())) {
+      (!key.hasValue() && !store->supportsNonBlockingFindTime()) ||
+      (key.hasValue() && !store->supportsNonBlockingFindKey())) {
     return false;
   }
 
@@ -264,11 +331,11 @@ bool runNonBlockingFindKey(const FINDKEY_Message& msg,
   int rv;
   lsn_t lo;
   lsn_t hi;
-  if (!msg.key_.hasValue()) {
-    std::chrono::milliseconds timestamp(msg.header_.timestamp);
-    lo = std::max(trim_point, msg.header_.hint_lo);
-    hi = std::min(last_per_epoch_released_lsn, msg.header_.hint_hi);
-    rv = store->findTime(msg.header_.log_id,
+  if (!key.hasValue()) {
+    std::chrono::milliseconds timestamp(header.timestamp);
+    lo = std::max(trim_point, header.hint_lo);
+    hi = std::min(last_per_epoch_released_lsn, header.hint_hi);
+    rv = store->findTime(header.log_id,
                          timestamp,
                          &lo,
                          &hi,
@@ -276,8 +343,8 @@ bool runNonBlockingFindKey(const FINDKEY_Message& msg,
                          false /* do not allow blocking io */
     );
   } else {
-    rv = store->findKey(msg.header_.log_id,
-                        msg.key_.value(),
+    rv = store->findKey(header.log_id,
+                        key.value(),
                         &lo,
                         &hi,
                         approximate,
@@ -285,11 +352,11 @@ bool runNonBlockingFindKey(const FINDKEY_Message& msg,
     );
   }
   if (rv == 0) {
-    send_reply(from, msg.header_.client_rqid, E::OK, lo, hi, shard_idx, tracer);
+    send_reply(from, header.client_rqid, E::OK, lo, hi, shard_idx, tracer);
     return true;
   } else {
     if (err == E::FAILED) {
-      send_error(from, msg.header_.client_rqid, E::FAILED, shard_idx, tracer);
+      send_error(from, header.client_rqid, E::FAILED, shard_idx, tracer);
       return true;
     }
   }
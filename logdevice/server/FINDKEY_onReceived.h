@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include "logdevice/common/protocol/FINDKEY_BATCH_Message.h"
 #include "logdevice/common/protocol/FINDKEY_Message.h"
 #include "logdevice/common/protocol/Message.h"
 
@@ -16,4 +17,7 @@ struct Address;
 
 Message::Disposition FINDKEY_onReceived(FINDKEY_Message* msg,
                                         const Address& from);
+
+Message::Disposition FINDKEY_BATCH_onReceived(FINDKEY_BATCH_Message* msg,
+                                              const Address& from);
 }} // namespace facebook::logdevice
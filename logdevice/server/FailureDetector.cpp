@@ -117,6 +117,59 @@ class FailureDetector::RoundRobinSelector
   size_t iters_{0};
 };
 
+class FailureDetector::LocalitySelector
+    : public FailureDetector::NodeSelector {
+ public:
+  NodeID getNode(FailureDetector* detector) override {
+    auto config = detector->getServerConfig();
+    auto& nodes = config->getNodes();
+    const NodeLocationScope scope = detector->settings_->locality_scope;
+    const int interval = detector->settings_->cross_scope_gossip_interval;
+
+    NodeID this_node = config->getMyNodeID();
+    const auto* my_node = config->getNode(this_node);
+    ld_check(my_node);
+    const auto& my_location = my_node->location;
+
+    std::vector<NodeID> local;
+    std::vector<NodeID> remote;
+    for (const auto& it : nodes) {
+      node_index_t idx = it.first;
+      if (idx == this_node.index() || !detector->isValidDestination(idx)) {
+        continue;
+      }
+      NodeID candidate_id(idx, it.second.generation);
+      if (my_location.hasValue() && it.second.location.hasValue() &&
+          my_location->closestSharedScope(it.second.location.value()) <=
+              scope) {
+        local.push_back(candidate_id);
+      } else {
+        remote.push_back(candidate_id);
+      }
+    }
+
+    bool cross_scope = ++iters_ % std::max(interval, 1) == 0;
+    // Nodes alone in their scope, or in a cluster that doesn't span several
+    // scopes, fall back to gossiping to whichever nodes there are.
+    if (local.empty()) {
+      cross_scope = true;
+    } else if (remote.empty()) {
+      cross_scope = false;
+    }
+    const auto& candidates = cross_scope ? remote : local;
+    if (candidates.size() == 0) {
+      // no valid candidates
+      return NodeID();
+    }
+
+    return candidates[folly::Random::rand32((uint32_t)candidates.size())];
+  }
+
+ private:
+  // number of calls to getNode()
+  size_t iters_{0};
+};
+
 // Request used to complete initialization that needs to
 // happen on the thread only
 class FailureDetector::InitRequest : public Request {
@@ -168,6 +221,9 @@ FailureDetector::FailureDetector(UpdateableSettings<GossipSettings> settings,
     case GossipSettings::SelectionMode::ROUND_ROBIN:
       selector_.reset(new RoundRobinSelector());
       break;
+    case GossipSettings::SelectionMode::LOCALITY:
+      selector_.reset(new LocalitySelector());
+      break;
     default:
       ld_error("Invalid gossip mode(%d)", (int)settings_->mode);
       ld_check(false);
@@ -716,9 +772,9 @@ void FailureDetector::onGossipReceived(const GOSSIP_Message& msg) {
   // presumably has more recent info about the j-th node).
   if (msg.suspect_matrix_.size() > 0) {
     for (auto& idx : to_update) {
-      for (size_t j = 0; j < num_nodes; ++j) {
-        suspect_matrix_[idx][j] = msg.suspect_matrix_[idx][j];
-      }
+      std::copy_n(msg.suspect_matrix_[idx].begin(),
+                  num_nodes,
+                  suspect_matrix_[idx].begin());
     }
   }
 
@@ -227,6 +227,7 @@ class FailureDetector {
   class InitRequest;
   class RandomSelector;
   class RoundRobinSelector;
+  class LocalitySelector;
 
   Timer cs_timer_;
   bool waiting_for_cluster_state_{true};
@@ -7,6 +7,8 @@
  */
 #include "FindKeyStorageTask.h"
 
+#include <algorithm>
+
 #include <folly/Memory.h>
 
 #include "logdevice/common/AdminCommandTable.h"
@@ -46,7 +48,12 @@ FindKeyStorageTask::FindKeyStorageTask(
       flags_(flags),
       task_deadline_(task_deadline),
       tracer_(std::move(tracer)),
-      client_address_(client_address) {}
+      client_address_(client_address) {
+  // Let the storage thread pool run the task ahead of other tasks with a
+  // later or no deadline, and drop it if the client's request times out
+  // before it runs.
+  setDeadline(task_deadline);
+}
 
 void FindKeyStorageTask::execute() {
   LocalLogStore& store = storageThreadPool_->getLocalLogStore();
@@ -96,7 +103,9 @@ void FindKeyStorageTask::onDone() {
 }
 
 void FindKeyStorageTask::onDropped() {
-  result_status_ = E::FAILED;
+  result_status_ = std::chrono::steady_clock::now() >= task_deadline_
+      ? E::TIMEDOUT
+      : E::FAILED;
   sendReply();
 }
 
@@ -126,4 +135,49 @@ void FindKeyStorageTask::getDebugInfoDetailed(
       flags_ & FINDKEY_Header::APPROXIMATE);
 }
 
+FindKeyBatchStorageTask::FindKeyBatchStorageTask(
+    std::vector<std::unique_ptr<FindKeyStorageTask>> tasks)
+    : StorageTask(StorageTask::Type::FINDKEY_BATCH), tasks_(std::move(tasks)) {
+  std::stable_sort(tasks_.begin(),
+                   tasks_.end(),
+                   [](const std::unique_ptr<FindKeyStorageTask>& a,
+                      const std::unique_ptr<FindKeyStorageTask>& b) {
+                     return a->getLogID() < b->getLogID();
+                   });
+  // The batch is only worth dropping once every lookup in it has timed out.
+  auto deadline = std::chrono::steady_clock::time_point::min();
+  for (const auto& task : tasks_) {
+    deadline = std::max(deadline, task->getDeadline());
+  }
+  if (!tasks_.empty()) {
+    setDeadline(deadline);
+  }
+}
+
+void FindKeyBatchStorageTask::execute() {
+  for (auto& task : tasks_) {
+    task->setStorageThreadPool(storageThreadPool_);
+    task->execute();
+  }
+}
+
+void FindKeyBatchStorageTask::onDone() {
+  for (auto& task : tasks_) {
+    task->onDone();
+  }
+}
+
+void FindKeyBatchStorageTask::onDropped() {
+  for (auto& task : tasks_) {
+    task->setStorageThreadPool(storageThreadPool_);
+    task->onDropped();
+  }
+}
+
+void FindKeyBatchStorageTask::getDebugInfoDetailed(
+    StorageTaskDebugInfo& info) const {
+  info.extra_info = folly::sformat("batch of {} findTime requests",
+                                   tasks_.size());
+}
+
 }} // namespace facebook::logdevice
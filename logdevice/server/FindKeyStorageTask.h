@@ -64,6 +64,10 @@ class FindKeyStorageTask : public StorageTask {
   // Workhorse of execute(), LocalLogStore passed from above for testability
   void executeImpl(const LocalLogStore& store, StatsHolder* stats = nullptr);
 
+  logid_t getLogID() const {
+    return log_id_;
+  }
+
   // The result, public for tests
   Status result_status_; // OK or FAILED
   lsn_t result_lo_;
@@ -94,4 +98,36 @@ class FindKeyStorageTask : public StorageTask {
   void getDebugInfoDetailed(StorageTaskDebugInfo&) const override;
 };
 
+/**
+ * Executes the FindKeyStorageTasks created from all entries of a
+ * FINDKEY_BATCH_Message as a single storage task, so that a client resolving
+ * timestamps for many logs at once doesn't flood the storage task queue.
+ * Replies are sent for each entry individually.
+ */
+class FindKeyBatchStorageTask : public StorageTask {
+ public:
+  explicit FindKeyBatchStorageTask(
+      std::vector<std::unique_ptr<FindKeyStorageTask>> tasks);
+
+  void execute() override;
+  void onDone() override;
+  void onDropped() override;
+
+  ThreadType getThreadType() const override {
+    return ThreadType::SLOW;
+  }
+
+  Priority getPriority() const override {
+    // Same as FindKeyStorageTask.
+    return Priority::VERY_HIGH;
+  }
+
+ private:
+  // Sorted by log ID, so that consecutive lookups touch neighboring
+  // directory entries.
+  std::vector<std::unique_ptr<FindKeyStorageTask>> tasks_;
+
+  void getDebugInfoDetailed(StorageTaskDebugInfo&) const override;
+};
+
 }} // namespace facebook::logdevice
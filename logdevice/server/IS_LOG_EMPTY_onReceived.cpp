@@ -44,21 +44,20 @@ static void send_reply(const Address& to,
   Worker::onThisThread()->sender().sendMessage(std::move(msg), to);
 }
 
-Message::Disposition IS_LOG_EMPTY_onReceived(IS_LOG_EMPTY_Message* msg,
-                                             const Address& from) {
-  const IS_LOG_EMPTY_Header& header = msg->getHeader();
-
+// Answers a single IS_LOG_EMPTY request.
+static void handleIsLogEmpty(const IS_LOG_EMPTY_Header& header,
+                             const Address& from) {
   if (header.log_id == LOGID_INVALID) {
     ld_error("got IS_LOG_EMPTY message from %s with invalid log ID, ignoring",
              Sender::describeConnection(from).c_str());
-    return Message::Disposition::NORMAL;
+    return;
   }
 
   ServerWorker* worker = ServerWorker::onThisThread();
   if (!worker->isAcceptingWork()) {
     ld_debug("Ignoring IS_LOG_EMPTY message: not accepting more work");
     send_reply(from, header, E::SHUTDOWN, false);
-    return Message::Disposition::NORMAL;
+    return;
   }
 
   WORKER_LOG_STAT_INCR(header.log_id, is_log_empty_received);
@@ -66,7 +65,7 @@ Message::Disposition IS_LOG_EMPTY_onReceived(IS_LOG_EMPTY_Message* msg,
   ServerProcessor* processor = worker->processor_;
   if (!processor->runningOnStorageNode()) {
     send_reply(from, header, E::NOTSTORAGE, false);
-    return Message::Disposition::NORMAL;
+    return;
   }
 
   auto scfg = worker->getServerConfig();
@@ -80,19 +79,19 @@ Message::Disposition IS_LOG_EMPTY_onReceived(IS_LOG_EMPTY_Message* msg,
                     Sender::describeConnection(from).c_str(),
                     shard_idx,
                     n_shards);
-    return Message::Disposition::NORMAL;
+    return;
   }
 
   if (processor->isDataMissingFromShard(shard_idx)) {
     send_reply(from, header, E::REBUILDING, false);
-    return Message::Disposition::NORMAL;
+    return;
   }
 
   LogStorageStateMap& map = processor->getLogStorageStateMap();
   LogStorageState* log_state = map.insertOrGet(header.log_id, shard_idx);
   if (log_state == nullptr || log_state->hasPermanentError()) {
     send_reply(from, header, E::FAILED, false);
-    return Message::Disposition::NORMAL;
+    return;
   }
 
   folly::Optional<lsn_t> trim_point = log_state->getTrimPoint();
@@ -105,7 +104,7 @@ Message::Disposition IS_LOG_EMPTY_onReceived(IS_LOG_EMPTY_Message* msg,
 
     // And in the meantime tell the client to try again in a bit
     send_reply(from, header, rv == 0 ? E::AGAIN : E::FAILED, false);
-    return Message::Disposition::NORMAL;
+    return;
   }
 
   ShardedStorageThreadPool* sstp = processor->sharded_storage_thread_pool_;
@@ -128,7 +127,7 @@ Message::Disposition IS_LOG_EMPTY_onReceived(IS_LOG_EMPTY_Message* msg,
                     error_description(err));
     // an error occurred, reply to the client
     send_reply(from, header, err, false);
-    return Message::Disposition::NORMAL;
+    return;
   }
 
   ld_debug("IS_LOG_EMPTY(%lu): last_lsn=%lu, trim_point=%lu",
@@ -149,7 +148,7 @@ Message::Disposition IS_LOG_EMPTY_onReceived(IS_LOG_EMPTY_Message* msg,
                       "partitions, reporting non-empty",
                       header.log_id.val_);
       send_reply(from, header, E::REBUILDING, false);
-      return Message::Disposition::NORMAL;
+      return;
     }
   } else {
     // Make sure it's not just pseudorecords, such as bridge records.
@@ -159,6 +158,36 @@ Message::Disposition IS_LOG_EMPTY_onReceived(IS_LOG_EMPTY_Message* msg,
   }
 
   send_reply(from, header, E::OK, empty);
+}
+
+Message::Disposition IS_LOG_EMPTY_onReceived(IS_LOG_EMPTY_Message* msg,
+                                             const Address& from) {
+  handleIsLogEmpty(msg->getHeader(), from);
+  return Message::Disposition::NORMAL;
+}
+
+Message::Disposition
+IS_LOG_EMPTY_BATCH_onReceived(IS_LOG_EMPTY_BATCH_Message* msg,
+                              const Address& from) {
+  for (const IS_LOG_EMPTY_Header& entry : msg->entries_) {
+    if (entry.shard != msg->shard_) {
+      RATELIMIT_ERROR(std::chrono::seconds(10),
+                      10,
+                      "Got malformed IS_LOG_EMPTY_BATCH message from %s: "
+                      "entry for log %lu has shard %u, batch shard is %u",
+                      Sender::describeConnection(from).c_str(),
+                      entry.log_id.val_,
+                      entry.shard,
+                      msg->shard_);
+      err = E::BADMSG;
+      return Message::Disposition::ERROR;
+    }
+  }
+
+  WORKER_STAT_INCR(log_query_batches_received);
+  for (const IS_LOG_EMPTY_Header& entry : msg->entries_) {
+    handleIsLogEmpty(entry, from);
+  }
   return Message::Disposition::NORMAL;
 }
 
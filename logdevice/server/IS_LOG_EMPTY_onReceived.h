@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include "logdevice/common/protocol/IS_LOG_EMPTY_BATCH_Message.h"
 #include "logdevice/common/protocol/IS_LOG_EMPTY_Message.h"
 #include "logdevice/common/protocol/Message.h"
 
@@ -16,4 +17,8 @@ struct Address;
 
 Message::Disposition IS_LOG_EMPTY_onReceived(IS_LOG_EMPTY_Message* msg,
                                              const Address& from);
+
+Message::Disposition
+IS_LOG_EMPTY_BATCH_onReceived(IS_LOG_EMPTY_BATCH_Message* msg,
+                              const Address& from);
 }} // namespace facebook::logdevice
@@ -25,9 +25,12 @@
 
 namespace facebook { namespace logdevice {
 
-Listener::Listener(InterfaceDef iface, std::string thread_name)
+Listener::Listener(InterfaceDef iface,
+                   std::string thread_name,
+                   bool reuse_port)
     : EventLoop(thread_name, ThreadID::Type::UTILITY),
-      iface_(std::move(iface)) {
+      iface_(std::move(iface)),
+      reuse_port_(reuse_port) {
   const int rv = iface_.isPort() ? setupTcpSockets() : setupUnixSocket();
 
   if (rv != 0) {
@@ -67,9 +70,12 @@ static void accept_error_callback(struct evconnlistener* /*listener*/,
 /**
  * Helper for setup_evconnlisteners() that creates a new socket for listening
  * on the specified address.  Mostly copied from evconnlistener_new_bind()
- * implementation, with the addition of making ipv6 addresses ipv6-only.
+ * implementation, with the addition of making ipv6 addresses ipv6-only and
+ * optionally setting SO_REUSEPORT.
  */
-static int new_listener_socket(const struct sockaddr* sa, int socklen) {
+static int new_listener_socket(const struct sockaddr* sa,
+                               int socklen,
+                               bool reuse_port) {
   int family = sa->sa_family;
   int fd = socket(family, SOCK_STREAM, 0);
   int off = 0, on = 1;
@@ -94,6 +100,14 @@ static int new_listener_socket(const struct sockaddr* sa, int socklen) {
     goto err;
   }
 
+  if (reuse_port &&
+      setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (void*)&on, sizeof on) != 0) {
+    ld_error("setsockopt() failed to set SO_REUSEPORT, errno=%d (%s)",
+             errno,
+             strerror(errno));
+    goto err;
+  }
+
   if (family == AF_INET6 || family == AF_INET) {
     if (setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, (void*)&on, sizeof on) != 0) {
       ld_error("setsockopt() failed to set SO_KEEPALIVE, errno=%d (%s)",
@@ -148,7 +162,7 @@ int Listener::setupTcpSockets() {
   };
 
   for (struct addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
-    int fd = new_listener_socket(ai->ai_addr, ai->ai_addrlen);
+    int fd = new_listener_socket(ai->ai_addr, ai->ai_addrlen, reuse_port_);
     if (fd == -1) {
       return -1;
     }
@@ -165,7 +179,8 @@ int Listener::setupUnixSocket() {
   Sockaddr addr(iface_.path());
   struct sockaddr_storage ss;
   int len = addr.toStructSockaddr(&ss);
-  int fd = new_listener_socket(reinterpret_cast<struct sockaddr*>(&ss), len);
+  int fd = new_listener_socket(
+      reinterpret_cast<struct sockaddr*>(&ss), len, /* reuse_port */ false);
   if (fd == -1) {
     return -1;
   }
@@ -68,7 +68,14 @@ class Listener : public EventLoop {
     bool ssl_;
   };
 
-  explicit Listener(InterfaceDef iface, std::string thread_name);
+  /**
+   * @param reuse_port  bind TCP sockets with SO_REUSEPORT, so that several
+   *                    Listeners can accept connections on the same port and
+   *                    the kernel spreads new connections among them
+   */
+  explicit Listener(InterfaceDef iface,
+                    std::string thread_name,
+                    bool reuse_port = false);
 
   ~Listener() override;
 
@@ -109,6 +116,9 @@ class Listener : public EventLoop {
   // Tcp port or path to unix domain socket we'll use to listen for connections.
   InterfaceDef iface_;
 
+  // Whether TCP sockets are bound with SO_REUSEPORT.
+  bool reuse_port_;
+
   // list of pointers to evconnlistener structs, used to ensure they're properly
   // released when this object is destroyed
   typedef std::unique_ptr<evconnlistener, std::function<void(evconnlistener*)>>
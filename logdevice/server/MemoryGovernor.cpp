@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/MemoryGovernor.h"
+
+namespace facebook { namespace logdevice {
+
+MemoryGovernor::ConsumerID MemoryGovernor::addConsumer(std::string name,
+                                                       ResourceBudget* budget) {
+  ld_check(budget != nullptr);
+  std::lock_guard<std::mutex> lock(mutex_);
+  Consumer consumer;
+  consumer.name = std::move(name);
+  consumer.budget = budget;
+  consumers_.push_back(std::move(consumer));
+  return consumers_.size() - 1;
+}
+
+void MemoryGovernor::setLimit(uint64_t total_bytes, double min_share) {
+  ld_check(min_share >= 0 && min_share <= 1);
+  std::lock_guard<std::mutex> lock(mutex_);
+  total_bytes_ = total_bytes;
+  min_share_ = min_share;
+}
+
+void MemoryGovernor::noteStalls(ConsumerID id, uint64_t stalls) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ld_check(id < consumers_.size());
+  consumers_[id].stalls += stalls;
+}
+
+void MemoryGovernor::maybeRebalance(std::chrono::milliseconds interval) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto now = std::chrono::steady_clock::now();
+  if (last_rebalance_time_ != std::chrono::steady_clock::time_point() &&
+      now - last_rebalance_time_ < interval) {
+    return;
+  }
+  last_rebalance_time_ = now;
+  rebalance();
+}
+
+uint64_t MemoryGovernor::minBytes() const {
+  if (consumers_.empty()) {
+    return 0;
+  }
+  return uint64_t(total_bytes_ * min_share_ / consumers_.size());
+}
+
+void MemoryGovernor::rebalance() {
+  if (consumers_.empty() || total_bytes_ == 0) {
+    return;
+  }
+  const uint64_t min_bytes = minBytes();
+  ld_check(min_bytes * consumers_.size() <= total_bytes_);
+  const uint64_t spare_bytes = total_bytes_ - min_bytes * consumers_.size();
+
+  // Every consumer gets a weight of 1 so that the spare memory is divided
+  // evenly when nobody stalls.
+  double total_weight = 0;
+  for (const Consumer& consumer : consumers_) {
+    total_weight += 1 + consumer.stalls;
+  }
+  for (Consumer& consumer : consumers_) {
+    const double weight = 1 + consumer.stalls;
+    consumer.budget->setLimit(
+        min_bytes + uint64_t(spare_bytes * (weight / total_weight)));
+    consumer.prev_stalls = consumer.stalls;
+    consumer.stalls = 0;
+  }
+}
+
+std::vector<MemoryGovernor::ConsumerInfo>
+MemoryGovernor::getConsumers() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<ConsumerInfo> res;
+  const uint64_t min_bytes = minBytes();
+  for (const Consumer& consumer : consumers_) {
+    const uint64_t limit = consumer.budget->getLimit();
+    res.push_back(ConsumerInfo{consumer.name,
+                               int64_t(limit) - consumer.budget->available(),
+                               limit,
+                               min_bytes,
+                               consumer.prev_stalls});
+  }
+  return res;
+}
+
+}} // namespace facebook::logdevice
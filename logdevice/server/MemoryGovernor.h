@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "logdevice/common/ResourceBudget.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Divides a memory limit between several consumers that each acquire
+ * memory from their own ResourceBudget, e.g. the read storage task budgets
+ * of the workers.
+ *
+ * Every consumer is guaranteed a minimum share of the total. The rest is
+ * given out in proportion to how many times each consumer stalled (failed
+ * to acquire memory from its budget) since the previous rebalancing, so
+ * that memory moves to where it is needed instead of sitting unused in the
+ * budgets of idle consumers. Without stalls the total is divided evenly.
+ *
+ * All methods are thread safe.
+ */
+
+class MemoryGovernor {
+ public:
+  using ConsumerID = size_t;
+
+  /**
+   * Registers a consumer. `budget` must outlive the governor or rather its
+   * last rebalancing.
+   */
+  ConsumerID addConsumer(std::string name, ResourceBudget* budget);
+
+  /**
+   * Sets the memory to divide and the fraction of an even share that every
+   * consumer is guaranteed. Takes effect on the next rebalancing.
+   */
+  void setLimit(uint64_t total_bytes, double min_share);
+
+  /**
+   * Reports that consumer `id` stalled `stalls` more times.
+   */
+  void noteStalls(ConsumerID id, uint64_t stalls);
+
+  /**
+   * Recomputes the limits of the budgets unless that was done less than
+   * `interval` ago.
+   */
+  void maybeRebalance(std::chrono::milliseconds interval);
+
+  struct ConsumerInfo {
+    std::string name;
+    int64_t used_bytes;
+    uint64_t limit_bytes;
+    uint64_t min_bytes;
+    // Stalls that the current limits are based on.
+    uint64_t stalls;
+  };
+
+  std::vector<ConsumerInfo> getConsumers() const;
+
+ private:
+  struct Consumer {
+    std::string name;
+    ResourceBudget* budget;
+    // Since the last rebalancing.
+    uint64_t stalls = 0;
+    // Before the last rebalancing.
+    uint64_t prev_stalls = 0;
+  };
+
+  mutable std::mutex mutex_;
+  std::vector<Consumer> consumers_;
+  uint64_t total_bytes_ = 0;
+  double min_share_ = 1;
+  std::chrono::steady_clock::time_point last_rebalance_time_;
+
+  uint64_t minBytes() const;
+  void rebalance();
+};
+
+}} // namespace facebook::logdevice
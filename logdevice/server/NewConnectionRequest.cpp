@@ -16,8 +16,12 @@ namespace facebook { namespace logdevice {
 Request::Execution NewConnectionRequest::execute() {
   Worker* w = Worker::onThisThread();
   ld_check(w != nullptr);
-  int rv = w->sender().addClient(
-      fd_, client_addr_, std::move(conn_token_), sock_type_, conntype_);
+  int rv = w->sender().addClient(fd_,
+                                 client_addr_,
+                                 std::move(conn_token_),
+                                 sock_type_,
+                                 conntype_,
+                                 std::move(established_ssl_));
 
   if (rv == 0) {
     ld_debug("A new connection from %s is running on "
@@ -20,19 +20,22 @@ namespace facebook { namespace logdevice {
  * @file Created by ConnectionListener when a new incoming connection (from a
  *       client or another LogDevice server) is accepted.  The worker thread
  *       processing this request assumes ownership of the socket provided by
- *       libevent.
+ *       libevent, and of its SSL connection if the listener did the SSL
+ *       handshake.
  */
 
 class NewConnectionRequest : public Request {
  public:
-  NewConnectionRequest(int fd,
-                       worker_id_t worker_id,
-                       const Sockaddr& client_addr,
-                       ResourceBudget::Token conn_token,
-                       ResourceBudget::Token conn_backlog_token,
-                       SocketType type,
-                       ConnectionType conntype,
-                       WorkerType worker_type = WorkerType::GENERAL)
+  NewConnectionRequest(
+      int fd,
+      worker_id_t worker_id,
+      const Sockaddr& client_addr,
+      ResourceBudget::Token conn_token,
+      ResourceBudget::Token conn_backlog_token,
+      SocketType type,
+      ConnectionType conntype,
+      WorkerType worker_type = WorkerType::GENERAL,
+      std::unique_ptr<EstablishedSSL> established_ssl = nullptr)
       : Request(RequestType::NEW_CONNECTION),
         fd_(fd),
         worker_id_(worker_id),
@@ -41,7 +44,8 @@ class NewConnectionRequest : public Request {
         conn_backlog_token_(std::move(conn_backlog_token)),
         sock_type_(type),
         conntype_(conntype),
-        worker_type_(worker_type) {}
+        worker_type_(worker_type),
+        established_ssl_(std::move(established_ssl)) {}
 
   ~NewConnectionRequest() override {}
 
@@ -63,6 +67,7 @@ class NewConnectionRequest : public Request {
   ConnectionType conntype_;
   // New connections on this listener will be routed to this worker type
   WorkerType worker_type_{WorkerType::GENERAL};
+  std::unique_ptr<EstablishedSSL> established_ssl_;
 };
 
 }} // namespace facebook::logdevice
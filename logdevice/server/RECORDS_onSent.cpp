@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "RECORDS_onSent.h"
+
+#include "logdevice/common/Sender.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/server/ServerWorker.h"
+#include "logdevice/server/read_path/AllServerReadStreams.h"
+
+namespace facebook { namespace logdevice {
+
+void RECORDS_onSent(const RECORDS_Message& msg,
+                    Status st,
+                    const Address& to,
+                    const SteadyTimestamp enqueue_time) {
+  if (st != E::OK) {
+    // If the message failed to send, the messaging layer will be closing the
+    // socket, so there's no point in trying to send more messages into it.
+    ld_debug("RECORDS message to %s failed to send: %s",
+             Sender::describeConnection(to).c_str(),
+             error_description(st));
+    return;
+  }
+
+  // Bump the same stats as RECORD_onSent() and GAP_onSent() would for the
+  // individual messages.
+  for (const auto& record : msg.records_) {
+    WORKER_TRAFFIC_CLASS_STAT_INCR(msg.tc_, record_messages_sent);
+    WORKER_TRAFFIC_CLASS_STAT_ADD(
+        msg.tc_, record_payload_bytes, record->payload_.size());
+    WORKER_LOG_STAT_ADD(
+        msg.log_id_, record_payload_bytes, record->payload_.size());
+    WORKER_LOG_STAT_INCR(msg.log_id_, records_sent);
+    if (record->log_group_path_) {
+      LOG_GROUP_TIME_SERIES_ADD(Worker::stats(),
+                                record_bytes,
+                                *record->log_group_path_,
+                                record->payload_.size());
+    }
+  }
+  if (msg.gap_) {
+    WORKER_TRAFFIC_CLASS_STAT_INCR(msg.tc_, gap_messages_sent);
+  }
+  WORKER_STAT_INCR(records_batch_messages_sent);
+  WORKER_STAT_ADD(records_batched, msg.records_.size());
+
+  ServerWorker::onThisThread()->serverReadStreams().onRecordsSent(
+      to.id_.client_, msg, enqueue_time);
+}
+
+}} // namespace facebook::logdevice
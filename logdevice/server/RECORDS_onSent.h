@@ -0,0 +1,18 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/RECORDS_Message.h"
+
+namespace facebook { namespace logdevice {
+void RECORDS_onSent(const RECORDS_Message& msg,
+                    Status st,
+                    const Address& to,
+                    const SteadyTimestamp enqueue_time);
+}} // namespace facebook::logdevice
@@ -9,6 +9,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "folly/AtomicIntrusiveLinkedList.h"
 #include "logdevice/common/UnorderedMapWithLRU.h"
@@ -136,6 +137,14 @@ class RealTimeRecordBuffer {
     return released_records_bytes_.load() > max_bytes_;
   }
 
+  size_t bytes() const {
+    return released_records_bytes_.load();
+  }
+
+  size_t maxBytes() const {
+    return max_bytes_;
+  }
+
   logid_t toEvict() {
     return logids_.getLRU();
   }
@@ -144,6 +153,17 @@ class RealTimeRecordBuffer {
     logids_.get(logid);
   }
 
+  // Returns up to `max` logs in the order in which they'd be evicted.
+  std::vector<logid_t> leastRecentlyUsed(size_t max) const {
+    std::vector<logid_t> logs;
+    for (logid_t logid = logids_.getLRU();
+         logid != LOGID_INVALID && logs.size() < max;
+         logid = logids_.getNextLRU(logid)) {
+      logs.push_back(logid);
+    }
+    return logs;
+  }
+
   void deletedReleasedRecords(const ReleasedRecords* records) {
     released_records_bytes_.fetch_sub(records->getBytesEstimate());
 
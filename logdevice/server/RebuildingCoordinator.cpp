@@ -116,9 +116,12 @@ class WriteShardRebuildingCompleteMetadataTask : public StorageTask {
  */
 class WakeUpServerReadStreamsRequest : public Request {
  public:
-  WakeUpServerReadStreamsRequest(int worker_idx, uint32_t shard_idx)
+  WakeUpServerReadStreamsRequest(int worker_idx,
+                                 WorkerType worker_type,
+                                 uint32_t shard_idx)
       : Request(RequestType::WAKEUP_SERVER_READ_STREAMS),
         worker_idx_(worker_idx),
+        worker_type_(worker_type),
         shard_idx_(shard_idx) {}
 
   Request::Execution execute() override {
@@ -131,8 +134,13 @@ class WakeUpServerReadStreamsRequest : public Request {
     return worker_idx_;
   }
 
+  WorkerType getWorkerTypeAffinity() override {
+    return worker_type_;
+  }
+
  private:
   int worker_idx_;
+  WorkerType worker_type_;
   uint32_t shard_idx_;
 };
 
@@ -357,11 +365,13 @@ void RebuildingCoordinator::onMarkerWrittenForShard(uint32_t shard,
 }
 
 void RebuildingCoordinator::wakeUpReadStreams(uint32_t shard) {
-  const int nworkers = processor_->getWorkerCount(WorkerType::GENERAL);
-  for (int i = 0; i < nworkers; ++i) {
-    std::unique_ptr<Request> req =
-        std::make_unique<WakeUpServerReadStreamsRequest>(i, shard);
-    processor_->postWithRetrying(req);
+  for (WorkerType type : {WorkerType::GENERAL, WorkerType::READ}) {
+    const int nworkers = processor_->getWorkerCount(type);
+    for (int i = 0; i < nworkers; ++i) {
+      std::unique_ptr<Request> req =
+          std::make_unique<WakeUpServerReadStreamsRequest>(i, type, shard);
+      processor_->postWithRetrying(req);
+    }
   }
 }
 
@@ -13,6 +13,7 @@
 #include "logdevice/common/protocol/STORE_Message.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/server/EpochRecordCache.h"
+#include "logdevice/server/EpochRecordCacheEntry.h"
 #include "logdevice/server/RecordCacheDependencies.h"
 
 namespace facebook { namespace logdevice {
@@ -81,6 +82,9 @@ int RecordCache::putRecord(RecordID rid,
 
   if (epoch_cache != nullptr) {
     // common path
+    if (flags & STORE_Header::NO_RECORD_CACHE) {
+      return skipRecord(*epoch_cache);
+    }
     return epoch_cache->putRecord(rid,
                                   timestamp,
                                   lng,
@@ -200,6 +204,9 @@ int RecordCache::putRecord(RecordID rid,
     ld_check(epoch_cache != nullptr);
   }
 
+  if (flags & STORE_Header::NO_RECORD_CACHE) {
+    return skipRecord(*epoch_cache);
+  }
   return epoch_cache->putRecord(rid,
                                 timestamp,
                                 lng,
@@ -212,6 +219,18 @@ int RecordCache::putRecord(RecordID rid,
                                 offset_within_epoch);
 }
 
+int RecordCache::skipRecord(EpochRecordCache& epoch_cache) {
+  // The record is from a log in streaming ingest mode. The epoch cache must
+  // not claim to hold all records of the epoch if this one is missing, so it
+  // is disabled instead: recovery digests the epoch from the local log store
+  // and readers read it from there.
+  if (!epoch_cache.isDisabled()) {
+    epoch_cache.disableCache();
+    STAT_INCR(deps_->getStatsHolder(), record_cache_epoch_skipped_streaming);
+  }
+  return -1;
+}
+
 std::pair<RecordCache::Result, std::shared_ptr<EpochRecordCache>>
 RecordCache::getEpochRecordCache(epoch_t epoch) const {
   std::shared_ptr<EpochRecordCache> epoch_cache = epoch_caches_.get(epoch.val_);
@@ -300,6 +319,21 @@ void RecordCache::onLastCleanEpochAdvanced(epoch_t lce) {
   // epoch caches will get dropped outside of the lock
 }
 
+void RecordCache::onDigestServed(epoch_t epoch) {
+  epoch_t::raw_type cur = digest_epoch_.load();
+  while (cur < epoch.val_ &&
+         !digest_epoch_.compare_exchange_weak(cur, epoch.val_)) {
+  }
+}
+
+bool RecordCache::hasPendingDigest() const {
+  const epoch_t::raw_type digest_epoch = digest_epoch_.load();
+  // onLastCleanEpochAdvanced() moves head_epoch_cached_ past the epochs
+  // recovery has cleaned
+  return digest_epoch != EPOCH_INVALID.val_ &&
+      digest_epoch >= head_epoch_cached_.load();
+}
+
 void RecordCache::onRelease(lsn_t last_released) {
   const esn_t release_esn = lsn_to_esn(last_released);
   if (release_esn > ESN_INVALID) {
@@ -435,7 +469,8 @@ void RecordCache::evictResetAllEpochs() {
 size_t RecordCache::getPayloadSizeEstimate() const {
   size_t total_size = 0;
   accessAllEpochCaches([&](const EpochRecordCache& epoch_cache) {
-    total_size += epoch_cache.bufferedPayloadBytes();
+    total_size += epoch_cache.bufferedPayloadBytes() +
+        epoch_cache.bufferedRecords() * sizeof(EpochRecordCacheEntry);
   });
   return total_size;
 }
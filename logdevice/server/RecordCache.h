@@ -175,9 +175,24 @@ class RecordCache {
    */
   void evictResetAllEpochs();
 
+  /**
+   * Called when a recovery digest of @param epoch was served from this cache.
+   * Until the last clean epoch of the log advances past it, the epoch is
+   * likely to be digested again if the recovery is restarted, so the
+   * size-based eviction of RecordCacheMonitorThread leaves this cache for
+   * last.
+   */
+  void onDigestServed(epoch_t epoch);
+
+  /**
+   * @return  true if a digest was served from an epoch that is still cached,
+   *          i.e., whose recovery hasn't cleaned it yet
+   */
+  bool hasPendingDigest() const;
+
   /**
    * @return   the size estimate of the all record payloads currently stored
-   *           in the record cache
+   *           in the record cache, along with the entries holding them
    */
   size_t getPayloadSizeEstimate() const;
 
@@ -267,10 +282,18 @@ class RecordCache {
   // indicate the record cache is shutdown and shouldn't take new writes
   std::atomic<bool> shutdown_{false};
 
+  // highest epoch a digest was served from, see onDigestServed(). Not
+  // included in snapshots.
+  std::atomic<epoch_t::raw_type> digest_epoch_{EPOCH_INVALID.val_};
+
   // actual implementation for evictResetEpoch(), must be called under
   // mutex_
   void evictResetEpochImpl(epoch_t epoch);
 
+  // called instead of EpochRecordCache::putRecord() for a STORE with the
+  // NO_RECORD_CACHE flag, returns -1
+  int skipRecord(EpochRecordCache& epoch_cache);
+
   // helper utility to call @param func on all epoch caches in the current
   // snapshot
   template <typename Func>
@@ -18,6 +18,8 @@ namespace facebook { namespace logdevice {
 
 class EpochRecordCache;
 class EpochRecordCacheEntry;
+class PayloadHolder;
+class SlabArena;
 class StatsHolder;
 struct Seal;
 
@@ -46,6 +48,16 @@ class EpochRecordCacheDependencies {
     return nullptr;
   }
 
+  /**
+   * @return  the arena to place the entry of a record holding `payload` in,
+   *          nullptr to allocate it on the heap. Entries placed in an arena
+   *          must be given to ZeroCopiedRecordDisposal by
+   *          disposeOfCacheEntry().
+   */
+  virtual SlabArena* getCacheEntryArena(const PayloadHolder* /*payload*/) {
+    return nullptr;
+  }
+
   /**
    * Called, with lock held, whenever entries are removed from the cache because
    * they've been released.  Not called when they're evicted due to memory
@@ -47,7 +47,11 @@ void RecordCacheDisposal::onRecordsReleased(const EpochRecordCache& cache,
                                             lsn_t begin,
                                             lsn_t end,
                                             const ReleasedVector& entries) {
-  if (!processor_->settings()->real_time_reads_enabled) {
+  const Settings* worker_settings = Worker::settingsIfOnWorker();
+  const bool real_time_reads_enabled = worker_settings
+      ? worker_settings->real_time_reads_enabled
+      : processor_->settings()->real_time_reads_enabled;
+  if (!real_time_reads_enabled) {
     return;
   }
 
@@ -63,14 +67,18 @@ void RecordCacheDisposal::onRecordsReleased(const EpochRecordCache& cache,
   LogStorageState& log_state = processor_->getLogStorageStateMap().get(
       cache.getLogId(), cache.getShardIndex());
 
-  processor_->applyToWorkerIdxs([&](worker_id_t index, WorkerType type) {
-    if (log_state.isWorkerSubscribed(index)) {
+  auto append = [&](worker_id_t index, WorkerType type) {
+    if (log_state.isWorkerSubscribed(index, type)) {
       AllServerReadStreams& streams =
           processor_->getWorker(index, type).serverReadStreams();
       streams.appendReleasedRecords(std::make_unique<ReleasedRecords>(
           cache.getLogId(), begin, end, entries_list, bytes_estimate));
     }
-  });
+  };
+  processor_->applyToWorkerIdxs(
+      append, Processor::Order::FORWARD, WorkerType::GENERAL);
+  processor_->applyToWorkerIdxs(
+      append, Processor::Order::FORWARD, WorkerType::READ);
 }
 
 folly::Optional<Seal> RecordCacheDisposal::getSeal(logid_t logid,
@@ -133,4 +141,9 @@ StatsHolder* RecordCacheDisposal::getStatsHolder() const {
   return processor_->stats_;
 }
 
+SlabArena*
+RecordCacheDisposal::getCacheEntryArena(const PayloadHolder* payload) {
+  return processor_->zeroCopiedRecordDisposal().getArena(payload);
+}
+
 }} // namespace facebook::logdevice
@@ -48,6 +48,8 @@ class RecordCacheDisposal : public RecordCacheDependencies {
 
   StatsHolder* getStatsHolder() const override;
 
+  SlabArena* getCacheEntryArena(const PayloadHolder* payload) override;
+
  private:
   ServerProcessor* const processor_;
 };
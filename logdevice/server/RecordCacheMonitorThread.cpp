@@ -7,9 +7,9 @@
  */
 #include "RecordCacheMonitorThread.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
-#include <functional>
-#include <queue>
 #include <vector>
 
 #include "logdevice/common/ThreadID.h"
@@ -20,9 +20,18 @@
 
 namespace facebook { namespace logdevice {
 
-RecordCacheMonitorThread::RecordCacheMonitorThread(ServerProcessor* processor)
-    : processor_(processor) {
+RecordCacheMonitorThread::RecordCacheMonitorThread(ServerProcessor* processor,
+                                                   shard_size_t num_shards)
+    : processor_(processor),
+      num_shards_(num_shards),
+      shard_budgets_(new std::atomic<size_t>[num_shards]),
+      recent_hits_(num_shards, 0),
+      last_hits_(num_shards, 0) {
   ld_check(processor != nullptr);
+  ld_check(num_shards > 0);
+  for (shard_index_t shard = 0; shard < num_shards_; ++shard) {
+    shard_budgets_[shard].store(0);
+  }
   thread_ = std::thread([this] { threadMain(); });
   ld_info("Record cache monitor thread started.");
 }
@@ -44,7 +53,9 @@ void RecordCacheMonitorThread::threadMain() {
           processor_->settings()->record_cache_max_size);
 
   while (!shutdown_.signaled()) {
-    auto result = recordCacheNeedsEviction();
+    updateShardBudgets();
+    size_t total_bytes = 0;
+    auto result = recordCacheNeedsEviction(&total_bytes);
     if (result.first) {
       RATELIMIT_INFO(
           std::chrono::seconds(10),
@@ -53,14 +64,134 @@ void RecordCacheMonitorThread::threadMain() {
           "attempting to evict %lu bytes.",
           processor_->settings()->record_cache_max_size,
           result.second);
-      evictCaches(result.second);
+      evictCaches(result.second, total_bytes);
     }
 
     shutdown_.waitFor(processor_->settings()->record_cache_monitor_interval);
   }
 }
 
-std::pair<bool, size_t> RecordCacheMonitorThread::recordCacheNeedsEviction() {
+size_t RecordCacheMonitorThread::getShardBudget(shard_index_t shard) const {
+  ld_check(shard >= 0 && shard < num_shards_);
+  return shard_budgets_[shard].load();
+}
+
+std::vector<double>
+RecordCacheMonitorThread::computeBudgetShares(const std::vector<double>& hits,
+                                              double hit_weight) {
+  ld_check(!hits.empty());
+  ld_check(hit_weight >= 0 && hit_weight <= 1);
+  double total_hits = 0;
+  for (double h : hits) {
+    total_hits += h;
+  }
+  std::vector<double> shares(hits.size(), 1.0 / hits.size());
+  if (total_hits <= 0) {
+    // no hits to go by, share equally
+    return shares;
+  }
+  for (size_t i = 0; i < hits.size(); ++i) {
+    shares[i] =
+        (1 - hit_weight) / hits.size() + hit_weight * hits[i] / total_hits;
+  }
+  return shares;
+}
+
+std::vector<size_t> RecordCacheMonitorThread::computeShardEvictionTargets(
+    const std::vector<size_t>& cached_bytes,
+    const std::vector<double>& shares,
+    size_t target_bytes) {
+  ld_check(cached_bytes.size() == shares.size());
+  size_t total = 0;
+  for (size_t b : cached_bytes) {
+    total += b;
+  }
+  if (target_bytes >= total) {
+    return cached_bytes;
+  }
+  // Bytes to keep on each shard are its share of what remains. Shards under
+  // their share keep everything, and what they don't use is shared between
+  // the others, until all remaining shards are over their share.
+  double remaining = total - target_bytes;
+  std::vector<bool> over(cached_bytes.size(), true);
+  std::vector<double> keep(cached_bytes.size(), 0);
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    double shares_over = 0;
+    size_t num_over = 0;
+    for (size_t i = 0; i < cached_bytes.size(); ++i) {
+      if (over[i]) {
+        shares_over += shares[i];
+        ++num_over;
+      }
+    }
+    for (size_t i = 0; i < cached_bytes.size(); ++i) {
+      if (!over[i]) {
+        continue;
+      }
+      keep[i] = remaining *
+          (shares_over > 0 ? shares[i] / shares_over : 1.0 / num_over);
+      if (cached_bytes[i] <= keep[i]) {
+        over[i] = false;
+        remaining -= cached_bytes[i];
+        changed = true;
+        break;
+      }
+    }
+  }
+
+  std::vector<size_t> targets(cached_bytes.size(), 0);
+  for (size_t i = 0; i < cached_bytes.size(); ++i) {
+    if (over[i]) {
+      const size_t excess = std::ceil(cached_bytes[i] - keep[i]);
+      targets[i] = std::min(cached_bytes[i], excess);
+    }
+  }
+  return targets;
+}
+
+void RecordCacheMonitorThread::updateShardBudgets() {
+  std::vector<uint64_t> hits(num_shards_, 0);
+  StatsHolder* holder = processor_->stats_;
+  if (holder != nullptr) {
+    holder->runForEach([&](Stats& stats) {
+      if (!stats.per_shard_stats) {
+        return;
+      }
+      for (shard_index_t shard = 0; shard < num_shards_; ++shard) {
+        const PerShardStats* shard_stats = stats.per_shard_stats->get(shard);
+        if (shard_stats != nullptr) {
+          hits[shard] += shard_stats->record_cache_digest_hit +
+              shard_stats->record_cache_seal_hit;
+        }
+      }
+    });
+  }
+
+  // Hits since the last check count fully, and older ones decay by half at
+  // each check.
+  for (shard_index_t shard = 0; shard < num_shards_; ++shard) {
+    // stats may have been reset
+    const uint64_t new_hits = hits[shard] >= last_hits_[shard]
+        ? hits[shard] - last_hits_[shard]
+        : hits[shard];
+    last_hits_[shard] = hits[shard];
+    recent_hits_[shard] = recent_hits_[shard] / 2 + new_hits;
+  }
+
+  const size_t size_limit = processor_->settings()->record_cache_max_size;
+  auto shares = computeBudgetShares(
+      recent_hits_, processor_->settings()->record_cache_budget_hit_weight);
+  for (shard_index_t shard = 0; shard < num_shards_; ++shard) {
+    shard_budgets_[shard].store(size_limit * shares[shard]);
+  }
+}
+
+std::pair<bool, size_t>
+RecordCacheMonitorThread::recordCacheNeedsEviction(size_t* total_bytes) {
+  ld_check(total_bytes != nullptr);
+  *total_bytes = 0;
   const size_t size_limit = processor_->settings()->record_cache_max_size;
   if (size_limit == 0) {
     // ulimited, no eviction required
@@ -74,9 +205,10 @@ std::pair<bool, size_t> RecordCacheMonitorThread::recordCacheNeedsEviction() {
   // 1) record_cache_bytes_cached_estimate only gets decreased when the Entry is
   //    destroyed at RecordCacheDisposal, which could be a bit later after the
   //    Entry is evicted.
-  // 2) record_cache_bytes_cached_estimate takes into account of the size
-  //    overhead of Entry itself, while RecordCache::getPayloadSizeEstimate()
-  //    only accounts for the payload size.
+  // 2) record_cache_bytes_cached_estimate also takes into account of the size
+  //    of the shared_ptr control block of each Entry, while
+  //    RecordCache::getPayloadSizeEstimate() only accounts for the payload and
+  //    the Entry itself.
   // Although record_cache_bytes_cached_estimate is an overestimate on the
   // current record cache size, it is actually more accurate on estimate the
   // memeory usage of all record cache related data. Therefore, we use this
@@ -95,6 +227,7 @@ std::pair<bool, size_t> RecordCacheMonitorThread::recordCacheNeedsEviction() {
   holder->runForEach([&total_cache_size](Stats& stats) {
     total_cache_size += stats.record_cache_bytes_cached_estimate;
   });
+  *total_bytes = std::max(total_cache_size, int64_t(0));
 
   if (total_cache_size > 0 && total_cache_size > (int64_t)size_limit) {
     // beside the bytes exceed the limit, evict another 20% of the max
@@ -114,27 +247,21 @@ namespace {
 
 struct LogEntry {
   logid_t log_id;
-  shard_index_t shard;
   size_t cache_size;
-
-  bool operator>(const LogEntry& rhs) const {
-    return cache_size > rhs.cache_size;
-  }
+  // the cache served a digest of an epoch that recovery hasn't cleaned yet
+  bool pending_digest;
 };
 
 } // namespace
 
-void RecordCacheMonitorThread::evictCaches(size_t target_bytes) {
+void RecordCacheMonitorThread::evictCaches(size_t target_bytes,
+                                           size_t total_bytes) {
   ld_check(target_bytes > 0);
-  using MinQueue = std::
-      priority_queue<LogEntry, std::vector<LogEntry>, std::greater<LogEntry>>;
 
-  MinQueue min_queue;
-  // number of bytes for logs in the min_queue
-  size_t bytes_in_queue = 0;
-
-  auto access_log = [target_bytes, &bytes_in_queue, &min_queue](
-                        logid_t logid, const LogStorageState& state) {
+  // Caches of each shard, and their total size
+  std::vector<std::vector<LogEntry>> shard_logs(num_shards_);
+  std::vector<size_t> cached_bytes(num_shards_, 0);
+  auto access_log = [&](logid_t logid, const LogStorageState& state) {
     if (state.record_cache_ == nullptr) {
       return 0;
     }
@@ -142,52 +269,89 @@ void RecordCacheMonitorThread::evictCaches(size_t target_bytes) {
     if (log_size == 0) {
       return 0;
     }
-
-    min_queue.push(LogEntry{logid, state.getShardIdx(), log_size});
-    bytes_in_queue += log_size;
-
-    // pop the queue until 1) it is empty or
-    // 2) bytes_in_queue - queue.top() < target_bytes
-    while (!min_queue.empty() && bytes_in_queue > target_bytes) {
-      const auto& entry = min_queue.top();
-      ld_check(bytes_in_queue >= entry.cache_size);
-      if (bytes_in_queue - entry.cache_size < target_bytes) {
-        break;
-      }
-      bytes_in_queue -= entry.cache_size;
-      min_queue.pop();
-    }
-
+    const shard_index_t shard = state.getShardIdx();
+    ld_check(shard >= 0 && shard < num_shards_);
+    shard_logs[shard].push_back(
+        LogEntry{logid, log_size, state.record_cache_->hasPendingDigest()});
+    cached_bytes[shard] += log_size;
     return 0;
   };
 
   auto& log_map = processor_->getLogStorageStateMap();
   log_map.forEachLog(access_log);
 
-  if (min_queue.empty()) {
+  size_t total_cached = 0;
+  for (size_t b : cached_bytes) {
+    total_cached += b;
+  }
+  if (total_cached == 0) {
     RATELIMIT_INFO(std::chrono::seconds(10),
                    1,
                    "Can't find a log to evict, nothing to do.");
     return;
   }
 
-  size_t num_logs_evicted = 0;
+  // target_bytes is in terms of record_cache_bytes_cached_estimate, which
+  // overestimates the sizes of caches, see recordCacheNeedsEviction()
+  if (total_bytes > total_cached) {
+    target_bytes =
+        static_cast<double>(target_bytes) * total_cached / total_bytes;
+  }
 
-  // evict all logs in queue
-  while (!min_queue.empty()) {
-    const LogEntry& e = min_queue.top();
-    auto& record_cache_ptr = log_map.get(e.log_id, e.shard).record_cache_;
-    // RecordCache pointer shouldn't get destroyed before this thread exists
-    ld_check(record_cache_ptr != nullptr);
-    record_cache_ptr->evictResetAllEpochs();
-    min_queue.pop();
-    ++num_logs_evicted;
+  std::vector<double> shares(num_shards_);
+  const size_t size_limit = processor_->settings()->record_cache_max_size;
+  for (shard_index_t shard = 0; shard < num_shards_; ++shard) {
+    shares[shard] = size_limit > 0
+        ? static_cast<double>(getShardBudget(shard)) / size_limit
+        : 1.0 / num_shards_;
+  }
+  auto targets =
+      computeShardEvictionTargets(cached_bytes, shares, target_bytes);
+
+  size_t num_logs_evicted = 0;
+  size_t bytes_evicted = 0;
+  for (shard_index_t shard = 0; shard < num_shards_; ++shard) {
+    if (targets[shard] == 0) {
+      continue;
+    }
+    // evict logs with the most bytes cached first. Logs with a pending
+    // digest go last: their recovery may be restarted and digest the same
+    // epochs again, which would then have to read them from the log store.
+    auto& logs = shard_logs[shard];
+    std::sort(logs.begin(), logs.end(), [](const auto& a, const auto& b) {
+      if (a.pending_digest != b.pending_digest) {
+        return b.pending_digest;
+      }
+      return a.cache_size > b.cache_size;
+    });
+    size_t shard_bytes_evicted = 0;
+    for (const LogEntry& e : logs) {
+      if (shard_bytes_evicted >= targets[shard]) {
+        break;
+      }
+      auto& record_cache_ptr = log_map.get(e.log_id, shard).record_cache_;
+      // RecordCache pointer shouldn't get destroyed before this thread exists
+      ld_check(record_cache_ptr != nullptr);
+      record_cache_ptr->evictResetAllEpochs();
+      if (e.pending_digest) {
+        STAT_INCR(processor_->stats_, record_cache_pending_digest_logs_evicted);
+      }
+      shard_bytes_evicted += e.cache_size;
+      ++num_logs_evicted;
+    }
+    PER_SHARD_STAT_ADD(processor_->stats_,
+                       record_cache_monitor_bytes_evicted,
+                       shard,
+                       shard_bytes_evicted);
+    PER_SHARD_STAT_INCR(
+        processor_->stats_, record_cache_monitor_evictions, shard);
+    bytes_evicted += shard_bytes_evicted;
   }
 
   STAT_INCR(processor_->stats_, record_cache_eviction_performed_by_monitor);
   STAT_ADD(processor_->stats_,
            record_cache_bytes_evicted_by_monitor,
-           bytes_in_queue);
+           bytes_evicted);
 
   RATELIMIT_INFO(
       std::chrono::seconds(10),
@@ -195,7 +359,7 @@ void RecordCacheMonitorThread::evictCaches(size_t target_bytes) {
       "Evicted %lu logs from the record cache, estimate actual total "
       "bytes evicted: %lu, bytes evicted target: %lu",
       num_logs_evicted,
-      bytes_in_queue,
+      bytes_evicted,
       target_bytes);
 }
 
@@ -7,11 +7,16 @@
  */
 #pragma once
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "logdevice/common/SingleEvent.h"
+#include "logdevice/common/types_internal.h"
 
 namespace facebook { namespace logdevice {
 
@@ -27,15 +32,63 @@ class ServerProcessor;
  *         epochs currently cached. This could help to leave more logs in the
  *         cache, achieving better availability in terms of logs and less seeks
  *         durng epoch recovery.
+ *
+ *         Eviction is triggered by the total size, but only evicts from
+ *         shards whose record caches exceed their budget, so that a hot
+ *         shard doesn't evict the caches of quiet ones. Each shard's budget
+ *         is a share of --record-cache-max-size, made partly of an equal
+ *         share and partly of a share proportional to the record cache hits
+ *         (digests and seals served from the cache) of the shard, see
+ *         --record-cache-budget-hit-weight.
  */
 
 class RecordCacheMonitorThread {
  public:
-  explicit RecordCacheMonitorThread(ServerProcessor* processor);
+  RecordCacheMonitorThread(ServerProcessor* processor, shard_size_t num_shards);
   ~RecordCacheMonitorThread();
 
+  /**
+   * @return  the record cache budget of `shard` in bytes as of the last check
+   *          of the monitor thread, 0 if the cache size is unlimited
+   */
+  size_t getShardBudget(shard_index_t shard) const;
+
+  /**
+   * Computes the share of each shard in the total record cache budget.
+   *
+   * @param hits        recent record cache hits of each shard
+   * @param hit_weight  fraction of the budget given out in proportion to
+   *                    hits, the rest is shared equally
+   *
+   * @return  shares adding up to 1
+   */
+  static std::vector<double>
+  computeBudgetShares(const std::vector<double>& hits, double hit_weight);
+
+  /**
+   * Computes how many bytes to evict from each shard so that the total
+   * cached bytes shrink by `target_bytes`, evicting only from shards over
+   * their share of what remains.
+   *
+   * @param cached_bytes  bytes cached on each shard
+   * @param shares        see computeBudgetShares()
+   */
+  static std::vector<size_t>
+  computeShardEvictionTargets(const std::vector<size_t>& cached_bytes,
+                              const std::vector<double>& shares,
+                              size_t target_bytes);
+
  private:
   ServerProcessor* const processor_;
+  const shard_size_t num_shards_;
+
+  // see getShardBudget()
+  std::unique_ptr<std::atomic<size_t>[]> shard_budgets_;
+
+  // decayed number of record cache hits of each shard, and the cumulative
+  // number of hits at the last check
+  std::vector<double> recent_hits_;
+  std::vector<uint64_t> last_hits_;
 
   // for controlling thread shut down
   SingleEvent shutdown_;
@@ -53,10 +106,16 @@ class RecordCacheMonitorThread {
   //          eviction_needed is a boolean value indicating whether eviction
   //          is needed, and bytes_target is the total amount of bytes that
   //          should be evicted
-  std::pair<bool, size_t> recordCacheNeedsEviction();
+  //
+  // @param total_bytes  set to the total size of all record caches
+  std::pair<bool, size_t> recordCacheNeedsEviction(size_t* total_bytes);
+
+  // Updates recent_hits_ from the per-shard stats, and the budgets.
+  void updateShardBudgets();
 
-  // Perform eviction for all logs, attempting to evict @param target_bytes
-  void evictCaches(size_t target_bytes);
+  // Perform eviction for all logs, attempting to evict @param target_bytes out
+  // of @param total_bytes, from the shards exceeding their budget
+  void evictCaches(size_t target_bytes, size_t total_bytes);
 };
 
 }} // namespace facebook::logdevice
@@ -7,9 +7,13 @@
  */
 #include "RecordCachePersistence.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "logdevice/common/Worker.h"
 #include "logdevice/server/RecordCache.h"
 #include "logdevice/server/ServerProcessor.h"
+#include "logdevice/server/locallogstore/LocalLogStore.h"
 #include "logdevice/server/read_path/LogStorageStateMap.h"
 #include "logdevice/server/storage_tasks/ExecStorageThread.h"
 #include "logdevice/server/storage_tasks/ShardedStorageThreadPool.h"
@@ -20,6 +24,16 @@ namespace facebook { namespace logdevice { namespace RecordCachePersistence {
 // Write in batches of 10Mib
 static const size_t SNAPSHOT_BATCH_SIZE_LIMIT = 10 * 1024 * 1024;
 
+namespace {
+const uint8_t CHUNK_INDEX_FORMAT_VERSION = 1;
+
+struct SerializedChunk {
+  uint64_t first_log;
+  uint64_t last_log;
+  uint64_t bytes;
+} __attribute__((__packed__));
+} // namespace
+
 void persistRecordCaches(shard_index_t shard_idx,
                          StorageThreadPool* storage_thread_pool) {
   LocalLogStore& shard = storage_thread_pool->getLocalLogStore();
@@ -45,12 +59,16 @@ void persistRecordCaches(shard_index_t shard_idx,
   // Keep owners of RecordCache blobs in memory so contents aren't freed
   std::vector<std::unique_ptr<uint8_t[]>> record_cache_snapshot_owners;
   std::vector<std::pair<logid_t, Slice>> record_cache_snapshot_batch;
+  std::vector<SnapshotChunk> chunks;
   size_t logs_in_current_batch = 0;
   size_t total_persisted_logs = 0;
   size_t bytes_in_current_batch = 0;
   size_t total_bytes = 0;
 
   auto commit_batch = [&]() -> int {
+    if (record_cache_snapshot_batch.empty()) {
+      return 0;
+    }
     int rv = shard.writeLogSnapshotBlobs(
         LocalLogStore::LogSnapshotBlobType::RECORD_CACHE,
         record_cache_snapshot_batch);
@@ -63,6 +81,9 @@ void persistRecordCaches(shard_index_t shard_idx,
                total_persisted_logs,
                total_bytes);
     } else {
+      chunks.push_back(SnapshotChunk{record_cache_snapshot_batch.front().first,
+                                     record_cache_snapshot_batch.back().first,
+                                     bytes_in_current_batch});
       total_bytes += bytes_in_current_batch;
       total_persisted_logs += logs_in_current_batch;
     }
@@ -73,14 +94,9 @@ void persistRecordCaches(shard_index_t shard_idx,
     return rv;
   };
 
-  // A callback function called for each log, which will write batches of
-  // serialized representations of record caches to disk.
-  auto callback = [&](logid_t log_id, const LogStorageState& state) {
-    // Serialize the record cache
-    RecordCache* record_cache = state.record_cache_.get();
-    if (!record_cache) {
-      return 0;
-    }
+  // Serializes the record cache of a log, and writes batches of serialized
+  // representations of record caches to disk.
+  auto persist = [&](logid_t log_id, RecordCache* record_cache) {
     ssize_t size = record_cache->sizeInLinearBuffer();
     if (size == -1) {
       ld_error("Failed to calculate size of RecordCache in linear buffer on "
@@ -115,8 +131,6 @@ void persistRecordCaches(shard_index_t shard_idx,
 
     // Add serialized representation to batch. If the batch's size now exceeds
     // the batch limit, write it and start a new one.
-    // TODO 12730327: make code cleaner without sharing states between two
-    // lambdas
     bytes_in_current_batch += linear_size;
     logs_in_current_batch++;
     record_cache_snapshot_batch.emplace_back(
@@ -128,18 +142,101 @@ void persistRecordCaches(shard_index_t shard_idx,
     return 0;
   };
 
-  // Run above lambda for each log
-  int rv = log_storage_state_map.forEachLogOnShard(shard_idx, callback);
+  // Batches must cover ranges of log IDs, go through the logs in order.
+  std::vector<std::pair<logid_t, RecordCache*>> record_caches;
+  log_storage_state_map.forEachLogOnShard(
+      shard_idx, [&](logid_t log_id, const LogStorageState& state) {
+        if (state.record_cache_) {
+          record_caches.emplace_back(log_id, state.record_cache_.get());
+        }
+        return 0;
+      });
+  std::sort(record_caches.begin(), record_caches.end());
+
+  int rv = 0;
+  for (const auto& kv : record_caches) {
+    rv = persist(kv.first, kv.second);
+    if (rv != 0) {
+      break;
+    }
+  }
 
   // Write the last batch, unless we've previously encountered an error
   if (rv == 0) {
     commit_batch();
   }
 
-  ld_info("Persisted record caches for %ju logs on shard %d, totaling %ju "
-          "bytes.",
+  // The chunks written so far can be read independently.
+  if (!chunks.empty()) {
+    std::string index = serializeChunkIndex(chunks);
+    rv = shard.writeLogSnapshotBlobs(
+        LocalLogStore::LogSnapshotBlobType::RECORD_CACHE_INDEX,
+        {{LOGID_INVALID, Slice(index.data(), index.size())}});
+    if (rv != 0) {
+      ld_error("Failed to write the index of %zu record cache snapshot chunks "
+               "to shard %d: %s. The snapshot will be read as a whole.",
+               chunks.size(),
+               shard_idx,
+               error_name(err));
+    }
+  }
+
+  ld_info("Persisted record caches for %ju logs on shard %d in %zu chunks, "
+          "totaling %ju bytes.",
           total_persisted_logs,
           shard_idx,
+          chunks.size(),
           total_bytes);
 }
+
+std::string serializeChunkIndex(const std::vector<SnapshotChunk>& chunks) {
+  std::string res(1, char(CHUNK_INDEX_FORMAT_VERSION));
+  for (const SnapshotChunk& chunk : chunks) {
+    SerializedChunk serialized = {
+        chunk.first_log.val_, chunk.last_log.val_, chunk.bytes};
+    res.append(reinterpret_cast<const char*>(&serialized), sizeof(serialized));
+  }
+  return res;
+}
+
+int deserializeChunkIndex(Slice blob, std::vector<SnapshotChunk>* chunks_out) {
+  ld_check(chunks_out);
+  const char* data = reinterpret_cast<const char*>(blob.data);
+  if (blob.size < 1 || uint8_t(data[0]) != CHUNK_INDEX_FORMAT_VERSION ||
+      (blob.size - 1) % sizeof(SerializedChunk) != 0) {
+    return -1;
+  }
+  chunks_out->clear();
+  for (size_t pos = 1; pos < blob.size; pos += sizeof(SerializedChunk)) {
+    SerializedChunk serialized;
+    memcpy(&serialized, data + pos, sizeof(serialized));
+    if (serialized.first_log > serialized.last_log ||
+        (!chunks_out->empty() &&
+         logid_t(serialized.first_log) <= chunks_out->back().last_log)) {
+      return -1;
+    }
+    chunks_out->push_back(SnapshotChunk{logid_t(serialized.first_log),
+                                        logid_t(serialized.last_log),
+                                        serialized.bytes});
+  }
+  return 0;
+}
+
+int readChunkIndex(LocalLogStore& store,
+                   std::vector<SnapshotChunk>* chunks_out) {
+  ld_check(chunks_out);
+  chunks_out->clear();
+  int rv = store.readAllLogSnapshotBlobs(
+      LocalLogStore::LogSnapshotBlobType::RECORD_CACHE_INDEX,
+      [&](logid_t log_id, Slice blob) {
+        if (log_id != LOGID_INVALID) {
+          return -1;
+        }
+        return deserializeChunkIndex(blob, chunks_out);
+      });
+  if (rv != 0) {
+    chunks_out->clear();
+  }
+  return rv;
+}
 }}} // namespace facebook::logdevice::RecordCachePersistence
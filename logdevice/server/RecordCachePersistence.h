@@ -7,23 +7,61 @@
  */
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include "logdevice/common/types_internal.h"
 
 namespace facebook { namespace logdevice {
 
+class LocalLogStore;
 class StorageThreadPool;
 
 /**
  * @file  A function for persisting record caches for all logs stored
  *        on a particular shard. Called at the very end of shutting down storage
  *        threads, from the last thread to be shut down.
+ *
+ *        Record caches are written in order of log ID, in chunks of about
+ *        10MiB, each covering a range of logs. The list of chunks is
+ *        written last, in a RECORD_CACHE_INDEX blob, so that
+ *        RecordCacheRepopulationTask can read the chunks in parallel on
+ *        several storage threads. Snapshots without an index (e.g. if writing
+ *        it failed) are read as one chunk.
  */
 
 namespace RecordCachePersistence {
 
+struct SnapshotChunk {
+  // Record caches of logs in [first_log, last_log] were written together.
+  logid_t first_log;
+  logid_t last_log;
+  // Total size of their blobs.
+  uint64_t bytes;
+
+  bool operator==(const SnapshotChunk& other) const {
+    return first_log == other.first_log && last_log == other.last_log &&
+        bytes == other.bytes;
+  }
+};
+
 void persistRecordCaches(shard_index_t, StorageThreadPool*);
-}
+
+std::string serializeChunkIndex(const std::vector<SnapshotChunk>& chunks);
+
+/**
+ * @return  0 on success, -1 if `blob` isn't a valid chunk index
+ */
+int deserializeChunkIndex(Slice blob, std::vector<SnapshotChunk>* chunks_out);
+
+/**
+ * Reads the chunk index of the record cache snapshot in `store`.
+ *
+ * @return  0 on success, with `chunks_out` empty if the snapshot has no
+ *          index; -1 if the index couldn't be read or is malformed
+ */
+int readChunkIndex(LocalLogStore& store,
+                   std::vector<SnapshotChunk>* chunks_out);
+} // namespace RecordCachePersistence
 
 }} // namespace facebook::logdevice
@@ -290,6 +290,12 @@ int RecordRebuildingBase::sendStore(StageRecipients::Type type,
           owner_->getLogID().val_,
           lsn_to_string(lsn_).c_str(),
           recipient.shard_.toString().c_str());
+  if (!amend &&
+      owner_->enqueueStoreForBatch(
+          message, recipient.shard_, recipient.on_socket_close)) {
+    ld_check(recipient.isStoreInFlight());
+    return 0;
+  }
   int rv = sender_->sendMessage(std::move(message),
                                 recipient.shard_.asNodeID(),
                                 &recipient.on_bw_avail,
@@ -39,6 +39,7 @@
 namespace facebook { namespace logdevice {
 
 class CopySetSelector;
+class STORE_Message;
 struct RebuildingSet;
 
 using NodeIndexServerInstancePair = std::pair<node_index_t, ServerInstanceId>;
@@ -150,6 +151,22 @@ class RecordRebuildingOwner {
   virtual void
   onAllAmendsReceived(lsn_t lsn,
                       std::unique_ptr<FlushTokenMap> flushTokenMap) = 0;
+
+  /**
+   * Lets the owner send a STORE (not an amend) together with the STOREs of
+   * its other records to the same node, in a STORES message. If it takes
+   * `msg`, the owner also registers `onclose` with the socket to `to`, as
+   * sendMessage() would, and the outcome of sending is reported through
+   * onStoreSent() as usual.
+   *
+   * @return true if `msg` was queued and moved from, false if the caller
+   *         should send it itself.
+   */
+  virtual bool enqueueStoreForBatch(std::unique_ptr<STORE_Message>& /*msg*/,
+                                    ShardID /*to*/,
+                                    SocketCallback& /*onclose*/) {
+    return false;
+  }
 };
 
 class RecordRebuildingBase : public RecordRebuildingInterface {
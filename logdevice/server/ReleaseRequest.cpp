@@ -16,24 +16,68 @@
 namespace facebook { namespace logdevice {
 
 Request::Execution ReleaseRequest::execute() {
-  ld_spew("ReleaseRequest(%s) running on worker %s for shard %u",
-          rid_.toString().c_str(),
-          Worker::onThisThread()->getName().c_str(),
-          shard_);
-  ServerWorker::onThisThread()->serverReadStreams().onRelease(
-      rid_, shard_, force_);
+  AllServerReadStreams& streams =
+      ServerWorker::onThisThread()->serverReadStreams();
+  for (const Release& release : releases_) {
+    ld_spew("ReleaseRequest(%s) running on worker %s for shard %u",
+            release.rid.toString().c_str(),
+            Worker::onThisThread()->getName().c_str(),
+            release.shard);
+    streams.onRelease(release.rid, release.shard, release.force);
+  }
   return Execution::COMPLETE;
 }
 
+thread_local ReleaseRequest::Batch* ReleaseRequest::Batch::current_ = nullptr;
+
+ReleaseRequest::Batch::Batch() {
+  // Batches don't nest.
+  ld_check(current_ == nullptr);
+  current_ = this;
+}
+
+ReleaseRequest::Batch::~Batch() {
+  ld_check(current_ == this);
+  current_ = nullptr;
+  for (auto& kv : releases_) {
+    const WorkerType type = kv.first.first;
+    const worker_id_t idx(kv.first.second);
+    auto release_req =
+        std::make_unique<ReleaseRequest>(idx, type, std::move(kv.second));
+    const ReleaseRequest* releases = release_req.get();
+    std::unique_ptr<Request> req = std::move(release_req);
+    if (processor_->postRequest(req) != 0) {
+      // On failure we still own `req`.
+      RATELIMIT_ERROR(std::chrono::seconds(10),
+                      5,
+                      "Could not propagate %zu RELEASEs to worker %c%d.  "
+                      "postRequest() failed with error %s",
+                      releases->releases_.size(),
+                      workerTypeChar(type),
+                      idx.val_,
+                      error_description(err));
+      for (const Release& release : releases->releases_) {
+        retry(processor_,
+              release.rid.logid,
+              release.shard,
+              idx,
+              type,
+              release.force);
+      }
+    }
+  }
+}
+
 void ReleaseRequest::retry(ServerProcessor* processor,
                            logid_t log_id,
                            shard_index_t shard,
                            worker_id_t idx,
+                           WorkerType worker_type,
                            bool force) {
   // We expect a LogStorageState instance to exist if we're releasing.
   processor->getLogStorageStateMap()
       .get(log_id, shard)
-      .retryRelease(idx, force);
+      .retryRelease(idx, worker_type, force);
 }
 
 }} // namespace facebook::logdevice
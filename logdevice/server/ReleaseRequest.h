@@ -7,6 +7,12 @@
  */
 #pragma once
 
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <folly/small_vector.h>
+
 #include "logdevice/common/RecordID.h"
 #include "logdevice/common/Request.h"
 #include "logdevice/common/RequestType.h"
@@ -26,12 +32,22 @@ enum class ReleaseType : uint8_t;
  *
  * The worker receiving this request reads the new record from the local log
  * store and sends it to clients reading from the log.
+ *
+ * When processing a RELEASES message, the releases of all its logs that go
+ * to the same worker are put in one request (see ReleaseRequest::Batch).
  */
 
 class ReleaseRequest : public Request {
  public:
+  struct Release {
+    RecordID rid;
+    shard_index_t shard;
+    bool force;
+  };
+
   /**
    * @param target        worker thread that should process this request
+   * @param worker_type   pool of the target worker, GENERAL or READ
    * @param rid           record that was released
    * @param force         if set, worker will attempt to read more data even if
    *                      rid was already delivered; this is used when last
@@ -39,14 +55,51 @@ class ReleaseRequest : public Request {
    *                      AllServerReadStreams::onRelease)
    */
   explicit ReleaseRequest(worker_id_t target,
+                          WorkerType worker_type,
                           RecordID rid,
                           shard_index_t shard,
                           bool force)
       : Request(RequestType::RELEASE),
         target_(target),
-        rid_(rid),
-        shard_(shard),
-        force_(force) {}
+        worker_type_(worker_type),
+        releases_({Release{rid, shard, force}}) {}
+
+  /**
+   * Notifies the target worker of several releases, in order.
+   */
+  ReleaseRequest(worker_id_t target,
+                 WorkerType worker_type,
+                 folly::small_vector<Release, 1> releases)
+      : Request(RequestType::RELEASE),
+        target_(target),
+        worker_type_(worker_type),
+        releases_(std::move(releases)) {}
+
+  /**
+   * While a Batch exists on a worker thread, broadcastReleaseRequest() called
+   * on that thread collects the releases for each target worker instead of
+   * posting a ReleaseRequest for every one of them. The destructor posts one
+   * ReleaseRequest per worker with all the releases collected for it.
+   */
+  class Batch {
+   public:
+    Batch();
+    ~Batch();
+
+    Batch(const Batch&) = delete;
+    Batch& operator=(const Batch&) = delete;
+
+   private:
+    friend class ReleaseRequest;
+
+    // The Batch of this thread, if any.
+    static thread_local Batch* current_;
+
+    ServerProcessor* processor_{nullptr};
+    std::map<std::pair<WorkerType, worker_id_t::raw_type>,
+             folly::small_vector<Release, 1>>
+        releases_;
+  };
 
   int getThreadAffinity(int /*nthreads*/) override {
     // ReleaseRequest gets targeted at a specific worker.  Multiple instances
@@ -54,16 +107,22 @@ class ReleaseRequest : public Request {
     return target_.val_;
   }
 
+  WorkerType getWorkerTypeAffinity() override {
+    return worker_type_;
+  }
+
   Request::Execution execute() override;
 
   /**
-   * A helper function to post a new ReleaseRequest on all workers for
-   * which filter functor returns true.
+   * A helper function to post a new ReleaseRequest on all workers that may
+   * have read streams (GENERAL and READ) for which filter functor returns
+   * true.
    *
    * @param processor     Processor object used to post a new request
    * @param rid           record part of the ReleaseRequest
-   * @param filter        function worker_id_t -> bool used to determine to
-   *                      which worker threads to send the request to
+   * @param filter        function (worker_id_t, WorkerType) -> bool used to
+   *                      determine to which worker threads to send the
+   *                      request to
    * @param force         see ReleaseRequest constructor
    */
   template <typename Func>
@@ -72,38 +131,49 @@ class ReleaseRequest : public Request {
                                       shard_index_t shard,
                                       Func&& filter,
                                       bool force = false) {
+    auto post = [&](worker_id_t idx, WorkerType type) {
+      if (!filter(idx, type)) {
+        return;
+      }
+      if (Batch::current_ != nullptr) {
+        Batch::current_->processor_ = processor;
+        Batch::current_->releases_[std::make_pair(type, idx.val_)].push_back(
+            Release{rid, shard, force});
+        return;
+      }
+
+      std::unique_ptr<Request> req =
+          std::make_unique<ReleaseRequest>(idx, type, rid, shard, force);
+      if (processor->postRequest(req) != 0) {
+        RATELIMIT_ERROR(std::chrono::seconds(10),
+                        5,
+                        "Could not propagate RELEASE %s to worker %c%d.  "
+                        "postRequest() failed "
+                        "with error %s",
+                        rid.toString().c_str(),
+                        workerTypeChar(type),
+                        idx.val_,
+                        error_description(err));
+        retry(processor, rid.logid, shard, idx, type, force);
+      }
+    };
+    processor->applyToWorkerIdxs(
+        post, Processor::Order::FORWARD, WorkerType::GENERAL);
     processor->applyToWorkerIdxs(
-        [&](worker_id_t idx, WorkerType /*unused*/) {
-          if (!filter(idx)) {
-            return;
-          }
-
-          std::unique_ptr<Request> req =
-              std::make_unique<ReleaseRequest>(idx, rid, shard, force);
-          if (processor->postRequest(req) != 0) {
-            RATELIMIT_ERROR(std::chrono::seconds(10),
-                            5,
-                            "Could not propagate RELEASE %s to worker #%d.  "
-                            "postRequest() failed "
-                            "with error %s",
-                            rid.toString().c_str(),
-                            idx.val_,
-                            error_description(err));
-            retry(processor, rid.logid, shard, idx, force);
-          }
-        },
-        Processor::Order::FORWARD,
-        WorkerType::GENERAL);
+        post, Processor::Order::FORWARD, WorkerType::READ);
   }
 
-  static void
-  retry(ServerProcessor*, logid_t, shard_index_t, worker_id_t, bool force);
+  static void retry(ServerProcessor*,
+                    logid_t,
+                    shard_index_t,
+                    worker_id_t,
+                    WorkerType,
+                    bool force);
 
  private:
   worker_id_t target_;
-  RecordID rid_;
-  shard_index_t shard_;
-  bool force_;
+  WorkerType worker_type_;
+  folly::small_vector<Release, 1> releases_;
 };
 
 }} // namespace facebook::logdevice
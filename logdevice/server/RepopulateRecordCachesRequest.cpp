@@ -25,12 +25,67 @@ RepopulateRecordCachesRequest::RepopulateRecordCachesRequest(
       ref_holder_(this),
       repopulate_record_caches_(repopulate_record_caches) {}
 
-void RepopulateRecordCachesRequest::onRepopulationTaskDone(
+void RepopulateRecordCachesRequest::putTask(
+    shard_index_t shard_idx,
+    std::unique_ptr<StorageTask> task) const {
+  ServerWorker::onThisThread()
+      ->getStorageTaskQueueForShard(shard_idx)
+      ->putTask(std::move(task));
+}
+
+void RepopulateRecordCachesRequest::onIndexRead(
+    shard_index_t shard_idx,
+    std::vector<RecordCachePersistence::SnapshotChunk> chunks) {
+  ld_check(shard_idx < shards_.size());
+  ld_check(!chunks.empty());
+  ShardState& state = shards_[shard_idx];
+  state.remaining_chunks = chunks.size();
+  state.repopulated_bytes = std::make_shared<std::atomic<size_t>>(0);
+  for (const auto& chunk : chunks) {
+    putTask(shard_idx,
+            std::make_unique<RecordCacheRepopulationTask>(
+                shard_idx,
+                ref_holder_.ref(),
+                RecordCacheRepopulationTask::Stage::REPOPULATE,
+                chunk.first_log,
+                chunk.last_log,
+                state.repopulated_bytes));
+  }
+}
+
+void RepopulateRecordCachesRequest::onChunkRepopulated(
+    Status status,
+    shard_index_t shard_idx) {
+  ld_check(shard_idx < shards_.size());
+  ld_check(status == E::OK || status == E::PARTIAL);
+  ShardState& state = shards_[shard_idx];
+  ld_check(state.remaining_chunks > 0);
+  state.partial |= status == E::PARTIAL;
+  if (--state.remaining_chunks > 0) {
+    return;
+  }
+
+  ld_info("Repopulated record caches on shard %d, totaling %ju bytes%s.",
+          shard_idx,
+          state.repopulated_bytes->load(),
+          state.partial ? " (partially)" : "");
+  putTask(shard_idx,
+          std::make_unique<RecordCacheRepopulationTask>(
+              shard_idx,
+              ref_holder_.ref(),
+              RecordCacheRepopulationTask::Stage::DELETE));
+}
+
+void RepopulateRecordCachesRequest::onSnapshotsDeleted(
     Status status,
     shard_index_t shard_idx) {
   ld_check(remaining_record_cache_repopulations_ > 0);
-  ld_check(status == E::OK || status == E::PARTIAL || status == E::FAILED);
+  ld_check(shard_idx < shards_.size());
+  ld_check(status == E::OK || status == E::FAILED);
 
+  if (status == E::OK && shards_[shard_idx].partial) {
+    status = E::PARTIAL;
+  }
   callback_(status, shard_idx);
   remaining_record_cache_repopulations_--;
   if (remaining_record_cache_repopulations_ == 0) {
@@ -48,6 +103,7 @@ Request::Execution RepopulateRecordCachesRequest::execute() {
   // Start a StorageTask for each shard
   const shard_size_t num_shards = sharded_pool->numShards();
   remaining_record_cache_repopulations_ = num_shards;
+  shards_.resize(num_shards);
 
   if (!repopulate_record_caches_) {
     ld_info("Not repopulating caches"); // just dropping snapshots col. family
@@ -64,9 +120,13 @@ Request::Execution RepopulateRecordCachesRequest::execute() {
       continue;
     }
 
-    auto task = std::unique_ptr<StorageTask>(new RecordCacheRepopulationTask(
-        shard_idx, ref_holder_.ref(), repopulate_record_caches_));
-    w->getStorageTaskQueueForShard(shard_idx)->putTask(std::move(task));
+    putTask(shard_idx,
+            std::make_unique<RecordCacheRepopulationTask>(
+                shard_idx,
+                ref_holder_.ref(),
+                repopulate_record_caches_
+                    ? RecordCacheRepopulationTask::Stage::READ_INDEX
+                    : RecordCacheRepopulationTask::Stage::DELETE));
   }
 
   // We're done if there are no enabled shards
@@ -7,16 +7,28 @@
  */
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include "logdevice/common/Request.h"
 #include "logdevice/common/WeakRefHolder.h"
+#include "logdevice/server/RecordCachePersistence.h"
 
 namespace facebook { namespace logdevice {
 
+class StorageTask;
+
 /**
  * @file  A request to repopulate the record caches from stable storage.
  *        Regardless of success or failure, any persistent cache data is
  *        destroyed so we have a clean slate for persisting record cache data
  *        on the next shutdown.
+ *
+ *        For each shard, a RecordCacheRepopulationTask first reads the index
+ *        of snapshot chunks, then one task per chunk repopulates the caches
+ *        of the chunk's logs (these run in parallel on the slow storage
+ *        threads of the shard), and finally a task deletes the snapshot.
  */
 class RepopulateRecordCachesRequest : public Request {
  public:
@@ -31,13 +43,31 @@ class RepopulateRecordCachesRequest : public Request {
 
   Execution execute() override;
 
-  // called by each RecordCacheRepopulationTask when it is done executing
-  void onRepopulationTaskDone(Status status, shard_index_t shard_idx);
+  // called by RecordCacheRepopulationTasks of each stage when they are done
+  // executing
+  void onIndexRead(shard_index_t shard_idx,
+                   std::vector<RecordCachePersistence::SnapshotChunk> chunks);
+  void onChunkRepopulated(Status status, shard_index_t shard_idx);
+  void onSnapshotsDeleted(Status status, shard_index_t shard_idx);
 
  private:
-  // count of remaining RecordCache repopulation tasks
+  struct ShardState {
+    // count of chunks not repopulated yet
+    size_t remaining_chunks{0};
+    // true if some chunk could only be partially repopulated
+    bool partial{false};
+    // bytes repopulated so far by all chunks
+    std::shared_ptr<std::atomic<size_t>> repopulated_bytes;
+  };
+
+  void putTask(shard_index_t shard_idx,
+               std::unique_ptr<StorageTask> task) const;
+
+  // count of shards whose snapshot is not deleted yet
   int remaining_record_cache_repopulations_;
 
+  std::vector<ShardState> shards_;
+
   /**
    * Callback function to notify caller of status from each shard. Possible
    * outcomes:
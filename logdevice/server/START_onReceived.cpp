@@ -367,6 +367,8 @@ onReceivedContinuation(START_Message* msg,
               // consider this as a cache miss, and fallback to reading
               // from local log store
               WORKER_STAT_INCR(record_cache_digest_miss);
+              PER_SHARD_STAT_INCR(
+                  Worker::stats(), record_cache_digest_miss, shard_idx);
               if (!MetaDataLog::isMetaDataLog(header.log_id)) {
                 WORKER_STAT_INCR(record_cache_digest_miss_datalog);
               }
@@ -376,7 +378,12 @@ onReceivedContinuation(START_Message* msg,
 
           // cache hit, proceed to serving the digest from the epoch
           // record cache snapshot
+          if (result.second != nullptr) {
+            cache->onDigestServed(lsn_to_epoch(header.start_lsn));
+          }
           WORKER_STAT_INCR(record_cache_digest_hit);
+          PER_SHARD_STAT_INCR(
+              Worker::stats(), record_cache_digest_hit, shard_idx);
           if (!MetaDataLog::isMetaDataLog(header.log_id)) {
             WORKER_STAT_INCR(record_cache_digest_hit_datalog);
           }
@@ -395,6 +402,8 @@ onReceivedContinuation(START_Message* msg,
         }
         case RecordCache::Result::MISS:
           WORKER_STAT_INCR(record_cache_digest_miss);
+          PER_SHARD_STAT_INCR(
+              Worker::stats(), record_cache_digest_miss, shard_idx);
           if (!MetaDataLog::isMetaDataLog(header.log_id)) {
             WORKER_STAT_INCR(record_cache_digest_miss_datalog);
           }
@@ -502,6 +511,8 @@ onReceivedContinuation(START_Message* msg,
   stream->include_byte_offset_ =
       (header.flags & START_Header::INCLUDE_BYTE_OFFSET) &&
       Worker::settings().byte_offsets;
+  stream->accepts_compressed_records_ =
+      w->sender().acceptsCompressedRecords(from.id_.client_);
 
   if (stream->digest_ || stream->no_payload_) {
     stream->setTrafficClass(TrafficClass::RECOVERY);
@@ -567,4 +578,19 @@ onReceivedContinuation(START_Message* msg,
   return Message::Disposition::NORMAL;
 }
 
+Message::Disposition STARTS_onReceived(STARTS_Message* msg,
+                                       const Address& from) {
+  WORKER_STAT_INCR(starts_batch_messages_received);
+  for (auto& start : msg->starts_) {
+    Message::Disposition disp = START_onReceived(start.get(), from);
+    if (disp == Message::Disposition::KEEP) {
+      // the permission check callback took ownership
+      start.release();
+    } else if (disp == Message::Disposition::ERROR) {
+      return disp;
+    }
+  }
+  return Message::Disposition::NORMAL;
+}
+
 }} // namespace facebook::logdevice
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/STARTS_Message.h"
 #include "logdevice/common/protocol/START_Message.h"
 
 namespace facebook { namespace logdevice {
@@ -15,4 +16,8 @@ namespace facebook { namespace logdevice {
 struct Address;
 
 Message::Disposition START_onReceived(START_Message* msg, const Address& from);
+
+// Handles every START of the batch as if it had been received on its own.
+Message::Disposition STARTS_onReceived(STARTS_Message* msg,
+                                       const Address& from);
 }} // namespace facebook::logdevice
@@ -0,0 +1,31 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "STORES_onSent.h"
+
+#include "logdevice/common/Worker.h"
+#include "logdevice/server/STORE_onSent.h"
+
+namespace facebook { namespace logdevice {
+
+void STORES_onSent(const STORES_Message& msg,
+                   Status st,
+                   const Address& to,
+                   const SteadyTimestamp enqueue_time) {
+  if (st == E::OK) {
+    WORKER_STAT_INCR(stores_batch_messages_sent);
+    WORKER_STAT_ADD(stores_batched, msg.stores_.size());
+  }
+
+  // Complete every STORE as if it had been sent in its own message, so that
+  // Appenders see the same outcome either way.
+  for (const auto& store : msg.stores_) {
+    STORE_onSent(*store, st, to, enqueue_time);
+  }
+}
+
+}} // namespace facebook::logdevice
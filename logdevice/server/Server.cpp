@@ -7,6 +7,9 @@
  */
 #include "Server.h"
 
+#include <algorithm>
+
+#include "logdevice/common/AsyncTraceLogger.h"
 #include "logdevice/common/ConfigInit.h"
 #include "logdevice/common/ConstructorFailed.h"
 #include "logdevice/common/CopySetManager.h"
@@ -43,6 +46,7 @@
 #include "logdevice/server/ServerPluginPack.h"
 #include "logdevice/server/ServerProcessor.h"
 #include "logdevice/server/UnreleasedRecordDetector.h"
+#include "logdevice/server/WarmUpLogStorageStateRequest.h"
 #include "logdevice/server/fatalsignal.h"
 #include "logdevice/server/locallogstore/ClusterMarkerChecker.h"
 #include "logdevice/server/locallogstore/ShardedRocksDBLocalLogStore.h"
@@ -317,6 +321,13 @@ ServerParameters::ServerParameters(
     trace_logger_ = std::make_shared<NoopTraceLogger>(updateable_config_);
   } else {
     trace_logger_ = (*trace_logger_factory)(updateable_config_);
+    if (processor_settings_->trace_logger_queue_size > 0) {
+      trace_logger_ = std::make_shared<AsyncTraceLogger>(
+          updateable_config_,
+          std::move(trace_logger_),
+          processor_settings_->trace_logger_queue_size,
+          getStats());
+    }
   }
 
   storage_node_ = this_node->hasRole(Configuration::NodeRole::STORAGE);
@@ -419,10 +430,11 @@ Server::Server(ServerParameters* params, std::function<void()> stop_handler)
   start_time_ = std::chrono::system_clock::now();
 
   if (!(initListeners() && initStore() && initProcessor() &&
-        repopulateRecordCaches() && initSequencers() && initFailureDetector() &&
-        initSequencerPlacement() && initRebuildingCoordinator() &&
-        initLogStoreMonitor() && initUnreleasedRecordDetector() &&
-        initLogsConfigManager() && initSettingsSubscriber())) {
+        repopulateRecordCaches() && warmUpLogStorageState() &&
+        initSequencers() && initFailureDetector() && initSequencerPlacement() &&
+        initRebuildingCoordinator() && initLogStoreMonitor() &&
+        initUnreleasedRecordDetector() && initLogsConfigManager() &&
+        initSettingsSubscriber())) {
     _exit(EXIT_FAILURE);
   }
 }
@@ -456,12 +468,20 @@ bool Server::initListeners() {
   try {
     auto conn_shared_state =
         std::make_shared<ConnectionListener::SharedState>();
-    connection_listener_handle_ = initListener<ConnectionListener>(
-        server_settings_->port,
-        server_settings_->unix_socket,
-        false,
-        conn_shared_state,
-        ConnectionListener::ListenerType::DATA);
+    // SO_REUSEPORT doesn't apply to unix sockets.
+    const int num_connection_listeners = server_settings_->unix_socket.empty()
+        ? server_settings_->num_connection_listeners
+        : 1;
+    for (int i = 0; i < num_connection_listeners; ++i) {
+      connection_listener_handles_.push_back(initListener<ConnectionListener>(
+          server_settings_->port,
+          server_settings_->unix_socket,
+          false,
+          conn_shared_state,
+          ConnectionListener::ListenerType::DATA,
+          i,
+          num_connection_listeners));
+    }
     command_listener_handle_ =
         initListener<CommandListener>(server_settings_->command_port,
                                       server_settings_->command_unix_socket,
@@ -507,12 +527,21 @@ bool Server::initListeners() {
           // validateSSLCertificatesExist() should output the error
           return false;
         }
-        ssl_connection_listener_handle_ = initListener<ConnectionListener>(
-            ssl_port,
-            ssl_unix_socket,
-            true,
-            conn_shared_state,
-            ConnectionListener::ListenerType::DATA_SSL);
+        const int num_ssl_listeners = ssl_unix_socket.empty()
+            ? std::max(params_->getProcessorSettings()->ssl_handshake_threads,
+                       1)
+            : 1;
+        for (int i = 0; i < num_ssl_listeners; ++i) {
+          ssl_connection_listener_handles_.push_back(
+              initListener<ConnectionListener>(
+                  ssl_port,
+                  ssl_unix_socket,
+                  true,
+                  conn_shared_state,
+                  ConnectionListener::ListenerType::DATA_SSL,
+                  i,
+                  num_ssl_listeners));
+        }
       }
     }
 
@@ -711,6 +740,42 @@ bool Server::repopulateRecordCaches() {
   return true;
 }
 
+bool Server::warmUpLogStorageState() {
+  if (!params_->isReadableStorageNode() ||
+      !params_->getProcessorSettings()->warm_up_log_storage_state) {
+    return true;
+  }
+
+  auto start_time = std::chrono::steady_clock::now();
+  std::vector<shard_index_t> partial_shards;
+  auto callback = [&partial_shards](Status status, shard_index_t shard_idx) {
+    if (status == E::PARTIAL) {
+      partial_shards.push_back(shard_idx);
+    }
+  };
+
+  std::unique_ptr<Request> req =
+      std::make_unique<WarmUpLogStorageStateRequest>(callback);
+  if (processor_->blockingRequest(req) != 0) {
+    ld_error("Failed to make a blocking request to warm up log storage "
+             "state: %s. Log state will be recovered lazily.",
+             error_name(err));
+    return true;
+  }
+
+  if (!partial_shards.empty()) {
+    // Not fatal: the missing state is recovered lazily, log by log.
+    ld_warning("Failed to read some log metadata while warming up log "
+               "storage state on shards [%s]",
+               folly::join(", ", partial_shards).c_str());
+  }
+  ld_info("Warmed up log storage state in %.3fs",
+          std::chrono::duration_cast<std::chrono::duration<double>>(
+              std::chrono::steady_clock::now() - start_time)
+              .count());
+  return true;
+}
+
 bool Server::initSequencers() {
   // Create an instance of EpochStore.
   std::unique_ptr<EpochStore> epoch_store;
@@ -926,8 +991,10 @@ bool Server::initSettingsSubscriber() {
 
 bool Server::startListening() {
   // start accepting new connections
-  if (!startConnectionListener(connection_listener_handle_)) {
-    return false;
+  for (auto& handle : connection_listener_handles_) {
+    if (!startConnectionListener(handle)) {
+      return false;
+    }
   }
 
   if (gossip_listener_handle_ &&
@@ -935,9 +1002,10 @@ bool Server::startListening() {
     return false;
   }
 
-  if (ssl_connection_listener_handle_ &&
-      !startConnectionListener(ssl_connection_listener_handle_)) {
-    return false;
+  for (auto& handle : ssl_connection_listener_handles_) {
+    if (handle && !startConnectionListener(handle)) {
+      return false;
+    }
   }
 
   // start command listener last, so that integration test framework
@@ -963,10 +1031,10 @@ void Server::gracefulShutdown() {
     return;
   }
   shutdown_server(admin_server_handle_,
-                  connection_listener_handle_,
+                  connection_listener_handles_,
                   command_listener_handle_,
                   gossip_listener_handle_,
-                  ssl_connection_listener_handle_,
+                  ssl_connection_listener_handles_,
                   logstore_monitor_,
                   processor_,
                   sharded_storage_thread_pool_,
@@ -9,6 +9,7 @@
 
 #include <atomic>
 #include <memory>
+#include <vector>
 
 #include "logdevice/common/EventLoopHandle.h"
 #include "logdevice/common/PermissionChecker.h"
@@ -200,10 +201,12 @@ class Server {
 
   // For tests, to help simulate various forms of network partition.
   void acceptNewConnections(bool accept) {
-    checked_downcast<Listener*>(connection_listener_handle_->get())
-        ->acceptNewConnections(accept);
-    checked_downcast<Listener*>(ssl_connection_listener_handle_->get())
-        ->acceptNewConnections(accept);
+    for (auto& handle : connection_listener_handles_) {
+      checked_downcast<Listener*>(handle->get())->acceptNewConnections(accept);
+    }
+    for (auto& handle : ssl_connection_listener_handles_) {
+      checked_downcast<Listener*>(handle->get())->acceptNewConnections(accept);
+    }
   }
 
   void rotateLocalLogs();
@@ -220,8 +223,11 @@ class Server {
   std::shared_ptr<SettingsUpdater> settings_updater_;
 
   // initListeners()
-  std::unique_ptr<EventLoopHandle> connection_listener_handle_;
-  std::unique_ptr<EventLoopHandle> ssl_connection_listener_handle_;
+  // One per --num-connection-listeners.
+  std::vector<std::unique_ptr<EventLoopHandle>> connection_listener_handles_;
+  // One per --ssl-handshake-threads, at least one if there's an SSL port.
+  std::vector<std::unique_ptr<EventLoopHandle>>
+      ssl_connection_listener_handles_;
   std::unique_ptr<EventLoopHandle> command_listener_handle_;
   std::unique_ptr<EventLoopHandle> gossip_listener_handle_;
   std::unique_ptr<AdminServer> admin_server_handle_;
@@ -262,6 +268,7 @@ class Server {
   bool initStore();
   bool initProcessor();
   bool repopulateRecordCaches();
+  bool warmUpLogStorageState();
   bool initSequencers();
   bool initLogStoreMonitor();
   bool initFailureDetector();
@@ -7,10 +7,14 @@
  */
 #include "ServerMessageDispatch.h"
 
+#include <array>
+#include <limits>
+
 #include "logdevice/common/GetEpochRecoveryMetadataRequest.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/protocol/CLEAN_Message.h"
 #include "logdevice/common/protocol/MessageTypeNames.h"
+#include "logdevice/common/protocol/RELEASES_Message.h"
 #include "logdevice/common/protocol/RELEASE_Message.h"
 #include "logdevice/common/protocol/STOP_Message.h"
 #include "logdevice/common/protocol/STORE_Message.h"
@@ -31,12 +35,14 @@
 #include "logdevice/server/GOSSIP_onSent.h"
 #include "logdevice/server/IS_LOG_EMPTY_onReceived.h"
 #include "logdevice/server/MEMTABLE_FLUSHED_onReceived.h"
+#include "logdevice/server/RECORDS_onSent.h"
 #include "logdevice/server/RECORD_onSent.h"
 #include "logdevice/server/SEAL_onReceived.h"
 #include "logdevice/server/STARTED_onSent.h"
 #include "logdevice/server/START_onReceived.h"
 #include "logdevice/server/STOP_onReceived.h"
 #include "logdevice/server/STORED_onReceived.h"
+#include "logdevice/server/STORES_onSent.h"
 #include "logdevice/server/STORE_onSent.h"
 #include "logdevice/server/ServerWorker.h"
 #include "logdevice/server/StoreStateMachine.h"
@@ -50,113 +56,114 @@
 
 namespace facebook { namespace logdevice {
 
-Message::Disposition
-ServerMessageDispatch::onReceivedImpl(Message* msg, const Address& from) {
-  switch (msg->type_) {
-    case MessageType::CHECK_NODE_HEALTH:
-      return CHECK_NODE_HEALTH_onReceived(
-          checked_downcast<CHECK_NODE_HEALTH_Message*>(msg), from);
-
-    case MessageType::CHECK_SEAL:
-      return CHECK_SEAL_onReceived(
-          checked_downcast<CHECK_SEAL_Message*>(msg), from);
-
-    case MessageType::CLEAN:
-      return PurgeCoordinator::onReceived(
-          checked_downcast<CLEAN_Message*>(msg), from);
-
-    case MessageType::DATA_SIZE:
-      return DATA_SIZE_onReceived(
-          checked_downcast<DATA_SIZE_Message*>(msg), from);
-
-    case MessageType::DELETE:
-      return DELETE_onReceived(checked_downcast<DELETE_Message*>(msg), from);
-
-    case MessageType::DELETE_LOG_METADATA:
-      return DELETE_LOG_METADATA_onReceived(
-          checked_downcast<DELETE_LOG_METADATA_Message*>(msg), from);
-
-    case MessageType::FINDKEY:
-      return FINDKEY_onReceived(checked_downcast<FINDKEY_Message*>(msg), from);
-
-    case MessageType::GET_EPOCH_RECOVERY_METADATA:
-      return GET_EPOCH_RECOVERY_METADATA_onReceived(
-          checked_downcast<GET_EPOCH_RECOVERY_METADATA_Message*>(msg), from);
-
-    case MessageType::GET_EPOCH_RECOVERY_METADATA_REPLY:
-      return GET_EPOCH_RECOVERY_METADATA_REPLY_onReceived(
-          checked_downcast<GET_EPOCH_RECOVERY_METADATA_REPLY_Message*>(msg),
-          from);
-
-    case MessageType::GET_HEAD_ATTRIBUTES:
-      return GET_HEAD_ATTRIBUTES_onReceived(
-          checked_downcast<GET_HEAD_ATTRIBUTES_Message*>(msg), from);
-
-    case MessageType::GET_TRIM_POINT:
-      return GET_TRIM_POINT_onReceived(
-          checked_downcast<GET_TRIM_POINT_Message*>(msg), from);
-
-    case MessageType::GOSSIP:
-      return GOSSIP_onReceived(checked_downcast<GOSSIP_Message*>(msg), from);
-
-    case MessageType::IS_LOG_EMPTY:
-      return IS_LOG_EMPTY_onReceived(
-          checked_downcast<IS_LOG_EMPTY_Message*>(msg), from);
+namespace {
 
-    case MessageType::MEMTABLE_FLUSHED:
-      return MEMTABLE_FLUSHED_onReceived(
-          checked_downcast<MEMTABLE_FLUSHED_Message*>(msg), from);
+using Handler = Message::Disposition (*)(Message*, const Address&);
 
-    case MessageType::NODE_STATS_AGGREGATE:
-      return NODE_STATS_AGGREGATE_onReceived(
-          checked_downcast<NODE_STATS_AGGREGATE_Message*>(msg), from);
-
-    case MessageType::NODE_STATS_AGGREGATE_REPLY:
-      return NODE_STATS_AGGREGATE_REPLY_onReceived(
-          checked_downcast<NODE_STATS_AGGREGATE_REPLY_Message*>(msg), from);
-
-    case MessageType::RELEASE:
-      return PurgeCoordinator::onReceived(
-          checked_downcast<RELEASE_Message*>(msg), from);
-
-    case MessageType::SEAL:
-      return SEAL_onReceived(checked_downcast<SEAL_Message*>(msg), from);
-
-    case MessageType::START:
-      return START_onReceived(checked_downcast<START_Message*>(msg), from);
-
-    case MessageType::STOP:
-      return STOP_onReceived(checked_downcast<STOP_Message*>(msg), from);
+// Handler for messages whose type is handled by OnReceived.
+template <typename MessageT,
+          Message::Disposition (*OnReceived)(MessageT*, const Address&)>
+Message::Disposition dispatch(Message* msg, const Address& from) {
+  return OnReceived(checked_downcast<MessageT*>(msg), from);
+}
 
-    case MessageType::STORE:
-      return StoreStateMachine::onReceived(
-          checked_downcast<STORE_Message*>(msg), from);
+Message::Disposition dispatchToMessage(Message* msg, const Address& from) {
+  // By default, call the Message's onReceived() implementation (for
+  // messages whose handler lives in common/ with the Message subclass)
+  return msg->onReceived(from);
+}
 
-    case MessageType::STORED:
-      return STORED_onReceived(checked_downcast<STORED_Message*>(msg), from);
+Message::Disposition rejectClientOnly(Message* msg, const Address&) {
+  RATELIMIT_ERROR(std::chrono::seconds(60),
+                  1,
+                  "ServerMessageDispatch::onReceived() called with %s message"
+                  "which is supposed to be client-only!",
+                  messageTypeNames[msg->type_].c_str());
+  err = E::PROTO;
+  return Message::Disposition::ERROR;
+}
 
-    case MessageType::TRIM:
-      return TRIM_onReceived(checked_downcast<TRIM_Message*>(msg), from);
+using HandlerTable =
+    std::array<Handler, std::numeric_limits<unsigned char>::max() + 1>;
+
+HandlerTable makeHandlerTable() {
+  HandlerTable handlers;
+  handlers.fill(&dispatchToMessage);
+  auto set = [&](MessageType type, Handler handler) {
+    handlers[static_cast<unsigned char>(type)] = handler;
+  };
+
+  set(MessageType::CHECK_NODE_HEALTH,
+      &dispatch<CHECK_NODE_HEALTH_Message, &CHECK_NODE_HEALTH_onReceived>);
+  set(MessageType::CHECK_SEAL,
+      &dispatch<CHECK_SEAL_Message, &CHECK_SEAL_onReceived>);
+  set(MessageType::CLEAN,
+      &dispatch<CLEAN_Message, &PurgeCoordinator::onReceived>);
+  set(MessageType::DATA_SIZE,
+      &dispatch<DATA_SIZE_Message, &DATA_SIZE_onReceived>);
+  set(MessageType::DATA_SIZE_BATCH,
+      &dispatch<DATA_SIZE_BATCH_Message, &DATA_SIZE_BATCH_onReceived>);
+  set(MessageType::DELETE, &dispatch<DELETE_Message, &DELETE_onReceived>);
+  set(MessageType::DELETE_LOG_METADATA,
+      &dispatch<DELETE_LOG_METADATA_Message, &DELETE_LOG_METADATA_onReceived>);
+  set(MessageType::FINDKEY, &dispatch<FINDKEY_Message, &FINDKEY_onReceived>);
+  set(MessageType::FINDKEY_BATCH,
+      &dispatch<FINDKEY_BATCH_Message, &FINDKEY_BATCH_onReceived>);
+  set(MessageType::GET_EPOCH_RECOVERY_METADATA,
+      &dispatch<GET_EPOCH_RECOVERY_METADATA_Message,
+                &GET_EPOCH_RECOVERY_METADATA_onReceived>);
+  set(MessageType::GET_EPOCH_RECOVERY_METADATA_REPLY,
+      &dispatch<GET_EPOCH_RECOVERY_METADATA_REPLY_Message,
+                &GET_EPOCH_RECOVERY_METADATA_REPLY_onReceived>);
+  set(MessageType::GET_HEAD_ATTRIBUTES,
+      &dispatch<GET_HEAD_ATTRIBUTES_Message, &GET_HEAD_ATTRIBUTES_onReceived>);
+  set(MessageType::GET_TRIM_POINT,
+      &dispatch<GET_TRIM_POINT_Message, &GET_TRIM_POINT_onReceived>);
+  set(MessageType::GOSSIP, &dispatch<GOSSIP_Message, &GOSSIP_onReceived>);
+  set(MessageType::IS_LOG_EMPTY,
+      &dispatch<IS_LOG_EMPTY_Message, &IS_LOG_EMPTY_onReceived>);
+  set(MessageType::IS_LOG_EMPTY_BATCH,
+      &dispatch<IS_LOG_EMPTY_BATCH_Message, &IS_LOG_EMPTY_BATCH_onReceived>);
+  set(MessageType::MEMTABLE_FLUSHED,
+      &dispatch<MEMTABLE_FLUSHED_Message, &MEMTABLE_FLUSHED_onReceived>);
+  set(MessageType::NODE_STATS_AGGREGATE,
+      &dispatch<NODE_STATS_AGGREGATE_Message,
+                &NODE_STATS_AGGREGATE_onReceived>);
+  set(MessageType::NODE_STATS_AGGREGATE_REPLY,
+      &dispatch<NODE_STATS_AGGREGATE_REPLY_Message,
+                &NODE_STATS_AGGREGATE_REPLY_onReceived>);
+  set(MessageType::RELEASE,
+      &dispatch<RELEASE_Message, &PurgeCoordinator::onReceived>);
+  set(MessageType::RELEASES,
+      &dispatch<RELEASES_Message, &PurgeCoordinator::onReceived>);
+  set(MessageType::SEAL, &dispatch<SEAL_Message, &SEAL_onReceived>);
+  set(MessageType::START, &dispatch<START_Message, &START_onReceived>);
+  set(MessageType::STARTS, &dispatch<STARTS_Message, &STARTS_onReceived>);
+  set(MessageType::STOP, &dispatch<STOP_Message, &STOP_onReceived>);
+  set(MessageType::STORE,
+      &dispatch<STORE_Message, &StoreStateMachine::onReceived>);
+  set(MessageType::STORED, &dispatch<STORED_Message, &STORED_onReceived>);
+  set(MessageType::STORES,
+      &dispatch<STORES_Message, &StoreStateMachine::onReceived>);
+  set(MessageType::TRIM, &dispatch<TRIM_Message, &TRIM_onReceived>);
+  set(MessageType::WINDOW,
+      &dispatch<WINDOW_Message, &AllServerReadStreams::onWindowMessage>);
+  set(MessageType::WINDOWS,
+      &dispatch<WINDOWS_Message, &AllServerReadStreams::onWindowsMessage>);
+  set(MessageType::NODE_STATS_REPLY, &rejectClientOnly);
+
+  return handlers;
+}
 
-    case MessageType::WINDOW:
-      return AllServerReadStreams::onWindowMessage(
-          checked_downcast<WINDOW_Message*>(msg), from);
+// Indexed by MessageType, so that dispatching a received message is a
+// single indirect call.
+const HandlerTable handlers = makeHandlerTable();
 
-    case MessageType::NODE_STATS_REPLY:
-      RATELIMIT_ERROR(
-          std::chrono::seconds(60),
-          1,
-          "ServerMessageDispatch::onReceived() called with %s message"
-          "which is supposed to be client-only!",
-          messageTypeNames[msg->type_].c_str());
-      err = E::PROTO;
-      return Message::Disposition::ERROR;
+} // namespace
 
-    default:
-      // By default, call the Message's onReceived() implementation (for
-      // messages whose handler lives in common/ with the Message subclass)
-      return msg->onReceived(from);
-  }
+Message::Disposition
+ServerMessageDispatch::onReceivedImpl(Message* msg, const Address& from) {
+  return handlers[static_cast<unsigned char>(msg->type_)](msg, from);
 }
 
 void ServerMessageDispatch::onSentImpl(const Message& msg,
@@ -191,6 +198,10 @@ void ServerMessageDispatch::onSentImpl(const Message& msg,
       return RECORD_onSent(
           checked_downcast<const RECORD_Message&>(msg), st, to, enqueue_time);
 
+    case MessageType::RECORDS:
+      return RECORDS_onSent(
+          checked_downcast<const RECORDS_Message&>(msg), st, to, enqueue_time);
+
     case MessageType::SHARD_STATUS_UPDATE:
       return ServerWorker::onThisThread()
           ->serverReadStreams()
@@ -204,6 +215,10 @@ void ServerMessageDispatch::onSentImpl(const Message& msg,
       return STORE_onSent(
           checked_downcast<const STORE_Message&>(msg), st, to, enqueue_time);
 
+    case MessageType::STORES:
+      return STORES_onSent(
+          checked_downcast<const STORES_Message&>(msg), st, to, enqueue_time);
+
     default:
       // By default, call the Message's onSent() implementation (for messages
       // whose handler lives in common/ with the Message subclass)
@@ -11,7 +11,9 @@
 
 /**
  * @file Server-specific dispatcher for message events.  Because it lives in
- * server/ it can call handlers also in server/.
+ * server/ it can call handlers also in server/.  Received messages are
+ * dispatched through a table of handlers indexed by MessageType, see
+ * test/benchmarks/MessageDispatchBenchmark.cpp.
  */
 
 namespace facebook { namespace logdevice {
@@ -68,6 +68,8 @@ int ServerProcessor::getWorkerCount(WorkerType type) const {
   switch (type) {
     case WorkerType::BACKGROUND:
       return server_settings_->num_background_workers;
+    case WorkerType::READ:
+      return server_settings_->num_read_workers;
     case WorkerType::FAILURE_DETECTOR:
       if (gossip_settings_->enabled) {
         return 1; // failure detector is hard coded to have only one worker.
@@ -14,6 +14,7 @@
 #include "logdevice/common/settings/GossipSettings.h"
 #include "logdevice/server/FailureDetector.h"
 #include "logdevice/server/LocalLogFile.h"
+#include "logdevice/server/MemoryGovernor.h"
 #include "logdevice/server/ServerSettings.h"
 #include "logdevice/server/ServerWorker.h"
 #include "logdevice/server/read_path/LogStorageStateMap.h"
@@ -64,6 +65,11 @@ class ServerProcessor : public Processor {
 
   LogStorageStateMap& getLogStorageStateMap() const;
 
+  // Divides --read-storage-tasks-max-mem-bytes between general workers.
+  MemoryGovernor& readStorageTasksMemoryGovernor() {
+    return read_storage_tasks_memory_governor_;
+  }
+
   // Alternative factory for tests that need to construct a half-baked
   // Processor (no workers etc).
   template <typename... Args>
@@ -124,6 +130,7 @@ class ServerProcessor : public Processor {
   UpdateableSettings<ServerSettings> server_settings_;
   UpdateableSettings<GossipSettings> gossip_settings_;
   std::unique_ptr<LogStorageStateMap> log_storage_state_map_;
+  MemoryGovernor read_storage_tasks_memory_governor_;
   UpdateableSettings<Settings>::SubscriptionHandle settings_subscription_;
 };
 }} // namespace facebook::logdevice
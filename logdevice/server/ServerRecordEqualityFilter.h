@@ -41,6 +41,11 @@ class ServerRecordEqualityFilter final : public ServerRecordFilter {
     return record_key == filter_key_;
   }
 
+  bool mayMatchRange(folly::StringPiece min_key,
+                     folly::StringPiece max_key) const override {
+    return min_key <= filter_key_ && max_key >= filter_key_;
+  }
+
   /**
    *  @return             A human-readable string which describes this
    *                      server-side filter.
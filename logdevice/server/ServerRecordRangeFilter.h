@@ -38,6 +38,11 @@ class ServerRecordRangeFilter final : public ServerRecordFilter {
     return record_key >= low_limit_ && record_key <= high_limit_;
   }
 
+  bool mayMatchRange(folly::StringPiece min_key,
+                     folly::StringPiece max_key) const override {
+    return max_key >= low_limit_ && min_key <= high_limit_;
+  }
+
   /**
    *  @return             A human-readable string which describes this
    *                      server-side filter.
@@ -153,6 +153,16 @@ void ServerSettings::defineSettings(SettingEasyInit& init) {
      SERVER,
      SettingsCategory::AdminAPI)
 
+    ("safety-check-cache-storage-sets", &safety_check_cache_storage_sets,
+     "false",
+     nullptr,
+     "If true, the CheckImpact operation evaluates each distinct (storage set, "
+     "replication) pair once for all logs and epochs that use it, and reuses "
+     "the results in subsequent checks with the same parameters as long as the "
+     "config version and the cluster state don't change",
+     SERVER,
+     SettingsCategory::AdminAPI)
+
     ("command-conn-limit", &command_conn_limit, "32",
      [](int x) -> void {
        if (x <= 0) {
@@ -225,6 +235,33 @@ void ServerSettings::defineSettings(SettingEasyInit& init) {
      SERVER | REQUIRES_RESTART,
      SettingsCategory::Execution)
 
+    ("num-read-workers",
+     &num_read_workers,
+     "0",
+     parse_nonnegative<ssize_t>(),
+     "The number of workers dedicated to serving read streams. Connections "
+     "that readers open with --separate-read-connections are handed to these "
+     "workers, so that reads don't take CPU time from appends on the general "
+     "workers. Only plaintext connections are recognized. If 0, read streams "
+     "are served by the general workers.",
+     SERVER | REQUIRES_RESTART,
+     SettingsCategory::Execution)
+
+    ("num-connection-listeners",
+     &num_connection_listeners,
+     "1",
+     parse_positive<ssize_t>(),
+     "The number of threads accepting connections on the data port. If "
+     "greater than 1, each of them listens on its own socket bound with "
+     "SO_REUSEPORT, the kernel spreads incoming connections among them, and "
+     "listener i hands its connections to the general workers whose index "
+     "is i modulo this number (unless --worker-cpus picks the worker). Set "
+     "it to the number of workers for one listener per worker, or lower for "
+     "one per group of workers, so that mass reconnects aren't bottlenecked "
+     "on one accept thread. Ignored if the server listens on a unix socket.",
+     SERVER | REQUIRES_RESTART,
+     SettingsCategory::Execution)
+
     ("assert-on-data", &assert_on_data, "false",
      nullptr,
      "Trigger asserts on data in RocksDB (or that received from the network). "
@@ -368,6 +405,25 @@ void ServerSettings::defineSettings(SettingEasyInit& init) {
      SERVER | REQUIRES_RESTART,
      SettingsCategory::ResourceManagement)
 
+    ("jemalloc-thread-arenas", &jemalloc_thread_arenas, "false", nullptr,
+     "If logdeviced is linked with jemalloc, give every worker and storage "
+     "thread a jemalloc arena of its own, and make all other threads share "
+     "one arena, instead of letting jemalloc spread threads over its default "
+     "arenas. Avoids arena lock contention between threads of different "
+     "kinds. Allocated bytes per kind of thread are shown by the 'stats "
+     "jemalloc arenas' admin command.",
+     SERVER | REQUIRES_RESTART | EXPERIMENTAL,
+     SettingsCategory::ResourceManagement)
+
+    ("jemalloc-allocation-tagging", &jemalloc_allocation_tagging, "false",
+     nullptr,
+     "If logdeviced is linked with jemalloc, place the allocations of the "
+     "record cache, of records read by storage threads for read streams and "
+     "of appenders in separate jemalloc arenas, so that the bytes allocated "
+     "by each of them are shown by the 'stats jemalloc arenas' admin command.",
+     SERVER | REQUIRES_RESTART | EXPERIMENTAL,
+     SettingsCategory::ResourceManagement)
+
     ("user", &user, "", nullptr,
      "user to switch to if server is run as root",
      SERVER | REQUIRES_RESTART,
@@ -44,12 +44,17 @@ struct ServerSettings : public SettingsBundle {
   bool admin_enabled;
   int safety_max_logs_in_flight;
   std::chrono::milliseconds safety_check_timeout;
+  bool safety_check_cache_storage_sets;
   int command_conn_limit;
   dbg::Level loglevel;
   dbg::LogLevelMap loglevel_overrides;
   bool assert_on_data;
   // number of background workers
   int num_background_workers;
+  // number of workers serving read streams, see WorkerType::READ
+  int num_read_workers;
+  // number of SO_REUSEPORT listeners on the data port
+  int num_connection_listeners;
   std::string log_file;
   std::string config_path;
   std::string epoch_store_path;
@@ -59,6 +64,9 @@ struct ServerSettings : public SettingsBundle {
   bool eagerly_allocate_fdtable;
   int num_reserved_fds;
   bool lock_memory;
+  // See JemallocArenas.
+  bool jemalloc_thread_arenas;
+  bool jemalloc_allocation_tagging;
   std::string user;
   SequencerOptions sequencer;
   std::string server_id;
@@ -57,6 +57,11 @@ class ServerWorkerImpl {
    * have to be destructed before the node_stats_controller_
    */
   Timer node_stats_controller_locator_timer_;
+
+  // This worker's consumer in ServerProcessor's read storage task memory
+  // governor, for general workers.
+  MemoryGovernor::ConsumerID read_memory_consumer_id_{0};
+  Timer read_memory_rebalance_timer_;
 };
 
 ServerWorker::ServerWorker(ServerProcessor* processor,
@@ -75,7 +80,14 @@ ServerWorker::ServerWorker(ServerProcessor* processor,
       processor->runningOnStorageNode() ? &processor->getLogStorageStateMap()
                                         : nullptr,
       processor,
-      stats);
+      stats,
+      /* on_worker_thread */ true,
+      type);
+  if (type == WorkerType::GENERAL) {
+    impl_->read_memory_consumer_id_ =
+        processor->readStorageTasksMemoryGovernor().addConsumer(
+            getName(), &server_read_streams_->getMemoryBudget());
+  }
 
   if (processor_->runningOnStorageNode()) {
     purge_scheduler_.reset(new PurgeScheduler(processor_));
@@ -100,6 +112,7 @@ ServerWorker::ServerWorker(ServerProcessor* processor,
 
 ServerWorker::~ServerWorker() {
   impl_->node_stats_controller_locator_timer_.cancel();
+  impl_->read_memory_rebalance_timer_.cancel();
   impl_->node_stats_controller_.reset();
   ld_check(activePurges().map.empty());
   activeSettingOverrides().map.clear();
@@ -171,9 +184,15 @@ AllServerReadStreams& ServerWorker::serverReadStreams() const {
 
 void ServerWorker::onSettingsUpdated() {
   Worker::onSettingsUpdated();
-  server_read_streams_->setMemoryBudget(
-      immutable_settings_->read_storage_tasks_max_mem_bytes /
-      immutable_settings_->num_workers);
+  if (readStorageTasksMemoryGoverned()) {
+    processor_->readStorageTasksMemoryGovernor().setLimit(
+        immutable_settings_->read_storage_tasks_max_mem_bytes,
+        immutable_settings_->read_storage_tasks_mem_min_share);
+  } else {
+    server_read_streams_->setMemoryBudget(
+        immutable_settings_->read_storage_tasks_max_mem_bytes /
+        immutable_settings_->num_workers);
+  }
   if (server_read_streams_) {
     server_read_streams_->onSettingsUpdate();
   }
@@ -207,6 +226,30 @@ void ServerWorker::onThreadStarted() {
       (worker_type_ == WorkerType::GENERAL)) {
     initializeNodeStatsController();
   }
+  if (readStorageTasksMemoryGoverned()) {
+    impl_->read_memory_rebalance_timer_.assign(
+        [this] { rebalanceReadStorageTasksMemory(); });
+    impl_->read_memory_rebalance_timer_.activate(
+        settings().read_storage_tasks_mem_rebalance_interval);
+  }
+}
+
+bool ServerWorker::readStorageTasksMemoryGoverned() const {
+  return worker_type_ == WorkerType::GENERAL &&
+      immutable_settings_->read_storage_tasks_mem_rebalance_interval.count() >
+      0;
+}
+
+void ServerWorker::rebalanceReadStorageTasksMemory() {
+  const auto interval = settings().read_storage_tasks_mem_rebalance_interval;
+  MemoryGovernor& governor = processor_->readStorageTasksMemoryGovernor();
+  governor.noteStalls(impl_->read_memory_consumer_id_,
+                      server_read_streams_->takeMemoryStalls());
+  // Only one worker per interval actually recomputes the limits. The others
+  // just pick up their new limits.
+  governor.maybeRebalance(interval);
+  server_read_streams_->onMemoryBudgetUpdated();
+  impl_->read_memory_rebalance_timer_.activate(interval);
 }
 
 PerWorkerStorageTaskQueue*
@@ -117,6 +117,11 @@ class ServerWorker : public Worker {
   void noteShuttingDownNoPendingRequests() override;
   void initializeNodeStatsController();
 
+  // True if the memory budget for read storage tasks of this worker is
+  // managed by ServerProcessor::readStorageTasksMemoryGovernor().
+  bool readStorageTasksMemoryGoverned() const;
+  void rebalanceReadStorageTasksMemory();
+
   // Coordinator for tasks to storage threads to read from the local log store
   // and their replies, sharded by log ID to match ShardedStorageThreadPool
   // sharding
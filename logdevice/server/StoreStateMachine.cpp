@@ -17,6 +17,7 @@
 #include "logdevice/common/event_log/EventLogRebuildingSet.h"
 #include "logdevice/common/protocol/RELEASE_Message.h"
 #include "logdevice/common/protocol/STORED_Message.h"
+#include "logdevice/common/protocol/STORES_Message.h"
 #include "logdevice/common/protocol/STORE_Message.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/server/EpochRecordCache.h"
@@ -277,6 +278,21 @@ Message::Disposition StoreStateMachine::onReceived(STORE_Message* msg,
   return Message::Disposition::KEEP;
 }
 
+Message::Disposition StoreStateMachine::onReceived(STORES_Message* msg,
+                                                   const Address& from) {
+  WORKER_STAT_INCR(stores_batch_messages_received);
+  for (auto& store : msg->stores_) {
+    Message::Disposition disp = onReceived(store.get(), from);
+    if (disp == Message::Disposition::KEEP) {
+      // the StoreStateMachine took ownership
+      store.release();
+    } else if (disp == Message::Disposition::ERROR) {
+      return disp;
+    }
+  }
+  return Message::Disposition::NORMAL;
+}
+
 // Check if a node index is being rebuilt in RELOCATE mode. If that's the
 // case, we will deny the STORE with E::REBUILDING.
 static bool destIsRebuilding(ShardID dest,
@@ -586,6 +602,18 @@ void StoreStateMachine::storeAndForward() {
   const auto log_config = cfg->getLogGroupByIDShared(log_id);
   bool merge_mutable_per_epoch_log_metadata = log_config &&
       log_config->attrs().mutablePerEpochLogMetadataEnabled().value();
+  // The compact format is new on disk, so it also needs to be enabled for the
+  // cluster with --write-compact-record-header.
+  const bool compact_record_header = log_config &&
+      log_config->attrs().compactRecordHeader().value() &&
+      Worker::settings().write_compact_record_header;
+
+  // Appends of ephemeral logs skip the WAL unless the writer asked for a sync.
+  if (log_config && log_config->attrs().ephemeral().value() &&
+      !(header.flags & (STORE_Header::SYNC | STORE_Header::REBUILDING)) &&
+      durability_ > Durability::MEMORY) {
+    durability_ = Durability::MEMORY;
+  }
   if (merge_mutable_per_epoch_log_metadata) {
     if (const LogStorageState* log_state =
             worker->processor_->getLogStorageStateMap().find(log_id, shard_)) {
@@ -627,7 +655,8 @@ void StoreStateMachine::storeAndForward() {
       durability_,
       worker_settings.write_find_time_index,
       merge_mutable_per_epoch_log_metadata,
-      worker_settings.write_shard_id_in_copyset);
+      worker_settings.write_shard_id_in_copyset,
+      compact_record_header);
 
   // Forward to next node in chain
   if (header.flags & STORE_Header::CHAIN) {
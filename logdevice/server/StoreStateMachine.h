@@ -18,6 +18,7 @@
 namespace facebook { namespace logdevice {
 
 class STORE_Message;
+class STORES_Message;
 
 /**
  * @file  This is a state machine used to process the STORE message. It does so
@@ -35,6 +36,15 @@ class StoreStateMachine {
    */
   static Message::Disposition onReceived(STORE_Message* msg,
                                          const Address& from);
+
+  /**
+   * Handles the STOREs of an incoming STORES message one by one, exactly as
+   * if they had come in separate STORE messages. Their write tasks reach the
+   * storage threads back to back, so they usually end up in the same
+   * WriteBatchStorageTask.
+   */
+  static Message::Disposition onReceived(STORES_Message* msg,
+                                         const Address& from);
   /**
    * Check if the copyset of an incoming STORE message is valid.
    *
@@ -7,7 +7,9 @@
  */
 #include "StoreStorageTask.h"
 
+#include <algorithm>
 #include <initializer_list>
+#include <limits>
 
 #include <folly/Format.h>
 
@@ -43,7 +45,8 @@ StoreStorageTask::StoreStorageTask(
     Durability durability,
     bool write_find_time_index,
     bool merge_mutable_per_epoch_log_metadata,
-    bool write_shard_id_in_copyset)
+    bool write_shard_id_in_copyset,
+    bool compact_record_header)
     : WriteStorageTask(StorageTask::Type::STORE),
       payload_holder_(payload_holder),
       timestamp_(store_header.timestamp),
@@ -68,7 +71,8 @@ StoreStorageTask::StoreStorageTask(
                                                       &record_header_buf_,
                                                       write_shard_id_in_copyset,
                                                       optional_keys,
-                                                      extra_),
+                                                      extra_,
+                                                      compact_record_header),
           payload_raw_,
           rebuilding_ ? copyset[0].destination.node()
                       : (store_header.sequencer_node_id.isNodeID()
@@ -231,6 +235,12 @@ void StoreStorageTask::onDone() {
     status_ = E::DISABLED;
   }
 
+  // Let UnreleasedRecordDetector know about the record if it isn't released
+  // yet
+  if (status_ == E::OK) {
+    getLogStorageState().noteRecordStored(rid_.lsn());
+  }
+
   // Bump metadata write stats if metadata has been written successfully
   if (status_ == E::OK && metadata_write_op_.hasValue()) {
     STAT_INCR(worker->stats(), mutable_per_epoch_log_metadata_writes);
@@ -260,6 +270,35 @@ void StoreStorageTask::onDropped() {
   sendReply(E::DROPPED);
 }
 
+void StoreStorageTask::onSynced() {
+  if (flags_ & STORE_Header::TIMINGS) {
+    synced_time_ = std::chrono::steady_clock::now();
+  }
+}
+
+folly::Optional<STORED_Timings> StoreStorageTask::getTimings() const {
+  using TimePoint = std::chrono::steady_clock::time_point;
+  if (!(flags_ & STORE_Header::TIMINGS) ||
+      write_start_time_ == TimePoint() || write_end_time_ == TimePoint()) {
+    return folly::none;
+  }
+  auto usec = [](TimePoint from, TimePoint to) -> uint32_t {
+    auto d = std::chrono::duration_cast<std::chrono::microseconds>(to - from);
+    return std::max<int64_t>(
+        0, std::min<int64_t>(d.count(), std::numeric_limits<uint32_t>::max()));
+  };
+  const bool synced = synced_time_ != TimePoint();
+  const TimePoint done = synced ? synced_time_ : write_end_time_;
+
+  STORED_Timings timings;
+  timings.worker_usec = usec(start_time_, enqueue_time_);
+  timings.queue_usec = usec(enqueue_time_, write_start_time_);
+  timings.write_usec = usec(write_start_time_, write_end_time_);
+  timings.sync_usec = synced ? usec(write_end_time_, synced_time_) : 0;
+  timings.reply_usec = usec(done, std::chrono::steady_clock::now());
+  return timings;
+}
+
 shard_index_t StoreStorageTask::getShardIdx() const {
   return static_cast<shard_index_t>(storageThreadPool_->getShardIdx());
 }
@@ -297,16 +336,23 @@ void StoreStorageTask::sendReply(Status status) const {
   }
 
   ServerWorker* worker = ServerWorker::onThisThread();
+  const ShardedStorageThreadPool* sharded_pool =
+      worker->processor_->sharded_storage_thread_pool_;
+  LocalLogStore& store =
+      sharded_pool->getByIndex(reply_shard_idx_).getLocalLogStore();
+
   if (worker->getStorageTaskQueueForShard(reply_shard_idx_)->isOverloaded()) {
     flags |= STORED_Header::OVERLOADED;
     WORKER_STAT_INCR(node_overloaded_sent);
+  } else if (store.isWriteStallPredicted()) {
+    // The store is about to stall writes. Ask sequencers to steer away from
+    // this shard now rather than after the storage task queue fills up.
+    flags |= STORED_Header::OVERLOADED;
+    WORKER_STAT_INCR(node_overloaded_sent);
+    WORKER_STAT_INCR(node_write_stall_predicted_sent);
   }
 
-  const ShardedStorageThreadPool* sharded_pool =
-      worker->processor_->sharded_storage_thread_pool_;
-  Status st = sharded_pool->getByIndex(reply_shard_idx_)
-                  .getLocalLogStore()
-                  .acceptingWrites();
+  Status st = store.acceptingWrites();
   if (st == E::LOW_ON_SPC) {
     flags |= STORED_Header::LOW_WATERMARK_NOSPC;
     WORKER_STAT_INCR(node_stored_low_on_space_sent);
@@ -318,7 +364,9 @@ void StoreStorageTask::sendReply(Status status) const {
       extra_.rebuilding_version,
       extra_.rebuilding_wave,
       extra_.rebuilding_id,
-      flushToken_);
+      flushToken_,
+      ShardID(),
+      status == E::OK ? getTimings() : folly::none);
 }
 
 int StoreStorageTask::putCache() {
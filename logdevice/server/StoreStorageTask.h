@@ -17,6 +17,7 @@
 #include "logdevice/common/CopySet.h"
 #include "logdevice/common/Metadata.h"
 #include "logdevice/common/RecordID.h"
+#include "logdevice/common/protocol/STORED_Message.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/include/Err.h"
 #include "logdevice/server/locallogstore/WriteOps.h"
@@ -55,7 +56,8 @@ class StoreStorageTask : public WriteStorageTask {
                    Durability durability,
                    bool write_find_time_index,
                    bool merge_mutable_per_epoch_log_metadata,
-                   bool write_shard_id_in_copyset);
+                   bool write_shard_id_in_copyset,
+                   bool compact_record_header = false);
 
   ~StoreStorageTask() override;
 
@@ -63,6 +65,7 @@ class StoreStorageTask : public WriteStorageTask {
   // specify what to do when it's done.
   void onDone() override;
   void onDropped() override;
+  void onSynced() override;
 
   bool isPreempted(Seal* preempted_by) override;
 
@@ -135,6 +138,10 @@ class StoreStorageTask : public WriteStorageTask {
   // Convenience wrapper for STORED_Message_createAndSend
   void sendReply(Status status) const;
 
+  // Where the store spent its time, if the STORE asked for it with
+  // STORE_Header::TIMINGS and the record was written.
+  folly::Optional<STORED_Timings> getTimings() const;
+
   // called when the storage task is sent back to the worker thread,
   // in case record caching is on, free evicted cache entries previously
   // disposed on the same worker thread
@@ -175,6 +182,10 @@ class StoreStorageTask : public WriteStorageTask {
   // latency.
   std::chrono::steady_clock::time_point start_time_;
 
+  // When the WAL sync of the write completed, if the STORE had
+  // STORE_Header::TIMINGS and the write was synced.
+  std::chrono::steady_clock::time_point synced_time_;
+
   // This holds the record header as it will be written into the local log
   // store.  formRecordHeader() initializes this and returns a Payload that
   // points into this string.
@@ -91,6 +91,18 @@ class WriteTrimMetadataTask : public StorageTask {
 
     log_state->updateTrimPoint(trim_point_);
     durability_ = Durability::SYNC_WRITE;
+
+    // The trim point is already moved, if this fails compactions will
+    // eventually delete the records anyway.
+    if (store.deleteTrimmedRecords(log_id_, trim_point_) != 0) {
+      RATELIMIT_WARNING(std::chrono::seconds(10),
+                        2,
+                        "Failed to delete records of log %lu up to trim point "
+                        "%s: %s",
+                        log_id_.val_,
+                        lsn_to_string(trim_point_).c_str(),
+                        error_description(err));
+    }
   }
 
   Durability durability() const override {
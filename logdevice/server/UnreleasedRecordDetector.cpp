@@ -8,6 +8,7 @@
 #include "UnreleasedRecordDetector.h"
 
 #include <cinttypes>
+#include <unordered_set>
 
 #include <folly/Likely.h>
 
@@ -178,6 +179,7 @@ bool UnreleasedRecordDetector::waitNextInterval(
       // ensure we do not take action unless at least two of the new
       // wait intervals have passed
       prev_states_.clear();
+      full_scan_needed_ = true;
       return true;
     } else {
       // nothing of interest happened, keep waiting
@@ -219,6 +221,9 @@ bool UnreleasedRecordDetector::collectLogStates() {
                            const logid_t log_id, const LogStorageState& state) {
     shard_index_t shard_idx = state.getShardIdx();
 
+    // records stored from now on need to note the log again
+    state.clearUnreleasedRecordsNoted();
+
     // read last released LSN with relaxed memory order (we do not care about
     // consistency here, because we are only interested in logs where the last
     // released LSN has not changed in a long time)
@@ -262,12 +267,42 @@ bool UnreleasedRecordDetector::collectLogStates() {
     return 0;
   };
 
-  ld_debug("Collecting log states...");
-  const bool error = processor_->getLogStorageStateMap().forEachLog(visitor);
-  ld_debug("Finished collecting log states.");
+  auto& log_storage_state_map = processor_->getLogStorageStateMap();
+  auto noted_logs = log_storage_state_map.takeLogsWithUnreleasedRecords();
+  if (!noted_logs.hasValue()) {
+    full_scan_needed_ = true;
+  }
+
+  if (full_scan_needed_) {
+    ld_debug("Collecting log states of all logs...");
+    if (log_storage_state_map.forEachLog(visitor) != 0) {
+      return true;
+    }
+    full_scan_needed_ = false;
+    ld_debug("Finished collecting log states.");
+    return false;
+  }
 
-  // return true iff visitor() returned -1 for some invocation
-  return error;
+  // Logs that have unreleased records now either had them at the previous
+  // check or got new records since.
+  std::unordered_set<Key> keys;
+  for (const auto& entry : prev_states_) {
+    keys.insert(entry.first);
+  }
+  for (const auto& log : noted_logs.value()) {
+    keys.emplace(log.first.val(), log.second);
+  }
+  ld_debug("Collecting log states of %zu logs...", keys.size());
+  for (const Key& key : keys) {
+    const logid_t log_id(key.first);
+    const LogStorageState* state =
+        log_storage_state_map.find(log_id, key.second);
+    if (state != nullptr && visitor(log_id, *state) != 0) {
+      return true;
+    }
+  }
+  ld_debug("Finished collecting log states.");
+  return false;
 }
 
 bool UnreleasedRecordDetector::compareLogStates() {
@@ -36,6 +36,13 @@
  *       GetSeqStateRequest, causing sequencer fail-over and eventually release
  *       of the records.
  *
+ *       Only the logs that had unreleased records at the previous check and
+ *       the logs that got records above their last released LSN since then
+ *       (see LogStorageStateMap::takeLogsWithUnreleasedRecords()) are
+ *       looked at. All logs are looked at on the first check, after the
+ *       interval changes, and if too many logs got unreleased records at
+ *       once.
+ *
  *       Runs only on storage nodes.
  */
 namespace facebook { namespace logdevice {
@@ -75,7 +82,9 @@ class UnreleasedRecordDetector final
   bool waitNextInterval(std::unique_lock<std::mutex>& lock);
 
   /**
-   * Collect new log states from local log store.
+   * Collect new log states from local log store, for all logs if
+   * full_scan_needed_ is set, otherwise for the logs in prev_states_ and the
+   * logs that got unreleased records since the last call.
    *
    * @return true iff some local log store does not support
    *         getHighestInsertedLSN() (fatal error)
@@ -124,6 +133,11 @@ class UnreleasedRecordDetector final
   /// log states at current iteration
   LogStates new_states_;
 
+  /// if true, the next collectLogStates() looks at all logs because
+  /// prev_states_ and the logs noted by LogStorageStateMap may not cover all
+  /// logs with unreleased records. Protected by mutex_
+  bool full_scan_needed_ = true;
+
   /// thread safe map that tells us whether there is an outstanding
   /// GetSeqStateRequest for a given log
   /// TODO(T15517759): With Flexible Log Sharding: in order to be able to have
@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "WarmUpLogStorageStateRequest.h"
+
+#include "logdevice/common/debug.h"
+#include "logdevice/server/ServerProcessor.h"
+#include "logdevice/server/ServerWorker.h"
+#include "logdevice/server/storage_tasks/PerWorkerStorageTaskQueue.h"
+#include "logdevice/server/storage_tasks/ShardedStorageThreadPool.h"
+#include "logdevice/server/storage_tasks/StorageThreadPool.h"
+#include "logdevice/server/storage_tasks/WarmUpLogStorageStateTask.h"
+
+namespace facebook { namespace logdevice {
+
+WarmUpLogStorageStateRequest::WarmUpLogStorageStateRequest(
+    std::function<void(Status, shard_index_t)> callback)
+    : Request(RequestType::WARM_UP_LOG_STORAGE_STATE),
+      callback_(std::move(callback)),
+      ref_holder_(this) {}
+
+Request::Execution WarmUpLogStorageStateRequest::execute() {
+  ServerWorker* w = ServerWorker::onThisThread();
+
+  const auto* sharded_pool = w->processor_->sharded_storage_thread_pool_;
+  // must be on a storage node
+  ld_check(sharded_pool != nullptr);
+
+  const shard_size_t num_shards = sharded_pool->numShards();
+  const auto& types = WarmUpLogStorageStateTask::metadataTypes();
+  shards_.resize(num_shards);
+  remaining_shards_ = num_shards;
+
+  for (shard_index_t shard_idx = 0; shard_idx < num_shards; shard_idx++) {
+    LocalLogStore& shard =
+        sharded_pool->getByIndex(shard_idx).getLocalLogStore();
+    if (shard.acceptingWrites() == E::DISABLED) {
+      remaining_shards_--;
+      callback_(E::DISABLED, shard_idx);
+      continue;
+    }
+
+    shards_[shard_idx].remaining_scans = types.size();
+    for (LogMetadataType type : types) {
+      auto task = std::make_unique<WarmUpLogStorageStateTask>(
+          shard_idx, type, ref_holder_.ref());
+      w->getStorageTaskQueueForShard(shard_idx)->putTask(std::move(task));
+    }
+  }
+
+  // We're done if there are no enabled shards
+  return remaining_shards_ == 0 ? Execution::COMPLETE : Execution::CONTINUE;
+}
+
+void WarmUpLogStorageStateRequest::onTaskDone(shard_index_t shard_idx,
+                                              bool final_task,
+                                              Status status) {
+  ld_check(shard_idx < shards_.size());
+  ld_check(status == E::OK || status == E::PARTIAL);
+
+  if (final_task) {
+    onShardDone(shard_idx, status);
+    return;
+  }
+
+  ShardState& shard = shards_[shard_idx];
+  ld_check(shard.remaining_scans > 0);
+  shard.failed |= status != E::OK;
+  if (--shard.remaining_scans > 0) {
+    return;
+  }
+
+  if (shard.failed) {
+    // Don't mark anything as absent: it may just not have been read.
+    onShardDone(shard_idx, E::PARTIAL);
+    return;
+  }
+
+  auto task = std::make_unique<WarmUpLogStorageStateTask>(
+      shard_idx, folly::none, ref_holder_.ref());
+  ServerWorker::onThisThread()
+      ->getStorageTaskQueueForShard(shard_idx)
+      ->putTask(std::move(task));
+}
+
+void WarmUpLogStorageStateRequest::onShardDone(shard_index_t shard_idx,
+                                               Status status) {
+  ld_check(remaining_shards_ > 0);
+  callback_(status, shard_idx);
+  if (--remaining_shards_ == 0) {
+    delete this;
+  }
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "logdevice/common/Request.h"
+#include "logdevice/common/WeakRefHolder.h"
+#include "logdevice/common/types_internal.h"
+#include "logdevice/include/Err.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file  A request to populate LogStorageStateMap on startup with the trim
+ *        points, last released LSNs, last clean epochs and seals of all logs,
+ *        read from the local log stores in bulk instead of log by log.
+ *
+ *        For each shard, one WarmUpLogStorageStateTask per metadata type scans
+ *        all metadata of that type; the scans of a shard run in parallel on
+ *        the shard's storage threads. Once all scans of a shard succeeded, a
+ *        final task marks the metadata that the scans didn't find as absent,
+ *        so that none of the logs in the map need a RecoverLogStateTask or a
+ *        RecoverSealTask later.
+ */
+class WarmUpLogStorageStateRequest : public Request {
+ public:
+  /**
+   * @param callback  Will be called with the resulting status for each shard:
+   *                   - OK        if all log metadata was loaded
+   *                   - PARTIAL   if some of it couldn't be read; whatever is
+   *                               missing gets recovered lazily, as if the
+   *                               warm-up was disabled
+   *                   - DISABLED  if the shard is disabled
+   */
+  explicit WarmUpLogStorageStateRequest(
+      std::function<void(Status, shard_index_t)> callback);
+
+  Execution execute() override;
+
+  // called by each WarmUpLogStorageStateTask when it is done executing;
+  // `final_task` is true for the last task of the shard
+  void onTaskDone(shard_index_t shard_idx, bool final_task, Status status);
+
+ private:
+  void onShardDone(shard_index_t shard_idx, Status status);
+
+  struct ShardState {
+    // number of metadata scans still running
+    size_t remaining_scans{0};
+    // true if one of the scans failed
+    bool failed{false};
+  };
+
+  std::vector<ShardState> shards_;
+
+  // number of shards that haven't called callback_ yet
+  int remaining_shards_;
+
+  std::function<void(Status, shard_index_t)> callback_;
+
+  // for creating weakref to itself for storage tasks created.
+  WeakRefHolder<WarmUpLogStorageStateRequest> ref_holder_;
+};
+
+}} // namespace facebook::logdevice
@@ -7,6 +7,15 @@
  */
 #pragma once
 
+#include <cinttypes>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <folly/FileUtil.h>
+#include <folly/String.h>
+
 #include "logdevice/server/AdminCommand.h"
 #include "rocksdb/utilities/checkpoint.h"
 
@@ -18,6 +27,11 @@ class CreateCheckpoint : public AdminCommand {
  private:
   std::string path_;
   shard_index_t shard_index_;
+  std::string base_;
+
+  // Written to every checkpoint. Identifies the DB the checkpoint was taken
+  // of and, for incremental checkpoints, the SST files left in the base.
+  static constexpr const char* INFO_FILE = "LOGDEVICE_CHECKPOINT";
 
  public:
   void getOptions(
@@ -35,7 +49,9 @@ class CreateCheckpoint : public AdminCommand {
              "Invalid value for --path. Must not be empty path or \"/\".");
          }
        })
-       ->required());
+       ->required())
+      ("base",
+       boost::program_options::value<std::string>(&base_));
     // clang-format on
   }
   void getPositionalOptions(
@@ -45,7 +61,7 @@ class CreateCheckpoint : public AdminCommand {
     out_options.add("path", 1);
   }
   std::string getUsage() override {
-    return "create_checkpoint <shard> <path>\r\n\r\n"
+    return "create_checkpoint <shard> <path> [--base <checkpoint path>]\r\n\r\n"
            "Checkpoint is a sort of copy-on-write copy of a rocksdb DB. It "
            "copies \r\n"
            "the current DB to <path>, except that for read-only files it "
@@ -66,7 +82,20 @@ class CreateCheckpoint : public AdminCommand {
            "\r\n"
            "supported by rocksdb, and may be unsafe (but we do it all the time "
            "\r\n"
-           "anyway and nothing bad ever happened).\r\n";
+           "anyway and nothing bad ever happened).\r\n\r\n"
+           "With --base, the checkpoint is incremental: SST files that are "
+           "also in \r\n"
+           "the full checkpoint <base> of the same shard are left out, so "
+           "only \r\n"
+           "files created since <base> need to be copied off the host. Old "
+           "\r\n"
+           "partitions don't change, so this is usually a small part of the "
+           "shard. \r\n"
+           "The files left out are listed in LOGDEVICE_CHECKPOINT; copy "
+           "them from \r\n"
+           "<base> into <path> to restore. --base must be a checkpoint "
+           "created by \r\n"
+           "this command.\r\n";
   }
 
   void run() override {
@@ -85,9 +114,21 @@ class CreateCheckpoint : public AdminCommand {
     }
     RocksDBLogStoreBase* store_base = dynamic_cast<RocksDBLogStoreBase*>(store);
     rocksdb::DB* db = &store_base->getDB();
-    rocksdb::Checkpoint* checkpoint_ptr;
 
-    rocksdb::Status status = rocksdb::Checkpoint::Create(db, &checkpoint_ptr);
+    std::string identity;
+    rocksdb::Status status = db->GetIdentity(identity);
+    if (!status.ok()) {
+      out_.printf("Could not get identity of shard %d. Error %s.\r\n",
+                  shard_index_,
+                  status.ToString().c_str());
+      return;
+    }
+    if (!base_.empty() && !checkBase(identity)) {
+      return;
+    }
+
+    rocksdb::Checkpoint* checkpoint_ptr;
+    status = rocksdb::Checkpoint::Create(db, &checkpoint_ptr);
     if (!status.ok()) {
       out_.printf("Could not create checkpoint for shard %d. Error %s.\r\n",
                   shard_index_,
@@ -107,10 +148,150 @@ class CreateCheckpoint : public AdminCommand {
                   status.ToString().c_str());
       return;
     }
-    out_.printf("Created checkpoint for shard %d at %s\r\n",
+
+    if (!finishCheckpoint(identity)) {
+      // Don't leave behind a checkpoint that's missing files or the info
+      // file.
+      boost::system::error_code ec;
+      boost::filesystem::remove_all(path_, ec);
+      if (ec) {
+        out_.printf("Error: could not remove incomplete checkpoint %s: %s\r\n",
+                    path_.c_str(),
+                    ec.message().c_str());
+      }
+      return;
+    }
+
+    out_.printf("Created %scheckpoint for shard %d at %s\r\n",
+                base_.empty() ? "" : "incremental ",
                 shard_index_,
                 path_.c_str());
   }
+
+ private:
+  // Checks that base_ is a full checkpoint of the DB with `identity`.
+  bool checkBase(const std::string& identity) {
+    while (base_.size() > 1 && base_.back() == '/') {
+      base_.resize(base_.size() - 1);
+    }
+    std::string info;
+    const std::string info_path = base_ + "/" + INFO_FILE;
+    if (!folly::readFile(info_path.c_str(), info)) {
+      out_.printf("Error: could not read %s: %s\r\n",
+                  info_path.c_str(),
+                  folly::errnoStr(errno).c_str());
+      return false;
+    }
+    std::vector<folly::StringPiece> lines;
+    folly::split('\n', info, lines, true);
+    if (lines.empty() || lines[0] != "db_identity " + identity) {
+      out_.printf("Error: %s is not a checkpoint of shard %d\r\n",
+                  base_.c_str(),
+                  shard_index_);
+      return false;
+    }
+    if (lines.size() > 1) {
+      out_.printf("Error: %s is an incremental checkpoint, --base must be a "
+                  "full one\r\n",
+                  base_.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  // Writes INFO_FILE to the new checkpoint at path_ and, for incremental
+  // checkpoints, removes the SST files that are also in base_. The info file
+  // is written before any file is removed, so that it lists all of them.
+  bool finishCheckpoint(const std::string& identity) {
+    std::string info = "db_identity " + identity + "\n";
+    std::vector<std::string> from_base;
+    if (!base_.empty()) {
+      if (!findFilesInBase(&from_base)) {
+        return false;
+      }
+      info += "base " + base_ + "\n";
+      for (const std::string& file : from_base) {
+        info += "from_base " + file + "\n";
+      }
+    }
+    const std::string info_path = path_ + "/" + INFO_FILE;
+    if (!folly::writeFile(info, info_path.c_str())) {
+      out_.printf("Could not write %s: %s\r\n",
+                  info_path.c_str(),
+                  folly::errnoStr(errno).c_str());
+      return false;
+    }
+
+    for (const std::string& file : from_base) {
+      boost::system::error_code ec;
+      boost::filesystem::remove(boost::filesystem::path(path_) / file, ec);
+      if (ec) {
+        out_.printf("Error: could not remove %s from %s: %s\r\n",
+                    file.c_str(),
+                    path_.c_str(),
+                    ec.message().c_str());
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Finds the SST files of the new checkpoint that are also in base_.
+  // RocksDB never reuses SST file names within a DB and never modifies
+  // them, so a file with the same name and size has the same contents.
+  bool findFilesInBase(std::vector<std::string>* from_base) {
+    namespace fs = boost::filesystem;
+    auto list_sst_files =
+        [&](const std::string& dir,
+            std::map<std::string, uint64_t>* out) -> bool {
+      boost::system::error_code ec;
+      for (fs::directory_iterator it(dir, ec), end; !ec && it != end;
+           it.increment(ec)) {
+        if (it->path().extension() != ".sst") {
+          continue;
+        }
+        uint64_t size = fs::file_size(it->path(), ec);
+        if (ec) {
+          break;
+        }
+        (*out)[it->path().filename().string()] = size;
+      }
+      if (ec) {
+        out_.printf("Error: could not list files in %s: %s\r\n",
+                    dir.c_str(),
+                    ec.message().c_str());
+        return false;
+      }
+      return true;
+    };
+
+    std::map<std::string, uint64_t> base_files;
+    std::map<std::string, uint64_t> new_files;
+    if (!list_sst_files(base_, &base_files) ||
+        !list_sst_files(path_, &new_files)) {
+      return false;
+    }
+
+    uint64_t new_bytes = 0;
+    uint64_t base_bytes = 0;
+    for (const auto& file : new_files) {
+      auto it = base_files.find(file.first);
+      if (it == base_files.end() || it->second != file.second) {
+        new_bytes += file.second;
+        continue;
+      }
+      from_base->push_back(file.first);
+      base_bytes += file.second;
+    }
+    out_.printf("%zu new SST files (%" PRIu64 " bytes), %zu SST files "
+                "(%" PRIu64 " bytes) left in base %s\r\n",
+                new_files.size() - from_base->size(),
+                new_bytes,
+                from_base->size(),
+                base_bytes,
+                base_.c_str());
+    return true;
+  }
 };
 
 }}} // namespace facebook::logdevice::commands
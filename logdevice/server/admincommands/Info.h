@@ -9,6 +9,7 @@
 
 #include <time.h>
 
+#include <folly/Format.h>
 #include <folly/String.h>
 #include <folly/json.h>
 
@@ -17,6 +18,7 @@
 #include "logdevice/common/PrincipalParser.h"
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/UpdateableSecurityInfo.h"
+#include "logdevice/common/Worker.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/server/AdminCommand.h"
 #include "logdevice/server/ServerPluginPack.h"
@@ -59,6 +61,60 @@ class Info : public AdminCommand {
     return folly::join(",", rebuilding_shards);
   }
 
+  // Formats a list of CPUs the way cpuset(7) does, e.g. "0-7,16-23".
+  static std::string formatCpuList(const std::vector<int>& cpus) {
+    std::vector<std::string> ranges;
+    for (size_t i = 0; i < cpus.size();) {
+      size_t j = i + 1;
+      while (j < cpus.size() && cpus[j] == cpus[j - 1] + 1) {
+        ++j;
+      }
+      ranges.push_back(j - i == 1
+                           ? std::to_string(cpus[i])
+                           : folly::sformat("{}-{}", cpus[i], cpus[j - 1]));
+      i = j;
+    }
+    return folly::join(",", ranges);
+  }
+
+  // CPUs each worker is pinned to (see worker-cpus setting), e.g.
+  // "WG0:2 WG1:3 WF0:2-3".
+  std::string getWorkerCpus() {
+    auto processor = server_->getProcessor();
+    auto settings = processor->settings();
+    if (settings->worker_cpus.empty()) {
+      return "none";
+    }
+    std::vector<std::string> workers;
+    for (int t = 0; t < numOfWorkerTypes(); ++t) {
+      WorkerType type = workerTypeByIndex(t);
+      for (int i = 0; i < processor->getWorkerCount(type); ++i) {
+        workers.push_back(
+            Worker::getName(type, worker_id_t(i)) + ":" +
+            formatCpuList(Worker::getCpus(*settings, type, worker_id_t(i))));
+      }
+    }
+    return folly::join(" ", workers);
+  }
+
+  // NUMA node the storage threads of each shard are bound to (see
+  // storage-thread-numa-nodes setting), e.g. "S0:0 S1:1".
+  std::string getStorageThreadNumaNodes() {
+    const auto& nodes =
+        server_->getProcessor()->settings()->storage_thread_numa_nodes;
+    if (!server_->getProcessor()->runningOnStorageNode() || nodes.empty()) {
+      return "none";
+    }
+    auto sharded_store = server_->getShardedLocalLogStore();
+    ld_check(sharded_store);
+    std::vector<std::string> shards;
+    for (shard_index_t shard = 0; shard < sharded_store->numShards(); ++shard) {
+      shards.push_back(
+          folly::sformat("S{}:{}", shard, nodes[shard % nodes.size()]));
+    }
+    return folly::join(" ", shards);
+  }
+
   std::string getUsage() override {
     return "info [--json] [--buildinfo]";
   }
@@ -85,7 +141,9 @@ class Info : public AdminCommand {
                     "Permission Checker Type",
                     "RocksDB Version",
                     "Node ID",
-                    "Is LogsConfig Manager Enabled");
+                    "Is LogsConfig Manager Enabled",
+                    "Worker CPUs",
+                    "Storage Thread NUMA Nodes");
 
     auto start_time = server_->getStartTime();
     auto uptime = std::chrono::duration_cast<std::chrono::seconds>(
@@ -125,7 +183,9 @@ class Info : public AdminCommand {
                  std::to_string(ROCKSDB_MINOR) + "." +
                  std::to_string(ROCKSDB_PATCH))
         .set<19>(processor->describeMyNode())
-        .set<20>(processor->updateableSettings()->enable_logsconfig_manager);
+        .set<20>(processor->updateableSettings()->enable_logsconfig_manager)
+        .set<21>(getWorkerCpus())
+        .set<22>(getStorageThreadNumaNodes());
 
     if (include_buildinfo_) {
       folly::dynamic map = folly::dynamic::object;
@@ -55,6 +55,9 @@ class InfoEventLog : public AdminCommand {
                                           "Delta log bytes",
                                           "Delta log records",
                                           "Delta log healthy",
+                                          "Snapshot tail ms",
+                                          "Snapshot replay ms",
+                                          "Delta replay ms",
                                           "Propagated version");
 
     auto tables = run_on_all_workers(server_->getProcessor(), [&]() {
@@ -69,7 +72,7 @@ class InfoEventLog : public AdminCommand {
         // column.
         ld_check_eq(w->rebuilding_coordinator_ != nullptr,
                     server_->getRebuildingCoordinator() != nullptr);
-        t.set<14>(w->rebuilding_coordinator_
+        t.set<17>(w->rebuilding_coordinator_
                       ? w->rebuilding_coordinator_->getLastSeenEventLogVersion()
                       : w->event_log_->getVersion());
       }
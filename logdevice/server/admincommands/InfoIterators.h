@@ -20,13 +20,17 @@ namespace facebook { namespace logdevice { namespace commands {
 class InfoIterators : public AdminCommand {
  private:
   folly::Optional<logid_t> logid_;
+  bool io_summary_ = false;
   bool json_ = false;
+  bool binary_ = false;
 
  public:
   void getOptions(
       boost::program_options::options_description& out_options) override {
     out_options.add_options()(
-        "json", boost::program_options::bool_switch(&json_));
+        "io-summary", boost::program_options::bool_switch(&io_summary_))(
+        "json", boost::program_options::bool_switch(&json_))(
+        "binary", boost::program_options::bool_switch(&binary_));
   }
   void getPositionalOptions(
       boost::program_options::positional_options_description& out_options)
@@ -34,11 +38,16 @@ class InfoIterators : public AdminCommand {
     out_options.add("logid", 1);
   }
   std::string getUsage() override {
-    return "info iterators [--json] [log_id]";
+    return "info iterators [--io-summary] [--json] [--binary] [log_id]";
   }
 
   void run() override {
-    InfoIteratorsTable table(!json_,
+    if (io_summary_) {
+      printIOSummary();
+      return;
+    }
+
+    InfoIteratorsTable table(!json_ && !binary_,
                              "Column family",
                              "Log ID",
                              "Is tailing",
@@ -50,7 +59,10 @@ class InfoIterators : public AdminCommand {
                              "More context",
                              "Last seek LSN",
                              "Last seek timestamp",
-                             "Version");
+                             "Version",
+                             "Bytes read",
+                             "Blocks read",
+                             "Seeks");
 
     auto info = IteratorTracker::get()->getDebugInfo();
 
@@ -80,7 +92,10 @@ class InfoIterators : public AdminCommand {
           .set<4>(type_to_string(row.imm.type))
           .set<5>(row.imm.created_by_rebuilding)
           .set<6>(row.imm.high_level_id)
-          .set<7>(row.imm.created.toMilliseconds().count());
+          .set<7>(row.imm.created.toMilliseconds().count())
+          .set<12>(row.io.bytes_read)
+          .set<13>(row.io.blocks_read)
+          .set<14>(row.io.seeks);
       if (row.mut.more_context) {
         table.set<8>(std::string(row.mut.more_context));
       }
@@ -91,7 +106,40 @@ class InfoIterators : public AdminCommand {
       }
     }
 
-    json_ ? table.printJson(out_) : table.print(out_);
+    if (binary_) {
+      table.printBinary(out_);
+    } else {
+      json_ ? table.printJson(out_) : table.print(out_);
+    }
+  }
+
+ private:
+  // IO done by iterators, including destroyed ones, aggregated by the context
+  // they were created in.
+  void printIOSummary() {
+    InfoIteratorsIOTable table(!json_ && !binary_,
+                               "More context",
+                               "Rebuilding",
+                               "Open iterators",
+                               "Bytes read",
+                               "Blocks read",
+                               "Seeks");
+
+    for (auto& row : IteratorTracker::get()->getIOSummary()) {
+      table.next()
+          .set<0>(row.more_context)
+          .set<1>(row.rebuilding)
+          .set<2>(row.open_iterators)
+          .set<3>(row.io.bytes_read)
+          .set<4>(row.io.blocks_read)
+          .set<5>(row.io.seeks);
+    }
+
+    if (binary_) {
+      table.printBinary(out_);
+    } else {
+      json_ ? table.printJson(out_) : table.print(out_);
+    }
   }
 };
 
@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <algorithm>
+
+#include "logdevice/common/AdminCommandTable.h"
+#include "logdevice/common/stats/LogHeavyHitters.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/AdminCommand.h"
+
+namespace facebook { namespace logdevice { namespace commands {
+
+typedef AdminCommandTable<std::string,               /* Metric */
+                          logid_t,                   /* Log ID */
+                          uint64_t,                  /* Value */
+                          uint64_t,                  /* Max error */
+                          std::chrono::milliseconds, /* Window start */
+                          uint64_t                   /* Window sec */
+                          >
+    InfoLogHeavyHittersTable;
+
+// Prints the logs with the highest appended bytes, read bytes and storage
+// thread time on this node, from the LogHeavyHitters of all threads.
+class InfoLogHeavyHitters : public AdminCommand {
+ private:
+  std::string metric_;
+  size_t top_ = 100;
+  bool current_ = false;
+  bool json_ = false;
+
+ public:
+  void getOptions(
+      boost::program_options::options_description& out_options) override {
+    out_options.add_options()(
+        "metric", boost::program_options::value<std::string>(&metric_))(
+        "top", boost::program_options::value<size_t>(&top_))(
+        "current", boost::program_options::bool_switch(&current_))(
+        "json", boost::program_options::bool_switch(&json_));
+  }
+
+  std::string getUsage() override {
+    return "info log_heavy_hitters [--metric "
+           "appended_bytes|read_bytes|storage_task_usec] [--top <n>] "
+           "[--current] [--json]";
+  }
+
+  void run() override {
+    using Metric = LogHeavyHitters::Metric;
+
+    // By default, report the last complete window. Windows are aligned on
+    // the system clock, so this is the same window on all nodes.
+    LogHeavyHitters::Window window = LogHeavyHitters::currentWindow();
+    if (!current_) {
+      window -= LogHeavyHitters::Window(1);
+    }
+    const auto window_start =
+        std::chrono::duration_cast<std::chrono::milliseconds>(window);
+    const auto window_sec =
+        std::chrono::duration_cast<std::chrono::seconds>(
+            LogHeavyHitters::Window(1))
+            .count();
+
+    InfoLogHeavyHittersTable table(!json_,
+                                   "Metric",
+                                   "Log ID",
+                                   "Value",
+                                   "Max Error",
+                                   "Window Start",
+                                   "Window Sec");
+
+    bool found = false;
+    StatsHolder* stats = server_->getParameters()->getStats();
+    for (int i = 0; i < static_cast<int>(Metric::MAX); ++i) {
+      const Metric metric = static_cast<Metric>(i);
+      if (!metric_.empty() && metric_ != LogHeavyHitters::metricName(metric)) {
+        continue;
+      }
+      found = true;
+      if (!stats) {
+        continue;
+      }
+
+      SpaceSavingSummary summary(std::max(top_, LogHeavyHitters::CAPACITY));
+      stats->runForEach([&](Stats& s) {
+        if (s.log_heavy_hitters) {
+          s.log_heavy_hitters->mergeInto(metric, window, summary);
+        }
+      });
+      for (const auto& entry : summary.top(top_)) {
+        table.next()
+            .set<0>(std::string(LogHeavyHitters::metricName(metric)))
+            .set<1>(entry.log_id)
+            .set<2>(entry.weight)
+            .set<3>(entry.error)
+            .set<4>(window_start)
+            .set<5>(window_sec);
+      }
+    }
+
+    if (!found) {
+      out_.printf("Unknown metric '%s'.\r\n", metric_.c_str());
+      return;
+    }
+
+    json_ ? table.printJson(out_) : table.print(out_);
+  }
+};
+
+}}} // namespace facebook::logdevice::commands
@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include "logdevice/common/AdminCommandTable.h"
+#include "logdevice/common/Sender.h"
+#include "logdevice/common/request_util.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/AdminCommand.h"
+#include "logdevice/server/ServerProcessor.h"
+#include "logdevice/server/ServerWorker.h"
+#include "logdevice/server/read_path/AllServerReadStreams.h"
+
+namespace facebook { namespace logdevice { namespace commands {
+
+/**
+ * Memory used by the subsystems that limit it, against their limits. For
+ * the read storage task budgets managed by MemoryGovernor, also the
+ * guaranteed minimum and the stalls the current limits are based on.
+ */
+class InfoMemory : public AdminCommand {
+ private:
+  bool json_ = false;
+
+  typedef AdminCommandTable<std::string, // Subsystem
+                            std::string, // Owner
+                            int64_t,     // Used bytes
+                            uint64_t,    // Limit bytes
+                            uint64_t,    // Min bytes
+                            uint64_t     // Stalls
+                            >
+      InfoMemoryTable;
+
+ public:
+  void getOptions(
+      boost::program_options::options_description& out_options) override {
+    out_options.add_options()(
+        "json", boost::program_options::bool_switch(&json_));
+  }
+
+  std::string getUsage() override {
+    return "info memory [--json]";
+  }
+
+  void run() override {
+    InfoMemoryTable table(!json_,
+                          "Subsystem",
+                          "Owner",
+                          "Used bytes",
+                          "Limit bytes",
+                          "Min bytes",
+                          "Stalls");
+
+    ServerProcessor* processor = server_->getServerProcessor();
+    for (const auto& consumer :
+         processor->readStorageTasksMemoryGovernor().getConsumers()) {
+      table.next()
+          .set<0>("read_storage_tasks")
+          .set<1>(consumer.name)
+          .set<2>(consumer.used_bytes)
+          .set<3>(consumer.limit_bytes)
+          .set<4>(consumer.min_bytes)
+          .set<5>(consumer.stalls);
+    }
+
+    auto tables = run_on_worker_pool(processor, WorkerType::GENERAL, [&]() {
+      InfoMemoryTable t(table);
+      ServerWorker* w = ServerWorker::onThisThread();
+      const RealTimeRecordBuffer& buffer =
+          w->serverReadStreams().getRealTimeRecordBuffer();
+      t.next()
+          .set<0>("real_time_buffer")
+          .set<1>(w->getName())
+          .set<2>(buffer.bytes())
+          .set<3>(buffer.maxBytes());
+      t.next()
+          .set<0>("sender_outbufs")
+          .set<1>(w->getName())
+          .set<2>(w->sender().getBytesPending())
+          .set<3>(w->settings().outbufs_mb_max_per_thread * 1024 * 1024);
+      return t;
+    });
+    for (auto& t : tables) {
+      table.mergeWith(std::move(t));
+    }
+
+    StatsHolder* stats = server_->getParameters()->getStats();
+    if (stats != nullptr) {
+      table.next()
+          .set<0>("record_cache")
+          .set<1>("all shards")
+          .set<2>(int64_t(
+              stats->aggregate().record_cache_bytes_cached_estimate))
+          .set<3>(processor->settings()->record_cache_max_size);
+    }
+
+    json_ ? table.printJson(out_) : table.print(out_);
+  }
+};
+
+}}} // namespace facebook::logdevice::commands
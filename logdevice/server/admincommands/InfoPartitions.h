@@ -82,6 +82,8 @@ class InfoPartitions : public AdminCommand {
                               "Durable Max Time",
                               "Append Dirtied By",
                               "Rebuild Dirtied By",
+                              "Spare Partitions",
+                              "Drop Pending",
                               // Level 2
                               "Approx. Obsolete Bytes");
 
@@ -118,6 +120,8 @@ class InfoPartitions : public AdminCommand {
         }
 
         auto partitions = partitioned_store->getPartitionList();
+        partition_id_t drop_target =
+            partitioned_store->getPartitionDropTarget();
 
         for (auto partition : *partitions) {
           table.next()
@@ -172,18 +176,20 @@ class InfoPartitions : public AdminCommand {
             folly::SharedMutex::ReadHolder lock(partition->mutex_);
             PartitionDirtyMetadata meta = partition->dirty_state_.metadata();
             table.set<19>(toString(meta.getDirtiedBy(DataClass::APPEND)))
-                .set<20>(toString(meta.getDirtiedBy(DataClass::REBUILD)));
+                .set<20>(toString(meta.getDirtiedBy(DataClass::REBUILD)))
+                .set<21>(partitioned_store->getNumSparePartitions())
+                .set<22>(partition->id_ < drop_target);
           }
 
           if (level_ >= 2) {
-            table.set<21>(
+            table.set<23>(
                 partitioned_store->getApproximateObsoleteBytes(partition->id_));
           }
         }
       }
     }
 
-    constexpr std::array<int, maxLevel() + 1> num_stats_per_level = {8, 13, 1};
+    constexpr std::array<int, maxLevel() + 1> num_stats_per_level = {8, 15, 1};
     static_assert(table.numCols() ==
                       num_stats_per_level[0] + num_stats_per_level[1] +
                           num_stats_per_level[2],
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <folly/Memory.h>
+#include <folly/Optional.h>
 
 #include "logdevice/common/AdminCommandTable.h"
 #include "logdevice/common/Processor.h"
@@ -22,18 +23,24 @@ namespace facebook { namespace logdevice { namespace commands {
 class InfoPurges : public AdminCommand {
  private:
   bool json_ = false;
+  folly::Optional<logid_t> log_id_;
 
  public:
   void getOptions(
       boost::program_options::options_description& out_options) override {
     out_options.add_options()(
-        "json", boost::program_options::bool_switch(&json_));
+        "json", boost::program_options::bool_switch(&json_))(
+        "logid",
+        boost::program_options::value<logid_t::raw_type>()->notifier(
+            [this](logid_t::raw_type id) { log_id_ = logid_t(id); }));
   }
   void getPositionalOptions(
-      boost::program_options::positional_options_description& /*out_options*/)
-      override {}
+      boost::program_options::positional_options_description& out_options)
+      override {
+    out_options.add("logid", 1);
+  }
   std::string getUsage() override {
-    return "info purges [--json]";
+    return "info purges [<logid>] [--json]";
   }
 
   void run() override {
@@ -50,6 +57,9 @@ class InfoPurges : public AdminCommand {
       InfoPurgesTable t(table);
       ServerWorker* w = ServerWorker::onThisThread();
       for (auto& it : w->activePurges().map) {
+        if (log_id_.hasValue() && it.getKey().log_id != log_id_.value()) {
+          continue;
+        }
         it.getDebugInfo(t);
       }
       return t;
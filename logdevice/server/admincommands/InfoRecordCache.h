@@ -16,7 +16,9 @@ namespace facebook { namespace logdevice { namespace commands {
 class InfoRecordCache : public AdminCommand {
   folly::Optional<logid_t> log_id_;
   shard_index_t shard_ = -1;
+  bool shards_ = false;
   bool json_ = false;
+  bool binary_ = false;
 
  public:
   void getOptions(boost::program_options::options_description& opts) override {
@@ -25,7 +27,9 @@ class InfoRecordCache : public AdminCommand {
         boost::program_options::value<logid_t::raw_type>()->notifier(
             [this](logid_t::raw_type id) { log_id_ = logid_t(id); }))(
         "shard", boost::program_options::value<shard_index_t>(&shard_))(
-        "json", boost::program_options::bool_switch(&json_));
+        "shards", boost::program_options::bool_switch(&shards_))(
+        "json", boost::program_options::bool_switch(&json_))(
+        "binary", boost::program_options::bool_switch(&binary_));
   }
 
   void getPositionalOptions(
@@ -35,7 +39,8 @@ class InfoRecordCache : public AdminCommand {
   }
 
   std::string getUsage() override {
-    return "info record_cache [<logid>] [--shard <shard>] [--json]";
+    return "info record_cache [<logid>] [--shard <shard>] [--shards] "
+           "[--json] [--binary]";
   }
 
   void run() override {
@@ -64,7 +69,12 @@ class InfoRecordCache : public AdminCommand {
     LogStorageStateMap& state_map =
         server_->getServerProcessor()->getLogStorageStateMap();
 
-    InfoRecordCacheTable table(!json_,
+    if (shards_) {
+      printShards(state_map, num_shards);
+      return;
+    }
+
+    InfoRecordCacheTable table(!json_ && !binary_,
                                "Log ID",
                                "Shard",
                                "Epoch",
@@ -107,7 +117,70 @@ class InfoRecordCache : public AdminCommand {
       }
     }
 
-    json_ ? table.printJson(out_) : table.print(out_);
+    if (binary_) {
+      table.printBinary(out_);
+    } else {
+      json_ ? table.printJson(out_) : table.print(out_);
+    }
+  }
+
+ private:
+  // Prints a summary of the record caches of each shard: their budget, size,
+  // hits and misses, and evictions.
+  void printShards(LogStorageStateMap& state_map, shard_size_t num_shards) {
+    InfoRecordCacheShardsTable table(!json_ && !binary_,
+                                     "Shard",
+                                     "Budget Bytes",
+                                     "Payload Bytes",
+                                     "Digest Hits",
+                                     "Digest Misses",
+                                     "Seal Hits",
+                                     "Seal Misses",
+                                     "Evictions",
+                                     "Bytes Evicted");
+    const RecordCacheMonitorThread* monitor =
+        state_map.getRecordCacheMonitor();
+    StatsHolder* stats = server_->getParameters()->getStats();
+    folly::Optional<Stats> agg;
+    if (stats != nullptr) {
+      agg = stats->aggregate();
+    }
+
+    for (shard_index_t s = 0; s < num_shards; ++s) {
+      if (shard_ != -1 && s != shard_) {
+        continue;
+      }
+      size_t payload_bytes = 0;
+      state_map.forEachLogOnShard(
+          s, [&](logid_t /*logid*/, const LogStorageState& state) {
+            if (state.record_cache_) {
+              payload_bytes += state.record_cache_->getPayloadSizeEstimate();
+            }
+            return 0;
+          });
+      table.next()
+          .set<0>(s)
+          .set<1>(monitor ? monitor->getShardBudget(s) : 0)
+          .set<2>(payload_bytes);
+      const PerShardStats* shard_stats =
+          agg.hasValue() && agg->per_shard_stats
+          ? agg->per_shard_stats->get(s)
+          : nullptr;
+      if (shard_stats != nullptr) {
+        table.set<3>(uint64_t(shard_stats->record_cache_digest_hit))
+            .set<4>(uint64_t(shard_stats->record_cache_digest_miss))
+            .set<5>(uint64_t(shard_stats->record_cache_seal_hit))
+            .set<6>(uint64_t(shard_stats->record_cache_seal_miss))
+            .set<7>(uint64_t(shard_stats->record_cache_monitor_evictions))
+            .set<8>(uint64_t(shard_stats->record_cache_monitor_bytes_evicted));
+      }
+    }
+
+    if (binary_) {
+      table.printBinary(out_);
+    } else {
+      json_ ? table.printJson(out_) : table.print(out_);
+    }
   }
 };
 
@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <map>
+
+#include "logdevice/common/AdminCommandTable.h"
+#include "logdevice/common/WatchDogThread.h"
+#include "logdevice/server/AdminCommand.h"
+
+namespace facebook { namespace logdevice { namespace commands {
+
+/**
+ * Dumps the samples of the watchdog's stall profiler, see
+ * watchdog-stall-profiler-threshold. With --folded, aggregates them into
+ * lines of "<run state>;<frames> <count>" that flame graph tools take.
+ */
+class InfoStalls : public AdminCommand {
+ private:
+  bool json_ = false;
+  bool folded_ = false;
+
+  typedef AdminCommandTable<std::string,               // Worker
+                            std::string,               // Run state
+                            std::chrono::milliseconds, // Stalled for
+                            std::chrono::milliseconds, // Ms ago
+                            std::string                // Stack
+                            >
+      InfoStallsTable;
+
+ public:
+  void getOptions(
+      boost::program_options::options_description& out_options) override {
+    out_options.add_options()(
+        "json", boost::program_options::bool_switch(&json_))(
+        "folded", boost::program_options::bool_switch(&folded_));
+  }
+
+  std::string getUsage() override {
+    return "info stalls [--json] [--folded]";
+  }
+
+  void run() override {
+    WatchDogThread* watchdog = server_->getProcessor()->getWatchDogThread();
+    if (watchdog == nullptr) {
+      out_.printf("Watchdog is not running\r\n");
+      return;
+    }
+    auto samples = watchdog->getStallSamples();
+
+    if (folded_) {
+      std::map<std::string, size_t> counts;
+      for (const auto& sample : samples) {
+        std::string key = sample.run_state;
+        if (!sample.stack.empty()) {
+          key += ';' + sample.stack;
+        }
+        ++counts[key];
+      }
+      for (const auto& kv : counts) {
+        out_.printf("%s %zu\r\n", kv.first.c_str(), kv.second);
+      }
+      return;
+    }
+
+    InfoStallsTable table(
+        !json_, "Worker", "Run state", "Stalled for", "Ms ago", "Stack");
+    const auto now = std::chrono::system_clock::now();
+    for (const auto& sample : samples) {
+      table.next()
+          .set<0>(sample.worker)
+          .set<1>(sample.run_state)
+          .set<2>(sample.duration)
+          .set<3>(std::chrono::duration_cast<std::chrono::milliseconds>(
+              now - sample.time))
+          .set<4>(sample.stack);
+    }
+    json_ ? table.printJson(out_) : table.print(out_);
+  }
+};
+
+}}} // namespace facebook::logdevice::commands
@@ -8,6 +8,8 @@
 #pragma once
 
 #include "logdevice/common/AdminCommandTable.h"
+#include "logdevice/common/stats/PerShardHistograms.h"
+#include "logdevice/common/stats/Stats.h"
 #include "logdevice/server/AdminCommand.h"
 #include "logdevice/server/ServerProcessor.h"
 #include "logdevice/server/locallogstore/PartitionedRocksDBStore.h"
@@ -17,14 +19,26 @@ namespace facebook { namespace logdevice { namespace commands {
 
 class InfoStorageTasks : public AdminCommand {
  private:
+  using LatenciesTable = AdminCommandTable<uint64_t,    // Shard
+                                           std::string, // Group
+                                           std::string, // Name
+                                           std::string, // Stage
+                                           uint64_t,    // Count
+                                           double,      // p50
+                                           double,      // p99
+                                           double       // Max
+                                           >;
+
   shard_index_t shard_ = -1;
   bool json_ = false;
+  bool latencies_ = false;
 
  public:
   virtual void getOptions(
       boost::program_options::options_description& out_options) override {
     out_options.add_options()(
         "shard", boost::program_options::value<shard_index_t>(&shard_))(
+        "latencies", boost::program_options::bool_switch(&latencies_))(
         "json", boost::program_options::bool_switch(&json_));
   }
   virtual void getPositionalOptions(
@@ -33,10 +47,15 @@ class InfoStorageTasks : public AdminCommand {
     out_options.add("shard", 1);
   }
   virtual std::string getUsage() override {
-    return "info storage_tasks [<shard>] [--json]";
+    return "info storage_tasks [<shard>] [--latencies] [--json]";
   }
 
   virtual void run() override {
+    if (latencies_) {
+      printLatencies();
+      return;
+    }
+
     InfoStorageTasksTable table(!json_,
                                 "Shard",
                                 "Priority",
@@ -50,7 +69,9 @@ class InfoStorageTasks : public AdminCommand {
                                 "LSN",
                                 "Client ID",
                                 "Client address",
-                                "Extra info");
+                                "Extra info",
+                                "Stealable",
+                                "Shard tasks stolen");
 
     if (!server_->getProcessor()->runningOnStorageNode()) {
       if (!json_) {
@@ -90,6 +111,100 @@ class InfoStorageTasks : public AdminCommand {
       table.print(out_, table.numCols());
     }
   }
+
+ private:
+  // With --latencies, prints percentiles of the storage task latency
+  // histograms of each shard instead of the pending tasks: time spent in the
+  // storage thread queue (by task type and by priority), executing, and
+  // waiting for the worker to process the response (by task type).
+  void printLatencies() {
+    LatenciesTable table(!json_,
+                         "Shard",
+                         "Group",
+                         "Name",
+                         "Stage",
+                         "Count",
+                         "p50 usec",
+                         "p99 usec",
+                         "Max usec");
+
+    auto statsh = server_->getParameters()->getStats();
+    if (!statsh || !server_->getProcessor()->runningOnStorageNode()) {
+      if (!json_) {
+        out_.printf("Not a storage node.\r\n\r\n");
+      }
+      return;
+    }
+    const shard_index_t num_shards =
+        server_->getShardedLocalLogStore()->numShards();
+    if (shard_ != -1 && (shard_ < 0 || shard_ >= num_shards)) {
+      if (!json_) {
+        out_.printf("Shard index %d out of range [0, %d]\r\n",
+                    shard_,
+                    num_shards - 1);
+      }
+      return;
+    }
+
+    Stats stats = statsh->aggregate();
+    ld_check(stats.per_shard_histograms);
+    const PerShardHistograms& hists = *stats.per_shard_histograms;
+
+    auto add = [&](shard_index_t shard,
+                   const char* group,
+                   const std::string& name,
+                   const char* stage,
+                   const ShardedHistogramBase& sharded) {
+      if (shard >= sharded.getNumShards()) {
+        return;
+      }
+      const MultiScaleHistogram* hist = sharded.get(shard);
+      const uint64_t count = hist->getCountAndSum().first;
+      if (count == 0) {
+        return;
+      }
+      table.next()
+          .set<0>(shard)
+          .set<1>(group)
+          .set<2>(name)
+          .set<3>(stage)
+          .set<4>(count)
+          .set<5>(hist->estimatePercentile(.5))
+          .set<6>(hist->estimatePercentile(.99))
+          .set<7>(hist->estimatePercentile(1));
+    };
+
+    for (shard_index_t shard = 0; shard < num_shards; ++shard) {
+      if (shard_ != -1 && shard != shard_) {
+        continue;
+      }
+      for (int i = 0; i < static_cast<int>(StorageTaskType::MAX); ++i) {
+        const std::string& name =
+            storageTaskTypeNames[static_cast<StorageTaskType>(i)];
+        add(shard, "type", name, "queue", hists.storage_task_queue_time[i]);
+        add(shard, "type", name, "execution", hists.storage_tasks[i]);
+        add(shard,
+            "type",
+            name,
+            "response",
+            hists.storage_task_response_time[i]);
+      }
+      for (int i = 0; i < static_cast<int>(StorageTaskPriority::NUM_PRIORITIES);
+           ++i) {
+        add(shard,
+            "priority",
+            storageTaskPriorityNames[static_cast<StorageTaskPriority>(i)],
+            "queue",
+            hists.storage_task_priority_queue_time[i]);
+      }
+    }
+
+    if (json_) {
+      table.printJson(out_);
+    } else {
+      table.print(out_);
+    }
+  }
 };
 
 }}} // namespace facebook::logdevice::commands
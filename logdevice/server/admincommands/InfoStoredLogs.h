@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <folly/Optional.h>
 #include <folly/ScopeGuard.h>
 
 #include "logdevice/common/AdminCommandTable.h"
@@ -27,23 +28,34 @@ class InfoStoredLogs : public AdminCommand {
  private:
   bool extended_ = false;
   bool json_ = false;
+  bool binary_ = false;
+  folly::Optional<logid_t> log_id_;
+  shard_index_t shard_ = -1;
 
  public:
   void getOptions(
       boost::program_options::options_description& out_options) override {
     out_options.add_options()(
         "extended", boost::program_options::bool_switch(&extended_))(
-        "json", boost::program_options::bool_switch(&json_));
+        "json", boost::program_options::bool_switch(&json_))(
+        "binary", boost::program_options::bool_switch(&binary_))(
+        "logid",
+        boost::program_options::value<logid_t::raw_type>()->notifier(
+            [this](logid_t::raw_type id) { log_id_ = logid_t(id); }))(
+        "shard", boost::program_options::value<shard_index_t>(&shard_));
   }
   void getPositionalOptions(
-      boost::program_options::positional_options_description& /*out_options*/)
-      override {}
+      boost::program_options::positional_options_description& out_options)
+      override {
+    out_options.add("logid", 1);
+  }
   std::string getUsage() override {
-    return "info stored_logs [--extended] [--json]";
+    return "info stored_logs [<logid>] [--shard <shard>] [--extended] "
+           "[--json] [--binary]";
   }
 
   void run() override {
-    InfoStoredLogsTable table(!json_,
+    InfoStoredLogsTable table(!json_ && !binary_,
                               "Log ID",
                               "Shard",
                               "Highest LSN",
@@ -54,6 +66,9 @@ class InfoStoredLogs : public AdminCommand {
       auto sharded_store = server_->getShardedLocalLogStore();
 
       for (int shard = 0; shard < sharded_store->numShards(); ++shard) {
+        if (shard_ != -1 && shard != shard_) {
+          continue;
+        }
         auto store = sharded_store->getByIndex(shard);
         auto partitioned_store = dynamic_cast<PartitionedRocksDBStore*>(store);
         if (partitioned_store == nullptr) {
@@ -69,6 +84,9 @@ class InfoStoredLogs : public AdminCommand {
                 lsn_t highest_lsn,
                 uint64_t highest_partition,
                 RecordTimestamp highest_timestamp_approx) {
+              if (log_id_.hasValue() && log != log_id_.value()) {
+                return;
+              }
               table.next().set<0>(log);
               if (extended_) {
                 table.set<1>((uint32_t)shard)
@@ -82,7 +100,11 @@ class InfoStoredLogs : public AdminCommand {
     }
 
     size_t columns = extended_ ? table.numCols() : 1;
-    json_ ? table.printJson(out_, columns) : table.print(out_, columns);
+    if (binary_) {
+      table.printBinary(out_, columns);
+    } else {
+      json_ ? table.printJson(out_, columns) : table.print(out_, columns);
+    }
   }
 };
 
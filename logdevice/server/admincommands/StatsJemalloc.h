@@ -7,6 +7,8 @@
  */
 #pragma once
 
+#include "logdevice/common/AdminCommandTable.h"
+#include "logdevice/common/JemallocArenas.h"
 #include "logdevice/common/config.h"
 #include "logdevice/server/AdminCommand.h"
 
@@ -121,6 +123,41 @@ class StatsJemallocProfDump : public AdminCommand {
   }
 };
 
+/**
+ * Bytes allocated in the arenas of each kind of thread and of each
+ * allocation tag, see JemallocArenas.
+ */
+class StatsJemallocArenas : public AdminCommand {
+ private:
+  bool json_ = false;
+
+ public:
+  void getOptions(
+      boost::program_options::options_description& out_options) override {
+    out_options.add_options()(
+        "json", boost::program_options::bool_switch(&json_));
+  }
+
+  std::string getUsage() override {
+    return "stats jemalloc arenas [--json]";
+  }
+
+  void run() override {
+    AdminCommandTable<std::string, // Arenas
+                      size_t,      // Count
+                      uint64_t     // Allocated bytes
+                      >
+        table(!json_, "Arenas", "Count", "Allocated bytes");
+    for (const auto& group : JemallocArenas::getStats()) {
+      table.next()
+          .set<0>(group.name)
+          .set<1>(group.num_arenas)
+          .set<2>(group.allocated_bytes);
+    }
+    json_ ? table.printJson(out_) : table.print(out_);
+  }
+};
+
 }}} // namespace facebook::logdevice::commands
 
 #endif // LOGDEVICE_USING_JEMALLOC
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <rocksdb/cache.h>
+#include <rocksdb/persistent_cache.h>
 
 #include "logdevice/server/AdminCommand.h"
 #include "logdevice/server/ServerProcessor.h"
@@ -155,6 +156,18 @@ class StatsRocks : public AdminCommand {
         table_options.block_cache_compressed.get(), "block_cache_compressed");
     printCacheUsage(
         metadata_table_options.block_cache.get(), "metadata_block_cache");
+#ifdef LOGDEVICED_ROCKSDB_HAS_PERSISTENT_CACHE
+    // Hits and misses of each shard are in the persistent.cache.* tickers.
+    if (table_options.persistent_cache) {
+      for (const auto& tier : table_options.persistent_cache->Stats()) {
+        for (const auto& stat : tier) {
+          out_.printf("STAT rocksdb.persistent_cache.%s %.0f\r\n",
+                      stat.first.c_str(),
+                      stat.second);
+        }
+      }
+    }
+#endif
   }
 
   void printCacheUsage(rocksdb::Cache* cache, const std::string& key) {
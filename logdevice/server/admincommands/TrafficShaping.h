@@ -8,13 +8,20 @@
 #pragma once
 
 #include <algorithm>
+#include <map>
+#include <tuple>
 
 #include <folly/ScopeGuard.h>
 
+#include "logdevice/common/FlowGroup.h"
 #include "logdevice/common/Priority.h"
 #include "logdevice/common/PriorityMap.h"
+#include "logdevice/common/Sender.h"
+#include "logdevice/common/Socket.h"
+#include "logdevice/common/Worker.h"
 #include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/configuration/NodeLocation.h"
+#include "logdevice/common/request_util.h"
 #include "logdevice/server/AdminCommand.h"
 
 namespace facebook { namespace logdevice { namespace commands {
@@ -29,6 +36,7 @@ class TrafficShaping : public AdminCommand {
   bool clear_{false};
   bool enable_{false};
   bool disable_{false};
+  bool fair_queue_shares_{false};
   int64_t guaranteed_bytes_per_second_{-1};
   int64_t max_bytes_per_second_{-1};
   int64_t max_burst_bytes_{-1};
@@ -43,6 +51,8 @@ class TrafficShaping : public AdminCommand {
         boost::program_options::value<std::string>(&read_traffic_class_))(
         "disable", boost::program_options::bool_switch(&disable_))(
         "enable", boost::program_options::bool_switch(&enable_))(
+        "fair-queue-shares",
+        boost::program_options::bool_switch(&fair_queue_shares_))(
         "priority",
         boost::program_options::value<std::string>(&priority_name_))(
         "guaranteed-bytes-per-second",
@@ -55,6 +65,7 @@ class TrafficShaping : public AdminCommand {
   std::string getUsage() override {
     return "traffic_shaping "
            "[--clear-local-overrides]"
+           "[--fair-queue-shares]"
            "[--default-read-traffic-class=NAME]"
            "[--scope=NAME|ALL"
            " [--enable|--disable]"
@@ -65,6 +76,11 @@ class TrafficShaping : public AdminCommand {
   }
 
   void run() override {
+    if (fair_queue_shares_) {
+      printFairQueueShares();
+      return;
+    }
+
     if (clear_) {
       auto& config = server_->getProcessor()->config_;
       auto result = config->updateableServerConfig()->updateOverrides(
@@ -269,6 +285,63 @@ class TrafficShaping : public AdminCommand {
     }
     ld_check(result == 0);
   }
+
+ private:
+  // Bytes each peer sent through each FlowGroup and priority, its share of
+  // the total, and how many of its callbacks are waiting for bandwidth.
+  void printFairQueueShares() {
+    using Key = std::tuple<NodeLocationScope, Priority, std::string>;
+    struct Share {
+      uint64_t bytes = 0;
+      size_t queued = 0;
+    };
+
+    auto per_worker = run_on_all_workers(server_->getProcessor(), [&]() {
+      std::map<Key, Share> shares;
+      Worker::onThisThread()->sender().forEachSocket([&](const Socket& sock) {
+        for (Priority p = Priority::MAX; p < Priority::NUM_PRIORITIES;
+             p = priorityBelow(p)) {
+          const uint64_t bytes = sock.getFlowGroupBytesReleased(p);
+          const size_t queued = sock.flow_group_.queuedCallbacks(p, &sock);
+          if (bytes == 0 && queued == 0) {
+            continue;
+          }
+          Key key(sock.flow_group_.scope(),
+                  p,
+                  Sender::describeConnection(sock.peer_name_));
+          auto& share = shares[key];
+          share.bytes += bytes;
+          share.queued += queued;
+        }
+      });
+      return shares;
+    });
+
+    std::map<Key, Share> shares;
+    std::map<std::pair<NodeLocationScope, Priority>, uint64_t> totals;
+    for (auto& worker_shares : per_worker) {
+      for (auto& kv : worker_shares) {
+        auto& share = shares[kv.first];
+        share.bytes += kv.second.bytes;
+        share.queued += kv.second.queued;
+        totals[std::make_pair(std::get<0>(kv.first), std::get<1>(kv.first))] +=
+            kv.second.bytes;
+      }
+    }
+
+    for (auto& kv : shares) {
+      const uint64_t total = totals[std::make_pair(std::get<0>(kv.first),
+                                                   std::get<1>(kv.first))];
+      out_.printf("traffic_shaping::%s::%s::%s bytes=%ju share=%.1f%% "
+                  "queued=%zu\r\n",
+                  NodeLocation::scopeNames()[std::get<0>(kv.first)].c_str(),
+                  PriorityMap::toName()[std::get<1>(kv.first)].c_str(),
+                  std::get<2>(kv.first).c_str(),
+                  (uintmax_t)kv.second.bytes,
+                  total == 0 ? 0.0 : 100.0 * kv.second.bytes / total,
+                  kv.second.queued);
+    }
+  }
 };
 
 }}} // namespace facebook::logdevice::commands
@@ -100,6 +100,14 @@ class FailingLocalLogStore : public LocalLogStore {
     return -1;
   }
 
+  int readLogSnapshotBlobs(LogSnapshotBlobType,
+                           logid_t,
+                           logid_t,
+                           LogSnapshotBlobCallback) override {
+    err = E::NOTSUPPORTED;
+    return -1;
+  }
+
   int writeLogSnapshotBlobs(
       LogSnapshotBlobType,
       const std::vector<std::pair<logid_t, Slice>>&) override {
@@ -0,0 +1,437 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/locallogstore/HotPartitionCache.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "logdevice/common/LocalLogStoreRecordFormat.h"
+#include "logdevice/common/debug.h"
+
+namespace facebook { namespace logdevice {
+
+// ====== LogRecords ======
+
+size_t HotPartitionCache::LogRecords::lowerBound(lsn_t lsn) const {
+  folly::SharedMutex::ReadHolder lock(mutex_);
+  auto end = records_.begin() + num_visible_;
+  return std::lower_bound(records_.begin(),
+                          end,
+                          lsn,
+                          [](const Record& r, lsn_t l) { return r.lsn < l; }) -
+      records_.begin();
+}
+
+bool HotPartitionCache::LogRecords::get(size_t idx, Record* out) const {
+  folly::SharedMutex::ReadHolder lock(mutex_);
+  if (idx >= num_visible_) {
+    return false;
+  }
+  *out = records_[idx];
+  return true;
+}
+
+size_t HotPartitionCache::LogRecords::append(lsn_t lsn,
+                                             const Slice& header,
+                                             const Slice& data) {
+  ld_check(lsn > lastLSN());
+  const size_t size = header.size + data.size;
+  size_t allocated = sizeof(Record);
+
+  folly::SharedMutex::WriteHolder lock(mutex_);
+  char* dst;
+  if (size > BLOCK_SIZE) {
+    // Dedicated block. Insert it before the last block, which is the one
+    // being filled.
+    auto pos = blocks_.empty() ? blocks_.end() : blocks_.end() - 1;
+    dst = blocks_.emplace(pos, new char[size])->get();
+    allocated += size;
+  } else {
+    if (block_used_ + size > BLOCK_SIZE) {
+      blocks_.emplace_back(new char[BLOCK_SIZE]);
+      block_used_ = 0;
+      allocated += BLOCK_SIZE;
+    }
+    dst = blocks_.back().get() + block_used_;
+    block_used_ += size;
+  }
+  if (header.size) {
+    memcpy(dst, header.data, header.size);
+  }
+  if (data.size) {
+    memcpy(dst + header.size, data.data, data.size);
+  }
+  records_.push_back(Record{lsn, Slice(dst, size)});
+  bytes_ += allocated;
+  return allocated;
+}
+
+void HotPartitionCache::LogRecords::publish(FlushToken flush_token) {
+  folly::SharedMutex::WriteHolder lock(mutex_);
+  num_visible_ = records_.size();
+  flush_token_ = std::max(flush_token_, flush_token);
+}
+
+// ====== HotPartitionCache ======
+
+HotPartitionCache::~HotPartitionCache() {
+  clear();
+}
+
+std::shared_ptr<HotPartitionCache::LogRecords>
+HotPartitionCache::find(logid_t log, lsn_t lsn) const {
+  folly::SharedMutex::ReadHolder lock(mutex_);
+  auto it = logs_.find(log);
+  if (it == logs_.end() || lsn < it->second->firstLSN() ||
+      !it->second->valid()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+void HotPartitionCache::dropLocked(logid_t log) {
+  auto it = logs_.find(log);
+  if (it == logs_.end()) {
+    return;
+  }
+  it->second->valid_.store(false);
+  total_bytes_.fetch_sub(it->second->bytes_);
+  STAT_SUB(stats_, hot_partition_cache_bytes, it->second->bytes_);
+  logs_.erase(it);
+}
+
+void HotPartitionCache::clear(partition_id_t partition) {
+  folly::SharedMutex::WriteHolder lock(mutex_);
+  while (!logs_.empty()) {
+    dropLocked(logs_.begin()->first);
+  }
+  partition_.store(partition);
+}
+
+void HotPartitionCache::onFlushed(FlushToken flushed_up_through) {
+  folly::SharedMutex::WriteHolder lock(mutex_);
+  for (auto it = logs_.begin(); it != logs_.end();) {
+    logid_t log = it->first;
+    bool flushed = it->second->flush_token_ <= flushed_up_through;
+    ++it;
+    if (flushed) {
+      dropLocked(log);
+    }
+  }
+}
+
+// ====== WriteBatch ======
+
+HotPartitionCache::WriteBatch::WriteBatch(HotPartitionCache* cache,
+                                          partition_id_t newest_partition)
+    : cache_(cache), partition_(newest_partition) {
+  if (cache_ != nullptr && cache_->getPartition() < partition_) {
+    // First write after a new partition was created. Records of the previous
+    // partition are not needed by anyone who could read from the new one.
+    cache_->clear(partition_);
+  }
+}
+
+HotPartitionCache::WriteBatch::~WriteBatch() {
+  if (cache_ == nullptr || committed_ || touched_.empty()) {
+    return;
+  }
+  // The write failed. The appended records may or may not be in rocksdb.
+  folly::SharedMutex::WriteHolder lock(cache_->mutex_);
+  for (auto& t : touched_) {
+    auto it = cache_->logs_.find(t.first);
+    if (it != cache_->logs_.end() && it->second == t.second) {
+      cache_->dropLocked(t.first);
+    }
+  }
+}
+
+void HotPartitionCache::WriteBatch::onRecordWrite(const WriteOp& op,
+                                                  partition_id_t partition,
+                                                  lsn_t max_lsn_before) {
+  if (cache_ == nullptr ||
+      (op.getType() != WriteType::PUT && op.getType() != WriteType::DELETE)) {
+    return;
+  }
+  const RecordWriteOp& record_op = static_cast<const RecordWriteOp&>(op);
+  const logid_t log = record_op.log_id;
+  const lsn_t lsn = record_op.lsn;
+
+  // Can the write be appended to the end of the log's list?
+  bool appendable = op.getType() == WriteType::PUT &&
+      partition == partition_ && cache_->getPartition() == partition_;
+  if (appendable) {
+    LocalLogStoreRecordFormat::flags_t flags;
+    const PutWriteOp& put_op = static_cast<const PutWriteOp&>(op);
+    appendable = LocalLogStoreRecordFormat::parseFlags(
+                     put_op.record_header, &flags) == 0 &&
+        !(flags & LocalLogStoreRecordFormat::FLAG_AMEND);
+  }
+
+  std::shared_ptr<LogRecords> to_create;
+  {
+    folly::SharedMutex::ReadHolder lock(cache_->mutex_);
+    auto it = cache_->logs_.find(log);
+    if (it != cache_->logs_.end()) {
+      if (lsn < it->second->firstLSN()) {
+        // Not in the range covered by the list.
+        return;
+      }
+      if (appendable && lsn > it->second->lastLSN() &&
+          appendLocked(log, it->second, static_cast<const PutWriteOp&>(op))) {
+        return;
+      }
+      // Can't keep the list consistent, drop it below. It'll be recreated by
+      // a later in-order append.
+    } else if (!appendable ||
+               (max_lsn_before != LSN_INVALID && lsn <= max_lsn_before)) {
+      // The log may have records with higher LSNs than this one, a list
+      // starting here wouldn't cover them.
+      return;
+    } else {
+      to_create = std::make_shared<LogRecords>(lsn);
+    }
+  }
+
+  folly::SharedMutex::WriteHolder lock(cache_->mutex_);
+  if (to_create == nullptr) {
+    cache_->dropLocked(log);
+    STAT_INCR(cache_->stats_, hot_partition_cache_drops);
+    touched_.erase(
+        std::remove_if(touched_.begin(),
+                       touched_.end(),
+                       [&](const auto& t) { return t.first == log; }),
+        touched_.end());
+    return;
+  }
+  // There's no race with other writers creating a list for this log: they
+  // would need to lock the log's LogState::mutex first. But the cache could
+  // have been cleared for a newer partition.
+  if (cache_->getPartition() == partition_ &&
+      appendLocked(log, to_create, static_cast<const PutWriteOp&>(op))) {
+    cache_->logs_[log] = std::move(to_create);
+  }
+}
+
+bool HotPartitionCache::WriteBatch::appendLocked(
+    logid_t log,
+    const std::shared_ptr<LogRecords>& records,
+    const PutWriteOp& op) {
+  size_t size = op.record_header.size + op.data.size;
+  if (cache_->total_bytes_.load() + size > cache_->max_bytes_.load()) {
+    STAT_INCR(cache_->stats_, hot_partition_cache_over_budget);
+    return false;
+  }
+  size_t allocated = records->append(op.lsn, op.record_header, op.data);
+  cache_->total_bytes_.fetch_add(allocated);
+  STAT_ADD(cache_->stats_, hot_partition_cache_bytes, allocated);
+  STAT_INCR(cache_->stats_, hot_partition_cache_records_appended);
+  for (const auto& t : touched_) {
+    if (t.first == log) {
+      return true;
+    }
+  }
+  touched_.emplace_back(log, records);
+  return true;
+}
+
+void HotPartitionCache::WriteBatch::commit(FlushToken flush_token) {
+  if (cache_ == nullptr) {
+    return;
+  }
+  committed_ = true;
+  // Hold the lock so that onFlushed() sees either no records or the records
+  // together with their flush token.
+  folly::SharedMutex::ReadHolder lock(cache_->mutex_);
+  for (auto& t : touched_) {
+    t.second->publish(flush_token);
+  }
+}
+
+// ====== Iterator ======
+
+HotPartitionCache::Iterator::Iterator(
+    const LocalLogStore* store,
+    const HotPartitionCache* cache,
+    logid_t log_id,
+    std::unique_ptr<LocalLogStore::ReadIterator> fallback,
+    std::function<bool()> can_use_cache)
+    : LocalLogStore::ReadIterator(store),
+      cache_(cache),
+      log_id_(log_id),
+      fallback_(std::move(fallback)),
+      can_use_cache_(std::move(can_use_cache)) {
+  ld_check(fallback_ != nullptr);
+}
+
+IteratorState HotPartitionCache::Iterator::state() const {
+  return records_ ? state_ : fallback_->state();
+}
+
+bool HotPartitionCache::Iterator::accessedUnderReplicatedRegion() const {
+  // The cache is only used while nothing in the store is under-replicated.
+  return records_ ? false : fallback_->accessedUnderReplicatedRegion();
+}
+
+lsn_t HotPartitionCache::Iterator::getLSN() const {
+  if (!records_) {
+    return fallback_->getLSN();
+  }
+  ld_check(state_ == IteratorState::AT_RECORD ||
+           state_ == IteratorState::LIMIT_REACHED);
+  return current_.lsn;
+}
+
+Slice HotPartitionCache::Iterator::getRecord() const {
+  if (!records_) {
+    return fallback_->getRecord();
+  }
+  ld_check(state_ == IteratorState::AT_RECORD);
+  return current_.blob;
+}
+
+void HotPartitionCache::Iterator::seek(lsn_t lsn,
+                                       LocalLogStore::ReadFilter* filter,
+                                       LocalLogStore::ReadStats* stats) {
+  records_ = can_use_cache_() ? cache_->find(log_id_, lsn) : nullptr;
+  if (!records_) {
+    STAT_INCR(cache_->stats_, hot_partition_cache_seek_misses);
+    fallback_->seek(lsn, filter, stats);
+    return;
+  }
+  STAT_INCR(cache_->stats_, hot_partition_cache_seek_hits);
+  pos_ = records_->lowerBound(lsn);
+  moveUntilValid(lsn, /* is_seek */ true, filter, stats);
+}
+
+void HotPartitionCache::Iterator::next(LocalLogStore::ReadFilter* filter,
+                                       LocalLogStore::ReadStats* stats) {
+  if (!records_) {
+    fallback_->next(filter, stats);
+    return;
+  }
+  ld_check_eq(state_, IteratorState::AT_RECORD);
+  ++pos_;
+  moveUntilValid(current_.lsn + 1, /* is_seek */ false, filter, stats);
+}
+
+void HotPartitionCache::Iterator::seekForPrev(lsn_t lsn) {
+  // Backward iteration is rare, always use the regular iterator for it.
+  records_.reset();
+  fallback_->seekForPrev(lsn);
+}
+
+void HotPartitionCache::Iterator::prev() {
+  if (!records_) {
+    fallback_->prev();
+    return;
+  }
+  ld_check_eq(state_, IteratorState::AT_RECORD);
+  ld_check_gt(current_.lsn, LSN_INVALID);
+  seekForPrev(current_.lsn - 1);
+}
+
+void HotPartitionCache::Iterator::fallBack(lsn_t lsn,
+                                           LocalLogStore::ReadFilter* filter,
+                                           LocalLogStore::ReadStats* stats) {
+  STAT_INCR(cache_->stats_, hot_partition_cache_fallbacks);
+  records_.reset();
+  fallback_->seek(lsn, filter, stats);
+}
+
+bool HotPartitionCache::Iterator::applyFilter(
+    const LogRecords::Record& record,
+    LocalLogStore::ReadFilter* filter) const {
+  // Amends are never added to the cache, so there are no dangling amends to
+  // skip. Without a filter there's nothing to parse.
+  if (filter == nullptr) {
+    return true;
+  }
+  std::array<ShardID, COPYSET_SIZE_MAX> copyset;
+  copyset_size_t copyset_size;
+  LocalLogStoreRecordFormat::flags_t flags;
+  std::chrono::milliseconds timestamp;
+  int rv = LocalLogStoreRecordFormat::parse(record.blob,
+                                            &timestamp,
+                                            nullptr,
+                                            &flags,
+                                            nullptr,
+                                            &copyset_size,
+                                            &copyset[0],
+                                            copyset.size(),
+                                            nullptr,
+                                            nullptr,
+                                            nullptr,
+                                            -1 /* unused */);
+  if (rv != 0) {
+    // Same as the rocksdb-based iterators: if we can't parse the record,
+    // be conservative and assume it would pass the filter.
+    return true;
+  }
+  return (*filter)(log_id_,
+                   record.lsn,
+                   &copyset[0],
+                   copyset_size,
+                   LocalLogStoreRecordFormat::formCopySetIndexFlags(flags),
+                   RecordTimestamp(timestamp),
+                   RecordTimestamp(timestamp));
+}
+
+void HotPartitionCache::Iterator::moveUntilValid(
+    lsn_t target,
+    bool is_seek,
+    LocalLogStore::ReadFilter* filter,
+    LocalLogStore::ReadStats* stats) {
+  ld_check(records_);
+  if (stats) {
+    // See CSIWrapper::moveTo().
+    stats->last_read_lsn = LSN_INVALID;
+  }
+  bool made_progress = false;
+
+  while (true) {
+    if (!records_->valid()) {
+      // The list was dropped because of a write we can't reflect in it or
+      // because it got flushed. Continue from the regular iterator.
+      fallBack(target, filter, stats);
+      return;
+    }
+
+    LogRecords::Record record;
+    if (!records_->get(pos_, &record)) {
+      // All records of the log with LSN >= first LSN of the list are in the
+      // list, so there are no more records.
+      state_ = IteratorState::AT_END;
+      return;
+    }
+
+    if (stats && stats->readLimitReached() &&
+        (made_progress || (is_seek && stats->hardLimitReached()))) {
+      state_ = IteratorState::LIMIT_REACHED;
+      current_ = LogRecords::Record{target, Slice()};
+      return;
+    }
+
+    bool passes = applyFilter(record, filter);
+    if (stats) {
+      stats->countRecord(record.lsn, record.blob.size, passes);
+    }
+    if (passes) {
+      state_ = IteratorState::AT_RECORD;
+      current_ = record;
+      return;
+    }
+
+    ++pos_;
+    target = record.lsn + 1;
+    made_progress = true;
+  }
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,272 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <folly/SharedMutex.h>
+#include <folly/small_vector.h>
+
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/common/types_internal.h"
+#include "logdevice/server/locallogstore/LocalLogStore.h"
+#include "logdevice/server/locallogstore/WriteOps.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file  In-memory copy of the records written to the newest partition of a
+ *        PartitionedRocksDBStore, used to serve tailing reads without creating
+ *        rocksdb iterators and doing memtable skiplist lookups.
+ *
+ *        For each log the cache keeps an append-only, LSN-ordered list of
+ *        records (payloads live in arena blocks owned by the list). The list
+ *        of a log covers LSN range [first_lsn, +inf): it contains all records
+ *        of the log with LSN >= first_lsn. Since LSN ranges of partitions
+ *        are disjoint and ordered (see the directory invariants in
+ *        PartitionedRocksDBStore::getWritePartition()), such records can only
+ *        be in the newest partition.
+ *
+ *        A log's list is created on the first record appended to the newest
+ *        partition with an LSN greater than all the LSNs the log has. Any
+ *        write that can't be appended in order (an amend, a delete, a
+ *        rewrite or an out-of-order store of an LSN >= first_lsn) drops the
+ *        list, and it is recreated by a later in-order append. Lists are also
+ *        dropped when the memtable holding their records gets flushed, when
+ *        a new partition is created and when the memory budget is exceeded.
+ *        Readers that still hold a dropped list notice it and fall back to
+ *        the regular iterator.
+ */
+
+class HotPartitionCache {
+ public:
+  class Iterator;
+  class WriteBatch;
+
+  // Records of one log in the newest partition.
+  class LogRecords {
+   public:
+    struct Record {
+      lsn_t lsn;
+      Slice blob;
+    };
+
+    explicit LogRecords(lsn_t first_lsn) : first_lsn_(first_lsn) {}
+
+    lsn_t firstLSN() const {
+      return first_lsn_;
+    }
+
+    // False if the list was dropped from the cache and may be missing some
+    // records.
+    bool valid() const {
+      return valid_.load();
+    }
+
+    // Index of the first visible record with LSN >= `lsn`. Equal to the number
+    // of visible records if there are none.
+    size_t lowerBound(lsn_t lsn) const;
+
+    // Returns false if there's no visible record at index `idx` (yet).
+    bool get(size_t idx, Record* out) const;
+
+   private:
+    friend class HotPartitionCache;
+    friend class WriteBatch;
+
+    // Size of arena blocks. Bigger records get dedicated blocks.
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    // Copies the record into the arena and adds it to the list, but doesn't
+    // make it visible to readers until publish(). Returns the number of bytes
+    // allocated.
+    size_t append(lsn_t lsn, const Slice& header, const Slice& data);
+    // Makes all appended records visible.
+    void publish(FlushToken flush_token);
+
+    lsn_t lastLSN() const {
+      return records_.empty() ? LSN_INVALID : records_.back().lsn;
+    }
+
+    const lsn_t first_lsn_;
+    std::atomic<bool> valid_{true};
+
+    // Only modified by writers holding the log's LogState::mutex, so writers
+    // can read the fields below without locking mutex_.
+    mutable folly::SharedMutex mutex_;
+    std::vector<Record> records_;
+    size_t num_visible_ = 0;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t block_used_ = BLOCK_SIZE;
+    size_t bytes_ = 0;
+    // Records are durable in sst files when this token is flushed.
+    FlushToken flush_token_ = FlushToken_INVALID;
+  };
+
+  HotPartitionCache(size_t max_bytes, StatsHolder* stats)
+      : max_bytes_(max_bytes), stats_(stats) {}
+
+  ~HotPartitionCache();
+
+  // Returns the records of `log` if they cover `lsn`, nullptr otherwise.
+  std::shared_ptr<LogRecords> find(logid_t log, lsn_t lsn) const;
+
+  // The newest partition, whose records are cached.
+  partition_id_t getPartition() const {
+    return partition_.load();
+  }
+
+  // Drops all records. If `partition` is not PARTITION_INVALID, it'll be
+  // cached from now on; this is called when a new partition is created.
+  void clear(partition_id_t partition = PARTITION_INVALID);
+
+  // Drops the records that are durable in sst files as of flush token
+  // `flushed_up_through`.
+  void onFlushed(FlushToken flushed_up_through);
+
+  void setMaxBytes(size_t max_bytes) {
+    max_bytes_.store(max_bytes);
+  }
+
+  size_t getTotalBytes() const {
+    return total_bytes_.load();
+  }
+
+ private:
+  // Removes the records of `log` from the map and marks them invalid.
+  // Must be called with mutex_ locked exclusively.
+  void dropLocked(logid_t log);
+
+  std::atomic<size_t> max_bytes_;
+  std::atomic<size_t> total_bytes_{0};
+  std::atomic<partition_id_t> partition_{PARTITION_INVALID};
+  StatsHolder* stats_;
+
+  mutable folly::SharedMutex mutex_;
+  std::unordered_map<logid_t, std::shared_ptr<LogRecords>, logid_t::Hash> logs_;
+};
+
+/**
+ * Collects the cache updates of one PartitionedRocksDBStore::writeMulti()
+ * call. Records are appended while the target partitions are being decided
+ * (with locked LogState::mutex'es of the logs) but only become visible to
+ * readers on commit(), after the batch was written to rocksdb. If the batch
+ * is destroyed without commit(), the lists it touched are dropped.
+ */
+class HotPartitionCache::WriteBatch {
+ public:
+  // `cache` can be nullptr, then all methods are no-ops.
+  // `newest_partition` is the ID of the newest partition at the time the
+  // write started.
+  WriteBatch(HotPartitionCache* cache, partition_id_t newest_partition);
+  ~WriteBatch();
+
+  // Called for each PUT and DELETE of a partitioned log after picking the
+  // target partition. `max_lsn_before` is the highest LSN the log had in any
+  // partition before this op, or LSN_INVALID if the log was empty.
+  void onRecordWrite(const WriteOp& op,
+                     partition_id_t partition,
+                     lsn_t max_lsn_before);
+
+  // Publishes the appended records. `flush_token` is the store's
+  // maxFlushToken() after the write.
+  void commit(FlushToken flush_token);
+
+ private:
+  // Appends the record of `op` to `records` and adds `records` to touched_.
+  // Must be called with the cache's mutex_ locked (in any mode). Returns false
+  // if the cache is over its memory budget.
+  bool appendLocked(logid_t log,
+                    const std::shared_ptr<LogRecords>& records,
+                    const PutWriteOp& op);
+
+  HotPartitionCache* cache_;
+  partition_id_t partition_;
+  bool committed_ = false;
+  folly::small_vector<std::pair<logid_t, std::shared_ptr<LogRecords>>, 4>
+      touched_;
+};
+
+/**
+ * ReadIterator that reads from the cache while the requested LSNs are covered
+ * by it, and from `fallback` (the regular LogsDB iterator) otherwise.
+ * Supports filtering and read limits the same way as the rocksdb-based
+ * iterators. Each seek() consults `can_use_cache` first; the store uses it
+ * to avoid the cache when the setting is off or some partitions are
+ * under-replicated.
+ */
+class HotPartitionCache::Iterator : public LocalLogStore::ReadIterator {
+ public:
+  Iterator(const LocalLogStore* store,
+           const HotPartitionCache* cache,
+           logid_t log_id,
+           std::unique_ptr<LocalLogStore::ReadIterator> fallback,
+           std::function<bool()> can_use_cache);
+
+  IteratorState state() const override;
+  bool accessedUnderReplicatedRegion() const override;
+
+  void prev() override;
+  void next(LocalLogStore::ReadFilter* filter = nullptr,
+            LocalLogStore::ReadStats* stats = nullptr) override;
+
+  void seek(lsn_t lsn,
+            LocalLogStore::ReadFilter* filter = nullptr,
+            LocalLogStore::ReadStats* stats = nullptr) override;
+  void seekForPrev(lsn_t lsn) override;
+  lsn_t getLSN() const override;
+  Slice getRecord() const override;
+
+  void setContextString(const char* str) override {
+    TrackableIterator::setContextString(str);
+    fallback_->setContextString(str);
+  }
+
+  size_t getIOBytesUnnormalized() const override {
+    return fallback_->getIOBytesUnnormalized();
+  }
+  size_t getIOBlocksUnnormalized() const override {
+    return fallback_->getIOBlocksUnnormalized();
+  }
+
+ private:
+  // Moves forward from index pos_ until a record passing `filter` is found,
+  // the end of the list is reached or a read limit is hit. Falls back to
+  // `fallback_` if the list gets dropped.
+  void moveUntilValid(lsn_t target,
+                      bool is_seek,
+                      LocalLogStore::ReadFilter* filter,
+                      LocalLogStore::ReadStats* stats);
+
+  // Returns false if the record is a dangling amend or doesn't pass the
+  // filter.
+  bool applyFilter(const LogRecords::Record& record,
+                   LocalLogStore::ReadFilter* filter) const;
+
+  // Leaves the cache and positions fallback_ with a seek to `lsn`.
+  void fallBack(lsn_t lsn,
+                LocalLogStore::ReadFilter* filter,
+                LocalLogStore::ReadStats* stats);
+
+  const HotPartitionCache* cache_;
+  const logid_t log_id_;
+  std::unique_ptr<LocalLogStore::ReadIterator> fallback_;
+  std::function<bool()> can_use_cache_;
+
+  // If not nullptr, the iterator is reading from the cache.
+  std::shared_ptr<LogRecords> records_;
+  size_t pos_ = 0;
+  LogRecords::Record current_{LSN_INVALID, Slice()};
+  IteratorState state_ = IteratorState::AT_END;
+};
+
+}} // namespace facebook::logdevice
@@ -169,6 +169,12 @@ int IteratorSearch::executeWithIndex(lsn_t* result_lo, lsn_t* result_hi) {
   rocksdb::ReadOptions ropt = RocksDBLogStoreBase::getReadOptionsSinglePrefix();
   ropt.read_tier =
       (allow_blocking_io_ ? rocksdb::kReadAllTier : rocksdb::kBlockCacheTier);
+  auto upper_bound_key =
+      RocksDBKeyFormat::IndexKey::upperBound(log_id_, index_type_);
+  rocksdb::Slice upper_bound(upper_bound_key.data(), upper_bound_key.size());
+  if (!store_->getSettings()->disable_iterate_upper_bound) {
+    ropt.iterate_upper_bound = &upper_bound;
+  }
   RocksDBIterator it = store_->newIterator(ropt, cf_);
 
   auto it_error = [&] {
@@ -14,6 +14,7 @@ namespace facebook { namespace logdevice {
 thread_local const TrackableIterator* IteratorTracker::active_iterator;
 thread_local const char* IteratorTracker::active_iterator_op;
 thread_local std::string IteratorTracker::active_iterator_op_context;
+thread_local TrackableIterator* IteratorTracker::accounting_iterator;
 
 void TrackableIterator::registerTracking(std::string column_family,
                                          logid_t log_id,
@@ -45,10 +46,16 @@ void TrackableIterator::trackSeek(lsn_t lsn, uint64_t version) {
       std::chrono::duration_cast<std::chrono::milliseconds>(
           std::chrono::system_clock::now().time_since_epoch());
   mut_info_.last_seek_version = version;
+  seeks_.fetch_add(1, std::memory_order_relaxed);
 }
 
 void TrackableIterator::trackIteratorRelease() {
-  trackSeek(LSN_INVALID, 0);
+  std::lock_guard<std::mutex> lock(tracking_mutex_);
+  mut_info_.last_seek_lsn = LSN_INVALID;
+  mut_info_.last_seek_time =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch());
+  mut_info_.last_seek_version = 0;
 }
 
 TrackableIterator::MutableTrackingInfo
@@ -64,9 +71,18 @@ TrackableIterator::TrackingInfo TrackableIterator::getDebugInfo() const {
     std::lock_guard<std::mutex> lock_guard(tracking_mutex_);
     info.mut = mut_info_;
   }
+  info.io = getIOStats();
   return info;
 }
 
+TrackableIterator::IOStats TrackableIterator::getIOStats() const {
+  IOStats io;
+  io.bytes_read = io_bytes_read_.load(std::memory_order_relaxed);
+  io.blocks_read = io_blocks_read_.load(std::memory_order_relaxed);
+  io.seeks = seeks_.load(std::memory_order_relaxed);
+  return io;
+}
+
 TrackableIterator::~TrackableIterator() {
   if (parent_) {
     // auto-unlink is not good enough, since we need to lock the mutex
@@ -97,7 +113,14 @@ void IteratorTracker::registerIterator(TrackableIterator* it) {
 void IteratorTracker::unregisterIterator(TrackableIterator* it) {
   ld_check(it);
   ld_check(it->parent_ == this);
+  TrackableIterator::IOStats io = it->getIOStats();
+  const char* ctx = it->getMutableTrackingInfo().more_context;
   std::lock_guard<std::mutex> lock(mutex_);
+  if (io.bytes_read || io.blocks_read || io.seeks) {
+    unregistered_io_[std::make_pair(std::string(ctx ? ctx : ""),
+                                    it->imm_info_.created_by_rebuilding)] +=
+        io;
+  }
   list_.erase(it->list_iterator_);
   it->parent_ = nullptr;
 }
@@ -111,6 +134,29 @@ std::vector<TrackableIterator::TrackingInfo> IteratorTracker::getDebugInfo() {
   return res;
 }
 
+std::vector<IteratorTracker::IOSummary> IteratorTracker::getIOSummary() {
+  std::map<std::pair<std::string, bool>, IOSummary> summary;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& kv : unregistered_io_) {
+    summary[kv.first].io += kv.second;
+  }
+  for (TrackableIterator* it : list_) {
+    const char* ctx = it->getMutableTrackingInfo().more_context;
+    IOSummary& s = summary[std::make_pair(
+        std::string(ctx ? ctx : ""), it->imm_info_.created_by_rebuilding)];
+    ++s.open_iterators;
+    s.io += it->getIOStats();
+  }
+
+  std::vector<IOSummary> res;
+  for (auto& kv : summary) {
+    kv.second.more_context = kv.first.first;
+    kv.second.rebuilding = kv.first.second;
+    res.push_back(std::move(kv.second));
+  }
+  return res;
+}
+
 TrackableIterator::TrackingContext::TrackingContext(bool rebuilding,
                                                     const char* more_ctx)
     : created_by_rebuilding(rebuilding), more_context(std::move(more_ctx)) {
@@ -10,7 +10,9 @@
 #include <atomic>
 #include <chrono>
 #include <list>
+#include <map>
 #include <mutex>
+#include <utility>
 #include <vector>
 
 #include <folly/Memory.h>
@@ -78,6 +80,24 @@ class TrackableIterator {
    private:
     size_t ctx_string_size_;
   };
+  // AccountIO is a scoped class that adds the disk IO done by the current
+  // thread during its lifetime (as reported by getIOBytesUnnormalized() and
+  // getIOBlocksUnnormalized()) to the iterator's IOStats. Put it around
+  // every operation that may read from disk.
+  //
+  // Note: Like DeclareActive, AccountIO does not nest. The IO is attributed
+  //       to the outermost iterator only, so that the IO done by lower-level
+  //       iterators on behalf of a higher-level iterator is not counted twice.
+  class AccountIO {
+   public:
+    inline explicit AccountIO(TrackableIterator* iter);
+    inline ~AccountIO();
+
+   private:
+    TrackableIterator* iter_{nullptr};
+    size_t bytes_before_;
+    size_t blocks_before_;
+  };
 
   enum IteratorType {
     DATA = 0,
@@ -139,9 +159,27 @@ class TrackableIterator {
     const char* more_context;
   };
 
+  // IO done by the iterator since it was created.
+  struct IOStats {
+    // Bytes and blocks read from disk (including OS page cache, but excluding
+    // RocksDB block cache and memtables). See AccountIO.
+    uint64_t bytes_read{0};
+    uint64_t blocks_read{0};
+    // Number of times the iterator was seeked.
+    uint64_t seeks{0};
+
+    IOStats& operator+=(const IOStats& rhs) {
+      bytes_read += rhs.bytes_read;
+      blocks_read += rhs.blocks_read;
+      seeks += rhs.seeks;
+      return *this;
+    }
+  };
+
   struct TrackingInfo {
     ImmutableTrackingInfo imm;
     MutableTrackingInfo mut;
+    IOStats io;
   };
 
   virtual ~TrackableIterator();
@@ -167,6 +205,8 @@ class TrackableIterator {
   // Returns a copy of both immutable and mutable info.
   TrackingInfo getDebugInfo() const;
 
+  IOStats getIOStats() const;
+
   // Returns information that can be used to deduce how many bytes this
   // iterator has read from disk (including OS page cache, but excluding any
   // caches and buffers maintained by LocalLogStore).
@@ -191,6 +231,11 @@ class TrackableIterator {
     return 0;
   }
 
+  // Same as getIOBytesUnnormalized() but counts blocks read from disk.
+  virtual size_t getIOBlocksUnnormalized() const {
+    return 0;
+  }
+
  protected:
   // Call this to register the iterator for tracking.
   // Usually called from constructor of the TrackableIterator subclass.
@@ -215,6 +260,12 @@ class TrackableIterator {
   MutableTrackingInfo mut_info_;
 
  private:
+  // Only updated by the thread using the iterator, but may be read by
+  // other threads.
+  std::atomic<uint64_t> io_bytes_read_{0};
+  std::atomic<uint64_t> io_blocks_read_{0};
+  std::atomic<uint64_t> seeks_{0};
+
   // Iterator pointing to the entry in the IteratorTracker's list that
   // references this iterator
   std::list<TrackableIterator*>::iterator list_iterator_;
@@ -237,6 +288,16 @@ class IteratorTracker {
   // Returns info on all iterators tracked
   std::vector<TrackableIterator::TrackingInfo> getDebugInfo();
 
+  // IO done by all iterators created with the same context string and
+  // rebuilding flag, including iterators that were already destroyed.
+  struct IOSummary {
+    std::string more_context;
+    bool rebuilding;
+    size_t open_iterators{0};
+    TrackableIterator::IOStats io;
+  };
+  std::vector<IOSummary> getIOSummary();
+
   // These maintain thread-local information about the currently active
   // iterator. File IO done on this thread is attributed to this iterator
   // (see RocksDBRandomAccessFile).
@@ -251,11 +312,18 @@ class IteratorTracker {
   // preceding context by "::".
   static thread_local std::string active_iterator_op_context;
 
+  // The iterator that IO done on this thread is accounted to. See AccountIO.
+  static thread_local TrackableIterator* accounting_iterator;
+
  private:
   std::mutex mutex_;
   // The list doesn't own TrackableIterators. They unregister themselves from
   // the list upon destruction.
   std::list<TrackableIterator*> list_;
+  // IO done by iterators that were unregistered, by context string and
+  // rebuilding flag.
+  std::map<std::pair<std::string, bool>, TrackableIterator::IOStats>
+      unregistered_io_;
 };
 
 TrackableIterator::DeclareActive::DeclareActive(const TrackableIterator* iter,
@@ -294,4 +362,24 @@ TrackableIterator::AddContext::~AddContext() {
   }
 }
 
+TrackableIterator::AccountIO::AccountIO(TrackableIterator* iter) {
+  if (!IteratorTracker::accounting_iterator) {
+    IteratorTracker::accounting_iterator = iter;
+    iter_ = iter;
+    bytes_before_ = iter->getIOBytesUnnormalized();
+    blocks_before_ = iter->getIOBlocksUnnormalized();
+  }
+}
+TrackableIterator::AccountIO::~AccountIO() {
+  if (iter_) {
+    iter_->io_bytes_read_.fetch_add(
+        iter_->getIOBytesUnnormalized() - bytes_before_,
+        std::memory_order_relaxed);
+    iter_->io_blocks_read_.fetch_add(
+        iter_->getIOBlocksUnnormalized() - blocks_before_,
+        std::memory_order_relaxed);
+    IteratorTracker::accounting_iterator = nullptr;
+  }
+}
+
 }} // namespace facebook::logdevice
@@ -343,6 +343,28 @@ class LocalLogStore : boost::noncopyable {
     // until you get a record of a non-metadata log or state() == AT_END.
     virtual std::unique_ptr<Location> metadataLogsBegin() const = 0;
 
+    // Splits the records into at most `max_ranges` ranges of consecutive
+    // locations of roughly equal size, which can be read independently, e.g.
+    // by several iterators in parallel. Returns the location where each range
+    // starts, in iteration order; the first one is minLocation() and each
+    // range ends where the next one starts. A reader of a range other than the
+    // last one uses reachedLocation() to tell where to stop.
+    // The default implementation doesn't split.
+    virtual std::vector<std::unique_ptr<Location>>
+    splitIntoRanges(size_t /* max_ranges */) const {
+      std::vector<std::unique_ptr<Location>> res;
+      res.push_back(minLocation());
+      return res;
+    }
+
+    // Requires: state() == AT_RECORD or LIMIT_REACHED.
+    // Returns true if the iterator is at or past `location`. Only called with
+    // locations returned by splitIntoRanges(), so the default implementation,
+    // which returns a single range, never needs to answer yes.
+    virtual bool reachedLocation(const Location& /* location */) const {
+      return false;
+    }
+
     // Resets the iterator to an unseeked state, unpinning all the data.
     // Almost equivalent to destroying the iterator and creating a new one.
     // The only difference is that invalidate() doesn't refresh iterator's view
@@ -529,6 +551,14 @@ class LocalLogStore : boost::noncopyable {
                                         RecordTimestamp /* max */) {
       return true;
     }
+
+    // Called by iterators that go over records of multiple logs, i.e.
+    // AllLogsIterator, when they get to a log. If it returns false, the
+    // iterator skips the log with a single seek instead of passing each of its
+    // CSI entries or records to operator().
+    virtual bool shouldProcessLog(logid_t /* log */) {
+      return true;
+    }
   };
 
   struct WriteOptions {
@@ -572,6 +602,16 @@ class LocalLogStore : boost::noncopyable {
    */
   virtual void adviseUnstallingLowPriWrites(bool /* unused */ = false) {}
 
+  /**
+   * @return true if the store expects to start stalling writes soon, e.g.
+   *         because flushes or compactions are falling behind. Used to tell
+   *         sequencers to send fewer writes to this shard before that
+   *         happens. Called from worker threads, so must be cheap.
+   */
+  virtual bool isWriteStallPredicted() {
+    return false;
+  }
+
   /**
    * Performs multiple writes in an atomic batch.  The operations may be
    * writes, deletes or both.
@@ -687,6 +727,29 @@ class LocalLogStore : boost::noncopyable {
   virtual int readLogMetadata(logid_t log_id, LogMetadata* metadata) = 0;
   virtual int readStoreMetadata(StoreMetadata* metadata) = 0;
 
+  using LogMetadataCallback = std::function<void(logid_t, LogMetadata&)>;
+
+  /**
+   * Reads the metadata of the given type for all logs, in order of log ID,
+   * with one sequential scan. Much cheaper than calling readLogMetadata() for
+   * each log when most logs have the metadata, e.g. when populating in-memory
+   * state on startup.
+   *
+   * @param callback  called for each log that has metadata of type `type`
+   *
+   * @return 0 on success. On failure returns -1 and sets err to
+   *         LOCAL_LOG_STORE_READ  if the scan stopped because of a read error
+   *         MALFORMED_RECORD      if some values couldn't be deserialized;
+   *                               these were skipped, `callback` was called
+   *                               for all other logs
+   *         NOTSUPPORTED          if not implemented by this store
+   */
+  virtual int readAllLogMetadata(LogMetadataType /* type */,
+                                 LogMetadataCallback /* callback */) {
+    err = E::NOTSUPPORTED;
+    return -1;
+  }
+
   /**
    * Reads per-epoch metadata for a log.
    *
@@ -750,7 +813,10 @@ class LocalLogStore : boost::noncopyable {
                             const PerEpochLogMetadataType type,
                             const WriteOptions& opts = WriteOptions()) = 0;
 
-  enum class LogSnapshotBlobType { RECORD_CACHE, MAX };
+  // RECORD_CACHE_INDEX holds a single blob, for LOGID_INVALID, describing how
+  // the RECORD_CACHE blobs can be split for reading (see
+  // RecordCachePersistence).
+  enum class LogSnapshotBlobType { RECORD_CACHE, RECORD_CACHE_INDEX, MAX };
 
   using LogSnapshotBlobCallback = std::function<int(logid_t, Slice)>;
 
@@ -762,6 +828,14 @@ class LocalLogStore : boost::noncopyable {
   virtual int readAllLogSnapshotBlobs(LogSnapshotBlobType type,
                                       LogSnapshotBlobCallback callback) = 0;
 
+  // Same as readAllLogSnapshotBlobs(), but only reads the blobs of logs in
+  // [first, last], so that several threads can each read a part of the
+  // snapshot.
+  virtual int readLogSnapshotBlobs(LogSnapshotBlobType type,
+                                   logid_t first,
+                                   logid_t last,
+                                   LogSnapshotBlobCallback callback) = 0;
+
   // Writing can be done in batches
   virtual int writeLogSnapshotBlobs(
       LogSnapshotBlobType snapshots_type,
@@ -769,6 +843,20 @@ class LocalLogStore : boost::noncopyable {
 
   virtual int deleteAllLogSnapshotBlobs() = 0;
 
+  /**
+   * Called after the trim point of a log has been moved to `trim_point`.
+   * Stores may use it to delete records up to and including `trim_point`
+   * eagerly instead of waiting for compactions to filter them out. The
+   * default implementation leaves it to compactions.
+   *
+   * @return On success, returns 0. On failure, returns -1 and sets err to
+   *         LOCAL_LOG_STORE_WRITE
+   */
+  virtual int deleteTrimmedRecords(logid_t /* log_id */,
+                                   lsn_t /* trim_point */) {
+    return 0;
+  }
+
   /**
    * Atomically update metadata entry for a log to a higher value.
    *
@@ -961,6 +1049,14 @@ class LocalLogStore : boost::noncopyable {
     return false;
   }
 
+  /**
+   * Called after reading a batch of records of `log`. `tailing` is true if
+   * the reader caught up with the tail, false if the batch was cut short by
+   * its size limits, i.e. the reader is scanning the backlog. Stores may use
+   * it to lay out the log's data for the way it's being read.
+   */
+  virtual void noteReadPattern(logid_t /* log */, bool /* tailing */) const {}
+
   /**
    * Called by each StorageThread before starting to execute
    * StorageTasks. Allows the store to initialize any per-thread data it may
@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/locallogstore/LogReadPatterns.h"
+
+#include <algorithm>
+
+#include <folly/hash/Hash.h>
+
+#include "logdevice/common/checks.h"
+
+namespace facebook { namespace logdevice {
+
+constexpr int8_t LogReadPatterns::MAX_SCORE;
+constexpr int8_t LogReadPatterns::THRESHOLD;
+
+LogReadPatterns::LogReadPatterns(size_t num_counters)
+    : num_counters_(num_counters),
+      scores_(new std::atomic<int8_t>[num_counters]) {
+  ld_check(num_counters_ > 0);
+  for (size_t i = 0; i < num_counters_; ++i) {
+    scores_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+std::atomic<int8_t>& LogReadPatterns::counter(logid_t log) const {
+  return scores_[folly::hash::twang_mix64(log.val_) % num_counters_];
+}
+
+void LogReadPatterns::update(logid_t log, int8_t delta) {
+  std::atomic<int8_t>& c = counter(log);
+  const int8_t score = c.load(std::memory_order_relaxed);
+  const int8_t new_score =
+      std::max<int8_t>(-MAX_SCORE, std::min<int8_t>(MAX_SCORE, score + delta));
+  if (new_score != score) {
+    c.store(new_score, std::memory_order_relaxed);
+  }
+}
+
+LogReadPatterns::Pattern LogReadPatterns::get(logid_t log) const {
+  const int8_t score = counter(log).load(std::memory_order_relaxed);
+  if (score <= -THRESHOLD) {
+    return Pattern::TAIL;
+  }
+  if (score >= THRESHOLD) {
+    return Pattern::SCAN;
+  }
+  return Pattern::UNKNOWN;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Approximate per-log record of how the log is being read: mostly by
+ *       readers tailing it, or mostly by readers scanning its backlog.
+ *       RocksDBFlushBlockPolicy uses it to pick block sizes when writing SST
+ *       files: small blocks for tailed logs, so that a read near the tail
+ *       doesn't have to load and decompress a big block, and big blocks for
+ *       scanned logs, which compress better and cost fewer block reads.
+ *
+ *       Each log hashes to a saturating counter that tail reads decrement and
+ *       scans increment, so that a log's pattern follows its recent reads. The
+ *       counters are fixed in number and updated without synchronization:
+ *       logs may share a counter and concurrent updates may be lost, which is
+ *       fine for a hint.
+ */
+
+class LogReadPatterns {
+ public:
+  enum class Pattern {
+    // Not read enough, or read both ways.
+    UNKNOWN,
+    // Mostly read by readers that are caught up.
+    TAIL,
+    // Mostly read in batches that stopped because of the batch size limits.
+    SCAN,
+  };
+
+  explicit LogReadPatterns(size_t num_counters = 1 << 16);
+
+  void noteTailRead(logid_t log) {
+    update(log, -1);
+  }
+
+  void noteScan(logid_t log) {
+    update(log, 1);
+  }
+
+  Pattern get(logid_t log) const;
+
+  // Counters saturate at +/-MAX_SCORE; a log needs a score of at least
+  // THRESHOLD in either direction to be classified.
+  static constexpr int8_t MAX_SCORE = 8;
+  static constexpr int8_t THRESHOLD = 4;
+
+ private:
+  const size_t num_counters_;
+  std::unique_ptr<std::atomic<int8_t>[]> scores_;
+
+  std::atomic<int8_t>& counter(logid_t log) const;
+  void update(logid_t log, int8_t delta);
+};
+
+}} // namespace facebook::logdevice
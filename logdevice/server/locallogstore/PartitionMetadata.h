@@ -8,6 +8,7 @@
 #pragma once
 
 #include <chrono>
+#include <string>
 
 #include <folly/small_vector.h>
 #include <rocksdb/slice.h>
@@ -30,6 +31,8 @@ enum class PartitionMetadataType {
   LAST_COMPACTION = 3,
   COMPACTED_RETENTION = 4,
   DIRTY = 5,
+  OFFLOADED = 6,
+  FILTERABLE_KEYS_INDEXED = 7,
   MAX
 };
 
@@ -104,6 +107,49 @@ class PartitionCompactedRetentionMetadata final : public PartitionMetadata {
   uint64_t backlog_duration_;
 };
 
+// Presence of this metadata means that a copy of the partition's data has
+// been uploaded to remote storage (see RemoteStorage.h), and the local copy
+// may have been deleted. The object's key is derived from the shard and the
+// partition ID.
+class PartitionOffloadedMetadata final : public PartitionMetadata {
+ public:
+  explicit PartitionOffloadedMetadata(uint64_t size_bytes = 0)
+      : size_bytes_(size_bytes) {}
+
+  PartitionMetadataType getType() const override {
+    return PartitionMetadataType::OFFLOADED;
+  }
+
+  GEN_METADATA_SERIALIZATION_METHODS(PartitionOffloadedMetadata,
+                                     size_bytes_,
+                                     std::to_string(size_bytes_) + " bytes")
+
+  // Size of the remote object.
+  uint64_t size_bytes_;
+};
+
+// Presence of this metadata means that every record written to the partition
+// is accounted for in the partition's FILTERABLE_KEY_INDEX entries (see
+// FilterableKeyRangeValue), so the entries can be used to skip the partition.
+// Written when the partition is created with --rocksdb-filterable-key-index
+// enabled, and deleted on startup if the setting is disabled.
+class PartitionFilterableKeysIndexedMetadata final : public PartitionMetadata {
+ public:
+  explicit PartitionFilterableKeysIndexedMetadata(uint32_t version = 1)
+      : version_(version) {}
+
+  PartitionMetadataType getType() const override {
+    return PartitionMetadataType::FILTERABLE_KEYS_INDEXED;
+  }
+
+  GEN_METADATA_SERIALIZATION_METHODS(PartitionFilterableKeysIndexedMetadata,
+                                     version_,
+                                     "v" + std::to_string(version_))
+
+  // Format of the index entries. Only 1 exists so far.
+  uint32_t version_;
+};
+
 class PartitionDirtyMetadata : public PartitionMetadata {
  public:
   using DirtyNodeVector = std::vector<node_index_t>;
@@ -389,4 +435,110 @@ inline bool compare(rocksdb::Slice val1, rocksdb::Slice val2) {
 }
 } // namespace CustomIndexDirectoryValue
 
+/**
+ * Value of a CustomIndexDirectoryKey with index type FILTERABLE_KEY_INDEX.
+ * Describes the filterable keys of a log's records in a partition: the
+ * smallest and the largest key, and whether some records have no filterable
+ * key (such records pass every filter). Format:
+ *   flags (1 byte), min key length (2 bytes), min key,
+ *   max key length (2 bytes), max key.
+ * Values are combined with merge(), so a partition's entry covers all the
+ * records written to it.
+ */
+namespace FilterableKeyRangeValue {
+
+// Some records have a filterable key; min and max keys are set.
+constexpr uint8_t HAS_KEYED = 1u << 0;
+// Some records have no filterable key.
+constexpr uint8_t HAS_UNKEYED = 1u << 1;
+
+inline std::string
+create(uint8_t flags, rocksdb::Slice min_key, rocksdb::Slice max_key) {
+  ld_check(min_key.size() <= USHRT_MAX);
+  ld_check(max_key.size() <= USHRT_MAX);
+
+  std::string value;
+  value.reserve(1 + 2 * sizeof(ushort) + min_key.size() + max_key.size());
+  value.push_back(static_cast<char>(flags));
+  for (rocksdb::Slice key : {min_key, max_key}) {
+    unsigned short key_length = key.size();
+    value.append(reinterpret_cast<const char*>(&key_length), sizeof(ushort));
+    value.append(key.data(), key.size());
+  }
+  return value;
+}
+
+// Value describing a single record with the given filterable key.
+inline std::string createKeyed(rocksdb::Slice key) {
+  return create(HAS_KEYED, key, key);
+}
+
+// Value describing a single record without a filterable key.
+inline std::string createUnkeyed() {
+  return create(HAS_UNKEYED, rocksdb::Slice(), rocksdb::Slice());
+}
+
+inline uint8_t getFlags(const void* blob) {
+  return *reinterpret_cast<const uint8_t*>(blob);
+}
+
+inline rocksdb::Slice getMinKey(const void* blob) {
+  const char* ptr = reinterpret_cast<const char*>(blob) + 1;
+  unsigned short length;
+  memcpy(&length, ptr, sizeof(ushort));
+  return rocksdb::Slice(ptr + sizeof(ushort), length);
+}
+
+inline rocksdb::Slice getMaxKey(const void* blob) {
+  rocksdb::Slice min_key = getMinKey(blob);
+  const char* ptr = min_key.data() + min_key.size();
+  unsigned short length;
+  memcpy(&length, ptr, sizeof(ushort));
+  return rocksdb::Slice(ptr + sizeof(ushort), length);
+}
+
+/**
+ * Checks if a memory segment of @param size bytes starting from @param blob
+ * represents a valid FilterableKeyRangeValue.
+ */
+inline bool valid(const void* blob, size_t size) {
+  const char* ptr = reinterpret_cast<const char*>(blob);
+  size_t offset = 1;
+  for (int i = 0; i < 2; ++i) {
+    if (size < offset + sizeof(ushort)) {
+      return false;
+    }
+    unsigned short key_length;
+    memcpy(&key_length, ptr + offset, sizeof(ushort));
+    offset += sizeof(ushort) + key_length;
+  }
+  const uint8_t flags = getFlags(blob);
+  return size == offset && flags != 0 &&
+      (flags & ~(HAS_KEYED | HAS_UNKEYED)) == 0;
+}
+
+/**
+ * Combines two valid values into one describing the records of both.
+ */
+inline std::string merge(rocksdb::Slice val1, rocksdb::Slice val2) {
+  const uint8_t flags1 = getFlags(val1.data());
+  const uint8_t flags2 = getFlags(val2.data());
+  if (!(flags2 & HAS_KEYED)) {
+    return create(
+        flags1 | flags2, getMinKey(val1.data()), getMaxKey(val1.data()));
+  }
+  if (!(flags1 & HAS_KEYED)) {
+    return create(
+        flags1 | flags2, getMinKey(val2.data()), getMaxKey(val2.data()));
+  }
+  rocksdb::Slice min1 = getMinKey(val1.data());
+  rocksdb::Slice min2 = getMinKey(val2.data());
+  rocksdb::Slice max1 = getMaxKey(val1.data());
+  rocksdb::Slice max2 = getMaxKey(val2.data());
+  return create(flags1 | flags2,
+                min1.compare(min2) <= 0 ? min1 : min2,
+                max1.compare(max2) >= 0 ? max1 : max2);
+}
+} // namespace FilterableKeyRangeValue
+
 }} // namespace facebook::logdevice
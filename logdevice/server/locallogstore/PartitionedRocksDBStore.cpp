@@ -12,8 +12,11 @@
 #include <cstdlib>
 #include <iterator>
 #include <list>
+#include <set>
 
+#include <boost/filesystem.hpp>
 #include <folly/Conv.h>
+#include <folly/Format.h>
 #include <folly/Likely.h>
 #include <folly/Optional.h>
 #include <folly/hash/Hash.h>
@@ -22,6 +25,7 @@
 #include <rocksdb/convenience.h>
 #include <rocksdb/merge_operator.h>
 #include <rocksdb/sst_file_manager.h>
+#include <rocksdb/sst_file_writer.h>
 
 #include "PartitionedRocksDBStoreFindKey.h"
 #include "PartitionedRocksDBStoreFindTime.h"
@@ -32,6 +36,7 @@
 #include "logdevice/common/ThreadID.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/common/plugin/RemoteStorage.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/common/util.h"
 #include "logdevice/server/ServerProcessor.h"
@@ -143,6 +148,33 @@ std::string getNameFromId(partition_id_t id) {
 }
 }; // namespace PartitionedDBKeyFormat
 
+// Value of the FILTERABLE_KEY_INDEX entry describing the single record `op`.
+static std::string filterableKeyRangeOf(const PutWriteOp& op) {
+  LocalLogStoreRecordFormat::flags_t flags;
+  std::map<KeyType, std::string> optional_keys;
+  int rv = LocalLogStoreRecordFormat::parse(op.record_header,
+                                            nullptr, // timestamp
+                                            nullptr, // last_known_good
+                                            &flags,
+                                            nullptr, // wave
+                                            nullptr, // copyset_size
+                                            nullptr, // copyset_arr
+                                            0,       // copyset_arr_size
+                                            nullptr, // offset_within_epoch
+                                            &optional_keys,
+                                            nullptr, // payload_out
+                                            -1);     // shard (unused)
+  if (rv == 0 && (flags & LocalLogStoreRecordFormat::FLAG_OPTIONAL_KEYS)) {
+    auto it = optional_keys.find(KeyType::FILTERABLE);
+    if (it != optional_keys.end()) {
+      return FilterableKeyRangeValue::createKeyed(it->second);
+    }
+  }
+  // Like LocalLogStoreReader, let records without a filterable key (including
+  // malformed ones) through.
+  return FilterableKeyRangeValue::createUnkeyed();
+}
+
 bool PartitionedRocksDBStore::MetadataMergeOperator::Merge(
     const rocksdb::Slice& key,
     const rocksdb::Slice* existing_value,
@@ -150,7 +182,7 @@ bool PartitionedRocksDBStore::MetadataMergeOperator::Merge(
     std::string* new_value,
     rocksdb::Logger* /*logger*/) const {
   // This operator only applies to MutablePerEpochLogMetadata and the metadata
-  // index entries for findKey. Make sure key is valid.
+  // index entries for findKey and filterable keys. Make sure key is valid.
   const char header = key.size() > 0 ? key.data()[0] : '\0';
   if (key.size() == 0 ||
       (header !=
@@ -190,6 +222,27 @@ bool PartitionedRocksDBStore::MetadataMergeOperator::Merge(
     return merge(MutablePerEpochLogMetadata{});
   }
 
+  if (CustomIndexDirectoryKey::getIndexType(key.data()) ==
+      FILTERABLE_KEY_INDEX) {
+    // The filterable key index maps (log_id, index_type, partition_id) to the
+    // range of filterable keys in the partition; extend the range.
+    if (!FilterableKeyRangeValue::valid(
+            existing_value->data(), existing_value->size()) ||
+        !FilterableKeyRangeValue::valid(value.data(), value.size())) {
+      RATELIMIT_ERROR(
+          std::chrono::seconds(1),
+          1,
+          "At least one value is invalid; key: %s, old value: %s, "
+          "new value: %s",
+          hexdump_buf(key.data(), key.size()).c_str(),
+          hexdump_buf(existing_value->data(), existing_value->size()).c_str(),
+          hexdump_buf(value.data(), value.size()).c_str());
+      return false;
+    }
+    *new_value = FilterableKeyRangeValue::merge(*existing_value, value);
+    return true;
+  }
+
   // Handle the case for CustomIndexDirectoryKey. The metadata index used in the
   // findKey API maps (log_id, index_type, partition_id) to the minimum key in
   // the partition and the corresponding LSN, which is thus the value being
@@ -406,6 +459,8 @@ void PartitionedRocksDBStore::init(const Configuration* config) {
   }
 
   if (!getSettings()->read_only) {
+    hot_partition_cache_ = std::make_unique<HotPartitionCache>(
+        getSettings()->hot_partition_cache_max_bytes, stats_);
     startBackgroundThreads();
     // Register flush callback
     createAndRegisterFlushCallback();
@@ -488,6 +543,14 @@ void PartitionedRocksDBStore::joinBackgroundThreads() {
 void PartitionedRocksDBStore::setProcessor(Processor* processor) {
   ld_check(!processor_.load());
   processor_.store(checked_downcast<ServerProcessor*>(processor));
+  auto plugin_registry = processor->getPluginRegistry();
+  auto remote_storage = plugin_registry
+      ? plugin_registry->getSinglePlugin<RemoteStorage>(
+            PluginType::REMOTE_STORAGE)
+      : nullptr;
+  if (remote_storage != nullptr) {
+    setRemoteStorage(std::move(remote_storage));
+  }
 }
 
 std::unique_ptr<LocalLogStore::ReadIterator>
@@ -495,7 +558,19 @@ PartitionedRocksDBStore::read(logid_t log_id,
                               const LocalLogStore::ReadOptions& options) const {
   // Reading from partitioned store without a log_id is not supported
   if (isLogPartitioned(log_id)) {
-    return std::make_unique<Iterator>(this, log_id, options);
+    auto it = std::make_unique<Iterator>(this, log_id, options);
+    // The cache holds full records, while csi_data_only reads are served
+    // from the copyset index only.
+    if (hot_partition_cache_ == nullptr ||
+        !getSettings()->hot_partition_cache || options.csi_data_only) {
+      return std::move(it);
+    }
+    return std::make_unique<HotPartitionCache::Iterator>(
+        this, hot_partition_cache_.get(), log_id, std::move(it), [this] {
+          // The cache doesn't track under-replication, let the regular
+          // iterator deal with it.
+          return getSettings()->hot_partition_cache && !isUnderReplicated();
+        });
   } else {
     return std::make_unique<RocksDBLocalLogStore::CSIWrapper>(
         this, log_id, options, unpartitioned_cf_.get());
@@ -712,47 +787,99 @@ bool PartitionedRocksDBStore::open(
     }
 
     if (!readPartitionTimestamps(partition)) {
-      if (id != latest_partition_id || err != E::NOTFOUND) {
+      if (err != E::NOTFOUND) {
         return false;
-      } else {
-        // We were probably adding a new latest partition, had created the CF,
-        // but crashed before we could write the partition timestamp.
-        // That's fine, we can drop it and it'll be recreated later if need be.
-        ld_warning("Latest partition %lu had no metadata; assuming we crashed "
-                   "before we could write it. Dropping the CF.",
-                   partition->id_);
-        ld_check_ne(oldest_partition_id, id);
-        status = db_->DropColumnFamilies({partition->cf_.get()});
-        if (!status.ok()) {
-          ld_error("Failed to drop column family %lu: %s",
-                   partition->id_,
-                   status.ToString().c_str());
+      }
+      // We were probably adding a new latest partition, had created the CF,
+      // but crashed before we could write the partition timestamp. Or these
+      // are spare partitions pre-created by precreateSparePartitions().
+      // Either way, all partitions after this one must have no metadata as
+      // well. That's fine, we can drop them and they'll be recreated later if
+      // need be.
+      std::vector<rocksdb::ColumnFamilyHandle*> to_drop;
+      for (partition_id_t p = id; p <= latest_partition_id; ++p) {
+        PartitionPtr incomplete = partitions_.get(p);
+        if (!incomplete) {
+          ld_error("Found gap after incomplete partition %lu at partition "
+                   "%lu; should be impossible!",
+                   id,
+                   p);
           return false;
         }
+        if (p != id) {
+          if (readPartitionTimestamps(incomplete)) {
+            ld_error("Partition %lu has metadata but partition %lu before it "
+                     "doesn't; should be impossible!",
+                     p,
+                     id);
+            return false;
+          }
+          if (err != E::NOTFOUND) {
+            return false;
+          }
+        }
+        to_drop.push_back(incomplete->cf_.get());
+      }
+      ld_warning("Partitions [%lu, %lu] had no metadata; assuming they're "
+                 "spare or we crashed before we could write it. Dropping the "
+                 "CFs.",
+                 id,
+                 latest_partition_id);
+      ld_check_ne(oldest_partition_id, id);
+      status = db_->DropColumnFamilies(to_drop);
+      if (!status.ok()) {
+        ld_error("Failed to drop column families [%lu, %lu]: %s",
+                 id,
+                 latest_partition_id,
+                 status.ToString().c_str());
+        return false;
+      }
 
+      for (size_t i = 0; i < to_drop.size(); ++i) {
         partitions_.pop_back();
-        if (partitions_.empty()) {
-          ld_error("Found incomplete latest partition %lu but no previous "
-                   "partition; should be impossible!",
-                   id);
+      }
+      STAT_SUB(stats_, partitions, to_drop.size());
+      if (partitions_.empty()) {
+        ld_error("Found incomplete partition %lu but no previous "
+                 "partition; should be impossible!",
+                 id);
+        return false;
+      } else {
+        latest_partition_id = partitions_.back()->id_;
+        if (latest_partition_id < id - 1) {
+          ld_error("Found gap between incomplete partition %lu and "
+                   "the partition %lu before it; should be impossible!",
+                   id,
+                   latest_partition_id);
           return false;
-        } else {
-          latest_partition_id = partitions_.back()->id_;
-          if (latest_partition_id < id - 1) {
-            ld_error("Found gap between incomplete-latest partition %lu and "
-                     "second-latest partition %lu; should be impossible!",
-                     id,
-                     latest_partition_id);
-            return false;
-          }
         }
-        break;
       }
+      break;
     }
     if (!readPartitionDirtyState(partition)) {
       return false;
     }
 
+    if (partition->filterable_keys_indexed &&
+        !getSettings()->filterable_key_index && !getSettings()->read_only) {
+      // Records written from now on won't be indexed, so the index entries
+      // of this partition can't be trusted anymore, even if the setting is
+      // enabled again.
+      LocalLogStore::WriteOptions write_options;
+      rv = writer_->deleteMetadata(
+          PartitionMetaKey(
+              PartitionMetadataType::FILTERABLE_KEYS_INDEXED, partition->id_),
+          write_options,
+          metadata_cf_.get());
+      if (rv != 0) {
+        ld_error("Failed to delete filterable key index marker of "
+                 "partition %lu",
+                 partition->id_);
+        return false;
+      }
+      partition->filterable_keys_indexed = false;
+    }
+
     for (auto& ndd_kv : partition->dirty_state_.dirtied_by_nodes) {
       // Only persisting Appends for now.
       if (ndd_kv.first.second != DataClass::APPEND) {
@@ -908,7 +1035,8 @@ PartitionedRocksDBStore::createPartitionsImpl(
     std::function<RecordTimestamp()> get_first_timestamp_func,
     size_t count,
     const DirtyState* pre_dirty_state,
-    bool create_cfs_before_metadata) {
+    bool create_cfs_before_metadata,
+    std::unique_ptr<rocksdb::ColumnFamilyHandle> precreated_cf) {
   ld_check(!getSettings()->read_only);
   ld_check(!immutable_.load());
 
@@ -924,6 +1052,13 @@ PartitionedRocksDBStore::createPartitionsImpl(
   // This is done when we're creating a new latest partition, since in all
   // other cases, we already know what the timestamp should be.
   auto create_cfs = [&]() {
+    if (precreated_cf) {
+      ld_check_eq(count, 1);
+      ld_check_eq(precreated_cf->GetName(),
+                  PartitionedDBKeyFormat::getNameFromId(first_id));
+      cfs.push_back(std::move(precreated_cf));
+      return true;
+    }
     std::vector<std::string> column_family_names;
     column_family_names.reserve(count);
     for (size_t i = 0; i < count; ++i) {
@@ -937,8 +1072,10 @@ PartitionedRocksDBStore::createPartitionsImpl(
     return true;
   };
 
+  const bool filterable_keys_indexed = getSettings()->filterable_key_index;
+
   auto write_metadata = [&]() {
-    // Write STARTING_TIMESTAMP and DIRTY metadata.
+    // Write STARTING_TIMESTAMP, DIRTY and FILTERABLE_KEYS_INDEXED metadata.
     RecordTimestamp first_timestamp = get_first_timestamp_func();
     for (size_t i = 0; i < count; ++i) {
       partition_id_t id = first_id + i;
@@ -967,6 +1104,17 @@ PartitionedRocksDBStore::createPartitionsImpl(
           return false;
         }
       }
+      if (filterable_keys_indexed) {
+        rv = writer_->writeMetadata(
+            PartitionMetaKey(
+                PartitionMetadataType::FILTERABLE_KEYS_INDEXED, id),
+            PartitionFilterableKeysIndexedMetadata(),
+            write_options,
+            metadata_cf_.get());
+        if (rv != 0) {
+          return false;
+        }
+      }
     }
     if (sync(Durability::ASYNC_WRITE) != 0) {
       return false;
@@ -992,6 +1140,7 @@ PartitionedRocksDBStore::createPartitionsImpl(
                                                     cfs[i].release(),
                                                     starting_timestamps[i],
                                                     pre_dirty_state);
+    new_partitions[i]->filterable_keys_indexed = filterable_keys_indexed;
   }
   addPartitions(new_partitions);
 
@@ -1029,13 +1178,25 @@ PartitionedRocksDBStore::createPartition() {
     }
   }
 
+  // Use a spare CF created by precreateSparePartitions() if there is one.
+  std::unique_ptr<rocksdb::ColumnFamilyHandle> precreated_cf;
+  if (!spare_cfs_.empty()) {
+    precreated_cf = std::move(spare_cfs_.front());
+    spare_cfs_.pop_front();
+    num_spare_cfs_.store(spare_cfs_.size());
+    STAT_INCR(stats_, partitions_precreated_used);
+  } else if (getSettings()->partition_precreate_count_ > 0) {
+    STAT_INCR(stats_, partitions_precreated_misses);
+  }
+
   // Create partition but create CF before deciding the starting time, since
   // that step can take longer time than the margin e.g. if another thread is
   // dropping lots of partitions at the same time.
-  ld_info("Creating a new partition [%lu], shard %u pre-dirtied by %lu nodes",
+  ld_info("Creating a new partition [%lu], shard %u pre-dirtied by %lu nodes%s",
           new_partition_id,
           shard_idx_,
-          pre_dirty_state.dirtied_by_nodes.size());
+          pre_dirty_state.dirtied_by_nodes.size(),
+          precreated_cf ? ", using a pre-created CF" : "");
   auto created = createPartitionsImpl(new_partition_id,
                                       [&] {
                                         starting_timestamp =
@@ -1043,7 +1204,9 @@ PartitionedRocksDBStore::createPartition() {
                                         return starting_timestamp;
                                       },
                                       1,
-                                      &pre_dirty_state);
+                                      &pre_dirty_state,
+                                      true,
+                                      std::move(precreated_cf));
 
   if (created.empty()) {
     return nullptr;
@@ -1075,6 +1238,52 @@ PartitionedRocksDBStore::createPartition() {
   return created[0];
 }
 
+void PartitionedRocksDBStore::precreateSparePartitions() {
+  ld_check(!getSettings()->read_only);
+  const size_t target = getSettings()->partition_precreate_count_;
+
+  // Create one CF at a time, so that createPartition() doesn't have to wait
+  // for more than one CF creation if it's called in the meantime.
+  while (!shutdown_event_.signaled() && !inFailSafeMode() &&
+         !immutable_.load()) {
+    std::lock_guard<std::mutex> lock(latest_partition_mutex_);
+    if (spare_cfs_.size() == target) {
+      break;
+    }
+
+    if (spare_cfs_.size() > target) {
+      // The setting was decreased.
+      rocksdb::Status status =
+          db_->DropColumnFamily(spare_cfs_.back().get());
+      if (!status.ok()) {
+        ld_error("Failed to drop spare column family %s in shard %u: %s",
+                 spare_cfs_.back()->GetName().c_str(),
+                 shard_idx_,
+                 status.ToString().c_str());
+        enterFailSafeIfFailed(status, "DropColumnFamily()");
+        break;
+      }
+      spare_cfs_.pop_back();
+      num_spare_cfs_.store(spare_cfs_.size());
+      continue;
+    }
+
+    PartitionPtr latest = latest_.get();
+    ld_check(latest);
+    // Spare CFs always have the IDs right after the latest partition's.
+    partition_id_t id = latest->id_ + 1 + spare_cfs_.size();
+    auto cf = createColumnFamily(
+        PartitionedDBKeyFormat::getNameFromId(id), data_cf_options_);
+    if (!cf) {
+      break;
+    }
+    ld_debug("Pre-created spare partition CF %lu in shard %u", id, shard_idx_);
+    spare_cfs_.push_back(std::move(cf));
+    num_spare_cfs_.store(spare_cfs_.size());
+    STAT_INCR(stats_, partitions_precreated);
+  }
+}
+
 std::vector<PartitionedRocksDBStore::PartitionPtr>
 PartitionedRocksDBStore::prependPartitionsInternal(size_t count) {
   ld_check(!getSettings()->read_only);
@@ -1469,6 +1678,35 @@ bool PartitionedRocksDBStore::readPartitionTimestamps(PartitionPtr partition) {
     }
   }
 
+  {
+    PartitionOffloadedMetadata meta;
+    int rv = RocksDBWriter::readMetadata(
+        this,
+        PartitionMetaKey(PartitionMetadataType::OFFLOADED, id),
+        &meta,
+        metadata_cf_.get());
+    if (rv != 0 && err != E::NOTFOUND) {
+      return false;
+    }
+    if (rv == 0) {
+      partition->offloaded = true;
+      partition->remote_copy_bytes = meta.size_bytes_;
+    }
+  }
+
+  {
+    PartitionFilterableKeysIndexedMetadata meta;
+    int rv = RocksDBWriter::readMetadata(
+        this,
+        PartitionMetaKey(PartitionMetadataType::FILTERABLE_KEYS_INDEXED, id),
+        &meta,
+        metadata_cf_.get());
+    if (rv != 0 && err != E::NOTFOUND) {
+      return false;
+    }
+    partition->filterable_keys_indexed = rv == 0;
+  }
+
   {
     PartitionTimestampMetadata meta(PartitionMetadataType::STARTING_TIMESTAMP);
     int rv = RocksDBWriter::readMetadata(
@@ -1760,6 +1998,7 @@ PartitionedRocksDBStore::getWritePartition(
     auto hint_it = log_directory.erase(next_it);
     current_partition =
         &log_directory.emplace_hint(hint_it, lsn, new_next_partition)->second;
+    invalidateFindTimeIndex(log_state);
     if (current_partition->id == max_used_partition) {
       // New first lsn of latest partition, update LogState
       log_state->latest_partition.store(
@@ -1790,6 +2029,7 @@ PartitionedRocksDBStore::getWritePartition(
     // Add to in-memory directory metadata
     current_partition =
         &log_directory.emplace_hint(next_it, lsn, new_partition)->second;
+    invalidateFindTimeIndex(log_state);
     if (target_partition > max_used_partition) {
       // New latest partition, update LogState
       log_state->latest_partition.store(target_partition, lsn, lsn);
@@ -2062,9 +2302,32 @@ int PartitionedRocksDBStore::dataSize(logid_t log_id,
                                       RecordTimestamp hi_timestamp,
                                       size_t* out) {
   ld_check_ne(out, nullptr);
-  *out = 0;
+  *out = dataSizeImpl(log_id,
+                      lo_timestamp,
+                      hi_timestamp,
+                      getPartitionList(),
+                      RecordTimestamp(currentTime()));
+  return 0;
+}
 
+void PartitionedRocksDBStore::dataSize(const std::vector<DataSizeRange>& ranges,
+                                       std::vector<size_t>* out) {
+  ld_check_ne(out, nullptr);
+  auto partitions = getPartitionList();
   RecordTimestamp now(currentTime());
+  out->resize(ranges.size());
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    (*out)[i] = dataSizeImpl(
+        ranges[i].log_id, ranges[i].lo, ranges[i].hi, partitions, now);
+  }
+}
+
+size_t
+PartitionedRocksDBStore::dataSizeImpl(logid_t log_id,
+                                      RecordTimestamp lo_timestamp,
+                                      RecordTimestamp hi_timestamp,
+                                      const PartitionList& partitions,
+                                      RecordTimestamp now) {
   if (hi_timestamp > now) {
     RATELIMIT_DEBUG(std::chrono::seconds(10),
                     1,
@@ -2088,7 +2351,6 @@ int PartitionedRocksDBStore::dataSize(logid_t log_id,
   if (log_directory.empty()) {
     return 0;
   }
-  auto partitions = getPartitionList();
 
   // Find the directory entry for the first partition which spans any
   // timestamps >= lo_timestamp -- that's our starting point.
@@ -2115,10 +2377,10 @@ int PartitionedRocksDBStore::dataSize(logid_t log_id,
     // max <= log_directory.crbegin()->first + 1.
     ld_check(mid_it != log_directory.cend());
 
+    // Partitions created after `partitions` was taken start after `now`.
     PartitionPtr partition = partitions->get(mid_it->second.id);
-    ld_check(partition != nullptr);
 
-    if (partition->starting_timestamp <= lo_timestamp) {
+    if (partition != nullptr && partition->starting_timestamp <= lo_timestamp) {
       // Good partition, advance min_it to it.
       min_it = mid_it;
     } else {
@@ -2127,14 +2389,14 @@ int PartitionedRocksDBStore::dataSize(logid_t log_id,
     }
   }
 
+  size_t size = 0;
   // Keep going through partitions and add their sizes (to whatever degree we
   // estimate that they are covered) until we go above hi_timestamp.
   for (auto dir_it = min_it; dir_it != log_directory.cend(); ++dir_it) {
     partition_id_t partition_id = dir_it->second.id;
     PartitionPtr partition = partitions->get(partition_id);
-    ld_check(partition != nullptr);
 
-    if (partition->starting_timestamp > hi_timestamp) {
+    if (partition == nullptr || partition->starting_timestamp > hi_timestamp) {
       // Done.
       break;
     }
@@ -2164,10 +2426,10 @@ int PartitionedRocksDBStore::dataSize(logid_t log_id,
       bytes_covered = (uint64_t)round(bytes_covered * fraction_in_range);
     }
 
-    *out += bytes_covered;
+    size += bytes_covered;
   }
 
-  return 0;
+  return size;
 }
 
 bool PartitionedRocksDBStore::isLogEmpty(logid_t log_id) {
@@ -2226,6 +2488,61 @@ int PartitionedRocksDBStore::findKey(logid_t log_id,
   return findkey.execute(lo, hi);
 }
 
+int PartitionedRocksDBStore::mayContainMatchingRecords(
+    logid_t log_id,
+    const PartitionPtr& partition,
+    const ServerRecordFilter& filter,
+    bool allow_blocking_io) const {
+  ld_check(partition != nullptr);
+  if (!partition->filterable_keys_indexed) {
+    return 1;
+  }
+
+  CustomIndexDirectoryKey key(log_id, FILTERABLE_KEY_INDEX, partition->id_);
+  auto options = RocksDBLogStoreBase::getDefaultReadOptions();
+  options.read_tier =
+      (allow_blocking_io ? rocksdb::kReadAllTier : rocksdb::kBlockCacheTier);
+  std::string value;
+  rocksdb::Status status = db_->Get(
+      options,
+      metadata_cf_.get(),
+      rocksdb::Slice(reinterpret_cast<const char*>(&key), sizeof(key)),
+      &value);
+  if (status.IsNotFound()) {
+    // No records of the log were written to the partition since it was
+    // created, but the directory is the authority on that.
+    return 1;
+  }
+  if (!status.ok()) {
+    err = status.IsIncomplete() ? E::WOULDBLOCK : E::FAILED;
+    return -1;
+  }
+  if (!FilterableKeyRangeValue::valid(value.data(), value.size())) {
+    RATELIMIT_ERROR(std::chrono::seconds(1),
+                    1,
+                    "Invalid filterable key index entry for log %lu in "
+                    "partition %lu: %s",
+                    log_id.val_,
+                    partition->id_,
+                    hexdump_buf(value.data(), value.size()).c_str());
+    err = E::FAILED;
+    return -1;
+  }
+
+  const uint8_t flags = FilterableKeyRangeValue::getFlags(value.data());
+  if (flags & FilterableKeyRangeValue::HAS_UNKEYED) {
+    // Records without a filterable key pass any filter.
+    return 1;
+  }
+  rocksdb::Slice min_key = FilterableKeyRangeValue::getMinKey(value.data());
+  rocksdb::Slice max_key = FilterableKeyRangeValue::getMaxKey(value.data());
+  return filter.mayMatchRange(
+             folly::StringPiece(min_key.data(), min_key.size()),
+             folly::StringPiece(max_key.data(), max_key.size()))
+      ? 1
+      : 0;
+}
+
 void PartitionedRocksDBStore::findPartitionsMatchingIntervals(
     RecordTimeIntervals& rtis,
     std::function<void(PartitionPtr, RecordTimeInterval)> cb) const {
@@ -2532,13 +2849,26 @@ int PartitionedRocksDBStore::writeMulti(
   int rv;
   while (true) {
     partition_id_t old_min_target_partition = min_target_partition;
-    rv = writeMultiImpl(
-        writes_in, options, &partitioned_logs, &min_target_partition);
+    PartitionPtr to_restore;
+    rv = writeMultiImpl(writes_in,
+                        options,
+                        &partitioned_logs,
+                        &min_target_partition,
+                        &to_restore);
     if (rv == 0 || err != E::AGAIN) {
       // Succeeded or failed, stop retrying. This is almost always hit on the
       // first iteration.
       break;
     }
+    if (to_restore != nullptr) {
+      // Some records go to an offloaded partition, e.g. rebuilding writes
+      // to an old partition. Bring it back and try again.
+      if (restorePartition(to_restore) != 0) {
+        err = E::LOCAL_LOG_STORE_WRITE;
+        break;
+      }
+      continue;
+    }
     RATELIMIT_INFO(
         std::chrono::seconds(10),
         2,
@@ -2563,7 +2893,8 @@ int PartitionedRocksDBStore::writeMultiImpl(
     const std::vector<const WriteOp*>& writes_in,
     const WriteOptions& options,
     const LogLocks::Keys* partitioned_logs,
-    partition_id_t* min_target_partition_est) {
+    partition_id_t* min_target_partition_est,
+    PartitionPtr* to_restore) {
   PartitionPtr min_target_partition;
   if (!getPartition(*min_target_partition_est, &min_target_partition)) {
     // Partition is dropped.
@@ -2596,8 +2927,16 @@ int PartitionedRocksDBStore::writeMultiImpl(
 
   partition_id_t latest_partition_id = latest_.get()->id_;
 
-  rocksdb::WriteBatch wal_batch;
-  rocksdb::WriteBatch mem_batch;
+  size_t wal_bytes, mem_bytes;
+  RocksDBWriter::estimateBatchSizes(writes_in, &wal_bytes, &mem_bytes);
+  rocksdb::WriteBatch wal_batch(wal_bytes);
+  rocksdb::WriteBatch mem_batch(mem_bytes);
+  // Mirrors appends to the latest partition in hot_partition_cache_.
+  const bool use_hot_partition_cache =
+      hot_partition_cache_ != nullptr && getSettings()->hot_partition_cache;
+  HotPartitionCache::WriteBatch hot_partition_batch(
+      use_hot_partition_cache ? hot_partition_cache_.get() : nullptr,
+      latest_partition_id);
   std::vector<const WriteOp*> writes;
   // Decide to which partition to put/delete each record.
   std::vector<rocksdb::ColumnFamilyHandle*> cf_handles;
@@ -2627,6 +2966,13 @@ int PartitionedRocksDBStore::writeMultiImpl(
   const bool skip_rebuilding = getRebuildingSettings()->read_only ==
       RebuildingReadOnlyOption::ON_RECIPIENT;
 
+  // Target partition of each of `writes` and whether the write can go to a
+  // rebuilding SST buffer. Only filled if rebuilding SST ingestion is on.
+  const bool rebuilding_sst_ingestion =
+      getSettings()->rebuilding_sst_ingestion_;
+  std::vector<PartitionPtr> write_partitions;
+  std::vector<bool> bufferable;
+
   // Writes and clears rocksdb_batch. Used for flushing directory updates
   // between calls to getWritePartition() for the same log.
   auto flush_batch = [&]() {
@@ -2660,6 +3006,7 @@ int PartitionedRocksDBStore::writeMultiImpl(
     }
 
     rocksdb::ColumnFamilyHandle* cf_handle = nullptr;
+    PartitionPtr write_partition;
     bool skip_op = false;
 
     switch (write->getType()) {
@@ -2756,6 +3103,14 @@ int PartitionedRocksDBStore::writeMultiImpl(
         //    entry.
         size_t payload_size_bytes = 0;
         LocalLogStoreRecordFormat::flags_t flags = 0;
+        // Max LSN of the log before this write, for hot_partition_batch.
+        lsn_t max_lsn_before = LSN_INVALID;
+        if (use_hot_partition_cache) {
+          auto logs_it = logs_.find(op->log_id.val_);
+          ld_check(logs_it != logs_.cend());
+          max_lsn_before =
+              logs_it->second->latest_partition.max_lsn_in_latest.load();
+        }
         if (write->getType() == WriteType::PUT) {
           auto* put_write_op = static_cast<const PutWriteOp*>(write);
           int rv = LocalLogStoreRecordFormat::parseFlags(
@@ -2813,6 +3168,20 @@ int PartitionedRocksDBStore::writeMultiImpl(
           break;
         }
 
+        if (partition->offloaded.load()) {
+          // Directory updates for this write may already be in the batch.
+          // That's fine, directory is allowed to overestimate LSN ranges.
+          if (!flush_batch()) {
+            return -1;
+          }
+          *to_restore = partition;
+          err = E::AGAIN;
+          return -1;
+        }
+
+        hot_partition_batch.onRecordWrite(
+            *write, partition->id_, max_lsn_before);
+
         if (write->getType() == WriteType::PUT &&
             write->durability() == Durability::MEMORY) {
           const PutWriteOp* put_op = static_cast<const PutWriteOp*>(write);
@@ -2841,6 +3210,7 @@ int PartitionedRocksDBStore::writeMultiImpl(
         dir_updates_pending[op->log_id] = dir_updates_flushed + 1;
 
         cf_handle = partition->cf_.get();
+        write_partition = partition;
 
         // Complain about suspicious writes.
         if (write->getType() != WriteType::PUT ||
@@ -2909,6 +3279,18 @@ int PartitionedRocksDBStore::writeMultiImpl(
               rocksdb_batch.Merge(metadata_cf_.get(), key_slice, value_slice);
             }
           }
+
+          if (partition->filterable_keys_indexed &&
+              !(flags & LocalLogStoreRecordFormat::FLAG_AMEND)) {
+            // Amends don't change the keys of the record they amend.
+            CustomIndexDirectoryKey key(
+                put_op->log_id, FILTERABLE_KEY_INDEX, partition->id_);
+            std::string value = filterableKeyRangeOf(*put_op);
+            rocksdb_batch.Merge(
+                metadata_cf_.get(),
+                rocksdb::Slice(reinterpret_cast<const char*>(&key), sizeof key),
+                rocksdb::Slice(value.data(), value.size()));
+          }
         }
 
         break;
@@ -2925,9 +3307,29 @@ int PartitionedRocksDBStore::writeMultiImpl(
     if (!skip_op) {
       writes.push_back(write);
       cf_handles.push_back(cf_handle);
+      if (rebuilding_sst_ingestion) {
+        // Only old partitions, and only writes whose loss in a crash is
+        // covered by dirty state, like memtable contents.
+        bufferable.push_back(
+            write->getType() == WriteType::PUT &&
+            static_cast<const PutWriteOp*>(write)->isRebuilding() &&
+            write->durability() == Durability::MEMORY &&
+            write_partition != nullptr &&
+            write_partition->id_ + 1 < latest_partition_id);
+        write_partitions.push_back(std::move(write_partition));
+      }
     }
   }
 
+  if (rebuilding_sst_ingestion &&
+      bufferRebuildingWrites(
+          writes, cf_handles, write_partitions, bufferable, options) != 0) {
+    // Keep directory consistent with LogState.
+    flush_batch();
+    err = E::LOCAL_LOG_STORE_WRITE;
+    return -1;
+  }
+
   ld_check_eq(writes.size(), cf_handles.size());
   ld_check_eq(*min_target_partition_est, min_target_partition->id_);
   ld_check(!min_target_partition->is_dropped);
@@ -2947,6 +3349,11 @@ int PartitionedRocksDBStore::writeMultiImpl(
   auto timestamp_wal_flush_token = maxWALSyncToken();
   auto now = currentSteadyTime();
 
+  if (rv == 0) {
+    // Needs to happen before unlocking LogState::mutex'es.
+    hot_partition_batch.commit(flush_token);
+  }
+
   // The rest of this method updates dirty state.
 
   // Unlock LogState::mutex'es, we don't need them anymore.
@@ -3188,6 +3595,243 @@ int PartitionedRocksDBStore::writeMultiImpl(
   return rv;
 }
 
+int PartitionedRocksDBStore::bufferRebuildingWrites(
+    std::vector<const WriteOp*>& writes,
+    std::vector<rocksdb::ColumnFamilyHandle*>& cf_handles,
+    const std::vector<PartitionPtr>& partitions,
+    const std::vector<bool>& bufferable,
+    const WriteOptions& write_options) {
+  ld_check_eq(writes.size(), cf_handles.size());
+  ld_check_eq(writes.size(), partitions.size());
+  ld_check_eq(writes.size(), bufferable.size());
+
+  // (partition, log) pairs of the writes that go through memtables.
+  std::set<std::pair<partition_id_t, logid_t>> unbuffered_targets;
+  // Records that could be buffered.
+  std::set<std::pair<logid_t, lsn_t>> bufferable_records;
+  bool buffer = false;
+  bool conflict = false;
+  for (size_t i = 0; i < writes.size(); ++i) {
+    if (partitions[i] == nullptr) {
+      continue;
+    }
+    const RecordWriteOp* op = static_cast<const RecordWriteOp*>(writes[i]);
+    if (bufferable[i]) {
+      buffer = true;
+      conflict |= !bufferable_records.emplace(op->log_id, op->lsn).second;
+    } else {
+      unbuffered_targets.emplace(partitions[i]->id_, op->log_id);
+    }
+  }
+  for (size_t i = 0; i < writes.size() && !conflict; ++i) {
+    if (bufferable[i]) {
+      const PutWriteOp* op = static_cast<const PutWriteOp*>(writes[i]);
+      conflict = unbuffered_targets.count(
+          std::make_pair(partitions[i]->id_, op->log_id));
+    }
+  }
+  // If the batch writes some records more than once, or writes other things
+  // to the logs in the same partitions, write it all normally rather than
+  // reasoning about the order.
+  buffer = buffer && !conflict;
+
+  std::lock_guard<std::mutex> lock(rebuilding_sst_mutex_);
+  if (rebuilding_sst_buffers_.empty() && !buffer) {
+    return 0;
+  }
+
+  // Writes going through memtables must be applied after the buffered
+  // writes of the same logs.
+  for (const auto& target : unbuffered_targets) {
+    auto it = rebuilding_sst_buffers_.find(target.first);
+    if (it != rebuilding_sst_buffers_.end() &&
+        it->second.buffer->containsLog(target.second) &&
+        !ingestRebuildingSstBuffer(it->second.partition)) {
+      return -1;
+    }
+  }
+  if (!buffer) {
+    return 0;
+  }
+
+  std::vector<const WriteOp*> sst_writes;
+  std::vector<rocksdb::ColumnFamilyHandle*> sst_cf_handles;
+  std::map<partition_id_t, std::pair<PartitionPtr, std::set<logid_t>>>
+      sst_targets;
+  size_t n = 0;
+  for (size_t i = 0; i < writes.size(); ++i) {
+    if (bufferable[i]) {
+      sst_writes.push_back(writes[i]);
+      sst_cf_handles.push_back(cf_handles[i]);
+      auto& target = sst_targets[partitions[i]->id_];
+      target.first = partitions[i];
+      target.second.insert(static_cast<const PutWriteOp*>(writes[i])->log_id);
+    } else {
+      writes[n] = writes[i];
+      cf_handles[n] = cf_handles[i];
+      ++n;
+    }
+  }
+  writes.resize(n);
+  cf_handles.resize(n);
+
+  rocksdb::WriteBatch sst_batch;
+  int rv = writer_->writeMulti(sst_writes,
+                               write_options,
+                               metadata_cf_.get(),
+                               &sst_cf_handles,
+                               sst_batch,
+                               sst_batch,
+                               /*skip_checksum_verification=*/true,
+                               /*apply=*/false);
+  if (rv != 0) {
+    return -1;
+  }
+
+  SCOPE_EXIT {
+    updateRebuildingSstMinFlushToken();
+  };
+  for (auto& kv : sst_targets) {
+    const PartitionPtr& partition = kv.second.first;
+    const uint32_t cf_id = partition->cf_->GetID();
+    auto it = rebuilding_sst_buffers_.find(kv.first);
+    if (it != rebuilding_sst_buffers_.end() &&
+        !it->second.buffer->add(sst_batch, cf_id, kv.second.second)) {
+      // Some of the records are already buffered, e.g. this is an amend.
+      // Ingest the buffer so that the new writes are applied on top.
+      if (!ingestRebuildingSstBuffer(partition)) {
+        return -1;
+      }
+      it = rebuilding_sst_buffers_.end();
+    }
+    if (it == rebuilding_sst_buffers_.end()) {
+      RebuildingSstBufferEntry entry{
+          partition,
+          std::make_unique<RebuildingSstBuffer>(
+              maxFlushToken(), currentSteadyTime())};
+      bool added = entry.buffer->add(sst_batch, cf_id, kv.second.second);
+      // A fresh buffer only refuses records written twice by the batch,
+      // which we checked above.
+      ld_check(added);
+      if (!added) {
+        return -1;
+      }
+      rebuilding_sst_buffers_.emplace(kv.first, std::move(entry));
+    }
+  }
+  return 0;
+}
+
+bool PartitionedRocksDBStore::ingestRebuildingSstBuffer(
+    const PartitionPtr& partition) {
+  auto it = rebuilding_sst_buffers_.find(partition->id_);
+  if (it == rebuilding_sst_buffers_.end()) {
+    return true;
+  }
+  std::unique_ptr<RebuildingSstBuffer> buffer = std::move(it->second.buffer);
+  rebuilding_sst_buffers_.erase(it);
+  SCOPE_EXIT {
+    updateRebuildingSstMinFlushToken();
+  };
+  if (partition->is_dropped) {
+    // The records are trimmed anyway.
+    return true;
+  }
+
+  const std::string path = rebuildingSstPath(partition->id_);
+  SCOPE_EXIT {
+    boost::system::error_code ec;
+    boost::filesystem::remove(path, ec);
+  };
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(
+      boost::filesystem::path(path).parent_path(), ec);
+  rocksdb::Status status = buffer->writeFile(
+      path, rocksdb::Options(rocksdb_config_.options_, data_cf_options_));
+  if (status.ok()) {
+    rocksdb::IngestExternalFileOptions options;
+    options.move_files = true;
+    status = db_->IngestExternalFile(partition->cf_.get(), {path}, options);
+  }
+  if (!status.ok()) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    10,
+                    "Failed to ingest %lu bytes of rebuilding writes into "
+                    "partition %lu of shard %u: %s",
+                    buffer->bytes(),
+                    partition->id_,
+                    shard_idx_,
+                    status.ToString().c_str());
+    enterFailSafeIfFailed(status, "IngestExternalFile()");
+    STAT_INCR(stats_, rebuilding_sst_ingestion_errors);
+    // Keep the buffer, so that its writes are still not reported flushed.
+    rebuilding_sst_buffers_.emplace(
+        partition->id_, RebuildingSstBufferEntry{partition, std::move(buffer)});
+    return false;
+  }
+  STAT_INCR(stats_, rebuilding_sst_files_ingested);
+  STAT_ADD(stats_, rebuilding_sst_bytes_ingested, buffer->bytes());
+  return true;
+}
+
+int PartitionedRocksDBStore::ingestRebuildingSstBuffers(bool all) {
+  std::vector<PartitionPtr> to_ingest;
+  {
+    std::lock_guard<std::mutex> lock(rebuilding_sst_mutex_);
+    const auto now = currentSteadyTime();
+    const auto max_age = getSettings()->partition_data_age_flush_trigger;
+    for (const auto& kv : rebuilding_sst_buffers_) {
+      const RebuildingSstBuffer& buffer = *kv.second.buffer;
+      if (all ||
+          buffer.bytes() >= getSettings()->rebuilding_sst_buffer_size_ ||
+          (max_age.count() > 0 && now - buffer.createdAt() >= max_age)) {
+        to_ingest.push_back(kv.second.partition);
+      }
+    }
+  }
+
+  int rv = 0;
+  for (const PartitionPtr& partition : to_ingest) {
+    // Prevent the partition from being dropped during ingestion.
+    folly::SharedMutex::ReadHolder partition_lock(partition->mutex_);
+    std::lock_guard<std::mutex> lock(rebuilding_sst_mutex_);
+    if (!ingestRebuildingSstBuffer(partition)) {
+      rv = -1;
+    }
+  }
+  return rv;
+}
+
+void PartitionedRocksDBStore::updateRebuildingSstMinFlushToken() {
+  FlushToken min_token = FlushToken_MAX;
+  for (const auto& kv : rebuilding_sst_buffers_) {
+    min_token = std::min(min_token, kv.second.buffer->flushToken());
+  }
+  rebuilding_sst_min_flush_token_.store(min_token);
+}
+
+bool PartitionedRocksDBStore::hasRebuildingSstBuffer(
+    partition_id_t partition) {
+  std::lock_guard<std::mutex> lock(rebuilding_sst_mutex_);
+  return rebuilding_sst_buffers_.count(partition) != 0;
+}
+
+std::string
+PartitionedRocksDBStore::rebuildingSstPath(partition_id_t partition) const {
+  return folly::sformat("{}/rebuilding/{}.sst", getDBPath(), partition);
+}
+
+FlushToken PartitionedRocksDBStore::flushedUpThrough() const {
+  const FlushToken flushed = RocksDBLogStoreBase::flushedUpThrough();
+  const FlushToken buffered = rebuilding_sst_min_flush_token_.load();
+  if (buffered == FlushToken_MAX) {
+    return flushed;
+  }
+  // Everything written since the oldest buffer was created may be buffered.
+  return std::min(
+      flushed, buffered == FlushToken_INVALID ? buffered : buffered - 1);
+}
+
 int PartitionedRocksDBStore::writeStoreMetadata(
     const StoreMetadata& metadata,
     const WriteOptions& write_options) {
@@ -3241,6 +3885,16 @@ int PartitionedRocksDBStore::readAllLogSnapshotBlobs(
   return readAllLogSnapshotBlobsImpl(type, callback, snapshots_cf_.get());
 }
 
+int PartitionedRocksDBStore::readLogSnapshotBlobs(
+    LogSnapshotBlobType type,
+    logid_t first,
+    logid_t last,
+    LogSnapshotBlobCallback callback) {
+  std::lock_guard<std::mutex> snapshots_lock(snapshots_cf_lock_);
+  return readAllLogSnapshotBlobsImpl(
+      type, callback, snapshots_cf_.get(), first, last);
+}
+
 int PartitionedRocksDBStore::writeLogSnapshotBlobs(
     LogSnapshotBlobType snapshots_type,
     const std::vector<std::pair<logid_t, Slice>>& snapshots) {
@@ -3321,6 +3975,55 @@ int PartitionedRocksDBStore::dropPartitions(
     std::function<partition_id_t()> get_oldest_to_keep) {
   ld_check(!getSettings()->read_only);
   ld_check(!immutable_.load());
+  const size_t batch_size = getSettings()->partition_drop_batch_size_;
+
+  drop_target_.store(oldest_to_keep_est);
+  SCOPE_EXIT {
+    drop_target_.store(PARTITION_INVALID);
+  };
+
+  // Drop in batches, releasing oldest_partition_mutex_ and partition locks
+  // in between, so that a drop of hundreds of partitions doesn't block writers
+  // and other background work for the whole time, and the deletion of the
+  // dropped files (rate limited by sst-delete-bytes-per-sec) starts early.
+  E error = E::OK;
+  while (true) {
+    partition_id_t batch_end = oldest_to_keep_est;
+    if (batch_size != 0) {
+      batch_end = std::min(batch_end, oldest_partition_id_.load() + batch_size);
+    }
+    int rv = dropPartitionsBatch(batch_end, [&]() {
+      return std::min(batch_end, get_oldest_to_keep());
+    });
+    if (rv != 0) {
+      if (err != E::GAP) {
+        return -1;
+      }
+      // Keep going, the gap is dropped along with the other partitions.
+      error = E::GAP;
+    }
+    STAT_INCR(stats_, partition_drop_batches);
+    if (batch_end >= oldest_to_keep_est ||
+        oldest_partition_id_.load() < batch_end) {
+      // Done, or get_oldest_to_keep() decided to drop less.
+      break;
+    }
+    if (shutdown_event_.signaled()) {
+      err = E::SHUTDOWN;
+      return -1;
+    }
+  }
+
+  if (error != E::OK) {
+    err = error;
+    return -1;
+  }
+  return 0;
+}
+
+int PartitionedRocksDBStore::dropPartitionsBatch(
+    partition_id_t oldest_to_keep_est,
+    std::function<partition_id_t()> get_oldest_to_keep) {
   // All partition drops are serialized for simplicity.
   std::lock_guard<std::mutex> drop_lock(oldest_partition_mutex_);
 
@@ -3425,6 +4128,21 @@ int PartitionedRocksDBStore::dropPartitions(
 
   cleanUpPartitionMetadataAfterDrop(oldest_to_keep);
 
+  // Delete remote copies of partitions. RemoteStorage::remove() ignores
+  // objects that don't exist, so there's no need to know which partitions
+  // were uploaded, possibly before a restart.
+  if (auto remote_storage = remote_storage_.get()) {
+    for (auto& partition : partitions) {
+      if (remote_storage->remove(remoteStorageKey(partition->id_)) != 0) {
+        ld_warning("Failed to remove remote copy of dropped partition %lu of "
+                   "shard %u",
+                   partition->id_,
+                   shard_idx_);
+        STAT_INCR(stats_, partition_offload_errors);
+      }
+    }
+  }
+
   STAT_ADD(stats_, partitions_dropped, oldest_to_keep - prev_oldest);
   STAT_SUB(stats_, partitions, oldest_to_keep - prev_oldest);
 
@@ -3783,13 +4501,18 @@ bool PartitionedRocksDBStore::PartialCompactionEvaluator::evaluateAll(
     if (!overlap) {
       PartitionToCompact p(partitions_[candidate.partition_offset],
                            PartitionToCompact::Reason::PARTIAL);
+      uint64_t total_size = 0;
       for (size_t file_offset = candidate.start_idx;
            file_offset < candidate.end_idx();
            ++file_offset) {
         ld_check_lt(file_offset, candidate.metadata->levels[0].files.size());
-        p.partial_compaction_filenames.push_back(
-            candidate.metadata->levels[0].files[file_offset].name);
+        const auto& file = candidate.metadata->levels[0].files[file_offset];
+        p.partial_compaction_filenames.push_back(file.name);
+        total_size += file.size;
       }
+      // Partial compactions rewrite the files, usually without dropping much.
+      p.has_cost_estimate = true;
+      p.predicted_io_bytes = total_size * 2;
       idx.emplace(candidate.partition_offset, candidate);
       out_to_compact->push_back(std::move(p));
 
@@ -4330,6 +5053,19 @@ partition_id_t PartitionedRocksDBStore::findObsoletePartitions() {
   return oldest_to_keep;
 }
 
+void PartitionedRocksDBStore::estimateCompactionCost(
+    PartitionToCompact* to_compact) {
+  ld_check(to_compact->reason != PartitionToCompact::Reason::PARTIAL);
+  const PartitionPtr& partition = to_compact->partition;
+  uint64_t size = getApproximatePartitionSize(partition->cf_.get());
+  uint64_t obsolete =
+      std::min(size, getApproximateObsoleteBytes(partition->id_));
+  // Full compaction reads the whole partition and writes what's left.
+  to_compact->has_cost_estimate = true;
+  to_compact->predicted_reclaimed_bytes = obsolete;
+  to_compact->predicted_io_bytes = size + (size - obsolete);
+}
+
 void PartitionedRocksDBStore::performCompactionInternal(
     PartitionToCompact to_compact) {
   ld_check(!getSettings()->read_only);
@@ -4369,6 +5105,10 @@ void PartitionedRocksDBStore::performCompactionInternal(
     STAT_DECR(stats_, partition_compactions_in_progress);
   };
 
+  uint64_t size_before = to_compact.has_cost_estimate
+      ? getApproximatePartitionSize(partition->cf_.get())
+      : 0;
+
   auto start_time = currentSteadyTime();
 
 #ifdef LOGDEVICED_ROCKSDB_HAS_FILTER_V2
@@ -4441,6 +5181,16 @@ void PartitionedRocksDBStore::performCompactionInternal(
   STAT_INCR(stats_, partitions_compacted);
   STAT_ADD(stats_, partitions_compaction_time, msec_taken.count());
 
+  if (to_compact.has_cost_estimate) {
+    uint64_t size_after = getApproximatePartitionSize(partition->cf_.get());
+    STAT_ADD(stats_,
+             partition_compaction_predicted_reclaimed_bytes,
+             to_compact.predicted_reclaimed_bytes);
+    STAT_ADD(stats_,
+             partition_compaction_actual_reclaimed_bytes,
+             size_before > size_after ? size_before - size_after : 0);
+  }
+
   ld_debug("compacted partition %lu", partition_id);
 
   // Update partition metadata.
@@ -4826,6 +5576,7 @@ void PartitionedRocksDBStore::cleanUpDirectory(
         // From in-memory directory as well
         in_memory_directory_it =
             log_state->directory.erase(in_memory_directory_it);
+        invalidateFindTimeIndex(log_state);
 
         // Delete the coresponding index entry (if any). The index entry would
         // only exist if the user uses custom keys, which is rare. So most of
@@ -4952,7 +5703,9 @@ void PartitionedRocksDBStore::cleanUpPartitionMetadataAfterDrop(
                     PartitionMetadataType::MIN_TIMESTAMP,
                     PartitionMetadataType::MAX_TIMESTAMP,
                     PartitionMetadataType::LAST_COMPACTION,
-                    PartitionMetadataType::DIRTY}) {
+                    PartitionMetadataType::DIRTY,
+                    PartitionMetadataType::OFFLOADED,
+                    PartitionMetadataType::FILTERABLE_KEYS_INDEXED}) {
     PartitionMetaKey key(type, PARTITION_INVALID);
     it.Seek(rocksdb::Slice(reinterpret_cast<const char*>(&key), sizeof(key)));
     while (it.status().ok() && it.Valid() &&
@@ -5004,6 +5757,356 @@ int PartitionedRocksDBStore::dropPartitionsUpTo(partition_id_t oldest_to_keep) {
   return rv;
 }
 
+void PartitionedRocksDBStore::setRemoteStorage(
+    std::shared_ptr<RemoteStorage> remote_storage) {
+  remote_storage_.update(std::move(remote_storage));
+}
+
+std::string
+PartitionedRocksDBStore::remoteStorageKey(partition_id_t partition) const {
+  return folly::sformat("shard{}/partition{}", shard_idx_, partition);
+}
+
+std::string
+PartitionedRocksDBStore::offloadStagingPath(partition_id_t partition) const {
+  return folly::sformat("{}/offload/{}.sst", getDBPath(), partition);
+}
+
+std::vector<std::string> PartitionedRocksDBStore::getColumnFamilyFiles(
+    rocksdb::ColumnFamilyHandle* cf) const {
+  rocksdb::ColumnFamilyMetaData meta;
+  db_->GetColumnFamilyMetaData(cf, &meta);
+  std::vector<std::string> files;
+  for (const auto& level : meta.levels) {
+    for (const auto& file : level.files) {
+      files.push_back(file.name);
+    }
+  }
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+bool PartitionedRocksDBStore::memtablesEmpty(
+    rocksdb::ColumnFamilyHandle* cf) const {
+  for (const char* property : {"rocksdb.num-entries-active-mem-table",
+                               "rocksdb.num-entries-imm-mem-tables"}) {
+    uint64_t entries;
+    if (!db_->GetIntProperty(cf, property, &entries) || entries != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t PartitionedRocksDBStore::offloadColdPartitions() {
+  ld_check(!getSettings()->read_only);
+  std::chrono::seconds offload_age = getSettings()->partition_offload_age_;
+  if (offload_age.count() == 0 || remote_storage_.get() == nullptr) {
+    return 0;
+  }
+  RecordTimestamp max_ts = RecordTimestamp(currentTime()) - offload_age;
+  SteadyTimestamp max_access_time =
+      SteadyTimestamp::now() - getSettings()->partition_offload_cache_ttl_;
+
+  size_t offloaded = 0;
+  auto partitions = getPartitionList();
+  // The two latest partitions take almost all writes, never offload them.
+  for (partition_id_t id = partitions->firstID(); id + 2 < partitions->nextID();
+       ++id) {
+    if (shutdown_event_.signaled() || inFailSafeMode()) {
+      break;
+    }
+    PartitionPtr partition = partitions->get(id);
+    if (partition->offloaded.load() || partition->max_timestamp > max_ts ||
+        partition->last_access_time > max_access_time) {
+      continue;
+    }
+    if (offloadPartition(partition)) {
+      ++offloaded;
+    }
+  }
+  return offloaded;
+}
+
+bool PartitionedRocksDBStore::offloadPartition(PartitionPtr partition) {
+  std::shared_ptr<RemoteStorage> remote_storage = remote_storage_.get();
+  ld_check(remote_storage != nullptr);
+  const partition_id_t id = partition->id_;
+  rocksdb::ColumnFamilyHandle* cf = partition->cf_.get();
+
+  std::lock_guard<std::mutex> offload_lock(partition->offload_mutex_);
+  if (partition->offloaded.load() || hasRebuildingSstBuffer(id)) {
+    // Buffered rebuilding writes are not in the partition's files yet.
+    return false;
+  }
+
+  if (!memtablesEmpty(cf) && !flushMemtables(partition)) {
+    return false;
+  }
+  std::vector<std::string> files = getColumnFamilyFiles(cf);
+  if (files.empty()) {
+    // Nothing to offload.
+    return false;
+  }
+
+  // 1) Upload the partition, unless the remote copy is up to date: the
+  // partition was restored and not written to since.
+  if (files != partition->remote_copy_files) {
+    partition->remote_copy_files.clear();
+    const std::string path = offloadStagingPath(id);
+    SCOPE_EXIT {
+      boost::system::error_code ec;
+      boost::filesystem::remove(path, ec);
+    };
+
+    // Export all records of the partition into a single SST file.
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(
+        boost::filesystem::path(path).parent_path(), ec);
+    rocksdb::SstFileWriter sst_writer(
+        rocksdb::EnvOptions(),
+        rocksdb::Options(rocksdb_config_.options_, data_cf_options_),
+        cf);
+    rocksdb::Status status = sst_writer.Open(path);
+    auto read_options = getDefaultReadOptions();
+    read_options.fill_cache = false;
+    RocksDBIterator it = newIterator(read_options, cf);
+    size_t num_keys = 0;
+    for (it.SeekToFirst(); status.ok() && it.status().ok() && it.Valid();
+         it.Next()) {
+      status = sst_writer.Put(it.key(), it.value());
+      ++num_keys;
+    }
+    if (status.ok()) {
+      status = it.status();
+    }
+    if (status.ok() && num_keys == 0) {
+      // Only deletions left, wait for them to be compacted away.
+      return false;
+    }
+    rocksdb::ExternalSstFileInfo file_info;
+    if (status.ok()) {
+      status = sst_writer.Finish(&file_info);
+    }
+    if (!status.ok()) {
+      ld_error("Failed to export partition %lu of shard %u to %s: %s",
+               id,
+               shard_idx_,
+               path.c_str(),
+               status.ToString().c_str());
+      STAT_INCR(stats_, partition_offload_errors);
+      return false;
+    }
+
+    if (remote_storage->upload(remoteStorageKey(id), path) != 0) {
+      RATELIMIT_ERROR(std::chrono::seconds(10),
+                      10,
+                      "Failed to upload partition %lu of shard %u",
+                      id,
+                      shard_idx_);
+      STAT_INCR(stats_, partition_offload_errors);
+      return false;
+    }
+    partition->remote_copy_files = files;
+    partition->remote_copy_bytes = file_info.file_size;
+    STAT_INCR(stats_, partitions_uploaded);
+    STAT_ADD(stats_, partition_offload_bytes_uploaded, file_info.file_size);
+  }
+
+  // 2) Mark the partition offloaded, unless it was written to or dropped
+  // while we were uploading it. Writers only lock the oldest partition they
+  // write to, so lock all partitions up to this one, the same way
+  // dropPartitionsBatch() does.
+  {
+    std::lock_guard<std::mutex> drop_lock(oldest_partition_mutex_);
+    std::vector<folly::SharedMutex::WriteHolder> partition_locks;
+    auto partitions = getPartitionList();
+    for (partition_id_t p = partitions->firstID(); p <= id; ++p) {
+      PartitionPtr to_lock = partitions->get(p);
+      if (to_lock == nullptr) {
+        // Dropped.
+        return false;
+      }
+      partition_locks.emplace_back(to_lock->mutex_);
+    }
+    if (partition->is_dropped ||
+        !partition->dirty_state_.dirtied_by_nodes.empty() ||
+        partition->dirty_state_.under_replicated) {
+      return false;
+    }
+    if (!memtablesEmpty(cf) || getColumnFamilyFiles(cf) != files) {
+      // The partition was written to. It'll be uploaded again next time.
+      return false;
+    }
+
+    // The metadata tells open() that the local files of this partition are
+    // gone or about to be.
+    LocalLogStore::WriteOptions write_options;
+    int rv = writer_->writeMetadata(
+        PartitionMetaKey(PartitionMetadataType::OFFLOADED, id),
+        PartitionOffloadedMetadata(partition->remote_copy_bytes),
+        write_options,
+        metadata_cf_.get());
+    if (rv != 0 || syncWAL() != 0) {
+      ld_error("Failed to write offloaded metadata for partition %lu of shard "
+               "%u: %s",
+               id,
+               shard_idx_,
+               error_description(err));
+      STAT_INCR(stats_, partition_offload_errors);
+      return false;
+    }
+    partition->offloaded.store(true);
+  }
+
+  // 3) Delete the local data. Iterators created before the partition was
+  // marked offloaded keep seeing it. No locks needed: readers and writers
+  // check `offloaded` first, and restores wait for offload_mutex_.
+  rocksdb::Status status =
+      rocksdb::DeleteFilesInRange(db_.get(), cf, nullptr, nullptr);
+  rocksdb::ColumnFamilyMetaData meta;
+  db_->GetColumnFamilyMetaData(cf, &meta);
+  if (status.ok() && meta.file_count != 0) {
+    // DeleteFilesInRange() leaves level 0 files. Cover what's left with
+    // a range tombstone and compact it away.
+    const rocksdb::Comparator* cmp = data_cf_options_.comparator;
+    std::string smallest, largest;
+    for (const auto& level : meta.levels) {
+      for (const auto& file : level.files) {
+        if (smallest.empty() || cmp->Compare(file.smallestkey, smallest) < 0) {
+          smallest = file.smallestkey;
+        }
+        if (largest.empty() || cmp->Compare(file.largestkey, largest) > 0) {
+          largest = file.largestkey;
+        }
+      }
+    }
+    rocksdb::WriteBatch batch;
+    batch.DeleteRange(cf, smallest, largest);
+    batch.Delete(cf, largest);
+    status = writer_->writeBatch(rocksdb::WriteOptions(), &batch);
+    if (status.ok()) {
+      rocksdb::CompactRangeOptions options;
+      options.bottommost_level_compaction =
+          rocksdb::BottommostLevelCompaction::kForce;
+      status = db_->CompactRange(options, cf, nullptr, nullptr);
+    }
+  }
+  if (!status.ok()) {
+    // The partition is offloaded anyway, what's left is just wasted space
+    // until it's dropped or restored.
+    ld_error("Failed to delete local data of offloaded partition %lu of "
+             "shard %u: %s",
+             id,
+             shard_idx_,
+             status.ToString().c_str());
+    enterFailSafeIfFailed(status, "offloadPartition()");
+    STAT_INCR(stats_, partition_offload_errors);
+  }
+
+  ld_info("Offloaded partition %lu of shard %u", id, shard_idx_);
+  STAT_INCR(stats_, partitions_offloaded);
+  return true;
+}
+
+int PartitionedRocksDBStore::restorePartition(PartitionPtr partition) const {
+  const partition_id_t id = partition->id_;
+  rocksdb::ColumnFamilyHandle* cf = partition->cf_.get();
+
+  std::lock_guard<std::mutex> offload_lock(partition->offload_mutex_);
+  if (!partition->offloaded.load()) {
+    // Someone else restored it.
+    return 0;
+  }
+  // Keep the partition from being dropped while we're ingesting into it.
+  folly::SharedMutex::ReadHolder cf_lock(partition->mutex_);
+  if (partition->is_dropped) {
+    err = E::FAILED;
+    return -1;
+  }
+  std::shared_ptr<RemoteStorage> remote_storage = remote_storage_.get();
+  if (remote_storage == nullptr) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    10,
+                    "Partition %lu of shard %u is offloaded but there's no "
+                    "remote storage to restore it from",
+                    id,
+                    shard_idx_);
+    err = E::FAILED;
+    return -1;
+  }
+
+  const std::string path = offloadStagingPath(id);
+  SCOPE_EXIT {
+    boost::system::error_code ec;
+    boost::filesystem::remove(path, ec);
+  };
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(
+      boost::filesystem::path(path).parent_path(), ec);
+  if (remote_storage->download(remoteStorageKey(id), path) != 0) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    10,
+                    "Failed to download partition %lu of shard %u",
+                    id,
+                    shard_idx_);
+    STAT_INCR(stats_, partition_offload_errors);
+    err = E::FAILED;
+    return -1;
+  }
+  const uint64_t size_bytes = boost::filesystem::file_size(path, ec);
+
+  rocksdb::IngestExternalFileOptions options;
+  options.move_files = true;
+  rocksdb::Status status = db_->IngestExternalFile(cf, {path}, options);
+  if (status.ok()) {
+    LocalLogStore::WriteOptions write_options;
+    if (writer_->deleteMetadata(
+            PartitionMetaKey(PartitionMetadataType::OFFLOADED, id),
+            write_options,
+            metadata_cf_.get()) != 0) {
+      status = rocksdb::Status::IOError("failed to delete metadata");
+    } else {
+      // If the deletion was lost in a crash, the partition would be restored
+      // again on top of newer writes.
+      status = writer_->syncWAL();
+    }
+  }
+  if (!status.ok()) {
+    ld_error("Failed to restore partition %lu of shard %u: %s",
+             id,
+             shard_idx_,
+             status.ToString().c_str());
+    enterFailSafeIfFailed(status, "restorePartition()");
+    STAT_INCR(stats_, partition_offload_errors);
+    err = E::FAILED;
+    return -1;
+  }
+
+  partition->remote_copy_files = getColumnFamilyFiles(cf);
+  partition->remote_copy_bytes = size_bytes;
+  partition->last_access_time = SteadyTimestamp::now();
+  partition->offloaded.store(false);
+  ld_info("Restored partition %lu of shard %u", id, shard_idx_);
+  STAT_INCR(stats_, partitions_restored);
+  STAT_ADD(stats_, partition_offload_bytes_downloaded, size_bytes);
+  return 0;
+}
+
+int PartitionedRocksDBStore::ensurePartitionLocal(
+    const PartitionPtr& partition,
+    bool allow_blocking_io) const {
+  partition->last_access_time = SteadyTimestamp::now();
+  if (!partition->offloaded.load()) {
+    return 0;
+  }
+  if (!allow_blocking_io) {
+    err = E::WOULDBLOCK;
+    return -1;
+  }
+  return restorePartition(partition);
+}
+
 void PartitionedRocksDBStore::performMetadataCompaction() {
   ld_check(!getSettings()->read_only);
   ld_check(!immutable_.load());
@@ -5067,7 +6170,7 @@ void PartitionedRocksDBStore::performCompaction(partition_id_t partition) {
 }
 
 uint64_t PartitionedRocksDBStore::getApproximatePartitionSize(
-    rocksdb::ColumnFamilyHandle* cf) {
+    rocksdb::ColumnFamilyHandle* cf) const {
   // No keys start with a 255 byte.
   rocksdb::Range key_range(rocksdb::Slice("", 0), rocksdb::Slice("\xff", 1));
   uint64_t size;
@@ -5142,16 +6245,20 @@ int PartitionedRocksDBStore::isEmpty() const {
   //  * "schema_version",
   //  * partition metadata of type STARTING_TIMESTAMP.
   //  * partition metadata of type DIRTY.
+  //  * partition metadata of type FILTERABLE_KEYS_INDEXED.
   RocksDBIterator it = createMetadataIterator(true);
   it.Seek(rocksdb::Slice("", 0));
-  while (
-      it.status().ok() && it.Valid() &&
-      (it.key().compare(SCHEMA_VERSION_KEY) == 0 ||
-       PartitionMetaKey::valid(it.key().data(),
-                               it.key().size(),
-                               PartitionMetadataType::STARTING_TIMESTAMP) ||
-       PartitionMetaKey::valid(
-           it.key().data(), it.key().size(), PartitionMetadataType::DIRTY))) {
+  while (it.status().ok() && it.Valid() &&
+         (it.key().compare(SCHEMA_VERSION_KEY) == 0 ||
+          PartitionMetaKey::valid(it.key().data(),
+                                  it.key().size(),
+                                  PartitionMetadataType::STARTING_TIMESTAMP) ||
+          PartitionMetaKey::valid(
+              it.key().data(), it.key().size(), PartitionMetadataType::DIRTY) ||
+          PartitionMetaKey::valid(
+              it.key().data(),
+              it.key().size(),
+              PartitionMetadataType::FILTERABLE_KEYS_INDEXED))) {
     it.Next();
   }
   if (!it.status().ok()) {
@@ -5385,6 +6492,11 @@ int PartitionedRocksDBStore::flushAllMemtables(bool wait) {
   bytes_written_since_flush_.store(0);
   last_flush_time_ = currentSteadyTime();
 
+  if (ingestRebuildingSstBuffers(/*all=*/true) != 0) {
+    err = E::LOCAL_LOG_STORE_WRITE;
+    return -1;
+  }
+
   if (latest_.get()) {
     auto partitions = getPartitionList();
     for (PartitionPtr partition : *partitions) {
@@ -5455,6 +6567,10 @@ void PartitionedRocksDBStore::hiPriBackgroundThreadRun() {
       createPartition();
     }
 
+    precreateSparePartitions();
+
+    ingestRebuildingSstBuffers(/*all=*/false);
+
     if (shouldFlushMemtables() && !isFlushInProgress()) {
       ld_debug("Shard %d: Triggering Flush with %jd bytes written: "
                "max data age %s, max time idle %s, last flushed %s ago.",
@@ -5475,6 +6591,15 @@ void PartitionedRocksDBStore::hiPriBackgroundThreadRun() {
               format_time_since(last_flush_time_).c_str());
     }
 
+#ifdef LOGDEVICED_ROCKSDB_HAS_GET_AGGREGATED_INT_PROPERTY
+    uint64_t allocated_bytes;
+    if (getDB().GetAggregatedIntProperty(
+            rocksdb::DB::Properties::kSizeAllMemTables, &allocated_bytes)) {
+      PER_SHARD_STAT_SET(
+          stats_, memtable_allocated_bytes, shard_idx_, allocated_bytes);
+    }
+#endif
+
     if (last_broadcast_flush_ < flushedUpThrough()) {
       ld_debug("Shard %d: Flushed up through now %ju.",
                getShardIdx(),
@@ -5660,7 +6785,38 @@ void PartitionedRocksDBStore::loPriBackgroundThreadRun() {
     }
 
     PartitionToCompact::removeDuplicates(&to_compact);
-    PartitionToCompact::interleavePartialAndNormalCompactions(&to_compact);
+    const bool cost_based =
+        getSettings()->partition_compaction_cost_based_scheduling_;
+    if (cost_based) {
+      for (auto& p : to_compact) {
+        if (shutdown_event_.signaled()) {
+          break;
+        }
+        if (p.reason != PartitionToCompact::Reason::PARTIAL &&
+            !p.has_cost_estimate) {
+          estimateCompactionCost(&p);
+        }
+      }
+      PartitionToCompact::orderByCost(
+          &to_compact, getSettings()->partition_compaction_file_value_);
+    } else {
+      PartitionToCompact::interleavePartialAndNormalCompactions(&to_compact);
+    }
+
+    // With cost-based scheduling, how many bytes of compaction IO to schedule
+    // in this iteration: what the compaction rate limit allows until the next
+    // iteration. 0 means unlimited.
+    uint64_t io_budget = 0;
+    if (cost_based) {
+      rate_limit_t rate = getSettings()->compaction_rate_limit_;
+      if (rate.second.count() > 0) {
+        io_budget = std::max<uint64_t>(
+            1,
+            (double)rate.first * getSettings()->partition_lo_pri_check_period_ /
+                rate.second);
+      }
+    }
+    uint64_t io_scheduled = 0;
 
     PER_SHARD_STAT_SET(stats_,
                        pending_compactions,
@@ -5684,7 +6840,13 @@ void PartitionedRocksDBStore::loPriBackgroundThreadRun() {
         skip_sleep = true;
         break;
       }
+      if (!first && io_budget != 0 && io_scheduled >= io_budget) {
+        // The rest will be reconsidered in the next iteration.
+        STAT_INCR(stats_, partition_compactions_postponed_by_io_budget);
+        break;
+      }
       first = false;
+      io_scheduled += p.predicted_io_bytes;
       performCompactionInternal(p);
       // The list of partitions to compact can be merged above, but partition
       // compactions with type MANUAL should always take precedence over all
@@ -5696,6 +6858,9 @@ void PartitionedRocksDBStore::loPriBackgroundThreadRun() {
       }
     }
 
+    // After compactions, so that partitions are uploaded in compacted form.
+    offloadColdPartitions();
+
     // Update stats for total trash size and the rate limit on its deletion
     PER_SHARD_STAT_SET(stats_, trash_size, shard_idx_, getTotalTrashSize());
     PER_SHARD_STAT_SET(stats_,
@@ -5707,6 +6872,16 @@ void PartitionedRocksDBStore::loPriBackgroundThreadRun() {
   ld_info("Shard %d lo-pri background thread finished", getShardIdx());
 }
 
+void PartitionedRocksDBStore::invalidateFindTimeIndex(LogState* log_state) {
+  if (log_state->find_time_index.empty()) {
+    return;
+  }
+  find_time_index_entries_.fetch_sub(log_state->find_time_index.size());
+  // Release the memory, not just the elements.
+  std::vector<std::pair<lsn_t, partition_id_t>>().swap(
+      log_state->find_time_index);
+}
+
 void PartitionedRocksDBStore::LogState::LatestPartitionInfo::load(
     partition_id_t* out_partition,
     lsn_t* out_first_lsn,
@@ -5804,6 +6979,9 @@ operator()(LocalLogStore* store, FlushToken token) const {
   auto s = static_cast<PartitionedRocksDBStore*>(store);
 
   ld_check(!s->getSettings()->read_only);
+
+  // Records flushed to sst files are no longer needed in memory.
+  s->hot_partition_cache_->onFlushed(token);
   Processor* processor = s->processor_.load();
 
   if (!processor) {
@@ -5871,6 +7049,16 @@ void PartitionedRocksDBStore::onSettingsUpdated(
   if (settingsUpdated) {
     ld_info("Changes: %s", ss.str().c_str());
   }
+
+  if (hot_partition_cache_ != nullptr) {
+    hot_partition_cache_->setMaxBytes(
+        rocksdb_settings->hot_partition_cache_max_bytes);
+    if (!rocksdb_settings->hot_partition_cache) {
+      // Release the memory. Writes stop maintaining the cache, so it
+      // must not be used again until it's repopulated from scratch.
+      hot_partition_cache_->clear();
+    }
+  }
 }
 
 uint64_t PartitionedRocksDBStore::getTotalTrashSize() {
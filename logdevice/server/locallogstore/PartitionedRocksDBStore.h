@@ -12,6 +12,7 @@
 #include <chrono>
 #include <deque>
 #include <limits>
+#include <map>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -28,6 +29,7 @@
 #include "logdevice/common/MetaDataLog.h"
 #include "logdevice/common/Metadata.h"
 #include "logdevice/common/RandomAccessQueue.h"
+#include "logdevice/common/ServerRecordFilter.h"
 #include "logdevice/common/SingleEvent.h"
 #include "logdevice/common/Timestamp.h"
 #include "logdevice/common/UpdateableSharedPtr.h"
@@ -35,7 +37,9 @@
 #include "logdevice/common/debug.h"
 #include "logdevice/common/util.h"
 #include "logdevice/server/FixedKeysMap.h"
+#include "logdevice/server/locallogstore/HotPartitionCache.h"
 #include "logdevice/server/locallogstore/NodeDirtyData.h"
+#include "logdevice/server/locallogstore/RebuildingSstBuffer.h"
 #include "logdevice/server/locallogstore/RocksDBLogStoreBase.h"
 #include "logdevice/server/locallogstore/RocksDBWriter.h"
 #include "logdevice/server/storage_tasks/StorageTask.h"
@@ -63,6 +67,7 @@ namespace facebook { namespace logdevice {
  *        always visit one partition at a time.
  */
 
+class RemoteStorage;
 class StatsHolder;
 class ServerProcessor;
 
@@ -270,6 +275,11 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
     std::atomic<std::chrono::seconds> compacted_retention{
         std::chrono::seconds::min()};
 
+    // If true, the FILTERABLE_KEY_INDEX entries of this partition cover all
+    // its records. See PartitionFilterableKeysIndexedMetadata. Never changes
+    // after Partition becomes visible.
+    bool filterable_keys_indexed{false};
+
     DirtyState dirty_state_;
 
     // Whether cf_ is dropped. A dropped column family is readable but not
@@ -277,6 +287,27 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
     // exclusively locked mutex_.
     bool is_dropped{false};
 
+    // If true, the data of this partition is only in remote storage and cf_
+    // has no files; see offloadColdPartitions(). Readers and writers need to
+    // restore the partition before using cf_. Set with exclusively locked
+    // mutex_ of this and all older partitions, like is_dropped.
+    std::atomic<bool> offloaded{false};
+
+    // Serializes offloading and restoring this partition. Protects
+    // remote_copy_files and remote_copy_bytes.
+    std::mutex offload_mutex_;
+
+    // SST files of cf_ at the time the remote copy of this partition was
+    // made. If cf_ still consists of the same files, the remote copy is up to
+    // date and the partition can be offloaded again without uploading it.
+    // Empty if there's no known remote copy.
+    std::vector<std::string> remote_copy_files;
+    uint64_t remote_copy_bytes{0};
+
+    // When the partition was last restored or opened by a reader. Partitions
+    // accessed in the last partition_offload_cache_ttl_ aren't offloaded.
+    AtomicSteadyTimestamp last_access_time{SteadyTimestamp::min()};
+
     Partition(partition_id_t id,
               rocksdb::ColumnFamilyHandle* cf,
               RecordTimestamp starting_timestamp,
@@ -408,6 +439,10 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
     bytes_written_since_flush_.fetch_add(written);
   }
 
+  // Doesn't report rebuilding writes waiting in a RebuildingSstBuffer as
+  // flushed until they are ingested.
+  FlushToken flushedUpThrough() const override;
+
   int writeStoreMetadata(const StoreMetadata& metadata,
                          const WriteOptions& write_options) override;
 
@@ -417,6 +452,11 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   int readAllLogSnapshotBlobs(LogSnapshotBlobType type,
                               LogSnapshotBlobCallback callback) override;
 
+  int readLogSnapshotBlobs(LogSnapshotBlobType type,
+                           logid_t first,
+                           logid_t last,
+                           LogSnapshotBlobCallback callback) override;
+
   int writeLogSnapshotBlobs(
       LogSnapshotBlobType snapshots_type,
       const std::vector<std::pair<logid_t, Slice>>& snapshots) override;
@@ -442,6 +482,17 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
                std::chrono::milliseconds hi,
                size_t* out);
 
+  struct DataSizeRange {
+    logid_t log_id;
+    RecordTimestamp lo;
+    RecordTimestamp hi;
+  };
+
+  // Same as dataSize() for many logs, sharing one snapshot of the partition
+  // list and of the current time. Sets (*out)[i] to the size for ranges[i].
+  void dataSize(const std::vector<DataSizeRange>& ranges,
+                std::vector<size_t>* out);
+
   /**
    * Checks whether the given log is empty, meaning it has either no records or
    * only pseudorecords, such as bridge records and hole plugs.
@@ -452,6 +503,24 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
    */
   bool isLogEmpty(logid_t log_id);
 
+  /**
+   * Sets the storage that cold partitions are offloaded to. Normally it comes
+   * from the REMOTE_STORAGE plugin in setProcessor(); tests set it directly.
+   */
+  void setRemoteStorage(std::shared_ptr<RemoteStorage> remote_storage);
+
+  /**
+   * Moves the data of partitions older than partition_offload_age_ to remote
+   * storage, uploading them if needed, and deletes their local SST files.
+   * Restored partitions that weren't accessed for
+   * partition_offload_cache_ttl_ are offloaded again. Called periodically
+   * from the low priority background thread. Does nothing if there's no
+   * remote storage or partition_offload_age_ is zero.
+   *
+   * @return  number of partitions offloaded.
+   */
+  size_t offloadColdPartitions();
+
   void normalizeTimeRanges(RecordTimeIntervals&) const override;
 
   /**
@@ -477,6 +546,23 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
               bool approximate = false,
               bool allow_blocking_io = true) const override;
 
+  /**
+   * Uses the filterable key index (see --rocksdb-filterable-key-index) to
+   * check whether `partition` may contain records of `log_id` that pass
+   * `filter`.
+   *
+   * @param allow_blocking_io   If false, only looks in the block cache.
+   * @return  1 if the partition may contain such records, which is also the
+   *          answer if the partition isn't indexed; 0 if it certainly
+   *          doesn't; -1 on error, with err set to WOULDBLOCK if
+   *          allow_blocking_io is false and the index entry isn't cached, or
+   *          to FAILED.
+   */
+  int mayContainMatchingRecords(logid_t log_id,
+                                const PartitionPtr& partition,
+                                const ServerRecordFilter& filter,
+                                bool allow_blocking_io = true) const;
+
   // Starts a new partition.
   // Used in tests, and is exposed through an admin command.
   // @return the new partition or nullptr in case of error.
@@ -521,6 +607,18 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   // destroyed before PartitionedRocksDBStore is destroyed.
   PartitionList getPartitionList() const;
 
+  // Number of spare empty partitions currently pre-created ahead of the
+  // latest partition.
+  size_t getNumSparePartitions() const {
+    return num_spare_cfs_.load();
+  }
+
+  // If partitions are being dropped, the ID of the oldest partition that
+  // will remain after the drop. PARTITION_INVALID otherwise.
+  partition_id_t getPartitionDropTarget() const {
+    return drop_target_.load();
+  }
+
   // Wraps partitions_.get(). Returns false if the partition was dropped.
   bool getPartition(partition_id_t id, PartitionPtr* out_partition) const;
 
@@ -589,7 +687,7 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   void performMetadataCompaction();
 
   // Size in bytes of column family data.
-  uint64_t getApproximatePartitionSize(rocksdb::ColumnFamilyHandle* cf);
+  uint64_t getApproximatePartitionSize(rocksdb::ColumnFamilyHandle* cf) const;
 
   // Number of level 0 files in column family. -1 if something
   // went wrong.
@@ -756,6 +854,12 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
     // compacted
     std::vector<std::string> partial_compaction_filenames;
 
+    // Filled in by cost-based scheduling (see orderByCost()): estimated number
+    // of bytes the compaction will free up, and read and write.
+    bool has_cost_estimate{false};
+    uint64_t predicted_reclaimed_bytes{0};
+    uint64_t predicted_io_bytes{0};
+
     PartitionToCompact(PartitionPtr p, Reason r)
         : partition(std::move(p)), reason(r) {
       ld_check(reason != Reason::RETENTION);
@@ -861,6 +965,47 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
       }
     }
 
+    // Benefit per byte of IO, used by orderByCost(). `file_value` is the
+    // benefit of removing one file by a partial compaction.
+    double costScore(uint64_t file_value) const {
+      double benefit = predicted_reclaimed_bytes;
+      if (reason == Reason::PARTIAL && !partial_compaction_filenames.empty()) {
+        benefit +=
+            double(file_value) * (partial_compaction_filenames.size() - 1);
+      }
+      return benefit / std::max<uint64_t>(predicted_io_bytes, 1);
+    }
+
+    // An alternative to interleavePartialAndNormalCompactions() that orders
+    // the same range (the higher priority full compactions and the partial
+    // compactions after them) by costScore(), highest first. Manual
+    // compactions in the range stay in front, in the original order.
+    // Compactions without a cost estimate are treated as having score 0.
+    static void orderByCost(std::vector<PartitionToCompact>* ps,
+                            uint64_t file_value) {
+      auto is_partial = [](const PartitionToCompact& p) {
+        return p.reason == Reason::PARTIAL;
+      };
+      auto range_begin = ps->begin();
+      auto partial_begin = std::find_if(range_begin, ps->end(), is_partial);
+      auto range_end = std::find_if_not(partial_begin, ps->end(), is_partial);
+
+      auto first_to_sort =
+          std::stable_partition(range_begin,
+                                range_end,
+                                [](const PartitionToCompact& p) {
+                                  return p.reason == Reason::MANUAL;
+                                });
+      std::stable_sort(
+          first_to_sort,
+          range_end,
+          [&](const PartitionToCompact& a, const PartitionToCompact& b) {
+            double sa = a.has_cost_estimate ? a.costScore(file_value) : 0;
+            double sb = b.has_cost_estimate ? b.costScore(file_value) : 0;
+            return sa > sb;
+          });
+    }
+
    private:
     size_t sort_order;
   };
@@ -978,6 +1123,11 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
     std::unique_ptr<Deps> deps_;
   };
 
+  // Fills in the cost estimate of a full compaction for orderByCost(),
+  // based on getApproximateObsoleteBytes() and the partition size.
+  // Partial compactions get their estimates from PartialCompactionEvaluator.
+  void estimateCompactionCost(PartitionToCompact* to_compact);
+
   // Drop partitions up to `partition` on the next iteration of background
   // thread.
   void setSpaceBasedTrimLimit(partition_id_t partition) {
@@ -993,6 +1143,12 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
 
   bool shouldStallLowPriWrites() override;
 
+  // Data partitions have compaction triggers disabled; only the metadata
+  // column family can make rocksdb stall writes on L0 files.
+  rocksdb::ColumnFamilyHandle* getWriteStallPredictionCF() override {
+    return metadata_cf_.get();
+  }
+
   void markImmutable() override {
     joinBackgroundThreads();
   }
@@ -1062,6 +1218,14 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
 
     // Information about partitions used by this log, keyed by their first_lsn
     std::map<lsn_t, DirectoryEntry> directory;
+
+    // Flat copy of the keys of `directory` (first_lsn and partition ID),
+    // sorted by first_lsn. Used by findTime() to binary search for the
+    // partitions covering a timestamp without seeking in the on-disk
+    // directory. Built lazily by the first findTime() call for this log and
+    // cleared whenever entries are added to or removed from `directory`.
+    // Empty if not built. See FindTime::findPartitionInMemory().
+    std::vector<std::pair<lsn_t, partition_id_t>> find_time_index;
   };
 
   using LogStateMap = folly::ConcurrentHashMap<logid_t::raw_type,
@@ -1070,6 +1234,11 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
 
   using LogLocks = FixedKeysMap<logid_t, std::unique_lock<std::mutex>>;
 
+  // Drops LogState::find_time_index of the given log, if it was built.
+  // Must be called with locked LogState::mutex whenever entries are added
+  // to or removed from LogState::directory.
+  void invalidateFindTimeIndex(LogState* log_state);
+
   // Opens the RocksDB instance. Called by the constructor.
   bool open(const std::vector<std::string>& column_families,
             const rocksdb::ColumnFamilyOptions& meta_cf_options,
@@ -1095,6 +1264,8 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   // if called with lambda to get first timestamp, by default, waits until CF
   // is created before getting and writing timestamp. This allows for more
   // precise timestamps when we're creating a new latest partition.
+  // If `precreated_cf` is given, it's used instead of creating a CF; `count`
+  // must be 1 then.
   std::vector<PartitionPtr>
   createPartitionsImpl(partition_id_t first_id,
                        RecordTimestamp first_timestamp,
@@ -1111,7 +1282,8 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
       std::function<RecordTimestamp()> get_first_timestamp_func,
       size_t count,
       const DirtyState* pre_dirty_state = nullptr,
-      bool create_cfs_before_metadata = true);
+      bool create_cfs_before_metadata = true,
+      std::unique_ptr<rocksdb::ColumnFamilyHandle> precreated_cf = nullptr);
 
   // Create `count` partitions at the beginning of partition list. Requires
   // `oldest_partition_mutex_` to be locked. Updates oldest_partition_id_.
@@ -1250,12 +1422,63 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   //     it again. Note that it may fail again if the partition was dropped
   //     between the calls, so this method is supposed to be called in a retry
   //     loop. E::AGAIN should be very rare.
+  //     If a record needs to go to an offloaded partition, *to_restore is
+  //     set to it instead, and the partition needs to be restored before
+  //     trying again.
   int writeMultiImpl(const std::vector<const WriteOp*>& writes,
                      const WriteOptions& write_options,
                      const LogLocks::Keys* partitioned_logs, // in
-                     partition_id_t* min_target_partition    // in and out
+                     partition_id_t* min_target_partition,   // in and out
+                     PartitionPtr* to_restore                // out
   );
 
+  // Used by writeMultiImpl() if --rocksdb-rebuilding-sst-ingestion is on.
+  // Moves the writes with bufferable[i] == true from `writes` into the
+  // rebuilding SST buffers of their partitions. Before that ingests the
+  // buffers that contain records of logs that the remaining writes go to in
+  // the same partition, so that the remaining writes are applied after them.
+  // Buffers nothing if some records are written more than once.
+  // The partitions must be protected from dropping by the caller.
+  //
+  // @return  0 on success, -1 on failure with err set to
+  //          E::LOCAL_LOG_STORE_WRITE.
+  int bufferRebuildingWrites(
+      std::vector<const WriteOp*>& writes,
+      std::vector<rocksdb::ColumnFamilyHandle*>& cf_handles,
+      const std::vector<PartitionPtr>& partitions,
+      const std::vector<bool>& bufferable,
+      const WriteOptions& write_options);
+
+  // Writes the rebuilding SST buffer of the partition to a file, ingests it
+  // and removes the buffer. Discards the buffer if the partition is dropped.
+  // Requires rebuilding_sst_mutex_ to be locked, and the partition to be
+  // protected from dropping. Returns false if ingestion failed, the buffer
+  // is kept then.
+  bool ingestRebuildingSstBuffer(const PartitionPtr& partition);
+
+  // Ingests the rebuilding SST buffers that reached
+  // --rocksdb-rebuilding-sst-buffer-size or are older than
+  // --rocksdb-partition-data-age-flush-trigger; all of them if `all` is true.
+  // Returns -1 if some ingestions failed.
+  int ingestRebuildingSstBuffers(bool all);
+
+  // Recomputes rebuilding_sst_min_flush_token_. Requires
+  // rebuilding_sst_mutex_ to be locked.
+  void updateRebuildingSstMinFlushToken();
+
+  bool hasRebuildingSstBuffer(partition_id_t partition);
+
+  // Local file a rebuilding SST buffer is written to before ingestion.
+  std::string rebuildingSstPath(partition_id_t partition) const;
+
+  // Implementation of dataSize() with the given partition list and current
+  // time.
+  size_t dataSizeImpl(logid_t log_id,
+                      RecordTimestamp lo_timestamp,
+                      RecordTimestamp hi_timestamp,
+                      const PartitionList& partitions,
+                      RecordTimestamp now);
+
   // Searches through the directory in order to find the partition a record
   // with the given sequence number belongs to. The iterator will be moved
   // to point to the record for this partition.
@@ -1382,6 +1605,9 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   // partition drops and trim point updates.
   // Dropping the latest partition is not allowed.
   //
+  // If partition_drop_batch_size_ is nonzero, partitions are dropped that
+  // many at a time, and get_oldest_to_keep() is called once per batch.
+  //
   // @return 0 on success, -1 on error. Sets err to:
   //   E::INTERNAL if an assertion failed.
   //   E::LOCAL_LOG_STORE_WRITE if some RocksDB operation failed.
@@ -1391,6 +1617,13 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   int dropPartitions(partition_id_t oldest_to_keep_est,
                      std::function<partition_id_t()> get_oldest_to_keep);
 
+  // Does one step of dropPartitions(): drops partitions with id less than
+  // min(oldest_to_keep_est, get_oldest_to_keep()) under a single
+  // oldest_partition_mutex_ critical section. Same return value as
+  // dropPartitions().
+  int dropPartitionsBatch(partition_id_t oldest_to_keep_est,
+                          std::function<partition_id_t()> get_oldest_to_keep);
+
   // Performs compaction in a way optimized for situation when most of the logs
   // in the partition are fully trimmed. This is usually the case for retention
   // compactions.
@@ -1415,6 +1648,35 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   // Applies RocksDBSettings::metadata_compaction_period.
   void compactMetadataCFIfNeeded();
 
+  // Uploads the partition to remote storage unless the remote copy is up to
+  // date, then deletes its SST files and marks it offloaded.
+  // Returns true if the partition was offloaded.
+  bool offloadPartition(PartitionPtr partition);
+
+  // Downloads an offloaded partition and ingests it back into its column
+  // family. On failure sets err to E::FAILED.
+  int restorePartition(PartitionPtr partition) const;
+
+  // Called by readers before using cf_ of a partition. Restores the partition
+  // if it's offloaded. Returns 0 if the partition's data is local. Otherwise
+  // returns -1 with err set to:
+  //  - E::WOULDBLOCK if the partition is offloaded and !allow_blocking_io,
+  //  - E::FAILED if restoring failed.
+  int ensurePartitionLocal(const PartitionPtr& partition,
+                           bool allow_blocking_io) const;
+
+  // Names of the SST files of the column family, sorted.
+  std::vector<std::string> getColumnFamilyFiles(
+      rocksdb::ColumnFamilyHandle* cf) const;
+
+  // Whether the column family has no unflushed writes.
+  bool memtablesEmpty(rocksdb::ColumnFamilyHandle* cf) const;
+
+  // Name of the object holding a copy of the partition in remote storage,
+  // and of the local file used to upload or download it.
+  std::string remoteStorageKey(partition_id_t partition) const;
+  std::string offloadStagingPath(partition_id_t partition) const;
+
   typedef std::function<void(logid_t log_id,
                              partition_id_t partition_id,
                              bool& remove_entry,
@@ -1447,9 +1709,19 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   // list.
   std::mutex oldest_partition_mutex_;
 
-  // Locked when creating partitions at the end of partition list.
+  // Locked when creating partitions at the end of partition list, and when
+  // creating or dropping spare CFs.
   std::mutex latest_partition_mutex_;
 
+  // Empty column families created in advance for the partitions that will
+  // come after the latest one (see rocksdb-partition-precreate-count).
+  // The i-th element has ID latest_->id_ + 1 + i. They don't have any
+  // metadata and aren't in partitions_; createPartition() takes them from the
+  // front. Protected by latest_partition_mutex_.
+  std::deque<std::unique_ptr<rocksdb::ColumnFamilyHandle>> spare_cfs_;
+  // spare_cfs_.size(), readable without locking.
+  std::atomic<size_t> num_spare_cfs_{0};
+
   // Pointer to the latest partition.
   struct LatestPtrTag {};
   UpdateableSharedPtr<Partition, LatestPtrTag> latest_;
@@ -1463,6 +1735,10 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   // Modified with locked oldest_partition_mutex_.
   std::atomic<partition_id_t> oldest_partition_id_{1};
 
+  // While dropPartitions() is in progress, the partition ID it's dropping up
+  // to. PARTITION_INVALID otherwise.
+  std::atomic<partition_id_t> drop_target_{PARTITION_INVALID};
+
   // Limit to drop partitions up to for space-based trimming
   std::atomic<partition_id_t> space_based_trim_limit{PARTITION_INVALID};
 
@@ -1512,6 +1788,11 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
 
   std::unique_ptr<MemtableFlushCallback> flushCallback_;
 
+  // In-memory copy of the records in the latest partition, used by read
+  // iterators if the hot_partition_cache setting is on. nullptr in read-only
+  // mode.
+  std::unique_ptr<HotPartitionCache> hot_partition_cache_;
+
   // If true, stall low-pri writes to wait for partial compactions to catch up.
   std::atomic<bool> too_many_partial_compactions_{false};
 
@@ -1523,6 +1804,26 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   AtomicSteadyTimestamp last_directory_consistency_check_time_{
       SteadyTimestamp::min()};
 
+  // Total number of entries in LogState::find_time_index across all logs.
+  // Bounded by RocksDBSettings::find_time_partition_index_max_entries.
+  std::atomic<size_t> find_time_index_entries_{0};
+
+  // Where cold partitions are offloaded to. nullptr if there's no
+  // REMOTE_STORAGE plugin.
+  UpdateableSharedPtr<RemoteStorage> remote_storage_;
+
+  // Rebuilding writes waiting to be ingested into their partitions, see
+  // --rocksdb-rebuilding-sst-ingestion. Lock order: Partition::mutex_, then
+  // rebuilding_sst_mutex_.
+  struct RebuildingSstBufferEntry {
+    PartitionPtr partition;
+    std::unique_ptr<RebuildingSstBuffer> buffer;
+  };
+  std::mutex rebuilding_sst_mutex_;
+  std::map<partition_id_t, RebuildingSstBufferEntry> rebuilding_sst_buffers_;
+  // Smallest flushToken() of the buffers, FlushToken_MAX if there are none.
+  std::atomic<FlushToken> rebuilding_sst_min_flush_token_{FlushToken_MAX};
+
  protected:
   enum class DeferInit {
     NO,
@@ -1597,6 +1898,10 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   // latest partition is either too old or has too many L0 files.
   virtual bool shouldCreatePartition();
 
+  // Creates or drops spare CFs until there are partition_precreate_count_ of
+  // them. Called from the hi-pri background thread.
+  void precreateSparePartitions();
+
   // Called on each iteration of each background thread. Sleeps between
   // iterations until some timeout expires or until shutdown is requested.
   // Can be mocked to control background thread from outside.
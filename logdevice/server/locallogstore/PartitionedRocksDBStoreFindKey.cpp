@@ -149,12 +149,22 @@ int PartitionedRocksDBStore::FindKey::findPartitionLo(
 }
 
 int PartitionedRocksDBStore::FindKey::findPreciseBound(PartitionPtr partition) {
+  if (store_.ensurePartitionLocal(partition, allow_blocking_io_) != 0) {
+    return -1;
+  }
+
   folly::small_vector<char, 26> key =
       RocksDBKeyFormat::IndexKey::create(logid_, FIND_KEY_INDEX, key_, 0);
 
   auto options = RocksDBLogStoreBase::getReadOptionsSinglePrefix();
   options.read_tier =
       (allow_blocking_io_ ? rocksdb::kReadAllTier : rocksdb::kBlockCacheTier);
+  auto upper_bound_key =
+      RocksDBKeyFormat::IndexKey::upperBound(logid_, FIND_KEY_INDEX);
+  rocksdb::Slice upper_bound(upper_bound_key.data(), upper_bound_key.size());
+  if (!store_.getSettings()->disable_iterate_upper_bound) {
+    options.iterate_upper_bound = &upper_bound;
+  }
 
   RocksDBIterator it = store_.newIterator(options, partition->cf_.get());
   auto it_error = [&] {
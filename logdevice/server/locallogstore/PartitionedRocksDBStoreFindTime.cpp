@@ -7,6 +7,8 @@
  */
 #include "PartitionedRocksDBStoreFindTime.h"
 
+#include <algorithm>
+
 #include "PartitionedRocksDBStoreIterators.h"
 #include "RocksDBKeyFormat.h"
 #include "RocksDBLocalLogStore.h"
@@ -96,7 +98,9 @@ int PartitionedRocksDBStore::FindTime::execute(lsn_t* lo, lsn_t* hi) {
     // timestamp `timestamp_` by doing a binary search on the partition
     // directory.
 
-    int rv = findPartition(&p, &p_first_lsn);
+    int rv = findPartitionInMemory(&p, &p_first_lsn)
+        ? 0
+        : findPartition(&p, &p_first_lsn);
     // Note that `p` is nullptr on success if searching within
     // a partition cannot improve upon the lo_ and high_ as updated
     // by findPartition().
@@ -134,6 +138,10 @@ int PartitionedRocksDBStore::FindTime::execute(lsn_t* lo, lsn_t* hi) {
       return 0;
     }
     if (p) {
+      if (store_.ensurePartitionLocal(p, allow_blocking_io_) != 0) {
+        ld_check(err == E::FAILED || !allow_blocking_io_);
+        return -1;
+      }
       cf = p->cf_.get();
     }
   }
@@ -428,6 +436,110 @@ int PartitionedRocksDBStore::FindTime::findPartition(
   return 0;
 }
 
+bool PartitionedRocksDBStore::FindTime::findPartitionInMemory(
+    PartitionPtr* out_partition,
+    lsn_t* out_first_lsn) const {
+  auto settings = store_.getSettings();
+  if (!settings->find_time_partition_index) {
+    return false;
+  }
+
+  *out_partition = nullptr;
+  *out_first_lsn = LSN_INVALID;
+
+  PartitionedRocksDBStore& store = const_cast<PartitionedRocksDBStore&>(store_);
+  auto logs_it = store.logs_.find(logid_.val_);
+  if (logs_it == store.logs_.cend()) {
+    // Log is empty.
+    STAT_INCR(store.stats_, logsdb_find_time_dir_seeks_avoided);
+    return true;
+  }
+  LogState* log_state = logs_it->second.get();
+  std::lock_guard<std::mutex> lock(log_state->mutex);
+  const auto& directory = log_state->directory;
+  auto& index = log_state->find_time_index;
+
+  if (index.empty() && !directory.empty()) {
+    size_t prev = store.find_time_index_entries_.fetch_add(directory.size());
+    if (prev + directory.size() >
+        settings->find_time_partition_index_max_entries) {
+      store.find_time_index_entries_.fetch_sub(directory.size());
+      STAT_INCR(store.stats_, logsdb_find_time_index_over_budget);
+      return false;
+    }
+    index.reserve(directory.size());
+    for (const auto& kv : directory) {
+      index.emplace_back(kv.first, kv.second.id);
+    }
+  }
+  STAT_INCR(store.stats_, logsdb_find_time_dir_seeks_avoided);
+  if (index.empty()) {
+    // Log is empty.
+    return true;
+  }
+
+  // This does the same thing as findPartition(), see the comments there.
+  // Directory entries are sorted by both first_lsn and partition ID, and
+  // partitions are sorted by starting_timestamp, so we can use binary searches
+  // instead of seeks. Relevant partitions form a contiguous range
+  // [relevant_begin, relevant_end) of the index.
+  auto partitions = store_.getPartitionList();
+  auto relevant_begin = std::lower_bound(
+      index.begin(),
+      index.end(),
+      partitions->firstID(),
+      [](const std::pair<lsn_t, partition_id_t>& e, partition_id_t id) {
+        return e.second < id;
+      });
+  auto relevant_end = std::lower_bound(
+      relevant_begin,
+      index.end(),
+      partitions->nextID(),
+      [](const std::pair<lsn_t, partition_id_t>& e, partition_id_t id) {
+        return e.second < id;
+      });
+
+  // First relevant entry with starting_timestamp >= timestamp_.
+  auto right = std::partition_point(
+      relevant_begin,
+      relevant_end,
+      [&](const std::pair<lsn_t, partition_id_t>& e) {
+        PartitionPtr partition = partitions->get(e.second);
+        ld_check(partition);
+        return partition->starting_timestamp < timestamp_;
+      });
+  if (right != relevant_end) {
+    *hi_ = std::min(*hi_, right->first);
+  }
+  if (right == relevant_begin) {
+    // No relevant partitions with starting_timestamp < timestamp_.
+    return true;
+  }
+
+  // Entry of partition X (see findPartition()).
+  auto left = right - 1;
+  PartitionPtr left_partition = partitions->get(left->second);
+  ld_check(left_partition);
+  ld_check(left_partition->starting_timestamp < timestamp_);
+  PartitionPtr next_partition = partitions->get(left_partition->id_ + 1);
+  if (!next_partition || next_partition->starting_timestamp >= timestamp_) {
+    // 2b - left_partition is B.
+    *out_partition = left_partition;
+    *out_first_lsn = left->first;
+    if (left == index.begin()) {
+      return true;
+    }
+    --left;
+  }
+
+  // `left` is A now. Get max_lsn from the directory.
+  auto dir_it = directory.find(left->first);
+  ld_check(dir_it != directory.end());
+  *lo_ = std::max(*lo_, dir_it->second.max_lsn);
+
+  return true;
+}
+
 int PartitionedRocksDBStore::FindTime::partitionSearch(
     rocksdb::ColumnFamilyHandle* cf) const {
   IteratorSearch search(&store_,
@@ -65,6 +65,17 @@ class PartitionedRocksDBStore::FindTime {
    */
   int findPartition(PartitionPtr* out_partition, lsn_t* out_first_lsn) const;
 
+  /**
+   * Same as findPartition(), but uses LogState::find_time_index and the
+   * in-memory directory instead of seeking in the on-disk directory.
+   *
+   * @return true if the lookup was done, false if the index couldn't be used
+   *         (it's disabled or over its memory budget) and the caller should
+   *         fall back to findPartition().
+   */
+  bool findPartitionInMemory(PartitionPtr* out_partition,
+                             lsn_t* out_first_lsn) const;
+
   /**
    * Do a binary search or, if the findTime index is used, a seek on the given
    * column family, and update *lo_ and *hi_ with the result. Only one of *lo_
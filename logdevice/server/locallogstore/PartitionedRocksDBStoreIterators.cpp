@@ -29,6 +29,10 @@ void PartitionedRocksDBStore::Iterator::setDataIteratorFromCurrent(
 
   RecordTimestamp min_ts, max_ts;
   if (!filter || checkFilterTimeRange(*filter, &min_ts, &max_ts)) {
+    // If the partition is offloaded and can't be restored, moveUntilValid()
+    // will see that and report an error instead of an empty partition.
+    pstore_->ensurePartitionLocal(
+        current_.partition_, options_.allow_blocking_io);
     if (data_iterator_ == nullptr) {
       data_iterator_ = std::make_unique<RocksDBLocalLogStore::CSIWrapper>(
           pstore_, log_id_, options_, current_.partition_->cf_.get());
@@ -425,6 +429,12 @@ void PartitionedRocksDBStore::Iterator::moveUntilValid(bool forward,
         ld_check_in(s, ({IteratorState::ERROR, IteratorState::WOULDBLOCK}));
         state_ = s;
         return;
+      } else if (current_.partition_->offloaded.load()) {
+        // The partition is offloaded, so AT_END doesn't mean that there are
+        // no more records in it.
+        state_ = options_.allow_blocking_io ? IteratorState::ERROR
+                                            : IteratorState::WOULDBLOCK;
+        return;
       }
     }
 
@@ -570,6 +580,7 @@ void PartitionedRocksDBStore::Iterator::moveUntilValid(bool forward,
 void PartitionedRocksDBStore::Iterator::seek(lsn_t lsn,
                                              ReadFilter* filter,
                                              ReadStats* stats) {
+  AccountIO account_io(this);
   trackSeek(lsn, 0);
 
   // Reset sticky state on seeks.
@@ -627,6 +638,7 @@ void PartitionedRocksDBStore::Iterator::seek(lsn_t lsn,
 }
 
 void PartitionedRocksDBStore::Iterator::seekForPrev(lsn_t lsn) {
+  AccountIO account_io(this);
   trackSeek(lsn, 0);
 
   // Reset sticky state on seeks.
@@ -684,6 +696,7 @@ void PartitionedRocksDBStore::Iterator::seekForPrev(lsn_t lsn) {
 void PartitionedRocksDBStore::Iterator::next(ReadFilter* filter,
                                              ReadStats* stats) {
   ld_check_eq(state(), IteratorState::AT_RECORD);
+  AccountIO account_io(this);
 
   PartitionInfo start = current_;
   lsn_t current_lsn = data_iterator_->getLSN();
@@ -699,6 +712,7 @@ void PartitionedRocksDBStore::Iterator::next(ReadFilter* filter,
 
 void PartitionedRocksDBStore::Iterator::prev() {
   ld_assert(state() == IteratorState::AT_RECORD);
+  AccountIO account_io(this);
 
   PartitionInfo start = current_;
   lsn_t current_lsn = data_iterator_->getLSN();
@@ -820,6 +834,10 @@ PartitionedRocksDBStore::PartitionedAllLogsIterator::state() const {
   if (!data_iterator_) {
     return IteratorState::AT_END;
   }
+  if (partition_offloaded_) {
+    return options_.allow_blocking_io ? IteratorState::ERROR
+                                      : IteratorState::WOULDBLOCK;
+  }
   IteratorState s = data_iterator_->state();
   ld_check(s != IteratorState::AT_END);
   return s;
@@ -854,6 +872,7 @@ void PartitionedRocksDBStore::PartitionedAllLogsIterator::seek(
   PartitionedLocation location =
       checked_downcast<const PartitionedLocation&>(base_location);
 
+  AccountIO account_io(this);
   trackSeek(lsn_t(0), /* version */ 0);
   setPartition(location.partition, filter, stats);
   if (!data_iterator_) {
@@ -871,6 +890,7 @@ void PartitionedRocksDBStore::PartitionedAllLogsIterator::next(
     ReadFilter* filter,
     ReadStats* stats) {
   ld_assert_eq(state(), IteratorState::AT_RECORD);
+  AccountIO account_io(this);
   data_iterator_->next(filter, stats);
   moveUntilValid(filter, stats);
 }
@@ -886,10 +906,72 @@ PartitionedRocksDBStore::PartitionedAllLogsIterator::metadataLogsBegin() const {
       PARTITION_INVALID, MetaDataLog::metaDataLogID(logid_t(0)), lsn_t(0));
 }
 
+std::vector<std::unique_ptr<Location>>
+PartitionedRocksDBStore::PartitionedAllLogsIterator::splitIntoRanges(
+    size_t max_ranges) const {
+  std::vector<std::unique_ptr<Location>> res;
+  res.push_back(minLocation());
+
+  auto partitions = pstore_->getPartitionList();
+  const partition_id_t first = partitions->firstID();
+  if (max_ranges <= 1 || last_partition_id_ <= first) {
+    return res;
+  }
+
+  std::vector<uint64_t> sizes;
+  uint64_t total_size = 0;
+  for (partition_id_t id = first; id <= last_partition_id_; ++id) {
+    // The list may have holes, which are null.
+    auto partition = partitions->get(id);
+    sizes.push_back(
+        partition ? pstore_->getApproximatePartitionSize(partition->cf_.get())
+                  : 0);
+    total_size += sizes.back();
+  }
+  const size_t n = std::min(max_ranges, sizes.size());
+
+  if (total_size == 0) {
+    // E.g. everything is still in memtables. Split by partition count.
+    for (size_t i = 1; i < n; ++i) {
+      res.push_back(std::make_unique<PartitionedLocation>(
+          first + sizes.size() * i / n, logid_t(0), lsn_t(0)));
+    }
+    return res;
+  }
+
+  // Start a new range at the first partition past each multiple of
+  // total_size / n.
+  uint64_t size_so_far = 0;
+  size_t ranges = 1;
+  for (size_t i = 0; i + 1 < sizes.size() && ranges < n; ++i) {
+    size_so_far += sizes[i];
+    if (size_so_far * n >= total_size * ranges) {
+      res.push_back(std::make_unique<PartitionedLocation>(
+          first + i + 1, logid_t(0), lsn_t(0)));
+      ++ranges;
+    }
+  }
+  return res;
+}
+
+bool PartitionedRocksDBStore::PartitionedAllLogsIterator::reachedLocation(
+    const Location& base_location) const {
+  ld_check_in(
+      state(), ({IteratorState::AT_RECORD, IteratorState::LIMIT_REACHED}));
+  const PartitionedLocation& location =
+      checked_downcast<const PartitionedLocation&>(base_location);
+  const partition_id_t partition =
+      current_partition_ ? current_partition_->id_ : PARTITION_INVALID;
+  return std::make_tuple(
+             partition, data_iterator_->getLogID(), data_iterator_->getLSN()) >=
+      std::make_tuple(location.partition, location.log, location.lsn);
+}
+
 void PartitionedRocksDBStore::PartitionedAllLogsIterator::invalidate() {
   trackIteratorRelease();
   current_partition_ = nullptr;
   data_iterator_ = nullptr;
+  partition_offloaded_ = false;
 }
 
 void PartitionedRocksDBStore::PartitionedAllLogsIterator::setPartition(
@@ -901,6 +983,7 @@ void PartitionedRocksDBStore::PartitionedAllLogsIterator::setPartition(
   };
 
   data_iterator_ = nullptr;
+  partition_offloaded_ = false;
   auto partitions = pstore_->getPartitionList();
   RecordTimestamp min_ts;
   RecordTimestamp max_ts;
@@ -932,6 +1015,11 @@ void PartitionedRocksDBStore::PartitionedAllLogsIterator::setPartition(
     }
   }
 
+  if (current_partition_) {
+    // Checked in moveUntilValid() if restoring fails.
+    pstore_->ensurePartitionLocal(
+        current_partition_, options_.allow_blocking_io);
+  }
   data_iterator_ = std::make_unique<RocksDBLocalLogStore::CSIWrapper>(
       pstore_,
       /* log_id */ folly::none,
@@ -950,6 +1038,11 @@ void PartitionedRocksDBStore::PartitionedAllLogsIterator::moveUntilValid(
     ReadFilter* filter,
     ReadStats* stats) {
   while (data_iterator_ && data_iterator_->state() == IteratorState::AT_END) {
+    if (current_partition_ && current_partition_->offloaded.load()) {
+      // AT_END doesn't mean that the partition has no more records.
+      partition_offloaded_ = true;
+      return;
+    }
     setPartition(
         current_partition_ ? current_partition_->id_ + 1 : 1, filter, stats);
     if (data_iterator_) {
@@ -68,6 +68,9 @@ class PartitionedRocksDBStore::Iterator : public LocalLogStore::ReadIterator {
   size_t getIOBytesUnnormalized() const override {
     return RocksDBLogStoreBase::getIOBytesUnnormalized();
   }
+  size_t getIOBlocksUnnormalized() const override {
+    return RocksDBLogStoreBase::getIOBlocksUnnormalized();
+  }
 
  private:
   enum class Operation { SEEK, SEEK_FOR_PREV, NEXT, PREV };
@@ -294,6 +297,12 @@ class PartitionedRocksDBStore::PartitionedAllLogsIterator
   std::unique_ptr<Location> minLocation() const override;
   std::unique_ptr<Location> metadataLogsBegin() const override;
 
+  // Splits at partition boundaries, by approximate partition size. The first
+  // range also covers the unpartitioned column family.
+  std::vector<std::unique_ptr<Location>>
+  splitIntoRanges(size_t max_ranges) const override;
+  bool reachedLocation(const Location& location) const override;
+
   void invalidate() override;
 
   const LocalLogStore* getStore() const override;
@@ -302,6 +311,9 @@ class PartitionedRocksDBStore::PartitionedAllLogsIterator
   size_t getIOBytesUnnormalized() const override {
     return RocksDBLogStoreBase::getIOBytesUnnormalized();
   }
+  size_t getIOBlocksUnnormalized() const override {
+    return RocksDBLogStoreBase::getIOBlocksUnnormalized();
+  }
 
  private:
   // Goes to the first existing partition between `partition` and
@@ -327,6 +339,9 @@ class PartitionedRocksDBStore::PartitionedAllLogsIterator
   PartitionPtr current_partition_;
   // nullptr if we're AT_END.
   std::unique_ptr<RocksDBLocalLogStore::CSIWrapper> data_iterator_;
+  // True if data_iterator_ reached the end of a partition that is offloaded
+  // and couldn't be restored. state() reports ERROR or WOULDBLOCK then.
+  bool partition_offloaded_ = false;
 };
 
 // Behaves as two nested iterators.
@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/locallogstore/RebuildingSstBuffer.h"
+
+#include <vector>
+
+#include <rocksdb/env.h>
+#include <rocksdb/sst_file_writer.h>
+
+#include "logdevice/common/debug.h"
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+// Collects the operations of a WriteBatch on one column family.
+class EntryCollector : public rocksdb::WriteBatch::Handler {
+ public:
+  struct Op {
+    std::string key;
+    bool merge;
+    std::string value;
+  };
+
+  explicit EntryCollector(uint32_t cf_id) : cf_id_(cf_id) {}
+
+  rocksdb::Status PutCF(uint32_t cf_id,
+                        const rocksdb::Slice& key,
+                        const rocksdb::Slice& value) override {
+    if (cf_id == cf_id_) {
+      ops.push_back({key.ToString(), false, value.ToString()});
+    }
+    return rocksdb::Status::OK();
+  }
+
+  rocksdb::Status MergeCF(uint32_t cf_id,
+                          const rocksdb::Slice& key,
+                          const rocksdb::Slice& value) override {
+    if (cf_id == cf_id_) {
+      ops.push_back({key.ToString(), true, value.ToString()});
+    }
+    return rocksdb::Status::OK();
+  }
+
+  rocksdb::Status DeleteCF(uint32_t cf_id,
+                           const rocksdb::Slice& /* key */) override {
+    // Buffered writes are record puts, which don't delete anything.
+    if (cf_id == cf_id_) {
+      return rocksdb::Status::NotSupported("delete in rebuilding SST buffer");
+    }
+    return rocksdb::Status::OK();
+  }
+
+  std::vector<Op> ops;
+
+ private:
+  uint32_t cf_id_;
+};
+
+} // namespace
+
+bool RebuildingSstBuffer::add(const rocksdb::WriteBatch& batch,
+                              uint32_t cf_id,
+                              const std::set<logid_t>& logs) {
+  EntryCollector collector(cf_id);
+  rocksdb::Status status = batch.Iterate(&collector);
+  if (!status.ok()) {
+    ld_check(false);
+    return false;
+  }
+
+  std::set<std::string> keys;
+  for (const auto& op : collector.ops) {
+    if (entries_.count(op.key) || !keys.insert(op.key).second) {
+      return false;
+    }
+  }
+
+  for (auto& op : collector.ops) {
+    bytes_ += op.key.size() + op.value.size();
+    entries_.emplace(std::move(op.key), Entry{op.merge, std::move(op.value)});
+  }
+  logs_.insert(logs.begin(), logs.end());
+  return true;
+}
+
+rocksdb::Status
+RebuildingSstBuffer::writeFile(const std::string& path,
+                               const rocksdb::Options& options) const {
+  ld_check(!entries_.empty());
+  rocksdb::SstFileWriter sst_writer(rocksdb::EnvOptions(), options);
+  rocksdb::Status status = sst_writer.Open(path);
+  // std::map iterates in bytewise order, which is the order of keys in
+  // logsdb column families.
+  for (auto it = entries_.begin(); status.ok() && it != entries_.end(); ++it) {
+    status = it->second.merge ? sst_writer.Merge(it->first, it->second.value)
+                              : sst_writer.Put(it->first, it->second.value);
+  }
+  if (status.ok()) {
+    status = sst_writer.Finish();
+  }
+  return status;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+
+#include <rocksdb/options.h>
+#include <rocksdb/status.h>
+#include <rocksdb/write_batch.h>
+
+#include "logdevice/common/Timestamp.h"
+#include "logdevice/common/types_internal.h"
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file  Rebuilding writes destined for one partition of a
+ *        PartitionedRocksDBStore, accumulated in memory so that they can be
+ *        written as one sorted SST file and ingested into the partition's
+ *        column family with IngestExternalFile(), bypassing the memtable and
+ *        the WAL (see --rocksdb-rebuilding-sst-ingestion).
+ *
+ *        An SST file can hold at most one entry per key, so a write touching
+ *        a key that is already buffered is refused; the caller ingests the
+ *        buffer first. Ingested files are applied on top of everything
+ *        already in the column family, so the caller also has to ingest the
+ *        buffer before writing anything else to the same records.
+ *
+ *        Not thread safe.
+ */
+
+class RebuildingSstBuffer {
+ public:
+  /**
+   * @param flush_token  maxFlushToken() of the store before the first write
+   *                     was buffered. Until the buffer is ingested, the store
+   *                     must not report anything at or above it as flushed.
+   */
+  RebuildingSstBuffer(FlushToken flush_token, SteadyTimestamp created_at)
+      : flush_token_(flush_token), created_at_(created_at) {}
+
+  /**
+   * Adds the operations of `batch` on column family `cf_id` to the buffer.
+   * Operations on other column families are ignored.
+   *
+   * @param logs  logs the operations belong to
+   * @return  true on success. false if some of the operations touch a key
+   *          that is already in the buffer or appears twice in `batch`; in
+   *          this case nothing is added.
+   */
+  bool add(const rocksdb::WriteBatch& batch,
+           uint32_t cf_id,
+           const std::set<logid_t>& logs);
+
+  /**
+   * Writes the buffered entries to a new SST file at `path`.
+   */
+  rocksdb::Status writeFile(const std::string& path,
+                            const rocksdb::Options& options) const;
+
+  bool containsLog(logid_t log) const {
+    return logs_.count(log) != 0;
+  }
+
+  bool empty() const {
+    return entries_.empty();
+  }
+
+  size_t bytes() const {
+    return bytes_;
+  }
+
+  FlushToken flushToken() const {
+    return flush_token_;
+  }
+
+  SteadyTimestamp createdAt() const {
+    return created_at_;
+  }
+
+ private:
+  struct Entry {
+    bool merge;
+    std::string value;
+  };
+
+  FlushToken flush_token_;
+  SteadyTimestamp created_at_;
+  std::map<std::string, Entry> entries_;
+  std::set<logid_t> logs_;
+  size_t bytes_ = 0;
+};
+
+}} // namespace facebook::logdevice
@@ -7,6 +7,8 @@
  */
 #include "RocksDBCompactionFilter.h"
 
+#include <algorithm>
+
 #include <rocksdb/slice.h>
 
 #include "logdevice/common/LocalLogStoreRecordFormat.h"
@@ -97,8 +99,7 @@ RocksDBCompactionFilter::filterImpl(const rocksdb::Slice& key,
                    hexdump_buf(key.data(), key.size(), 200).c_str())) {
       return Decision::kKeep;
     }
-    log_id = DataKey::getLogID(key.data());
-    lsn = DataKey::getLSN(key.data());
+    std::tie(log_id, lsn) = DataKey::getLogIDAndLSN(key.data());
   }
 
   getTrimInfo(log_id);
@@ -359,17 +360,52 @@ void RocksDBCompactionFilter::getTrimInfo(logid_t log_id) {
     return;
   }
 
+  // Most of the time the log is either the next one in `trim_infos_' or
+  // a new one past its end.
+  if (trim_infos_pos_ + 1 < trim_infos_.size() &&
+      trim_infos_[trim_infos_pos_ + 1].log_id == log_id) {
+    ++trim_infos_pos_;
+    cache = trim_infos_[trim_infos_pos_];
+    return;
+  }
+  auto it = trim_infos_.end();
+  if (!trim_infos_.empty() && log_id < trim_infos_.back().log_id) {
+    it = std::lower_bound(
+        trim_infos_.begin(),
+        trim_infos_.end(),
+        log_id,
+        [](const TrimInfoCache& info, logid_t id) { return info.log_id < id; });
+    if (it != trim_infos_.end() && it->log_id == log_id) {
+      trim_infos_pos_ = it - trim_infos_.begin();
+      cache = *it;
+      return;
+    }
+  }
+
+  // Store the result in the cache.  Note that we also cache a negative
+  // response (trim point not found).  If the trim point is updated while we
+  // are still compacting records for the same log, the change will not be
+  // reflected until the next compaction run.
+  if (lookUpTrimInfo(log_id, &cache)) {
+    it = trim_infos_.insert(it, cache);
+    trim_infos_pos_ = it - trim_infos_.begin();
+  }
+}
+
+bool RocksDBCompactionFilter::lookUpTrimInfo(logid_t log_id,
+                                             TrimInfoCache* out) {
   // initially empty
   folly::Optional<lsn_t> trim_point;
   folly::Optional<std::chrono::milliseconds> cutoff_timestamp;
   folly::Optional<epoch_t> per_epoch_log_metadata_trim_point;
 
-  // Cache miss, query LogStorageStateMap (lives in the storage node's
-  // Processor)
+  // Query LogStorageStateMap (lives in the storage node's Processor)
 
   ServerProcessor* processor = &storage_thread_pool_->getProcessor();
 
-  std::shared_ptr<Configuration> current_config = processor->config_->get();
+  if (!config_) {
+    config_ = processor->config_->get();
+  }
 
   ld_spew("querying Processor for trim point/cutoff_timestamp of log %lu",
           log_id.val_);
@@ -386,16 +422,23 @@ void RocksDBCompactionFilter::getTrimInfo(logid_t log_id) {
     noteLogSkipped(log_id);
   }
 
-  if (!current_config->logsConfig()->isFullyLoaded()) {
+  out->log_id = log_id;
+  out->trim_point = trim_point;
+  out->cutoff_timestamp = folly::none;
+  out->per_epoch_log_metadata_trim_point = per_epoch_log_metadata_trim_point;
+
+  if (!config_->logsConfig()->isFullyLoaded()) {
     // LogsConfig is not fully loaded, avoid changing the trim point until we
-    // have a full config.
-    return;
+    // have a full config. Look the log up again on the next pass in case the
+    // config is loaded by then.
+    config_.reset();
+    return false;
   }
 
   // TODO: right now, for non-partitioned stores, if a log is removed,
   //       its data will never be deleted.
   const std::shared_ptr<LogsConfig::LogGroupNode> log =
-      current_config->getLogGroupByIDShared(log_id);
+      config_->getLogGroupByIDShared(log_id);
   folly::Optional<std::chrono::seconds> backlog =
       log ? log->attrs().backlogDuration().value() : folly::none;
   // Don't trim metadata logs based on time.
@@ -403,18 +446,10 @@ void RocksDBCompactionFilter::getTrimInfo(logid_t log_id) {
     // compute the cutoff timestamp based on the current local time
     std::chrono::milliseconds now = currentTime();
 
-    cutoff_timestamp = now -
+    out->cutoff_timestamp = now -
         std::chrono::duration_cast<std::chrono::milliseconds>(backlog.value());
   }
-
-  // Store the result in the cache.  Note that we also cache a negative
-  // response (trim point not found).  If the trim point is updated while we
-  // are still compacting records for the same log, the change will not be
-  // reflected until the next compaction run.
-  cache.log_id = log_id;
-  cache.trim_point = trim_point;
-  cache.cutoff_timestamp = cutoff_timestamp;
-  cache.per_epoch_log_metadata_trim_point = per_epoch_log_metadata_trim_point;
+  return true;
 }
 
 void RocksDBCompactionFilter::noteLogSkipped(logid_t log_id) {
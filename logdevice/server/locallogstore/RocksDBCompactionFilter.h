@@ -27,6 +27,8 @@
 
 namespace facebook { namespace logdevice {
 
+class Configuration;
+
 /**
  * @file
  * Filter that RocksDB calls while compacting our records.  Looks for records
@@ -157,10 +159,10 @@ class RocksDBCompactionFilter : public rocksdb::CompactionFilter {
 
   UpdateableSettings<RocksDBSettings> settings_;
 
-  // Cache for trim point/cutoff timestamp queries (given a log, find its trim
-  // point and cutoff timestamp).  Because compaction processes keys in
-  // lexicographical order and our records are sorted by log ID, this cache is
-  // simple and very effective.
+  // Trim point/cutoff timestamp of a log (given a log, find its trim point
+  // and cutoff timestamp).  Because compaction processes keys in
+  // lexicographical order and our records are sorted by log ID, `cache' holds
+  // the log of the current run of keys, and most lookups are hits.
   struct TrimInfoCache {
     logid_t log_id = LOGID_INVALID;
     folly::Optional<lsn_t> trim_point;
@@ -174,11 +176,27 @@ class RocksDBCompactionFilter : public rocksdb::CompactionFilter {
     folly::Optional<epoch_t> per_epoch_log_metadata_trim_point;
   } cache;
 
+  // Trim info of all logs looked up so far in this compaction, sorted by log
+  // ID. Each kind of key (records, copyset index, findTime index, per-epoch
+  // log metadata) visits the logs in the same order, so without it every
+  // log would be looked up once per kind of key. Logs are appended in order
+  // on the first pass; later passes walk the vector with `trim_infos_pos_'.
+  std::vector<TrimInfoCache> trim_infos_;
+  size_t trim_infos_pos_ = 0;
+
+  // Config used for all lookups of this compaction, taken on the first one.
+  std::shared_ptr<Configuration> config_;
+
   virtual std::chrono::milliseconds currentTime();
 
   // Makes sure `cache' is filled with information about the given log.
   void getTrimInfo(logid_t log_id);
 
+  // Looks up the trim info of the given log in LogStorageStateMap and config.
+  // Returns false if it shouldn't be remembered for the rest of the
+  // compaction.
+  bool lookUpTrimInfo(logid_t log_id, TrimInfoCache* out);
+
   virtual Decision filterImpl(const rocksdb::Slice& key,
                               const rocksdb::Slice& value,
                               std::string* skip_until);
@@ -7,12 +7,17 @@
  */
 #include "RocksDBEnv.h"
 
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <folly/Optional.h>
 #include <folly/ThreadLocal.h>
 
 #include "logdevice/common/ThreadID.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/common/stats/Stats.h"
 #include "logdevice/common/util.h"
 #include "logdevice/server/locallogstore/LocalLogStore.h"
 
@@ -120,11 +125,46 @@ RocksDBEnv::NewRandomAccessFile(const std::string& f,
   if (!status.ok()) {
     return status;
   }
+  const size_t readahead_size = settings_->async_readahead_size;
+  int readahead_fd = -1;
+  if (readahead_size > 0) {
+    readahead_fd = open(f.c_str(), O_RDONLY | O_CLOEXEC);
+    if (readahead_fd < 0) {
+      RATELIMIT_WARNING(std::chrono::seconds(10),
+                        2,
+                        "Failed to open %s for readahead: %s. Continuing "
+                        "without readahead for this file.",
+                        f.c_str(),
+                        strerror(errno));
+    }
+  }
   ld_debug("Wrapping random access file %s", f.c_str());
-  r->reset(new RocksDBRandomAccessFile(f, std::move(file)));
+  r->reset(new RocksDBRandomAccessFile(f,
+                                       std::move(file),
+                                       getShardIdx(f),
+                                       stats_,
+                                       readahead_fd,
+                                       readahead_size));
   return rocksdb::Status::OK();
 }
 
+void RocksDBEnv::setShardPaths(std::vector<std::string> shard_paths,
+                               StatsHolder* stats) {
+  shard_paths_ = std::move(shard_paths);
+  stats_ = stats;
+}
+
+shard_index_t RocksDBEnv::getShardIdx(const std::string& fname) const {
+  for (size_t shard = 0; shard < shard_paths_.size(); ++shard) {
+    const std::string& path = shard_paths_[shard];
+    if (fname.size() > path.size() &&
+        fname.compare(0, path.size(), path) == 0 && fname[path.size()] == '/') {
+      return static_cast<shard_index_t>(shard);
+    }
+  }
+  return -1;
+}
+
 rocksdb::Status
 RocksDBEnv::NewWritableFile(const std::string& f,
                             std::unique_ptr<rocksdb::WritableFile>* r,
@@ -218,19 +258,72 @@ RocksDBRandomAccessFile::RocksDBReadTracer::~RocksDBReadTracer() {
 
 RocksDBRandomAccessFile::RocksDBRandomAccessFile(
     const std::string& f,
-    std::unique_ptr<rocksdb::RandomAccessFile> file)
+    std::unique_ptr<rocksdb::RandomAccessFile> file,
+    shard_index_t shard_idx,
+    StatsHolder* stats,
+    int readahead_fd,
+    size_t readahead_size)
     : RocksDBRandomAccessFileWrapper(file.get()),
       file(std::move(file)),
       file_name(f),
       file_offset(~0),
-      file_name_hash(f) {}
+      file_name_hash(f),
+      shard_idx_(shard_idx),
+      stats_(shard_idx == -1 ? nullptr : stats),
+      readahead_fd_(readahead_fd),
+      readahead_size_(readahead_size) {}
+
+RocksDBRandomAccessFile::~RocksDBRandomAccessFile() {
+  if (readahead_fd_ >= 0) {
+    close(readahead_fd_);
+  }
+}
 
 rocksdb::Status RocksDBRandomAccessFile::Read(uint64_t offset,
                                               size_t n,
                                               rocksdb::Slice* result,
                                               char* scratch) const {
   auto tracer = RocksDBReadTracer(this, offset, n);
-  return RocksDBRandomAccessFileWrapper::Read(offset, n, result, scratch);
+  maybeReadAhead(offset, n);
+  PER_SHARD_STAT_INCR(stats_, rocksdb_reads_in_flight, shard_idx_);
+  auto status =
+      RocksDBRandomAccessFileWrapper::Read(offset, n, result, scratch);
+  PER_SHARD_STAT_DECR(stats_, rocksdb_reads_in_flight, shard_idx_);
+  return status;
+}
+
+void RocksDBRandomAccessFile::maybeReadAhead(uint64_t offset, size_t n) const {
+  const uint64_t end = offset + n;
+  const bool sequential = last_read_end_.exchange(end) == offset;
+  if (readahead_fd_ < 0 || !sequential) {
+    return;
+  }
+
+  // Request more when less than half of the window is left, so that the disk
+  // doesn't go idle between the reader catching up and the next request.
+  uint64_t ahead = readahead_end_.load();
+  if (ahead >= end + readahead_size_ / 2) {
+    return;
+  }
+  const uint64_t from = std::max(ahead, end);
+  const uint64_t to = end + readahead_size_;
+  if (!readahead_end_.compare_exchange_strong(ahead, to)) {
+    // Another reader of this file got to it first.
+    return;
+  }
+
+  // Only initiates the reads into page cache, doesn't wait for them.
+  int rv = posix_fadvise(readahead_fd_, from, to - from, POSIX_FADV_WILLNEED);
+  if (rv != 0) {
+    RATELIMIT_WARNING(std::chrono::seconds(10),
+                      2,
+                      "posix_fadvise() failed for %s: %s",
+                      file_name.c_str(),
+                      strerror(rv));
+    return;
+  }
+  PER_SHARD_STAT_ADD(
+      stats_, rocksdb_async_readahead_bytes, shard_idx_, to - from);
 }
 
 rocksdb::Status RocksDBBackgroundSyncFile::Close() {
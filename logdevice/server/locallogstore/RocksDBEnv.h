@@ -7,15 +7,19 @@
  */
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <queue>
 #include <set>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include <rocksdb/db.h>
 #include <rocksdb/env.h>
 
+#include "logdevice/common/types_internal.h"
 #include "logdevice/server/locallogstore/LocalLogStore.h"
 #include "logdevice/server/locallogstore/RocksDBSettings.h"
 
@@ -29,6 +33,8 @@
 
 namespace facebook { namespace logdevice {
 
+class StatsHolder;
+
 /**
  * A thin wrapper around default rocksdb::Env. Lowers IO priority of low-pri
  * background threads. The current rocksdb's implementation of
@@ -70,6 +76,10 @@ class RocksDBEnv : public rocksdb::EnvWrapper {
 
   rocksdb::Status DeleteFile(const std::string& fname) override;
 
+  // Files under shard_paths[i] belong to shard i; their reads are reported in
+  // per-shard stats. Must be called before any DB using this Env is opened.
+  void setShardPaths(std::vector<std::string> shard_paths, StatsHolder* stats);
+
  private:
   struct Callback {
     typedef void (*function_t)(void*);
@@ -106,6 +116,13 @@ class RocksDBEnv : public rocksdb::EnvWrapper {
 
   UpdateableSettings<RocksDBSettings> settings_;
 
+  // See setShardPaths().
+  std::vector<std::string> shard_paths_;
+  StatsHolder* stats_ = nullptr;
+
+  // Index of the shard whose path `fname` is under, -1 if none.
+  shard_index_t getShardIdx(const std::string& fname) const;
+
   static void callback(void* arg);
   static void callback_unschedule(void* arg);
 
@@ -187,8 +204,18 @@ class RocksDBRandomAccessFile : public RocksDBRandomAccessFileWrapper {
     const std::chrono::steady_clock::time_point start_time_;
   };
 
+  // @param shard_idx       shard the file belongs to, for stats; -1 if
+  //                        unknown
+  // @param readahead_fd    another descriptor of the same file used for
+  //                        asynchronous readahead (owned), or -1 to disable it
+  // @param readahead_size  see --rocksdb-async-readahead-size
   RocksDBRandomAccessFile(const std::string& f,
-                          std::unique_ptr<rocksdb::RandomAccessFile> file);
+                          std::unique_ptr<rocksdb::RandomAccessFile> file,
+                          shard_index_t shard_idx = -1,
+                          StatsHolder* stats = nullptr,
+                          int readahead_fd = -1,
+                          size_t readahead_size = 0);
+  ~RocksDBRandomAccessFile() override;
 
   rocksdb::Status Read(uint64_t offset,
                        size_t n,
@@ -199,6 +226,20 @@ class RocksDBRandomAccessFile : public RocksDBRandomAccessFileWrapper {
   const std::string file_name;
   mutable uint64_t file_offset;
   FileNameHash file_name_hash;
+
+ private:
+  // If the read of [offset, offset + n) continues the previous one, makes
+  // sure that the next readahead_size_ bytes are being prefetched.
+  void maybeReadAhead(uint64_t offset, size_t n) const;
+
+  const shard_index_t shard_idx_;
+  StatsHolder* const stats_;
+  const int readahead_fd_;
+  const size_t readahead_size_;
+  // Where the last read ended, to detect sequential reads.
+  mutable std::atomic<uint64_t> last_read_end_{~0ul};
+  // Readahead was requested up to this offset.
+  mutable std::atomic<uint64_t> readahead_end_{0};
 };
 
 // A wrapper around rocksdb::WritableFile intended for WAL files.
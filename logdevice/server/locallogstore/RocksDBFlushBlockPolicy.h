@@ -7,16 +7,24 @@
  */
 #pragma once
 
+#include <memory>
+
 #include <rocksdb/flush_block_policy.h>
 
 #include "logdevice/common/LocalLogStoreRecordFormat.h"
 #include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/locallogstore/LogReadPatterns.h"
 #include "logdevice/server/locallogstore/RocksDBKeyFormat.h"
 
 namespace facebook { namespace logdevice {
 
 // RocksDB uses this class to decide when to start a new block when flushing
 // an SST file.
+//
+// If `read_patterns' is given, the size at which a block of records is cut
+// depends on how the log of its first record is being read: tail_block_size
+// for logs read mostly by tailing readers, scan_block_size for logs read
+// mostly by backlog scans (see LogReadPatterns). Zero means block_size.
 class RocksDBFlushBlockPolicy : public rocksdb::FlushBlockPolicy {
  public:
   struct Options {
@@ -24,9 +32,13 @@ class RocksDBFlushBlockPolicy : public rocksdb::FlushBlockPolicy {
     size_t min_block_size;
     bool flush_for_each_copyset;
     StatsHolder* stats;
+    size_t tail_block_size = 0;
+    size_t scan_block_size = 0;
+    std::shared_ptr<const LogReadPatterns> read_patterns;
   };
 
-  explicit RocksDBFlushBlockPolicy(const Options& opts) : opts_(opts) {}
+  explicit RocksDBFlushBlockPolicy(const Options& opts)
+      : opts_(opts), cur_block_size_(opts.block_size) {}
 
   bool Update(const rocksdb::Slice& key, const rocksdb::Slice& value) override {
     // RocksDB's default flush block policy uses BlockBuilder to get a better
@@ -36,10 +48,19 @@ class RocksDBFlushBlockPolicy : public rocksdb::FlushBlockPolicy {
     bool ret = false;
     Group g = getGroup(key, value);
 
-    if (cur_block_bytes_ >= opts_.block_size ||
+    if (cur_block_bytes_ == 0) {
+      // First record of the file.
+      cur_group_ = g;
+      cur_block_size_ = blockSizeFor(g.log);
+    }
+
+    if (cur_block_bytes_ >= cur_block_size_ ||
         (g != cur_group_ && cur_block_bytes_ >= opts_.min_block_size)) {
       STAT_INCR(opts_.stats, sst_blocks_written);
       STAT_ADD(opts_.stats, sst_blocks_bytes, cur_block_bytes_);
+      if (g.log != cur_group_.log) {
+        cur_block_size_ = blockSizeFor(g.log);
+      }
       cur_group_ = g;
       cur_block_bytes_ = 0;
       ret = true;
@@ -74,6 +95,26 @@ class RocksDBFlushBlockPolicy : public rocksdb::FlushBlockPolicy {
 
   size_t cur_block_bytes_ = 0;
   Group cur_group_;
+  // Size at which the current block is cut, picked for cur_group_.log.
+  size_t cur_block_size_;
+
+  size_t blockSizeFor(logid_t log) const {
+    if (!opts_.read_patterns || log == LOGID_INVALID) {
+      return opts_.block_size;
+    }
+    size_t size = 0;
+    switch (opts_.read_patterns->get(log)) {
+      case LogReadPatterns::Pattern::TAIL:
+        size = opts_.tail_block_size;
+        break;
+      case LogReadPatterns::Pattern::SCAN:
+        size = opts_.scan_block_size;
+        break;
+      case LogReadPatterns::Pattern::UNKNOWN:
+        break;
+    }
+    return size > 0 ? size : opts_.block_size;
+  }
 
   Group getGroup(const rocksdb::Slice& key, const rocksdb::Slice& value) {
     Group g;
@@ -96,11 +137,9 @@ class RocksDBFlushBlockPolicy : public rocksdb::FlushBlockPolicy {
 
 class RocksDBFlushBlockPolicyFactory : public rocksdb::FlushBlockPolicyFactory {
  public:
-  RocksDBFlushBlockPolicyFactory(size_t block_size,
-                                 size_t min_block_size,
-                                 bool flush_for_each_copyset,
-                                 StatsHolder* stats)
-      : opts_({block_size, min_block_size, flush_for_each_copyset, stats}) {}
+  explicit RocksDBFlushBlockPolicyFactory(
+      RocksDBFlushBlockPolicy::Options opts)
+      : opts_(std::move(opts)) {}
 
   const char* Name() const override {
     return "facebook::logdevice::RocksDBFlushBlockPolicyFactory";
@@ -8,6 +8,11 @@
 #pragma once
 
 #include <cstring>
+#include <utility>
+
+#if defined(__SSSE3__) && defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
 
 #include <folly/CppAttributes.h>
 #include <folly/small_vector.h>
@@ -33,6 +38,7 @@ namespace facebook { namespace logdevice { namespace RocksDBKeyFormat {
  *                    FROM USING THE SAME CHARACTER TWICE.
  */
 enum class KeyPrefix : char {
+  LogSnapshotBlobIndex = '[',
   LogSnapshotBlob = ']',
   // TODO: (T30250351) clean-up that deprecated metadata everywhere so we can
   // remove this from the enum.
@@ -44,11 +50,13 @@ enum class KeyPrefix : char {
   DataKey = 'd',
   LogMeta_LogRemovalTime = 'e',
   Index = 'I',
+  PartitionMeta_FilterableKeysIndexed = 'K',
   LogMeta_SoftSeal = 'i',
   StoreMeta_ClusterMarker = 'i',
   // TODO(T23728838): fix the collision with LogMeta_SoftSeal
   CustomIndexDirectory = 'M',
   LogMeta_LastReleased = 'm',
+  PartitionMeta_Offloaded = 'O',
   // NOTE 'o' is deprecated and removed from shards on startup from now on
   PartitionDirectory = 'p',
   StoreMeta_RebuildingRanges = 'q',
@@ -167,6 +175,48 @@ class DataKey {
     return lsn_t(be64toh(raw_be));
   }
 
+  /**
+   * Extracts both the log ID and the LSN from a memory segment that is a
+   * DataKey. Same as calling getLogID() and getLSN(), but loads the two
+   * adjacent big-endian fields with a single unaligned 16-byte load and
+   * byte-swaps them together when SSSE3 is available. Iterators decoding
+   * every key they step over should use this.
+   */
+  static std::pair<logid_t, lsn_t> getLogIDAndLSN(const void* blob) {
+    static_assert(offsetof(DataKey, lsn_big_endian_) ==
+                      offsetof(DataKey, log_id_big_endian_) + sizeof(uint64_t),
+                  "");
+    const char* ptr = reinterpret_cast<const char*>(blob) +
+        offsetof(DataKey, log_id_big_endian_);
+#if defined(__SSSE3__) && defined(__SSE4_1__)
+    // Reverse the bytes within each 64-bit half.
+    const __m128i bswap_mask =
+        _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    v = _mm_shuffle_epi8(v, bswap_mask);
+    return std::make_pair(logid_t(int64_t(_mm_cvtsi128_si64(v))),
+                          lsn_t(_mm_extract_epi64(v, 1)));
+#else
+    uint64_t raw_be[2];
+    memcpy(raw_be, ptr, sizeof raw_be);
+    return std::make_pair(
+        logid_t(int64_t(be64toh(raw_be[0]))), lsn_t(be64toh(raw_be[1])));
+#endif
+  }
+
+  /**
+   * Checks whether a memory segment that is a DataKey belongs to the given
+   * log, comparing the encoded bytes directly instead of decoding the key.
+   * Useful to check for the end of a single-log iteration.
+   */
+  static bool belongsToLog(const void* blob, logid_t log_id) {
+    const uint64_t log_id_be = htobe64(log_id.val_);
+    return memcmp(reinterpret_cast<const char*>(blob) +
+                      offsetof(DataKey, log_id_big_endian_),
+                  &log_id_be,
+                  sizeof log_id_be) == 0;
+  }
+
   /**
    * Checks if a memory segment of @param size bytes starting from @param blob
    * represents a valid DataKey.
@@ -464,6 +514,10 @@ class PartitionMetaKey {
         return prefix(KeyPrefix::PartitionMeta_CompactedRetention);
       case PartitionMetadataType::DIRTY:
         return prefix(KeyPrefix::PartitionMeta_Dirty);
+      case PartitionMetadataType::OFFLOADED:
+        return prefix(KeyPrefix::PartitionMeta_Offloaded);
+      case PartitionMetadataType::FILTERABLE_KEYS_INDEXED:
+        return prefix(KeyPrefix::PartitionMeta_FilterableKeysIndexed);
       case PartitionMetadataType::MAX:
         break;
     }
@@ -616,6 +670,24 @@ inline folly::small_vector<char, 26> create(logid_t log_id,
   return key;
 }
 
+/**
+ * Creates a key that is greater than all entries of index `index_type` of
+ * `log_id`, and smaller than entries of other indexes and logs. Used as
+ * iterate_upper_bound for iterators reading one log's index, so that RocksDB
+ * doesn't look at data blocks past it.
+ */
+inline folly::small_vector<char, 10> upperBound(logid_t log_id,
+                                                char index_type) {
+  ld_check(static_cast<unsigned char>(index_type) < 0xFF);
+  folly::small_vector<char, 10> key(sizeof(char) + sizeof(uint64_t) +
+                                    sizeof(char));
+  key[0] = HEADER;
+  uint64_t log_id_big_endian = htobe64(log_id.val_);
+  memcpy(&key[sizeof(char)], &log_id_big_endian, sizeof(log_id_big_endian));
+  key[sizeof(char) + sizeof(uint64_t)] = index_type + 1;
+  return key;
+}
+
 /**
  * Extracts the log ID from a memory segment that is an IndexKey.
  */
@@ -721,6 +793,9 @@ inline bool valid(const void* blob, size_t size) {
  * This index is used for the findKey client operation which finds the LSN
  * of the record corresponding to a key. The index allows the correct partition
  * to be identified through a binary search on the minimum key.
+ * With index_type FILTERABLE_KEY_INDEX the value is instead the range of
+ * filterable keys of the log's records in the partition (see
+ * FilterableKeyRangeValue), used by server-side filtering to skip partitions.
  */
 class CustomIndexDirectoryKey {
  public:
@@ -781,14 +856,15 @@ class CustomIndexDirectoryKey {
     char index_type = getIndexType(blob);
     switch (index_type) {
       case FIND_KEY_INDEX:
+      case FILTERABLE_KEY_INDEX:
         return true;
       default:
         return false;
     }
   }
 
-  static constexpr std::array<char, 1> allEligibleIndexTypes() {
-    return {{FIND_KEY_INDEX}};
+  static constexpr std::array<char, 2> allEligibleIndexTypes() {
+    return {{FIND_KEY_INDEX, FILTERABLE_KEY_INDEX}};
   }
 
   static constexpr char HEADER = prefix(KeyPrefix::CustomIndexDirectory);
@@ -811,6 +887,8 @@ class LogSnapshotBlobKey {
     switch (type) {
       case LocalLogStore::LogSnapshotBlobType::RECORD_CACHE:
         return prefix(KeyPrefix::LogSnapshotBlob);
+      case LocalLogStore::LogSnapshotBlobType::RECORD_CACHE_INDEX:
+        return prefix(KeyPrefix::LogSnapshotBlobIndex);
       case LocalLogStore::LogSnapshotBlobType::MAX:
         break;
     }
@@ -42,6 +42,7 @@ namespace facebook { namespace logdevice {
 static const int SCHEMA_VERSION = 2;
 
 using DeclareActive = LocalLogStore::ReadIterator::DeclareActive;
+using AccountIO = LocalLogStore::ReadIterator::AccountIO;
 using AddContext = LocalLogStore::ReadIterator::AddContext;
 using Direction = RocksDBLocalLogStore::CSIWrapper::Direction;
 using Location = RocksDBLocalLogStore::CSIWrapper::Location;
@@ -163,6 +164,15 @@ int RocksDBLocalLogStore::readAllLogSnapshotBlobs(
       type, callback, db_->DefaultColumnFamily());
 }
 
+int RocksDBLocalLogStore::readLogSnapshotBlobs(
+    LogSnapshotBlobType type,
+    logid_t first,
+    logid_t last,
+    LogSnapshotBlobCallback callback) {
+  return readAllLogSnapshotBlobsImpl(
+      type, callback, db_->DefaultColumnFamily(), first, last);
+}
+
 int RocksDBLocalLogStore::writeLogSnapshotBlobs(
     LogSnapshotBlobType snapshots_type,
     const std::vector<std::pair<logid_t, Slice>>& snapshots) {
@@ -183,6 +193,48 @@ int RocksDBLocalLogStore::deleteAllLogSnapshotBlobs() {
   return 0;
 }
 
+int RocksDBLocalLogStore::deleteTrimmedRecords(logid_t log_id,
+                                               lsn_t trim_point) {
+  if (!getSettings()->trim_delete_range || trim_point == LSN_INVALID) {
+    return 0;
+  }
+  if (getSettings()->read_only) {
+    err = E::LOCAL_LOG_STORE_WRITE;
+    return -1;
+  }
+
+  // Keys of records and copyset index entries are ordered by (log, lsn), so
+  // everything up to trim_point is covered by one range of each kind.
+  // Forward seek slices of DataKey are prefixes of both the old and the new
+  // format of keys. The copyset index contains only single entries, block
+  // entries are not supported (see CopySetIndexIterator).
+  const logid_t end_log =
+      trim_point == LSN_MAX ? logid_t(log_id.val_ + 1) : log_id;
+  const lsn_t end_lsn = trim_point == LSN_MAX ? LSN_INVALID : trim_point + 1;
+
+  DataKey data_begin(log_id, LSN_INVALID);
+  DataKey data_end(end_log, end_lsn);
+  CopySetIndexKey csi_begin(
+      log_id, LSN_INVALID, CopySetIndexKey::SEEK_ENTRY_TYPE);
+  CopySetIndexKey csi_end(end_log, end_lsn, CopySetIndexKey::SEEK_ENTRY_TYPE);
+
+  rocksdb::WriteBatch batch;
+  batch.DeleteRange(
+      data_begin.sliceForForwardSeek(), data_end.sliceForForwardSeek());
+  batch.DeleteRange(
+      rocksdb::Slice(reinterpret_cast<const char*>(&csi_begin),
+                     sizeof(csi_begin)),
+      rocksdb::Slice(reinterpret_cast<const char*>(&csi_end),
+                     sizeof(csi_end)));
+
+  rocksdb::Status status = writer_->writeBatch(rocksdb::WriteOptions(), &batch);
+  if (!status.ok()) {
+    err = E::LOCAL_LOG_STORE_WRITE;
+    return -1;
+  }
+  return 0;
+}
+
 int RocksDBLocalLogStore::performCompaction() {
   rocksdb::Status status =
       db_->CompactRange(rocksdb::CompactRangeOptions(), nullptr, nullptr);
@@ -505,6 +557,7 @@ void RocksDBLocalLogStore::CSIWrapper::seek(logid_t log,
                                             ReadFilter* filter,
                                             ReadStats* stats) {
   DeclareActive activeIter(this, filter ? "seek(filtered)" : "seek");
+  AccountIO account_io(this);
   moveTo(Location(log, lsn), Direction::FORWARD, false, filter, stats);
   trackSeek(lsn, 0);
 }
@@ -518,6 +571,7 @@ void RocksDBLocalLogStore::CSIWrapper::seek(lsn_t lsn,
 
 void RocksDBLocalLogStore::CSIWrapper::seekForPrev(lsn_t lsn) {
   DeclareActive activeIter(this, "seekForPrev");
+  AccountIO account_io(this);
   ld_check(log_id_.hasValue());
   moveTo(Location(log_id_.value(), lsn),
          Direction::BACKWARD,
@@ -530,6 +584,7 @@ void RocksDBLocalLogStore::CSIWrapper::seekForPrev(lsn_t lsn) {
 void RocksDBLocalLogStore::CSIWrapper::next(ReadFilter* filter,
                                             ReadStats* stats) {
   DeclareActive activeIter(this, filter ? "next(filtered)" : "next");
+  AccountIO account_io(this);
   moveTo(getLocation().advance(Direction::FORWARD, log_id_),
          Direction::FORWARD,
          /* near */ true,
@@ -539,6 +594,7 @@ void RocksDBLocalLogStore::CSIWrapper::next(ReadFilter* filter,
 
 void RocksDBLocalLogStore::CSIWrapper::prev() {
   DeclareActive activeIter(this, "prev");
+  AccountIO account_io(this);
   moveTo(getLocation().advance(Direction::BACKWARD, log_id_),
          Direction::BACKWARD,
          /* near */ true,
@@ -675,6 +731,27 @@ bool RocksDBLocalLogStore::CSIWrapper::applyFilterToDataRecord(
                    RecordTimestamp(timestamp));
 }
 
+bool RocksDBLocalLogStore::CSIWrapper::shouldSkipLog(Location loc,
+                                                     ReadFilter* filter) {
+  if (!filter || log_id_.hasValue() || loc.log_id == skip_log_checked_) {
+    return false;
+  }
+  if (filter->shouldProcessLog(loc.log_id)) {
+    // Don't ask again for every record of the log.
+    skip_log_checked_ = loc.log_id;
+    return false;
+  }
+  STAT_INCR(getStatsHolder(), read_streams_num_logs_skipped);
+  return true;
+}
+
+RocksDBLocalLogStore::CSIWrapper::Location
+RocksDBLocalLogStore::CSIWrapper::skipLog(Location loc, Direction dir) {
+  loc.lsn = dir == Direction::FORWARD ? std::numeric_limits<lsn_t>::max()
+                                      : lsn_t(0);
+  return loc.advance(dir, log_id_);
+}
+
 void RocksDBLocalLogStore::CSIWrapper::moveTo(const Location& target,
                                               Direction dir,
                                               bool near,
@@ -814,6 +891,15 @@ void RocksDBLocalLogStore::CSIWrapper::moveTo(const Location& target,
         current_is_filtered_out = false;
       }
 
+      if (shouldSkipLog(current, filter)) {
+        current = skipLog(current, dir);
+        csi_iterator_good = false;
+        data_iterator_good = false;
+        csi_near = false;
+        data_near = false;
+        continue;
+      }
+
       const std::vector<ShardID>& cs = csi_iterator_->getCurrentCopySet();
       LocalLogStoreRecordFormat::csi_flags_t flags =
           csi_iterator_->getCurrentFlags();
@@ -891,6 +977,13 @@ void RocksDBLocalLogStore::CSIWrapper::moveTo(const Location& target,
         current_is_filtered_out = false;
       }
 
+      if (csi_iterator_ == nullptr && shouldSkipLog(current, filter)) {
+        current = skipLog(current, dir);
+        data_iterator_good = false;
+        data_near = false;
+        continue;
+      }
+
       // Apply the filter and check for dangling amend.
       bool data_passes_filter = applyFilterToDataRecord(
           data_loc,
@@ -1250,7 +1343,7 @@ IteratorState RocksDBLocalLogStore::CSIWrapper::DataIterator::state() const {
     return IteratorState::ERROR;
   }
   if (parent_->log_id_.hasValue() &&
-      DataKey::getLogID(slice.data()) != parent_->log_id_.value()) {
+      !DataKey::belongsToLog(slice.data(), parent_->log_id_.value())) {
     return IteratorState::AT_END;
   }
   return IteratorState::AT_RECORD;
@@ -1259,8 +1352,8 @@ IteratorState RocksDBLocalLogStore::CSIWrapper::DataIterator::state() const {
 Location RocksDBLocalLogStore::CSIWrapper::DataIterator::getLocation() const {
   ld_check_eq(state(), IteratorState::AT_RECORD);
   ld_check(DataKey::valid(iterator_->key().data(), iterator_->key().size()));
-  Location loc(DataKey::getLogID(iterator_->key().data()),
-               DataKey::getLSN(iterator_->key().data()));
+  auto log_and_lsn = DataKey::getLogIDAndLSN(iterator_->key().data());
+  Location loc(log_and_lsn.first, log_and_lsn.second);
   ld_check_eq(loc.log_id, parent_->log_id_.value_or(loc.log_id));
   return loc;
 }
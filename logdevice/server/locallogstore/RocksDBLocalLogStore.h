@@ -157,6 +157,9 @@ class RocksDBLocalLogStore : public RocksDBLogStoreBase {
     size_t getIOBytesUnnormalized() const override {
       return RocksDBLogStoreBase::getIOBytesUnnormalized();
     }
+    size_t getIOBlocksUnnormalized() const override {
+      return RocksDBLogStoreBase::getIOBlocksUnnormalized();
+    }
 
     // Passed to ReadFilter.
     // Used by PartitionedRocksDBStore::Iterator: it uses a CSIWrapper confined
@@ -193,6 +196,14 @@ class RocksDBLocalLogStore : public RocksDBLogStoreBase {
                                  ReadFilter* filter,
                                  CopySetIndexIterator* csi_it);
 
+    // In multi-log mode, returns true if filter->shouldProcessLog() rejects
+    // the log of loc.
+    bool shouldSkipLog(Location loc, ReadFilter* filter);
+
+    // Returns the first location past all records of loc's log, going in
+    // direction dir.
+    Location skipLog(Location loc, Direction dir);
+
     const RocksDBLogStoreBase* getRocksDBStore() const {
       return static_cast<const RocksDBLogStoreBase*>(store_);
     }
@@ -224,6 +235,9 @@ class RocksDBLocalLogStore : public RocksDBLogStoreBase {
     IteratorState state_;
     // if state_ == LIMIT_REACHED, getLocation() returns this.
     Location limit_reached_at_ = Location::end();
+    // Last log that ReadFilter::shouldProcessLog() accepted, to only call it
+    // once per log.
+    logid_t skip_log_checked_ = LOGID_INVALID;
   };
 
   // A simple wrapper around CSIWrapper with log_id = none.
@@ -262,6 +276,9 @@ class RocksDBLocalLogStore : public RocksDBLogStoreBase {
     size_t getIOBytesUnnormalized() const override {
       return RocksDBLogStoreBase::getIOBytesUnnormalized();
     }
+    size_t getIOBlocksUnnormalized() const override {
+      return RocksDBLogStoreBase::getIOBlocksUnnormalized();
+    }
 
    private:
     std::unique_ptr<CSIWrapper> iterator_;
@@ -284,8 +301,10 @@ class RocksDBLocalLogStore : public RocksDBLogStoreBase {
 
   int writeMulti(const std::vector<const WriteOp*>& writes,
                  const WriteOptions& options) override {
-    rocksdb::WriteBatch wal_batch;
-    rocksdb::WriteBatch mem_batch;
+    size_t wal_bytes, mem_bytes;
+    RocksDBWriter::estimateBatchSizes(writes, &wal_bytes, &mem_bytes);
+    rocksdb::WriteBatch wal_batch(wal_bytes);
+    rocksdb::WriteBatch mem_batch(mem_bytes);
     return writer_->writeMulti(writes,
                                options,
                                /* column families */ nullptr,
@@ -309,12 +328,21 @@ class RocksDBLocalLogStore : public RocksDBLogStoreBase {
   int readAllLogSnapshotBlobs(LogSnapshotBlobType type,
                               LogSnapshotBlobCallback callback) override;
 
+  int readLogSnapshotBlobs(LogSnapshotBlobType type,
+                           logid_t first,
+                           logid_t last,
+                           LogSnapshotBlobCallback callback) override;
+
   int writeLogSnapshotBlobs(
       LogSnapshotBlobType snapshots_type,
       const std::vector<std::pair<logid_t, Slice>>& snapshots) override;
 
   int deleteAllLogSnapshotBlobs() override;
 
+  // If rocksdb-trim-delete-range is set, covers the records and copyset
+  // index entries of the log up to trim_point with range tombstones.
+  int deleteTrimmedRecords(logid_t log_id, lsn_t trim_point) override;
+
   /**
    * Perform a manual compation run on the entire rocksDB logstore.
    * Will block the calling thread until the compaction finishes.
@@ -7,6 +7,8 @@
  */
 #include "logdevice/server/locallogstore/RocksDBLogStoreBase.h"
 
+#include <folly/Conv.h>
+
 #include "logdevice/server/locallogstore/RocksDBMemTableRep.h"
 #include "logdevice/server/locallogstore/RocksDBSettings.h"
 #include "logdevice/server/locallogstore/RocksDBWriter.h"
@@ -204,17 +206,78 @@ void RocksDBLogStoreBase::stallLowPriWrite() {
   stall_cv_.notify_all();
 }
 
+bool RocksDBLogStoreBase::isWriteStallPredicted() {
+  const double ratio = getSettings()->write_stall_prediction_ratio_;
+  if (ratio <= 0) {
+    return false;
+  }
+
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  if (now < write_stall_prediction_valid_until_.load()) {
+    return write_stall_predicted_.load();
+  }
+
+  // Multiple workers may get here at the same time and all re-evaluate the
+  // prediction. That's harmless as it only queries a few rocksdb properties.
+  bool predicted = predictWriteStall(ratio);
+  write_stall_predicted_.store(predicted);
+  write_stall_prediction_valid_until_.store(now +
+                                            getSettings()->stall_cache_ttl_);
+  return predicted;
+}
+
+bool RocksDBLogStoreBase::predictWriteStall(double ratio) {
+#ifdef LOGDEVICED_ROCKSDB_HAS_GET_AGGREGATED_INT_PROPERTY
+  const rocksdb::Options& options = rocksdb_config_.options_;
+  rocksdb::ColumnFamilyHandle* cf = getWriteStallPredictionCF();
+  uint64_t val;
+
+  // RocksDB stalls writes to a column family that has
+  // max_write_buffer_number - 1 immutable memtables waiting to be flushed.
+  // This is aggregated over all column families, so it errs on the side of
+  // predicting a stall too early.
+  if (options.max_write_buffer_number > 1 &&
+      db_->GetAggregatedIntProperty(
+          rocksdb::DB::Properties::kNumImmutableMemTable, &val) &&
+      val >= ratio * (options.max_write_buffer_number - 1)) {
+    PER_SHARD_STAT_INCR(stats_, write_stall_predicted_flush, shard_idx_);
+    return true;
+  }
+
+  std::string str;
+  if (cf != nullptr &&
+      db_->GetProperty(cf, "rocksdb.num-files-at-level0", &str) &&
+      folly::to<uint64_t>(str) >=
+          ratio * options.level0_slowdown_writes_trigger) {
+    PER_SHARD_STAT_INCR(stats_, write_stall_predicted_l0, shard_idx_);
+    return true;
+  }
+
+  if (cf != nullptr && options.soft_pending_compaction_bytes_limit > 0 &&
+      db_->GetIntProperty(
+          cf, rocksdb::DB::Properties::kEstimatePendingCompactionBytes, &val) &&
+      val >= ratio * options.soft_pending_compaction_bytes_limit) {
+    PER_SHARD_STAT_INCR(
+        stats_, write_stall_predicted_pending_compaction, shard_idx_);
+    return true;
+  }
+#endif
+  return false;
+}
+
 int RocksDBLogStoreBase::readAllLogSnapshotBlobsImpl(
     LogSnapshotBlobType snapshots_type,
     LogSnapshotBlobCallback callback,
-    rocksdb::ColumnFamilyHandle* snapshots_cf) {
+    rocksdb::ColumnFamilyHandle* snapshots_cf,
+    logid_t first,
+    logid_t last) {
   if (!snapshots_cf) {
     ld_info("Snapshots column family does not exist");
     return 0;
   }
 
   auto it = newIterator(getDefaultReadOptions(), snapshots_cf);
-  LogSnapshotBlobKey seek_target(snapshots_type, LOGID_INVALID);
+  LogSnapshotBlobKey seek_target(snapshots_type, first);
   it.Seek(rocksdb::Slice(
       reinterpret_cast<const char*>(&seek_target), sizeof(seek_target)));
   for (; it.status().ok() && it.Valid(); it.Next()) {
@@ -225,6 +288,9 @@ int RocksDBLogStoreBase::readAllLogSnapshotBlobsImpl(
     }
 
     auto logid = LogSnapshotBlobKey::getLogID(key_raw.data());
+    if (logid > last) {
+      break;
+    }
     Slice blob = Slice(it.value().data(), it.value().size());
     int rv = callback(logid, blob);
     if (rv != 0) {
@@ -282,6 +348,17 @@ int RocksDBLogStoreBase::readLogMetadata(logid_t log_id,
                                          LogMetadata* metadata) {
   return writer_->readLogMetadata(log_id, metadata, getMetadataCFHandle());
 }
+int RocksDBLogStoreBase::readAllLogMetadata(LogMetadataType type,
+                                            LogMetadataCallback callback) {
+  return RocksDBWriter::enumerateLogMetadata(
+      db_.get(),
+      getMetadataCFHandle(),
+      /* logs */ {},
+      {type},
+      [&](LogMetadataType, logid_t log_id, LogMetadata& metadata) {
+        callback(log_id, metadata);
+      });
+}
 int RocksDBLogStoreBase::readStoreMetadata(StoreMetadata* metadata) {
   return writer_->readStoreMetadata(metadata, getMetadataCFHandle());
 }
@@ -65,6 +65,8 @@ class RocksDBLogStoreBase : public LocalLogStore {
 
   void stallLowPriWrite() override;
 
+  bool isWriteStallPredicted() override;
+
   StatsHolder* getStatsHolder() const {
     return stats_;
   }
@@ -142,6 +144,16 @@ class RocksDBLogStoreBase : public LocalLogStore {
 
   virtual void onMemTableWindowUpdated() {}
 
+  void noteReadPattern(logid_t log, bool tailing) const override {
+    if (rocksdb_config_.read_patterns_) {
+      if (tailing) {
+        rocksdb_config_.read_patterns_->noteTailRead(log);
+      } else {
+        rocksdb_config_.read_patterns_->noteScan(log);
+      }
+    }
+  }
+
   /**
    * @return  path of RocksDB directory
    */
@@ -297,6 +309,8 @@ class RocksDBLogStoreBase : public LocalLogStore {
 
   int readLogMetadata(logid_t log_id, LogMetadata* metadata) override;
   int readStoreMetadata(StoreMetadata* metadata) override;
+  int readAllLogMetadata(LogMetadataType type,
+                         LogMetadataCallback callback) override;
   int readPerEpochLogMetadata(logid_t log_id,
                               epoch_t epoch,
                               PerEpochLogMetadata* metadata,
@@ -343,6 +357,10 @@ class RocksDBLogStoreBase : public LocalLogStore {
     return ROCKSDB_PERF_CONTEXT()->block_read_byte;
   }
 
+  static size_t getIOBlocksUnnormalized() {
+    return ROCKSDB_PERF_CONTEXT()->block_read_count;
+  }
+
  protected:
   /**
    * Assumes ownership of the raw rocksdb::DB pointer.
@@ -411,9 +429,12 @@ class RocksDBLogStoreBase : public LocalLogStore {
     return version;
   }
 
+  // Reads the blobs of logs in [first, last].
   int readAllLogSnapshotBlobsImpl(LogSnapshotBlobType snapshots_type,
                                   LogSnapshotBlobCallback callback,
-                                  rocksdb::ColumnFamilyHandle* snapshots_cf);
+                                  rocksdb::ColumnFamilyHandle* snapshots_cf,
+                                  logid_t first = LOGID_INVALID,
+                                  logid_t last = LOGID_MAX_INTERNAL);
 
   void gotRocksDBStatusImpl(const rocksdb::Status& s,
                             bool enter_fail_safe_if_bad,
@@ -462,6 +483,13 @@ class RocksDBLogStoreBase : public LocalLogStore {
     return isFlushInProgress();
   }
 
+  // Column family whose L0 file count and pending compaction bytes are
+  // checked by isWriteStallPredicted(), i.e. the one rocksdb may stall
+  // writes for due to falling behind on compactions.
+  virtual rocksdb::ColumnFamilyHandle* getWriteStallPredictionCF() {
+    return db_->DefaultColumnFamily();
+  }
+
   std::unique_ptr<rocksdb::DB> db_;
 
   uint32_t shard_idx_;
@@ -497,6 +525,12 @@ class RocksDBLogStoreBase : public LocalLogStore {
 
     void OnFlushCompleted(rocksdb::DB*, const rocksdb::FlushJobInfo&) override {
       store_->adviseUnstallingLowPriWrites();
+      store_->invalidateWriteStallPrediction();
+    }
+
+    void OnCompactionCompleted(rocksdb::DB*,
+                               const rocksdb::CompactionJobInfo&) override {
+      store_->invalidateWriteStallPrediction();
     }
 
     RocksDBLogStoreBase* store_;
@@ -509,6 +543,24 @@ class RocksDBLogStoreBase : public LocalLogStore {
   std::condition_variable stall_cv_;
   std::shared_ptr<RocksDBMemTableRepFactory> mtr_factory_;
 
+  // Cached result of predictWriteStall(), valid until
+  // write_stall_prediction_valid_until_. Invalidated by Listener whenever a
+  // flush or compaction completes.
+  std::atomic<bool> write_stall_predicted_{false};
+  std::atomic<std::chrono::steady_clock::duration>
+      write_stall_prediction_valid_until_{
+          std::chrono::steady_clock::duration::min()};
+
+  void invalidateWriteStallPrediction() {
+    write_stall_prediction_valid_until_.store(
+        std::chrono::steady_clock::duration::min());
+  }
+
+  // Checks the flush backlog, the number of L0 files and the pending
+  // compaction bytes against `ratio` times the rocksdb triggers for stalling
+  // writes.
+  bool predictWriteStall(double ratio);
+
   // Adds a rocksdb::EventListener that is used for unstalling writes when
   // a flush finishes.
   void registerListener(rocksdb::Options& options);
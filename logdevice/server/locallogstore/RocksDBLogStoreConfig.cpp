@@ -11,6 +11,7 @@
 #include <rocksdb/db.h>
 #include <rocksdb/filter_policy.h>
 #include <rocksdb/options.h>
+#include <rocksdb/persistent_cache.h>
 #include <rocksdb/slice_transform.h>
 #include <rocksdb/sst_file_manager.h>
 #include <rocksdb/statistics.h>
@@ -98,15 +99,52 @@ RocksDBLogStoreConfig::RocksDBLogStoreConfig(
     }
   }
 
+#ifdef LOGDEVICED_ROCKSDB_HAS_PERSISTENT_CACHE
+  if (!rocksdb_settings_->persistent_cache_path_.empty() &&
+      rocksdb_settings_->persistent_cache_size_ > 0) {
+    // Created once and shared by all shards, like the block caches, since
+    // every shard gets a copy of this config.
+    std::shared_ptr<rocksdb::PersistentCache> persistent_cache;
+    rocksdb::Status status = rocksdb::NewPersistentCache(
+        options_.env,
+        rocksdb_settings_->persistent_cache_path_,
+        rocksdb_settings_->persistent_cache_size_,
+        nullptr /* log */,
+        true /* optimized_for_nvm */,
+        &persistent_cache);
+    if (status.ok()) {
+      table_options_.persistent_cache = std::move(persistent_cache);
+    } else {
+      ld_error("Failed to create RocksDB persistent cache in %s: %s. "
+               "Continuing without it.",
+               rocksdb_settings_->persistent_cache_path_.c_str(),
+               status.ToString().c_str());
+    }
+  }
+#else
+  if (!rocksdb_settings_->persistent_cache_path_.empty()) {
+    ld_warning("RocksDB persistent cache is not supported by this version of "
+               "RocksDB, ignoring --rocksdb-persistent-cache-path");
+  }
+#endif
+
   if (rocksdb_settings_->flush_block_policy_ !=
       RocksDBSettings::FlushBlockPolicyType::DEFAULT) {
+    RocksDBFlushBlockPolicy::Options opts{
+        rocksdb_settings_->block_size_,
+        rocksdb_settings_->min_block_size_,
+        rocksdb_settings_->flush_block_policy_ ==
+            RocksDBSettings::FlushBlockPolicyType::EACH_COPYSET,
+        stats};
+    if (rocksdb_settings_->tail_block_size_ > 0 ||
+        rocksdb_settings_->scan_block_size_ > 0) {
+      read_patterns_ = std::make_shared<LogReadPatterns>();
+      opts.tail_block_size = rocksdb_settings_->tail_block_size_;
+      opts.scan_block_size = rocksdb_settings_->scan_block_size_;
+      opts.read_patterns = read_patterns_;
+    }
     table_options_.flush_block_policy_factory =
-        std::make_shared<RocksDBFlushBlockPolicyFactory>(
-            rocksdb_settings_->block_size_,
-            rocksdb_settings_->min_block_size_,
-            rocksdb_settings_->flush_block_policy_ ==
-                RocksDBSettings::FlushBlockPolicyType::EACH_COPYSET,
-            stats);
+        std::make_shared<RocksDBFlushBlockPolicyFactory>(std::move(opts));
   }
 
   table_options_.block_size = rocksdb_settings_->block_size_;
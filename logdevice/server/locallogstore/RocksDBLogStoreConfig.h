@@ -14,6 +14,7 @@
 #include "logdevice/common/settings/UpdateableSettings.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/include/types.h"
+#include "logdevice/server/locallogstore/LogReadPatterns.h"
 #include "logdevice/server/locallogstore/RocksDBSettings.h"
 
 /**
@@ -83,6 +84,11 @@ struct RocksDBLogStoreConfig {
   rocksdb::ColumnFamilyOptions metadata_options_;
   rocksdb::BlockBasedTableOptions metadata_table_options_;
 
+  // How logs are being read, shared by all shards and used by the flush
+  // block policy to pick block sizes. nullptr if block sizes don't depend
+  // on it.
+  std::shared_ptr<LogReadPatterns> read_patterns_;
+
   UpdateableSettings<RocksDBSettings> rocksdb_settings_;
   UpdateableSettings<RebuildingSettings> rebuilding_settings_;
 
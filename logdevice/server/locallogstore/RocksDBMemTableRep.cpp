@@ -24,6 +24,19 @@ RocksDBMemTableRep::RocksDBMemTableRep(RocksDBMemTableRepFactory& factory,
 RocksDBMemTableRep::~RocksDBMemTableRep() {
   ld_debug("Destroyed MemTableRep(%p). ID:%ju", this, (uintmax_t)flush_token_);
   factory_->unregisterMemTableRep(*this);
+  PER_SHARD_STAT_ADD(factory_->store_->getStatsHolder(),
+                     memtable_used_bytes,
+                     factory_->store_->getShardIdx(),
+                     -static_cast<int64_t>(used_bytes_.load()));
+}
+
+rocksdb::KeyHandle RocksDBMemTableRep::Allocate(const size_t len, char** buf) {
+  used_bytes_.fetch_add(len, std::memory_order_relaxed);
+  PER_SHARD_STAT_ADD(factory_->store_->getStatsHolder(),
+                     memtable_used_bytes,
+                     factory_->store_->getShardIdx(),
+                     len);
+  return mtr_->Allocate(len, buf);
 }
 
 void RocksDBMemTableRep::Insert(rocksdb::KeyHandle handle) {
@@ -32,6 +32,8 @@ class RocksDBMemTableRep : public RocksDBMemTableRepWrapper {
 
   ~RocksDBMemTableRep() override;
 
+  rocksdb::KeyHandle Allocate(const size_t len, char** buf) override;
+
   void Insert(rocksdb::KeyHandle handle) override;
 
  private:
@@ -45,6 +47,8 @@ class RocksDBMemTableRep : public RocksDBMemTableRepWrapper {
   std::unique_ptr<rocksdb::MemTableRep> mtr_;
   SteadyTimestamp first_dirtied_time_{SteadyTimestamp::max()};
   std::atomic<bool> dirty_ = {false};
+  // Bytes of entries allocated in this memtable, for memtable_used_bytes stat.
+  std::atomic<size_t> used_bytes_{0};
 
   friend class RocksDBMemTableRepFactory;
 };
@@ -103,6 +107,8 @@ class RocksDBMemTableRepFactory : public RocksDBMemTableRepFactoryWrapper {
   RocksDBLogStoreBase* store_;
   std::string name_;
   std::unique_ptr<rocksdb::MemTableRepFactory> mtr_factory_;
+
+  friend class RocksDBMemTableRep;
 };
 
 }} // namespace facebook::logdevice
@@ -446,6 +446,32 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER,
        SettingsCategory::LogsDB);
 
+  init(OPTNAME(partition_compaction_cost_based_scheduling),
+       &partition_compaction_cost_based_scheduling_,
+       "false",
+       nullptr,
+       "If true, order retention and partial compactions by estimated benefit "
+       "per byte of IO instead of interleaving them 1:1. The benefit of a "
+       "retention compaction is the approximate size of its records past "
+       "retention; the benefit of a partial compaction is the number of files "
+       "it removes, times --rocksdb-partition-compaction-file-value. Each "
+       "iteration of the low-priority thread also stops starting compactions "
+       "once it has scheduled --rocksdb-compaction-ratelimit worth of IO for "
+       "the duration of --rocksdb-partition-lo-pri-check-period.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
+  init(OPTNAME(partition_compaction_file_value),
+       &partition_compaction_file_value_,
+       "64M",
+       parse_nonnegative<ssize_t>(),
+       "With --rocksdb-partition-compaction-cost-based-scheduling, how much a "
+       "partial compaction removing one sst file is worth, expressed in bytes "
+       "of reclaimed space. Higher values favor partial compactions over "
+       "retention compactions.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
   init(OPTNAME(partition_partial_compaction_stall_trigger),
        &partition_partial_compaction_stall_trigger_,
        "50",
@@ -513,6 +539,94 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER,
        SettingsCategory::LogsDB);
 
+  init(OPTNAME(partition_drop_batch_size),
+       &partition_drop_batch_size_,
+       "0",
+       nullptr,
+       "When dropping many partitions at once (e.g. when retention kicks in "
+       "after an outage), drop them this many at a time, letting writes and "
+       "other background work proceed between batches. Deletion of the "
+       "dropped files is additionally rate limited by "
+       "--rocksdb-sst-delete-bytes-per-sec. 0 drops all of them at once.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
+  init(OPTNAME(partition_offload_age),
+       &partition_offload_age_,
+       "0s",
+       [](std::chrono::seconds val) {
+         if (val.count() < 0) {
+           throw boost::program_options::error(
+               "value of --rocksdb-partition-offload-age must be "
+               "non-negative; " +
+               std::to_string(val.count()) + "s given.");
+         }
+       },
+       "Tiered storage: partitions whose newest record is older than this "
+       "are uploaded to remote storage (the RemoteStorage plugin, which must "
+       "be loaded) by the low priority background thread, and then their "
+       "local copy is deleted. Reading or writing an offloaded partition "
+       "downloads it back first; non-blocking reads report that they would "
+       "block. 0 disables offloading.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
+  init(OPTNAME(partition_offload_cache_ttl),
+       &partition_offload_cache_ttl_,
+       "1h",
+       [](std::chrono::seconds val) {
+         if (val.count() < 0) {
+           throw boost::program_options::error(
+               "value of --rocksdb-partition-offload-cache-ttl must be "
+               "non-negative; " +
+               std::to_string(val.count()) + "s given.");
+         }
+       },
+       "How long a partition that was downloaded back from remote storage "
+       "(see --rocksdb-partition-offload-age) is kept on local disk after it "
+       "was last read. If it was written to, it's uploaded again before its "
+       "local copy is deleted.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
+  init(OPTNAME(rebuilding_sst_ingestion),
+       &rebuilding_sst_ingestion_,
+       "false",
+       nullptr,
+       "If true, rebuilding writes that go to partitions older than the two "
+       "latest ones are buffered in memory per partition, written to sorted "
+       "SST files by the high priority background thread and ingested into "
+       "their partition, bypassing memtables and WAL. Buffered records are "
+       "not readable until ingested, and are reported flushed to donors only "
+       "after that. Only applies to writes with --rebuild-store-durability="
+       "memory, others are written normally.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
+  init(OPTNAME(rebuilding_sst_buffer_size),
+       &rebuilding_sst_buffer_size_,
+       "64M",
+       parse_nonnegative<ssize_t>(),
+       "With --rocksdb-rebuilding-sst-ingestion, a partition's buffer of "
+       "rebuilding writes is ingested once it's this big, once its oldest "
+       "write is older than --rocksdb-partition-data-age-flush-trigger, or "
+       "whenever all memtables are flushed.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
+  init(OPTNAME(partition_precreate_count),
+       &partition_precreate_count_,
+       "0",
+       nullptr,
+       "Number of spare empty partitions the hi-pri background thread keeps "
+       "created ahead of the latest partition. Creating a new latest partition "
+       "then only needs to write its metadata, instead of also waiting for "
+       "rocksdb to create a column family, which can take a while when there "
+       "are many partitions or other partitions are being dropped. 0 disables "
+       "pre-creation.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
   init(OPTNAME(partition_hi_pri_check_period),
        &partition_hi_pri_check_period_,
        "2s",
@@ -743,6 +857,24 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER,
        SettingsCategory::ResourceManagement);
 
+  init(OPTNAME(write_stall_prediction_ratio),
+       &write_stall_prediction_ratio_,
+       "0",
+       [](const double& val) {
+         if (val < 0.0 || val > 1.0) {
+           throw boost::program_options::error(
+               "value of --rocksdb-write-stall-prediction-ratio must be in "
+               "the range [0.0, 1.0]");
+         }
+       },
+       "Report the shard as overloaded in STORED replies once the number of "
+       "unflushed immutable memtables, the number of L0 files or the pending "
+       "compaction bytes reach this fraction of the threshold at which "
+       "rocksdb stalls writes. This lets sequencers steer new copysets away "
+       "from the shard before writes actually stall. 0 means disabled.",
+       SERVER,
+       SettingsCategory::ResourceManagement);
+
   init(OPTNAME(allow_fallocate),
        &allow_fallocate,
        "true",
@@ -768,6 +900,32 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER,
        SettingsCategory::LogsDB);
 
+  init(OPTNAME(async_readahead_size),
+       &async_readahead_size,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "If nonzero, when an SST file is read sequentially (e.g. by backlog "
+       "readers), ask the kernel to asynchronously prefetch up to this many "
+       "bytes past the current position with posix_fadvise(WILLNEED). This "
+       "keeps multiple disk reads in flight per storage thread instead of one "
+       "synchronous pread() at a time. Doesn't work with direct I/O. Uses one "
+       "extra file descriptor per open SST file. 0 disables.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::LogsDB);
+
+  init(OPTNAME(coalesce_metadata_writes),
+       &coalesce_metadata_writes,
+       "false",
+       nullptr,
+       "When a write batch contains several metadata updates for the same "
+       "key, write only their combined effect: a log metadata Put that a later "
+       "Put in the batch overwrites is dropped, and all mutable per-epoch "
+       "metadata updates for the same epoch are merged into one merge "
+       "operand. Reduces the number of memtable entries and merge operands "
+       "per appended record.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
   init(OPTNAME(use_copyset_index),
        &use_copyset_index,
        "true",
@@ -785,6 +943,19 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER | REQUIRES_RESTART,
        SettingsCategory::LogsDB);
 
+  init(OPTNAME(trim_delete_range),
+       &trim_delete_range,
+       "false",
+       nullptr,
+       "If set to true, moving the trim point of a log will delete its records "
+       "and copyset index entries up to the trim point with a RocksDB range "
+       "deletion, so that the space is reclaimed by the next compaction "
+       "without the compaction filter having to inspect every record. Only "
+       "applies to non-partitioned stores, partitioned ones drop partitions "
+       "instead.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
   init(OPTNAME(read_find_time_index),
        &read_find_time_index,
        "false",
@@ -794,6 +965,64 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER,
        SettingsCategory::LogsDB);
 
+  init(OPTNAME(find_time_partition_index),
+       &find_time_partition_index,
+       "true",
+       nullptr,
+       "If set to true, findTime will use a compact in-memory copy of the "
+       "partition directory to find the partitions covering the target "
+       "timestamp, instead of doing a binary search with seeks in the on-disk "
+       "partition directory. The copy is built lazily for each log on its "
+       "first findTime and invalidated when the log's directory changes.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
+  init(OPTNAME(find_time_partition_index_max_entries),
+       &find_time_partition_index_max_entries,
+       "1000000",
+       parse_nonnegative<ssize_t>(),
+       "Maximum total number of entries (one per log per partition, 16 bytes "
+       "each) in the in-memory findTime partition index of a shard. When "
+       "the limit is reached, findTime falls back to searching the on-disk "
+       "partition directory for logs not yet indexed.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
+  init(OPTNAME(hot_partition_cache),
+       &hot_partition_cache,
+       "false",
+       nullptr,
+       "If set to true, LogsDB keeps an append-only in-memory copy of the "
+       "records written to the latest partition, ordered by LSN for each log, "
+       "and read iterators serve records from it instead of rocksdb "
+       "iterators while the requested LSNs are covered. A log's records are "
+       "released when the memtable holding them is flushed, or when a write "
+       "can't be appended in order (e.g. an amend or rebuilding store).",
+       SERVER,
+       SettingsCategory::LogsDB);
+
+  init(OPTNAME(hot_partition_cache_max_bytes),
+       &hot_partition_cache_max_bytes,
+       "512M",
+       parse_memory_budget(),
+       "Maximum total size of the records held by the in-memory latest "
+       "partition cache of a shard (see --rocksdb-hot-partition-cache). "
+       "When exceeded, new records are not cached until some memtables are "
+       "flushed.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
+  init(OPTNAME(filterable_key_index),
+       &filterable_key_index,
+       "false",
+       nullptr,
+       "If set to true, LogsDB keeps the smallest and largest filterable key "
+       "of each log's records in each partition, so that server-side "
+       "filtering can tell which partitions have no matching records. Only "
+       "partitions created while this is enabled are indexed.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::LogsDB);
+
   init(OPTNAME(read_only),
        &read_only,
        "false",
@@ -994,6 +1223,28 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER | REQUIRES_RESTART,
        SettingsCategory::RocksDB);
 
+  init(OPTNAME(tail_block_size),
+       &tail_block_size_,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "approximate size of the uncompressed data block for logs that are "
+       "read mostly by tailing readers, so that reading new records doesn't "
+       "load and decompress big blocks; if zero, same as --rocksdb-block-size; "
+       "only used when --rocksdb-flush-block-policy is not default",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::RocksDB);
+
+  init(OPTNAME(scan_block_size),
+       &scan_block_size_,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "approximate size of the uncompressed data block for logs that are "
+       "read mostly by readers scanning their backlog, for better compression "
+       "and fewer block reads; if zero, same as --rocksdb-block-size; only "
+       "used when --rocksdb-flush-block-policy is not default",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::RocksDB);
+
   init(OPTNAME(cache_size),
        &cache_size_,
        "10G",
@@ -1048,6 +1299,29 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER | REQUIRES_RESTART,
        SettingsCategory::RocksDB);
 
+  init(OPTNAME(persistent_cache_path),
+       &persistent_cache_path_,
+       "",
+       nullptr,
+       "If not empty, blocks evicted from the block caches in memory are "
+       "kept in a cache in this directory, shared by all shards, and read "
+       "from there instead of from the shards' disks. Meant for a fast local "
+       "device, e.g. NVMe in front of HDD shards. Its contents don't survive "
+       "restarts. Requires --rocksdb-persistent-cache-size. Hits and misses "
+       "of each shard are in the persistent.cache.hit/miss RocksDB "
+       "statistics.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::RocksDB);
+
+  init(OPTNAME(persistent_cache_size),
+       &persistent_cache_size_,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "size of the block cache in --rocksdb-persistent-cache-path, in bytes "
+       "(0 to turn off)",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::RocksDB);
+
   init(OPTNAME(num_bg_threads_lo),
        &num_bg_threads_lo,
        "-1",
@@ -1304,6 +1578,17 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        "granularity of memtable allocations",
        SERVER | REQUIRES_RESTART,
        SettingsCategory::RocksDB);
+
+  init(OPTNAME(memtable_huge_page_size),
+       &memtable_huge_page_size,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "if nonzero, allocate memtable arena blocks from huge pages of this "
+       "size (in bytes, e.g. 2097152), falling back to regular pages if none "
+       "are available. Huge pages need to be reserved in the OS, see "
+       "/proc/sys/vm/nr_hugepages.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::RocksDB);
 }
 
 rocksdb::Options RocksDBSettings::toRocksDBOptions() const {
@@ -1335,6 +1620,7 @@ rocksdb::Options RocksDBSettings::toRocksDBOptions() const {
   options.max_total_wal_size = max_total_wal_size;
   options.db_write_buffer_size = db_write_buffer_size;
   options.arena_block_size = arena_block_size;
+  options.memtable_huge_page_size = memtable_huge_page_size;
 
   options.compaction_options_universal.min_merge_width = uc_min_merge_width;
   options.compaction_options_universal.max_merge_width = uc_max_merge_width;
@@ -9,6 +9,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <string>
 
 #include <rocksdb/db.h>
 #include <rocksdb/options.h>
@@ -57,6 +58,11 @@
 #define LOGDEVICED_ROCKSDB_BLOOM_UNBROKEN
 #endif
 
+#if (ROCKSDB_MAJOR > 5 || (ROCKSDB_MAJOR == 5 && ROCKSDB_MINOR >= 4)) && \
+    !defined(ROCKSDB_LITE)
+#define LOGDEVICED_ROCKSDB_HAS_PERSISTENT_CACHE
+#endif
+
 #if ROCKSDB_MAJOR > 5 || (ROCKSDB_MAJOR == 5 && ROCKSDB_MINOR >= 14)
 // These performance counters were added in rocksdb 5.14.
 #define ROCKSDB_PERF_COUNTER_write_scheduling_flushes_compactions_time( \
@@ -116,6 +122,13 @@ class RocksDBSettings : public SettingsBundle {
   // Do RangeSync() for WAL files in a background thread.
   bool background_wal_sync;
 
+  // If nonzero, keep this many bytes ahead of sequential SST readers
+  // prefetched asynchronously. See .cpp.
+  size_t async_readahead_size;
+
+  // Combine metadata write ops of a write batch that touch the same key.
+  bool coalesce_metadata_writes;
+
   // IO priority to request for lo-pri rocksdb threads.
   folly::Optional<std::pair<int, int>> low_ioprio;
 
@@ -125,6 +138,12 @@ class RocksDBSettings : public SettingsBundle {
 
   std::chrono::milliseconds stall_cache_ttl_;
 
+  // If positive, predict a write stall once the flush backlog, the number of
+  // L0 files or the pending compaction bytes reach this fraction of the
+  // respective rocksdb stall trigger, and report the shard as overloaded to
+  // sequencers so that they pick other copysets.
+  double write_stall_prediction_ratio_;
+
   // If true, data will be partitioned by time and stored in multiple column
   // families, one per partition. Compaction is not necessary in this mode
   // (trimming is implemented by dropping complete partitions) and will be
@@ -173,6 +192,10 @@ class RocksDBSettings : public SettingsBundle {
   size_t partition_partial_compaction_max_files_;
 
   size_t partition_partial_compaction_max_num_per_loop_;
+
+  // See .cpp
+  bool partition_compaction_cost_based_scheduling_;
+  size_t partition_compaction_file_value_;
   size_t partition_partial_compaction_stall_trigger_;
 
   // The largest l0 files that it is beneficial to compact on their own. note
@@ -203,6 +226,27 @@ class RocksDBSettings : public SettingsBundle {
   // See .cpp
   std::chrono::milliseconds new_partition_timestamp_margin_;
 
+  // Maximum number of partitions dropped under one lock; 0 means unlimited.
+  size_t partition_drop_batch_size_;
+
+  // Number of empty column families to keep created for future partitions.
+  size_t partition_precreate_count_;
+
+  // Partitions with no records newer than this are uploaded to the
+  // RemoteStorage plugin and their local copy is deleted; 0 disables it.
+  std::chrono::seconds partition_offload_age_;
+
+  // How long a partition downloaded back from remote storage stays local
+  // after it was last read.
+  std::chrono::seconds partition_offload_cache_ttl_;
+
+  // If true, rebuilding writes with memory durability to old partitions are
+  // buffered and ingested as SST files instead of going through memtables.
+  bool rebuilding_sst_ingestion_;
+
+  // Size at which a partition's buffer of rebuilding writes is ingested.
+  size_t rebuilding_sst_buffer_size_;
+
   // How often a background thread will check if new partition should be
   // created.
   std::chrono::milliseconds partition_hi_pri_check_period_;
@@ -256,10 +300,36 @@ class RocksDBSettings : public SettingsBundle {
   // that do not pass copyset filters
   bool use_copyset_index;
 
+  // When set to true, moving the trim point of a log deletes its records up
+  // to the trim point with range tombstones instead of leaving them to the
+  // compaction filter. Only affects non-partitioned stores.
+  bool trim_delete_range;
+
   // When set to true, the findTime operation will use the findTime index
   // instead of doing a binary search in the relevant partition.
   bool read_find_time_index;
 
+  // When set to true, findTime will locate the relevant partitions using an
+  // in-memory index of the partition directory instead of seeking in the
+  // on-disk directory. See .cpp.
+  bool find_time_partition_index;
+
+  // Upper bound on the total number of entries in the in-memory findTime
+  // partition index, across all logs of a shard.
+  size_t find_time_partition_index_max_entries;
+
+  // If true, PartitionedRocksDBStore keeps an in-memory copy of the records in
+  // the latest partition and serves reads from it when possible.
+  bool hot_partition_cache;
+
+  // Memory budget of the cache above, per shard.
+  size_t hot_partition_cache_max_bytes;
+
+  // If true, PartitionedRocksDBStore maintains the range of filterable keys of
+  // each log in each partition, for skipping partitions in server-side
+  // filtering. See .cpp.
+  bool filterable_key_index;
+
   // If true, PartitionedRocksDBStore will be opened in read only mode.
   bool read_only;
 
@@ -284,6 +354,11 @@ class RocksDBSettings : public SettingsBundle {
   // ignored for FlushBlockPolicyType::DEFAULT
   size_t min_block_size_;
 
+  // Block sizes for logs read mostly by tailing readers and mostly by backlog
+  // scans; zero means block_size_. Ignored for FlushBlockPolicyType::DEFAULT.
+  size_t tail_block_size_;
+  size_t scan_block_size_;
+
   // same for metadata column family (if partitioned = true)
   size_t metadata_block_size_;
 
@@ -301,6 +376,14 @@ class RocksDBSettings : public SettingsBundle {
   // compressed block cache (not sharded by default)
   int compressed_cache_numshardbits_;
 
+  // Directory for a block cache tier on local flash, shared by all shards,
+  // between the block caches in memory and the shards' disks. Empty to
+  // disable.
+  std::string persistent_cache_path_;
+
+  // size of the block cache tier on local flash
+  size_t persistent_cache_size_;
+
   // Size of the separate block cache for metadata (including the
   // (log, lsn) to partition mapping). If zero, block cache will be shared with
   // data partitions.
@@ -387,6 +470,7 @@ class RocksDBSettings : public SettingsBundle {
   size_t db_write_buffer_size;
   size_t memtable_size_per_node;
   size_t arena_block_size;
+  size_t memtable_huge_page_size;
   unsigned int uc_min_merge_width;
   unsigned int uc_max_merge_width;
   unsigned int uc_max_size_amplification_percent;
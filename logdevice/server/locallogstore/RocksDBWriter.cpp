@@ -8,6 +8,8 @@
 #include "RocksDBWriter.h"
 
 #include <algorithm>
+#include <map>
+#include <numeric>
 
 #include <folly/small_vector.h>
 #include <rocksdb/env.h>
@@ -40,7 +42,8 @@ int RocksDBWriter::writeMulti(
     std::vector<rocksdb::ColumnFamilyHandle*>* data_cf_handles,
     rocksdb::WriteBatch& wal_batch,
     rocksdb::WriteBatch& mem_batch,
-    bool skip_checksum_verification) {
+    bool skip_checksum_verification,
+    bool apply) {
   if (read_only_) {
     ld_check(false);
     err = E::LOCAL_LOG_STORE_WRITE;
@@ -62,7 +65,58 @@ int RocksDBWriter::writeMulti(
   size_t csi_bytes = 0;
   size_t index_bytes = 0;
 
-  for (size_t i = 0; i < writes.size(); ++i) {
+  folly::small_vector<bool, 16> skip(writes.size(), false);
+  std::unordered_map<size_t, MutablePerEpochLogMetadata> merged_per_epoch;
+  if (store_->getSettings()->coalesce_metadata_writes && writes.size() > 1) {
+    STAT_ADD(store_->getStatsHolder(),
+             metadata_writes_coalesced,
+             coalesceMetadataWrites(writes, skip, merged_per_epoch));
+  }
+
+  // Add ops to the batches grouped by column family, so that applying a batch
+  // that spans many partitions (e.g. rebuilding writing old records) doesn't
+  // switch between memtables on every op. Relative order of ops within a
+  // column family is preserved, and ops in different column families can't
+  // affect each other, so the result of the write doesn't change.
+  folly::small_vector<size_t, 16> order(writes.size());
+  std::iota(order.begin(), order.end(), 0);
+  size_t cf_fanout = writes.empty() ? 0 : 1;
+  if (data_cf_handles != nullptr && writes.size() > 1) {
+    ld_check_eq(data_cf_handles->size(), writes.size());
+    folly::small_vector<uint32_t, 16> cf_ids(writes.size());
+    size_t switches = 0;
+    for (size_t i = 0; i < writes.size(); ++i) {
+      rocksdb::ColumnFamilyHandle* cf;
+      switch (writes[i]->getType()) {
+        case WriteType::PUT:
+        case WriteType::DELETE:
+          cf = (*data_cf_handles)[i];
+          break;
+        default:
+          cf = metadata_cf;
+          break;
+      }
+      // nullptr means default column family, which always has ID 0.
+      cf_ids[i] = cf != nullptr ? cf->GetID() : 0;
+      switches += i > 0 && cf_ids[i] != cf_ids[i - 1];
+    }
+    if (switches > 0) {
+      std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return cf_ids[a] < cf_ids[b];
+      });
+      for (size_t i = 1; i < order.size(); ++i) {
+        cf_fanout += cf_ids[order[i]] != cf_ids[order[i - 1]];
+      }
+      if (switches + 1 > cf_fanout) {
+        STAT_INCR(store_->getStatsHolder(), write_batches_regrouped);
+      }
+    }
+  }
+
+  for (size_t i : order) {
+    if (skip[i]) {
+      continue;
+    }
     const WriteOp* write = writes[i];
     rocksdb::ColumnFamilyHandle* data_cf =
         data_cf_handles ? (*data_cf_handles)[i] : nullptr;
@@ -351,7 +405,10 @@ int RocksDBWriter::writeMulti(
 
         PerEpochLogMetaKey key{
             PerEpochLogMetadataType::MUTABLE, op->log_id, op->epoch};
-        Slice value = op->metadata->serialize();
+        auto merged_it = merged_per_epoch.find(i);
+        Slice value = merged_it != merged_per_epoch.end()
+            ? merged_it->second.serialize()
+            : op->metadata->serialize();
 
         // Use mem_batch because we don't need WAL for this type of metadata.
         // It is written in best-effort manner.
@@ -372,7 +429,7 @@ int RocksDBWriter::writeMulti(
 
   rocksdb::WriteOptions options;
   for (auto rocksdb_batch : {&wal_batch, &mem_batch}) {
-    if (rocksdb_batch->Count() > 0) {
+    if (apply && rocksdb_batch->Count() > 0) {
       rocksdb::Status status = writeBatch(options, rocksdb_batch);
       if (!status.ok()) {
         err = E::LOCAL_LOG_STORE_WRITE;
@@ -385,9 +442,117 @@ int RocksDBWriter::writeMulti(
   STAT_ADD(store_->getStatsHolder(), record_bytes_written, record_bytes);
   STAT_ADD(store_->getStatsHolder(), csi_bytes_written, csi_bytes);
   STAT_ADD(store_->getStatsHolder(), index_bytes_written, index_bytes);
+  STAT_INCR(store_->getStatsHolder(), write_batches);
+  STAT_ADD(store_->getStatsHolder(), write_batch_cf_fanout, cf_fanout);
   return 0;
 }
 
+size_t RocksDBWriter::coalesceMetadataWrites(
+    const std::vector<const WriteOp*>& writes,
+    folly::small_vector<bool, 16>& skip,
+    std::unordered_map<size_t, MutablePerEpochLogMetadata>& merged) {
+  // Deletes and release state dumps may touch the same keys as Puts; don't
+  // bother reasoning about how they interleave.
+  bool can_drop_puts = true;
+  for (const WriteOp* write : writes) {
+    if (write->getType() == WriteType::DELETE_LOG_METADATA ||
+        write->getType() == WriteType::DUMP_RELEASE_STATE) {
+      can_drop_puts = false;
+      break;
+    }
+  }
+
+  auto memory_only = [](const WriteOp* write) {
+    return write->durability() <= Durability::MEMORY;
+  };
+
+  // Index of the last op of the batch for each key seen so far, walking the
+  // batch backwards.
+  std::map<std::pair<LogMetadataType, logid_t>, size_t> last_put;
+  std::map<std::pair<logid_t, epoch_t>, size_t> last_merge;
+  size_t coalesced = 0;
+  for (size_t i = writes.size(); i-- > 0;) {
+    const WriteOp* write = writes[i];
+    switch (write->getType()) {
+      case WriteType::PUT_LOG_METADATA: {
+        auto op = static_cast<const PutLogMetadataWriteOp*>(write);
+        if (!can_drop_puts || detail::useMerge(*op->metadata_)) {
+          break;
+        }
+        auto ins = last_put.emplace(
+            std::make_pair(op->metadata_->getType(), op->log_id_), i);
+        // Only drop the Put if the one overwriting it goes to the same
+        // rocksdb batch, so that its durability doesn't change.
+        if (!ins.second &&
+            memory_only(writes[ins.first->second]) == memory_only(write)) {
+          skip[i] = true;
+          ++coalesced;
+        }
+        break;
+      }
+      case WriteType::MERGE_MUTABLE_PER_EPOCH_METADATA: {
+        auto op =
+            static_cast<const MergeMutablePerEpochLogMetadataWriteOp*>(write);
+        auto ins = last_merge.emplace(std::make_pair(op->log_id, op->epoch), i);
+        if (ins.second) {
+          break;
+        }
+        // The merge operator takes the maximum of each field, so the order of
+        // operands doesn't matter.
+        const size_t last = ins.first->second;
+        auto acc = merged.emplace(
+            last,
+            *static_cast<const MergeMutablePerEpochLogMetadataWriteOp*>(
+                 writes[last])
+                 ->metadata);
+        acc.first->second.merge(*op->metadata);
+        skip[i] = true;
+        ++coalesced;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  return coalesced;
+}
+
+void RocksDBWriter::estimateBatchSizes(
+    const std::vector<const WriteOp*>& writes,
+    size_t* wal_batch_bytes,
+    size_t* mem_batch_bytes) {
+  // Per-entry overhead in rocksdb::WriteBatch: tag byte, column family ID and
+  // varint lengths of key and value.
+  const size_t entry_overhead = 12;
+  // Rough size of an op that isn't a record write. Doesn't need to be exact,
+  // records dominate the size of batches.
+  const size_t other_op_bytes = 64;
+
+  size_t wal_bytes = 0;
+  size_t mem_bytes = 0;
+  for (const WriteOp* write : writes) {
+    size_t bytes = other_op_bytes;
+    if (write->getType() == WriteType::PUT) {
+      const PutWriteOp* op = static_cast<const PutWriteOp*>(write);
+      bytes = entry_overhead + sizeof(DataKey) + 1 + op->record_header.size +
+          op->data.size;
+      if (op->copyset_index_lsn.hasValue()) {
+        bytes += entry_overhead + sizeof(CopySetIndexKey) +
+            op->copyset_index_entry.size;
+      }
+      for (const auto& index_key : op->index_key_list) {
+        bytes += entry_overhead + sizeof(logid_t) + 1 +
+            index_key.second.size() + sizeof(lsn_t);
+      }
+    }
+    (write->durability() <= Durability::MEMORY ? mem_bytes : wal_bytes) +=
+        bytes;
+  }
+  // WriteBatch header (sequence number and count).
+  *wal_batch_bytes = wal_bytes > 0 ? wal_bytes + 12 : 0;
+  *mem_batch_bytes = mem_bytes > 0 ? mem_bytes + 12 : 0;
+}
+
 // ====== Metadata operations ======
 
 int RocksDBWriter::readLogMetadata(logid_t log_id,
@@ -10,9 +10,11 @@
 #include <deque>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <folly/Demangle.h>
+#include <folly/small_vector.h>
 #include <rocksdb/cache.h>
 #include <rocksdb/db.h>
 #include <rocksdb/env.h>
@@ -82,13 +84,24 @@ class RocksDBWriter {
   //   separate call to writeBatch.
   // - If both settings are false, all operations are performed atomically with
   //   wal.
+  //
+  // If `apply` is false, the operations are only added to the batches and
+  // writing them is up to the caller.
   int writeMulti(const std::vector<const WriteOp*>& writes,
                  const LocalLogStore::WriteOptions& write_options,
                  rocksdb::ColumnFamilyHandle* metadata_cf,
                  std::vector<rocksdb::ColumnFamilyHandle*>* data_cf_handles,
                  rocksdb::WriteBatch& wal_batch,
                  rocksdb::WriteBatch& mem_batch,
-                 bool skip_checksum_verification = false);
+                 bool skip_checksum_verification = false,
+                 bool apply = true);
+
+  // Estimates how many bytes writeMulti() will add to `wal_batch` and
+  // `mem_batch` for `writes`, so that callers can reserve space for the
+  // batches upfront instead of growing them op by op.
+  static void estimateBatchSizes(const std::vector<const WriteOp*>& writes,
+                                 size_t* wal_batch_bytes,
+                                 size_t* mem_batch_bytes);
 
   int readLogMetadata(logid_t log_id,
                       LogMetadata* metadata,
@@ -362,6 +375,20 @@ class RocksDBWriter {
                          PerEpochLogMetadata& meta)> cb);
 
  private:
+  // Used by writeMulti() if --rocksdb-coalesce-metadata-writes is set. Finds
+  // metadata ops in `writes` whose effect can be folded into a later op of
+  // the same batch: log metadata Puts that are overwritten later in the batch
+  // and mutable per-epoch metadata merges for the same (log, epoch). Sets
+  // skip[i] for the ops that no longer need to be written, and fills `merged`
+  // with the combined value for each merge op that absorbed others (keyed by
+  // index in `writes`).
+  //
+  // @return number of ops marked in `skip`
+  static size_t coalesceMetadataWrites(
+      const std::vector<const WriteOp*>& writes,
+      folly::small_vector<bool, 16>& skip,
+      std::unordered_map<size_t, MutablePerEpochLogMetadata>& merged);
+
   int readPreviousPerEpochLogMetadata(logid_t log_id,
                                       epoch_t epoch,
                                       PerEpochLogMetadata* metadata,
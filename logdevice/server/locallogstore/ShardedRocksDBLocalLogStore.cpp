@@ -151,6 +151,13 @@ ShardedRocksDBLocalLogStore::ShardedRocksDBLocalLogStore(
     throw ConstructorFailed();
   }
   ld_check(static_cast<int>(shard_paths_.size()) == nshards);
+  {
+    std::vector<std::string> shard_path_strings;
+    for (const auto& path : shard_paths_) {
+      shard_path_strings.push_back(path.string());
+    }
+    env_->setShardPaths(std::move(shard_path_strings), stats);
+  }
 
   // Create shards in multiple threads since it's a bit slow
   using FutureResult =
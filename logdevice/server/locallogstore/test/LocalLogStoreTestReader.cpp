@@ -30,6 +30,7 @@ class TestCallback : public LocalLogStoreReader::Callback {
     }
     memcpy(blob_copy, record.blob.data, record.blob.size);
     records_.emplace_back(record.lsn, Slice(blob_copy, record.blob.size), true);
+    records_.back().filtered_out = record.filtered_out;
 
     return 0;
   }
@@ -65,6 +66,7 @@ LocalLogStoreTestReader::process(const TemporaryRocksDBStore* store,
                                        false, // is_rebuilding
                                        filter_,
                                        CatchupEventTrigger::OTHER);
+  ctx.record_filter_ = record_filter_;
 
   Status st = LocalLogStoreReader::read(*it, cb, &ctx, nullptr, settings_);
   records = std::move(cb.getRecords());
@@ -64,6 +64,11 @@ class LocalLogStoreTestReader {
     filter_ = std::move(f);
     return *this;
   }
+  LocalLogStoreTestReader&
+  record_filter(std::shared_ptr<ServerRecordFilter> f) {
+    record_filter_ = std::move(f);
+    return *this;
+  }
   LocalLogStoreTestReader& use_csi(bool v) {
     use_csi_ = v;
     return *this;
@@ -85,6 +90,7 @@ class LocalLogStoreTestReader {
   bool first_record_any_size_{false};
   size_t max_bytes_all_records_{1000000};
   std::shared_ptr<LocalLogStoreReadFilter> filter_;
+  std::shared_ptr<ServerRecordFilter> record_filter_;
   LocalLogStoreReader::ReadPointer read_ptr_{lsn_t{1}};
   int fail_after_ = -1;
   bool use_csi_ = false;
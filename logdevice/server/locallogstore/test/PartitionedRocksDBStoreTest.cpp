@@ -14,6 +14,7 @@
 #include <queue>
 #include <set>
 
+#include <folly/FileUtil.h>
 #include <folly/Random.h>
 #include <folly/Varint.h>
 #include <gtest/gtest.h>
@@ -26,11 +27,14 @@
 #include "logdevice/common/configuration/InternalLogs.h"
 #include "logdevice/common/configuration/LocalLogsConfig.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/common/plugin/RemoteStorage.h"
 #include "logdevice/common/settings/Settings.h"
 #include "logdevice/common/settings/SettingsUpdater.h"
 #include "logdevice/common/test/TestUtil.h"
 #include "logdevice/common/util.h"
 #include "logdevice/server/ServerProcessor.h"
+#include "logdevice/server/ServerRecordEqualityFilter.h"
+#include "logdevice/server/ServerRecordRangeFilter.h"
 #include "logdevice/server/locallogstore/PartitionMetadata.h"
 #include "logdevice/server/locallogstore/RocksDBCompactionFilter.h"
 #include "logdevice/server/locallogstore/RocksDBEnv.h"
@@ -3183,6 +3187,215 @@ TEST_F(PartitionedRocksDBStoreTest, FindTimeBehindTrimPoint) {
   FINDTIME(logid, BASE_TIME, 30, LSN_MAX, 30, 31);
 }
 
+// The in-memory partition index should give the same results as the binary
+// search in the on-disk directory, including after the directory changes.
+TEST_F(PartitionedRocksDBStoreTest, FindTimePartitionIndex) {
+  logid_t logid(3);
+
+  // partition 0
+  put({TestRecord(logid, 10, BASE_TIME)});
+  time_ = SystemTimestamp(std::chrono::milliseconds(BASE_TIME + 10));
+  store_->createPartition();
+  // partition 1
+  put({TestRecord(logid, 20, BASE_TIME + 11)});
+  put({TestRecord(logid, 30, BASE_TIME + 20)});
+  time_ = SystemTimestamp(std::chrono::milliseconds(BASE_TIME + 30));
+  store_->createPartition();
+  // partition 2, no records of `logid`
+  put({TestRecord(logid_t(4), 5, BASE_TIME + 31)});
+  time_ = SystemTimestamp(std::chrono::milliseconds(BASE_TIME + 40));
+  store_->createPartition();
+  // partition 3
+  put({TestRecord(logid, 40, BASE_TIME + 41)});
+
+  const std::vector<uint64_t> timestamps = {BASE_TIME - 20,
+                                            BASE_TIME + 5,
+                                            BASE_TIME + 15,
+                                            BASE_TIME + 35,
+                                            BASE_TIME + 45,
+                                            BASE_TIME + 90};
+  auto check = [&] {
+    for (uint64_t ts : timestamps) {
+      for (logid_t log : {logid, logid_t(4), logid_t(5)}) {
+        lsn_t expected_lo = LSN_INVALID, expected_hi = LSN_MAX;
+        updateSetting("rocksdb-find-time-partition-index", "false");
+        ASSERT_EQ(0,
+                  store_->findTime(log,
+                                   std::chrono::milliseconds(ts),
+                                   &expected_lo,
+                                   &expected_hi));
+        updateSetting("rocksdb-find-time-partition-index", "true");
+        FINDTIME(log, ts, LSN_INVALID, LSN_MAX, expected_lo, expected_hi);
+      }
+    }
+  };
+
+  check();
+  EXPECT_EQ(timestamps.size() * 3,
+            stats_.aggregate().logsdb_find_time_dir_seeks_avoided);
+
+  // Add a new directory entry and drop a partition. The index should be
+  // rebuilt.
+  time_ = SystemTimestamp(std::chrono::milliseconds(BASE_TIME + 50));
+  store_->createPartition();
+  put({TestRecord(logid, 50, BASE_TIME + 51)});
+  store_->dropPartitionsUpTo(ID0 + 1);
+  check();
+
+  // With no budget, the index isn't used.
+  updateSetting("rocksdb-find-time-partition-index-max-entries", "0");
+  closeStore();
+  openStore(settings_overrides_);
+  FINDTIME(logid, BASE_TIME + 45, LSN_INVALID, LSN_MAX, 40, 50);
+  EXPECT_GE(stats_.aggregate().logsdb_find_time_index_over_budget, 1);
+}
+
+TEST_F(PartitionedRocksDBStoreTest, HotPartitionCache) {
+  logid_t logid(3);
+  updateSetting("rocksdb-hot-partition-cache", "true");
+
+  auto read_all = [&](lsn_t from) {
+    std::vector<lsn_t> lsns;
+    auto it =
+        store_->read(logid, LocalLogStore::ReadOptions("HotPartitionCache"));
+    for (it->seek(from); it->state() == IteratorState::AT_RECORD; it->next()) {
+      lsns.push_back(it->getLSN());
+      EXPECT_GT(it->getRecord().size, 0);
+    }
+    EXPECT_EQ(IteratorState::AT_END, it->state());
+    return lsns;
+  };
+  auto hits = [&] { return stats_.aggregate().hot_partition_cache_seek_hits; };
+
+  put({TestRecord(logid, 10)});
+  put({TestRecord(logid, 20), TestRecord(logid, 30)});
+  EXPECT_EQ(3, stats_.aggregate().hot_partition_cache_records_appended);
+
+  // Seeks below the first cached LSN go to rocksdb.
+  EXPECT_EQ(std::vector<lsn_t>({10, 20, 30}), read_all(1));
+  EXPECT_EQ(0, hits());
+  EXPECT_EQ(std::vector<lsn_t>({10, 20, 30}), read_all(10));
+  EXPECT_EQ(1, hits());
+  EXPECT_EQ(std::vector<lsn_t>({30}), read_all(21));
+  EXPECT_EQ(std::vector<lsn_t>(), read_all(31));
+  EXPECT_EQ(3, hits());
+
+  // An out-of-order write drops the log's records from the cache.
+  put({TestRecord(logid, 25)});
+  EXPECT_EQ(1, stats_.aggregate().hot_partition_cache_drops);
+  EXPECT_EQ(std::vector<lsn_t>({20, 25, 30}), read_all(20));
+  EXPECT_EQ(3, hits());
+
+  // The next in-order write starts a new list.
+  put({TestRecord(logid, 40)});
+  EXPECT_EQ(std::vector<lsn_t>({40}), read_all(40));
+  EXPECT_EQ(4, hits());
+
+  // The first write after creating a partition clears the cache.
+  put({TestRecord(logid, 50)});
+  store_->createPartition();
+  EXPECT_EQ(std::vector<lsn_t>({40, 50}), read_all(40));
+  EXPECT_EQ(5, hits());
+  put({TestRecord(logid, 60)});
+  EXPECT_EQ(std::vector<lsn_t>({60}), read_all(60));
+  EXPECT_EQ(6, hits());
+  EXPECT_EQ(std::vector<lsn_t>({50, 60}), read_all(41));
+  EXPECT_EQ(6, hits());
+
+  // Deletes drop the list too.
+  put({TestRecord(logid, 60, TestRecord::Type::DELETE)});
+  EXPECT_EQ(2, stats_.aggregate().hot_partition_cache_drops);
+  EXPECT_EQ(std::vector<lsn_t>(), read_all(60));
+  EXPECT_EQ(6, hits());
+
+  // Disabling the cache releases the memory.
+  put({TestRecord(logid, 70)});
+  EXPECT_GT(stats_.aggregate().hot_partition_cache_bytes, 0);
+  updateSetting("rocksdb-hot-partition-cache", "false");
+  store_->onSettingsUpdated(store_->getSettings());
+  EXPECT_EQ(0, stats_.aggregate().hot_partition_cache_bytes);
+  EXPECT_EQ(std::vector<lsn_t>({70}), read_all(70));
+  EXPECT_EQ(6, hits());
+}
+
+// Spare partitions are created by the hi-pri thread, used by
+// createPartition() and dropped on startup.
+TEST_F(PartitionedRocksDBStoreTest, PrecreatedPartitions) {
+  logid_t logid(3);
+  auto hi_pri_iteration = [&] {
+    store_
+        ->backgroundThreadIteration(
+            PartitionedRocksDBStore::BackgroundThreadType::HI_PRI)
+        .wait();
+  };
+
+  put({TestRecord(logid, 10)});
+  updateSetting("rocksdb-partition-precreate-count", "2");
+  hi_pri_iteration();
+  EXPECT_EQ(2, store_->getNumSparePartitions());
+  EXPECT_EQ(2, stats_.aggregate().partitions_precreated);
+  EXPECT_EQ(1, store_->getPartitionList()->size());
+
+  auto partition = store_->createPartition();
+  ASSERT_NE(nullptr, partition);
+  EXPECT_EQ(ID0 + 1, partition->id_);
+  EXPECT_EQ(1, store_->getNumSparePartitions());
+  EXPECT_EQ(1, stats_.aggregate().partitions_precreated_used);
+  put({TestRecord(logid, 20)});
+
+  hi_pri_iteration();
+  EXPECT_EQ(2, store_->getNumSparePartitions());
+  EXPECT_EQ(3, stats_.aggregate().partitions_precreated);
+
+  // Decreasing the setting drops the extra spares.
+  updateSetting("rocksdb-partition-precreate-count", "1");
+  hi_pri_iteration();
+  EXPECT_EQ(1, store_->getNumSparePartitions());
+
+  // Spare CFs have no metadata and are dropped on startup.
+  closeStore();
+  openStore();
+  EXPECT_EQ(0, store_->getNumSparePartitions());
+  ASSERT_EQ(2, store_->getPartitionList()->size());
+  EXPECT_EQ(ID0 + 1, store_->getPartitionList()->back()->id_);
+
+  // Without spares, createPartition() creates the CF itself.
+  partition = store_->createPartition();
+  ASSERT_NE(nullptr, partition);
+  EXPECT_EQ(ID0 + 2, partition->id_);
+  EXPECT_EQ(1, stats_.aggregate().partitions_precreated_misses);
+  put({TestRecord(logid, 30)});
+
+  auto data = readAndCheck();
+  ASSERT_EQ(3, data.size());
+  EXPECT_EQ(std::vector<lsn_t>({10}), data[0][logid].records);
+  EXPECT_EQ(std::vector<lsn_t>({20}), data[1][logid].records);
+  EXPECT_EQ(std::vector<lsn_t>({30}), data[2][logid].records);
+}
+
+// Partitions are dropped in batches of rocksdb-partition-drop-batch-size.
+TEST_F(PartitionedRocksDBStoreTest, BatchedPartitionDrops) {
+  logid_t logid(3);
+  updateSetting("rocksdb-partition-drop-batch-size", "2");
+  for (lsn_t lsn = 10; lsn <= 60; lsn += 10) {
+    put({TestRecord(logid, lsn)});
+    store_->createPartition();
+  }
+  ASSERT_EQ(7, store_->getPartitionList()->size());
+
+  // 5 partitions to drop, in 3 batches.
+  EXPECT_EQ(0, store_->dropPartitionsUpTo(ID0 + 5));
+  EXPECT_EQ(3, stats_.aggregate().partition_drop_batches);
+  EXPECT_EQ(5, stats_.aggregate().partitions_dropped);
+  EXPECT_EQ(PARTITION_INVALID, store_->getPartitionDropTarget());
+  ASSERT_EQ(2, store_->getPartitionList()->size());
+  EXPECT_EQ(ID0 + 5, store_->getPartitionList()->front()->id_);
+
+  auto data = readAndCheck();
+  ASSERT_EQ(2, data.size());
+  EXPECT_EQ(std::vector<lsn_t>({60}), data[0][logid].records);
+}
+
 TEST_F(PartitionedRocksDBStoreTest, FindTimeWithIndexSimple) {
   logid_t logid(3);
   openStoreWithReadFindTimeIndex();
@@ -3911,6 +4124,63 @@ TEST_F(PartitionedRocksDBStoreTest, FindKeyStrictDeleteRecords) {
   FINDKEY(logid, std::string("10000006"), 30, LSN_MAX, false);
 }
 
+TEST_F(PartitionedRocksDBStoreTest, FilterableKeyIndex) {
+  const logid_t log1(1), log2(2), log3(3);
+  auto filterable = [](std::string key) {
+    return std::map<KeyType, std::string>{{KeyType::FILTERABLE, key}};
+  };
+  auto may_contain = [&](logid_t log,
+                         partition_id_t id,
+                         const ServerRecordFilter& filter) {
+    auto partition = store_->getPartitionList()->get(id);
+    return store_->mayContainMatchingRecords(log, partition, filter);
+  };
+  ServerRecordEqualityFilter eq_a("a"), eq_c("c"), eq_e("e");
+  ServerRecordRangeFilter range_a_b("a", "b"), range_e_z("e", "z");
+  ServerConfig::SettingsConfig indexed;
+  indexed["rocksdb-filterable-key-index"] = "true";
+
+  closeStore();
+  openStore(indexed);
+
+  // The first partition was created before the index was enabled.
+  put({TestRecord(log1, 10, false, BASE_TIME + 1, filterable("b"))});
+  EXPECT_EQ(1, may_contain(log1, ID0, eq_a));
+
+  time_ = SystemTimestamp(std::chrono::milliseconds(BASE_TIME + 2));
+  store_->createPartition();
+  put({TestRecord(log1, 20, false, BASE_TIME + 3, filterable("d")),
+       TestRecord(log1, 30, false, BASE_TIME + 3, filterable("b")),
+       TestRecord(log2, 20, false, BASE_TIME + 3, filterable("x")),
+       TestRecord(log2, 30, false, BASE_TIME + 3)});
+
+  // Log 1 has keys in ["b", "d"].
+  EXPECT_EQ(0, may_contain(log1, ID0 + 1, eq_a));
+  EXPECT_EQ(1, may_contain(log1, ID0 + 1, eq_c));
+  EXPECT_EQ(0, may_contain(log1, ID0 + 1, eq_e));
+  EXPECT_EQ(1, may_contain(log1, ID0 + 1, range_a_b));
+  EXPECT_EQ(0, may_contain(log1, ID0 + 1, range_e_z));
+  // Log 2 has a record without a filterable key, which passes any filter.
+  EXPECT_EQ(1, may_contain(log2, ID0 + 1, eq_a));
+  // Log 3 has no index entry; it's up to the directory to skip the partition.
+  EXPECT_EQ(1, may_contain(log3, ID0 + 1, eq_a));
+
+  // The index survives a restart.
+  closeStore();
+  openStore(indexed);
+  EXPECT_EQ(0, may_contain(log1, ID0 + 1, eq_a));
+
+  // Records written while the index is disabled aren't indexed, so the
+  // partition can't be skipped anymore, even after re-enabling it.
+  closeStore();
+  openStore();
+  put({TestRecord(log1, 40, false, BASE_TIME + 4, filterable("a"))});
+  EXPECT_EQ(1, may_contain(log1, ID0 + 1, eq_a));
+  closeStore();
+  openStore(indexed);
+  EXPECT_EQ(1, may_contain(log1, ID0 + 1, eq_a));
+}
+
 TEST_F(PartitionedRocksDBStoreTest, DecreasingDirectory) {
   increasing_lsns_ = false;
   logid_t logid(1);
@@ -5926,6 +6196,51 @@ TEST_F(MutablePerEpochMetadataTest, MultiWrite) {
   ASSERT_EQ(uint64_t{NWRITES * 100}, metadata_out.data_.epoch_size);
 }
 
+/**
+ * With --rocksdb-coalesce-metadata-writes, metadata ops of a batch that touch
+ * the same key are combined before writing, with the same end result.
+ */
+TEST_F(MutablePerEpochMetadataTest, CoalescedWrites) {
+  updateSetting("rocksdb-coalesce-metadata-writes", "true");
+
+  MutablePerEpochLogMetadata metadata[] = {
+      {0 /* flags */, esn_t{3}, 100},
+      {0 /* flags */, esn_t{7}, 50},
+      {0 /* flags */, esn_t{1}, 400},
+      {0 /* flags */, esn_t{2}, 20}};
+  TrimMetadata trim1(lsn_t{10});
+  TrimMetadata trim2(lsn_t{20});
+  MergeMutablePerEpochLogMetadataWriteOp merge1(
+      logid_t{1}, epoch_t{2}, &metadata[0]);
+  PutLogMetadataWriteOp put1(logid_t{1}, &trim1, Durability::ASYNC_WRITE);
+  MergeMutablePerEpochLogMetadataWriteOp merge2(
+      logid_t{1}, epoch_t{2}, &metadata[1]);
+  MergeMutablePerEpochLogMetadataWriteOp merge3(
+      logid_t{1}, epoch_t{3}, &metadata[3]);
+  PutLogMetadataWriteOp put2(logid_t{1}, &trim2, Durability::ASYNC_WRITE);
+  MergeMutablePerEpochLogMetadataWriteOp merge4(
+      logid_t{1}, epoch_t{2}, &metadata[2]);
+  std::vector<const WriteOp*> op_ptrs = {
+      &merge1, &put1, &merge2, &merge3, &put2, &merge4};
+  ASSERT_EQ(0, store_->writeMulti(op_ptrs, LocalLogStore::WriteOptions()));
+
+  MutablePerEpochLogMetadata metadata_out;
+  ASSERT_EQ(
+      0,
+      store_->readPerEpochLogMetadata(logid_t{1}, epoch_t{2}, &metadata_out));
+  EXPECT_EQ(esn_t{7}, metadata_out.data_.last_known_good);
+  EXPECT_EQ(uint64_t{400}, metadata_out.data_.epoch_size);
+  ASSERT_EQ(
+      0,
+      store_->readPerEpochLogMetadata(logid_t{1}, epoch_t{3}, &metadata_out));
+  EXPECT_EQ(esn_t{2}, metadata_out.data_.last_known_good);
+  EXPECT_EQ(uint64_t{20}, metadata_out.data_.epoch_size);
+
+  TrimMetadata trim_out;
+  ASSERT_EQ(0, store_->readLogMetadata(logid_t{1}, &trim_out));
+  EXPECT_EQ(lsn_t{20}, trim_out.trim_point_);
+}
+
 /**
  * Test Iterator behavior when crossing dirty partitions.
  *
@@ -6984,6 +7299,60 @@ TEST_F(PartitionedRocksDBStoreTest, WrittenByRecovery) {
   EXPECT_EQ(std::vector<lsn_t>({90}), data[7][logid_t(1)].records);
 }
 
+TEST_F(PartitionedRocksDBStoreTest, RebuildingSstIngestion) {
+  closeStore();
+  openStore({{"rocksdb-partition-duration", "1h"},
+             {"rocksdb-rebuilding-sst-ingestion", "true"}});
+  const logid_t logid(1);
+  auto read_lsns = [&] {
+    std::vector<lsn_t> lsns;
+    auto it = store_->read(
+        logid, LocalLogStore::ReadOptions("RebuildingSstIngestion"));
+    for (it->seek(0); it->state() == IteratorState::AT_RECORD; it->next()) {
+      lsns.push_back(it->getLSN());
+    }
+    return lsns;
+  };
+
+  // An old rebuilding record goes to a prepended partition, so it's buffered
+  // instead of written to the memtable, and isn't reported flushed.
+  const FlushToken token_before = store_->maxFlushToken();
+  put({TestRecord(logid,
+                  10,
+                  Durability::MEMORY,
+                  TestRecord::StoreType::REBUILD,
+                  BASE_TIME - HOUR * 2 - HOUR / 2)});
+  EXPECT_EQ(3, stats_.aggregate().partitions_prepended);
+  EXPECT_EQ(std::vector<lsn_t>(), read_lsns());
+  EXPECT_LT(store_->flushedUpThrough(), token_before);
+
+  // Writing the same record again ingests the buffer first.
+  put({TestRecord(logid,
+                  10,
+                  Durability::MEMORY,
+                  TestRecord::StoreType::REBUILD,
+                  BASE_TIME - HOUR * 2 - HOUR / 2)});
+  EXPECT_EQ(1, stats_.aggregate().rebuilding_sst_files_ingested);
+  EXPECT_EQ(std::vector<lsn_t>({10}), read_lsns());
+
+  // Records in recent partitions are written normally.
+  put({TestRecord(logid,
+                  20,
+                  Durability::MEMORY,
+                  TestRecord::StoreType::REBUILD,
+                  BASE_TIME + 10)});
+  EXPECT_EQ(std::vector<lsn_t>({10, 20}), read_lsns());
+
+  store_->flushAllMemtables();
+  EXPECT_EQ(2, stats_.aggregate().rebuilding_sst_files_ingested);
+  EXPECT_EQ(0, stats_.aggregate().rebuilding_sst_ingestion_errors);
+
+  auto data = readAndCheck();
+  ASSERT_EQ(4, data.size());
+  EXPECT_EQ(std::vector<lsn_t>({10}), data[0][logid].records);
+  EXPECT_EQ(std::vector<lsn_t>({20}), data[3][logid].records);
+}
+
 #ifdef LOGDEVICED_ROCKSDB_BLOOM_UNBROKEN
 TEST_F(PartitionedRocksDBStoreTest, Bloom) {
   // Note: this test is somewhat sensitive to the details of rocksdb bloom
@@ -8518,3 +8887,182 @@ TEST_F(PartitionedRocksDBStoreTest, InterleavingCompactions) {
   PartitionToCompact::interleavePartialAndNormalCompactions(&c);
   check(0, {});
 }
+
+TEST_F(PartitionedRocksDBStoreTest, CostBasedCompactionOrder) {
+  using PartitionToCompact = PartitionedRocksDBStore::PartitionToCompact;
+  using Reason = PartitionedRocksDBStore::PartitionToCompact::Reason;
+  using Partition = PartitionedRocksDBStore::Partition;
+  using PartitionPtr = PartitionedRocksDBStore::PartitionPtr;
+
+  std::vector<PartitionPtr> ps(10);
+  for (partition_id_t i = 1; i < ps.size(); ++i) {
+    ps[i] = std::make_shared<Partition>(i, nullptr, RecordTimestamp::min());
+  }
+
+  auto retention = [&](partition_id_t id, uint64_t reclaimed, uint64_t io) {
+    PartitionToCompact p(ps[id], std::chrono::seconds(3600));
+    p.has_cost_estimate = true;
+    p.predicted_reclaimed_bytes = reclaimed;
+    p.predicted_io_bytes = io;
+    return p;
+  };
+  auto partial = [&](partition_id_t id, size_t num_files, uint64_t io) {
+    PartitionToCompact p(ps[id], Reason::PARTIAL);
+    p.partial_compaction_filenames.resize(num_files);
+    p.has_cost_estimate = true;
+    p.predicted_io_bytes = io;
+    return p;
+  };
+
+  // File value 100: partial of 3 files on 100 bytes of io has score 2,
+  // retentions have scores 0.5 and 4.
+  std::vector<PartitionToCompact> c = {retention(1, 50, 100),
+                                       retention(2, 400, 100),
+                                       {ps[3], Reason::MANUAL},
+                                       partial(4, 3, 100),
+                                       {ps[5], Reason::PROACTIVE},
+                                       partial(6, 9, 1)};
+  PartitionToCompact::orderByCost(&c, 100);
+  std::vector<std::pair<partition_id_t, Reason>> expected = {
+      {3, Reason::MANUAL},
+      {2, Reason::RETENTION},
+      {4, Reason::PARTIAL},
+      {1, Reason::RETENTION},
+      // Lower priority compactions are left alone.
+      {5, Reason::PROACTIVE},
+      {6, Reason::PARTIAL}};
+  ASSERT_EQ(expected.size(), c.size());
+  for (size_t i = 0; i < c.size(); ++i) {
+    EXPECT_EQ(expected[i].first, c[i].partition->id_);
+    EXPECT_EQ(expected[i].second, c[i].reason);
+  }
+
+  c = {};
+  PartitionToCompact::orderByCost(&c, 100);
+  EXPECT_TRUE(c.empty());
+}
+
+// Keeps uploaded files in memory.
+class TestRemoteStorage : public RemoteStorage {
+ public:
+  std::string identifier() const override {
+    return "test";
+  }
+  std::string displayName() const override {
+    return "test";
+  }
+
+  int upload(const std::string& key, const std::string& path) override {
+    std::string data;
+    if (!folly::readFile(path.c_str(), data)) {
+      return -1;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    objects_[key] = std::move(data);
+    ++uploads_;
+    return 0;
+  }
+
+  int download(const std::string& key, const std::string& path) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = objects_.find(key);
+    if (it == objects_.end() || !folly::writeFile(it->second, path.c_str())) {
+      return -1;
+    }
+    return 0;
+  }
+
+  int remove(const std::string& key) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    objects_.erase(key);
+    return 0;
+  }
+
+  size_t numObjects() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return objects_.size();
+  }
+
+  size_t uploads() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return uploads_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::map<std::string, std::string> objects_;
+  size_t uploads_ = 0;
+};
+
+// Offload old partitions to remote storage, then read them back.
+TEST_F(PartitionedRocksDBStoreTest, OffloadColdPartitions) {
+  ServerConfig::SettingsConfig settings = {
+      {"rocksdb-partition-offload-age", "1h"},
+      {"rocksdb-partition-offload-cache-ttl", "0s"}};
+  closeStore();
+  openStore(settings);
+  auto remote_storage = std::make_shared<TestRemoteStorage>();
+  store_->setRemoteStorage(remote_storage);
+  const logid_t logid(1);
+
+  put({TestRecord(logid, 10)});
+  store_->createPartition();
+  put({TestRecord(logid, 20), TestRecord(logid, 30)});
+  store_->createPartition();
+  put({TestRecord(logid, 40)});
+  store_->createPartition();
+
+  // Nothing is old enough yet.
+  setTime(FUTURE);
+  EXPECT_EQ(0, store_->offloadColdPartitions());
+
+  // The two latest partitions are never offloaded.
+  setTime(FUTURE + DAY);
+  EXPECT_EQ(2, store_->offloadColdPartitions());
+  EXPECT_EQ(2, remote_storage->numObjects());
+  {
+    auto partitions = store_->getPartitionList();
+    EXPECT_TRUE(partitions->get(ID0)->offloaded);
+    EXPECT_TRUE(partitions->get(ID0 + 1)->offloaded);
+    EXPECT_FALSE(partitions->get(ID0 + 2)->offloaded);
+  }
+
+  // Offloaded partitions stay offloaded after reopening the store.
+  closeStore();
+  openStore(settings);
+  store_->setRemoteStorage(remote_storage);
+  setTime(FUTURE + DAY);
+  EXPECT_TRUE(store_->getPartitionList()->get(ID0)->offloaded);
+
+  // Non-blocking reads can't restore partitions.
+  LocalLogStore::ReadOptions options("OffloadColdPartitions");
+  options.allow_blocking_io = false;
+  auto it = store_->read(logid, options);
+  it->seek(10);
+  EXPECT_EQ(IteratorState::WOULDBLOCK, it->state());
+  EXPECT_TRUE(store_->getPartitionList()->get(ID0)->offloaded);
+
+  // Blocking reads can.
+  options.allow_blocking_io = true;
+  it = store_->read(logid, options);
+  it->seek(10);
+  for (lsn_t lsn : {10, 20, 30, 40}) {
+    ASSERT_EQ(IteratorState::AT_RECORD, it->state());
+    EXPECT_EQ(lsn, it->getLSN());
+    it->next();
+  }
+  EXPECT_EQ(IteratorState::AT_END, it->state());
+  EXPECT_FALSE(store_->getPartitionList()->get(ID0)->offloaded);
+  EXPECT_FALSE(store_->getPartitionList()->get(ID0 + 1)->offloaded);
+  EXPECT_EQ(2, stats_.aggregate().partitions_restored);
+
+  // The restored partitions weren't modified, so they are offloaded again
+  // without uploading.
+  it.reset();
+  EXPECT_EQ(2, store_->offloadColdPartitions());
+  EXPECT_EQ(2, remote_storage->uploads());
+
+  // Dropping partitions removes their remote copies.
+  store_->dropPartitionsUpTo(ID0 + 2);
+  EXPECT_EQ(0, remote_storage->numObjects());
+}
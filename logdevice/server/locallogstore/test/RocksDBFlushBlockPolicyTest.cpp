@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/locallogstore/RocksDBFlushBlockPolicy.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+using namespace facebook::logdevice::RocksDBKeyFormat;
+
+namespace {
+
+// Feeds `count` records of `value_size` bytes of each log to the policy and
+// returns the number of blocks started in each log.
+std::vector<size_t> blocksPerLog(RocksDBFlushBlockPolicy& policy,
+                                 const std::vector<logid_t>& logs,
+                                 size_t count,
+                                 size_t value_size) {
+  std::vector<size_t> res;
+  const std::string value(value_size, 'x');
+  for (logid_t log : logs) {
+    size_t blocks = 0;
+    for (lsn_t lsn = 1; lsn <= count; ++lsn) {
+      DataKey key(log, lsn);
+      blocks += policy.Update(key.sliceForWriting(), value);
+    }
+    res.push_back(blocks);
+  }
+  return res;
+}
+
+} // namespace
+
+TEST(LogReadPatternsTest, Basic) {
+  LogReadPatterns patterns;
+  const logid_t log(1);
+  EXPECT_EQ(LogReadPatterns::Pattern::UNKNOWN, patterns.get(log));
+
+  for (int i = 0; i < LogReadPatterns::THRESHOLD; ++i) {
+    patterns.noteTailRead(log);
+  }
+  EXPECT_EQ(LogReadPatterns::Pattern::TAIL, patterns.get(log));
+
+  // Saturates, so that a log switching to scans is reclassified soon.
+  for (int i = 0; i < 100; ++i) {
+    patterns.noteTailRead(log);
+  }
+  for (int i = 0; i < LogReadPatterns::MAX_SCORE; ++i) {
+    patterns.noteScan(log);
+  }
+  EXPECT_EQ(LogReadPatterns::Pattern::UNKNOWN, patterns.get(log));
+  for (int i = 0; i < LogReadPatterns::THRESHOLD; ++i) {
+    patterns.noteScan(log);
+  }
+  EXPECT_EQ(LogReadPatterns::Pattern::SCAN, patterns.get(log));
+}
+
+TEST(RocksDBFlushBlockPolicyTest, BlockSizePerReadPattern) {
+  auto patterns = std::make_shared<LogReadPatterns>();
+  for (int i = 0; i < LogReadPatterns::MAX_SCORE; ++i) {
+    patterns->noteTailRead(logid_t(1));
+    patterns->noteScan(logid_t(3));
+  }
+
+  RocksDBFlushBlockPolicy::Options opts{
+      /* block_size */ 10000,
+      /* min_block_size */ 100,
+      /* flush_for_each_copyset */ false,
+      /* stats */ nullptr};
+
+  // Without read patterns all logs get the same block size.
+  {
+    RocksDBFlushBlockPolicy policy(opts);
+    auto blocks = blocksPerLog(
+        policy, {logid_t(1), logid_t(2), logid_t(3)}, 1000, 100);
+    EXPECT_EQ(blocks[0], blocks[1]);
+    EXPECT_EQ(blocks[1], blocks[2]);
+  }
+
+  opts.tail_block_size = 1000;
+  opts.scan_block_size = 100000;
+  opts.read_patterns = patterns;
+  RocksDBFlushBlockPolicy policy(opts);
+  auto blocks =
+      blocksPerLog(policy, {logid_t(1), logid_t(2), logid_t(3)}, 1000, 100);
+  // A bit over 100KB of records per log. The first block of logs 2 and 3
+  // starts at the log boundary.
+  EXPECT_GE(blocks[0], 100);
+  EXPECT_LE(blocks[0], 125);
+  EXPECT_GE(blocks[1], 10);
+  EXPECT_LE(blocks[1], 14);
+  EXPECT_GE(blocks[2], 1);
+  EXPECT_LE(blocks[2], 2);
+}
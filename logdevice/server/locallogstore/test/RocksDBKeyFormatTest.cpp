@@ -0,0 +1,64 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/locallogstore/RocksDBKeyFormat.h"
+
+#include <folly/Random.h>
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+using namespace facebook::logdevice::RocksDBKeyFormat;
+
+// The fused decoding of DataKey must agree with the field-by-field one.
+TEST(RocksDBKeyFormatTest, DataKeyGetLogIDAndLSN) {
+  std::vector<std::pair<logid_t, lsn_t>> cases = {
+      {logid_t(1), lsn_t(1)},
+      {logid_t(0x0102030405060708l), lsn_t(0x1112131415161718ul)},
+      {LOGID_MAX, LSN_MAX},
+      {logid_t(42), LSN_INVALID},
+  };
+  for (int i = 0; i < 1000; ++i) {
+    cases.emplace_back(logid_t(folly::Random::rand64() >> 1),
+                       lsn_t(folly::Random::rand64()));
+  }
+
+  for (const auto& c : cases) {
+    DataKey key(c.first, c.second);
+    rocksdb::Slice slice = key.sliceForWriting();
+    ASSERT_TRUE(DataKey::valid(slice.data(), slice.size()));
+
+    auto decoded = DataKey::getLogIDAndLSN(slice.data());
+    EXPECT_EQ(c.first, decoded.first);
+    EXPECT_EQ(c.second, decoded.second);
+    EXPECT_EQ(DataKey::getLogID(slice.data()), decoded.first);
+    EXPECT_EQ(DataKey::getLSN(slice.data()), decoded.second);
+
+    EXPECT_TRUE(DataKey::belongsToLog(slice.data(), c.first));
+    EXPECT_FALSE(
+        DataKey::belongsToLog(slice.data(), logid_t(c.first.val_ ^ 1)));
+  }
+}
+
+// IndexKey::upperBound() must sort after all entries of the log's index and
+// before anything of the next index or log.
+TEST(RocksDBKeyFormatTest, IndexKeyUpperBound) {
+  auto cmp = [](const auto& a, const auto& b) {
+    return rocksdb::Slice(a.data(), a.size())
+        .compare(rocksdb::Slice(b.data(), b.size()));
+  };
+  const logid_t log(0x01020304050607ff);
+  for (char type : {FIND_TIME_INDEX, FIND_KEY_INDEX}) {
+    auto bound = IndexKey::upperBound(log, type);
+    std::string max_key(type == FIND_TIME_INDEX ? FIND_TIME_KEY_SIZE : 100,
+                        '\xff');
+    EXPECT_LT(cmp(IndexKey::create(log, type, max_key, LSN_MAX), bound), 0);
+    EXPECT_LT(cmp(IndexKey::create(log, type, "", LSN_INVALID), bound), 0);
+    EXPECT_GT(
+        cmp(IndexKey::create(logid_t(log.val_ + 1), type, "", 0), bound), 0);
+    EXPECT_GT(cmp(IndexKey::create(log, type + 1, "", 0), bound), 0);
+  }
+}
@@ -345,6 +345,40 @@ STORE_TEST(RocksDBLocalLogStoreTest, AllLogsIterators, store) {
   EXPECT_EQ(written_records, read_records);
   EXPECT_EQ(IteratorState::AT_END, iterator->state());
 
+  // Read everything except log 2, which the filter skips as a whole.
+
+  class SkipLogFilter : public LocalLogStore::ReadFilter {
+   public:
+    bool operator()(logid_t log,
+                    lsn_t,
+                    const ShardID*,
+                    const copyset_size_t,
+                    const csi_flags_t,
+                    RecordTimestamp,
+                    RecordTimestamp) override {
+      // Records of log 2 don't even get here.
+      EXPECT_NE(logid_t(2), log);
+      return true;
+    }
+    bool shouldProcessLog(logid_t log) override {
+      return log != logid_t(2);
+    }
+  };
+  SkipLogFilter filter;
+  read_records.clear();
+  for (iterator->seek(*iterator->minLocation(), &filter);
+       iterator->state() == IteratorState::AT_RECORD;
+       iterator->next(&filter)) {
+    auto p = std::make_pair(iterator->getLogID().val_, iterator->getLSN());
+    read_records[p] = std::string(iterator->getRecord().ptr() + header_size,
+                                  iterator->getRecord().size - header_size);
+  }
+  for (auto it = written_records.begin(); it != written_records.end();) {
+    it = it->first.first == 2 ? written_records.erase(it) : std::next(it);
+  }
+  EXPECT_EQ(written_records, read_records);
+  EXPECT_EQ(IteratorState::AT_END, iterator->state());
+
   // Read only the metadata log record.
 
   iterator->seek(*iterator->metadataLogsBegin());
@@ -828,6 +862,27 @@ TEST_F(RocksDBLocalLogStoreTest, StoreMetadata) {
   }
 }
 
+STORE_TEST(RocksDBLocalLogStoreTest, ReadAllLogMetadata, store) {
+  const std::map<logid_t, lsn_t> trim_points{
+      {logid_t(1), 10}, {logid_t(7), 70}, {logid_t(1000), 5}};
+  for (const auto& kv : trim_points) {
+    ASSERT_EQ(0, store.writeLogMetadata(kv.first, TrimMetadata{kv.second}));
+  }
+  // Metadata of other types must not show up.
+  ASSERT_EQ(0, store.writeLogMetadata(logid_t(3), LastReleasedMetadata{30}));
+
+  std::map<logid_t, lsn_t> read;
+  ASSERT_EQ(0,
+            store.readAllLogMetadata(
+                LogMetadataType::TRIM_POINT,
+                [&](logid_t log_id, LogMetadata& metadata) {
+                  EXPECT_EQ(LogMetadataType::TRIM_POINT, metadata.getType());
+                  read[log_id] =
+                      static_cast<TrimMetadata&>(metadata).trim_point_;
+                }));
+  EXPECT_EQ(trim_points, read);
+}
+
 TEST_F(RocksDBLocalLogStoreTest, StoreMetadataBatch) {
   TemporaryRocksDBStore store;
 
@@ -1123,6 +1178,121 @@ STORE_TEST(RocksDBLocalLogStoreTest, SnapshotsPersistence, store) {
   ASSERT_EQ(0, rv);
   snapshots_content[logid_t(999)] = final_example;
   ASSERT_EQ(blob_map, snapshots_content);
+
+  // A range of logs can be read on its own
+  blob_map.clear();
+  rv = store.readLogSnapshotBlobs(
+      snapshots_type, logid_t(2), logid_t(999), callback);
+  ASSERT_EQ(0, rv);
+  std::map<logid_t, std::string> expected_range{
+      {logid_t(777), snapshots_content[logid_t(777)]},
+      {logid_t(999), final_example}};
+  ASSERT_EQ(expected_range, blob_map);
+
+  // Blobs of other types are kept apart
+  auto index_type = LocalLogStore::LogSnapshotBlobType::RECORD_CACHE_INDEX;
+  std::string index = "index";
+  rv = store.writeLogSnapshotBlobs(
+      index_type, {{LOGID_INVALID, Slice(index.c_str(), index.size())}});
+  ASSERT_EQ(0, rv);
+  blob_map.clear();
+  rv = store.readAllLogSnapshotBlobs(index_type, callback);
+  ASSERT_EQ(0, rv);
+  ASSERT_EQ((std::map<logid_t, std::string>{{LOGID_INVALID, index}}), blob_map);
+  blob_map.clear();
+  rv = store.readAllLogSnapshotBlobs(snapshots_type, callback);
+  ASSERT_EQ(0, rv);
+  ASSERT_EQ(blob_map, snapshots_content);
+}
+
+// Write stall prediction kicks in once the number of L0 files reaches the
+// configured fraction of level0_slowdown_writes_trigger.
+TEST_F(RocksDBLocalLogStoreTest, WriteStallPrediction) {
+  RocksDBSettings settings = RocksDBSettings::defaultTestSettings();
+  settings.write_stall_prediction_ratio_ = 0.5;
+  settings.level0_file_num_compaction_trigger = 100;
+  settings.level0_slowdown_writes_trigger = 4;
+  settings.level0_stop_writes_trigger = 100;
+  RocksDBLogStoreConfig config(
+      UpdateableSettings<RocksDBSettings>(settings),
+      UpdateableSettings<RebuildingSettings>(),
+      &env_,
+      nullptr,
+      &stats_);
+  config.createMergeOperator(0);
+  TemporaryLogStore store([&](std::string path) {
+    return new RocksDBLocalLogStore(0, path, config, &stats_);
+  });
+
+  for (lsn_t lsn = 1; lsn <= 2; ++lsn) {
+    EXPECT_FALSE(store.isWriteStallPredicted());
+    PutWriteOp op{logid_t(123),
+                  lsn,
+                  getHeader(),
+                  Slice("abc1", 4),
+                  folly::none,
+                  folly::none,
+                  Slice(nullptr, 0),
+                  {},
+                  Durability::ASYNC_WRITE,
+                  false};
+    ASSERT_EQ(0, store.writeMulti(std::vector<const WriteOp*>{&op}));
+    // Flushing creates an L0 file and invalidates the cached prediction.
+    ASSERT_EQ(0, store.sync(Durability::MEMORY));
+  }
+  EXPECT_TRUE(store.isWriteStallPredicted());
+  EXPECT_EQ(1,
+            stats_.aggregate().totalPerShardStats().write_stall_predicted_l0);
+}
+
+// With rocksdb-trim-delete-range, deleteTrimmedRecords() removes the records
+// of the log up to the trim point and leaves everything else alone.
+TEST_F(RocksDBLocalLogStoreTest, DeleteTrimmedRecords) {
+  RocksDBSettings settings = RocksDBSettings::defaultTestSettings();
+  settings.trim_delete_range = true;
+  RocksDBLogStoreConfig config(
+      UpdateableSettings<RocksDBSettings>(settings),
+      UpdateableSettings<RebuildingSettings>(),
+      &env_,
+      nullptr,
+      &stats_);
+  config.createMergeOperator(0);
+  TemporaryLogStore store([&](std::string path) {
+    return new RocksDBLocalLogStore(0, path, config, &stats_);
+  });
+
+  for (logid_t log : {logid_t(1), logid_t(2)}) {
+    for (lsn_t lsn = 1; lsn <= 5; ++lsn) {
+      PutWriteOp op{log,
+                    lsn,
+                    getHeader(),
+                    Slice("abc", 3),
+                    folly::none,
+                    folly::none,
+                    Slice(nullptr, 0),
+                    {},
+                    Durability::ASYNC_WRITE,
+                    false};
+      ASSERT_EQ(0, store.writeMulti(std::vector<const WriteOp*>{&op}));
+    }
+  }
+  ASSERT_EQ(0, store.deleteTrimmedRecords(logid_t(1), 3));
+
+  auto read_lsns = [&](logid_t log) {
+    std::vector<lsn_t> lsns;
+    auto it = store.read(log, LocalLogStore::ReadOptions("DeleteTrimmed"));
+    for (it->seek(0); it->state() == IteratorState::AT_RECORD; it->next()) {
+      lsns.push_back(it->getLSN());
+    }
+    return lsns;
+  };
+  EXPECT_EQ(std::vector<lsn_t>({4, 5}), read_lsns(logid_t(1)));
+  EXPECT_EQ(std::vector<lsn_t>({1, 2, 3, 4, 5}), read_lsns(logid_t(2)));
+
+  // Trimming everything doesn't touch the next log either.
+  ASSERT_EQ(0, store.deleteTrimmedRecords(logid_t(1), LSN_MAX));
+  EXPECT_EQ(std::vector<lsn_t>(), read_lsns(logid_t(1)));
+  EXPECT_EQ(std::vector<lsn_t>({1, 2, 3, 4, 5}), read_lsns(logid_t(2)));
 }
 
 } // namespace
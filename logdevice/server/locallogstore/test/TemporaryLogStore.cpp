@@ -44,6 +44,10 @@ void TemporaryLogStore::adviseUnstallingLowPriWrites(bool never_stall) {
   db_->adviseUnstallingLowPriWrites(never_stall);
 }
 
+bool TemporaryLogStore::isWriteStallPredicted() {
+  return db_->isWriteStallPredicted();
+}
+
 int TemporaryLogStore::writeMulti(const std::vector<const WriteOp*>& writes,
                                   const WriteOptions& options) {
   return db_->writeMulti(writes, options);
@@ -84,6 +88,11 @@ int TemporaryLogStore::readLogMetadata(logid_t log_id, LogMetadata* metadata) {
   return db_->readLogMetadata(log_id, metadata);
 }
 
+int TemporaryLogStore::readAllLogMetadata(LogMetadataType type,
+                                          LogMetadataCallback callback) {
+  return db_->readAllLogMetadata(type, std::move(callback));
+}
+
 int TemporaryLogStore::writeLogMetadata(logid_t log_id,
                                         const LogMetadata& metadata,
                                         const WriteOptions& options) {
@@ -196,6 +205,14 @@ int TemporaryLogStore::readAllLogSnapshotBlobs(
   return db_->readAllLogSnapshotBlobs(type, callback);
 }
 
+int TemporaryLogStore::readLogSnapshotBlobs(
+    LocalLogStore::LogSnapshotBlobType type,
+    logid_t first,
+    logid_t last,
+    LogSnapshotBlobCallback callback) {
+  return db_->readLogSnapshotBlobs(type, first, last, callback);
+}
+
 int TemporaryLogStore::writeLogSnapshotBlobs(
     LocalLogStore::LogSnapshotBlobType snapshots_type,
     const std::vector<std::pair<logid_t, Slice>>& snapshots) {
@@ -206,6 +223,10 @@ int TemporaryLogStore::deleteAllLogSnapshotBlobs() {
   return db_->deleteAllLogSnapshotBlobs();
 }
 
+int TemporaryLogStore::deleteTrimmedRecords(logid_t log_id, lsn_t trim_point) {
+  return db_->deleteTrimmedRecords(log_id, trim_point);
+}
+
 namespace {
 class RocksDBStoreFactory : public LocalLogStoreFactory {
  public:
@@ -47,6 +47,7 @@ class TemporaryLogStore : public LocalLogStore {
   //
   void stallLowPriWrite() override;
   void adviseUnstallingLowPriWrites(bool never_stall = false) override;
+  bool isWriteStallPredicted() override;
   int writeMulti(const std::vector<const WriteOp*>& writes,
                  const WriteOptions& options = WriteOptions()) override;
   int sync(Durability) override;
@@ -61,6 +62,8 @@ class TemporaryLogStore : public LocalLogStore {
   readAllLogs(const LocalLogStore::ReadOptions&) const override;
 
   int readLogMetadata(logid_t log_id, LogMetadata* metadata) override;
+  int readAllLogMetadata(LogMetadataType type,
+                         LogMetadataCallback callback) override;
   int writeLogMetadata(logid_t log_id,
                        const LogMetadata& metadata,
                        const WriteOptions& options) override;
@@ -110,12 +113,19 @@ class TemporaryLogStore : public LocalLogStore {
   int readAllLogSnapshotBlobs(LocalLogStore::LogSnapshotBlobType type,
                               LogSnapshotBlobCallback callback) override;
 
+  int readLogSnapshotBlobs(LocalLogStore::LogSnapshotBlobType type,
+                           logid_t first,
+                           logid_t last,
+                           LogSnapshotBlobCallback callback) override;
+
   int writeLogSnapshotBlobs(
       LocalLogStore::LogSnapshotBlobType snapshots_type,
       const std::vector<std::pair<logid_t, Slice>>& snapshots) override;
 
   int deleteAllLogSnapshotBlobs() override;
 
+  int deleteTrimmedRecords(logid_t log_id, lsn_t trim_point) override;
+
   int findTime(logid_t log_id,
                std::chrono::milliseconds timestamp,
                lsn_t* lo,
@@ -21,6 +21,7 @@
 
 #include "logdevice/common/BuildInfo.h"
 #include "logdevice/common/ConstructorFailed.h"
+#include "logdevice/common/JemallocArenas.h"
 #include "logdevice/common/NoopTraceLogger.h"
 #include "logdevice/common/Semaphore.h"
 #include "logdevice/common/StatsCollectionThread.h"
@@ -392,6 +393,10 @@ int main(int argc, const char** argv) {
   ld_info("asserts on (NDEBUG not set)");
 #endif
 
+  // Before ServerParameters starts any threads.
+  JemallocArenas::init(server_settings->jemalloc_thread_arenas,
+                       server_settings->jemalloc_allocation_tagging);
+
   std::unique_ptr<ServerParameters> params;
   try {
     params = std::make_unique<ServerParameters>(settings_updater,
@@ -18,6 +18,7 @@
 #include "logdevice/common/configuration/ServerConfig.h"
 #include "logdevice/common/configuration/UpdateableConfig.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/RECORDS_Message.h"
 #include "logdevice/common/protocol/RECORD_Message.h"
 #include "logdevice/common/protocol/RELEASE_Message.h"
 #include "logdevice/common/protocol/SHARD_STATUS_UPDATE_Message.h"
@@ -41,7 +42,8 @@ AllServerReadStreams::AllServerReadStreams(
     LogStorageStateMap* log_storage_state_map,
     ServerProcessor* processor,
     StatsHolder* stats,
-    bool on_worker_thread)
+    bool on_worker_thread,
+    WorkerType worker_type)
     : real_time_record_buffer_(
           settings->real_time_max_bytes / settings->num_workers,
           settings->real_time_eviction_threshold_bytes / settings->num_workers,
@@ -51,6 +53,7 @@ AllServerReadStreams::AllServerReadStreams(
       settings_(settings),
       memory_budget_(max_read_storage_tasks_mem),
       worker_id_(worker_id),
+      worker_type_(worker_type),
       log_storage_state_map_(log_storage_state_map),
       on_worker_thread_(on_worker_thread) {}
 
@@ -90,7 +93,10 @@ AllServerReadStreams::insertOrGet(ClientID client_id,
     // We actually inserted ...
 
     // Check that we aren't over capacity
-    if (streams_.size() > settings_->max_server_read_streams) {
+    const size_t max_streams = on_worker_thread_
+        ? Worker::settings().max_server_read_streams
+        : settings_->max_server_read_streams;
+    if (streams_.size() > max_streams) {
       streams_.erase(insert_result.first);
       err = E::TEMPLIMIT;
       return std::make_pair(nullptr, false);
@@ -132,12 +138,21 @@ AllServerReadStreams::insertOrGet(ClientID client_id,
 
     if (on_worker_thread_) {
       // initialize the iterator cache
+      std::shared_ptr<IteratorPool> pool;
+      if (Worker::settings().share_read_iterators) {
+        auto& pool_ref = iterator_pools_[std::make_pair(log_id, shard)];
+        if (!pool_ref) {
+          pool_ref = std::make_shared<IteratorPool>();
+        }
+        pool = pool_ref;
+      }
       deref(insert_result.first).iterator_cache_ =
           std::make_shared<IteratorCache>(
               &processor_->sharded_storage_thread_pool_->getByIndex(shard)
                    .getLocalLogStore(),
               log_id,
-              false /* created_for_rebuilding */);
+              false /* created_for_rebuilding */,
+              std::move(pool));
     }
   } else {
     (*insert_result.first)->log_group_path_ = log_group_path;
@@ -301,6 +316,20 @@ void AllServerReadStreams::onRecordSent(ClientID client_id,
   }
 }
 
+void AllServerReadStreams::onRecordsSent(ClientID client_id,
+                                         const RECORDS_Message& msg,
+                                         const SteadyTimestamp enqueue_time) {
+  auto it = client_states_.find(client_id);
+  if (it != client_states_.end()) {
+    ld_check(it->second.catchup_queue);
+    auto* stream =
+        get(client_id, msg.log_id_, msg.read_stream_id_, msg.shard_);
+    it->second.catchup_queue->onRecordsSent(msg, stream, enqueue_time);
+  } else {
+    // Client disconnected, nothing to do.
+  }
+}
+
 void AllServerReadStreams::onStartedSent(ClientID client_id,
                                          const STARTED_Message& msg,
                                          const SteadyTimestamp enqueue_time) {
@@ -332,6 +361,11 @@ void AllServerReadStreams::onEpochOffsetTask(EpochOffsetStorageTask& task) {
   if (task.status_ == E::OK) {
     task.stream_.get()->epoch_offset_ =
         std::make_pair(task.epoch_, task.result_offset_);
+    LogStorageState* log_state =
+        log_storage_state_map_->find(task.log_id_, stream->shard_);
+    if (log_state) {
+      log_state->cacheEpochOffset(task.epoch_, task.result_offset_);
+    }
   } else {
     ld_error("Got error while executing EpochOffsetStorageTask for epoch %u "
              "in log %ld with status=%s",
@@ -344,7 +378,12 @@ void AllServerReadStreams::onEpochOffsetTask(EpochOffsetStorageTask& task) {
 void AllServerReadStreams::onReadTaskDone(ReadStorageTask& task) {
   ld_check(read_storage_tasks_in_flight_ > 0);
   read_storage_tasks_in_flight_--;
-  if (task.catchup_queue_) {
+  if (task.is_prefetch_ && task.stream_ && task.stream_->prefetched_batch_ &&
+      !task.stream_->prefetched_batch_->adopted) {
+    onPrefetchTaskDone(task);
+  } else if (task.is_prefetch_ && !task.stream_) {
+    // Stream was destroyed, nobody is waiting for this task.
+  } else if (task.catchup_queue_) {
     task.catchup_queue_->onReadTaskDone(task);
   } else {
     // Client disconnected.
@@ -353,10 +392,49 @@ void AllServerReadStreams::onReadTaskDone(ReadStorageTask& task) {
   sendDelayedReadStorageTasks();
 }
 
+void AllServerReadStreams::onPrefetchTaskDone(ReadStorageTask& task) {
+  ServerReadStream* stream = task.stream_.get();
+  ld_check(stream);
+  auto& batch = stream->prefetched_batch_;
+  ld_check(batch);
+  ld_check(!batch->done);
+  ld_check(batch->version == task.server_read_stream_version_);
+
+  batch->accessed_under_replicated_region = task.owned_iterator_ &&
+      task.owned_iterator_->accessedUnderReplicatedRegion();
+  if (stream->iterator_cache_) {
+    if (!stream->iterator_cache_->valid(task.options_)) {
+      stream->iterator_cache_->set(
+          task.options_, std::move(task.owned_iterator_));
+    }
+    stream->iterator_cache_->release(task.options_);
+  }
+
+  batch->done = true;
+  batch->status = task.status_;
+  batch->records = std::move(task.records_);
+  batch->read_ptr = task.read_ctx_.read_ptr_;
+  batch->memory_token = std::move(task.memory_token_);
+  STAT_INCR(stats_, read_prefetch_batches_ready);
+}
+
 void AllServerReadStreams::onReadTaskDropped(ReadStorageTask& task) {
   ld_check(read_storage_tasks_in_flight_ > 0);
   read_storage_tasks_in_flight_--;
-  if (task.catchup_queue_) {
+  bool prefetch_adopted = false;
+  if (task.is_prefetch_ && task.stream_) {
+    ServerReadStream* stream = task.stream_.get();
+    ld_check(stream->prefetched_batch_);
+    prefetch_adopted = stream->prefetched_batch_->adopted;
+    if (stream->iterator_cache_) {
+      stream->iterator_cache_->release(task.options_);
+    }
+    stream->prefetched_batch_.reset();
+  }
+
+  if (task.is_prefetch_ && !prefetch_adopted) {
+    // Nobody is waiting for this task.
+  } else if (task.catchup_queue_) {
     task.catchup_queue_->onStorageTaskDropped(task.stream_.get());
   } else {
     // Client disconnected.
@@ -365,9 +443,13 @@ void AllServerReadStreams::onReadTaskDropped(ReadStorageTask& task) {
   sendDelayedReadStorageTasks();
 }
 
-Message::Disposition
-AllServerReadStreams::onWindowMessage(WINDOW_Message* msg,
-                                      const Address& from) {
+/**
+ * Validates WINDOW updates received from a client and applies them to the
+ * read streams of the current Worker.
+ */
+static Message::Disposition onWindowHeaders(const WINDOW_Header* headers,
+                                            size_t count,
+                                            const Address& from) {
   if (!from.isClientAddress()) {
     ld_error("got WINDOW message from non-client %s",
              Sender::describeConnection(from).c_str());
@@ -392,34 +474,48 @@ AllServerReadStreams::onWindowMessage(WINDOW_Message* msg,
     return Message::Disposition::ERROR;
   }
 
-  const WINDOW_Header& header = msg->header_;
+  for (size_t i = 0; i < count; ++i) {
+    const WINDOW_Header& header = headers[i];
+
+    // TODO validate log ID and send back error
+
+    // The size of the sliding window should be positive.
+    if (header.sliding_window.high < header.sliding_window.low) {
+      ld_warning("Client %s sent a malformed WINDOW message: "
+                 "log_id %lu, read_stream_id %lu "
+                 "sliding_window.high %lu, "
+                 "sliding_window.low %lu. "
+                 "Ignoring.",
+                 Sender::describeConnection(from).c_str(),
+                 header.log_id.val_,
+                 uint64_t(header.read_stream_id),
+                 header.sliding_window.high,
+                 header.sliding_window.low);
+      continue;
+    }
 
-  // TODO validate log ID and send back error
+    ld_spew("Client %s updated window for log %lu (rsid %ld) to [%s, %s]",
+            Sender::describeConnection(from).c_str(),
+            header.log_id.val_,
+            header.read_stream_id.val_,
+            lsn_to_string(header.sliding_window.low).c_str(),
+            lsn_to_string(header.sliding_window.high).c_str());
 
-  // The size of the sliding window should be positive.
-  if (header.sliding_window.high < header.sliding_window.low) {
-    ld_warning("Client %s sent a malformed WINDOW message: "
-               "log_id %lu, read_stream_id %lu "
-               "sliding_window.high %lu, "
-               "sliding_window.low %lu. "
-               "Ignoring.",
-               Sender::describeConnection(from).c_str(),
-               header.log_id.val_,
-               uint64_t(header.read_stream_id),
-               header.sliding_window.high,
-               header.sliding_window.low);
-    return Message::Disposition::NORMAL;
+    w->serverReadStreams().onWindowMessage(from.asClientID(), header);
   }
+  return Message::Disposition::NORMAL;
+}
 
-  ld_spew("Client %s updated window for log %lu (rsid %ld) to [%s, %s]",
-          Sender::describeConnection(from).c_str(),
-          header.log_id.val_,
-          header.read_stream_id.val_,
-          lsn_to_string(header.sliding_window.low).c_str(),
-          lsn_to_string(header.sliding_window.high).c_str());
+Message::Disposition
+AllServerReadStreams::onWindowMessage(WINDOW_Message* msg,
+                                      const Address& from) {
+  return onWindowHeaders(&msg->header_, 1, from);
+}
 
-  w->serverReadStreams().onWindowMessage(from.asClientID(), header);
-  return Message::Disposition::NORMAL;
+Message::Disposition
+AllServerReadStreams::onWindowsMessage(WINDOWS_Message* msg,
+                                       const Address& from) {
+  return onWindowHeaders(msg->windows_.data(), msg->windows_.size(), from);
 }
 
 void AllServerReadStreams::onWindowMessage(ClientID from,
@@ -562,9 +658,11 @@ int AllServerReadStreams::updateSubscription(logid_t log_id,
   // Depending on whether there are still any active streams for this log,
   // subscribe to or unsubscribe from RELEASE messages for the log.
   if (log_index.find(key) != log_index.end()) {
-    log_state->subscribeWorker(worker_id_);
+    log_state->subscribeWorker(worker_id_, worker_type_);
   } else {
-    log_state->unsubscribeWorker(worker_id_);
+    log_state->unsubscribeWorker(worker_id_, worker_type_);
+    // No more streams to share iterators with.
+    iterator_pools_.erase(std::make_pair(log_id, shard));
   }
   return 0;
 }
@@ -648,8 +746,11 @@ void AllServerReadStreams::sendDelayedReadStorageTasks() {
     auto& queued = delayed_read_storage_tasks_.front();
     if (!tryAcquireMemoryForTask(queued.task)) {
       // Still not enough memory available. We'll try again next time a storage
-      // task comes back.
-      ld_check(read_storage_tasks_in_flight_ > 0);
+      // task comes back. If none is in flight, MemoryGovernor must have
+      // lowered the limit and will call onMemoryBudgetUpdated() again.
+      ld_check(read_storage_tasks_in_flight_ > 0 ||
+               settings_->read_storage_tasks_mem_rebalance_interval.count() >
+                   0);
       return;
     }
     read_storage_tasks_in_flight_++;
@@ -669,12 +770,26 @@ void AllServerReadStreams::putStorageTask(
     // in that queue each time another task already in flight comes back.
     delayed_read_storage_tasks_.push(QueuedTask{std::move(task), shard});
     STAT_INCR(stats_, read_storage_tasks_delayed);
+    ++memory_stalls_;
   } else {
     read_storage_tasks_in_flight_++;
     sendStorageTask(std::move(task), shard);
   }
 }
 
+bool AllServerReadStreams::tryPutPrefetchStorageTask(
+    std::unique_ptr<ReadStorageTask>& task,
+    shard_index_t shard) {
+  ld_check(task->is_prefetch_);
+  if (!delayed_read_storage_tasks_.empty() || !tryAcquireMemoryForTask(task)) {
+    // Memory is needed for regular reads.
+    return false;
+  }
+  read_storage_tasks_in_flight_++;
+  sendStorageTask(std::move(task), shard);
+  return true;
+}
+
 void AllServerReadStreams::sendStorageTask(
     std::unique_ptr<ReadStorageTask>&& task,
     shard_index_t shard) {
@@ -699,11 +814,16 @@ void AllServerReadStreams::appendReleasedRecords(
     // RecordCacheDisposal::onRecordsReleased() returning a bitset of workers to
     // follow up on.
     std::unique_ptr<Request> request = std::make_unique<EvictRealTimeRequest>();
-    processor_->postRequest(request, WorkerType::GENERAL, worker_id_.val());
+    processor_->postRequest(request, worker_type_, worker_id_.val());
   }
 }
 
 void AllServerReadStreams::evictRealTime() {
+  if (real_time_record_buffer_.overEvictionThreshold()) {
+    distributeNewlyReleasedRecords();
+    evictUnreadRealTimeRecords();
+  }
+
   while (real_time_record_buffer_.overEvictionThreshold()) {
     distributeNewlyReleasedRecords();
 
@@ -727,6 +847,37 @@ void AllServerReadStreams::evictRealTimeLog(logid_t logid) {
   }
 }
 
+void AllServerReadStreams::evictUnreadRealTimeRecords() {
+  const std::vector<logid_t> candidates =
+      real_time_record_buffer_.leastRecentlyUsed(
+          settings_->real_time_eviction_candidate_logs);
+
+  for (logid_t logid : candidates) {
+    size_t tailing_readers = 0;
+    auto range = streams_.get<LogIndex>().equal_range(logid);
+    for (auto it = range.first; it != range.second; ++it) {
+      if ((*it)->canReadFromReleasedRecords()) {
+        ++tailing_readers;
+        continue;
+      }
+      auto recs{(*it)->giveReleasedRecords()};
+      STAT_ADD(stats_, real_time_record_buffer_unread_eviction, recs.size());
+      // The shared_ptr to ReleasedRecords will be destroyed here, freeing the
+      // records unless a tailing reader still holds them.
+    }
+    if (tailing_readers > 0) {
+      // We'll evict the log's records from the tailing readers too if we get
+      // to it in the LRU order.
+      ld_spew("Real time reads: log %s has %lu tailing readers",
+              toString(logid).c_str(),
+              tailing_readers);
+    }
+    if (!real_time_record_buffer_.overEvictionThreshold()) {
+      break;
+    }
+  }
+}
+
 void AllServerReadStreams::onShardStatusChanged() {
   for (const auto& client_state : client_states_) {
     sendShardStatusToClient(client_state.first);
@@ -24,8 +24,10 @@
 #include "logdevice/common/ResourceBudget.h"
 #include "logdevice/common/ShardAuthoritativeStatusMap.h"
 #include "logdevice/common/SocketCallback.h"
+#include "logdevice/common/WorkerType.h"
 #include "logdevice/common/protocol/STARTED_Message.h"
 #include "logdevice/common/protocol/STOP_Message.h"
+#include "logdevice/common/protocol/WINDOWS_Message.h"
 #include "logdevice/common/protocol/WINDOW_Message.h"
 #include "logdevice/common/settings/Settings.h"
 #include "logdevice/common/settings/UpdateableSettings.h"
@@ -47,8 +49,10 @@ namespace facebook { namespace logdevice {
  */
 
 class EpochOffsetStorageTask;
+class IteratorPool;
 class ReadStorageTask;
 class RECORD_Message;
+class RECORDS_Message;
 class StatsHolder;
 class ServerProcessor;
 class Worker;
@@ -69,6 +73,8 @@ class AllServerReadStreams : public ShardAuthoritativeStatusSubscriber {
    *                                         stats.
    * @param on_worker_thread                 True if all methods will be called
    *                                         on a worker thread.
+   * @param worker_type                      pool of the worker we are running
+   *                                         on, GENERAL or READ
    */
   AllServerReadStreams(UpdateableSettings<Settings> settings,
                        size_t max_read_storage_tasks_mem,
@@ -76,7 +82,8 @@ class AllServerReadStreams : public ShardAuthoritativeStatusSubscriber {
                        LogStorageStateMap* log_storage_state_map,
                        ServerProcessor* processor,
                        StatsHolder* stats = nullptr,
-                       bool on_worker_thread = true);
+                       bool on_worker_thread = true,
+                       WorkerType worker_type = WorkerType::GENERAL);
 
   AllServerReadStreams(const AllServerReadStreams&) = delete;
   AllServerReadStreams& operator=(const AllServerReadStreams&) = delete;
@@ -173,6 +180,13 @@ class AllServerReadStreams : public ShardAuthoritativeStatusSubscriber {
                     const RECORD_Message& msg,
                     const SteadyTimestamp enqueue_time);
 
+  /**
+   * Same as onRecordSent(), for a RECORDS message.
+   */
+  void onRecordsSent(ClientID client_id,
+                     const RECORDS_Message& msg,
+                     const SteadyTimestamp enqueue_time);
+
   /**
    * Called when the messaging layer drains a STARTED message from the output
    * evbuffer.
@@ -198,6 +212,12 @@ class AllServerReadStreams : public ShardAuthoritativeStatusSubscriber {
    */
   void onReadTaskDropped(ReadStorageTask& task);
 
+  /**
+   * Called when a prefetch ReadStorageTask that was not adopted by its stream
+   * comes back. Stores the records in the stream's prefetched batch.
+   */
+  void onPrefetchTaskDone(ReadStorageTask& task);
+
   /**
    * Static handler for incoming WINDOW messages.  Validates a bit then calls
    * the instance method on the current Worker's AllServerReadStreams
@@ -206,6 +226,13 @@ class AllServerReadStreams : public ShardAuthoritativeStatusSubscriber {
   static Message::Disposition onWindowMessage(WINDOW_Message* msg,
                                               const Address& from);
 
+  /**
+   * Static handler for incoming WINDOWS messages. Handles every entry as if it
+   * had been received in its own WINDOW message.
+   */
+  static Message::Disposition onWindowsMessage(WINDOWS_Message* msg,
+                                               const Address& from);
+
   /**
    * Called when a WINDOW message is received from a client.  Looks up the
    * relevant ServerReadStream and updates its window, switching it to the
@@ -257,6 +284,7 @@ class AllServerReadStreams : public ShardAuthoritativeStatusSubscriber {
 
     streams_.clear();
     client_states_.clear();
+    iterator_pools_.clear();
     // Free all released records that we didn't get around to sending.
     // This moves EpochRecordCacheEntrys to various workers, so
     // must be run before the Worker::~Worker() is called.
@@ -278,6 +306,14 @@ class AllServerReadStreams : public ShardAuthoritativeStatusSubscriber {
   void putStorageTask(std::unique_ptr<ReadStorageTask>&& task,
                       shard_index_t shard);
 
+  /**
+   * Like putStorageTask(), but for a prefetch task, which is not worth
+   * delaying: if the task can't be sent right away because memory for it
+   * can't be budgeted, does nothing and returns false.
+   */
+  bool tryPutPrefetchStorageTask(std::unique_ptr<ReadStorageTask>& task,
+                                 shard_index_t shard);
+
   /**
    * Adjust the memory budget for read storage tasks (called by Worker when
    * settings are updated).
@@ -288,6 +324,22 @@ class AllServerReadStreams : public ShardAuthoritativeStatusSubscriber {
 
   ResourceBudget& getMemoryBudget();
 
+  /**
+   * Called after the limit of the memory budget was changed by
+   * MemoryGovernor. Sends the delayed storage tasks that fit now.
+   */
+  void onMemoryBudgetUpdated() {
+    sendDelayedReadStorageTasks();
+  }
+
+  /**
+   * Returns the number of storage tasks delayed for lack of memory since the
+   * last call.
+   */
+  uint64_t takeMemoryStalls() {
+    return std::exchange(memory_stalls_, 0);
+  }
+
   RealTimeRecordBuffer& getRealTimeRecordBuffer() {
     return real_time_record_buffer_;
   }
@@ -435,6 +487,12 @@ class AllServerReadStreams : public ShardAuthoritativeStatusSubscriber {
 
   RealTimeRecordBuffer real_time_record_buffer_;
 
+  // Iterators shared by the read streams of each (log, shard) if
+  // Settings::share_read_iterators is enabled. Entries are removed when the
+  // last stream of the log goes away.
+  std::map<std::pair<logid_t, shard_index_t>, std::shared_ptr<IteratorPool>>
+      iterator_pools_;
+
   /**
    * Retrieve a ServerReadStream behind an iterator. boost::multi_index does not
    * allow retrieving a non const ServerReadStream because modifying its
@@ -452,6 +510,14 @@ class AllServerReadStreams : public ShardAuthoritativeStatusSubscriber {
    */
   void evictRealTimeLog(logid_t);
 
+  /**
+   * Looks at the least recently used logs of the real time buffer and drops
+   * buffered records from the read streams that can't read them (see
+   * ServerReadStream::canReadFromReleasedRecords()), so that records nobody is
+   * tailing get evicted before the working set of logs with tailing readers.
+   */
+  void evictUnreadRealTimeRecords();
+
   /**
    * Wake up all the read streams for which `pred` returns true in the specified
    * range.
@@ -537,10 +603,16 @@ class AllServerReadStreams : public ShardAuthoritativeStatusSubscriber {
   };
   std::queue<QueuedTask> delayed_read_storage_tasks_;
 
+  // Number of tasks put in delayed_read_storage_tasks_ since the last
+  // takeMemoryStalls().
+  uint64_t memory_stalls_{0};
+
   // Worker ID we are on, used to manage subscriptions for RELEASE messages.
   // In production, this is always equal to Worker::onThisThread()->idx_.  In
   // unit tests where there is no Worker, the test supplies a fake value.
   const worker_id_t worker_id_;
+  // Pool of that worker. Subscriptions are per pool.
+  const WorkerType worker_type_;
 
   // LogStorageStateMap instance to talk to to subscribe or unsubscribe from
   // RELEASE messages for a log.  Unowned.
@@ -23,11 +23,13 @@
 #include "logdevice/common/Sender.h"
 #include "logdevice/common/ServerRecordFilter.h"
 #include "logdevice/common/protocol/GAP_Message.h"
+#include "logdevice/common/protocol/RECORDS_Message.h"
 #include "logdevice/common/protocol/RECORD_Message.h"
 #include "logdevice/common/protocol/STARTED_Message.h"
 #include "logdevice/common/stats/Histogram.h"
 #include "logdevice/common/stats/ServerHistograms.h"
 #include "logdevice/common/stats/Stats.h"
+#include "logdevice/common/util.h"
 #include "logdevice/include/Record.h"
 #include "logdevice/server/EpochRecordCache.h"
 #include "logdevice/server/IOFaultInjection.h"
@@ -169,6 +171,20 @@ class ReadingCallback : public LocalLogStoreReader::Callback {
 
   int processRecord(const RawRecord& record) override;
 
+  // Makes the next processRecord() call for `record` hand the record's blob
+  // over to the RECORD message if the blob is owned by `record`, instead of
+  // copying the payload out of it.
+  void setStealableRecord(RawRecord* record) {
+    stealable_record_ = record;
+  }
+
+  // Makes the next processRecord() call, whose payload must point into
+  // `record`'s payload, attach the payload to the RECORD message by reference
+  // to `record` instead of copying it.
+  void setSharedRecord(std::shared_ptr<ZeroCopiedRecord> record) {
+    shared_record_ = std::move(record);
+  }
+
   int nrecords_ = 0;
 
   int processRecord(const lsn_t lsn,
@@ -180,7 +196,8 @@ class ReadingCallback : public LocalLogStoreReader::Callback {
                     const esn_t last_known_good,
                     const copyset_size_t copyset_size,
                     const ShardID* const copyset,
-                    const uint64_t offset_within_epoch);
+                    const uint64_t offset_within_epoch,
+                    const bool filtered_by_reader = false);
 
  private:
   // Sends a RECORD_Message for the given record over the wire
@@ -208,11 +225,30 @@ class ReadingCallback : public LocalLogStoreReader::Callback {
   LocalLogStore* store_;
   ServerReadStream::RecordSource source_;
   CatchupEventTrigger catchup_reason_;
+  RawRecord* stealable_record_ = nullptr;
+  std::shared_ptr<ZeroCopiedRecord> shared_record_;
 };
 
 int ReadingCallback::processRecord(const RawRecord& record) {
   const lsn_t lsn = record.lsn;
 
+  if (record.filtered_out) {
+    // LocalLogStoreReader already evaluated filter_pred_ on the record's key
+    // and didn't pass the rest of the record along. See RawRecord.
+    stream_->in_under_replicated_region_ |= record.from_under_replicated_region;
+    return processRecord(lsn,
+                         std::chrono::milliseconds(0),
+                         0,
+                         {},
+                         Payload(),
+                         0,
+                         ESN_INVALID,
+                         0,
+                         nullptr,
+                         BYTE_OFFSET_INVALID,
+                         /* filtered_by_reader */ true);
+  }
+
   // Parse the local log store blob
   std::chrono::milliseconds timestamp;
   Payload payload;
@@ -288,16 +324,17 @@ int ReadingCallback::processRecord(
     const esn_t last_known_good,
     const copyset_size_t copyset_size,
     const ShardID* const copyset,
-    const uint64_t offset_within_epoch) {
+    const uint64_t offset_within_epoch,
+    const bool filtered_by_reader) {
   ld_check(lsn > stream_->last_delivered_lsn_);
 
   // [Experimental Feature] If server-side filtering is enabled, we should
   // do filtering here. If record key can not pass record filter,
   // filtered_out will be set to be true. A gap message with reason
   // FILTERED_OUT will be sent to client-side.
-  bool filtered_out = false;
+  bool filtered_out = filtered_by_reader;
 
-  if (stream_->filter_pred_ != nullptr &&
+  if (!filtered_out && stream_->filter_pred_ != nullptr &&
       (flags & LocalLogStoreRecordFormat::FLAG_OPTIONAL_KEYS)) {
     const auto it = optional_keys.find(KeyType::FILTERABLE);
     if (it != optional_keys.end()) {
@@ -350,14 +387,14 @@ int ReadingCallback::processRecord(
   ld_check(!(flags & LocalLogStoreRecordFormat::FLAG_AMEND));
 
   std::unique_ptr<ExtraMetadata> extra_metadata;
-  if (stream_->include_extra_metadata_) {
+  if (stream_->include_extra_metadata_ && !filtered_out) {
     DCHECK_NOTNULL(copyset);
     extra_metadata = this->prepareExtraMetadata(
         last_known_good, wave, copyset, copyset_size, offset_within_epoch);
   }
 
   uint64_t byte_offset = BYTE_OFFSET_INVALID;
-  if (stream_->include_byte_offset_ &&
+  if (stream_->include_byte_offset_ && !filtered_out &&
       offset_within_epoch != BYTE_OFFSET_INVALID) {
     // epoch byte offset value has to be know to determine global offset.
     uint64_t epoch_offset = getEpochOffset(lsn_to_epoch(lsn), log_state);
@@ -453,6 +490,16 @@ uint64_t ReadingCallback::getEpochOffset(epoch_t record_epoch,
     return epoch_offset_from_metadata.value().second;
   }
 
+  // Another read stream of this log may have already read it from
+  // PerEpochLogMetadata.
+  folly::Optional<uint64_t> cached_offset =
+      log_state.getCachedEpochOffset(record_epoch);
+  if (cached_offset.hasValue()) {
+    STAT_INCR(catchup_->deps_.getStatsHolder(), epoch_offset_cache_hits);
+    stream_->epoch_offset_ = std::make_pair(record_epoch, *cached_offset);
+    return *cached_offset;
+  }
+
   // PerEpochLogMetadata is written on node after epoch recovery.
   // So, PerEpochLogMetadata for record_epoch is already stored on node if
   // record_epoch is not active epoch which sequencer use.
@@ -472,6 +519,8 @@ uint64_t ReadingCallback::getEpochOffset(epoch_t record_epoch,
                                              false,  // find_last_available
                                              false); // allow_blocking_io
     if (rv == 0) {
+      log_state.cacheEpochOffset(
+          record_epoch, metadata.header_.epoch_end_offset);
       return metadata.header_.epoch_end_offset;
     } else if (rv != 0 && err == E::LOCAL_LOG_STORE_READ) {
       ld_error("Error while reading PerEpochLogMetadata for epoch %u",
@@ -494,8 +543,10 @@ uint64_t ReadingCallback::getEpochOffset(epoch_t record_epoch,
                                                false,  // find_last_available
                                                false); // allow_blocking_io
       if (rv == 0) {
-        return metadata_.header_.epoch_end_offset -
-            metadata_.header_.epoch_size;
+        const uint64_t offset =
+            metadata_.header_.epoch_end_offset - metadata_.header_.epoch_size;
+        log_state.cacheEpochOffset(record_epoch, offset);
+        return offset;
       }
       ld_check(rv == -1);
       if (err == E::NOTFOUND) {
@@ -568,6 +619,9 @@ int ReadingCallback::shipRecord(lsn_t lsn,
     wire_flags |= RECORD_Header::UNDER_REPLICATED_REGION;
   }
 
+  void* payload_buffer = nullptr;
+  // Only ever used for the record it was set for.
+  std::shared_ptr<ZeroCopiedRecord> shared_record = std::move(shared_record_);
   RECORD_Header header = {stream_->log_id_,
                           stream_->id_,
                           lsn,
@@ -575,6 +629,26 @@ int ReadingCallback::shipRecord(lsn_t lsn,
                           wire_flags,
                           stream_->shard_};
 
+  const Settings& settings = catchup_->deps_.getSettings();
+  Payload compressed;
+  if (stream_->accepts_compressed_records_ &&
+      settings.record_compression != Compression::NONE &&
+      payload.size() >= settings.record_compression_min_bytes &&
+      !(header.flags & RECORD_Header::BUFFERED_WRITER_BLOB) &&
+      !stream_->no_payload_ && !stream_->csi_data_only_ &&
+      !stream_->payload_hash_only_) {
+    // The checksum stays in front of the compressed bytes, where the client
+    // expects it.
+    size_t checksum_sz = 0;
+    if (header.flags & RECORD_Header::CHECKSUM) {
+      checksum_sz = header.flags & RECORD_Header::CHECKSUM_64BIT ? 8 : 4;
+    }
+    if (payload.size() >= checksum_sz) {
+      compressed = RECORD_Message::compressPayload(
+          payload, checksum_sz, settings.record_compression);
+    }
+  }
+
   if (stream_->no_payload_ || stream_->csi_data_only_) {
     payload = Payload(nullptr, 0);
     // Clear checksum flags if we don't ship payload
@@ -610,6 +684,42 @@ int ReadingCallback::shipRecord(lsn_t lsn,
     h.length = static_cast<uint32_t>(payload.size());
     h.hash = checksum_32bit(Slice(payload));
     payload = Payload(&h, sizeof(h)).dup();
+    // The message owns this copy, it must not be attached to a shared record.
+    shared_record.reset();
+  } else if (compressed.data()) {
+    // The compressed copy is malloc-d and owned by the message.
+    STAT_INCR(catchup_->deps_.getStatsHolder(), record_payloads_compressed);
+    STAT_ADD(catchup_->deps_.getStatsHolder(),
+             record_payload_bytes_saved_by_compression,
+             payload.size() - compressed.size());
+    payload = compressed;
+    header.flags |= RECORD_Header::COMPRESSED;
+    shared_record.reset();
+  } else if (stealable_record_ && stealable_record_->owned &&
+             settings.zero_copy_record_payloads) {
+    // The payload points into a blob malloc-d by the storage thread, and the
+    // blob isn't needed after this. Give it to the message instead of making
+    // a copy.
+    ld_check(!payload.data() ||
+             ((const char*)payload.data() >=
+                  (const char*)stealable_record_->blob.data &&
+              (const char*)payload.data() + payload.size() <=
+                  (const char*)stealable_record_->blob.data +
+                      stealable_record_->blob.size));
+    payload_buffer = const_cast<void*>(stealable_record_->blob.data);
+    stealable_record_->owned = false;
+    STAT_INCR(catchup_->deps_.getStatsHolder(), record_payloads_zero_copied);
+  } else if (shared_record) {
+    // The payload lives in a record of the real-time buffer, which is
+    // immutable and ref counted. Every stream tailing the log attaches the
+    // same copy of the payload to its RECORD message.
+    ld_check(!payload.data() ||
+             ((const char*)payload.data() >=
+                  (const char*)shared_record->payload_raw.data &&
+              (const char*)payload.data() + payload.size() <=
+                  (const char*)shared_record->payload_raw.data +
+                      shared_record->payload_raw.size));
+    STAT_INCR(catchup_->deps_.getStatsHolder(), record_payloads_shared);
   } else {
     // Make private copy of the data so it is stable for the lifetime of
     // the, possibly deferred on transmission, RECORD message.
@@ -632,6 +742,10 @@ int ReadingCallback::shipRecord(lsn_t lsn,
                                        RECORD_Message::Source::LOCAL_LOG_STORE,
                                        byte_offset,
                                        stream_->log_group_path_);
+  msg->payload_buffer_ = payload_buffer;
+  if (shared_record) {
+    msg->payload_owner_ = std::move(shared_record);
+  }
 
   if (lsn <= stream_->last_delivered_lsn_) {
     RATELIMIT_CRITICAL(std::chrono::seconds(10),
@@ -649,8 +763,18 @@ int ReadingCallback::shipRecord(lsn_t lsn,
   // Let the Sender deal with any traffic shaping induced deferral.
   // We don't want to have to read the data again just because traffic
   // shaping is pacing data.
-  int rv =
-      catchup_->deps_.sender_->sendMessage(std::move(msg), stream_->client_id_);
+  const bool batched = catchup_->canBatchRecord(msg_size);
+  int rv;
+  if (batched) {
+    rv = catchup_->addToRecordBatch(std::move(msg), msg_size);
+  } else {
+    // Records already batched must go out first.
+    rv = catchup_->flushRecordBatch();
+    if (rv == 0) {
+      rv = catchup_->deps_.sender_->sendMessage(
+          std::move(msg), stream_->client_id_);
+    }
+  }
 
   if (rv != 0) {
     ld_check(err != E::CBREGISTERED);
@@ -682,6 +806,10 @@ int ReadingCallback::shipRecord(lsn_t lsn,
     HISTOGRAM_ADD(Worker::stats(), write_to_read_latency, latency);
   }
 
+  if (batched) {
+    // Accounted for when the RECORDS message is sent.
+    return 0;
+  }
   size_t& bytes_queued = catchup_->record_bytes_queued_;
   ld_check(bytes_queued <= std::numeric_limits<size_t>::max() - msg_size);
   bytes_queued += msg_size;
@@ -711,7 +839,14 @@ CatchupOneStream::CatchupOneStream(CatchupQueueDependencies& deps,
     : deps_(deps),
       stream_(stream),
       resume_cb_(resume_cb),
-      record_bytes_queued_(0) {}
+      record_bytes_queued_(0),
+      record_batch_max_records_(
+          stream->proto_ >= Compatibility::RECORDS_MESSAGE_SUPPORT
+              ? deps.getSettings().record_batch_max_records
+              : 1),
+      record_batch_max_bytes_(
+          std::min(deps.getSettings().record_batch_max_bytes,
+                   size_t(MAX_PAYLOAD_SIZE_INTERNAL))) {}
 
 CatchupOneStream::Action
 CatchupOneStream::startRead(WeakRef<CatchupQueue> catchup_queue,
@@ -735,6 +870,22 @@ CatchupOneStream::startRead(WeakRef<CatchupQueue> catchup_queue,
     }
   }
 
+  max_record_bytes_queued = getReadBatchBytes(max_record_bytes_queued);
+
+  if (stream_->prefetched_batch_ && !stream_->prefetched_batch_->done) {
+    // The next batch is already being read. Wait for it as for a regular
+    // storage task; the stream mustn't use its iterator meanwhile.
+    if (!allow_storage_task) {
+      return Action::WOULDBLOCK;
+    }
+    stream_ld_debug(*stream_, "Waiting for prefetch task in flight");
+    ld_check(!stream_->storage_task_in_flight_);
+    stream_->prefetched_batch_->adopted = true;
+    stream_->storage_task_in_flight_ = true;
+    STAT_INCR(deps_.getStatsHolder(), read_prefetch_batches_waited_for);
+    return Action::WAIT_FOR_STORAGE_TASK;
+  }
+
   LogStorageState& log_state =
       deps_.getLogStorageStateMap().get(stream_->log_id_, stream_->shard_);
   LogStorageState::LastReleasedLSN last_released_lsn =
@@ -949,6 +1100,32 @@ CatchupOneStream::startRead(WeakRef<CatchupQueue> catchup_queue,
   STAT_INCR(deps_.getStatsHolder(), read_requests);
   ld_check_eq(record_bytes_queued_, 0);
 
+  if (stream_->prefetched_batch_) {
+    auto batch = std::move(stream_->prefetched_batch_);
+    ld_check(batch->done);
+    if (batch->version == stream_->version_ &&
+        batch->filter_version == stream_->filter_version_ &&
+        batch->start_lsn == stream_->getReadPtr().lsn) {
+      stream_ld_debug(*stream_,
+                      "Using %zu prefetched records",
+                      batch->records.size());
+      STAT_INCR(deps_.getStatsHolder(), read_prefetch_batches_used);
+      Action action = processRecords(batch->records,
+                                     batch->version,
+                                     batch->read_ptr,
+                                     batch->accessed_under_replicated_region,
+                                     batch->status,
+                                     batch->catchup_reason);
+      maybePrefetch(action,
+                    std::move(catchup_queue),
+                    batch->last_released_lsn,
+                    batch->catchup_reason);
+      return action;
+    }
+    // The stream moved on since the batch was read, e.g. it was rewound.
+    STAT_INCR(deps_.getStatsHolder(), read_prefetch_batches_discarded);
+  }
+
   // Create the read context.
   LocalLogStoreReader::ReadContext read_ctx =
       createReadContext(last_released,
@@ -991,9 +1168,13 @@ CatchupOneStream::startRead(WeakRef<CatchupQueue> catchup_queue,
     Action action = pushReleasedRecords(released_records, read_ctx);
     if (action != Action::NOT_IN_REAL_TIME_BUFFER) {
       deps_.used(stream_->log_id_);
+      WORKER_LOG_STAT_INCR(stream_->log_id_, real_time_reads_hit);
       return action;
     }
   }
+  if (deps_.getSettings().real_time_reads_enabled) {
+    WORKER_LOG_STAT_INCR(stream_->log_id_, real_time_reads_miss);
+  }
 
   if (try_non_blocking_read && !inject_latency) {
     // First try an immediate non-blocking read on the current worker
@@ -1028,6 +1209,8 @@ CatchupOneStream::Action CatchupOneStream::pushReleasedRecords(
                            stream_,
                            ServerReadStream::RecordSource::REAL_TIME,
                            read_ctx.catchup_reason_);
+  const bool share_payloads =
+      deps_.getSettings().share_real_time_record_payloads;
 
   int nrecords = 0;
   size_t bytes_delivered = 0;
@@ -1151,8 +1334,10 @@ CatchupOneStream::Action CatchupOneStream::pushReleasedRecords(
     }
 
     // The read ptr is within rec.  Consider each entry!
-    for (ZeroCopiedRecord* entry = rec->entries_.get(); entry != nullptr;
-         entry = entry->next_.get()) {
+    for (const std::shared_ptr<ZeroCopiedRecord>* entry_ptr = &rec->entries_;
+         *entry_ptr != nullptr;
+         entry_ptr = &(*entry_ptr)->next_) {
+      ZeroCopiedRecord* entry = entry_ptr->get();
       // Skip over already-delivered records
       if (entry->lsn < read_ctx.read_ptr_.lsn) {
         continue;
@@ -1185,6 +1370,9 @@ CatchupOneStream::Action CatchupOneStream::pushReleasedRecords(
 
       nrecords++;
 
+      if (share_payloads) {
+        callback.setSharedRecord(*entry_ptr);
+      }
       int rv = callback.processRecord(
           entry->lsn,
           std::chrono::milliseconds(entry->timestamp),
@@ -1220,7 +1408,8 @@ CatchupOneStream::Action CatchupOneStream::pushReleasedRecords(
         : E::UNTIL_LSN_REACHED;
   }
 
-  return handleBatchEnd(stream_->version_, status, read_ctx.read_ptr_);
+  return finishRecordBatch(
+      handleBatchEnd(stream_->version_, status, read_ctx.read_ptr_));
 }
 
 CatchupOneStream::Action
@@ -1258,6 +1447,9 @@ CatchupOneStream::readNonBlocking(WeakRef<CatchupQueue> /*catchup_queue*/,
                            ServerReadStream::RecordSource::NON_BLOCKING,
                            read_ctx.catchup_reason_);
   Status status = deps_.read(read_iterator.get(), callback, &read_ctx);
+  if (stream_->iterator_cache_) {
+    stream_->iterator_cache_->release(options);
+  }
 
   stream_ld_debug(*stream_,
                   "got %d records without blocking, status=%s",
@@ -1285,6 +1477,9 @@ CatchupOneStream::readNonBlocking(WeakRef<CatchupQueue> /*catchup_queue*/,
     // bytes queued, whereas all our tests of whether or not to send depend on
     // RECORD_Message::expectedSize(), which doesn't include rebuilding metadata
     // or byte_offset and is therefore an underestimate.
+    if (flushRecordBatch() != 0) {
+      return Action::TRANSIENT_ERROR;
+    }
     ld_check(read_ctx.max_bytes_to_deliver_ > record_bytes_queued_);
 
     // setting the read pointer from the read_ctx, so we don't read the same
@@ -1297,13 +1492,15 @@ CatchupOneStream::readNonBlocking(WeakRef<CatchupQueue> /*catchup_queue*/,
     return Action::WOULDBLOCK;
   }
 
-  return handleBatchEnd(stream_->version_, status, read_ctx.read_ptr_);
+  return finishRecordBatch(
+      handleBatchEnd(stream_->version_, status, read_ctx.read_ptr_));
 }
 
 void CatchupOneStream::readOnStorageThread(
     WeakRef<CatchupQueue> catchup_queue,
     LocalLogStoreReader::ReadContext& read_ctx,
-    bool inject_latency) {
+    bool inject_latency,
+    bool prefetch) {
   stream_ld_debug(*stream_,
                   "Reading from storage thread. "
                   "last_released=%s, max_record_bytes_queued=%lu, "
@@ -1353,6 +1550,26 @@ void CatchupOneStream::readOnStorageThread(
                                                      is_tailer,
                                                      client_address);
 
+  if (prefetch) {
+    task_uniq->is_prefetch_ = true;
+    if (!deps_.tryPutPrefetchStorageTask(task_uniq, stream_->shard_)) {
+      if (stream_->iterator_cache_) {
+        stream_->iterator_cache_->release(options);
+      }
+      STAT_INCR(deps_.getStatsHolder(), read_prefetch_no_memory);
+      return;
+    }
+    auto batch = std::make_unique<ServerReadStream::PrefetchedBatch>();
+    batch->version = stream_->version_;
+    batch->filter_version = stream_->filter_version_;
+    batch->start_lsn = read_ctx.read_ptr_.lsn;
+    batch->last_released_lsn = read_ctx.last_released_lsn_;
+    batch->catchup_reason = read_ctx.catchup_reason_;
+    stream_->prefetched_batch_ = std::move(batch);
+    STAT_INCR(deps_.getStatsHolder(), read_prefetch_tasks);
+    return;
+  }
+
   deps_.putStorageTask(std::move(task_uniq), stream_->shard_);
   STAT_INCR(deps_.getStatsHolder(), read_requests_to_storage);
 
@@ -1377,6 +1594,8 @@ CatchupOneStream::read(CatchupQueueDependencies& deps,
                                     first_record_any_size,
                                     allow_storage_task,
                                     catchup_reason);
+  ld_check(catchup.record_batch_.empty());
+  stream->batch_sizing_.sample_bytes += catchup.record_bytes_queued_;
   return std::make_pair(action, catchup.record_bytes_queued_);
 }
 
@@ -1387,6 +1606,8 @@ CatchupOneStream::onReadTaskDone(CatchupQueueDependencies& deps,
   auto& resume_cb = task.catchup_queue_->resumeCallback();
   CatchupOneStream catchup(deps, stream, resume_cb);
   Action action = catchup.processTask(task);
+  ld_check(catchup.record_batch_.empty());
+  stream->batch_sizing_.sample_bytes += catchup.record_bytes_queued_;
   return std::make_pair(action, catchup.record_bytes_queued_);
 }
 
@@ -1403,6 +1624,21 @@ CatchupOneStream::processTask(const ReadStorageTask& task) {
       task.owned_iterator_ && // May be null in tests.
       task.owned_iterator_->accessedUnderReplicatedRegion();
 
+  if (deps_.getSettings().adaptive_read_batch_size) {
+    // Smoothed like the send rate, see getReadBatchBytes().
+    double usec = usec_since(task.enqueue_time_);
+    auto& sizing = stream_->batch_sizing_;
+    sizing.storage_task_usec = sizing.storage_task_usec == 0
+        ? usec
+        : sizing.storage_task_usec * 0.75 + usec * 0.25;
+  }
+
+  if (task.is_prefetch_) {
+    // The stream was waiting for this prefetch task, see startRead().
+    ld_check(stream_->prefetched_batch_ && stream_->prefetched_batch_->adopted);
+    stream_->prefetched_batch_.reset();
+  }
+
   if (stream_->iterator_cache_ &&
       !stream_->iterator_cache_->valid(task.options_)) {
     // We don't have an iterator in cache, either because it was the first
@@ -1412,6 +1648,10 @@ CatchupOneStream::processTask(const ReadStorageTask& task) {
     stream_->iterator_cache_->set(
         task.options_, std::move(task.owned_iterator_));
   }
+  if (stream_->iterator_cache_) {
+    // The task is done with the iterator, others can use it now.
+    stream_->iterator_cache_->release(task.options_);
+  }
 
   // The filter version at the time the task was created is not the same as the
   // current filter version. We must not send the records and do nothing
@@ -1426,12 +1666,48 @@ CatchupOneStream::processTask(const ReadStorageTask& task) {
 
   LocalLogStoreReader::ReadPointer read_ptr = task.read_ctx_.read_ptr_;
 
-  return processRecords(task.records_,
-                        task.server_read_stream_version_,
-                        read_ptr,
-                        accessed_under_replicated_region,
-                        task.status_,
-                        task.read_ctx_.catchup_reason_);
+  Action action = processRecords(task.records_,
+                                 task.server_read_stream_version_,
+                                 read_ptr,
+                                 accessed_under_replicated_region,
+                                 task.status_,
+                                 task.read_ctx_.catchup_reason_);
+  maybePrefetch(action,
+                task.catchup_queue_,
+                task.read_ctx_.last_released_lsn_,
+                task.read_ctx_.catchup_reason_);
+  return action;
+}
+
+void CatchupOneStream::maybePrefetch(Action action,
+                                     WeakRef<CatchupQueue> catchup_queue,
+                                     lsn_t last_released_lsn,
+                                     CatchupEventTrigger catchup_reason) {
+  // Only prefetch if the batch stopped because of the limit on bytes queued
+  // in the output evbuffer, i.e. the stream will read more once the records
+  // are sent. Tailing streams are served from memory anyway.
+  if (action != Action::REQUEUE_AND_DRAIN ||
+      !deps_.getSettings().prefetch_backlog_reads ||
+      stream_->trafficClass() != TrafficClass::READ_BACKLOG ||
+      stream_->prefetched_batch_ || stream_->storage_task_in_flight_ ||
+      !catchup_queue) {
+    return;
+  }
+  if (stream_->getReadPtr().lsn > last_released_lsn ||
+      stream_->getReadPtr().lsn > stream_->until_lsn_ ||
+      stream_->isPastWindow()) {
+    return;
+  }
+
+  LocalLogStoreReader::ReadContext read_ctx = createReadContext(
+      last_released_lsn,
+      deps_.getMaxRecordBytesQueued(stream_->client_id_),
+      true, // first_record_any_size: the output evbuffer will be empty
+      catchup_reason);
+  readOnStorageThread(std::move(catchup_queue),
+                      read_ctx,
+                      false, // inject_latency
+                      true); // prefetch
 }
 
 int CatchupOneStream::sendStarted(
@@ -1584,7 +1860,7 @@ int CatchupOneStream::sendGapFilteredOutIfNeeded(
 }
 
 CatchupOneStream::Action CatchupOneStream::processRecords(
-    const std::vector<RawRecord>& records,
+    std::vector<RawRecord>& records,
     server_read_stream_version_t version,
     const LocalLogStoreReader::ReadPointer& read_ptr,
     bool accessed_under_replicated_region,
@@ -1594,7 +1870,8 @@ CatchupOneStream::Action CatchupOneStream::processRecords(
   // in the non-blocking read path.
   ReadingCallback callback(
       this, stream_, ServerReadStream::RecordSource::BLOCKING, catchup_reason);
-  for (const RawRecord& record : records) {
+  for (RawRecord& record : records) {
+    callback.setStealableRecord(&record);
     if (callback.processRecord(record) != 0) {
       ld_check(err != E::CBREGISTERED);
       stream_ld_debug(*stream_,
@@ -1608,7 +1885,7 @@ CatchupOneStream::Action CatchupOneStream::processRecords(
   stream_->last_batch_status_ = status;
   stream_->in_under_replicated_region_ = accessed_under_replicated_region;
 
-  return handleBatchEnd(version, status, read_ptr);
+  return finishRecordBatch(handleBatchEnd(version, status, read_ptr));
 }
 
 CatchupOneStream::Action CatchupOneStream::handleBatchEnd(
@@ -1776,8 +2053,10 @@ int CatchupOneStream::sendGAP(lsn_t end_lsn,
                        toString(*stream_).c_str());
   }
 
-  const int rv =
-      deps_.sender_->sendMessage(std::move(message), stream_->client_id_);
+  // If records are pending, the gap goes in the same RECORDS message.
+  const int rv = record_batch_.empty()
+      ? deps_.sender_->sendMessage(std::move(message), stream_->client_id_)
+      : flushRecordBatch(std::move(message));
   if (rv == 0) {
     ld_check(end_lsn > stream_->last_delivered_lsn_ ||
              stream_->need_to_deliver_lsn_zero_);
@@ -1794,6 +2073,135 @@ int CatchupOneStream::sendGAP(lsn_t end_lsn,
   return rv;
 }
 
+bool CatchupOneStream::canBatchRecord(size_t msg_size) const {
+  return record_batch_max_records_ > 1 && msg_size <= record_batch_max_bytes_;
+}
+
+int CatchupOneStream::addToRecordBatch(std::unique_ptr<RECORD_Message> msg,
+                                       size_t msg_size) {
+  if (!record_batch_.empty() &&
+      (record_batch_.size() >= record_batch_max_records_ ||
+       record_batch_bytes_ + msg_size > record_batch_max_bytes_) &&
+      flushRecordBatch() != 0) {
+    return -1;
+  }
+  if (record_batch_.empty()) {
+    record_batch_rollback_ = {stream_->last_delivered_lsn_,
+                              stream_->last_delivered_record_,
+                              stream_->getReadPtr(),
+                              stream_->filtered_out_end_lsn_};
+  }
+  record_batch_.push_back(std::move(msg));
+  record_batch_bytes_ += msg_size;
+  return 0;
+}
+
+int CatchupOneStream::flushRecordBatch(std::unique_ptr<GAP_Message> gap) {
+  if (record_batch_.empty()) {
+    ld_check(!gap);
+    return 0;
+  }
+
+  std::unique_ptr<Message> msg;
+  if (record_batch_.size() == 1 && !gap) {
+    // A RECORDS message would only add overhead.
+    msg = std::move(record_batch_.front());
+  } else {
+    msg = std::make_unique<RECORDS_Message>(stream_->log_id_,
+                                            stream_->id_,
+                                            stream_->shard_,
+                                            stream_->trafficClass(),
+                                            std::move(record_batch_),
+                                            std::move(gap));
+  }
+  record_batch_.clear();
+  record_batch_bytes_ = 0;
+
+  const auto msg_size = msg->size();
+  int rv = deps_.sender_->sendMessage(std::move(msg), stream_->client_id_);
+  if (rv != 0) {
+    stream_ld_debug(*stream_,
+                    "Failed to send batched records, err=%s. Rewinding to %s.",
+                    error_description(err),
+                    lsn_to_string(record_batch_rollback_.read_ptr.lsn).c_str());
+    ld_check(!stream_->storage_task_in_flight_);
+    stream_->last_delivered_lsn_ = record_batch_rollback_.last_delivered_lsn;
+    stream_->last_delivered_record_ =
+        record_batch_rollback_.last_delivered_record;
+    stream_->filtered_out_end_lsn_ =
+        record_batch_rollback_.filtered_out_end_lsn;
+    stream_->setReadPtr(record_batch_rollback_.read_ptr);
+    return -1;
+  }
+
+  ld_check(record_bytes_queued_ <=
+           std::numeric_limits<size_t>::max() - msg_size);
+  record_bytes_queued_ += msg_size;
+  ld_spew("records of log %lu queued, record_bytes_queued_ = %zu",
+          stream_->log_id_.val_,
+          record_bytes_queued_);
+  return 0;
+}
+
+CatchupOneStream::Action CatchupOneStream::finishRecordBatch(Action action) {
+  if (flushRecordBatch() != 0 && action != Action::PERMANENT_ERROR) {
+    return Action::TRANSIENT_ERROR;
+  }
+  return action;
+}
+
+size_t CatchupOneStream::getReadBatchBytes(size_t max_record_bytes_queued) {
+  const Settings& settings = deps_.getSettings();
+  if (!settings.adaptive_read_batch_size) {
+    return max_record_bytes_queued;
+  }
+  auto& sizing = stream_->batch_sizing_;
+
+  // The send rate is measured over periods of at least this long, so that a
+  // couple of batches queued back to back don't look like a huge rate.
+  static constexpr auto min_sample_period = std::chrono::milliseconds(10);
+  const SteadyTimestamp now = SteadyTimestamp::now();
+  if (sizing.sample_start == SteadyTimestamp::min()) {
+    sizing.sample_start = now;
+    sizing.sample_bytes = 0;
+  } else if (now - sizing.sample_start >= min_sample_period) {
+    double sec = std::chrono::duration_cast<std::chrono::duration<double>>(
+                     now - sizing.sample_start)
+                     .count();
+    double rate = sizing.sample_bytes / sec;
+    sizing.send_rate = sizing.send_rate * 0.75 + rate * 0.25;
+    sizing.sample_start = now;
+    sizing.sample_bytes = 0;
+  }
+
+  const size_t max_bytes = deps_.getMaxRecordBytesQueued(stream_->client_id_);
+  const size_t min_bytes =
+      std::min(settings.adaptive_read_batch_min_kb * 1024, max_bytes);
+  if (sizing.batch_bytes == 0) {
+    sizing.batch_bytes = max_bytes;
+  } else if (deps_.getBytesPendingForClient(stream_->client_id_) >=
+             max_bytes) {
+    // The client isn't consuming what we already sent. Reading more now would
+    // only make it wait in memory.
+    sizing.batch_bytes /= 2;
+  } else {
+    sizing.batch_bytes *= 2;
+  }
+
+  // While a storage task of this stream is queued or executing, the client
+  // keeps consuming the previous batch at about send_rate. Make sure that
+  // batch lasts that long.
+  size_t lower_bound = std::max<size_t>(
+      min_bytes,
+      std::min<size_t>(
+          sizing.send_rate * sizing.storage_task_usec / 1e6, max_bytes));
+  sizing.batch_bytes =
+      std::min(std::max(sizing.batch_bytes, lower_bound), max_bytes);
+
+  HISTOGRAM_ADD(deps_.getStatsHolder(), read_batch_size, sizing.batch_bytes);
+  return std::min(sizing.batch_bytes, max_record_bytes_queued);
+}
+
 LocalLogStoreReader::ReadContext
 CatchupOneStream::createReadContext(lsn_t last_released_lsn,
                                     size_t max_record_bytes_queued,
@@ -1831,6 +2239,7 @@ CatchupOneStream::createReadContext(lsn_t last_released_lsn,
                                             false, // is_rebuilding
                                             std::move(filter),
                                             catchup_reason);
+  read_ctx.record_filter_ = stream_->filter_pred_;
 
   return read_ctx;
 }
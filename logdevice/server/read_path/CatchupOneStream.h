@@ -7,9 +7,13 @@
  */
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "logdevice/common/WeakRefHolder.h"
+#include "logdevice/common/protocol/GAP_Message.h"
+#include "logdevice/common/protocol/RECORD_Message.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/include/EnumMap.h"
 #include "logdevice/include/Err.h"
@@ -178,7 +182,10 @@ class CatchupOneStream {
 
   Action processTask(const ReadStorageTask& task);
 
-  Action processRecords(const std::vector<RawRecord>& records,
+  // If the records own their blobs (they were copied by a storage thread),
+  // RECORD messages may take ownership of them, see
+  // Settings::zero_copy_record_payloads.
+  Action processRecords(std::vector<RawRecord>& records,
                         server_read_stream_version_t version,
                         const LocalLogStoreReader::ReadPointer& read_ptr,
                         bool accessed_under_replicated_region,
@@ -211,10 +218,26 @@ class CatchupOneStream {
    *                        max_record_bytes_queued as well as
    *                        first_record_any_size (See read()).
    * @param inject_latency  whether to simulate slow reads by injecting latency
+   * @param prefetch        if true, the task reads the next batch ahead of time
+   *                        instead of the stream waiting for it, see
+   *                        ServerReadStream::PrefetchedBatch
    */
   void readOnStorageThread(WeakRef<CatchupQueue> catchup_queue,
                            LocalLogStoreReader::ReadContext& read_ctx,
-                           bool inject_latency = false);
+                           bool inject_latency = false,
+                           bool prefetch = false);
+
+  /**
+   * If `action`, the result of a batch read on a storage thread, means that a
+   * backlog stream has more records to read once the batch is sent, starts
+   * reading the next batch right away (Settings::prefetch_backlog_reads).
+   *
+   * @param last_released_lsn  last released lsn the batch was read with
+   */
+  void maybePrefetch(Action action,
+                     WeakRef<CatchupQueue> catchup_queue,
+                     lsn_t last_released_lsn,
+                     CatchupEventTrigger catchup_reason);
 
   /**
    * Conditionally send the STARTED message if one is needed for this
@@ -279,6 +302,14 @@ class CatchupOneStream {
               GapReason reason,
               lsn_t provided_start_lsn = LSN_INVALID);
 
+  /**
+   * If adaptive-read-batch-size is enabled, updates the batch size feedback
+   * in stream_->batch_sizing_ and returns the number of record bytes the next
+   * batch may queue, never more than `max_record_bytes_queued`. Otherwise,
+   * returns `max_record_bytes_queued`.
+   */
+  size_t getReadBatchBytes(size_t max_record_bytes_queued);
+
   /**
    * @return ReadContext to be passed by LocalLogStoreReader::read().
    */
@@ -308,6 +339,43 @@ class CatchupOneStream {
    */
   int sendGapFilteredOutIfNeeded(folly::Optional<lsn_t> trim_point);
 
+  /**
+   * @return  true if the RECORD message of a record of `msg_size` bytes should
+   *          be put in the pending RECORDS message with addToRecordBatch()
+   *          instead of being sent right away, see
+   *          Settings::record_batch_max_records
+   */
+  bool canBatchRecord(size_t msg_size) const;
+
+  /**
+   * Adds the RECORD message of a record to the pending RECORDS message,
+   * sending the latter first if it is full.
+   *
+   * @return On success, returns 0. On failure, returns -1 with err set
+   *         according to Sender::sendMessage()
+   */
+  int addToRecordBatch(std::unique_ptr<RECORD_Message> msg, size_t msg_size);
+
+  /**
+   * Sends the pending records, followed by `gap` if not null, in a RECORDS
+   * message. If that fails, rolls the stream back to where it was before the
+   * first of the records, so that they are read again.
+   *
+   * @return On success, or if there are no pending records, returns 0. On
+   *         failure, returns -1 with err set according to
+   *         Sender::sendMessage()
+   */
+  int flushRecordBatch(std::unique_ptr<GAP_Message> gap = nullptr);
+
+  /**
+   * Called with the outcome of a batch read. Sends the pending records, if
+   * any.
+   *
+   * @return `action`, or Action::TRANSIENT_ERROR if the records couldn't be
+   *         sent.
+   */
+  Action finishRecordBatch(Action action);
+
   CatchupQueueDependencies& deps_;
   ServerReadStream* stream_;
   BWAvailableCallback& resume_cb_;
@@ -315,6 +383,24 @@ class CatchupOneStream {
   // Current amount of bytes we have enqueued in the output evbuffer so far.
   size_t record_bytes_queued_;
 
+  // Limits on the RECORDS message, see Settings::record_batch_max_records. 1
+  // if the client doesn't support RECORDS messages.
+  const size_t record_batch_max_records_;
+  const size_t record_batch_max_bytes_;
+
+  // Records shipped but not sent yet, and the total size of their messages.
+  std::vector<std::unique_ptr<RECORD_Message>> record_batch_;
+  size_t record_batch_bytes_{0};
+
+  // State of the stream before the first record in record_batch_, restored if
+  // the RECORDS message fails to send.
+  struct {
+    lsn_t last_delivered_lsn;
+    lsn_t last_delivered_record;
+    LocalLogStoreReader::ReadPointer read_ptr;
+    lsn_t filtered_out_end_lsn;
+  } record_batch_rollback_;
+
   friend class ReadingCallback;
 };
 
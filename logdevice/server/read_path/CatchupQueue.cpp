@@ -18,6 +18,7 @@
 #include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/RECORDS_Message.h"
 #include "logdevice/common/protocol/RECORD_Message.h"
 #include "logdevice/common/protocol/STARTED_Message.h"
 #include "logdevice/include/Err.h"
@@ -428,6 +429,36 @@ void CatchupQueue::onRecordSent(const RECORD_Message& msg,
     }
   };
 
+  checkRecordSent(msg, stream, enqueue_time);
+}
+
+void CatchupQueue::onRecordsSent(const RECORDS_Message& msg,
+                                 ServerReadStream* stream,
+                                 const SteadyTimestamp enqueue_time) {
+  const auto msg_size = msg.size();
+  ld_check(record_bytes_queued_ >= msg_size);
+  record_bytes_queued_ -= msg_size;
+  ld_spew("records drained, record_bytes_queued_ = %zu", record_bytes_queued_);
+
+  // See onRecordSent().
+  SCOPE_EXIT {
+    if (record_bytes_queued_ == 0) {
+      catchup_queue_ld_debug("Output evbuffer drained");
+      pushRecords();
+    }
+  };
+
+  for (const auto& record : msg.records_) {
+    checkRecordSent(*record, stream, enqueue_time);
+  }
+  if (msg.gap_) {
+    onGapSent(*msg.gap_, stream, enqueue_time);
+  }
+}
+
+void CatchupQueue::checkRecordSent(const RECORD_Message& msg,
+                                   ServerReadStream* stream,
+                                   const SteadyTimestamp enqueue_time) {
   if (stream == nullptr) {
     // Stream has been reaped. Nothing to validate.
     return;
@@ -687,6 +718,12 @@ void CatchupQueueDependencies::putStorageTask(
   all_server_read_streams_->putStorageTask(std::move(task), shard);
 }
 
+bool CatchupQueueDependencies::tryPutPrefetchStorageTask(
+    std::unique_ptr<ReadStorageTask>& task,
+    shard_index_t shard) {
+  return all_server_read_streams_->tryPutPrefetchStorageTask(task, shard);
+}
+
 Status
 CatchupQueueDependencies::read(LocalLogStore::ReadIterator* read_iterator,
                                LocalLogStoreReader::Callback& callback,
@@ -732,6 +769,10 @@ size_t CatchupQueueDependencies::getMaxRecordBytesQueued(ClientID client) {
   return max_record_bytes_queued;
 }
 
+size_t CatchupQueueDependencies::getBytesPendingForClient(ClientID client) {
+  return Worker::onThisThread()->sender().getBytesPendingForClient(client);
+}
+
 const Settings& CatchupQueueDependencies::getSettings() const {
   return Worker::settings();
 }
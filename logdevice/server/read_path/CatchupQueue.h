@@ -48,6 +48,7 @@ class Timer;
 class LogStorageStateMap;
 class ReadStorageTask;
 class RECORD_Message;
+class RECORDS_Message;
 class SenderBase;
 class SenderProxy;
 class StatsHolder;
@@ -131,6 +132,12 @@ class CatchupQueueDependencies {
   virtual void putStorageTask(std::unique_ptr<ReadStorageTask>&& task,
                               shard_index_t shard);
 
+  /**
+   * Proxy for AllServerReadStreams::tryPutPrefetchStorageTask().
+   */
+  virtual bool tryPutPrefetchStorageTask(std::unique_ptr<ReadStorageTask>& task,
+                                         shard_index_t shard);
+
   /**
    * Proxy for Processor::getLogStorageStateMap().
    */
@@ -152,6 +159,11 @@ class CatchupQueueDependencies {
    */
   virtual size_t getMaxRecordBytesQueued(ClientID client);
 
+  /**
+   * Proxy for Sender::getBytesPendingForClient().
+   */
+  virtual size_t getBytesPendingForClient(ClientID client);
+
   virtual ~CatchupQueueDependencies();
 
  public:
@@ -223,6 +235,15 @@ class CatchupQueue {
                     ServerReadStream*,
                     const SteadyTimestamp enqueue_time);
 
+  /**
+   * Called when a RECORDS message is drained from the output evbuffer and
+   * sent over the network. Equivalent to onRecordSent() for each record
+   * followed by onGapSent() for the gap, if any.
+   */
+  void onRecordsSent(const RECORDS_Message& msg,
+                     ServerReadStream*,
+                     const SteadyTimestamp enqueue_time);
+
   /**
    * Called when a gap message is drained from the output evbuffer and
    * sent over the network.
@@ -343,6 +364,13 @@ class CatchupQueue {
 
   void onStorageTaskStopped(const ServerReadStream* stream);
 
+  // Checks that a record sent to the client is consistent with the sending
+  // state of `stream` and advances it. Used by onRecordSent() and
+  // onRecordsSent().
+  void checkRecordSent(const RECORD_Message& msg,
+                       ServerReadStream* stream,
+                       const SteadyTimestamp enqueue_time);
+
   friend class CatchupQueueReadingCallback; // impl detail in CatchupQueue.cpp
   friend class CatchupQueueTest;
 };
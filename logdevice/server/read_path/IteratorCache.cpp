@@ -7,7 +7,9 @@
  */
 #include "IteratorCache.h"
 
+#include <algorithm>
 #include <chrono>
+#include <iterator>
 
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/stats/Stats.h"
@@ -15,9 +17,65 @@
 
 namespace facebook { namespace logdevice {
 
+bool IteratorPool::IdleIterator::compatible(
+    const LocalLogStore::ReadOptions& options) const {
+  return allow_blocking_io == options.allow_blocking_io &&
+      fill_cache == options.fill_cache &&
+      allow_copyset_index == options.allow_copyset_index &&
+      csi_data_only == options.csi_data_only;
+}
+
+std::shared_ptr<LocalLogStore::ReadIterator>
+IteratorPool::checkOut(const LocalLogStore::ReadOptions& options) {
+  for (auto it = idle_.rbegin(); it != idle_.rend(); ++it) {
+    if (it->compatible(options)) {
+      auto iterator = std::move(it->iterator);
+      idle_.erase(std::next(it).base());
+      return iterator;
+    }
+  }
+  return nullptr;
+}
+
+bool IteratorPool::hasIdle(const LocalLogStore::ReadOptions& options) const {
+  return std::any_of(
+      idle_.begin(), idle_.end(), [&](const IdleIterator& idle) {
+        return idle.compatible(options);
+      });
+}
+
+void IteratorPool::checkIn(
+    const LocalLogStore::ReadOptions& options,
+    std::shared_ptr<LocalLogStore::ReadIterator> iterator) {
+  ld_check(iterator);
+  idle_.push_back(IdleIterator{options.allow_blocking_io,
+                               options.fill_cache,
+                               options.allow_copyset_index,
+                               options.csi_data_only,
+                               std::move(iterator),
+                               std::chrono::steady_clock::now()});
+}
+
+void IteratorPool::invalidateIfUnused(std::chrono::steady_clock::time_point now,
+                                      std::chrono::milliseconds ttl) {
+  // idle_ is ordered by last_used, so the expired iterators are at the front.
+  auto expired = std::find_if(
+      idle_.begin(), idle_.end(), [&](const IdleIterator& idle) {
+        return now - idle.last_used <= ttl;
+      });
+  WORKER_STAT_ADD(iterator_invalidations, expired - idle_.begin());
+  idle_.erase(idle_.begin(), expired);
+}
+
 std::shared_ptr<LocalLogStore::ReadIterator>
 IteratorCache::createOrGet(const LocalLogStore::ReadOptions& options) {
   auto& wrapper = getWrapper(options);
+  if (!wrapper.iterator && pool_) {
+    wrapper.iterator = pool_->checkOut(options);
+    if (wrapper.iterator) {
+      WORKER_STAT_INCR(iterator_pool_reuses);
+    }
+  }
   if (!wrapper.iterator) {
     wrapper.iterator = store_->read(log_id_, options);
   } else {
@@ -29,7 +87,8 @@ IteratorCache::createOrGet(const LocalLogStore::ReadOptions& options) {
 }
 
 bool IteratorCache::valid(const LocalLogStore::ReadOptions& options) {
-  return getWrapper(options).iterator != nullptr;
+  return getWrapper(options).iterator != nullptr ||
+      (pool_ && pool_->hasIdle(options));
 }
 
 void IteratorCache::set(const LocalLogStore::ReadOptions& options,
@@ -39,6 +98,14 @@ void IteratorCache::set(const LocalLogStore::ReadOptions& options,
   wrapper.last_used = std::chrono::steady_clock::now();
 }
 
+void IteratorCache::release(const LocalLogStore::ReadOptions& options) {
+  auto& wrapper = getWrapper(options);
+  if (pool_ && wrapper.iterator) {
+    pool_->checkIn(options, std::move(wrapper.iterator));
+    wrapper.iterator.reset();
+  }
+}
+
 void IteratorCache::invalidateIfUnused(
     std::chrono::steady_clock::time_point now,
     std::chrono::milliseconds ttl) {
@@ -48,6 +115,9 @@ void IteratorCache::invalidateIfUnused(
       WORKER_STAT_INCR(iterator_invalidations);
     }
   }
+  if (pool_) {
+    pool_->invalidateIfUnused(now, ttl);
+  }
 }
 
 }} // namespace facebook::logdevice
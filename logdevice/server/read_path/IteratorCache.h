@@ -11,6 +11,7 @@
 #include <chrono>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include "logdevice/server/locallogstore/LocalLogStore.h"
 
@@ -20,15 +21,83 @@ namespace facebook { namespace logdevice {
  * @file  IteratorCache provides a way to get a read iterator for a particular
  *        log. The iterator will be created lazily the first time it's
  *        requested; future calls to getIterator() will return the cached value.
+ *
+ *        If given an IteratorPool, the cache only holds an iterator while the
+ *        owner is reading with it, and returns it to the pool in release().
+ *        This lets all read streams of a log on a worker share a few
+ *        iterators instead of each pinning memtables and files with its own.
  */
 
+/**
+ * Idle tailing read iterators of a log, shared by the IteratorCaches of all
+ * read streams reading the log from the same shard on a worker. An iterator is
+ * checked out by one IteratorCache at a time.
+ */
+class IteratorPool {
+ public:
+  IteratorPool() = default;
+
+  IteratorPool(const IteratorPool&) = delete;
+  IteratorPool& operator=(const IteratorPool&) = delete;
+
+  /**
+   * Takes the most recently returned idle iterator created with options
+   * compatible with the given ones.
+   *
+   * @return  the iterator, or nullptr if there is none.
+   */
+  std::shared_ptr<LocalLogStore::ReadIterator>
+  checkOut(const LocalLogStore::ReadOptions&);
+
+  /**
+   * @return  true if checkOut() would return an iterator.
+   */
+  bool hasIdle(const LocalLogStore::ReadOptions&) const;
+
+  /**
+   * Returns an iterator created with the given options to the pool. The caller
+   * must not use it anymore.
+   */
+  void checkIn(const LocalLogStore::ReadOptions&,
+               std::shared_ptr<LocalLogStore::ReadIterator>);
+
+  /**
+   * Release idle iterators which haven't been used recently.
+   */
+  void invalidateIfUnused(std::chrono::steady_clock::time_point now,
+                          std::chrono::milliseconds ttl);
+
+  size_t numIdle() const {
+    return idle_.size();
+  }
+
+ private:
+  struct IdleIterator {
+    // options the iterator was created with that affect what it reads
+    bool allow_blocking_io;
+    bool fill_cache;
+    bool allow_copyset_index;
+    bool csi_data_only;
+
+    std::shared_ptr<LocalLogStore::ReadIterator> iterator;
+    std::chrono::steady_clock::time_point last_used;
+
+    bool compatible(const LocalLogStore::ReadOptions& options) const;
+  };
+
+  // Ordered by last_used, the most recently used iterator at the back.
+  std::vector<IdleIterator> idle_;
+};
+
 class IteratorCache {
  public:
   explicit IteratorCache(LocalLogStore* store,
                          logid_t log_id,
-                         bool created_by_rebuilding)
+                         bool created_by_rebuilding,
+                         std::shared_ptr<IteratorPool> pool = nullptr)
       : store_(store),
         log_id_(log_id),
+        pool_(std::move(pool)),
         created_by_rebuilding_(created_by_rebuilding) {}
 
   /**
@@ -57,6 +126,13 @@ class IteratorCache {
   void set(const LocalLogStore::ReadOptions&,
            std::shared_ptr<LocalLogStore::ReadIterator>);
 
+  /**
+   * If this cache uses an IteratorPool, returns the cached iterator for the
+   * given ReadOptions to the pool. Must only be called once nothing, e.g. a
+   * storage task, is using the iterator anymore. No-op otherwise.
+   */
+  void release(const LocalLogStore::ReadOptions&);
+
   /**
    * Release iterators which haven't been used recently.
    *
@@ -99,6 +175,9 @@ class IteratorCache {
   IterWrapper blocking_;
   IterWrapper nonblocking_;
 
+  // May be nullptr.
+  std::shared_ptr<IteratorPool> pool_;
+
  public:
   // Context for tracking iterators
   bool created_by_rebuilding_;
@@ -24,6 +24,32 @@
 
 namespace facebook { namespace logdevice { namespace LocalLogStoreReader {
 
+// Checks the filterable key in the header of `record_blob` against `filter`
+// without looking at the payload.
+static bool isFilteredOut(const Slice& record_blob,
+                          ServerRecordFilter& filter) {
+  LocalLogStoreRecordFormat::flags_t flags;
+  std::map<KeyType, std::string> optional_keys;
+  int rv = LocalLogStoreRecordFormat::parse(record_blob,
+                                            nullptr,
+                                            nullptr,
+                                            &flags,
+                                            nullptr,
+                                            nullptr,
+                                            nullptr,
+                                            0,
+                                            nullptr,
+                                            &optional_keys,
+                                            nullptr,
+                                            -1 /* unused */);
+  if (rv != 0 || !(flags & LocalLogStoreRecordFormat::FLAG_OPTIONAL_KEYS)) {
+    // Malformed records are left for the callback to deal with.
+    return false;
+  }
+  const auto it = optional_keys.find(KeyType::FILTERABLE);
+  return it != optional_keys.end() && !filter(it->second);
+}
+
 static Status maybeSendRecord(LocalLogStore::ReadIterator& read_iterator,
                               Callback& callback,
                               ReadContext* read_ctx,
@@ -34,15 +60,20 @@ static Status maybeSendRecord(LocalLogStore::ReadIterator& read_iterator,
   size_t msg_size = RECORD_Message::expectedSize(payload_size);
   const lsn_t lsn = read_iterator.getLSN();
 
+  const bool filtered_out = read_ctx->record_filter_ &&
+      isFilteredOut(record_blob, *read_ctx->record_filter_);
+
   // Have we shipped too much data to the client already?
-  if (read_ctx->byteLimitReached(nrecords, bytes_delivered, msg_size)) {
+  if (!filtered_out &&
+      read_ctx->byteLimitReached(nrecords, bytes_delivered, msg_size)) {
     return E::BYTE_LIMIT_REACHED;
   }
 
   RawRecord record(lsn,
-                   record_blob,
+                   filtered_out ? Slice() : record_blob,
                    false, // unowned, points into LocalLogStore memory
                    read_iterator.accessedUnderReplicatedRegion());
+  record.filtered_out = filtered_out;
 
   if (callback.processRecord(record) != 0) {
     if (err != E::CBREGISTERED) {
@@ -50,8 +81,10 @@ static Status maybeSendRecord(LocalLogStore::ReadIterator& read_iterator,
     }
     return err;
   }
-  bytes_delivered += msg_size;
-  ++nrecords;
+  if (!filtered_out) {
+    bytes_delivered += msg_size;
+    ++nrecords;
+  }
   return E::OK;
 }
 
@@ -117,6 +150,11 @@ Status readImpl(LocalLogStore::ReadIterator& read_iterator,
              read_streams_num_csi_entries_sent,
              read_ctx->it_stats_.sent_csi_entries);
     STAT_ADD(stats, read_streams_block_bytes_read, block_bytes_read);
+    const size_t bytes_read = read_ctx->it_stats_.read_record_bytes +
+        read_ctx->it_stats_.read_csi_bytes;
+    if (bytes_read > 0) {
+      LOG_HEAVY_HITTER_ADD(stats, READ_BYTES, read_ctx->logid_, bytes_read);
+    }
     if (read_ctx->rebuilding_) {
       PER_SHARD_STAT_ADD(stats,
                          read_streams_num_records_read_rebuilding,
@@ -272,6 +310,15 @@ Status read(LocalLogStore::ReadIterator& read_iterator,
 
   Status st = readImpl(read_iterator, callback, read_ctx, stats, settings);
 
+  const LocalLogStore* store = read_iterator.getStore();
+  if (store != nullptr) {
+    if (st == E::CAUGHT_UP) {
+      store->noteReadPattern(read_ctx->logid_, /* tailing */ true);
+    } else if (st == E::BYTE_LIMIT_REACHED || st == E::PARTIAL) {
+      store->noteReadPattern(read_ctx->logid_, /* tailing */ false);
+    }
+  }
+
   // checks the return value of the read before returning it
 
 #ifndef NDEBUG
@@ -16,6 +16,7 @@
 #include "logdevice/common/CopySet.h"
 #include "logdevice/common/LocalLogStoreRecordFormat.h"
 #include "logdevice/common/SCDCopysetReordering.h"
+#include "logdevice/common/ServerRecordFilter.h"
 #include "logdevice/common/TailRecord.h"
 #include "logdevice/common/settings/Settings.h"
 #include "logdevice/common/stats/Stats.h"
@@ -65,17 +66,22 @@ class RawRecord : boost::noncopyable {
       : lsn(other.lsn),
         blob(other.blob),
         owned(other.owned),
-        from_under_replicated_region(other.from_under_replicated_region) {
+        from_under_replicated_region(other.from_under_replicated_region),
+        filtered_out(other.filtered_out) {
     other.lsn = LSN_INVALID;
     other.blob = Slice();
     other.owned = false;
     other.from_under_replicated_region = false;
+    other.filtered_out = false;
   }
 
   lsn_t lsn;
   Slice blob;
   bool owned;
   bool from_under_replicated_region;
+  // True if ReadContext::record_filter_ rejected the record. The blob is
+  // empty then: the reader only needs to know that the LSN was filtered out.
+  bool filtered_out{false};
 };
 
 namespace LocalLogStoreReader {
@@ -143,6 +149,11 @@ struct ReadContext {
   std::shared_ptr<LocalLogStore::ReadFilter> lls_filter_;
   // A reason of the current catchup
   CatchupEventTrigger catchup_reason_;
+  // If set, records whose filterable key (KeyType::FILTERABLE) doesn't pass
+  // this filter are passed to Callback::processRecord() with
+  // RawRecord::filtered_out set and without their blob, as soon as their
+  // header is parsed. They don't count towards max_bytes_to_deliver_.
+  std::shared_ptr<ServerRecordFilter> record_filter_;
   // Iterabtor statistics. Reset by LocalLogStoreReader::read().
   // It duplicates some of the stopping conditions, e.g.
   // it_stats_.stop_reading_after_lsn is usually set to
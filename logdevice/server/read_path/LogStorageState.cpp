@@ -38,6 +38,8 @@ namespace facebook { namespace logdevice {
 static_assert(LSN_INVALID == std::numeric_limits<lsn_t>::min(),
               "LSN_INVALID needs to be smallest possible lsn_t value");
 
+constexpr size_t LogStorageState::MAX_CACHED_EPOCH_OFFSETS;
+
 static const std::chrono::milliseconds RETRY_RELEASE_INITIAL_DELAY(100);
 static const std::chrono::milliseconds RETRY_RELEASE_MAX_DELAY(30000);
 
@@ -78,6 +80,15 @@ bool LogStorageState::hasPermanentError() {
   return permanent_error_.load();
 }
 
+void LogStorageState::noteRecordStored(lsn_t lsn) {
+  if (lsn <= last_released_lsn_.load(std::memory_order_relaxed) ||
+      unreleased_records_noted_.load(std::memory_order_relaxed) ||
+      unreleased_records_noted_.exchange(true)) {
+    return;
+  }
+  owner_->noteUnreleasedRecords(log_id_, shard_);
+}
+
 int LogStorageState::updateLastReleasedLSN(lsn_t new_val,
                                            LastReleasedSource source) {
   SCOPE_EXIT {
@@ -148,6 +159,24 @@ LogStorageState::getEpochOffset() const {
   return latest_epoch_offset_;
 }
 
+folly::Optional<uint64_t>
+LogStorageState::getCachedEpochOffset(epoch_t epoch) const {
+  RWLock::ReadHolder read_guard(rw_lock_);
+  auto it = cached_epoch_offsets_.find(epoch);
+  if (it == cached_epoch_offsets_.end()) {
+    return folly::none;
+  }
+  return it->second;
+}
+
+void LogStorageState::cacheEpochOffset(epoch_t epoch, uint64_t offset) {
+  RWLock::WriteHolder write_guard(rw_lock_);
+  cached_epoch_offsets_[epoch] = offset;
+  if (cached_epoch_offsets_.size() > MAX_CACHED_EPOCH_OFFSETS) {
+    cached_epoch_offsets_.erase(cached_epoch_offsets_.begin());
+  }
+}
+
 void LogStorageState::updateLastCleanEpoch(epoch_t epoch) {
   last_clean_epoch_.fetchMax(epoch.val_);
 }
@@ -192,9 +221,13 @@ int LogStorageState::updateSeal(Seal new_seal, LogStorageState::SealType type) {
   return 0;
 }
 
-void LogStorageState::retryRelease(worker_id_t id, bool force) {
+void LogStorageState::retryRelease(worker_id_t id,
+                                   WorkerType type,
+                                   bool force) {
   std::lock_guard<std::mutex> guard(retry_release_.mutex_);
-  retry_release_.failed_workers_.set(id.val_);
+  (type == WorkerType::READ ? retry_release_.failed_read_workers_
+                            : retry_release_.failed_workers_)
+      .set(id.val_);
   retry_release_.force_ |= force;
   if (!retry_release_.timer_scheduled_) {
     ExponentialBackoffTimerNode* node = Worker::onThisThread()->registerTimer(
@@ -217,14 +250,17 @@ void LogStorageState::onRetryReleaseTimer(ExponentialBackoffTimerNode* node) {
   ld_check(retry_release_.timer_scheduled_);
 
   std::bitset<MAX_WORKERS> failed_workers;
+  std::bitset<MAX_WORKERS> failed_read_workers;
   bool force;
   {
     std::lock_guard<std::mutex> guard(retry_release_.mutex_);
     failed_workers = retry_release_.failed_workers_;
-    // Reset the public bitset.  Later we will check it to see if anyone has
+    failed_read_workers = retry_release_.failed_read_workers_;
+    // Reset the public bitsets.  Later we will check them to see if anyone has
     // added new bits while we were broadcasting, to see if we need to
     // reactivate the timer.
     retry_release_.failed_workers_.reset();
+    retry_release_.failed_read_workers_.reset();
     force = retry_release_.force_;
   }
 
@@ -232,16 +268,19 @@ void LogStorageState::onRetryReleaseTimer(ExponentialBackoffTimerNode* node) {
       ServerWorker::onThisThread()->processor_,
       RecordID(last_released_lsn_, log_id_),
       shard_,
-      [&](worker_id_t id) {
-        return failed_workers.test(id.val_) && this->isWorkerSubscribed(id);
+      [&](worker_id_t id, WorkerType type) {
+        const auto& failed =
+            type == WorkerType::READ ? failed_read_workers : failed_workers;
+        return failed.test(id.val_) && this->isWorkerSubscribed(id, type);
       },
       force);
   // If any workers failed again, they will have conveniently gotten readded
-  // to the public bitset, by ReleaseRequest::broadcastReleaseRequest().
+  // to the public bitsets, by ReleaseRequest::broadcastReleaseRequest().
 
   {
     std::lock_guard<std::mutex> guard(retry_release_.mutex_);
-    if (retry_release_.failed_workers_.any()) {
+    if (retry_release_.failed_workers_.any() ||
+        retry_release_.failed_read_workers_.any()) {
       // Some workers failed while retrying above, or failed on another thread
       // while we were retrying.  Reactivate the timer with a larger delay.
       node->timer->activate();
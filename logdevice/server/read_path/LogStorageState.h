@@ -8,6 +8,7 @@
 #pragma once
 
 #include <bitset>
+#include <map>
 #include <memory>
 #include <string>
 
@@ -20,6 +21,7 @@
 #include "logdevice/common/AtomicOptional.h"
 #include "logdevice/common/GetSeqStateRequest-fwd.h"
 #include "logdevice/common/Seal.h"
+#include "logdevice/common/WorkerType.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/include/Err.h"
 #include "logdevice/server/RecordCache.h"
@@ -193,6 +195,14 @@ class LogStorageState {
 
   folly::Optional<std::pair<epoch_t, uint64_t>> getEpochOffset() const;
 
+  /**
+   * Looks up the byte offset at the start of `epoch` among the ones read
+   * from PerEpochLogMetadata by read streams of this log. Those don't change
+   * once written, so streams reading the same epochs share them instead of
+   * each reading the metadata.
+   */
+  folly::Optional<uint64_t> getCachedEpochOffset(epoch_t epoch) const;
+
   std::chrono::seconds getLogRemovalTime() const {
     return log_removal_time_.load();
   }
@@ -257,21 +267,33 @@ class LogStorageState {
   void updateEpochOffset(std::pair<epoch_t, uint64_t>);
 
   /**
-   * Looks up the worker in the set of workers subscribed to the log.
+   * Remembers the byte offset at the start of `epoch`, read from
+   * PerEpochLogMetadata. Only the MAX_CACHED_EPOCH_OFFSETS highest epochs are
+   * kept.
+   */
+  void cacheEpochOffset(epoch_t epoch, uint64_t offset);
+
+  static constexpr size_t MAX_CACHED_EPOCH_OFFSETS = 16;
+
+  /**
+   * Looks up the worker in the set of workers subscribed to the log. Read
+   * streams live on GENERAL and READ workers, which have separate sets.
    */
-  bool isWorkerSubscribed(worker_id_t id) const {
+  bool isWorkerSubscribed(worker_id_t id,
+                          WorkerType type = WorkerType::GENERAL) const {
     ld_check(id.val_ >= 0);
-    return subscribed_workers_.test(id.val_);
+    return subscribedWorkers(type).test(id.val_);
   }
 
-  void subscribeWorker(worker_id_t id) {
+  void subscribeWorker(worker_id_t id, WorkerType type = WorkerType::GENERAL) {
     ld_check(id.val_ >= 0);
-    subscribed_workers_.set(id.val_);
+    subscribedWorkers(type).set(id.val_);
   }
 
-  void unsubscribeWorker(worker_id_t id) {
+  void unsubscribeWorker(worker_id_t id,
+                         WorkerType type = WorkerType::GENERAL) {
     ld_check(id.val_ >= 0);
-    subscribed_workers_.reset(id.val_);
+    subscribedWorkers(type).reset(id.val_);
   }
 
   void noteLogStateRecovered() {
@@ -313,7 +335,7 @@ class LogStorageState {
    * Called when ReleaseRequest::broadcastReleaseRequest() fails to post a
    * ReleaseRequest to a worker.  Schedules a timer to retry again in a while.
    */
-  void retryRelease(worker_id_t id, bool force);
+  void retryRelease(worker_id_t id, WorkerType type, bool force);
 
   void getDebugInfo(InfoLogStorageStateTable& table) const;
 
@@ -338,6 +360,22 @@ class LogStorageState {
   // @return whether the permanent error flag is set
   bool hasPermanentError();
 
+  /**
+   * Called after a record with `lsn` was stored for this log. If the record
+   * is not released yet, adds the log to the logs with unreleased records
+   * of LogStorageStateMap, for UnreleasedRecordDetector to look at.
+   */
+  void noteRecordStored(lsn_t lsn);
+
+  /**
+   * Clears the flag set by noteRecordStored(), so that the next unreleased
+   * record stored adds the log again. Called by UnreleasedRecordDetector
+   * before it looks at the log.
+   */
+  void clearUnreleasedRecordsNoted() const {
+    unreleased_records_noted_.store(false);
+  }
+
   shard_index_t getShardIdx() const {
     return shard_;
   }
@@ -388,6 +426,12 @@ class LogStorageState {
 
   std::atomic<bool> recover_log_state_task_in_flight_{false};
 
+  // Was the log added to LogStorageStateMap's logs with unreleased records
+  // since UnreleasedRecordDetector last looked at it? Avoids adding it for
+  // every record stored. Mutable because the detector resets it while
+  // visiting const states.
+  mutable std::atomic<bool> unreleased_records_noted_{false};
+
   // Trim point of log.  Allows the local log store to delete trimmed
   // records and read paths to recognize that records are missing because of
   // trimming.  All records up to (and including) this LSN are scheduled for
@@ -423,6 +467,20 @@ class LogStorageState {
   // subscribed to broadcasts of RELEASE messages.  These workers are
   // notified, for example, when a new record is released for delivery.
   folly::AtomicBitSet<MAX_WORKERS> subscribed_workers_;
+  // Same for READ workers.
+  folly::AtomicBitSet<MAX_WORKERS> subscribed_read_workers_;
+
+  folly::AtomicBitSet<MAX_WORKERS>& subscribedWorkers(WorkerType type) {
+    ld_check(type == WorkerType::GENERAL || type == WorkerType::READ);
+    return type == WorkerType::READ ? subscribed_read_workers_
+                                    : subscribed_workers_;
+  }
+  const folly::AtomicBitSet<MAX_WORKERS>&
+  subscribedWorkers(WorkerType type) const {
+    ld_check(type == WorkerType::GENERAL || type == WorkerType::READ);
+    return type == WorkerType::READ ? subscribed_read_workers_
+                                    : subscribed_workers_;
+  }
 
   // Latest time (number of microseconds since steady_clock's epoch) when
   // some storage node tried to recover the state.
@@ -448,6 +506,10 @@ class LogStorageState {
   // can be different from epoch in latest_epoch_offset_ pair.
   folly::Optional<std::pair<epoch_t, uint64_t>> latest_epoch_offset_;
 
+  // Offsets at the start of epochs, read from PerEpochLogMetadata. Also
+  // protected by rw_lock_.
+  std::map<epoch_t, uint64_t> cached_epoch_offsets_;
+
   // Data needed to manage retrying sending ReleaseRequests to workers.
   struct RetryRelease {
     std::mutex mutex_;
@@ -456,6 +518,7 @@ class LogStorageState {
     bool timer_scheduled_;
     bool force_;
     std::bitset<MAX_WORKERS> failed_workers_;
+    std::bitset<MAX_WORKERS> failed_read_workers_;
   } retry_release_;
 
   /**
@@ -36,7 +36,7 @@ LogStorageStateMap::LogStorageStateMap(
     // only starts the record cache monitor thread if record cache
     // is enabled
     record_cache_monitor_ =
-        std::make_unique<RecordCacheMonitorThread>(processor);
+        std::make_unique<RecordCacheMonitorThread>(processor, num_shards);
   }
 }
 
@@ -125,6 +125,34 @@ LogStorageStateMap::getAllLastReleasedLSNs(shard_index_t shard) const {
   return states;
 }
 
+constexpr size_t LogStorageStateMap::MAX_NOTED_UNRELEASED_LOGS;
+
+void LogStorageStateMap::noteUnreleasedRecords(logid_t log_id,
+                                               shard_index_t shard_idx) {
+  std::lock_guard<std::mutex> lock(unreleased_mutex_);
+  if (noted_unreleased_.size() < MAX_NOTED_UNRELEASED_LOGS) {
+    noted_unreleased_.emplace_back(log_id, shard_idx);
+  } else {
+    noted_unreleased_overflow_ = true;
+  }
+}
+
+folly::Optional<LogStorageStateMap::LogKeys>
+LogStorageStateMap::takeLogsWithUnreleasedRecords() {
+  LogKeys logs;
+  bool overflow;
+  {
+    std::lock_guard<std::mutex> lock(unreleased_mutex_);
+    logs.swap(noted_unreleased_);
+    overflow = noted_unreleased_overflow_;
+    noted_unreleased_overflow_ = false;
+  }
+  if (overflow) {
+    return folly::none;
+  }
+  return logs;
+}
+
 int LogStorageStateMap::recoverLogState(logid_t log_id,
                                         shard_index_t shard_idx,
                                         LogStorageState::RecoverContext ctx,
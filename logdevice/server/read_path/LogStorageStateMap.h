@@ -10,8 +10,11 @@
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 
+#include <folly/Optional.h>
 #include <folly/concurrency/ConcurrentHashMap.h>
 
 #include "logdevice/common/types_internal.h"
@@ -151,6 +154,37 @@ class LogStorageStateMap {
   template <typename Func>
   int forEachLogOnShard(shard_index_t shard, const Func& func) const;
 
+  using LogKeys = std::vector<std::pair<logid_t, shard_index_t>>;
+
+  /**
+   * Adds a log to the logs with unreleased records. Called by
+   * LogStorageState::noteRecordStored(), at most once between calls to
+   * takeLogsWithUnreleasedRecords() for each log.
+   */
+  void noteUnreleasedRecords(logid_t log_id, shard_index_t shard_idx);
+
+  /**
+   * Takes the logs added by noteUnreleasedRecords() since the last call,
+   * so that UnreleasedRecordDetector only needs to look at those and the
+   * ones that already had unreleased records.
+   *
+   * @return  the logs, or folly::none if more than
+   *          MAX_NOTED_UNRELEASED_LOGS were added, in which case some of
+   *          them were not remembered and the caller has to look at all
+   *          logs.
+   */
+  folly::Optional<LogKeys> takeLogsWithUnreleasedRecords();
+
+  static constexpr size_t MAX_NOTED_UNRELEASED_LOGS = 100000;
+
+  /**
+   * Record cache monitor thread, nullptr if record caching is disabled or
+   * not running on a storage node.
+   */
+  const RecordCacheMonitorThread* getRecordCacheMonitor() const {
+    return record_cache_monitor_.get();
+  }
+
   // May be nullptr in tests.
   ServerProcessor* getProcessor();
   StatsHolder* getStats();
@@ -184,6 +218,11 @@ class LogStorageStateMap {
    * if needed.
    */
   std::unique_ptr<RecordCacheMonitorThread> record_cache_monitor_;
+
+  // See noteUnreleasedRecords(). Protected by unreleased_mutex_.
+  std::mutex unreleased_mutex_;
+  LogKeys noted_unreleased_;
+  bool noted_unreleased_overflow_ = false;
 };
 
 template <typename Func>
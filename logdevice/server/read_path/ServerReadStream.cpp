@@ -280,6 +280,19 @@ void ServerReadStream::addReleasedRecords(
   released_records_.push_back(ptr);
 }
 
+bool ServerReadStream::canReadFromReleasedRecords() const {
+  // Mirrors the checks in CatchupOneStream::pushReleasedRecords().
+  const lsn_t read_ptr = getReadPtr().lsn;
+  for (const auto& rec : released_records_) {
+    if (!same_epoch(rec->end_lsn_, read_ptr) || *rec < read_ptr) {
+      continue;
+    }
+    // The first record at or past the read pointer must contain it.
+    return !(*rec > read_ptr);
+  }
+  return false;
+}
+
 void ServerReadStream::noteSent(StatsHolder* stats,
                                 RecordSource source,
                                 size_t msg_size_bytes_approx) {
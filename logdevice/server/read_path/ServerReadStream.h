@@ -17,6 +17,7 @@
 #include "logdevice/common/AdminCommandTable-fwd.h"
 #include "logdevice/common/ClientID.h"
 #include "logdevice/common/NodeID.h"
+#include "logdevice/common/ResourceBudget.h"
 #include "logdevice/common/SCDCopysetReordering.h"
 #include "logdevice/common/ServerRecordFilter.h"
 #include "logdevice/common/SimpleEnumMap.h"
@@ -196,6 +197,16 @@ class ServerReadStream : boost::noncopyable {
 
   void addReleasedRecords(const std::shared_ptr<ReleasedRecords>& ptr);
 
+  /**
+   * @return  true if the next batch could start with records from
+   *          released_records_, i.e. this stream is tailing the log and the
+   *          buffered records start at or before its read pointer. Records
+   *          of a stream for which this returns false are of no use: they'll
+   *          be dropped by the next batch, which will read from the local log
+   *          store.
+   */
+  bool canReadFromReleasedRecords() const;
+
   std::vector<std::shared_ptr<ReleasedRecords>> giveReleasedRecords() {
     // Note: the move constructor here doesn't guarantee that released_records_
     // will be empty.  In fact, the optimizer may elide the construction of a
@@ -394,6 +405,12 @@ class ServerReadStream : boost::noncopyable {
    */
   bool payload_hash_only_ = false;
 
+  /*
+   * Did the client say in HELLO that it can take compressed payloads?
+   * See setting record-compression.
+   */
+  bool accepts_compressed_records_ = false;
+
   /**
    * Indicate that storage node should try to send byte offset of log up to
    * current reading record if record contain offset_within_epoch. Byte offset
@@ -438,6 +455,60 @@ class ServerReadStream : boost::noncopyable {
   // which case the stream should be at the top of CatchupQueue.
   bool storage_task_in_flight_;
 
+  // The next batch of a backlog stream, read ahead of time by a prefetch
+  // ReadStorageTask while the previous batch was being sent to the client
+  // (Settings::prefetch_backlog_reads).
+  struct PrefetchedBatch {
+    // Stream state at the time the prefetch task was created. The batch is
+    // only used if the stream still is in that state.
+    server_read_stream_version_t version;
+    filter_version_t filter_version;
+    lsn_t start_lsn;
+    lsn_t last_released_lsn;
+    CatchupEventTrigger catchup_reason;
+
+    // False while the task is in flight. If the stream is ready to read its
+    // next batch before that, the task is adopted: the stream waits for it as
+    // for a regular storage task, with storage_task_in_flight_ set.
+    bool done{false};
+    bool adopted{false};
+
+    // Result of the task, see ReadStorageTask.
+    Status status{E::UNKNOWN};
+    std::vector<RawRecord> records;
+    LocalLogStoreReader::ReadPointer read_ptr{LSN_INVALID};
+    bool accessed_under_replicated_region{false};
+
+    // Keeps the memory of `records` charged to the read storage task memory
+    // budget of AllServerReadStreams until the batch is used or discarded.
+    ResourceBudget::Token memory_token;
+  };
+  // nullptr if there is no prefetched batch or prefetch task in flight.
+  std::unique_ptr<PrefetchedBatch> prefetched_batch_;
+
+  // Feedback used to size read batches of this stream when
+  // adaptive-read-batch-size is enabled. See
+  // CatchupOneStream::getReadBatchBytes().
+  struct ReadBatchSizing {
+    // Current limit on record bytes per batch. 0 until the first batch.
+    size_t batch_bytes{0};
+
+    // Smoothed rate at which records of this stream were queued for sending,
+    // in bytes per second.
+    double send_rate{0};
+
+    // Smoothed time it took storage tasks of this stream to come back,
+    // including the time spent in the shard's storage task queue, in
+    // microseconds.
+    double storage_task_usec{0};
+
+    // Start of the period over which send_rate is being measured, and number
+    // of record bytes queued during that period so far.
+    SteadyTimestamp sample_start{SteadyTimestamp::min()};
+    size_t sample_bytes{0};
+  };
+  ReadBatchSizing batch_sizing_;
+
   // Status of the last batch. Equal to E::UNKNOWN if a batch has not yet
   // completed.
   // Used for debugging only.
@@ -460,8 +531,9 @@ class ServerReadStream : boost::noncopyable {
   folly::Optional<std::pair<epoch_t, uint64_t>> epoch_offset_ = folly::none;
 
   // ServerRecordFilter used to filter out record. It will be constructed
-  // by ServerRecordFilterFactory.
-  std::unique_ptr<ServerRecordFilter> filter_pred_;
+  // by ServerRecordFilterFactory. Shared with the ReadContext of batches
+  // being read, since LocalLogStoreReader applies it while reading.
+  std::shared_ptr<ServerRecordFilter> filter_pred_;
 
   // The location of the client reader.
   // Only used if local_scd_enabled_ is set to true.
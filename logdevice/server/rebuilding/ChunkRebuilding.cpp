@@ -8,6 +8,9 @@
 #include "logdevice/server/rebuilding/ChunkRebuilding.h"
 
 #include "logdevice/common/Processor.h"
+#include "logdevice/common/Socket.h"
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/STORES_Message.h"
 #include "logdevice/server/ServerWorker.h"
 #include "logdevice/server/rebuilding/ShardRebuildingV2.h"
 
@@ -73,9 +76,67 @@ void ChunkRebuilding::start() {
             data_, data_->getUninitializedPayloadHolder(i)));
   }
   numInFlight_ = rrStores_.size();
+  // Nothing is sent in read-only mode.
+  batchingStores_ = !readOnly_ && rebuildingSettings_->batch_chunk_stores;
   for (size_t i = 0; i < rrStores_.size(); ++i) {
     rrStores_[i]->start(readOnly_);
   }
+  if (batchingStores_) {
+    batchingStores_ = false;
+    flushStoreBatches();
+  }
+}
+
+bool ChunkRebuilding::enqueueStoreForBatch(std::unique_ptr<STORE_Message>& msg,
+                                           ShardID to,
+                                           SocketCallback& onclose) {
+  if (!batchingStores_) {
+    return false;
+  }
+
+  // The protocol of the connection must be known to support STORES. STOREs
+  // sent before the handshake completes go in STORE messages.
+  Sender& sender = Worker::onThisThread()->sender();
+  const NodeID node = to.asNodeID();
+  const auto conn = Sender::connectionFor(*msg);
+  Socket* socket = sender.findServerSocket(node.index(), conn);
+  if (socket == nullptr || !socket->isHandshaken() ||
+      socket->getProto() < Compatibility::STORES_MESSAGE_SUPPORT) {
+    return false;
+  }
+  if (sender.registerOnSocketClosed(Address(node), onclose, conn) != 0) {
+    return false;
+  }
+
+  StoreBatch& batch = storeBatches_[node.index()];
+  batch.to = node;
+  batch.stores.push_back(std::move(msg));
+  return true;
+}
+
+void ChunkRebuilding::flushStoreBatches() {
+  auto batches = std::move(storeBatches_);
+  storeBatches_.clear();
+  Worker* w = Worker::onThisThread();
+  for (auto& kv : batches) {
+    StoreBatch& batch = kv.second;
+    ld_check(!batch.stores.empty());
+    std::unique_ptr<Message> msg;
+    if (batch.stores.size() == 1) {
+      // Nothing to batch the STORE with, send it as is.
+      msg = std::move(batch.stores.front());
+    } else {
+      msg = std::make_unique<STORES_Message>(std::move(batch.stores));
+    }
+    int rv = w->sender().sendMessage(std::move(msg), batch.to);
+    if (rv != 0) {
+      // The message wasn't sent, so the messaging layer won't call onSent().
+      // Report the error to the RecordRebuildingStores the same way as if
+      // sending had failed later.
+      w->message_dispatch_->onSent(
+          *msg, err, Address(batch.to), SteadyTimestamp::now());
+    }
+  }
 }
 
 bool ChunkRebuilding::onStoreSent(Status st,
@@ -7,6 +7,8 @@
  */
 #pragma once
 
+#include <map>
+
 #include "logdevice/common/PayloadHolder.h"
 #include "logdevice/server/RecordRebuildingStore.h"
 #include "logdevice/server/locallogstore/LocalLogStore.h"
@@ -147,10 +149,26 @@ class ChunkRebuilding : public RecordRebuildingOwner {
   onAllAmendsReceived(lsn_t lsn,
                       std::unique_ptr<FlushTokenMap> flushTokenMap) override;
 
+  // While start() starts the RecordRebuildingStores, queues their STOREs to
+  // send them in one STORES message per recipient node, if
+  // rebuilding-batch-chunk-stores is set and the connection to the node
+  // supports it. STOREs sent later, e.g. retries, go out one per message.
+  bool enqueueStoreForBatch(std::unique_ptr<STORE_Message>& msg,
+                            ShardID to,
+                            SocketCallback& onclose) override;
+
   // Unregisters itself from ServerWorker's ChunkRebuildingMap.
   void deleteThis();
 
  private:
+  struct StoreBatch {
+    NodeID to;
+    std::vector<std::unique_ptr<STORE_Message>> stores;
+  };
+
+  // Sends the STOREs queued by enqueueStoreForBatch().
+  void flushStoreBatches();
+
   ShardRebuildingV2Ref owner_;
   // This needs to be a shared_ptr to allow STORE_Message to keep the payload
   // alive until it's passed to TCP.
@@ -169,6 +187,12 @@ class ChunkRebuilding : public RecordRebuildingOwner {
 
   bool readOnly_ = false;
 
+  // True while start() is starting the RecordRebuildingStores with STORE
+  // batching enabled.
+  bool batchingStores_ = false;
+  // Node index -> STOREs queued for that node.
+  std::map<node_index_t, StoreBatch> storeBatches_;
+
   void onAmendDone(lsn_t lsn);
 };
 
@@ -372,6 +372,31 @@ bool RebuildingPlanner::rebuildingSetTooBig(
   return !f.canReplicate(true);
 }
 
+const RebuildingPlanner::MetaDataDecision&
+RebuildingPlanner::getMetaDataDecision(const EpochMetaData& metadata) {
+  MetaDataDecisionKey key(
+      metadata.shards, metadata.replication.getDistinctReplicationFactors());
+  auto it = metadataDecisions_.find(key);
+  if (it != metadataDecisions_.end()) {
+    return it->second;
+  }
+
+  // findDonorShards() removes the shards that are not in the config anymore,
+  // work on a copy.
+  EpochMetaData copy = metadata;
+  MetaDataDecision decision;
+  decision.donors = findDonorShards(copy);
+  decision.shards = copy.shards;
+  if (!decision.donors.empty()) {
+    decision.rebuildingSetTooBig = rebuildingSetTooBig(copy);
+    if (!decision.rebuildingSetTooBig) {
+      decision.isAuthoritative = rebuildingIsAuthoritative(copy);
+    }
+  }
+  return metadataDecisions_.emplace(std::move(key), std::move(decision))
+      .first->second;
+}
+
 void RebuildingPlanner::processMetadataForEpochInterval(
     logid_t logid,
     std::shared_ptr<EpochMetaData> metadata,
@@ -381,11 +406,12 @@ void RebuildingPlanner::processMetadataForEpochInterval(
   ld_check(it != log_states_.end());
   LogState& log_state = it->second;
 
-  auto cfg = Worker::getConfig();
+  const MetaDataDecision& decision = getMetaDataDecision(*metadata);
+  metadata->setShards(decision.shards);
 
-  auto donors = findDonorShards(*metadata);
+  const auto& donors = decision.donors;
   if (!donors.empty()) {
-    if (rebuildingSetTooBig(*metadata)) {
+    if (decision.rebuildingSetTooBig) {
       RATELIMIT_ERROR(
           std::chrono::seconds(1),
           1,
@@ -407,7 +433,7 @@ void RebuildingPlanner::processMetadataForEpochInterval(
         }
         log_state.plan[shard]->addEpochRange(epoch_first, epoch_last, metadata);
       }
-      if (!rebuildingIsAuthoritative(*metadata)) {
+      if (!decision.isAuthoritative) {
         RATELIMIT_WARNING(
             std::chrono::seconds(1),
             1,
@@ -6,6 +6,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 #pragma once
+#include <map>
 #include <mutex>
 #include <queue>
 #include <set>
@@ -161,6 +162,30 @@ class RebuildingPlanner : public RebuildingLogEnumerator::Listener {
   // SyncSequencerRequest needs to be retried.
   ExponentialBackoffTimer retry_timer_;
 
+  // What processMetadataForEpochInterval() decides for an epoch interval
+  // depends only on the storage set and replication property of its
+  // EpochMetaData, and most logs share a few of those across their history.
+  // Decisions are made once per distinct pair and cached here for the
+  // lifetime of the planner, i.e. of one rebuilding version.
+  struct MetaDataDecision {
+    // Storage set without the shards that aren't readable storage nodes in
+    // the config anymore.
+    StorageSet shards;
+    std::vector<shard_index_t> donors;
+    // Only meaningful if donors is not empty.
+    bool rebuildingSetTooBig{false};
+    // Only meaningful if donors is not empty and rebuildingSetTooBig is false.
+    bool isAuthoritative{true};
+  };
+  using MetaDataDecisionKey =
+      std::pair<StorageSet,
+                std::vector<ReplicationProperty::ScopeReplication>>;
+  std::map<MetaDataDecisionKey, MetaDataDecision> metadataDecisions_;
+
+  // Returns the decision for the storage set and replication of `metadata`,
+  // making it if it's not cached yet.
+  const MetaDataDecision& getMetaDataDecision(const EpochMetaData& metadata);
+
   // Looks at queue to see if some requests are ready to be sent.
   // May destroy `this`.
   void maybeSendMoreRequests();
@@ -38,7 +38,9 @@ void RebuildingReadStorageTaskV2::execute() {
     opts.allow_copyset_index = true;
 
     context->iterator = createIterator(opts);
-    context->nextLocation = context->iterator->minLocation();
+    if (context->nextLocation == nullptr) {
+      context->nextLocation = context->iterator->minLocation();
+    }
   }
 
   LocalLogStore::AllLogsIterator* iterator = context->iterator.get();
@@ -148,6 +150,11 @@ void RebuildingReadStorageTaskV2::execute() {
       // stop here without delivering it.
       break;
     }
+    if (context->endLocation != nullptr &&
+        iterator->reachedLocation(*context->endLocation)) {
+      // The rest belongs to another range.
+      break;
+    }
 
     logid_t log = iterator->getLogID();
     lsn_t lsn = iterator->getLSN();
@@ -249,6 +256,13 @@ void RebuildingReadStorageTaskV2::execute() {
   switch (iterator->state()) {
     case IteratorState::AT_RECORD:
     case IteratorState::LIMIT_REACHED:
+      // Note that if the records past endLocation don't pass the filter, the
+      // iterator may go through some of them before stopping.
+      if (context->endLocation != nullptr &&
+          iterator->reachedLocation(*context->endLocation)) {
+        context->reachedEnd = true;
+        break;
+      }
       context->nextLocation = iterator->getLocation();
       break;
     case IteratorState::AT_END:
@@ -423,6 +437,12 @@ RebuildingReadStorageTaskV2::Filter::Filter(RebuildingReadStorageTaskV2* task,
   scd_my_shard_id_ = context->myShardID;
 }
 
+bool RebuildingReadStorageTaskV2::Filter::shouldProcessLog(logid_t log) {
+  // Logs outside the plan don't need to be rebuilt. Skip them without reading
+  // their CSI entries, let alone records.
+  return context->logs.count(log) != 0;
+}
+
 bool RebuildingReadStorageTaskV2::Filter::shouldProcessTimeRange(
     RecordTimestamp min,
     RecordTimestamp max) {
@@ -504,9 +524,9 @@ operator()(logid_t log,
   if (log != currentLog) {
     auto it = context->logs.find(log);
     if (it == context->logs.end()) {
+      // Iterators skip such logs altogether if they support
+      // shouldProcessLog(), see above.
       currentLogState = nullptr;
-      // TODO (T24665001): Do this filtering on logsdb directory
-      //                   instead of individual records.
       noteRecordFiltered(FilteredReason::EPOCH_RANGE, late);
       return false;
     }
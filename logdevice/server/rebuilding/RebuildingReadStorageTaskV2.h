@@ -75,8 +75,16 @@ class RebuildingReadStorageTaskV2 : public StorageTask {
     // at nextLocation.
     std::unique_ptr<LocalLogStore::AllLogsIterator> iterator;
     // The first location not processed yet.
-    // Next storage task needs to start reading from here.
+    // Next storage task needs to start reading from here. If nullptr when the
+    // iterator is created, it is set to the iterator's minLocation().
     std::unique_ptr<LocalLogStore::AllLogsIterator::Location> nextLocation;
+    // If not nullptr, reading stops at this location, as if it was the end.
+    // Together with nextLocation, this lets several contexts read disjoint
+    // ranges of the shard in parallel, each with its own iterator and storage
+    // tasks. The ranges come from AllLogsIterator::splitIntoRanges(). Since
+    // each context tracks sticky copyset blocks on its own, the LogStates of
+    // different ranges should start from disjoint currentBlockIDs.
+    std::unique_ptr<LocalLogStore::AllLogsIterator::Location> endLocation;
     // If we encounter too many invalid records, stall rebuilding just in case.
     size_t numMalformedRecordsSeen{0};
 
@@ -106,6 +114,7 @@ class RebuildingReadStorageTaskV2 : public StorageTask {
                     RecordTimestamp min_ts,
                     RecordTimestamp max_ts) override;
 
+    bool shouldProcessLog(logid_t log) override;
     bool shouldProcessTimeRange(RecordTimestamp min,
                                 RecordTimestamp max) override;
 
@@ -11,6 +11,7 @@
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/configuration/UpdateableConfig.h"
+#include "logdevice/common/stats/PerShardHistograms.h"
 #include "logdevice/server/locallogstore/PartitionedRocksDBStore.h"
 
 namespace facebook { namespace logdevice {
@@ -84,6 +85,10 @@ void ShardRebuildingV1::start(
 
   // Kick off some `LogRebuilding`s.
   someLogMadeProgress();
+
+  if (!completed_) {
+    activateThrottleTimer();
+  }
 }
 
 void ShardRebuildingV1::destroy() {
@@ -268,6 +273,96 @@ void ShardRebuildingV1::cancelStallTimer() {
   }
 }
 
+void ShardRebuildingV1::activateThrottleTimer() {
+  if (!throttleTimer_) {
+    throttleTimer_ =
+        folly::make_unique<Timer>([this] { onThrottleTimerExpired(); });
+  }
+  throttleTimer_->activate(rebuildingSettings_->donor_throttle_interval);
+}
+
+ShardRebuildingV1::ForegroundLoad ShardRebuildingV1::getForegroundLoad() {
+  ForegroundLoad load;
+  StatsHolder* stats = getStats();
+  if (!stats) {
+    return load;
+  }
+
+  LatencyHistogram store_latency;
+  int64_t socket_backlog = 0;
+  stats->runForEach([&](Stats& s) {
+    if (s.per_shard_histograms) {
+      const MultiScaleHistogram* h =
+          s.per_shard_histograms->store_latency.get(shard_);
+      if (h) {
+        store_latency.merge(*h);
+      }
+    }
+    socket_backlog += s.evbuffer_total_size;
+  });
+
+  // Histograms are cumulative, only look at the stores since the last sample.
+  LatencyHistogram recent = store_latency;
+  recent.subtract(lastStoreLatency_);
+  lastStoreLatency_ = std::move(store_latency);
+
+  load.store_latency_p99 =
+      std::chrono::microseconds(recent.estimatePercentile(.99));
+  load.socket_backlog = std::max(socket_backlog, int64_t(0));
+  return load;
+}
+
+void ShardRebuildingV1::onThrottleTimerExpired() {
+  if (completed_) {
+    return;
+  }
+  SCOPE_EXIT {
+    activateThrottleTimer();
+  };
+
+  auto settings = rebuildingSettings_.get();
+  const size_t prev = getMaxLogsInFlight();
+  size_t limit = prev;
+
+  if (settings->donor_store_latency_target.count() == 0 &&
+      settings->donor_socket_backlog_target == 0) {
+    limit = settings->max_logs_in_flight;
+  } else {
+    ForegroundLoad load = getForegroundLoad();
+    const bool overloaded =
+        (settings->donor_store_latency_target.count() > 0 &&
+         load.store_latency_p99 > settings->donor_store_latency_target) ||
+        (settings->donor_socket_backlog_target > 0 &&
+         load.socket_backlog > settings->donor_socket_backlog_target);
+    if (overloaded) {
+      // Back off quickly so that foreground traffic recovers, then probe for
+      // spare capacity one log at a time.
+      limit = std::max(prev / 2, size_t(1));
+      if (limit < prev) {
+        PER_SHARD_STAT_INCR(getStats(), rebuilding_donor_throttled, shard_);
+        ld_debug("Throttling rebuilding of shard %u to %zu logs in flight: "
+                 "store latency p99 %ldus, socket backlog %zu bytes",
+                 shard_,
+                 limit,
+                 load.store_latency_p99.count(),
+                 load.socket_backlog);
+      }
+    } else {
+      limit = std::min(prev + 1, settings->max_logs_in_flight);
+    }
+  }
+
+  maxLogsInFlight_ = limit < settings->max_logs_in_flight ? limit : 0;
+  PER_SHARD_STAT_SET(
+      getStats(), rebuilding_donor_max_logs_in_flight, shard_, limit);
+
+  if (limit > prev && !isStallTimerActive()) {
+    // Use the new slot. If the stall timer is active, the memory limit is what
+    // holds logs back, and the stall timer will wake them up.
+    wakeUpLogs();
+  }
+}
+
 void ShardRebuildingV1::cancelRestartTimerForLog(logid_t logid) {
   auto it = activeLogs_.find(logid);
   if (it != activeLogs_.end() && it->second.restartTimer) {
@@ -413,8 +508,16 @@ bool ShardRebuildingV1::isLogRebuilding(logid_t logid) {
   return true;
 }
 
-void ShardRebuildingV1::wakeUpLogs() {
+size_t ShardRebuildingV1::getMaxLogsInFlight() const {
   size_t max_logs_in_flight = rebuildingSettings_->max_logs_in_flight;
+  if (maxLogsInFlight_ > 0) {
+    max_logs_in_flight = std::min(max_logs_in_flight, maxLogsInFlight_);
+  }
+  return max_logs_in_flight;
+}
+
+void ShardRebuildingV1::wakeUpLogs() {
+  size_t max_logs_in_flight = getMaxLogsInFlight();
 
   wakeupQueue_.advanceWindow(localWindowEnd_);
 
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "logdevice/common/RebuildingTypes.h"
+#include "logdevice/common/stats/Histogram.h"
 #include "logdevice/server/LogRebuilding.h"
 #include "logdevice/server/RebuildingWakeupQueue.h"
 
@@ -199,6 +200,39 @@ class ShardRebuildingV1 : public ShardRebuildingInterface {
   virtual void cancelStallTimer();
   virtual bool isStallTimerActive();
 
+  /**
+   * Load that foreground traffic puts on this donor, which rebuilding backs
+   * off from. See rebuilding-donor-store-latency-target and
+   * rebuilding-donor-socket-backlog-target.
+   */
+  struct ForegroundLoad {
+    // p99 latency of stores of appends on this shard since the last sample.
+    std::chrono::microseconds store_latency_p99{0};
+    // Bytes waiting to be written to sockets, across all workers.
+    size_t socket_backlog{0};
+  };
+
+  /**
+   * Samples ForegroundLoad from the stats of all threads. Mocked by tests.
+   */
+  virtual ForegroundLoad getForegroundLoad();
+
+  /**
+   * Schedules onThrottleTimerExpired() after
+   * rebuilding-donor-throttle-interval.
+   */
+  virtual void activateThrottleTimer();
+
+  /**
+   * Adjusts maxLogsInFlight_ to the foreground load: halves it if foreground
+   * traffic is over one of its targets, otherwise increments it up to
+   * rebuilding-max-logs-in-flight.
+   */
+  void onThrottleTimerExpired();
+
+  // How many LogRebuilding state machines may run at the same time.
+  size_t getMaxLogsInFlight() const;
+
  protected:
   /**
    * State maintained per log for which there is an active LogRebuilding state
@@ -357,6 +391,18 @@ class ShardRebuildingV1 : public ShardRebuildingInterface {
   // At most `maxLogsInFlight_`.
   int nRunningLogRebuildings_{0};
 
+  // Limit on nRunningLogRebuildings_ lowered by onThrottleTimerExpired() when
+  // foreground traffic suffers. 0 if the donor isn't throttled, in which case
+  // rebuilding-max-logs-in-flight applies.
+  size_t maxLogsInFlight_{0};
+
+  // Periodically calls onThrottleTimerExpired().
+  std::unique_ptr<Timer> throttleTimer_;
+
+  // store_latency histogram of this shard as of the last call to
+  // getForegroundLoad(), to compute the latencies of the last interval.
+  LatencyHistogram lastStoreLatency_;
+
   // How many logs have reached the end of rebuilding but not durable
   // and hence have the restart timers active
   int nLogRebuildingRestartTimerActive_{0};
@@ -130,10 +130,10 @@ using std::chrono::steady_clock;
 
 void shutdown_server(
     std::unique_ptr<AdminServer>& admin_server,
-    std::unique_ptr<EventLoopHandle>& connection_listener,
+    std::vector<std::unique_ptr<EventLoopHandle>>& connection_listeners,
     std::unique_ptr<EventLoopHandle>& command_listener,
     std::unique_ptr<EventLoopHandle>& gossip_listener,
-    std::unique_ptr<EventLoopHandle>& ssl_connection_listener,
+    std::vector<std::unique_ptr<EventLoopHandle>>& ssl_connection_listeners,
     std::unique_ptr<LogStoreMonitor>& logstore_monitor,
     std::shared_ptr<ServerProcessor>& processor,
     std::unique_ptr<ShardedStorageThreadPool>& storage_thread_pool,
@@ -179,7 +179,7 @@ void shutdown_server(
   // stop accepting new connections
   ld_info("Destroying listeners");
 
-  connection_listener.reset();
+  connection_listeners.clear();
 
   // Save off the thread id for command listener thread. It will be joined after
   // stopping all workers. Joining admin command is avoided at this time because
@@ -200,7 +200,7 @@ void shutdown_server(
     gossip_listener.reset();
   }
 
-  ssl_connection_listener.reset();
+  ssl_connection_listeners.clear();
 
   // set accepting_work to false
   ld_info("Stopping accepting work on all workers except FAILURE_DETECTOR");
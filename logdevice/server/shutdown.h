@@ -9,6 +9,7 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "logdevice/common/WorkerType.h"
 
@@ -36,7 +37,7 @@ class Worker;
  *   1. If fast_shutdown is set to false, call requestFailover on the
  *      SequencerPlacement object to failover currently handled shards to a
  *      different server.
- *   2. Destroys ConnectionListener, CommandListener, GossipListener,
+ *   2. Destroys ConnectionListeners, CommandListener, GossipListener,
  *      SSL connection and command listeners to stop accepting new
  *      connections.
  *   3. accepting_work_ is set to false on all Workers. This prevents worker
@@ -50,10 +51,10 @@ class Worker;
  */
 void shutdown_server(
     std::unique_ptr<AdminServer>& admin_server,
-    std::unique_ptr<EventLoopHandle>& connection_listener,
+    std::vector<std::unique_ptr<EventLoopHandle>>& connection_listeners,
     std::unique_ptr<EventLoopHandle>& command_listener,
     std::unique_ptr<EventLoopHandle>& gossip_listener,
-    std::unique_ptr<EventLoopHandle>& ssl_connection_listener,
+    std::vector<std::unique_ptr<EventLoopHandle>>& ssl_connection_listeners,
     std::unique_ptr<LogStoreMonitor>& logstore_monitor,
     std::shared_ptr<ServerProcessor>& processor,
     std::unique_ptr<ShardedStorageThreadPool>& storage_thread_pool,
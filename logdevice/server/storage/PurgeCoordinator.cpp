@@ -16,6 +16,7 @@
 #include "logdevice/common/debug.h"
 #include "logdevice/common/protocol/CLEANED_Message.h"
 #include "logdevice/common/protocol/CLEAN_Message.h"
+#include "logdevice/common/protocol/RELEASES_Message.h"
 #include "logdevice/common/protocol/RELEASE_Message.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/server/CleanedResponseRequest.h"
@@ -45,7 +46,9 @@ static void broadcastReleaseRequest(LogStorageState* parent,
       ServerWorker::onThisThread()->processor_,
       rid,
       shard,
-      [parent](worker_id_t idx) { return parent->isWorkerSubscribed(idx); },
+      [parent](worker_id_t idx, WorkerType type) {
+        return parent->isWorkerSubscribed(idx, type);
+      },
       force);
 }
 
@@ -222,9 +225,25 @@ Message::Disposition PurgeCoordinator::onReceived(CLEAN_Message* msg,
 
 Message::Disposition PurgeCoordinator::onReceived(RELEASE_Message* msg,
                                                   const Address& from) {
-  ServerWorker* w = ServerWorker::onThisThread();
+  return onRelease(msg->getHeader(), from);
+}
 
-  const RELEASE_Header& header = msg->getHeader();
+Message::Disposition PurgeCoordinator::onReceived(RELEASES_Message* msg,
+                                                  const Address& from) {
+  // Read streams of all the logs in the message are notified with one
+  // ReleaseRequest per worker, posted when `batch` goes out of scope.
+  ReleaseRequest::Batch batch;
+  for (const RELEASE_Header& header : msg->releases_) {
+    if (onRelease(header, from) == Message::Disposition::ERROR) {
+      return Message::Disposition::ERROR;
+    }
+  }
+  return Message::Disposition::NORMAL;
+}
+
+Message::Disposition PurgeCoordinator::onRelease(const RELEASE_Header& header,
+                                                 const Address& from) {
+  ServerWorker* w = ServerWorker::onThisThread();
 
   const shard_size_t n_shards = w->getServerConfig()->getNumShards();
   shard_index_t shard = header.shard;
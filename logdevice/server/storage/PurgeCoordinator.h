@@ -31,6 +31,8 @@ class CLEAN_Message;
 class LogStorageState;
 class PurgeUncleanEpochs;
 class RELEASE_Message;
+class RELEASES_Message;
+struct RELEASE_Header;
 enum class ReleaseType : uint8_t;
 
 /**
@@ -57,13 +59,15 @@ class PurgeCoordinator : public LogStorageState_PurgeCoordinator_Bridge {
                    LogStorageState* parent);
 
   /**
-   * Static handlers for incoming CLEAN and RELEASE messages; validates and
-   * hands over to per-log PurgeCoordinator instance.
+   * Static handlers for incoming CLEAN, RELEASE and RELEASES messages;
+   * validates and hands over to per-log PurgeCoordinator instance.
    */
   static Message::Disposition onReceived(CLEAN_Message* msg,
                                          const Address& from);
   static Message::Disposition onReceived(RELEASE_Message* msg,
                                          const Address& from);
+  static Message::Disposition onReceived(RELEASES_Message* msg,
+                                         const Address& from);
 
   //
   // NOTE: all public methods expect the mutex *not* to be held
@@ -185,6 +189,11 @@ class PurgeCoordinator : public LogStorageState_PurgeCoordinator_Bridge {
 
   std::vector<BufferedClean> buffered_clean_;
 
+  // Validates a RELEASE received in a RELEASE or RELEASES message from `from`
+  // and hands it over to the PurgeCoordinator of the log.
+  static Message::Disposition onRelease(const RELEASE_Header& header,
+                                        const Address& from);
+
   // Part of the lock-free path of processing RELEASE messages, called after
   // onReleaseMessage() has ascertained that all earlier epochs are clean and
   // we can process the RELEASE.  Updates the LogStorageStateMap and
@@ -233,6 +233,21 @@ void PurgeSingleEpoch::purgeRecords() {
                                      : "n/a");
 
   // delete every record in [start, end] in this epoch
+  if (driver_ != nullptr && driver_->getSettings().purging_batch_deletes &&
+      end_esn.val_ - start_esn.val_ <=
+          PurgeDeleteRecordsStorageTask::PURGE_DELETE_BY_KEY_THRESHOLD - 1) {
+    PurgingTracer::traceRecordPurge(
+        Worker::onThisThread()->processor_->getTraceLogger().get(),
+        log_id_,
+        epoch_,
+        ESN_INVALID,
+        start_esn,
+        end_esn,
+        true);
+    startStorageTask(std::make_unique<PurgeDeleteRecordsWriteStorageTask>(
+        log_id_, epoch_, start_esn, end_esn, ref_holder_.ref()));
+    return;
+  }
   startStorageTask(std::make_unique<PurgeDeleteRecordsStorageTask>(
       log_id_, epoch_, start_esn, end_esn, ref_holder_.ref()));
 }
@@ -541,6 +556,67 @@ void PurgeDeleteRecordsStorageTask::onDropped() {
   onDone();
 }
 
+///////// PurgeDeleteRecordsWriteStorageTask
+
+PurgeDeleteRecordsWriteStorageTask::PurgeDeleteRecordsWriteStorageTask(
+    logid_t log_id,
+    epoch_t epoch,
+    esn_t start_esn,
+    esn_t end_esn,
+    WeakRef<PurgeSingleEpoch> driver)
+    : WriteStorageTask(StorageTask::Type::PURGE_DELETE_RECORDS),
+      driver_(std::move(driver)) {
+  ld_check(start_esn <= end_esn);
+  ld_check(end_esn.val_ - start_esn.val_ <
+           PurgeDeleteRecordsStorageTask::PURGE_DELETE_BY_KEY_THRESHOLD);
+
+  if (MetaDataLog::isMetaDataLog(log_id)) {
+    ld_info("Maybe deleting metadata log records; log: %lu epoch: %u "
+            "start esn: %u end esn: %u",
+            log_id.val_,
+            epoch.val_,
+            start_esn.val_,
+            end_esn.val_);
+  }
+
+  const size_t num_keys = end_esn.val_ - start_esn.val_ + 1;
+  deletes_.reserve(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    esn_t::raw_type esn = start_esn.val_ + static_cast<esn_t::raw_type>(i);
+    deletes_.emplace_back(log_id, compose_lsn(epoch, esn_t(esn)));
+  }
+}
+
+size_t
+PurgeDeleteRecordsWriteStorageTask::getWriteOps(const WriteOp** write_ops,
+                                                size_t write_ops_len) const {
+  size_t n = std::min(write_ops_len, deletes_.size());
+  for (size_t i = 0; i < n; ++i) {
+    write_ops[i] = &deletes_[i];
+  }
+  return n;
+}
+
+void PurgeDeleteRecordsWriteStorageTask::onDone() {
+  PurgeSingleEpoch* driver = driver_.get();
+  if (driver == nullptr) {
+    return;
+  }
+  STAT_INCR(driver->getStats(), purging_v2_delete_by_keys);
+  STAT_INCR(driver->getStats(), purging_delete_done);
+  // Failing to write the batch is a permanent error, as it is for
+  // PurgeDeleteRecordsStorageTask.
+  driver->onPurgeRecordsTaskDone(status_ == E::OK ? E::OK : E::FAILED);
+}
+
+void PurgeDeleteRecordsWriteStorageTask::onDropped() {
+  PurgeSingleEpoch* driver = driver_.get();
+  if (driver != nullptr) {
+    STAT_INCR(driver->getStats(), purging_task_dropped);
+    driver->onPurgeRecordsTaskDone(E::DROPPED);
+  }
+}
+
 ///////// PurgeWriteEpochRecoveryMetadataStorageTask
 
 void PurgeWriteEpochRecoveryMetadataStorageTask::execute() {
@@ -16,6 +16,7 @@
 #include "logdevice/common/WeakRefHolder.h"
 #include "logdevice/common/WorkerCallbackHelper.h"
 #include "logdevice/server/storage/SealStorageTask.h"
+#include "logdevice/server/storage_tasks/WriteStorageTask.h"
 
 namespace facebook { namespace logdevice {
 
@@ -150,6 +151,11 @@ class PurgeDeleteRecordsStorageTask : public StorageTask {
     return ThreadType::METADATA;
   }
 
+  // if the ESN range contains less or equal number of records than this
+  // threshold, delete key by key directly. Otherwise, create an iterator
+  // to read actual records for deletion
+  static const size_t PURGE_DELETE_BY_KEY_THRESHOLD = 4096;
+
   Durability durability() const override {
     // do not require syncing the delete task immediately.
     // The reason is that local LCE is advanced after delete is completed, so
@@ -165,11 +171,42 @@ class PurgeDeleteRecordsStorageTask : public StorageTask {
   const esn_t end_esn_;
   WeakRef<PurgeSingleEpoch> driver_;
   Status status_;
+};
 
-  // if the ESN range contains less or equal number of records than this
-  // threshold, delete key by key directly. Otherwise, create an iterator
-  // to read actual records for deletion
-  static const size_t PURGE_DELETE_BY_KEY_THRESHOLD = 4096;
+/**
+ * Deletes all keys of an ESN range of at most PURGE_DELETE_BY_KEY_THRESHOLD
+ * ESNs, like PurgeDeleteRecordsStorageTask does, but as a WriteStorageTask.
+ * It goes to the write queue of the shard, from which WriteBatchStorageTask
+ * writes the deletes of all logs being purged at the same time in one
+ * writeMulti(), instead of one storage task and write batch per epoch of each
+ * log. Used if --purging-batch-deletes is set.
+ */
+class PurgeDeleteRecordsWriteStorageTask : public WriteStorageTask {
+ public:
+  PurgeDeleteRecordsWriteStorageTask(logid_t log_id,
+                                     epoch_t epoch,
+                                     esn_t start_esn,
+                                     esn_t end_esn,
+                                     WeakRef<PurgeSingleEpoch> driver);
+
+  void onDone() override;
+  void onDropped() override;
+
+  size_t getNumWriteOps() const override {
+    return deletes_.size();
+  }
+
+  size_t getWriteOps(const WriteOp** write_ops,
+                     size_t write_ops_len) const override;
+
+  bool allowIfStoreIsNotAcceptingWrites(Status status) const override {
+    // deletes free space
+    return status == E::NOSPC;
+  }
+
+ private:
+  std::vector<DeleteWriteOp> deletes_;
+  WeakRef<PurgeSingleEpoch> driver_;
 };
 
 class PurgeWriteEpochRecoveryMetadataStorageTask : public StorageTask {
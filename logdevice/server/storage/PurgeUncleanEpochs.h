@@ -186,6 +186,8 @@ class PurgeUncleanEpochs : public IntrusiveUnorderedMapHook {
     return stats_;
   }
 
+  virtual const Settings& getSettings() const;
+
   // delay used to retry on various stage of the purging process
   static const std::chrono::milliseconds INITIAL_RETRY_DELAY;
   static const std::chrono::milliseconds MAX_RETRY_DELAY;
@@ -314,7 +316,6 @@ class PurgeUncleanEpochs : public IntrusiveUnorderedMapHook {
   void writeLastClean();
 
   void allEpochsPurged();
-  virtual const Settings& getSettings() const;
 
   // return the replication attribute for the metadata log, fetched from the
   // config
@@ -293,6 +293,7 @@ bool SealStorageTask::getEpochInfoFromCache(LocalLogStore& /*store*/,
 
     if (from_cache) {
       STAT_INCR(stats, record_cache_seal_hit);
+      PER_SHARD_STAT_INCR(stats, record_cache_seal_hit, getShardIdx());
       if (!MetaDataLog::isMetaDataLog(log_id_)) {
         STAT_INCR(stats, record_cache_seal_hit_datalog);
       }
@@ -301,6 +302,7 @@ bool SealStorageTask::getEpochInfoFromCache(LocalLogStore& /*store*/,
       tail_records_ = std::move(tail_records);
     } else {
       STAT_INCR(stats, record_cache_seal_miss);
+      PER_SHARD_STAT_INCR(stats, record_cache_seal_miss, getShardIdx());
       if (!MetaDataLog::isMetaDataLog(log_id_)) {
         STAT_INCR(stats, record_cache_seal_miss_datalog);
       }
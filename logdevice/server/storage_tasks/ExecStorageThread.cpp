@@ -7,6 +7,7 @@
  */
 #include "ExecStorageThread.h"
 
+#include <algorithm>
 #include <chrono>
 
 #include "logdevice/common/SlowStorageTasksTracer.h"
@@ -32,64 +33,132 @@ void ExecStorageThread::run() {
       settings->slow_ioprio.hasValue()) {
     set_io_priority_of_this_thread(settings->slow_ioprio.value());
   }
+  if (!settings->storage_thread_numa_nodes.empty()) {
+    const auto& nodes = settings->storage_thread_numa_nodes;
+    bind_this_thread_to_numa_node(nodes[pool_->getShardIdx() % nodes.size()]);
+  }
 
   while (shouldProcessTasks_) {
+    // Execute the reads held back by the read scheduler before waiting for
+    // new tasks.
+    auto held = pool_->takeHeldReads(thread_type_, /* only_if_idle */ true);
+    if (!held.empty()) {
+      for (auto& held_task : held) {
+        processTask(std::move(held_task));
+      }
+      continue;
+    }
+
     std::unique_ptr<StorageTask> task = pool_->blockingGetTask(thread_type_);
-    task->setStorageThread(this);
+    auto batch = pool_->tryGetReadBatch(thread_type_, *task);
+    if (task->getReadPosition().hasValue() &&
+        pool_->hasReadScheduler(thread_type_)) {
+      // The read scheduler decides what to execute now; it may be tasks
+      // taken by other threads earlier.
+      batch.push_back(std::move(task));
+      for (auto& scheduled :
+           pool_->scheduleReads(thread_type_, std::move(batch))) {
+        processTask(std::move(scheduled));
+      }
+      continue;
+    }
+    if (batch.empty()) {
+      processTask(std::move(task));
+      // Other tasks mustn't keep the held reads waiting for an idle queue
+      // forever.
+      for (auto& held_task :
+           pool_->takeHeldReads(thread_type_, /* only_if_idle */ false)) {
+        processTask(std::move(held_task));
+      }
+      continue;
+    }
 
-    // Maintain stats for queueing latency.
-    auto queueing_usec = usec_since(task->enqueue_time_);
-    if (task->reply_shard_idx_ != -1) {
-      PER_SHARD_HISTOGRAM_ADD(
-          pool_->stats(),
-          storage_threads_queue_time[static_cast<int>(thread_type_)],
-          task->reply_shard_idx_,
-          queueing_usec);
+    // Execute the reads in key order, so that each one finds the blocks of
+    // the previous one in cache.
+    batch.push_back(std::move(task));
+    std::sort(batch.begin(), batch.end(), [](const auto& a, const auto& b) {
+      return a->getReadPosition() < b->getReadPosition();
+    });
+    STAT_INCR(pool_->stats(), storage_read_batches);
+    STAT_ADD(pool_->stats(), storage_read_batched_tasks, batch.size());
+    for (auto& batched_task : batch) {
+      processTask(std::move(batched_task));
+    }
+  }
+
+  // Don't leave reads behind if the other threads stopped already.
+  for (auto& held : pool_->takeAllHeldReads(thread_type_)) {
+    processTask(std::move(held));
+  }
+}
+
+void ExecStorageThread::processTask(std::unique_ptr<StorageTask> task) {
+  task->setStorageThread(this);
+
+  // Maintain stats for queueing latency.
+  auto queueing_usec = usec_since(task->enqueue_time_);
+  if (task->reply_shard_idx_ != -1) {
+    PER_SHARD_HISTOGRAM_ADD(
+        pool_->stats(),
+        storage_threads_queue_time[static_cast<int>(thread_type_)],
+        task->reply_shard_idx_,
+        queueing_usec);
+    PER_SHARD_HISTOGRAM_ADD(
+        pool_->stats(),
+        storage_task_queue_time[static_cast<int>(task->getType())],
+        task->reply_shard_idx_,
+        queueing_usec);
+    if (task->getPriority() < StorageTask::Priority::NUM_PRIORITIES) {
       PER_SHARD_HISTOGRAM_ADD(
           pool_->stats(),
-          storage_task_queue_time[static_cast<int>(task->getType())],
+          storage_task_priority_queue_time[static_cast<int>(
+              task->getPriority())],
           task->reply_shard_idx_,
           queueing_usec);
     }
+  }
 
-    auto execution_start_time = std::chrono::steady_clock::now();
-    task->execute();
-    auto execution_end_time = std::chrono::steady_clock::now();
-    auto usec = SystemTimestamp(execution_end_time - execution_start_time)
-                    .toMicroseconds()
-                    .count();
-    STORAGE_TASK_TYPE_STAT_INCR(
-        pool_->stats(), task->getType(), storage_tasks_executed);
-    STORAGE_TASK_TYPE_STAT_ADD(
-        pool_->stats(), task->getType(), storage_thread_usec, usec);
+  auto execution_start_time = std::chrono::steady_clock::now();
+  task->execute();
+  auto execution_end_time = std::chrono::steady_clock::now();
+  auto usec = SystemTimestamp(execution_end_time - execution_start_time)
+                  .toMicroseconds()
+                  .count();
+  STORAGE_TASK_TYPE_STAT_INCR(
+      pool_->stats(), task->getType(), storage_tasks_executed);
+  STORAGE_TASK_TYPE_STAT_ADD(
+      pool_->stats(), task->getType(), storage_thread_usec, usec);
+  if (auto read_pos = task->getReadPosition()) {
+    LOG_HEAVY_HITTER_ADD(
+        pool_->stats(), STORAGE_TASK_USEC, read_pos->first, usec);
+  }
 
-    // Maintaining stats for execution latency.
-    if (task->reply_shard_idx_ != -1) {
-      if (task->getType() != StorageTask::Type::UNKNOWN) {
-        PER_SHARD_HISTOGRAM_ADD(
-            pool_->stats(),
-            storage_tasks[static_cast<int>(task->getType())],
-            task->reply_shard_idx_,
-            usec);
-      }
+  // Maintaining stats for execution latency.
+  if (task->reply_shard_idx_ != -1) {
+    if (task->getType() != StorageTask::Type::UNKNOWN) {
+      PER_SHARD_HISTOGRAM_ADD(
+          pool_->stats(),
+          storage_tasks[static_cast<int>(task->getType())],
+          task->reply_shard_idx_,
+          usec);
     }
+  }
 
-    // If we are running on a slow thread, post samples to Scuba
-    if (task->getThreadType() == StorageTask::ThreadType::SLOW) {
-      SlowStorageTasksTracer logger{pool_->getTraceLogger()};
-      StorageTaskDebugInfo info = task->getDebugInfo();
-      info.execution_start_time =
-          toSystemTimestamp(execution_start_time).toMilliseconds();
-      info.execution_end_time =
-          toSystemTimestamp(execution_end_time).toMilliseconds();
-      logger.traceStorageTask(info);
-    }
+  // If we are running on a slow thread, post samples to Scuba
+  if (task->getThreadType() == StorageTask::ThreadType::SLOW) {
+    SlowStorageTasksTracer logger{pool_->getTraceLogger()};
+    StorageTaskDebugInfo info = task->getDebugInfo();
+    info.execution_start_time =
+        toSystemTimestamp(execution_start_time).toMilliseconds();
+    info.execution_end_time =
+        toSystemTimestamp(execution_end_time).toMilliseconds();
+    logger.traceStorageTask(info);
+  }
 
-    if (task->durability() == Durability::SYNC_WRITE) {
-      pool_->enqueueForSync(std::move(task));
-    } else {
-      StorageTaskResponse::sendBackToWorker(std::move(task));
-    }
+  if (task->durability() == Durability::SYNC_WRITE) {
+    pool_->enqueueForSync(std::move(task));
+  } else {
+    StorageTaskResponse::sendBackToWorker(std::move(task));
   }
 }
 }} // namespace facebook::logdevice
@@ -55,6 +55,10 @@ class ExecStorageThread : public StorageThread {
   }
 
  private:
+  // Executes `task` and sends it back to its worker (or to the syncing
+  // thread).
+  void processTask(std::unique_ptr<StorageTask> task);
+
   // What kind of storage tasks does this thread execute
   StorageTask::ThreadType thread_type_;
 
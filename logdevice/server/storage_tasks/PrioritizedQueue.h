@@ -7,8 +7,10 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -16,7 +18,7 @@
 #include <folly/MPMCQueue.h>
 #include <folly/SharedMutex.h>
 #include <folly/small_vector.h>
-#include <logdevice/common/Semaphore.h>
+#include <folly/synchronization/LifoSem.h>
 #include <logdevice/common/debug.h>
 #include <logdevice/common/stats/Stats.h>
 #include <logdevice/common/util.h>
@@ -26,16 +28,55 @@
  *        Strict priority can be relaxed by providing a yield schedule
  *        that causes priorities to be periodically masked from consideration
  *        during read attempts of the queue.
+ *
+ *        Each priority lane is a lock-free folly::MPMCQueue and the count of
+ *        queued items is kept in a folly::LifoSem, so that producers (one per
+ *        worker) and storage threads don't serialize on any lock in the
+ *        common case.
+ *
+ *        Items with a deadline go to a separate lane of their priority,
+ *        ordered earliest deadline first and read before the other items of
+ *        that priority. These lanes are guarded by a mutex, but are only
+ *        locked when they're not empty.
  */
 namespace facebook { namespace logdevice {
 
 template <class T, size_t NumPriorities>
 class PrioritizedQueue {
  public:
-  PrioritizedQueue(size_t size, StatsHolder* stats) : stats_(stats) {
+  // Which set of per-priority queues an item is written to.
+  enum class Lane {
+    REGULAR,
+    // Only consumed by trySteal() in addition to regular reads.
+    STEALABLE,
+    // Also consumed by readBatchable().
+    BATCHABLE,
+  };
+
+  // If `stealable_size` (`batchable_size`) is nonzero, the queue also keeps a
+  // separate set of per-priority queues of that size for items written to
+  // Lane::STEALABLE (Lane::BATCHABLE). Readers of the queue consume all kinds
+  // of items, trySteal() and readBatchable() only consume their own lane.
+  // Items written to a lane the queue was created without go to the regular
+  // queues.
+  PrioritizedQueue(size_t size,
+                   StatsHolder* stats,
+                   size_t stealable_size = 0,
+                   size_t batchable_size = 0)
+      : deadline_lane_capacity_(size), stats_(stats) {
     for (size_t i = 0; i < NumPriorities; ++i) {
       queues_.emplace_back(size);
     }
+    if (stealable_size > 0) {
+      for (size_t i = 0; i < NumPriorities; ++i) {
+        stealable_queues_.emplace_back(stealable_size);
+      }
+    }
+    if (batchable_size > 0) {
+      for (size_t i = 0; i < NumPriorities; ++i) {
+        batchable_queues_.emplace_back(batchable_size);
+      }
+    }
   }
 
   size_t getPriority(const T& task) {
@@ -44,39 +85,106 @@ class PrioritizedQueue {
     ld_check(rv < NumPriorities);
     return rv;
   }
-  bool writeIfNotFull(T task) {
+  bool writeIfNotFull(T task, Lane lane = Lane::REGULAR) {
     shared_lock<folly::SharedMutex> l(introspection_mutex_);
-    bool rv = queues_[getPriority(task)].writeIfNotFull(task);
+    bool rv = queueFor(getPriority(task), lane).writeIfNotFull(task);
     if (rv) {
       sem_.post();
     }
     return rv;
   }
-  void blockingWrite(T task) {
+  void blockingWrite(T task, Lane lane = Lane::REGULAR) {
     shared_lock<folly::SharedMutex> l(introspection_mutex_);
-    queues_[getPriority(task)].blockingWrite(task);
+    queueFor(getPriority(task), lane).blockingWrite(task);
     sem_.post();
   }
 
+  // Puts the item into the deadline lane of its priority. Returns false if
+  // the lane is full.
+  bool writeWithDeadline(T task,
+                         std::chrono::steady_clock::time_point deadline) {
+    shared_lock<folly::SharedMutex> l(introspection_mutex_);
+    DeadlineLane& lane = deadline_lanes_[getPriority(task)];
+    {
+      std::lock_guard<std::mutex> lane_lock(lane.mutex);
+      if (lane.heap.size() >= deadline_lane_capacity_) {
+        return false;
+      }
+      lane.heap.emplace_back(deadline, task);
+      std::push_heap(lane.heap.begin(), lane.heap.end(), LaterDeadline());
+      lane.size.store(lane.heap.size());
+    }
+    sem_.post();
+    return true;
+  }
+
   void blockingRead(T& out) {
     sem_.wait();
     readQueueGuaranteedNonEmpty(out);
   }
 
   bool read(T& out) {
-    if (!sem_.try_wait()) {
+    if (!sem_.tryWait()) {
       return false;
     }
     readQueueGuaranteedNonEmpty(out);
     return true;
   }
 
+  // Same as blockingRead(), but gives up after `timeout`.
+  bool timedRead(T& out, std::chrono::milliseconds timeout) {
+    if (!sem_.try_wait_for(timeout)) {
+      return false;
+    }
+    readQueueGuaranteedNonEmpty(out);
+    return true;
+  }
+
+  // Same as read(), but only takes items that were written as stealable,
+  // highest priority first.
+  bool trySteal(T& out) {
+    if (stealable_queues_.empty() || !sem_.tryWait()) {
+      return false;
+    }
+    shared_lock<folly::SharedMutex> l(introspection_mutex_);
+
+    for (int pri = NumPriorities - 1; pri >= 0; --pri) {
+      if (stealable_queues_[pri].readIfNotEmpty(out)) {
+        return true;
+      }
+    }
+    // The semaphore was accounting for a non-stealable item, give it back.
+    sem_.post();
+    return false;
+  }
+
+  // Reads up to `max_count` items written to Lane::BATCHABLE at priority
+  // `pri`, without blocking.
+  folly::small_vector<T, 4> readBatchable(size_t pri, size_t max_count) {
+    folly::small_vector<T, 4> res;
+    if (batchable_queues_.empty()) {
+      return res;
+    }
+    shared_lock<folly::SharedMutex> l(introspection_mutex_);
+
+    T item;
+    while (res.size() < max_count && sem_.tryWait()) {
+      if (!batchable_queues_[pri].readIfNotEmpty(item)) {
+        // The semaphore was accounting for some other item, give it back.
+        sem_.post();
+        break;
+      }
+      res.push_back(std::move(item));
+    }
+    return res;
+  }
+
   void readQueueGuaranteedNonEmpty(T& out) {
     shared_lock<folly::SharedMutex> l(introspection_mutex_);
 
     // Highest to lowest, yielding if required due to the yield schedule.
     for (int pri = NumPriorities - 1; pri >= 0; --pri) {
-      if (queues_[pri].readIfNotEmpty(out)) {
+      if (readIfNotEmpty(pri, out)) {
         return;
       }
     }
@@ -98,7 +206,7 @@ class PrioritizedQueue {
 
     for (int i = 0;; i++) {
       for (int pri = 0; pri < NumPriorities; ++pri) {
-        if (queues_[pri].readIfNotEmpty(out)) {
+        if (readIfNotEmpty(pri, out)) {
           return;
         }
       }
@@ -120,14 +228,14 @@ class PrioritizedQueue {
 
   // same as read(), but reads at the specified priority only
   bool readPriority(size_t pri, T& out) {
-    if (!sem_.try_wait()) {
+    if (!sem_.tryWait()) {
       return false;
     }
     shared_lock<folly::SharedMutex> l(introspection_mutex_);
 
     // using readIfNotEmpty() below instead of read() as we can't afford to
     // not ship a queue entry after decrementing the semaphore
-    if (queues_[pri].readIfNotEmpty(out)) {
+    if (readIfNotEmpty(pri, out)) {
       return true;
     } else {
       // We have to bump the semaphore back so someone else could pop that
@@ -172,8 +280,18 @@ class PrioritizedQueue {
     for (auto& q : queues_) {
       res += q.size();
     }
+    for (auto& q : stealable_queues_) {
+      res += q.size();
+    }
+    for (auto& q : batchable_queues_) {
+      res += q.size();
+    }
+    for (auto& lane : deadline_lanes_) {
+      res += lane.size.load();
+    }
     return res;
   }
+  // Capacity of the regular queues only.
   ssize_t max_capacity() const {
     shared_lock<folly::SharedMutex> l(introspection_mutex_);
     ssize_t res = 0;
@@ -190,25 +308,111 @@ class PrioritizedQueue {
   void introspect_contents(std::function<void(T&)> cb) {
     std::unique_lock<folly::SharedMutex> l(introspection_mutex_);
     for (int pri = NumPriorities - 1; pri >= 0; --pri) {
-      std::vector<T> queue_contents;
-      T out;
-      while (queues_[pri].read(out)) {
-        cb(out);
-        queue_contents.push_back(std::move(out));
+      {
+        DeadlineLane& lane = deadline_lanes_[pri];
+        std::lock_guard<std::mutex> lane_lock(lane.mutex);
+        auto entries = lane.heap;
+        std::sort(entries.begin(), entries.end(), [](auto& a, auto& b) {
+          return a.first < b.first;
+        });
+        for (auto& entry : entries) {
+          cb(entry.second);
+        }
       }
-      for (T& item : queue_contents) {
-        queues_[pri].blockingWrite(std::move(item));
+      for (std::vector<folly::MPMCQueue<T>>* lane :
+           {&queues_, &stealable_queues_, &batchable_queues_}) {
+        if (lane->empty()) {
+          continue;
+        }
+        auto& q = (*lane)[pri];
+        std::vector<T> queue_contents;
+        T out;
+        while (q.read(out)) {
+          cb(out);
+          queue_contents.push_back(std::move(out));
+        }
+        for (T& item : queue_contents) {
+          q.blockingWrite(std::move(item));
+        }
       }
     }
   }
 
  private:
+  folly::MPMCQueue<T>& queueFor(size_t pri, Lane lane) {
+    switch (lane) {
+      case Lane::STEALABLE:
+        if (!stealable_queues_.empty()) {
+          return stealable_queues_[pri];
+        }
+        break;
+      case Lane::BATCHABLE:
+        if (!batchable_queues_.empty()) {
+          return batchable_queues_[pri];
+        }
+        break;
+      case Lane::REGULAR:
+        break;
+    }
+    return queues_[pri];
+  }
+
+  bool readIfNotEmpty(size_t pri, T& out) {
+    return readDeadlineLane(pri, out) || queues_[pri].readIfNotEmpty(out) ||
+        (!stealable_queues_.empty() &&
+         stealable_queues_[pri].readIfNotEmpty(out)) ||
+        (!batchable_queues_.empty() &&
+         batchable_queues_[pri].readIfNotEmpty(out));
+  }
+
+  bool readDeadlineLane(size_t pri, T& out) {
+    DeadlineLane& lane = deadline_lanes_[pri];
+    if (lane.size.load() == 0) {
+      return false;
+    }
+    std::lock_guard<std::mutex> lane_lock(lane.mutex);
+    if (lane.heap.empty()) {
+      return false;
+    }
+    std::pop_heap(lane.heap.begin(), lane.heap.end(), LaterDeadline());
+    out = std::move(lane.heap.back().second);
+    lane.heap.pop_back();
+    lane.size.store(lane.heap.size());
+    return true;
+  }
+
   // Fixed integer math scale factor for testing ratio of read attempts
   // to yields for each priority class.
   static constexpr int64_t YIELD_SCALE = 1000;
   std::vector<folly::MPMCQueue<T>> queues_;
+  // Empty if the queue was created without stealable capacity.
+  std::vector<folly::MPMCQueue<T>> stealable_queues_;
+  // Empty if the queue was created without batchable capacity.
+  std::vector<folly::MPMCQueue<T>> batchable_queues_;
+
+  using DeadlineEntry = std::pair<std::chrono::steady_clock::time_point, T>;
+
+  struct LaterDeadline {
+    bool operator()(const DeadlineEntry& a, const DeadlineEntry& b) const {
+      return a.first > b.first;
+    }
+  };
+
+  struct DeadlineLane {
+    std::mutex mutex;
+    // Min-heap by deadline.
+    std::vector<DeadlineEntry> heap;
+    // heap.size(), readable without locking the mutex.
+    std::atomic<size_t> size{0};
+  };
+
+  std::array<DeadlineLane, NumPriorities> deadline_lanes_;
+  const size_t deadline_lane_capacity_;
 
-  Semaphore sem_;
+  // Number of items in all the queues. Unlike Semaphore, posting to it
+  // doesn't touch a shared refcount or take a lock, and it wakes up the most
+  // recently blocked consumer, whose cache is likely still warm.
+  folly::LifoSem sem_;
 
   /**
    * The pointer to stats.
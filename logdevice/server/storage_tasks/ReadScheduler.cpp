@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "ReadScheduler.h"
+
+#include <algorithm>
+
+#include "logdevice/common/checks.h"
+
+namespace facebook { namespace logdevice {
+
+ReadScheduler::TaskVector ReadScheduler::schedule(TaskVector tasks) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  for (auto& task : tasks) {
+    ld_check(task->getReadPosition().hasValue());
+    const ClientID client = task->getReadClient();
+    ClientQueue& queue = clients_[client];
+    if (queue.tasks.empty()) {
+      ring_.push_back(client);
+    }
+    queue.tasks.push_back(std::move(task));
+    ++held_;
+  }
+
+  // Take out at least one group, so that the storage thread stays busy, and
+  // enough to get back within the window.
+  const size_t to_dispatch = held_ > window_ ? held_ - window_ : 1;
+  TaskVector res;
+  while (res.size() < to_dispatch) {
+    dispatchGroup(res);
+  }
+  return res;
+}
+
+ReadScheduler::TaskVector ReadScheduler::takeNextGroup() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  TaskVector res;
+  if (held_ > 0) {
+    dispatchGroup(res);
+  }
+  return res;
+}
+
+ReadScheduler::TaskVector ReadScheduler::takeAll() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  TaskVector res;
+  while (held_ > 0) {
+    dispatchGroup(res);
+  }
+  return res;
+}
+
+size_t ReadScheduler::numHeld() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return held_;
+}
+
+void ReadScheduler::dispatchGroup(TaskVector& out) {
+  ld_check(held_ > 0);
+  ld_check(!ring_.empty());
+
+  // Skip the clients that already got their turn.
+  while (true) {
+    ClientQueue& queue = clients_.at(ring_.front());
+    if (queue.turns_ahead == 0) {
+      break;
+    }
+    --queue.turns_ahead;
+    ring_.push_back(ring_.front());
+    ring_.pop_front();
+  }
+
+  const ClientID client = ring_.front();
+  ring_.pop_front();
+  ClientQueue& queue = clients_.at(client);
+  ld_check(!queue.tasks.empty());
+
+  const size_t group_start = out.size();
+  const logid_t log = queue.tasks.front()->getReadPosition()->first;
+  out.push_back(std::move(queue.tasks.front()));
+  queue.tasks.pop_front();
+  --held_;
+
+  // Other reads of the same log go along, whichever client they are for.
+  for (auto& kv : clients_) {
+    auto& tasks = kv.second.tasks;
+    for (auto it = tasks.begin(); it != tasks.end();) {
+      if ((*it)->getReadPosition()->first != log) {
+        ++it;
+        continue;
+      }
+      out.push_back(std::move(*it));
+      it = tasks.erase(it);
+      --held_;
+      ++kv.second.turns_ahead;
+    }
+  }
+  std::sort(out.begin() + group_start,
+            out.end(),
+            [](const auto& a, const auto& b) {
+              return a->getReadPosition() < b->getReadPosition();
+            });
+
+  if (!queue.tasks.empty()) {
+    ring_.push_back(client);
+  }
+  // Forget the clients that don't have held tasks anymore.
+  ring_.erase(std::remove_if(ring_.begin(),
+                             ring_.end(),
+                             [&](const ClientID& c) {
+                               return clients_.at(c).tasks.empty();
+                             }),
+              ring_.end());
+  for (auto it = clients_.begin(); it != clients_.end();) {
+    it = it->second.tasks.empty() ? clients_.erase(it) : std::next(it);
+  }
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <folly/small_vector.h>
+
+#include "logdevice/common/ClientID.h"
+#include "logdevice/server/storage_tasks/StorageTask.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file  Orders the read tasks of one shard (and thread type) taken from the
+ *        StorageThreadPool queue, which gathers the reads of all workers.
+ *        Instead of executing them in the order workers happened to post
+ *        them, storage threads hand them to this scheduler, which keeps up to
+ *        --storage-thread-read-scheduler-window of them aside (once the
+ *        window is full, as many go out as come in) and dispatches:
+ *         - clients in round-robin order, so that a client with many read
+ *           streams doesn't get more disk time than others just because all
+ *           its streams are queued;
+ *         - along with each task, the other held tasks reading the same log,
+ *           sorted by LSN, so that they are served by mostly sequential I/O.
+ *           These count as turns of their clients, which are skipped later.
+ *
+ *        Storage threads execute held tasks whenever there is nothing else in
+ *        the queue, and after each other task. All methods are thread safe.
+ */
+class ReadScheduler {
+ public:
+  using TaskVector = folly::small_vector<std::unique_ptr<StorageTask>, 4>;
+
+  explicit ReadScheduler(size_t window) : window_(window) {}
+
+  /**
+   * Adds `tasks`, which must all have a read position (see
+   * StorageTask::getReadPosition()), to the held tasks, and takes out at
+   * least one group of tasks, more if the window is exceeded.
+   *
+   * @return  the tasks to execute now, in order
+   */
+  TaskVector schedule(TaskVector tasks);
+
+  /**
+   * Takes the next group of tasks to execute; empty if there are none.
+   */
+  TaskVector takeNextGroup();
+
+  /**
+   * Takes all held tasks. Called by storage threads that stop, so that the
+   * held tasks are not lost.
+   */
+  TaskVector takeAll();
+
+  size_t numHeld() const;
+
+ private:
+  struct ClientQueue {
+    std::deque<std::unique_ptr<StorageTask>> tasks;
+    // Number of turns the client was already given by having its tasks
+    // dispatched along with the first task of a group.
+    size_t turns_ahead{0};
+  };
+
+  // Dispatches the next group of tasks into `out`. Requires held_ > 0.
+  void dispatchGroup(TaskVector& out);
+
+  const size_t window_;
+
+  mutable std::mutex mutex_;
+
+  std::unordered_map<ClientID, ClientQueue, ClientID::Hash> clients_;
+
+  // Clients with held tasks, in the order of their turns.
+  std::deque<ClientID> ring_;
+
+  // Number of tasks held in clients_.
+  size_t held_{0};
+};
+
+}} // namespace facebook::logdevice
@@ -15,6 +15,7 @@
 #include <folly/synchronization/Baton.h>
 
 #include "logdevice/common/AdminCommandTable.h"
+#include "logdevice/common/JemallocArenas.h"
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/Sender.h"
 #include "logdevice/common/debug.h"
@@ -180,7 +181,9 @@ void ReadStorageTask::releaseRecords() {
         w->stats(), read_storage_tasks_allocated_records_bytes, total_bytes_);
   }
 
-  ld_check(memory_token_.valid());
+  // The token is invalid if it was handed over to a prefetched batch along
+  // with the records.
+  ld_check(memory_token_.valid() || is_prefetch_);
   memory_token_.release();
 }
 
@@ -204,11 +207,21 @@ void ReadStorageTask::getDebugInfoDetailed(StorageTaskDebugInfo& info) const {
 }
 
 int StorageThreadCallback::processRecord(const RawRecord& record) {
+  if (record.filtered_out) {
+    records_.emplace_back(record.lsn,
+                          Slice(),
+                          /*owned*/ false,
+                          record.from_under_replicated_region);
+    records_.back().filtered_out = true;
+    return 0;
+  }
+
   // When doing local log store reads on a storage thread, we need to copy the
   // data out of the local log store into a malloc'd buffer, since records
   // will only get passed to the messaging layer at some later time (when the
   // worker thread gets around to processing the ReadStorageTask result).
-  void* blob_copy = malloc(record.blob.size);
+  void* blob_copy = JemallocArenas::mallocTagged(
+      AllocationTag::READ_BUFFERS, record.blob.size);
   if (blob_copy == nullptr) {
     throw std::bad_alloc();
   }
@@ -94,6 +94,20 @@ class ReadStorageTask : public StorageTask {
     return is_tailer_ ? Priority::HIGH : Priority::MID;
   }
 
+  bool isStealable() const override {
+    // Tailing reads are usually served from the memtable or block cache, so
+    // they are bound by CPU rather than by the disk of their shard.
+    return is_tailer_;
+  }
+
+  folly::Optional<std::pair<logid_t, lsn_t>> getReadPosition() const override {
+    return std::make_pair(read_ctx_.logid_, read_ctx_.read_ptr_.lsn);
+  }
+
+  ClientID getReadClient() const override {
+    return client_id_;
+  }
+
   // Used to track if the ServerReadStream for which this task is for has been
   // destroyed.
   WeakRef<ServerReadStream> stream_;
@@ -102,6 +116,10 @@ class ReadStorageTask : public StorageTask {
   // destroyed.
   WeakRef<CatchupQueue> catchup_queue_;
 
+  // True if this task reads the next batch of a backlog stream ahead of time,
+  // see ServerReadStream::PrefetchedBatch.
+  bool is_prefetch_{false};
+
   const server_read_stream_version_t server_read_stream_version_;
   const filter_version_t filter_version_;
   LocalLogStoreReader::ReadContext read_ctx_;
@@ -120,7 +138,9 @@ class ReadStorageTask : public StorageTask {
   //
   typedef std::vector<RawRecord> RecordContainer;
   Status status_{E::UNKNOWN};
-  RecordContainer records_;
+  // Mutable so that CatchupOneStream can move record blobs out of it into
+  // RECORD messages.
+  mutable RecordContainer records_;
   // Total amount of record bytes that were allocated by this storage task.
   // Used for stats.
   size_t total_bytes_{0};
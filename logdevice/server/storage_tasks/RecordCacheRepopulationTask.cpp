@@ -22,31 +22,52 @@
 namespace facebook { namespace logdevice {
 
 void RecordCacheRepopulationTask::execute() {
-  LocalLogStore& shard = storageThreadPool_->getLocalLogStore();
   // the store should not be disabled since we checked before creating the task,
   // therefore getShardIdx() should yield a valid result
-  ld_check(shard.getShardIdx() == shard_idx_);
+  ld_check(storageThreadPool_->getLocalLogStore().getShardIdx() == shard_idx_);
+  switch (stage_) {
+    case Stage::READ_INDEX:
+      readIndex();
+      break;
+    case Stage::REPOPULATE:
+      repopulate();
+      break;
+    case Stage::DELETE:
+      deleteSnapshots();
+      break;
+  }
+}
+
+void RecordCacheRepopulationTask::readIndex() {
+  LocalLogStore& shard = storageThreadPool_->getLocalLogStore();
+  int rv = RecordCachePersistence::readChunkIndex(shard, &chunks_);
+  if (rv != 0 || chunks_.empty()) {
+    if (rv != 0) {
+      ld_error("Failed to read the index of record cache snapshot chunks on "
+               "shard %d. Reading the snapshot as a whole.",
+               shard_idx_);
+    }
+    // No index, e.g. written by an older version; a single chunk covers all
+    // logs.
+    chunks_.assign(
+        1, RecordCachePersistence::SnapshotChunk{LOGID_INVALID,
+                                                 LOGID_MAX_INTERNAL,
+                                                 0});
+  }
+  ld_debug("Repopulating record caches on shard %d from %zu chunks",
+           shard_idx_,
+           chunks_.size());
+  status_ = E::OK;
+}
+
+void RecordCacheRepopulationTask::repopulate() {
+  LocalLogStore& shard = storageThreadPool_->getLocalLogStore();
   ShardedLocalLogStore* sharded_store =
       storageThreadPool_->getProcessor()
           .sharded_storage_thread_pool_->getShardedLocalLogStore();
   LogStorageStateMap& log_storage_state_map =
       storageThreadPool_->getProcessor().getLogStorageStateMap();
-
-  // On exit, always delete all snapshot blobs, so that future instances
-  // do not repopulate record caches from old data!
-  SCOPE_EXIT {
-    int rv = storageThreadPool_->getLocalLogStore().deleteAllLogSnapshotBlobs();
-    if (rv != 0) {
-      ld_critical(
-          "Failed to delete all log snapshot blobs on shard %d", shard_idx_);
-      status_ = E::FAILED;
-    }
-  };
-
-  if (!repopulate_record_caches_) {
-    status_ = E::OK;
-    return;
-  }
+  ld_check(shard_repopulated_bytes_);
 
   ld_check(sharded_store->numShards() > 0);
 
@@ -58,15 +79,21 @@ void RecordCacheRepopulationTask::execute() {
 
   LocalLogStore::LogSnapshotBlobCallback repopulate = [&](logid_t log_id,
                                                           Slice data) {
+    // Reserve the bytes first, other chunks of the shard are repopulated
+    // concurrently.
+    const size_t shard_bytes = shard_repopulated_bytes_->fetch_add(data.size);
     if (bytes_limit_per_shard > 0 &&
-        repopulated_bytes + data.size > bytes_limit_per_shard) {
+        shard_bytes + data.size > bytes_limit_per_shard) {
+      shard_repopulated_bytes_->fetch_sub(data.size);
       ld_error("Repopulating saved snapshot of record cache on shard %d "
                "reached the byte limit of %lu bytes per-shard. Already "
-               "populated %lu bytes. Stop populating record caches on "
-               "this shard.",
+               "populated %lu bytes. Stop populating record caches of logs "
+               "[%lu, %lu] on this shard.",
                shard_idx_,
                bytes_limit_per_shard,
-               repopulated_bytes);
+               shard_bytes,
+               first_log_.val_,
+               last_log_.val_);
       return -1;
     }
 
@@ -78,17 +105,25 @@ void RecordCacheRepopulationTask::execute() {
     if (rv == 0) {
       repopulated_caches++;
       repopulated_bytes += data.size;
+    } else {
+      shard_repopulated_bytes_->fetch_sub(data.size);
     }
     return rv;
   };
 
-  int rv = shard.readAllLogSnapshotBlobs(
-      LocalLogStore::LogSnapshotBlobType::RECORD_CACHE, repopulate);
+  int rv = shard.readLogSnapshotBlobs(
+      LocalLogStore::LogSnapshotBlobType::RECORD_CACHE,
+      first_log_,
+      last_log_,
+      repopulate);
   if (rv == 0) {
     status_ = E::OK;
   } else {
-    ld_error("Failed to read all snapshots on shard %d. Repopulated caches "
-             "for %ju logs so far, totaling %ju bytes",
+    ld_error("Failed to read all snapshots of logs [%lu, %lu] on shard %d. "
+             "Repopulated caches for %ju of these logs so far, totaling %ju "
+             "bytes",
+             first_log_.val_,
+             last_log_.val_,
              shard_idx_,
              repopulated_caches,
              repopulated_bytes);
@@ -96,11 +131,13 @@ void RecordCacheRepopulationTask::execute() {
     STAT_INCR(stats_, record_cache_repopulations_failed);
   }
 
-  ld_info("Repopulated record caches for %ju logs on shard %d, totaling %ju "
-          "bytes.",
-          repopulated_caches,
-          shard_idx_,
-          repopulated_bytes);
+  ld_debug("Repopulated record caches for %ju logs in [%lu, %lu] on shard %d, "
+           "totaling %ju bytes.",
+           repopulated_caches,
+           first_log_.val_,
+           last_log_.val_,
+           shard_idx_,
+           repopulated_bytes);
   STAT_ADD(stats_, record_cache_repopulated_bytes, repopulated_bytes);
 
   // also bump the record_cache_bytes_cached_estimate stats for accurately
@@ -108,9 +145,32 @@ void RecordCacheRepopulationTask::execute() {
   STAT_ADD(stats_, record_cache_bytes_cached_estimate, repopulated_bytes);
 }
 
+void RecordCacheRepopulationTask::deleteSnapshots() {
+  // Always delete all snapshot blobs, so that future instances do not
+  // repopulate record caches from old data!
+  int rv = storageThreadPool_->getLocalLogStore().deleteAllLogSnapshotBlobs();
+  if (rv != 0) {
+    ld_critical(
+        "Failed to delete all log snapshot blobs on shard %d", shard_idx_);
+    status_ = E::FAILED;
+  } else {
+    status_ = E::OK;
+  }
+}
+
 void RecordCacheRepopulationTask::onDone() {
   ld_check(parent_);
   // Notify parent of result
-  parent_->onRepopulationTaskDone(status_, shard_idx_);
+  switch (stage_) {
+    case Stage::READ_INDEX:
+      parent_->onIndexRead(shard_idx_, std::move(chunks_));
+      break;
+    case Stage::REPOPULATE:
+      parent_->onChunkRepopulated(status_, shard_idx_);
+      break;
+    case Stage::DELETE:
+      parent_->onSnapshotsDeleted(status_, shard_idx_);
+      break;
+  }
 }
 }} // namespace facebook::logdevice
@@ -7,26 +7,51 @@
  */
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include <folly/Memory.h>
 
 #include "logdevice/server/RecordCache.h"
+#include "logdevice/server/RecordCachePersistence.h"
 #include "logdevice/server/RepopulateRecordCachesRequest.h"
 #include "logdevice/server/storage_tasks/StorageTask.h"
 
 namespace facebook { namespace logdevice {
 
+/**
+ * @file  One step of repopulating the record caches of a shard, see
+ *        RepopulateRecordCachesRequest. Chunks of the snapshot (see
+ *        RecordCachePersistence.h) are repopulated by separate tasks, so that
+ *        all slow storage threads of the shard take part.
+ */
 class RecordCacheRepopulationTask : public StorageTask {
  public:
-  RecordCacheRepopulationTask(shard_index_t shard_idx,
-                              WeakRef<RepopulateRecordCachesRequest> parent,
-                              bool repopulate_record_caches)
+  enum class Stage {
+    // Reads the index of snapshot chunks.
+    READ_INDEX,
+    // Repopulates the record caches of logs in [first_log, last_log].
+    REPOPULATE,
+    // Deletes all snapshot blobs of the shard.
+    DELETE,
+  };
+
+  RecordCacheRepopulationTask(
+      shard_index_t shard_idx,
+      WeakRef<RepopulateRecordCachesRequest> parent,
+      Stage stage,
+      logid_t first_log = LOGID_INVALID,
+      logid_t last_log = LOGID_MAX_INTERNAL,
+      std::shared_ptr<std::atomic<size_t>> shard_repopulated_bytes = nullptr)
       : StorageTask(StorageTask::Type::RECORD_CACHE_REPOPULATION),
         shard_idx_(shard_idx),
         status_(E::UNKNOWN),
         parent_(parent),
-        repopulate_record_caches_(repopulate_record_caches) {}
+        stage_(stage),
+        first_log_(first_log),
+        last_log_(last_log),
+        shard_repopulated_bytes_(std::move(shard_repopulated_bytes)) {}
 
   // see StorageTask.h
   void execute() override;
@@ -48,6 +73,17 @@ class RecordCacheRepopulationTask : public StorageTask {
   // see notes on callback_ in RepopulateRecordCachesRequest
   Status status_;
   WeakRef<RepopulateRecordCachesRequest> parent_;
-  bool repopulate_record_caches_;
+  const Stage stage_;
+  const logid_t first_log_;
+  const logid_t last_log_;
+  // Bytes repopulated by all REPOPULATE tasks of the shard, to enforce the
+  // per-shard byte limit.
+  std::shared_ptr<std::atomic<size_t>> shard_repopulated_bytes_;
+  // Filled by READ_INDEX.
+  std::vector<RecordCachePersistence::SnapshotChunk> chunks_;
+
+  void readIndex();
+  void repopulate();
+  void deleteSnapshots();
 };
 }} // namespace facebook::logdevice
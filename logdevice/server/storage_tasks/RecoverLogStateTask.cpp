@@ -175,7 +175,9 @@ void RecoverLogStateTask::onDone() {
       processor,
       rid,
       storageThreadPool_->getShardIdx(),
-      [&](worker_id_t worker) { return log_state.isWorkerSubscribed(worker); },
+      [&](worker_id_t worker, WorkerType type) {
+        return log_state.isWorkerSubscribed(worker, type);
+      },
       true // force (to make sure CatchupQueue tries to read again)
   );
 
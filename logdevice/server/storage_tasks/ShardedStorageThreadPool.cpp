@@ -32,5 +32,8 @@ ShardedStorageThreadPool::ShardedStorageThreadPool(
                                             stats,
                                             trace_logger));
   }
+  for (auto& pool : pools_) {
+    pool->setSiblingPools(&pools_);
+  }
 }
 }} // namespace facebook::logdevice
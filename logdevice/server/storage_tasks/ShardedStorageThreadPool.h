@@ -43,6 +43,12 @@ class ShardedStorageThreadPool {
       StatsHolder* stats,
       const std::shared_ptr<TraceLogger> trace_logger = nullptr);
 
+  ~ShardedStorageThreadPool() {
+    // Threads of each pool may steal tasks from the other pools, so all of
+    // them must be stopped before any pool is destroyed.
+    shutdown();
+  }
+
   void setProcessor(ServerProcessor* processor) {
     for (auto& pool : pools_) {
       pool->setProcessor(processor);
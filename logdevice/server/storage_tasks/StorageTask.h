@@ -7,14 +7,20 @@
  */
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <utility>
+
+#include <folly/Optional.h>
 
 #include "logdevice/common/AdminCommandTable-fwd.h"
+#include "logdevice/common/ClientID.h"
 #include "logdevice/common/StorageTask-enums.h"
 #include "logdevice/common/StorageTaskDebugInfo.h"
 #include "logdevice/common/Timestamp.h"
 #include "logdevice/common/settings/Durability.h"
+#include "logdevice/include/types.h"
 
 namespace facebook { namespace logdevice {
 
@@ -152,6 +158,65 @@ class StorageTask {
     return true;
   }
 
+  /**
+   * Time after which the result of this task is no longer useful, e.g.
+   * because the client's request has timed out. time_point::max() if none.
+   *
+   * Within the same priority, tasks with a deadline are executed before tasks
+   * without one, earliest deadline first. If the task is droppable and still
+   * queued when the deadline passes, it's dropped instead of executed.
+   */
+  std::chrono::steady_clock::time_point getDeadline() const {
+    return deadline_;
+  }
+
+  bool hasDeadline() const {
+    return deadline_ != std::chrono::steady_clock::time_point::max();
+  }
+
+  /**
+   * Must be called before the task is handed to the storage thread pool.
+   */
+  void setDeadline(std::chrono::steady_clock::time_point deadline) {
+    deadline_ = deadline;
+  }
+
+  /**
+   * Can this storage task be executed by an idle storage thread of another
+   * shard when work stealing is enabled (see
+   * --storage-task-stealing-interval)? Only tasks that are mostly CPU-bound
+   * should allow it; the rest stay on the threads of their own shard so that
+   * the I/O of each disk is limited by its own thread pool.
+   *
+   * The task still operates on the StorageThreadPool (and local log store) it
+   * was posted to, only the thread differs. Tasks that need syncing
+   * (Durability::SYNC_WRITE) must not be stealable.
+   */
+  virtual bool isStealable() const {
+    return false;
+  }
+
+  /**
+   * Tasks that read records of one log starting from some LSN (see
+   * ReadStorageTask) return that log and LSN, other tasks return folly::none.
+   * If --storage-thread-read-batch-size is greater than 1, storage threads
+   * take queued tasks like this in batches and execute each batch sorted by
+   * this key, so that consecutive reads touch adjacent keys of the local log
+   * store.
+   */
+  virtual folly::Optional<std::pair<logid_t, lsn_t>> getReadPosition() const {
+    return folly::none;
+  }
+
+  /**
+   * Client on whose behalf a task with a read position reads, if any. If
+   * --storage-thread-read-scheduler-window is nonzero, storage threads take
+   * turns between clients when executing such tasks (see ReadScheduler).
+   */
+  virtual ClientID getReadClient() const {
+    return ClientID::INVALID;
+  }
+
   /**
    * Hook called on a storage thread when the task is dropped during a queue
    * drop.  Subclasses can override to perform extra processing.
@@ -234,6 +299,10 @@ class StorageTask {
   ExecStorageThread* storageThread_ = nullptr;
 
  private:
+  // See getDeadline().
+  std::chrono::steady_clock::time_point deadline_ =
+      std::chrono::steady_clock::time_point::max();
+
   // Fetches fields that are specific to every task type. Should be overridden
   // in specific task implementations that want to provide this
   virtual void getDebugInfoDetailed(StorageTaskDebugInfo&) const {}
@@ -10,6 +10,7 @@
 #include <folly/Memory.h>
 
 #include "logdevice/common/RequestPump.h"
+#include "logdevice/common/stats/PerShardHistograms.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/server/ServerWorker.h"
 #include "logdevice/server/storage_tasks/PerWorkerStorageTaskQueue.h"
@@ -53,6 +54,13 @@ void StorageTaskResponse::sendDroppedToWorker(
 
 Request::Execution StorageTaskResponse::execute() {
   ServerWorker* worker = ServerWorker::onThisThread();
+  if (task_->reply_shard_idx_ != -1) {
+    PER_SHARD_HISTOGRAM_ADD(
+        Worker::stats(),
+        storage_task_response_time[static_cast<int>(task_->getType())],
+        task_->reply_shard_idx_,
+        usec_since(enqueue_time_));
+  }
   worker->getStorageTaskQueueForShard(task_->reply_shard_idx_)->onReply(*task_);
 
   if (task_->dropped_from_storage_thread_queue_) {
@@ -8,6 +8,7 @@
 #include "StorageThreadPool.h"
 
 #include <folly/Memory.h>
+#include <folly/Random.h>
 
 #include "logdevice/common/AdminCommandTable.h"
 #include "logdevice/common/ConstructorFailed.h"
@@ -83,12 +84,25 @@ StorageThreadPool::StorageThreadPool(
       trace_logger_(trace_logger),
       stats_(stats),
       shard_idx_(shard_idx),
+      stealing_interval_(settings->storage_task_stealing_interval),
+      read_batch_size_(settings->storage_thread_read_batch_size),
       taskQueues_([&, task_queue_size]() {
         const auto actual_queue_sizes =
             computeActualQueueSizes(task_queue_size);
         for (int type = 0; type < (int)ThreadType::MAX; ++type) {
           const size_t size = actual_queue_sizes[type];
-          taskQueues_.emplace_back(size, stats);
+          // Stealable tasks get a separate queue of the same size when work
+          // stealing is enabled.
+          const size_t stealable_size =
+              stealing_interval_.count() > 0 ? size : 0;
+          // Same for batchable read tasks when read batching is enabled.
+          const size_t batchable_size = read_batch_size_ > 1 ? size : 0;
+          taskQueues_.emplace_back(
+              size,
+              stealable_size,
+              batchable_size,
+              settings->storage_thread_read_scheduler_window,
+              stats);
         }
       }) {
   ld_check(local_log_store != nullptr);
@@ -263,7 +277,10 @@ int StorageThreadPool::tryPutTask(std::unique_ptr<StorageTask>&& task) {
   auto& queue = taskQueues_[thread_type].queue;
 
   task->setStorageThreadPool(this);
-  if (!queue.writeIfNotFull(task.get())) {
+  const bool written = task->hasDeadline()
+      ? queue.writeWithDeadline(task.get(), task->getDeadline())
+      : queue.writeIfNotFull(task.get(), getLane(*task));
+  if (!written) {
     err = E::INTERNAL;
     return -1;
   }
@@ -303,7 +320,14 @@ void StorageThreadPool::blockingPutTask(std::unique_ptr<StorageTask>&& task) {
   auto& queue = taskQueues_[thread_type].queue;
 
   task->setStorageThreadPool(this);
-  queue.blockingWrite(task.release());
+  if (task->hasDeadline() &&
+      queue.writeWithDeadline(task.get(), task->getDeadline())) {
+    task.release();
+  } else {
+    // If the deadline lane is full, the task waits in the regular queue.
+    const TaskQueue::Lane lane = getLane(*task);
+    queue.blockingWrite(task.release(), lane);
+  }
   STORAGE_TASK_STAT_INCR(stats_, thread_type, num_storage_tasks);
   STORAGE_TASK_TYPE_STAT_INCR(stats_, task_type, storage_tasks_posted);
 }
@@ -314,20 +338,107 @@ StorageThreadPool::blockingGetTask(StorageTask::ThreadType type) {
 
   while (true) {
     StorageTask* rawptr;
-    task_queue.queue.blockingRead(rawptr);
-    std::unique_ptr<StorageTask> task(rawptr);
+    if (stealing_interval_.count() > 0) {
+      // Our own tasks come first. When there are none, help other shards,
+      // then wait for our own tasks for a while before looking again.
+      if (!task_queue.queue.read(rawptr)) {
+        std::unique_ptr<StorageTask> stolen = stealFromSiblings(type);
+        if (stolen) {
+          return stolen;
+        }
+        if (!task_queue.queue.timedRead(rawptr, stealing_interval_)) {
+          continue;
+        }
+      }
+    } else {
+      task_queue.queue.blockingRead(rawptr);
+    }
+
+    std::unique_ptr<StorageTask> task = consumeTask(rawptr, type, task_queue);
+    if (task) {
+      return task;
+    }
+  }
+}
+
+StorageThreadPool::TaskQueue::Lane
+StorageThreadPool::getLane(const StorageTask& task) const {
+  if (stealing_interval_.count() > 0 && task.isStealable()) {
+    return TaskQueue::Lane::STEALABLE;
+  }
+  if (read_batch_size_ > 1 && task.getReadPosition().hasValue()) {
+    return TaskQueue::Lane::BATCHABLE;
+  }
+  return TaskQueue::Lane::REGULAR;
+}
+
+std::unique_ptr<StorageTask>
+StorageThreadPool::consumeTask(StorageTask* rawptr,
+                               StorageTask::ThreadType type,
+                               PerTypeTaskQueue& task_queue) {
+  std::unique_ptr<StorageTask> task(rawptr);
+
+  STORAGE_TASK_STAT_DECR(stats_, type, num_storage_tasks);
+
+  // Check if we should drop the task.  Doing a load first to avoid an
+  // std::atomic write in the common case when there is nothing to drop.
+  if (task_queue.tasks_to_drop.load() > 0 && tryDropOneTask(task)) {
+    return nullptr;
+  }
+
+  // Don't spend storage thread time on tasks nobody is waiting for anymore.
+  if (task->hasDeadline() && task->isDroppable() &&
+      task->getDeadline() <= std::chrono::steady_clock::now()) {
+    STAT_INCR(stats_, storage_tasks_expired);
+    StorageTaskResponse::sendDroppedToWorker(std::move(task));
+    return nullptr;
+  }
+
+  STORAGE_TASK_STAT_INCR(stats_, type, storage_tasks_dequeued);
+  return task;
+}
+
+std::unique_ptr<StorageTask>
+StorageThreadPool::tryStealTask(StorageTask::ThreadType type) {
+  if (shutting_down_.load()) {
+    // Let our own threads drain the queue.
+    return nullptr;
+  }
+
+  auto& task_queue = taskQueues_[getThreadType(type)];
+  StorageTask* rawptr;
+  if (!task_queue.queue.trySteal(rawptr)) {
+    return nullptr;
+  }
+
+  std::unique_ptr<StorageTask> task = consumeTask(rawptr, type, task_queue);
+  if (task) {
+    ++num_tasks_stolen_;
+    STAT_INCR(stats_, storage_tasks_stolen);
+  }
+  return task;
+}
 
-    STORAGE_TASK_STAT_DECR(stats_, type, num_storage_tasks);
+std::unique_ptr<StorageTask>
+StorageThreadPool::stealFromSiblings(StorageTask::ThreadType type) {
+  const auto* pools = sibling_pools_.load();
+  if (pools == nullptr || pools->size() < 2 || shutting_down_.load()) {
+    return nullptr;
+  }
 
-    // Check if we should drop the task.  Doing a load first to avoid an
-    // std::atomic write in the common case when there is nothing to drop.
-    if (task_queue.tasks_to_drop.load() > 0 && tryDropOneTask(task)) {
+  const size_t n = pools->size();
+  const size_t start = folly::Random::rand32(static_cast<uint32_t>(n));
+  for (size_t i = 0; i < n; ++i) {
+    StorageThreadPool* pool = (*pools)[(start + i) % n].get();
+    if (pool == this) {
       continue;
     }
-
-    STORAGE_TASK_STAT_INCR(stats_, type, storage_tasks_dequeued);
-    return task;
+    std::unique_ptr<StorageTask> task = pool->tryStealTask(type);
+    if (task) {
+      return task;
+    }
   }
+  return nullptr;
 }
 
 folly::small_vector<std::unique_ptr<WriteStorageTask>, 4>
@@ -347,6 +458,65 @@ StorageThreadPool::tryGetWriteBatch(StorageTask::ThreadType thread_type,
   return res;
 }
 
+folly::small_vector<std::unique_ptr<StorageTask>, 4>
+StorageThreadPool::tryGetReadBatch(StorageTask::ThreadType type,
+                                   const StorageTask& task) {
+  folly::small_vector<std::unique_ptr<StorageTask>, 4> res;
+  if (read_batch_size_ <= 1 || !task.getReadPosition().hasValue()) {
+    return res;
+  }
+
+  auto& task_queue = taskQueues_[getThreadType(type)];
+  folly::small_vector<StorageTask*, 4> raw_tasks =
+      task_queue.queue.readBatchable(
+          static_cast<size_t>(task.getPriority()), read_batch_size_ - 1);
+  for (StorageTask* rawptr : raw_tasks) {
+    std::unique_ptr<StorageTask> batched =
+        consumeTask(rawptr, type, task_queue);
+    if (batched) {
+      res.push_back(std::move(batched));
+    }
+  }
+  return res;
+}
+
+bool StorageThreadPool::hasReadScheduler(StorageTask::ThreadType type) const {
+  return taskQueues_[getThreadType(type)].read_scheduler != nullptr;
+}
+
+ReadScheduler::TaskVector
+StorageThreadPool::scheduleReads(StorageTask::ThreadType type,
+                                 ReadScheduler::TaskVector tasks) {
+  auto& task_queue = taskQueues_[getThreadType(type)];
+  ld_check(task_queue.read_scheduler);
+  const size_t ntasks = tasks.size();
+  ReadScheduler::TaskVector res =
+      task_queue.read_scheduler->schedule(std::move(tasks));
+  STAT_INCR(stats_, storage_read_scheduler_rounds);
+  STAT_ADD(stats_, storage_read_scheduler_tasks, ntasks);
+  return res;
+}
+
+ReadScheduler::TaskVector
+StorageThreadPool::takeHeldReads(StorageTask::ThreadType type,
+                                 bool only_if_idle) {
+  auto& task_queue = taskQueues_[getThreadType(type)];
+  if (!task_queue.read_scheduler ||
+      (only_if_idle && task_queue.queue.size() > 0)) {
+    return {};
+  }
+  return task_queue.read_scheduler->takeNextGroup();
+}
+
+ReadScheduler::TaskVector
+StorageThreadPool::takeAllHeldReads(StorageTask::ThreadType type) {
+  auto& task_queue = taskQueues_[getThreadType(type)];
+  if (!task_queue.read_scheduler) {
+    return {};
+  }
+  return task_queue.read_scheduler->takeAll();
+}
+
 void StorageThreadPool::enqueueForSync(std::unique_ptr<StorageTask> task) {
   syncing_thread_->enqueueForSync(std::move(task));
 }
@@ -410,6 +580,7 @@ StorageThreadPool::getThreadType(StorageTask::ThreadType type) const {
 
 void StorageThreadPool::getStorageTaskDebugInfo(InfoStorageTasksTable& table) {
   size_t seq_counter = 0;
+  const uint64_t num_tasks_stolen = num_tasks_stolen_.load();
   auto cb = [&](StorageTask* task,
                 StorageTask::ThreadType /*thread_type*/,
                 bool is_write_queue) {
@@ -425,7 +596,10 @@ void StorageThreadPool::getStorageTaskDebugInfo(InfoStorageTasksTable& table) {
         .set<F::DURABILITY>(info.durability);
     // Set thread-specific fields
     table.set<F::IS_WRITE_QUEUE>(is_write_queue)
-        .set<F::SEQUENCE_NO>(++seq_counter);
+        .set<F::SEQUENCE_NO>(++seq_counter)
+        .set<F::STEALABLE>(stealing_interval_.count() > 0 &&
+                           !is_write_queue && task->isStealable())
+        .set<F::SHARD_TASKS_STOLEN>(num_tasks_stolen);
     // Set optional fields if they are non-empty
     table.setOptional<F::LOG_ID>(info.log_id);
     table.setOptional<F::LSN>(info.lsn);
@@ -7,6 +7,8 @@
  */
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <vector>
 
@@ -16,6 +18,7 @@
 #include "logdevice/common/SimpleEnumMap.h"
 #include "logdevice/common/settings/Settings.h"
 #include "logdevice/server/storage_tasks/PrioritizedQueue.h"
+#include "logdevice/server/storage_tasks/ReadScheduler.h"
 #include "logdevice/server/storage_tasks/StorageTask.h"
 
 namespace facebook { namespace logdevice {
@@ -129,6 +132,32 @@ class StorageThreadPool {
    */
   std::unique_ptr<StorageTask> blockingGetTask(StorageTask::ThreadType type);
 
+  /**
+   * Called by idle storage threads of other shards. Takes a stealable task
+   * (see StorageTask::isStealable()) meant for threads of type `type` without
+   * blocking.
+   *
+   * @return nullptr if there are no such tasks or work stealing is disabled
+   */
+  std::unique_ptr<StorageTask> tryStealTask(StorageTask::ThreadType type);
+
+  /**
+   * Lets threads of this pool steal tasks from `pools` when idle (this pool
+   * itself may be in the list). Called once by ShardedStorageThreadPool after
+   * creating all pools. `pools` must outlive this pool's threads.
+   */
+  void setSiblingPools(
+      const std::vector<std::unique_ptr<StorageThreadPool>>* pools) {
+    sibling_pools_.store(pools);
+  }
+
+  /**
+   * Number of this pool's tasks that were executed by threads of other pools.
+   */
+  uint64_t getNumTasksStolen() const {
+    return num_tasks_stolen_.load();
+  }
+
   /**
    * Tries to get a batch of WriteStorageTasks from the write queue.
    * @return nullptr if write queue was empty
@@ -138,6 +167,49 @@ class StorageThreadPool {
                    size_t max_count,
                    size_t max_bytes);
 
+  /**
+   * Called by storage threads after getting `task` from blockingGetTask().
+   * If read batching is enabled (--storage-thread-read-batch-size) and `task`
+   * has a read position (see StorageTask::getReadPosition()), takes other
+   * such queued tasks of the same priority, without blocking.
+   *
+   * @return the tasks taken, fewer than --storage-thread-read-batch-size;
+   *         empty if there are none or read batching is disabled
+   */
+  folly::small_vector<std::unique_ptr<StorageTask>, 4>
+  tryGetReadBatch(StorageTask::ThreadType type, const StorageTask& task);
+
+  /**
+   * @return true if tasks with a read position taken by threads of type
+   *         `type` go through a ReadScheduler
+   *         (--storage-thread-read-scheduler-window)
+   */
+  bool hasReadScheduler(StorageTask::ThreadType type) const;
+
+  /**
+   * Called by storage threads with the tasks with a read position they took
+   * from the queue, if hasReadScheduler(). See ReadScheduler::schedule().
+   *
+   * @return the tasks to execute now, in order
+   */
+  ReadScheduler::TaskVector scheduleReads(StorageTask::ThreadType type,
+                                          ReadScheduler::TaskVector tasks);
+
+  /**
+   * Takes the next group of tasks held by the ReadScheduler of `type`, if
+   * any. See ReadScheduler::takeNextGroup().
+   *
+   * @param only_if_idle  only take them if the queue for `type` is empty
+   */
+  ReadScheduler::TaskVector takeHeldReads(StorageTask::ThreadType type,
+                                          bool only_if_idle);
+
+  /**
+   * Called by storage threads that stop. Takes all the tasks that the
+   * ReadScheduler of `type` still holds, if any.
+   */
+  ReadScheduler::TaskVector takeAllHeldReads(StorageTask::ThreadType type);
+
   /**
    * Enqueue the task for syncing to nonvolatile storage.  This is called
    * after the local log store has accepted a write but has not necessarily
@@ -192,13 +264,30 @@ class StorageThreadPool {
   const std::shared_ptr<TraceLogger> trace_logger_;
 
   struct PerTypeTaskQueue {
-    PerTypeTaskQueue(size_t size, StatsHolder* stats)
-        : queue(size, stats), write_queue(size, stats), tasks_to_drop(0) {}
+    PerTypeTaskQueue(size_t size,
+                     size_t stealable_size,
+                     size_t batchable_size,
+                     size_t read_scheduler_window,
+                     StatsHolder* stats)
+        : queue(size, stats, stealable_size, batchable_size),
+          write_queue(size, stats),
+          read_scheduler(read_scheduler_window > 0
+                             ? std::make_unique<ReadScheduler>(
+                                   read_scheduler_window)
+                             : nullptr),
+          tasks_to_drop(0) {}
 
     // Task queue. Other threads write into it and our threads read from it.
+    // If work stealing is enabled, stealable tasks are kept apart in it so
+    // that threads of other pools can take them too. Likewise, if read
+    // batching is enabled, tasks with a read position are kept apart so that
+    // they can be taken in batches.
     TaskQueue queue;
     // Separate queue for write batching
     WriteTaskQueue write_queue;
+    // Read tasks taken from `queue` but not executed yet, if
+    // --storage-thread-read-scheduler-window is nonzero.
+    std::unique_ptr<ReadScheduler> read_scheduler;
     // How many tasks should be dropped?
     std::atomic<int64_t> tasks_to_drop;
   };
@@ -211,9 +300,48 @@ class StorageThreadPool {
 
   shard_index_t shard_idx_;
 
+  // Value of --storage-task-stealing-interval at startup. Zero if work
+  // stealing is disabled.
+  const std::chrono::milliseconds stealing_interval_;
+
+  // Value of --storage-thread-read-batch-size at startup. 1 if read batching
+  // is disabled.
+  const size_t read_batch_size_;
+
   // Separate queue for each of the two types of storage threads.
   SimpleEnumMap<StorageTask::ThreadType, PerTypeTaskQueue> taskQueues_;
 
+  // All pools of the ShardedStorageThreadPool this pool belongs to, or
+  // nullptr if not set (yet). Only used if work stealing is enabled.
+  std::atomic<const std::vector<std::unique_ptr<StorageThreadPool>>*>
+      sibling_pools_{nullptr};
+
+  // See getNumTasksStolen().
+  std::atomic<uint64_t> num_tasks_stolen_{0};
+
+  /**
+   * Takes a stealable task from the queues of some other pool, starting from
+   * a random one.
+   *
+   * @return nullptr if no other pool has stealable tasks for threads of
+   *         type `type`
+   */
+  std::unique_ptr<StorageTask> stealFromSiblings(StorageTask::ThreadType type);
+
+  /**
+   * Takes ownership of a task just read from `task_queue` and updates stats.
+   * Drops the task instead if a drop was requested and the task is
+   * droppable; returns nullptr in that case.
+   */
+  std::unique_ptr<StorageTask> consumeTask(StorageTask* rawptr,
+                                           StorageTask::ThreadType type,
+                                           PerTypeTaskQueue& task_queue);
+
+  /**
+   * Which lane of its queue `task` should be written to.
+   */
+  TaskQueue::Lane getLane(const StorageTask& task) const;
+
   /**
    * Called when tasksToDrop_ was observed to be more than 0, suggesting that
    * a task should be dropped.
@@ -7,10 +7,12 @@
  */
 #include "logdevice/server/storage_tasks/SyncingStorageThread.h"
 
+#include <algorithm>
 #include <chrono>
 #include <deque>
 
 #include "logdevice/common/debug.h"
+#include "logdevice/common/stats/PerShardHistograms.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/server/locallogstore/LocalLogStore.h"
 #include "logdevice/server/storage_tasks/StorageTask.h"
@@ -25,34 +27,89 @@ SyncingStorageThread::SyncingStorageThread(StorageThreadPool* pool,
 
 SyncingStorageThread::~SyncingStorageThread() {}
 
+namespace {
+// Weight of the newest sample in the moving averages of sync durations and
+// task interarrival times.
+constexpr double kEstimatorAlpha = 0.2;
+
+void updateAverage(double* avg, double sample) {
+  *avg = *avg < 0 ? sample
+                  : *avg * (1 - kEstimatorAlpha) + sample * kEstimatorAlpha;
+}
+} // namespace
+
 void SyncingStorageThread::enqueueForSync(std::unique_ptr<StorageTask> task) {
   // Tasks should be non-null so we can abuse null in stopProcessingTasks()
   ld_check(task);
 
-  if (!queue_.writeIfNotFull(std::move(task))) {
+  QueueEntry entry{std::move(task), std::chrono::steady_clock::now()};
+  if (!queue_.writeIfNotFull(std::move(entry))) {
     RATELIMIT_WARNING(
         std::chrono::seconds(60),
         1,
         "Failed to enqueue.  This should never happen if the queue is properly "
         "sized.  Reverting to blockingWrite().");
-    queue_.blockingWrite(std::move(task));
+    queue_.blockingWrite(std::move(entry));
   }
 }
 
 void SyncingStorageThread::stopProcessingTasks() {
-  queue_.write(std::unique_ptr<StorageTask>());
+  queue_.write(QueueEntry{nullptr, std::chrono::steady_clock::now()});
+}
+
+void SyncingStorageThread::onTaskArrived(
+    std::chrono::steady_clock::time_point enqueue_time) {
+  using namespace std::chrono;
+  if (last_arrival_.hasValue() && enqueue_time > last_arrival_.value()) {
+    updateAverage(
+        &avg_interarrival_usec_,
+        duration_cast<microseconds>(enqueue_time - last_arrival_.value())
+            .count());
+  }
+  if (!last_arrival_.hasValue() || enqueue_time > last_arrival_.value()) {
+    last_arrival_ = enqueue_time;
+  }
+}
+
+void SyncingStorageThread::onSynced(std::chrono::microseconds duration) {
+  updateAverage(&avg_sync_usec_, duration.count());
+}
+
+std::chrono::microseconds SyncingStorageThread::groupCommitDelay(
+    std::chrono::steady_clock::time_point oldest,
+    std::chrono::steady_clock::time_point now) const {
+  using namespace std::chrono;
+  const microseconds target =
+      pool_->getSettings()->sync_group_commit_target_latency;
+  if (target.count() <= 0 || avg_sync_usec_ < 0 ||
+      avg_interarrival_usec_ < 0) {
+    return microseconds(0);
+  }
+  // The oldest task has already waited for `now - oldest` and will wait for
+  // about one sync duration after we issue the sync.
+  const double budget_usec = target.count() -
+      duration_cast<microseconds>(now - oldest).count() - avg_sync_usec_;
+  // Only wait if another task is likely to arrive within the budget. On a
+  // quiet shard it won't, and waiting would just add latency.
+  if (budget_usec <= 0 || avg_interarrival_usec_ >= budget_usec) {
+    return microseconds(0);
+  }
+  return microseconds(static_cast<int64_t>(budget_usec));
 }
 
 void SyncingStorageThread::run() {
-  std::deque<std::unique_ptr<StorageTask>> batch;
+  using namespace std::chrono;
+  std::deque<QueueEntry> batch;
   bool stop = false;
-  auto got_task = [&](std::unique_ptr<StorageTask> task) {
-    if (task) {
+  auto got_task = [&](QueueEntry entry) {
+    if (entry.task) {
+      auto& task = entry.task;
       ld_check(task->durability() == Durability::SYNC_WRITE);
+      onTaskArrived(entry.enqueue_time);
       auto sync_token = task->syncToken();
       if (sync_token == FlushToken_INVALID ||
           sync_token > pool_->getLocalLogStore().walSyncedUpThrough()) {
-        batch.push_back(std::move(task));
+        batch.push_back(std::move(entry));
       } else {
         task->onSynced();
         StorageTaskResponse::sendBackToWorker(std::move(task));
@@ -65,14 +122,14 @@ void SyncingStorageThread::run() {
   };
 
   while (!stop) {
-    std::unique_ptr<StorageTask> task;
+    QueueEntry entry;
 
     // Some tasks may have been waiting for a sync we just completed.
     // Loop until got_task() finds a task that still needs a sync to
     // be issued.
     while (!stop && batch.empty()) {
-      queue_.blockingRead(task);
-      got_task(std::move(task));
+      queue_.blockingRead(entry);
+      got_task(std::move(entry));
     }
 
     // We got one task off the incoming queue, now pull as much as possible to
@@ -81,16 +138,36 @@ void SyncingStorageThread::run() {
     // synced.  (The worst case is when a task comes in just as we started
     // syncing a previous batch, so it has to wait for two syncs.)
     //
-    // The `batch.size()' check guards against the theoretical possibility of
+    // The batch size check guards against the theoretical possibility of
     // tasks coming in faster than we can drain them, although this should be
     // impossible in practice because of limits on how many tasks can be in
-    // flight.
-    while (batch.size() < queue_.capacity() && queue_.read(task)) {
-      got_task(std::move(task));
+    // flight. With group commit enabled, it also caps how many tasks we wait
+    // for.
+    size_t max_batch = queue_.capacity();
+    const size_t max_group_commit_batch =
+        pool_->getSettings()->sync_group_commit_max_batch;
+    if (max_group_commit_batch > 0) {
+      max_batch = std::min(max_batch, max_group_commit_batch);
+    }
+    while (!stop && batch.size() < max_batch && queue_.read(entry)) {
+      got_task(std::move(entry));
+    }
+
+    // Group commit: if the shard is busy and the oldest task still has some
+    // of its latency budget left, wait for more tasks to share the sync.
+    if (!stop && !batch.empty() && batch.size() < max_batch) {
+      auto now = steady_clock::now();
+      microseconds delay = groupCommitDelay(batch.front().enqueue_time, now);
+      if (delay.count() > 0) {
+        auto deadline = now + delay;
+        while (!stop && batch.size() < max_batch &&
+               queue_.tryReadUntil(deadline, entry)) {
+          got_task(std::move(entry));
+        }
+      }
     }
 
     if (!batch.empty()) {
-      using namespace std::chrono;
       auto t1 = steady_clock::now();
       int rv = pool_->getLocalLogStore().sync(Durability::ASYNC_WRITE);
       if (rv != 0) {
@@ -98,16 +175,25 @@ void SyncingStorageThread::run() {
         // interface further to allow this failure.  Seems unlikely?
         RATELIMIT_ERROR(std::chrono::seconds(60), 1, "Sync failed!?");
       }
+      auto t2 = steady_clock::now();
+      onSynced(duration_cast<microseconds>(t2 - t1));
       ld_debug("Shard %d: Synced %zu tasks in %ld ms",
                pool_->getLocalLogStore().getShardIdx(),
                batch.size(),
-               duration_cast<milliseconds>(steady_clock::now() - t1).count());
+               duration_cast<milliseconds>(t2 - t1).count());
 
+      const shard_index_t shard_idx = pool_->getShardIdx();
+      PER_SHARD_HISTOGRAM_ADD(
+          pool_->stats(), sync_batch_size, shard_idx, batch.size());
       for (auto& ptr : batch) {
-        if (ptr) {
-          ptr->onSynced();
-          StorageTaskResponse::sendBackToWorker(std::move(ptr));
-        } else {
+        if (ptr.task) {
+          PER_SHARD_HISTOGRAM_ADD(
+              pool_->stats(),
+              sync_wait_time,
+              shard_idx,
+              duration_cast<microseconds>(t2 - ptr.enqueue_time).count());
+          ptr.task->onSynced();
+          StorageTaskResponse::sendBackToWorker(std::move(ptr.task));
         }
       }
       batch.clear();
@@ -7,7 +7,10 @@
  */
 #pragma once
 
+#include <chrono>
+
 #include <folly/MPMCQueue.h>
+#include <folly/Optional.h>
 
 #include "logdevice/server/storage_tasks/StorageThread.h"
 #include "logdevice/server/storage_tasks/StorageThreadPool.h"
@@ -18,6 +21,11 @@ namespace facebook { namespace logdevice {
  * @file Storage thread that makes sure writes get synced before
  * acknowledgement (when required).  Makes periodic calls to
  * LocalLogStore::sync().
+ *
+ * If --sync-group-commit-target-latency is set, the thread may hold a sync
+ * back for a while to let more tasks join it (group commit). How long it
+ * waits depends on the recently observed sync durations and task arrival
+ * rate, see run().
  */
 
 class StorageTask;
@@ -49,6 +57,28 @@ class SyncingStorageThread : public StorageThread {
   }
 
  private:
-  folly::MPMCQueue<std::unique_ptr<StorageTask>> queue_;
+  struct QueueEntry {
+    std::unique_ptr<StorageTask> task;
+    std::chrono::steady_clock::time_point enqueue_time;
+  };
+
+  // Entries with null `task` tell run() to stop.
+  folly::MPMCQueue<QueueEntry> queue_;
+
+  // Exponential moving averages of the duration of LocalLogStore::sync()
+  // calls and of the time between consecutive tasks enqueued for sync, in
+  // microseconds. Only accessed by run(). Negative if no samples yet.
+  double avg_sync_usec_ = -1;
+  double avg_interarrival_usec_ = -1;
+  folly::Optional<std::chrono::steady_clock::time_point> last_arrival_;
+
+  // Returns how long run() should wait for more tasks before syncing a batch
+  // whose oldest task was enqueued at `oldest`. Zero if it should sync now.
+  std::chrono::microseconds
+  groupCommitDelay(std::chrono::steady_clock::time_point oldest,
+                   std::chrono::steady_clock::time_point now) const;
+
+  void onTaskArrived(std::chrono::steady_clock::time_point enqueue_time);
+  void onSynced(std::chrono::microseconds duration);
 };
 }} // namespace facebook::logdevice
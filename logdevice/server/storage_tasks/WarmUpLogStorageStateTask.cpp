@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "WarmUpLogStorageStateTask.h"
+
+#include "logdevice/common/debug.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/ServerProcessor.h"
+#include "logdevice/server/locallogstore/LocalLogStore.h"
+#include "logdevice/server/read_path/LogStorageStateMap.h"
+#include "logdevice/server/storage_tasks/StorageThreadPool.h"
+
+namespace facebook { namespace logdevice {
+
+const std::vector<LogMetadataType>&
+WarmUpLogStorageStateTask::metadataTypes() {
+  static const std::vector<LogMetadataType> types{
+      LogMetadataType::TRIM_POINT,
+      LogMetadataType::LAST_RELEASED,
+      LogMetadataType::LAST_CLEAN,
+      LogMetadataType::SEAL,
+      LogMetadataType::SOFT_SEAL,
+  };
+  return types;
+}
+
+void WarmUpLogStorageStateTask::execute() {
+  LocalLogStore& store = storageThreadPool_->getLocalLogStore();
+  ld_check(store.getShardIdx() == shard_idx_);
+  LogStorageStateMap& map =
+      storageThreadPool_->getProcessor().getLogStorageStateMap();
+
+  if (type_.hasValue()) {
+    scan(store, map);
+  } else {
+    fillInAbsentMetadata(map);
+  }
+}
+
+void WarmUpLogStorageStateTask::scan(LocalLogStore& store,
+                                     LogStorageStateMap& map) {
+  const LogMetadataType type = type_.value();
+  size_t num_loaded = 0;
+  size_t num_invalid = 0;
+
+  auto callback = [&](logid_t log_id, LogMetadata& metadata) {
+    LogStorageState* state = map.insertOrGet(log_id, shard_idx_);
+    ld_check(state != nullptr);
+
+    // Like the Recover*Tasks, ignore E::UPTODATE errors: they only mean that
+    // the in-memory value is already more recent.
+    switch (type) {
+      case LogMetadataType::TRIM_POINT:
+        state->updateTrimPoint(
+            static_cast<TrimMetadata&>(metadata).trim_point_);
+        break;
+      case LogMetadataType::LAST_RELEASED:
+        state->updateLastReleasedLSN(
+            static_cast<LastReleasedMetadata&>(metadata).last_released_lsn_,
+            LogStorageState::LastReleasedSource::LOCAL_LOG_STORE);
+        break;
+      case LogMetadataType::LAST_CLEAN:
+        state->updateLastCleanEpoch(
+            static_cast<LastCleanMetadata&>(metadata).epoch_);
+        break;
+      case LogMetadataType::SEAL:
+      case LogMetadataType::SOFT_SEAL: {
+        const Seal& seal = static_cast<SealMetadata&>(metadata).seal_;
+        if (!seal.seq_node.isNodeID()) {
+          // Leave it to RecoverSealTask to report the error.
+          ++num_invalid;
+          return;
+        }
+        state->updateSeal(seal,
+                          type == LogMetadataType::SEAL
+                              ? LogStorageState::SealType::NORMAL
+                              : LogStorageState::SealType::SOFT);
+        break;
+      }
+      default:
+        ld_check(false);
+        return;
+    }
+    ++num_loaded;
+  };
+
+  int rv = store.readAllLogMetadata(type, callback);
+  if (rv != 0 || num_invalid > 0) {
+    ld_error("Failed to read all %s metadata on shard %d: %s. Loaded %zu "
+             "values, %zu values were invalid.",
+             logMetadataTypeNames()[type].c_str(),
+             shard_idx_,
+             rv != 0 ? error_name(err) : "invalid seal",
+             num_loaded,
+             num_invalid);
+    status_ = E::PARTIAL;
+  } else {
+    ld_info("Loaded %s metadata of %zu logs on shard %d",
+            logMetadataTypeNames()[type].c_str(),
+            num_loaded,
+            shard_idx_);
+    status_ = E::OK;
+  }
+  STAT_ADD(stats_, log_storage_state_warm_up_metadata_loaded, num_loaded);
+}
+
+void WarmUpLogStorageStateTask::fillInAbsentMetadata(LogStorageStateMap& map) {
+  // All scans of this shard succeeded, so any metadata still missing doesn't
+  // exist in the local log store. Use the same values as RecoverLogStateTask
+  // and RecoverSealTask use on E::NOTFOUND.
+  std::vector<logid_t> logs;
+  map.forEachLogOnShard(
+      shard_idx_, [&](logid_t log_id, const LogStorageState&) {
+        logs.push_back(log_id);
+        return 0;
+      });
+
+  for (logid_t log_id : logs) {
+    LogStorageState& state = map.get(log_id, shard_idx_);
+    if (!state.getTrimPoint().hasValue()) {
+      state.updateTrimPoint(LSN_INVALID);
+    }
+    if (!state.getLastReleasedLSN().hasValue()) {
+      state.updateLastReleasedLSN(
+          LSN_INVALID, LogStorageState::LastReleasedSource::LOCAL_LOG_STORE);
+    }
+    if (!state.getLastCleanEpoch().hasValue()) {
+      state.updateLastCleanEpoch(epoch_t(0));
+    }
+    for (auto seal_type :
+         {LogStorageState::SealType::NORMAL, LogStorageState::SealType::SOFT}) {
+      if (!state.getSeal(seal_type).hasValue()) {
+        state.updateSeal(Seal(), seal_type);
+      }
+    }
+  }
+
+  ld_info("Warmed up the state of %zu logs on shard %d",
+          logs.size(),
+          shard_idx_);
+  status_ = E::OK;
+}
+
+void WarmUpLogStorageStateTask::onDone() {
+  ld_check(parent_);
+  parent_->onTaskDone(shard_idx_, !type_.hasValue(), status_);
+}
+}} // namespace facebook::logdevice
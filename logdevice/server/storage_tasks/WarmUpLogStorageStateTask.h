@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <vector>
+
+#include <folly/Optional.h>
+
+#include "logdevice/common/Metadata.h"
+#include "logdevice/server/WarmUpLogStorageStateRequest.h"
+#include "logdevice/server/storage_tasks/StorageTask.h"
+
+namespace facebook { namespace logdevice {
+
+class LocalLogStore;
+class LogStorageStateMap;
+
+/**
+ * @file Task used by WarmUpLogStorageStateRequest. Reads all metadata of one
+ *       type from the local log store with one sequential scan and updates
+ *       the LogStorageState of each log found, creating it if needed.
+ *       The final task of a shard (without a type) runs after all scans
+ *       succeeded and fills in the metadata that doesn't exist with the same
+ *       defaults as RecoverLogStateTask and RecoverSealTask would.
+ *
+ *       LogStorageStateMap and LogStorageState are thread-safe, so the map
+ *       is updated directly from the storage thread.
+ */
+class WarmUpLogStorageStateTask : public StorageTask {
+ public:
+  WarmUpLogStorageStateTask(shard_index_t shard_idx,
+                            folly::Optional<LogMetadataType> type,
+                            WeakRef<WarmUpLogStorageStateRequest> parent)
+      : StorageTask(StorageTask::Type::WARM_UP_LOG_STORAGE_STATE),
+        shard_idx_(shard_idx),
+        type_(type),
+        parent_(std::move(parent)) {}
+
+  // see StorageTask.h
+  void execute() override;
+  void onDone() override;
+  bool isDroppable() const override {
+    return false;
+  }
+  void onDropped() override {
+    ld_check(false);
+  }
+
+  ThreadType getThreadType() const override {
+    return ThreadType::SLOW;
+  }
+
+  // Types of LogMetadata kept in LogStorageState, one scan per type.
+  static const std::vector<LogMetadataType>& metadataTypes();
+
+ private:
+  void scan(LocalLogStore& store, LogStorageStateMap& map);
+  void fillInAbsentMetadata(LogStorageStateMap& map);
+
+  const shard_index_t shard_idx_;
+  // folly::none for the final task of the shard
+  const folly::Optional<LogMetadataType> type_;
+  WeakRef<WarmUpLogStorageStateRequest> parent_;
+  // OK or PARTIAL, see WarmUpLogStorageStateRequest
+  Status status_{E::UNKNOWN};
+};
+}} // namespace facebook::logdevice
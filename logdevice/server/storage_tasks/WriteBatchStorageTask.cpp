@@ -104,13 +104,27 @@ void WriteBatchStorageTask::execute() {
               std::back_inserter(write_ops));
 
     if (reply_shard_idx_ >= 0) {
-      // Update the histogram of queueing latency for that individual
+      // Update the histograms of queueing latency for that individual
       // WriteStorageTask.
+      const int64_t queueing_usec = usec_since(write->enqueue_time_);
       PER_SHARD_HISTOGRAM_ADD(
           stats(),
           storage_threads_queue_time[static_cast<int>(thread_type_)],
           reply_shard_idx_,
-          usec_since(write->enqueue_time_));
+          queueing_usec);
+      PER_SHARD_HISTOGRAM_ADD(
+          stats(),
+          storage_task_queue_time[static_cast<int>(write->getType())],
+          reply_shard_idx_,
+          queueing_usec);
+      if (write->getPriority() < StorageTask::Priority::NUM_PRIORITIES) {
+        PER_SHARD_HISTOGRAM_ADD(
+            stats(),
+            storage_task_priority_queue_time[static_cast<int>(
+                write->getPriority())],
+            reply_shard_idx_,
+            queueing_usec);
+      }
     }
   }
 
@@ -124,14 +138,18 @@ void WriteBatchStorageTask::execute() {
 
   FlushToken flushToken;
 
+  const auto write_start_time = std::chrono::steady_clock::now();
   int rv = writeMulti(write_ops, flushToken);
   Status status = rv == 0 ? E::OK : err;
+  const auto write_end_time = std::chrono::steady_clock::now();
 
   for (auto& write : writes) {
     if (!write) {
       continue;
     }
     write->status_ = status;
+    write->write_start_time_ = write_start_time;
+    write->write_end_time_ = write_end_time;
     if (status == E::OK) {
       // store success, try to insert the stored record into the record
       // cache. Perform insertion on the storage thread rather than the
@@ -7,6 +7,8 @@
  */
 #pragma once
 
+#include <chrono>
+
 #include "logdevice/include/Err.h"
 #include "logdevice/server/locallogstore/WriteOps.h"
 #include "logdevice/server/storage_tasks/StorageTask.h"
@@ -134,5 +136,12 @@ class WriteStorageTask : public StorageTask {
   // synced.
   //
   bool synced_{false};
+
+  //
+  // Set by WriteBatchStorageTask around the write of the batch this write
+  // was part of. Unset (default constructed) if the write was skipped.
+  //
+  std::chrono::steady_clock::time_point write_start_time_;
+  std::chrono::steady_clock::time_point write_end_time_;
 };
 }} // namespace facebook::logdevice
@@ -295,3 +295,46 @@ TEST(AllServerReadStreams, ReadStorageTasksMemoryLimit) {
 
   streams.clear();
 }
+
+// Only streams positioned within their buffered released records can read
+// them; the records of other streams are the first to be evicted.
+TEST(AllServerReadStreams, CanReadFromReleasedRecords) {
+  LogStorageStateMap map(1);
+  Settings settings = create_default_settings<Settings>();
+  AllServerReadStreams streams(
+      settings, 99999, worker_id_t(1), &map, nullptr, nullptr, false);
+
+  const logid_t LOG_ID(1);
+  const epoch_t epoch(5);
+  ServerReadStream* stream =
+      streams.insertOrGet(ClientID(111), LOG_ID, SHARD_IDX, read_stream_id_t(1))
+          .first;
+  ASSERT_NE(nullptr, stream);
+  EXPECT_FALSE(stream->canReadFromReleasedRecords());
+
+  stream->addReleasedRecords(
+      std::make_shared<ReleasedRecords>(LOG_ID,
+                                        compose_lsn(epoch, esn_t(10)),
+                                        compose_lsn(epoch, esn_t(20)),
+                                        nullptr,
+                                        0));
+
+  // Behind the buffered records, must read from the local log store.
+  stream->setReadPtr(compose_lsn(epoch, esn_t(5)));
+  EXPECT_FALSE(stream->canReadFromReleasedRecords());
+
+  // Tailing.
+  stream->setReadPtr(compose_lsn(epoch, esn_t(10)));
+  EXPECT_TRUE(stream->canReadFromReleasedRecords());
+  stream->setReadPtr(compose_lsn(epoch, esn_t(20)));
+  EXPECT_TRUE(stream->canReadFromReleasedRecords());
+
+  // Already past them, or in a different epoch.
+  stream->setReadPtr(compose_lsn(epoch, esn_t(21)));
+  EXPECT_FALSE(stream->canReadFromReleasedRecords());
+  stream->setReadPtr(compose_lsn(epoch_t(4), esn_t(15)));
+  EXPECT_FALSE(stream->canReadFromReleasedRecords());
+
+  EXPECT_EQ(1, stream->giveReleasedRecords().size());
+  streams.clear();
+}
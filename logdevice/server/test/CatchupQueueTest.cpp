@@ -429,6 +429,10 @@ class MockCatchupQueueDependencies : public CatchupQueueDependencies {
     return 128 * 1024;
   }
 
+  size_t getBytesPendingForClient(ClientID) override {
+    return 0;
+  }
+
   const Settings& getSettings() const override {
     return *settings_.get();
   }
@@ -1863,6 +1867,42 @@ TEST_F(CatchupQueueTest, MergeFilteredOutGapOnServerSide1) {
   ASSERT_EQ(0, tasks_.size());
 }
 
+// Records filtered out by LocalLogStoreReader come without blob and are turned
+// into FILTERED_OUT gaps just like records filtered out on the worker.
+TEST_F(CatchupQueueTest, FilteredOutWhileReading) {
+  resetCatchupQueue();
+  read_stream_id_t read_stream_id(1);
+  ServerReadStream& stream = createStream(read_stream_id);
+  stream.filter_pred_ = ServerRecordFilterFactory::create(
+      ServerRecordFilterType::EQUALITY, "PASS", "PASS");
+  notifyNeedsCatchup(stream, read_stream_id, /* more_data */ true);
+  ASSERT_EQ(1, tasks_.size());
+  auto task = std::move(tasks_.front());
+  ASSERT_EQ(stream.filter_pred_, task->read_ctx_.record_filter_);
+  task->status_ = E::CAUGHT_UP;
+  task->records_ = ReadStorageTask::RecordContainer();
+  ASSERT_EQ(/*STARTED*/ 1, messages_.size());
+  messages_.clear();
+
+  for (lsn_t lsn = 1; lsn <= 2; ++lsn) {
+    task->records_.emplace_back(lsn, Slice(), /* owned */ false);
+    task->records_.back().filtered_out = true;
+  }
+  task->records_.push_back(createFakeRecord(3, 100, {N1}, 1, 0, "PASS", true));
+  streams_.onReadTaskDone(*task);
+
+  ASSERT_EQ(2, messages_.size());
+  GAP_Message* gap_msg = dynamic_cast<GAP_Message*>(messages_[0].first.get());
+  ASSERT_NE(nullptr, gap_msg);
+  ASSERT_EQ(GapReason::FILTERED_OUT, gap_msg->getHeader().reason);
+  ASSERT_EQ(1, gap_msg->getHeader().start_lsn);
+  ASSERT_EQ(2, gap_msg->getHeader().end_lsn);
+  RECORD_Message* record_msg =
+      dynamic_cast<RECORD_Message*>(messages_[1].first.get());
+  ASSERT_NE(nullptr, record_msg);
+  ASSERT_EQ(3, getHeader(*record_msg).lsn);
+}
+
 TEST_F(CatchupQueueTest, MergeFilteredOutGapOnServerSide2) {
   resetCatchupQueue();
   read_stream_id_t read_stream_id(1);
@@ -100,9 +100,11 @@ class MockFailureDetector : public FailureDetector {
 
 namespace {
 
-// generates a dummy config consisting of num_nodes sequencers
+// generates a dummy config consisting of num_nodes sequencers, spread
+// across num_racks racks if nonzero
 std::shared_ptr<ServerConfig> gen_config(size_t num_nodes,
-                                         node_index_t this_node) {
+                                         node_index_t this_node,
+                                         size_t num_racks = 0) {
   configuration::Nodes nodes;
   for (node_index_t i = 0; i < num_nodes; ++i) {
     auto& node = nodes[i];
@@ -111,6 +113,13 @@ std::shared_ptr<ServerConfig> gen_config(size_t num_nodes,
     node.generation = 1;
     node.addSequencerRole();
     node.addStorageRole();
+    if (num_racks > 0) {
+      NodeLocation location;
+      int rv = location.fromDomainString(
+          "rg.dc.cl.row." + folly::to<std::string>(i % num_racks));
+      ld_check(rv == 0);
+      node.location = location;
+    }
   }
 
   Configuration::NodesConfig nodes_config(std::move(nodes));
@@ -207,7 +216,9 @@ void simulate_single(detector_list_t& detectors,
 // Runs a simulation featuring N nodes gossiping. For each 0 <= i < N/2,
 // i randomly selected nodes are marked as down. The rest of the cluster is
 // expected to detect that in a limited number of steps.
-void simulate(size_t num_nodes, const GossipSettings& settings) {
+void simulate(size_t num_nodes,
+              const GossipSettings& settings,
+              size_t num_racks = 0) {
   folly::ThreadLocalPRNG g;
 
   for (size_t num_dead = 1; num_dead < num_nodes / 2; ++num_dead) {
@@ -232,7 +243,7 @@ void simulate(size_t num_nodes, const GossipSettings& settings) {
     for (node_index_t i = 0; i < num_nodes; ++i) {
       std::shared_ptr<UpdateableConfig> uconfig =
           std::make_shared<UpdateableConfig>(std::make_shared<Configuration>(
-              gen_config(num_nodes, i),
+              gen_config(num_nodes, i, num_racks),
               std::make_shared<configuration::LocalLogsConfig>()));
       std::shared_ptr<ServerProcessor> p;
       MockFailureDetector* d;
@@ -268,6 +279,15 @@ TEST(FailureDetector, RoundRobinGossip) {
   simulate(20, settings);
 }
 
+TEST(FailureDetector, LocalityGossip) {
+  GossipSettings settings = create_default_settings<GossipSettings>();
+  settings.mode = GossipSettings::SelectionMode::LOCALITY;
+  settings.locality_scope = NodeLocationScope::RACK;
+  settings.cross_scope_gossip_interval = 4;
+  settings.suspect_duration = std::chrono::milliseconds(0);
+  simulate(20, settings, 4);
+}
+
 namespace {
 // simulates a single round of gossiping between two nodes
 void gossip_round(MockFailureDetector* d1, MockFailureDetector* d2) {
@@ -38,6 +38,8 @@ struct Params {
   bool with_suspect = false;
   bool with_failover = false;
   bool with_boycott = false;
+  gossip_list_t gossip_list{1, 2};
+  gossip_ts_t gossip_ts{5ms, 10ms};
 };
 
 void serializeAndDeserializeTest(Params params) {
@@ -45,8 +47,8 @@ void serializeAndDeserializeTest(Params params) {
     LD_EV(evbuffer_free)(ptr);
   });
   NodeID this_node{1};
-  gossip_list_t gossip_list{1, 2};
-  gossip_ts_t gossip_ts{5ms, 10ms};
+  gossip_list_t gossip_list = params.gossip_list;
+  gossip_ts_t gossip_ts = params.gossip_ts;
   std::chrono::milliseconds instance_id{1};
   std::chrono::milliseconds sent_time{1};
 
@@ -54,12 +56,16 @@ void serializeAndDeserializeTest(Params params) {
   failover_list_t failover_list;
   if (params.with_failover) {
     flags = GOSSIP_Message::HAS_FAILOVER_LIST_FLAG;
-    failover_list = {1ms, 2ms};
+    failover_list.assign(gossip_list.size(), 1ms);
   }
 
   suspect_matrix_t suspect_matrix;
   if (params.with_suspect) {
-    suspect_matrix = {{1, 0}, {0, 1}};
+    suspect_matrix.assign(gossip_list.size(),
+                          std::vector<uint8_t>(gossip_list.size(), 0));
+    for (size_t i = 0; i < gossip_list.size(); ++i) {
+      suspect_matrix[i][i] = 1;
+    }
   }
 
   boycott_list_t boycott_list;
@@ -148,3 +154,24 @@ TEST(GOSSIP_MessageTest, SerializeAndDeserializeWithBoycott) {
   params.with_failover = true;
   serializeAndDeserializeTest(params);
 }
+
+TEST(GOSSIP_MessageTest, SerializeAndDeserializeCompactLists) {
+  Params params{Compatibility::GOSSIP_COMPACT_LISTS_SUPPORT};
+  params.with_boycott = true;
+  params.with_suspect = true;
+  params.with_failover = true;
+  serializeAndDeserializeTest(params);
+
+  // Gossip list entries that need 16 and 32 bits.
+  params.gossip_list = {1, 300, 0};
+  params.gossip_ts = {1500000000000ms, 0ms, 1500000600000ms};
+  serializeAndDeserializeTest(params);
+  params.gossip_list = {70000, 0, 1};
+  serializeAndDeserializeTest(params);
+
+  // Timestamps too far apart for 32-bit offsets, and all unknown.
+  params.gossip_ts = {1ms, 0ms, 1500000000000ms};
+  serializeAndDeserializeTest(params);
+  params.gossip_ts = {0ms, 0ms, 0ms};
+  serializeAndDeserializeTest(params);
+}
@@ -18,6 +18,7 @@
 #include "logdevice/common/protocol/STORE_Message.h"
 #include "logdevice/common/test/TestUtil.h"
 #include "logdevice/common/util.h"
+#include "logdevice/server/ServerRecordFilterFactory.h"
 #include "logdevice/server/locallogstore/LocalLogStore.h"
 #include "logdevice/server/locallogstore/WriteOps.h"
 #include "logdevice/server/locallogstore/test/LocalLogStoreTestReader.h"
@@ -53,6 +54,7 @@ struct RecordDescriptor {
   STORE_flags_t flags = 0;
   size_t extra_payload_size = 0;
   DataKeyFormat key_format = DataKeyFormat::DEFAULT;
+  std::string filterable_key;
 };
 
 } // namespace
@@ -108,12 +110,12 @@ class LocalLogStoreReaderTest : public ::testing::TestWithParam<Options> {
     for (ShardID shard : rec.copyset) {
       chain.push_back(StoreChainLink{shard, ClientID::INVALID});
     }
+    std::map<KeyType, std::string> optional_keys;
+    if (!rec.filterable_key.empty()) {
+      optional_keys.emplace(KeyType::FILTERABLE, rec.filterable_key);
+    }
     return LocalLogStoreRecordFormat::formRecordHeader(
-        hdr,
-        chain.data(),
-        buf,
-        shardIDInCopyset(),
-        std::map<KeyType, std::string>());
+        hdr, chain.data(), buf, shardIDInCopyset(), optional_keys);
   }
 
   Slice formCopySetIndexEntry(const RecordDescriptor& rec, std::string* buf) {
@@ -733,6 +735,39 @@ TEST_P(LocalLogStoreReaderTest, FilteredAtEndOfBatch) {
   ASSERT_EQ(1, read_ptr.lsn);
 }
 
+// Records whose filterable key doesn't pass the server-side record filter are
+// passed to the callback without their blob and don't count towards the byte
+// limit.
+TEST_P(LocalLogStoreReaderTest, RecordFilteredByKey) {
+  auto store = createStore({{1, 1, {N1, N2}, 0, 100, {}, "FAIL"},
+                            {2, 1, {N1, N2}, 0, 100, {}, "PASS"},
+                            {3, 1, {N1, N2}, 0, 100, {}, "FAIL"},
+                            {4, 1, {N1, N2}, 0, 100, {}, "FAIL"},
+                            {5, 1, {N1, N2}, 0, 100, {}, "PASS"}});
+
+  std::shared_ptr<ServerRecordFilter> record_filter =
+      ServerRecordFilterFactory::create(
+          ServerRecordFilterType::EQUALITY, "PASS", "PASS");
+
+  std::vector<RawRecord> records;
+  const Status st = ReadOperation()
+                        .use_csi(useCSI())
+                        .until_lsn(5)
+                        .window_high(5)
+                        .last_released(5)
+                        .record_filter(record_filter)
+                        .max_bytes_all_records(
+                            2 * RECORD_Message::expectedSize(200))
+                        .process(store.get(), records);
+
+  ASSERT_EQ(E::UNTIL_LSN_REACHED, st);
+  ASSERT_SHIPPED(records, 1, 2, 3, 4, 5);
+  for (const RawRecord& record : records) {
+    ASSERT_EQ(record.lsn % 3 != 2, record.filtered_out);
+    ASSERT_EQ(record.filtered_out, record.blob.size == 0);
+  }
+}
+
 // Same test as FilteredAtEndOfBatch, but this time the last record to be
 // filtered in the batch is also until_lsn.
 TEST_P(LocalLogStoreReaderTest, UntilLSNFiltered) {
@@ -130,6 +130,24 @@ TEST(LogStorageStateMapTest, WorkerSubscriptions) {
   ASSERT_FALSE(log_state.isWorkerSubscribed(sub));
 }
 
+/**
+ * GENERAL and READ workers with the same index have separate subscriptions.
+ */
+TEST(LogStorageStateMapTest, WorkerSubscriptionsPerWorkerType) {
+  LogStorageStateMap map(1);
+  LogStorageState log_state(logid_t(22), THIS_SHARD, &map);
+  const worker_id_t sub(2);
+
+  log_state.subscribeWorker(sub, WorkerType::READ);
+  ASSERT_TRUE(log_state.isWorkerSubscribed(sub, WorkerType::READ));
+  ASSERT_FALSE(log_state.isWorkerSubscribed(sub, WorkerType::GENERAL));
+
+  log_state.subscribeWorker(sub, WorkerType::GENERAL);
+  log_state.unsubscribeWorker(sub, WorkerType::READ);
+  ASSERT_FALSE(log_state.isWorkerSubscribed(sub, WorkerType::READ));
+  ASSERT_TRUE(log_state.isWorkerSubscribed(sub, WorkerType::GENERAL));
+}
+
 TEST(LogStorageStateMapTest, LastReleasedLSNSource) {
   LogStorageStateMap map(1);
   LogStorageState log_state(logid_t(42), THIS_SHARD, &map);
@@ -148,3 +166,61 @@ TEST(LogStorageStateMapTest, LastReleasedLSNSource) {
   EXPECT_EQ(
       LogStorageState::LastReleasedSource::RELEASE, released_state.source());
 }
+
+TEST(LogStorageStateMapTest, CachedEpochOffsets) {
+  LogStorageStateMap map(1);
+  LogStorageState log_state(logid_t(42), THIS_SHARD, &map);
+
+  EXPECT_FALSE(log_state.getCachedEpochOffset(epoch_t(1)).hasValue());
+  const uint32_t max = LogStorageState::MAX_CACHED_EPOCH_OFFSETS;
+  for (uint32_t e = 1; e <= max + 1; ++e) {
+    log_state.cacheEpochOffset(epoch_t(e), e * 1000);
+  }
+
+  // The lowest epoch was evicted.
+  EXPECT_FALSE(log_state.getCachedEpochOffset(epoch_t(1)).hasValue());
+  for (uint32_t e = 2; e <= max + 1; ++e) {
+    auto offset = log_state.getCachedEpochOffset(epoch_t(e));
+    ASSERT_TRUE(offset.hasValue());
+    EXPECT_EQ(e * 1000, offset.value());
+  }
+}
+
+TEST(LogStorageStateMapTest, LogsWithUnreleasedRecords) {
+  LogStorageStateMap map(1);
+  LogStorageState* log_state = map.insertOrGet(logid_t(42), THIS_SHARD);
+  ASSERT_NE(nullptr, log_state);
+  ASSERT_EQ(0,
+            log_state->updateLastReleasedLSN(
+                10, LogStorageState::LastReleasedSource::RELEASE));
+
+  // Released records and repeated unreleased ones don't add the log again.
+  log_state->noteRecordStored(5);
+  log_state->noteRecordStored(11);
+  log_state->noteRecordStored(12);
+  auto logs = map.takeLogsWithUnreleasedRecords();
+  ASSERT_TRUE(logs.hasValue());
+  LogStorageStateMap::LogKeys expected{{logid_t(42), THIS_SHARD}};
+  EXPECT_EQ(expected, logs.value());
+
+  logs = map.takeLogsWithUnreleasedRecords();
+  ASSERT_TRUE(logs.hasValue());
+  EXPECT_TRUE(logs->empty());
+
+  // Once the detector looked at the log, new records add it again.
+  log_state->clearUnreleasedRecordsNoted();
+  log_state->noteRecordStored(13);
+  logs = map.takeLogsWithUnreleasedRecords();
+  ASSERT_TRUE(logs.hasValue());
+  EXPECT_EQ(expected, logs.value());
+
+  // Too many logs at once.
+  const size_t max = LogStorageStateMap::MAX_NOTED_UNRELEASED_LOGS;
+  for (size_t i = 0; i <= max; ++i) {
+    map.noteUnreleasedRecords(logid_t(i + 100), THIS_SHARD);
+  }
+  EXPECT_FALSE(map.takeLogsWithUnreleasedRecords().hasValue());
+  logs = map.takeLogsWithUnreleasedRecords();
+  ASSERT_TRUE(logs.hasValue());
+  EXPECT_TRUE(logs->empty());
+}
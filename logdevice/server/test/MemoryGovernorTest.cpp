@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/MemoryGovernor.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+
+TEST(MemoryGovernorTest, EvenWithoutStalls) {
+  ResourceBudget a(0), b(0);
+  MemoryGovernor governor;
+  governor.addConsumer("a", &a);
+  governor.addConsumer("b", &b);
+  governor.setLimit(1000, 0.5);
+  governor.maybeRebalance(std::chrono::milliseconds::zero());
+  EXPECT_EQ(500, a.getLimit());
+  EXPECT_EQ(500, b.getLimit());
+}
+
+TEST(MemoryGovernorTest, MovesSpareMemoryToStalledConsumers) {
+  ResourceBudget a(0), b(0);
+  MemoryGovernor governor;
+  auto id_a = governor.addConsumer("a", &a);
+  governor.addConsumer("b", &b);
+  governor.setLimit(1000, 0.5);
+
+  // Each gets its minimum of 250. Of the spare 500, a gets 4/5.
+  governor.noteStalls(id_a, 3);
+  governor.maybeRebalance(std::chrono::milliseconds::zero());
+  EXPECT_EQ(650, a.getLimit());
+  EXPECT_EQ(350, b.getLimit());
+
+  auto consumers = governor.getConsumers();
+  ASSERT_EQ(2, consumers.size());
+  EXPECT_EQ("a", consumers[0].name);
+  EXPECT_EQ(250, consumers[0].min_bytes);
+  EXPECT_EQ(3, consumers[0].stalls);
+
+  // Stalls are only counted until the next rebalancing.
+  governor.maybeRebalance(std::chrono::milliseconds::zero());
+  EXPECT_EQ(500, a.getLimit());
+  EXPECT_EQ(500, b.getLimit());
+}
+
+TEST(MemoryGovernorTest, RebalancesAtMostOncePerInterval) {
+  ResourceBudget a(0);
+  MemoryGovernor governor;
+  governor.addConsumer("a", &a);
+  governor.setLimit(1000, 1);
+  governor.maybeRebalance(std::chrono::hours(1));
+  EXPECT_EQ(1000, a.getLimit());
+  governor.setLimit(2000, 1);
+  governor.maybeRebalance(std::chrono::hours(1));
+  EXPECT_EQ(1000, a.getLimit());
+}
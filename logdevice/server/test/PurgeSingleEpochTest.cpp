@@ -263,6 +263,46 @@ TEST_F(PurgeSingleEpochTest, DeleteRecordsByKey) {
   ASSERT_EQ(0, stats.get().purging_v2_delete_by_reading_data);
 }
 
+// the deletes of a batched delete task, written in one batch with the
+// deletes of other logs, delete the same records as the storage task
+TEST_F(PurgeSingleEpochTest, DeleteRecordsInWriteBatch) {
+  TemporaryRocksDBStore store;
+  const logid_t other_log(LOG_ID.val_ + 1);
+
+  std::vector<TestRecord> test_data = {
+      TestRecord(LOG_ID, lsn(1, 2), esn_t(1)),
+      TestRecord(LOG_ID, lsn(2, 1), esn_t(0)),
+      TestRecord(LOG_ID, lsn(2, 2), esn_t(1)),
+      TestRecord(LOG_ID, lsn(2, 10), esn_t(1)),
+      TestRecord(LOG_ID, lsn(3, 1), esn_t(0)),
+      TestRecord(other_log, lsn(5, 1), esn_t(0)),
+      TestRecord(other_log, lsn(5, 7), esn_t(1)),
+  };
+  store_fill(store, test_data);
+
+  PurgeDeleteRecordsWriteStorageTask task1(
+      LOG_ID, epoch_t(2), esn_t(2), esn_t(100), WeakRef<PurgeSingleEpoch>());
+  PurgeDeleteRecordsWriteStorageTask task2(
+      other_log, epoch_t(5), esn_t(2), esn_t(7), WeakRef<PurgeSingleEpoch>());
+  ASSERT_EQ(99, task1.getNumWriteOps());
+  ASSERT_EQ(6, task2.getNumWriteOps());
+
+  std::vector<const WriteOp*> ops(
+      task1.getNumWriteOps() + task2.getNumWriteOps());
+  size_t n = task1.getWriteOps(ops.data(), ops.size());
+  n += task2.getWriteOps(ops.data() + n, ops.size() - n);
+  ASSERT_EQ(ops.size(), n);
+  ASSERT_EQ(0, store.writeMulti(ops));
+
+  const std::vector<lsn_t> expected_lsns = {
+      lsn(1, 2),
+      lsn(2, 1),
+      lsn(3, 1),
+  };
+  ASSERT_EQ(expected_lsns, getLsnsForLog(LOG_ID, store));
+  ASSERT_EQ(std::vector<lsn_t>({lsn(5, 1)}), getLsnsForLog(other_log, store));
+}
+
 TEST_F(PurgeSingleEpochTest, DeleteRecordsByReadingData) {
   TemporaryRocksDBStore store;
   StatsHolder stats(StatsParams().setIsServer(true));
@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/storage_tasks/ReadScheduler.h"
+
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+
+namespace {
+
+struct ReadTask : public StorageTask {
+  ReadTask(ClientID client, logid_t log, lsn_t lsn)
+      : StorageTask(StorageTask::Type::UNKNOWN),
+        client(client),
+        log(log),
+        lsn(lsn) {}
+  void execute() override {}
+  void onDone() override {}
+  void onDropped() override {}
+  folly::Optional<std::pair<logid_t, lsn_t>> getReadPosition() const override {
+    return std::make_pair(log, lsn);
+  }
+  ClientID getReadClient() const override {
+    return client;
+  }
+  ClientID client;
+  logid_t log;
+  lsn_t lsn;
+};
+
+const ClientID A(1);
+const ClientID B(2);
+
+ReadScheduler::TaskVector tasks(std::vector<ReadTask> v) {
+  ReadScheduler::TaskVector res;
+  for (auto& t : v) {
+    res.push_back(std::make_unique<ReadTask>(t.client, t.log, t.lsn));
+  }
+  return res;
+}
+
+std::vector<std::pair<logid_t, lsn_t>>
+positions(const ReadScheduler::TaskVector& v) {
+  std::vector<std::pair<logid_t, lsn_t>> res;
+  for (auto& t : v) {
+    res.push_back(t->getReadPosition().value());
+  }
+  return res;
+}
+
+// Schedules `v` and takes all tasks out, in order.
+std::vector<std::pair<logid_t, lsn_t>> scheduleAll(ReadScheduler& scheduler,
+                                                   std::vector<ReadTask> v) {
+  auto res = positions(scheduler.schedule(tasks(std::move(v))));
+  while (true) {
+    auto group = positions(scheduler.takeNextGroup());
+    if (group.empty()) {
+      return res;
+    }
+    res.insert(res.end(), group.begin(), group.end());
+  }
+}
+
+} // namespace
+
+// A client with many queued reads doesn't delay the reads of other clients.
+TEST(ReadSchedulerTest, RoundRobinBetweenClients) {
+  ReadScheduler scheduler(8);
+  std::vector<std::pair<logid_t, lsn_t>> expected = {
+      {logid_t(1), 1}, {logid_t(4), 1}, {logid_t(2), 1}, {logid_t(3), 1}};
+  EXPECT_EQ(expected,
+            scheduleAll(scheduler,
+                        {{A, logid_t(1), 1},
+                         {A, logid_t(2), 1},
+                         {A, logid_t(3), 1},
+                         {B, logid_t(4), 1}}));
+  EXPECT_EQ(0, scheduler.numHeld());
+}
+
+// Reads of the same log go together sorted by LSN, and count as turns of
+// their clients.
+TEST(ReadSchedulerTest, GroupByLog) {
+  ReadScheduler scheduler(8);
+  // B's next turn is skipped since its read of log 1 went along with A's.
+  std::vector<std::pair<logid_t, lsn_t>> expected = {
+      {logid_t(1), 10}, {logid_t(1), 20}, {logid_t(3), 1}, {logid_t(2), 1}};
+  EXPECT_EQ(expected,
+            scheduleAll(scheduler,
+                        {{A, logid_t(1), 20},
+                         {A, logid_t(3), 1},
+                         {B, logid_t(1), 10},
+                         {B, logid_t(2), 1}}));
+}
+
+// Up to the window, tasks put in are held back.
+TEST(ReadSchedulerTest, Window) {
+  ReadScheduler scheduler(2);
+  auto out = scheduler.schedule(tasks({{A, logid_t(1), 1},
+                                       {A, logid_t(2), 1},
+                                       {A, logid_t(3), 1},
+                                       {A, logid_t(4), 1}}));
+  EXPECT_EQ(2, out.size());
+  EXPECT_EQ(2, scheduler.numHeld());
+
+  out = scheduler.schedule(tasks({{B, logid_t(5), 1}}));
+  std::vector<std::pair<logid_t, lsn_t>> expected = {{logid_t(3), 1}};
+  EXPECT_EQ(expected, positions(out));
+  EXPECT_EQ(2, scheduler.numHeld());
+
+  expected = {{logid_t(5), 1}};
+  EXPECT_EQ(expected, positions(scheduler.takeNextGroup()));
+  EXPECT_EQ(1, scheduler.takeAll().size());
+  EXPECT_EQ(0, scheduler.numHeld());
+  EXPECT_TRUE(scheduler.takeNextGroup().empty());
+}
@@ -181,6 +181,8 @@ static std::unordered_set<std::pair<logid_t, shard_index_t>>
     restart_timer_activated;
 static std::unordered_set<uint32_t> stall_timer_activated;
 static std::unordered_set<uint32_t> restart_scheduled;
+static std::unordered_set<uint32_t> throttle_timer_activated;
+static std::chrono::microseconds foreground_store_latency{0};
 
 class MockedRebuildingCoordinator;
 
@@ -270,6 +272,16 @@ class MockedShardRebuildingV1 : public ShardRebuildingV1 {
     restart_timer_activated.erase(std::make_pair(logid, shard_));
   }
 
+  void activateThrottleTimer() override {
+    throttle_timer_activated.insert(shard_);
+  }
+
+  ForegroundLoad getForegroundLoad() override {
+    ForegroundLoad load;
+    load.store_latency_p99 = foreground_store_latency;
+    return load;
+  }
+
   void start(std::unordered_map<logid_t, std::unique_ptr<RebuildingPlan>> plan)
       override;
 
@@ -512,6 +524,8 @@ class RebuildingCoordinatorTest : public ::testing::Test {
     restart_timer_activated.clear();
     stall_timer_activated.clear();
     restart_scheduled.clear();
+    throttle_timer_activated.clear();
+    foreground_store_latency = std::chrono::microseconds(0);
 
     dbg::assertOnData = true;
   }
@@ -833,6 +847,13 @@ class RebuildingCoordinatorTest : public ::testing::Test {
     reb->onStallTimerExpired();
   }
 
+  void fireThrottleTimer(uint32_t shard_idx) {
+    auto reb = getShard(shard_idx);
+    ld_check(throttle_timer_activated.count(shard_idx));
+    throttle_timer_activated.erase(shard_idx);
+    reb->onThrottleTimerExpired();
+  }
+
   size_t num_nodes = 4;
   shard_size_t num_shards = 2;
   size_t num_logs = 10;
@@ -1248,6 +1269,48 @@ TEST_F(RebuildingCoordinatorTest, NoGlobalWindowAndMaxLogsInFlightLimit) {
   ASSERT_SHARD_REBUILT(1, v1);
 }
 
+// The donor halves the number of logs it rebuilds at the same time while
+// foreground stores are slower than rebuilding-donor-store-latency-target,
+// and adds them back one at a time once they are not.
+TEST_F(RebuildingCoordinatorTest, DonorThrottling) {
+  settings.local_window = RecordTimestamp::duration::max();
+  settings.global_window = RecordTimestamp::duration::max();
+  settings.max_logs_in_flight = 4;
+  settings.donor_store_latency_target = std::chrono::milliseconds(10);
+  num_logs = 20;
+  num_shards = 2;
+
+  start();
+
+  lsn_t v1 = onShardNeedsRebuild(2, 1, 0 /* flags */);
+  RebuildingSet set({{N2S1, RebuildingNodeInfo(RebuildingMode::RESTORE)}});
+  ASSERT_STARTED(set, RecordTimestamp::max(), 1, 3, 5, 7);
+
+  // Foreground stores are slow, go down to 2 logs in flight.
+  foreground_store_latency = std::chrono::milliseconds(50);
+  fireThrottleTimer(1);
+  onLogRebuildingComplete(1, 1, v1);
+  ASSERT_NO_STARTED();
+  onLogRebuildingComplete(3, 1, v1);
+  ASSERT_NO_STARTED();
+  onLogRebuildingComplete(5, 1, v1);
+  ASSERT_EQ(1, received.start.size());
+  received.start.clear();
+
+  // Foreground stores recovered, the freed slot is used right away.
+  foreground_store_latency = std::chrono::milliseconds(1);
+  fireThrottleTimer(1);
+  ASSERT_EQ(1, received.start.size());
+  received.start.clear();
+
+  // Back to rebuilding-max-logs-in-flight, and not beyond.
+  fireThrottleTimer(1);
+  ASSERT_EQ(1, received.start.size());
+  received.start.clear();
+  fireThrottleTimer(1);
+  ASSERT_NO_STARTED();
+}
+
 // One of my shards is being rebuilt by the other nodes in the cluster. All I
 // have to do is wait until all donors rebuilt it and acknowledge.
 TEST_F(RebuildingCoordinatorTest, MyShardAck) {
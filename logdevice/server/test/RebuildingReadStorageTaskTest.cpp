@@ -505,3 +505,77 @@ TEST_F(RebuildingReadStorageTaskTest, TimeRanges) {
               convertChunks(chunks));
   }
 }
+
+TEST_F(RebuildingReadStorageTaskTest, Ranges) {
+  logid_t L1(1), L2(2);
+  logid_t M1 = MetaDataLog::metaDataLogID(L1);
+  auto& P = partition_start;
+  ReplicationProperty R({{NodeLocationScope::NODE, 3}});
+  StorageSet all_nodes{N0, N1, N2, N3, N4, N5, N6, N7, N8, N9};
+
+  // Rebuilding set is {N2}, all records have a copy on N2.
+  auto rebuilding_set = std::make_shared<RebuildingSet>();
+  rebuilding_set->shards.emplace(
+      ShardID(2, 0), RebuildingNodeInfo(RebuildingMode::RESTORE));
+
+  store->putRecord(M1, mklsn(1, 1), BASE_TIME - MINUTE, {N1, N2, N3});
+  for (size_t i = 0; i < 6; ++i) {
+    store->putRecord(L1, mklsn(1, i + 1), P[i] + MINUTE, {N1, N2, N3});
+    store->putRecord(L2, mklsn(1, i + 1), P[i] + MINUTE, {N1, N2, N3});
+  }
+  EXPECT_EQ(
+      std::vector<size_t>({2, 2, 2, 2, 2, 2}), store->getNumLogsPerPartition());
+
+  // Split the shard into 3 ranges, and read each of them with its own
+  // context. splitIntoRanges() is called twice to get the ends of ranges,
+  // which are the starts of the following ones.
+  LocalLogStore::ReadOptions opts("RebuildingReadStorageTaskTest", true);
+  auto it = store->readAllLogs(opts);
+  auto starts = it->splitIntoRanges(3);
+  auto ends = it->splitIntoRanges(3);
+  ASSERT_EQ(3, starts.size());
+
+  std::vector<std::vector<ChunkDescription>> ranges;
+  for (size_t i = 0; i < starts.size(); ++i) {
+    auto c = createContext(rebuilding_set);
+    for (logid_t log : {L1, L2, M1}) {
+      c->logs[log].plan.untilLSN = LSN_MAX;
+      c->logs[log].plan.addEpochRange(
+          EPOCH_INVALID,
+          EPOCH_MAX,
+          std::make_shared<EpochMetaData>(all_nodes, R));
+    }
+    c->nextLocation = std::move(starts[i]);
+    if (i + 1 < ends.size()) {
+      c->endLocation = std::move(ends[i + 1]);
+    }
+
+    ranges.emplace_back();
+    while (!c->reachedEnd) {
+      MockRebuildingReadStorageTaskV2 task(this, c);
+      task.execute();
+      task.onDone();
+      ASSERT_FALSE(c->persistentError);
+      auto batch = convertChunks(chunks);
+      ranges.back().insert(ranges.back().end(), batch.begin(), batch.end());
+    }
+  }
+
+  // The first range also covers the unpartitioned metadata logs.
+  EXPECT_EQ(std::vector<ChunkDescription>({{M1, mklsn(1, 1)},
+                                           {L1, mklsn(1, 1)},
+                                           {L2, mklsn(1, 1)},
+                                           {L1, mklsn(1, 2)},
+                                           {L2, mklsn(1, 2)}}),
+            ranges[0]);
+  EXPECT_EQ(std::vector<ChunkDescription>({{L1, mklsn(1, 3)},
+                                           {L2, mklsn(1, 3)},
+                                           {L1, mklsn(1, 4)},
+                                           {L2, mklsn(1, 4)}}),
+            ranges[1]);
+  EXPECT_EQ(std::vector<ChunkDescription>({{L1, mklsn(1, 5)},
+                                           {L2, mklsn(1, 5)},
+                                           {L1, mklsn(1, 6)},
+                                           {L2, mklsn(1, 6)}}),
+            ranges[2]);
+}
@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/RecordCacheMonitorThread.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+
+TEST(RecordCacheMonitorThreadTest, BudgetShares) {
+  // Without hits, shards share the budget equally.
+  std::vector<double> expected = {0.25, 0.25, 0.25, 0.25};
+  EXPECT_EQ(expected,
+            RecordCacheMonitorThread::computeBudgetShares({0, 0, 0, 0}, 0.5));
+
+  // Half of the budget follows the hits.
+  expected = {0.125 + 0.5, 0.125, 0.125 + 0.25, 0.125};
+  auto shares =
+      RecordCacheMonitorThread::computeBudgetShares({50, 0, 25, 0}, 0.5);
+  ASSERT_EQ(expected.size(), shares.size());
+  for (size_t i = 0; i < shares.size(); ++i) {
+    EXPECT_DOUBLE_EQ(expected[i], shares[i]);
+  }
+
+  // With a weight of 0 hits are ignored.
+  expected = {0.5, 0.5};
+  EXPECT_EQ(expected,
+            RecordCacheMonitorThread::computeBudgetShares({100, 0}, 0));
+}
+
+TEST(RecordCacheMonitorThreadTest, ShardEvictionTargets) {
+  // One hot shard over its equal share: only that shard evicts, and keeps
+  // what the quiet shards don't use.
+  std::vector<size_t> expected = {500, 0, 0, 0};
+  EXPECT_EQ(expected,
+            RecordCacheMonitorThread::computeShardEvictionTargets(
+                {1000, 100, 100, 100}, {0.25, 0.25, 0.25, 0.25}, 500));
+
+  // Shards over their share of what remains evict down to it.
+  expected = {150, 50, 0};
+  EXPECT_EQ(expected,
+            RecordCacheMonitorThread::computeShardEvictionTargets(
+                {400, 300, 100}, {0.25, 0.25, 0.5}, 200));
+
+  // Evicting more than is cached evicts everything.
+  expected = {10, 20};
+  EXPECT_EQ(expected,
+            RecordCacheMonitorThread::computeShardEvictionTargets(
+                {10, 20}, {0.5, 0.5}, 100));
+}
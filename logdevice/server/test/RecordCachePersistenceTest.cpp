@@ -0,0 +1,48 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/RecordCachePersistence.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+using namespace facebook::logdevice::RecordCachePersistence;
+
+TEST(RecordCachePersistenceTest, ChunkIndexSerialization) {
+  std::vector<SnapshotChunk> chunks{{logid_t(1), logid_t(777), 15000000},
+                                    {logid_t(999), logid_t(1337), 14}};
+  std::string blob = serializeChunkIndex(chunks);
+  std::vector<SnapshotChunk> out;
+  ASSERT_EQ(0, deserializeChunkIndex(Slice(blob.data(), blob.size()), &out));
+  EXPECT_EQ(chunks, out);
+
+  // An index without chunks is valid.
+  blob = serializeChunkIndex({});
+  ASSERT_EQ(0, deserializeChunkIndex(Slice(blob.data(), blob.size()), &out));
+  EXPECT_TRUE(out.empty());
+}
+
+TEST(RecordCachePersistenceTest, MalformedChunkIndex) {
+  std::vector<SnapshotChunk> out;
+  EXPECT_EQ(-1, deserializeChunkIndex(Slice(), &out));
+
+  std::string blob =
+      serializeChunkIndex({{logid_t(1), logid_t(777), 15000000}});
+  // Truncated.
+  EXPECT_EQ(
+      -1, deserializeChunkIndex(Slice(blob.data(), blob.size() - 1), &out));
+  // Unknown version.
+  std::string bad_version = blob;
+  bad_version[0] = 0x7f;
+  EXPECT_EQ(-1,
+            deserializeChunkIndex(
+                Slice(bad_version.data(), bad_version.size()), &out));
+  // Overlapping chunks.
+  blob = serializeChunkIndex({{logid_t(1), logid_t(777), 1},
+                              {logid_t(777), logid_t(1337), 1}});
+  EXPECT_EQ(-1, deserializeChunkIndex(Slice(blob.data(), blob.size()), &out));
+}
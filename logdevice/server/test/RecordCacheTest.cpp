@@ -1833,6 +1833,26 @@ TEST_F(RecordCacheTest, AdvanceLCE) {
   ASSERT_EQ(nullptr, result.second);
 }
 
+TEST_F(RecordCacheTest, PendingDigest) {
+  epoch_cache_capacity_ = 10;
+  initial_seal_epoch_ = epoch_t(5);
+  create();
+  int rv = putRecord(cache_.get(), lsn(8, 5), 2);
+  ASSERT_EQ(0, rv);
+  rv = putRecord(cache_.get(), lsn(10, 7), 3);
+  ASSERT_EQ(0, rv);
+  ASSERT_FALSE(cache_->hasPendingDigest());
+
+  cache_->onDigestServed(epoch_t(10));
+  cache_->onDigestServed(epoch_t(8));
+  ASSERT_TRUE(cache_->hasPendingDigest());
+  // recovery cleaned epoch 8, but epoch 10 is still cached
+  cache_->onLastCleanEpochAdvanced(epoch_t(8));
+  ASSERT_TRUE(cache_->hasPendingDigest());
+  cache_->onLastCleanEpochAdvanced(epoch_t(10));
+  ASSERT_FALSE(cache_->hasPendingDigest());
+}
+
 TEST_F(RecordCacheTest, BasicSequencing) {
   epoch_cache_capacity_ = 10;
   create();
@@ -7,7 +7,10 @@
  */
 #include "logdevice/server/storage_tasks/StorageThreadPool.h"
 
+#include <algorithm>
 #include <atomic>
+#include <mutex>
+#include <utility>
 
 #include <folly/Memory.h>
 #include <folly/synchronization/Baton.h>
@@ -38,10 +41,13 @@ struct SimpleStorageTask : public StorageTask {
 };
 
 struct TestTask : public StorageTask {
-  TestTask(ThreadType thread_type, std::function<void()> fn)
+  TestTask(ThreadType thread_type,
+           std::function<void()> fn,
+           bool stealable = false)
       : StorageTask(StorageTask::Type::UNKNOWN),
         thread_type(thread_type),
-        fn(fn) {}
+        fn(fn),
+        stealable(stealable) {}
 
   void execute() override {
     fn();
@@ -49,6 +55,9 @@ struct TestTask : public StorageTask {
   ThreadType getThreadType() const override {
     return thread_type;
   }
+  bool isStealable() const override {
+    return stealable;
+  }
   void onDone() override {}
   void onDropped() override {
     ld_check(false && "Storage task dropped");
@@ -56,6 +65,7 @@ struct TestTask : public StorageTask {
 
   ThreadType thread_type;
   std::function<void()> fn;
+  bool stealable;
 };
 
 } // namespace
@@ -328,3 +338,199 @@ TEST(StorageThreadPoolTest, BatchLimits) {
   res = pool.tryGetWriteBatch(ttype, limit, byte_limit);
   ASSERT_EQ(1, res.size());
 }
+
+// Two pools with one slow thread each. While the thread of the first pool is
+// busy, its stealable tasks should be executed by the thread of the second
+// pool, and the rest should wait for the first pool's thread.
+TEST(StorageThreadPoolTest, WorkStealing) {
+  Alarm alarm(std::chrono::seconds(60));
+  Settings init_settings = create_default_settings<Settings>();
+  init_settings.storage_task_stealing_interval = std::chrono::milliseconds(1);
+  UpdateableSettings<Settings> settings(init_settings);
+  StorageThreadPool::Params params;
+  params[(size_t)StorageTaskThreadType::SLOW].nthreads = 1;
+
+  TemporaryRocksDBStore store0;
+  TemporaryRocksDBStore store1;
+  std::vector<std::unique_ptr<StorageThreadPool>> pools;
+  pools.push_back(
+      std::make_unique<StorageThreadPool>(0, params, settings, &store0, 16));
+  pools.push_back(
+      std::make_unique<StorageThreadPool>(1, params, settings, &store1, 16));
+  for (auto& pool : pools) {
+    pool->setSiblingPools(&pools);
+  }
+
+  // Occupy the thread of the first pool.
+  Semaphore blocking_sem;
+  folly::Baton<> blocking_started;
+  ASSERT_EQ(0,
+            pools[0]->tryPutTask(std::make_unique<TestTask>(
+                StorageTask::ThreadType::SLOW, [&]() {
+                  blocking_started.post();
+                  blocking_sem.wait();
+                })));
+  blocking_started.wait();
+
+  std::atomic<bool> non_stealable_done(false);
+  ASSERT_EQ(0,
+            pools[0]->tryPutTask(std::make_unique<TestTask>(
+                StorageTask::ThreadType::SLOW,
+                [&]() { non_stealable_done.store(true); })));
+
+  Semaphore stealable_sem;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(0,
+              pools[0]->tryPutTask(std::make_unique<TestTask>(
+                  StorageTask::ThreadType::SLOW,
+                  [&]() { stealable_sem.post(); },
+                  /* stealable */ true)));
+  }
+  for (int i = 0; i < 3; ++i) {
+    stealable_sem.wait();
+  }
+  EXPECT_EQ(3, pools[0]->getNumTasksStolen());
+  EXPECT_EQ(0, pools[1]->getNumTasksStolen());
+  EXPECT_FALSE(non_stealable_done.load());
+
+  blocking_sem.post();
+  for (auto& pool : pools) {
+    pool->shutDown();
+  }
+  for (auto& pool : pools) {
+    pool->join();
+  }
+  EXPECT_TRUE(non_stealable_done.load());
+}
+
+// Tasks of the same priority should run earliest deadline first, ahead of
+// tasks without a deadline, and tasks whose deadline has passed while they
+// were queued should be dropped.
+TEST(StorageThreadPoolTest, Deadlines) {
+  struct DeadlineTask : public TestTask {
+    DeadlineTask(std::function<void()> fn,
+                 std::atomic<int>* dropped,
+                 std::chrono::steady_clock::time_point deadline)
+        : TestTask(StorageTask::ThreadType::SLOW, fn), dropped(dropped) {
+      setDeadline(deadline);
+    }
+    void onStorageThreadDrop() override {
+      ++*dropped;
+    }
+    std::atomic<int>* dropped;
+  };
+
+  Alarm alarm(std::chrono::seconds(60));
+  UpdateableSettings<Settings> settings;
+  StorageThreadPool::Params params;
+  params[(size_t)StorageTaskThreadType::SLOW].nthreads = 1;
+  TemporaryRocksDBStore store;
+  auto pool =
+      std::make_unique<StorageThreadPool>(0, params, settings, &store, 16);
+
+  // Occupy the only thread.
+  Semaphore blocking_sem;
+  folly::Baton<> blocking_started;
+  ASSERT_EQ(0,
+            pool->tryPutTask(std::make_unique<TestTask>(
+                StorageTask::ThreadType::SLOW, [&]() {
+                  blocking_started.post();
+                  blocking_sem.wait();
+                })));
+  blocking_started.wait();
+
+  std::mutex mutex;
+  std::vector<int> order;
+  auto record = [&](int i) {
+    return [&, i]() {
+      std::lock_guard<std::mutex> lock(mutex);
+      order.push_back(i);
+    };
+  };
+  std::atomic<int> dropped(0);
+  auto now = std::chrono::steady_clock::now();
+  ASSERT_EQ(0,
+            pool->tryPutTask(std::make_unique<TestTask>(
+                StorageTask::ThreadType::SLOW, record(1))));
+  ASSERT_EQ(0,
+            pool->tryPutTask(std::make_unique<DeadlineTask>(
+                record(2), &dropped, now + std::chrono::hours(2))));
+  ASSERT_EQ(0,
+            pool->tryPutTask(std::make_unique<DeadlineTask>(
+                record(3), &dropped, now + std::chrono::hours(1))));
+  ASSERT_EQ(0,
+            pool->tryPutTask(std::make_unique<DeadlineTask>(
+                record(4), &dropped, now - std::chrono::seconds(1))));
+
+  blocking_sem.post();
+  pool->shutDown();
+  pool->join();
+
+  EXPECT_EQ(std::vector<int>({3, 2, 1}), order);
+  EXPECT_EQ(1, dropped.load());
+}
+
+// With read batching enabled, read tasks queued while the thread is busy
+// should be executed together, sorted by log and LSN.
+TEST(StorageThreadPoolTest, ReadBatching) {
+  struct ReadPositionTask : public TestTask {
+    ReadPositionTask(std::function<void()> fn, logid_t log, lsn_t lsn)
+        : TestTask(StorageTask::ThreadType::SLOW, fn), log(log), lsn(lsn) {}
+    folly::Optional<std::pair<logid_t, lsn_t>>
+    getReadPosition() const override {
+      return std::make_pair(log, lsn);
+    }
+    logid_t log;
+    lsn_t lsn;
+  };
+
+  Alarm alarm(std::chrono::seconds(60));
+  Settings init_settings = create_default_settings<Settings>();
+  init_settings.storage_thread_read_batch_size = 8;
+  UpdateableSettings<Settings> settings(init_settings);
+  StorageThreadPool::Params params;
+  params[(size_t)StorageTaskThreadType::SLOW].nthreads = 1;
+  TemporaryRocksDBStore store;
+  auto pool =
+      std::make_unique<StorageThreadPool>(0, params, settings, &store, 16);
+
+  // Occupy the only thread.
+  Semaphore blocking_sem;
+  folly::Baton<> blocking_started;
+  ASSERT_EQ(0,
+            pool->tryPutTask(std::make_unique<TestTask>(
+                StorageTask::ThreadType::SLOW, [&]() {
+                  blocking_started.post();
+                  blocking_sem.wait();
+                })));
+  blocking_started.wait();
+
+  std::mutex mutex;
+  std::vector<std::pair<logid_t, lsn_t>> order;
+  Semaphore done_sem;
+  std::vector<std::pair<logid_t, lsn_t>> positions = {
+      {logid_t(2), 5}, {logid_t(1), 9}, {logid_t(2), 1}, {logid_t(1), 3}};
+  for (auto pos : positions) {
+    ASSERT_EQ(0,
+              pool->tryPutTask(std::make_unique<ReadPositionTask>(
+                  [&, pos]() {
+                    {
+                      std::lock_guard<std::mutex> lock(mutex);
+                      order.push_back(pos);
+                    }
+                    done_sem.post();
+                  },
+                  pos.first,
+                  pos.second)));
+  }
+
+  blocking_sem.post();
+  for (size_t i = 0; i < positions.size(); ++i) {
+    done_sem.wait();
+  }
+  pool->shutDown();
+  pool->join();
+
+  std::sort(positions.begin(), positions.end());
+  EXPECT_EQ(positions, order);
+}
@@ -80,10 +80,10 @@ std::shared_ptr<ServerProcessor> make_test_server_processor(
 
 void shutdown_test_server(std::shared_ptr<ServerProcessor>& processor) {
   std::unique_ptr<AdminServer> admin_handle;
-  std::unique_ptr<EventLoopHandle> connection_listener;
+  std::vector<std::unique_ptr<EventLoopHandle>> connection_listeners;
   std::unique_ptr<EventLoopHandle> command_listener;
   std::unique_ptr<EventLoopHandle> gossip_listener;
-  std::unique_ptr<EventLoopHandle> ssl_connection_listener;
+  std::vector<std::unique_ptr<EventLoopHandle>> ssl_connection_listeners;
   std::unique_ptr<LogStoreMonitor> logstore_monitor;
   std::unique_ptr<ShardedStorageThreadPool> storage_thread_pool;
   std::unique_ptr<ShardedRocksDBLocalLogStore> sharded_store;
@@ -93,10 +93,10 @@ void shutdown_test_server(std::shared_ptr<ServerProcessor>& processor) {
   std::shared_ptr<UnreleasedRecordDetector> unreleased_record_detector;
 
   shutdown_server(admin_handle,
-                  connection_listener,
+                  connection_listeners,
                   command_listener,
                   gossip_listener,
-                  ssl_connection_listener,
+                  ssl_connection_listeners,
                   logstore_monitor,
                   processor,
                   storage_thread_pool,
@@ -340,6 +340,11 @@ bool UnreleasedRecordDetectorTest::waitUntilSequencerIsActive(
 void UnreleasedRecordDetectorTest::setHighestInsertedLSN(lsn_t lsn) {
   static_cast<TemporaryRocksDBStoreExt*>(sharded_store_->getByIndex(0))
       ->setHighestInsertedLSN(lsn);
+  // let the detector know, as a STORE would
+  LogStorageState* state =
+      processor_->getLogStorageStateMap().insertOrGet(LOG_ID, 0);
+  ASSERT_NE(nullptr, state);
+  state->noteRecordStored(lsn);
 }
 
 /**
@@ -0,0 +1,104 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Random.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
+#include "logdevice/server/locallogstore/RocksDBKeyFormat.h"
+
+using namespace facebook::logdevice;
+using namespace facebook::logdevice::RocksDBKeyFormat;
+
+/**
+ * @file: compares decoding DataKeys field by field (getLogID() + getLSN())
+ *        with the fused getLogIDAndLSN(), over a buffer of serialized keys
+ *        laid out like consecutive keys in a data block.
+ */
+
+const size_t N_KEYS = 1 << 16;
+
+static std::vector<char> makeKeys() {
+  std::vector<char> buf;
+  buf.reserve(N_KEYS * DataKey::sizeForWriting());
+  logid_t log(folly::Random::rand64(1, 1 << 20));
+  lsn_t lsn = folly::Random::rand64(1, 1ul << 40);
+  for (size_t i = 0; i < N_KEYS; ++i) {
+    if (folly::Random::oneIn(100)) {
+      log = logid_t(log.val_ + 1);
+    }
+    lsn += folly::Random::rand32(1, 10);
+    DataKey key(log, lsn);
+    rocksdb::Slice slice = key.sliceForWriting();
+    buf.insert(buf.end(), slice.data(), slice.data() + slice.size());
+  }
+  return buf;
+}
+
+BENCHMARK(DataKeyScalarDecode, iters) {
+  std::vector<char> buf;
+  BENCHMARK_SUSPEND {
+    buf = makeKeys();
+  }
+  const size_t key_size = DataKey::sizeForWriting();
+  for (size_t it = 0; it < iters; ++it) {
+    const char* key = &buf[(it % N_KEYS) * key_size];
+    folly::doNotOptimizeAway(DataKey::getLogID(key));
+    folly::doNotOptimizeAway(DataKey::getLSN(key));
+  }
+}
+
+BENCHMARK_RELATIVE(DataKeyFusedDecode, iters) {
+  std::vector<char> buf;
+  BENCHMARK_SUSPEND {
+    buf = makeKeys();
+  }
+  const size_t key_size = DataKey::sizeForWriting();
+  for (size_t it = 0; it < iters; ++it) {
+    const char* key = &buf[(it % N_KEYS) * key_size];
+    folly::doNotOptimizeAway(DataKey::getLogIDAndLSN(key));
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(DataKeyDecodeLogIDCompare, iters) {
+  std::vector<char> buf;
+  BENCHMARK_SUSPEND {
+    buf = makeKeys();
+  }
+  const size_t key_size = DataKey::sizeForWriting();
+  const logid_t log = DataKey::getLogID(&buf[0]);
+  for (size_t it = 0; it < iters; ++it) {
+    const char* key = &buf[(it % N_KEYS) * key_size];
+    folly::doNotOptimizeAway(DataKey::getLogID(key) == log);
+  }
+}
+
+BENCHMARK_RELATIVE(DataKeyRawLogIDCompare, iters) {
+  std::vector<char> buf;
+  BENCHMARK_SUSPEND {
+    buf = makeKeys();
+  }
+  const size_t key_size = DataKey::sizeForWriting();
+  const logid_t log = DataKey::getLogID(&buf[0]);
+  for (size_t it = 0; it < iters; ++it) {
+    const char* key = &buf[(it % N_KEYS) * key_size];
+    folly::doNotOptimizeAway(DataKey::belongsToLog(key, log));
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  runBenchmarksWithReport();
+  return 0;
+}
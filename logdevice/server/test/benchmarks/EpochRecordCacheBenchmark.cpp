@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Random.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/PayloadHolder.h"
+#include "logdevice/common/RecordID.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
+#include "logdevice/server/EpochRecordCache.h"
+#include "logdevice/server/EpochRecordCacheEntry.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file: scans of a dense EpochRecordCache holding small records, as done
+ *        when reading it for epoch recovery (full snapshot, sequential and
+ *        random reads) and when records are released.
+ */
+
+DEFINE_int32(capacity, 4096, "capacity of the epoch cache");
+DEFINE_int32(payload_size, 16, "payload size of the cached records");
+
+namespace {
+
+const logid_t LOG_ID(1);
+const epoch_t EPOCH(7);
+
+class Deps : public EpochRecordCacheDependencies {
+ public:
+  void disposeOfCacheEntry(std::unique_ptr<EpochRecordCacheEntry>) override {}
+  void onRecordsReleased(const EpochRecordCache&,
+                         lsn_t,
+                         lsn_t,
+                         const ReleasedVector&) override {}
+};
+
+void putRecord(EpochRecordCache& cache, esn_t esn, esn_t lng) {
+  void* payload = malloc(FLAGS_payload_size);
+  auto ph = std::make_shared<PayloadHolder>(payload, FLAGS_payload_size);
+  cache.putRecord(RecordID(compose_lsn(EPOCH, esn), LOG_ID),
+                  /*timestamp=*/esn.val_,
+                  lng,
+                  /*wave_or_recovery_epoch=*/1,
+                  copyset_t({ShardID(1, 0), ShardID(2, 0), ShardID(3, 0)}),
+                  STORE_flags_t(0),
+                  {},
+                  Slice(payload, FLAGS_payload_size),
+                  ph);
+}
+
+// Creates a cache with all of its slots filled.
+std::unique_ptr<EpochRecordCache> createDenseCache(Deps* deps) {
+  auto cache =
+      std::make_unique<EpochRecordCache>(LOG_ID,
+                                         shard_index_t(0),
+                                         EPOCH,
+                                         deps,
+                                         FLAGS_capacity,
+                                         EpochRecordCache::TailOptimized::NO,
+                                         EpochRecordCache::StoredBefore::NEVER);
+  for (int i = 1; i <= FLAGS_capacity; ++i) {
+    putRecord(*cache, esn_t(i), ESN_INVALID);
+  }
+  return cache;
+}
+
+} // namespace
+
+BENCHMARK(SnapshotSequentialScan, iters) {
+  Deps deps;
+  std::unique_ptr<EpochRecordCache> cache;
+  BENCHMARK_SUSPEND {
+    cache = createDenseCache(&deps);
+  }
+  for (size_t it = 0; it < iters; ++it) {
+    auto snapshot = cache->createSnapshot();
+    uint64_t sum = 0;
+    for (auto i = snapshot->createIterator(); !i->atEnd(); i->next()) {
+      auto record = i->getRecord();
+      sum += record.timestamp + record.payload_raw.size;
+    }
+    folly::doNotOptimizeAway(sum);
+  }
+  BENCHMARK_SUSPEND {
+    cache.reset();
+  }
+}
+
+BENCHMARK(SnapshotRandomReads, iters) {
+  Deps deps;
+  std::unique_ptr<EpochRecordCache> cache;
+  std::unique_ptr<EpochRecordCache::Snapshot> snapshot;
+  BENCHMARK_SUSPEND {
+    cache = createDenseCache(&deps);
+    snapshot = cache->createSnapshot();
+  }
+  for (size_t it = 0; it < iters; ++it) {
+    const esn_t esn(folly::Random::rand32(1, FLAGS_capacity + 1));
+    folly::doNotOptimizeAway(snapshot->getRecord(esn).second.timestamp);
+  }
+  BENCHMARK_SUSPEND {
+    snapshot.reset();
+    cache.reset();
+  }
+}
+
+BENCHMARK(PutAndRelease, iters) {
+  Deps deps;
+  EpochRecordCache cache(LOG_ID,
+                         shard_index_t(0),
+                         EPOCH,
+                         &deps,
+                         FLAGS_capacity,
+                         EpochRecordCache::TailOptimized::NO,
+                         EpochRecordCache::StoredBefore::NEVER);
+  for (size_t it = 0; it < iters; ++it) {
+    // The first record of each window releases the whole previous window.
+    const esn_t esn(it + 1);
+    putRecord(cache, esn, esn_t(it / FLAGS_capacity * FLAGS_capacity));
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  runBenchmarksWithReport();
+  return 0;
+}
@@ -0,0 +1,598 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <folly/Format.h>
+#include <folly/String.h>
+#include <folly/experimental/TestUtil.h>
+
+#include "logdevice/common/LocalLogStoreRecordFormat.h"
+#include "logdevice/common/commandline_util.h"
+#include "logdevice/common/commandline_util_chrono.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/settings/RebuildingSettings.h"
+#include "logdevice/common/settings/SettingsUpdater.h"
+#include "logdevice/common/types_internal.h"
+#include "logdevice/server/locallogstore/PartitionedRocksDBStore.h"
+#include "logdevice/server/locallogstore/RocksDBLogStoreConfig.h"
+#include "logdevice/server/locallogstore/RocksDBSettings.h"
+#include "logdevice/server/locallogstore/WriteOps.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file: drives a PartitionedRocksDBStore directly, without sequencers,
+ *        sockets or storage threads, to compare RocksDB and LogsDB settings
+ *        on a synthetic workload in minutes instead of standing up a cluster.
+ *
+ *        One thread writes records at --write-rate, --readers threads do
+ *        tailing and backlog reads, and one thread calls findTime() at
+ *        --findtime-rate. At the end, prints throughput, latency percentiles
+ *        of each operation, write amplification (bytes written to the
+ *        filesystem, from /proc/self/io, per byte of record written) and space
+ *        amplification (size of the store directory per byte of record
+ *        written; nothing is trimmed).
+ *
+ *        All RocksDBSettings (--rocksdb-*) are accepted, e.g.
+ *        --rocksdb-partition-duration=1min. To replay a production key
+ *        distribution, pass --log-weights-file with lines "<log id> <weight>",
+ *        e.g. the output of
+ *          SELECT log_id, SUM(value) FROM log_heavy_hitters
+ *          WHERE metric = 'appended_bytes' GROUP BY log_id
+ *        Writes and reads then go to each log with probability proportional
+ *        to its weight.
+ */
+
+namespace {
+
+struct Options {
+  std::string path;
+  std::chrono::seconds duration{60};
+  size_t logs = 1000;
+  std::string log_weights_file;
+  double write_rate = 10000;
+  size_t write_batch_size = 16;
+  size_t record_size = 1000;
+  std::string record_size_distribution = "constant";
+  size_t readers = 4;
+  double tailing_read_fraction = 0.8;
+  double backlog_read_fraction = 0.2;
+  size_t tailing_read_records = 10;
+  size_t backlog_read_records = 1000;
+  double findtime_rate = 10;
+  uint64_t seed = 0;
+};
+
+// Picks a log with probability proportional to its weight.
+class LogPicker {
+ public:
+  LogPicker(std::vector<logid_t> logs, const std::vector<double>& weights)
+      : logs_(std::move(logs)), dist_(weights.begin(), weights.end()) {}
+
+  size_t pickIndex(std::mt19937_64& rng) {
+    return dist_(rng);
+  }
+  logid_t log(size_t idx) const {
+    return logs_[idx];
+  }
+  size_t size() const {
+    return logs_.size();
+  }
+
+ private:
+  std::vector<logid_t> logs_;
+  std::discrete_distribution<size_t> dist_;
+};
+
+// Record sizes, following ldbench's convention for '*-distribution' options:
+// bucket i of the histogram is the probability that the size is in
+// [X * 2^i, X * 2^(i+1)), with X chosen so that the average is `avg`.
+class SizePicker {
+ public:
+  SizePicker(size_t avg, const std::string& histogram) : avg_(avg) {
+    if (histogram == "constant") {
+      return;
+    }
+    std::vector<double> weights;
+    folly::splitTo<double>(',', histogram, std::back_inserter(weights));
+    double mean = 0;
+    double total = 0;
+    for (size_t i = 0; i < weights.size(); ++i) {
+      mean += weights[i] * 1.5 * std::pow(2., i);
+      total += weights[i];
+    }
+    if (total <= 0) {
+      throw boost::program_options::error(
+          "invalid --record-size-distribution: " + histogram);
+    }
+    scale_ = avg / (mean / total);
+    buckets_ = std::discrete_distribution<int>(weights.begin(), weights.end());
+    constant_ = false;
+  }
+
+  size_t pick(std::mt19937_64& rng) {
+    if (constant_) {
+      return avg_;
+    }
+    int b = buckets_(rng);
+    std::uniform_real_distribution<double> in_bucket(
+        scale_ * std::pow(2., b), scale_ * std::pow(2., b + 1));
+    return std::max<size_t>(1, static_cast<size_t>(in_bucket(rng)));
+  }
+
+ private:
+  size_t avg_;
+  bool constant_ = true;
+  double scale_ = 1;
+  std::discrete_distribution<int> buckets_;
+};
+
+// Latencies of one kind of operation, in microseconds. One per thread,
+// merged at the end.
+struct Latencies {
+  std::vector<uint64_t> usec;
+
+  void add(std::chrono::steady_clock::time_point start) {
+    usec.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count());
+  }
+  void merge(const Latencies& other) {
+    usec.insert(usec.end(), other.usec.begin(), other.usec.end());
+  }
+  void print(const char* name) {
+    if (usec.empty()) {
+      std::cout << folly::format("{:<14} no samples\n", name);
+      return;
+    }
+    std::sort(usec.begin(), usec.end());
+    auto pct = [&](double p) {
+      return usec[std::min(usec.size() - 1, size_t(p * usec.size()))];
+    };
+    std::cout << folly::format(
+        "{:<14} n={:<10} p50={}us p90={}us p99={}us p99.9={}us max={}us\n",
+        name,
+        usec.size(),
+        pct(.5),
+        pct(.9),
+        pct(.99),
+        pct(.999),
+        usec.back());
+  }
+};
+
+// Bytes written to the filesystem by this process so far, or 0 if
+// /proc/self/io is not readable.
+uint64_t processWriteBytes() {
+  std::ifstream in("/proc/self/io");
+  std::string key;
+  uint64_t value;
+  while (in >> key >> value) {
+    if (key == "write_bytes:") {
+      return value;
+    }
+  }
+  return 0;
+}
+
+uint64_t directorySize(const std::string& path) {
+  uint64_t size = 0;
+  boost::system::error_code ec;
+  for (boost::filesystem::recursive_directory_iterator it(path, ec), end;
+       it != end;
+       it.increment(ec)) {
+    if (boost::filesystem::is_regular_file(it->path(), ec)) {
+      size += boost::filesystem::file_size(it->path(), ec);
+    }
+  }
+  return size;
+}
+
+LogPicker makeLogPicker(const Options& opts) {
+  std::vector<logid_t> logs;
+  std::vector<double> weights;
+  if (opts.log_weights_file.empty()) {
+    for (size_t i = 1; i <= opts.logs; ++i) {
+      logs.push_back(logid_t(i));
+      weights.push_back(1);
+    }
+  } else {
+    std::ifstream in(opts.log_weights_file);
+    uint64_t log;
+    double weight;
+    while (in >> log >> weight) {
+      if (log != 0 && weight > 0) {
+        logs.push_back(logid_t(log));
+        weights.push_back(weight);
+      }
+    }
+    if (logs.empty()) {
+      throw boost::program_options::error(
+          "no logs with positive weight in " + opts.log_weights_file);
+    }
+  }
+  return LogPicker(std::move(logs), weights);
+}
+
+class Benchmark {
+ public:
+  Benchmark(const Options& opts, LocalLogStore* store)
+      : opts_(opts),
+        store_(store),
+        logs_(makeLogPicker(opts)),
+        sizes_(opts.record_size, opts.record_size_distribution),
+        last_esn_(logs_.size()) {
+    for (auto& esn : last_esn_) {
+      esn.store(0);
+    }
+  }
+
+  void run() {
+    const uint64_t write_bytes_before = processWriteBytes();
+    start_ = std::chrono::steady_clock::now();
+    const auto deadline = start_ + opts_.duration;
+
+    std::vector<Latencies> read_latencies(opts_.readers * 2);
+    Latencies write_latency;
+    Latencies findtime_latency;
+
+    std::vector<std::thread> threads;
+    threads.emplace_back([&] { writeLoop(deadline, write_latency); });
+    for (size_t i = 0; i < opts_.readers; ++i) {
+      threads.emplace_back([&, i] {
+        readLoop(
+            deadline, i, read_latencies[i * 2], read_latencies[i * 2 + 1]);
+      });
+    }
+    if (opts_.findtime_rate > 0) {
+      threads.emplace_back([&] { findTimeLoop(deadline, findtime_latency); });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+
+    store_->sync(Durability::ASYNC_WRITE);
+    const double sec = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start_)
+                           .count();
+    const uint64_t fs_bytes = processWriteBytes() - write_bytes_before;
+    const uint64_t dir_bytes = directorySize(opts_.path);
+
+    Latencies tailing_latency;
+    Latencies backlog_latency;
+    for (size_t i = 0; i < opts_.readers; ++i) {
+      tailing_latency.merge(read_latencies[i * 2]);
+      backlog_latency.merge(read_latencies[i * 2 + 1]);
+    }
+
+    std::cout << folly::format(
+        "records written: {} ({:.0f}/s), bytes written: {} ({:.2f} MB/s)\n",
+        records_written_.load(),
+        records_written_.load() / sec,
+        bytes_written_.load(),
+        bytes_written_.load() / sec / 1e6);
+    std::cout << folly::format("records read: {} ({:.0f}/s), bytes read: {}\n",
+                               records_read_.load(),
+                               records_read_.load() / sec,
+                               bytes_read_.load());
+    write_latency.print("write batch");
+    tailing_latency.print("tailing read");
+    backlog_latency.print("backlog read");
+    findtime_latency.print("findTime");
+    if (bytes_written_.load() > 0) {
+      std::cout << folly::format(
+          "write amplification: {:.2f} ({} bytes written to filesystem)\n",
+          double(fs_bytes) / bytes_written_.load(),
+          fs_bytes);
+      std::cout << folly::format(
+          "space amplification: {:.2f} ({} bytes in {})\n",
+          double(dir_bytes) / bytes_written_.load(),
+          dir_bytes,
+          opts_.path);
+    }
+  }
+
+ private:
+  void writeLoop(std::chrono::steady_clock::time_point deadline,
+                 Latencies& latency) {
+    std::mt19937_64 rng(opts_.seed);
+    const ShardID copyset[] = {ShardID(1, 0), ShardID(2, 0), ShardID(3, 0)};
+    const auto flags = LocalLogStoreRecordFormat::FLAG_SHARD_ID |
+        LocalLogStoreRecordFormat::FLAG_CHECKSUM_PARITY;
+    std::string csi_entry_buf;
+    Slice csi_entry = LocalLogStoreRecordFormat::formCopySetIndexEntry(
+        1,
+        copyset,
+        3,
+        LSN_INVALID,
+        LocalLogStoreRecordFormat::formCopySetIndexFlags(flags),
+        &csi_entry_buf);
+    const std::string payload_buf(opts_.record_size * 64, 'x');
+
+    std::vector<std::string> headers(opts_.write_batch_size);
+    std::vector<PutWriteOp> ops(opts_.write_batch_size);
+    std::vector<const WriteOp*> op_ptrs;
+    // Log index and ESN of each record of the batch.
+    std::vector<std::pair<size_t, esn_t::raw_type>> batch;
+    // Only accessed by this thread, unlike last_esn_.
+    std::vector<esn_t::raw_type> next_esn(logs_.size(), 1);
+    uint64_t batches = 0;
+
+    while (std::chrono::steady_clock::now() < deadline) {
+      op_ptrs.clear();
+      batch.clear();
+      size_t batch_bytes = 0;
+      const int64_t now_ms =
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::system_clock::now().time_since_epoch())
+              .count();
+      for (size_t i = 0; i < opts_.write_batch_size; ++i) {
+        const size_t idx = logs_.pickIndex(rng);
+        const esn_t::raw_type esn = next_esn[idx]++;
+        batch.emplace_back(idx, esn);
+        const size_t size = std::min(sizes_.pick(rng), payload_buf.size());
+        Slice header = LocalLogStoreRecordFormat::formRecordHeader(
+            now_ms,
+            esn_t(0),
+            flags,
+            1,
+            folly::Range<const ShardID*>(copyset, copyset + 3),
+            0,
+            {},
+            &headers[i]);
+        ops[i] = PutWriteOp(logs_.log(idx),
+                            compose_lsn(epoch_t(1), esn_t(esn)),
+                            header,
+                            Slice(payload_buf.data(), size),
+                            node_index_t(1),
+                            LSN_INVALID,
+                            csi_entry,
+                            {},
+                            Durability::ASYNC_WRITE,
+                            false);
+        op_ptrs.push_back(&ops[i]);
+        batch_bytes += header.size + size;
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      int rv = store_->writeMulti(op_ptrs);
+      latency.add(start);
+      if (rv != 0) {
+        ld_error("writeMulti() failed: %s", error_description(err));
+        break;
+      }
+      // Let readers see the new records.
+      for (const auto& rec : batch) {
+        if (rec.second > last_esn_[rec.first].load()) {
+          last_esn_[rec.first].store(rec.second);
+        }
+      }
+      records_written_ += op_ptrs.size();
+      bytes_written_ += batch_bytes;
+      ++batches;
+
+      if (opts_.write_rate > 0) {
+        // Sleep until the time this many records should have been written.
+        std::this_thread::sleep_until(
+            start_ +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(batches *
+                                              opts_.write_batch_size /
+                                              opts_.write_rate)));
+      }
+    }
+  }
+
+  void readLoop(std::chrono::steady_clock::time_point deadline,
+                size_t thread_idx,
+                Latencies& tailing_latency,
+                Latencies& backlog_latency) {
+    std::mt19937_64 rng(opts_.seed + 1 + thread_idx);
+    const double total =
+        opts_.tailing_read_fraction + opts_.backlog_read_fraction;
+    if (total <= 0) {
+      return;
+    }
+    std::bernoulli_distribution tailing(opts_.tailing_read_fraction / total);
+
+    while (std::chrono::steady_clock::now() < deadline) {
+      const size_t idx = logs_.pickIndex(rng);
+      const esn_t::raw_type last = last_esn_[idx].load();
+      if (last == 0) {
+        std::this_thread::yield();
+        continue;
+      }
+      const bool is_tailing = tailing(rng);
+      const size_t records = is_tailing ? opts_.tailing_read_records
+                                        : opts_.backlog_read_records;
+      esn_t::raw_type from;
+      if (is_tailing) {
+        from = last > records ? last - records + 1 : 1;
+      } else {
+        from = std::uniform_int_distribution<esn_t::raw_type>(1, last)(rng);
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      LocalLogStore::ReadOptions read_opts(
+          is_tailing ? "Benchmark:tailing" : "Benchmark:backlog");
+      read_opts.tailing = is_tailing;
+      read_opts.fill_cache = is_tailing;
+      auto it = store_->read(logs_.log(idx), read_opts);
+      it->seek(compose_lsn(epoch_t(1), esn_t(from)));
+      size_t n = 0;
+      for (; n < records && it->state() == IteratorState::AT_RECORD; ++n) {
+        bytes_read_ += it->getRecord().size;
+        it->next();
+      }
+      (is_tailing ? tailing_latency : backlog_latency).add(start);
+      records_read_ += n;
+    }
+  }
+
+  void findTimeLoop(std::chrono::steady_clock::time_point deadline,
+                    Latencies& latency) {
+    std::mt19937_64 rng(opts_.seed + 1000000);
+    const auto start_time = std::chrono::system_clock::now();
+    const auto interval =
+        std::chrono::duration<double>(1. / opts_.findtime_rate);
+    auto next = std::chrono::steady_clock::now();
+
+    while (std::chrono::steady_clock::now() < deadline) {
+      next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          interval);
+      std::this_thread::sleep_until(next);
+
+      const auto now = std::chrono::system_clock::now();
+      const auto range = std::chrono::duration_cast<std::chrono::milliseconds>(
+          now - start_time);
+      const auto target =
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              start_time.time_since_epoch()) +
+          std::chrono::milliseconds(
+              std::uniform_int_distribution<int64_t>(0, range.count())(rng));
+
+      lsn_t lo;
+      lsn_t hi;
+      auto start = std::chrono::steady_clock::now();
+      store_->findTime(logs_.log(logs_.pickIndex(rng)), target, &lo, &hi);
+      latency.add(start);
+    }
+  }
+
+  const Options& opts_;
+  LocalLogStore* store_;
+  LogPicker logs_;
+  SizePicker sizes_;
+  std::chrono::steady_clock::time_point start_;
+
+  // Last ESN written to each log, in epoch 1. Indexed like logs_.
+  std::vector<std::atomic<esn_t::raw_type>> last_esn_;
+
+  std::atomic<uint64_t> records_written_{0};
+  std::atomic<uint64_t> bytes_written_{0};
+  std::atomic<uint64_t> records_read_{0};
+  std::atomic<uint64_t> bytes_read_{0};
+};
+
+} // namespace
+
+int main(int argc, const char* argv[]) {
+  Options opts;
+  UpdateableSettings<RocksDBSettings> rocksdb_settings;
+  UpdateableSettings<RebuildingSettings> rebuilding_settings;
+  auto settings_updater = std::make_shared<SettingsUpdater>();
+  settings_updater->registerSettings(rocksdb_settings);
+  settings_updater->registerSettings(rebuilding_settings);
+
+  auto fallback_parser = [&](int argc2, const char** argv2) {
+    namespace po = boost::program_options;
+    po::options_description desc;
+    // clang-format off
+    desc.add_options()
+      ("help,h", "produce this help message and exit")
+      ("path", po::value<std::string>(&opts.path),
+       "directory for the store; a temporary directory by default")
+      ("duration", chrono_value(&opts.duration), "how long to run")
+      ("logs", po::value<size_t>(&opts.logs)->default_value(opts.logs),
+       "number of logs, written and read uniformly")
+      ("log-weights-file", po::value<std::string>(&opts.log_weights_file),
+       "file with lines \"<log id> <weight>\"; overrides --logs")
+      ("write-rate",
+       po::value<double>(&opts.write_rate)->default_value(opts.write_rate),
+       "records per second; 0 to write as fast as possible")
+      ("write-batch-size",
+       po::value<size_t>(&opts.write_batch_size)
+         ->default_value(opts.write_batch_size),
+       "records per writeMulti() call")
+      ("record-size",
+       po::value<size_t>(&opts.record_size)->default_value(opts.record_size),
+       "average payload size in bytes")
+      ("record-size-distribution",
+       po::value<std::string>(&opts.record_size_distribution)
+         ->default_value(opts.record_size_distribution),
+       "\"constant\" or a logarithmic histogram, like ldbench's "
+       "*-distribution options")
+      ("readers",
+       po::value<size_t>(&opts.readers)->default_value(opts.readers),
+       "number of reader threads")
+      ("tailing-read-fraction",
+       po::value<double>(&opts.tailing_read_fraction)
+         ->default_value(opts.tailing_read_fraction),
+       "fraction of reads that read the last --tailing-read-records records")
+      ("backlog-read-fraction",
+       po::value<double>(&opts.backlog_read_fraction)
+         ->default_value(opts.backlog_read_fraction),
+       "fraction of reads that read --backlog-read-records records from a "
+       "random position, without filling the block cache")
+      ("tailing-read-records",
+       po::value<size_t>(&opts.tailing_read_records)
+         ->default_value(opts.tailing_read_records),
+       "records per tailing read")
+      ("backlog-read-records",
+       po::value<size_t>(&opts.backlog_read_records)
+         ->default_value(opts.backlog_read_records),
+       "records per backlog read")
+      ("findtime-rate",
+       po::value<double>(&opts.findtime_rate)
+         ->default_value(opts.findtime_rate),
+       "findTime() calls per second, on random logs and timestamps")
+      ("seed", po::value<uint64_t>(&opts.seed)->default_value(opts.seed),
+       "random seed");
+    // clang-format on
+
+    auto parsed = program_options_parse_no_positional(argc2, argv2, desc);
+    if (parsed.count("help")) {
+      std::cout << "Benchmarks a LogsDB store on a synthetic workload. All "
+                   "--rocksdb-* settings are accepted too.\n\n"
+                << desc << std::endl;
+      exit(0);
+    }
+  };
+
+  try {
+    settings_updater->parseFromCLI(
+        argc, argv, &SettingsUpdater::mustBeServerOption, fallback_parser);
+  } catch (const boost::program_options::error& ex) {
+    std::cerr << argv[0] << ": " << ex.what() << '\n';
+    return 1;
+  }
+
+  std::unique_ptr<folly::test::TemporaryDirectory> temp_dir;
+  if (opts.path.empty()) {
+    temp_dir = std::make_unique<folly::test::TemporaryDirectory>(
+        "LocalLogStoreBenchmark");
+    opts.path = temp_dir->path().string();
+  }
+
+  const shard_index_t shard_idx = 0;
+  RocksDBLogStoreConfig rocksdb_config(
+      rocksdb_settings, rebuilding_settings, nullptr, nullptr, nullptr);
+  rocksdb_config.createMergeOperator(shard_idx);
+  PartitionedRocksDBStore store(
+      shard_idx, opts.path, std::move(rocksdb_config));
+
+  try {
+    Benchmark(opts, &store).run();
+  } catch (const boost::program_options::error& ex) {
+    std::cerr << argv[0] << ": " << ex.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -14,6 +14,7 @@
 #include <gflags/gflags.h>
 
 #include "logdevice/common/MetaDataLog.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
 #include "logdevice/include/types.h"
 #include "logdevice/server/read_path/LogStorageStateMap.h"
 
@@ -95,6 +96,6 @@ int main(int argc, char* argv[]) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
   gflags::SetCommandLineOptionWithMode(
       "bm_min_iters", "100000000", gflags::SET_FLAG_IF_DEFAULT);
-  folly::runBenchmarks();
+  runBenchmarksWithReport();
   return 0;
 }
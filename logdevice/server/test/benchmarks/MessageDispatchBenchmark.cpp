@@ -0,0 +1,50 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <folly/Benchmark.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/protocol/TEST_Message.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
+#include "logdevice/server/ServerMessageDispatch.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file: per-message cost of dispatching a received message to its handler
+ *        through ServerMessageDispatch's handler table, compared to calling
+ *        Message::onReceived() directly as the base MessageDispatch does.
+ *        TEST_Message's handler does nothing, so this measures dispatch
+ *        alone. MessageDispatch::onReceived() also runs the MessageTracer,
+ *        which needs a Worker, so onReceivedImpl() is called directly.
+ */
+
+template <typename Dispatch>
+static void dispatchMessages(size_t iters) {
+  Dispatch dispatch;
+  TEST_Message msg(TEST_Message_Header{1});
+  const Address from(ClientID::MIN);
+  for (size_t it = 0; it < iters; ++it) {
+    folly::doNotOptimizeAway(dispatch.onReceivedImpl(&msg, from));
+  }
+}
+
+BENCHMARK(MessageDispatch, iters) {
+  dispatchMessages<MessageDispatch>(iters);
+}
+
+BENCHMARK_RELATIVE(ServerMessageDispatch, iters) {
+  dispatchMessages<ServerMessageDispatch>(iters);
+}
+
+BENCHMARK_DRAW_LINE();
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  runBenchmarksWithReport();
+  return 0;
+}
@@ -0,0 +1,299 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Random.h>
+#include <gflags/gflags.h>
+
+#include "event2/buffer.h"
+#include "logdevice/common/LocalLogStoreRecordFormat.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/libevent/compat.h"
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/protocol/RECORD_Message.h"
+#include "logdevice/common/settings/Settings.h"
+#include "logdevice/common/settings/util.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
+#include "logdevice/common/types_internal.h"
+#include "logdevice/server/locallogstore/WriteOps.h"
+#include "logdevice/server/locallogstore/test/TemporaryLogStore.h"
+#include "logdevice/server/read_path/LocalLogStoreReader.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file: benchmarks of the storage node read path, to measure read path
+ *        optimizations against:
+ *         - LocalLogStoreReader::read() of batches of records from a
+ *           temporary RocksDB store, without filter, with a single copy
+ *           delivery filter and with a rebuilding filter, for different
+ *           record sizes;
+ *         - the work CatchupOneStream does for each batch after reading it:
+ *           parsing the records, building a RECORD_Message for each and
+ *           serializing them into an evbuffer, as the socket would.
+ *           CatchupOneStream itself needs a Worker, a ServerReadStream and
+ *           CatchupQueueDependencies, so the benchmark does the same steps
+ *           as ReadingCallback::processRecord() and shipRecord() for a
+ *           plain stream (no compression, no extra metadata).
+ *
+ *       Run with --bm_min_usec=1000000.
+ */
+
+namespace {
+
+const logid_t LOG_ID(1);
+const size_t N_RECORDS = 10000;
+const size_t NODES = 6;
+const size_t REPLICATION = 3;
+
+// Records per LocalLogStoreReader::read() call.
+const size_t BATCH_RECORDS = 128;
+
+lsn_t lsn(size_t i) {
+  return compose_lsn(epoch_t(1), esn_t(i + 1));
+}
+
+// A store with N_RECORDS records of the given payload size in LOG_ID, with
+// random copysets of REPLICATION of NODES nodes. Cached across benchmark
+// runs, since filling it takes longer than the benchmarks.
+TemporaryRocksDBStore* getStore(size_t record_size) {
+  static std::map<size_t, std::unique_ptr<TemporaryRocksDBStore>> stores;
+  auto& store = stores[record_size];
+  if (store) {
+    return store.get();
+  }
+  store = std::make_unique<TemporaryRocksDBStore>();
+
+  const auto flags = LocalLogStoreRecordFormat::FLAG_SHARD_ID |
+      LocalLogStoreRecordFormat::FLAG_CHECKSUM_PARITY;
+  std::vector<std::string> headers(N_RECORDS);
+  std::vector<std::string> csi_entries(N_RECORDS);
+  const std::string payload(record_size, 'x');
+  std::vector<PutWriteOp> put_ops;
+  put_ops.reserve(N_RECORDS);
+  for (size_t i = 0; i < N_RECORDS; ++i) {
+    std::vector<ShardID> copyset;
+    while (copyset.size() < REPLICATION) {
+      ShardID shard(folly::Random::rand32(NODES), 0);
+      if (std::find(copyset.begin(), copyset.end(), shard) == copyset.end()) {
+        copyset.push_back(shard);
+      }
+    }
+    Slice header = LocalLogStoreRecordFormat::formRecordHeader(
+        1500000000000 + i,
+        esn_t(0),
+        flags,
+        1,
+        folly::Range<const ShardID*>(copyset.data(), copyset.size()),
+        0,
+        {},
+        &headers[i]);
+    Slice csi = LocalLogStoreRecordFormat::formCopySetIndexEntry(
+        1,
+        copyset.data(),
+        copyset.size(),
+        LSN_INVALID,
+        LocalLogStoreRecordFormat::formCopySetIndexFlags(flags),
+        &csi_entries[i]);
+    put_ops.emplace_back(LOG_ID,
+                         lsn(i),
+                         header,
+                         Slice(payload.data(), payload.size()),
+                         node_index_t(0),
+                         LSN_INVALID,
+                         csi,
+                         std::vector<std::pair<char, std::string>>(),
+                         Durability::ASYNC_WRITE,
+                         false);
+  }
+  std::vector<const WriteOp*> ops;
+  for (auto& op : put_ops) {
+    ops.push_back(&op);
+  }
+  int rv = store->writeMulti(ops);
+  ld_check(rv == 0);
+  return store.get();
+}
+
+class CountingCallback : public LocalLogStoreReader::Callback {
+ public:
+  int processRecord(const RawRecord& record) override {
+    bytes_ += record.blob.size;
+    return 0;
+  }
+  size_t bytes_ = 0;
+};
+
+enum class Filter { NONE, SCD, REBUILDING };
+
+void readBatches(size_t iters, size_t record_size, Filter filter_type) {
+  TemporaryRocksDBStore* store;
+  std::unique_ptr<LocalLogStore::ReadIterator> it;
+  std::shared_ptr<LocalLogStoreReadFilter> filter;
+  const Settings settings = create_default_settings<Settings>();
+  BENCHMARK_SUSPEND {
+    store = getStore(record_size);
+    LocalLogStore::ReadOptions read_options("ReadPathBenchmark");
+    read_options.allow_copyset_index = filter_type != Filter::NONE;
+    it = store->read(LOG_ID, read_options);
+    filter = std::make_shared<LocalLogStoreReadFilter>();
+    switch (filter_type) {
+      case Filter::NONE:
+        break;
+      case Filter::SCD:
+        // Ship only the records this node is the first copy of.
+        filter->scd_my_shard_id_ = ShardID(0, 0);
+        filter->scd_replication_ = REPLICATION;
+        break;
+      case Filter::REBUILDING:
+        filter->required_in_copyset_.push_back(ShardID(1, 0));
+        break;
+    }
+  }
+
+  CountingCallback cb;
+  size_t next = 0;
+  for (size_t i = 0; i < iters; ++i) {
+    LocalLogStoreReader::ReadContext ctx(
+        LOG_ID,
+        LocalLogStoreReader::ReadPointer{lsn(next)},
+        LSN_MAX,
+        lsn(next + BATCH_RECORDS - 1),
+        std::chrono::milliseconds::max(),
+        LSN_MAX,
+        std::numeric_limits<size_t>::max(),
+        false,
+        filter_type == Filter::REBUILDING,
+        filter,
+        CatchupEventTrigger::OTHER);
+    folly::doNotOptimizeAway(
+        LocalLogStoreReader::read(*it, cb, &ctx, nullptr, settings));
+    next += BATCH_RECORDS;
+    if (next + BATCH_RECORDS > N_RECORDS) {
+      next = 0;
+    }
+  }
+  folly::doNotOptimizeAway(cb.bytes_);
+}
+
+void noFilter(size_t iters, size_t record_size) {
+  readBatches(iters, record_size, Filter::NONE);
+}
+void scdFilter(size_t iters, size_t record_size) {
+  readBatches(iters, record_size, Filter::SCD);
+}
+void rebuildingFilter(size_t iters, size_t record_size) {
+  readBatches(iters, record_size, Filter::REBUILDING);
+}
+
+#define READ_BENCH(record_size)                                    \
+  BENCHMARK_NAMED_PARAM(noFilter, size_##record_size, record_size) \
+  BENCHMARK_RELATIVE_NAMED_PARAM(                                  \
+      scdFilter, size_##record_size, record_size)                  \
+  BENCHMARK_RELATIVE_NAMED_PARAM(                                  \
+      rebuildingFilter, size_##record_size, record_size)           \
+  BENCHMARK_DRAW_LINE();
+
+READ_BENCH(100)
+READ_BENCH(1000)
+READ_BENCH(16000)
+
+// Parses `n` records read from the store, builds a RECORD_Message for each
+// and serializes them.
+void recordBatch(size_t iters, size_t record_size, size_t n) {
+  std::vector<std::string> blobs;
+  struct evbuffer* evbuf;
+  BENCHMARK_SUSPEND {
+    TemporaryRocksDBStore* store = getStore(record_size);
+    auto it = store->read(LOG_ID, LocalLogStore::ReadOptions("ReadPathBench"));
+    it->seek(lsn(0));
+    for (size_t i = 0; i < n && it->state() == IteratorState::AT_RECORD; ++i) {
+      Slice blob = it->getRecord();
+      blobs.emplace_back(static_cast<const char*>(blob.data), blob.size);
+      it->next();
+    }
+    evbuf = LD_EV(evbuffer_new)();
+  }
+
+  for (size_t iter = 0; iter < iters; ++iter) {
+    std::vector<std::unique_ptr<RECORD_Message>> batch;
+    batch.reserve(blobs.size());
+    for (size_t i = 0; i < blobs.size(); ++i) {
+      std::chrono::milliseconds timestamp;
+      esn_t last_known_good;
+      LocalLogStoreRecordFormat::flags_t flags;
+      uint32_t wave;
+      copyset_size_t copyset_size;
+      uint64_t offset_within_epoch;
+      Payload payload;
+      int rv = LocalLogStoreRecordFormat::parse(
+          Slice(blobs[i].data(), blobs[i].size()),
+          &timestamp,
+          &last_known_good,
+          &flags,
+          &wave,
+          &copyset_size,
+          nullptr,
+          0,
+          &offset_within_epoch,
+          nullptr,
+          &payload,
+          0);
+      ld_check(rv == 0);
+      RECORD_Header header = {LOG_ID,
+                              read_stream_id_t(1),
+                              lsn(i),
+                              static_cast<uint64_t>(timestamp.count()),
+                              flags & LocalLogStoreRecordFormat::FLAG_MASK,
+                              0};
+      batch.push_back(std::make_unique<RECORD_Message>(
+          header, TrafficClass::READ_BACKLOG, payload.dup(), nullptr));
+    }
+    for (auto& msg : batch) {
+      ProtocolWriter writer(
+          msg->type_, evbuf, Compatibility::MAX_PROTOCOL_SUPPORTED);
+      msg->serialize(writer);
+    }
+    LD_EV(evbuffer_drain)(evbuf, LD_EV(evbuffer_get_length)(evbuf));
+  }
+
+  BENCHMARK_SUSPEND {
+    LD_EV(evbuffer_free)(evbuf);
+  }
+}
+
+#define BATCH_BENCH(record_size)                                      \
+  BENCHMARK_NAMED_PARAM(                                              \
+      recordBatch, size_##record_size##_n_16, record_size, 16)        \
+  BENCHMARK_NAMED_PARAM(                                              \
+      recordBatch, size_##record_size##_n_128, record_size, 128)      \
+  BENCHMARK_NAMED_PARAM(                                              \
+      recordBatch, size_##record_size##_n_1024, record_size, 1024)    \
+  BENCHMARK_DRAW_LINE();
+
+BATCH_BENCH(100)
+BATCH_BENCH(1000)
+BATCH_BENCH(16000)
+
+} // namespace
+
+#ifndef BENCHMARK_BUNDLE
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  runBenchmarksWithReport();
+  return 0;
+}
+
+#endif
@@ -18,6 +18,7 @@
 #include "logdevice/common/protocol/TEST_Message.h"
 #include "logdevice/common/request_util.h"
 #include "logdevice/common/test/TestUtil.h"
+#include "logdevice/common/test/benchmarks/BenchmarkReport.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/lib/ClientImpl.h"
 #include "logdevice/test/utils/IntegrationTestUtils.h"
@@ -139,6 +140,6 @@ BENCHMARK(SocketBenchmark, n) {
 int main(int argc, char** argv) {
   folly::SingletonVault::singleton()->registrationComplete();
   gflags::ParseCommandLineFlags(&argc, &argv, true);
-  folly::runBenchmarks();
+  facebook::logdevice::runBenchmarksWithReport();
   return 0;
 }
@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <gtest/gtest.h>
+
+#include "logdevice/common/configuration/Configuration.h"
+#include "logdevice/test/utils/ClusterBenchmark.h"
+#include "logdevice/test/utils/IntegrationTestUtils.h"
+
+/**
+ * @file Failure scenarios benchmarked under a foreground load. They take
+ *       minutes and are disabled by default; run them with
+ *
+ *         LOGDEVICE_BENCHMARK_RESULTS_DIR=/tmp/results \
+ *           integration_test --gtest_filter='ClusterBenchmarkTest.*' \
+ *           --gtest_also_run_disabled_tests
+ *
+ *       to get one JSON file of results per scenario in /tmp/results.
+ */
+
+using namespace facebook::logdevice;
+using IntegrationTestUtils::ClusterFactory;
+
+namespace {
+
+const int NUM_LOGS = 100;
+
+std::vector<logid_t> allLogs() {
+  std::vector<logid_t> logs;
+  for (int i = 1; i <= NUM_LOGS; ++i) {
+    logs.push_back(logid_t(i));
+  }
+  return logs;
+}
+
+ClusterFactory benchmarkCluster() {
+  Configuration::Log log_config;
+  log_config.replicationFactor = 2;
+  log_config.rangeName = "benchmark";
+  log_config.extraCopies = 0;
+  log_config.syncedCopies = 0;
+  log_config.maxWritesInFlight = 1000;
+
+  ClusterFactory factory;
+  factory.setLogConfig(log_config)
+      .setNumLogs(NUM_LOGS)
+      .useHashBasedSequencerAssignment()
+      .doPreProvisionEpochMetaData()
+      .doNotLetSequencersProvisionEpochMetaData()
+      .setRocksDBType(IntegrationTestUtils::RocksDBType::PARTITIONED)
+      .setParam("--disable-rebuilding", "false")
+      .setParam("--disabled-retry-interval", "0s")
+      .setParam("--seq-state-backoff-time", "10ms..1s")
+      .setParam("--rocksdb-partition-data-age-flush-trigger", "1s")
+      .setParam("--rocksdb-partition-idle-flush-trigger", "100ms")
+      .setParam("--rocksdb-min-manual-flush-interval", "200ms")
+      .setParam("--iterator-cache-ttl", "1s")
+      .setNumDBShards(2);
+  return factory;
+}
+
+} // namespace
+
+TEST(ClusterBenchmarkTest, DISABLED_SequencerFailover) {
+  auto cluster = benchmarkCluster().create(5);
+  cluster->waitForRecovery();
+
+  IntegrationTestUtils::SequencerFailoverOptions options;
+  auto results =
+      IntegrationTestUtils::runSequencerFailover(*cluster, allLogs(), options);
+  IntegrationTestUtils::writeBenchmarkResults("sequencer_failover", results);
+  EXPECT_EQ(0, results.getDefault("logs_not_writable", 1).asInt());
+}
+
+TEST(ClusterBenchmarkTest, DISABLED_StorageNodeRebuild) {
+  auto cluster = benchmarkCluster().create(5);
+  cluster->waitForRecovery();
+
+  IntegrationTestUtils::StorageNodeRebuildOptions options;
+  // The node may also run sequencers; their failover is part of the impact
+  // on the foreground load.
+  auto results = IntegrationTestUtils::runStorageNodeRebuild(
+      *cluster, node_index_t(4), allLogs(), options);
+  IntegrationTestUtils::writeBenchmarkResults("storage_node_rebuild", results);
+  EXPECT_GT(results["records_rebuilt"].asInt(), 0);
+}
@@ -8,12 +8,14 @@
 #include <chrono>
 #include <memory>
 
+#include <folly/FileUtil.h>
 #include <gtest/gtest.h>
 
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/configuration/UpdateableConfig.h"
 #include "logdevice/common/settings/Settings.h"
+#include "logdevice/common/test/TestUtil.h"
 #include "logdevice/lib/ClientBuiltinPluginProvider.h"
 #include "logdevice/lib/ClientImpl.h"
 #include "logdevice/lib/ClientPluginPack.h"
@@ -220,3 +222,51 @@ TEST_F(ServerConfigSourceIntegrationTest, StaleServerConfigFetchFromSource) {
   EXPECT_LT(
       0, cluster->getNode(0).stats()["config_changed_ignored_not_trusted"]);
 }
+
+/**
+ * Create a client with --server-config-cache-path, check that it saves the
+ * fetched config. Then kill all nodes and check that a new client with the
+ * same config path starts from the saved config.
+ */
+TEST_F(ServerConfigSourceIntegrationTest, CachedConfig) {
+  auto cluster = IntegrationTestUtils::ClusterFactory().create(3);
+  auto server_config = cluster->getConfig()->getServerConfig();
+
+  std::string config_path = "server:";
+  for (const auto& it : server_config->getNodes()) {
+    if (config_path.back() != ':') {
+      config_path += ',';
+    }
+    config_path += it.second.address.toString();
+  }
+
+  auto temp_dir = createTemporaryDir("ServerConfigSourceIntegrationTest");
+  const std::string cache_path = temp_dir->path().string() + "/config_cache";
+  auto create_client = [&] {
+    std::unique_ptr<ClientSettings> client_settings(ClientSettings::create());
+    EXPECT_EQ(0, client_settings->set("on-demand-logs-config", true));
+    EXPECT_EQ(0, client_settings->set("server-config-cache-path", cache_path));
+    return Client::create(server_config->getClusterName(),
+                          config_path,
+                          "",
+                          std::chrono::seconds(1),
+                          std::move(client_settings));
+  };
+
+  auto client = create_client();
+  ASSERT_TRUE((bool)client);
+  std::string cache_contents;
+  ASSERT_TRUE(folly::readFile(cache_path.c_str(), cache_contents));
+  client.reset();
+
+  for (const auto& it : server_config->getNodes()) {
+    cluster->getNode(it.first).kill();
+  }
+
+  client = create_client();
+  ASSERT_TRUE((bool)client);
+  auto client_config =
+      checked_downcast<ClientImpl*>(client.get())->getProcessor().config_;
+  EXPECT_EQ(client_config->getServerConfig()->toString(),
+            server_config->toString());
+}
@@ -7,7 +7,10 @@
  */
 #include "logdevice/common/ZookeeperEpochStore.h"
 
+#include <algorithm>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -700,6 +703,45 @@ TEST_F(ZookeeperEpochStoreTest, QuorumChangeTest) {
   ASSERT_NE(E::SHUTDOWN, zk_req_st);
 }
 
+// Concurrent epoch increments of the same log race with each other. Their
+// writes may be sent in the same multi-op, along with the write for another
+// log; writes rolled back because of the conflict are then retried on their
+// own. Either way, exactly one increment of log 1 loses the race.
+TEST_F(ZookeeperEpochStoreTest, ConcurrentNextEpoch) {
+  Semaphore sem;
+  std::mutex mutex;
+  std::map<logid_t, std::vector<Status>> statuses;
+  auto cf = [&](Status st,
+                logid_t logid,
+                std::unique_ptr<EpochMetaData> /*info*/,
+                std::unique_ptr<EpochStoreMetaProperties> /*meta_props*/) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      statuses[logid].push_back(st);
+    }
+    sem.post();
+  };
+
+  for (logid_t logid : {logid_t(1), logid_t(1), logid_t(2)}) {
+    int rv = epochstore->createOrUpdateMetaData(
+        logid,
+        std::make_shared<EpochMetaDataUpdateToNextEpoch>(),
+        cf,
+        MetaDataTracer());
+    ASSERT_EQ(0, rv);
+  }
+  for (int i = 0; i < 3; ++i) {
+    sem.wait();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& log1 = statuses[logid_t(1)];
+  ASSERT_EQ(2, log1.size());
+  EXPECT_EQ(1, std::count(log1.begin(), log1.end(), E::OK));
+  EXPECT_EQ(1, std::count(log1.begin(), log1.end(), E::AGAIN));
+  EXPECT_EQ(std::vector<Status>{E::OK}, statuses[logid_t(2)]);
+}
+
 /*
  * This is a test request that verifies that the NodeID read from
  * ZookeeperEpochStore is the one of the last writer.
@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/test/ldbench/BenchStats.h"
+
+#include <algorithm>
+
+#include <folly/Format.h>
+
+namespace facebook { namespace logdevice { namespace ldbench {
+
+void OpStats::Snapshot::merge(const Snapshot& other) {
+  ok += other.ok;
+  failed += other.failed;
+  bytes += other.bytes;
+  latency.merge(other.latency);
+  for (const auto& kv : other.errors) {
+    errors[kv.first] += kv.second;
+  }
+}
+
+std::string
+OpStats::Snapshot::describe(std::chrono::duration<double> interval) const {
+  const double sec = std::max(interval.count(), 1e-9);
+  std::string res = folly::sformat("{:>9.0f}/s {:>8.2f}MB/s fail {:>6}",
+                                   ok / sec,
+                                   bytes / sec / 1e6,
+                                   failed);
+  if (latency.getCountAndSum().first > 0) {
+    const double pcts[] = {0.5, 0.99, 0.999, 1.0};
+    int64_t usec[4];
+    latency.estimatePercentiles(pcts, 4, usec);
+    res += folly::sformat(" p50 {:>8.3f}ms p99 {:>8.3f}ms p99.9 {:>8.3f}ms "
+                          "max {:>8.3f}ms",
+                          usec[0] / 1e3,
+                          usec[1] / 1e3,
+                          usec[2] / 1e3,
+                          usec[3] / 1e3);
+  }
+  return res;
+}
+
+void OpStats::onSuccess(size_t bytes, std::chrono::microseconds latency) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++interval_.ok;
+  interval_.bytes += bytes;
+  interval_.latency.add(latency.count());
+  active_ = true;
+}
+
+void OpStats::onSuccess(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++interval_.ok;
+  interval_.bytes += bytes;
+  active_ = true;
+}
+
+void OpStats::onFailure(Status status) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++interval_.failed;
+  ++interval_.errors[status];
+  active_ = true;
+}
+
+OpStats::Snapshot OpStats::takeInterval() {
+  Snapshot res;
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::swap(res, interval_);
+  total_.merge(res);
+  return res;
+}
+
+OpStats::Snapshot OpStats::total() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return total_;
+}
+
+bool OpStats::active() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return active_;
+}
+
+}}} // namespace facebook::logdevice::ldbench
@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "logdevice/common/stats/Histogram.h"
+#include "logdevice/include/Err.h"
+
+namespace facebook { namespace logdevice { namespace ldbench {
+
+/**
+ * @file Counters and latency distribution of one kind of operation issued by
+ *       ldbench (appends, records read, findTime requests). Updated from
+ *       client threads, and read once per reporting interval by the main
+ *       thread.
+ */
+
+class OpStats {
+ public:
+  struct Snapshot {
+    uint64_t ok = 0;
+    uint64_t failed = 0;
+    uint64_t bytes = 0;
+    HighResLatencyHistogram latency;
+    std::map<Status, uint64_t> errors;
+
+    void merge(const Snapshot& other);
+
+    // "<ok>/s <MB>/s fail <failed> p50 <ms> p99 <ms> p99.9 <ms> max <ms>"
+    // with rates computed over `interval`.
+    std::string describe(std::chrono::duration<double> interval) const;
+  };
+
+  explicit OpStats(std::string name) : name_(std::move(name)) {}
+
+  const std::string& name() const {
+    return name_;
+  }
+
+  // Records a successful operation of `bytes` bytes, that completed
+  // `latency` after it was due.
+  void onSuccess(size_t bytes, std::chrono::microseconds latency);
+
+  // Same, for operations without a meaningful latency, like records read
+  // from the backlog.
+  void onSuccess(size_t bytes);
+
+  void onFailure(Status status);
+
+  // Returns what was recorded since the previous call, and adds it to the
+  // totals.
+  Snapshot takeInterval();
+
+  // Everything recorded up to the last takeInterval().
+  Snapshot total() const;
+
+  // True if anything was ever recorded.
+  bool active() const;
+
+ private:
+  const std::string name_;
+  mutable std::mutex mutex_;
+  Snapshot interval_;
+  Snapshot total_;
+  bool active_ = false;
+};
+
+}}} // namespace facebook::logdevice::ldbench
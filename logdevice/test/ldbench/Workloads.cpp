@@ -0,0 +1,375 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/test/ldbench/Workloads.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <folly/Random.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/include/Record.h"
+
+namespace facebook { namespace logdevice { namespace ldbench {
+
+using std::chrono::duration_cast;
+
+// How long stop() waits for the operations in flight.
+static const std::chrono::seconds DRAIN_TIMEOUT(10);
+
+OpenLoopScheduler::OpenLoopScheduler(double rate, size_t max_in_flight)
+    : interval_(1.0 / rate), max_in_flight_(max_in_flight) {
+  ld_check(rate > 0);
+  ld_check(max_in_flight > 0);
+}
+
+bool OpenLoopScheduler::next(Clock::time_point* due,
+                             std::chrono::system_clock::time_point* due_wall) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (issued_ == 0) {
+    start_ = Clock::now();
+    start_wall_ = std::chrono::system_clock::now();
+  }
+  const auto offset = duration_cast<Clock::duration>(interval_ * issued_);
+  *due = start_ + offset;
+  cv_.wait_until(lock, *due, [&] { return stopped_; });
+  cv_.wait(lock, [&] { return stopped_ || in_flight_ < max_in_flight_; });
+  if (stopped_) {
+    return false;
+  }
+  ++issued_;
+  ++in_flight_;
+  *due_wall = start_wall_ +
+      duration_cast<std::chrono::system_clock::duration>(offset);
+  return true;
+}
+
+void OpenLoopScheduler::done() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ld_check(in_flight_ > 0);
+  --in_flight_;
+  cv_.notify_all();
+}
+
+void OpenLoopScheduler::stop() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stopped_ = true;
+  cv_.notify_all();
+}
+
+void OpenLoopScheduler::drain(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!cv_.wait_for(lock, timeout, [&] { return in_flight_ == 0; })) {
+    ld_warning("%lu operations still in flight after %lums",
+               in_flight_,
+               timeout.count());
+  }
+}
+
+std::string makePayload(size_t size,
+                        std::chrono::system_clock::time_point due_wall) {
+  std::string payload(std::max(size, sizeof(PayloadHeader)), 'x');
+  PayloadHeader header;
+  header.magic = PayloadHeader::MAGIC;
+  header.due_usec =
+      duration_cast<std::chrono::microseconds>(due_wall.time_since_epoch())
+          .count();
+  memcpy(&payload[0], &header, sizeof(header));
+  return payload;
+}
+
+folly::Optional<std::chrono::microseconds>
+endToEndLatency(const Payload& payload) {
+  if (payload.size() < sizeof(PayloadHeader)) {
+    return folly::none;
+  }
+  PayloadHeader header;
+  memcpy(&header, payload.data(), sizeof(header));
+  if (header.magic != PayloadHeader::MAGIC) {
+    return folly::none;
+  }
+  const auto now = duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch());
+  return std::max(std::chrono::microseconds(0),
+                  now - std::chrono::microseconds(header.due_usec));
+}
+
+AppendWorkload::AppendWorkload(std::shared_ptr<Client> client,
+                               std::vector<logid_t> logs,
+                               AppendOptions options,
+                               OpStats* stats)
+    : client_(std::move(client)),
+      logs_(std::move(logs)),
+      options_(std::move(options)),
+      stats_(stats),
+      scheduler_(options_.rate, options_.max_in_flight) {
+  ld_check(!logs_.empty());
+  if (options_.buffered_writer) {
+    buffered_writer_ = BufferedWriter::create(
+        client_, this, options_.buffered_writer_options);
+  }
+}
+
+AppendWorkload::~AppendWorkload() {
+  if (thread_.joinable()) {
+    stop();
+  }
+}
+
+void AppendWorkload::start() {
+  thread_ = std::thread([this] { run(); });
+}
+
+void AppendWorkload::stop() {
+  scheduler_.stop();
+  thread_.join();
+  if (buffered_writer_) {
+    buffered_writer_->flushAll();
+  }
+  scheduler_.drain(DRAIN_TIMEOUT);
+}
+
+void AppendWorkload::run() {
+  Clock::time_point due;
+  std::chrono::system_clock::time_point due_wall;
+  while (scheduler_.next(&due, &due_wall)) {
+    const logid_t log = logs_[folly::Random::rand32(logs_.size())];
+    std::string payload = makePayload(options_.payload_size, due_wall);
+    int rv;
+    if (buffered_writer_) {
+      auto context = new Clock::time_point(due);
+      rv = buffered_writer_->append(log, std::move(payload), context);
+      if (rv != 0) {
+        delete context;
+      }
+    } else {
+      rv = client_->append(
+          log, std::move(payload), [this, due](Status st, const DataRecord&) {
+            onAppendDone(st, due);
+          });
+    }
+    if (rv != 0) {
+      onAppendDone(err, due);
+    }
+  }
+}
+
+void AppendWorkload::onAppendDone(Status status, Clock::time_point due) {
+  if (status == E::OK) {
+    stats_->onSuccess(
+        options_.payload_size,
+        duration_cast<std::chrono::microseconds>(Clock::now() - due));
+  } else {
+    stats_->onFailure(status);
+  }
+  scheduler_.done();
+}
+
+void AppendWorkload::onSuccess(logid_t /*log_id*/,
+                               ContextSet contexts,
+                               const DataRecordAttributes& /*attrs*/) {
+  for (auto& context : contexts) {
+    auto due = static_cast<Clock::time_point*>(context.first);
+    onAppendDone(E::OK, *due);
+    delete due;
+  }
+}
+
+void AppendWorkload::onFailure(logid_t /*log_id*/,
+                               ContextSet contexts,
+                               Status status) {
+  for (auto& context : contexts) {
+    auto due = static_cast<Clock::time_point*>(context.first);
+    onAppendDone(status, *due);
+    delete due;
+  }
+}
+
+// Counts records and data loss gaps delivered to `reader` in `stats`.
+// Records written by ldbench are counted with their end-to-end latency.
+static void setReaderCallbacks(AsyncReader& reader, OpStats* stats) {
+  reader.setBatchRecordCallback(
+      [stats](std::vector<std::unique_ptr<DataRecord>>& records) {
+        for (const auto& record : records) {
+          auto latency = endToEndLatency(record->payload);
+          if (latency.hasValue()) {
+            stats->onSuccess(record->payload.size(), latency.value());
+          } else {
+            stats->onSuccess(record->payload.size());
+          }
+        }
+        return records.size();
+      });
+  reader.setGapCallback([stats](const GapRecord& gap) {
+    if (gap.type == GapType::DATALOSS) {
+      stats->onFailure(E::DATALOSS);
+    }
+    return true;
+  });
+}
+
+TailWorkload::TailWorkload(std::shared_ptr<Client> client,
+                           std::vector<logid_t> logs,
+                           size_t fanout,
+                           OpStats* stats)
+    : client_(std::move(client)),
+      logs_(std::move(logs)),
+      fanout_(fanout),
+      stats_(stats) {}
+
+void TailWorkload::start() {
+  std::vector<std::pair<logid_t, lsn_t>> from;
+  for (logid_t log : logs_) {
+    const lsn_t tail = client_->getTailLSNSync(log);
+    if (tail == LSN_INVALID) {
+      ld_error("Not tailing log %lu: failed to get its tail LSN: %s",
+               log.val_,
+               error_description(err));
+      continue;
+    }
+    from.emplace_back(log, tail + 1);
+  }
+
+  for (size_t i = 0; i < fanout_; ++i) {
+    auto reader = client_->createAsyncReader();
+    setReaderCallbacks(*reader, stats_);
+    for (const auto& log_from : from) {
+      int rv = reader->startReading(log_from.first, log_from.second);
+      if (rv != 0) {
+        ld_error("Failed to start reading log %lu: %s",
+                 log_from.first.val_,
+                 error_description(err));
+      }
+    }
+    readers_.push_back(std::move(reader));
+  }
+}
+
+void TailWorkload::stop() {
+  // Destroying the readers stops their read streams.
+  readers_.clear();
+}
+
+BackfillWorkload::BackfillWorkload(std::shared_ptr<Client> client,
+                                   std::vector<logid_t> logs,
+                                   std::chrono::seconds backlog,
+                                   size_t readers,
+                                   OpStats* stats)
+    : client_(std::move(client)),
+      logs_(std::move(logs)),
+      backlog_(backlog),
+      num_readers_(std::max<size_t>(1, std::min(readers, logs_.size()))),
+      stats_(stats) {}
+
+void BackfillWorkload::start() {
+  start_time_ = Clock::now();
+  const auto since = duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch() - backlog_);
+
+  for (size_t i = 0; i < num_readers_; ++i) {
+    auto reader = client_->createAsyncReader();
+    setReaderCallbacks(*reader, stats_);
+    reader->setDoneCallback([this](logid_t) {
+      if (++logs_done_ == logs_.size()) {
+        ld_info(
+            "Backlog replay of %lu logs done in %.1fs",
+            logs_.size(),
+            std::chrono::duration<double>(Clock::now() - start_time_).count());
+      }
+    });
+    readers_.push_back(std::move(reader));
+  }
+
+  for (size_t i = 0; i < logs_.size(); ++i) {
+    const logid_t log = logs_[i];
+    lsn_t from = LSN_OLDEST;
+    if (backlog_.count() > 0) {
+      Status st;
+      from = client_->findTimeSync(log, since, &st);
+      if (st != E::OK) {
+        ld_warning("findTime() on log %lu failed: %s. Reading it from the "
+                   "beginning.",
+                   log.val_,
+                   error_description(st));
+        from = LSN_OLDEST;
+      }
+    }
+    const lsn_t until = client_->getTailLSNSync(log);
+    if (until == LSN_INVALID || until < from) {
+      if (until == LSN_INVALID) {
+        ld_error("Not reading log %lu: failed to get its tail LSN: %s",
+                 log.val_,
+                 error_description(err));
+      }
+      ++logs_done_;
+      continue;
+    }
+    int rv = readers_[i % num_readers_]->startReading(log, from, until);
+    if (rv != 0) {
+      ld_error("Failed to start reading log %lu: %s",
+               log.val_,
+               error_description(err));
+      ++logs_done_;
+    }
+  }
+}
+
+void BackfillWorkload::stop() {
+  readers_.clear();
+}
+
+FindTimeWorkload::FindTimeWorkload(std::shared_ptr<Client> client,
+                                   std::vector<logid_t> logs,
+                                   FindTimeOptions options,
+                                   OpStats* stats)
+    : client_(std::move(client)),
+      logs_(std::move(logs)),
+      options_(std::move(options)),
+      stats_(stats),
+      scheduler_(options_.rate, options_.max_in_flight) {
+  ld_check(!logs_.empty());
+}
+
+void FindTimeWorkload::start() {
+  thread_ = std::thread([this] { run(); });
+}
+
+void FindTimeWorkload::stop() {
+  scheduler_.stop();
+  thread_.join();
+  scheduler_.drain(DRAIN_TIMEOUT);
+}
+
+void FindTimeWorkload::run() {
+  const uint64_t range_ms =
+      duration_cast<std::chrono::milliseconds>(options_.range).count();
+  Clock::time_point due;
+  std::chrono::system_clock::time_point due_wall;
+  while (scheduler_.next(&due, &due_wall)) {
+    const logid_t log = logs_[folly::Random::rand32(logs_.size())];
+    const auto timestamp =
+        duration_cast<std::chrono::milliseconds>(due_wall.time_since_epoch()) -
+        std::chrono::milliseconds(folly::Random::rand64(range_ms + 1));
+    auto cb = [this, due](Status st, lsn_t /*result*/) {
+      if (st == E::OK) {
+        stats_->onSuccess(
+            0, duration_cast<std::chrono::microseconds>(Clock::now() - due));
+      } else {
+        stats_->onFailure(st);
+      }
+      scheduler_.done();
+    };
+    int rv = client_->findTime(log, timestamp, cb, options_.accuracy);
+    if (rv != 0) {
+      stats_->onFailure(err);
+      scheduler_.done();
+    }
+  }
+}
+
+}}} // namespace facebook::logdevice::ldbench
@@ -0,0 +1,227 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <folly/Optional.h>
+
+#include "logdevice/include/AsyncReader.h"
+#include "logdevice/include/BufferedWriter.h"
+#include "logdevice/include/Client.h"
+#include "logdevice/include/types.h"
+#include "logdevice/test/ldbench/BenchStats.h"
+
+namespace facebook { namespace logdevice { namespace ldbench {
+
+/**
+ * @file The load that ldbench puts on a cluster is a combination of
+ *       workloads, each issuing one kind of operation and recording it in an
+ *       OpStats.
+ *
+ *       Appends and findTime requests are issued open-loop: the i-th
+ *       operation is due at start + i / rate, whether or not the previous
+ *       ones completed, and its latency is measured from when it was due
+ *       rather than from when it was issued. A slow cluster thus shows up as
+ *       higher latencies instead of a lower request rate (no "coordinated
+ *       omission"). The number of operations in flight is still capped, to
+ *       bound memory use; operations waiting for a slot are late, and their
+ *       latency includes the wait.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+// Issues operations at a fixed rate from a single thread.
+class OpenLoopScheduler {
+ public:
+  OpenLoopScheduler(double rate, size_t max_in_flight);
+
+  // Blocks until the next operation is due and fewer than max_in_flight
+  // operations are in flight. Returns false if stop() was called.
+  // Otherwise, sets `due` to when the operation was due and `due_wall` to
+  // the same time on the system clock, and counts the operation as in
+  // flight until done() is called.
+  bool next(Clock::time_point* due,
+            std::chrono::system_clock::time_point* due_wall);
+
+  void done();
+
+  void stop();
+
+  // Waits until no operation is in flight, or until `timeout` passed.
+  void drain(std::chrono::milliseconds timeout);
+
+ private:
+  const std::chrono::duration<double> interval_;
+  const size_t max_in_flight_;
+  Clock::time_point start_;
+  std::chrono::system_clock::time_point start_wall_;
+  uint64_t issued_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t in_flight_ = 0;
+  bool stopped_ = false;
+};
+
+class Workload {
+ public:
+  virtual void start() = 0;
+
+  // Stops issuing operations and waits for the ones in flight, for a
+  // bounded time.
+  virtual void stop() = 0;
+
+  virtual ~Workload() {}
+};
+
+// Payloads written by ldbench start with a magic number and the time the
+// append was due, so that readers can compute the end-to-end latency.
+struct PayloadHeader {
+  static constexpr uint32_t MAGIC = 0x4e42444c; // "LDBN"
+  uint32_t magic;
+  int64_t due_usec; // since epoch, system clock
+} __attribute__((__packed__));
+
+std::string makePayload(size_t size,
+                        std::chrono::system_clock::time_point due_wall);
+
+// Returns how long ago the append of `payload` was due, if it was written
+// by ldbench.
+folly::Optional<std::chrono::microseconds>
+endToEndLatency(const Payload& payload);
+
+struct AppendOptions {
+  double rate = 1000;
+  size_t payload_size = 1024;
+  size_t max_in_flight = 10000;
+  // If set, appends go through a BufferedWriter with these options, rather
+  // than straight to Client::append().
+  bool buffered_writer = false;
+  BufferedWriter::Options buffered_writer_options;
+};
+
+// Appends to random logs of `logs`.
+class AppendWorkload : public Workload,
+                       public BufferedWriter::AppendCallback {
+ public:
+  AppendWorkload(std::shared_ptr<Client> client,
+                 std::vector<logid_t> logs,
+                 AppendOptions options,
+                 OpStats* stats);
+  ~AppendWorkload() override;
+
+  void start() override;
+  void stop() override;
+
+  void onSuccess(logid_t log_id,
+                 ContextSet contexts,
+                 const DataRecordAttributes& attrs) override;
+  void onFailure(logid_t log_id, ContextSet contexts, Status status) override;
+
+ private:
+  void run();
+  void onAppendDone(Status status, Clock::time_point due);
+
+  std::shared_ptr<Client> client_;
+  const std::vector<logid_t> logs_;
+  const AppendOptions options_;
+  OpStats* const stats_;
+  OpenLoopScheduler scheduler_;
+  std::unique_ptr<BufferedWriter> buffered_writer_;
+  std::thread thread_;
+};
+
+// `fanout` AsyncReaders, each tailing all of `logs` from their tail at
+// start(). Records are counted in `stats` with their end-to-end latency.
+class TailWorkload : public Workload {
+ public:
+  TailWorkload(std::shared_ptr<Client> client,
+               std::vector<logid_t> logs,
+               size_t fanout,
+               OpStats* stats);
+
+  void start() override;
+  void stop() override;
+
+ private:
+  std::shared_ptr<Client> client_;
+  const std::vector<logid_t> logs_;
+  const size_t fanout_;
+  OpStats* const stats_;
+  std::vector<std::unique_ptr<AsyncReader>> readers_;
+};
+
+// Reads the backlog of `logs`, from `backlog` ago (from the beginning of the
+// logs if zero) to their tail at start(), with `readers` AsyncReaders that
+// each read a share of the logs.
+class BackfillWorkload : public Workload {
+ public:
+  BackfillWorkload(std::shared_ptr<Client> client,
+                   std::vector<logid_t> logs,
+                   std::chrono::seconds backlog,
+                   size_t readers,
+                   OpStats* stats);
+
+  void start() override;
+  void stop() override;
+
+  // True once all logs were read up to their tail.
+  bool done() const {
+    return logs_done_.load() == logs_.size();
+  }
+
+ private:
+  std::shared_ptr<Client> client_;
+  const std::vector<logid_t> logs_;
+  const std::chrono::seconds backlog_;
+  const size_t num_readers_;
+  OpStats* const stats_;
+  std::vector<std::unique_ptr<AsyncReader>> readers_;
+  std::atomic<size_t> logs_done_{0};
+  Clock::time_point start_time_;
+};
+
+struct FindTimeOptions {
+  double rate = 100;
+  size_t max_in_flight = 1000;
+  // Timestamps are picked uniformly at random in [now - range, now].
+  std::chrono::seconds range{3600};
+  FindKeyAccuracy accuracy = FindKeyAccuracy::STRICT;
+};
+
+// findTime() requests on random logs of `logs`.
+class FindTimeWorkload : public Workload {
+ public:
+  FindTimeWorkload(std::shared_ptr<Client> client,
+                   std::vector<logid_t> logs,
+                   FindTimeOptions options,
+                   OpStats* stats);
+
+  void start() override;
+  void stop() override;
+
+ private:
+  void run();
+
+  std::shared_ptr<Client> client_;
+  const std::vector<logid_t> logs_;
+  const FindTimeOptions options_;
+  OpStats* const stats_;
+  OpenLoopScheduler scheduler_;
+  std::thread thread_;
+};
+
+}}} // namespace facebook::logdevice::ldbench
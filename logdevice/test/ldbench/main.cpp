@@ -0,0 +1,433 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+#include <folly/Conv.h>
+#include <folly/Singleton.h>
+#include <folly/String.h>
+
+#include "logdevice/include/BufferedWriter.h"
+#include "logdevice/include/Client.h"
+#include "logdevice/include/ClientSettings.h"
+#include "logdevice/include/debug.h"
+#include "logdevice/test/ldbench/BenchStats.h"
+#include "logdevice/test/ldbench/Workloads.h"
+
+/**
+ * @file ldbench: load generator for LogDevice clusters, to measure their
+ *       throughput and latency under a realistic load, e.g. on a staging
+ *       cluster before an upgrade. See USAGE.
+ */
+
+using namespace facebook::logdevice;
+using namespace facebook::logdevice::ldbench;
+
+static const char* USAGE =
+    R"DOC(Usage: ldbench [options...] -c CONFIG -l LOGS -p PROFILE
+
+Puts load on a LogDevice cluster and prints, every second, the rate,
+throughput and latency percentiles of each kind of operation, followed by a
+summary at the end of the run.
+
+Profiles:
+  write     appends at --write-rate to random logs of LOGS
+  tail      appends as in "write", and --fanout readers tailing all of LOGS;
+            read latency is end-to-end, from when the append was due
+  backfill  reads the backlog of LOGS, from --backlog ago (from the
+            beginning of the logs if 0) to their tail at start, with
+            --backfill-readers readers; appends too if --write-rate > 0;
+            ends when the backlog is read or after --duration
+  findtime  findTime requests at --findtime-rate on random logs of LOGS
+  mixed     "tail" and "findtime" at the same time
+
+Appends and findTime requests are issued open-loop at a fixed rate, and
+their latency is measured from when they were due rather than from when
+they were sent, so that a slow cluster shows up as higher latencies rather
+than a lower rate.
+
+LOGS is a comma-separated list of log IDs or ranges, e.g. "1..100,200".
+
+)DOC";
+
+namespace {
+
+struct {
+  std::string config_path;
+  std::string profile;
+  std::string logs;
+  uint64_t duration_sec = 60;
+  std::vector<std::string> client_settings;
+
+  double write_rate = 1000;
+  size_t payload_size = 1024;
+  size_t max_appends_in_flight = 10000;
+  bool buffered_writer = false;
+  int64_t buffered_writer_time_trigger_ms = 10;
+  ssize_t buffered_writer_size_trigger = -1;
+
+  size_t fanout = 1;
+
+  uint64_t backlog_sec = 0;
+  size_t backfill_readers = 1;
+
+  double findtime_rate = 100;
+  size_t max_findtimes_in_flight = 1000;
+  uint64_t findtime_range_sec = 3600;
+  bool findtime_approximate = false;
+} options;
+
+std::atomic<bool> interrupted{false};
+
+void parse_command_line(int argc, const char** argv);
+
+std::vector<logid_t> parse_logs(const std::string& spec) {
+  std::vector<logid_t> logs;
+  std::vector<folly::StringPiece> tokens;
+  folly::split(',', spec, tokens, /* ignoreEmpty */ true);
+  for (auto token : tokens) {
+    folly::StringPiece lo;
+    folly::StringPiece hi;
+    if (folly::split("..", token, lo, hi)) {
+      const auto first = folly::to<logid_t::raw_type>(lo);
+      const auto last = folly::to<logid_t::raw_type>(hi);
+      for (auto log = first; log <= last; ++log) {
+        logs.push_back(logid_t(log));
+      }
+    } else {
+      logs.push_back(logid_t(folly::to<logid_t::raw_type>(token)));
+    }
+  }
+  return logs;
+}
+
+std::shared_ptr<Client> create_client() {
+  std::unique_ptr<ClientSettings> settings(ClientSettings::create());
+  for (const auto& setting : options.client_settings) {
+    std::string name;
+    std::string value;
+    if (!folly::split('=', setting, name, value)) {
+      std::cerr << "Invalid --client-setting \"" << setting
+                << "\", expected name=value\n";
+      exit(1);
+    }
+    if (settings->set(name.c_str(), value.c_str()) != 0) {
+      std::cerr << "Invalid --client-setting \"" << setting
+                << "\": " << error_description(err) << '\n';
+      exit(1);
+    }
+  }
+  return Client::create("ldbench",
+                        options.config_path,
+                        "",
+                        std::chrono::seconds(60),
+                        std::move(settings));
+}
+
+void print_interval(std::chrono::seconds elapsed,
+                    std::chrono::duration<double> interval,
+                    const std::vector<std::unique_ptr<OpStats>>& stats) {
+  for (const auto& s : stats) {
+    // Always take the interval, so that the totals stay up to date.
+    auto snapshot = s->takeInterval();
+    if (s->active()) {
+      printf("[%5lds] %-9s %s\n",
+             elapsed.count(),
+             s->name().c_str(),
+             snapshot.describe(interval).c_str());
+    }
+  }
+  fflush(stdout);
+}
+
+void print_summary(std::chrono::duration<double> run_time,
+                   const std::vector<std::unique_ptr<OpStats>>& stats) {
+  printf("\nSummary over %.1fs:\n", run_time.count());
+  for (const auto& s : stats) {
+    if (!s->active()) {
+      continue;
+    }
+    auto total = s->total();
+    printf("%-9s %s\n", s->name().c_str(), total.describe(run_time).c_str());
+    for (const auto& kv : total.errors) {
+      printf("%-9s   %lu failed with %s\n",
+             "",
+             kv.second,
+             error_name(kv.first));
+    }
+  }
+  fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, const char* argv[]) {
+  folly::SingletonVault::singleton()->registrationComplete();
+  dbg::currentLevel = dbg::Level::WARNING;
+
+  parse_command_line(argc, argv);
+
+  std::vector<logid_t> logs;
+  try {
+    logs = parse_logs(options.logs);
+  } catch (const std::exception& ex) {
+    std::cerr << "Invalid --logs \"" << options.logs << "\": " << ex.what()
+              << '\n';
+    return 1;
+  }
+  if (logs.empty()) {
+    std::cerr << "--logs is empty\n";
+    return 1;
+  }
+
+  const std::string& profile = options.profile;
+  const bool append = profile == "write" || profile == "tail" ||
+      profile == "mixed" ||
+      (profile == "backfill" && options.write_rate > 0);
+  const bool tail = profile == "tail" || profile == "mixed";
+  const bool backfill = profile == "backfill";
+  const bool findtime = profile == "findtime" || profile == "mixed";
+  if (!append && !tail && !backfill && !findtime) {
+    std::cerr << "Unknown --profile \"" << profile << "\"\n";
+    return 1;
+  }
+  if ((append && options.write_rate <= 0) ||
+      (findtime && options.findtime_rate <= 0)) {
+    std::cerr << "Rates must be positive\n";
+    return 1;
+  }
+
+  std::shared_ptr<Client> client = create_client();
+  if (!client) {
+    std::cerr << "Failed to create a client: " << error_description(err)
+              << ". Is the config path correct?\n";
+    return 1;
+  }
+
+  std::vector<std::unique_ptr<OpStats>> stats;
+  std::vector<std::unique_ptr<Workload>> workloads;
+  BackfillWorkload* backfill_workload = nullptr;
+
+  // Readers are started first, so that tailers see all appends.
+  if (tail) {
+    stats.push_back(std::make_unique<OpStats>("tail"));
+    workloads.push_back(std::make_unique<TailWorkload>(
+        client, logs, options.fanout, stats.back().get()));
+  }
+  if (backfill) {
+    stats.push_back(std::make_unique<OpStats>("backfill"));
+    auto w = std::make_unique<BackfillWorkload>(
+        client,
+        logs,
+        std::chrono::seconds(options.backlog_sec),
+        options.backfill_readers,
+        stats.back().get());
+    backfill_workload = w.get();
+    workloads.push_back(std::move(w));
+  }
+  if (append) {
+    AppendOptions append_options;
+    append_options.rate = options.write_rate;
+    append_options.payload_size = options.payload_size;
+    append_options.max_in_flight = options.max_appends_in_flight;
+    append_options.buffered_writer = options.buffered_writer;
+    append_options.buffered_writer_options.time_trigger =
+        std::chrono::milliseconds(options.buffered_writer_time_trigger_ms);
+    append_options.buffered_writer_options.size_trigger =
+        options.buffered_writer_size_trigger;
+    stats.push_back(std::make_unique<OpStats>("append"));
+    workloads.push_back(std::make_unique<AppendWorkload>(
+        client, logs, std::move(append_options), stats.back().get()));
+  }
+  if (findtime) {
+    FindTimeOptions findtime_options;
+    findtime_options.rate = options.findtime_rate;
+    findtime_options.max_in_flight = options.max_findtimes_in_flight;
+    findtime_options.range = std::chrono::seconds(options.findtime_range_sec);
+    findtime_options.accuracy = options.findtime_approximate
+        ? FindKeyAccuracy::APPROXIMATE
+        : FindKeyAccuracy::STRICT;
+    stats.push_back(std::make_unique<OpStats>("findtime"));
+    workloads.push_back(std::make_unique<FindTimeWorkload>(
+        client, logs, std::move(findtime_options), stats.back().get()));
+  }
+
+  std::signal(SIGINT, [](int) { interrupted.store(true); });
+  std::signal(SIGTERM, [](int) { interrupted.store(true); });
+
+  for (auto& w : workloads) {
+    w->start();
+  }
+
+  const auto start = Clock::now();
+  const auto end = start + std::chrono::seconds(options.duration_sec);
+  auto last_report = start;
+  auto next_report = start + std::chrono::seconds(1);
+  while (!interrupted.load() && Clock::now() < end &&
+         !(backfill_workload && backfill_workload->done())) {
+    std::this_thread::sleep_until(std::min(next_report, end));
+    const auto now = Clock::now();
+    if (now >= next_report) {
+      print_interval(
+          std::chrono::duration_cast<std::chrono::seconds>(now - start),
+          now - last_report,
+          stats);
+      last_report = now;
+      next_report += std::chrono::seconds(1);
+    }
+  }
+
+  for (auto& w : workloads) {
+    w->stop();
+  }
+  const auto now = Clock::now();
+  print_interval(std::chrono::duration_cast<std::chrono::seconds>(now - start),
+                 now - last_report,
+                 stats);
+  print_summary(now - start, stats);
+  workloads.clear();
+  return 0;
+}
+
+namespace {
+
+void parse_command_line(int argc, const char** argv) {
+  using boost::program_options::bool_switch;
+  using boost::program_options::value;
+  namespace style = boost::program_options::command_line_style;
+  try {
+    boost::program_options::options_description desc("Options");
+    // clang-format off
+    desc.add_options()
+
+    ("help,h",
+     "print help and exit")
+
+    ("config,c",
+     value<std::string>(&options.config_path)
+       ->required(),
+     "location of the cluster config to use; can be a file or more generally "
+     "[scheme:]<path-to-config>")
+
+    ("profile,p",
+     value<std::string>(&options.profile)
+       ->required(),
+     "workload profile: write, tail, backfill, findtime or mixed")
+
+    ("logs,l",
+     value<std::string>(&options.logs)
+       ->required(),
+     "logs to use, e.g. \"1..100,200\"")
+
+    ("duration",
+     value<uint64_t>(&options.duration_sec)
+       ->default_value(options.duration_sec),
+     "how long to run, in seconds")
+
+    ("client-setting",
+     value<std::vector<std::string>>(&options.client_settings)
+       ->composing(),
+     "client setting, as name=value; may be repeated")
+
+    ("write-rate",
+     value<double>(&options.write_rate)
+       ->default_value(options.write_rate),
+     "appends per second")
+
+    ("payload-size",
+     value<size_t>(&options.payload_size)
+       ->default_value(options.payload_size),
+     "payload size of appends, in bytes; at least 12 for end-to-end latency "
+     "to be measured")
+
+    ("max-appends-in-flight",
+     value<size_t>(&options.max_appends_in_flight)
+       ->default_value(options.max_appends_in_flight),
+     "appends due while this many are in flight wait for one to complete")
+
+    ("buffered-writer",
+     bool_switch(&options.buffered_writer),
+     "append through a BufferedWriter rather than with Client::append()")
+
+    ("buffered-writer-time-trigger-ms",
+     value<int64_t>(&options.buffered_writer_time_trigger_ms)
+       ->default_value(options.buffered_writer_time_trigger_ms),
+     "time trigger of the BufferedWriter, in milliseconds")
+
+    ("buffered-writer-size-trigger",
+     value<ssize_t>(&options.buffered_writer_size_trigger)
+       ->default_value(options.buffered_writer_size_trigger),
+     "size trigger of the BufferedWriter, in bytes; -1 for none")
+
+    ("fanout",
+     value<size_t>(&options.fanout)
+       ->default_value(options.fanout),
+     "number of readers tailing each log")
+
+    ("backlog",
+     value<uint64_t>(&options.backlog_sec)
+       ->default_value(options.backlog_sec),
+     "how far back backlog replay starts reading, in seconds; 0 to read logs "
+     "from the beginning")
+
+    ("backfill-readers",
+     value<size_t>(&options.backfill_readers)
+       ->default_value(options.backfill_readers),
+     "number of readers replaying the backlog, each reading a share of the "
+     "logs")
+
+    ("findtime-rate",
+     value<double>(&options.findtime_rate)
+       ->default_value(options.findtime_rate),
+     "findTime requests per second")
+
+    ("max-findtimes-in-flight",
+     value<size_t>(&options.max_findtimes_in_flight)
+       ->default_value(options.max_findtimes_in_flight),
+     "findTime requests due while this many are in flight wait for one to "
+     "complete")
+
+    ("findtime-range",
+     value<uint64_t>(&options.findtime_range_sec)
+       ->default_value(options.findtime_range_sec),
+     "findTime timestamps are picked at random in the last this many seconds")
+
+    ("findtime-approximate",
+     bool_switch(&options.findtime_approximate),
+     "use FindKeyAccuracy::APPROXIMATE")
+
+      ;
+    // clang-format on
+
+    boost::program_options::command_line_parser parser(argc, argv);
+    boost::program_options::variables_map parsed;
+    boost::program_options::store(
+        parser.options(desc)
+            .style(style::unix_style & ~style::allow_guessing)
+            .run(),
+        parsed);
+    if (parsed.count("help")) {
+      std::cout << USAGE << "\n" << desc;
+      exit(0);
+    }
+    boost::program_options::notify(parsed);
+  } catch (const boost::program_options::error& ex) {
+    std::cerr << argv[0] << ": " << ex.what() << '\n';
+    exit(1);
+  }
+}
+
+} // namespace
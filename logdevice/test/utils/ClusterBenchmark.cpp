@@ -0,0 +1,408 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/test/utils/ClusterBenchmark.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <folly/Conv.h>
+#include <folly/FileUtil.h>
+#include <folly/Random.h>
+#include <folly/json.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/test/utils/IntegrationTestUtils.h"
+
+namespace facebook { namespace logdevice { namespace IntegrationTestUtils {
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::duration_cast;
+
+// How long BenchmarkLoad::stop() waits for the appends in flight.
+static const std::chrono::seconds DRAIN_TIMEOUT(10);
+
+// Messages exchanged by log recovery, and stats of its outcome.
+static const std::vector<std::string> RECOVERY_STATS = {
+    "message_sent.SEAL",
+    "message_sent.SEALED",
+    "message_sent.CLEAN",
+    "message_sent.CLEANED",
+    "message_sent.MUTATED",
+    "message_sent.GET_EPOCH_RECOVERY_METADATA",
+    "message_sent.GET_EPOCH_RECOVERY_METADATA_REPLY",
+    "recovery_completed",
+    "recovery_success",
+    "recovery_failed",
+};
+
+static const std::vector<std::string> REBUILDING_STATS = {
+    "rebuilding_donor_stored_ok",
+    "rebuilding_recipient_stored_ok",
+};
+
+static double secondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+BenchmarkLoad::BenchmarkLoad(std::shared_ptr<Client> client,
+                             std::vector<logid_t> logs,
+                             double appends_per_sec,
+                             size_t payload_size)
+    : client_(std::move(client)),
+      logs_(std::move(logs)),
+      appends_per_sec_(appends_per_sec),
+      payload_(payload_size, 'x') {
+  ld_check(!logs_.empty());
+  ld_check(appends_per_sec_ > 0);
+}
+
+BenchmarkLoad::~BenchmarkLoad() {
+  if (thread_.joinable()) {
+    stop();
+  }
+}
+
+void BenchmarkLoad::start(std::string phase) {
+  setPhase(std::move(phase));
+  thread_ = std::thread([this] { run(); });
+}
+
+void BenchmarkLoad::stop() {
+  stop_.store(true);
+  thread_.join();
+  const auto deadline = Clock::now() + DRAIN_TIMEOUT;
+  while (in_flight_.load() > 0 && Clock::now() < deadline) {
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  if (in_flight_.load() > 0) {
+    ld_warning("%lu appends still in flight", in_flight_.load());
+  }
+}
+
+void BenchmarkLoad::setPhase(std::string phase) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  phase_ = std::move(phase);
+}
+
+void BenchmarkLoad::run() {
+  // Appends are issued open-loop: the i-th append is due at start + i / rate
+  // whether or not the previous ones completed, and its latency is measured
+  // from when it was due, so that a stalled cluster shows up in latencies.
+  const std::chrono::duration<double> interval(1.0 / appends_per_sec_);
+  const auto start = Clock::now();
+  for (uint64_t i = 0; !stop_.load(); ++i) {
+    const auto due = start + duration_cast<Clock::duration>(interval * i);
+    std::this_thread::sleep_until(due);
+    std::string phase;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      phase = phase_;
+    }
+    const logid_t log = logs_[folly::Random::rand32(logs_.size())];
+    ++in_flight_;
+    int rv = client_->append(
+        log, payload_, [this, phase, due](Status st, const DataRecord&) {
+          onAppendDone(st, phase, due);
+        });
+    if (rv != 0) {
+      onAppendDone(err, phase, due);
+    }
+  }
+}
+
+void BenchmarkLoad::onAppendDone(Status st,
+                                 const std::string& phase,
+                                 Clock::time_point due) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Phase& p = phases_[phase];
+    if (st == E::OK) {
+      ++p.appends;
+      p.latency.add(
+          duration_cast<std::chrono::microseconds>(Clock::now() - due)
+              .count());
+    } else {
+      ++p.failed;
+    }
+  }
+  --in_flight_;
+}
+
+folly::dynamic BenchmarkLoad::toDynamic() const {
+  folly::dynamic res = folly::dynamic::object;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& kv : phases_) {
+    const Phase& p = kv.second;
+    folly::dynamic obj = folly::dynamic::object("appends", p.appends)(
+        "failed", p.failed);
+    if (p.appends > 0) {
+      const double pcts[] = {0.5, 0.99, 0.999, 1.0};
+      int64_t usec[4];
+      p.latency.estimatePercentiles(pcts, 4, usec);
+      obj["p50_ms"] = usec[0] / 1e3;
+      obj["p99_ms"] = usec[1] / 1e3;
+      obj["p999_ms"] = usec[2] / 1e3;
+      obj["max_ms"] = usec[3] / 1e3;
+    }
+    res[kv.first] = std::move(obj);
+  }
+  return res;
+}
+
+std::map<std::string, int64_t>
+sumNodeStats(Cluster& cluster, const std::vector<std::string>& names) {
+  std::map<std::string, int64_t> res;
+  for (const auto& name : names) {
+    res[name] = 0;
+  }
+  for (const auto& it : cluster.getNodes()) {
+    if (!it.second->isRunning()) {
+      continue;
+    }
+    auto stats = it.second->stats();
+    for (const auto& name : names) {
+      auto stat = stats.find(name);
+      if (stat != stats.end()) {
+        res[name] += stat->second;
+      }
+    }
+  }
+  return res;
+}
+
+static folly::dynamic statsDelta(const std::map<std::string, int64_t>& before,
+                                 const std::map<std::string, int64_t>& after) {
+  folly::dynamic res = folly::dynamic::object;
+  for (const auto& kv : after) {
+    auto it = before.find(kv.first);
+    res[kv.first] = kv.second - (it == before.end() ? 0 : it->second);
+  }
+  return res;
+}
+
+static void loadFor(std::chrono::seconds duration) {
+  /* sleep override */
+  std::this_thread::sleep_for(duration);
+}
+
+folly::dynamic runSequencerFailover(Cluster& cluster,
+                                    std::vector<logid_t> logs,
+                                    SequencerFailoverOptions options) {
+  ld_check(!logs.empty());
+  auto client = cluster.createClient();
+
+  // Make sure all sequencers are active before finding out where they are.
+  for (logid_t log : logs) {
+    std::string payload(options.payload_size, 'x');
+    if (client->appendSync(log, payload) == LSN_INVALID) {
+      ld_error("Append to log %lu failed: %s", log.val_, error_name(err));
+    }
+  }
+  std::map<logid_t, node_index_t> sequencers;
+  for (logid_t log : logs) {
+    SequencerState seq_state;
+    Status st = getSeqState(client.get(), log, seq_state, true);
+    if (st != E::OK) {
+      ld_error("Failed to find the sequencer of log %lu: %s",
+               log.val_,
+               error_name(st));
+      continue;
+    }
+    sequencers[log] = seq_state.node.index();
+  }
+  if (!sequencers.count(logs[0])) {
+    return folly::dynamic::object("error", "no sequencer for logs[0]");
+  }
+  const node_index_t victim = sequencers[logs[0]];
+  std::vector<logid_t> affected;
+  for (const auto& kv : sequencers) {
+    if (kv.second == victim) {
+      affected.push_back(kv.first);
+    }
+  }
+  ld_info("Killing N%d, which runs the sequencers of %lu logs",
+          victim,
+          affected.size());
+
+  BenchmarkLoad load(
+      client, logs, options.appends_per_sec, options.payload_size);
+  load.start("before_kill");
+  loadFor(options.warmup);
+
+  const auto stats_before = sumNodeStats(cluster, RECOVERY_STATS);
+  load.setPhase("after_kill");
+  const auto kill_time = Clock::now();
+  cluster.getNode(victim).kill();
+
+  // One thread per affected log appends until an append succeeds, and
+  // records when it did. A log is writable again once a sequencer was
+  // activated on another node and its recovery released the new epoch.
+  const auto deadline = kill_time + options.timeout;
+  std::vector<double> time_to_writable(affected.size(), -1);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < affected.size(); ++i) {
+    threads.emplace_back([&, i] {
+      std::string payload(options.payload_size, 'x');
+      while (Clock::now() < deadline) {
+        if (client->appendSync(affected[i], payload) != LSN_INVALID) {
+          time_to_writable[i] = secondsSince(kill_time);
+          return;
+        }
+        /* sleep override */
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const double all_writable_sec = secondsSince(kill_time);
+  // Leave recovery time to finish so that its messages are all counted.
+  cluster.waitForRecovery(Clock::now() + options.timeout);
+  const auto stats_after = sumNodeStats(cluster, RECOVERY_STATS);
+  load.stop();
+
+  folly::dynamic per_log = folly::dynamic::object;
+  size_t not_writable = 0;
+  double max_sec = 0;
+  for (size_t i = 0; i < affected.size(); ++i) {
+    per_log[folly::to<std::string>(affected[i].val_)] = time_to_writable[i];
+    if (time_to_writable[i] < 0) {
+      ++not_writable;
+    } else {
+      max_sec = std::max(max_sec, time_to_writable[i]);
+    }
+  }
+  if (not_writable > 0) {
+    ld_error("%lu logs were still not writable %lds after killing N%d",
+             not_writable,
+             options.timeout.count(),
+             victim);
+  }
+
+  return folly::dynamic::object("killed_node", victim)(
+      "logs_affected", affected.size())("logs_not_writable", not_writable)(
+      "max_time_to_writable_sec", max_sec)(
+      "all_writable_sec", all_writable_sec)("time_to_writable_sec", per_log)(
+      "recovery_stats", statsDelta(stats_before, stats_after))(
+      "foreground_appends", load.toDynamic());
+}
+
+folly::dynamic runStorageNodeRebuild(Cluster& cluster,
+                                     node_index_t node,
+                                     std::vector<logid_t> logs,
+                                     StorageNodeRebuildOptions options) {
+  ld_check(!logs.empty());
+  auto client = cluster.createClient();
+
+  const auto write_start = Clock::now();
+  std::atomic<size_t> written{0};
+  {
+    // Use the same async path as the foreground load, with a cap on appends
+    // in flight.
+    const size_t max_in_flight = 1000;
+    std::atomic<size_t> in_flight{0};
+    std::string payload(options.payload_size, 'x');
+    for (size_t i = 0; i < options.records; ++i) {
+      while (in_flight.load() >= max_in_flight) {
+        /* sleep override */
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      ++in_flight;
+      auto cb = [&](Status st, const DataRecord&) {
+        if (st == E::OK) {
+          ++written;
+        }
+        --in_flight;
+      };
+      if (client->append(logs[i % logs.size()], payload, cb) != 0) {
+        --in_flight;
+      }
+    }
+    while (in_flight.load() > 0) {
+      /* sleep override */
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  ld_info("Wrote %lu records in %.1fs",
+          written.load(),
+          secondsSince(write_start));
+
+  BenchmarkLoad load(
+      client, logs, options.appends_per_sec, options.payload_size);
+  load.start("before_rebuilding");
+  loadFor(options.warmup);
+
+  Node& victim = cluster.getNode(node);
+  const uint32_t num_shards = victim.num_db_shards_;
+  victim.kill();
+  for (uint32_t shard = 0; shard < num_shards; ++shard) {
+    victim.wipeShard(shard);
+  }
+
+  const auto stats_before = sumNodeStats(cluster, REBUILDING_STATS);
+  load.setPhase("during_rebuilding");
+  const auto rebuild_start = Clock::now();
+  std::vector<ShardID> shards;
+  for (uint32_t shard = 0; shard < num_shards; ++shard) {
+    if (requestShardRebuilding(*client, node, shard) == LSN_INVALID) {
+      ld_error("Failed to request rebuilding of N%d:S%u: %s",
+               node,
+               shard,
+               error_name(err));
+    }
+    shards.emplace_back(node, shard);
+  }
+  waitUntilShardsHaveEventLogState(
+      client, shards, AuthoritativeStatus::AUTHORITATIVE_EMPTY, true);
+  const double rebuild_sec = secondsSince(rebuild_start);
+  const auto stats_after = sumNodeStats(cluster, REBUILDING_STATS);
+
+  load.setPhase("after_rebuilding");
+  // Bring the node back with empty shards, as an operator would after
+  // replacing its disks, and measure the load once it took writes again.
+  victim.start();
+  victim.waitUntilAvailable();
+  loadFor(options.cooldown);
+  load.stop();
+
+  auto rebuilding_stats = statsDelta(stats_before, stats_after);
+  // Each copy rebuilt is stored once by a recipient. The payload size is
+  // the same for all records, so bytes are estimated from it.
+  const int64_t records_rebuilt =
+      rebuilding_stats["rebuilding_recipient_stored_ok"].asInt();
+  const double bytes_rebuilt =
+      static_cast<double>(records_rebuilt) * options.payload_size;
+  const double bytes_per_sec = bytes_rebuilt / std::max(rebuild_sec, 1e-9);
+
+  return folly::dynamic::object("rebuilt_node", node)("shards", num_shards)(
+      "records_written", written.load())("rebuilding_sec", rebuild_sec)(
+      "records_rebuilt", records_rebuilt)("bytes_rebuilt", bytes_rebuilt)(
+      "rebuilding_mb_per_sec", bytes_per_sec / 1e6)(
+      "rebuilding_sec_per_tb",
+      bytes_per_sec > 0 ? 1e12 / bytes_per_sec : -1.0)(
+      "rebuilding_stats", rebuilding_stats)(
+      "foreground_appends", load.toDynamic());
+}
+
+void writeBenchmarkResults(const std::string& scenario,
+                           const folly::dynamic& results) {
+  ld_info("Benchmark %s: %s", scenario.c_str(), folly::toJson(results).c_str());
+  const char* dir = getenv("LOGDEVICE_BENCHMARK_RESULTS_DIR");
+  if (dir == nullptr || *dir == '\0') {
+    return;
+  }
+  const std::string path = std::string(dir) + "/" + scenario + ".json";
+  if (!folly::writeFile(folly::toPrettyJson(results) + "\n", path.c_str())) {
+    ld_error("Failed to write %s: %s", path.c_str(), strerror(errno));
+  }
+}
+
+}}} // namespace facebook::logdevice::IntegrationTestUtils
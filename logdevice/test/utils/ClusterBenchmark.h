@@ -0,0 +1,151 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <folly/dynamic.h>
+
+#include "logdevice/common/stats/Histogram.h"
+#include "logdevice/include/Client.h"
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice { namespace IntegrationTestUtils {
+
+class Cluster;
+
+/**
+ * @file Failure scenarios to benchmark on a Cluster: how long logs take to
+ *       become writable again after their sequencer node dies, and how long
+ *       a storage node takes to be rebuilt, while a foreground load runs.
+ *       Each scenario returns its measurements as a folly::dynamic object,
+ *       which writeBenchmarkResults() outputs as JSON for regression
+ *       tracking. See ClusterBenchmarkTest.cpp for how to run them.
+ */
+
+/**
+ * Appends to random logs at a fixed rate from a background thread, and
+ * records the latency of appends, measured from when they were due, in the
+ * phase of the scenario that was current when they were due.
+ */
+class BenchmarkLoad {
+ public:
+  BenchmarkLoad(std::shared_ptr<Client> client,
+                std::vector<logid_t> logs,
+                double appends_per_sec,
+                size_t payload_size);
+  ~BenchmarkLoad();
+
+  void start(std::string phase);
+
+  // Stops appending and waits for appends in flight, for a bounded time.
+  void stop();
+
+  // Appends due from now on are recorded under `phase`.
+  void setPhase(std::string phase);
+
+  // {<phase>: {"appends": n, "failed": n, "p50_ms": x, "p99_ms": x,
+  //            "p999_ms": x, "max_ms": x}}
+  folly::dynamic toDynamic() const;
+
+ private:
+  struct Phase {
+    uint64_t appends = 0;
+    uint64_t failed = 0;
+    HighResLatencyHistogram latency;
+  };
+
+  void run();
+  void onAppendDone(Status st,
+                    const std::string& phase,
+                    std::chrono::steady_clock::time_point due);
+
+  std::shared_ptr<Client> client_;
+  const std::vector<logid_t> logs_;
+  const double appends_per_sec_;
+  const std::string payload_;
+
+  mutable std::mutex mutex_;
+  std::string phase_;
+  std::map<std::string, Phase> phases_;
+  std::atomic<size_t> in_flight_{0};
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+};
+
+/**
+ * Sums, over all running nodes of the cluster, the stats whose names are in
+ * `names`. Per-message-type stats are named like "message_sent.SEAL".
+ */
+std::map<std::string, int64_t>
+sumNodeStats(Cluster& cluster, const std::vector<std::string>& names);
+
+struct SequencerFailoverOptions {
+  // Appends per second of the foreground load, across all logs.
+  double appends_per_sec = 1000;
+  size_t payload_size = 1024;
+  // Foreground load before the sequencer node is killed.
+  std::chrono::seconds warmup{5};
+  // How long to wait for all logs to become writable.
+  std::chrono::seconds timeout{120};
+};
+
+/**
+ * Kills the node running the sequencer of logs[0] under a foreground load,
+ * then measures, for each log whose sequencer was on that node, how long
+ * after the kill an append first succeeds. Also reports the recovery
+ * messages and stats of the surviving nodes during the failover, and the
+ * foreground append latency before and after the kill.
+ *
+ * The cluster should use hash based sequencer assignment, so that another
+ * node activates sequencers for the logs.
+ */
+folly::dynamic runSequencerFailover(Cluster& cluster,
+                                    std::vector<logid_t> logs,
+                                    SequencerFailoverOptions options);
+
+struct StorageNodeRebuildOptions {
+  // Records written to the logs before the storage node is killed, spread
+  // evenly across them.
+  size_t records = 100000;
+  double appends_per_sec = 1000;
+  size_t payload_size = 1024;
+  std::chrono::seconds warmup{5};
+  // Foreground load after rebuilding completed.
+  std::chrono::seconds cooldown{5};
+  std::chrono::seconds timeout{600};
+};
+
+/**
+ * Writes options.records records, then kills storage node `node` under a
+ * foreground load, wipes its shards and rebuilds them. Measures the time
+ * rebuilding takes, the records and estimated bytes rebuilt, the rebuilding
+ * throughput and time per TB, and the foreground append latency before,
+ * during and after rebuilding.
+ */
+folly::dynamic runStorageNodeRebuild(Cluster& cluster,
+                                     node_index_t node,
+                                     std::vector<logid_t> logs,
+                                     StorageNodeRebuildOptions options);
+
+/**
+ * Prints `results` of `scenario` as a JSON line to the log. If the
+ * LOGDEVICE_BENCHMARK_RESULTS_DIR environment variable is set, also writes
+ * them to <dir>/<scenario>.json.
+ */
+void writeBenchmarkResults(const std::string& scenario,
+                           const folly::dynamic& results);
+
+}}} // namespace facebook::logdevice::IntegrationTestUtils